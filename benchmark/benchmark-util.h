@@ -0,0 +1,94 @@
+// Helpers shared by the benchmarks of the connection life cycle, failover and mixed workload: server parameters from
+// the TEST_DB_* environment variables, the same as main-benchmark uses, and latency percentiles reported as benchmark
+// counters, i.e. in the same console table and JSON output as the other counters
+
+#ifndef _BENCHMARK_UTIL_H_
+#define _BENCHMARK_UTIL_H_
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#ifdef BENCHMARK_IN_TREE
+  #include "conncpp.hpp"
+#else
+  #include <mariadb/conncpp.hpp>
+#endif
+
+#define OPERATION_PER_SECOND_LABEL "nb operations per second"
+
+inline std::string GetEnvironmentVariableOrDefault(const std::string& variable_name, const std::string& default_value)
+{
+  const char* value = getenv(variable_name.c_str());
+  return value ? value : default_value;
+}
+
+// Benchmarks run on 1, 2, 4, ... up to TEST_MAX_THREAD threads
+const int MAX_THREAD = std::max(1, atoi(GetEnvironmentVariableOrDefault("TEST_MAX_THREAD", "1").c_str()));
+
+const std::string DB_PORT = GetEnvironmentVariableOrDefault("TEST_DB_PORT", "3306");
+const std::string DB_DATABASE = GetEnvironmentVariableOrDefault("TEST_DB_DATABASE", "bench");
+const std::string DB_USER = GetEnvironmentVariableOrDefault("TEST_DB_USER", "root");
+const std::string DB_HOST = GetEnvironmentVariableOrDefault("TEST_DB_HOST", "localhost");
+const std::string DB_PASSWORD = GetEnvironmentVariableOrDefault("TEST_DB_PASSWORD", "");
+
+inline double microsSince(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+// hosts is the comma separated list of host:port, options start with '?'. Throws on error, so that the caller can
+// measure failed attempts as well
+inline sql::Connection* connectTo(const std::string& hosts, const std::string& options)
+{
+  sql::Driver* driver = sql::mariadb::get_driver_instance();
+  sql::Properties props{{"user", DB_USER}, {"password", DB_PASSWORD}};
+  return driver->connect("jdbc:mariadb://" + hosts + "/" + DB_DATABASE + options, props);
+}
+
+inline sql::Connection* connectToServer(const std::string& options)
+{
+  return connectTo(DB_HOST + ":" + DB_PORT, options);
+}
+
+// Latency samples of one benchmark thread. report() sets p50, p99, p999 and max counters in microseconds. With several
+// threads each counter is the average of the threads' percentiles, as Google Benchmark has no way to merge samples
+class LatencySamples
+{
+  std::vector<double> samples;
+
+public:
+  explicit LatencySamples(std::size_t expected = 1024) { samples.reserve(expected); }
+
+  void add(double micros) { samples.push_back(micros); }
+  // Returns the sample
+  double addSince(std::chrono::steady_clock::time_point start)
+  {
+    double micros = microsSince(start);
+    samples.push_back(micros);
+    return micros;
+  }
+  std::size_t size() const { return samples.size(); }
+  // Merges samples of threads, that the benchmark has started itself
+  void addTo(LatencySamples& total) const { total.samples.insert(total.samples.end(), samples.begin(), samples.end()); }
+
+  void report(benchmark::State& state, const std::string& prefix = "")
+  {
+    if (samples.empty()) {
+      return;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [this](double p) {
+      return samples[std::min(samples.size() - 1, static_cast<std::size_t>(p * samples.size()))];
+    };
+    state.counters[prefix + "p50(us)"] = benchmark::Counter(percentile(0.5), benchmark::Counter::kAvgThreads);
+    state.counters[prefix + "p99(us)"] = benchmark::Counter(percentile(0.99), benchmark::Counter::kAvgThreads);
+    state.counters[prefix + "p999(us)"] = benchmark::Counter(percentile(0.999), benchmark::Counter::kAvgThreads);
+    state.counters[prefix + "max(us)"] = benchmark::Counter(samples.back(), benchmark::Counter::kAvgThreads);
+  }
+};
+
+#endif
@@ -0,0 +1,249 @@
+// Connection life cycle: establishing the connection over plain TCP and TLS, caching_sha2_password fast and full
+// authentication, storms of parallel connects, and the resident memory an idle connection costs. Besides the wall time
+// of connect, the handshake time the connector records itself(ConnectionMetrics::connectTime, without the session
+// initialization queries) is reported, so that the difference shows the cost of the session setup.
+// caching_sha2_password benchmarks need the account using it, that is set by TEST_SHA2_USER and TEST_SHA2_PASSWORD,
+// and MySQL server, as MariaDB server does not have this plugin. They are skipped without it
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+# include <unistd.h>
+# include <fstream>
+#endif
+
+#include "benchmark-util.h"
+
+const std::string SHA2_USER = GetEnvironmentVariableOrDefault("TEST_SHA2_USER", "");
+const std::string SHA2_PASSWORD = GetEnvironmentVariableOrDefault("TEST_SHA2_PASSWORD", "");
+
+// Connections with the storm and memory benchmarks are opened by that many threads
+#define CONNECT_THREADS 64
+#define TLS_OPTIONS "?useTls=true&trustServerCertificate=true"
+
+// Reports the handshake time recorded by the connector for connections opened since the previous snapshot
+static void reportConnectTime(benchmark::State& state, const sql::LatencySummary& before)
+{
+  std::unique_ptr<sql::MetricsSnapshot> snapshot(sql::mariadb::get_driver_instance()->getMetricsSnapshot());
+  const sql::LatencySummary& after = snapshot->getTotal().connectTime;
+  if (after.count > before.count) {
+    state.counters["handshake avg(us)"] = static_cast<double>(after.sum - before.sum) / (after.count - before.count);
+  }
+}
+
+static sql::LatencySummary connectTimeNow()
+{
+  std::unique_ptr<sql::MetricsSnapshot> snapshot(sql::mariadb::get_driver_instance()->getMetricsSnapshot());
+  return snapshot->getTotal().connectTime;
+}
+
+static void connect_loop(benchmark::State& state, const std::string& options) {
+  LatencySamples latency;
+  sql::LatencySummary before = connectTimeNow();
+  int numOperation = 0;
+
+  for (auto _ : state) {
+    auto start = std::chrono::steady_clock::now();
+    try {
+      std::unique_ptr<sql::Connection> conn(connectToServer(options));
+      latency.addSince(start);
+    }
+    catch (sql::SQLException& e) {
+      state.SkipWithError(e.what());
+      break;
+    }
+    numOperation++;
+  }
+  state.counters[OPERATION_PER_SECOND_LABEL] = benchmark::Counter(numOperation, benchmark::Counter::kIsRate);
+  latency.report(state);
+  if (state.thread_index() == 0) {
+    reportConnectTime(state, before);
+  }
+}
+
+static void BM_CONNECT_TCP(benchmark::State& state) {
+  connect_loop(state, "");
+}
+
+// Connector/C creates TLS context for each connection, so each connect makes the full handshake, and there is no
+// session resumption to switch on. TLS 1.3 handshake takes one round trip less than TLS 1.2 one. The pool is what
+// avoids handshakes
+static void BM_CONNECT_TLS12(benchmark::State& state) {
+  connect_loop(state, TLS_OPTIONS "&enabledTlsProtocolSuites=TLSv1.2");
+}
+
+static void BM_CONNECT_TLS13(benchmark::State& state) {
+  connect_loop(state, TLS_OPTIONS "&enabledTlsProtocolSuites=TLSv1.3");
+}
+
+static void BM_POOL_TLS(benchmark::State& state) {
+  connect_loop(state, TLS_OPTIONS "&pool=true&minPoolSize=1&maxPoolSize=" + std::to_string(MAX_THREAD));
+}
+
+BENCHMARK(BM_CONNECT_TCP)->Name("MariaDB connect + close - TCP")->ThreadRange(1, MAX_THREAD)->UseRealTime();
+BENCHMARK(BM_CONNECT_TLS12)->Name("MariaDB connect + close - TLS 1.2")->ThreadRange(1, MAX_THREAD)->UseRealTime();
+BENCHMARK(BM_CONNECT_TLS13)->Name("MariaDB connect + close - TLS 1.3")->ThreadRange(1, MAX_THREAD)->UseRealTime();
+BENCHMARK(BM_POOL_TLS)->Name("MariaDB pool get connection - TLS")->ThreadRange(1, MAX_THREAD)->UseRealTime();
+
+// caching_sha2_password. The fast authentication uses the hash, that the server caches after the first successful
+// authentication of the account. FLUSH PRIVILEGES empties the cache, so that the next connect makes the full
+// authentication - over TLS the password is sent in the clear, otherwise it is encrypted by the server's RSA key, that
+// the connector caches per host
+static void sha2_loop(benchmark::State& state, bool full) {
+  if (SHA2_USER.empty()) {
+    state.SkipWithError("TEST_SHA2_USER is not set");
+    return;
+  }
+  const bool tls = state.range(0) != 0;
+  sql::Driver* driver = sql::mariadb::get_driver_instance();
+  const sql::SQLString url("jdbc:mariadb://" + DB_HOST + ":" + DB_PORT + "/" + DB_DATABASE + (tls ? TLS_OPTIONS : ""));
+  sql::Properties props{{"user", SHA2_USER}, {"password", SHA2_PASSWORD}};
+  LatencySamples latency;
+
+  try {
+    std::unique_ptr<sql::Connection> admin(connectToServer(""));
+    std::unique_ptr<sql::Statement> stmt(admin->createStatement());
+    // Fills the server's cache, and the connector's RSA key cache
+    delete driver->connect(url, props);
+
+    for (auto _ : state) {
+      if (full) {
+        state.PauseTiming();
+        stmt->execute("FLUSH PRIVILEGES");
+        state.ResumeTiming();
+      }
+      auto start = std::chrono::steady_clock::now();
+      delete driver->connect(url, props);
+      latency.addSince(start);
+    }
+  }
+  catch (sql::SQLException& e) {
+    state.SkipWithError(e.what());
+  }
+  latency.report(state);
+}
+
+static void BM_SHA2_FAST_AUTH(benchmark::State& state) {
+  sha2_loop(state, false);
+}
+
+static void BM_SHA2_FULL_AUTH(benchmark::State& state) {
+  sha2_loop(state, true);
+}
+
+BENCHMARK(BM_SHA2_FAST_AUTH)->Name("MariaDB connect - caching_sha2_password fast auth")->ArgName("tls")->Arg(0)->Arg(1)->UseRealTime();
+BENCHMARK(BM_SHA2_FULL_AUTH)->Name("MariaDB connect - caching_sha2_password full auth")->ArgName("tls")->Arg(0)->Arg(1)->UseRealTime();
+
+// Opens connections by CONNECT_THREADS threads, and keeps them open until all are done. Connects, that have failed,
+// are counted in errors. The caller owns the connections
+static std::vector<std::unique_ptr<sql::Connection>> openConnections(int64_t count, LatencySamples& latency,
+  int64_t& errors)
+{
+  std::vector<std::unique_ptr<sql::Connection>> connections(static_cast<std::size_t>(count));
+  std::vector<LatencySamples> threadLatency(CONNECT_THREADS);
+  std::atomic<int64_t> next{0}, failed{0};
+  std::vector<std::thread> threads;
+
+  for (int i = 0; i < CONNECT_THREADS; ++i) {
+    threads.emplace_back([&, i]() {
+      int64_t index;
+      while ((index = next++) < count) {
+        auto start = std::chrono::steady_clock::now();
+        try {
+          connections[static_cast<std::size_t>(index)].reset(connectToServer(""));
+          threadLatency[i].addSince(start);
+        }
+        catch (sql::SQLException&) {
+          ++failed;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto& samples : threadLatency) {
+    samples.addTo(latency);
+  }
+  errors = failed;
+  return connections;
+}
+
+// Connect storm, e.g. after the application restart, or the failover of the whole fleet. The server has to allow as
+// many connections(max_connections)
+static void BM_CONNECT_STORM(benchmark::State& state) {
+  const int64_t count = state.range(0);
+  LatencySamples latency(static_cast<std::size_t>(count));
+  sql::LatencySummary before = connectTimeNow();
+  int64_t errors = 0, opened = 0;
+
+  for (auto _ : state) {
+    auto start = std::chrono::steady_clock::now();
+    auto connections = openConnections(count, latency, errors);
+    state.SetIterationTime(microsSince(start) / 1000000);
+    state.PauseTiming();
+    opened += count - errors;
+    connections.clear();
+    state.ResumeTiming();
+  }
+  state.counters["connections per second"] = benchmark::Counter(static_cast<double>(opened), benchmark::Counter::kIsRate);
+  state.counters["errors"] = static_cast<double>(errors);
+  latency.report(state, "connect ");
+  reportConnectTime(state, before);
+}
+
+BENCHMARK(BM_CONNECT_STORM)->Name("MariaDB parallel connect storm")->Arg(1000)->Arg(10000)->Iterations(3)->UseManualTime();
+
+#ifdef __linux__
+static uint64_t residentBytes()
+{
+  std::ifstream statm("/proc/self/statm");
+  uint64_t size = 0, resident = 0;
+  statm >> size >> resident;
+  return resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+}
+#endif
+
+// Resident memory of the process grows by that much per idle connection - the connector's objects, the C API handle and
+// its network buffer, and the TLS state. memoryFootprint is the connector's own estimate, without the C API handle
+static void BM_IDLE_CONNECTION_MEMORY(benchmark::State& state) {
+#ifdef __linux__
+  const int64_t count = state.range(0);
+  const bool tls = state.range(1) != 0;
+
+  for (auto _ : state) {
+    // The first connect loads the TLS library and initializes the driver, that is not per connection cost
+    delete connectToServer(tls ? TLS_OPTIONS : "");
+    uint64_t start = residentBytes();
+    std::vector<std::unique_ptr<sql::Connection>> connections;
+    int64_t errors = 0;
+    for (int64_t i = 0; i < count; ++i) {
+      try {
+        connections.emplace_back(connectToServer(tls ? TLS_OPTIONS : ""));
+      }
+      catch (sql::SQLException&) {
+        ++errors;
+      }
+    }
+    uint64_t footprint = 0;
+    for (auto& conn : connections) {
+      footprint += conn->getMetrics().memoryFootprint;
+    }
+    if (!connections.empty()) {
+      state.counters["RSS per connection(bytes)"] = static_cast<double>(residentBytes() - start) / connections.size();
+      state.counters["footprint per connection(bytes)"] = static_cast<double>(footprint) / connections.size();
+    }
+    state.counters["errors"] = static_cast<double>(errors);
+  }
+#else
+  state.SkipWithError("Resident memory is measured on Linux only");
+#endif
+}
+
+BENCHMARK(BM_IDLE_CONNECTION_MEMORY)->Name("MariaDB idle connection memory")->ArgNames({"connections", "tls"})
+  ->ArgsProduct({{1000}, {0, 1}})->Iterations(1)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
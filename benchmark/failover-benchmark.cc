@@ -0,0 +1,213 @@
+// Behaviour of the connector under network faults, that the steady state benchmarks do not see: time to recover after
+// the connection reset, time to fail over to the second host, when the first one is black-holed, with and without
+// the parallel connect and the warm standby, the throughput dip during the failover, and the query latency on the
+// link with latency and loss. The faults are injected by FaultProxy between the connector and the server, so one
+// server is enough - both "hosts" of the failover url are proxies to it. Hosts, that fail, stay in the process wide
+// blacklist, so iterations after the first one show the effect of the shared blacklist as well
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "benchmark-util.h"
+#include "fault-proxy.h"
+
+// Iterations of the benchmarks, each of which injects the fault and waits for the recovery
+#define FAULT_ITERATIONS 20
+// Bounds the wait for the black-holed host
+#define FAILOVER_OPTIONS "connectTimeout=1000&socketTimeout=2000&retryOnFailover=true"
+
+// Runs SELECT 1 until it succeeds, reconnecting after failures, and returns the time it took
+static double recover(sql::Connection* conn, sql::Statement* stmt)
+{
+  auto start = std::chrono::steady_clock::now();
+  while (true) {
+    try {
+      std::unique_ptr<sql::ResultSet> res(stmt->executeQuery("SELECT 1"));
+      if (res->next()) {
+        return microsSince(start);
+      }
+    }
+    catch (sql::SQLException&) {
+      try {
+        conn->reconnect();
+      }
+      catch (sql::SQLException&) {
+      }
+    }
+  }
+}
+
+// All proxied connections are reset, the host stays reachable
+static void BM_RECONNECT_AFTER_RESET(benchmark::State& state) {
+  FaultProxy proxy(DB_HOST, DB_PORT);
+  std::unique_ptr<sql::Connection> conn(connectTo(proxy.address(), "?" FAILOVER_OPTIONS));
+  std::unique_ptr<sql::Statement> stmt(conn->createStatement());
+  LatencySamples recovery(FAULT_ITERATIONS);
+
+  for (auto _ : state) {
+    proxy.resetAll();
+    // Lets the reset reach the client
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    double micros = recover(conn.get(), stmt.get());
+    recovery.add(micros);
+    state.SetIterationTime(micros / 1000000);
+  }
+  recovery.report(state, "recover ");
+}
+
+BENCHMARK(BM_RECONNECT_AFTER_RESET)->Name("MariaDB reconnect after connection reset")->Iterations(FAULT_ITERATIONS)->UseManualTime();
+
+// The current host is black-holed and its connections are reset. The statement is retried on the second host
+static void failover_loop(benchmark::State& state, const std::string& options) {
+  FaultProxy first(DB_HOST, DB_PORT), second(DB_HOST, DB_PORT);
+  const std::string hosts = first.address() + "," + second.address();
+  LatencySamples recovery(FAULT_ITERATIONS);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    first.setBlackhole(false);
+    std::unique_ptr<sql::Connection> conn(connectTo(hosts, "?" FAILOVER_OPTIONS + options));
+    std::unique_ptr<sql::Statement> stmt(conn->createStatement());
+    // Gives the standby time to connect
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    state.ResumeTiming();
+
+    first.setBlackhole(true);
+    first.resetAll();
+    double micros = recover(conn.get(), stmt.get());
+    recovery.add(micros);
+    state.SetIterationTime(micros / 1000000);
+  }
+  recovery.report(state, "failover ");
+}
+
+static void BM_FAILOVER_SEQUENTIAL(benchmark::State& state) {
+  failover_loop(state, "");
+}
+
+static void BM_FAILOVER_PARALLEL_CONNECT(benchmark::State& state) {
+  failover_loop(state, "&connectAttemptDelay=50");
+}
+
+static void BM_FAILOVER_STANDBY(benchmark::State& state) {
+  failover_loop(state, "&failoverStandby=true&failoverStandbyPingInterval=100");
+}
+
+BENCHMARK(BM_FAILOVER_SEQUENTIAL)->Name("MariaDB failover - hosts tried one after another")->Iterations(FAULT_ITERATIONS)->UseManualTime();
+BENCHMARK(BM_FAILOVER_PARALLEL_CONNECT)->Name("MariaDB failover - parallel connect")->Iterations(FAULT_ITERATIONS)->UseManualTime();
+BENCHMARK(BM_FAILOVER_STANDBY)->Name("MariaDB failover - warm standby")->Iterations(FAULT_ITERATIONS)->UseManualTime();
+
+// Threads run SELECT 1 for DIP_DURATION_MS, the first host fails after DIP_FAULT_AT_MS. Queries are counted in buckets of
+// DIP_BUCKET_MS. Reported are the throughput before the fault, the lowest one after it, and the time until the
+// throughput is back to 90% of the one before the fault
+#define DIP_DURATION_MS 4000
+#define DIP_FAULT_AT_MS 1000
+#define DIP_BUCKET_MS 50
+
+static void BM_FAILOVER_THROUGHPUT_DIP(benchmark::State& state) {
+  const int threadCount = static_cast<int>(state.range(0));
+  const std::size_t bucketCount = DIP_DURATION_MS / DIP_BUCKET_MS;
+  FaultProxy first(DB_HOST, DB_PORT), second(DB_HOST, DB_PORT);
+  const std::string hosts = first.address() + "," + second.address();
+
+  for (auto _ : state) {
+    std::vector<std::atomic<int64_t>> buckets(bucketCount);
+    for (auto& bucket : buckets) {
+      bucket = 0;
+    }
+    std::vector<std::unique_ptr<sql::Connection>> connections;
+    for (int i = 0; i < threadCount; ++i) {
+      connections.emplace_back(connectTo(hosts, "?" FAILOVER_OPTIONS));
+    }
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < threadCount; ++i) {
+      threads.emplace_back([&, i]() {
+        std::unique_ptr<sql::Statement> stmt(connections[i]->createStatement());
+        while (true) {
+          std::size_t bucket = static_cast<std::size_t>(microsSince(start) / 1000 / DIP_BUCKET_MS);
+          if (bucket >= bucketCount) {
+            break;
+          }
+          try {
+            std::unique_ptr<sql::ResultSet> res(stmt->executeQuery("SELECT 1"));
+            res->next();
+            ++buckets[bucket];
+          }
+          catch (sql::SQLException&) {
+            try {
+              connections[i]->reconnect();
+            }
+            catch (sql::SQLException&) {
+            }
+          }
+        }
+      });
+    }
+    std::this_thread::sleep_until(start + std::chrono::milliseconds(DIP_FAULT_AT_MS));
+    first.setBlackhole(true);
+    first.resetAll();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    first.setBlackhole(false);
+
+    const std::size_t faultBucket = DIP_FAULT_AT_MS / DIP_BUCKET_MS;
+    double baseline = 0;
+    // The first bucket includes the warm up
+    for (std::size_t i = 1; i < faultBucket; ++i) {
+      baseline += buckets[i];
+    }
+    baseline /= faultBucket - 1;
+    int64_t lowest = buckets[faultBucket];
+    std::size_t recovered = bucketCount;
+    for (std::size_t i = faultBucket; i < bucketCount; ++i) {
+      lowest = std::min<int64_t>(lowest, buckets[i]);
+      if (recovered == bucketCount && i > faultBucket && buckets[i] >= 0.9 * baseline) {
+        recovered = i;
+      }
+    }
+    const double perSecond = 1000.0 / DIP_BUCKET_MS;
+    state.counters["before fault ops/s"] = baseline * perSecond;
+    state.counters["lowest ops/s"] = static_cast<double>(lowest) * perSecond;
+    state.counters["time to 90% (ms)"] = static_cast<double>((recovered - faultBucket) * DIP_BUCKET_MS);
+    state.SetIterationTime(DIP_DURATION_MS / 1000.0);
+  }
+}
+
+BENCHMARK(BM_FAILOVER_THROUGHPUT_DIP)->Name("MariaDB failover throughput dip")->Arg(1)->Arg(8)->Iterations(1)->UseManualTime();
+
+// Query latency on the degraded link. Arguments are the one way latency in microseconds, and the loss in 1/1000
+static void BM_SELECT_1_DEGRADED_LINK(benchmark::State& state) {
+  FaultProxy proxy(DB_HOST, DB_PORT);
+  proxy.setLatency(std::chrono::microseconds(state.range(0)));
+  proxy.setLossRate(state.range(1) / 1000.0);
+  std::unique_ptr<sql::Connection> conn(connectTo(proxy.address(), ""));
+  std::unique_ptr<sql::Statement> stmt(conn->createStatement());
+  LatencySamples latency;
+  int numOperation = 0;
+
+  for (auto _ : state) {
+    auto start = std::chrono::steady_clock::now();
+    try {
+      std::unique_ptr<sql::ResultSet> res(stmt->executeQuery("SELECT 1"));
+      res->next();
+    }
+    catch (sql::SQLException& e) {
+      state.SkipWithError(e.what());
+      break;
+    }
+    latency.addSince(start);
+    numOperation++;
+  }
+  state.counters[OPERATION_PER_SECOND_LABEL] = benchmark::Counter(numOperation, benchmark::Counter::kIsRate);
+  latency.report(state);
+}
+
+BENCHMARK(BM_SELECT_1_DEGRADED_LINK)->Name("MariaDB SELECT 1 - degraded link")->Args({0, 0})->Args({500, 0})->Args({500, 10})->Args({500, 50})->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,213 @@
+// TCP proxy between the connector and the server, that injects network faults: added latency, packet loss, connection
+// resets and the black-holed host. It listens on an ephemeral port of 127.0.0.1, and forwards each accepted connection
+// to the target by a pair of threads, one for each direction. POSIX only.
+// Userspace proxy cannot drop packets of the kernel's TCP stream, thus the loss is emulated as its effect on the
+// stream - the chunk is delayed by the retransmission timeout. The black-holed proxy still completes the TCP handshake,
+// as the listening socket does it in the kernel, but never forwards a byte, i.e. the connector waits for the server
+// greeting until connectTimeout, and for results until socketTimeout, like with the hung host
+
+#ifndef _FAULT_PROXY_H_
+#define _FAULT_PROXY_H_
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+class FaultProxy
+{
+  // Minimal retransmission timeout of Linux TCP
+  static constexpr int RETRANSMIT_DELAY_MS = 200;
+
+  struct Link
+  {
+    int client;
+    int server;
+    std::atomic<bool> closed{false};
+    std::thread worker;
+
+    Link(int _client, int _server) : client(_client), server(_server) {}
+  };
+
+  sockaddr_storage target;
+  socklen_t targetLength = 0;
+  int listener = -1;
+  int listenPort = 0;
+  std::atomic<bool> stopped{false};
+  std::atomic<int64_t> latencyMicros{0};
+  std::atomic<uint32_t> lossPerMillion{0};
+  std::atomic<bool> blackholed{false};
+  std::mutex lock;
+  std::list<std::shared_ptr<Link>> links;
+  std::thread acceptor;
+
+  static void sendAll(int fd, const char* buf, ssize_t length)
+  {
+    while (length > 0) {
+      ssize_t sent = ::send(fd, buf, static_cast<std::size_t>(length), MSG_NOSIGNAL);
+      if (sent <= 0) {
+        return;
+      }
+      buf += sent;
+      length -= sent;
+    }
+  }
+
+  void pump(Link& link, int from, int to)
+  {
+    std::minstd_rand random(static_cast<uint32_t>(from));
+    std::uniform_int_distribution<uint32_t> perMillion(0, 999999);
+    char buf[16384];
+
+    while (!link.closed && !stopped) {
+      pollfd ready{from, POLLIN, 0};
+      if (poll(&ready, 1, 50) <= 0) {
+        continue;
+      }
+      // Data stays in the socket buffers, the peer sees no response
+      if (blackholed) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        continue;
+      }
+      ssize_t received = ::recv(from, buf, sizeof(buf), 0);
+      if (received <= 0) {
+        break;
+      }
+      int64_t delay = latencyMicros;
+      if (lossPerMillion > 0 && perMillion(random) < lossPerMillion) {
+        delay += RETRANSMIT_DELAY_MS * 1000;
+      }
+      if (delay > 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(delay));
+      }
+      sendAll(to, buf, received);
+    }
+    link.closed = true;
+  }
+
+  void serve(std::shared_ptr<Link> link)
+  {
+    std::thread upstream(&FaultProxy::pump, this, std::ref(*link), link->client, link->server);
+    pump(*link, link->server, link->client);
+    upstream.join();
+    // Zero linger makes close send RST instead of FIN, if the link is reset
+    linger hard{1, 0};
+    setsockopt(link->client, SOL_SOCKET, SO_LINGER, &hard, sizeof(hard));
+    ::close(link->client);
+    ::close(link->server);
+  }
+
+  void acceptLoop()
+  {
+    while (!stopped) {
+      pollfd ready{listener, POLLIN, 0};
+      if (poll(&ready, 1, 50) <= 0) {
+        continue;
+      }
+      int client = ::accept(listener, nullptr, nullptr);
+      if (client < 0) {
+        continue;
+      }
+      int server = ::socket(target.ss_family, SOCK_STREAM, 0);
+      if (server < 0 || ::connect(server, reinterpret_cast<sockaddr*>(&target), targetLength) != 0) {
+        ::close(client);
+        if (server >= 0) {
+          ::close(server);
+        }
+        continue;
+      }
+      int one = 1;
+      setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+      setsockopt(server, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+      std::shared_ptr<Link> link(new Link(client, server));
+      std::lock_guard<std::mutex> guard(lock);
+      // Forgets links, that have finished
+      for (auto it = links.begin(); it != links.end();) {
+        if ((*it)->closed && (*it)->worker.joinable()) {
+          (*it)->worker.join();
+          it = links.erase(it);
+        }
+        else {
+          ++it;
+        }
+      }
+      links.push_back(link);
+      link->worker = std::thread(&FaultProxy::serve, this, link);
+    }
+  }
+
+public:
+  FaultProxy(const std::string& targetHost, const std::string& targetPort)
+  {
+    addrinfo hints, *resolved = nullptr;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(targetHost.c_str(), targetPort.c_str(), &hints, &resolved) != 0 || resolved == nullptr) {
+      throw std::runtime_error("Could not resolve " + targetHost);
+    }
+    std::memcpy(&target, resolved->ai_addr, resolved->ai_addrlen);
+    targetLength = static_cast<socklen_t>(resolved->ai_addrlen);
+    freeaddrinfo(resolved);
+
+    sockaddr_in local;
+    std::memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t localLength = sizeof(local);
+    listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0 || ::bind(listener, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0
+        || ::listen(listener, 1024) != 0
+        || getsockname(listener, reinterpret_cast<sockaddr*>(&local), &localLength) != 0) {
+      throw std::runtime_error("Could not start the proxy listener");
+    }
+    listenPort = ntohs(local.sin_port);
+    acceptor = std::thread(&FaultProxy::acceptLoop, this);
+  }
+
+  ~FaultProxy()
+  {
+    stopped = true;
+    acceptor.join();
+    std::lock_guard<std::mutex> guard(lock);
+    for (auto& link : links) {
+      link->closed = true;
+      link->worker.join();
+    }
+    ::close(listener);
+  }
+
+  // host:port to put in the connection url
+  std::string address() const { return "127.0.0.1:" + std::to_string(listenPort); }
+
+  // Added to each forwarded chunk in each direction, i.e. twice per round trip
+  void setLatency(std::chrono::microseconds latency) { latencyMicros = latency.count(); }
+  // Share of chunks, that are delayed by the retransmission timeout
+  void setLossRate(double rate) { lossPerMillion = static_cast<uint32_t>(rate * 1000000); }
+  void setBlackhole(bool on) { blackholed = on; }
+
+  // Connections, that are proxied now, are closed with RST. New connections are accepted as before
+  void resetAll()
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    for (auto& link : links) {
+      link->closed = true;
+    }
+  }
+};
+
+#endif
@@ -1,10 +1,13 @@
 #include <benchmark/benchmark.h>
 #include <iostream>
+#include <memory>
+#include <sstream>
 #include <string>
 #include <cstring>
 #include <stdlib.h>
+#include <algorithm>
+#include <vector>
 
-const int MAX_THREAD = 1;
 #define OPERATION_PER_SECOND_LABEL "nb operations per second"
 
 std::string GetEnvironmentVariableOrDefault(const std::string& variable_name,
@@ -14,6 +17,10 @@ std::string GetEnvironmentVariableOrDefault(const std::string& variable_name,
     return value ? value : default_value;
 }
 
+// Benchmarks run on 1, 2, 4, ... up to TEST_MAX_THREAD threads
+const int MAX_THREAD = std::max(1, atoi(GetEnvironmentVariableOrDefault("TEST_MAX_THREAD", "1").c_str()));
+const int MAX_POOL_THREAD = std::max(MAX_THREAD, 64);
+
 std::string DB_PORT = GetEnvironmentVariableOrDefault("TEST_DB_PORT", "3306");
 std::string DB_DATABASE = GetEnvironmentVariableOrDefault("TEST_DB_DATABASE", "bench");
 std::string DB_USER = GetEnvironmentVariableOrDefault("TEST_DB_USER", "root");
@@ -21,7 +28,11 @@ std::string DB_HOST = GetEnvironmentVariableOrDefault("TEST_DB_HOST", "localhost
 std::string DB_PASSWORD = GetEnvironmentVariableOrDefault("TEST_DB_PASSWORD", "");
 
 #ifndef MYSQL
+  #ifdef BENCHMARK_IN_TREE
+    #include "conncpp.hpp"
+  #else
     #include <mariadb/conncpp.hpp>
+  #endif
 const std::string TYPE = "MariaDB";
 sql::Connection* connect(std::string options) {
     try {
@@ -74,16 +85,12 @@ sql::Connection* connect(std::string options) {
 }
 #endif
 
-void do_1(benchmark::State& state, sql::Connection* conn) {
+// Statements are created once per benchmark thread and reused for every iteration, so that only the execution
+// itself is measured, and not the statement object life cycle
+void do_1(benchmark::State& state, sql::Statement* stmt) {
   try {
-    sql::Statement *stmt;
-    sql::ResultSet *res;
-
-    // Create a new Statement
-    stmt = conn->createStatement();
     // Execute query
     stmt->executeUpdate("DO 1");
-    delete stmt;
   } catch(sql::SQLException& e){
     state.SkipWithError(e.what());
   }
@@ -91,25 +98,24 @@ void do_1(benchmark::State& state, sql::Connection* conn) {
 
 static void BM_DO_1(benchmark::State& state) {
   sql::Connection *conn = connect("");
+  std::unique_ptr<sql::Statement> stmt(conn->createStatement());
   int numOperation = 0;
   for (auto _ : state) {
-    do_1(state, conn);
+    do_1(state, stmt.get());
     numOperation++;
   }
   state.counters[OPERATION_PER_SECOND_LABEL] = benchmark::Counter(numOperation, benchmark::Counter::kIsRate);
+  stmt.reset();
   delete conn;
 }
 
 BENCHMARK(BM_DO_1)->Name(TYPE + " DO 1")->ThreadRange(1, MAX_THREAD)->UseRealTime();
 
-int select_1(benchmark::State& state, sql::Connection* conn) {
-    int val;
+int select_1(benchmark::State& state, sql::Statement* stmt) {
+    int val = 0;
     try {
-        sql::Statement *stmt;
         sql::ResultSet *res;
 
-        // Create a new Statement
-        stmt = conn->createStatement();
         // Execute query
         res = stmt->executeQuery("SELECT 1");
         // Loop through results
@@ -117,7 +123,6 @@ int select_1(benchmark::State& state, sql::Connection* conn) {
           val = res->getInt(1);
         }
         delete res;
-        delete stmt;
     } catch(sql::SQLException& e){
         state.SkipWithError(e.what());
     }
@@ -126,28 +131,26 @@ int select_1(benchmark::State& state, sql::Connection* conn) {
 
 static void BM_SELECT_1(benchmark::State& state) {
   sql::Connection *conn = connect("");
+  std::unique_ptr<sql::Statement> stmt(conn->createStatement());
   int numOperation = 0;
   for (auto _ : state) {
-    benchmark::DoNotOptimize(select_1(state, conn));
+    benchmark::DoNotOptimize(select_1(state, stmt.get()));
     benchmark::ClobberMemory();
     numOperation++;
   }
   state.counters[OPERATION_PER_SECOND_LABEL] = benchmark::Counter(numOperation, benchmark::Counter::kIsRate);
+  stmt.reset();
   delete conn;
 }
 
 BENCHMARK(BM_SELECT_1)->Name(TYPE + " SELECT 1")->ThreadRange(1, MAX_THREAD)->UseRealTime();
 
-void select_1000_rows(benchmark::State& state, sql::Connection* conn) {
+void select_rows(benchmark::State& state, sql::Statement* stmt, const std::string& query) {
   try {
-    sql::Statement *stmt;
     sql::ResultSet *res;
 
-    // Create a new Statement
-    stmt = conn->createStatement();
-    // stmt->setFetchSize(1); => error if set
     // Execute query
-    res = stmt->executeQuery("select seq, 'abcdefghijabcdefghijabcdefghijaa' from seq_1_to_1000");
+    res = stmt->executeQuery(query);
 
     // Loop through results
     int val1;
@@ -158,7 +161,6 @@ void select_1000_rows(benchmark::State& state, sql::Connection* conn) {
         benchmark::ClobberMemory();
     }
     delete res;
-    delete stmt;
   } catch(sql::SQLException& e){
       state.SkipWithError(e.what());
   }
@@ -166,17 +168,106 @@ void select_1000_rows(benchmark::State& state, sql::Connection* conn) {
 
 static void BM_SELECT_1000_ROWS(benchmark::State& state) {
   sql::Connection *conn = connect("");
+  std::unique_ptr<sql::Statement> stmt(conn->createStatement());
   int numOperation = 0;
   for (auto _ : state) {
-    select_1000_rows(state, conn);
+    select_rows(state, stmt.get(), "select seq, 'abcdefghijabcdefghijabcdefghijaa' from seq_1_to_1000");
     numOperation++;
   }
   state.counters[OPERATION_PER_SECOND_LABEL] = benchmark::Counter(numOperation, benchmark::Counter::kIsRate);
+  stmt.reset();
   delete conn;
 }
 
 BENCHMARK(BM_SELECT_1000_ROWS)->Name(TYPE + " SELECT 1000 rows (int + char(32))")->ThreadRange(1, MAX_THREAD)->UseRealTime();
 
+#define SELECT_100K_ROWS "select seq, 'abcdefghijabcdefghijabcdefghijaa' from seq_1_to_100000"
+
+// Whole result is read into the memory by the executeQuery
+static void BM_SELECT_100K_ROWS_BUFFERED(benchmark::State& state) {
+  sql::Connection *conn = connect("");
+  std::unique_ptr<sql::Statement> stmt(conn->createStatement());
+  int numOperation = 0;
+  for (auto _ : state) {
+    select_rows(state, stmt.get(), SELECT_100K_ROWS);
+    numOperation++;
+  }
+  state.counters[OPERATION_PER_SECOND_LABEL] = benchmark::Counter(numOperation, benchmark::Counter::kIsRate);
+  stmt.reset();
+  delete conn;
+}
+
+// Rows are fetched from the server by 1000 while the result is read
+static void BM_SELECT_100K_ROWS_STREAMING(benchmark::State& state) {
+  sql::Connection *conn = connect("");
+  std::unique_ptr<sql::Statement> stmt(conn->createStatement());
+  stmt->setFetchSize(1000);
+  int numOperation = 0;
+  for (auto _ : state) {
+    select_rows(state, stmt.get(), SELECT_100K_ROWS);
+    numOperation++;
+  }
+  state.counters[OPERATION_PER_SECOND_LABEL] = benchmark::Counter(numOperation, benchmark::Counter::kIsRate);
+  stmt.reset();
+  delete conn;
+}
+
+// The same with the big socket receive buffer, that matters on links with high bandwidth-delay product
+static void BM_SELECT_100K_ROWS_BUFFERED_BIG_RCVBUF(benchmark::State& state) {
+  sql::Connection *conn = connect("?tcpRcvBuf=4194304");
+  std::unique_ptr<sql::Statement> stmt(conn->createStatement());
+  int numOperation = 0;
+  for (auto _ : state) {
+    select_rows(state, stmt.get(), SELECT_100K_ROWS);
+    numOperation++;
+  }
+  state.counters[OPERATION_PER_SECOND_LABEL] = benchmark::Counter(numOperation, benchmark::Counter::kIsRate);
+  stmt.reset();
+  delete conn;
+}
+
+#ifndef MYSQL
+// Over Unix socket, or shared memory on Windows, if the server is local - compare with the same tests over TCP
+static void BM_SELECT_1_LOCAL_TRANSPORT(benchmark::State& state) {
+  sql::Connection *conn = connect("?localSocketAutoDetect=true");
+  // The transport is detected by the first connection to the host
+  delete conn;
+  conn = connect("?localSocketAutoDetect=true");
+  std::unique_ptr<sql::Statement> stmt(conn->createStatement());
+  int numOperation = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(select_1(state, stmt.get()));
+    benchmark::ClobberMemory();
+    numOperation++;
+  }
+  state.counters[OPERATION_PER_SECOND_LABEL] = benchmark::Counter(numOperation, benchmark::Counter::kIsRate);
+  stmt.reset();
+  delete conn;
+}
+
+static void BM_SELECT_100K_ROWS_BUFFERED_LOCAL_TRANSPORT(benchmark::State& state) {
+  sql::Connection *conn = connect("?localSocketAutoDetect=true");
+  delete conn;
+  conn = connect("?localSocketAutoDetect=true");
+  std::unique_ptr<sql::Statement> stmt(conn->createStatement());
+  int numOperation = 0;
+  for (auto _ : state) {
+    select_rows(state, stmt.get(), SELECT_100K_ROWS);
+    numOperation++;
+  }
+  state.counters[OPERATION_PER_SECOND_LABEL] = benchmark::Counter(numOperation, benchmark::Counter::kIsRate);
+  stmt.reset();
+  delete conn;
+}
+
+BENCHMARK(BM_SELECT_1_LOCAL_TRANSPORT)->Name(TYPE + " SELECT 1 - local transport")->ThreadRange(1, MAX_THREAD)->UseRealTime();
+BENCHMARK(BM_SELECT_100K_ROWS_BUFFERED_LOCAL_TRANSPORT)->Name(TYPE + " SELECT 100k rows - buffered, local transport")->ThreadRange(1, MAX_THREAD)->UseRealTime();
+#endif
+
+BENCHMARK(BM_SELECT_100K_ROWS_BUFFERED)->Name(TYPE + " SELECT 100k rows - buffered")->ThreadRange(1, MAX_THREAD)->UseRealTime();
+BENCHMARK(BM_SELECT_100K_ROWS_STREAMING)->Name(TYPE + " SELECT 100k rows - streaming")->ThreadRange(1, MAX_THREAD)->UseRealTime();
+BENCHMARK(BM_SELECT_100K_ROWS_BUFFERED_BIG_RCVBUF)->Name(TYPE + " SELECT 100k rows - buffered, 4MB socket buffer")->ThreadRange(1, MAX_THREAD)->UseRealTime();
+
 static void setup_select_100_cols(const benchmark::State& state) {
   sql::Connection *conn = connect("");
 
@@ -191,13 +282,10 @@ static void setup_select_100_cols(const benchmark::State& state) {
 }
 
 
-void select_100_cols(benchmark::State& state, sql::Connection* conn) {
+void select_100_cols(benchmark::State& state, sql::PreparedStatement* prep_stmt) {
     try {
-        sql::PreparedStatement *prep_stmt;
         sql::ResultSet *res;
 
-        // Create a new Statement
-        prep_stmt = conn->prepareStatement("select * FROM test100");
         // Execute query
         res = prep_stmt->executeQuery();
         // Loop through results
@@ -208,7 +296,6 @@ void select_100_cols(benchmark::State& state, sql::Connection* conn) {
                benchmark::ClobberMemory();
         }
         delete res;
-        delete prep_stmt;
     } catch(sql::SQLException& e){
         state.SkipWithError(e.what());
     }
@@ -216,47 +303,83 @@ void select_100_cols(benchmark::State& state, sql::Connection* conn) {
 
 static void BM_SELECT_100_COLS(benchmark::State& state) {
   sql::Connection *conn = connect("");
+  std::unique_ptr<sql::PreparedStatement> prep_stmt(conn->prepareStatement("select * FROM test100"));
   int numOperation = 0;
   for (auto _ : state) {
-    select_100_cols(state, conn);
+    select_100_cols(state, prep_stmt.get());
     numOperation++;
   }
   state.counters[OPERATION_PER_SECOND_LABEL] = benchmark::Counter(numOperation, benchmark::Counter::kIsRate);
+  prep_stmt.reset();
   delete conn;
 }
 static void BM_SELECT_100_COLS_SRV_PREPARED(benchmark::State& state) {
   sql::Connection *conn = connect("?useServerPrepStmts=true");
+  std::unique_ptr<sql::PreparedStatement> prep_stmt(conn->prepareStatement("select * FROM test100"));
   int numOperation = 0;
   for (auto _ : state) {
-    select_100_cols(state, conn);
+    select_100_cols(state, prep_stmt.get());
     numOperation++;
   }
   state.counters[OPERATION_PER_SECOND_LABEL] = benchmark::Counter(numOperation, benchmark::Counter::kIsRate);
+  prep_stmt.reset();
   delete conn;
 }
 
 BENCHMARK(BM_SELECT_100_COLS)->Name(TYPE + " SELECT 100 int cols")->ThreadRange(1, MAX_THREAD)->UseRealTime()->Setup(setup_select_100_cols);
 #ifndef MYSQL
-BENCHMARK(BM_SELECT_100_COLS_SRV_PREPARED)->Name(TYPE + " SELECT 100 int cols - srv prepared")->ThreadRange(1, MAX_THREAD)->UseRealTime();
+BENCHMARK(BM_SELECT_100_COLS_SRV_PREPARED)->Name(TYPE + " SELECT 100 int cols - srv prepared")->ThreadRange(1, MAX_THREAD)->UseRealTime()->Setup(setup_select_100_cols);
 #endif
 
+// Re-execution of already prepared statement with a new parameter value
+int prepared_execute(benchmark::State& state, sql::PreparedStatement* prep_stmt, int param) {
+    int val = 0;
+    try {
+        prep_stmt->setInt(1, param);
+        std::unique_ptr<sql::ResultSet> res(prep_stmt->executeQuery());
+        while (res->next()) {
+          val = res->getInt(1);
+        }
+    } catch(sql::SQLException& e){
+        state.SkipWithError(e.what());
+    }
+    return val;
+}
 
-void do_1000_params(benchmark::State& state, sql::Connection* conn) {
-     try {
-         sql::PreparedStatement *prep_stmt;
-         sql::ResultSet *res;
+static void prepared_execute_loop(benchmark::State& state, const std::string& options) {
+  sql::Connection *conn = connect(options);
+  std::unique_ptr<sql::PreparedStatement> prep_stmt(conn->prepareStatement("SELECT ?"));
+  int numOperation = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(prepared_execute(state, prep_stmt.get(), numOperation));
+    numOperation++;
+  }
+  state.counters[OPERATION_PER_SECOND_LABEL] = benchmark::Counter(numOperation, benchmark::Counter::kIsRate);
+  prep_stmt.reset();
+  delete conn;
+}
 
-         // Create a new Statement
-         prep_stmt = conn->prepareStatement(
-            "DO ?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?"
-         );
+static void BM_PREPARED_EXECUTE_CLIENT(benchmark::State& state) {
+  prepared_execute_loop(state, "");
+}
+
+BENCHMARK(BM_PREPARED_EXECUTE_CLIENT)->Name(TYPE + " SELECT ? prepared execute")->ThreadRange(1, MAX_THREAD)->UseRealTime();
+#ifndef MYSQL
+static void BM_PREPARED_EXECUTE_SERVER(benchmark::State& state) {
+  prepared_execute_loop(state, "?useServerPrepStmts=true");
+}
+
+BENCHMARK(BM_PREPARED_EXECUTE_SERVER)->Name(TYPE + " SELECT ? prepared execute - srv prepared")->ThreadRange(1, MAX_THREAD)->UseRealTime();
+#endif
+
+void do_1000_params(benchmark::State& state, sql::PreparedStatement* prep_stmt) {
+     try {
          for (int i=1; i<=1000; i++) {
             prep_stmt->setInt(i, i);
          }
 
          // Execute query
          prep_stmt->execute();
-         delete prep_stmt;
     } catch(sql::SQLException& e){
         state.SkipWithError(e.what());
     }
@@ -264,12 +387,16 @@ void do_1000_params(benchmark::State& state, sql::Connection* conn) {
 
 static void BM_DO_1000_PARAMS(benchmark::State& state) {
   sql::Connection *conn = connect("");
+  std::unique_ptr<sql::PreparedStatement> prep_stmt(conn->prepareStatement(
+      "DO ?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?"
+  ));
   int numOperation = 0;
   for (auto _ : state) {
-    do_1000_params(state, conn);
+    do_1000_params(state, prep_stmt.get());
     numOperation++;
   }
   state.counters[OPERATION_PER_SECOND_LABEL] = benchmark::Counter(numOperation, benchmark::Counter::kIsRate);
+  prep_stmt.reset();
   delete conn;
 }
 
@@ -302,17 +429,8 @@ BENCHMARK(BM_DO_1000_PARAMS)->Name(TYPE + " DO 1000 params")->ThreadRange(1, MAX
       delete conn;
     }
 
-    void insert_batch_with_prepare(benchmark::State& state, sql::Connection* conn) {
-      std::string query = "INSERT INTO perfTestTextBatch(t0) VALUES (?)";
-      int rc;
-      std::string randomStringVal = randomString(100);
-
+    void insert_batch(benchmark::State& state, sql::PreparedStatement* prep_stmt, const std::string& randomStringVal) {
       try {
-        sql::PreparedStatement *prep_stmt;
-        sql::ResultSet *res;
-
-        // Create a new Statement
-        prep_stmt = conn->prepareStatement(query);
         for (int i = 0; i < 100; i++) {
           prep_stmt->setString(1, randomStringVal);
           prep_stmt->addBatch();
@@ -320,35 +438,187 @@ BENCHMARK(BM_DO_1000_PARAMS)->Name(TYPE + " DO 1000 params")->ThreadRange(1, MAX
 
         // Execute query
         prep_stmt->executeBatch();
-        delete prep_stmt;
       } catch(sql::SQLException& e){
         state.SkipWithError(e.what());
       }
     }
 
-    static void BM_INSERT_BATCH_CLIENT_REWRITE(benchmark::State& state) {
-      sql::Connection *conn = connect("?rewriteBatchedStatements=true");
+    static void insert_batch_loop(benchmark::State& state, const std::string& options) {
+      sql::Connection *conn = connect(options);
+      std::unique_ptr<sql::PreparedStatement> prep_stmt(conn->prepareStatement("INSERT INTO perfTestTextBatch(t0) VALUES (?)"));
+      std::string randomStringVal = randomString(100);
       int numOperation = 0;
       for (auto _ : state) {
-        insert_batch_with_prepare(state, conn);
+        insert_batch(state, prep_stmt.get(), randomStringVal);
         numOperation++;
       }
       state.counters[OPERATION_PER_SECOND_LABEL] = benchmark::Counter(numOperation, benchmark::Counter::kIsRate);
+      prep_stmt.reset();
       delete conn;
     }
 
+    static void BM_INSERT_BATCH_CLIENT_REWRITE(benchmark::State& state) {
+      insert_batch_loop(state, "?rewriteBatchedStatements=true");
+    }
+
     static void BM_INSERT_BATCH_WITH_PREPARE(benchmark::State& state) {
-      sql::Connection *conn = connect("?useServerPrepStmts=true");
+      insert_batch_loop(state, "?useServerPrepStmts=true");
+    }
+
+    static void BM_INSERT_BATCH_MULTI_SEND(benchmark::State& state) {
+      insert_batch_loop(state, "?useServerPrepStmts=true&useBatchMultiSend=true");
+    }
+
+    static void BM_INSERT_BATCH_BULK(benchmark::State& state) {
+      insert_batch_loop(state, "?useServerPrepStmts=true&useBulkStmts=true");
+    }
+    BENCHMARK(BM_INSERT_BATCH_WITH_PREPARE)->Name(TYPE + " insert batch looping execute")->ThreadRange(1, MAX_THREAD)->UseRealTime()->Setup(setup_insert_batch);
+    BENCHMARK(BM_INSERT_BATCH_CLIENT_REWRITE)->Name(TYPE + " insert batch client rewrite")->ThreadRange(1, MAX_THREAD)->UseRealTime()->Setup(setup_insert_batch);
+    BENCHMARK(BM_INSERT_BATCH_MULTI_SEND)->Name(TYPE + " insert batch multi-send")->ThreadRange(1, MAX_THREAD)->UseRealTime()->Setup(setup_insert_batch);
+    BENCHMARK(BM_INSERT_BATCH_BULK)->Name(TYPE + " insert batch bulk")->ThreadRange(1, MAX_THREAD)->UseRealTime()->Setup(setup_insert_batch);
+#endif
+
+#define BLOB_SIZE (1024*1024)
+
+static void setup_blob(const benchmark::State& state) {
+  sql::Connection *conn = connect("");
+  std::unique_ptr<sql::Statement> stmt(conn->createStatement());
+  stmt->executeUpdate("DROP TABLE IF EXISTS perfTestBlob");
+  stmt->executeUpdate("CREATE TABLE perfTestBlob (id int NOT NULL AUTO_INCREMENT, b LONGBLOB, PRIMARY KEY (id))");
+  stmt->executeUpdate("INSERT INTO perfTestBlob(b) VALUES (REPEAT('a', " + std::to_string(BLOB_SIZE) + "))");
+  stmt.reset();
+  delete conn;
+}
+
+// Each thread updates its own row, not to wait for others' locks
+static void BM_BLOB_WRITE(benchmark::State& state) {
+  sql::Connection *conn = connect("");
+  std::unique_ptr<sql::PreparedStatement> prep_stmt(conn->prepareStatement("INSERT INTO perfTestBlob(b) VALUES (?)"));
+  std::unique_ptr<sql::Statement> stmt(conn->createStatement());
+  std::string value(BLOB_SIZE, 'b');
+  int numOperation = 0;
+  for (auto _ : state) {
+    try {
+      std::istringstream blob(value);
+      prep_stmt->setBlob(1, &blob);
+      prep_stmt->executeUpdate();
+    } catch(sql::SQLException& e){
+      state.SkipWithError(e.what());
+    }
+    numOperation++;
+  }
+  state.counters[OPERATION_PER_SECOND_LABEL] = benchmark::Counter(numOperation, benchmark::Counter::kIsRate);
+  state.SetBytesProcessed(static_cast<int64_t>(numOperation) * BLOB_SIZE);
+  try {
+    stmt->executeUpdate("DELETE FROM perfTestBlob WHERE id > 1");
+  } catch(sql::SQLException&) {
+  }
+  prep_stmt.reset();
+  stmt.reset();
+  delete conn;
+}
+
+static void BM_BLOB_READ(benchmark::State& state) {
+  sql::Connection *conn = connect("");
+  std::unique_ptr<sql::PreparedStatement> prep_stmt(conn->prepareStatement("SELECT b FROM perfTestBlob WHERE id = 1"));
+  std::vector<char> buffer(BLOB_SIZE);
+  int numOperation = 0;
+  for (auto _ : state) {
+    try {
+      std::unique_ptr<sql::ResultSet> res(prep_stmt->executeQuery());
+      while (res->next()) {
+        std::unique_ptr<std::istream> blob(res->getBlob(1));
+        blob->read(buffer.data(), buffer.size());
+        benchmark::DoNotOptimize(blob->gcount());
+      }
+    } catch(sql::SQLException& e){
+      state.SkipWithError(e.what());
+    }
+    numOperation++;
+  }
+  state.counters[OPERATION_PER_SECOND_LABEL] = benchmark::Counter(numOperation, benchmark::Counter::kIsRate);
+  state.SetBytesProcessed(static_cast<int64_t>(numOperation) * BLOB_SIZE);
+  prep_stmt.reset();
+  delete conn;
+}
+
+BENCHMARK(BM_BLOB_WRITE)->Name(TYPE + " BLOB write 1MB")->ThreadRange(1, MAX_THREAD)->UseRealTime()->Setup(setup_blob);
+BENCHMARK(BM_BLOB_READ)->Name(TYPE + " BLOB read 1MB")->ThreadRange(1, MAX_THREAD)->UseRealTime()->Setup(setup_blob);
+
+// Columns of the table via DatabaseMetaData, and reading of ResultSetMetaData of 100 columns result
+static void BM_METADATA_GET_COLUMNS(benchmark::State& state) {
+  sql::Connection *conn = connect("");
+  sql::DatabaseMetaData *dbmd = conn->getMetaData();
+  int numOperation = 0;
+  for (auto _ : state) {
+    try {
+      std::unique_ptr<sql::ResultSet> res(dbmd->getColumns(DB_DATABASE, "", "test100", "%"));
+      while (res->next()) {
+        benchmark::DoNotOptimize(res->getString(4));
+      }
+    } catch(sql::SQLException& e){
+      state.SkipWithError(e.what());
+    }
+    numOperation++;
+  }
+  state.counters[OPERATION_PER_SECOND_LABEL] = benchmark::Counter(numOperation, benchmark::Counter::kIsRate);
+  delete conn;
+}
+
+static void BM_METADATA_RESULTSET(benchmark::State& state) {
+  sql::Connection *conn = connect("");
+  std::unique_ptr<sql::Statement> stmt(conn->createStatement());
+  int numOperation = 0;
+  for (auto _ : state) {
+    try {
+      std::unique_ptr<sql::ResultSet> res(stmt->executeQuery("SELECT * FROM test100 LIMIT 0"));
+      sql::ResultSetMetaData *md = res->getMetaData();
+      for (unsigned int i = 1; i <= md->getColumnCount(); i++) {
+        benchmark::DoNotOptimize(md->getColumnName(i));
+        benchmark::DoNotOptimize(md->getColumnType(i));
+      }
+    } catch(sql::SQLException& e){
+      state.SkipWithError(e.what());
+    }
+    numOperation++;
+  }
+  state.counters[OPERATION_PER_SECOND_LABEL] = benchmark::Counter(numOperation, benchmark::Counter::kIsRate);
+  stmt.reset();
+  delete conn;
+}
+
+BENCHMARK(BM_METADATA_GET_COLUMNS)->Name(TYPE + " metadata getColumns")->ThreadRange(1, MAX_THREAD)->UseRealTime()->Setup(setup_select_100_cols);
+BENCHMARK(BM_METADATA_RESULTSET)->Name(TYPE + " metadata of 100 columns result")->ThreadRange(1, MAX_THREAD)->UseRealTime()->Setup(setup_select_100_cols);
+
+// Full connection establishment and closing, without the pool
+static void BM_CONNECT(benchmark::State& state) {
+  int numOperation = 0;
+  for (auto _ : state) {
+    sql::Connection *conn = connect("");
+    delete conn;
+    numOperation++;
+  }
+  state.counters[OPERATION_PER_SECOND_LABEL] = benchmark::Counter(numOperation, benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(BM_CONNECT)->Name(TYPE + " connect + close")->ThreadRange(1, MAX_THREAD)->UseRealTime();
+
+#ifndef MYSQL
+    // Connection checkout/return from the pool under contention. All threads share one pool, that is smaller than
+    // the number of threads at the top of the range
+    static void BM_POOL_GET_CONNECTION(benchmark::State& state) {
       int numOperation = 0;
       for (auto _ : state) {
-        insert_batch_with_prepare(state, conn);
+        sql::Connection *conn = connect("?pool=true&minPoolSize=4&maxPoolSize=16");
+        std::unique_ptr<sql::Statement> stmt(conn->createStatement());
+        do_1(state, stmt.get());
+        stmt.reset();
+        delete conn;
         numOperation++;
       }
       state.counters[OPERATION_PER_SECOND_LABEL] = benchmark::Counter(numOperation, benchmark::Counter::kIsRate);
-      delete conn;
     }
-    BENCHMARK(BM_INSERT_BATCH_WITH_PREPARE)->Name(TYPE + " insert batch looping execute")->ThreadRange(1, MAX_THREAD)->UseRealTime()->Setup(setup_insert_batch);
-    BENCHMARK(BM_INSERT_BATCH_CLIENT_REWRITE)->Name(TYPE + " insert batch client rewrite")->ThreadRange(1, MAX_THREAD)->UseRealTime()->Setup(setup_insert_batch);
+    BENCHMARK(BM_POOL_GET_CONNECTION)->Name(TYPE + " pool get connection + DO 1")->ThreadRange(1, MAX_POOL_THREAD)->UseRealTime();
 #endif
 
 BENCHMARK_MAIN();
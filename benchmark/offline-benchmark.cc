@@ -0,0 +1,336 @@
+// Micro-benchmarks of the connector internals, that do not need a server: decoding of text protocol rows, client
+// side prepare parsing, parameters encoding and SQLString operations. Rows are given to the decoder in the form the
+// connector keeps cached results, i.e. vector of column values, so the results are deterministic and can be compared
+// between builds
+
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Consts.h"
+#include "ColumnType.h"
+#include "ColumnDefinition.h"
+#include "options/DefaultOptions.h"
+#include "protocol/capi/TextRowProtocolCapi.h"
+#include "util/ClientPrepareResult.h"
+#include "parameters/IntParameter.h"
+#include "parameters/LongParameter.h"
+#include "parameters/DoubleParameter.h"
+#include "parameters/StringParameter.h"
+#include "parameters/ByteArrayParameter.h"
+
+using namespace sql;
+using namespace sql::mariadb;
+
+#define ROW_COUNT 1000
+
+// Column values are stored with the terminating null, as the connector does for cached rows
+static sql::bytes wrap(const std::string& value) {
+  return sql::bytes(value.c_str(), value.length() + 1);
+}
+
+struct TextRows
+{
+  std::vector<Shared::ColumnDefinition> columns;
+  std::vector<std::string> values;
+  std::vector<std::vector<sql::bytes>> rows;
+
+  TextRows()
+  {
+    columns.emplace_back(ColumnDefinition::create("i", ColumnType::INTEGER));
+    columns.emplace_back(ColumnDefinition::create("l", ColumnType::BIGINT));
+    columns.emplace_back(ColumnDefinition::create("d", ColumnType::DOUBLE));
+    columns.emplace_back(ColumnDefinition::create("s", ColumnType::VARCHAR));
+    columns.emplace_back(ColumnDefinition::create("dt", ColumnType::DATETIME));
+    columns.emplace_back(ColumnDefinition::create("dec", ColumnType::DECIMAL));
+
+    values.reserve(ROW_COUNT*columns.size());
+    for (int i= 0; i < ROW_COUNT; ++i) {
+      values.push_back(std::to_string(i));
+      values.push_back(std::to_string(static_cast<int64_t>(i)*1000000007));
+      values.push_back(std::to_string(i/7.0));
+      values.push_back("abcdefghijabcdefghijabcdefghij" + std::to_string(i));
+      values.push_back("2023-01-15 12:34:56.123456");
+      values.push_back("12345.6789");
+    }
+    rows.resize(ROW_COUNT);
+    for (int i= 0; i < ROW_COUNT; ++i) {
+      for (std::size_t j= 0; j < columns.size(); ++j) {
+        rows[i].push_back(wrap(values[i*columns.size() + j]));
+      }
+    }
+  }
+};
+
+
+static void BM_TEXT_ROW_DECODE(benchmark::State& state) {
+  TextRows data;
+  Shared::Options options(DefaultOptions::defaultValues(HaMode::NONE));
+  capi::TextRowProtocolCapi row(0, options, nullptr);
+  int64_t sum= 0;
+
+  for (auto _ : state) {
+    for (auto& rowData : data.rows) {
+      row.resetRow(rowData);
+      row.setPosition(0);
+      sum+= row.getInternalInt(data.columns[0].get());
+      row.setPosition(1);
+      sum+= row.getInternalLong(data.columns[1].get());
+      row.setPosition(2);
+      benchmark::DoNotOptimize(row.getInternalDouble(data.columns[2].get()));
+      row.setPosition(3);
+      benchmark::DoNotOptimize(row.getInternalString(data.columns[3].get()));
+      row.setPosition(4);
+      benchmark::DoNotOptimize(row.getInternalTimestamp(data.columns[4].get()));
+      row.setPosition(5);
+      benchmark::DoNotOptimize(row.getInternalBigDecimal(data.columns[5].get()));
+    }
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations()*ROW_COUNT);
+}
+
+BENCHMARK(BM_TEXT_ROW_DECODE)->Name("text row decode (int, bigint, double, varchar, datetime, decimal)");
+
+static void BM_TEXT_ROW_GET_INT(benchmark::State& state) {
+  TextRows data;
+  Shared::Options options(DefaultOptions::defaultValues(HaMode::NONE));
+  capi::TextRowProtocolCapi row(0, options, nullptr);
+  int64_t sum= 0;
+
+  for (auto _ : state) {
+    for (auto& rowData : data.rows) {
+      row.resetRow(rowData);
+      row.setPosition(0);
+      sum+= row.getInternalInt(data.columns[0].get());
+    }
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations()*ROW_COUNT);
+}
+
+BENCHMARK(BM_TEXT_ROW_GET_INT)->Name("text row decode int");
+
+static void BM_TEXT_ROW_GET_TIMESTAMP(benchmark::State& state) {
+  TextRows data;
+  Shared::Options options(DefaultOptions::defaultValues(HaMode::NONE));
+  capi::TextRowProtocolCapi row(0, options, nullptr);
+
+  for (auto _ : state) {
+    for (auto& rowData : data.rows) {
+      row.resetRow(rowData);
+      row.setPosition(4);
+      benchmark::DoNotOptimize(row.getInternalTimestamp(data.columns[4].get()));
+    }
+  }
+  state.SetItemsProcessed(state.iterations()*ROW_COUNT);
+}
+
+static void BM_TEXT_ROW_GET_DATETIME(benchmark::State& state) {
+  TextRows data;
+  Shared::Options options(DefaultOptions::defaultValues(HaMode::NONE));
+  capi::TextRowProtocolCapi row(0, options, nullptr);
+  DateTime value;
+
+  for (auto _ : state) {
+    for (auto& rowData : data.rows) {
+      row.resetRow(rowData);
+      row.setPosition(4);
+      benchmark::DoNotOptimize(row.getInternalDateTime(data.columns[4].get(), value));
+    }
+  }
+  state.SetItemsProcessed(state.iterations()*ROW_COUNT);
+}
+
+BENCHMARK(BM_TEXT_ROW_GET_TIMESTAMP)->Name("text row decode datetime");
+BENCHMARK(BM_TEXT_ROW_GET_DATETIME)->Name("text row decode datetime into DateTime");
+
+static void BM_TEXT_ROW_GET_BIGDECIMAL(benchmark::State& state) {
+  TextRows data;
+  Shared::Options options(DefaultOptions::defaultValues(HaMode::NONE));
+  capi::TextRowProtocolCapi row(0, options, nullptr);
+
+  for (auto _ : state) {
+    for (auto& rowData : data.rows) {
+      row.resetRow(rowData);
+      row.setPosition(5);
+      benchmark::DoNotOptimize(row.getInternalBigDecimal(data.columns[5].get()));
+    }
+  }
+  state.SetItemsProcessed(state.iterations()*ROW_COUNT);
+}
+
+static void BM_TEXT_ROW_GET_DECIMAL(benchmark::State& state) {
+  TextRows data;
+  Shared::Options options(DefaultOptions::defaultValues(HaMode::NONE));
+  capi::TextRowProtocolCapi row(0, options, nullptr);
+  Decimal value;
+
+  for (auto _ : state) {
+    for (auto& rowData : data.rows) {
+      row.resetRow(rowData);
+      row.setPosition(5);
+      benchmark::DoNotOptimize(row.getInternalDecimal(data.columns[5].get(), value));
+    }
+  }
+  state.SetItemsProcessed(state.iterations()*ROW_COUNT);
+}
+
+BENCHMARK(BM_TEXT_ROW_GET_BIGDECIMAL)->Name("text row decode decimal");
+BENCHMARK(BM_TEXT_ROW_GET_DECIMAL)->Name("text row decode decimal into Decimal");
+
+
+static const SQLString insertQuery("INSERT INTO perfTest(id, name, val, created) /* comment ? */ VALUES (?, ?, 'it''s ?', ?)");
+
+static void BM_CLIENT_PREPARE_PARSE(benchmark::State& state) {
+  for (auto _ : state) {
+    std::unique_ptr<ClientPrepareResult> result(ClientPrepareResult::parameterParts(insertQuery, false));
+    benchmark::DoNotOptimize(result->getParamCount());
+  }
+}
+
+static void BM_CLIENT_PREPARE_REWRITABLE_PARSE(benchmark::State& state) {
+  for (auto _ : state) {
+    std::unique_ptr<ClientPrepareResult> result(ClientPrepareResult::rewritableParts(insertQuery, false));
+    benchmark::DoNotOptimize(result->getParamCount());
+  }
+}
+
+static void BM_QUERY_DIGEST(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ClientPrepareResult::digest(insertQuery, false));
+  }
+}
+
+BENCHMARK(BM_CLIENT_PREPARE_PARSE)->Name("client prepare parse");
+BENCHMARK(BM_CLIENT_PREPARE_REWRITABLE_PARSE)->Name("client prepare rewritable parse");
+BENCHMARK(BM_QUERY_DIGEST)->Name("query digest");
+
+
+static void parameter_write(benchmark::State& state, ParameterHolder& parameter) {
+  SQLString query;
+  for (auto _ : state) {
+    query.clear();
+    parameter.writeTo(query);
+    benchmark::DoNotOptimize(query.c_str());
+  }
+}
+
+static void BM_PARAMETER_WRITE_INT(benchmark::State& state) {
+  IntParameter parameter(1234567);
+  parameter_write(state, parameter);
+}
+
+static void BM_PARAMETER_WRITE_LONG(benchmark::State& state) {
+  LongParameter parameter(1234567890123456789LL);
+  parameter_write(state, parameter);
+}
+
+static void BM_PARAMETER_WRITE_DOUBLE(benchmark::State& state) {
+  DoubleParameter parameter(12345.6789);
+  parameter_write(state, parameter);
+}
+
+static void BM_PARAMETER_WRITE_STRING(benchmark::State& state) {
+  StringParameter parameter("a string value, that has 'quotes', \\backslashes\\ and has to be escaped", false);
+  parameter_write(state, parameter);
+}
+
+// JSON document of ~4k, that has only few characters to escape
+static std::string jsonValue() {
+  std::string value("{\"items\": [");
+  while (value.length() < 4096) {
+    value.append("{\"id\": 12345, \"name\": \"item's name\", \"tags\": [\"first\", \"second\", \"third\"]}, ");
+  }
+  return value.append("{}]}");
+}
+
+static void BM_PARAMETER_WRITE_JSON(benchmark::State& state) {
+  StringParameter parameter(jsonValue(), false);
+  parameter_write(state, parameter);
+}
+
+static void BM_PARAMETER_WRITE_JSON_NO_BACKSLASH_ESCAPES(benchmark::State& state) {
+  StringParameter parameter(jsonValue(), true);
+  parameter_write(state, parameter);
+}
+
+static void BM_PARAMETER_WRITE_BYTES(benchmark::State& state) {
+  std::string value(1024, '\x01');
+  sql::bytes bytes(value.c_str(), value.length());
+  ByteArrayParameter parameter(bytes, false);
+  parameter_write(state, parameter);
+}
+
+BENCHMARK(BM_PARAMETER_WRITE_INT)->Name("parameter write int");
+BENCHMARK(BM_PARAMETER_WRITE_LONG)->Name("parameter write bigint");
+BENCHMARK(BM_PARAMETER_WRITE_DOUBLE)->Name("parameter write double");
+BENCHMARK(BM_PARAMETER_WRITE_STRING)->Name("parameter write string with escaping");
+BENCHMARK(BM_PARAMETER_WRITE_JSON)->Name("parameter write 4k json");
+BENCHMARK(BM_PARAMETER_WRITE_JSON_NO_BACKSLASH_ESCAPES)->Name("parameter write 4k json, no backslash escapes");
+BENCHMARK(BM_PARAMETER_WRITE_BYTES)->Name("parameter write 1k bytes");
+
+// Text of the query with parameters, as it is assembled for the client side prepared statement execution
+static void BM_QUERY_ASSEMBLE(benchmark::State& state) {
+  std::unique_ptr<ClientPrepareResult> prepareResult(ClientPrepareResult::parameterParts(insertQuery, false));
+  std::vector<std::unique_ptr<ParameterHolder>> parameters;
+  parameters.emplace_back(new IntParameter(1));
+  parameters.emplace_back(new StringParameter("name", false));
+  parameters.emplace_back(new StringParameter("2023-01-15 12:34:56", false));
+  SQLString query;
+
+  for (auto _ : state) {
+    const std::vector<SQLString>& queryParts= prepareResult->getQueryParts();
+    query.clear();
+    query.append(queryParts[0]);
+    for (std::size_t i= 0; i < parameters.size(); ++i) {
+      parameters[i]->writeTo(query);
+      query.append(queryParts[i + 1]);
+    }
+    benchmark::DoNotOptimize(query.c_str());
+  }
+}
+
+BENCHMARK(BM_QUERY_ASSEMBLE)->Name("client prepared query assemble");
+
+
+static void BM_SQLSTRING_COPY(benchmark::State& state) {
+  SQLString source("select seq, 'abcdefghijabcdefghijabcdefghijaa' from seq_1_to_1000");
+  for (auto _ : state) {
+    SQLString copy(source);
+    benchmark::DoNotOptimize(copy.c_str());
+  }
+}
+
+static void BM_SQLSTRING_APPEND(benchmark::State& state) {
+  for (auto _ : state) {
+    SQLString str;
+    for (int i= 0; i < 16; ++i) {
+      str.append("abcdefgh").append(',');
+    }
+    benchmark::DoNotOptimize(str.c_str());
+  }
+}
+
+static void BM_SQLSTRING_TO_LOWER_CASE(benchmark::State& state) {
+  SQLString source("SELECT SEQ, 'ABCDEFGHIJABCDEFGHIJABCDEFGHIJAA' FROM SEQ_1_TO_1000");
+  for (auto _ : state) {
+    SQLString str(source);
+    benchmark::DoNotOptimize(str.toLowerCase().c_str());
+  }
+}
+
+static void BM_SQLSTRING_CASE_COMPARE(benchmark::State& state) {
+  SQLString source("useServerPrepStmts"), other("USESERVERPREPSTMTS");
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(source.caseCompare(other));
+  }
+}
+
+BENCHMARK(BM_SQLSTRING_COPY)->Name("SQLString copy");
+BENCHMARK(BM_SQLSTRING_APPEND)->Name("SQLString append");
+BENCHMARK(BM_SQLSTRING_TO_LOWER_CASE)->Name("SQLString toLowerCase");
+BENCHMARK(BM_SQLSTRING_CASE_COMPARE)->Name("SQLString caseCompare");
+
+BENCHMARK_MAIN();
@@ -0,0 +1,213 @@
+// Mixed OLTP workload modelled after sysbench oltp_read_write: each transaction runs 10 point selects, 4 range scans of
+// 100 rows (plain, SUM, ORDER BY and DISTINCT), an update by the indexed and by the non-indexed column, a delete and an
+// insert of the same row, and commits. Unlike SELECT 1 it shows the interaction of round trips, result allocation and
+// server side locks, that sets the throughput of real applications.
+// Arguments are "prepared" - server side prepared statements, prepared once per connection, or text queries, and "pool" -
+// the connection is taken from the pool for each transaction, or each thread keeps its own connection. The table size is
+// set by TEST_OLTP_TABLE_SIZE, default 10000 rows. Transaction latency percentiles are reported as counters, and are in
+// the JSON output with the other counters
+
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+
+#include "benchmark-util.h"
+
+const int32_t TABLE_SIZE = std::max(100, atoi(GetEnvironmentVariableOrDefault("TEST_OLTP_TABLE_SIZE", "10000").c_str()));
+#define POINT_SELECTS 10
+#define RANGE_SIZE 100
+// Number of the queries in one transaction, including COMMIT
+#define QUERIES_PER_TRANSACTION (POINT_SELECTS + 4 + 4 + 1)
+
+static void setup_oltp_table(const benchmark::State& state) {
+  try {
+    std::unique_ptr<sql::Connection> conn(connectToServer(""));
+    std::unique_ptr<sql::Statement> stmt(conn->createStatement());
+    stmt->executeUpdate("DROP TABLE IF EXISTS sbtest1");
+    stmt->executeUpdate("CREATE TABLE sbtest1 (id INT NOT NULL AUTO_INCREMENT, k INT NOT NULL DEFAULT 0,"
+      "c CHAR(120) NOT NULL DEFAULT '', pad CHAR(60) NOT NULL DEFAULT '', PRIMARY KEY (id), KEY k_1 (k)) ENGINE=InnoDB");
+
+    std::unique_ptr<sql::PreparedStatement> insert(conn->prepareStatement("INSERT INTO sbtest1(k, c, pad) VALUES (?,?,?)"));
+    std::minstd_rand random(1);
+    std::uniform_int_distribution<int32_t> key(1, TABLE_SIZE);
+    conn->setAutoCommit(false);
+    for (int32_t i = 0; i < TABLE_SIZE; ++i) {
+      insert->setInt(1, key(random));
+      insert->setString(2, std::string(119, static_cast<char>('a' + i % 26)));
+      insert->setString(3, std::string(59, static_cast<char>('z' - i % 26)));
+      insert->addBatch();
+      if (i % 1000 == 999) {
+        insert->executeBatch();
+      }
+    }
+    insert->executeBatch();
+    conn->commit();
+  }
+  catch (sql::SQLException& e) {
+    std::cerr << "Could not create the OLTP table: " << e.what() << std::endl;
+    exit(1);
+  }
+}
+
+// Queries of one transaction. The text variant formats the values into the query, like applications without prepared
+// statements do
+class OltpTransaction
+{
+  sql::Connection* conn;
+  const bool prepared;
+  std::unique_ptr<sql::Statement> stmt;
+  std::unique_ptr<sql::PreparedStatement> pointSelect, simpleRange, sumRange, orderRange, distinctRange;
+  std::unique_ptr<sql::PreparedStatement> indexUpdate, nonIndexUpdate, deleteRow, insertRow;
+  std::minstd_rand& random;
+  std::uniform_int_distribution<int32_t> id;
+
+  void readAll(sql::ResultSet* res)
+  {
+    std::unique_ptr<sql::ResultSet> guard(res);
+    while (res->next()) {
+      benchmark::DoNotOptimize(res->getString(1));
+    }
+  }
+
+  void range(const std::unique_ptr<sql::PreparedStatement>& ps, const char* select, const char* tail)
+  {
+    int32_t from = id(random);
+    if (prepared) {
+      ps->setInt(1, from);
+      ps->setInt(2, from + RANGE_SIZE - 1);
+      readAll(ps->executeQuery());
+    }
+    else {
+      std::ostringstream query;
+      query << select << " FROM sbtest1 WHERE id BETWEEN " << from << " AND " << from + RANGE_SIZE - 1 << tail;
+      readAll(stmt->executeQuery(query.str()));
+    }
+  }
+
+  void update(const std::unique_ptr<sql::PreparedStatement>& ps, const char* text, int32_t rowId)
+  {
+    if (prepared) {
+      ps->setInt(1, rowId);
+      ps->executeUpdate();
+    }
+    else {
+      stmt->executeUpdate(text + std::to_string(rowId));
+    }
+  }
+
+public:
+  OltpTransaction(sql::Connection* _conn, bool _prepared, std::minstd_rand& _random)
+    : conn(_conn)
+    , prepared(_prepared)
+    , stmt(_conn->createStatement())
+    , random(_random)
+    , id(1, TABLE_SIZE - RANGE_SIZE)
+  {
+    if (prepared) {
+      pointSelect.reset(conn->prepareStatement("SELECT c FROM sbtest1 WHERE id=?"));
+      simpleRange.reset(conn->prepareStatement("SELECT c FROM sbtest1 WHERE id BETWEEN ? AND ?"));
+      sumRange.reset(conn->prepareStatement("SELECT SUM(k) FROM sbtest1 WHERE id BETWEEN ? AND ?"));
+      orderRange.reset(conn->prepareStatement("SELECT c FROM sbtest1 WHERE id BETWEEN ? AND ? ORDER BY c"));
+      distinctRange.reset(conn->prepareStatement("SELECT DISTINCT c FROM sbtest1 WHERE id BETWEEN ? AND ? ORDER BY c"));
+      indexUpdate.reset(conn->prepareStatement("UPDATE sbtest1 SET k=k+1 WHERE id=?"));
+      nonIndexUpdate.reset(conn->prepareStatement("UPDATE sbtest1 SET c=REVERSE(c) WHERE id=?"));
+      deleteRow.reset(conn->prepareStatement("DELETE FROM sbtest1 WHERE id=?"));
+      insertRow.reset(conn->prepareStatement("INSERT INTO sbtest1(id, k, c, pad) VALUES (?, 0, 'c', 'pad')"));
+    }
+    conn->setAutoCommit(false);
+  }
+
+  void run()
+  {
+    try {
+      for (int i = 0; i < POINT_SELECTS; ++i) {
+        int32_t rowId = id(random);
+        if (prepared) {
+          pointSelect->setInt(1, rowId);
+          readAll(pointSelect->executeQuery());
+        }
+        else {
+          readAll(stmt->executeQuery("SELECT c FROM sbtest1 WHERE id=" + std::to_string(rowId)));
+        }
+      }
+      range(simpleRange, "SELECT c", "");
+      range(sumRange, "SELECT SUM(k)", "");
+      range(orderRange, "SELECT c", " ORDER BY c");
+      range(distinctRange, "SELECT DISTINCT c", " ORDER BY c");
+
+      update(indexUpdate, "UPDATE sbtest1 SET k=k+1 WHERE id=", id(random));
+      update(nonIndexUpdate, "UPDATE sbtest1 SET c=REVERSE(c) WHERE id=", id(random));
+      // The row is deleted and inserted back, so that the table size stays the same
+      int32_t rowId = id(random);
+      update(deleteRow, "DELETE FROM sbtest1 WHERE id=", rowId);
+      if (prepared) {
+        insertRow->setInt(1, rowId);
+        insertRow->executeUpdate();
+      }
+      else {
+        stmt->executeUpdate("INSERT INTO sbtest1(id, k, c, pad) VALUES (" + std::to_string(rowId) + ", 0, 'c', 'pad')");
+      }
+      conn->commit();
+    }
+    catch (sql::SQLException&) {
+      // Deadlocks and lock wait timeouts are part of the workload, the transaction is counted as failed
+      conn->rollback();
+      throw;
+    }
+  }
+};
+
+static void BM_OLTP_READ_WRITE(benchmark::State& state) {
+  const bool prepared = state.range(0) != 0, pooled = state.range(1) != 0;
+  std::string options(prepared ? "?useServerPrepStmts=true&cachePrepStmts=true" : "?useServerPrepStmts=false");
+  if (pooled) {
+    options.append("&pool=true&minPoolSize=" + std::to_string(MAX_THREAD) + "&maxPoolSize=" + std::to_string(MAX_THREAD));
+  }
+  std::minstd_rand random(static_cast<uint32_t>(state.thread_index() + 1));
+  LatencySamples latency;
+  int numOperation = 0, numFailed = 0;
+  std::unique_ptr<sql::Connection> conn;
+  std::unique_ptr<OltpTransaction> transaction;
+
+  try {
+    if (!pooled) {
+      conn.reset(connectToServer(options));
+      transaction.reset(new OltpTransaction(conn.get(), prepared, random));
+    }
+    for (auto _ : state) {
+      auto start = std::chrono::steady_clock::now();
+      if (pooled) {
+        // Returned to the pool by the close in the destructor. Statements are prepared again on the pooled connection,
+        // what the prepared statements cache makes cheap after the first use of the connection
+        transaction.reset();
+        conn.reset(connectToServer(options));
+        transaction.reset(new OltpTransaction(conn.get(), prepared, random));
+      }
+      try {
+        transaction->run();
+        latency.addSince(start);
+        numOperation++;
+      }
+      catch (sql::SQLException&) {
+        numFailed++;
+      }
+    }
+  }
+  catch (sql::SQLException& e) {
+    state.SkipWithError(e.what());
+  }
+  transaction.reset();
+  conn.reset();
+
+  state.counters["transactions per second"] = benchmark::Counter(numOperation, benchmark::Counter::kIsRate);
+  state.counters["queries per second"] = benchmark::Counter(static_cast<double>(numOperation) * QUERIES_PER_TRANSACTION,
+    benchmark::Counter::kIsRate);
+  state.counters["failed transactions"] = numFailed;
+  latency.report(state);
+}
+
+BENCHMARK(BM_OLTP_READ_WRITE)->Name("MariaDB OLTP read/write")->ArgNames({"prepared", "pool"})
+  ->ArgsProduct({{0, 1}, {0, 1}})->ThreadRange(1, MAX_THREAD)->UseRealTime()->Setup(setup_oltp_table);
+
+BENCHMARK_MAIN();
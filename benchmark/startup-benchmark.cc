@@ -0,0 +1,40 @@
+// Startup cost of the connector for short-lived processes, that issue few queries: CPU time spent before main(), i.e.
+// by the loader and the static initializers of the library, and the time of the first preparation of connection
+// parameters, which builds the options tables on the first use. No server is needed. The numbers are only
+// meaningful for a fresh process, so the benchmark is a plain program, that is run several times
+
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <memory>
+
+#include "conncpp.hpp"
+
+static double microsSince(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main()
+{
+  // Static initializers have run, and CPU time counts from the process start
+  const double beforeMain= 1000000.0*std::clock()/CLOCKS_PER_SEC;
+  sql::Properties props{{"user", "root"}, {"useTls", "false"}};
+
+  auto start= std::chrono::steady_clock::now();
+  sql::Driver* driver= sql::mariadb::get_driver_instance();
+  std::unique_ptr<sql::ConnectionDescriptor> first(driver->prepareConnection("jdbc:mariadb://localhost:3306/test", props));
+  const double firstUse= microsSince(start);
+
+  start= std::chrono::steady_clock::now();
+  std::unique_ptr<sql::ConnectionDescriptor> second(driver->prepareConnection("jdbc:mariadb://localhost:3306/test", props));
+  const double secondUse= microsSince(start);
+
+  if (!first || !second) {
+    std::cerr << "Connection url has not been accepted" << std::endl;
+    return 1;
+  }
+  std::cout << "CPU before main(us): " << beforeMain << ", first prepareConnection(us): " << firstUse
+    << ", second prepareConnection(us): " << secondUse << std::endl;
+  return 0;
+}
@@ -39,6 +39,25 @@ ENDIF()
 
 OPTION(WITH_SSL "Enables use of TLS/SSL library" ON)
 OPTION(WITH_UNIT_TESTS "Build test suite" ON)
+OPTION(WITH_BENCHMARK "Build benchmark suite, requires Google Benchmark" OFF)
+# Changes SQLString layout, i.e. ABI. Applications have to be compiled with MARIADB_INLINE_SQLSTRING defined as well
+OPTION(WITH_INLINE_SQLSTRING "Store SQLString data inline, without separate heap allocation" OFF)
+OPTION(WITH_USDT "Compile in USDT(DTrace/SystemTap) static probes, requires sys/sdt.h" OFF)
+
+# Lean profile for the services, that only run queries. It changes defaults of the subsystem options below, explicitly
+# given values of those options still win
+OPTION(WITH_LEAN "Lean build without failover, protocol logging, callable statements, DatabaseMetaData and credential plugins" OFF)
+IF(WITH_LEAN)
+  SET(LEAN_SUBSYSTEM_DEFAULT OFF)
+ELSE()
+  SET(LEAN_SUBSYSTEM_DEFAULT ON)
+ENDIF()
+OPTION(WITH_FAILOVER "Build replication and failover proxies" ${LEAN_SUBSYSTEM_DEFAULT})
+OPTION(WITH_PROTOCOL_LOGGING "Build protocol logging proxy(profileSql and slowQueryThresholdNanos options)" ${LEAN_SUBSYSTEM_DEFAULT})
+OPTION(WITH_CALLABLE_STATEMENTS "Build callable statements, i.e. Connection::prepareCall" ${LEAN_SUBSYSTEM_DEFAULT})
+OPTION(WITH_DATABASE_METADATA "Build DatabaseMetaData, i.e. Connection::getMetaData" ${LEAN_SUBSYSTEM_DEFAULT})
+OPTION(WITH_CREDENTIAL_PLUGINS "Build credential plugin loader(credentialType option)" ${LEAN_SUBSYSTEM_DEFAULT})
+OPTION(WITH_LTO "Build the library with interprocedural(link time) optimization, requires CMake 3.9" OFF)
 
 IF(MINGW)
   OPTION(USE_SYSTEM_INSTALLED_LIB "Use installed in the system C/C library and do not build one" ON)
@@ -55,6 +74,10 @@ ENDIF()
 IF(NOT EXISTS "${CMAKE_CURRENT_SOURCE_DIR}/test/CMakeLists.txt")
   SET(WITH_UNIT_TESTS OFF)
 ENDIF()
+# The test suite covers the whole API, and its fixture uses DatabaseMetaData
+IF(NOT BUILD_TESTS_ONLY AND (NOT WITH_CALLABLE_STATEMENTS OR NOT WITH_DATABASE_METADATA))
+  SET(WITH_UNIT_TESTS OFF)
+ENDIF()
 
 IF(WITH_UNIT_TESTS)
   SET_VALUE(TEST_HOST           "tcp://localhost:3306" "Defines Unit Tests default server")
@@ -28,8 +28,21 @@
 #include "conncpp/DatabaseMetaData.hpp"
 #include "conncpp/ResultSetMetaData.hpp"
 #include "conncpp/Statement.hpp"
+#include "conncpp/AsyncExecution.hpp"
+#include "conncpp/Pipeline.hpp"
+#include "conncpp/Multiplexer.hpp"
+#include "conncpp/ParallelBatchExecutor.hpp"
+#include "conncpp/AsyncInsertQueue.hpp"
+#include "conncpp/SequenceAllocator.hpp"
+#include "conncpp/Metrics.hpp"
+#include "conncpp/Tracing.hpp"
+#include "conncpp/Allocator.hpp"
+#include "conncpp/BulkLoad.hpp"
+#include "conncpp/ArrowExport.hpp"
+#include "conncpp/ShardRouter.hpp"
 #include "conncpp/PreparedStatement.hpp"
 #include "conncpp/ParameterMetaData.hpp"
+#include "conncpp/ParameterValue.hpp"
 #include "conncpp/CallableStatement.hpp"
 #include "conncpp/Warning.hpp"
 #include "conncpp/Savepoint.hpp"
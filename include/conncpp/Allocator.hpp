@@ -0,0 +1,46 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _ALLOCATOR_H_
+#define _ALLOCATOR_H_
+
+#include <cstddef>
+
+#include "buildconf.hpp"
+
+namespace sql
+{
+/* Source of the memory for the driver's bigger and frequent internal allocations, i.e. stored rows of result sets,
+   parameters of statements and cache entries, e.g. adapter to the arena or pool allocator. Memory has to be aligned
+   as of operator new. Each block is returned to the allocator, it came from, with the size it was requested with.
+   Calls may come from any thread at any time */
+class MARIADB_EXPORTED Allocator {
+  Allocator(const Allocator &);
+  void operator=(Allocator &);
+public:
+  Allocator() {}
+  virtual ~Allocator(){}
+
+  /* Throws std::bad_alloc, if the memory cannot be allocated */
+  virtual void* allocate(std::size_t size)=0;
+  virtual void deallocate(void* ptr, std::size_t size)=0;
+};
+}
+#endif
@@ -0,0 +1,90 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _ARROWEXPORT_H_
+#define _ARROWEXPORT_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "buildconf.hpp"
+#include "CArray.hpp"
+
+/* Structures of the Arrow C data interface(https://arrow.apache.org/docs/format/CDataInterface.html). They are ABI
+   stable, and any Arrow implementation can import them, thus the driver does not depend on the Arrow library */
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+extern "C" {
+struct ArrowSchema {
+  const char* format;
+  const char* name;
+  const char* metadata;
+  int64_t flags;
+  int64_t n_children;
+  struct ArrowSchema** children;
+  struct ArrowSchema* dictionary;
+  void (*release)(struct ArrowSchema*);
+  void* private_data;
+};
+
+struct ArrowArray {
+  int64_t length;
+  int64_t null_count;
+  int64_t offset;
+  int64_t n_buffers;
+  int64_t n_children;
+  const void** buffers;
+  struct ArrowArray** children;
+  struct ArrowArray* dictionary;
+  void (*release)(struct ArrowArray*);
+  void* private_data;
+};
+}
+#endif
+
+namespace sql
+{
+class ResultSet;
+class PreparedStatement;
+
+/* Reads up to maxRows next rows of the result into the Arrow record batch, i.e. the struct array with a child array per
+   column, and its schema. Buffers are owned by the exported structures, and are freed by their release callbacks, thus
+   the consumer takes them over without copying. Integer columns are exported as int64(uint64 for unsigned BIGINT),
+   floating point columns as float64, DATE as date32, DATETIME and TIMESTAMP as timestamp[us], TIME as duration[us],
+   binary columns as binary, and all others, including DECIMAL, as utf8. Zero dates are NULL. With the fetch size set,
+   batches are built while rows arrive. Returns the number of rows; 0 means the end of the result, and nothing is
+   exported then, i.e. release callbacks are nullptr */
+MARIADB_EXPORTED std::size_t exportArrowBatch(ResultSet* rs, std::size_t maxRows, ArrowSchema* schema, ArrowArray* array);
+
+/* Executes the prepared statement for each row of the Arrow record batch, i.e. the struct array with a child array per
+   parameter. Columns are bound with PreparedStatement::setArray, and are sent in one bulk command where the server
+   supports it. int32, int64 and float64 values, and utf8 and binary values are bound as they are in the batch, other
+   integer and floating point types are widened, unsigned int64, date32, date64 and timestamps without the time zone
+   are sent as strings. Validity bitmaps are converted to the NULL indicators. The batch stays owned by the caller, and
+   is not released. Statement's batch is cleared before and after the execution. Returns update counts */
+MARIADB_EXPORTED const sql::Longs& executeArrowBatch(PreparedStatement* ps, const ArrowSchema* schema, const ArrowArray* array);
+
+}
+#endif
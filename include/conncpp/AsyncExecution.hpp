@@ -0,0 +1,64 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _ASYNCEXECUTION_H_
+#define _ASYNCEXECUTION_H_
+
+#include <cstdint>
+
+#include "buildconf.hpp"
+
+namespace sql
+{
+/* Handle of the query executed in non-blocking way. The execution is driven by the application: it waits for the
+   events returned by getWaitStatus() on the socket returned by getSocket(), e.g. in its event loop, and then calls
+   resume() with the events that have occurred. After the execution is done, results are read with Statement's
+   methods the same way as after Statement::execute(). The connection may not be used for anything else until then.
+   The handle has to be destroyed before the statement that created it */
+class MARIADB_EXPORTED AsyncExecution {
+  AsyncExecution(const AsyncExecution &);
+  void operator=(AsyncExecution &);
+public:
+  /* Values are the same as MYSQL_WAIT_* of the C API */
+  enum {
+    WAIT_READ= 1,
+    WAIT_WRITE= 2,
+    WAIT_EXCEPT= 4,
+    WAIT_TIMEOUT= 8
+  };
+  AsyncExecution() {}
+  virtual ~AsyncExecution(){}
+
+  /* Native socket descriptor of the connection */
+  virtual int64_t getSocket()=0;
+  /* Bitmask of events the execution waits for. 0 if the execution is done */
+  virtual int32_t getWaitStatus()=0;
+  /* Number of milliseconds to wait, if WAIT_TIMEOUT is set in the wait status */
+  virtual uint32_t getTimeout()=0;
+  /* Continues the execution after events from readyEvents bitmask have occurred. Returns new wait status. Throws
+     SQLException if the query has failed */
+  virtual int32_t resume(int32_t readyEvents)=0;
+  virtual bool isDone()=0;
+  /* Returns true if the first result is a result set, i.e. what Statement::execute() would return */
+  virtual bool getResult()=0;
+};
+
+}
+#endif
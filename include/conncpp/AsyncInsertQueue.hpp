@@ -0,0 +1,66 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+
+#ifndef _ASYNCINSERTQUEUE_H_
+#define _ASYNCINSERTQUEUE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+
+#include "buildconf.hpp"
+#include "SQLString.hpp"
+#include "ParameterValue.hpp"
+
+namespace sql
+{
+/* Coalesces single-row inserts of many threads into batches. Rows are queued, and the queue's own thread executes them
+   on the queue's own connection as one batch of the prepared statement, i.e. in bulk where the server and the options
+   allow it, once maxRows rows are queued, or the oldest queued row has waited for maxDelay. Each row gets the future of
+   its update count, or of the exception the batch has thrown. Rows of one batch succeed or fail together only if the
+   batch does, i.e. the queue's connection is in autocommit mode, and the failed batch may have inserted some of its
+   rows. All methods are thread safe */
+class MARIADB_EXPORTED AsyncInsertQueue {
+  AsyncInsertQueue(const AsyncInsertQueue &);
+  void operator=(AsyncInsertQueue &);
+public:
+  AsyncInsertQueue() {}
+  virtual ~AsyncInsertQueue(){}
+
+  /* Queues the row with the arguments as the parameters values, in their order, like PreparedStatement::executeWith
+     does, e.g. queue->insert(id, name, score). The values are copied, and the arguments don't have to outlive the call */
+  template<typename... Args> std::future<int64_t> insert(const Args&... args)
+  {
+    const ParameterValue values[sizeof...(Args) + 1]= {args..., ParameterValue()};
+    return insertValues(values, sizeof...(Args));
+  }
+  /* insert with the values already made of the arguments */
+  virtual std::future<int64_t> insertValues(const ParameterValue* values, std::size_t count)=0;
+  /* Executes the rows, that are queued, without waiting for the delay, and waits until they are done */
+  virtual void flush()=0;
+  /* Number of rows, that are queued or being executed */
+  virtual std::size_t getPendingRows()=0;
+  /* Executes the rows, that are queued, stops the thread and closes the connection. Rows cannot be queued after that */
+  virtual void close()=0;
+};
+
+}
+#endif
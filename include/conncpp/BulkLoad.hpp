@@ -0,0 +1,62 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _BULKLOAD_H_
+#define _BULKLOAD_H_
+
+#include <cstddef>
+
+#include "buildconf.hpp"
+#include "SQLString.hpp"
+
+namespace sql
+{
+/* Receives values of the row, that RowProducer generates, in the order of columns. Values are serialized right away,
+   so the producer does not have to keep them after the call */
+class MARIADB_EXPORTED RowWriter {
+  RowWriter(const RowWriter &);
+  void operator=(RowWriter &);
+public:
+  RowWriter() {}
+  virtual ~RowWriter(){}
+
+  virtual void setNull()=0;
+  virtual void setInt64(int64_t value)=0;
+  virtual void setUInt64(uint64_t value)=0;
+  virtual void setDouble(double value)=0;
+  virtual void setString(const char* value, std::size_t length)=0;
+  virtual void setString(const SQLString& value)=0;
+};
+
+/* Source of rows for Connection::bulkLoad */
+class MARIADB_EXPORTED RowProducer {
+  RowProducer(const RowProducer &);
+  void operator=(RowProducer &);
+public:
+  RowProducer() {}
+  virtual ~RowProducer(){}
+
+  /* Writes values of the next row to the writer. Returns false, and writes nothing, if there are no more rows.
+     Exception thrown here aborts the load, and is re-thrown from Connection::bulkLoad */
+  virtual bool nextRow(RowWriter& writer)=0;
+};
+
+}
+#endif
@@ -65,7 +65,12 @@ namespace sql
     const T* end() const;
 
     CArray(std::initializer_list<T> const& initList);
+    /* Copy of the owning array owns the copy of its elements, copy of the wrapping one wraps the same memory */
     CArray(const CArray& rhs);
+    /* Takes over the elements of rhs, that becomes empty */
+    CArray(CArray&& rhs) noexcept;
+    CArray& operator=(const CArray& rhs);
+    CArray& operator=(CArray&& rhs) noexcept;
 
     CArray() : arr(nullptr), length(0)
     {}
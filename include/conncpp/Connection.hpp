@@ -24,6 +24,7 @@
 #include "buildconf.hpp"
 #include "SQLString.hpp"
 #include "Savepoint.hpp"
+#include "Metrics.hpp"
 #include "jdbccompat.hpp"
 
 namespace sql
@@ -31,6 +32,9 @@ namespace sql
 class Statement;
 class PreparedStatement;
 class CallableStatement;
+class Pipeline;
+class RowProducer;
+class SequenceAllocator;
 class DatabaseMetaData;
 class SQLWarning;
 
@@ -117,6 +121,18 @@ public:
   virtual void abort(sql::Executor* executor)=0;
   virtual void setNetworkTimeout(Executor* executor,int32_t milliseconds)=0;
 #endif
+
+  virtual Pipeline* createPipeline()=0;
+  /* Loads rows generated by the producer into the table via LOAD DATA LOCAL INFILE, without any intermediate file.
+     columns may be nullptr, if the producer writes values for all columns of the table. Returns number of loaded rows */
+  virtual int64_t bulkLoad(const SQLString& table, const SQLString* columns, std::size_t columnCount, RowProducer& producer)=0;
+  /* Counters of this connection. Connection from the pool reports the physical connection's ones, i.e. since it has
+     been created, and not since it's been taken from the pool */
+  virtual ConnectionMetrics getMetrics()=0;
+  /* Allocator of values of the sequence, that claims them from the server in blocks. The sequence name is put in the
+     query as is, and may be qualified with the schema name. blockSize has to be equal to the sequence's INCREMENT, or
+     0 to take it from the sequence */
+  virtual SequenceAllocator* getSequenceAllocator(const SQLString& sequence, int64_t blockSize)=0;
 };
 }
 #endif
@@ -0,0 +1,167 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _COROUTINES_H_
+#define _COROUTINES_H_
+
+/* Optional C++20 coroutine support on top of the non-blocking execution. Header only, and it's empty for older
+   language standards */
+#if __cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
+
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <memory>
+
+#include "Statement.hpp"
+#include "PreparedStatement.hpp"
+#include "ResultSet.hpp"
+#include "AsyncExecution.hpp"
+
+namespace sql
+{
+namespace coro
+{
+/* Interface to the application's event loop */
+class Reactor {
+public:
+  virtual ~Reactor() {}
+  /* Has to call onReady once some of the events (AsyncExecution::WAIT_* bitmask) have occurred on the socket, or
+     when timeoutMs have passed, if WAIT_TIMEOUT is in the mask. onReady gets the bitmask of occurred events. The
+     coroutine is resumed on the thread, that calls onReady */
+  virtual void waitFor(int64_t socket, int32_t events, uint32_t timeoutMs, std::function<void(int32_t)> onReady)=0;
+};
+
+/* Awaitable of the query execution. co_await returns what Statement::execute would return, and the results are
+   then read with the statement. For the PreparedStatement it's the execution of the statement itself, which is
+   supported by client side prepared statements only, as PreparedStatement::executeAsync is */
+class ExecuteAwaitable {
+  Statement* stmt;
+  PreparedStatement* pstmt= nullptr;
+  SQLString sql;
+  Reactor& reactor;
+  std::unique_ptr<AsyncExecution> execution;
+  std::exception_ptr error;
+
+  void schedule(std::coroutine_handle<> awaiting)
+  {
+    reactor.waitFor(execution->getSocket(), execution->getWaitStatus(), execution->getTimeout(),
+      [this, awaiting](int32_t readyEvents) {
+        try {
+          if (execution->resume(readyEvents) != 0) {
+            schedule(awaiting);
+            return;
+          }
+        }
+        catch (...) {
+          error= std::current_exception();
+        }
+        awaiting.resume();
+      });
+  }
+
+public:
+  ExecuteAwaitable(Statement* _stmt, const SQLString& _sql, Reactor& _reactor)
+    : stmt(_stmt), sql(_sql), reactor(_reactor) {}
+  ExecuteAwaitable(PreparedStatement* _pstmt, Reactor& _reactor)
+    : stmt(_pstmt), pstmt(_pstmt), reactor(_reactor) {}
+
+  bool await_ready()
+  {
+    try {
+      execution.reset(pstmt != nullptr ? pstmt->executeAsync() : stmt->executeAsync(sql));
+    }
+    catch (...) {
+      error= std::current_exception();
+      return true;
+    }
+    return execution->isDone();
+  }
+
+  void await_suspend(std::coroutine_handle<> awaiting) { schedule(awaiting); }
+
+  bool await_resume()
+  {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+    return execution->getResult();
+  }
+};
+
+/* co_await returns result set of the query. The caller owns it, as with Statement::executeQuery */
+class ExecuteQueryAwaitable : public ExecuteAwaitable {
+  Statement* stmt;
+
+public:
+  ExecuteQueryAwaitable(Statement* _stmt, const SQLString& _sql, Reactor& _reactor)
+    : ExecuteAwaitable(_stmt, _sql, _reactor), stmt(_stmt) {}
+  ExecuteQueryAwaitable(PreparedStatement* _pstmt, Reactor& _reactor)
+    : ExecuteAwaitable(_pstmt, _reactor), stmt(_pstmt) {}
+
+  ResultSet* await_resume()
+  {
+    ExecuteAwaitable::await_resume();
+    return stmt->getResultSet();
+  }
+};
+
+/* Rows are read from the result set data, that has been already received. Thus this never suspends, unless the
+   result set is streamed(fetch size is set) - then reading of the next portion of rows is blocking */
+class NextAwaitable {
+  ResultSet* rs;
+
+public:
+  explicit NextAwaitable(ResultSet* _rs) : rs(_rs) {}
+
+  bool await_ready() { return true; }
+  void await_suspend(std::coroutine_handle<>) {}
+  bool await_resume() { return rs->next(); }
+};
+
+inline ExecuteAwaitable executeAsync(Statement* stmt, const SQLString& sql, Reactor& reactor)
+{
+  return ExecuteAwaitable(stmt, sql, reactor);
+}
+
+inline ExecuteQueryAwaitable executeQueryAsync(Statement* stmt, const SQLString& sql, Reactor& reactor)
+{
+  return ExecuteQueryAwaitable(stmt, sql, reactor);
+}
+
+inline ExecuteAwaitable executeAsync(PreparedStatement* stmt, Reactor& reactor)
+{
+  return ExecuteAwaitable(stmt, reactor);
+}
+
+inline ExecuteQueryAwaitable executeQueryAsync(PreparedStatement* stmt, Reactor& reactor)
+{
+  return ExecuteQueryAwaitable(stmt, reactor);
+}
+
+inline NextAwaitable nextAsync(ResultSet* rs)
+{
+  return NextAwaitable(rs);
+}
+
+}
+}
+#endif
+#endif
@@ -21,6 +21,9 @@
 #ifndef _DRIVER_H_
 #define _DRIVER_H_
 
+#include <list>
+#include <vector>
+
 #include "buildconf.hpp"
 #include "SQLString.hpp"
 #include "Connection.hpp"
@@ -30,6 +33,38 @@ namespace sql
 {
 typedef Properties ConnectOptionsMap;
 
+class Multiplexer;
+class ParallelBatchExecutor;
+class AsyncInsertQueue;
+class ShardRouter;
+class ShardFunction;
+class MetricsSnapshot;
+class StatementDigests;
+struct MemoryUsage;
+class Tracer;
+class Allocator;
+
+/* Connection parameters, that have been parsed and validated once, and can be used to open any number of connections.
+   Object can be used from different threads at the same time */
+class MARIADB_EXPORTED ConnectionDescriptor {
+  ConnectionDescriptor(const ConnectionDescriptor &);
+  void operator=(ConnectionDescriptor &);
+public:
+  ConnectionDescriptor() {}
+  virtual ~ConnectionDescriptor(){}
+
+  virtual Connection* connect()=0;
+  /* Opens given number of connections, that are shared by the threads using the multiplexer. The caller owns the
+     multiplexer */
+  virtual Multiplexer* createMultiplexer(uint32_t connections)=0;
+  /* Opens given number of connections, that execute partitions of big batches in parallel. The caller owns the
+     executor */
+  virtual ParallelBatchExecutor* createParallelBatchExecutor(uint32_t parallelism)=0;
+  /* Opens the connection, that executes rows of the insert statement queued by many threads as batches of up to
+     maxRows rows, waiting up to maxDelayMs for the batch to fill up. The caller owns the queue */
+  virtual AsyncInsertQueue* createAsyncInsertQueue(const SQLString& sql, uint32_t maxDelayMs, std::size_t maxRows)=0;
+};
+
 class MARIADB_EXPORTED Driver {
   Driver(const Driver &);
   void operator=(Driver &);
@@ -46,6 +81,38 @@ public:
   virtual bool jdbcCompliant()=0;
   //Not in the classic API
   virtual const SQLString& getName()=0;
+  /* Parses url and properties for later connects. Returns nullptr if url is not accepted by the driver */
+  virtual ConnectionDescriptor* prepareConnection(const SQLString& url, Properties& props)=0;
+  /* Metrics of all connections of the process, grouped by pools. The caller owns the snapshot */
+  virtual MetricsSnapshot* getMetricsSnapshot()=0;
+  /* Memory the driver holds for all connections of the process at the moment */
+  virtual MemoryUsage getMemoryUsage()=0;
+  /* Limits the bytes of rows, that result sets of all connections may store. Reading the row, that would exceed it,
+     fails with HY001 SQLSTATE. 0 removes the limit */
+  virtual void setMemoryLimit(uint64_t bytes)=0;
+  /* Installs process wide tracer of connects, queries, prepares, executions and batches. nullptr uninstalls it. The
+     tracer is not owned by the driver, and has to stay alive until it's uninstalled and all operations are done */
+  virtual void setTracer(Tracer* tracer)=0;
+  /* Installs process wide allocator of the stored rows, statement parameters and cache entries. nullptr returns to
+     operator new. Memory allocated before the change is freed by the allocator, that has allocated it, thus the
+     allocator is not owned by the driver, and has to stay alive while any memory allocated by it may be in use */
+  virtual void setAllocator(Allocator* allocator)=0;
+  /* Enables process wide table of the most expensive statements, keeping up to capacity digests, or disables it with
+     0. The table is cleared */
+  virtual void setStatementDigests(std::size_t capacity)=0;
+  /* The caller owns the result */
+  virtual StatementDigests* getStatementDigests()=0;
+  /* Enables process wide cache of results of the queries, marked with Statement::setResultCacheTtl or the
+     RESULT_CACHE(ttl) comment, taking up to capacity bytes, or disables it with 0. The cache is cleared */
+  virtual void setResultCache(std::size_t capacity)=0;
+  /* Router over shards, each given by its url, and the properties common for all of them. nullptr function means the
+     hash of the key. The function is not owned by the router, and has to outlive it. The caller owns the router */
+  virtual ShardRouter* createShardRouter(const std::vector<SQLString>& shardUrls, Properties& props,
+    ShardFunction* function= nullptr)=0;
+  /* Statements, that every new connection prepares right after connecting, if it caches server side prepared
+     statements(useServerPrepStmts and cachePrepStmts), so their first executions don't wait for PREPARE. Empty list
+     turns that off */
+  virtual void setPrepareWarmup(const std::list<SQLString>& statements)=0;
 #ifdef JDBC_SPECIFIC_TYPES_IMPLEMENTED
   virtual Logger* getParentLogger()= 0;
 #endif
@@ -29,11 +29,21 @@
 
 namespace sql
 {
+namespace mariadb
+{
+class ExceptionMessage;
+}
+
 class SQLException : public ::std::runtime_error
 {
+  friend class mariadb::ExceptionMessage;
+
   SQLString SqlState;
   int32_t ErrorCode;
   std::shared_ptr<std::exception> Cause;
+  /* Connection id, query and other details added by the driver. They are put together with the message on the first
+     what() call */
+  std::shared_ptr<mariadb::ExceptionMessage> Details;
 
 public:
   MARIADB_EXPORTED virtual ~SQLException();
@@ -249,6 +259,40 @@ public:
 };
 
 
+/* Error of the non-throwing execution(Statement::tryExecute and others). The kind is the class of the error by its
+   SQLState, the same that selects the SQLException subclass for the error */
+struct ErrorInfo
+{
+  enum Kind {
+    NONE= 0,
+    GENERIC,
+    DATA,
+    FEATURE_NOT_SUPPORTED,
+    INTEGRITY_CONSTRAINT_VIOLATION,
+    INVALID_AUTHORIZATION,
+    NON_TRANSIENT_CONNECTION,
+    SYNTAX,
+    TRANSACTION_ROLLBACK,
+    TRANSIENT,
+    TIMEOUT
+  };
+
+  Kind kind= NONE;
+  int32_t errorCode= 0;
+  SQLString sqlState;
+  SQLString message;
+
+  bool failed() const { return kind != NONE; }
+  void clear()
+  {
+    kind= NONE;
+    errorCode= 0;
+    sqlState.clear();
+    message.clear();
+  }
+};
+
+
 class MaxAllowedPacketException : public std::runtime_error {
 
   bool mustReconnect;
@@ -0,0 +1,172 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _METRICS_H_
+#define _METRICS_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "buildconf.hpp"
+#include "SQLString.hpp"
+
+namespace sql
+{
+/* Summary of a latency histogram. Times are in microseconds. Percentiles are accurate within 1/16 of their value */
+struct LatencySummary
+{
+  uint64_t count= 0;
+  uint64_t sum= 0;
+  uint64_t max= 0;
+  uint64_t p50= 0;
+  uint64_t p90= 0;
+  uint64_t p99= 0;
+  uint64_t p999= 0;
+};
+
+/* Counters of a connection, or totals of a group of connections. queries are text protocol queries, prepares and
+   executes are server side prepared statements commands. Bytes are payload ones - query texts and parameters data
+   sent, and row data received, without protocol overhead. Prepare cache counts lookups in the cache of parsed client
+   side prepared statements, and in the server side prepared statements cache */
+struct ConnectionMetrics
+{
+  uint64_t queries= 0;
+  uint64_t prepares= 0;
+  uint64_t executes= 0;
+  uint64_t roundTrips= 0;
+  uint64_t bytesSent= 0;
+  uint64_t bytesReceived= 0;
+  uint64_t rowsFetched= 0;
+  uint64_t prepareCacheHits= 0;
+  uint64_t prepareCacheMisses= 0;
+  uint64_t reconnects= 0;
+  /* Server side prepared statements executed in bulk, i.e. with array of parameters sets in one command */
+  uint64_t bulkExecutes= 0;
+  /* Microseconds spent in the commands sending statements and waiting for the response, i.e. the network and the
+     server time, and in reading the results after that */
+  uint64_t networkTime= 0;
+  uint64_t decodeTime= 0;
+  /* Statement execution time */
+  LatencySummary executionTime;
+  /* Time getConnection waited for the pool. Only in the pool's totals */
+  LatencySummary poolWait;
+  /* Estimated memory held by the connection object, its buffers and caches, without the C API's connection handle.
+     Only in the connection's metrics, the snapshot's ones have 0 */
+  uint64_t memoryFootprint= 0;
+  /* Bytes of rows stored by the connection's result sets at the moment, limited by maxResultSetMemory. Only in the
+     connection's metrics */
+  uint64_t resultSetMemory= 0;
+  /* Number of statements multi-send batches keep in flight - adaptiveBatchWindow's current window, or
+     useBatchMultiSendNumber. Only in the connection's metrics */
+  uint64_t batchWindow= 0;
+  /* Time of establishing the connection - TCP or local transport connect, TLS handshake and authentication, without
+     the session initialization queries. Reconnects are included */
+  LatencySummary connectTime;
+};
+
+/* Breakdown of the last execution of a statement. Times are in microseconds. networkTime is spent in the commands
+   sending the statement and waiting for the response, i.e. it is the network and the server time together - the
+   protocol does not report the server time on its own. decodeTime is spent reading the results, and includes
+   receiving rows of the buffered result. encodeTime is the rest of the execution on the client - parsing, building
+   the query and binding parameters. Rows of streamed results are fetched later, and are not counted */
+struct ExecutionStats
+{
+  uint64_t totalTime= 0;
+  uint64_t encodeTime= 0;
+  uint64_t networkTime= 0;
+  uint64_t decodeTime= 0;
+  uint64_t bytesSent= 0;
+  uint64_t bytesReceived= 0;
+  uint64_t rows= 0;
+  uint64_t roundTrips= 0;
+  /* Executed as server side prepared statement */
+  bool prepared= false;
+  /* Prepared statement executed without the prepare command of its own, i.e. reusing the earlier prepare, or the one
+     from the cache */
+  bool cached= false;
+  /* Batch executed in bulk */
+  bool bulk= false;
+  /* Batch rewritten into multi-values or multi-statement queries */
+  bool rewritten= false;
+};
+
+/* Bytes the driver holds at the moment, by the kind of memory. Result sets are rows stored in the driver's own storage,
+   that is used, if a memory limit or resultSpillThreshold is set - otherwise rows are stored by the C API and are not
+   counted. Large values are the chunk buffers of the values streamed with getBinaryStream and getBlob. Prepare caches
+   are the parsed client side prepared statements */
+struct MemoryUsage
+{
+  uint64_t resultSets= 0;
+  uint64_t largeValues= 0;
+  uint64_t prepareCaches= 0;
+  uint64_t metadataCache= 0;
+  /* Query buffers of the connections */
+  uint64_t connectionBuffers= 0;
+  /* The limit of result sets memory set with Driver::setMemoryLimit, 0 if there is none */
+  uint64_t resultSetsLimit= 0;
+};
+
+/* Metrics of all connections of the process at the moment of the snapshot. Connections are grouped by pools, and
+   connections, that are not from pools, make the group with empty name. Closed connections stay in their group's
+   totals */
+class MARIADB_EXPORTED MetricsSnapshot {
+  MetricsSnapshot(const MetricsSnapshot &);
+  void operator=(MetricsSnapshot &);
+public:
+  MetricsSnapshot() {}
+  virtual ~MetricsSnapshot(){}
+
+  virtual const ConnectionMetrics& getTotal()=0;
+  virtual std::size_t getGroupCount()=0;
+  /* Pool tag - the poolName option, MariaDB-pool by default, followed by the pool index */
+  virtual const SQLString& getGroupName(std::size_t index)=0;
+  virtual const ConnectionMetrics& getGroup(std::size_t index)=0;
+};
+
+/* Executions of the statements with the same digest - the query text with literals replaced by ? and whitespace
+   collapsed. Times are in microseconds, as seen by the client, i.e. including the network time. Rows are the ones
+   fetched during the execution, rows of streamed results are fetched later and are not counted */
+struct StatementDigest
+{
+  SQLString digest;
+  uint64_t count= 0;
+  uint64_t errors= 0;
+  uint64_t totalTime= 0;
+  /* If the digest has replaced a less expensive one in the full table, its totalTime includes the replaced digest's
+     total, that is totalTimeError. Other members count only executions since then */
+  uint64_t totalTimeError= 0;
+  uint64_t rows= 0;
+  LatencySummary latency;
+};
+
+/* The most expensive statements of the process, sorted by totalTime descending */
+class MARIADB_EXPORTED StatementDigests {
+  StatementDigests(const StatementDigests &);
+  void operator=(StatementDigests &);
+public:
+  StatementDigests() {}
+  virtual ~StatementDigests(){}
+
+  virtual std::size_t getCount()=0;
+  virtual const StatementDigest& get(std::size_t index)=0;
+};
+
+}
+#endif
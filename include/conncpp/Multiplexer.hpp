@@ -0,0 +1,54 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _MULTIPLEXER_H_
+#define _MULTIPLEXER_H_
+
+#include <cstdint>
+
+#include "buildconf.hpp"
+#include "SQLString.hpp"
+#include "ResultSet.hpp"
+
+namespace sql
+{
+/* Few physical connections shared by any number of threads. Queries of the threads, that arrive while a connection is
+   busy, are queued, and then sent together in one pipeline. Each caller gets back the result of its own query.
+   Queries of different callers run one after another in the same session, so only queries, that do not depend on the
+   session state, e.g. autocommit reads, should be executed this way. Object can be used from different threads at
+   the same time */
+class MARIADB_EXPORTED Multiplexer {
+  Multiplexer(const Multiplexer &);
+  void operator=(Multiplexer &);
+public:
+  Multiplexer() {}
+  virtual ~Multiplexer(){}
+
+  /* The caller owns the result set. nullptr if the query has not returned one */
+  virtual ResultSet* executeQuery(const SQLString& sql)=0;
+  /* Update count of the query, or -1 for the result set, which is discarded */
+  virtual int64_t executeUpdate(const SQLString& sql)=0;
+  virtual uint32_t getConnectionCount()=0;
+  /* Waits for the queries, that are being executed, and closes connections. Queries still queued fail */
+  virtual void close()=0;
+};
+
+}
+#endif
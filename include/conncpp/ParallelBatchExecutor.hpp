@@ -0,0 +1,78 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _PARALLELBATCHEXECUTOR_H_
+#define _PARALLELBATCHEXECUTOR_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "buildconf.hpp"
+#include "SQLString.hpp"
+#include "ArrowExport.hpp"
+
+namespace sql
+{
+/* Binds parameters of one row of the batch, that ParallelBatchExecutor executes. It is called from the worker threads
+   for different rows at the same time, so it has to be thread safe. It must not call execute or addBatch */
+class MARIADB_EXPORTED BatchRowBinder {
+  BatchRowBinder(const BatchRowBinder &);
+  void operator=(BatchRowBinder &);
+public:
+  BatchRowBinder() {}
+  virtual ~BatchRowBinder(){}
+
+  virtual void bindRow(PreparedStatement& ps, std::size_t row)=0;
+};
+
+/* Executes big batches on few connections at once. Rows are split into contiguous partitions, one per connection, and
+   each partition is executed by its own thread as the batch of the prepared statement, i.e. in bulk where the server
+   and the options allow it. Update counts are gathered in the order of rows. If partitions fail, the others are still
+   completed, and then the error of the first failed partition is thrown. Partitions run in different sessions, so
+   rows must not depend on each other. Only one batch is executed at a time */
+class MARIADB_EXPORTED ParallelBatchExecutor {
+  ParallelBatchExecutor(const ParallelBatchExecutor &);
+  void operator=(ParallelBatchExecutor &);
+public:
+  ParallelBatchExecutor() {}
+  virtual ~ParallelBatchExecutor(){}
+
+  /* Each partition runs in its own transaction, committed if all its rows succeed, and rolled back otherwise. By
+     default partitions run in the autocommit mode of the connections */
+  virtual void setPartitionTransactions(bool enable)=0;
+  /* Maximum number of rows sent by one execution of the partition's batch, bounding the memory for the bound
+     parameters. 0(default) sends the whole partition at once */
+  virtual void setChunkSize(std::size_t rows)=0;
+  /* Executes the statement for rows 0..rows-1, bound by the binder. Returns update counts, see getUpdateCounts */
+  virtual const sql::Longs& executeBatch(const SQLString& sql, std::size_t rows, BatchRowBinder& binder)=0;
+  /* Executes the statement for each row of the Arrow record batch, as sql::executeArrowBatch does. The batch stays
+     owned by the caller */
+  virtual const sql::Longs& executeArrowBatch(const SQLString& sql, const ArrowSchema* schema, const ArrowArray* array)=0;
+  /* Update counts of the last batch, one per row, also after it has thrown. Rows, whose counts are unknown because
+     their chunk has failed, or whose partition has been rolled back, have Statement::EXECUTE_FAILED. Valid until the
+     next batch */
+  virtual const sql::Longs& getUpdateCounts()=0;
+  virtual uint32_t getConnectionCount()=0;
+  /* Waits for the batch, that is being executed, and closes connections */
+  virtual void close()=0;
+};
+
+}
+#endif
@@ -0,0 +1,74 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _PARAMETERVALUE_H_
+#define _PARAMETERVALUE_H_
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#include "buildconf.hpp"
+#include "SQLString.hpp"
+
+namespace sql
+{
+/* Parameter value of PreparedStatement::executeWith. The kind is chosen at compile time by the type of the argument,
+   and the value is not copied - it refers the argument's memory, that stays valid for the time of the call */
+struct ParameterValue
+{
+  enum Kind {
+    NULL_VALUE= 0,
+    INTEGER,
+    UNSIGNED,
+    REAL,
+    STRING
+  };
+
+  Kind kind;
+  const void* value;
+  /* Size of the number in bytes, or length of the string */
+  std::size_t length;
+
+  ParameterValue() : kind(NULL_VALUE), value(nullptr), length(0) {}
+  ParameterValue(std::nullptr_t) : ParameterValue() {}
+
+  template<typename T, typename std::enable_if<std::is_integral<T>::value, int>::type= 0>
+  ParameterValue(const T& number) : kind(std::is_signed<T>::value ? INTEGER : UNSIGNED), value(&number), length(sizeof(T))
+  {
+    static_assert(sizeof(T) <= 8, "Integer types of up to 64 bits are supported");
+  }
+
+  template<typename T, typename std::enable_if<std::is_floating_point<T>::value, int>::type= 0>
+  ParameterValue(const T& number) : kind(REAL), value(&number), length(sizeof(T))
+  {
+    static_assert(sizeof(T) == sizeof(float) || sizeof(T) == sizeof(double), "Only float and double are supported");
+  }
+
+  ParameterValue(const SQLString& str) : kind(STRING), value(str.c_str()), length(str.length()) {}
+  ParameterValue(const std::string& str) : kind(STRING), value(str.c_str()), length(str.length()) {}
+  /* nullptr is NULL */
+  ParameterValue(const char* str) : kind(str != nullptr ? STRING : NULL_VALUE), value(str),
+    length(str != nullptr ? std::strlen(str) : 0) {}
+};
+
+}
+#endif
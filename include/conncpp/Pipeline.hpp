@@ -0,0 +1,59 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _PIPELINE_H_
+#define _PIPELINE_H_
+
+#include <cstddef>
+
+#include "buildconf.hpp"
+#include "SQLString.hpp"
+#include "ResultSet.hpp"
+#include "PreparedStatement.hpp"
+
+namespace sql
+{
+/* Queue of independent queries, that are all sent to the server at once, before reading any result, i.e. N queries
+   cost one roundtrip instead of N. Results are read in the order of queries */
+class MARIADB_EXPORTED Pipeline {
+  Pipeline(const Pipeline &);
+  void operator=(Pipeline &);
+public:
+  Pipeline() {}
+  virtual ~Pipeline(){}
+
+  virtual Pipeline* add(const SQLString& sql)=0;
+  /* Queues execution of the prepared statement with parameters, that are currently set. Only client side prepared
+     statements can be pipelined */
+  virtual Pipeline* add(PreparedStatement* pstmt)=0;
+  virtual std::size_t size()=0;
+  virtual void clear()=0;
+  /* Sends queued queries and reads their results. The queue is cleared. If any query fails, results of all queries
+     are still read, and then the error of the first failed query is thrown */
+  virtual void execute()=0;
+  /* Result set of the query with given index in the last execution, or nullptr. The caller owns the result set */
+  virtual ResultSet* getResultSet(std::size_t index)=0;
+  /* Update count of the query with given index in the last execution. -1 for result set, and
+     Statement::EXECUTE_FAILED if the query has failed */
+  virtual int64_t getUpdateCount(std::size_t index)=0;
+};
+
+}
+#endif
@@ -24,6 +24,7 @@
 #include "buildconf.hpp"
 #include "SQLString.hpp"
 #include "ParameterMetaData.hpp"
+#include "ParameterValue.hpp"
 
 #include "Statement.hpp"
 
@@ -128,6 +129,98 @@ public:
 
 #endif
 
+  /* Column-wise binding of the parameter to the array of values in the application memory, executed by executeBatch
+     as the batch of "rows" parameter sets. Values are not copied, and memory has to stay valid till the batch is
+     executed. Element of nullIndicators is 1 for NULL and 0 otherwise, the array can be nullptr if there are no NULLs.
+     All parameters have to be bound this way, to the arrays of the same size. Supported by server side prepared
+     statements only */
+  virtual void setArray(int32_t parameterIndex, const int32_t* values, const char* nullIndicators, std::size_t rows)=0;
+  virtual void setArray(int32_t parameterIndex, const int64_t* values, const char* nullIndicators, std::size_t rows)=0;
+  virtual void setArray(int32_t parameterIndex, const double* values, const char* nullIndicators, std::size_t rows)=0;
+  virtual void setArray(int32_t parameterIndex, const char* const* values, const unsigned long* lengths,
+    const char* nullIndicators, std::size_t rows)=0;
+
+  /* Non-throwing execute() and executeUpdate(). On error they fill the error and return false and
+     Statement::EXECUTE_FAILED respectively */
+  virtual bool tryExecute(ErrorInfo& error) noexcept=0;
+  virtual bool tryExecute(const SQLString& sql, ErrorInfo& error) noexcept=0;
+  virtual int32_t tryExecuteUpdate(ErrorInfo& error) noexcept=0;
+
+  /* BLOB value with the content of the file. The file is mapped to the memory and sent from the mapping without
+     copying. The file must not be changed till the statement is executed */
+  virtual void setBlobFromFile(int32_t parameterIndex, const SQLString& path)=0;
+
+  /* The value is sent as TIME, if its date part is 0, and as DATETIME otherwise */
+  virtual void setDateTime(int32_t parameterIndex, const DateTime& value)=0;
+  virtual void setDecimal(int32_t parameterIndex, const Decimal& value)=0;
+
+  /* The value is not copied - the memory has to stay valid till the statement, or the batch the row is added to, is
+     executed. nullptr sets NULL */
+  virtual void setBytes(int32_t parameterIndex, const char* bytes, std::size_t length)=0;
+
+  /* Executes the statement with the arguments as the parameters values, in their order, instead of the values set
+     with setters, e.g. stmt->executeWith(id, name, score). Each argument is mapped to the parameter type at compile
+     time, and its value is sent right from the argument's memory. Integer types, float, double, SQLString,
+     std::string, const char* and nullptr for NULL are supported. The number of arguments has to be equal to the number
+     of parameters */
+  template<typename... Args> bool executeWith(const Args&... args)
+  {
+    // One more element, so that the array is not empty for the query without parameters
+    const ParameterValue values[sizeof...(Args) + 1]= {args..., ParameterValue()};
+    return executeValues(values, sizeof...(Args));
+  }
+  /* executeQuery() with the arguments as the parameters values, like executeWith. The result cache is not used */
+  template<typename... Args> ResultSet* executeQueryWith(const Args&... args)
+  {
+    const ParameterValue values[sizeof...(Args) + 1]= {args..., ParameterValue()};
+    return executeQueryValues(values, sizeof...(Args));
+  }
+  /* executeWith and executeQueryWith with the values already made of the arguments */
+  virtual bool executeValues(const ParameterValue* values, std::size_t count)=0;
+  virtual ResultSet* executeQueryValues(const ParameterValue* values, std::size_t count)=0;
+
+  /* Binds the list of values to the parameter, that stands for the whole list, e.g. "WHERE id IN (?)". On execution the
+     marker is expanded to the number of markers, that is the nearest power of two not less than count, and the list is
+     padded with its last value. Thus lists of any size up to N are executed with log2(N) prepared statements, that
+     stay in the prepared statements cache. Values are copied. Not supported in batches. Supported by server side
+     prepared statements only */
+  virtual void setList(int32_t parameterIndex, const int64_t* values, std::size_t count)=0;
+  virtual void setList(int32_t parameterIndex, const SQLString* values, std::size_t count)=0;
+
+  using Statement::executeScalar;
+  /* Executes the statement and returns the value of the first column of the first row, or T(), as
+     Statement::executeScalar does. Server side prepared statements read the value from the binary result set */
+  template<typename T> T executeScalar()
+  {
+    static_assert(std::is_arithmetic<T>::value || std::is_same<T, SQLString>::value,
+      "executeScalar supports integer, floating point types and SQLString");
+    typename ScalarType<T>::type value{};
+    executeScalar(value);
+    return static_cast<T>(value);
+  }
+  virtual bool executeScalar(int64_t& value)=0;
+  virtual bool executeScalar(double& value)=0;
+  virtual bool executeScalar(SQLString& value)=0;
+
+  /* Copy of the statement for the connection, or for the statement's own one, if it's nullptr. The parsed query, and
+     parameters and columns metadata are shared, and only parameter values are the clone's own. Client side statements
+     are cloned without anything sent to the server. Server side statement is prepared on the connection. If the
+     connection caches prepared statements(cachePrepStmts), the clone takes the cached prepare of the query, unless
+     other statement uses it - the server's handle is never shared. May be called from any thread, while the statement
+     is used by its own. The caller owns the clone */
+  virtual PreparedStatement* clone(Connection* connection=nullptr)=0;
+
+  /* The string is converted to the connection character set in one pass. wchar_t is UTF-16 or UTF-32 depending on its
+     size */
+  virtual void setU16String(int32_t parameterIndex, const std::u16string& str)=0;
+  virtual void setWString(int32_t parameterIndex, const std::wstring& str)=0;
+
+  using Statement::executeAsync;
+  /* Starts non-blocking execution of the statement with current parameters values, like Statement::executeAsync does
+     for the query text. Supported by client side prepared statements only(useServerPrepStmts=false), and not by
+     CallableStatement - the binary protocol has no non-blocking execution in the driver */
+  virtual AsyncExecution* executeAsync()=0;
+
   };
 }
 #endif
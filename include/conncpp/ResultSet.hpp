@@ -22,6 +22,11 @@
 #define _RESULTSET_H_
 
 #include <istream>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
 
 #include "buildconf.hpp"
 #include "SQLString.hpp"
@@ -32,6 +37,92 @@ namespace sql
 {
 class ResultSetMetaData;
 class Statement;
+template <typename... T> class TypedCursor;
+template <typename T> class RowMapping;
+
+/* Date and time value of ResultSet::getDateTime. Date part of TIME values is 0, and their hour may exceed 23. nanos are
+   the fractional part of the second */
+struct DateTime
+{
+  uint32_t year;
+  uint32_t month;
+  uint32_t day;
+  uint32_t hour;
+  uint32_t minute;
+  uint32_t second;
+  uint32_t nanos;
+  bool negative;
+};
+
+/* Exact value of ResultSet::getDecimal and PreparedStatement::setDecimal, i.e. the 128 bits integer high*2^64 + low,
+   divided by 10^scale. Values with up to 38 digits are supported */
+struct Decimal
+{
+  uint64_t low;
+  uint64_t high;
+  uint32_t scale;
+  bool negative;
+};
+
+/* Destination of a column for ResultSet::fetchColumns. Values of consecutive rows go to consecutive elements of
+   the buffer, that has to have space for maxRows elements. For strings each element is bufferLength bytes long,
+   the value is truncated to this length, is not NUL-terminated, and its full length is written to
+   length. BIND_SQLSTRING elements are SQLString objects, that get the whole value. isNull and length are optional.
+   With stride other than 0 the values of consecutive rows are stride bytes apart, e.g. in the array of structs */
+struct ColumnBinding
+{
+  enum BindType {
+    BIND_INT32= 0,
+    BIND_INT64,
+    BIND_UINT64,
+    BIND_DOUBLE,
+    BIND_STRING,
+    BIND_SQLSTRING
+  };
+
+  int32_t columnIndex;
+  BindType type;
+  void* buffer;
+  std::size_t bufferLength;
+  std::size_t* length;
+  bool* isNull;
+  std::size_t stride;
+};
+
+/* Output of ResultSet::exportTo. CSV quotes the values containing the separator, quote, CR or LF, and doubles the quotes.
+   TSV is the format of SELECT ... INTO OUTFILE, i.e. tab, newline, CR, NUL and backslash are escaped with backslash,
+   and NULL is \N. NDJSON writes each row as the JSON object on its own line, keyed by column labels, numeric values
+   unquoted. Strings are written as they come, i.e. in the connection's character set */
+struct ExportOptions
+{
+  enum Format {
+    EXPORT_CSV= 0,
+    EXPORT_TSV,
+    EXPORT_NDJSON
+  };
+
+  /* CSV field separator */
+  char separator= ',';
+  /* CSV and TSV start with the line of column labels */
+  bool header= false;
+  /* CSV text of NULL, that is written unquoted. Empty by default */
+  const char* nullValue= "";
+  /* Output is written in blocks of this size */
+  std::size_t bufferSize= 64*1024;
+};
+
+/* Runs the tasks of ResultSet::materializeColumns, e.g. on the application's thread pool. run calls task(context, i)
+   once for each i from 0 to count - 1, in any threads and order, and returns after all calls have returned. Tasks do
+   not throw */
+class MARIADB_EXPORTED TaskExecutor {
+  TaskExecutor(const TaskExecutor &);
+  void operator=(TaskExecutor &);
+public:
+  TaskExecutor() {}
+  virtual ~TaskExecutor(){}
+
+  virtual void run(std::size_t count, void (*task)(void* context, std::size_t index), void* context)=0;
+};
 
 class MARIADB_EXPORTED ResultSet {
 
@@ -119,6 +210,8 @@ public:
   virtual std::istream* getBinaryStream(int32_t columnIndex)=0;
   virtual std::istream* getBinaryStream(const SQLString& columnLabel)=0;
 
+  /* Returns the index of the column with the given label. Label lookup is case-insensitive. Loops reading columns by
+     label may resolve labels once with this method, and use index getters, that do not need the lookup */
   virtual int32_t findColumn(const SQLString& columnLabel)=0;
   virtual SQLString getCursorName()=0;
   virtual int32_t getHoldability()=0;
@@ -194,6 +287,68 @@ public:
 
   virtual std::size_t rowsCount()=0;
 
+  /* Returns pointer to the value of the column in the current row, and sets its length. It points directly to the row
+     buffer, if the value does not need conversion to be represented as a string, i.e. no SQLString is created. The value
+     is not NUL-terminated in general. The pointer is valid until the cursor is moved or the result set is closed.
+     NULL value is returned as nullptr */
+  virtual const char* getStringView(int32_t columnIndex, std::size_t& length)=0;
+  virtual const char* getStringView(const SQLString& columnLabel, std::size_t& length)=0;
+  /* Returns pointer to the JSON document in the row buffer, and sets its length, so the application can hand it to
+     its JSON parser without any copy. The bytes are as the server sent them, in the connection character set, and
+     never converted. The pointer has the same lifetime as the one of getStringView. NULL value is returned as nullptr.
+     Throws SQLDataException if the column is not of JSON type. MariaDB Server identifies JSON columns only in the
+     extended metadata, which requires 10.5.2 or newer */
+  virtual const char* getJsonView(int32_t columnIndex, std::size_t& length)=0;
+  virtual const char* getJsonView(const SQLString& columnLabel, std::size_t& length)=0;
+  /* The value converted to UTF-16 straight from the row buffer, i.e. without SQLString in between. std::wstring is
+     UTF-16, where wchar_t has 16 bits(Windows), and UTF-32 otherwise. NULL value is returned as the empty string */
+  virtual std::u16string getU16String(int32_t columnIndex)=0;
+  virtual std::u16string getU16String(const SQLString& columnLabel)=0;
+  virtual std::wstring getWString(int32_t columnIndex)=0;
+  virtual std::wstring getWString(const SQLString& columnLabel)=0;
+  /* Copies the value of the column in the current row into the buffer, as the server has sent it, i.e. without charset
+     conversion, and returns its length. The buffer is reallocated only if it is smaller than the value, and keeps its
+     size otherwise, thus one buffer can be reused for the column of all rows. NULL value has 0 length, and can be told
+     from the empty one by wasNull() */
+  virtual std::size_t getBytesInto(int32_t columnIndex, sql::bytes& buffer)=0;
+  virtual std::size_t getBytesInto(const SQLString& columnLabel, sql::bytes& buffer)=0;
+  /* Reads up to maxRows next rows into the caller's arrays described by the bindings, and returns the number of rows
+     read. The cursor is left on the last row read. NULL values are stored as 0 or empty strings */
+  virtual std::size_t fetchColumns(std::size_t maxRows, ColumnBinding* columns, std::size_t columnCount)=0;
+  /* Decodes all rows of the result into the arrays described by the bindings, like fetchColumns does, the row i going
+     to the element i - 1. Buffers have to have space for rowsCount() elements. The result is loaded completely first,
+     thus it cannot be forward-only result with fetch size set. Partitions of rows of text protocol results are decoded
+     in parallel by the executor, or by the driver's own threads, if executor is nullptr. The cursor is not moved.
+     Returns the number of rows */
+  virtual std::size_t materializeColumns(ColumnBinding* columns, std::size_t columnCount, TaskExecutor* executor=nullptr)=0;
+  /* Writes the next rows up to the end of the result to the file descriptor, e.g. file, pipe or socket. Values are
+     escaped straight from the row buffers, without creating strings, and the output goes out in bufferSize blocks. With
+     fetch size set, rows are fetched while they are written, thus the memory stays bounded. The cursor is left after
+     the last row. Returns the number of rows written. Throws, if the write fails */
+  virtual int64_t exportTo(int fd, ExportOptions::Format format, const ExportOptions& options=ExportOptions())=0;
+  /* Reads DATE, DATETIME, TIMESTAMP, TIME or YEAR value, or the string in one of their formats, into the struct without
+     creating the string representation. Returns false for NULL and zero dates, and the value is zeroed then */
+  virtual bool getDateTime(int32_t columnIndex, DateTime& value)=0;
+  virtual bool getDateTime(const SQLString& columnLabel, DateTime& value)=0;
+  /* Reads DECIMAL, integer, or the string value with the decimal number, without conversion to the floating point.
+     Throws, if the value has more than 38 digits. Returns false for NULL, and the value is zeroed then */
+  virtual bool getDecimal(int32_t columnIndex, Decimal& value)=0;
+  virtual bool getDecimal(const SQLString& columnLabel, Decimal& value)=0;
+  /* Same metadata as getMetaData returns, but created once and owned by the result set, i.e. it's valid while the
+     result set exists. Unlike getMetaData, nothing is allocated or copied by repeated calls */
+  virtual ResultSetMetaData& getMetaDataView()=0;
+  /* Value of the column read with the getter of the type, that is selected at compile time. Specialized for bool,
+     int8_t, int16_t, int32_t, uint32_t, int64_t, uint64_t, float, double, long double and SQLString */
+  template <typename T> T get(int32_t columnIndex);
+  /* Cursor reading the next row into the tuple, column i + 1 into its element i. Getters of the columns are resolved
+     once for the cursor type, thus reading the row does not select them for each value */
+  template <typename... T> TypedCursor<T...> typed();
+  /* Appends up to maxRows next rows to the vector, decoding the columns straight into the members of the structs,
+     as the mapping describes. Column types are checked once for each chunk of rows, and rows are decoded by
+     fetchColumns, thus nothing is called for each value. Returns the number of rows read */
+  template <typename T> std::size_t fetchInto(std::vector<T>& rows, const RowMapping<T>& mapping,
+    std::size_t maxRows= (std::numeric_limits<std::size_t>::max)());
+
 #ifdef RS_UPDATE_FUNCTIONALITY_IMPLEMENTED
 
   virtual void deleteRow()=0;
@@ -283,5 +438,125 @@ public:
 #endif
 };
 
+template <> inline bool ResultSet::get<bool>(int32_t columnIndex) { return getBoolean(columnIndex); }
+template <> inline int8_t ResultSet::get<int8_t>(int32_t columnIndex) { return getByte(columnIndex); }
+template <> inline int16_t ResultSet::get<int16_t>(int32_t columnIndex) { return getShort(columnIndex); }
+template <> inline int32_t ResultSet::get<int32_t>(int32_t columnIndex) { return getInt(columnIndex); }
+template <> inline uint32_t ResultSet::get<uint32_t>(int32_t columnIndex) { return getUInt(columnIndex); }
+template <> inline int64_t ResultSet::get<int64_t>(int32_t columnIndex) { return getLong(columnIndex); }
+template <> inline uint64_t ResultSet::get<uint64_t>(int32_t columnIndex) { return getUInt64(columnIndex); }
+template <> inline float ResultSet::get<float>(int32_t columnIndex) { return getFloat(columnIndex); }
+template <> inline long double ResultSet::get<long double>(int32_t columnIndex) { return getDouble(columnIndex); }
+template <> inline double ResultSet::get<double>(int32_t columnIndex)
+{
+  return static_cast<double>(getDouble(columnIndex));
+}
+template <> inline SQLString ResultSet::get<SQLString>(int32_t columnIndex) { return getString(columnIndex); }
+
+/* Reads rows of the result set into tuples of the types. The cursor does not own the result set. NULL values are
+   read as getters return them, i.e. 0 or the empty string */
+template <typename... T> class TypedCursor
+{
+  typedef std::tuple<T...> Row;
+  ResultSet* rs;
+
+  template <std::size_t I> typename std::enable_if<I == sizeof...(T)>::type read(Row&) {}
+
+  template <std::size_t I> typename std::enable_if<I < sizeof...(T)>::type read(Row& row)
+  {
+    std::get<I>(row)= rs->get<typename std::tuple_element<I, Row>::type>(static_cast<int32_t>(I + 1));
+    read<I + 1>(row);
+  }
+
+public:
+  explicit TypedCursor(ResultSet* _rs) : rs(_rs) {}
+
+  /* Moves to the next row and reads it. Returns false, and the row is not changed, if there are no more rows */
+  bool next(Row& row)
+  {
+    if (!rs->next()) {
+      return false;
+    }
+    read<0>(row);
+    return true;
+  }
+};
+
+template <typename... T> inline TypedCursor<T...> ResultSet::typed()
+{
+  return TypedCursor<T...>(this);
+}
+
+/* Field descriptor of the struct for ResultSet::fetchInto - the column i + 1 is read into the member i. Members can be
+   int32_t, int64_t, uint64_t, double and SQLString, the struct has to be default constructible. NULL values are read as 0
+   or the empty string. Made once for the struct, e.g.
+     static const sql::RowMapping<Order> orderFields(&Order::id, &Order::name, &Order::price); */
+template <typename T> class RowMapping
+{
+  std::vector<ColumnBinding> columns;
+
+  static ColumnBinding::BindType bindType(const int32_t*) { return ColumnBinding::BIND_INT32; }
+  static ColumnBinding::BindType bindType(const int64_t*) { return ColumnBinding::BIND_INT64; }
+  static ColumnBinding::BindType bindType(const uint64_t*) { return ColumnBinding::BIND_UINT64; }
+  static ColumnBinding::BindType bindType(const double*) { return ColumnBinding::BIND_DOUBLE; }
+  static ColumnBinding::BindType bindType(const SQLString*) { return ColumnBinding::BIND_SQLSTRING; }
+
+  void add(const T&) {}
+
+  /* The buffer is the offset of the member in the struct, until the rows to read into are known */
+  template <typename M, typename... Rest> void add(const T& sample, M T::* member, Rest... rest)
+  {
+    const char* base= reinterpret_cast<const char*>(&sample);
+    const M* field= &(sample.*member);
+    ColumnBinding column= {static_cast<int32_t>(columns.size() + 1), bindType(field), nullptr, 0, nullptr, nullptr,
+      sizeof(T)};
+
+    column.bufferLength= static_cast<std::size_t>(reinterpret_cast<const char*>(field) - base);
+    columns.push_back(column);
+    add(sample, rest...);
+  }
+
+public:
+  template <typename... M> explicit RowMapping(M T::*... members)
+  {
+    T sample;
+    columns.reserve(sizeof...(M));
+    add(sample, members...);
+  }
+
+  /* Bindings of the columns to the members of the struct at the address */
+  void bind(T* row, std::vector<ColumnBinding>& bindings) const
+  {
+    bindings= columns;
+    for (auto& column : bindings) {
+      column.buffer= reinterpret_cast<char*>(row) + column.bufferLength;
+      column.bufferLength= 0;
+    }
+  }
+};
+
+template <typename T> std::size_t ResultSet::fetchInto(std::vector<T>& rows, const RowMapping<T>& mapping,
+  std::size_t maxRows)
+{
+  // Rows are added in chunks, so that the vector does not have to be sized for the whole result up front
+  static const std::size_t CHUNK_ROWS= 1024;
+  std::vector<ColumnBinding> bindings;
+  std::size_t first= rows.size(), fetched= 0;
+
+  while (fetched < maxRows) {
+    std::size_t chunk= maxRows - fetched < CHUNK_ROWS ? maxRows - fetched : CHUNK_ROWS;
+
+    rows.resize(first + fetched + chunk);
+    mapping.bind(rows.data() + first + fetched, bindings);
+    std::size_t read= fetchColumns(chunk, bindings.data(), bindings.size());
+    fetched+= read;
+    if (read < chunk) {
+      break;
+    }
+  }
+  rows.resize(first + fetched);
+  return fetched;
+}
+
 }
 #endif
@@ -36,7 +36,14 @@ class MARIADB_EXPORTED SQLString final {
 
   friend class StringImp;
 
+/* With MARIADB_INLINE_SQLSTRING the string is stored in the object itself, and short strings do not need any heap
+   allocation. That changes the layout of the class, and thus the ABI - the library and the application have to be
+   built with the same setting */
+#ifdef MARIADB_INLINE_SQLSTRING
+  std::string theString;
+#else
   std::unique_ptr<StringImp> theString;
+#endif
 public:
   SQLString(const SQLString&);
   SQLString(SQLString&&); //Move constructor
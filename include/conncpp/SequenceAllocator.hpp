@@ -0,0 +1,54 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+
+#ifndef _SEQUENCEALLOCATOR_H_
+#define _SEQUENCEALLOCATOR_H_
+
+#include <cstdint>
+
+#include "buildconf.hpp"
+
+namespace sql
+{
+/* Hands out values of the SEQUENCE without the round trip per value. One NEXT VALUE FOR the sequence claims the block
+   of values from the one it returns up to the next one, i.e. as many values as the sequence's INCREMENT is. Thus the
+   sequence has to be created with INCREMENT BY the block size, and all its users have to take its values in blocks.
+   Values of the current block are handed out by the atomic counter. The next block is claimed in the background, once
+   half of the current one is used, if the connection is thread safe (threadSafeConnection option), and when the block
+   runs out otherwise. Values are unique, but are not ordered across the clients. next() is thread safe. The allocator
+   uses the connection, and must not outlive it */
+class MARIADB_EXPORTED SequenceAllocator {
+  SequenceAllocator(const SequenceAllocator &);
+  void operator=(SequenceAllocator &);
+public:
+  SequenceAllocator() {}
+  virtual ~SequenceAllocator(){}
+
+  /* Next value of the sequence. Throws the exception of the claim of the new block, if the block has run out */
+  virtual int64_t next()=0;
+  /* Number of values in the block, i.e. the sequence's INCREMENT */
+  virtual int64_t getBlockSize()=0;
+  /* Waits for the block being claimed in the background. Values of the current block are lost */
+  virtual void close()=0;
+};
+
+}
+#endif
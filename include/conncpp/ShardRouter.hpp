@@ -0,0 +1,110 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+
+#ifndef _SHARDROUTER_H_
+#define _SHARDROUTER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "buildconf.hpp"
+#include "SQLString.hpp"
+#include "Connection.hpp"
+#include "ResultSet.hpp"
+
+namespace sql
+{
+/* Maps the shard key to the index of the shard in [0, shardCount). It is called from different threads at the same
+   time, so it has to be thread safe */
+class MARIADB_EXPORTED ShardFunction {
+  ShardFunction(const ShardFunction &);
+  void operator=(ShardFunction &);
+public:
+  ShardFunction() {}
+  virtual ~ShardFunction(){}
+
+  virtual uint32_t shardOf(const SQLString& key, uint32_t shardCount)=0;
+};
+
+/* Range table for integer keys. The shard i gets keys from lowerBounds[i] till lowerBounds[i+1], the last one - all
+   keys from its bound up, and keys below the first bound go to the first shard. Bounds have to be sorted */
+class RangeShardFunction : public ShardFunction {
+  const std::vector<int64_t> lowerBounds;
+public:
+  RangeShardFunction(const std::vector<int64_t>& bounds) : lowerBounds(bounds) {}
+
+  uint32_t shardOf(const SQLString& key, uint32_t shardCount) override
+  {
+    int64_t value= std::stoll(key.c_str());
+    uint32_t shard= 0;
+    while (shard + 1 < lowerBounds.size() && shard + 1 < shardCount && value >= lowerBounds[shard + 1]) {
+      ++shard;
+    }
+    return shard;
+  }
+};
+
+/* Rows of the query executed on several shards. Shards execute the query in parallel, and their rows are read one
+   shard after another, in the order the shards have been given, as they arrive. The current row is read from
+   current() */
+class MARIADB_EXPORTED ShardedResult {
+  ShardedResult(const ShardedResult &);
+  void operator=(ShardedResult &);
+public:
+  ShardedResult() {}
+  virtual ~ShardedResult(){}
+
+  /* Moves to the next row. False, when rows of all shards have been read */
+  virtual bool next()=0;
+  /* Result set of the shard, that the current row is from. Its cursor is on the row. Owned by the ShardedResult */
+  virtual ResultSet* current()=0;
+  /* Index of the shard, that the current row is from */
+  virtual uint32_t currentShard()=0;
+  /* Closes result sets, and gives the connections back */
+  virtual void close()=0;
+};
+
+/* Routes work to shards, each of which is the host group of its own url. Connections of each shard come from its own
+   pool, unless the pool option is set to false. The shard of the key is decided by the ShardFunction, by default it's
+   the hash of the key. Object can be used from different threads at the same time */
+class MARIADB_EXPORTED ShardRouter {
+  ShardRouter(const ShardRouter &);
+  void operator=(ShardRouter &);
+public:
+  ShardRouter() {}
+  virtual ~ShardRouter(){}
+
+  virtual uint32_t getShardCount()=0;
+  virtual uint32_t shardOf(const SQLString& key)=0;
+  /* Connection to the shard of the key, e.g. to execute statements for the key. Closing of the connection gives it
+     back to the shard's pool */
+  virtual Connection* getConnection(const SQLString& key)=0;
+  virtual Connection* getShardConnection(uint32_t shard)=0;
+  /* Executes the query on the given shards in parallel. Rows are fetched in portions of fetchSize, 0 reads each shard's
+     result as a whole. The caller owns the result */
+  virtual ShardedResult* executeQuery(const SQLString& sql, const std::vector<uint32_t>& shards, int32_t fetchSize= 0)=0;
+  /* Executes the query on all shards */
+  virtual ShardedResult* executeQueryOnAll(const SQLString& sql, int32_t fetchSize= 0)=0;
+};
+
+}
+#endif
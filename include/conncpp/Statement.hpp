@@ -26,10 +26,26 @@
 #include "ResultSet.hpp"
 #include "Warning.hpp"
 #include "Connection.hpp"
+#include "AsyncExecution.hpp"
+#include "Metrics.hpp"
+#include "Exception.hpp"
+
+#include <type_traits>
 
 namespace sql
 {
 
+/* The type, in that executeScalar reads the value for T - 64 bit integer for integer types, double for floating point
+   ones, and SQLString */
+template<typename T> struct ScalarType
+{
+  typedef typename std::conditional<std::is_floating_point<T>::value, double, int64_t>::type type;
+};
+template<> struct ScalarType<SQLString>
+{
+  typedef SQLString type;
+};
+
 class MARIADB_EXPORTED Statement {
   Statement(const Statement &);
   void operator=(Statement &);
@@ -105,6 +121,71 @@ public:
   virtual void closeOnCompletion()=0;
   virtual bool isCloseOnCompletion()=0;
   virtual Statement* setResultSetType(int32_t rsType)=0;
+
+  /* Starts non-blocking execution of the query. Returned handle is owned by the caller */
+  virtual AsyncExecution* executeAsync(const SQLString& sql)=0;
+
+  /* Marks the statement as safe to execute once more on a new connection, if the connection is lost during the
+     execution. Has effect only with retryOnFailover option. Reads are retried without marking */
+  virtual void setRetryable(bool retryable)=0;
+  virtual bool isRetryable()=0;
+
+  /* Query timeout with milliseconds precision. Timeouts, that are not whole seconds, are enforced on the client side */
+  virtual int64_t getQueryTimeoutMs()=0;
+  virtual void setQueryTimeoutMs(int64_t milliseconds)=0;
+
+  /* Non-throwing execute(). Returns false, if the query failed, and fills the error. The error of the server is
+     returned without creating an exception on the way. Results are available the same way as after execute() */
+  virtual bool tryExecute(const SQLString& sql, ErrorInfo& error) noexcept=0;
+
+  /* Results of the last batch as they came from the server, without conversion. Valid until the next execution or
+     close of the statement. One element per command sent to the server - i.e. per chunk, if the batch has been
+     rewritten. Failed commands have EXECUTE_FAILED count */
+  virtual void getBatchUpdateCounts(const int64_t*& counts, std::size_t& size)=0;
+  /* The first id generated by each command, aligned with getBatchUpdateCounts, or 0. The ids of the command are the
+     range of counts[i] ids starting from ids[i], with the increment(auto_increment_increment) step */
+  virtual void getBatchInsertIds(const int64_t*& ids, std::size_t& size, int32_t& increment)=0;
+
+  /* The id generated by the last executed query, as the server has reported it, without generated keys result set.
+     For batches, the first id generated by the last command, that has generated any(see getBatchInsertIds for
+     all). 0, if there is no such id. Does not require RETURN_GENERATED_KEYS */
+  virtual int64_t getLastInsertId()=0;
+
+  /* Moves count results forward, as count calls of getMoreResults() would do, but rows of the text results in between
+     are discarded as they are read off the connection - they are neither stored nor decoded. Returns what the last
+     getMoreResults() would */
+  virtual bool skipResults(int32_t count)=0;
+
+  /* With ttl > 0, results of executeQuery are served from the process wide result cache, if the driver has it
+     enabled, for ttl milliseconds. For queries, that rarely change, e.g. configuration and lookup tables. 0 turns
+     it off. The same may be set for the query with the RESULT_CACHE(ttl) comment at its start */
+  virtual void setResultCacheTtl(int64_t milliseconds)=0;
+  virtual int64_t getResultCacheTtl()=0;
+
+  /* Executes the query and returns the value of the first column of its first row, e.g. of SELECT COUNT(*), or T() if
+     there was no row or the value is NULL. The value is read right off the connection, and the rest of the result is
+     skipped - no ResultSet is created. Integer, floating point types and SQLString are supported */
+  template<typename T> T executeScalar(const SQLString& sql)
+  {
+    static_assert(std::is_arithmetic<T>::value || std::is_same<T, SQLString>::value,
+      "executeScalar supports integer, floating point types and SQLString");
+    typename ScalarType<T>::type value{};
+    executeScalar(sql, value);
+    return static_cast<T>(value);
+  }
+  /* executeScalar in the type, that the value is read in. Return false, if there was no row or the value is NULL */
+  virtual bool executeScalar(const SQLString& sql, int64_t& value)=0;
+  virtual bool executeScalar(const SQLString& sql, double& value)=0;
+  virtual bool executeScalar(const SQLString& sql, SQLString& value)=0;
+
+  /* Byte budget of the chunk of the streamed result. Rows are read until their data reach it, so that wide rows don't
+     blow the memory, and narrow ones don't cost round trips. Without the fetch size it streams the result alone. 0
+     means no budget */
+  virtual std::size_t getFetchBytes()=0;
+  virtual void setFetchBytes(std::size_t bytes)=0;
+
+  /* Breakdown of the time, traffic and round trips of the last execution. Valid until the next execution */
+  virtual const ExecutionStats& getLastExecutionStats()=0;
 };
 
 }
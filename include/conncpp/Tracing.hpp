@@ -0,0 +1,69 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _TRACING_H_
+#define _TRACING_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "buildconf.hpp"
+
+namespace sql
+{
+/* Attributes of the span of a database operation. Pointers are valid only during the callback */
+struct SpanAttributes
+{
+  /* "connect", "query", "prepare", "execute" or "batch" */
+  const char* operation= nullptr;
+  /* Query text as it was given to the driver, and its digest - the text with literals replaced by ? and whitespace
+     collapsed, that is the same for all executions of the same statement. Both are nullptr for connect. For batch of
+     different queries it's the first query */
+  const char* sql= nullptr;
+  std::size_t sqlLength= 0;
+  const char* digest= nullptr;
+  const char* host= nullptr;
+  int32_t port= 0;
+  /* Number of queries or parameter sets in the batch, 1 for other operations */
+  std::size_t batchSize= 1;
+  /* Members below are set for the end of the span. serverThreadId of the connect span is known only at the end */
+  int64_t serverThreadId= 0;
+  /* Rows fetched while the span was open. Rows of streamed results are fetched later, and are not counted */
+  uint64_t rowCount= 0;
+  uint64_t bytesSent= 0;
+  uint64_t bytesReceived= 0;
+  bool failed= false;
+};
+
+/* Receiver of the driver's spans, e.g. adapter to OpenTelemetry tracer. Callbacks are called from the thread doing the
+   operation, and should be quick. The span handle returned by startSpan is passed to endSpan as is */
+class MARIADB_EXPORTED Tracer {
+  Tracer(const Tracer &);
+  void operator=(Tracer &);
+public:
+  Tracer() {}
+  virtual ~Tracer(){}
+
+  virtual void* startSpan(const SpanAttributes& attributes)=0;
+  virtual void endSpan(void* span, const SpanAttributes& attributes)=0;
+};
+
+}
+#endif
@@ -0,0 +1,598 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ArrowExport.hpp"
+#include "ResultSet.hpp"
+#include "PreparedStatement.hpp"
+#include "ResultSetMetaData.hpp"
+#include "Types.hpp"
+#include "Exception.hpp"
+
+namespace sql
+{
+namespace
+{
+  enum ArrowKind {
+    ARROW_INT64,
+    ARROW_UINT64,
+    ARROW_FLOAT64,
+    ARROW_DATE32,
+    ARROW_TIMESTAMP_US,
+    ARROW_DURATION_US,
+    ARROW_UTF8,
+    ARROW_BINARY
+  };
+
+  const char* arrowFormat[]= {"l", "L", "g", "tdD", "tsu:", "tDu", "u", "z"};
+
+  const int64_t MICROS_PER_SECOND= 1000000;
+
+  /* Private data of the column array. Fixed size values go to values64, or to values32 for date32, offsets of var-length
+     values go to values32. Validity bits are kept for all rows, and are exported only if there are NULLs */
+  struct ArrowColumn
+  {
+    ArrowKind kind;
+    int64_t nullCount= 0;
+    std::vector<uint8_t> validity;
+    std::vector<int64_t> values64;
+    std::vector<int32_t> values32;
+    std::string data;
+    const void* buffers[3];
+
+    ArrowColumn(ArrowKind _kind) : kind(_kind)
+    {
+      if (kind == ARROW_UTF8 || kind == ARROW_BINARY) {
+        values32.push_back(0);
+      }
+    }
+
+    bool isVarLength() const { return kind == ARROW_UTF8 || kind == ARROW_BINARY; }
+  };
+
+  struct ArrowBatch
+  {
+    std::vector<ArrowArray> children;
+    std::vector<ArrowArray*> childPointers;
+    const void* buffers[1]= {nullptr};
+  };
+
+  struct ArrowBatchSchema
+  {
+    std::vector<ArrowSchema> children;
+    std::vector<ArrowSchema*> childPointers;
+  };
+
+
+  ArrowKind arrowKind(ResultSetMetaData& md, uint32_t column)
+  {
+    switch (md.getColumnType(column)) {
+    case Types::BIT:
+    case Types::BOOLEAN:
+    case Types::TINYINT:
+    case Types::SMALLINT:
+    case Types::INTEGER:
+      return ARROW_INT64;
+    case Types::BIGINT:
+      return md.isSigned(column) ? ARROW_INT64 : ARROW_UINT64;
+    case Types::FLOAT:
+    case Types::REAL:
+    case Types::DOUBLE:
+      return ARROW_FLOAT64;
+    case Types::DATE:
+      return ARROW_DATE32;
+    case Types::TIMESTAMP:
+      return ARROW_TIMESTAMP_US;
+    case Types::TIME:
+      return ARROW_DURATION_US;
+    case Types::BINARY:
+    case Types::VARBINARY:
+    case Types::LONGVARBINARY:
+    case Types::BLOB:
+      // TEXT columns have BLOB type as well
+      return std::strstr(md.getColumnTypeName(column).c_str(), "TEXT") == nullptr ? ARROW_BINARY : ARROW_UTF8;
+    default:
+      return ARROW_UTF8;
+    }
+  }
+
+  /* Number of days since 1970-01-01 of the proleptic Gregorian calendar date */
+  int64_t daysFromCivil(int64_t year, uint32_t month, uint32_t day)
+  {
+    year-= month <= 2 ? 1 : 0;
+    int64_t era= (year >= 0 ? year : year - 399) / 400;
+    int64_t yearOfEra= year - era*400;
+    int64_t dayOfYear= (153*(month > 2 ? month - 3 : month + 9) + 2)/5 + day - 1;
+    int64_t dayOfEra= yearOfEra*365 + yearOfEra/4 - yearOfEra/100 + dayOfYear;
+
+    return era*146097 + dayOfEra - 719468;
+  }
+
+  int64_t timeMicros(const DateTime& value)
+  {
+    return (value.hour*3600LL + value.minute*60 + value.second)*MICROS_PER_SECOND + value.nanos/1000;
+  }
+
+
+  void appendValue(ResultSet* rs, int32_t columnIndex, ArrowColumn& column, std::size_t row)
+  {
+    bool isNull= false;
+
+    switch (column.kind) {
+    case ARROW_INT64:
+    {
+      int64_t value= rs->getLong(columnIndex);
+      isNull= rs->wasNull();
+      column.values64.push_back(isNull ? 0 : value);
+      break;
+    }
+    case ARROW_UINT64:
+    {
+      uint64_t value= rs->getUInt64(columnIndex);
+      isNull= rs->wasNull();
+      column.values64.push_back(isNull ? 0 : static_cast<int64_t>(value));
+      break;
+    }
+    case ARROW_FLOAT64:
+    {
+      double value= static_cast<double>(rs->getDouble(columnIndex));
+      int64_t bits= 0;
+      isNull= rs->wasNull();
+      if (!isNull) {
+        std::memcpy(&bits, &value, sizeof(bits));
+      }
+      column.values64.push_back(bits);
+      break;
+    }
+    case ARROW_DATE32:
+    case ARROW_TIMESTAMP_US:
+    case ARROW_DURATION_US:
+    {
+      DateTime value;
+      isNull= !rs->getDateTime(columnIndex, value);
+      if (column.kind == ARROW_DURATION_US) {
+        int64_t micros= timeMicros(value);
+        column.values64.push_back(value.negative ? -micros : micros);
+        break;
+      }
+      // YEAR as the DATE has zero month and day
+      int64_t days= isNull ? 0 : daysFromCivil(value.year, value.month > 0 ? value.month : 1, value.day > 0 ? value.day : 1);
+      if (column.kind == ARROW_DATE32) {
+        column.values32.push_back(static_cast<int32_t>(days));
+      }
+      else {
+        column.values64.push_back(isNull ? 0 : days*86400*MICROS_PER_SECOND + timeMicros(value));
+      }
+      break;
+    }
+    default:
+    {
+      std::size_t length= 0;
+      const char* value= rs->getStringView(columnIndex, length);
+      isNull= value == nullptr;
+      if (!isNull) {
+        if (column.data.length() + length > static_cast<std::size_t>(INT32_MAX)) {
+          throw SQLException("Values of the column exceed 2GB in the Arrow batch, the batch has to have fewer rows", "HY000");
+        }
+        column.data.append(value, length);
+      }
+      column.values32.push_back(static_cast<int32_t>(column.data.length()));
+    }
+    }
+
+    if ((row & 7) == 0) {
+      column.validity.push_back(0);
+    }
+    if (isNull) {
+      ++column.nullCount;
+    }
+    else {
+      column.validity.back()|= static_cast<uint8_t>(1 << (row & 7));
+    }
+  }
+
+
+  void releaseColumnArray(ArrowArray* array)
+  {
+    delete static_cast<ArrowColumn*>(array->private_data);
+    array->release= nullptr;
+  }
+
+
+  void releaseBatchArray(ArrowArray* array)
+  {
+    ArrowBatch* batch= static_cast<ArrowBatch*>(array->private_data);
+
+    // The consumer may have moved children out, and then their release is nullptr
+    for (auto& child : batch->children) {
+      if (child.release != nullptr) {
+        child.release(&child);
+      }
+    }
+    delete batch;
+    array->release= nullptr;
+  }
+
+
+  void releaseColumnSchema(ArrowSchema* schema)
+  {
+    delete static_cast<std::string*>(schema->private_data);
+    schema->release= nullptr;
+  }
+
+
+  void releaseBatchSchema(ArrowSchema* schema)
+  {
+    ArrowBatchSchema* batch= static_cast<ArrowBatchSchema*>(schema->private_data);
+
+    for (auto& child : batch->children) {
+      if (child.release != nullptr) {
+        child.release(&child);
+      }
+    }
+    delete batch;
+    schema->release= nullptr;
+  }
+
+
+  void exportColumn(std::unique_ptr<ArrowColumn> column, int64_t length, ArrowArray& array)
+  {
+    // Buffers are never nullptr, even if empty, except the validity bitmap of the column without NULLs
+    static int64_t emptyBuffer= 0;
+
+    column->buffers[0]= column->nullCount > 0 ? column->validity.data() : nullptr;
+    if (column->isVarLength()) {
+      column->buffers[1]= column->values32.data();
+      column->buffers[2]= column->data.empty() ? static_cast<const void*>(&emptyBuffer) : column->data.data();
+    }
+    else if (column->kind == ARROW_DATE32) {
+      column->buffers[1]= column->values32.data();
+    }
+    else {
+      column->buffers[1]= column->values64.data();
+    }
+
+    array.length= length;
+    array.null_count= column->nullCount;
+    array.offset= 0;
+    array.n_buffers= column->isVarLength() ? 3 : 2;
+    array.n_children= 0;
+    array.buffers= column->buffers;
+    array.children= nullptr;
+    array.dictionary= nullptr;
+    array.release= releaseColumnArray;
+    array.private_data= column.release();
+  }
+
+
+  void exportSchema(ResultSetMetaData& md, const std::vector<ArrowKind>& kinds, ArrowSchema* schema)
+  {
+    std::unique_ptr<ArrowBatchSchema> batch(new ArrowBatchSchema());
+
+    batch->children.resize(kinds.size());
+    for (std::size_t i= 0; i < kinds.size(); ++i) {
+      ArrowSchema& child= batch->children[i];
+      std::string* name= new std::string(md.getColumnLabel(static_cast<uint32_t>(i + 1)).c_str());
+
+      child.format= arrowFormat[kinds[i]];
+      child.name= name->c_str();
+      child.metadata= nullptr;
+      child.flags= ARROW_FLAG_NULLABLE;
+      child.n_children= 0;
+      child.children= nullptr;
+      child.dictionary= nullptr;
+      child.release= releaseColumnSchema;
+      child.private_data= name;
+      batch->childPointers.push_back(&child);
+    }
+
+    schema->format= "+s";
+    schema->name= "";
+    schema->metadata= nullptr;
+    schema->flags= 0;
+    schema->n_children= static_cast<int64_t>(kinds.size());
+    schema->children= batch->childPointers.data();
+    schema->dictionary= nullptr;
+    schema->release= releaseBatchSchema;
+    schema->private_data= batch.release();
+  }
+
+  /* Proleptic Gregorian calendar date of the number of days since 1970-01-01 */
+  void civilFromDays(int64_t days, int64_t& year, uint32_t& month, uint32_t& day)
+  {
+    days+= 719468;
+    int64_t era= (days >= 0 ? days : days - 146096) / 146097;
+    int64_t dayOfEra= days - era*146097;
+    int64_t yearOfEra= (dayOfEra - dayOfEra/1460 + dayOfEra/36524 - dayOfEra/146096) / 365;
+    int64_t dayOfYear= dayOfEra - (365*yearOfEra + yearOfEra/4 - yearOfEra/100);
+    int64_t mp= (5*dayOfYear + 2)/153;
+
+    day= static_cast<uint32_t>(dayOfYear - (153*mp + 2)/5 + 1);
+    month= static_cast<uint32_t>(mp < 10 ? mp + 3 : mp - 9);
+    year= yearOfEra + era*400 + (month <= 2 ? 1 : 0);
+  }
+
+  /* Conversion buffers of the imported column. They have to live till the statement is executed */
+  struct ArrowParameter
+  {
+    std::vector<char> indicators;
+    std::vector<int64_t> ints;
+    std::vector<double> doubles;
+    std::vector<const char*> pointers;
+    std::vector<unsigned long> lengths;
+    std::string text;
+  };
+
+  bool isValid(const ArrowArray& column, int64_t row)
+  {
+    const uint8_t* validity= static_cast<const uint8_t*>(column.buffers[0]);
+    return validity == nullptr || (validity[row >> 3] & (1 << (row & 7))) != 0;
+  }
+
+  template <typename T> const T* arrowValues(const ArrowArray& column, int64_t offset)
+  {
+    return static_cast<const T*>(column.buffers[1]) + offset;
+  }
+
+  template <typename T, typename V> void widenValues(const ArrowArray& column, int64_t offset, int64_t rows,
+    std::vector<V>& values)
+  {
+    const T* source= arrowValues<T>(column, offset);
+    values.assign(source, source + rows);
+  }
+
+  /* Values of offset and var-length data buffers */
+  template <typename T> void bindVarLength(const ArrowArray& column, int64_t offset, int64_t rows, ArrowParameter& param)
+  {
+    const T* offsets= arrowValues<T>(column, offset);
+    const char* data= static_cast<const char*>(column.buffers[2]);
+
+    param.pointers.reserve(static_cast<std::size_t>(rows));
+    param.lengths.reserve(static_cast<std::size_t>(rows));
+    for (int64_t i= 0; i < rows; ++i) {
+      param.pointers.push_back(data + offsets[i]);
+      param.lengths.push_back(static_cast<unsigned long>(offsets[i + 1] - offsets[i]));
+    }
+  }
+
+  /* Strings go to one buffer, and pointers to them are taken, when it does not grow anymore */
+  void textToPointers(ArrowParameter& param)
+  {
+    std::size_t position= 0;
+
+    param.pointers.reserve(param.lengths.size());
+    for (unsigned long length : param.lengths) {
+      param.pointers.push_back(param.text.data() + position);
+      position+= length;
+    }
+  }
+
+  void appendText(ArrowParameter& param, const char* value, int length)
+  {
+    param.text.append(value, length > 0 ? static_cast<std::size_t>(length) : 0);
+    param.lengths.push_back(static_cast<unsigned long>(length > 0 ? length : 0));
+  }
+
+  void appendTimestamp(ArrowParameter& param, int64_t value, int64_t unitsPerSecond, bool withTime)
+  {
+    int64_t seconds= value / unitsPerSecond, fraction= value % unitsPerSecond;
+    if (fraction < 0) {
+      fraction+= unitsPerSecond;
+      --seconds;
+    }
+    int64_t days= seconds / 86400, secondOfDay= seconds % 86400;
+    if (secondOfDay < 0) {
+      secondOfDay+= 86400;
+      --days;
+    }
+    int64_t year;
+    uint32_t month, day;
+    char buffer[40];
+    civilFromDays(days, year, month, day);
+
+    if (!withTime) {
+      appendText(param, buffer, std::snprintf(buffer, sizeof(buffer), "%04lld-%02u-%02u", static_cast<long long>(year),
+        month, day));
+      return;
+    }
+    // Fraction in microseconds, that is the server's precision
+    int64_t micros= unitsPerSecond >= 1000000 ? fraction / (unitsPerSecond / 1000000) : fraction * (1000000 / unitsPerSecond);
+    appendText(param, buffer, std::snprintf(buffer, sizeof(buffer), "%04lld-%02u-%02u %02u:%02u:%02u.%06u",
+      static_cast<long long>(year), month, day, static_cast<uint32_t>(secondOfDay / 3600),
+      static_cast<uint32_t>(secondOfDay / 60 % 60), static_cast<uint32_t>(secondOfDay % 60), static_cast<uint32_t>(micros)));
+  }
+
+
+  void bindColumn(PreparedStatement* ps, int32_t parameterIndex, const ArrowSchema& field, const ArrowArray& column,
+    int64_t offset, int64_t rows, ArrowParameter& param)
+  {
+    const std::string format(field.format);
+    const char* indicators= nullptr;
+    std::size_t count= static_cast<std::size_t>(rows);
+
+    if (column.null_count != 0 && column.buffers[0] != nullptr) {
+      param.indicators.reserve(count);
+      for (int64_t i= 0; i < rows; ++i) {
+        param.indicators.push_back(isValid(column, offset + i) ? 0 : 1);
+      }
+      indicators= param.indicators.data();
+    }
+
+    if (format == "l") {
+      ps->setArray(parameterIndex, arrowValues<int64_t>(column, offset), indicators, count);
+    }
+    else if (format == "i") {
+      ps->setArray(parameterIndex, arrowValues<int32_t>(column, offset), indicators, count);
+    }
+    else if (format == "g") {
+      ps->setArray(parameterIndex, arrowValues<double>(column, offset), indicators, count);
+    }
+    else if (format == "u" || format == "z") {
+      bindVarLength<int32_t>(column, offset, rows, param);
+      ps->setArray(parameterIndex, param.pointers.data(), param.lengths.data(), indicators, count);
+    }
+    else if (format == "U" || format == "Z") {
+      bindVarLength<int64_t>(column, offset, rows, param);
+      ps->setArray(parameterIndex, param.pointers.data(), param.lengths.data(), indicators, count);
+    }
+    else if (format == "f") {
+      widenValues<float>(column, offset, rows, param.doubles);
+      ps->setArray(parameterIndex, param.doubles.data(), indicators, count);
+    }
+    else if (format.length() == 1 && std::strchr("cCsSIb", format[0]) != nullptr) {
+      switch (format[0]) {
+      case 'c': widenValues<int8_t>(column, offset, rows, param.ints); break;
+      case 'C': widenValues<uint8_t>(column, offset, rows, param.ints); break;
+      case 's': widenValues<int16_t>(column, offset, rows, param.ints); break;
+      case 'S': widenValues<uint16_t>(column, offset, rows, param.ints); break;
+      case 'I': widenValues<uint32_t>(column, offset, rows, param.ints); break;
+      default:
+        // Boolean values are bits, like validity
+        const uint8_t* bits= static_cast<const uint8_t*>(column.buffers[1]);
+        param.ints.reserve(count);
+        for (int64_t i= 0; i < rows; ++i) {
+          param.ints.push_back((bits[(offset + i) >> 3] >> ((offset + i) & 7)) & 1);
+        }
+      }
+      ps->setArray(parameterIndex, param.ints.data(), indicators, count);
+    }
+    else if (format == "L" || format == "tdD" || format == "tdm" || (format.length() == 4 && format.compare(0, 2, "ts") == 0
+      && std::strchr("smun", format[2]) != nullptr && format[3] == ':')) {
+      param.lengths.reserve(count);
+      for (int64_t i= 0; i < rows; ++i) {
+        if (!isValid(column, offset + i)) {
+          param.lengths.push_back(0);
+        }
+        else if (format == "L") {
+          std::string value(std::to_string(arrowValues<uint64_t>(column, offset)[i]));
+          appendText(param, value.c_str(), static_cast<int>(value.length()));
+        }
+        else if (format == "tdD") {
+          appendTimestamp(param, arrowValues<int32_t>(column, offset)[i]*86400LL, 1, false);
+        }
+        else if (format == "tdm") {
+          appendTimestamp(param, arrowValues<int64_t>(column, offset)[i], 1000, false);
+        }
+        else {
+          static const int64_t unitsPerSecond[]= {1, 1000, 1000000, 1000000000};
+          appendTimestamp(param, arrowValues<int64_t>(column, offset)[i],
+            unitsPerSecond[std::strchr("smun", format[2]) - "smun"], true);
+        }
+      }
+      textToPointers(param);
+      ps->setArray(parameterIndex, param.pointers.data(), param.lengths.data(), indicators, count);
+    }
+    else {
+      std::string error("Arrow format '" + format + "' of the column " + std::to_string(parameterIndex) + " is not supported");
+      throw SQLException(error.c_str(), "HYC00");
+    }
+  }
+}
+
+
+  std::size_t exportArrowBatch(ResultSet* rs, std::size_t maxRows, ArrowSchema* schema, ArrowArray* array)
+  {
+    ResultSetMetaData& md= rs->getMetaDataView();
+    uint32_t columnCount= md.getColumnCount();
+    std::vector<ArrowKind> kinds;
+    std::vector<std::unique_ptr<ArrowColumn>> columns;
+    std::size_t rows= 0;
+
+    schema->release= nullptr;
+    array->release= nullptr;
+
+    kinds.reserve(columnCount);
+    columns.reserve(columnCount);
+    for (uint32_t i= 1; i <= columnCount; ++i) {
+      kinds.push_back(arrowKind(md, i));
+      columns.emplace_back(new ArrowColumn(kinds.back()));
+    }
+
+    while (rows < maxRows && rs->next()) {
+      for (uint32_t i= 0; i < columnCount; ++i) {
+        appendValue(rs, static_cast<int32_t>(i + 1), *columns[i], rows);
+      }
+      ++rows;
+    }
+    if (rows == 0) {
+      return 0;
+    }
+
+    std::unique_ptr<ArrowBatch> batch(new ArrowBatch());
+    batch->children.resize(columnCount);
+    batch->childPointers.reserve(columnCount);
+    // The last thing, that may throw, so nothing has to be released on error
+    exportSchema(md, kinds, schema);
+
+    for (uint32_t i= 0; i < columnCount; ++i) {
+      exportColumn(std::move(columns[i]), static_cast<int64_t>(rows), batch->children[i]);
+      batch->childPointers.push_back(&batch->children[i]);
+    }
+
+    array->length= static_cast<int64_t>(rows);
+    array->null_count= 0;
+    array->offset= 0;
+    array->n_buffers= 1;
+    array->n_children= static_cast<int64_t>(columnCount);
+    array->buffers= batch->buffers;
+    array->children= batch->childPointers.data();
+    array->dictionary= nullptr;
+    array->release= releaseBatchArray;
+    array->private_data= batch.release();
+
+    return rows;
+  }
+
+
+  const sql::Longs& executeArrowBatch(PreparedStatement* ps, const ArrowSchema* schema, const ArrowArray* array)
+  {
+    if (std::strcmp(schema->format, "+s") != 0 || schema->n_children != array->n_children) {
+      throw SQLException("Arrow record batch has to be the struct array with its schema", "HY024");
+    }
+    std::size_t columnCount= static_cast<std::size_t>(array->n_children);
+    std::vector<ArrowParameter> params(columnCount);
+
+    ps->clearBatch();
+    if (array->length == 0) {
+      return ps->executeLargeBatch();
+    }
+    try {
+      for (std::size_t i= 0; i < columnCount; ++i) {
+        const ArrowArray& column= *array->children[i];
+        bindColumn(ps, static_cast<int32_t>(i + 1), *schema->children[i], column, array->offset + column.offset,
+          array->length, params[i]);
+      }
+      const sql::Longs& result= ps->executeLargeBatch();
+      // Bound arrays point to the params, going out of scope
+      ps->clearBatch();
+      return result;
+    }
+    catch (...) {
+      ps->clearBatch();
+      throw;
+    }
+  }
+
+}
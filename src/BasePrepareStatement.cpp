@@ -18,6 +18,8 @@
 *************************************************************************************/
 
 
+#include <typeinfo>
+
 #include "BasePrepareStatement.h"
 
 #include "Results.h"
@@ -25,7 +27,11 @@
 
 #include "MariaDbStatement.h"
 #include "MariaDbConnection.h"
+#include "protocol/MasterProtocol.h"
 #include "ExceptionFactory.h"
+#include "util/DateTimeCodec.h"
+#include "util/DecimalCodec.h"
+#include "util/ResultCache.h"
 
 namespace sql
 {
@@ -55,8 +61,11 @@ namespace mariadb
       autoGeneratedKeys(autoGeneratedKeys),
       useFractionalSeconds(_connection->getProtocol()->getOptions()->useFractionalSeconds),
       noBackslashEscapes(_connection->getProtocol()->noBackslashEscapes()),
+      transcoding(Charset::getTranscoding(_connection->getProtocol()->getOptions()->useCharacterEncoding,
+        _connection->getProtocol()->getOptions()->clientCharacterEncoding, true)),
       exceptionFactory(factory),
-      protocol(connection->getProtocol().get())
+      protocol(connection->getProtocol().get()),
+      directProtocol(dynamic_cast<MasterProtocol*>(protocol))
   {
   }
 
@@ -64,7 +73,7 @@ namespace mariadb
   int64_t BasePrepareStatement::executeLargeUpdate()
   {
     //checkConnectionExists();
-    if (executeInternal(getFetchSize())){
+    if (executeScalarInternal()){
       return 0;
     }
     return getLargeUpdateCount();
@@ -576,6 +585,26 @@ namespace mariadb
     setParameter(parameterIndex, new StringParameter(dt, false));
   }
 
+
+  void BasePrepareStatement::setDateTime(int32_t parameterIndex, const DateTime& value)
+  {
+    char buffer[DateTimeCodec::MAX_LENGTH];
+    uint32_t fractionDigits= useFractionalSeconds ? 6 : 0;
+    std::size_t length= value.year == 0 && value.month == 0 && value.day == 0 ?
+      DateTimeCodec::formatTime(value, fractionDigits, buffer) : DateTimeCodec::formatDateTime(value, fractionDigits, buffer);
+
+    setParameter(parameterIndex, new StringParameter(SQLString(buffer, length), false));
+  }
+
+
+  void BasePrepareStatement::setDecimal(int32_t parameterIndex, const Decimal& value)
+  {
+    char buffer[DecimalCodec::MAX_LENGTH];
+    std::size_t length= DecimalCodec::format(value, buffer);
+
+    setParameter(parameterIndex, new BigDecimalParameter(SQLString(buffer, length)));
+  }
+
   /**
    * Sets the designated parameter to a <code>InputStream</code> object. The inputstream must
    * contain the number of characters specified by length otherwise a <code>SQLException</code> will
@@ -633,6 +662,21 @@ namespace mariadb
     hasLongData= true;
   }
 
+  /**
+   * Sets the designated parameter to the content of the file. The file is mapped to the memory, and the value is sent
+   * from the mapping, in chunks of longDataChunkSize for server side prepared statements.
+   *
+   * @param parameterIndex index of the first parameter is 1, the second is 2, ...
+   * @param path path of the file
+   * @throws SQLException if parameterIndex does not correspond to a parameter marker in the SQL
+   *     statement, or if the file cannot be opened or mapped
+   */
+  void BasePrepareStatement::setBlobFromFile(int32_t parameterIndex, const SQLString& path)
+  {
+    setParameter(parameterIndex, new FileParameter(path, noBackslashEscapes));
+    hasLongData= true;
+  }
+
   /**
    * Sets the designated parameter to SQL <code>NULL</code>.
    *
@@ -1265,6 +1309,21 @@ namespace mariadb
   }
 #endif
 
+  /* Overwrites the value of the holder bound at the index, if it has the same type and may be reused. Otherwise a new
+     holder is created. Thus rebinding of the statement with new values in a loop does not allocate */
+  template <class T, class V, class... Args>
+  void BasePrepareStatement::setValueParameter(int32_t parameterIndex, const V& value, Args... args)
+  {
+    ParameterHolder* current= getReusableParameter(parameterIndex);
+
+    if (current != nullptr && typeid(*current) == typeid(T)) {
+      static_cast<T*>(current)->setValue(value);
+    }
+    else {
+      setParameter(parameterIndex, new T(value, args...));
+    }
+  }
+
   /**
    * Sets the designated parameter to the given Java <code>boolean</code> value. The driver converts
    * this to an SQL <code>BIT</code> or <code>BOOLEAN</code> value when it sends it to the database.
@@ -1277,7 +1336,7 @@ namespace mariadb
    */
   void BasePrepareStatement::setBoolean(int32_t parameterIndex, bool value)
   {
-    setParameter(parameterIndex,new BooleanParameter(value));
+    setValueParameter<BooleanParameter>(parameterIndex, value);
   }
 
   /**
@@ -1292,7 +1351,7 @@ namespace mariadb
    */
   void BasePrepareStatement::setByte(int32_t parameterIndex, int8_t bit)
   {
-    setParameter(parameterIndex,new ByteParameter(bit));
+    setValueParameter<ByteParameter>(parameterIndex, bit);
   }
 
   /**
@@ -1307,7 +1366,7 @@ namespace mariadb
    */
   void BasePrepareStatement::setShort(int32_t parameterIndex,const int16_t value)
   {
-    setParameter(parameterIndex,new ShortParameter(value));
+    setValueParameter<ShortParameter>(parameterIndex, value);
   }
 
   /**
@@ -1326,7 +1385,29 @@ namespace mariadb
       return;
     }*/
 
-    setParameter(parameterIndex,new StringParameter(str, noBackslashEscapes));
+    if (transcoding == Charset::LATIN1_UTF8) {
+      SQLString encoded(str);
+      Charset::encode(transcoding, encoded);
+      setValueParameter<StringParameter>(parameterIndex, encoded, noBackslashEscapes);
+      return;
+    }
+    setValueParameter<StringParameter>(parameterIndex, str, noBackslashEscapes);
+  }
+
+
+  void BasePrepareStatement::setU16String(int32_t parameterIndex, const std::u16string& str)
+  {
+    SQLString encoded;
+    Charset::encodeWide(transcoding, str.data(), str.length(), StringImp::get(encoded));
+    setValueParameter<StringParameter>(parameterIndex, encoded, noBackslashEscapes);
+  }
+
+
+  void BasePrepareStatement::setWString(int32_t parameterIndex, const std::wstring& str)
+  {
+    SQLString encoded;
+    Charset::encodeWide(transcoding, str.data(), str.length(), StringImp::get(encoded));
+    setValueParameter<StringParameter>(parameterIndex, encoded, noBackslashEscapes);
   }
 
   /**
@@ -1351,9 +1432,21 @@ namespace mariadb
     setParameter(parameterIndex, new ByteArrayParameter(*bytes, noBackslashEscapes));
   }
 
+
+  void BasePrepareStatement::setBytes(int32_t parameterIndex, const char* bytes, std::size_t length)
+  {
+    if (bytes == nullptr){
+      setNull(parameterIndex, ColumnType::BLOB);
+      return;
+    }
+    // Wrapping array, the parameter's copy of it wraps the same memory
+    sql::bytes wrapped(const_cast<char*>(bytes), length);
+    setParameter(parameterIndex, new ByteArrayParameter(wrapped, noBackslashEscapes));
+  }
+
   void BasePrepareStatement::setInt(int32_t column, int32_t value)
   {
-    setParameter(column, new IntParameter(value));
+    setValueParameter<IntParameter>(column, value);
   }
 
   /**
@@ -1367,17 +1460,17 @@ namespace mariadb
    *     PreparedStatement</code>
    */
   void BasePrepareStatement::setLong(int32_t parameterIndex, int64_t value) {
-    setParameter(parameterIndex, new LongParameter(value));
+    setValueParameter<LongParameter>(parameterIndex, value);
   }
 
 
   void BasePrepareStatement::setUInt64(int32_t parameterIndex, uint64_t value) {
-    setParameter(parameterIndex, new ULongParameter(value));
+    setValueParameter<ULongParameter>(parameterIndex, value);
   }
 
 
   void BasePrepareStatement::setUInt(int32_t parameterIndex, uint32_t value) {
-    setParameter(parameterIndex, new ULongParameter(value));
+    setValueParameter<ULongParameter>(parameterIndex, static_cast<uint64_t>(value));
   }
 
 
@@ -1387,7 +1480,7 @@ namespace mariadb
       return;
     }*/
 
-    setParameter(parameterIndex, new StringParameter(str, noBackslashEscapes));
+    setValueParameter<StringParameter>(parameterIndex, str, noBackslashEscapes);
   }
 
   /**
@@ -1402,7 +1495,7 @@ namespace mariadb
    */
   void BasePrepareStatement::setFloat(int32_t parameterIndex, float value)
   {
-    setParameter(parameterIndex,new FloatParameter(value));
+    setValueParameter<FloatParameter>(parameterIndex, value);
   }
 
   /**
@@ -1417,7 +1510,48 @@ namespace mariadb
    */
   void BasePrepareStatement::setDouble(int32_t parameterIndex, double value)
   {
-    setParameter(parameterIndex,new DoubleParameter(value));
+    setValueParameter<DoubleParameter>(parameterIndex, value);
+  }
+
+  /* Parameter arrays are bound directly to the C API statement, and that requires server side prepared statement */
+  void BasePrepareStatement::setArray(int32_t /*parameterIndex*/, const int32_t* /*values*/, const char* /*nullIndicators*/,
+    std::size_t /*rows*/)
+  {
+    throw exceptionFactory->notSupported("Parameter arrays are supported only by server side prepared statements");
+  }
+
+
+  void BasePrepareStatement::setArray(int32_t /*parameterIndex*/, const int64_t* /*values*/, const char* /*nullIndicators*/,
+    std::size_t /*rows*/)
+  {
+    throw exceptionFactory->notSupported("Parameter arrays are supported only by server side prepared statements");
+  }
+
+
+  void BasePrepareStatement::setArray(int32_t /*parameterIndex*/, const double* /*values*/, const char* /*nullIndicators*/,
+    std::size_t /*rows*/)
+  {
+    throw exceptionFactory->notSupported("Parameter arrays are supported only by server side prepared statements");
+  }
+
+
+  void BasePrepareStatement::setArray(int32_t /*parameterIndex*/, const char* const* /*values*/, const unsigned long* /*lengths*/,
+    const char* /*nullIndicators*/, std::size_t /*rows*/)
+  {
+    throw exceptionFactory->notSupported("Parameter arrays are supported only by server side prepared statements");
+  }
+
+  /* List parameters are expanded to the prepared statement of the bucket size, and that requires server side prepared
+     statement */
+  void BasePrepareStatement::setList(int32_t /*parameterIndex*/, const int64_t* /*values*/, std::size_t /*count*/)
+  {
+    throw exceptionFactory->notSupported("List parameters are supported only by server side prepared statements");
+  }
+
+
+  void BasePrepareStatement::setList(int32_t /*parameterIndex*/, const SQLString* /*values*/, std::size_t /*count*/)
+  {
+    throw exceptionFactory->notSupported("List parameters are supported only by server side prepared statements");
   }
 
 
@@ -1438,6 +1572,19 @@ namespace mariadb
     */
   ResultSet* BasePrepareStatement::executeQuery()
   {
+    if (ResultCache::isEnabled()) {
+      SQLString query;
+      int64_t ttl= getResultCacheQuery(query);
+
+      if (ttl > 0) {
+        return ResultCache::getInstance().query(protocol, ResultCache::key(protocol, query), ttl, [this]() -> ResultSet* {
+          if (execute()) {
+            return stmt->getInternalResults()->releaseResultSet();
+          }
+          return SelectResultSet::createEmptyResultSet();
+        });
+      }
+    }
     if (execute()) {
       return stmt->getInternalResults()->releaseResultSet();
     }
@@ -1447,12 +1594,174 @@ namespace mariadb
 
   int32_t BasePrepareStatement::executeUpdate()
   {
-    if (execute()) {
+    if (executeScalarInternal()) {
       return 0;
     }
     return getUpdateCount();
   }
 
+  /**
+   * Executes the statement with the text result set, if any, read as the scalar value, instead of the result set.
+   * Server side prepared statements get the result set as usual.
+   *
+   * @return true if the statement has returned a result set
+   */
+  bool BasePrepareStatement::executeScalarInternal()
+  {
+    stmt->setScalarOnly(true);
+    try {
+      executeInternal(0);
+    }
+    catch (...) {
+      stmt->setScalarOnly(false);
+      throw;
+    }
+    stmt->setScalarOnly(false);
+    return stmt->getInternalResults()->hasScalar();
+  }
+
+  /**
+   * Executes the statement, and returns the value of the first column of the first row.
+   *
+   * @param value the value
+   * @return false, if there was no row, or the value is NULL
+   */
+  bool BasePrepareStatement::executeScalar(int64_t& value)
+  {
+    executeScalarInternal();
+    return stmt->getInternalResults()->getScalar(value);
+  }
+
+
+  bool BasePrepareStatement::executeScalar(double& value)
+  {
+    executeScalarInternal();
+    return stmt->getInternalResults()->getScalar(value);
+  }
+
+
+  bool BasePrepareStatement::executeScalar(SQLString& value)
+  {
+    executeScalarInternal();
+    return stmt->getInternalResults()->getScalar(value);
+  }
+
+  /* Resets the statement's values, once executeWith is done, also if it has thrown */
+  class BoundValues
+  {
+    const ParameterValue*& bound;
+
+  public:
+    BoundValues(const ParameterValue*& _bound, const ParameterValue* values) : bound(_bound) { bound= values; }
+    ~BoundValues() { bound= nullptr; }
+  };
+
+
+  bool BasePrepareStatement::executeValues(const ParameterValue* values, std::size_t count)
+  {
+    BoundValues bound(boundValues, values);
+    boundValuesCount= count;
+    return executeInternal(getFetchSize());
+  }
+
+
+  ResultSet* BasePrepareStatement::executeQueryValues(const ParameterValue* values, std::size_t count)
+  {
+    if (executeValues(values, count)) {
+      return stmt->getInternalResults()->releaseResultSet();
+    }
+    return SelectResultSet::createEmptyResultSet();
+  }
+
+
+  void BasePrepareStatement::validValues(std::size_t parameterCount)
+  {
+    if (boundValuesCount != parameterCount) {
+      exceptionFactory->raiseStatementError(connection, stmt.get())->create("The statement has "
+        + std::to_string(parameterCount) + " parameters, but " + std::to_string(boundValuesCount)
+        + " values have been given", "07001").Throw();
+    }
+  }
+
+
+  void BasePrepareStatement::setValues(PreparedStatement* statement, const ParameterValue* values, std::size_t count,
+    int32_t firstIndex)
+  {
+    for (std::size_t i= 0; i < count; ++i) {
+      const ParameterValue& value= values[i];
+      int32_t index= firstIndex + static_cast<int32_t>(i);
+
+      switch (value.kind) {
+      case ParameterValue::INTEGER:
+        switch (value.length) {
+        case 1: statement->setByte(index, *static_cast<const int8_t*>(value.value)); break;
+        case 2: statement->setShort(index, *static_cast<const int16_t*>(value.value)); break;
+        case 4: statement->setInt(index, *static_cast<const int32_t*>(value.value)); break;
+        default: statement->setInt64(index, *static_cast<const int64_t*>(value.value));
+        }
+        break;
+      case ParameterValue::UNSIGNED:
+        switch (value.length) {
+        case 1: statement->setShort(index, *static_cast<const uint8_t*>(value.value)); break;
+        case 2: statement->setInt(index, *static_cast<const uint16_t*>(value.value)); break;
+        case 4: statement->setUInt(index, *static_cast<const uint32_t*>(value.value)); break;
+        default: statement->setUInt64(index, *static_cast<const uint64_t*>(value.value));
+        }
+        break;
+      case ParameterValue::REAL:
+        if (value.length == sizeof(float)) {
+          statement->setFloat(index, *static_cast<const float*>(value.value));
+        }
+        else {
+          statement->setDouble(index, *static_cast<const double*>(value.value));
+        }
+        break;
+      case ParameterValue::STRING:
+        statement->setString(index, SQLString(static_cast<const char*>(value.value), value.length));
+        break;
+      default:
+        statement->setNull(index, Types::_NULL);
+      }
+    }
+  }
+
+  /**
+   * Non-throwing execute. The error of the server is returned without an exception created for it, other errors are
+   * caught and put into the error.
+   *
+   * @param error the error, if the execution has failed
+   * @return true if the statement has been executed
+   */
+  bool BasePrepareStatement::tryExecute(ErrorInfo& error) noexcept
+  {
+    error.clear();
+    return ExceptionFactory::catchInto(error, [this, &error]() {
+        executeInternal(getFetchSize(), false, &error);
+      }) && !error.failed();
+  }
+
+  /**
+   * Non-throwing executeUpdate.
+   *
+   * @param error the error, if the execution has failed
+   * @return the update count, 0 for a statement, that returns a result set, or Statement::EXECUTE_FAILED on error
+   */
+  int32_t BasePrepareStatement::tryExecuteUpdate(ErrorInfo& error) noexcept
+  {
+    int32_t updateCount= Statement::EXECUTE_FAILED;
+
+    error.clear();
+    ExceptionFactory::catchInto(error, [this, &error, &updateCount]() {
+        if (executeInternal(getFetchSize(), false, &error)) {
+          updateCount= 0;
+        }
+        else if (!error.failed()) {
+          updateCount= getUpdateCount();
+        }
+      });
+    return updateCount;
+  }
+
 
   /**
    * Reset timeout after query, re-throw SQL exception.
@@ -1474,6 +1783,23 @@ namespace mariadb
     return stmt->executeExceptionEpilogue(sqle);
   }
 
+  /* Puts into the error the exception, that executeExceptionEpilogue returns */
+  void BasePrepareStatement::executeExceptionEpilogue(SQLException& sqle, ErrorInfo& error)
+  {
+    MariaDBExceptionThrower sqlException(executeExceptionEpilogue(sqle));
+    ExceptionFactory::toErrorInfo(*sqlException.getException(), error);
+  }
+
+  /* Counterpart of executeExceptionEpilogue for the error, returned by the non-throwing execution. Has to be called
+     without the lock */
+  void BasePrepareStatement::executeErrorEpilogue(ErrorInfo& error)
+  {
+    if (stmt->needsExceptionEpilogue(error)) {
+      SQLException sqle(error.message.c_str(), error.sqlState.c_str(), error.errorCode);
+      executeExceptionEpilogue(sqle, error);
+    }
+  }
+
   /*** Inherited Statement methods that should not be used in Prepared/CallableStatement. We throw the exception here ***/
 
   void BasePrepareStatement::addBatch(const SQLString& /*sql*/) {
@@ -1530,6 +1856,38 @@ namespace mariadb
     return false;
   }
 
+  bool BasePrepareStatement::tryExecute(const SQLString& /*sql*/, ErrorInfo& error) noexcept {
+    error.clear();
+    ExceptionFactory::toErrorInfo(*exceptionFactory->create("tryExecute(const SQString& sql) cannot be called on PreparedStatement",
+      false).getException(), error);
+    return false;
+  }
+
+  AsyncExecution* BasePrepareStatement::executeAsync(const SQLString& /*sql*/) {
+    exceptionFactory->create("executeAsync(const SQString& sql) cannot be called on PreparedStatement").Throw();
+    return nullptr;
+  }
+
+  /* Overridden by the client side prepared statement */
+  AsyncExecution* BasePrepareStatement::executeAsync() {
+    throw exceptionFactory->notSupported("Asynchronous execution is supported only by client side prepared statements");
+  }
+
+  bool BasePrepareStatement::executeScalar(const SQLString& /*sql*/, int64_t& /*value*/) {
+    exceptionFactory->create("executeScalar(const SQString& sql) cannot be called on PreparedStatement").Throw();
+    return false;
+  }
+
+  bool BasePrepareStatement::executeScalar(const SQLString& /*sql*/, double& /*value*/) {
+    exceptionFactory->create("executeScalar(const SQString& sql) cannot be called on PreparedStatement").Throw();
+    return false;
+  }
+
+  bool BasePrepareStatement::executeScalar(const SQLString& /*sql*/, SQLString& /*value*/) {
+    exceptionFactory->create("executeScalar(const SQString& sql) cannot be called on PreparedStatement").Throw();
+    return false;
+  }
+
   bool BasePrepareStatement::execute(const SQLString& /*sql*/, int32_t /*autoGeneratedKeys*/) {
     exceptionFactory->create("execute(const SQString& sql, int32_t autoGeneratedKeys) cannot be called on PreparedStatement").Throw();
     return false;
@@ -64,12 +64,18 @@ protected:
 //private:
   bool useFractionalSeconds;
   bool noBackslashEscapes;
+  Charset::Transcoding transcoding;
   /** Pointers to the factory and protocol owned by stmt(shared ownship)
       If connection object gets deleted - stmt will still have valid Protocol object.
       That helps not to crash and throw exception
   */
   Shared::ExceptionFactory exceptionFactory;
   Protocol* protocol;
+  /* Not proxied protocol, or nullptr, as in MariaDbStatement */
+  MasterProtocol* const directProtocol;
+  /* Values of executeWith for the time of its execution. They are used instead of the parameters set with setters */
+  const ParameterValue* boundValues= nullptr;
+  std::size_t boundValuesCount= 0;
 
 //public:
   BasePrepareStatement(
@@ -83,7 +89,13 @@ public:
   virtual ~BasePrepareStatement(){}
 
 protected:
-  virtual bool executeInternal(int32_t fetchSize)=0;
+  virtual bool executeInternal(int32_t fetchSize, bool isRetry= false, ErrorInfo* error= nullptr)=0;
+  /* If the result may come from the result cache, returns its TTL, and the query with the current parameters values,
+     that identifies the result. Otherwise returns 0 */
+  virtual int64_t getResultCacheQuery(SQLString& query)=0;
+  /* Throws, if the number of executeWith values is not the number of parameters */
+  void validValues(std::size_t parameterCount);
+  bool executeScalarInternal();
 public:
   operator MariaDbStatement* () { return stmt.get(); }
   /**
@@ -99,6 +111,14 @@ public:
   */
   virtual ParameterMetaData* getParameterMetaData()=0;
   virtual void setParameter(int32_t parameterIndex, ParameterHolder* holder)=0;
+  /* Returns the holder bound at the index, if nothing else but the statement references it, and thus its value can be
+     overwritten in place. nullptr otherwise */
+  virtual ParameterHolder* getReusableParameter(int32_t parameterIndex)=0;
+
+private:
+  template <class T, class V, class... Args> void setValueParameter(int32_t parameterIndex, const V& value, Args... args);
+
+public:
 
 #ifdef MAYBE_IN_NEXTVERSION
   void setBlob(int32_t parameterIndex, Blob* blob);
@@ -153,12 +173,16 @@ public:
   void setNull(int32_t parameterIndex, int32_t sqlType, const SQLString& typeName);
   void setBlob(int32_t parameterIndex, std::istream* inputStream, const int64_t length);
   void setBlob(int32_t parameterIndex, std::istream* inputStream);
+  void setBlobFromFile(int32_t parameterIndex, const SQLString& path);
 
   void setBoolean(int32_t parameterIndex,bool value);
   void setByte(int32_t parameterIndex, int8_t byte);
   void setShort(int32_t parameterIndex, int16_t value);
   void setString(int32_t parameterIndex, const SQLString& str);
+  void setU16String(int32_t parameterIndex, const std::u16string& str);
+  void setWString(int32_t parameterIndex, const std::wstring& str);
   void setBytes(int32_t parameterIndex, sql::bytes* bytes);
+  void setBytes(int32_t parameterIndex, const char* bytes, std::size_t length);
   void setInt(int32_t column, int32_t value);
   void setLong(int32_t parameterIndex, int64_t value);
   void setInt64(int32_t parameterIndex, int64_t value) { setLong(parameterIndex, value); }
@@ -167,14 +191,36 @@ public:
   void setFloat(int32_t parameterIndex, float value);
   void setDouble(int32_t parameterIndex, double value);
   void setDateTime(int32_t parameterIndex, const SQLString& dt);
+  void setDateTime(int32_t parameterIndex, const DateTime& value);
+  void setDecimal(int32_t parameterIndex, const Decimal& value);
   void setBigInt(int32_t column, const SQLString& value);
+  void setArray(int32_t parameterIndex, const int32_t* values, const char* nullIndicators, std::size_t rows);
+  void setArray(int32_t parameterIndex, const int64_t* values, const char* nullIndicators, std::size_t rows);
+  void setArray(int32_t parameterIndex, const double* values, const char* nullIndicators, std::size_t rows);
+  void setArray(int32_t parameterIndex, const char* const* values, const unsigned long* lengths,
+    const char* nullIndicators, std::size_t rows);
+  void setList(int32_t parameterIndex, const int64_t* values, std::size_t count);
+  void setList(int32_t parameterIndex, const SQLString* values, std::size_t count);
 
   int32_t executeUpdate();
   int64_t executeLargeUpdate();
   bool execute();
   ResultSet* executeQuery();
+  bool executeScalar(int64_t& value);
+  bool executeScalar(double& value);
+  bool executeScalar(SQLString& value);
+  bool tryExecute(ErrorInfo& error) noexcept;
+  int32_t tryExecuteUpdate(ErrorInfo& error) noexcept;
+  bool executeValues(const ParameterValue* values, std::size_t count);
+  ResultSet* executeQueryValues(const ParameterValue* values, std::size_t count);
+  /* Sets values of executeWith with the setters of the statement, that cannot use them directly, starting from the
+     parameter firstIndex */
+  static void setValues(PreparedStatement* statement, const ParameterValue* values, std::size_t count,
+    int32_t firstIndex= 1);
 
   MariaDBExceptionThrower executeExceptionEpilogue(SQLException& sqle);
+  void executeExceptionEpilogue(SQLException& sqle, ErrorInfo& error);
+  void executeErrorEpilogue(ErrorInfo& error);
 
   /*** Inherited methods that should not work with Prepared/CallableStatement ***/
   void addBatch(const SQLString& sql);
@@ -190,6 +236,12 @@ public:
   int64_t executeLargeUpdate(const SQLString& sql, const SQLString* columnNames);
   
   bool execute(const SQLString& sql);
+  AsyncExecution* executeAsync(const SQLString& sql);
+  AsyncExecution* executeAsync();
+  bool tryExecute(const SQLString& sql, ErrorInfo& error) noexcept;
+  bool executeScalar(const SQLString& sql, int64_t& value);
+  bool executeScalar(const SQLString& sql, double& value);
+  bool executeScalar(const SQLString& sql, SQLString& value);
   bool execute(const SQLString& sql, int32_t autoGeneratedKeys);
   bool execute(const SQLString& sql, int32_t* columnIndexes);
   bool execute(const SQLString& sql, const SQLString* columnNames);
@@ -204,14 +256,21 @@ public:
   int64_t getLargeMaxRows()         { return stmt->getLargeMaxRows(); }
   void setLargeMaxRows(int64_t max) { stmt->setLargeMaxRows(max); }
   void setEscapeProcessing(bool enable) { stmt->setEscapeProcessing(enable); }
+  void setRetryable(bool retryable) { stmt->setRetryable(retryable); }
+  bool isRetryable() { return stmt->isRetryable(); }
+  void setResultCacheTtl(int64_t milliseconds) { stmt->setResultCacheTtl(milliseconds); }
+  int64_t getResultCacheTtl() { return stmt->getResultCacheTtl(); }
   int32_t getQueryTimeout()             { return stmt->getQueryTimeout(); }
   void setQueryTimeout(int32_t seconds) { stmt->setQueryTimeout(seconds); }
+  int64_t getQueryTimeoutMs()           { return stmt->getQueryTimeoutMs(); }
+  void setQueryTimeoutMs(int64_t milliseconds) { stmt->setQueryTimeoutMs(milliseconds); }
   void cancel()             { stmt->cancel(); }
   SQLWarning* getWarnings() { return stmt->getWarnings(); }
   void clearWarnings()      { stmt->clearWarnings(); }
   void setCursorName(const SQLString& name) { stmt->setCursorName(name); }
   Connection* getConnection()               { return stmt->getConnection(); }
   ResultSet* getGeneratedKeys()             { return stmt->getGeneratedKeys(); }
+  int64_t getLastInsertId()                 { return stmt->getLastInsertId(); }
   int32_t getResultSetHoldability()         { return stmt->getResultSetHoldability(); }
   bool isClosed()                 { return stmt->isClosed(); }
   bool isPoolable()               { return stmt->isPoolable(); }
@@ -219,16 +278,25 @@ public:
   ResultSet* getResultSet()       { return stmt->getResultSet(); }
   int32_t getUpdateCount()        { return stmt->getUpdateCount(); }
   int64_t getLargeUpdateCount()   { return stmt->getLargeUpdateCount(); }
+  const ExecutionStats& getLastExecutionStats() { return stmt->getLastExecutionStats(); }
   bool getMoreResults()           { return stmt->getMoreResults(); }
   bool getMoreResults(int32_t current) { return stmt->getMoreResults(current); }
+  bool skipResults(int32_t count) { return stmt->skipResults(count); }
   int32_t getFetchDirection()          { return stmt->getFetchDirection(); }
   void setFetchDirection(int32_t direction) { stmt->setFetchDirection(direction); }
   int32_t getFetchSize()            { return stmt->getFetchSize(); }
   void setFetchSize(int32_t rows)   { stmt->setFetchSize(rows); }
+  std::size_t getFetchBytes()       { return stmt->getFetchBytes(); }
+  void setFetchBytes(std::size_t bytes) { stmt->setFetchBytes(bytes); }
   int32_t getResultSetConcurrency() { return stmt->getResultSetConcurrency(); }
   int32_t getResultSetType()        { return stmt->getResultSetType(); }
   void closeOnCompletion()    { stmt->closeOnCompletion(); }
   bool isCloseOnCompletion()  { return stmt->isCloseOnCompletion(); }
+  void getBatchUpdateCounts(const int64_t*& counts, std::size_t& size) { stmt->getBatchUpdateCounts(counts, size); }
+  void getBatchInsertIds(const int64_t*& ids, std::size_t& size, int32_t& increment)
+  {
+    stmt->getBatchInsertIds(ids, size, increment);
+  }
   Statement* setResultSetType(int32_t rsType) { stmt->setResultSetType(rsType); return this; }
 
   };
@@ -84,16 +84,14 @@ template <class T> CArray<T>::CArray(std::initializer_list<T> const& initList) :
 }
 
 
-/*template <class T> CArray<T>::CArray(CArray&& rhs)
+template <class T> CArray<T>::CArray(CArray&& rhs) noexcept
   : arr(rhs.arr)
   , length(rhs.length)
 {
-  if (rhs.length > 0)
-  {
-    rhs.arr= nullptr;
-    length = 0;
-  }
-}*/
+  rhs.arr= nullptr;
+  rhs.length= 0;
+}
+
 
 template <class T> CArray<T>::CArray(const CArray& rhs)
   : arr(rhs.arr)
@@ -102,8 +100,51 @@ template <class T> CArray<T>::CArray(const CArray& rhs)
   if (length > 0)
   {
     arr= new T[static_cast<size_t>(length)];
-    std::memcpy(arr, rhs.arr, static_cast<std::size_t>(length));
+    std::memcpy(arr, rhs.arr, static_cast<std::size_t>(length)*sizeof(T));
+  }
+}
+
+
+/* The owned array is reused, if it has the same size */
+template <class T> CArray<T>& CArray<T>::operator=(const CArray& rhs)
+{
+  if (this == &rhs)
+  {
+    return *this;
   }
+  if (rhs.length <= 0)
+  {
+    return wrap(rhs.arr, static_cast<std::size_t>(-rhs.length));
+  }
+  if (length != rhs.length)
+  {
+    T* copy= new T[static_cast<size_t>(rhs.length)];
+    if (length > 0)
+    {
+      delete[] arr;
+    }
+    arr= copy;
+    length= rhs.length;
+  }
+  std::memcpy(arr, rhs.arr, static_cast<std::size_t>(length)*sizeof(T));
+  return *this;
+}
+
+
+template <class T> CArray<T>& CArray<T>::operator=(CArray&& rhs) noexcept
+{
+  if (this != &rhs)
+  {
+    if (length > 0)
+    {
+      delete[] arr;
+    }
+    arr= rhs.arr;
+    length= rhs.length;
+    rhs.arr= nullptr;
+    rhs.length= 0;
+  }
+  return *this;
 }
 
 
@@ -18,7 +18,16 @@
 *************************************************************************************/
 
 
+#include <cstring>
+#include <string>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# define MADB_SSE2_CHARSET 1
+# include <emmintrin.h>
+#endif
+
 #include "Charset.h"
+#include "Exception.hpp"
 
 namespace sql
 {
@@ -31,6 +40,440 @@ namespace mariadb
   Charset::~Charset()
   {}
 
+  /* Unicode code points of the bytes 0x80-0x9F in the latin1 of the server, which is cp1252. 5 bytes, that cp1252 does
+     not define, map to the same code points, like in ISO 8859-1 */
+  static const uint16_t cp1252High[32]= {
+    0x20AC, 0x0081, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021, 0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0x008D, 0x017D, 0x008F,
+    0x0090, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014, 0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x009D, 0x017E, 0x0178
+  };
+
+  /* Returns the position of the first byte, that is not ASCII, or end */
+  static const char* skipAscii(const char* it, const char* end)
+  {
+#ifdef MADB_SSE2_CHARSET
+    while (end - it >= 16) {
+      __m128i chunk= _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+      if (_mm_movemask_epi8(chunk) != 0) {
+        break;
+      }
+      it+= 16;
+    }
+#else
+    uint64_t word;
+    while (end - it >= 8) {
+      std::memcpy(&word, it, sizeof(word));
+      if ((word & 0x8080808080808080ULL) != 0) {
+        break;
+      }
+      it+= 8;
+    }
+#endif
+    while (it < end && (*it & 0x80) == 0) {
+      ++it;
+    }
+    return it;
+  }
+
+  static inline bool isContinuation(unsigned char c)
+  {
+    return (c & 0xC0) == 0x80;
+  }
+
+  /* Decodes the multibyte sequence at it, and moves it past the sequence. Returns false, if the sequence is not valid */
+  static bool decodeUtf8(const unsigned char*& it, const unsigned char* end, uint32_t& codePoint)
+  {
+    unsigned char lead= *it;
+    std::size_t length;
+    // The range of the second byte is narrower for some leads, that is how overlong forms and surrogates are rejected
+    unsigned char low= 0x80, high= 0xBF;
+
+    if (lead >= 0xC2 && lead <= 0xDF) {
+      length= 2;
+      codePoint= lead & 0x1F;
+    }
+    else if (lead >= 0xE0 && lead <= 0xEF) {
+      length= 3;
+      codePoint= lead & 0x0F;
+      if (lead == 0xE0) {
+        low= 0xA0;
+      }
+      else if (lead == 0xED) {
+        high= 0x9F;
+      }
+    }
+    else if (lead >= 0xF0 && lead <= 0xF4) {
+      length= 4;
+      codePoint= lead & 0x07;
+      if (lead == 0xF0) {
+        low= 0x90;
+      }
+      else if (lead == 0xF4) {
+        high= 0x8F;
+      }
+    }
+    else {
+      return false;
+    }
+    if (static_cast<std::size_t>(end - it) < length || it[1] < low || it[1] > high) {
+      return false;
+    }
+    for (std::size_t i= 1; i < length; ++i) {
+      if (!isContinuation(it[i])) {
+        return false;
+      }
+      codePoint= (codePoint << 6) | (it[i] & 0x3F);
+    }
+    it+= length;
+    return true;
+  }
+
+
+  static bool isUtf8Name(const SQLString& name)
+  {
+    return name.caseCompare("utf8mb4") == 0 || name.caseCompare("utf8") == 0 || name.caseCompare("utf8mb3") == 0;
+  }
+
+
+  Charset::Transcoding Charset::getTranscoding(const SQLString& connectionEncoding, const SQLString& clientEncoding,
+    bool trustServerEncoding)
+  {
+    bool connectionUtf8= isUtf8Name(connectionEncoding);
+
+    if (clientEncoding.empty() || clientEncoding.caseCompare(connectionEncoding) == 0
+      || (connectionUtf8 && isUtf8Name(clientEncoding))) {
+      return connectionUtf8 && !trustServerEncoding ? VALIDATE_UTF8 : NO_TRANSCODING;
+    }
+    if (connectionEncoding.caseCompare("latin1") == 0 && isUtf8Name(clientEncoding)) {
+      return LATIN1_UTF8;
+    }
+    throw SQLFeatureNotSupportedException("Conversion of strings from " + clientEncoding + " to " + connectionEncoding
+      + " is not supported");
+  }
+
+
+  bool Charset::isDecoded(Transcoding transcoding, const char* str, std::size_t len)
+  {
+    switch (transcoding) {
+    case VALIDATE_UTF8:
+      if (validUtf8Length(str, len) != len) {
+        throw SQLException("The string received from the server is not valid UTF-8", "22018");
+      }
+      return true;
+    case LATIN1_UTF8:
+      // Nothing has to be converted in pure ASCII strings
+      return skipAscii(str, str + len) == str + len;
+    default:
+      return true;
+    }
+  }
+
+
+  void Charset::decode(Transcoding transcoding, SQLString& str)
+  {
+    if (!isDecoded(transcoding, str.c_str(), str.length())) {
+      std::string utf8;
+      utf8.reserve(str.length() + str.length() / 2);
+      latin1ToUtf8(str.c_str(), str.length(), utf8);
+      StringImp::get(str).swap(utf8);
+    }
+  }
+
+
+  void Charset::encode(Transcoding transcoding, SQLString& str)
+  {
+    const char* begin= str.c_str(), *end= begin + str.length();
+
+    if (transcoding == LATIN1_UTF8 && skipAscii(begin, end) != end) {
+      std::string latin1;
+      latin1.reserve(str.length());
+      if (!utf8ToLatin1(begin, str.length(), latin1)) {
+        throw SQLException("The string is not valid UTF-8, or has characters, that latin1 does not have", "22018");
+      }
+      StringImp::get(str).swap(latin1);
+    }
+  }
+
+
+  /* Copies the ASCII bytes widened to the units of the wide string, and returns the position of the first byte, that
+     is not ASCII, or end. With SSE2 16 bytes are widened at once */
+  template <class CharT>
+  static const char* widenAscii(const char* it, const char* end, CharT*& dst)
+  {
+#ifdef MADB_SSE2_CHARSET
+    const __m128i zero= _mm_setzero_si128();
+
+    while (end - it >= 16) {
+      __m128i chunk= _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+      if (_mm_movemask_epi8(chunk) != 0) {
+        break;
+      }
+      __m128i low= _mm_unpacklo_epi8(chunk, zero), high= _mm_unpackhi_epi8(chunk, zero);
+      if (sizeof(CharT) == 2) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), low);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 8), high);
+      }
+      else {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_unpacklo_epi16(low, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4), _mm_unpackhi_epi16(low, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 8), _mm_unpacklo_epi16(high, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 12), _mm_unpackhi_epi16(high, zero));
+      }
+      it+= 16;
+      dst+= 16;
+    }
+#endif
+    while (it < end && (*it & 0x80) == 0) {
+      *dst++= static_cast<CharT>(*it++);
+    }
+    return it;
+  }
+
+  /* Writes the code point as the surrogate pair, if it does not fit the unit */
+  template <class CharT>
+  static inline CharT* putCodePoint(CharT* dst, uint32_t codePoint)
+  {
+    if (sizeof(CharT) == 2 && codePoint > 0xFFFF) {
+      codePoint-= 0x10000;
+      *dst++= static_cast<CharT>(0xD800 | (codePoint >> 10));
+      *dst++= static_cast<CharT>(0xDC00 | (codePoint & 0x3FF));
+    }
+    else {
+      *dst++= static_cast<CharT>(codePoint);
+    }
+    return dst;
+  }
+
+  /* Neither UTF-8 nor latin1 string gives more units of UTF-16 or UTF-32, than it has bytes, thus the output is sized
+     once, and is shrunk in the end */
+  template <class CharT>
+  static void toWide(Charset::Transcoding transcoding, const char* str, std::size_t len, std::basic_string<CharT>& out)
+  {
+    const std::size_t start= out.size();
+    const char* it= str, *end= str + len;
+    CharT* dst;
+
+    out.resize(start + len);
+    dst= &out[0] + start;
+
+    while ((it= widenAscii(it, end, dst)) < end) {
+      if (transcoding == Charset::LATIN1_UTF8) {
+        unsigned char c= static_cast<unsigned char>(*it++);
+        *dst++= static_cast<CharT>(c < 0xA0 ? cp1252High[c - 0x80] : c);
+        continue;
+      }
+      const unsigned char* pos= reinterpret_cast<const unsigned char*>(it);
+      uint32_t codePoint;
+      if (decodeUtf8(pos, reinterpret_cast<const unsigned char*>(end), codePoint)) {
+        dst= putCodePoint(dst, codePoint);
+        it= reinterpret_cast<const char*>(pos);
+      }
+      else if (transcoding == Charset::VALIDATE_UTF8) {
+        out.resize(start);
+        throw SQLException("The string received from the server is not valid UTF-8", "22018");
+      }
+      else {
+        *dst++= static_cast<CharT>(0xFFFD);
+        do {
+          ++it;
+        } while (it < end && isContinuation(static_cast<unsigned char>(*it)));
+      }
+    }
+    out.resize(dst - &out[0]);
+  }
+
+  /* Reads the code point from the UTF-16 or UTF-32 string, and moves it past the code point. Unpaired surrogates and
+     values beyond U+10FFFF give U+FFFD */
+  template <class CharT>
+  static inline uint32_t getCodePoint(const CharT*& it, const CharT* end)
+  {
+    uint32_t codePoint= static_cast<uint32_t>(*it++);
+
+    if (codePoint < 0xD800 || (codePoint > 0xDFFF && codePoint <= 0x10FFFF)) {
+      return codePoint;
+    }
+    if (sizeof(CharT) == 2 && codePoint <= 0xDBFF && it < end) {
+      uint32_t low= static_cast<uint32_t>(*it);
+      if (low >= 0xDC00 && low <= 0xDFFF) {
+        ++it;
+        return 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+      }
+    }
+    return 0xFFFD;
+  }
+
+  /* Copies the units below 0x80 narrowed to bytes, and returns the position of the first unit, that is not ASCII, or
+     end. With SSE2 8 units of UTF-16 are narrowed at once */
+  template <class CharT>
+  static const CharT* narrowAscii(const CharT* it, const CharT* end, char*& dst)
+  {
+#ifdef MADB_SSE2_CHARSET
+    if (sizeof(CharT) == 2) {
+      const __m128i nonAscii= _mm_set1_epi16(static_cast<short>(0xFF80)), zero= _mm_setzero_si128();
+
+      while (end - it >= 8) {
+        __m128i chunk= _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(chunk, nonAscii), zero)) != 0xFFFF) {
+          break;
+        }
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(chunk, chunk));
+        it+= 8;
+        dst+= 8;
+      }
+    }
+#endif
+    while (it < end && static_cast<uint32_t>(*it) < 0x80) {
+      *dst++= static_cast<char>(*it++);
+    }
+    return it;
+  }
+
+  /* A unit of UTF-16 gives 3 bytes of UTF-8 at most, and a unit of UTF-32 4 */
+  template <class CharT>
+  static void fromWide(Charset::Transcoding transcoding, const CharT* str, std::size_t len, std::string& out)
+  {
+    const std::size_t start= out.size();
+    const CharT* it= str, *end= str + len;
+    char* dst;
+
+    out.resize(start + len*(sizeof(CharT) == 2 ? 3 : 4));
+    dst= &out[0] + start;
+
+    while ((it= narrowAscii(it, end, dst)) < end) {
+      uint32_t codePoint= getCodePoint(it, end);
+
+      if (transcoding == Charset::LATIN1_UTF8) {
+        std::size_t i= 0;
+        if (codePoint >= 0xA0 && codePoint <= 0xFF) {
+          *dst++= static_cast<char>(codePoint);
+          continue;
+        }
+        while (i < sizeof(cp1252High)/sizeof(cp1252High[0]) && cp1252High[i] != codePoint) {
+          ++i;
+        }
+        if (i == sizeof(cp1252High)/sizeof(cp1252High[0])) {
+          out.resize(start);
+          throw SQLException("The string has characters, that latin1 does not have", "22018");
+        }
+        *dst++= static_cast<char>(0x80 + i);
+        continue;
+      }
+      if (codePoint < 0x800) {
+        *dst++= static_cast<char>(0xC0 | (codePoint >> 6));
+      }
+      else if (codePoint < 0x10000) {
+        *dst++= static_cast<char>(0xE0 | (codePoint >> 12));
+        *dst++= static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+      }
+      else {
+        *dst++= static_cast<char>(0xF0 | (codePoint >> 18));
+        *dst++= static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        *dst++= static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+      }
+      *dst++= static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+    out.resize(dst - &out[0]);
+  }
+
+
+  void Charset::decodeWide(Transcoding transcoding, const char* str, std::size_t len, std::u16string& out)
+  {
+    toWide(transcoding, str, len, out);
+  }
+
+
+  void Charset::decodeWide(Transcoding transcoding, const char* str, std::size_t len, std::wstring& out)
+  {
+    toWide(transcoding, str, len, out);
+  }
+
+
+  void Charset::encodeWide(Transcoding transcoding, const char16_t* str, std::size_t len, std::string& out)
+  {
+    fromWide(transcoding, str, len, out);
+  }
+
+
+  void Charset::encodeWide(Transcoding transcoding, const wchar_t* str, std::size_t len, std::string& out)
+  {
+    fromWide(transcoding, str, len, out);
+  }
+
+
+  std::size_t Charset::validUtf8Length(const char* str, std::size_t len)
+  {
+    const char* it= str, *end= str + len;
+    uint32_t codePoint;
+
+    while ((it= skipAscii(it, end)) < end) {
+      const unsigned char* pos= reinterpret_cast<const unsigned char*>(it);
+      if (!decodeUtf8(pos, reinterpret_cast<const unsigned char*>(end), codePoint)) {
+        break;
+      }
+      it= reinterpret_cast<const char*>(pos);
+    }
+    return it - str;
+  }
+
+
+  void Charset::latin1ToUtf8(const char* str, std::size_t len, std::string& out)
+  {
+    const char* it= str, *end= str + len;
+
+    while (it < end) {
+      const char* special= skipAscii(it, end);
+      out.append(it, special - it);
+      if (special == end) {
+        break;
+      }
+      unsigned char c= static_cast<unsigned char>(*special);
+      uint32_t codePoint= c < 0xA0 ? cp1252High[c - 0x80] : c;
+
+      if (codePoint < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+      }
+      else {
+        out.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+      }
+      out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+      it= special + 1;
+    }
+  }
+
+
+  bool Charset::utf8ToLatin1(const char* str, std::size_t len, std::string& out)
+  {
+    const char* it= str, *end= str + len;
+    uint32_t codePoint;
+
+    while (it < end) {
+      const char* special= skipAscii(it, end);
+      out.append(it, special - it);
+      if (special == end) {
+        break;
+      }
+      const unsigned char* pos= reinterpret_cast<const unsigned char*>(special);
+      if (!decodeUtf8(pos, reinterpret_cast<const unsigned char*>(end), codePoint)) {
+        return false;
+      }
+      if (codePoint >= 0xA0 && codePoint <= 0xFF) {
+        out.push_back(static_cast<char>(codePoint));
+      }
+      else {
+        std::size_t i= 0;
+        while (i < sizeof(cp1252High)/sizeof(cp1252High[0]) && cp1252High[i] != codePoint) {
+          ++i;
+        }
+        if (i == sizeof(cp1252High)/sizeof(cp1252High[0])) {
+          return false;
+        }
+        out.push_back(static_cast<char>(0x80 + i));
+      }
+      it= reinterpret_cast<const char*>(pos);
+    }
+    return true;
+  }
+
 namespace StandardCharsets
 {
   const Charset UTF_8("utf8mb4");
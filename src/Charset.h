@@ -34,9 +34,50 @@ class Charset{
   Charset(const Charset&)=delete;
   void operator=(Charset &)=delete;
 public:
+  /* Conversion of strings between the connection character set and the character set of the application */
+  enum Transcoding {
+    NO_TRANSCODING= 0,
+    // Strings received in utf8mb4 are checked to be valid UTF-8
+    VALIDATE_UTF8,
+    // The connection uses latin1, the application uses UTF-8
+    LATIN1_UTF8
+  };
+
   Charset() {}
   Charset(const SQLString& name);
   ~Charset();
+
+  const SQLString& getName() const { return csName; }
+
+  /* The transcoding for the useCharacterEncoding, clientCharacterEncoding and trustServerEncoding options. Throws, if
+     the conversion between the character sets is not supported */
+  static Transcoding getTranscoding(const SQLString& connectionEncoding, const SQLString& clientEncoding,
+    bool trustServerEncoding);
+  /* If the string received from the server does not need the conversion to the application's character set. Throws,
+     if the string has to be valid UTF-8, and it is not */
+  static bool isDecoded(Transcoding transcoding, const char* str, std::size_t len);
+  /* Converts the string received from the server to the application's character set, or checks that it is valid */
+  static void decode(Transcoding transcoding, SQLString& str);
+  /* Converts the string of the application to the connection character set */
+  static void encode(Transcoding transcoding, SQLString& str);
+  /* Appends the string received from the server converted to UTF-16, or to wchar_t, which is UTF-16 or UTF-32 depending
+     on the platform. Invalid UTF-8 sequences are replaced by U+FFFD, unless the transcoding requires valid UTF-8, and
+     then it throws */
+  static void decodeWide(Transcoding transcoding, const char* str, std::size_t len, std::u16string& out);
+  static void decodeWide(Transcoding transcoding, const char* str, std::size_t len, std::wstring& out);
+  /* Appends the UTF-16 or wchar_t string converted to the connection character set. Unpaired surrogates are replaced by
+     U+FFFD. Throws, if latin1 does not have a character of the string */
+  static void encodeWide(Transcoding transcoding, const char16_t* str, std::size_t len, std::string& out);
+  static void encodeWide(Transcoding transcoding, const wchar_t* str, std::size_t len, std::string& out);
+
+  /* Length of the longest valid UTF-8 prefix of the string. Overlong forms, surrogates and code points above U+10FFFF
+     are not valid */
+  static std::size_t validUtf8Length(const char* str, std::size_t len);
+  /* Appends the string in the latin1 of the server, i.e. cp1252, converted to UTF-8 */
+  static void latin1ToUtf8(const char* str, std::size_t len, std::string& out);
+  /* Appends the UTF-8 string converted to latin1. Returns false, if the string is not valid UTF-8, or has characters,
+     that latin1 does not have */
+  static bool utf8ToLatin1(const char* str, std::size_t len, std::string& out);
 };
 
 namespace StandardCharsets
@@ -23,11 +23,17 @@
 #include "ExceptionFactory.h"
 #include "Results.h"
 #include "Protocol.h"
+#include "util/LogQueryTool.h"
+#include "protocol/capi/QueryProtocol.h"
+#include "protocol/MasterProtocol.h"
 #include "util/ClientPrepareResult.h"
+#include "util/ClientPrepareResultCache.h"
+#include "util/MetricsRecorder.h"
 #include "parameters/ParameterHolder.h"
 #include "ServerSidePreparedStatement.h"
 #include "MariaDbParameterMetaData.h"
 #include "MariaDbResultSetMetaData.h"
+#include "MariaDbAsyncExecution.h"
 #include "SimpleParameterMetaData.h"
 
 namespace sql
@@ -69,16 +75,35 @@ namespace mariadb
     : BasePrepareStatement(connection, resultSetScrollType, resultSetConcurrency, autoGeneratedKeys, factory),
       sqlQuery(sql)
   {
-    if (protocol->getOptions()->rewriteBatchedStatements) {
-      prepareResult.reset(ClientPrepareResult::rewritableParts(sqlQuery, protocol->noBackslashEscapes()));
-    }
-    else {
-      prepareResult.reset(ClientPrepareResult::parameterParts(sqlQuery, protocol->noBackslashEscapes()));
+    bool cached= false;
+    std::size_t cacheSize= static_cast<std::size_t>(protocol->getOptions()->parsedQueryCacheSize);
+
+    prepareResult= ClientPrepareResultCache::getInstance().get(sqlQuery, protocol->noBackslashEscapes(),
+      protocol->getOptions()->rewriteBatchedStatements, cacheSize, &cached);
+    if (cacheSize > 0) {
+      MetricsRecorder::increment(cached ? protocol->getMetrics().prepareCacheHits : protocol->getMetrics().prepareCacheMisses);
     }
     parameters.reserve(prepareResult->getParamCount());
     parameters.assign(prepareResult->getParamCount(), Shared::ParameterHolder());
   }
 
+
+  ClientSidePreparedStatement::~ClientSidePreparedStatement()
+  {
+    if (serverPrepareResult) {
+      bool closed= !stmt || stmt->isClosed();
+      // Results may refer to the prepare, thus they go first
+      stmt.reset();
+      // Not closed statement gives the prepare back the same way, as ServerSidePreparedStatement does
+      if (!closed) {
+        serverPrepareResult->decrementShareCounter();
+        if (!serverPrepareResult->canBeDeallocate()) {
+          serverPrepareResult.release();
+        }
+      }
+    }
+  }
+
   /**
     * Clone statement.
     *
@@ -93,16 +118,25 @@ namespace mariadb
       this->autoGeneratedKeys, ef);
     clone->sqlQuery= sqlQuery;
     clone->prepareResult= prepareResult;
-    clone->parameters.reserve(prepareResult->getParamCount());
+    clone->parameters.assign(prepareResult->getParamCount(), Shared::ParameterHolder());
     clone->resultSetMetaData= resultSetMetaData;
     clone->parameterMetaData= parameterMetaData;
     return clone;
   }
 
 
-  bool ClientSidePreparedStatement::executeInternal(int32_t fetchSize)
+  PreparedStatement* ClientSidePreparedStatement::clone(Connection* target)
   {
-    // valid parameters
+    return clone(MariaDbConnection::cloneTarget(connection, target));
+  }
+
+
+  void ClientSidePreparedStatement::validateParameters()
+  {
+    if (boundValues != nullptr) {
+      validValues(prepareResult->getParamCount());
+      return;
+    }
     for (uint32_t i= 0; i < prepareResult->getParamCount(); ++i) {
       if (!parameters[i]) {
         logger->error("Parameter at position " + std::to_string(i + 1) + " is not set");
@@ -110,46 +144,206 @@ namespace mariadb
           + std::to_string(i + 1) + " is not set", "07004").Throw();
       }
     }
+  }
+
+
+  void ClientSidePreparedStatement::assembleQuery(SQLString& out)
+  {
+    validateParameters();
+    capi::assemblePreparedQueryForExec(out, prepareResult.get(), parameters, -1);
+  }
+
+
+  /* Streamed parameters can be read only once, thus such query is not cached */
+  int64_t ClientSidePreparedStatement::getResultCacheQuery(SQLString& query)
+  {
+    int64_t ttl= stmt->resultCacheTtlFor(sqlQuery);
+
+    if (ttl == 0 || hasLongData) {
+      return 0;
+    }
+    assembleQuery(query);
+    return ttl;
+  }
+
+
+  /* Sends the query with the protocol of the given type - the calls are not virtual for the MasterProtocol.
+     Returns false if the error was put to the error info */
+  template <class ProtocolType>
+  bool ClientSidePreparedStatement::sendQuery(ProtocolType& executor, ErrorInfo* error)
+  {
+    if (boundValues != nullptr) {
+      SQLString query;
+      capi::assemblePreparedQueryForExec(query, prepareResult.get(), boundValues, executor.noBackslashEscapes(),
+        stmt->queryTimeout != 0 && stmt->useServerTimeout() ? stmt->queryTimeout : -1);
+      executor.executeQuery(executor.isMasterConnection(), stmt->getInternalResults(), query);
+    }
+    else if (error != nullptr) {
+      return executor.tryExecuteQuery(executor.isMasterConnection(), stmt->getInternalResults(), prepareResult.get(),
+        parameters, stmt->queryTimeout != 0 && stmt->useServerTimeout() ? stmt->queryTimeout : -1, *error);
+    }
+    else if (stmt->queryTimeout !=0 && stmt->useServerTimeout()) {
+      executor.executeQuery(
+        executor.isMasterConnection(), stmt->getInternalResults(), prepareResult.get(), parameters, stmt->queryTimeout);
+    }
+    else {
+      executor.executeQuery(executor.isMasterConnection(), stmt->getInternalResults(), prepareResult.get(), parameters);
+    }
+    return true;
+  }
+
+
+  bool ClientSidePreparedStatement::executeInternal(int32_t fetchSize, bool isRetry, ErrorInfo* error)
+  {
+    validateParameters();
+    if (!isRetry && !serverPrepareResult && protocol->getOptions()->serverPrepareThreshold > 0 &&
+        ++executions == static_cast<uint32_t>(protocol->getOptions()->serverPrepareThreshold) + 1) {
+      prepareOnServer();
+    }
+    // Values of executeWith and long data are still sent with the text protocol
+    if (serverPrepareResult && boundValues == nullptr && !hasLongData) {
+      return executeOnServer(fetchSize, isRetry, error);
+    }
+
+    std::unique_lock<ConnectionMutex> localScopeLock(*protocol->getLock());
+    // Streamed parameters cannot be read once more
+    bool mayRetry= !isRetry && !hasLongData && stmt->mayRetryOnFailover(sqlQuery);
+    try {
+      stmt->executeQueryPrologue(false);
+      stmt->newInternalResults(this, fetchSize, autoGeneratedKeys, sqlQuery);
+      if (!(directProtocol != nullptr ? sendQuery(*directProtocol, error) : sendQuery(*protocol, error))) {
+        stmt->getInternalResults()->commandEnd();
+        stmt->executeEpilogue();
+        localScopeLock.unlock();
+        executeErrorEpilogue(*error);
+        return false;
+      }
+      stmt->getInternalResults()->commandEnd();
+      stmt->executeEpilogue();
+      return stmt->getInternalResults()->getResultSet();
+    }
+    catch (SQLException& exception) {
+      if (stmt->getInternalResults()) {
+        stmt->getInternalResults()->commandEnd();
+      }
+      stmt->executeEpilogue();
+      localScopeLock.unlock();
+      if (stmt->failoverForRetry(exception, mayRetry)) {
+        return executeInternal(fetchSize, true, error);
+      }
+      if (error != nullptr) {
+        executeExceptionEpilogue(exception, *error);
+        return false;
+      }
+      executeExceptionEpilogue(exception).Throw();
+    }
+    return false;
+  }
+
+
+  /* Prepares the statement on the server, once it has been executed serverPrepareThreshold times. Whatever the server
+     cannot prepare, stays with the text protocol. So does the statement of the failover connection, that may move to
+     other host */
+  void ClientSidePreparedStatement::prepareOnServer()
+  {
+    if (protocol->getProxy() != nullptr || !shouldPrepareOnServer(sqlQuery)) {
+      return;
+    }
+    std::lock_guard<ConnectionMutex> localScopeLock(*protocol->getLock());
+    try {
+      serverPrepareResult.reset(protocol->prepare(sqlQuery, protocol->isMasterConnection()));
+    }
+    catch (SQLException& e) {
+      if (e.getSQLState().startsWith("08")) {
+        throw;
+      }
+      logger->debug("Query could not be prepared on the server, it stays with the text protocol", e);
+    }
+  }
+
 
-    std::unique_lock<std::mutex> localScopeLock(*protocol->getLock());
+  /* Execution of the statement prepared on the server by prepareOnServer */
+  bool ClientSidePreparedStatement::executeOnServer(int32_t fetchSize, bool isRetry, ErrorInfo* error)
+  {
+    std::unique_lock<ConnectionMutex> localScopeLock(*protocol->getLock());
+    bool mayRetry= !isRetry && stmt->mayRetryOnFailover(sqlQuery);
     try {
       stmt->executeQueryPrologue(false);
+      if (stmt->getQueryTimeoutMs() != 0) {
+        stmt->setTimerTask(false);
+      }
       stmt->setInternalResults(
-        new Results(
+        std::make_shared<Results>(
           this,
           fetchSize,
           false,
           1,
-          false,
+          true,
           stmt->getResultSetType(),
           stmt->getResultSetConcurrency(),
           autoGeneratedKeys,
           protocol->getAutoIncrementIncrement(),
-          sqlQuery,
-          parameters));
-      if (stmt->queryTimeout !=0 && stmt->canUseServerTimeout) {
+          sqlQuery));
 
-        protocol->executeQuery(
-          protocol->isMasterConnection(), stmt->getInternalResults(), prepareResult.get(), parameters, stmt->queryTimeout);
+      serverPrepareResult->resetParameterTypeHeader();
+      if (error == nullptr) {
+        protocol->executePreparedQuery(protocol->isMasterConnection(), serverPrepareResult.get(),
+          stmt->getInternalResults(), parameters);
       }
-      else {
-        protocol->executeQuery(protocol->isMasterConnection(), stmt->getInternalResults(), prepareResult.get(), parameters);
+      else if (!protocol->tryExecutePreparedQuery(protocol->isMasterConnection(), serverPrepareResult.get(),
+                 stmt->getInternalResults(), parameters, *error)) {
+        stmt->executeEpilogue();
+        localScopeLock.unlock();
+        executeErrorEpilogue(*error);
+        return false;
       }
       stmt->getInternalResults()->commandEnd();
       stmt->executeEpilogue();
-      return stmt->getInternalResults()->getResultSet();
+      return stmt->getInternalResults()->getResultSet() != nullptr;
     }
     catch (SQLException& exception) {
-      if (stmt->getInternalResults()) {
-        stmt->getInternalResults()->commandEnd();
-      }
       stmt->executeEpilogue();
       localScopeLock.unlock();
+      if (stmt->failoverForRetry(exception, mayRetry)) {
+        // The prepare belongs to the lost connection. The statement goes back to the text protocol
+        serverPrepareResult.reset();
+        return executeInternal(fetchSize, true, error);
+      }
+      if (error != nullptr) {
+        executeExceptionEpilogue(exception, *error);
+        return false;
+      }
       executeExceptionEpilogue(exception).Throw();
     }
     return false;
   }
 
+  /* Starts non-blocking execution of the query with current parameters values. It's driven then by the statement's
+     MariaDbStatement, as if it was its own query, but the results belong to this statement */
+  AsyncExecution* ClientSidePreparedStatement::executeAsync()
+  {
+    SQLString query;
+    int32_t waitStatus= 0;
+
+    validateParameters();
+
+    std::unique_lock<ConnectionMutex> localScopeLock(*protocol->getLock());
+    try {
+      stmt->executeQueryPrologue(false);
+      stmt->newInternalResults(this, getFetchSize(), autoGeneratedKeys, sqlQuery);
+      capi::assemblePreparedQueryForExec(query, prepareResult.get(), parameters,
+        stmt->queryTimeout != 0 && stmt->useServerTimeout() ? stmt->queryTimeout : -1);
+      waitStatus= protocol->executeQueryAsyncStart(query);
+    }
+    catch (SQLException& exception) {
+      stmt->executeEpilogue();
+      localScopeLock.unlock();
+      executeExceptionEpilogue(exception).Throw();
+    }
+    localScopeLock.unlock();
+    return new MariaDbAsyncExecution(stmt.get(), stmt->protocol, waitStatus);
+  }
+
   /**
     * Adds a set of parameters to this <code>PreparedStatement</code> object's batch of send. <br>
     * <br>
@@ -161,10 +355,9 @@ namespace mariadb
     */
   void ClientSidePreparedStatement::addBatch()
   {
-    std::vector<Shared::ParameterHolder> holder(prepareResult->getParamCount());
-    for (uint32_t i= 0; i < holder.size(); i++) {
-      holder[i]= parameters[i];
-      if (!holder[i]) {
+    const std::size_t paramCount= prepareResult->getParamCount();
+    for (std::size_t i= 0; i < paramCount; i++) {
+      if (!parameters[i]) {
         logger->error(
           "You need to set exactly "
           + std::to_string(prepareResult->getParamCount())
@@ -175,25 +368,39 @@ namespace mariadb
           + " parameters on the prepared statement").Throw();
       }
     }
-    parameterList.push_back(holder);
+    if (isBatchEncoded()) {
+      encodedBatch.addRow(prepareResult->getQueryParts(), parameters, paramCount);
+      return;
+    }
+    parameterList.emplace_back(parameters.begin(), parameters.begin() + paramCount);
+  }
+
+  /* Rows are encoded at addBatch time, if the option is set, and the batch is going to be rewritten as the multi-values
+     query */
+  bool ClientSidePreparedStatement::isBatchEncoded()
+  {
+    const Shared::Options& options= protocol->getOptions();
+    return options->encodeBatchAtAdd && options->rewriteBatchedStatements
+      && prepareResult->isQueryMultiValuesRewritable() && autoGeneratedKeys == Statement::NO_GENERATED_KEYS;
   }
 
 
   void ClientSidePreparedStatement::clearBatch()
   {
     parameterList.clear();
+    encodedBatch.clear();
   }
 
   /** {inheritdoc}. */
   Ints& ClientSidePreparedStatement::executeBatch()
   {
     stmt->checkClose();
-    std::size_t size= parameterList.size();
+    std::size_t size= parameterList.size() + encodedBatch.size();
     if (size == 0) {
       return stmt->batchRes.wrap(nullptr, 0);
     }
 
-    std::unique_lock<std::mutex> localScopeLock(*protocol->getLock());
+    std::unique_lock<ConnectionMutex> localScopeLock(*protocol->getLock());
     try {
       executeInternalBatch(size);
       stmt->getInternalResults()->commandEnd();
@@ -235,12 +442,12 @@ namespace mariadb
   sql::Longs& ClientSidePreparedStatement::executeLargeBatch()
   {
     stmt->checkClose();
-    std::size_t size= parameterList.size();
+    std::size_t size= parameterList.size() + encodedBatch.size();
     if (size == 0) {
       return stmt->largeBatchRes.wrap(nullptr, 0);
     }
 
-    std::unique_lock<std::mutex> localScopeLock(*protocol->getLock());
+    std::unique_lock<ConnectionMutex> localScopeLock(*protocol->getLock());
     try {
       executeInternalBatch(size);
       stmt->getInternalResults()->commandEnd();
@@ -264,11 +471,10 @@ namespace mariadb
     */
   void ClientSidePreparedStatement::executeInternalBatch(std::size_t size)
   {
-    std::vector<Shared::ParameterHolder> dummy;
 
     stmt->executeQueryPrologue(true);
     stmt->setInternalResults(
-      new Results(
+      std::make_shared<Results>(
         this,
         0,
         true,
@@ -278,9 +484,12 @@ namespace mariadb
         stmt->getResultSetConcurrency(),
         autoGeneratedKeys,
         protocol->getAutoIncrementIncrement(),
-        nullptr,
-        dummy));
+        nullptr));
 
+    if (!encodedBatch.empty()) {
+      protocol->executeBatchEncoded(stmt->getInternalResults(), prepareResult.get(), encodedBatch);
+      return;
+    }
     protocol->executeBatchClient(protocol->isMasterConnection(), stmt->getInternalResults(),
       prepareResult.get(), parameterList, hasLongData);
     return;
@@ -321,6 +530,19 @@ namespace mariadb
     * @param holder parameter holder
     * @throws SQLException if index position doesn't correspond to query parameters
     */
+  /* Holders, that have been added to the batch, are shared with the batch, and can't be changed */
+  ParameterHolder* ClientSidePreparedStatement::getReusableParameter(int32_t parameterIndex)
+  {
+    if (parameterIndex >= 1 && static_cast<std::size_t>(parameterIndex) < prepareResult->getParamCount() + 1) {
+      Shared::ParameterHolder& holder= parameters[parameterIndex - 1];
+      if (holder && holder.use_count() == 1) {
+        return holder.get();
+      }
+    }
+    return nullptr;
+  }
+
+
   void ClientSidePreparedStatement::setParameter(int32_t parameterIndex, ParameterHolder* holder)
   {
     if (parameterIndex >= 1 && static_cast<std::size_t>(parameterIndex) < prepareResult->getParamCount() + 1) {
@@ -375,11 +597,23 @@ namespace mariadb
   {
     stmt->checkClose();
     if (!parameterMetaData) {
-      loadParametersData();
+      parameterMetaData= prepareResult->getParameterMetaData();
+    }
+    if (!parameterMetaData) {
+      // The parse tells all that can be told about no parameters
+      if (prepareResult->getParamCount() == 0) {
+        parameterMetaData.reset(new SimpleParameterMetaData(0));
+        prepareResult->setParameterMetaData(parameterMetaData);
+      }
+      else {
+        loadParametersData();
+      }
     }
     return parameterMetaData.get();
   }
 
+  /* Prepares the query on the server to get the metadata. The parameters metadata is kept with the parse result of
+     the query, so the next statements of the query do not have to ask the server again */
   void ClientSidePreparedStatement::loadParametersData()
   {
     try {
@@ -393,9 +627,14 @@ namespace mariadb
       resultSetMetaData.reset(ssps.getMetaData());
       parameterMetaData.reset(ssps.getParameterMetaData());
     }
-    catch (SQLException&) {
+    catch (SQLException& e) {
       parameterMetaData.reset(new SimpleParameterMetaData(static_cast<uint32_t>(prepareResult->getParamCount())));
+      // Connection errors say nothing about the query
+      if (e.getSQLState().startsWith("08")) {
+        return;
+      }
     }
+    prepareResult->setParameterMetaData(parameterMetaData);
   }
 
   /**
@@ -416,6 +655,18 @@ namespace mariadb
   void ClientSidePreparedStatement::close()
   {
     stmt->close();
+    // The prepare, that the cache keeps for other statements, is not the statement's any more. Otherwise it is deleted
+    // with the statement
+    if (serverPrepareResult && protocol) {
+      std::lock_guard<ConnectionMutex> localScopeLock(*protocol->getLock());
+      try {
+        if (!serverPrepareResult->getUnProxiedProtocol()->releasePrepareStatement(serverPrepareResult.get())) {
+          serverPrepareResult.release();
+        }
+      }
+      catch (SQLException&) {
+      }
+    }
     connection= nullptr;
   }
 
@@ -27,21 +27,29 @@
 #include "MariaDbStatement.h"
 
 #include "parameters/ParameterHolder.h"
+#include "util/EncodedBatch.h"
 
 namespace sql
 {
 namespace mariadb
 {
 
-class ClientSidePreparedStatement : public BasePrepareStatement
+class ClientSidePreparedStatement final : public BasePrepareStatement
 {
   static const Shared::Logger logger ; /*LoggerFactory.getLogger(typeid(ClientSidePreparedStatement))*/
   std::vector<std::vector<Shared::ParameterHolder>> parameterList;
+  // Rows of the batch, if they are encoded at addBatch time(encodeBatchAtAdd). Then parameterList stays empty
+  EncodedBatch encodedBatch;
   Shared::ClientPrepareResult prepareResult;
   SQLString sqlQuery;
   std::vector<Shared::ParameterHolder> parameters;
   Shared::ResultSetMetaData resultSetMetaData; /*NULL*/
   Shared::ParameterMetaData parameterMetaData ; /*NULL*/
+  // Executions of the statement, for serverPrepareThreshold
+  uint32_t executions= 0;
+  // Prepare of the statement, that has been executed more than serverPrepareThreshold times. The statement is executed
+  // with the binary protocol then
+  Unique::ServerPrepareResult serverPrepareResult;
 
   ClientSidePreparedStatement(
     MariaDbConnection* connection,
@@ -57,13 +65,31 @@ public:
     int32_t autoGeneratedKeys,
     Shared::ExceptionFactory& factory);
 
+  ~ClientSidePreparedStatement();
+
   ClientSidePreparedStatement* clone(MariaDbConnection* connection);
+  PreparedStatement* clone(Connection* connection);
 
   /* Need to define overloaded methods*/
   void addBatch(const SQLString& sql) { BasePrepareStatement::addBatch(sql); }
+  AsyncExecution* executeAsync(const SQLString& sql) { return BasePrepareStatement::executeAsync(sql); }
+
+  AsyncExecution* executeAsync();
 
 protected:
-  bool executeInternal(int32_t fetchSize);
+  bool executeInternal(int32_t fetchSize, bool isRetry= false, ErrorInfo* error= nullptr);
+  int64_t getResultCacheQuery(SQLString& query);
+
+private:
+  void validateParameters();
+  void prepareOnServer();
+  bool executeOnServer(int32_t fetchSize, bool isRetry, ErrorInfo* error);
+  template <class ProtocolType>
+  bool sendQuery(ProtocolType& executor, ErrorInfo* error);
+
+public:
+  /* Query text with current parameters values, as it would be sent for execution */
+  void assembleQuery(SQLString& out);
 
 public:
   void addBatch();
@@ -74,10 +100,12 @@ public:
 
 private:
   void executeInternalBatch(std::size_t size);
+  bool isBatchEncoded();
 
 public:
   sql::ResultSetMetaData* getMetaData();
   void setParameter(int32_t parameterIndex, ParameterHolder* holder);
+  ParameterHolder* getReusableParameter(int32_t parameterIndex);
   ParameterMetaData* getParameterMetaData();
 
 private:
@@ -91,6 +119,8 @@ public:
 
 protected:
   ClientPrepareResult* getPrepareResult();
+public:
+  ServerPrepareResult* getServerPrepareResult() { return serverPrepareResult.get(); }
 };
 }
 }
@@ -45,6 +45,11 @@ public:
   virtual SQLString getOriginalTable() const=0;
   virtual SQLString getName() const=0;
   virtual SQLString getOriginalName() const=0;
+  /* Same names without the copy. The pointer is valid as long as the object */
+  virtual const char* getTableView(std::size_t& length) const=0;
+  virtual const char* getOriginalTableView(std::size_t& length) const=0;
+  virtual const char* getNameView(std::size_t& length) const=0;
+  virtual const char* getOriginalNameView(std::size_t& length) const=0;
   virtual short getCharsetNumber() const=0;
   virtual SQLString getCollation() const=0;
   /* Length of the column */
@@ -65,6 +70,8 @@ public:
   virtual bool isZeroFill() const=0;
   virtual bool isBinary() const=0;
   virtual bool isReadonly() const=0;
+  /* If the column is of JSON type - either by the type code, or by the format in the extended metadata */
+  virtual bool isJson() const=0;
   // In case of resultset caching we might need to make local copy of metadata, and it does not make sense to make copy by default. it seems.
   virtual void makeLocalCopy()=0;
 };
@@ -57,36 +57,52 @@ namespace capi
   const ColumnType ColumnType::STRING(254, Types::VARCHAR, "Types::VARCHAR", "SQLString", 0);
   const ColumnType ColumnType::GEOMETRY(255, Types::VARBINARY, "Types::VARBINARY", "[B", 0);
 
-  const std::map<int32_t, const ColumnType&> ColumnType::typeMap= {
-    {ColumnType::OLDDECIMAL.mariadbType, ColumnType::OLDDECIMAL},
-    {ColumnType::TINYINT.mariadbType, ColumnType::TINYINT},
-    {ColumnType::SMALLINT.mariadbType, ColumnType::SMALLINT},
-    {ColumnType::INTEGER.mariadbType, ColumnType::INTEGER},
-    {ColumnType::FLOAT.mariadbType, ColumnType::FLOAT},
-    {ColumnType::DOUBLE.mariadbType, ColumnType::DOUBLE},
-    {ColumnType::_NULL.mariadbType, ColumnType::_NULL},
-    {ColumnType::TIMESTAMP.mariadbType, ColumnType::TIMESTAMP},
-    {ColumnType::BIGINT.mariadbType, ColumnType::BIGINT},
-    {ColumnType::MEDIUMINT.mariadbType, ColumnType::MEDIUMINT},
-    {ColumnType::DATE.mariadbType, ColumnType::DATE},
-    {ColumnType::TIME.mariadbType, ColumnType::TIME},
-    {ColumnType::DATETIME.mariadbType, ColumnType::DATETIME},
-    {ColumnType::YEAR.mariadbType, ColumnType::YEAR},
-    {ColumnType::NEWDATE.mariadbType, ColumnType::NEWDATE},
-    {ColumnType::VARCHAR.mariadbType, ColumnType::VARCHAR},
-    {ColumnType::BIT.mariadbType, ColumnType::BIT},
-    {ColumnType::JSON.mariadbType, ColumnType::JSON},
-    {ColumnType::DECIMAL.mariadbType, ColumnType::DECIMAL},
-    {ColumnType::ENUM.mariadbType, ColumnType::ENUM},
-    {ColumnType::SET.mariadbType, ColumnType::SET},
-    {ColumnType::TINYBLOB.mariadbType, ColumnType::TINYBLOB},
-    {ColumnType::MEDIUMBLOB.mariadbType, ColumnType::MEDIUMBLOB},
-    {ColumnType::LONGBLOB.mariadbType, ColumnType::LONGBLOB},
-    {ColumnType::BLOB.mariadbType, ColumnType::BLOB},
-    {ColumnType::VARSTRING.mariadbType, ColumnType::VARSTRING},
-    {ColumnType::STRING.mariadbType, ColumnType::STRING},
-    {ColumnType::GEOMETRY.mariadbType, ColumnType::GEOMETRY}
+  /* Types 0 - 16 are at the index of their value, and 245 - 255 follow them. The table holds only addresses, thus it
+     is initialized statically, and lookups do not depend on the order of the initialization */
+  static const int32_t LOW_TYPES_END= 17, HIGH_TYPES_BEGIN= 245, HIGH_TYPES_END= 256;
+  static const ColumnType* const typeTable[]= {
+    &ColumnType::OLDDECIMAL,
+    &ColumnType::TINYINT,
+    &ColumnType::SMALLINT,
+    &ColumnType::INTEGER,
+    &ColumnType::FLOAT,
+    &ColumnType::DOUBLE,
+    &ColumnType::_NULL,
+    &ColumnType::TIMESTAMP,
+    &ColumnType::BIGINT,
+    &ColumnType::MEDIUMINT,
+    &ColumnType::DATE,
+    &ColumnType::TIME,
+    &ColumnType::DATETIME,
+    &ColumnType::YEAR,
+    &ColumnType::NEWDATE,
+    &ColumnType::VARCHAR,
+    &ColumnType::BIT,
+    &ColumnType::JSON,
+    &ColumnType::DECIMAL,
+    &ColumnType::ENUM,
+    &ColumnType::SET,
+    &ColumnType::TINYBLOB,
+    &ColumnType::MEDIUMBLOB,
+    &ColumnType::LONGBLOB,
+    &ColumnType::BLOB,
+    &ColumnType::VARSTRING,
+    &ColumnType::STRING,
+    &ColumnType::GEOMETRY
   };
+  static_assert(sizeof(typeTable)/sizeof(typeTable[0]) == LOW_TYPES_END + HIGH_TYPES_END - HIGH_TYPES_BEGIN,
+    "Every type value of both ranges has to have the entry");
+
+  static const ColumnType* typeByValue(int32_t typeValue)
+  {
+    if (typeValue >= 0 && typeValue < LOW_TYPES_END) {
+      return typeTable[typeValue];
+    }
+    if (typeValue >= HIGH_TYPES_BEGIN && typeValue < HIGH_TYPES_END) {
+      return typeTable[LOW_TYPES_END + typeValue - HIGH_TYPES_BEGIN];
+    }
+    return nullptr;
+  }
 
   ColumnType::ColumnType(int32_t _mariadbType, int32_t _javaType, const SQLString& _javaTypeName, const SQLString& _className, size_t binBindTypeSize) :
     mariadbType(static_cast<int16_t>(_mariadbType)),
@@ -279,15 +295,12 @@ namespace capi
     */
   const ColumnType& ColumnType::fromServer(int32_t typeValue, int32_t charsetNumber)
   {
-    const auto cit= typeMap.find(typeValue);
-    const ColumnType& columnType= cit != typeMap.end() ? cit->second : BLOB;
-
     if (charsetNumber != 63 && typeValue >= 249 && typeValue <= 252) {
-
       return ColumnType::VARCHAR;
     }
+    const ColumnType* columnType= typeByValue(typeValue);
 
-    return columnType;
+    return columnType != nullptr ? *columnType : BLOB;
   }
 
   /**
@@ -298,9 +311,9 @@ namespace capi
     */
   const ColumnType& ColumnType::toServer(int32_t javaType)
   {
-    for (auto& cit : typeMap) {
-      if (cit.second.javaType == javaType) {
-        return cit.second;
+    for (auto type : typeTable) {
+      if (type->javaType == javaType) {
+        return *type;
       }
     }
     return ColumnType::BLOB;
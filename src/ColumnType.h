@@ -30,8 +30,6 @@ namespace mariadb
 
 class ColumnType
 {
-  static const std::map<int32_t, const ColumnType&> typeMap;
-
   const int16_t mariadbType;
   const int32_t javaType;
   const SQLString javaTypeName;
@@ -37,6 +37,7 @@
 #include "Version.h"
 #include "util/ServerStatus.h"
 #include "util/String.h"
+#include "util/ConnectionMutex.h"
 #include "CArrayImp.h"
 
 #include "ResultSet.hpp"
@@ -117,6 +118,7 @@ namespace mariadb
   class ColumnDefinition;
   class Credential;
   class ParameterHolder;
+  class EncodedBatch;
   class RowProtocol;
   class SelectResultSet;
   class ExceptionFactory;
@@ -171,7 +173,7 @@ namespace mariadb
 
   namespace Shared
   {
-    typedef std::shared_ptr<std::mutex> mutex;
+    typedef std::shared_ptr<ConnectionMutex> mutex;
 
     typedef std::shared_ptr<sql::mariadb::Options> Options;
     typedef std::shared_ptr<sql::mariadb::Logger> Logger;
@@ -0,0 +1,127 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#include "ControlConnectionRegistry.h"
+
+#include "UrlParser.h"
+#include "protocol/MasterProtocol.h"
+#include "pool/GlobalStateInfo.h"
+#include "util/LogQueryTool.h"
+
+namespace sql
+{
+namespace mariadb
+{
+  const std::chrono::minutes ControlConnectionRegistry::MAX_IDLE(5);
+
+  ControlConnectionRegistry::ControlConnection::ControlConnection()
+    : protocolLock(new ConnectionMutex())
+  {
+  }
+
+
+  ControlConnectionRegistry::ControlConnection::~ControlConnection()
+  {
+    if (protocol) {
+      try {
+        protocol->close();
+      }
+      catch (SQLException&) {
+      }
+    }
+  }
+
+
+  ControlConnectionRegistry& ControlConnectionRegistry::getInstance()
+  {
+    static ControlConnectionRegistry theInstance;
+    return theInstance;
+  }
+
+
+  void ControlConnectionRegistry::closeIdle(std::chrono::steady_clock::time_point now)
+  {
+    for (auto it= connections.begin(); it != connections.end();) {
+      // Connection, that is in use, is locked. It will be checked next time
+      std::unique_lock<std::mutex> connectionLock(it->second->lock, std::try_to_lock);
+      if (connectionLock.owns_lock() && now - it->second->lastUsed > MAX_IDLE) {
+        connectionLock.unlock();
+        it= connections.erase(it);
+      }
+      else {
+        ++it;
+      }
+    }
+  }
+
+
+  void ControlConnectionRegistry::execute(std::shared_ptr<UrlParser>& urlParser, const HostAddress& host,
+    const SQLString& command)
+  {
+    std::string key(StringImp::get(host.toString()));
+    key.append("|").append(StringImp::get(urlParser->getUsername()));
+    auto now= std::chrono::steady_clock::now();
+    std::shared_ptr<ControlConnection> control;
+    {
+      std::lock_guard<std::mutex> localScopeLock(lock);
+      closeIdle(now);
+      auto& entry= connections[key];
+      if (!entry) {
+        entry.reset(new ControlConnection());
+      }
+      control= entry;
+    }
+
+    std::lock_guard<std::mutex> connectionLock(control->lock);
+    control->lastUsed= now;
+    // The connection may have been closed by the server, while it was idle. Then it's established once more
+    for (int32_t attempt= 0; attempt < 2; ++attempt) {
+      bool reused= false;
+      try {
+        if (control->protocol && control->protocol->isConnected()) {
+          reused= true;
+        }
+        else {
+          control->protocol.reset(new MasterProtocol(urlParser, new GlobalStateInfo(), control->protocolLock));
+          control->protocol->setHostAddress(host);
+          control->protocol->connect();
+        }
+        control->protocol->executeQuery(command);
+        return;
+      }
+      catch (SQLException&) {
+        if (!reused || control->protocol->isConnected()) {
+          // Connect has failed, or the command itself
+          throw;
+        }
+        control->protocol.reset();
+      }
+    }
+  }
+
+
+  void ControlConnectionRegistry::clear()
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    connections.clear();
+  }
+
+}
+}
@@ -0,0 +1,75 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _CONTROLCONNECTIONREGISTRY_H_
+#define _CONTROLCONNECTIONREGISTRY_H_
+
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+
+#include "Consts.h"
+#include "HostAddress.h"
+
+namespace sql
+{
+namespace mariadb
+{
+class MasterProtocol;
+class UrlParser;
+
+/* Process wide set of "control" connections, used to send KILL commands for other connections, i.e. to cancel their
+   queries or abort them. There is one per host and user, created on the first use, so cancel does not cost the
+   connect and authentication every time. The connection is created with connection options of the connection, that
+   needed it first. It is re-established once, if it has been lost, e.g. closed by the server after wait_timeout, and
+   closed, if not used for MAX_IDLE */
+class ControlConnectionRegistry final
+{
+  static const std::chrono::minutes MAX_IDLE;
+
+  struct ControlConnection
+  {
+    std::mutex lock;
+    Shared::mutex protocolLock;
+    std::unique_ptr<MasterProtocol> protocol;
+    std::chrono::steady_clock::time_point lastUsed;
+
+    ControlConnection();
+    ~ControlConnection();
+  };
+
+  std::mutex lock;
+  std::unordered_map<std::string, std::shared_ptr<ControlConnection>> connections;
+
+  ControlConnectionRegistry() {}
+  /* Has to be called under the lock */
+  void closeIdle(std::chrono::steady_clock::time_point now);
+
+public:
+  static ControlConnectionRegistry& getInstance();
+
+  /* Executes the command on the control connection to the host */
+  void execute(std::shared_ptr<UrlParser>& urlParser, const HostAddress& host, const SQLString& command);
+  void clear();
+};
+
+}
+}
+#endif
@@ -22,6 +22,7 @@
 
 #include "ExceptionFactory.h"
 #include "MariaDbConnection.h"
+#include "SqlStates.h"
 
 
 namespace sql
@@ -73,14 +74,14 @@ namespace mariadb
       MariaDbConnection* connection,
       Statement* statement,
       std::exception* cause,
-      bool throwRightAway)
+      bool throwRightAway,
+      SQLException* messageSource)
   {
-    SQLString msg(buildMsgText(initialMessage, threadId, options, cause));
-
     MariaDBExceptionThrower returnEx;
 
     if (sqlState.compare("70100") == 0) { // ER_QUERY_INTERRUPTED
-      SQLTimeoutException ex(msg, sqlState, errorCode);
+      SQLTimeoutException ex(initialMessage, sqlState, errorCode);
+      decorate(ex, threadId, options, messageSource);
       if (throwRightAway) {
         throw ex;
       }
@@ -92,7 +93,8 @@ namespace mariadb
     SQLString sqlClass(sqlState.empty() ? "42" : sqlState.substr(0, 2).c_str());
 
     if (sqlClass.compare("0A") == 0) {
-      SQLFeatureNotSupportedException ex(msg, sqlState, errorCode, cause);
+      SQLFeatureNotSupportedException ex(initialMessage, sqlState, errorCode, cause);
+      decorate(ex, threadId, options, messageSource);
       if (throwRightAway) {
         throw ex;
       }
@@ -103,7 +105,8 @@ namespace mariadb
     else if (sqlClass.compare("22") == 0 || sqlClass.compare("26") == 0 || sqlClass.compare("2F") == 0
       || sqlClass.compare("20") == 0 || sqlClass.compare("42") == 0 || sqlClass.compare("XA"))
     {
-      SQLSyntaxErrorException ex(msg, sqlState, errorCode, cause);
+      SQLSyntaxErrorException ex(initialMessage, sqlState, errorCode, cause);
+      decorate(ex, threadId, options, messageSource);
       if (throwRightAway) {
         throw ex;
       }
@@ -112,7 +115,8 @@ namespace mariadb
       }
     }
     else if (sqlClass.compare("25") == 0 || sqlClass.compare("28") == 0) {
-      SQLInvalidAuthorizationSpecException ex(msg, sqlState, errorCode, cause);
+      SQLInvalidAuthorizationSpecException ex(initialMessage, sqlState, errorCode, cause);
+      decorate(ex, threadId, options, messageSource);
       if (throwRightAway) {
         throw ex;
       }
@@ -121,7 +125,8 @@ namespace mariadb
       }
     }
     else if (sqlClass.compare("21") == 0 || sqlClass.compare("23") == 0) {
-      SQLIntegrityConstraintViolationException ex(msg, sqlState, errorCode, cause);
+      SQLIntegrityConstraintViolationException ex(initialMessage, sqlState, errorCode, cause);
+      decorate(ex, threadId, options, messageSource);
       if (throwRightAway) {
         throw ex;
       }
@@ -130,7 +135,8 @@ namespace mariadb
       }
     }
     else if (sqlClass.compare("08") == 0) {
-      SQLNonTransientConnectionException ex(msg, sqlState, errorCode, cause);
+      SQLNonTransientConnectionException ex(initialMessage, sqlState, errorCode, cause);
+      decorate(ex, threadId, options, messageSource);
       if (throwRightAway) {
         throw ex;
       }
@@ -139,7 +145,8 @@ namespace mariadb
       }
     }
     else if (sqlClass.compare("40") == 0) {
-      SQLTransactionRollbackException ex(msg, sqlState, errorCode, cause);
+      SQLTransactionRollbackException ex(initialMessage, sqlState, errorCode, cause);
+      decorate(ex, threadId, options, messageSource);
       if (throwRightAway) {
         throw ex;
       }
@@ -148,7 +155,8 @@ namespace mariadb
       }
     }
     else {
-      SQLTransientConnectionException ex(msg, sqlState, errorCode, cause);
+      SQLTransientConnectionException ex(initialMessage, sqlState, errorCode, cause);
+      decorate(ex, threadId, options, messageSource);
       if (throwRightAway) {
         throw ex;
       }
@@ -163,61 +171,18 @@ namespace mariadb
     return returnEx;
   }
 
-  SQLString ExceptionFactory::buildMsgText(const SQLString& initialMessage, int64_t threadId, Shared::Options& options, std::exception* cause)
+  /* Adds the connection id to the message, and the additions of the exception, the message is taken from. The text is
+     put together only if it's requested */
+  void ExceptionFactory::decorate(SQLException& exception, int64_t threadId, Shared::Options& options, SQLException* messageSource)
   {
-    std::ostringstream msg("");
-    SQLString deadLockException;
-    SQLString threadName;
-
-    if (threadId != -1){
-      msg << "(conn=" << threadId << ") " << initialMessage.c_str();
-    }else {
-      msg << initialMessage.c_str();
-    }
-
-    SQLException* exception= dynamic_cast<SQLException*>(cause);
-    if (exception != nullptr) {
-
-      SQLString sql;// = exception.getSql();
-
-      if (options && options->dumpQueriesOnException && !sql.empty()){
-        if (options && options->maxQuerySizeToLog != 0
-            && sql.size() + 3 > static_cast<std::size_t>(options->maxQuerySizeToLog)) {
-          msg << "\nQuery is: " << sql.substr(0, options->maxQuerySizeToLog - 3).c_str() << "...";
-        }else {
-          msg << "\nQuery is: " << sql.c_str();
-        }
-      }
-      //deadLockException= exception.getDeadLockInfo();
-      //threadName= exception.getThreadName();
-    }
-
-    if (options && options->includeInnodbStatusInDeadlockExceptions
-        && !deadLockException.empty()) {
-      msg << "\ndeadlock information: " << deadLockException.c_str();
+    if (messageSource != nullptr) {
+      ExceptionMessage::copy(*messageSource, exception);
     }
+    ExceptionMessage::setThreadId(exception, threadId);
 
     if (options && options->includeThreadDumpInDeadlockExceptions) {
-      if (!threadName.empty()){
-        msg << "\nthread name: " << threadName.c_str();
-      }
-      msg << "\ncurrent threads: ";
-      /*Thread.getAllStackTraces()
-        .forEach(
-            (thread,traces)->{
-            msg.append("\n  name:\"")
-            .append(thread.getName())
-            .append("\" pid:")
-            .append(thread.getId())
-            .append(" status:")
-            .append(thread.getState());
-            for (int32_t i= 0;i <traces.length;i++){
-            msg.append("\n    ").append(traces[i]);
-            }
-            });*/
+      ExceptionMessage::append(exception, "\ncurrent threads: ");
     }
-
-    return msg.str();
   }
 
   std::unique_ptr<ExceptionFactory> ExceptionFactory::raiseStatementError(MariaDbConnection* connection, Statement* stmt)
@@ -227,8 +192,9 @@ namespace mariadb
 
   MariaDBExceptionThrower ExceptionFactory::create(SQLException& cause, bool throwRightAway)
   {
+    // The message of the cause is taken without its additions - they are copied by decorate
     return createException(
-        cause.getMessage(),
+        ExceptionMessage::getRawMessage(cause),
         cause.getSQLState(),
         cause.getErrorCode(),
         threadId,
@@ -236,7 +202,8 @@ namespace mariadb
         connection,
         statement,
         &cause,
-        throwRightAway);
+        throwRightAway,
+        &cause);
   }
 
   SQLFeatureNotSupportedException ExceptionFactory::notSupported(const SQLString& message)
@@ -295,5 +262,31 @@ namespace mariadb
     asStr << "ExceptionFactory{" << "threadId=" << threadId  << '}';
     return asStr.str();
   }
+
+
+  void ExceptionFactory::toErrorInfo(const char* message, const char* sqlState, int32_t errorCode, ErrorInfo& error)
+  {
+    error.errorCode= errorCode;
+    error.sqlState= sqlState;
+    error.message= message;
+    error.kind= SqlStates::classify(error.sqlState, false, nullptr);
+  }
+
+  /* The timeout is told by the class of the exception */
+  void ExceptionFactory::toErrorInfo(SQLException& exception, ErrorInfo& error)
+  {
+    error.errorCode= exception.getErrorCode();
+    error.sqlState= exception.getSQLState();
+    error.message= exception.what();
+    error.kind= SqlStates::classify(error.sqlState, INSTANCEOF(&exception, SQLTimeoutException*), &exception);
+  }
+
+  void ExceptionFactory::toErrorInfo(const std::exception& exception, ErrorInfo& error)
+  {
+    error.errorCode= 0;
+    error.sqlState= "HY000";
+    error.message= exception.what();
+    error.kind= ErrorInfo::GENERIC;
+  }
 }
 }
@@ -63,9 +63,10 @@ private:
     MariaDbConnection* connection,
     Statement* statement,
     std::exception* cause,
-    bool throwRightAway= true);
+    bool throwRightAway= true,
+    SQLException* messageSource= nullptr);
 
-  static SQLString buildMsgText(const SQLString& initialMessage, int64_t threadId, Shared::Options& options, std::exception* cause);
+  static void decorate(SQLException& exception, int64_t threadId, Shared::Options& options, SQLException* messageSource);
 
 public:
   std::unique_ptr<ExceptionFactory> raiseStatementError(MariaDbConnection* connection, Statement* stmt);
@@ -82,7 +83,32 @@ public:
   int64_t getThreadId();
   Shared::Options& getOptions();
   SQLString toString();
+
+  /* For the non-throwing methods. The error of the server, the exception, that the throwing method would throw, and
+     any other exception respectively */
+  static void toErrorInfo(const char* message, const char* sqlState, int32_t errorCode, ErrorInfo& error);
+  static void toErrorInfo(SQLException& exception, ErrorInfo& error);
+  static void toErrorInfo(const std::exception& exception, ErrorInfo& error);
+  /* Runs the throwing operation. Returns false, if its exception has been put into the error */
+  template <class Operation> static bool catchInto(ErrorInfo& error, Operation operation);
   };
+
+
+template <class Operation> bool ExceptionFactory::catchInto(ErrorInfo& error, Operation operation)
+{
+  try {
+    operation();
+    return true;
+  }
+  catch (SQLException& exception) {
+    toErrorInfo(exception, error);
+  }
+  catch (std::exception& exception) {
+    toErrorInfo(exception, error);
+  }
+  return false;
+}
+
 }
 }
 #endif
\ No newline at end of file
@@ -59,8 +59,10 @@ namespace mariadb
     */
   SQLException ExceptionMapper::getException(SQLException &exception, MariaDbConnection* connection, MariaDbStatement* statement, bool timeout)
   {
-    SQLString message("(conn=");
-    SQLString errMsg(exception.getMessage());
+    // Only the first line of the raw message is taken, without the query and other additions
+    SQLString errMsg(ExceptionMessage::getRawMessage(exception));
+    SQLString details;
+    int64_t threadId= -1;
 
     if ((errMsg.find_first_of("\n") != std::string::npos))
     {
@@ -68,14 +70,10 @@ namespace mariadb
     }
     if (connection != NULL)
     {
-      message.append(std::to_string(connection->getServerThreadId())).append(") ").append(errMsg);
+      threadId= connection->getServerThreadId();
     }
     else if (statement != NULL) {
-      message.append(std::to_string(statement->getServerThreadId())).append(") ")
-        .append(errMsg);
-    }
-    else {
-      message= errMsg;
+      threadId= statement->getServerThreadId();
     }
 
     SQLException sqlException;
@@ -93,7 +91,7 @@ namespace mariadb
 
             if (rs->next())
             {
-              message.append("\nDeadlock information: ").append(rs->getString(3));
+              details.append("\nDeadlock information: ").append(rs->getString(3));
             }
           }
           catch (SQLException& /*sqle*/) {
@@ -104,11 +102,11 @@ namespace mariadb
         if (connection->includeThreadsTraces())
         {
 #ifdef WE_FOUND_WHAT_TO_USE_HERE
-          message.append("\n\ncurrent threads: ");
+          details.append("\n\ncurrent threads: ");
           Thread.getAllStackTraces()
             .forEach(
             (thread, traces)->{
-            message
+            details
               .append("\n  name:\"")
               .append(thread.getName())
               .append("\" pid:")
@@ -116,14 +114,18 @@ namespace mariadb
               .append(" status:")
               .append(thread.getState());
             for (int32_t i= 0; i <traces.length; i++) {
-              message.append("\n    ").append(traces[i]);
+              details.append("\n    ").append(traces[i]);
             }
           });
 #endif
         }
       }
-      sqlException= get(message, exception.getSQLState(), exception.getErrorCode(), &exception,
+      sqlException= get(errMsg, exception.getSQLState(), exception.getErrorCode(), &exception,
           timeout);
+      ExceptionMessage::setThreadId(sqlException, threadId);
+      if (!details.empty()) {
+        ExceptionMessage::append(sqlException, details);
+      }
 
       SQLException* nextException= exception.getNextException();
       if (nextException != NULL) {
@@ -192,57 +194,27 @@ namespace mariadb
   SQLException ExceptionMapper::get(const SQLString& message, const SQLString& sqlState, int32_t errorCode,
                                     const std::exception *exception, bool timeout)
   {
-    const SqlStates state(SqlStates::fromString(sqlState));
-
-    if (state.getSqlState().compare(DATA_EXCEPTION.getSqlState()) == 0) {
+    switch (SqlStates::classify(sqlState, timeout, exception)) {
+    case ErrorInfo::DATA:
       return SQLDataException(message, sqlState, errorCode, exception);
-    }
-    else if(state.getSqlState().compare(FEATURE_NOT_SUPPORTED.getSqlState()) == 0) {
+    case ErrorInfo::FEATURE_NOT_SUPPORTED:
       return SQLFeatureNotSupportedException(message, sqlState, errorCode, exception);
-    }
-    else if(state.getSqlState().compare(CONSTRAINT_VIOLATION.getSqlState()) == 0) {
-      return SQLIntegrityConstraintViolationException(
-        message, sqlState, errorCode, exception);
-    }
-    else if(state.getSqlState().compare(INVALID_AUTHORIZATION.getSqlState()) == 0) {
+    case ErrorInfo::INTEGRITY_CONSTRAINT_VIOLATION:
+      return SQLIntegrityConstraintViolationException(message, sqlState, errorCode, exception);
+    case ErrorInfo::INVALID_AUTHORIZATION:
       return SQLInvalidAuthorizationSpecException(message, sqlState, errorCode, exception);
-    }
-    else if(state.getSqlState().compare(CONNECTION_EXCEPTION.getSqlState()) == 0) {
+    case ErrorInfo::NON_TRANSIENT_CONNECTION:
       return SQLNonTransientConnectionException(message, sqlState, errorCode, exception);
-    }
-    else if(state.getSqlState().compare(SYNTAX_ERROR_ACCESS_RULE.getSqlState()) == 0) {
+    case ErrorInfo::SYNTAX:
       return SQLSyntaxErrorException(message, sqlState, errorCode, exception);
-    }
-    else if(state.getSqlState().compare(TRANSACTION_ROLLBACK.getSqlState()) == 0) {
+    case ErrorInfo::TRANSACTION_ROLLBACK:
       return SQLTransactionRollbackException(message, sqlState, errorCode, exception);
-    }
-    else if(state.getSqlState().compare(WARNING.getSqlState()) == 0) {
-      /* TODO: need to think about that */
-      //return MariaDBWarning(message, sqlState, errorCode, exception);
-      return SQLException(message, sqlState, errorCode, exception);
-    }
-    else if(state.getSqlState().compare(INTERRUPTED_EXCEPTION.getSqlState()) == 0) {
-      if(timeout && (sqlState.compare("70100") == 0))
-      {
-        return SQLTimeoutException(message, sqlState, errorCode, exception);
-      }
-      else if(INSTANCEOF(exception, const SQLNonTransientConnectionException*))
-      {
-        return SQLNonTransientConnectionException(message, sqlState, errorCode, exception);
-      }
+    case ErrorInfo::TRANSIENT:
       return SQLTransientException(message, sqlState, errorCode, exception);
-    }
-    else if(state.getSqlState().compare(TIMEOUT_EXCEPTION.getSqlState()) == 0) {
+    case ErrorInfo::TIMEOUT:
       return SQLTimeoutException(message, sqlState, errorCode, exception);
-    }
-    else if (state.getSqlState().compare(UNDEFINED_SQLSTATE.getSqlState()) == 0) {
-      if (INSTANCEOF(exception, const SQLNonTransientConnectionException*))
-      {
-        return SQLNonTransientConnectionException(message, sqlState, errorCode, exception);
-      }
-      return SQLException(message, sqlState, errorCode, exception);
-    }
-    else {
+    default:
+      /* TODO: need to think about warnings - MariaDBWarning(message, sqlState, errorCode, exception) */
       return SQLException(message, sqlState, errorCode, exception);
     }
   }
@@ -53,6 +53,8 @@ namespace sql
       : host(other.host)
       , port(other.port)
       , type(other.type)
+      , weight(other.weight)
+      , compress(other.compress)
     {}
 
     HostAddress& HostAddress::operator=(const HostAddress& right)
@@ -60,11 +62,14 @@ namespace sql
       host= right.host;
       port= right.port;
       type= right.type;
+      weight= right.weight;
+      compress= right.compress;
       return *this;
     }
 
     HostAddress::HostAddress(HostAddress &&moved) :
-      host(std::move(moved.host)), port(moved.port), type(std::move(moved.type))
+      host(std::move(moved.host)), port(moved.port), type(std::move(moved.type)), weight(moved.weight),
+      compress(moved.compress)
     {
     }
 
@@ -163,7 +168,7 @@ namespace sql
       HostAddress result;
       Tokens array= split(_str, "(?=\\()|(?<=\\))");
       std::size_t parenthesis= 0, closing= 0;
-      while ((parenthesis= _str.find_first_of('(')) != std::string::npos) 
+      while ((parenthesis= _str.find_first_of('(', closing)) != std::string::npos)
       {
         closing= _str.find_first_of(')', parenthesis + 1);
         if (closing == std::string::npos) {
@@ -181,6 +186,7 @@ namespace sql
 
         if ((key.compare("host") == 0))
         {
+          result.host= (*token)[1];
           replaceAny(result.host, "[]", "");
         }
         else if ((key.compare("port") == 0)) {
@@ -191,6 +197,28 @@ namespace sql
             || value.compare(ParameterConstant::TYPE_SLAVE) == 0 )) {
           result.type= value;
         }
+        else if ((key.compare("weight") == 0)) {
+          try {
+            result.weight= std::stoi(StringImp::get(value));
+          }
+          catch (std::exception&) {
+            throw IllegalArgumentException("Invalid connection URL, host weight must be a positive integer, found " + value);
+          }
+          if (result.weight < 1) {
+            throw IllegalArgumentException("Invalid connection URL, host weight must be a positive integer, found " + value);
+          }
+        }
+        else if ((key.compare("compress") == 0)) {
+          if (value.compare("true") == 0 || value.compare("1") == 0) {
+            result.compress= COMPRESS_ON;
+          }
+          else if (value.compare("false") == 0 || value.compare("0") == 0) {
+            result.compress= COMPRESS_OFF;
+          }
+          else {
+            throw IllegalArgumentException("Invalid connection URL, host compress must be true or false, found " + value);
+          }
+        }
         ++closing;
       }
       return result;
@@ -211,6 +239,12 @@ namespace sql
             .append(")(type=")
             .append(addr.type)
             .append(")");
+          if (addr.weight != 1) {
+            str.append("(weight=").append(std::to_string(addr.weight)).append(")");
+          }
+          if (addr.compress != COMPRESS_DEFAULT) {
+            str.append(addr.compress == COMPRESS_ON ? "(compress=true)" : "(compress=false)");
+          }
         }
         else
         {
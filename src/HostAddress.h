@@ -42,6 +42,11 @@ namespace mariadb
     SQLString host;
     int32_t   port;
     SQLString type;
+    /* Relative weight of the host for load balancing, set with address=(host=..)(weight=..) */
+    int32_t   weight= 1;
+    /* Compression of the connections to the host, set with address=(host=..)(compress=..). By default the
+       useCompression option decides */
+    enum Compress { COMPRESS_DEFAULT= -1, COMPRESS_OFF= 0, COMPRESS_ON= 1 } compress= COMPRESS_DEFAULT;
   private:
     HostAddress();
   public:
@@ -0,0 +1,519 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+#ifdef _WIN32
+# include <windows.h>
+#else
+# include <unistd.h>
+#endif
+
+#include "HostHealthRegistry.h"
+
+namespace sql
+{
+namespace mariadb
+{
+  const std::chrono::hours HostHealthRegistry::MAX_BLACKLIST_AGE(1);
+  const std::chrono::seconds HostHealthRegistry::GALERA_POLL_INTERVAL(1);
+  const std::chrono::hours HostHealthRegistry::MAX_GALERA_IDLE(1);
+
+  static const char* GALERA_STATUS_QUERY= "SHOW STATUS WHERE Variable_name IN "
+    "('wsrep_local_state','wsrep_local_recv_queue','wsrep_flow_control_paused_ns')";
+
+
+  HostHealthRegistry::GaleraNode::GaleraNode(const HostAddress& _host, const SQLString& _user, const SQLString& _password,
+    const std::vector<SQLString>& _allowedStates)
+    : host(_host)
+    , user(_user)
+    , password(_password)
+    , allowedStates(_allowedStates)
+    , connection(nullptr)
+    , pausedNs(0)
+    , known(false)
+    , degraded(false)
+  {}
+
+
+  HostHealthRegistry::GaleraNode::~GaleraNode()
+  {
+    if (connection != nullptr) {
+      capi::mysql_close(connection);
+    }
+  }
+
+  HostHealthRegistry& HostHealthRegistry::getInstance()
+  {
+    static HostHealthRegistry theInstance;
+    return theInstance;
+  }
+
+
+  HostHealthRegistry::~HostHealthRegistry()
+  {
+    {
+      std::lock_guard<std::mutex> localScopeLock(lock);
+      stopping= true;
+    }
+    proberWakeup.notify_all();
+    if (prober.joinable()) {
+      prober.join();
+    }
+    for (auto& it : rsaPublicKeyFiles) {
+      if (!it.second.empty()) {
+        std::remove(it.second.c_str());
+      }
+    }
+  }
+
+
+  bool HostHealthRegistry::isHostFailure(int32_t errorCode)
+  {
+    // Client side errors of the C API. Errors sent by the server mean the host is alive
+    return errorCode >= 2000 && errorCode < 3000;
+  }
+
+
+  std::string HostHealthRegistry::key(const HostAddress& host)
+  {
+    std::string result(StringImp::get(host.host));
+    return result.append(":").append(std::to_string(host.port));
+  }
+
+
+  double HostHealthRegistry::score(const HostAddress& host)
+  {
+    auto it= latencies.find(key(host));
+    if (it == latencies.end()) {
+      return 0.0;
+    }
+    return it->second / (host.weight > 0 ? host.weight : 1);
+  }
+
+
+  void HostHealthRegistry::updateLatency(const HostAddress& host, std::chrono::microseconds latency)
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    auto result= latencies.emplace(key(host), static_cast<double>(latency.count()));
+
+    if (!result.second) {
+      result.first->second+= LATENCY_ALPHA*(latency.count() - result.first->second);
+    }
+    blacklist.erase(key(host));
+  }
+
+
+  void HostHealthRegistry::order(std::vector<HostAddress>& hosts)
+  {
+    std::vector<double> scores, weights;
+    std::lock_guard<std::mutex> localScopeLock(lock);
+
+    scores.reserve(hosts.size());
+    weights.reserve(hosts.size());
+    for (const auto& host : hosts) {
+      scores.push_back(score(host));
+      weights.push_back(host.weight > 0 ? host.weight : 1);
+    }
+
+    for (std::size_t i= 0; i + 1 < hosts.size(); ++i) {
+      std::discrete_distribution<std::size_t> pick(weights.begin() + i, weights.end());
+      std::size_t first= i + pick(rnd), second= i + pick(rnd);
+      std::size_t chosen= scores[second] < scores[first] ? second : first;
+
+      if (chosen != i) {
+        std::swap(hosts[i], hosts[chosen]);
+        std::swap(scores[i], scores[chosen]);
+        std::swap(weights[i], weights[chosen]);
+      }
+    }
+    partitionUnhealthy(hosts);
+  }
+
+
+  bool HostHealthRegistry::isUnhealthy(const std::string& hostKey)
+  {
+    if (blacklist.find(hostKey) != blacklist.end()) {
+      return true;
+    }
+    auto it= galeraNodes.find(hostKey);
+    return it != galeraNodes.end() && it->second->known && it->second->degraded;
+  }
+
+
+  void HostHealthRegistry::partitionUnhealthy(std::vector<HostAddress>& hosts)
+  {
+    if (!blacklist.empty() || !galeraNodes.empty()) {
+      std::stable_partition(hosts.begin(), hosts.end(),
+        [this](const HostAddress& host) { return !isUnhealthy(key(host)); });
+    }
+  }
+
+
+  void HostHealthRegistry::moveUnhealthyLast(std::vector<HostAddress>& hosts)
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    partitionUnhealthy(hosts);
+  }
+
+
+  void HostHealthRegistry::addToBlacklist(const HostAddress& host, const SQLString& user, const SQLString& password,
+    int32_t blacklistTimeout)
+  {
+    if (blacklistTimeout <= 0) {
+      return;
+    }
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    std::string hostKey(key(host));
+
+    if (blacklist.find(hostKey) != blacklist.end() || stopping) {
+      return;
+    }
+    auto now= std::chrono::steady_clock::now();
+    std::chrono::seconds backoff(1);
+    blacklist.emplace(hostKey,
+      Blacklisted{host, user, password, backoff, std::chrono::seconds(blacklistTimeout), now, now + backoff});
+    startProber();
+  }
+
+
+  /* Has to be called under the lock */
+  void HostHealthRegistry::startProber()
+  {
+    if (!prober.joinable()) {
+      prober= std::thread(&HostHealthRegistry::probing, this);
+    }
+    else {
+      proberWakeup.notify_all();
+    }
+  }
+
+
+  void HostHealthRegistry::removeFromBlacklist(const HostAddress& host)
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    blacklist.erase(key(host));
+  }
+
+
+  bool HostHealthRegistry::isBlacklisted(const HostAddress& host)
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    return blacklist.find(key(host)) != blacklist.end();
+  }
+
+
+  void HostHealthRegistry::watchGalera(const HostAddress& host, const SQLString& user, const SQLString& password,
+    const std::vector<SQLString>& allowedStates)
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    std::string hostKey(key(host));
+    auto now= std::chrono::steady_clock::now();
+    auto it= galeraNodes.find(hostKey);
+
+    if (it != galeraNodes.end()) {
+      it->second->lastUsed= now;
+      return;
+    }
+    if (stopping) {
+      return;
+    }
+    std::shared_ptr<GaleraNode> node(new GaleraNode(host, user, password, allowedStates));
+    node->lastUsed= now;
+    node->nextPoll= now;
+    galeraNodes.emplace(hostKey, node);
+    startProber();
+  }
+
+
+  bool HostHealthRegistry::galeraDegraded(const HostAddress& host, bool& degraded)
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    auto it= galeraNodes.find(key(host));
+
+    if (it == galeraNodes.end() || !it->second->known) {
+      return false;
+    }
+    degraded= it->second->degraded;
+    return true;
+  }
+
+
+  bool HostHealthRegistry::pollGalera(GaleraNode& node, bool& known)
+  {
+    known= false;
+    if (node.connection == nullptr) {
+      node.connection= capi::mysql_init(nullptr);
+      if (node.connection == nullptr) {
+        return false;
+      }
+      const unsigned int timeout= PROBE_TIMEOUT_SECONDS;
+      capi::mysql_optionsv(node.connection, capi::MYSQL_OPT_CONNECT_TIMEOUT, &timeout);
+      capi::mysql_optionsv(node.connection, capi::MYSQL_OPT_READ_TIMEOUT, &timeout);
+
+      if (capi::mysql_real_connect(node.connection, node.host.host.c_str(), node.user.c_str(), node.password.c_str(),
+        nullptr, static_cast<unsigned int>(node.host.port), nullptr, 0) == nullptr) {
+        capi::mysql_close(node.connection);
+        node.connection= nullptr;
+        return false;
+      }
+    }
+    capi::MYSQL_RES* res= nullptr;
+    if (capi::mysql_query(node.connection, GALERA_STATUS_QUERY) != 0
+      || (res= capi::mysql_store_result(node.connection)) == nullptr) {
+      capi::mysql_close(node.connection);
+      node.connection= nullptr;
+      return false;
+    }
+
+    SQLString state;
+    int64_t recvQueue= 0;
+    uint64_t pausedNs= node.pausedNs;
+    capi::MYSQL_ROW row;
+
+    while ((row= capi::mysql_fetch_row(res)) != nullptr) {
+      if (row[0] == nullptr || row[1] == nullptr) {
+        continue;
+      }
+      std::string name(row[0]);
+      if (name.compare("wsrep_local_state") == 0) {
+        state= row[1];
+      }
+      else if (name.compare("wsrep_local_recv_queue") == 0) {
+        recvQueue= std::strtoll(row[1], nullptr, 10);
+      }
+      else if (name.compare("wsrep_flow_control_paused_ns") == 0) {
+        pausedNs= std::strtoull(row[1], nullptr, 10);
+      }
+    }
+    capi::mysql_free_result(res);
+
+    if (state.empty()) {
+      // Not a Galera node
+      return false;
+    }
+    auto now= std::chrono::steady_clock::now();
+    double paused= 0.0;
+
+    if (node.pausedNs != 0 && pausedNs >= node.pausedNs) {
+      paused= static_cast<double>(pausedNs - node.pausedNs)/
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now - node.polled).count();
+    }
+    node.pausedNs= pausedNs;
+    node.polled= now;
+    known= true;
+
+    return std::find(node.allowedStates.begin(), node.allowedStates.end(), state) == node.allowedStates.end()
+      || recvQueue >= GALERA_MAX_RECV_QUEUE || paused > GALERA_MAX_PAUSED;
+  }
+
+
+  bool HostHealthRegistry::probe(const Blacklisted& entry)
+  {
+    capi::MYSQL* socket= capi::mysql_init(nullptr);
+    if (socket == nullptr) {
+      return false;
+    }
+    const unsigned int timeout= PROBE_TIMEOUT_SECONDS;
+    capi::mysql_optionsv(socket, capi::MYSQL_OPT_CONNECT_TIMEOUT, &timeout);
+    capi::mysql_optionsv(socket, capi::MYSQL_OPT_READ_TIMEOUT, &timeout);
+
+    bool alive= capi::mysql_real_connect(socket, entry.host.host.c_str(), entry.user.c_str(), entry.password.c_str(),
+      nullptr, static_cast<unsigned int>(entry.host.port), nullptr, 0) != nullptr
+      || !isHostFailure(static_cast<int32_t>(capi::mysql_errno(socket)));
+
+    capi::mysql_close(socket);
+    return alive;
+  }
+
+
+  void HostHealthRegistry::probing()
+  {
+    std::unique_lock<std::mutex> localScopeLock(lock);
+
+    while (!stopping) {
+      if (blacklist.empty() && galeraNodes.empty()) {
+        proberWakeup.wait(localScopeLock);
+        continue;
+      }
+      auto now= std::chrono::steady_clock::now();
+      auto nextRun= now + GALERA_POLL_INTERVAL;
+      std::string hostKey;
+      std::shared_ptr<GaleraNode> galeraNode;
+
+      for (auto& it : blacklist) {
+        if (it.second.nextProbe < nextRun) {
+          nextRun= it.second.nextProbe;
+          hostKey= it.first;
+        }
+      }
+      for (auto& it : galeraNodes) {
+        if (it.second->nextPoll < nextRun) {
+          nextRun= it.second->nextPoll;
+          hostKey= it.first;
+          galeraNode= it.second;
+        }
+      }
+
+      if (hostKey.empty() || nextRun > now) {
+        proberWakeup.wait_until(localScopeLock, nextRun);
+        continue;
+      }
+
+      if (galeraNode) {
+        localScopeLock.unlock();
+        bool known, degraded= pollGalera(*galeraNode, known);
+        localScopeLock.lock();
+
+        now= std::chrono::steady_clock::now();
+        galeraNode->known= known;
+        galeraNode->degraded= degraded;
+        galeraNode->nextPoll= now + GALERA_POLL_INTERVAL;
+        if (now - galeraNode->lastUsed > MAX_GALERA_IDLE) {
+          galeraNodes.erase(hostKey);
+        }
+        continue;
+      }
+
+      Blacklisted entry(blacklist.find(hostKey)->second);
+
+      localScopeLock.unlock();
+      bool alive= probe(entry);
+      localScopeLock.lock();
+
+      // The entry might have been removed or replaced while probing
+      auto it= blacklist.find(hostKey);
+      if (it == blacklist.end()) {
+        continue;
+      }
+      now= std::chrono::steady_clock::now();
+      if (alive || now - it->second.since > MAX_BLACKLIST_AGE) {
+        blacklist.erase(it);
+      }
+      else {
+        it->second.backoff= std::min(it->second.backoff*2, it->second.maxBackoff);
+        it->second.nextProbe= now + it->second.backoff;
+      }
+    }
+  }
+
+
+  bool HostHealthRegistry::getLocalSocket(const HostAddress& host, SQLString& path)
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    auto it= localSockets.find(key(host));
+
+    if (it == localSockets.end()) {
+      return false;
+    }
+    path= it->second;
+    return true;
+  }
+
+
+  void HostHealthRegistry::setLocalSocket(const HostAddress& host, const SQLString& path)
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    localSockets[key(host)]= path;
+  }
+
+
+  bool HostHealthRegistry::getRsaPublicKeyFile(const HostAddress& host, SQLString& path)
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    auto it= rsaPublicKeyFiles.find(key(host));
+
+    if (it == rsaPublicKeyFiles.end()) {
+      return false;
+    }
+    path= it->second;
+    return true;
+  }
+
+
+  static std::string createKeyFile()
+  {
+#ifdef _WIN32
+    char dir[MAX_PATH + 1], path[MAX_PATH + 1];
+
+    if (GetTempPathA(sizeof(dir), dir) == 0 || GetTempFileNameA(dir, "mdb", 0, path) == 0) {
+      return "";
+    }
+    return path;
+#else
+    const char* dir= std::getenv("TMPDIR");
+    std::string path(dir != nullptr && *dir != '\0' ? dir : "/tmp");
+
+    path.append("/mariadb-rsa-XXXXXX");
+    int fd= mkstemp(&path[0]);
+    if (fd < 0) {
+      return "";
+    }
+    close(fd);
+    return path;
+#endif
+  }
+
+
+  void HostHealthRegistry::setRsaPublicKey(const HostAddress& host, const std::string& pem)
+  {
+    std::string path;
+
+    if (!pem.empty()) {
+      path= createKeyFile();
+      if (!path.empty()) {
+        std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        file << pem;
+        if (!file) {
+          file.close();
+          std::remove(path.c_str());
+          path.clear();
+        }
+      }
+    }
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    auto inserted= rsaPublicKeyFiles.emplace(key(host), path);
+
+    // Other connection to the host has stored the key meanwhile
+    if (!inserted.second && !path.empty()) {
+      std::remove(path.c_str());
+    }
+  }
+
+
+  void HostHealthRegistry::clear()
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    latencies.clear();
+    blacklist.clear();
+    galeraNodes.clear();
+    localSockets.clear();
+    for (auto& it : rsaPublicKeyFiles) {
+      if (!it.second.empty()) {
+        std::remove(it.second.c_str());
+      }
+    }
+    rsaPublicKeyFiles.clear();
+  }
+}
+}
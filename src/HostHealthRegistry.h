@@ -0,0 +1,168 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _HOSTHEALTHREGISTRY_H_
+#define _HOSTHEALTHREGISTRY_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "HostAddress.h"
+
+namespace sql
+{
+namespace mariadb
+{
+namespace capi
+{
+#include "mysql.h"
+}
+}
+}
+
+namespace sql
+{
+namespace mariadb
+{
+
+/* Process wide registry of observed hosts health, shared by all connections. That is the latency - EWMA of connect
+   and ping times of each host, and the blacklist of hosts, connection to which has failed. Both are used for ordering
+   of hosts for connection attempts.
+   Blacklisted hosts are probed by the background thread with exponential backoff, starting from 1s and up to the
+   loadBalanceBlacklistTimeout of the connection, that blacklisted the host. Once the host answers, or any connection
+   to it succeeds, it's back in rotation. Hosts, that do not answer for MAX_BLACKLIST_AGE, are forgotten.
+   Galera nodes, i.e. hosts of connections with galeraAllowedState option, are polled by the same thread every
+   GALERA_POLL_INTERVAL over own connection. Node is degraded, if its wsrep_local_state is not allowed, or its receive
+   queue is long enough to trigger the flow control, or it has been paused by the flow control for a noticeable part of
+   the last interval. Degraded nodes go last like blacklisted hosts, and their connections are not valid */
+class HostHealthRegistry final
+{
+  /* Weight of the newest sample in the latency average */
+  static constexpr double LATENCY_ALPHA= 0.2;
+  static constexpr unsigned int PROBE_TIMEOUT_SECONDS= 2;
+  static const std::chrono::hours MAX_BLACKLIST_AGE;
+  static const std::chrono::seconds GALERA_POLL_INTERVAL;
+  /* Nodes, that nobody has connected to for that long, are not polled any more */
+  static const std::chrono::hours MAX_GALERA_IDLE;
+  /* The default gcs.fc_limit - receive queue length, that triggers the flow control */
+  static constexpr int64_t GALERA_MAX_RECV_QUEUE= 16;
+  static constexpr double GALERA_MAX_PAUSED= 0.1;
+
+  struct Blacklisted
+  {
+    HostAddress host;
+    SQLString user;
+    SQLString password;
+    std::chrono::seconds backoff;
+    std::chrono::seconds maxBackoff;
+    std::chrono::steady_clock::time_point since;
+    std::chrono::steady_clock::time_point nextProbe;
+  };
+
+  struct GaleraNode
+  {
+    HostAddress host;
+    SQLString user;
+    SQLString password;
+    std::vector<SQLString> allowedStates;
+    /* Used by the prober thread only */
+    capi::MYSQL* connection;
+    uint64_t pausedNs;
+    std::chrono::steady_clock::time_point polled;
+    /* Values below are protected by the registry lock */
+    std::chrono::steady_clock::time_point lastUsed;
+    std::chrono::steady_clock::time_point nextPoll;
+    bool known;
+    bool degraded;
+
+    GaleraNode(const HostAddress& host, const SQLString& user, const SQLString& password,
+      const std::vector<SQLString>& allowedStates);
+    ~GaleraNode();
+  };
+
+  std::mutex lock;
+  /* Latency average in microseconds by "host:port" */
+  std::unordered_map<std::string, double> latencies;
+  std::unordered_map<std::string, Blacklisted> blacklist;
+  std::unordered_map<std::string, std::shared_ptr<GaleraNode>> galeraNodes;
+  /* Unix socket files of local servers. Empty path means the server has no usable socket */
+  std::unordered_map<std::string, SQLString> localSockets;
+  /* Temporary files with RSA public keys of the servers. Empty path means the server has given no key */
+  std::unordered_map<std::string, std::string> rsaPublicKeyFiles;
+  std::default_random_engine rnd;
+  std::condition_variable proberWakeup;
+  std::thread prober;
+  bool stopping= false;
+
+  HostHealthRegistry() {}
+  ~HostHealthRegistry();
+  static std::string key(const HostAddress& host);
+  /* Has to be called under the lock */
+  double score(const HostAddress& host);
+  bool isUnhealthy(const std::string& hostKey);
+  void partitionUnhealthy(std::vector<HostAddress>& hosts);
+  void startProber();
+  void probing();
+  static bool probe(const Blacklisted& entry);
+  /* Returns true if the node is degraded, sets known to false, if its state could not be read */
+  static bool pollGalera(GaleraNode& node, bool& known);
+
+public:
+  static HostHealthRegistry& getInstance();
+  /* Tells if the connection error means the host is not reachable, rather than it has refused the connection */
+  static bool isHostFailure(int32_t errorCode);
+
+  void updateLatency(const HostAddress& host, std::chrono::microseconds latency);
+  /* Orders hosts for connection attempts with power of two choices - of two candidates, picked randomly with regard
+     to hosts weights, the one with the lower latency per weight unit goes first. Hosts without latency observed yet
+     win the comparison, so they get measured. Blacklisted hosts and degraded Galera nodes go last */
+  void order(std::vector<HostAddress>& hosts);
+  /* Moves blacklisted hosts and degraded Galera nodes to the end, keeping the order otherwise */
+  void moveUnhealthyLast(std::vector<HostAddress>& hosts);
+  /* user and password are used for probing of the host. Nothing is done if blacklistTimeout is 0 */
+  void addToBlacklist(const HostAddress& host, const SQLString& user, const SQLString& password,
+    int32_t blacklistTimeout);
+  void removeFromBlacklist(const HostAddress& host);
+  bool isBlacklisted(const HostAddress& host);
+  /* Starts, or continues, polling of the Galera node state. user and password are used for the polling connection */
+  void watchGalera(const HostAddress& host, const SQLString& user, const SQLString& password,
+    const std::vector<SQLString>& allowedStates);
+  /* Sets degraded and returns true, if the node state is known from recent polling */
+  bool galeraDegraded(const HostAddress& host, bool& degraded);
+  /* Returns false, if the socket of the host has not been detected yet */
+  bool getLocalSocket(const HostAddress& host, SQLString& path);
+  void setLocalSocket(const HostAddress& host, const SQLString& path);
+  /* Returns false, if the RSA public key of the host has not been read yet */
+  bool getRsaPublicKeyFile(const HostAddress& host, SQLString& path);
+  /* Stores the key in PEM format to the temporary file, that lives until the registry is cleared or destroyed. Empty
+     key marks the host as not having one */
+  void setRsaPublicKey(const HostAddress& host, const std::string& pem);
+  void clear();
+};
+
+}
+}
+#endif
@@ -18,6 +18,8 @@
 *************************************************************************************/
 
 
+#include <sstream>
+
 #include "MariaDBException.h"
 
 namespace sql
@@ -33,7 +35,8 @@ namespace sql
     std::runtime_error(other),
     SqlState(other.SqlState),
     ErrorCode(other.ErrorCode),
-    Cause(other.Cause)
+    Cause(other.Cause),
+    Details(other.Details)
   {}
 
   SQLException::SQLException(const char* msg, const char* state, int32_t error, const std::exception* /*e*/) : std::runtime_error(msg),
@@ -50,6 +53,9 @@ namespace sql
 
   char const* SQLException::what() const noexcept
   {
+    if (Details) {
+      return Details->get(std::runtime_error::what());
+    }
     return std::runtime_error::what();
   }
 
@@ -76,6 +82,112 @@ namespace sql
     }
   }
 
+  /******************** ExceptionMessage ***************************/
+  namespace mariadb
+  {
+    ExceptionMessage::ExceptionMessage(const ExceptionMessage& other) :
+      threadId(other.threadId),
+      query(other.query),
+      maxQuerySize(other.maxQuerySize),
+      threadLabel(other.threadLabel),
+      thread(other.thread),
+      suffix(other.suffix)
+    {}
+
+
+    ExceptionMessage& ExceptionMessage::of(SQLException& exception)
+    {
+      if (!exception.Details) {
+        exception.Details.reset(new ExceptionMessage());
+      }
+      else if (exception.Details.use_count() > 1) {
+        // Shared with the exception, it's been copied from
+        exception.Details.reset(new ExceptionMessage(*exception.Details));
+      }
+      else {
+        // The parts are going to change, and the text, what() may have built already, with them
+        std::lock_guard<std::mutex> localScopeLock(exception.Details->lock);
+        exception.Details->built= false;
+      }
+      return *exception.Details;
+    }
+
+
+    void ExceptionMessage::copy(const SQLException& from, SQLException& to)
+    {
+      to.Details= from.Details;
+    }
+
+
+    void ExceptionMessage::setThreadId(SQLException& exception, int64_t threadId)
+    {
+      if (threadId != -1) {
+        of(exception).threadId= threadId;
+      }
+    }
+
+
+    void ExceptionMessage::setQuery(SQLException& exception, const SQLString& query, int32_t maxQuerySize,
+      const char* threadLabel)
+    {
+      ExceptionMessage& details= of(exception);
+      details.query= query;
+      details.maxQuerySize= maxQuerySize;
+      details.threadLabel= threadLabel;
+      if (threadLabel != nullptr) {
+        details.thread= std::this_thread::get_id();
+      }
+    }
+
+
+    void ExceptionMessage::append(SQLException& exception, const SQLString& text)
+    {
+      of(exception).suffix.append(text);
+    }
+
+
+    void ExceptionMessage::build(const char* rawMessage)
+    {
+      std::ostringstream msg;
+
+      if (threadId != -1) {
+        msg << "(conn=" << threadId << ") ";
+      }
+      msg << rawMessage;
+      if (threadLabel != nullptr || !query.empty()) {
+        msg << "\nQuery is: ";
+        if (maxQuerySize > 3 && query.size() > static_cast<std::size_t>(maxQuerySize - 3)) {
+          msg.write(query.c_str(), maxQuerySize - 3);
+          msg << "...";
+        }
+        else {
+          msg << query.c_str();
+        }
+      }
+      if (threadLabel != nullptr) {
+        msg << threadLabel << thread;
+      }
+      msg << suffix.c_str();
+      text= msg.str();
+    }
+
+
+    const char* ExceptionMessage::get(const char* rawMessage)
+    {
+      try {
+        std::lock_guard<std::mutex> localScopeLock(lock);
+        if (!built) {
+          build(rawMessage);
+          built= true;
+        }
+        return text.c_str();
+      }
+      catch (...) {
+        return rawMessage;
+      }
+    }
+  }
+
   /******************** SQLFeatureNotImplementedException ***************************/
   SQLFeatureNotImplementedException::~SQLFeatureNotImplementedException()
   {}
@@ -22,6 +22,10 @@
 #ifndef _MARIADB_EXCEPTION_H_
 #define _MARIADB_EXCEPTION_H_
 
+#include <mutex>
+#include <string>
+#include <thread>
+
 #include "Exception.hpp"
 
 namespace sql
@@ -79,5 +83,45 @@ public:
   operator bool() { return (exceptionThrower.get() != nullptr); }
 };
 
+
+namespace mariadb
+{
+/* Parts the driver adds to the exception's message - the connection id prefix, the query and the thread, and other
+   details. The text of what() is put together from them only on the first request, so exceptions, that application
+   catches and handles, like duplicate key errors, do not pay for the formatting. Parts are shared between copies of
+   the exception, and are copied on write. Changing a part drops the text, and the next request builds it again */
+class ExceptionMessage final
+{
+  int64_t threadId= -1;
+  SQLString query;
+  int32_t maxQuerySize= 0;
+  /* nullptr, if the thread is not to be shown */
+  const char* threadLabel= nullptr;
+  std::thread::id thread;
+  SQLString suffix;
+  std::mutex lock;
+  bool built= false;
+  std::string text;
+
+  ExceptionMessage() {}
+  ExceptionMessage(const ExceptionMessage& other);
+  void operator=(const ExceptionMessage&)= delete;
+
+  static ExceptionMessage& of(SQLException& exception);
+  void build(const char* rawMessage);
+
+public:
+  /* The message without the driver's additions */
+  static const char* getRawMessage(const SQLException& exception) { return exception.std::runtime_error::what(); }
+  /* Makes the exception to have the same additions as the other one */
+  static void copy(const SQLException& from, SQLException& to);
+  static void setThreadId(SQLException& exception, int64_t threadId);
+  /* The query is truncated to maxQuerySize, when the message is built. threadLabel is the text shown before the
+     current thread's id, or nullptr to omit the thread */
+  static void setQuery(SQLException& exception, const SQLString& query, int32_t maxQuerySize, const char* threadLabel);
+  static void append(SQLException& exception, const SQLString& text);
+  const char* get(const char* rawMessage);
+};
+}
 }
 #endif // _MARIADB_EXCEPTION_H_
@@ -0,0 +1,86 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#include "MariaDbAsyncExecution.h"
+
+#include "MariaDbStatement.h"
+#include "Protocol.h"
+
+namespace sql
+{
+namespace mariadb
+{
+  MariaDbAsyncExecution::MariaDbAsyncExecution(MariaDbStatement* _stmt, Shared::Protocol& _protocol, int32_t _waitStatus)
+    : stmt(_stmt)
+    , protocol(_protocol)
+    , waitStatus(_waitStatus)
+    , hasResultSet(false)
+  {
+    if (waitStatus == 0) {
+      hasResultSet= stmt->executeAsyncEnd();
+    }
+  }
+
+
+  int64_t MariaDbAsyncExecution::getSocket()
+  {
+    return protocol->getNativeSocket();
+  }
+
+
+  int32_t MariaDbAsyncExecution::getWaitStatus()
+  {
+    return waitStatus;
+  }
+
+
+  uint32_t MariaDbAsyncExecution::getTimeout()
+  {
+    return protocol->getAsyncTimeout();
+  }
+
+
+  int32_t MariaDbAsyncExecution::resume(int32_t readyEvents)
+  {
+    if (waitStatus != 0) {
+      waitStatus= stmt->executeAsyncContinue(readyEvents);
+      if (waitStatus == 0) {
+        hasResultSet= stmt->executeAsyncEnd();
+      }
+    }
+    return waitStatus;
+  }
+
+
+  bool MariaDbAsyncExecution::isDone()
+  {
+    return waitStatus == 0;
+  }
+
+
+  bool MariaDbAsyncExecution::getResult()
+  {
+    if (waitStatus != 0) {
+      throw SQLException("Asynchronous execution is not complete yet", "HY000");
+    }
+    return hasResultSet;
+  }
+}
+}
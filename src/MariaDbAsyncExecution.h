@@ -0,0 +1,54 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _MARIADBASYNCEXECUTION_H_
+#define _MARIADBASYNCEXECUTION_H_
+
+#include "AsyncExecution.hpp"
+#include "Consts.h"
+
+namespace sql
+{
+namespace mariadb
+{
+class MariaDbStatement;
+
+/* Non-blocking execution of a text protocol query started by MariaDbStatement::executeAsync */
+class MariaDbAsyncExecution final : public sql::AsyncExecution
+{
+  MariaDbStatement* stmt;
+  Shared::Protocol protocol;
+  int32_t waitStatus;
+  bool hasResultSet;
+
+public:
+  MariaDbAsyncExecution(MariaDbStatement* stmt, Shared::Protocol& protocol, int32_t waitStatus);
+
+  int64_t getSocket() override;
+  int32_t getWaitStatus() override;
+  uint32_t getTimeout() override;
+  int32_t resume(int32_t readyEvents) override;
+  bool isDone() override;
+  bool getResult() override;
+};
+
+}
+}
+#endif
@@ -0,0 +1,266 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+
+#include "MariaDbAsyncInsertQueue.h"
+#include "ParameterMetaData.hpp"
+#include "Statement.hpp"
+#include "Types.hpp"
+#include "Exception.hpp"
+
+namespace sql
+{
+namespace mariadb
+{
+  MariaDbAsyncInsertQueue::MariaDbAsyncInsertQueue(Connection* _connection, const SQLString& sql, uint32_t maxDelayMs,
+    std::size_t _maxRows)
+    : connection(_connection)
+    , maxDelay(maxDelayMs)
+    , maxRows(_maxRows)
+  {
+    ps.reset(connection->prepareStatement(sql));
+    parameterCount= static_cast<std::size_t>(ps->getParameterMetaData()->getParameterCount());
+    queue.reserve(maxRows);
+    worker= std::thread(&MariaDbAsyncInsertQueue::run, this);
+  }
+
+
+  MariaDbAsyncInsertQueue::~MariaDbAsyncInsertQueue()
+  {
+    try {
+      close();
+    }
+    catch (SQLException&) {
+    }
+  }
+
+
+  std::future<int64_t> MariaDbAsyncInsertQueue::insertValues(const ParameterValue* values, std::size_t count)
+  {
+    if (count != parameterCount) {
+      throw SQLException(("Insert queue's statement has " + std::to_string(parameterCount) + " parameters, but "
+        + std::to_string(count) + " values are given").c_str(), "07001");
+    }
+    Row row;
+
+    row.values.reserve(count);
+    for (std::size_t i= 0; i < count; ++i) {
+      row.values.push_back(copyValue(values[i]));
+    }
+    std::future<int64_t> result(row.done.get_future());
+
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    if (closed) {
+      throw SQLException("Insert queue is closed", "08003");
+    }
+    if (queue.empty()) {
+      oldest= std::chrono::steady_clock::now();
+    }
+    queue.push_back(std::move(row));
+    // The thread starts waiting for the delay with the first row, and stops waiting, when the batch is full
+    if (queue.size() == 1 || queue.size() == maxRows) {
+      queued.notify_one();
+    }
+    return result;
+  }
+
+
+  void MariaDbAsyncInsertQueue::flush()
+  {
+    std::unique_lock<std::mutex> localScopeLock(lock);
+
+    if (closed) {
+      return;
+    }
+    uint64_t request= ++flushRequests;
+    queued.notify_one();
+    executed.wait(localScopeLock, [this, request]() { return flushesServed >= request; });
+  }
+
+
+  std::size_t MariaDbAsyncInsertQueue::getPendingRows()
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    return queue.size() + executing;
+  }
+
+
+  void MariaDbAsyncInsertQueue::close()
+  {
+    {
+      std::lock_guard<std::mutex> localScopeLock(lock);
+      if (closed) {
+        return;
+      }
+      closed= true;
+      queued.notify_one();
+    }
+    // The thread executes the rows, that are still queued, before it ends
+    if (worker.joinable()) {
+      worker.join();
+    }
+    ps->close();
+    connection->close();
+  }
+
+
+  void MariaDbAsyncInsertQueue::run()
+  {
+    std::unique_lock<std::mutex> localScopeLock(lock);
+    std::vector<Row> rows;
+
+    rows.reserve(maxRows);
+    while (!queue.empty() || !closed) {
+      if (queue.empty()) {
+        queued.wait(localScopeLock);
+        continue;
+      }
+      // Nobody waits for the batch, that is not full yet
+      if (queue.size() < maxRows && flushesServed == flushRequests && !closed) {
+        std::chrono::steady_clock::time_point deadline= oldest + maxDelay;
+        if (std::chrono::steady_clock::now() < deadline) {
+          queued.wait_until(localScopeLock, deadline);
+          continue;
+        }
+      }
+      std::size_t count= std::min(queue.size(), maxRows);
+      uint64_t served= flushRequests;
+
+      std::move(queue.begin(), queue.begin() + count, std::back_inserter(rows));
+      queue.erase(queue.begin(), queue.begin() + count);
+      // Rows beyond the full batch have been queued a moment ago
+      oldest= std::chrono::steady_clock::now();
+      executing= count;
+
+      localScopeLock.unlock();
+      execute(rows);
+      rows.clear();
+      localScopeLock.lock();
+
+      executing= 0;
+      // Flushes requested before the queue was taken are served, when the queue has been emptied
+      if (queue.empty() || closed) {
+        flushesServed= served;
+        executed.notify_all();
+      }
+    }
+    flushesServed= flushRequests;
+    executed.notify_all();
+  }
+
+
+  void MariaDbAsyncInsertQueue::execute(std::vector<Row>& rows)
+  {
+    std::exception_ptr error;
+
+    try {
+      for (auto& row : rows) {
+        for (std::size_t i= 0; i < row.values.size(); ++i) {
+          bindValue(*ps, static_cast<int32_t>(i + 1), row.values[i]);
+        }
+        ps->addBatch();
+      }
+      const sql::Longs& counts= ps->executeLargeBatch();
+      for (std::size_t i= 0; i < rows.size(); ++i) {
+        rows[i].done.set_value(i < counts.size() ? counts.arr[i] : static_cast<int64_t>(Statement::SUCCESS_NO_INFO));
+      }
+      return;
+    }
+    catch (...) {
+      error= std::current_exception();
+    }
+    try {
+      ps->clearBatch();
+    }
+    catch (SQLException&) {
+    }
+    for (auto& row : rows) {
+      row.done.set_exception(error);
+    }
+  }
+
+
+  MariaDbAsyncInsertQueue::Value MariaDbAsyncInsertQueue::copyValue(const ParameterValue& value)
+  {
+    Value copy;
+
+    copy.kind= value.kind;
+    copy.length= value.length;
+    switch (value.kind) {
+    case ParameterValue::INTEGER:
+      switch (value.length) {
+      case 1: copy.integer= *static_cast<const int8_t*>(value.value); break;
+      case 2: copy.integer= *static_cast<const int16_t*>(value.value); break;
+      case 4: copy.integer= *static_cast<const int32_t*>(value.value); break;
+      default: copy.integer= *static_cast<const int64_t*>(value.value);
+      }
+      break;
+    case ParameterValue::UNSIGNED:
+      switch (value.length) {
+      case 1: copy.unsignedInteger= *static_cast<const uint8_t*>(value.value); break;
+      case 2: copy.unsignedInteger= *static_cast<const uint16_t*>(value.value); break;
+      case 4: copy.unsignedInteger= *static_cast<const uint32_t*>(value.value); break;
+      default: copy.unsignedInteger= *static_cast<const uint64_t*>(value.value);
+      }
+      break;
+    case ParameterValue::REAL:
+      copy.real= value.length == sizeof(float) ? *static_cast<const float*>(value.value) :
+        *static_cast<const double*>(value.value);
+      break;
+    case ParameterValue::STRING:
+      copy.str= SQLString(static_cast<const char*>(value.value), value.length);
+      break;
+    default:
+      break;
+    }
+    return copy;
+  }
+
+
+  void MariaDbAsyncInsertQueue::bindValue(PreparedStatement& ps, int32_t index, const Value& value)
+  {
+    switch (value.kind) {
+    case ParameterValue::INTEGER:
+      ps.setLong(index, value.integer);
+      break;
+    case ParameterValue::UNSIGNED:
+      ps.setUInt64(index, value.unsignedInteger);
+      break;
+    case ParameterValue::REAL:
+      if (value.length == sizeof(float)) {
+        ps.setFloat(index, static_cast<float>(value.real));
+      }
+      else {
+        ps.setDouble(index, value.real);
+      }
+      break;
+    case ParameterValue::STRING:
+      ps.setString(index, value.str);
+      break;
+    default:
+      ps.setNull(index, Types::VARCHAR);
+    }
+  }
+}
+}
@@ -0,0 +1,95 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+
+#ifndef _MARIADBASYNCINSERTQUEUE_H_
+#define _MARIADBASYNCINSERTQUEUE_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "AsyncInsertQueue.hpp"
+#include "Connection.hpp"
+#include "PreparedStatement.hpp"
+
+namespace sql
+{
+namespace mariadb
+{
+
+/* The thread takes all queued rows off the queue at once, and executes them with the lock released, so other threads
+   keep queueing rows for the next batch meanwhile */
+class MariaDbAsyncInsertQueue final : public sql::AsyncInsertQueue
+{
+  /* Copy of the ParameterValue, owning the string */
+  struct Value {
+    ParameterValue::Kind kind;
+    std::size_t length;
+    int64_t integer;
+    uint64_t unsignedInteger;
+    double real;
+    SQLString str;
+  };
+  struct Row {
+    std::vector<Value> values;
+    std::promise<int64_t> done;
+  };
+
+  std::mutex lock;
+  std::condition_variable queued;
+  std::condition_variable executed;
+  std::unique_ptr<Connection> connection;
+  std::unique_ptr<PreparedStatement> ps;
+  const std::chrono::milliseconds maxDelay;
+  const std::size_t maxRows;
+  std::size_t parameterCount;
+  std::vector<Row> queue;
+  /* Time the oldest queued row has been queued at */
+  std::chrono::steady_clock::time_point oldest;
+  std::size_t executing= 0;
+  /* Incremented by flush, and set to the number of flushes served by the thread, when it takes the queue */
+  uint64_t flushRequests= 0;
+  uint64_t flushesServed= 0;
+  bool closed= false;
+  std::thread worker;
+
+  void run();
+  void execute(std::vector<Row>& rows);
+  static Value copyValue(const ParameterValue& value);
+  static void bindValue(PreparedStatement& ps, int32_t index, const Value& value);
+
+public:
+  MariaDbAsyncInsertQueue(Connection* connection, const SQLString& sql, uint32_t maxDelayMs, std::size_t maxRows);
+  ~MariaDbAsyncInsertQueue();
+
+  std::future<int64_t> insertValues(const ParameterValue* values, std::size_t count) override;
+  void flush() override;
+  std::size_t getPendingRows() override;
+  void close() override;
+};
+
+}
+}
+#endif
@@ -24,16 +24,28 @@
 #include "MariaDbSavepoint.h"
 #include "ServerSidePreparedStatement.h"
 #include "ClientSidePreparedStatement.h"
-#include "MariaDbProcedureStatement.h"
-#include "MariaDbFunctionStatement.h"
-#include "MariaDbDatabaseMetaData.h"
-#include "CallableParameterMetaData.h"
+#ifndef MARIADB_NO_CALLABLE_STATEMENTS
+# include "MariaDbProcedureStatement.h"
+# include "MariaDbFunctionStatement.h"
+# include "CallableParameterMetaData.h"
+#endif
+#ifndef MARIADB_NO_DATABASE_METADATA
+# include "MariaDbDatabaseMetaData.h"
+#endif
 
 #include "logger/LoggerFactory.h"
 #include "pool/Pools.h"
 #include "util/Utils.h"
+#include "util/NativeSqlCache.h"
+#include "util/MemoryAccounting.h"
 #include "jdbccompat.hpp"
 #include "ExceptionFactory.h"
+#include "MariaDbPipeline.h"
+#include "MariaDbSequenceAllocator.h"
+#include "util/MetricsRecorder.h"
+#include "util/MetadataCache.h"
+#include "util/PrepareWarmup.h"
+#include "util/ServerPrepareStatementCache.h"
 
 namespace sql
 {
@@ -56,10 +68,13 @@ namespace mariadb
     _canUseServerTimeout(protocol->versionGreaterOrEqual(10, 1, 2)),
     sessionStateAware(protocol->sessionStateAware())
   {
+#ifndef MARIADB_NO_CALLABLE_STATEMENTS
     if (options->cacheCallableStmts)
     {
       callableStatementCache.reset(CallableStatementCache::newInstance(options->callableStmtCacheSize));
     }
+#endif
+    PrepareWarmup::warmUp(protocol.get());
   }
 
   /**
@@ -67,14 +82,18 @@ namespace mariadb
     *
     * @param urlParser parser
     * @param globalInfo global info
+    * @param connectKey key of connect parameters, that were parsed by urlParser, to find the pool without parsing next
+    *        time
     * @return connection object
     * @throws SQLException if any connection error occur
     */
-  MariaDbConnection* MariaDbConnection::newConnection(UrlParser &urlParser, GlobalStateInfo *globalInfo)
+  Connection* MariaDbConnection::newConnection(UrlParser &urlParser, GlobalStateInfo *globalInfo, const std::string& connectKey)
   {
     if (urlParser.getOptions()->pool)
     {
-      //return Pools::retrievePool(urlParser)->getConnection();
+      PoolRequest request(urlParser);
+      std::shared_ptr<UrlParser> poolUrlParser(&urlParser);
+      return Pools::retrievePool(poolUrlParser, connectKey)->getConnection(request);
     }
     Shared::Protocol protocol(Utils::retrieveProxy(urlParser, globalInfo));
 
@@ -117,6 +136,63 @@ namespace mariadb
     return new MariaDbStatement(this, ResultSet::TYPE_FORWARD_ONLY, ResultSet::CONCUR_READ_ONLY, exceptionFactory);
   }
 
+  /**
+    * Creates a pipeline - queue of queries, that are sent to the server together, and then their results are read.
+    *
+    * @return a new pipeline object
+    */
+  Pipeline* MariaDbConnection::createPipeline()
+  {
+    checkConnection();
+    return new MariaDbPipeline(this, exceptionFactory);
+  }
+
+  /**
+    * Creates an allocator, that claims values of the sequence in blocks of its INCREMENT, and hands them out locally.
+    *
+    * @param sequence name of the sequence, that may be qualified with the schema name. It is put in the query as is
+    * @param blockSize number of values one NEXT VALUE claims, that has to be the sequence's INCREMENT. 0 means to take
+    *        it from the sequence
+    * @return a new allocator
+    * @throws SQLException if the sequence cannot be read, or its INCREMENT is not the block size
+    */
+  SequenceAllocator* MariaDbConnection::getSequenceAllocator(const SQLString& sequence, int64_t blockSize)
+  {
+    checkConnection();
+    return new MariaDbSequenceAllocator(this, sequence, blockSize, options->threadSafeConnection);
+  }
+
+  /**
+    * Loads rows, that the producer generates, into the table using LOAD DATA LOCAL INFILE. Rows are serialized
+    * directly into the stream of packets, no file is created. Requires allowLocalInfile option and server's
+    * local_infile to be enabled.
+    *
+    * @param table name of the table, that may be qualified with the schema name. It is put in the query as is
+    * @param columns names of columns, that producer writes values for. If nullptr, values for all columns are expected
+    * @param columnCount number of names in columns
+    * @param producer source of rows
+    * @return number of loaded rows
+    * @throws SQLException if connection is closed or load failed. Rows, that had been sent before the error, remain
+    *         loaded, unless the load has been done inside a transaction, that is rolled back
+    */
+  int64_t MariaDbConnection::bulkLoad(const SQLString& table, const SQLString* columns, std::size_t columnCount,
+    RowProducer& producer)
+  {
+    checkConnection();
+    return protocol->executeBulkLoad(table, columns, columnCount, producer);
+  }
+
+
+  ConnectionMetrics MariaDbConnection::getMetrics()
+  {
+    ConnectionMetrics result;
+    protocol->getMetrics().snapshot(result);
+    result.memoryFootprint= sizeof(*this) + protocol->getMemoryFootprint();
+    result.resultSetMemory= protocol->getMemoryAccount()->getUsed();
+    result.batchWindow= protocol->getBatchWindow();
+    return result;
+  }
+
   /**
     * Creates a <code>Statement</code> object that will generate <code>ResultSet</code> objects with
     * the given type and concurrency. This method is the same as the <code>createStatement</code>
@@ -161,9 +237,10 @@ namespace mariadb
     if (protocol->isExplicitClosed()) {
       exceptionFactory->create("createStatement() is called on closed connection", "08000").Throw();
     }
+#ifndef MARIADB_NO_FAILOVER
     if (protocol->isClosed() && protocol->getProxy())
     {
-      std::lock_guard<std::mutex> localScopeLock(*lock);
+      std::lock_guard<ConnectionMutex> localScopeLock(*lock);
       try
       {
         protocol->getProxy()->reconnect();
@@ -172,6 +249,7 @@ namespace mariadb
       {
       }
     }
+#endif
   }
 
   /**
@@ -192,6 +270,20 @@ namespace mariadb
       exceptionFactory);
   }
 
+  MariaDbConnection* MariaDbConnection::cloneTarget(MariaDbConnection* own, Connection* target)
+  {
+    if (target == nullptr && own == nullptr) {
+      throw SQLException("Cannot clone closed statement", "HY000");
+    }
+    MariaDbConnection* result= target != nullptr ? dynamic_cast<MariaDbConnection*>(target) : own;
+
+    if (result == nullptr) {
+      throw SQLException("Statement can be cloned only for the connection of the same driver", "HY000");
+    }
+    result->checkConnection();
+    return result;
+  }
+
 /**
   * Create a new server prepared statement.
   *
@@ -435,7 +527,8 @@ namespace mariadb
   {
     if (!sql.empty())
     {
-      SQLString sqlQuery= Utils::nativeSql(sql, protocol.get());
+      SQLString nativeSql;
+      const SQLString& sqlQuery= Utils::hasEscapes(sql) ? (nativeSql= nativeSQL(sql)) : sql;
 
       if (options->useServerPrepStmts && shouldPrepareOnServer(sql))
       {
@@ -502,6 +595,9 @@ namespace mariadb
   CallableStatement* MariaDbConnection::prepareCall(const SQLString& sql, int32_t resultSetType, int32_t resultSetConcurrency)
   {
     checkConnection();
+#ifdef MARIADB_NO_CALLABLE_STATEMENTS
+    throw SQLFeatureNotImplementedException("Callable statements are not compiled in this build of the connector");
+#else
 
     const SQLString *query= &sql;
     SQLString native("");
@@ -526,7 +622,7 @@ namespace mariadb
         
       }
       if (!wrongFormat) {
-        native= Utils::nativeSql(sql, protocol.get());
+        native= nativeSQL(sql);
         query= &native;
         firstUsefulChar= Utils::skipCommentsAndBlanks(StringImp::get(native));
       }
@@ -562,7 +658,7 @@ namespace mariadb
     charOfInterest= databaseAndProcedure.find_first_of('.');
     if (charOfInterest != std::string::npos) {
       database= databaseAndProcedure.substr(0, charOfInterest);
-      procedureName= databaseAndProcedure.substr(charOfInterest);
+      procedureName= databaseAndProcedure.substr(charOfInterest + 1);
     }
     else {
       procedureName= databaseAndProcedure;
@@ -618,6 +714,7 @@ namespace mariadb
       resultSetType,
       resultSetConcurrency,
       exceptionFactory);
+#endif
   }
   /**
     * Creates a <code>CallableStatement</code> object that will generate <code>ResultSet</code>
@@ -652,34 +749,42 @@ namespace mariadb
   }
 
 
+#ifndef MARIADB_NO_CALLABLE_STATEMENTS
   CallableStatement* MariaDbConnection::createNewCallableStatement(
     SQLString query, SQLString& procedureName,
-    bool /*isFunction*/, SQLString& /*databaseAndProcedure*/, SQLString& database, SQLString& /*arguments*/,
+    bool isFunction, SQLString& databaseAndProcedure, SQLString& database, SQLString& arguments,
     int32_t resultSetType,
     int32_t resultSetConcurrency,
     Shared::ExceptionFactory& expFactory)
   {
-    /*if (isFunction)
+    // Function can't be called, its value is selected. OUT parameters of the procedure come in the result, that the
+    // server sends in the response to the execution of the prepared CALL. Both make one round trip
+    if (isFunction)
     {
       return new MariaDbFunctionStatement(
         this,
         database,
         databaseAndProcedure,
-        (arguments.empty()) ? "()" : arguments,
+        "(" + arguments + ")",
         resultSetType,
-        resultSetConcurrency);
+        resultSetConcurrency,
+        expFactory);
     }
-    else*/
+    else
     {
       return new MariaDbProcedureStatement(
         query, this, procedureName, database, resultSetType, resultSetConcurrency, expFactory);
     }
   }
+#endif
 
 
   SQLString MariaDbConnection::nativeSQL(const SQLString& sql)
   {
-    return Utils::nativeSql(sql, protocol.get());
+    if (!Utils::hasEscapes(sql)) {
+      return sql;
+    }
+    return NativeSqlCache::getInstance().get(sql, protocol.get(), static_cast<std::size_t>(options->parsedQueryCacheSize));
   }
 
   /**
@@ -705,13 +810,10 @@ namespace mariadb
     {
       return;
     }
-    Unique::Statement stmt(createStatement());
-
-    if (stmt)
-    {
-      stateFlag|= ConnectionState::STATE_AUTOCOMMIT;
-      stmt->executeUpdate(SQLString("set autocommit=").append((autoCommit) ? '1' : '0'));
-    }
+    checkConnection();
+    stateFlag|= ConnectionState::STATE_AUTOCOMMIT;
+    // Sent to the server with the next statement
+    protocol->setAutocommit(autoCommit);
   }
 
   /**
@@ -726,6 +828,10 @@ namespace mariadb
 
     if (protocol->inTransaction())
     {
+      if (options->pipelineTransactionEnd) {
+        protocol->deferTransactionEnd(true);
+        return;
+      }
       Unique::Statement st(this->createStatement());
       if (st)
       {
@@ -743,6 +849,10 @@ namespace mariadb
   {
     if (protocol->inTransaction())
     {
+      if (options->pipelineTransactionEnd) {
+        protocol->deferTransactionEnd(false);
+        return;
+      }
       // It doesn't look that stmt creation needs lock. and execute will lock.
       Unique::Statement st(this->createStatement());
       if (st)
@@ -767,7 +877,10 @@ namespace mariadb
     */
   void MariaDbConnection::rollback(const Savepoint* savepoint)
   {
-    std::unique_lock<std::mutex> localScopeLock(*lock);
+    if (options->pipelineSavepoints && protocol->rollbackDeferredSavepoint(savepoint->toString())) {
+      return;
+    }
+    std::unique_lock<ConnectionMutex> localScopeLock(*lock);
     Unique::Statement st(createStatement());
     localScopeLock.unlock();
     st->execute("ROLLBACK TO SAVEPOINT " + savepoint->toString());
@@ -782,6 +895,8 @@ namespace mariadb
   {
     if (pooledConnection)
     {
+      // Deferred COMMIT has to get to the server before the connection is given back
+      protocol->flushTransactionEnd();
       rollback();
       pooledConnection->fireConnectionClosed();
       return;
@@ -806,7 +921,11 @@ namespace mariadb
     */
   DatabaseMetaData* MariaDbConnection::getMetaData()
   {
+#ifdef MARIADB_NO_DATABASE_METADATA
+    throw SQLFeatureNotImplementedException("DatabaseMetaData is not compiled in this build of the connector");
+#else
     return new MariaDbDatabaseMetaData(this, protocol->getUrlParser());
+#endif
   }
   /**
     * Retrieves whether this <code>Connection</code> object is in read-only mode.
@@ -898,6 +1017,11 @@ namespace mariadb
     */
   int32_t MariaDbConnection::getTransactionIsolation()
   {
+    checkConnection();
+    if (protocol->transactionIsolationTracked()) {
+      std::lock_guard<ConnectionMutex> localScopeLock(*lock);
+      return protocol->getTransactionIsolationLevel();
+    }
     Unique::Statement stmt(createStatement());
 
     SQLString sql("SELECT @@tx_isolation");
@@ -912,7 +1036,7 @@ namespace mariadb
     }
     //executeQuery has its locking
     Unique::ResultSet rs(stmt->executeQuery(sql));
-    std::lock_guard<std::mutex> localScopeLock(*lock);
+    std::lock_guard<ConnectionMutex> localScopeLock(*lock);
 
     if (rs->next())
     {
@@ -988,23 +1112,36 @@ namespace mariadb
     */
   SQLWarning* MariaDbConnection::getWarnings()
   {
-    if (warningsCleared || isClosed() || !protocol->hasWarnings())
+    if (warningsCleared || isClosed())
     {
       return nullptr;
     }
+    if (!warningsCached)
+    {
+      if (!protocol->hasWarnings()) {
+        return nullptr;
+      }
+      SQLString query("SHOW WARNINGS");
+      if (options->maxWarnings > 0) {
+        query.append(" LIMIT ").append(std::to_string(options->maxWarnings));
+      }
+      Unique::Statement st(this->createStatement());
+      Unique::ResultSet rs(st->executeQuery(query));
+      // The execution above has reset the cache, it is filled for the last user's execution now
+      warningsCache.clear();
+      while (rs->next())
+      {
+        warningsCache.emplace_back(rs->getInt(2), rs->getString(3));
+      }
+      warningsCached= true;
+    }
 
     SQLWarning* last= nullptr;
     SQLWarning* first= nullptr;
 
-    Unique::Statement st(this->createStatement());
-    Unique::ResultSet rs(st->executeQuery("show warnings"));
-
-    while (rs->next())
+    for (const auto& cached : warningsCache)
     {
-      int32_t code= rs->getInt(2);
-      SQLString message= rs->getString(3);
-
-      SQLWarning* warning= new MariaDBWarning(message, "", code);
+      SQLWarning* warning= new MariaDBWarning(cached.second, "", cached.first);
 
       if (first == nullptr)
       {
@@ -1039,6 +1176,7 @@ namespace mariadb
   /** Reenable warnings, when next statement is executed. */
   void MariaDbConnection::reenableWarnings() {
     warningsCleared= false;
+    warningsCached= false;
   }
   /**
     * Retrieves the current holdability of <code>ResultSet</code> objects created using this <code>
@@ -1092,6 +1230,11 @@ namespace mariadb
   Savepoint* MariaDbConnection::setSavepoint(const SQLString& name)
   {
     Savepoint* savepoint= new MariaDbSavepoint(name, savepointCount++);
+
+    if (options->pipelineSavepoints) {
+      protocol->deferSavepoint(savepoint->toString(), false);
+      return savepoint;
+    }
     std::unique_ptr<Statement> st(createStatement());
 
     st->execute("SAVEPOINT "+savepoint->toString());
@@ -1111,6 +1254,10 @@ namespace mariadb
     */
   void MariaDbConnection::releaseSavepoint(const Savepoint* savepoint)
   {
+    if (options->pipelineSavepoints) {
+      protocol->deferSavepoint(savepoint->toString(), true);
+      return;
+    }
     std::unique_ptr<Statement> st(createStatement());
     st->execute("RELEASE SAVEPOINT " + savepoint->toString());
   }
@@ -1229,9 +1376,10 @@ namespace mariadb
   void MariaDbConnection::checkClientReconnect(const SQLString& name)
   {
     if (protocol->isClosed()) {
+#ifndef MARIADB_NO_FAILOVER
       if (protocol->getProxy() != nullptr) {
 
-        std::lock_guard<std::mutex> localScopeLock(*lock);
+        std::lock_guard<ConnectionMutex> localScopeLock(*lock);
         try
         {
           protocol->getProxy()->reconnect();
@@ -1243,7 +1391,9 @@ namespace mariadb
           throw SQLException("ClientInfoException: Connection closed");// SQLClientInfoException("Connection* closed", failures, sqle);
         }
       }
-      else {
+      else
+#endif
+      {
         protocol->reconnect();
       }
     }
@@ -1745,43 +1895,52 @@ namespace mariadb
     * Reset connection set has it was after creating a "fresh" new connection.
     * defaultTransactionIsolation must have been initialized.
     *
-    * <p>BUT : - session variable state are reset only if option useResetConnection is set and - if
-    * using the option "useServerPrepStmts", PREPARE statement are still prepared
+    * <p>If option useResetConnection is set, COM_RESET_CONNECTION resets session on the server. Otherwise only the
+    * tracked state, that has been changed(autocommit, transaction isolation, database, read-only), is restored -
+    * all in one query. If using the option "useServerPrepStmts", PREPARE statement are still prepared
     *
     * @throws SQLException if resetting operation failed
     */
   void MariaDbConnection::reset()
   {
+    // Neither the deferred COMMIT, nor ROLLBACK may be dropped with the session state
+    protocol->flushTransactionEnd();
     bool useComReset=
       options->useResetConnection
       && ((protocol->isServerMariaDb() && protocol->versionGreaterOrEqual(10, 2, 4))
         || (!protocol->isServerMariaDb() && protocol->versionGreaterOrEqual(5, 7, 3)));
+    std::vector<SQLString> hotQueries;
+
     if (useComReset) {
+      // Prepared statements don't survive the reset. The most recently used ones are prepared again after the state
+      // is restored, while the connection is being given back, rather than at the first execution after that
+      ServerPrepareStatementCache* cache= protocol->prepareStatementCache();
+      if (options->prepStmtCacheResetWarmup > 0 && cache != nullptr) {
+        hotQueries= cache->keys();
+      }
       protocol->reset();
     }
-    if (stateFlag !=0) {
+    // After COM_RESET_CONNECTION autocommit has to be checked regardless of the flag - it gets server's default
+    if (stateFlag != 0 || useComReset) {
       try {
         if ((stateFlag & ConnectionState::STATE_NETWORK_TIMEOUT) != 0) {
           setNetworkTimeout(nullptr, options->socketTimeout);
         }
-        if ((stateFlag & ConnectionState::STATE_AUTOCOMMIT) != 0) {
-          setAutoCommit(options->autocommit);
-        }
-        if ((stateFlag & ConnectionState::STATE_DATABASE) != 0) {
-          protocol->resetDatabase();
-        }
         if ((stateFlag & ConnectionState::STATE_READ_ONLY) != 0) {
-          setReadOnly(false);
-        }
-        if (!useComReset && (stateFlag & ConnectionState::STATE_TRANSACTION_ISOLATION) != 0) {
-          setTransactionIsolation(defaultTransactionIsolation);
+          protocol->setReadonly(false);
         }
+        protocol->resetSessionState(options->autocommit,
+          (!useComReset && (stateFlag & ConnectionState::STATE_TRANSACTION_ISOLATION) != 0) ? defaultTransactionIsolation : 0,
+          (stateFlag & ConnectionState::STATE_DATABASE) != 0);
         stateFlag= 0;
       }
       catch (SQLException&) {
         throw SQLException("Error resetting connection");
       }
     }
+    if (!hotQueries.empty()) {
+      protocol->prepareCachedQueries(hotQueries, static_cast<std::size_t>(options->prepStmtCacheResetWarmup));
+    }
     warningsCleared= true;
   }
 
@@ -1801,7 +1960,7 @@ namespace mariadb
     return options->includeThreadDumpInDeadlockExceptions;
   }
 
-  CallableParameterMetaData* MariaDbConnection::getInternalParameterMetaData(const SQLString& procedureName, const SQLString& databaseName, bool isFunction)
+  ResultSet* MariaDbConnection::queryRoutineParameters(const SQLString& procedureName, const SQLString& databaseName)
   {
     SQLString sql("SELECT * from INFORMATION_SCHEMA.PARAMETERS WHERE SPECIFIC_NAME=? AND SPECIFIC_SCHEMA=");
     sql.append(!databaseName.empty() ? "?" : "DATABASE()");
@@ -1813,7 +1972,41 @@ namespace mariadb
       preparedStatement->setString(2, databaseName);
     }
 
-    return new CallableParameterMetaData(preparedStatement->executeQuery(), isFunction);
+    return preparedStatement->executeQuery();
+  }
+
+
+  /* With metadataCacheTtl set, parameters of the routine are kept in the metadata cache shared by the connections to
+     the host, so new connections don't query them again for each routine they call */
+#ifndef MARIADB_NO_CALLABLE_STATEMENTS
+  CallableParameterMetaData* MariaDbConnection::getInternalParameterMetaData(const SQLString& procedureName, const SQLString& databaseName, bool isFunction)
+  {
+    if (options->metadataCacheTtl <= 0) {
+      return new CallableParameterMetaData(queryRoutineParameters(procedureName, databaseName), isFunction);
+    }
+    MetadataCache& cache= MetadataCache::getInstance();
+    std::string host(MetadataCache::hostKey(protocol->getHostAddress()));
+    std::string cacheKey("PARAMETERS");
+
+    // The user's privileges define, what they can see in INFORMATION_SCHEMA.PARAMETERS
+    cacheKey.push_back('\0');
+    cacheKey.append(StringImp::get(protocol->getUsername()));
+    cacheKey.push_back('\0');
+    cacheKey.append(StringImp::get(databaseName.empty() ? protocol->getDatabase() : databaseName));
+    cacheKey.push_back('\0');
+    cacheKey.append(StringImp::get(procedureName));
+
+    std::shared_ptr<const MetadataCache::Entry> entry(cache.get(host, cacheKey));
+    if (!entry) {
+      Unique::ResultSet rs(queryRoutineParameters(procedureName, databaseName));
+      std::shared_ptr<MetadataCache::Entry> fresh(new MetadataCache::Entry());
+      fresh->fill(rs.get());
+      fresh->expires= std::chrono::steady_clock::now() + std::chrono::milliseconds(options->metadataCacheTtl);
+      cache.put(host, cacheKey, fresh);
+      entry= fresh;
+    }
+    return new CallableParameterMetaData(entry->createResultSet(protocol.get()), isFunction);
   }
+#endif
 }
 }
@@ -57,7 +57,7 @@ namespace mariadb
     STATE_TRANSACTION_ISOLATION= 16
   };
 
-class MariaDbConnection  : public Connection
+class MariaDbConnection final : public Connection
 {
     static std::shared_ptr<sql::mariadb::Logger> logger ; /*LoggerFactory.getLogger(MariaDbConnection.class)*/
 
@@ -70,7 +70,7 @@ class MariaDbConnection  : public Connection
 
 public:
   Shared::mutex lock; /* TODO: Public? Really? */
-  std::unique_ptr<MariaDbPooledConnection> pooledConnection;
+  MariaDbPooledConnection* pooledConnection;
 //protected:
   bool nullCatalogMeansCurrent;
 private:
@@ -82,10 +82,14 @@ private:
   int32_t defaultTransactionIsolation= 0;
   int32_t savepointCount= 0;
   bool warningsCleared= true;
+  /* Warnings of the last execution, code and message, once they have been read from the server. Each getWarnings()
+     call makes its chain of them, without querying the server again */
+  std::vector<std::pair<int32_t, SQLString>> warningsCache;
+  bool warningsCached= false;
 
 public:
   MariaDbConnection(Shared::Protocol& protocol);
-  static MariaDbConnection* newConnection(UrlParser& urlParser, GlobalStateInfo* globalInfo);
+  static Connection* newConnection(UrlParser& urlParser, GlobalStateInfo* globalInfo, const std::string& connectKey= "");
   static SQLString quoteIdentifier(const SQLString& string);
   static SQLString unquoteIdentifier(SQLString& string);
   ~MariaDbConnection();
@@ -94,6 +98,10 @@ public:
 
 public:
   Statement* createStatement();
+  Pipeline* createPipeline();
+  int64_t bulkLoad(const SQLString& table, const SQLString* columns, std::size_t columnCount, RowProducer& producer);
+  ConnectionMetrics getMetrics();
+  SequenceAllocator* getSequenceAllocator(const SQLString& sequence, int64_t blockSize);
   Statement* createStatement(int32_t resultSetType,int32_t resultSetConcurrency);
   Statement* createStatement( int32_t resultSetType,int32_t resultSetConcurrency,int32_t resultSetHoldability);
 
@@ -103,6 +111,9 @@ private:
 public:
   ClientSidePreparedStatement* clientPrepareStatement(const SQLString& sql);
   ServerSidePreparedStatement* serverPrepareStatement(const SQLString& sql);
+  /* Connection, the clone of the statement goes to - the target, or the statement's own one for nullptr. The own one is
+     nullptr, if the statement has been closed */
+  static MariaDbConnection* cloneTarget(MariaDbConnection* own, Connection* target);
   PreparedStatement* prepareStatement(const SQLString& sql);
   PreparedStatement* prepareStatement(const SQLString& sql,int32_t resultSetType,int32_t resultSetConcurrency);
   PreparedStatement* prepareStatement(const SQLString& sql, int32_t resultSetType, int32_t resultSetConcurrency,
@@ -171,6 +182,7 @@ private:
   void checkClientReconnect(const SQLString& name);
   void checkClientValidProperty(const SQLString& name);
   SQLString buildClientQuery(const SQLString& name,const SQLString& value);
+  ResultSet* queryRoutineParameters(const SQLString& procedureName, const SQLString& databaseName);
 
 public:
   void setClientInfo(const SQLString& name,const SQLString& value);
@@ -208,6 +220,8 @@ public:
   CallableParameterMetaData* getInternalParameterMetaData(const SQLString& procedureName, const SQLString& databaseName, bool isFunction);
 };
 
+bool shouldPrepareOnServer(const SQLString& sql);
+
 }
 }
 #endif
@@ -30,6 +30,9 @@
 #include "SelectResultSet.h"
 #include "ColumnDefinition.h"
 #include "util/Utils.h"
+#include "util/MetadataCache.h"
+#include "util/ConstantResult.h"
+#include "util/DriverAllocator.h"
 
 
 #define IMPORTED_KEYS_COLUMN_COUNT 14
@@ -409,6 +412,14 @@ namespace sql
       throw SQLException("'table' parameter in getImportedKeys cannot be NULL");
     }
 
+    return cachedQuery("getImportedKeys " + escapeQuote(database) + "." + escapeQuote(table),
+      catalogCond("TABLE_SCHEMA", database) + " AND TABLE_NAME = " + escapeQuote(table),
+      [this, &database, &table]() { return fetchImportedKeys(database, table); });
+  }
+
+
+  ResultSet* MariaDbDatabaseMetaData::fetchImportedKeys(const SQLString& database, const SQLString& table)
+  {
     if (database.empty()) {
       return getImportedKeysUsingInformationSchema(database, table);
     }
@@ -519,6 +530,54 @@ namespace sql
   }
 
 
+  /* Returns the result from the metadata cache, if it's enabled and has the valid entry for the key, otherwise runs
+     the query and caches its result. tablesCond selects in INFORMATION_SCHEMA.TABLES the tables, that the result
+     describes, for the validation of the entry */
+  ResultSet* MariaDbDatabaseMetaData::cachedQuery(const SQLString& key, const SQLString& tablesCond,
+    const std::function<ResultSet*()>& query)
+  {
+    Shared::Options options= urlParser.getOptions();
+
+    if (options->metadataCacheTtl <= 0) {
+      return query();
+    }
+    Protocol* protocol= connection->getProtocol().get();
+    MetadataCache& cache= MetadataCache::getInstance();
+    std::string host(MetadataCache::hostKey(protocol->getHostAddress()));
+    std::string cacheKey(StringImp::get(key));
+    SQLString token;
+
+    // What the user can see depends on the privileges, and conditions on the empty schema depend on the current one
+    cacheKey.push_back('\0');
+    cacheKey.append(StringImp::get(protocol->getUsername()));
+    cacheKey.push_back('\0');
+    cacheKey.append(StringImp::get(protocol->getDatabase()));
+
+    if (options->metadataCacheValidation) {
+      Unique::Statement stmt(connection->createStatement());
+      Unique::ResultSet rs(stmt->executeQuery("SELECT COUNT(*), MAX(CREATE_TIME) FROM INFORMATION_SCHEMA.TABLES WHERE "
+        + tablesCond));
+      if (rs->next()) {
+        token.append(rs->getString(1)).append(',').append(rs->getString(2));
+      }
+    }
+    std::shared_ptr<const MetadataCache::Entry> entry(cache.get(host, cacheKey));
+    if (entry && entry->token.compare(token) == 0) {
+      return entry->createResultSet(protocol);
+    }
+
+    Unique::ResultSet rs(query());
+    std::shared_ptr<MetadataCache::Entry> fresh(
+      std::allocate_shared<MetadataCache::Entry>(DriverAllocator::Std<MetadataCache::Entry>()));
+    fresh->fill(rs.get());
+    fresh->token= token;
+    fresh->expires= std::chrono::steady_clock::now() + std::chrono::milliseconds(options->metadataCacheTtl);
+    cache.put(host, cacheKey, fresh);
+
+    return fresh->createResultSet(protocol);
+  }
+
+
   SQLString MariaDbDatabaseMetaData::escapeQuote(const SQLString& value){
     if (value.empty() == true){
       return "NULL";
@@ -623,7 +682,8 @@ ResultSet* MariaDbDatabaseMetaData::getPrimaryKeys(const SQLString& /*catalog*/,
     + " AND B.TABLE_NAME=A.TABLE_NAME AND A.COLUMN_NAME = B.COLUMN_NAME "
       " ORDER BY A.COLUMN_NAME");
 
-  return executeQuery(sql);
+  return cachedQuery(sql, schemaPatternCond("TABLE_SCHEMA", schema) + " AND " + patternCond("TABLE_NAME", table),
+    [this, &sql]() { return executeQuery(sql); });
 }
 
 /**
@@ -693,7 +753,8 @@ ResultSet* MariaDbDatabaseMetaData::getTables(const SQLString& /*catalog*/, cons
   }
   sql.append(" ORDER BY TABLE_TYPE, TABLE_SCHEMA, TABLE_NAME");
 
-  return executeQuery(sql);
+  return cachedQuery(sql, schemaPatternCond("TABLE_SCHEMA", schemaPattern) + " AND " + patternCond("TABLE_NAME", tableNamePattern),
+    [this, &sql]() { return executeQuery(sql); });
 }
 
 /**
@@ -838,7 +899,8 @@ ResultSet* MariaDbDatabaseMetaData::getTables(const SQLString& /*catalog*/, cons
       +" ORDER BY TABLE_CAT, TABLE_SCHEM, TABLE_NAME, ORDINAL_POSITION";
 
     try {
-      return executeQuery(sql);
+      return cachedQuery(sql, catalogCond("TABLE_SCHEMA", schemaPattern) + " AND " + patternCond("TABLE_NAME", tableNamePattern),
+        [this, &sql]() { return executeQuery(sql); });
     }catch (SQLException& sqlException){
       if ((StringImp::get(sqlException.getMessage()).find("Unknown column 'DATETIME_PRECISION'") != std::string::npos)){
         datePrecisionColumnExist= false;
@@ -2316,12 +2378,14 @@ ResultSet* MariaDbDatabaseMetaData::getTables(const SQLString& /*catalog*/, cons
 
 
   ResultSet* MariaDbDatabaseMetaData::getCatalogs() {
-    return executeQuery("SELECT '' TABLE_CAT FROM DUAL WHERE 1=0");
+    static const ConstantResult catalogs({ "TABLE_CAT" }, { ColumnType::VARCHAR }, {});
+    return catalogs.createResultSet(connection->getProtocol().get());
   }
 
   ResultSet* MariaDbDatabaseMetaData::getTableTypes() {
-    return executeQuery(
-        "SELECT 'TABLE' TABLE_TYPE UNION SELECT 'SYSTEM VIEW' TABLE_TYPE UNION SELECT 'VIEW' TABLE_TYPE");
+    static const ConstantResult tableTypes({ "TABLE_TYPE" }, { ColumnType::VARCHAR },
+      { { {"TABLE", 5} }, { {"SYSTEM VIEW", 11} }, { {"VIEW", 4} } });
+    return tableTypes.createResultSet(connection->getProtocol().get());
   }
 
   /**
@@ -2660,7 +2724,7 @@ ResultSet* MariaDbDatabaseMetaData::getTables(const SQLString& /*catalog*/, cons
     */
   ResultSet* MariaDbDatabaseMetaData::getTypeInfo()
   {
-    static std::vector<SQLString> columnNames{
+    static const std::vector<SQLString> columnNames{
       "TYPE_NAME",
       "DATA_TYPE",
       "PRECISION",
@@ -2680,7 +2744,7 @@ ResultSet* MariaDbDatabaseMetaData::getTables(const SQLString& /*catalog*/, cons
       "SQL_DATETIME_SUB",
       "NUM_PREC_RADIX"      /*18*/
     };
-    std::vector<ColumnType> columnTypes{
+    static const std::vector<ColumnType> columnTypes{
       ColumnType::VARCHAR,
       ColumnType::INTEGER,
       ColumnType::INTEGER,
@@ -2701,7 +2765,7 @@ ResultSet* MariaDbDatabaseMetaData::getTables(const SQLString& /*catalog*/, cons
       ColumnType::INTEGER
     };
 
-    static std::vector<std::vector<sql::bytes>> data{
+    static const ConstantResult typeInfo(columnNames, columnTypes, {
     {
       BYTES_INIT("BIT"),
       BYTES_INIT("-7"),
@@ -3372,9 +3436,9 @@ ResultSet* MariaDbDatabaseMetaData::getTables(const SQLString& /*catalog*/, cons
       BYTES_INIT("0"),
       BYTES_INIT("10")
       }
-    };
+    });
 
-    return SelectResultSet::createResultSet(columnNames, columnTypes, data, connection->getProtocol().get());
+    return typeInfo.createResultSet(connection->getProtocol().get());
   }
 
   /**
@@ -3447,7 +3511,8 @@ ResultSet* MariaDbDatabaseMetaData::getTables(const SQLString& /*catalog*/, cons
       + ((unique)?" AND NON_UNIQUE = 0":"")
       + " ORDER BY NON_UNIQUE, TYPE, INDEX_NAME, ORDINAL_POSITION");
 
-    return executeQuery(sql);
+    return cachedQuery(sql, catalogCond("TABLE_SCHEMA", schema) + " AND TABLE_NAME = " + escapeQuote(table),
+      [this, &sql]() { return executeQuery(sql); });
   }
 
   /**
@@ -3794,8 +3859,8 @@ ResultSet* MariaDbDatabaseMetaData::getTables(const SQLString& /*catalog*/, cons
    */
   ResultSet* MariaDbDatabaseMetaData::getClientInfoProperties()
   {
-    static std::vector<SQLString> columnNames{ "NAME", "MAX_LEN", "DEFAULT_VALUE", "DESCRIPTION" };
-    std::vector<ColumnType> columnTypes{
+    static const std::vector<SQLString> columnNames{ "NAME", "MAX_LEN", "DEFAULT_VALUE", "DESCRIPTION" };
+    static const std::vector<ColumnType> columnTypes{
       ColumnType::STRING,
       ColumnType::INTEGER,
       ColumnType::STRING,
@@ -3811,7 +3876,7 @@ ResultSet* MariaDbDatabaseMetaData::getTables(const SQLString& /*catalog*/, cons
       };*/
     const char* sixteenMb= "16777215";// { 49, 54, 55, 55, 55, 50, 49, 53, 0};
 
-    std::vector<std::vector<sql::bytes>> rows{
+    static const ConstantResult clientInfo(columnNames, columnTypes, {
       {
         BYTES_INIT("ApplicationName"),
         BYTES_INIT(sixteenMb),
@@ -3831,7 +3896,7 @@ ResultSet* MariaDbDatabaseMetaData::getTables(const SQLString& /*catalog*/, cons
         BYTES_STR_INIT(emptyStr),
         BYTES_INIT("The hostname of the computer the application using the connection is running on")
       }
-    };
+    });
 
     /*rows.reserve(3);
     rows.push_back(
@@ -3862,7 +3927,7 @@ ResultSet* MariaDbDatabaseMetaData::getTables(const SQLString& /*catalog*/, cons
           "The hostname of the computer the application using the connection is running on"
           },
           types));*/
-    return SelectResultSet::createResultSet(columnNames, columnTypes, rows, connection->getProtocol().get());
+    return clientInfo.createResultSet(connection->getProtocol().get());
     /*return new SelectResultSet(
         columns, rows, connection->getProtocol(), ResultSet::TYPE_SCROLL_INSENSITIVE);*/
   }
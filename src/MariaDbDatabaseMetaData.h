@@ -21,6 +21,8 @@
 #ifndef _MARIADBDATABASEMETADATA_H_
 #define _MARIADBDATABASEMETADATA_H_
 
+#include <functional>
+
 #include "MariaDbConnection.h"
 #include "Identifier.h"
 #include "Consts.h"
@@ -64,6 +66,8 @@ public:
 private:
   SQLString dataTypeClause(const SQLString& fullTypeColumnName);
   ResultSet* executeQuery(const SQLString& sql);
+  ResultSet* cachedQuery(const SQLString& key, const SQLString& tablesCond, const std::function<ResultSet*()>& query);
+  ResultSet* fetchImportedKeys(const SQLString& database, const SQLString& table);
   SQLString escapeQuote(const SQLString& value);
   SQLString catalogCond(const SQLString& columnName, const SQLString& catalog);
   SQLString patternCond(const SQLString& columnName, const SQLString& tableName);
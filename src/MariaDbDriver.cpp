@@ -22,11 +22,25 @@
 
 #include "UrlParser.h"
 #include "MariaDbConnection.h"
+#include "MariaDbMultiplexer.h"
+#include "MariaDbParallelBatchExecutor.h"
+#include "MariaDbAsyncInsertQueue.h"
+#include "MariaDbShardRouter.h"
 #include "options/DefaultOptions.h"
 #include "Exception.hpp"
 #include "Consts.h"
 #include "util/ClassField.h"
-#include "MariaDbDatabaseMetaData.h"
+#ifndef MARIADB_NO_DATABASE_METADATA
+# include "MariaDbDatabaseMetaData.h"
+#endif
+#include "pool/Pools.h"
+#include "util/MetricsRecorder.h"
+#include "util/TraceSpan.h"
+#include "util/StatementDigestTable.h"
+#include "util/ResultCache.h"
+#include "util/PrepareWarmup.h"
+#include "util/MemoryAccounting.h"
+#include "util/DriverAllocator.h"
 
 namespace sql
 {
@@ -44,6 +58,15 @@ namespace mariadb
 
   Connection* MariaDbDriver::connect(const SQLString& url, Properties& props)
   {
+    const std::string connectKey(Pools::connectKey(url, props));
+    PoolRequest request;
+    Shared::Pool pool(Pools::findPool(connectKey, request));
+
+    if (pool)
+    {
+      return pool->getConnection(request);
+    }
+
     Properties propsCopy(props);
     UrlParser* urlParser= UrlParser::parse(url, propsCopy);
 
@@ -53,8 +76,119 @@ namespace mariadb
     }
     else
     {
-      return MariaDbConnection::newConnection(*urlParser, nullptr);
+      return MariaDbConnection::newConnection(*urlParser, nullptr, connectKey);
+    }
+  }
+
+
+  ConnectionDescriptor* MariaDbDriver::prepareConnection(const SQLString& url, Properties& props)
+  {
+    Properties propsCopy(props);
+    UrlParser* urlParser= UrlParser::parse(url, propsCopy);
+
+    if (urlParser == nullptr || urlParser->getHostAddresses().empty())
+    {
+      delete urlParser;
+      return nullptr;
+    }
+    return new MariaDbConnectionDescriptor(urlParser, Pools::connectKey(url, props));
+  }
+
+  /**
+    * Parses urls of the shards. Each shard gets its own pool, unless the pool property is given.
+    *
+    * @throws SQLException if no url is given, or any of them is not accepted
+    */
+  ShardRouter* MariaDbDriver::createShardRouter(const std::vector<SQLString>& shardUrls, Properties& props,
+    ShardFunction* function)
+  {
+    if (shardUrls.empty()) {
+      throw SQLException("Shard router needs at least one shard", "HY024");
+    }
+    Properties shardProps(props);
+    std::vector<std::unique_ptr<ConnectionDescriptor>> shards;
+
+    if (shardProps.find("pool") == shardProps.end()) {
+      shardProps["pool"]= "true";
+    }
+    shards.reserve(shardUrls.size());
+    for (const auto& url : shardUrls) {
+      shards.emplace_back(prepareConnection(url, shardProps));
+      if (!shards.back()) {
+        throw SQLException("Shard url " + url + " is not accepted by the driver", "08000");
+      }
+    }
+    return new MariaDbShardRouter(shards, function);
+  }
+
+
+  MariaDbConnectionDescriptor::MariaDbConnectionDescriptor(UrlParser* _urlParser, const std::string& _connectKey)
+    : urlParser(_urlParser)
+    , connectKey(_connectKey)
+  {
+  }
+
+
+  MariaDbConnectionDescriptor::~MariaDbConnectionDescriptor()
+  {
+  }
+
+  /**
+    * Opens new connection using parsed parameters. The connection gets its own copy of UrlParser, while its Options
+    * are shared by all connections of the descriptor.
+    *
+    * @return connection object
+    */
+  Connection* MariaDbConnectionDescriptor::connect()
+  {
+    PoolRequest request;
+    Shared::Pool pool(Pools::findPool(connectKey, request));
+
+    if (pool)
+    {
+      return pool->getConnection(request);
+    }
+    return MariaDbConnection::newConnection(*new UrlParser(*urlParser), nullptr, connectKey);
+  }
+
+
+  Multiplexer* MariaDbConnectionDescriptor::createMultiplexer(uint32_t connections)
+  {
+    if (connections == 0) {
+      throw SQLException("Multiplexer needs at least one connection", "HY024");
+    }
+    std::vector<std::unique_ptr<Connection>> opened;
+
+    opened.reserve(connections);
+    for (uint32_t i= 0; i < connections; ++i) {
+      opened.emplace_back(connect());
+    }
+    return new MariaDbMultiplexer(opened);
+  }
+
+
+  ParallelBatchExecutor* MariaDbConnectionDescriptor::createParallelBatchExecutor(uint32_t parallelism)
+  {
+    if (parallelism == 0) {
+      throw SQLException("Parallel batch executor needs at least one connection", "HY024");
+    }
+    std::vector<std::unique_ptr<Connection>> opened;
+
+    opened.reserve(parallelism);
+    for (uint32_t i= 0; i < parallelism; ++i) {
+      opened.emplace_back(connect());
+    }
+    return new MariaDbParallelBatchExecutor(opened);
+  }
+
+
+  AsyncInsertQueue* MariaDbConnectionDescriptor::createAsyncInsertQueue(const SQLString& sql, uint32_t maxDelayMs,
+    std::size_t maxRows)
+  {
+    if (maxRows == 0) {
+      throw SQLException("Insert queue needs at least one row per batch", "HY024");
     }
+    return new MariaDbAsyncInsertQueue(connect(), sql, maxDelayMs, maxRows);
   }
 
 
@@ -186,13 +320,14 @@ namespace mariadb
     {
       options= DefaultOptions::parse(HaMode::NONE, emptyStr, info, options);
     }
-    for (auto &o : OptionsMap)
+    Value value;
+    for (auto &o : defaultOptionsMap())
     {
       try
       {
-        ClassField<Options> field= Options::getField(o.second.getOptionName());
-        Value value= field.get(*options);
-        SQLString strValue= value;
+        const ClassField<Options>& field= Options::getField(o.second.getOptionName());
+        field.get(*options, value);
+        SQLString strValue(value.toString());
         /* TODO: should ClassField know it's name?*/
         DriverPropertyInfo propertyInfo(/*field.getName()*/o.first, strValue);
         propertyInfo.description= o.second.getDescription();
@@ -223,7 +358,68 @@ namespace mariadb
 
   const SQLString& MariaDbDriver::getName()
   {
+#ifdef MARIADB_NO_DATABASE_METADATA
+    static const SQLString driverName("MariaDB Connector/C++");
+    return driverName;
+#else
     return MariaDbDatabaseMetaData::DRIVER_NAME;
+#endif
+  }
+
+
+  MetricsSnapshot* MariaDbDriver::getMetricsSnapshot()
+  {
+    return MetricsRegistry::getInstance().snapshot();
+  }
+
+
+  MemoryUsage MariaDbDriver::getMemoryUsage()
+  {
+    MemoryUsage usage;
+    MemoryAccounting::getInstance().snapshot(usage);
+    return usage;
+  }
+
+
+  void MariaDbDriver::setMemoryLimit(uint64_t bytes)
+  {
+    MemoryAccounting::get(MemoryAccounting::RESULT_SETS).setLimit(bytes);
+  }
+
+
+  void MariaDbDriver::setTracer(Tracer* tracer)
+  {
+    TraceSpan::setTracer(tracer);
+  }
+
+
+  void MariaDbDriver::setAllocator(Allocator* allocator)
+  {
+    DriverAllocator::set(allocator);
+  }
+
+
+  void MariaDbDriver::setStatementDigests(std::size_t capacity)
+  {
+    StatementDigestTable::getInstance().setCapacity(capacity);
+  }
+
+
+  StatementDigests* MariaDbDriver::getStatementDigests()
+  {
+    return StatementDigestTable::getInstance().snapshot();
+  }
+
+
+  void MariaDbDriver::setResultCache(std::size_t capacity)
+  {
+    ResultCache::getInstance().setCapacity(capacity);
+  }
+
+
+  void MariaDbDriver::setPrepareWarmup(const std::list<SQLString>& statements)
+  {
+    PrepareWarmup::getInstance().set(statements);
   }
 
 
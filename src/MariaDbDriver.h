@@ -31,11 +31,28 @@ namespace sql
 {
 namespace mariadb
 {
+  class UrlParser;
+
+  class MariaDbConnectionDescriptor final : public sql::ConnectionDescriptor {
+    const std::unique_ptr<UrlParser> urlParser;
+    const std::string connectKey;
+
+    public:
+      MariaDbConnectionDescriptor(UrlParser* urlParser, const std::string& connectKey);
+      ~MariaDbConnectionDescriptor();
+      Connection* connect();
+      Multiplexer* createMultiplexer(uint32_t connections);
+      ParallelBatchExecutor* createParallelBatchExecutor(uint32_t parallelism);
+      AsyncInsertQueue* createAsyncInsertQueue(const SQLString& sql, uint32_t maxDelayMs, std::size_t maxRows);
+  };
+
   class MariaDbDriver final : public sql::Driver {
     public:
       Connection* connect(const SQLString& url, Properties& props);
       Connection* connect(const SQLString& host, const SQLString& user, const SQLString& pwd);
       Connection* connect(const Properties& props);
+      ConnectionDescriptor* prepareConnection(const SQLString& url, Properties& props);
+      ShardRouter* createShardRouter(const std::vector<SQLString>& shardUrls, Properties& props, ShardFunction* function);
 
       bool acceptsURL(const SQLString& url);
       std::unique_ptr<std::vector<DriverPropertyInfo>> getPropertyInfo(SQLString& url, Properties& info);
@@ -43,6 +60,15 @@ namespace mariadb
       uint32_t getMinorVersion();
       bool jdbcCompliant();
       const SQLString& getName();
+      MetricsSnapshot* getMetricsSnapshot();
+      MemoryUsage getMemoryUsage();
+      void setMemoryLimit(uint64_t bytes);
+      void setTracer(Tracer* tracer);
+      void setAllocator(Allocator* allocator);
+      void setStatementDigests(std::size_t capacity);
+      StatementDigests* getStatementDigests();
+      void setResultCache(std::size_t capacity);
+      void setPrepareWarmup(const std::list<SQLString>& statements);
       Logger* getParentLogger();
   };
 }
@@ -27,6 +27,7 @@
 #include "MariaDbConnection.h"
 #include "CallParameter.h"
 #include "Results.h"
+#include "ExceptionFactory.h"
 
 namespace sql
 {
@@ -62,7 +63,8 @@ namespace mariadb
       parameterMetadata(nullptr),
       connection(_connection),
       databaseName(_databaseName),
-      functionName(_functionName)
+      // The name may be qualified with the database, parameters metadata is looked up by the function name only
+      functionName(_functionName.substr(_functionName.find_last_of('.') + 1))
   {
     initFunctionData(stmt->getParameterCount() + 1);
   }
@@ -98,6 +100,8 @@ namespace mariadb
     , parameterMetadata(other.parameterMetadata)
     , connection(_connection)
     , params(other.params)
+    , databaseName(other.databaseName)
+    , functionName(other.functionName)
   {
   }
 
@@ -115,9 +119,15 @@ namespace mariadb
     return clone;
   }
 
+
+  PreparedStatement* MariaDbFunctionStatement::clone(Connection* target)
+  {
+    return clone(MariaDbConnection::cloneTarget(connection, target));
+  }
+
   int32_t MariaDbFunctionStatement::executeUpdate()
   {
-    std::lock_guard<std::mutex> localScopeLock(*connection->lock);
+    std::lock_guard<ConnectionMutex> localScopeLock(*connection->lock);
     auto& results= getResults();
 
     stmt->execute();
@@ -130,6 +140,16 @@ namespace mariadb
     return getUpdateCount();
   }
 
+  /* The result of the function is read with the query, thus the error is caught here rather than returned */
+  int32_t MariaDbFunctionStatement::tryExecuteUpdate(ErrorInfo& error) noexcept
+  {
+    int32_t updateCount= Statement::EXECUTE_FAILED;
+
+    error.clear();
+    ExceptionFactory::catchInto(error, [this, &updateCount]() { updateCount= executeUpdate(); });
+    return updateCount;
+  }
+
   void MariaDbFunctionStatement::retrieveOutputResult()
   {
     auto& results= getResults();
@@ -193,12 +213,9 @@ namespace mariadb
   */
   void MariaDbFunctionStatement::initFunctionData(int32_t parametersCount)
   {
-    params.reserve(parametersCount);
-    for (int32_t i= 0; i < parametersCount; i++) {
-      params[i]= CallParameter();
-      if (i > 0) {
-        params[i].setInput(true);
-      }
+    params.resize(parametersCount);
+    for (int32_t i= 1; i < parametersCount; i++) {
+      params[i].setInput(true);
     }
     // the query was in the form {?=call function()}, so the first parameter is always output
     params[0].setOutput(true);
@@ -212,7 +229,7 @@ namespace mariadb
 
   ResultSet* MariaDbFunctionStatement::executeQuery()
   {
-    std::lock_guard<std::mutex> localScopeLock(*connection->getProtocol()->getLock());
+    std::lock_guard<ConnectionMutex> localScopeLock(*connection->getProtocol()->getLock());
     auto& results= getResults();
 
     stmt->execute();
@@ -226,7 +243,7 @@ namespace mariadb
 
   bool MariaDbFunctionStatement::execute()
   {
-    std::unique_lock<std::mutex>  localScopeLock(*connection->getProtocol()->getLock());
+    std::unique_lock<ConnectionMutex>  localScopeLock(*connection->getProtocol()->getLock());
     auto& results= getResults();
     localScopeLock.unlock();
     stmt->execute();
@@ -235,6 +252,28 @@ namespace mariadb
   }
 
 
+  bool MariaDbFunctionStatement::tryExecute(ErrorInfo& error) noexcept
+  {
+    error.clear();
+    return ExceptionFactory::catchInto(error, [this]() { execute(); });
+  }
+
+
+  /* Values are the function's arguments - the parameter 1 is its return value */
+  bool MariaDbFunctionStatement::executeValues(const ParameterValue* values, std::size_t count)
+  {
+    BasePrepareStatement::setValues(this, values, count, 2);
+    return execute();
+  }
+
+
+  ResultSet* MariaDbFunctionStatement::executeQueryValues(const ParameterValue* values, std::size_t count)
+  {
+    BasePrepareStatement::setValues(this, values, count, 2);
+    return executeQuery();
+  }
+
+
   Connection * MariaDbFunctionStatement::getConnection()
   {
     return connection;
@@ -445,6 +484,25 @@ namespace mariadb
   }
 
 
+  AsyncExecution* MariaDbFunctionStatement::executeAsync(const SQLString& sql)
+  {
+    return stmt->executeAsync(sql);
+  }
+
+
+  /* The output has to be read after the execution, thus only the blocking one is possible */
+  AsyncExecution* MariaDbFunctionStatement::executeAsync()
+  {
+    throw ExceptionFactory::INSTANCE.notSupported("Asynchronous execution is not supported by CallableStatement");
+  }
+
+
+  bool MariaDbFunctionStatement::tryExecute(const SQLString& sql, ErrorInfo& error) noexcept
+  {
+    return stmt->tryExecute(sql, error);
+  }
+
+
   bool MariaDbFunctionStatement::execute(const SQLString& sql, int32_t autoGeneratedKeys)
   {
     return stmt->execute(sql, autoGeneratedKeys);
@@ -457,6 +515,43 @@ namespace mariadb
   }
 
 
+  /* The function value is the only column of the statement's query */
+  bool MariaDbFunctionStatement::executeScalar(int64_t& value)
+  {
+    return stmt->executeScalar(value);
+  }
+
+
+  bool MariaDbFunctionStatement::executeScalar(double& value)
+  {
+    return stmt->executeScalar(value);
+  }
+
+
+  bool MariaDbFunctionStatement::executeScalar(SQLString& value)
+  {
+    return stmt->executeScalar(value);
+  }
+
+
+  bool MariaDbFunctionStatement::executeScalar(const SQLString& sql, int64_t& value)
+  {
+    return stmt->executeScalar(sql, value);
+  }
+
+
+  bool MariaDbFunctionStatement::executeScalar(const SQLString& sql, double& value)
+  {
+    return stmt->executeScalar(sql, value);
+  }
+
+
+  bool MariaDbFunctionStatement::executeScalar(const SQLString& sql, SQLString& value)
+  {
+    return stmt->executeScalar(sql, value);
+  }
+
+
   int64_t MariaDbFunctionStatement::executeLargeUpdate(const SQLString& sql)
   {
     return stmt->executeLargeUpdate(sql);
@@ -542,6 +637,30 @@ namespace mariadb
   }
 
 
+  void MariaDbFunctionStatement::setRetryable(bool retryable)
+  {
+    stmt->setRetryable(retryable);
+  }
+
+
+  bool MariaDbFunctionStatement::isRetryable()
+  {
+    return stmt->isRetryable();
+  }
+
+
+  void MariaDbFunctionStatement::setResultCacheTtl(int64_t milliseconds)
+  {
+    stmt->setResultCacheTtl(milliseconds);
+  }
+
+
+  int64_t MariaDbFunctionStatement::getResultCacheTtl()
+  {
+    return stmt->getResultCacheTtl();
+  }
+
+
 
   int32_t MariaDbFunctionStatement::getQueryTimeout()
   {
@@ -556,6 +675,18 @@ namespace mariadb
   }
 
 
+  int64_t MariaDbFunctionStatement::getQueryTimeoutMs()
+  {
+    return stmt->getQueryTimeoutMs();
+  }
+
+
+  void MariaDbFunctionStatement::setQueryTimeoutMs(int64_t milliseconds)
+  {
+    stmt->setQueryTimeoutMs(milliseconds);
+  }
+
+
 
   void MariaDbFunctionStatement::cancel()
   {
@@ -589,6 +720,12 @@ namespace mariadb
   }
 
 
+  int64_t MariaDbFunctionStatement::getLastInsertId()
+  {
+    return stmt->getLastInsertId();
+  }
+
+
   int32_t MariaDbFunctionStatement::getResultSetHoldability()
   {
     return stmt->getResultSetHoldability();
@@ -631,6 +768,12 @@ namespace mariadb
   }
 
 
+  const ExecutionStats& MariaDbFunctionStatement::getLastExecutionStats()
+  {
+    return stmt->getLastExecutionStats();
+  }
+
+
   bool MariaDbFunctionStatement::getMoreResults()
   {
     return stmt->getMoreResults();
@@ -643,6 +786,12 @@ namespace mariadb
   }
 
 
+  bool MariaDbFunctionStatement::skipResults(int32_t count)
+  {
+    return stmt->skipResults(count);
+  }
+
+
   int32_t MariaDbFunctionStatement::getFetchDirection()
   {
     return stmt->getFetchDirection();
@@ -667,6 +816,18 @@ namespace mariadb
   }
 
 
+  std::size_t MariaDbFunctionStatement::getFetchBytes()
+  {
+    return stmt->getFetchBytes();
+  }
+
+
+  void MariaDbFunctionStatement::setFetchBytes(std::size_t bytes)
+  {
+    stmt->setFetchBytes(bytes);
+  }
+
+
   int32_t MariaDbFunctionStatement::getResultSetConcurrency()
   {
     return stmt->getResultSetConcurrency();
@@ -718,147 +879,218 @@ namespace mariadb
   }
 
 
+  void MariaDbFunctionStatement::getBatchUpdateCounts(const int64_t*& counts, std::size_t& size) {
+    stmt->getBatchUpdateCounts(counts, size);
+  }
+
+
+  void MariaDbFunctionStatement::getBatchInsertIds(const int64_t*& ids, std::size_t& size, int32_t& increment) {
+    stmt->getBatchInsertIds(ids, size, increment);
+  }
+
+
   int64_t MariaDbFunctionStatement::executeLargeUpdate() {
     return stmt->executeLargeUpdate();
   }
 
   void MariaDbFunctionStatement::setNull(int32_t parameterIndex, int32_t sqlType) {
-    stmt->setNull(parameterIndex, sqlType);
+    stmt->setNull(parameterIndex - 1, sqlType);
   }
   /*void MariaDbFunctionStatement::setNull(int32_t parameterIndex, const ColumnType& mariadbType) {
-  stmt->setNull(parameterIndex, mariadbType);
+  stmt->setNull(parameterIndex - 1, mariadbType);
   }*/
   void MariaDbFunctionStatement::setNull(int32_t parameterIndex, int32_t sqlType, const SQLString& typeName) {
-    stmt->setNull(parameterIndex, sqlType, typeName);
+    stmt->setNull(parameterIndex - 1, sqlType, typeName);
   }
 
 
   void MariaDbFunctionStatement::setBlob(int32_t parameterIndex, std::istream* inputStream, const int64_t length) {
-    stmt->setBlob(parameterIndex, inputStream, length);
+    stmt->setBlob(parameterIndex - 1, inputStream, length);
   }
 
 
   void MariaDbFunctionStatement::setBlob(int32_t parameterIndex, std::istream* inputStream) {
-    stmt->setBlob(parameterIndex, inputStream);
+    stmt->setBlob(parameterIndex - 1, inputStream);
+  }
+
+
+  void MariaDbFunctionStatement::setBlobFromFile(int32_t parameterIndex, const SQLString& path) {
+    stmt->setBlobFromFile(parameterIndex - 1, path);
   }
 
 
   void MariaDbFunctionStatement::setBoolean(int32_t parameterIndex, bool value) {
-    stmt->setBoolean(parameterIndex, value);
+    stmt->setBoolean(parameterIndex - 1, value);
   }
 
 
   void MariaDbFunctionStatement::setByte(int32_t parameterIndex, int8_t byte) {
-    stmt->setByte(parameterIndex, byte);
+    stmt->setByte(parameterIndex - 1, byte);
   }
 
 
   void MariaDbFunctionStatement::setShort(int32_t parameterIndex, int16_t value) {
-    stmt->setShort(parameterIndex, value);
+    stmt->setShort(parameterIndex - 1, value);
   }
 
 
   void MariaDbFunctionStatement::setString(int32_t parameterIndex, const SQLString& str) {
-    stmt->setString(parameterIndex, str);
+    stmt->setString(parameterIndex - 1, str);
+  }
+
+
+  void MariaDbFunctionStatement::setU16String(int32_t parameterIndex, const std::u16string& str) {
+    stmt->setU16String(parameterIndex - 1, str);
+  }
+
+
+  void MariaDbFunctionStatement::setWString(int32_t parameterIndex, const std::wstring& str) {
+    stmt->setWString(parameterIndex - 1, str);
   }
 
 
   void MariaDbFunctionStatement::setBytes(int32_t parameterIndex, sql::bytes* bytes) {
-    stmt->setBytes(parameterIndex, bytes);
+    stmt->setBytes(parameterIndex - 1, bytes);
+  }
+
+
+  void MariaDbFunctionStatement::setBytes(int32_t parameterIndex, const char* bytes, std::size_t length) {
+    stmt->setBytes(parameterIndex - 1, bytes, length);
   }
 
 
   void MariaDbFunctionStatement::setInt(int32_t column, int32_t value) {
-    stmt->setInt(column, value);
+    stmt->setInt(column - 1, value);
   }
 
 
   void MariaDbFunctionStatement::setLong(int32_t parameterIndex, int64_t value) {
-    stmt->setLong(parameterIndex, value);
+    stmt->setLong(parameterIndex - 1, value);
   }
 
 
   void MariaDbFunctionStatement::setUInt64(int32_t parameterIndex, uint64_t value) {
-    stmt->setUInt64(parameterIndex, value);
+    stmt->setUInt64(parameterIndex - 1, value);
   }
 
 
   void MariaDbFunctionStatement::setUInt(int32_t parameterIndex, uint32_t value) {
-    stmt->setUInt(parameterIndex, value);
+    stmt->setUInt(parameterIndex - 1, value);
   }
 
 
   void MariaDbFunctionStatement::setFloat(int32_t parameterIndex, float value) {
-    stmt->setFloat(parameterIndex, value);
+    stmt->setFloat(parameterIndex - 1, value);
   }
 
 
   void MariaDbFunctionStatement::setDouble(int32_t parameterIndex, double value) {
-    stmt->setDouble(parameterIndex, value);
+    stmt->setDouble(parameterIndex - 1, value);
   }
 
 
   void MariaDbFunctionStatement::setDateTime(int32_t parameterIndex, const SQLString & dt) {
-    stmt->setDateTime(parameterIndex, dt);
+    stmt->setDateTime(parameterIndex - 1, dt);
+  }
+
+
+  void MariaDbFunctionStatement::setDateTime(int32_t parameterIndex, const DateTime& value) {
+    stmt->setDateTime(parameterIndex - 1, value);
+  }
+
+
+  void MariaDbFunctionStatement::setDecimal(int32_t parameterIndex, const Decimal& value) {
+    stmt->setDecimal(parameterIndex - 1, value);
   }
 
 
   void MariaDbFunctionStatement::setBigInt(int32_t parameterIndex, const SQLString& value) {
-    stmt->setBigInt(parameterIndex, value);
+    stmt->setBigInt(parameterIndex - 1, value);
+  }
+
+
+  void MariaDbFunctionStatement::setArray(int32_t parameterIndex, const int32_t* values, const char* nullIndicators, std::size_t rows) {
+    stmt->setArray(parameterIndex - 1, values, nullIndicators, rows);
+  }
+
+
+  void MariaDbFunctionStatement::setArray(int32_t parameterIndex, const int64_t* values, const char* nullIndicators, std::size_t rows) {
+    stmt->setArray(parameterIndex - 1, values, nullIndicators, rows);
+  }
+
+
+  void MariaDbFunctionStatement::setArray(int32_t parameterIndex, const double* values, const char* nullIndicators, std::size_t rows) {
+    stmt->setArray(parameterIndex - 1, values, nullIndicators, rows);
+  }
+
+
+  void MariaDbFunctionStatement::setArray(int32_t parameterIndex, const char* const* values, const unsigned long* lengths,
+    const char* nullIndicators, std::size_t rows) {
+    stmt->setArray(parameterIndex - 1, values, lengths, nullIndicators, rows);
+  }
+
+
+  void MariaDbFunctionStatement::setList(int32_t parameterIndex, const int64_t* values, std::size_t count) {
+    stmt->setList(parameterIndex - 1, values, count);
+  }
+
+
+  void MariaDbFunctionStatement::setList(int32_t parameterIndex, const SQLString* values, std::size_t count) {
+    stmt->setList(parameterIndex - 1, values, count);
   }
 
 
   void MariaDbFunctionStatement::setNull(const SQLString& parameterName, int32_t sqlType) {
-    stmt->setNull(nameToIndex(parameterName), sqlType);
+    stmt->setNull(nameToIndex(parameterName) - 1, sqlType);
   }
 
   void MariaDbFunctionStatement::setNull(const SQLString& parameterName, int32_t sqlType, const SQLString& typeName)
   {
-    stmt->setNull(nameToIndex(parameterName), sqlType, typeName);
+    stmt->setNull(nameToIndex(parameterName) - 1, sqlType, typeName);
   }
 
   void MariaDbFunctionStatement::setBoolean(const SQLString& parameterName, bool boolValue)
   {
-    stmt->setBoolean(nameToIndex(parameterName), boolValue);
+    stmt->setBoolean(nameToIndex(parameterName) - 1, boolValue);
   }
 
   void MariaDbFunctionStatement::setByte(const SQLString& parameterName, char byteValue)
   {
-    stmt->setByte(nameToIndex(parameterName), byteValue);
+    stmt->setByte(nameToIndex(parameterName) - 1, byteValue);
   }
 
   void MariaDbFunctionStatement::setShort(const SQLString& parameterName, int16_t shortValue)
   {
-    stmt->setShort(nameToIndex(parameterName), shortValue);
+    stmt->setShort(nameToIndex(parameterName) - 1, shortValue);
   }
 
   void MariaDbFunctionStatement::setInt(const SQLString& parameterName, int32_t intValue)
   {
-    stmt->setInt(nameToIndex(parameterName), intValue);
+    stmt->setInt(nameToIndex(parameterName) - 1, intValue);
   }
 
   void MariaDbFunctionStatement::setLong(const SQLString& parameterName, int64_t longValue)
   {
-    stmt->setLong(nameToIndex(parameterName), longValue);
+    stmt->setLong(nameToIndex(parameterName) - 1, longValue);
   }
 
   void MariaDbFunctionStatement::setFloat(const SQLString& parameterName, float floatValue) {
-    stmt->setFloat(nameToIndex(parameterName), floatValue);
+    stmt->setFloat(nameToIndex(parameterName) - 1, floatValue);
   }
 
 
   void MariaDbFunctionStatement::setDouble(const SQLString& parameterName, double doubleValue) {
-    stmt->setDouble(nameToIndex(parameterName), doubleValue);
+    stmt->setDouble(nameToIndex(parameterName) - 1, doubleValue);
   }
 
 
   void MariaDbFunctionStatement::setString(const SQLString& parameterName, const SQLString& stringValue) {
-    stmt->setString(nameToIndex(parameterName), stringValue);
+    stmt->setString(nameToIndex(parameterName) - 1, stringValue);
   }
 
 
   void MariaDbFunctionStatement::setBytes(const SQLString& parameterName, sql::bytes* bytes) {
-    stmt->setBytes(nameToIndex(parameterName), bytes);
+    stmt->setBytes(nameToIndex(parameterName) - 1, bytes);
   }
 
 
@@ -0,0 +1,221 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#include "MariaDbMultiplexer.h"
+
+namespace sql
+{
+namespace mariadb
+{
+  MariaDbMultiplexer::MariaDbMultiplexer(std::vector<std::unique_ptr<Connection>>& connections)
+  {
+    channels.reserve(connections.size());
+    for (auto& it : connections) {
+      channels.emplace_back(new Channel());
+      Channel& channel= *channels.back();
+      channel.connection= std::move(it);
+      channel.pipeline.reset(channel.connection->createPipeline());
+      channel.stmt.reset(channel.connection->createStatement());
+    }
+  }
+
+
+  MariaDbMultiplexer::~MariaDbMultiplexer()
+  {
+    try {
+      close();
+    }
+    catch (SQLException&) {
+    }
+  }
+
+
+  /* Has to be called under the lock. Idle connection, or the one with the shortest queue */
+  MariaDbMultiplexer::Channel& MariaDbMultiplexer::pick()
+  {
+    Channel* best= channels.front().get();
+
+    for (auto& it : channels) {
+      if (it->queue.size() + (it->busy ? 1 : 0) < best->queue.size() + (best->busy ? 1 : 0)) {
+        best= it.get();
+      }
+    }
+    return *best;
+  }
+
+
+  void MariaDbMultiplexer::execute(Request& request)
+  {
+    std::unique_lock<std::mutex> localScopeLock(lock);
+
+    if (closed) {
+      throw SQLException("Multiplexer is closed", "08003");
+    }
+    Channel& channel= pick();
+    channel.queue.push_back(&request);
+
+    while (!request.done) {
+      if (channel.busy) {
+        channel.done.wait(localScopeLock);
+        continue;
+      }
+      if (closed) {
+        for (auto it= channel.queue.begin(); it != channel.queue.end(); ++it) {
+          if (*it == &request) {
+            channel.queue.erase(it);
+            break;
+          }
+        }
+        throw SQLException("Multiplexer is closed", "08003");
+      }
+      // The queue has at least this request
+      std::vector<Request*> batch(channel.queue.begin(), channel.queue.end());
+      channel.queue.clear();
+      channel.busy= true;
+      localScopeLock.unlock();
+
+      run(channel, batch);
+
+      localScopeLock.lock();
+      for (auto it : batch) {
+        it->done= true;
+      }
+      channel.busy= false;
+      channel.done.notify_all();
+    }
+
+    if (request.error) {
+      throw *request.error;
+    }
+  }
+
+
+  /* The connection is used by this thread only, while its channel is busy */
+  void MariaDbMultiplexer::run(Channel& channel, std::vector<Request*>& batch)
+  {
+    std::unique_ptr<SQLException> firstError;
+
+    try {
+      for (auto it : batch) {
+        channel.pipeline->add(it->sql);
+      }
+      channel.pipeline->execute();
+    }
+    catch (SQLException& e) {
+      channel.pipeline->clear();
+      firstError.reset(new SQLException(e));
+    }
+
+    if (!firstError) {
+      for (std::size_t i= 0; i < batch.size(); ++i) {
+        batch[i]->resultSet.reset(channel.pipeline->getResultSet(i));
+        batch[i]->updateCount= channel.pipeline->getUpdateCount(i);
+      }
+      return;
+    }
+
+    // The pipeline throws the error of the first failed query only. Queries, that have failed after it, or have not
+    // been sent, are run again alone to get their own outcome
+    for (std::size_t i= 0; i < batch.size(); ++i) {
+      Request& request= *batch[i];
+      try {
+        request.resultSet.reset(channel.pipeline->getResultSet(i));
+        request.updateCount= channel.pipeline->getUpdateCount(i);
+      }
+      catch (SQLException&) {
+        // Nothing has been read
+        request.updateCount= -1;
+      }
+      if (request.resultSet || request.updateCount >= 0) {
+        continue;
+      }
+      if (request.updateCount == Statement::EXECUTE_FAILED && firstError) {
+        request.error= std::move(firstError);
+      }
+      else {
+        runAlone(channel, request);
+      }
+    }
+  }
+
+
+  void MariaDbMultiplexer::runAlone(Channel& channel, Request& request)
+  {
+    try {
+      if (channel.stmt->execute(request.sql)) {
+        request.resultSet.reset(channel.stmt->getResultSet());
+        request.updateCount= -1;
+      }
+      else {
+        request.updateCount= channel.stmt->getLargeUpdateCount();
+      }
+    }
+    catch (SQLException& e) {
+      request.error.reset(new SQLException(e));
+    }
+  }
+
+
+  ResultSet* MariaDbMultiplexer::executeQuery(const SQLString& sql)
+  {
+    Request request(sql);
+    execute(request);
+    return request.resultSet.release();
+  }
+
+
+  int64_t MariaDbMultiplexer::executeUpdate(const SQLString& sql)
+  {
+    Request request(sql);
+    execute(request);
+    return request.updateCount;
+  }
+
+
+  uint32_t MariaDbMultiplexer::getConnectionCount()
+  {
+    return static_cast<uint32_t>(channels.size());
+  }
+
+
+  void MariaDbMultiplexer::close()
+  {
+    std::unique_lock<std::mutex> localScopeLock(lock);
+
+    if (closed) {
+      return;
+    }
+    closed= true;
+    for (auto& it : channels) {
+      Channel& channel= *it;
+      while (channel.busy) {
+        channel.done.wait(localScopeLock);
+      }
+      // Waiting callers fail, once they see the connection idle
+      channel.done.notify_all();
+    }
+    for (auto& it : channels) {
+      it->stmt.reset();
+      it->pipeline.reset();
+      it->connection->close();
+    }
+  }
+}
+}
@@ -0,0 +1,90 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _MARIADBMULTIPLEXER_H_
+#define _MARIADBMULTIPLEXER_H_
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Multiplexer.hpp"
+#include "Connection.hpp"
+#include "Pipeline.hpp"
+#include "Statement.hpp"
+#include "Exception.hpp"
+
+namespace sql
+{
+namespace mariadb
+{
+
+/* There is no dispatcher thread - the caller, that finds the connection idle, takes all queries queued for it, runs
+   them in one pipeline and hands out results, while the others wait for their results on the condition of the
+   connection */
+class MariaDbMultiplexer final : public sql::Multiplexer
+{
+  struct Request
+  {
+    const SQLString& sql;
+    bool done= false;
+    std::unique_ptr<ResultSet> resultSet;
+    int64_t updateCount= -1;
+    std::unique_ptr<SQLException> error;
+
+    Request(const SQLString& _sql) : sql(_sql) {}
+  };
+
+  struct Channel
+  {
+    std::unique_ptr<Connection> connection;
+    std::unique_ptr<Pipeline> pipeline;
+    // For queries, whose results had to be read separately
+    std::unique_ptr<Statement> stmt;
+    std::deque<Request*> queue;
+    // The caller is running the pipeline of this connection
+    bool busy= false;
+    std::condition_variable done;
+  };
+
+  std::mutex lock;
+  std::vector<std::unique_ptr<Channel>> channels;
+  bool closed= false;
+
+  Channel& pick();
+  void execute(Request& request);
+  void run(Channel& channel, std::vector<Request*>& batch);
+  void runAlone(Channel& channel, Request& request);
+
+public:
+  MariaDbMultiplexer(std::vector<std::unique_ptr<Connection>>& connections);
+  ~MariaDbMultiplexer();
+
+  ResultSet* executeQuery(const SQLString& sql) override;
+  int64_t executeUpdate(const SQLString& sql) override;
+  uint32_t getConnectionCount() override;
+  void close() override;
+};
+
+}
+}
+#endif
@@ -0,0 +1,212 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#include <algorithm>
+#include <system_error>
+#include <thread>
+
+#include "MariaDbParallelBatchExecutor.h"
+#include "Statement.hpp"
+#include "Exception.hpp"
+
+namespace sql
+{
+namespace mariadb
+{
+  MariaDbParallelBatchExecutor::MariaDbParallelBatchExecutor(std::vector<std::unique_ptr<Connection>>& _connections)
+    : connections(std::move(_connections))
+  {
+  }
+
+
+  MariaDbParallelBatchExecutor::~MariaDbParallelBatchExecutor()
+  {
+    try {
+      close();
+    }
+    catch (SQLException&) {
+    }
+  }
+
+
+  void MariaDbParallelBatchExecutor::setPartitionTransactions(bool enable)
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    partitionTransactions= enable;
+  }
+
+
+  void MariaDbParallelBatchExecutor::setChunkSize(std::size_t rows)
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    chunkSize= rows;
+  }
+
+
+  const sql::Longs& MariaDbParallelBatchExecutor::executeBatch(const SQLString& sql, std::size_t rows,
+    BatchRowBinder& binder)
+  {
+    return execute(sql, rows, [&binder](PreparedStatement* ps, std::size_t begin, std::size_t end) -> const sql::Longs& {
+      try {
+        for (std::size_t row= begin; row < end; ++row) {
+          binder.bindRow(*ps, row);
+          ps->addBatch();
+        }
+      }
+      catch (...) {
+        ps->clearBatch();
+        throw;
+      }
+      return ps->executeLargeBatch();
+    });
+  }
+
+
+  const sql::Longs& MariaDbParallelBatchExecutor::executeArrowBatch(const SQLString& sql, const ArrowSchema* schema,
+    const ArrowArray* array)
+  {
+    return execute(sql, static_cast<std::size_t>(array->length),
+      [schema, array](PreparedStatement* ps, std::size_t begin, std::size_t end) -> const sql::Longs& {
+        // The slice shares the buffers, only the window of rows is moved
+        ArrowArray slice(*array);
+        slice.offset= array->offset + static_cast<int64_t>(begin);
+        slice.length= static_cast<int64_t>(end - begin);
+        return sql::executeArrowBatch(ps, schema, &slice);
+      });
+  }
+
+
+  const sql::Longs& MariaDbParallelBatchExecutor::execute(const SQLString& sql, std::size_t rows,
+    const ChunkExecutor& executor)
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+
+    if (closed) {
+      throw SQLException("Parallel batch executor is closed", "08003");
+    }
+    updateCounts.assign(rows, static_cast<int64_t>(Statement::EXECUTE_FAILED));
+    result.wrap(updateCounts);
+    if (rows == 0) {
+      return result;
+    }
+    std::size_t partitions= std::min(rows, connections.size());
+    std::vector<std::exception_ptr> errors(partitions);
+    std::vector<std::thread> workers;
+
+    workers.reserve(partitions - 1);
+    try {
+      for (std::size_t i= 1; i < partitions; ++i) {
+        workers.emplace_back(&MariaDbParallelBatchExecutor::executePartition, this, std::ref(*connections[i]),
+          std::cref(sql), rows*i / partitions, rows*(i + 1) / partitions, std::cref(executor), std::ref(errors[i]));
+      }
+    }
+    catch (std::system_error&) {
+      // Partitions, that did not get their threads, are executed by this one
+      for (std::size_t i= workers.size() + 1; i < partitions; ++i) {
+        executePartition(*connections[i], sql, rows*i / partitions, rows*(i + 1) / partitions, executor, errors[i]);
+      }
+    }
+    executePartition(*connections[0], sql, 0, rows / partitions, executor, errors[0]);
+    for (auto& it : workers) {
+      it.join();
+    }
+    for (auto& it : errors) {
+      if (it) {
+        std::rethrow_exception(it);
+      }
+    }
+    return result;
+  }
+
+
+  void MariaDbParallelBatchExecutor::executePartition(Connection& connection, const SQLString& sql, std::size_t begin,
+    std::size_t end, const ChunkExecutor& executor, std::exception_ptr& error)
+  {
+    std::size_t chunkEnd= begin;
+    bool autoCommit= true, transaction= false;
+    std::unique_ptr<PreparedStatement> ps;
+
+    try {
+      ps.reset(connection.prepareStatement(sql));
+      if (partitionTransactions) {
+        autoCommit= connection.getAutoCommit();
+        if (autoCommit) {
+          connection.setAutoCommit(false);
+        }
+        transaction= true;
+      }
+      for (std::size_t chunkBegin= begin; chunkBegin < end; chunkBegin= chunkEnd) {
+        chunkEnd= chunkSize == 0 ? end : std::min(end, chunkBegin + chunkSize);
+        const sql::Longs& counts= executor(ps.get(), chunkBegin, chunkEnd);
+        std::copy(counts.begin(), counts.begin() + std::min(counts.size(), chunkEnd - chunkBegin),
+          updateCounts.begin() + chunkBegin);
+      }
+      if (transaction) {
+        connection.commit();
+      }
+    }
+    catch (...) {
+      error= std::current_exception();
+      if (transaction) {
+        try {
+          connection.rollback();
+        }
+        catch (SQLException&) {
+        }
+        std::fill(updateCounts.begin() + begin, updateCounts.begin() + end, static_cast<int64_t>(Statement::EXECUTE_FAILED));
+      }
+    }
+    if (transaction && autoCommit) {
+      try {
+        connection.setAutoCommit(true);
+      }
+      catch (SQLException&) {
+      }
+    }
+  }
+
+
+  const sql::Longs& MariaDbParallelBatchExecutor::getUpdateCounts()
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    return result;
+  }
+
+
+  uint32_t MariaDbParallelBatchExecutor::getConnectionCount()
+  {
+    return static_cast<uint32_t>(connections.size());
+  }
+
+
+  void MariaDbParallelBatchExecutor::close()
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+
+    if (closed) {
+      return;
+    }
+    closed= true;
+    for (auto& it : connections) {
+      it->close();
+    }
+  }
+}
+}
@@ -0,0 +1,73 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _MARIADBPARALLELBATCHEXECUTOR_H_
+#define _MARIADBPARALLELBATCHEXECUTOR_H_
+
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "ParallelBatchExecutor.hpp"
+#include "Connection.hpp"
+#include "PreparedStatement.hpp"
+
+namespace sql
+{
+namespace mariadb
+{
+
+/* The caller's thread executes the first partition, and a thread is started for each of the others. The lock is held
+   for the whole batch */
+class MariaDbParallelBatchExecutor final : public sql::ParallelBatchExecutor
+{
+  /* Executes rows [begin, end) as one batch of the statement */
+  typedef std::function<const sql::Longs&(PreparedStatement*, std::size_t, std::size_t)> ChunkExecutor;
+
+  std::mutex lock;
+  std::vector<std::unique_ptr<Connection>> connections;
+  bool partitionTransactions= false;
+  std::size_t chunkSize= 0;
+  std::vector<int64_t> updateCounts;
+  sql::Longs result;
+  bool closed= false;
+
+  const sql::Longs& execute(const SQLString& sql, std::size_t rows, const ChunkExecutor& executor);
+  void executePartition(Connection& connection, const SQLString& sql, std::size_t begin, std::size_t end,
+    const ChunkExecutor& executor, std::exception_ptr& error);
+
+public:
+  MariaDbParallelBatchExecutor(std::vector<std::unique_ptr<Connection>>& connections);
+  ~MariaDbParallelBatchExecutor();
+
+  void setPartitionTransactions(bool enable) override;
+  void setChunkSize(std::size_t rows) override;
+  const sql::Longs& executeBatch(const SQLString& sql, std::size_t rows, BatchRowBinder& binder) override;
+  const sql::Longs& executeArrowBatch(const SQLString& sql, const ArrowSchema* schema, const ArrowArray* array) override;
+  const sql::Longs& getUpdateCounts() override;
+  uint32_t getConnectionCount() override;
+  void close() override;
+};
+
+}
+}
+#endif
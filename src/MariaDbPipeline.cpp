@@ -0,0 +1,119 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#include "MariaDbPipeline.h"
+
+#include "MariaDbConnection.h"
+#include "MariaDbStatement.h"
+#include "ClientSidePreparedStatement.h"
+#include "ExceptionFactory.h"
+#include "Results.h"
+
+namespace sql
+{
+namespace mariadb
+{
+  MariaDbPipeline::MariaDbPipeline(MariaDbConnection* _connection, Shared::ExceptionFactory& factory)
+    : connection(_connection)
+    , exceptionFactory(factory)
+    , stmt(new MariaDbStatement(_connection, ResultSet::TYPE_FORWARD_ONLY, ResultSet::CONCUR_READ_ONLY, factory))
+  {
+  }
+
+
+  MariaDbPipeline::~MariaDbPipeline()
+  {
+    // Results refer to the statement
+    results.clear();
+  }
+
+
+  Pipeline* MariaDbPipeline::add(const SQLString& sql)
+  {
+    queries.push_back(sql);
+    return this;
+  }
+
+
+  Pipeline* MariaDbPipeline::add(PreparedStatement* pstmt)
+  {
+    ClientSidePreparedStatement* csps= dynamic_cast<ClientSidePreparedStatement*>(pstmt);
+
+    if (csps == nullptr) {
+      throw SQLFeatureNotSupportedException("Only client side prepared statements can be added to the pipeline");
+    }
+    SQLString sql;
+    csps->assembleQuery(sql);
+    queries.push_back(sql);
+    return this;
+  }
+
+
+  std::size_t MariaDbPipeline::size()
+  {
+    return queries.size();
+  }
+
+
+  void MariaDbPipeline::clear()
+  {
+    queries.clear();
+  }
+
+
+  void MariaDbPipeline::execute()
+  {
+    std::vector<SQLString> toExecute;
+    toExecute.swap(queries);
+
+    if (toExecute.empty()) {
+      results.clear();
+      return;
+    }
+    stmt->executePipeline(toExecute, results);
+  }
+
+
+  Results* MariaDbPipeline::getResults(std::size_t index)
+  {
+    if (index >= results.size()) {
+      exceptionFactory->create("Invalid pipeline query index " + std::to_string(index), "07009").Throw();
+    }
+    return results[index].get();
+  }
+
+
+  ResultSet* MariaDbPipeline::getResultSet(std::size_t index)
+  {
+    return getResults(index)->releaseResultSet();
+  }
+
+
+  int64_t MariaDbPipeline::getUpdateCount(std::size_t index)
+  {
+    Results* result= getResults(index);
+
+    if (result->getCmdInformation()) {
+      return result->getCmdInformation()->getLargeUpdateCount();
+    }
+    return -1;
+  }
+}
+}
@@ -0,0 +1,61 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _MARIADBPIPELINE_H_
+#define _MARIADBPIPELINE_H_
+
+#include <vector>
+
+#include "Pipeline.hpp"
+#include "Consts.h"
+
+namespace sql
+{
+namespace mariadb
+{
+class MariaDbConnection;
+
+class MariaDbPipeline final : public sql::Pipeline
+{
+  MariaDbConnection* connection;
+  Shared::ExceptionFactory exceptionFactory;
+  // Internal statement, that executes queries and owns results
+  Unique::MariaDbStatement stmt;
+  std::vector<SQLString> queries;
+  std::vector<Shared::Results> results;
+
+  Results* getResults(std::size_t index);
+
+public:
+  MariaDbPipeline(MariaDbConnection* connection, Shared::ExceptionFactory& factory);
+  ~MariaDbPipeline();
+
+  Pipeline* add(const SQLString& sql) override;
+  Pipeline* add(PreparedStatement* pstmt) override;
+  std::size_t size() override;
+  void clear() override;
+  void execute() override;
+  ResultSet* getResultSet(std::size_t index) override;
+  int64_t getUpdateCount(std::size_t index) override;
+};
+
+}
+}
+#endif
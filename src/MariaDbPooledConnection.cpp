@@ -19,6 +19,7 @@
 
 
 #include <chrono>
+#include <algorithm>
 
 #include "MariaDbPooledConnection.h"
 
@@ -35,10 +36,18 @@ namespace mariadb
   MariaDbPooledConnection::MariaDbPooledConnection(MariaDbConnection* connection)
     : connection(connection)
   {
-    connection->pooledConnection.reset(this);
+    connection->pooledConnection= this;
     lastUsedToNow();
   }
 
+
+  MariaDbPooledConnection::~MariaDbPooledConnection()
+  {
+    if (connection) {
+      connection->pooledConnection= nullptr;
+    }
+  }
+
   /**
     * Creates and returns a <code>Connection</code> object that is a handle for the physical
     * connection that this <code>PooledConnection</code> object represents. The connection pool
@@ -51,7 +60,7 @@ namespace mariadb
     */
   MariaDbConnection* MariaDbPooledConnection::getConnection()
   {
-    return connection;
+    return connection.get();
   }
 
   /**
@@ -64,7 +73,7 @@ namespace mariadb
     */
   void MariaDbPooledConnection::close()
   {
-    connection->pooledConnection.reset();
+    connection->pooledConnection= nullptr;
     connection->close();
   }
 
@@ -76,7 +85,7 @@ namespace mariadb
     */
   void MariaDbPooledConnection::abort(sql::Executor* executor)
   {
-    connection->pooledConnection.reset();
+    connection->pooledConnection= nullptr;
     connection->abort(executor);
   }
 
@@ -103,9 +112,12 @@ namespace mariadb
     *     PooledConnection</code> object as a failover
     * @see #addConnectionEventListener
     */
-  void MariaDbPooledConnection::removeConnectionEventListener(ConnectionEventListener& /*listener*/)
+  void MariaDbPooledConnection::removeConnectionEventListener(ConnectionEventListener& listener)
   {
-    //connectionEventListeners.erase(&listener);
+    auto it= std::find(connectionEventListeners.begin(), connectionEventListeners.end(), &listener);
+    if (it != connectionEventListeners.end()) {
+      connectionEventListeners.erase(it);
+    }
   }
 
   /**
@@ -170,10 +182,11 @@ namespace mariadb
   /** Fire Connection close to listening listeners. */
   void MariaDbPooledConnection::fireConnectionClosed()
   {
-    /*ConnectionEvent* event= new ConnectionEvent(this);
-    for (ConnectionEventListener* listener : connectionEventListeners) {
-      listener->connectionClosed(event);
-    }*/
+    // Listener may remove itself, and the connection may go back to the pool and get new listeners meanwhile
+    std::vector<ConnectionEventListener*> listeners(connectionEventListeners);
+    for (ConnectionEventListener* listener : listeners) {
+      listener->connectionClosed(*this);
+    }
   }
 
   /**
@@ -181,12 +194,11 @@ namespace mariadb
     *
     * @param ex exception
     */
-  void MariaDbPooledConnection::fireConnectionErrorOccured(SQLException /*ex*/)
+  void MariaDbPooledConnection::fireConnectionErrorOccured(SQLException ex)
   {
-    /*ConnectionEvent* event= new ConnectionEvent(this, ex);
     for (ConnectionEventListener* listener : connectionEventListeners) {
-      listener->connectionErrorOccurred(event);
-    }*/
+      listener->connectionErrorOccurred(*this, ex);
+    }
   }
 
   /**
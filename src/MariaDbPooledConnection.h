@@ -31,18 +31,37 @@ namespace sql
 class Executor;
 namespace mariadb
 {
-class ConnectionEventListener;
+class MariaDbPooledConnection;
 class StatementEventListener;
 
+/* Interface for objects, that need to be notified about events on a pooled connection - its close and fatal errors */
+class ConnectionEventListener
+{
+public:
+  virtual ~ConnectionEventListener() {}
+  virtual void connectionClosed(MariaDbPooledConnection& pooledConnection)=0;
+  virtual void connectionErrorOccurred(MariaDbPooledConnection& pooledConnection, SQLException& ex)=0;
+};
+
+/* Owns the physical connection, that the pool hands out. */
 class MariaDbPooledConnection //  : public PooledConnection {
 {
-  MariaDbConnection* connection;
+  std::unique_ptr<MariaDbConnection> connection;
   std::vector<ConnectionEventListener*>connectionEventListeners;
   std::vector<StatementEventListener*>statementEventListeners;
   std::atomic<std::int64_t> lastUsed;
+  /* Time after which the pool retires the connection. 0 if the connection is not retired for its age */
+  int64_t retireTime= 0;
+  /* Time after which the pool pings the idle connection. 0 if the pool does not keep connections alive */
+  int64_t keepAliveTime= 0;
+  /* User and password, the connection is authenticated with. Set only for connections of the shared pool */
+  SQLString tenant;
+  /* "host:port", the pool counts the connection on */
+  std::string hostKey;
 
 public:
   MariaDbPooledConnection(MariaDbConnection* connection);
+  ~MariaDbPooledConnection();
   MariaDbConnection* getConnection();
   void close();
   void abort(sql::Executor* executor);
@@ -57,6 +76,14 @@ public:
   bool noStmtEventListeners();
   int64_t getLastUsed();
   void lastUsedToNow();
+  int64_t getRetireTime() const { return retireTime; }
+  void setRetireTime(int64_t time) { retireTime= time; }
+  int64_t getKeepAliveTime() const { return keepAliveTime; }
+  void setKeepAliveTime(int64_t time) { keepAliveTime= time; }
+  const SQLString& getTenant() const { return tenant; }
+  void setTenant(const SQLString& _tenant) { tenant= _tenant; }
+  const std::string& getHostKey() const { return hostKey; }
+  void setHostKey(const std::string& key) { hostKey= key; }
   };
 }
 }
@@ -26,6 +26,7 @@
 #include "ServerSidePreparedStatement.h"
 #include "CallableParameterMetaData.h"
 #include "Results.h"
+#include "ExceptionFactory.h"
 #include "Parameters.h"
 
 namespace sql
@@ -149,6 +150,12 @@ namespace mariadb
     return clone;
   }
 
+
+  PreparedStatement* MariaDbProcedureStatement::clone(Connection* target)
+  {
+    return clone(MariaDbConnection::cloneTarget(connection, target));
+  }
+
   void MariaDbProcedureStatement::retrieveOutputResult()
   {
     Shared::Results& results= getResults();
@@ -176,6 +183,27 @@ namespace mariadb
     return results && results->getResultSet();
   }
 
+  /* Output parameters are read with queries, thus the error is caught here rather than returned */
+  bool MariaDbProcedureStatement::tryExecute(ErrorInfo& error) noexcept
+  {
+    error.clear();
+    return ExceptionFactory::catchInto(error, [this]() { execute(); });
+  }
+
+  /* Values are set as IN parameters, so that the output parameters are handled as with execute() */
+  bool MariaDbProcedureStatement::executeValues(const ParameterValue* values, std::size_t count)
+  {
+    BasePrepareStatement::setValues(this, values, count);
+    return execute();
+  }
+
+
+  ResultSet* MariaDbProcedureStatement::executeQueryValues(const ParameterValue* values, std::size_t count)
+  {
+    BasePrepareStatement::setValues(this, values, count);
+    return executeQuery();
+  }
+
   /**
     * Valid that all parameters are set.
     *
@@ -979,6 +1007,37 @@ namespace mariadb
   }
 
 
+  void MariaDbProcedureStatement::setArray(int32_t parameterIndex, const int32_t* values, const char* nullIndicators, std::size_t rows) {
+    stmt->setArray(parameterIndex, values, nullIndicators, rows);
+  }
+
+
+  void MariaDbProcedureStatement::setArray(int32_t parameterIndex, const int64_t* values, const char* nullIndicators, std::size_t rows) {
+    stmt->setArray(parameterIndex, values, nullIndicators, rows);
+  }
+
+
+  void MariaDbProcedureStatement::setArray(int32_t parameterIndex, const double* values, const char* nullIndicators, std::size_t rows) {
+    stmt->setArray(parameterIndex, values, nullIndicators, rows);
+  }
+
+
+  void MariaDbProcedureStatement::setArray(int32_t parameterIndex, const char* const* values, const unsigned long* lengths,
+    const char* nullIndicators, std::size_t rows) {
+    stmt->setArray(parameterIndex, values, lengths, nullIndicators, rows);
+  }
+
+
+  void MariaDbProcedureStatement::setList(int32_t parameterIndex, const int64_t* values, std::size_t count) {
+    stmt->setList(parameterIndex, values, count);
+  }
+
+
+  void MariaDbProcedureStatement::setList(int32_t parameterIndex, const SQLString* values, std::size_t count) {
+    stmt->setList(parameterIndex, values, count);
+  }
+
+
   void MariaDbProcedureStatement::setString(const SQLString& parameterName, const SQLString& stringValue)
   {
     stmt->setString(nameToIndex(parameterName), stringValue);
@@ -998,6 +1057,15 @@ namespace mariadb
   bool MariaDbProcedureStatement::execute(const SQLString& sql) {
     return stmt->execute(sql);
   }
+  AsyncExecution* MariaDbProcedureStatement::executeAsync(const SQLString& sql) {
+    return stmt->executeAsync(sql);
+  }
+  AsyncExecution* MariaDbProcedureStatement::executeAsync() {
+    throw ExceptionFactory::INSTANCE.notSupported("Asynchronous execution is not supported by CallableStatement");
+  }
+  bool MariaDbProcedureStatement::tryExecute(const SQLString& sql, ErrorInfo& error) noexcept {
+    return stmt->tryExecute(sql, error);
+  }
   bool MariaDbProcedureStatement::execute(const SQLString& sql, int32_t autoGeneratedKeys) {
     return stmt->execute(sql, autoGeneratedKeys);
   }
@@ -1026,6 +1094,12 @@ namespace mariadb
   ResultSet* MariaDbProcedureStatement::executeQuery(const SQLString& sql) {
     return dynamic_cast<Statement*>(stmt.get())->executeQuery(sql);
   }
+  bool MariaDbProcedureStatement::executeScalar(int64_t& value) { return stmt->executeScalar(value); }
+  bool MariaDbProcedureStatement::executeScalar(double& value) { return stmt->executeScalar(value); }
+  bool MariaDbProcedureStatement::executeScalar(SQLString& value) { return stmt->executeScalar(value); }
+  bool MariaDbProcedureStatement::executeScalar(const SQLString& sql, int64_t& value) { return stmt->executeScalar(sql, value); }
+  bool MariaDbProcedureStatement::executeScalar(const SQLString& sql, double& value) { return stmt->executeScalar(sql, value); }
+  bool MariaDbProcedureStatement::executeScalar(const SQLString& sql, SQLString& value) { return stmt->executeScalar(sql, value); }
 
   void MariaDbProcedureStatement::setNull(int32_t parameterIndex, int32_t sqlType) {
     stmt->setNull(parameterIndex, sqlType);
@@ -1044,6 +1118,9 @@ namespace mariadb
   void MariaDbProcedureStatement::setBlob(int32_t parameterIndex, std::istream* inputStream) {
     stmt->setBlob(parameterIndex, inputStream);
   }
+  void MariaDbProcedureStatement::setBlobFromFile(int32_t parameterIndex, const SQLString& path) {
+    stmt->setBlobFromFile(parameterIndex, path);
+  }
 
   void MariaDbProcedureStatement::setBoolean(int32_t parameterIndex, bool value) {
     stmt->setBoolean(parameterIndex, value);
@@ -1057,9 +1134,18 @@ namespace mariadb
   void MariaDbProcedureStatement::setString(int32_t parameterIndex, const SQLString& str) {
     stmt->setString(parameterIndex, str);
   }
+  void MariaDbProcedureStatement::setU16String(int32_t parameterIndex, const std::u16string& str) {
+    stmt->setU16String(parameterIndex, str);
+  }
+  void MariaDbProcedureStatement::setWString(int32_t parameterIndex, const std::wstring& str) {
+    stmt->setWString(parameterIndex, str);
+  }
   void MariaDbProcedureStatement::setBytes(int32_t parameterIndex, sql::bytes* bytes) {
     stmt->setBytes(parameterIndex, bytes);
   }
+  void MariaDbProcedureStatement::setBytes(int32_t parameterIndex, const char* bytes, std::size_t length) {
+    stmt->setBytes(parameterIndex, bytes, length);
+  }
   void MariaDbProcedureStatement::setInt(int32_t column, int32_t value) {
     stmt->setInt(column, value);
   }
@@ -1078,6 +1164,16 @@ namespace mariadb
     stmt->setDateTime(parameterIndex, dt);
   }
 
+  void MariaDbProcedureStatement::setDateTime(int32_t parameterIndex, const DateTime& value)
+  {
+    stmt->setDateTime(parameterIndex, value);
+  }
+
+  void MariaDbProcedureStatement::setDecimal(int32_t parameterIndex, const Decimal& value)
+  {
+    stmt->setDecimal(parameterIndex, value);
+  }
+
   uint32_t MariaDbProcedureStatement::getMaxFieldSize() { return stmt->getMaxFieldSize(); }
   void MariaDbProcedureStatement::setMaxFieldSize(uint32_t max) { stmt->setMaxFieldSize(max); }
   int32_t MariaDbProcedureStatement::getMaxRows() { return stmt->getMaxRows(); }
@@ -1085,14 +1181,21 @@ namespace mariadb
   int64_t MariaDbProcedureStatement::getLargeMaxRows() { return stmt->getLargeMaxRows(); }
   void MariaDbProcedureStatement::setLargeMaxRows(int64_t max) { stmt->setLargeMaxRows(max); }
   void MariaDbProcedureStatement::setEscapeProcessing(bool enable) { stmt->setEscapeProcessing(enable); }
+  void MariaDbProcedureStatement::setRetryable(bool retryable) { stmt->setRetryable(retryable); }
+  bool MariaDbProcedureStatement::isRetryable() { return stmt->isRetryable(); }
+  void MariaDbProcedureStatement::setResultCacheTtl(int64_t milliseconds) { stmt->setResultCacheTtl(milliseconds); }
+  int64_t MariaDbProcedureStatement::getResultCacheTtl() { return stmt->getResultCacheTtl(); }
   int32_t MariaDbProcedureStatement::getQueryTimeout() { return stmt->getQueryTimeout(); }
   void MariaDbProcedureStatement::setQueryTimeout(int32_t seconds) { stmt->setQueryTimeout(seconds); }
+  int64_t MariaDbProcedureStatement::getQueryTimeoutMs() { return stmt->getQueryTimeoutMs(); }
+  void MariaDbProcedureStatement::setQueryTimeoutMs(int64_t milliseconds) { stmt->setQueryTimeoutMs(milliseconds); }
   void MariaDbProcedureStatement::cancel() { stmt->cancel(); }
   SQLWarning* MariaDbProcedureStatement::getWarnings() { return stmt->getWarnings(); }
   void MariaDbProcedureStatement::clearWarnings() { stmt->clearWarnings(); }
   void MariaDbProcedureStatement::setCursorName(const SQLString& name) { stmt->setCursorName(name); }
   Connection* MariaDbProcedureStatement::getConnection() { return stmt->getConnection(); }
   ResultSet* MariaDbProcedureStatement::getGeneratedKeys() { return stmt->getGeneratedKeys(); }
+  int64_t MariaDbProcedureStatement::getLastInsertId() { return stmt->getLastInsertId(); }
   int32_t MariaDbProcedureStatement::getResultSetHoldability() { return stmt->getResultSetHoldability(); }
   bool MariaDbProcedureStatement::isClosed() { return stmt->isClosed(); }
   bool MariaDbProcedureStatement::isPoolable() { return stmt->isPoolable(); }
@@ -1100,12 +1203,16 @@ namespace mariadb
   ResultSet* MariaDbProcedureStatement::getResultSet() { return stmt->getResultSet(); }
   int32_t MariaDbProcedureStatement::getUpdateCount() { return stmt->getUpdateCount(); }
   int64_t MariaDbProcedureStatement::getLargeUpdateCount() { return stmt->getLargeUpdateCount(); }
+  const ExecutionStats& MariaDbProcedureStatement::getLastExecutionStats() { return stmt->getLastExecutionStats(); }
   bool MariaDbProcedureStatement::getMoreResults() { return stmt->getMoreResults(); }
   bool MariaDbProcedureStatement::getMoreResults(int32_t current) { return stmt->getMoreResults(current); }
+  bool MariaDbProcedureStatement::skipResults(int32_t count) { return stmt->skipResults(count); }
   int32_t MariaDbProcedureStatement::getFetchDirection() { return stmt->getFetchDirection(); }
   void MariaDbProcedureStatement::setFetchDirection(int32_t direction) { stmt->setFetchDirection(direction); }
   int32_t MariaDbProcedureStatement::getFetchSize() { return stmt->getFetchSize(); }
   void MariaDbProcedureStatement::setFetchSize(int32_t rows) { stmt->setFetchSize(rows); }
+  std::size_t MariaDbProcedureStatement::getFetchBytes() { return stmt->getFetchBytes(); }
+  void MariaDbProcedureStatement::setFetchBytes(std::size_t bytes) { stmt->setFetchBytes(bytes); }
   int32_t MariaDbProcedureStatement::getResultSetConcurrency() { return stmt->getResultSetConcurrency(); }
   int32_t MariaDbProcedureStatement::getResultSetType() { return stmt->getResultSetType(); }
   void MariaDbProcedureStatement::closeOnCompletion() { stmt->closeOnCompletion(); }
@@ -1131,10 +1238,22 @@ namespace mariadb
     return stmt->executeLargeBatch();
   }
 
+  void MariaDbProcedureStatement::getBatchUpdateCounts(const int64_t*& counts, std::size_t& size) {
+    stmt->getBatchUpdateCounts(counts, size);
+  }
+
+  void MariaDbProcedureStatement::getBatchInsertIds(const int64_t*& ids, std::size_t& size, int32_t& increment) {
+    stmt->getBatchInsertIds(ids, size, increment);
+  }
+
   int32_t MariaDbProcedureStatement::executeUpdate() {
       return stmt->executeUpdate();
   }
 
+  int32_t MariaDbProcedureStatement::tryExecuteUpdate(ErrorInfo& error) noexcept {
+    return stmt->tryExecuteUpdate(error);
+  }
+
   int64_t MariaDbProcedureStatement::executeLargeUpdate() {
     return stmt->executeLargeUpdate();
   }
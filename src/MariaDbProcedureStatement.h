@@ -72,6 +72,7 @@ protected:
 
 public:
   MariaDbProcedureStatement* clone(MariaDbConnection* connection);
+  PreparedStatement* clone(Connection* connection);
 
 private:
   void retrieveOutputResult();
@@ -79,6 +80,9 @@ private:
 public:
   void setParameter(int32_t parameterIndex, ParameterHolder& holder);
   bool execute();
+  bool tryExecute(ErrorInfo& error) noexcept;
+  bool executeValues(const ParameterValue* values, std::size_t count);
+  ResultSet* executeQueryValues(const ParameterValue* values, std::size_t count);
 
 private:
   void validAllParameters();
@@ -92,6 +96,8 @@ private:
 public:
   const sql::Ints& executeBatch();
   const sql::Longs& executeLargeBatch();
+  void getBatchUpdateCounts(const int64_t*& counts, std::size_t& size);
+  void getBatchInsertIds(const int64_t*& ids, std::size_t& size, int32_t& increment);
   void setParametersVariables();
   ParameterMetaData* getParameterMetaData();
 
@@ -224,12 +230,16 @@ public:
   void setNull(int32_t parameterIndex, int32_t sqlType, const SQLString& typeName);
   void setBlob(int32_t parameterIndex, std::istream* inputStream, const int64_t length);
   void setBlob(int32_t parameterIndex, std::istream* inputStream);
+  void setBlobFromFile(int32_t parameterIndex, const SQLString& path);
 
   void setBoolean(int32_t parameterIndex, bool value);
   void setByte(int32_t parameterIndex, int8_t byte);
   void setShort(int32_t parameterIndex, int16_t value);
   void setString(int32_t parameterIndex, const SQLString& str);
+  void setU16String(int32_t parameterIndex, const std::u16string& str);
+  void setWString(int32_t parameterIndex, const std::wstring& str);
   void setBytes(int32_t parameterIndex, sql::bytes* bytes);
+  void setBytes(int32_t parameterIndex, const char* bytes, std::size_t length);
   void setInt(int32_t column, int32_t value);
   void setLong(int32_t parameterIndex, int64_t value);
   void setInt64(int32_t parameterIndex, int64_t value) { setLong(parameterIndex, value); }
@@ -238,12 +248,24 @@ public:
   void setFloat(int32_t parameterIndex, float value);
   void setDouble(int32_t parameterIndex, double value);
   void setDateTime(int32_t parameterIndex, const SQLString& dt);
+  void setDateTime(int32_t parameterIndex, const DateTime& value);
+  void setDecimal(int32_t parameterIndex, const Decimal& value);
   void setBigInt(int32_t parameterIndex, const SQLString& value);
+  void setArray(int32_t parameterIndex, const int32_t* values, const char* nullIndicators, std::size_t rows);
+  void setArray(int32_t parameterIndex, const int64_t* values, const char* nullIndicators, std::size_t rows);
+  void setArray(int32_t parameterIndex, const double* values, const char* nullIndicators, std::size_t rows);
+  void setArray(int32_t parameterIndex, const char* const* values, const unsigned long* lengths,
+    const char* nullIndicators, std::size_t rows);
+  void setList(int32_t parameterIndex, const int64_t* values, std::size_t count);
+  void setList(int32_t parameterIndex, const SQLString* values, std::size_t count);
 
   /* Forwarding to stmt to implement Statement's part of interface */
   bool execute(const sql::SQLString& sql, const sql::SQLString* colNames);
   bool execute(const sql::SQLString& sql, int32_t* colIdxs);
   bool execute(const SQLString& sql);
+  AsyncExecution* executeAsync(const SQLString& sql);
+  AsyncExecution* executeAsync();
+  bool tryExecute(const SQLString& sql, ErrorInfo& error) noexcept;
   bool execute(const SQLString& sql, int32_t autoGeneratedKeys);
   int32_t executeUpdate(const SQLString& sql);
   int32_t executeUpdate(const SQLString& sql, int32_t autoGeneratedKeys);
@@ -255,6 +277,12 @@ public:
   int64_t executeLargeUpdate(const SQLString& sql, const SQLString* columnNames);
   ResultSet* executeQuery();
   ResultSet* executeQuery(const SQLString& sql);
+  bool executeScalar(int64_t& value);
+  bool executeScalar(double& value);
+  bool executeScalar(SQLString& value);
+  bool executeScalar(const SQLString& sql, int64_t& value);
+  bool executeScalar(const SQLString& sql, double& value);
+  bool executeScalar(const SQLString& sql, SQLString& value);
 
   uint32_t getMaxFieldSize();
   void setMaxFieldSize(uint32_t max);
@@ -263,14 +291,21 @@ public:
   int64_t getLargeMaxRows();
   void setLargeMaxRows(int64_t max);
   void setEscapeProcessing(bool enable);
+  void setRetryable(bool retryable);
+  bool isRetryable();
+  void setResultCacheTtl(int64_t milliseconds);
+  int64_t getResultCacheTtl();
   int32_t getQueryTimeout();
   void setQueryTimeout(int32_t seconds);
+  int64_t getQueryTimeoutMs();
+  void setQueryTimeoutMs(int64_t milliseconds);
   void cancel();
   SQLWarning* getWarnings();
   void clearWarnings();
   void setCursorName(const SQLString& name);
   Connection* getConnection();
   ResultSet* getGeneratedKeys();
+  int64_t getLastInsertId();
   int32_t getResultSetHoldability();
   bool isClosed();
   bool isPoolable();
@@ -278,12 +313,16 @@ public:
   ResultSet* getResultSet();
   int32_t getUpdateCount();
   int64_t getLargeUpdateCount();
+  const ExecutionStats& getLastExecutionStats();
   bool getMoreResults();
   bool getMoreResults(int32_t current);
+  bool skipResults(int32_t count);
   int32_t getFetchDirection();
   void setFetchDirection(int32_t direction);
   int32_t getFetchSize();
   void setFetchSize(int32_t rows);
+  std::size_t getFetchBytes();
+  void setFetchBytes(std::size_t bytes);
   int32_t getResultSetConcurrency();
   int32_t getResultSetType();
   void closeOnCompletion();
@@ -293,6 +332,7 @@ public:
   void clearBatch();
   void close();
   int32_t executeUpdate();
+  int32_t tryExecuteUpdate(ErrorInfo& error) noexcept;
   int64_t executeLargeUpdate();
   Statement* setResultSetType(int32_t rsType);
   void clearParameters();
@@ -35,7 +35,7 @@ namespace mariadb
     * @param forceAlias force table and column name alias as original data
     */
   MariaDbResultSetMetaData::MariaDbResultSetMetaData(const std::vector<Shared::ColumnDefinition>& _fieldPackets, const Shared::Options& _options, bool _forceAlias)
-    : fieldPackets(_fieldPackets)
+    : fieldPackets(std::make_shared<const std::vector<Shared::ColumnDefinition>>(_fieldPackets))
     , options(_options)
     , forceAlias(_forceAlias)
   {
@@ -48,7 +48,7 @@ namespace mariadb
     */
   uint32_t MariaDbResultSetMetaData::getColumnCount()
   {
-    return static_cast<uint32_t>(fieldPackets.size());
+    return static_cast<uint32_t>(fieldPackets->size());
   }
 
   /**
@@ -371,8 +371,8 @@ namespace mariadb
 
   const ColumnDefinition& MariaDbResultSetMetaData::getColumnDefinition(uint32_t column)
   {
-    if (column >=1 &&column <= fieldPackets.size()) {
-      return *fieldPackets[column -1];
+    if (column >=1 &&column <= fieldPackets->size()) {
+      return *(*fieldPackets)[column -1];
     }
     throw InvalidArgumentException("No such column", "42000");//*ExceptionFactory::INSTANCE.create("No such column");
   }
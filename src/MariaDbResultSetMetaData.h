@@ -32,7 +32,8 @@ class ColumnDefinition;
 
 class MariaDbResultSetMetaData : public sql::ResultSetMetaData
 {
-  const std::vector<Shared::ColumnDefinition> fieldPackets;
+  /* Immutable, thus copies of the metadata share it */
+  std::shared_ptr<const std::vector<Shared::ColumnDefinition>> fieldPackets;
   const Shared::Options options;
   bool forceAlias;
 
@@ -0,0 +1,146 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+
+#include <string>
+
+#include "MariaDbSequenceAllocator.h"
+#include "MariaDbConnection.h"
+#include "Statement.hpp"
+#include "ResultSet.hpp"
+#include "Exception.hpp"
+
+namespace sql
+{
+namespace mariadb
+{
+  MariaDbSequenceAllocator::MariaDbSequenceAllocator(MariaDbConnection* connection, const SQLString& sequence,
+    int64_t _blockSize, bool _background)
+    : stmt(connection->createStatement())
+    , nextValueQuery("SELECT NEXT VALUE FOR " + sequence)
+    , background(_background)
+    , current(new Block(0, 0))
+  {
+    // The sequence is the table of one row with its definition
+    Unique::ResultSet rs(stmt->executeQuery("SELECT increment, maximum_value FROM " + sequence));
+
+    if (!rs->next()) {
+      throw SQLException(("Could not read the definition of the sequence " + sequence).c_str(), "HY000");
+    }
+    int64_t increment= rs->getLong(1);
+    maxValue= rs->getLong(2);
+
+    // INCREMENT 0 means steps of auto_increment_increment, that are shared with other servers, not a block
+    if (increment <= 0) {
+      throw SQLException("Values can be claimed in blocks only from the sequence with positive INCREMENT", "HY024");
+    }
+    if (_blockSize != 0 && _blockSize != increment) {
+      throw SQLException(("Block size " + std::to_string(_blockSize) + " differs from the INCREMENT "
+        + std::to_string(increment) + " of the sequence").c_str(), "HY024");
+    }
+    blockSize= increment;
+  }
+
+
+  MariaDbSequenceAllocator::~MariaDbSequenceAllocator()
+  {
+    try {
+      close();
+    }
+    catch (SQLException&) {
+    }
+  }
+
+
+  int64_t MariaDbSequenceAllocator::next()
+  {
+    while (true) {
+      std::shared_ptr<Block> block(std::atomic_load(&current));
+      int64_t index= block->taken.fetch_add(1);
+
+      if (index < block->size) {
+        // Exactly one thread gets the middle of the block
+        if (background && index == block->size / 2) {
+          prefetch();
+        }
+        return block->start + index;
+      }
+      switchBlock(block);
+    }
+  }
+
+
+  int64_t MariaDbSequenceAllocator::getBlockSize()
+  {
+    return blockSize;
+  }
+
+
+  void MariaDbSequenceAllocator::close()
+  {
+    std::lock_guard<std::mutex> guard(lock);
+
+    if (claimed.valid()) {
+      claimed.wait();
+      claimed= std::future<int64_t>();
+    }
+    std::atomic_store(&current, std::make_shared<Block>(0, 0));
+    stmt.reset();
+  }
+
+  /* The first value of the new block. The connection's lock keeps the background claim apart from the application's
+     use of the connection */
+  int64_t MariaDbSequenceAllocator::claim()
+  {
+    Unique::ResultSet rs(stmt->executeQuery(nextValueQuery));
+    rs->next();
+    return rs->getLong(1);
+  }
+
+
+  void MariaDbSequenceAllocator::prefetch()
+  {
+    std::lock_guard<std::mutex> guard(lock);
+
+    if (stmt && !claimed.valid()) {
+      claimed= std::async(std::launch::async, &MariaDbSequenceAllocator::claim, this);
+    }
+  }
+
+
+  void MariaDbSequenceAllocator::switchBlock(const std::shared_ptr<Block>& exhausted)
+  {
+    std::lock_guard<std::mutex> guard(lock);
+
+    // Other thread has switched it already
+    if (std::atomic_load(&current) != exhausted) {
+      return;
+    }
+    if (!stmt) {
+      throw SQLException("Sequence allocator is closed", "HY000");
+    }
+    // If the claim fails, the exhausted block stays, and the next call claims again
+    int64_t start= claimed.valid() ? claimed.get() : claim();
+    int64_t size= maxValue - start < blockSize ? maxValue - start + 1 : blockSize;
+
+    std::atomic_store(&current, std::make_shared<Block>(start, size));
+  }
+}
+}
@@ -0,0 +1,78 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+
+#ifndef _MARIADBSEQUENCEALLOCATOR_H_
+#define _MARIADBSEQUENCEALLOCATOR_H_
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <mutex>
+
+#include "SequenceAllocator.hpp"
+#include "Consts.h"
+
+namespace sql
+{
+namespace mariadb
+{
+class MariaDbConnection;
+
+/* The current block is replaced as a whole, so the thread, that has read it, takes the value from it even if other
+   thread switches to the next block meanwhile. Blocks are claimed one at a time - the background claim is started,
+   and the block is switched, under the lock, and the switch waits for the claim in progress */
+class MariaDbSequenceAllocator final : public sql::SequenceAllocator
+{
+  struct Block {
+    const int64_t start;
+    /* Less than the block size, if the block reaches the sequence's maximum value */
+    const int64_t size;
+    std::atomic<int64_t> taken;
+
+    Block(int64_t _start, int64_t _size) : start(_start), size(_size), taken(0) {}
+  };
+
+  Unique::Statement stmt;
+  const SQLString nextValueQuery;
+  int64_t blockSize= 0;
+  int64_t maxValue= 0;
+  /* If the connection may be used by the background claim */
+  const bool background;
+  std::mutex lock;
+  std::shared_ptr<Block> current;
+  std::future<int64_t> claimed;
+
+  int64_t claim();
+  void prefetch();
+  void switchBlock(const std::shared_ptr<Block>& exhausted);
+
+public:
+  MariaDbSequenceAllocator(MariaDbConnection* connection, const SQLString& sequence, int64_t blockSize, bool background);
+  ~MariaDbSequenceAllocator();
+
+  int64_t next() override;
+  int64_t getBlockSize() override;
+  void close() override;
+};
+
+}
+}
+#endif
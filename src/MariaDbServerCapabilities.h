@@ -65,6 +65,12 @@ struct MariaDbServerCapabilities  {
       1LL << 33; /* bundle command during connection */
   static const int64_t _MARIADB_CLIENT_STMT_BULK_OPERATIONS =
     1LL << 34; /* support of array binding */
+  static const int64_t _MARIADB_CLIENT_EXTENDED_METADATA =
+    1LL << 35; /* extended data type information in column definitions */
+  static const int64_t _MARIADB_CLIENT_CACHE_METADATA =
+    1LL << 36; /* column definitions of prepared statement are not re-sent if they haven't changed */
+  static const int64_t _MARIADB_CLIENT_BULK_UNIT_RESULTS =
+    1LL << 37; /* bulk command returns result of each parameter set */
 
 };
 }
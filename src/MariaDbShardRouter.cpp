@@ -0,0 +1,214 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+
+#include <exception>
+#include <system_error>
+#include <thread>
+
+#include "MariaDbShardRouter.h"
+#include "Exception.hpp"
+
+namespace sql
+{
+namespace mariadb
+{
+  MariaDbShardRouter::MariaDbShardRouter(std::vector<std::unique_ptr<ConnectionDescriptor>>& _shards,
+    ShardFunction* _function)
+    : shards(std::move(_shards))
+    , function(_function)
+  {
+  }
+
+
+  uint32_t MariaDbShardRouter::getShardCount()
+  {
+    return static_cast<uint32_t>(shards.size());
+  }
+
+
+  uint32_t MariaDbShardRouter::shardOf(const SQLString& key)
+  {
+    uint32_t shardCount= getShardCount();
+
+    if (function != nullptr) {
+      uint32_t shard= function->shardOf(key, shardCount);
+      if (shard >= shardCount) {
+        throw SQLException(("Shard function has returned shard " + std::to_string(shard) + " of " +
+          std::to_string(shardCount)).c_str(), "HY024");
+      }
+      return shard;
+    }
+    uint64_t hash= 14695981039346656037ULL;
+    for (std::size_t i= 0; i < key.length(); ++i) {
+      hash^= static_cast<uint8_t>(key.c_str()[i]);
+      hash*= 1099511628211ULL;
+    }
+    return static_cast<uint32_t>(hash % shardCount);
+  }
+
+
+  Connection* MariaDbShardRouter::getConnection(const SQLString& key)
+  {
+    return shards[shardOf(key)]->connect();
+  }
+
+
+  Connection* MariaDbShardRouter::getShardConnection(uint32_t shard)
+  {
+    if (shard >= shards.size()) {
+      throw SQLException(("Invalid shard index " + std::to_string(shard)).c_str(), "HY024");
+    }
+    return shards[shard]->connect();
+  }
+
+
+  static void executeShardQuery(ConnectionDescriptor& descriptor, ShardQuery& query, const SQLString& sql,
+    int32_t fetchSize, std::exception_ptr& error)
+  {
+    try {
+      query.connection.reset(descriptor.connect());
+      query.statement.reset(query.connection->createStatement());
+      query.statement->setFetchSize(fetchSize);
+      query.resultSet.reset(query.statement->executeQuery(sql));
+    }
+    catch (...) {
+      error= std::current_exception();
+    }
+  }
+
+  /**
+    * The caller's thread executes the query of the first shard, and a thread is started for each of the others. With
+    * fetchSize the threads return after the first portion of rows has arrived. If shards fail, the error of the first
+    * failed one is thrown, after all are done.
+    */
+  ShardedResult* MariaDbShardRouter::executeQuery(const SQLString& sql, const std::vector<uint32_t>& shardList,
+    int32_t fetchSize)
+  {
+    std::vector<ShardQuery> queries;
+    std::vector<std::exception_ptr> errors(shardList.size());
+    std::vector<std::thread> workers;
+
+    queries.reserve(shardList.size());
+    for (auto shard : shardList) {
+      if (shard >= shards.size()) {
+        throw SQLException(("Invalid shard index " + std::to_string(shard)).c_str(), "HY024");
+      }
+      queries.emplace_back(shard);
+    }
+    if (queries.empty()) {
+      return new MariaDbShardedResult(queries);
+    }
+    workers.reserve(queries.size() - 1);
+    try {
+      for (std::size_t i= 1; i < queries.size(); ++i) {
+        workers.emplace_back(executeShardQuery, std::ref(*shards[queries[i].shard]), std::ref(queries[i]),
+          std::cref(sql), fetchSize, std::ref(errors[i]));
+      }
+    }
+    catch (std::system_error&) {
+      // Shards, that did not get their threads, are queried by this one
+      for (std::size_t i= workers.size() + 1; i < queries.size(); ++i) {
+        executeShardQuery(*shards[queries[i].shard], queries[i], sql, fetchSize, errors[i]);
+      }
+    }
+    executeShardQuery(*shards[queries[0].shard], queries[0], sql, fetchSize, errors[0]);
+    for (auto& it : workers) {
+      it.join();
+    }
+    for (auto& it : errors) {
+      if (it) {
+        std::rethrow_exception(it);
+      }
+    }
+    return new MariaDbShardedResult(queries);
+  }
+
+
+  ShardedResult* MariaDbShardRouter::executeQueryOnAll(const SQLString& sql, int32_t fetchSize)
+  {
+    std::vector<uint32_t> all;
+
+    all.reserve(shards.size());
+    for (uint32_t i= 0; i < shards.size(); ++i) {
+      all.push_back(i);
+    }
+    return executeQuery(sql, all, fetchSize);
+  }
+
+
+  MariaDbShardedResult::MariaDbShardedResult(std::vector<ShardQuery>& _queries)
+    : queries(std::move(_queries))
+  {
+  }
+
+
+  MariaDbShardedResult::~MariaDbShardedResult()
+  {
+    try {
+      close();
+    }
+    catch (SQLException&) {
+    }
+  }
+
+  /* Result set of the shard, that has been read to the end, is closed right away, so its connection goes back to the
+     pool before the rest are read */
+  bool MariaDbShardedResult::next()
+  {
+    for (; position < queries.size(); ++position) {
+      ShardQuery& query= queries[position];
+
+      if (query.resultSet && query.resultSet->next()) {
+        return true;
+      }
+      query.resultSet.reset();
+      query.statement.reset();
+      query.connection.reset();
+    }
+    return false;
+  }
+
+
+  ResultSet* MariaDbShardedResult::current()
+  {
+    if (position >= queries.size()) {
+      throw SQLException("Current position is after the last row", "24000");
+    }
+    return queries[position].resultSet.get();
+  }
+
+
+  uint32_t MariaDbShardedResult::currentShard()
+  {
+    if (position >= queries.size()) {
+      throw SQLException("Current position is after the last row", "24000");
+    }
+    return queries[position].shard;
+  }
+
+
+  void MariaDbShardedResult::close()
+  {
+    queries.clear();
+    position= 0;
+  }
+}
+}
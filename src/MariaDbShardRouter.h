@@ -0,0 +1,83 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+
+#ifndef _MARIADBSHARDROUTER_H_
+#define _MARIADBSHARDROUTER_H_
+
+#include <memory>
+#include <vector>
+
+#include "ShardRouter.hpp"
+#include "Driver.hpp"
+#include "Statement.hpp"
+
+namespace sql
+{
+namespace mariadb
+{
+
+/* Each shard is the descriptor of its url. The default function is 64-bit FNV-1a hash of the key, so the key goes to
+   the same shard in every process */
+class MariaDbShardRouter final : public sql::ShardRouter
+{
+  const std::vector<std::unique_ptr<ConnectionDescriptor>> shards;
+  ShardFunction* const function;
+
+public:
+  MariaDbShardRouter(std::vector<std::unique_ptr<ConnectionDescriptor>>& shards, ShardFunction* function);
+
+  uint32_t getShardCount() override;
+  uint32_t shardOf(const SQLString& key) override;
+  Connection* getConnection(const SQLString& key) override;
+  Connection* getShardConnection(uint32_t shard) override;
+  ShardedResult* executeQuery(const SQLString& sql, const std::vector<uint32_t>& shards, int32_t fetchSize) override;
+  ShardedResult* executeQueryOnAll(const SQLString& sql, int32_t fetchSize) override;
+};
+
+/* Query of one shard. The result set is destroyed before its statement, and the statement before the connection */
+struct ShardQuery
+{
+  uint32_t shard;
+  std::unique_ptr<Connection> connection;
+  std::unique_ptr<Statement> statement;
+  std::unique_ptr<ResultSet> resultSet;
+
+  ShardQuery(uint32_t _shard) : shard(_shard) {}
+};
+
+class MariaDbShardedResult final : public sql::ShardedResult
+{
+  std::vector<ShardQuery> queries;
+  std::size_t position= 0;
+
+public:
+  MariaDbShardedResult(std::vector<ShardQuery>& queries);
+  ~MariaDbShardedResult();
+
+  bool next() override;
+  ResultSet* current() override;
+  uint32_t currentShard() override;
+  void close() override;
+};
+
+}
+}
+#endif
@@ -19,11 +19,17 @@
 
 
 #include "MariaDbStatement.h"
+#include "protocol/MasterProtocol.h"
 
 #include "SqlStates.h"
 #include "ExceptionFactory.h"
 #include "util/Utils.h"
+#include "util/NativeSqlCache.h"
 #include "Results.h"
+#include "MariaDbAsyncExecution.h"
+#include "util/TimerWheel.h"
+#include "util/MetricsRecorder.h"
+#include "util/ResultCache.h"
 
 namespace sql
 {
@@ -60,13 +66,15 @@ namespace mariadb
     :
       connection(_connection),
       protocol(_connection->getProtocol()),
+      directProtocol(dynamic_cast<MasterProtocol*>(protocol.get())),
       lock(_connection->lock),
       resultSetScrollType(_resultSetScrollType),
       resultSetConcurrency(_resultSetConcurrency),
       options(protocol->getOptions()),
-      canUseServerTimeout(_connection->canUseServerTimeout()),
+      canUseServerTimeout(_connection->canUseServerTimeout() && !options->clientQueryTimeout),
       exceptionFactory(factory),
       fetchSize(options->defaultFetchSize),
+      fetchBytes(static_cast<std::size_t>(options->defaultFetchBytes)),
       batchRes(0),
       largeBatchRes(0)
   {
@@ -91,6 +99,7 @@ namespace mariadb
     Shared::ExceptionFactory ef(ExceptionFactory::of(this->exceptionFactory->getThreadId(), this->exceptionFactory->getOptions()));
     MariaDbStatement* clone= new MariaDbStatement(connection, this->resultSetScrollType, this->resultSetConcurrency, ef);
     clone->fetchSize= this->options->defaultFetchSize;
+    clone->fetchBytes= static_cast<std::size_t>(this->options->defaultFetchBytes);
 
     return clone;
   }
@@ -98,36 +107,28 @@ namespace mariadb
 
   MariaDbStatement::~MariaDbStatement()
   {
+    stopTimeoutTask();
     if (results) {
       results->loadFully(true, protocol.get());
     }
   }
 
-  // Part of query prolog - setup timeout timer
-  void MariaDbStatement::setTimerTask(bool /*isBatch*/)
+  // Part of query prolog - setup timeout timer. Timer of the batch only interrupts it between queries
+  void MariaDbStatement::setTimerTask(bool isBatch)
   {
-#ifdef MAYBE_IN_NEXTVERSION
-    assert(!timerTaskFuture);
-    if (!timeoutScheduler)
-    {
-      timeoutScheduler= SchedulerServiceProviderHolder::getTimeoutScheduler();
-    }
-    timerTaskFuture =
-      timeoutScheduler.schedule(
-          ()->{
-          try {
-          isTimedout= true;
-          if (!isBatch){
+    stopTimeoutTask();
+    isTimedout= false;
+    timerTask= TimerWheel::getInstance().schedule(std::chrono::milliseconds(queryTimeoutMs), [this, isBatch]() {
+      isTimedout= true;
+      try {
+        if (!isBatch) {
           protocol->cancelCurrentQuery();
-          }
-          protocol->interrupt();
-          }catch (std::exception& e){
-
-          }
-          },
-          queryTimeout,
-          TimeUnit::SECONDS);
-#endif
+        }
+        protocol->interrupt();
+      }
+      catch (std::exception&) {
+      }
+    });
   }
 
   /**
@@ -147,31 +148,25 @@ namespace mariadb
       exceptionFactory->raiseStatementError(connection, this)->create("execute() is called on closed statement").Throw();
     }
     protocol->prolog(maxRows, protocol->getProxy(), connection, this);
-    if (queryTimeout != 0 &&(!canUseServerTimeout ||isBatch)) {
+    if (queryTimeoutMs != 0 && (!useServerTimeout() || isBatch)) {
       setTimerTask(isBatch);
     }
   }
 
-
-  void MariaDbStatement::stopTimeoutTask()
+  /* Tells if the query timeout is enforced by the server with max_statement_time, rather than by the client side
+     deadline. Server timeout has seconds precision */
+  bool MariaDbStatement::useServerTimeout()
   {
-#ifdef MAYBE_IN_NEXTVERSION
-    if (timerTaskFuture){
-      if (!timerTaskFuture.cancel(true)){
-
-
-        try {
-          timerTaskFuture.get();
-        }catch (InterruptedException& e){
+    return canUseServerTimeout && queryTimeoutMs % 1000 == 0;
+  }
 
-          Thread.currentThread().interrupt();
-        }catch (InterruptedException& e){
 
-        }
-      }
-      timerTaskFuture= NULL;
+  void MariaDbStatement::stopTimeoutTask()
+  {
+    if (timerTask != 0) {
+      TimerWheel::getInstance().cancel(timerTask);
+      timerTask= 0;
     }
-#endif
   }
 
   /**
@@ -182,6 +177,7 @@ namespace mariadb
    */
   MariaDBExceptionThrower MariaDbStatement::executeExceptionEpilogue(SQLException& sqle)
   {
+    setExecutingFlag(false);
     if (!sqle.getSQLState().empty() && sqle.getSQLState().startsWith("08")) {
       try {
         close();
@@ -208,18 +204,45 @@ namespace mariadb
     return sqlException;
   }
 
+  /* Puts into the error the exception, that executeExceptionEpilogue returns */
+  void MariaDbStatement::executeExceptionEpilogue(SQLException& sqle, ErrorInfo& error)
+  {
+    MariaDBExceptionThrower sqlException(executeExceptionEpilogue(sqle));
+    ExceptionFactory::toErrorInfo(*sqlException.getException(), error);
+  }
 
+  /* Tells if the error, returned by the non-throwing execution, is not returned as is, but has to be given the
+     exception's way, i.e. it is timeout, the connection error, or the error, that has to be explained */
+  bool MariaDbStatement::needsExceptionEpilogue(const ErrorInfo& error)
+  {
+    return isTimedout || error.sqlState.startsWith("08") || (error.errorCode == 1148 && !options->allowLocalInfile);
+  }
+
+  /**
+   * Counterpart of executeExceptionEpilogue for the error, returned by the non-throwing execution. Has to be called
+   * without the lock.
+   *
+   * @param error the error of the server
+   */
+  void MariaDbStatement::executeErrorEpilogue(ErrorInfo& error)
+  {
+    if (needsExceptionEpilogue(error)) {
+      SQLException sqle(error.message.c_str(), error.sqlState.c_str(), error.errorCode);
+      executeExceptionEpilogue(sqle, error);
+    }
+  }
+
+
+  /* isTimedout is kept, so the exception epilogue may report the timeout. It's reset when the timer is set next time */
   void MariaDbStatement::executeEpilogue()
   {
     stopTimeoutTask();
-    isTimedout= false;
     setExecutingFlag(false);
   }
 
   void MariaDbStatement::executeBatchEpilogue(){
     setExecutingFlag(false);
     stopTimeoutTask();
-    isTimedout= false;
     clearBatch();
   }
 
@@ -244,6 +267,8 @@ namespace mariadb
 
   BatchUpdateException MariaDbStatement::executeBatchExceptionEpilogue(SQLException& initialSqle, std::size_t size)
   {
+    // Prepared statements batches come here without the batch epilogue
+    stopTimeoutTask();
     MariaDBExceptionThrower sqle(handleFailoverAndTimeout(initialSqle));
 
     /* It does not make any sense to fill these arrays really - application won't see it since the exception will be thrown */
@@ -266,6 +291,42 @@ namespace mariadb
     return BatchUpdateException(sqle2.getException()->getMessage(), sqle2.getException()->getSQLState(), sqle2.getException()->getErrorCode());//, ret, &sqle2); //MAYBE_IN_NEXTVERSION
   }
 
+  /**
+   * Tells if the query may be executed once more on a new connection, if the connection is lost during its execution.
+   * Has to be checked before the execution, as it depends on the transaction state.
+   *
+   * @param sql the query
+   * @return true if retryOnFailover is on, the connection is in autocommit mode outside of transaction, and the query
+   *     is a read, or the statement is marked retryable
+   */
+  bool MariaDbStatement::mayRetryOnFailover(const SQLString& sql)
+  {
+    return options->retryOnFailover && protocol->getAutocommit() && !protocol->inTransaction()
+      && (retryable || Utils::isReadQuery(sql));
+  }
+
+  /**
+   * Reconnects, if the error means, that the connection has been lost, and the execution may be retried.
+   *
+   * @param sqle execution error
+   * @param mayRetry result of mayRetryOnFailover before the execution
+   * @return true if the new connection is ready, and the execution has to be repeated
+   */
+  bool MariaDbStatement::failoverForRetry(SQLException& sqle, bool mayRetry)
+  {
+    if (!mayRetry) {
+      return false;
+    }
+    switch (sqle.getErrorCode()) {
+    case 2006: // Server has gone away
+    case 2013: // Lost connection during query
+    case 2055: // Lost connection at some system call
+      return protocol->failover();
+    default:
+      return false;
+    }
+  }
+
   /**
    * Executes a query.
    *
@@ -273,18 +334,88 @@ namespace mariadb
    * @param fetchSize fetch size
    * @param autoGeneratedKeys a flag indicating whether auto-generated keys should be returned; one
    *     of <code>Statement::RETURN_GENERATED_KEYS</code> or <code>Statement::NO_GENERATED_KEYS</code>
+   * @param isRetry true if this is the repeated execution after failover
+   * @param error if not null, the error is put there instead of being thrown
    * @return true if there was a result set, false otherwise.
    * @throws SQLException the error description
    */
-  bool MariaDbStatement::executeInternal(const SQLString& sql, int32_t fetchSize, int32_t autoGeneratedKeys)
+  /**
+   * Sends the query with the protocol of the given type. Instantiated for the MasterProtocol, the calls are
+   * not virtual, and for the Protocol interface, when the protocol is behind a proxy.
+   *
+   * @return false if the error was put to the error info
+   */
+  template <class ProtocolType>
+  bool MariaDbStatement::sendQuery(ProtocolType& executor, const SQLString& sql, ErrorInfo* error)
   {
-    std::unique_lock<std::mutex> localScopeLock(*lock);
+    if (error == nullptr) {
+      executor.executeQuery(executor.isMasterConnection(), results, sql);
+      return true;
+    }
+    return executor.tryExecuteQuery(executor.isMasterConnection(), results, sql, *error);
+  }
+
+
+  bool MariaDbStatement::executeInternal(const SQLString& sql, int32_t fetchSize, int32_t autoGeneratedKeys, bool isRetry,
+    ErrorInfo* error)
+  {
+    std::unique_lock<ConnectionMutex> localScopeLock(*lock);
+    bool mayRetry= !isRetry && mayRetryOnFailover(sql);
+    SQLString nativeSql;
 
     try {
-      std::vector<Shared::ParameterHolder> dummy;
       executeQueryPrologue(false);
-      results.reset(
-        new Results(
+      newInternalResults(this, fetchSize, autoGeneratedKeys, sql);
+
+      const SQLString& query= getTimeoutSql(getNativeSql(sql, nativeSql), nativeSql);
+      if (!(directProtocol != nullptr ? sendQuery(*directProtocol, query, error) : sendQuery(*protocol, query, error))) {
+        executeEpilogue();
+        localScopeLock.unlock();
+        executeErrorEpilogue(*error);
+        return false;
+      }
+
+      results->commandEnd();
+      executeEpilogue();
+      return results->getResultSet() != nullptr;
+    }
+    catch (SQLException& exception)
+    {
+      executeEpilogue();
+      localScopeLock.unlock();
+      if (failoverForRetry(exception, mayRetry)) {
+        return executeInternal(sql, fetchSize, autoGeneratedKeys, true, error);
+      }
+      if ((exception.getSQLState().compare("70100") == 0 && 1927 == exception.getErrorCode()) || 2013 == exception.getErrorCode()) {
+        
+        protocol->handleIoException(exception, true);
+      }
+      if (error != nullptr) {
+        executeExceptionEpilogue(exception, *error);
+        return false;
+      }
+      executeExceptionEpilogue(exception).Throw();
+    }
+    return false;
+  }
+
+  /**
+   * Starts non-blocking execution of the query. The execution is driven then by the application with the returned
+   * handle, until it's done. After that results are available the same way as after execute()
+   *
+   * @param sql any SQL statement
+   * @return handle of the execution
+   * @throws SQLException if the query could not be sent to server
+   */
+  AsyncExecution* MariaDbStatement::executeAsync(const SQLString& sql)
+  {
+    std::unique_lock<ConnectionMutex> localScopeLock(*lock);
+    int32_t waitStatus= 0;
+    SQLString nativeSql;
+
+    try {
+      executeQueryPrologue(false);
+      results= std::make_shared<Results>(
             this,
             fetchSize,
             false,
@@ -292,13 +423,94 @@ namespace mariadb
             false,
             resultSetScrollType,
             resultSetConcurrency,
-            autoGeneratedKeys,
+            Statement::NO_GENERATED_KEYS,
             protocol->getAutoIncrementIncrement(),
-            sql,
-            dummy));
+            sql);
+
+      waitStatus= protocol->executeQueryAsyncStart(getTimeoutSql(getNativeSql(sql, nativeSql), nativeSql));
+    }
+    catch (SQLException& exception)
+    {
+      executeEpilogue();
+      localScopeLock.unlock();
+      executeExceptionEpilogue(exception).Throw();
+    }
+    localScopeLock.unlock();
+    return new MariaDbAsyncExecution(this, protocol, waitStatus);
+  }
+
+
+  /**
+   * Executes queries in pipeline - all are sent first, and then all results are read. Results of each query go to
+   * its own results object.
+   *
+   * @param queries queries to execute
+   * @param pipelineResults vector to fill with results objects, one per query
+   * @throws SQLException the error of the first failed query
+   */
+  void MariaDbStatement::executePipeline(const std::vector<SQLString>& queries, std::vector<Shared::Results>& pipelineResults)
+  {
+    std::unique_lock<ConnectionMutex> localScopeLock(*lock);
+
+    try {
+      executeQueryPrologue(false);
+      pipelineResults.clear();
+      pipelineResults.reserve(queries.size());
+      for (auto& sql : queries) {
+        // Result has to be read completely before the next one - no streaming here
+        pipelineResults.emplace_back(
+          std::make_shared<Results>(
+              this,
+              0,
+              false,
+              1,
+              false,
+              resultSetScrollType,
+              resultSetConcurrency,
+              Statement::NO_GENERATED_KEYS,
+              protocol->getAutoIncrementIncrement(),
+              sql));
+      }
+      protocol->executePipeline(pipelineResults, queries);
+
+      for (auto& it : pipelineResults) {
+        it->commandEnd();
+      }
+      executeEpilogue();
+    }
+    catch (SQLException& exception)
+    {
+      for (auto& it : pipelineResults) {
+        it->commandEnd();
+      }
+      executeEpilogue();
+      localScopeLock.unlock();
+      executeExceptionEpilogue(exception).Throw();
+    }
+  }
 
-      protocol->executeQuery(protocol->isMasterConnection(), results, getTimeoutSql(Utils::nativeSql(sql, protocol.get())));
 
+  int32_t MariaDbStatement::executeAsyncContinue(int32_t readyEvents)
+  {
+    std::unique_lock<ConnectionMutex> localScopeLock(*lock);
+    try {
+      return protocol->executeQueryAsyncContinue(readyEvents);
+    }
+    catch (SQLException& exception)
+    {
+      executeEpilogue();
+      localScopeLock.unlock();
+      executeExceptionEpilogue(exception).Throw();
+    }
+    return 0;
+  }
+
+  /* Reads the result of the query, that has been executed asynchronously */
+  bool MariaDbStatement::executeAsyncEnd()
+  {
+    std::unique_lock<ConnectionMutex> localScopeLock(*lock);
+    try {
+      protocol->getResult(results.get());
       results->commandEnd();
       executeEpilogue();
       return results->getResultSet() != nullptr;
@@ -307,10 +519,6 @@ namespace mariadb
     {
       executeEpilogue();
       localScopeLock.unlock();
-      if ((exception.getSQLState().compare("70100") == 0 && 1927 == exception.getErrorCode()) || 2013 == exception.getErrorCode()) {
-        
-        protocol->handleIoException(exception, true);
-      }
       executeExceptionEpilogue(exception).Throw();
     }
     return false;
@@ -415,10 +623,23 @@ namespace mariadb
   }
 
 
-  SQLString MariaDbStatement::getTimeoutSql(const SQLString& sql)
+  /* Returns the query with JDBC escapes rewritten, or the query itself, if it has none or the escape processing is
+     off. The buffer keeps the rewritten query, and has to live while the result is used */
+  const SQLString& MariaDbStatement::getNativeSql(const SQLString& sql, SQLString& buffer)
+  {
+    if (!escapeProcessing || !Utils::hasEscapes(sql)) {
+      return sql;
+    }
+    buffer= NativeSqlCache::getInstance().get(sql, protocol.get(), static_cast<std::size_t>(options->parsedQueryCacheSize));
+    return buffer;
+  }
+
+  /* The sql may be the buffer itself */
+  const SQLString& MariaDbStatement::getTimeoutSql(const SQLString& sql, SQLString& buffer)
   {
-    if (queryTimeout > 0 && canUseServerTimeout) {
-      return "SET STATEMENT max_statement_time="+ std::to_string(queryTimeout) +" FOR "+ sql;
+    if (queryTimeout > 0 && useServerTimeout()) {
+      buffer= "SET STATEMENT max_statement_time="+ std::to_string(queryTimeout) +" FOR "+ sql;
+      return buffer;
     }
     return sql;
   }
@@ -433,11 +654,11 @@ namespace mariadb
    */
   bool MariaDbStatement::testExecute(const SQLString& sql, const Charset& charset)
   {
-    std::lock_guard<std::mutex> localScopeLock(*lock);
+    std::lock_guard<ConnectionMutex> localScopeLock(*lock);
+    SQLString nativeSql;
     try {
-      std::vector<Shared::ParameterHolder> dummy;
       executeQueryPrologue(false);
-      results.reset(new Results(
+      results= std::make_shared<Results>(
             this,
             fetchSize,
             false,
@@ -447,13 +668,12 @@ namespace mariadb
             resultSetConcurrency,
             Statement::NO_GENERATED_KEYS,
             protocol->getAutoIncrementIncrement(),
-            sql,
-            dummy));
+            sql);
 
       protocol->executeQuery(
           protocol->isMasterConnection(),
           results,
-          getTimeoutSql(Utils::nativeSql(sql, protocol.get())),
+          getTimeoutSql(getNativeSql(sql, nativeSql), nativeSql),
           &charset);
 
       results->commandEnd();
@@ -480,6 +700,22 @@ namespace mariadb
     return executeInternal(sql, fetchSize, Statement::NO_GENERATED_KEYS);
   }
 
+  /**
+   * Non-throwing execute. The error of the server is returned without an exception created for it, other errors are
+   * caught and put into the error.
+   *
+   * @param sql the query
+   * @param error the error, if the execution has failed
+   * @return true if the query has been executed. Results are available the same way as after execute()
+   */
+  bool MariaDbStatement::tryExecute(const SQLString& sql, ErrorInfo& error) noexcept
+  {
+    error.clear();
+    return ExceptionFactory::catchInto(error, [this, &sql, &error]() {
+        executeInternal(sql, fetchSize, Statement::NO_GENERATED_KEYS, false, &error);
+      }) && !error.failed();
+  }
+
   /**
    * Executes the given SQL statement, which may return multiple results, and signals the driver
    * that any auto-generated keys should be made available for retrieval. The driver will ignore
@@ -588,6 +824,17 @@ namespace mariadb
    * @throws SQLException if something went wrong
    */
   ResultSet* MariaDbStatement::executeQuery(const SQLString& sql) {
+    int64_t ttl= resultCacheTtlFor(sql);
+
+    if (ttl > 0) {
+      return ResultCache::getInstance().query(protocol.get(), ResultCache::key(protocol.get(), sql), ttl,
+        [this, &sql]() -> ResultSet* {
+          if (executeInternal(sql, fetchSize, Statement::NO_GENERATED_KEYS)) {
+            return results->releaseResultSet();
+          }
+          return SelectResultSet::createEmptyResultSet();
+        });
+    }
     if (executeInternal(sql,fetchSize,Statement::NO_GENERATED_KEYS)){
       return results->releaseResultSet();
     }
@@ -602,7 +849,7 @@ namespace mariadb
    * @throws SQLException if the query could not be sent to server.
    */
   int32_t MariaDbStatement::executeUpdate(const SQLString& sql) {
-    if (executeInternal(sql,fetchSize,Statement::NO_GENERATED_KEYS)){
+    if (executeScalarInternal(sql, Statement::NO_GENERATED_KEYS)){
       throw SQLException("executeUpdate should not be used for queries returning a resultset");
     }
     return getUpdateCount();
@@ -629,7 +876,7 @@ namespace mariadb
    */
   int32_t MariaDbStatement::executeUpdate(const SQLString& sql, int32_t autoGeneratedKeys)
   {
-    if (executeInternal(sql,fetchSize,autoGeneratedKeys))
+    if (executeScalarInternal(sql, autoGeneratedKeys))
     {
       throw SQLException("executeUpdate should not be used for queries returning a resultset");
     }
@@ -687,7 +934,7 @@ namespace mariadb
 
 
   int64_t MariaDbStatement::executeLargeUpdate(const SQLString& sql) {
-    if (executeInternal(sql,fetchSize,Statement::NO_GENERATED_KEYS)){
+    if (executeScalarInternal(sql, Statement::NO_GENERATED_KEYS)){
       throw SQLException("executeLargeUpdate should not be used for queries returning a resultset");
     }
     return getLargeUpdateCount();
@@ -695,7 +942,7 @@ namespace mariadb
 
 
   int64_t MariaDbStatement::executeLargeUpdate(const SQLString& sql, int32_t autoGeneratedKeys) {
-    if (executeInternal(sql, fetchSize, autoGeneratedKeys)){
+    if (executeScalarInternal(sql, autoGeneratedKeys)){
       return 0;
     }
     return getLargeUpdateCount();
@@ -711,6 +958,56 @@ namespace mariadb
     return executeLargeUpdate(sql, Statement::RETURN_GENERATED_KEYS);
   }
 
+  /**
+   * Executes the query with the result set, if the query returns one, read as the scalar value - only the first
+   * value is taken, the rest is skipped as it is read. Used by executeUpdate too, as it does not need the rows.
+   *
+   * @param sql the query
+   * @param autoGeneratedKeys generated keys flag
+   * @return true if the query has returned a result set
+   */
+  bool MariaDbStatement::executeScalarInternal(const SQLString& sql, int32_t autoGeneratedKeys)
+  {
+    scalarOnly= true;
+    try {
+      executeInternal(sql, 0, autoGeneratedKeys);
+    }
+    catch (...) {
+      scalarOnly= false;
+      throw;
+    }
+    scalarOnly= false;
+    return results->hasScalar();
+  }
+
+  /**
+   * Executes the query, and reads the value of the first column of the first row right off the connection.
+   *
+   * @param sql the query
+   * @param value the value
+   * @return false, if there was no row, or the value is NULL
+   * @throws SQLException if the query failed, or the value cannot be converted
+   */
+  bool MariaDbStatement::executeScalar(const SQLString& sql, int64_t& value)
+  {
+    executeScalarInternal(sql, Statement::NO_GENERATED_KEYS);
+    return results->getScalar(value);
+  }
+
+
+  bool MariaDbStatement::executeScalar(const SQLString& sql, double& value)
+  {
+    executeScalarInternal(sql, Statement::NO_GENERATED_KEYS);
+    return results->getScalar(value);
+  }
+
+
+  bool MariaDbStatement::executeScalar(const SQLString& sql, SQLString& value)
+  {
+    executeScalarInternal(sql, Statement::NO_GENERATED_KEYS);
+    return results->getScalar(value);
+  }
+
   /**
    * Releases this <code>Statement</code> object's database and JDBC resources immediately instead
    * of waiting for this to happen when it is automatically closed. It is generally good practice to
@@ -723,7 +1020,7 @@ namespace mariadb
    */
   void MariaDbStatement::close()
   {
-    std::lock_guard<std::mutex> localScopeLock(*lock);
+    std::lock_guard<ConnectionMutex> localScopeLock(*lock);
 
     try {
       closed = true;
@@ -835,8 +1132,41 @@ namespace mariadb
    *
    * @param enable <code>true</code> to enable escape processing; <code>false</code> to disable it
    */
-  void MariaDbStatement::setEscapeProcessing(bool /*enable*/){
-    // not handled
+  void MariaDbStatement::setEscapeProcessing(bool enable){
+    escapeProcessing= enable;
+  }
+
+  /**
+   * Marks the statement as idempotent, i.e. safe to execute once more on a new connection, if the connection has been
+   * lost during the execution in autocommit mode outside of transaction. Has effect only if retryOnFailover option is
+   * set. Reads are retried regardless of this flag.
+   *
+   * @param retryable <code>true</code> if the statement may be executed again
+   */
+  void MariaDbStatement::setRetryable(bool retryable){
+    this->retryable= retryable;
+  }
+
+  bool MariaDbStatement::isRetryable(){
+    return retryable;
+  }
+
+  void MariaDbStatement::setResultCacheTtl(int64_t milliseconds){
+    if (milliseconds < 0) {
+      throw SQLException("Result cache TTL cannot be negative");
+    }
+    resultCacheTtl= milliseconds;
+  }
+
+  int64_t MariaDbStatement::getResultCacheTtl(){
+    return resultCacheTtl;
+  }
+
+  int64_t MariaDbStatement::resultCacheTtlFor(const SQLString& sql){
+    if (!ResultCache::isEnabled()) {
+      return 0;
+    }
+    return resultCacheTtl > 0 ? resultCacheTtl : ResultCache::hintTtl(sql);
   }
 
   /**
@@ -867,6 +1197,33 @@ namespace mariadb
         "Query timeout value cannot be negative : asked for " + std::to_string(seconds)).Throw();
     }
     this->queryTimeout= seconds;
+    this->queryTimeoutMs= static_cast<int64_t>(seconds)*1000;
+  }
+
+  /**
+   * Retrieves the number of milliseconds the driver will wait for a <code>Statement</code> object to execute.
+   *
+   * @return the current query timeout limit in milliseconds; zero means there is no limit
+   */
+  int64_t MariaDbStatement::getQueryTimeoutMs(){
+    return queryTimeoutMs;
+  }
+
+  /**
+   * Sets the query timeout in milliseconds. Timeout, that is not whole seconds, is enforced with the client side
+   * deadline, that cancels the query with KILL QUERY, since the server timeout has seconds precision.
+   * getQueryTimeout returns then the timeout rounded up to seconds.
+   *
+   * @param milliseconds the new query timeout limit in milliseconds; zero means there is no limit
+   * @throws SQLException if the value is negative
+   */
+  void MariaDbStatement::setQueryTimeoutMs(int64_t milliseconds) {
+    if (milliseconds < 0){
+      exceptionFactory->raiseStatementError(connection, this)->create(
+        "Query timeout value cannot be negative : asked for " + std::to_string(milliseconds)).Throw();
+    }
+    this->queryTimeoutMs= milliseconds;
+    this->queryTimeout= static_cast<int32_t>((milliseconds + 999)/1000);
   }
 
   /**
@@ -1015,6 +1372,12 @@ namespace mariadb
     return SelectResultSet::createEmptyResultSet();
   }
 
+
+  int64_t MariaDbStatement::getLastInsertId()
+  {
+    return results ? results->getLastInsertId() : 0;
+  }
+
   /**
    * Retrieves the result set holdability for <code>ResultSet</code> objects generated by this
    * <code>Statement</code> object.
@@ -1148,6 +1511,12 @@ namespace mariadb
     return results && results->getMoreResults(current, protocol.get());
   }
 
+
+  bool MariaDbStatement::skipResults(int32_t count) {
+    checkClose();
+    return results && results->skipResults(count, protocol.get());
+  }
+
   /**
    * Retrieves the direction for fetching rows from database tables that is the default for result
    * sets generated from this <code>Statement</code> object. If this <code>Statement</code> object
@@ -1218,6 +1587,18 @@ namespace mariadb
     this->fetchSize= rows;
   }
 
+
+  std::size_t MariaDbStatement::getFetchBytes()
+  {
+    return fetchBytes;
+  }
+
+
+  void MariaDbStatement::setFetchBytes(std::size_t bytes)
+  {
+    fetchBytes= bytes;
+  }
+
   /**
    * Retrieves the result set concurrency for <code>ResultSet</code> objects generated by this
    * <code>Statement</code> object.
@@ -1303,7 +1684,7 @@ namespace mariadb
       return batchRes;
     }
 
-    std::unique_lock<std::mutex> localScopeLock(*lock);
+    std::unique_lock<ConnectionMutex> localScopeLock(*lock);
     try
     {
       internalBatchExecution(size);
@@ -1331,7 +1712,7 @@ namespace mariadb
       return largeBatchRes;
     }
 
-    std::unique_lock<std::mutex> localScopeLock(*lock);
+    std::unique_lock<ConnectionMutex> localScopeLock(*lock);
     try
     {
       internalBatchExecution(size);
@@ -1350,6 +1731,36 @@ namespace mariadb
     return largeBatchRes;
   }
 
+
+  void MariaDbStatement::getBatchUpdateCounts(const int64_t*& counts, std::size_t& size)
+  {
+    const int64_t* ids;
+    int32_t increment;
+    getBatchResults(counts, ids, size, increment);
+  }
+
+
+  void MariaDbStatement::getBatchInsertIds(const int64_t*& ids, std::size_t& size, int32_t& increment)
+  {
+    const int64_t* counts;
+    getBatchResults(counts, ids, size, increment);
+  }
+
+
+  void MariaDbStatement::getBatchResults(const int64_t*& counts, const int64_t*& ids, std::size_t& size,
+    int32_t& increment)
+  {
+    if (results && results->getCmdInformation()) {
+      size= results->getCmdInformation()->getServerResults(counts, ids, increment);
+    }
+    else {
+      counts= nullptr;
+      ids= nullptr;
+      size= 0;
+      increment= 1;
+    }
+  }
+
   /**
    * Internal batch execution.
    *
@@ -1358,9 +1769,8 @@ namespace mariadb
    */
   void MariaDbStatement::internalBatchExecution(std::size_t size)
   {
-    std::vector<Shared::ParameterHolder> dummy;
     executeQueryPrologue(true);
-    results.reset(new Results(
+    results= std::make_shared<Results>(
           this,
           0,
           true,
@@ -1370,8 +1780,7 @@ namespace mariadb
           resultSetConcurrency,
           Statement::RETURN_GENERATED_KEYS,
           protocol->getAutoIncrementIncrement(),
-          NULL,
-          dummy));
+          "");
     protocol->executeBatchStmt(protocol->isMasterConnection(),results,batchQueries);
     results->commandEnd();
   }
@@ -1449,14 +1858,102 @@ namespace mariadb
     return results;
   }
 
-  void MariaDbStatement::setInternalResults(Results* newResults) {
-    results.reset(newResults);
+  void MariaDbStatement::setInternalResults(Shared::Results&& newResults) {
+    results= std::move(newResults);
+  }
+
+
+  Shared::Results& MariaDbStatement::newInternalResults(Statement* owner, int32_t fetchSize, int32_t autoGeneratedKeys,
+    const SQLString& sql)
+  {
+    // Results of server side prepared statements refer to their prepare result
+    if (results && results.use_count() == 1 && results->getStatement() == this && !results->isBinaryFormat()) {
+      results->reset(fetchSize, false, 1, false, resultSetScrollType, resultSetConcurrency, autoGeneratedKeys,
+        protocol->getAutoIncrementIncrement(), sql);
+    }
+    else {
+      results= std::make_shared<Results>(
+            owner,
+            fetchSize,
+            false,
+            1,
+            false,
+            resultSetScrollType,
+            resultSetConcurrency,
+            autoGeneratedKeys,
+            protocol->getAutoIncrementIncrement(),
+            sql);
+    }
+    results->setScalarOnly(scalarOnly);
+    return results;
   }
 
+  /* Execution time is measured between setting and clearing of the flag, and goes to the connection's metrics. Setting
+     the flag starts the new execution for getWarnings too */
   void MariaDbStatement::setExecutingFlag(bool _set) {
+    if (_set) {
+      executionStart= std::chrono::steady_clock::now();
+      warningsCleared= false;
+      if (protocol) {
+        markCounters(executionMarks);
+      }
+    }
+    else if (executing && protocol) {
+      uint64_t elapsed= static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - executionStart).count());
+      protocol->getMetrics().executionTime.record(elapsed / 1000);
+      setExecutionStats(elapsed);
+    }
     executing= _set;
   }
 
+
+  void MariaDbStatement::markCounters(CounterMarks& marks)
+  {
+    const MetricsRecorder& metrics= protocol->getMetrics();
+
+    marks.roundTrips= metrics.roundTrips.load(std::memory_order_relaxed);
+    marks.bytesSent= metrics.bytesSent.load(std::memory_order_relaxed);
+    marks.bytesReceived= metrics.bytesReceived.load(std::memory_order_relaxed);
+    marks.rowsFetched= metrics.rowsFetched.load(std::memory_order_relaxed);
+    marks.prepares= metrics.prepares.load(std::memory_order_relaxed);
+    marks.executes= metrics.executes.load(std::memory_order_relaxed);
+    marks.bulkExecutes= metrics.bulkExecutes.load(std::memory_order_relaxed);
+    marks.networkTime= metrics.networkTime.load(std::memory_order_relaxed);
+    marks.decodeTime= metrics.decodeTime.load(std::memory_order_relaxed);
+  }
+
+  /* The execution's share of the connection's counters. The connection executes one statement at a time, and
+     everything counted meanwhile belongs to it */
+  void MariaDbStatement::setExecutionStats(uint64_t elapsed)
+  {
+    CounterMarks end;
+    ExecutionStats& stats= lastExecutionStats;
+
+    markCounters(end);
+    uint64_t network= end.networkTime - executionMarks.networkTime;
+    uint64_t decode= end.decodeTime - executionMarks.decodeTime;
+
+    stats.totalTime= elapsed / 1000;
+    stats.networkTime= network / 1000;
+    stats.decodeTime= decode / 1000;
+    stats.encodeTime= elapsed > network + decode ? (elapsed - network - decode) / 1000 : 0;
+    stats.bytesSent= end.bytesSent - executionMarks.bytesSent;
+    stats.bytesReceived= end.bytesReceived - executionMarks.bytesReceived;
+    stats.rows= end.rowsFetched - executionMarks.rowsFetched;
+    stats.roundTrips= end.roundTrips - executionMarks.roundTrips;
+    stats.prepared= end.executes != executionMarks.executes;
+    stats.cached= stats.prepared && end.prepares == executionMarks.prepares;
+    stats.bulk= end.bulkExecutes != executionMarks.bulkExecutes;
+    stats.rewritten= results && results->isRewritten();
+  }
+
+
+  const ExecutionStats& MariaDbStatement::getLastExecutionStats()
+  {
+    return lastExecutionStats;
+  }
+
   void MariaDbStatement::markClosed()
   {
     closed= true;
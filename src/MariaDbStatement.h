@@ -22,6 +22,7 @@
 #define _MARIADBSTATEMENT_H_
 
 #include <atomic>
+#include <chrono>
 #include <map>
 #include <mutex>
 
@@ -37,8 +38,9 @@ namespace sql
 namespace mariadb
 {
 class MariaDbConnection;
+class MasterProtocol;
 
-class MariaDbStatement : public Statement
+class MariaDbStatement final : public Statement
 {
   static const std::map<std::string,std::string> mapper;
   static Shared::Logger logger ; /*LoggerFactory.getLogger(MariaDbStatement)*/
@@ -51,6 +53,8 @@ protected:
   MariaDbConnection* connection;
   //TODO: possibly it is better to make it weak ptr, and check if it's still available, and gracefully throw exception otherwise
   Shared::Protocol protocol;
+  /* The protocol, if it is not wrapped by a proxy(HA modes, logging), or nullptr. The hot path calls go through it */
+  MasterProtocol* const directProtocol;
   const Shared::mutex lock;
   int32_t resultSetScrollType;
   int32_t resultSetConcurrency;
@@ -60,10 +64,28 @@ protected:
 
   std::atomic<bool> closed{false};
   int32_t queryTimeout= 0;
+  int64_t queryTimeoutMs= 0;
   int64_t maxRows= 0;
   Shared::Results results;
   int32_t fetchSize;
+  std::size_t fetchBytes;
   std::atomic<bool> executing{false};
+  /* For the execution time metrics */
+  std::chrono::steady_clock::time_point executionStart;
+  /* The connection's counters at the start of the execution, and the breakdown of the last execution made of them */
+  struct CounterMarks {
+    uint64_t roundTrips= 0;
+    uint64_t bytesSent= 0;
+    uint64_t bytesReceived= 0;
+    uint64_t rowsFetched= 0;
+    uint64_t prepares= 0;
+    uint64_t executes= 0;
+    uint64_t bulkExecutes= 0;
+    uint64_t networkTime= 0;
+    uint64_t decodeTime= 0;
+  };
+  CounterMarks executionMarks;
+  ExecutionStats lastExecutionStats;
   sql::Ints batchRes;
   sql::Longs largeBatchRes;
 
@@ -77,8 +99,15 @@ private:
 #ifdef MAYBE_IN_NEXTVERSION
   Future<?>timerTaskFuture;
 #endif
-  bool isTimedout= false;
+  std::atomic<bool> isTimedout{false};
+  /* Id of the deadline timer in the TimerWheel, 0 if not set */
+  uint64_t timerTask= 0;
   uint32_t maxFieldSize= 0;
+  bool retryable= false;
+  int64_t resultCacheTtl= 0;
+  bool escapeProcessing= true;
+  /* Makes the next results read the first value of a text result set instead of the result set */
+  bool scalarOnly= false;
 
 public:
   MariaDbStatement(MariaDbConnection* connection, int32_t resultSetScrollType, int32_t resultSetConcurrency, Shared::ExceptionFactory& factory);
@@ -90,23 +119,40 @@ public:
 
 protected:
   void executeQueryPrologue(bool isBatch);
+public:
+  bool useServerTimeout();
 private:
   void stopTimeoutTask();
+  void markCounters(CounterMarks& marks);
+  void setExecutionStats(uint64_t elapsed);
   MariaDBExceptionThrower handleFailoverAndTimeout(SQLException& sqle);
 public://protected:
   void executeEpilogue();
   void executeBatchEpilogue();
   MariaDBExceptionThrower executeExceptionEpilogue(SQLException& sqle);
+  void executeExceptionEpilogue(SQLException& sqle, ErrorInfo& error);
+  bool needsExceptionEpilogue(const ErrorInfo& error);
+  void executeErrorEpilogue(ErrorInfo& error);
   BatchUpdateException executeBatchExceptionEpilogue(SQLException& initialSqle, std::size_t size);
+  bool mayRetryOnFailover(const SQLString& sql);
+  bool failoverForRetry(SQLException& sqle, bool mayRetry);
 private:
-  bool executeInternal(const SQLString& sql,int32_t fetchSize,int32_t autoGeneratedKeys);
+  template <class ProtocolType>
+  bool sendQuery(ProtocolType& executor, const SQLString& sql, ErrorInfo* error);
+  bool executeInternal(const SQLString& sql,int32_t fetchSize,int32_t autoGeneratedKeys, bool isRetry= false,
+    ErrorInfo* error= nullptr);
+  bool executeScalarInternal(const SQLString& sql, int32_t autoGeneratedKeys);
 public:
+  void executePipeline(const std::vector<SQLString>& queries, std::vector<Shared::Results>& pipelineResults);
+  int32_t executeAsyncContinue(int32_t readyEvents);
+  bool executeAsyncEnd();
   SQLString enquoteLiteral(const SQLString& val);
   SQLString enquoteIdentifier(const SQLString& identifier,bool alwaysQuote);
   bool isSimpleIdentifier(const SQLString& identifier);
   SQLString enquoteNCharLiteral(const SQLString& val);
 private:
-  SQLString getTimeoutSql(const SQLString& sql);
+  const SQLString& getNativeSql(const SQLString& sql, SQLString& buffer);
+  const SQLString& getTimeoutSql(const SQLString& sql, SQLString& buffer);
 public:
   bool testExecute(const SQLString& sql, const Charset& charset);
 
@@ -123,6 +169,11 @@ public:
   int64_t executeLargeUpdate(const SQLString& sql, int32_t autoGeneratedKeys);
   int64_t executeLargeUpdate(const SQLString& sql, int32_t* columnIndexes);
   int64_t executeLargeUpdate(const SQLString& sql, const SQLString* columnNames);
+  bool executeScalar(const SQLString& sql, int64_t& value);
+  bool executeScalar(const SQLString& sql, double& value);
+  bool executeScalar(const SQLString& sql, SQLString& value);
+  AsyncExecution* executeAsync(const SQLString& sql);
+  bool tryExecute(const SQLString& sql, ErrorInfo& error) noexcept;
   void close();
   uint32_t getMaxFieldSize();
   void setMaxFieldSize(uint32_t max);
@@ -131,8 +182,16 @@ public:
   int64_t getLargeMaxRows();
   void setLargeMaxRows(int64_t max);
   void setEscapeProcessing(bool enable);
+  void setRetryable(bool retryable);
+  bool isRetryable();
+  void setResultCacheTtl(int64_t milliseconds);
+  int64_t getResultCacheTtl();
+  /* TTL of the statement, or of the query's hint, if the result cache is enabled, or 0 */
+  int64_t resultCacheTtlFor(const SQLString& sql);
   int32_t getQueryTimeout();
   void setQueryTimeout(int32_t seconds);
+  int64_t getQueryTimeoutMs();
+  void setQueryTimeoutMs(int64_t milliseconds);
   void setLocalInfileInputStream(std::istream* inputStream);
   void cancel();
   SQLWarning* getWarnings();
@@ -140,6 +199,7 @@ public:
   void setCursorName(const SQLString& name);
   Connection* getConnection();
   ResultSet* getGeneratedKeys();
+  int64_t getLastInsertId();
   int32_t getResultSetHoldability();
   bool isClosed();
   bool isPoolable();
@@ -147,6 +207,7 @@ public:
   ResultSet* getResultSet();
   int32_t getUpdateCount();
   int64_t getLargeUpdateCount();
+  const ExecutionStats& getLastExecutionStats();
 
 //protected:
   void skipMoreResults();
@@ -154,10 +215,13 @@ public:
 public:
   bool getMoreResults();
   bool getMoreResults(int32_t current);
+  bool skipResults(int32_t count);
   int32_t getFetchDirection();
   void setFetchDirection(int32_t direction);
   int32_t getFetchSize();
   void setFetchSize(int32_t rows);
+  std::size_t getFetchBytes();
+  void setFetchBytes(std::size_t bytes);
   int32_t getResultSetConcurrency();
   int32_t getResultSetType();
   void addBatch(const SQLString& sql);
@@ -165,9 +229,12 @@ public:
 
   const sql::Ints& executeBatch();
   const sql::Longs& executeLargeBatch();
+  void getBatchUpdateCounts(const int64_t*& counts, std::size_t& size);
+  void getBatchInsertIds(const int64_t*& ids, std::size_t& size, int32_t& increment);
 
 private:
   void internalBatchExecution(std::size_t size);
+  void getBatchResults(const int64_t*& counts, const int64_t*& ids, std::size_t& size, int32_t& increment);
 
 public:
   void closeOnCompletion();
@@ -179,7 +246,14 @@ public:
   int64_t getServerThreadId();
   /* TODO: not quite nice to have these public */
   Shared::Results& getInternalResults();
-  void setInternalResults(Results* newResults);
+  void setInternalResults(Shared::Results&& newResults);
+  /* Results for the next single query execution by this statement, or by its owner. The previous ones are recycled,
+     if nothing else refers to them */
+  Shared::Results& newInternalResults(Statement* owner, int32_t fetchSize, int32_t autoGeneratedKeys,
+    const SQLString& sql);
+  /* Makes results of the following executions read only the first value of a text result set, for executeScalar and
+     executeUpdate, that do not need the result set */
+  void setScalarOnly(bool _scalarOnly) { scalarOnly= _scalarOnly; }
   void setExecutingFlag(bool _set= true);
   void markClosed();
   Protocol* getProtocol() { return protocol.get(); }
@@ -29,6 +29,7 @@
 #include "parameters/DateParameter.h"
 #include "parameters/DefaultParameter.h"
 #include "parameters/DoubleParameter.h"
+#include "parameters/FileParameter.h"
 #include "parameters/FloatParameter.h"
 #include "parameters/IntParameter.h"
 #include "parameters/LocalTimeParameter.h"
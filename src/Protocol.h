@@ -30,6 +30,7 @@
 #include "HostAddress.h"
 #include "options/Options.h"
 #include "parameters/ParameterHolder.h"
+#include "ParameterValue.hpp"
 
 namespace sql
 {
@@ -41,6 +42,7 @@ namespace capi
 }
 
 class ServerPrepareResult;
+struct ParameterArray;
 class ClientPrepareResult;
 class FailoverProxy;
 class Results;
@@ -50,6 +52,8 @@ class TimeZone;
 class ServerPrepareStatementCache;
 class MariaDbStatement;
 class FutureTask;
+struct MetricsRecorder;
+class MemoryAccount;
 
 class Protocol
 {
@@ -57,6 +61,7 @@ public:
   virtual ~Protocol() {}
   virtual ServerPrepareResult* prepare(const SQLString& sql, bool executeOnMaster)=0;
   virtual bool getAutocommit()=0;
+  virtual void setAutocommit(bool autocommit)=0;
   virtual bool noBackslashEscapes()=0;
   virtual void connect()=0;
   virtual const UrlParser& getUrlParser() const=0;
@@ -67,9 +72,20 @@ public:
   virtual bool hasMoreResults()=0;
   virtual void close()=0;
   virtual void reset()=0;
+  /* COM_CHANGE_USER. The session state is reset, like with reset() */
+  virtual void changeUser(const SQLString& user, const SQLString& password, const SQLString& database)=0;
   virtual void closeExplicit()=0;
+  /* With pipelineTransactionEnd COMMIT/ROLLBACK is sent with the next command, or by flushTransactionEnd */
+  virtual void deferTransactionEnd(bool commit)=0;
+  virtual void flushTransactionEnd()=0;
+  /* With pipelineSavepoints SAVEPOINT and RELEASE SAVEPOINT are sent with the next command. Releasing the savepoint,
+     that is still deferred, drops it. rollbackDeferredSavepoint returns false, if ROLLBACK TO SAVEPOINT has to be
+     executed, i.e. the savepoint is not deferred anymore */
+  virtual void deferSavepoint(const SQLString& name, bool release)=0;
+  virtual bool rollbackDeferredSavepoint(const SQLString& name)=0;
   virtual bool isClosed()=0;
   virtual void resetDatabase()=0;
+  virtual void resetSessionState(bool autocommit, int32_t transactionIsolationLevel, bool resetDatabase)=0;
   virtual SQLString getCatalog()=0;
   virtual void setCatalog(const SQLString& database)=0;
   virtual const SQLString& getServerVersion() const=0;
@@ -96,14 +112,38 @@ public:
   virtual void executeQuery(bool mustExecuteOnMaster, Shared::Results& results, ClientPrepareResult* clientPrepareResult,
     std::vector<Shared::ParameterHolder>& parameters,
     int32_t timeout)= 0;
+  /* Non-throwing executions. Error of the server is put into the error, and false is returned. Errors of the connection
+     are thrown as usual */
+  virtual bool tryExecuteQuery(bool mustExecuteOnMaster, Shared::Results& results, const SQLString& sql, ErrorInfo& error)= 0;
+  virtual bool tryExecuteQuery(bool mustExecuteOnMaster, Shared::Results& results, ClientPrepareResult* clientPrepareResult,
+    std::vector<Shared::ParameterHolder>& parameters, int32_t timeout, ErrorInfo& error)= 0;
+  /* Non-blocking execution. Return events to wait for, 0 when the query is done. Result is read with getResult() */
+  virtual void executePipeline(std::vector<Shared::Results>& results, const std::vector<SQLString>& queries)=0;
+  virtual int32_t executeQueryAsyncStart(const SQLString& sql)=0;
+  virtual int32_t executeQueryAsyncContinue(int32_t readyEvents)=0;
+  virtual int64_t getNativeSocket()=0;
+  virtual uint32_t getAsyncTimeout()=0;
 
   virtual bool executeBatchClient(bool mustExecuteOnMaster, Shared::Results& results, ClientPrepareResult* prepareResult,
     std::vector<std::vector<Shared::ParameterHolder>>& parametersList, bool hasLongData)=0;
   virtual void executeBatchStmt(bool mustExecuteOnMaster, Shared::Results& results, const std::vector<SQLString>& queries)= 0;
+  /* Executes the rows encoded at addBatch time as the multi-values queries */
+  virtual void executeBatchEncoded(Shared::Results& results, ClientPrepareResult* prepareResult, const EncodedBatch& batch)=0;
   virtual void executePreparedQuery(bool mustExecuteOnMaster, ServerPrepareResult* serverPrepareResult, Shared::Results& results,
     std::vector<Shared::ParameterHolder>& parameters)= 0;
+  /* Execution with the values of PreparedStatement::executeWith, one per parameter, bound as they are */
+  virtual void executePreparedQuery(bool mustExecuteOnMaster, ServerPrepareResult* serverPrepareResult, Shared::Results& results,
+    const ParameterValue* values)= 0;
+  virtual bool tryExecutePreparedQuery(bool mustExecuteOnMaster, ServerPrepareResult* serverPrepareResult, Shared::Results& results,
+    std::vector<Shared::ParameterHolder>& parameters, ErrorInfo& error)= 0;
+  virtual ServerPrepareResult* prepareAndExecute(const SQLString& sql, Shared::Results& results,
+    std::vector<Shared::ParameterHolder>& parameters)= 0;
   virtual bool executeBatchServer(bool mustExecuteOnMaster, ServerPrepareResult* serverPrepareResult, Shared::Results& results, const SQLString& sql,
                                   std::vector<std::vector<Shared::ParameterHolder>>& parameterList, bool hasLongData)= 0;
+  virtual void executeBatchArrays(ServerPrepareResult* serverPrepareResult, Shared::Results& results,
+                                  const std::vector<ParameterArray>& arrays, uint32_t rows)= 0;
+  virtual int64_t executeBulkLoad(const SQLString& table, const SQLString* columns, std::size_t columnCount,
+                                  RowProducer& producer)= 0;
 
   virtual void moveToNextResult(Results* results, ServerPrepareResult* spr= nullptr)=0;
   virtual void getResult(Results* results, ServerPrepareResult *pr=nullptr, bool readAllResults= false)=0;
@@ -130,10 +170,13 @@ public:
   virtual void connectWithoutProxy()=0;
   virtual bool shouldReconnectWithoutProxy()=0;
   virtual void setHostFailedWithoutProxy()=0;
-  virtual void releasePrepareStatement(ServerPrepareResult* serverPrepareResult)=0;
+  virtual bool releasePrepareStatement(ServerPrepareResult* serverPrepareResult)=0;
   virtual bool forceReleasePrepareStatement(capi::MYSQL_STMT* statementId)=0;
   virtual void forceReleaseWaitingPrepareStatement()=0;
   virtual ServerPrepareStatementCache* prepareStatementCache()=0;
+  /* Prepares and caches again up to maxCount statements of the given prepared statements cache keys, that belong to
+     the current database. Failed statements are skipped */
+  virtual void prepareCachedQueries(const std::vector<SQLString>& keys, std::size_t maxCount)=0;
   virtual TimeZone* getTimeZone()=0;
   virtual void prolog(int64_t maxRows, bool hasProxy, MariaDbConnection* connection, MariaDbStatement* statement)= 0;
   virtual void prologProxy(ServerPrepareResult* serverPrepareResult, int64_t maxRows, bool hasProxy, MariaDbConnection* connection,
@@ -145,7 +188,7 @@ public:
   virtual uint32_t getServerStatus()=0;
   virtual void removeHasMoreResults()=0;
   virtual void setHasWarnings(bool hasWarnings)=0;
-  virtual ServerPrepareResult* addPrepareInCache(const SQLString& key, ServerPrepareResult* serverPrepareResult)=0;
+  virtual bool addPrepareInCache(const SQLString& key, ServerPrepareResult* serverPrepareResult)=0;
   virtual void readEofPacket()=0;
   virtual void skipEofPacket()=0;
   virtual void changeSocketTcpNoDelay(bool setTcpNoDelay)=0;
@@ -155,11 +198,29 @@ public:
   virtual bool isServerMariaDb()=0;
   virtual void setActiveFutureTask(FutureTask* activeFutureTask)=0;
   virtual MariaDBExceptionThrower handleIoException(std::runtime_error& initialException, bool throwRightAway=true)=0;
+  virtual bool failover()=0;
+  /* Counters of the connection, updated lock-free on the hot path */
+  virtual MetricsRecorder& getMetrics()=0;
+  /* Releases memory kept for reuse - query buffers and cached prepared statements. Done for connections idle in the
+     pool for idleTrimTime */
+  virtual void trimMemory()=0;
+  /* Estimated memory, that the connection object keeps, not counting the C API's handle */
+  virtual std::size_t getMemoryFootprint()=0;
+  /* Number of statements, that multi-send batches keep in flight */
+  virtual std::size_t getBatchWindow()=0;
+  /* GTID of the last transaction the session has written, tracked with readYourWrites. Empty, if it's not known */
+  virtual const SQLString& getLastGtid() const=0;
+  /* Waits up to timeout milliseconds until the server has applied the GTID as the replica. False on timeout */
+  virtual bool waitForGtid(const SQLString& gtid, int32_t timeout)=0;
+  /* Account of the rows stored by the connection's result sets. Shared with them, as they may outlive the protocol */
+  virtual const std::shared_ptr<MemoryAccount>& getMemoryAccount()=0;
   //virtual PacketInputistream* getReader()=0;
   //virtual PacketOutputStream* getWriter()=0;
   virtual bool isEofDeprecated()=0;
   virtual int32_t getAutoIncrementIncrement()=0;
   virtual bool sessionStateAware()=0;
+  /* If true, getTransactionIsolationLevel is kept actual with the session state tracking */
+  virtual bool transactionIsolationTracked()=0;
   virtual SQLString getTraces()=0;
   virtual bool isInterrupted()=0;
   virtual void stopIfInterrupted()=0;
@@ -18,6 +18,9 @@
 *************************************************************************************/
 
 
+#include <cerrno>
+#include <cstdlib>
+
 #include "Results.h"
 
 #include "ExceptionFactory.h"
@@ -57,7 +60,6 @@ namespace mariadb
    *     of <code>Statement.RETURN_GENERATED_KEYS</code> or <code>Statement.NO_GENERATED_KEYS</code>
    * @param autoIncrement Connection auto-increment value
    * @param sql sql command
-   * @param parameters parameters
    */
   Results::Results(
       Statement* _statement,
@@ -69,8 +71,7 @@ namespace mariadb
       int32_t resultSetConcurrency,
       int32_t autoGeneratedKeys,
       int32_t autoIncrement,
-      const SQLString& _sql,
-      std::vector<Shared::ParameterHolder>& _parameters)
+      const SQLString& _sql)
     :
       fetchSize(fetchSize)
     , batch(batch)
@@ -82,7 +83,6 @@ namespace mariadb
     , maxFieldSize(_statement->getMaxFieldSize())
     , autoIncrement(autoIncrement)
     , sql(_sql)
-    , parameters(_parameters)
   {
     ServerSidePreparedStatement *ssps = dynamic_cast<ServerSidePreparedStatement*>(_statement);
     if (ssps != nullptr) {
@@ -94,8 +94,13 @@ namespace mariadb
       if (statement == nullptr) {
         ClientSidePreparedStatement *csps= dynamic_cast<ClientSidePreparedStatement*>(_statement);
         statement= static_cast<MariaDbStatement*>(*csps);
+        // Client side statement is executed with the binary protocol after it has been prepared on the server
+        if (binaryFormat) {
+          serverPrepResult= csps->getServerPrepareResult();
+        }
       }
     }
+    setFetchBytes(_statement->getFetchBytes());
   }
 
   Results::~Results()
@@ -105,6 +110,64 @@ namespace mariadb
     }
   }
 
+
+  void Results::reset(
+      int32_t _fetchSize,
+      bool _batch,
+      std::size_t _expectedSize,
+      bool _binaryFormat,
+      int32_t _resultSetScrollType,
+      int32_t _resultSetConcurrency,
+      int32_t _autoGeneratedKeys,
+      int32_t _autoIncrement,
+      const SQLString& _sql)
+  {
+    if (statement && statement->getProtocol()) {
+      loadFully(true, statement->getProtocol());
+    }
+    if (cmdInformation.use_count() == 1) {
+      std::shared_ptr<CmdInformationSingle> single(std::dynamic_pointer_cast<CmdInformationSingle>(cmdInformation));
+      if (single) {
+        spareCmdInformation= std::move(single);
+      }
+    }
+    cmdInformation.reset();
+    executionResults.clear();
+    resultSet.reset();
+    given2appRs= nullptr;
+    callableResultSet.reset();
+
+    fetchSize= _fetchSize;
+    batch= _batch;
+    expectedSize= _expectedSize;
+    binaryFormat= _binaryFormat;
+    resultSetScrollType= _resultSetScrollType;
+    resultSetConcurrency= _resultSetConcurrency;
+    autoGeneratedKeys= _autoGeneratedKeys;
+    maxFieldSize= statement->getMaxFieldSize();
+    setFetchBytes(statement->getFetchBytes());
+    autoIncrement= _autoIncrement;
+    rewritten= false;
+    rewriteRows.clear();
+    sql= _sql;
+    haveResultInWire= false;
+    cachingLocally= false;
+    scalarOnly= false;
+    scalarRead= false;
+  }
+
+
+  void Results::createCmdInformationSingle(int64_t insertId, int64_t updateCount)
+  {
+    if (spareCmdInformation) {
+      spareCmdInformation->set(insertId, updateCount, autoIncrement);
+      cmdInformation= std::move(spareCmdInformation);
+    }
+    else {
+      cmdInformation= std::make_shared<CmdInformationSingle>(insertId, updateCount, autoIncrement);
+    }
+  }
+
   /**
    * Add execution statistics.
    *
@@ -120,11 +183,11 @@ namespace mariadb
     haveResultInWire= moreResultAvailable;
     if (!cmdInformation){
       if (batch){
-        cmdInformation.reset(new CmdInformationBatch(expectedSize, autoIncrement));
+        cmdInformation= std::make_shared<CmdInformationBatch>(expectedSize, autoIncrement);
       }else if (moreResultAvailable){
-        cmdInformation.reset(new CmdInformationMultiple(expectedSize, autoIncrement));
+        cmdInformation= std::make_shared<CmdInformationMultiple>(expectedSize, autoIncrement);
       }else {
-        cmdInformation.reset(new CmdInformationSingle(insertId, updateCount, autoIncrement));
+        createCmdInformationSingle(insertId, updateCount);
         return;
       }
     }
@@ -144,11 +207,11 @@ namespace mariadb
     haveResultInWire= moreResultAvailable;
     if (!cmdInformation){
       if (batch){
-        cmdInformation.reset(new CmdInformationBatch(expectedSize, autoIncrement));
+        cmdInformation= std::make_shared<CmdInformationBatch>(expectedSize, autoIncrement);
       }else if (moreResultAvailable){
-        cmdInformation.reset(new CmdInformationMultiple(expectedSize, autoIncrement));
+        cmdInformation= std::make_shared<CmdInformationMultiple>(expectedSize, autoIncrement);
       }else {
-        cmdInformation.reset(new CmdInformationSingle(0, Statement::EXECUTE_FAILED, autoIncrement));
+        createCmdInformationSingle(0, Statement::EXECUTE_FAILED);
         return;
       }
     }
@@ -182,19 +245,42 @@ namespace mariadb
     }
     if (!cmdInformation) {
       if (batch) {
-        cmdInformation.reset(new CmdInformationBatch(expectedSize, autoIncrement));
+        cmdInformation= std::make_shared<CmdInformationBatch>(expectedSize, autoIncrement);
       }
       else if (moreResultAvailable) {
-        cmdInformation.reset(new CmdInformationMultiple(expectedSize, autoIncrement));
+        cmdInformation= std::make_shared<CmdInformationMultiple>(expectedSize, autoIncrement);
       }
       else {
-        cmdInformation.reset(new CmdInformationSingle(0, -1, autoIncrement));
+        createCmdInformationSingle(0, -1);
         return;
       }
     }
     cmdInformation->addResultSetStat();
   }
 
+  /**
+   * Adds the first value of the result set, that has been read instead of the result set itself. The rest of the
+   * results has been skipped by the protocol.
+   *
+   * @param value the value, or nullptr for no row or NULL
+   * @param length length of the value
+   */
+  void Results::addScalar(const char* value, std::size_t length)
+  {
+    haveResultInWire= false;
+    scalarRead= true;
+    scalarNull= value == nullptr;
+    scalarValue.clear();
+    if (value != nullptr) {
+      scalarValue.append(value, length);
+    }
+    if (!cmdInformation) {
+      createCmdInformationSingle(0, -1);
+      return;
+    }
+    cmdInformation->addResultSetStat();
+  }
+
 
   Shared::CmdInformation Results::getCmdInformation(){
     return cmdInformation;
@@ -211,6 +297,8 @@ namespace mariadb
    * @return true id has cmdInformation
    */
   bool Results::commandEnd() {
+    // Only the first result may be read as scalar, getMoreResults reads the following ones as usual
+    scalarOnly= false;
 
     if (cmdInformation)
     {
@@ -222,6 +310,9 @@ namespace mariadb
         resultSet.reset(nullptr);
       }
       cmdInformation->setRewrite(rewritten);
+      if (rewritten && !rewriteRows.empty()) {
+        cmdInformation->setRewriteRows(rewriteRows, rowUpdateCountMin, rowUpdateCountMax);
+      }
       return true;
     }
     else {
@@ -341,7 +432,7 @@ namespace mariadb
    */
   bool Results::getMoreResults(int32_t current, Protocol* protocol) {
 
-    std::lock_guard<std::mutex> localScopeLock(*(protocol->getLock()));
+    std::lock_guard<ConnectionMutex> localScopeLock(*(protocol->getLock()));
     auto rs= resultSet.get();
 
     if (rs) {
@@ -386,10 +477,51 @@ namespace mariadb
   }
 
 
+  /* Text results in between are streamed, and closing the stream reads their rows off without storing or decoding them.
+   * The stream is closed before getMoreResults takes the protocol lock, since the close takes it as well */
+  bool Results::skipResults(int32_t count, Protocol* protocol)
+  {
+    bool result= false;
+    int32_t savedFetchSize= fetchSize;
+
+    for (int32_t i= 0; i < count; ++i) {
+      if (resultSet) {
+        resultSet->close();
+      }
+      if (serverPrepResult == nullptr && savedFetchSize == 0 && i < count - 1) {
+        fetchSize= 1;
+      }
+      try {
+        result= getMoreResults(Statement::CLOSE_CURRENT_RESULT, protocol);
+      }
+      catch (...) {
+        fetchSize= savedFetchSize;
+        throw;
+      }
+      fetchSize= savedFetchSize;
+    }
+    return result;
+  }
+
+
   int32_t Results::getFetchSize(){
     return fetchSize;
   }
 
+  std::size_t Results::getFetchBytes(){
+    return fetchBytes;
+  }
+
+  /* The budget alone streams the result too. The result then has no limit on rows of the chunk, and the fetch size is
+     the biggest possible value. Batches are never streamed */
+  void Results::setFetchBytes(std::size_t _fetchBytes)
+  {
+    fetchBytes= batch ? 0 : _fetchBytes;
+    if (fetchBytes > 0 && fetchSize == 0) {
+      fetchSize= INT32_MAX;
+    }
+  }
+
   MariaDbStatement* Results::getStatement(){
     return statement;
   }
@@ -408,6 +540,7 @@ namespace mariadb
 
   void Results::removeFetchSize(){
     fetchSize= 0;
+    fetchBytes= 0;
   }
 
   int32_t Results::getResultSetScrollType(){
@@ -418,10 +551,6 @@ namespace mariadb
     return sql;
   }
 
-  std::vector<Shared::ParameterHolder>& Results::getParameters(){
-    return parameters;
-  }
-
   /**
    * Send a resultSet that contain auto generated keys. 2 differences :
    *
@@ -453,6 +582,11 @@ namespace mariadb
     return SelectResultSet::createEmptyResultSet();
   }
 
+  /* Unlike getGeneratedKeys, does not need RETURN_GENERATED_KEYS - the id is sent by the server anyway */
+  int64_t Results::getLastInsertId() {
+    return cmdInformation ? cmdInformation->getLastInsertId() : 0;
+  }
+
   void Results::close(){
     statement= NULL;
     fetchSize= 0;
@@ -482,6 +616,15 @@ namespace mariadb
     this->rewritten= rewritten;
   }
 
+
+  void Results::setRewriteRows(std::vector<std::size_t>&& queryRows, int32_t _rowUpdateCountMin,
+    int32_t _rowUpdateCountMax)
+  {
+    rewriteRows= std::move(queryRows);
+    rowUpdateCountMin= _rowUpdateCountMin;
+    rowUpdateCountMax= _rowUpdateCountMax;
+  }
+
   /* Resets remembered bare ptr of the current resultSet if it's equal the one checking out.
      @param ptr to the resultset object being destructed
    */
@@ -492,5 +635,104 @@ namespace mariadb
       given2appRs= nullptr;
     }
   }
+
+  void Results::setScalarOnly(bool _scalarOnly)
+  {
+    scalarOnly= _scalarOnly;
+  }
+
+
+  bool Results::isScalarOnly()
+  {
+    return scalarOnly;
+  }
+
+
+  bool Results::hasScalar()
+  {
+    return scalarRead || getResultSet() != nullptr;
+  }
+
+  /**
+   * Returns the text of the first value, either read off the connection, or from the result set, if that has been
+   * created, e.g. for the binary protocol.
+   *
+   * @param buffer string to read the value from the result set to
+   * @return the value, or nullptr, if there was no row or the value was NULL
+   */
+  const SQLString* Results::fetchScalar(SQLString& buffer)
+  {
+    if (scalarRead) {
+      return scalarNull ? nullptr : &scalarValue;
+    }
+    SelectResultSet* rs= getResultSet();
+    return rs != nullptr && readScalar(rs, buffer) ? &buffer : nullptr;
+  }
+
+
+  bool Results::readScalar(ResultSet* rs, SQLString& value)
+  {
+    if (rs == nullptr || !rs->next()) {
+      return false;
+    }
+    value= rs->getString(1);
+    return !rs->wasNull();
+  }
+
+
+  bool Results::getScalar(SQLString& value)
+  {
+    SQLString buffer;
+    const SQLString* text= fetchScalar(buffer);
+    if (text == nullptr) {
+      return false;
+    }
+    value= *text;
+    return true;
+  }
+
+  /**
+   * Converts the first value to integer. Decimal part, if any, is truncated.
+   *
+   * @param value the value
+   * @return false, if there was no row or the value was NULL
+   * @throws SQLException if the value is not a number, or does not fit
+   */
+  bool Results::getScalar(int64_t& value)
+  {
+    SQLString buffer;
+    const SQLString* text= fetchScalar(buffer);
+    if (text == nullptr) {
+      return false;
+    }
+    const char* str= text->c_str();
+    char* end= nullptr;
+    errno= 0;
+    value= std::strtoll(str, &end, 10);
+    if (errno == ERANGE) {
+      throw SQLException("Out of range value '" + *text + "' for integer", "22003", 1264);
+    }
+    if (end == str || (*end != '\0' && *end != '.')) {
+      throw SQLException("Incorrect integer value '" + *text + "'", "22018");
+    }
+    return true;
+  }
+
+
+  bool Results::getScalar(double& value)
+  {
+    SQLString buffer;
+    const SQLString* text= fetchScalar(buffer);
+    if (text == nullptr) {
+      return false;
+    }
+    const char* str= text->c_str();
+    char* end= nullptr;
+    value= std::strtod(str, &end);
+    if (end == str || *end != '\0') {
+      throw SQLException("Incorrect double value '" + *text + "'", "22018");
+    }
+    return true;
+  }
 }
 }
@@ -33,11 +33,15 @@ namespace sql
 namespace mariadb
 {
 
+class CmdInformationSingle;
+
 class Results  {
 
   MariaDbStatement*     statement= nullptr;
   ServerPrepareResult*  serverPrepResult= nullptr;
   int32_t     fetchSize=    0;
+  /* Byte budget of the streamed result's chunk */
+  std::size_t fetchBytes=   0;
   bool        batch=        false;
   std::size_t expectedSize= 1;
   Shared::CmdInformation              cmdInformation;
@@ -52,10 +56,25 @@ class Results  {
   int32_t maxFieldSize=   0;
   int32_t autoIncrement=  1;
   bool    rewritten=      false;
+  /* Rows of each query of the rewritten batch, and the range of the update count of one row */
+  std::vector<std::size_t> rewriteRows;
+  int32_t rowUpdateCountMin= 1;
+  int32_t rowUpdateCountMax= 1;
   SQLString sql;
-  std::vector<Shared::ParameterHolder> parameters;
   bool    haveResultInWire= false;
   bool    cachingLocally=   false;
+  /* Kept from the previous execution, if nobody else has referred to it, to be recycled by the next one */
+  std::shared_ptr<CmdInformationSingle> spareCmdInformation;
+  /* With scalarOnly the protocol reads only the first value of the text result set into scalarValue, and skips the
+     rest of the results, instead of creating the result set */
+  bool    scalarOnly= false;
+  bool    scalarRead= false;
+  bool    scalarNull= true;
+  SQLString scalarValue;
+
+  void createCmdInformationSingle(int64_t insertId, int64_t updateCount);
+  void setFetchBytes(std::size_t fetchBytes);
+  const SQLString* fetchScalar(SQLString& buffer);
 
 public:
   Results();
@@ -69,14 +88,26 @@ public:
     int32_t resultSetConcurrency,
     int32_t autoGeneratedKeys,
     int32_t autoIncrement,
-    const SQLString& sql,
-    std::vector<Shared::ParameterHolder>& parameters);
+    const SQLString& sql);
   ~Results();
+  /* Makes the object ready for the next execution of the same statement instead of a new one. Skips unread results
+     of the previous execution. The statement has to make sure nobody else refers to the object */
+  void reset(
+    int32_t fetchSize,
+    bool batch,
+    std::size_t expectedSize,
+    bool binaryFormat,
+    int32_t resultSetScrollType,
+    int32_t resultSetConcurrency,
+    int32_t autoGeneratedKeys,
+    int32_t autoIncrement,
+    const SQLString& sql);
 
   void    addStats(int64_t updateCount,int64_t insertId,bool moreResultAvailable);
   void    addStatsError(bool moreResultAvailable);
   int32_t getCurrentStatNumber();
   void    addResultSet(SelectResultSet* resultSet,bool moreResultAvailable);
+  void    addScalar(const char* value, std::size_t length);
   Shared::CmdInformation getCmdInformation();
 
 protected:
@@ -91,7 +122,9 @@ public:
   void abort();
   bool isFullyLoaded(Protocol* protocol);
   bool getMoreResults(int32_t current, Protocol* protocol);
+  bool skipResults(int32_t count, Protocol* protocol);
   int32_t getFetchSize();
+  std::size_t getFetchBytes();
   MariaDbStatement* getStatement();
   bool isBatch();
   std::size_t getExpectedSize();
@@ -99,8 +132,8 @@ public:
   void removeFetchSize();
   int32_t getResultSetScrollType();
   const SQLString& getSql();
-  std::vector<Shared::ParameterHolder>& getParameters();
   ResultSet* getGeneratedKeys(Protocol* protocol);
+  int64_t getLastInsertId();
   void close();
   int32_t getMaxFieldSize();
   void setAutoIncrement(int32_t autoIncrement);
@@ -108,7 +141,18 @@ public:
   int32_t getAutoGeneratedKeys();
   bool isRewritten();
   void setRewritten(bool rewritten);
+  void setRewriteRows(std::vector<std::size_t>&& queryRows, int32_t rowUpdateCountMin, int32_t rowUpdateCountMax);
   void checkOut(SelectResultSet* iamleaving);
+  void setScalarOnly(bool scalarOnly);
+  bool isScalarOnly();
+  /* If the first result has been a result set, read as scalar or not */
+  bool hasScalar();
+  /* Value of the first column of the first row. false, if there has been no row, or the value is NULL */
+  bool getScalar(SQLString& value);
+  bool getScalar(int64_t& value);
+  bool getScalar(double& value);
+  /* The same for the result set, that has been returned to the application, e.g. by the callable statement */
+  static bool readScalar(ResultSet* rs, SQLString& value);
 };
 
 }
@@ -21,6 +21,7 @@
 #include <cctype>
 #include <functional>
 #include <iostream>
+#include <stdexcept>
 
 #include "string.h"
 
@@ -29,7 +30,30 @@
 namespace sql
 {
 
-  SQLString::SQLString(const SQLString& other) : theString(new StringImp((*other.theString)->c_str(), (*other.theString)->length()))
+#ifdef MARIADB_INLINE_SQLSTRING
+  SQLString::SQLString(const SQLString& other) : theString(other.theString)
+  {
+  }
+
+  SQLString::SQLString(SQLString&& moved) : theString(std::move(moved.theString))
+  {
+  }
+
+  SQLString::SQLString(const char* str) : theString(str != nullptr ? str : "")
+  {
+  }
+
+
+  SQLString::SQLString(const char* str, std::size_t count) : theString(str, count)
+  {
+  }
+
+
+  SQLString::SQLString()
+  {
+  }
+#else
+  SQLString::SQLString(const SQLString& other) : theString(new StringImp(StringImp::get(other).c_str(), StringImp::get(other).length()))
   {
   }
 
@@ -53,15 +77,16 @@ namespace sql
   }
 
 
-  SQLString& SQLString::operator=(const SQLString &other)
+  SQLString::SQLString() : theString(new StringImp())
   {
-    *theString= *other.theString;
-    return *this;
   }
+#endif
 
 
-  SQLString::SQLString() : SQLString("")
+  SQLString& SQLString::operator=(const SQLString &other)
   {
+    StringImp::get(*this)= StringImp::get(other);
+    return *this;
   }
 
 
@@ -71,31 +96,31 @@ namespace sql
 
   const char* SQLString::c_str() const
   {
-    return (*theString)->c_str();
+    return StringImp::get(*this).c_str();
   }
 
   bool SQLString::empty() const
   {
-    return (*theString)->empty();
+    return StringImp::get(*this).empty();
   }
 
   SQLString& SQLString::toUpperCase()
   {
-    std::transform((*theString)->begin(), (*theString)->end(), (*theString)->begin(),
+    std::transform(StringImp::get(*this).begin(), StringImp::get(*this).end(), StringImp::get(*this).begin(),
       [](unsigned char c) { return std::toupper(c); });
     return *this;
   }
 
   SQLString& SQLString::toLowerCase()
   {
-    std::transform((*theString)->begin(), (*theString)->end(), (*theString)->begin(),
+    std::transform(StringImp::get(*this).begin(), StringImp::get(*this).end(), StringImp::get(*this).begin(),
       [](unsigned char c) { return std::tolower(c); });
     return *this;
   }
 
   SQLString & SQLString::ltrim()
   {
-    (*theString)->erase((*theString)->begin(), std::find_if((*theString)->begin(), (*theString)->end(), [](int ch) {
+    StringImp::get(*this).erase(StringImp::get(*this).begin(), std::find_if(StringImp::get(*this).begin(), StringImp::get(*this).end(), [](int ch) {
       return !std::isspace(ch);
     }));
     return *this;
@@ -103,9 +128,9 @@ namespace sql
 
   SQLString & SQLString::rtrim()
   {
-    (*theString)->erase(std::find_if((*theString)->rbegin(), (*theString)->rend(), [](int ch) {
+    StringImp::get(*this).erase(std::find_if(StringImp::get(*this).rbegin(), StringImp::get(*this).rend(), [](int ch) {
       return !std::isspace(ch);
-    }).base(), (*theString)->end());
+    }).base(), StringImp::get(*this).end());
     return *this;
   }
 
@@ -117,48 +142,48 @@ namespace sql
 
   int SQLString::compare(const SQLString & str) const
   {
-    return (*theString)->compare(0, (*theString)->length(), (*str.theString)->c_str(), (*str.theString)->length());
+    return StringImp::get(*this).compare(0, StringImp::get(*this).length(), StringImp::get(str).c_str(), StringImp::get(str).length());
   }
 
   int SQLString::compare(std::size_t pos1, std::size_t count1, const char* str, std::size_t count2) const
   {
-    return (*theString)->compare(pos1, count1, str, count2);
+    return StringImp::get(*this).compare(pos1, count1, str, count2);
   }
 
 
   SQLString & SQLString::append(const SQLString & addition)
   {
-    (*theString)->append((*addition.theString)->c_str(), (*addition.theString)->length());
+    StringImp::get(*this).append(StringImp::get(addition).c_str(), StringImp::get(addition).length());
     return *this;
   }
 
   SQLString& SQLString::append(const char* const addition)
   {
-    (*theString)->append(addition);
+    StringImp::get(*this).append(addition);
     return *this;
   }
 
   SQLString & SQLString::append(const char * const addition, std::size_t len)
   {
-    (*theString)->append(addition, len);
+    StringImp::get(*this).append(addition, len);
     return *this;
   }
 
   SQLString & SQLString::append(char c)
   {
-    (*theString)->append(1, c);
+    StringImp::get(*this).append(1, c);
     return *this;
   }
 
 
   int64_t SQLString::hashCode() const
   {
-    return static_cast<int64_t>(std::hash<std::string>{}(theString->get()));
+    return static_cast<int64_t>(std::hash<std::string>{}(StringImp::get(*this)));
   }
 
   bool SQLString::startsWith(const SQLString & str) const
   {
-    return ((*theString)->compare(0, str.size(), (*str.theString)->c_str(), (*str.theString)->length()) == 0);
+    return (StringImp::get(*this).compare(0, str.size(), StringImp::get(str).c_str(), StringImp::get(str).length()) == 0);
   }
 
   bool SQLString::endsWith(const SQLString & str) const
@@ -169,98 +194,107 @@ namespace sql
     {
       return false;
     }
-    return (*theString)->compare(size - otherSize, otherSize, (*str.theString)->c_str(), (*str.theString)->length()) == 0;
+    return StringImp::get(*this).compare(size - otherSize, otherSize, StringImp::get(str).c_str(), StringImp::get(str).length()) == 0;
   }
 
   SQLString SQLString::substr(std::size_t pos, std::size_t count) const
   {
-    return (*theString)->substr(pos, count).c_str();
+    const std::string& str= StringImp::get(*this);
+    if (pos > str.length()) {
+      throw std::out_of_range("SQLString::substr position is out of range");
+    }
+    // Constructing directly from the part, without temporary std::string and strlen
+    return SQLString(str.c_str() + pos, std::min(count, str.length() - pos));
   }
 
   std::size_t SQLString::find_first_of(const SQLString & str, std::size_t pos) const
   {
-    return (*theString)->find_first_of((*str.theString)->c_str(), pos, (*str.theString)->length());
+    return StringImp::get(*this).find_first_of(StringImp::get(str).c_str(), pos, StringImp::get(str).length());
   }
 
   std::size_t SQLString::find_first_of(const char * str, std::size_t pos) const
   {
-    return (*theString)->find_first_of(str, pos);
+    return StringImp::get(*this).find_first_of(str, pos);
   }
 
   std::size_t SQLString::find_first_of(const char ch, std::size_t pos) const
   {
-    return (*theString)->find_first_of(ch, pos);
+    return StringImp::get(*this).find_first_of(ch, pos);
   }
 
 
   std::size_t SQLString::find_last_of(const SQLString& str, std::size_t pos) const
   {
-    return (*theString)->find_last_of(str.theString->get(), pos);
+    return StringImp::get(*this).find_last_of(StringImp::get(str), pos);
   }
 
   std::size_t SQLString::find_last_of(const char* str, std::size_t pos) const
   {
-    return (*theString)->find_last_of(str, pos);
+    return StringImp::get(*this).find_last_of(str, pos);
   }
 
   std::size_t SQLString::find_last_of(const char ch, std::size_t pos) const
   {
-    return (*theString)->find_last_of(ch, pos);
+    return StringImp::get(*this).find_last_of(ch, pos);
   }
 
 
   std::size_t SQLString::size() const
   {
-    return (*theString)->size();
+    return StringImp::get(*this).size();
   }
 
   std::size_t SQLString::length() const
   {
-    return (*theString)->length();
+    return StringImp::get(*this).length();
   }
 
   void SQLString::reserve(std::size_t n)
   {
-    (*theString)->reserve(n);
+    std::string& str= StringImp::get(*this);
+    // Before C++20 the smaller value may shrink the string, and the memory, that it has, is kept intentionally
+    if (n > str.capacity()) {
+      str.reserve(n);
+    }
   }
 
   char & SQLString::at(std::size_t pos)
   {
-    return (*theString)->at(pos);
+    return StringImp::get(*this).at(pos);
   }
 
   const char & SQLString::at(std::size_t pos) const
   {
-    return (*theString)->at(pos);
+    return StringImp::get(*this).at(pos);
   }
 
 
   std::string::iterator SQLString::begin()
   {
-    return (*theString)->begin();
+    return StringImp::get(*this).begin();
   }
 
 
   std::string::iterator SQLString::end()
   {
-    return (*theString)->end();
+    return StringImp::get(*this).end();
   }
 
 
   std::string::const_iterator SQLString::begin() const
   {
-    return (*theString)->begin();
+    return StringImp::get(*this).begin();
   }
 
 
   std::string::const_iterator SQLString::end() const
   {
-    return (*theString)->end();
+    return StringImp::get(*this).end();
   }
 
   void SQLString::clear()
   {
-    (*theString)->clear();
+    StringImp::get(*this).clear();
   }
 
 
@@ -317,20 +351,20 @@ namespace sql
 
   SQLString::operator const char* () const
   {
-    return (*theString)->c_str();
+    return StringImp::get(*this).c_str();
   }
 
 
   SQLString & SQLString::operator=(const char * right)
   {
-    *theString= (right != nullptr ? right : "");
+    StringImp::get(*this).assign(right != nullptr ? right : "");
     return *this;
   }
 
 
   int SQLString::caseCompare(const SQLString& other) const
   {
-    SQLString lcThis((*theString)->c_str(), (*theString)->length()), lsThat(other.c_str(), other.length());
+    SQLString lcThis(StringImp::get(*this).c_str(), StringImp::get(*this).length()), lsThat(other.c_str(), other.length());
     return lcThis.toLowerCase().compare(lsThat.toLowerCase());
   }
 }
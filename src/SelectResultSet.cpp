@@ -90,8 +90,8 @@ namespace mariadb
     *     <code>ResultSet.TYPE_SCROLL_SENSITIVE</code>
     */
   SelectResultSet* SelectResultSet::create(
-    std::vector<Shared::ColumnDefinition>& columnInformation,
-    /*std::unique_ptr<*/std::vector<std::vector<sql::bytes>>& resultSet,
+    const std::vector<Shared::ColumnDefinition>& columnInformation,
+    /*std::unique_ptr<*/const std::vector<std::vector<sql::bytes>>& resultSet,
     Protocol* protocol,
     int32_t resultSetScrollType)
   {
@@ -133,6 +133,34 @@ namespace mariadb
     return new capi::SelectResultSetCapi(columns, rows, protocol, TYPE_SCROLL_SENSITIVE);
   }
 
+
+  ResultSet* SelectResultSet::createGeneratedData(const int64_t* updateCounts, const int64_t* insertIds, std::size_t size,
+    int32_t autoIncrement, Protocol* protocol)
+  {
+    std::vector<Shared::ColumnDefinition> columns{capi::ColumnDefinitionCapi::create("insert_id", ColumnType::BIGINT)};
+    std::vector<std::vector<sql::bytes>> rows;
+    std::size_t total= 0;
+
+    for (std::size_t i= 0; i < size; ++i) {
+      if (updateCounts[i] > 0 && insertIds[i] > 0) {
+        total+= static_cast<std::size_t>(updateCounts[i]);
+      }
+    }
+    rows.reserve(total);
+
+    for (std::size_t i= 0; i < size; ++i) {
+      if (updateCounts[i] > 0 && insertIds[i] > 0) {
+        int64_t id= insertIds[i];
+        for (int64_t k= 0; k < updateCounts[i]; ++k, id+= autoIncrement) {
+          std::string idAsStr(std::to_string(id));
+          rows.emplace_back();
+          rows.back().emplace_back(idAsStr.c_str(), idAsStr.length());
+        }
+      }
+    }
+    return create(columns, rows, protocol, TYPE_SCROLL_SENSITIVE);
+  }
+
   bool SelectResultSet::InitIdColumns() {
     SelectResultSet::INSERT_ID_COLUMNS.push_back(capi::ColumnDefinitionCapi::create("insert_id", ColumnType::BIGINT));
     return true;
@@ -145,9 +173,9 @@ namespace mariadb
     return create(INSERT_ID_COLUMNS, emptyRs, nullptr, TYPE_SCROLL_SENSITIVE);
   }
 
-  ResultSet * SelectResultSet::createResultSet(std::vector<SQLString>& columnNames,
-    std::vector<ColumnType>& columnTypes,
-    std::vector<std::vector<sql::bytes>>& data,
+  ResultSet * SelectResultSet::createResultSet(const std::vector<SQLString>& columnNames,
+    const std::vector<ColumnType>& columnTypes,
+    const std::vector<std::vector<sql::bytes>>& data,
     Protocol* protocol)
   {
     std::size_t columnNameLength= columnNames.size();
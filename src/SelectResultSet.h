@@ -89,12 +89,16 @@ public:
     bool eofDeprecated);
 
   static SelectResultSet* create(
-    std::vector<Shared::ColumnDefinition>& columnInformation,
-    /*std::unique_ptr<*/std::vector<std::vector<sql::bytes>>& resultSet,
+    const std::vector<Shared::ColumnDefinition>& columnInformation,
+    /*std::unique_ptr<*/const std::vector<std::vector<sql::bytes>>& resultSet,
     Protocol* protocol,
     int32_t resultSetScrollType);
 
   static ResultSet* createGeneratedData(std::vector<int64_t>& data, Protocol* protocol, bool findColumnReturnsOne);
+  /* Ids generated by the commands - updateCounts[i] ids from insertIds[i] with autoIncrement step. Failed commands,
+     the ones, that have returned a result set, or have not generated ids, are skipped */
+  static ResultSet* createGeneratedData(const int64_t* updateCounts, const int64_t* insertIds, std::size_t size,
+    int32_t autoIncrement, Protocol* protocol);
   static SelectResultSet* createEmptyResultSet();
 
   /**
@@ -110,8 +114,8 @@ public:
   * @return resultset
   */
 
-  static ResultSet* createResultSet(std::vector<SQLString>& columnNames, std::vector<ColumnType>& columnTypes,
-    std::vector<std::vector<sql::bytes>>& data, Protocol* protocol);
+  static ResultSet* createResultSet(const std::vector<SQLString>& columnNames, const std::vector<ColumnType>& columnTypes,
+    const std::vector<std::vector<sql::bytes>>& data, Protocol* protocol);
 
   virtual ~SelectResultSet() {}
 
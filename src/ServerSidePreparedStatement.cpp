@@ -21,11 +21,15 @@
 #include <deque>
 
 #include "ServerSidePreparedStatement.h"
+#include "protocol/MasterProtocol.h"
 #include "logger/LoggerFactory.h"
 #include "ExceptionFactory.h"
 #include "Results.h"
 #include "MariaDbParameterMetaData.h"
 #include "MariaDbResultSetMetaData.h"
+#include "util/ClientPrepareResult.h"
+#include "util/ClientPrepareResultCache.h"
+#include "Parameters.h"
 
 namespace sql
 {
@@ -33,12 +37,30 @@ namespace sql
 {
 
   const Shared::Logger ServerSidePreparedStatement::logger= LoggerFactory::getLogger(typeid(ServerSidePreparedStatement));
+
+  /* Gives the prepare of the statement, that has not been closed, back. The protocol may be gone already, and the prepare
+     is not deallocated on the server then. If the prepared statements cache keeps it, the cache owns it after that */
+  static void releaseNotClosed(Unique::ServerPrepareResult& prepareResult)
+  {
+    if (prepareResult) {
+      prepareResult->decrementShareCounter();
+      if (!prepareResult->canBeDeallocate()) {
+        prepareResult.release();
+      }
+    }
+  }
+
   ServerSidePreparedStatement::~ServerSidePreparedStatement()
   {
+    bool closed= !stmt || stmt->isClosed();
     // Statement has to be deleted before prepare result, because prepare result owns(and closes) C API stmt handle, and Results deleted in
     // MariaDBStatement might need to fetch remaining results(in case of streaming). Basically, closing stmt handle would be enough - this
     // fetches remaining results as well, but we can also have here CSPS, not only SSPS
     stmt.reset();
+    if (!closed) {
+      releaseNotClosed(serverPrepareResult);
+      releaseNotClosed(listShapeResult);
+    }
     serverPrepareResult.reset();
   }
   /**
@@ -65,7 +87,15 @@ namespace sql
   {
     serverPrepareResult= nullptr;
     sql= _sql;
-    prepare(sql);
+    if (defersPrepare()) {
+      // Prepare is deferred to the first execution, that sends it together with the execute command. Until then the
+      // number of parameters is what the client side parser counts
+      parameterCount= static_cast<int32_t>(ClientPrepareResultCache::getInstance().get(sql, protocol->noBackslashEscapes(),
+        false, static_cast<std::size_t>(protocol->getOptions()->parsedQueryCacheSize))->getParamCount());
+    }
+    else {
+      prepare(sql);
+    }
   }
 
   ServerSidePreparedStatement::ServerSidePreparedStatement(
@@ -95,7 +125,12 @@ namespace sql
       this->autoGeneratedKeys, this->mustExecuteOnMaster, ef);
     clone->metadata= metadata;
     clone->parameterMetaData= this->parameterMetaData;
+    clone->sql= sql;
 
+    if (!serverPrepareResult && defersPrepare()) {
+      clone->parameterCount= parameterCount;
+      return clone;
+    }
     try {
       clone->prepare(sql);
     }
@@ -106,6 +141,12 @@ namespace sql
   }
 
 
+  PreparedStatement* ServerSidePreparedStatement::clone(Connection* target)
+  {
+    return clone(MariaDbConnection::cloneTarget(connection, target));
+  }
+
+
   void ServerSidePreparedStatement::prepare(const SQLString& sql)
   {
     try {
@@ -123,6 +164,25 @@ namespace sql
     }
   }
 
+  /* Prepare is deferred to the first execution with pipelinePrepare, and for the query, that is never cached - the
+     connection has no prepared statements cache, or the query is too long for it - and thus is likely to be executed
+     once */
+  bool ServerSidePreparedStatement::defersPrepare() const
+  {
+    const Shared::Options& options= protocol->getOptions();
+    return options->pipelinePrepare ||
+      (options->executeDirectLongQueries && (protocol->prepareStatementCache() == nullptr ||
+        sql.length() >= static_cast<std::size_t>(options->prepStmtCacheSqlLimit)));
+  }
+
+  /* Makes sure, that the statement is prepared, in case the prepare has been deferred to the first execution */
+  void ServerSidePreparedStatement::ensurePrepared()
+  {
+    if (!serverPrepareResult) {
+      prepare(sql);
+    }
+  }
+
   void ServerSidePreparedStatement::setMetaFromResult()
   {
     parameterCount= static_cast<int32_t>(serverPrepareResult->getParameters().size());
@@ -131,10 +191,22 @@ namespace sql
     parameterMetaData.reset(new MariaDbParameterMetaData(serverPrepareResult->getParameters()));
   }
 
+  /* Holders, that have been added to the batch, are shared with the batch, and can't be changed */
+  ParameterHolder* ServerSidePreparedStatement::getReusableParameter(int32_t parameterIndex)
+  {
+    auto it= currentParameterHolder.find(parameterIndex - 1);
+    if (it != currentParameterHolder.end() && it->second.use_count() == 1) {
+      return it->second.get();
+    }
+    return nullptr;
+  }
+
+
   void ServerSidePreparedStatement::setParameter(int32_t parameterIndex, ParameterHolder* holder)
   {
     // TODO: does it really has to be map? can be, actually
-    if (parameterIndex > 0 && static_cast<std::size_t>(parameterIndex) < serverPrepareResult->getParamCount() + 1) {
+    if (parameterIndex > 0 && parameterIndex < parameterCount + 1) {
+      listParameters.erase(parameterIndex - 1);
       auto it= currentParameterHolder.find(parameterIndex - 1);
       if (it == currentParameterHolder.end()) {
         Shared::ParameterHolder paramHolder(holder);
@@ -173,9 +245,159 @@ namespace sql
     }
   }
 
+  void ServerSidePreparedStatement::setParameterArray(int32_t parameterIndex, const ParameterArray& parameterArray,
+    std::size_t rows)
+  {
+    if (parameterIndex < 1 || parameterIndex > parameterCount) {
+      exceptionFactory->raiseStatementError(connection, stmt.get())->create("Could not set parameter array at position "
+        + std::to_string(parameterIndex), "07009").Throw();
+    }
+    if (rows == 0 || rows > INT32_MAX) {
+      exceptionFactory->raiseStatementError(connection, stmt.get())->create("Invalid number of rows in the parameter array: "
+        + std::to_string(rows), "HY090").Throw();
+    }
+    // clearBatch has to be called to bind arrays of other size
+    if (!parameterArrays.empty() && rows != parameterArrayRows) {
+      exceptionFactory->raiseStatementError(connection, stmt.get())->create("All parameter arrays must have the same number of rows("
+        + std::to_string(parameterArrayRows) + ")", "HY090").Throw();
+    }
+    parameterArrays[parameterIndex - 1]= parameterArray;
+    parameterArrayRows= rows;
+  }
+
+
+  void ServerSidePreparedStatement::setArray(int32_t parameterIndex, const int32_t* values, const char* nullIndicators,
+    std::size_t rows)
+  {
+    setParameterArray(parameterIndex, {capi::MYSQL_TYPE_LONG, values, nullptr, nullIndicators, sizeof(int32_t)}, rows);
+  }
+
+
+  void ServerSidePreparedStatement::setArray(int32_t parameterIndex, const int64_t* values, const char* nullIndicators,
+    std::size_t rows)
+  {
+    setParameterArray(parameterIndex, {capi::MYSQL_TYPE_LONGLONG, values, nullptr, nullIndicators, sizeof(int64_t)}, rows);
+  }
+
+
+  void ServerSidePreparedStatement::setArray(int32_t parameterIndex, const double* values, const char* nullIndicators,
+    std::size_t rows)
+  {
+    setParameterArray(parameterIndex, {capi::MYSQL_TYPE_DOUBLE, values, nullptr, nullIndicators, sizeof(double)}, rows);
+  }
+
+
+  void ServerSidePreparedStatement::setArray(int32_t parameterIndex, const char* const* values, const unsigned long* lengths,
+    const char* nullIndicators, std::size_t rows)
+  {
+    setParameterArray(parameterIndex, {capi::MYSQL_TYPE_STRING, values, lengths, nullIndicators, 0}, rows);
+  }
+
+
+  void ServerSidePreparedStatement::setListParameter(int32_t parameterIndex, std::vector<Shared::ParameterHolder>&& values)
+  {
+    if (parameterIndex < 1 || parameterIndex > parameterCount) {
+      exceptionFactory->raiseStatementError(connection, stmt.get())->create("Could not set list parameter at position "
+        + std::to_string(parameterIndex), "07009").Throw();
+    }
+    if (values.empty()) {
+      exceptionFactory->raiseStatementError(connection, stmt.get())->create("The list parameter at position "
+        + std::to_string(parameterIndex) + " has no values", "HY090").Throw();
+    }
+    currentParameterHolder.erase(parameterIndex - 1);
+    listParameters[parameterIndex - 1]= std::move(values);
+  }
+
+
+  void ServerSidePreparedStatement::setList(int32_t parameterIndex, const int64_t* values, std::size_t count)
+  {
+    std::vector<Shared::ParameterHolder> list;
+    list.reserve(count);
+    for (std::size_t i= 0; i < count; ++i) {
+      list.emplace_back(new LongParameter(values[i]));
+    }
+    setListParameter(parameterIndex, std::move(list));
+  }
+
+
+  void ServerSidePreparedStatement::setList(int32_t parameterIndex, const SQLString* values, std::size_t count)
+  {
+    std::vector<Shared::ParameterHolder> list;
+    list.reserve(count);
+    for (std::size_t i= 0; i < count; ++i) {
+      if (transcoding == Charset::LATIN1_UTF8) {
+        SQLString encoded(values[i]);
+        Charset::encode(transcoding, encoded);
+        list.emplace_back(new StringParameter(encoded, noBackslashEscapes));
+      }
+      else {
+        list.emplace_back(new StringParameter(values[i], noBackslashEscapes));
+      }
+    }
+    setListParameter(parameterIndex, std::move(list));
+  }
+
+
+  /* Expands the markers of the list parameters to the nearest power of two of their sizes, and returns the statement of
+     that query. The statement is kept till the sizes go to other buckets, and the server prepare cache keeps it after
+     that. The parameters for it are put to parameterHolders, lists are padded with their last value */
+  ServerPrepareResult* ServerSidePreparedStatement::prepareListShape(std::vector<Shared::ParameterHolder>& parameterHolders)
+  {
+    Shared::ClientPrepareResult parts= ClientPrepareResultCache::getInstance().get(sql, protocol->noBackslashEscapes(),
+      false, static_cast<std::size_t>(protocol->getOptions()->parsedQueryCacheSize));
+    const std::vector<SQLString>& queryParts= parts->getQueryParts();
+
+    if (queryParts.size() != static_cast<std::size_t>(parameterCount) + 1) {
+      exceptionFactory->raiseStatementError(connection, stmt.get())->create(
+        "Could not find the markers of list parameters in the query", "HY000").Throw();
+    }
+    SQLString shapeSql(queryParts[0]);
+    parameterHolders.clear();
+
+    for (int32_t i= 0; i < parameterCount; ++i) {
+      auto list= listParameters.find(i);
+      if (list == listParameters.end()) {
+        shapeSql.append('?');
+        parameterHolders.push_back(currentParameterHolder[i]);
+      }
+      else {
+        std::size_t bucket= 1;
+        while (bucket < list->second.size()) {
+          bucket<<= 1;
+        }
+        parameterHolders.insert(parameterHolders.end(), list->second.begin(), list->second.end());
+        parameterHolders.insert(parameterHolders.end(), bucket - list->second.size(), list->second.back());
+        shapeSql.append('?');
+        for (std::size_t j= 1; j < bucket; ++j) {
+          shapeSql.append(",?");
+        }
+      }
+      shapeSql.append(queryParts[i + 1]);
+    }
+
+    if (!listShapeResult || listShapeResult->getSql() != shapeSql) {
+      if (listShapeResult) {
+        try {
+          if (!listShapeResult->getUnProxiedProtocol()->releasePrepareStatement(listShapeResult.get())) {
+            // The cache keeps it
+            listShapeResult.release();
+          }
+        }
+        catch (SQLException&) {
+        }
+      }
+      listShapeResult.reset(protocol->prepare(shapeSql, mustExecuteOnMaster));
+    }
+    return listShapeResult.get();
+  }
+
+
   void ServerSidePreparedStatement::addBatch()
   {
     validParameters();
+    if (!listParameters.empty()) {
+      throw exceptionFactory->notSupported("List parameters are not supported in batches");
+    }
 
     queryParameters.push_back({});
 
@@ -194,6 +416,8 @@ namespace sql
   void ServerSidePreparedStatement::clearBatch()
   {
     queryParameters.clear();
+    parameterArrays.clear();
+    parameterArrayRows= 0;
   }
 
   ParameterMetaData* ServerSidePreparedStatement::getParameterMetaData()
@@ -201,12 +425,14 @@ namespace sql
     if (isClosed()) {
       throw SQLException("The query has been already closed");
     }
+    ensurePrepared();
 
     return new MariaDbParameterMetaData(*parameterMetaData);
   }
 
   sql::ResultSetMetaData* ServerSidePreparedStatement::getMetaData()
   {
+    ensurePrepared();
     return new MariaDbResultSetMetaData(*metadata);
   }
 
@@ -216,10 +442,15 @@ namespace sql
     sql::Ints& res= stmt->getBatchResArr();
     res.wrap(nullptr, 0);
     int32_t queryParameterSize= static_cast<int32_t>(queryParameters.size());
-    if (queryParameterSize == 0) {
+    if (!parameterArrays.empty()) {
+      executeArrayBatchInternal();
+    }
+    else if (queryParameterSize == 0) {
       return res;
     }
-    executeBatchInternal(queryParameterSize);
+    else {
+      executeBatchInternal(queryParameterSize);
+    }
     return res.wrap(stmt->getInternalResults()->getCmdInformation()->getUpdateCounts());
   }
 
@@ -228,28 +459,33 @@ namespace sql
     stmt->checkClose();
     sql::Longs& res = stmt->getLargeBatchResArr();
     int32_t queryParameterSize= static_cast<int32_t>(queryParameters.size());
-    if (queryParameterSize == 0) {
+    if (!parameterArrays.empty()) {
+      executeArrayBatchInternal();
+    }
+    else if (queryParameterSize == 0) {
       return res;
     }
-    executeBatchInternal(queryParameterSize);
+    else {
+      executeBatchInternal(queryParameterSize);
+    }
     return res.wrap(stmt->getInternalResults()->getCmdInformation()->getLargeUpdateCounts());
   }
 
   void ServerSidePreparedStatement::executeBatchInternal(int32_t queryParameterSize)
   {
-    std::unique_lock<std::mutex> localScopeLock(*protocol->getLock());
+    ensurePrepared();
+    std::unique_lock<ConnectionMutex> localScopeLock(*protocol->getLock());
 
     stmt->setExecutingFlag();
 
     try {
       executeQueryPrologue(serverPrepareResult.get());
 
-      if (stmt->getQueryTimeout() !=0) {
+      if (stmt->getQueryTimeoutMs() !=0) {
         stmt->setTimerTask(true);
       }
-      std::vector<Shared::ParameterHolder> dummy;
       stmt->setInternalResults(
-        new Results(
+        std::make_shared<Results>(
           stmt.get(),
           0,
           true,
@@ -259,8 +495,7 @@ namespace sql
           stmt->getResultSetConcurrency(),
           autoGeneratedKeys,
           protocol->getAutoIncrementIncrement(),
-          nullptr,
-          dummy));
+          nullptr));
 
       serverPrepareResult->resetParameterTypeHeader();
 
@@ -283,7 +518,7 @@ namespace sql
       SQLException exception("");
       bool exceptionSet= false;
       bool autoCommit= protocol->getAutocommit();
-      bool queryTimeout= stmt->getQueryTimeout() > 0;
+      bool queryTimeout= stmt->getQueryTimeoutMs() > 0;
       auto& results= stmt->getInternalResults();
       auto pr= serverPrepareResult.get();
 
@@ -340,6 +575,59 @@ namespace sql
     stmt->executeBatchEpilogue();
   }
 
+  /* Executes the batch of parameters bound to arrays. They are bound to the C API statement as is */
+  void ServerSidePreparedStatement::executeArrayBatchInternal()
+  {
+    ensurePrepared();
+
+    std::vector<ParameterArray> arrays;
+    arrays.reserve(parameterCount);
+
+    for (int32_t i= 0; i < parameterCount; ++i) {
+      auto it= parameterArrays.find(i);
+      if (it == parameterArrays.end()) {
+        exceptionFactory->raiseStatementError(connection, stmt.get())->create("Parameter at position " + std::to_string(i + 1)
+          + " is not bound to array", "07004").Throw();
+      }
+      arrays.push_back(it->second);
+    }
+    int32_t rows= static_cast<int32_t>(parameterArrayRows);
+
+    std::unique_lock<ConnectionMutex> localScopeLock(*protocol->getLock());
+
+    stmt->setExecutingFlag();
+
+    try {
+      executeQueryPrologue(serverPrepareResult.get());
+
+      if (stmt->getQueryTimeoutMs() !=0) {
+        stmt->setTimerTask(true);
+      }
+      stmt->setInternalResults(
+        std::make_shared<Results>(
+          stmt.get(),
+          0,
+          true,
+          rows,
+          true,
+          stmt->getResultSetType(),
+          stmt->getResultSetConcurrency(),
+          autoGeneratedKeys,
+          protocol->getAutoIncrementIncrement(),
+          nullptr));
+
+      protocol->executeBatchArrays(serverPrepareResult.get(), stmt->getInternalResults(), arrays,
+        static_cast<uint32_t>(parameterArrayRows));
+
+      stmt->getInternalResults()->commandEnd();
+    }
+    catch (SQLException& initialSqlEx) {
+      localScopeLock.unlock();
+      throw stmt->executeBatchExceptionEpilogue(initialSqlEx, rows);
+    }
+    stmt->executeBatchEpilogue();
+  }
+
   // must have "lock" locked before invoking
   void ServerSidePreparedStatement::executeQueryPrologue(ServerPrepareResult* serverPrepareResult)
   {
@@ -355,6 +643,7 @@ namespace sql
   void ServerSidePreparedStatement::clearParameters()
   {
     currentParameterHolder.clear();
+    listParameters.clear();
     //currentParameterHolder.assign(serverPrepareResult->getParamCount(), Shared::ParameterHolder());
     hasLongData= false;
   }
@@ -362,9 +651,13 @@ namespace sql
 
   void ServerSidePreparedStatement::validParameters()
   {
+    if (boundValues != nullptr) {
+      validValues(static_cast<std::size_t>(parameterCount));
+      return;
+    }
     for (int32_t i= 0; i < parameterCount; i++)
     {
-      if (currentParameterHolder.find(i) == currentParameterHolder.end())
+      if (currentParameterHolder.find(i) == currentParameterHolder.end() && listParameters.find(i) == listParameters.end())
       {
         logger->error("Parameter at position " + std::to_string(i + 1) + " is not set" );
         exceptionFactory->raiseStatementError(connection, stmt.get())->create("Parameter at position "+ std::to_string(i+1) + " is not set", "07004").Throw();
@@ -373,23 +666,84 @@ namespace sql
   }
 
 
-  bool ServerSidePreparedStatement::executeInternal(int32_t fetchSize)
+  /* Parameters go as their text protocol values after the query. Long data has been sent already, and isn't cached */
+  int64_t ServerSidePreparedStatement::getResultCacheQuery(SQLString& query)
+  {
+    int64_t ttl= stmt->resultCacheTtlFor(sql);
+
+    if (ttl == 0 || hasLongData) {
+      return 0;
+    }
+    validParameters();
+    query.append(sql);
+    for (int32_t i= 0; i < parameterCount; ++i) {
+      auto list= listParameters.find(i);
+      if (list == listParameters.end()) {
+        query.append('\0');
+        currentParameterHolder[i]->writeTo(query);
+        continue;
+      }
+      query.append('\1');
+      for (auto& value : list->second) {
+        query.append('\0');
+        value->writeTo(query);
+      }
+    }
+    return ttl;
+  }
+
+
+  /* Executes the prepared statement with the protocol of the given type - not virtual calls for the MasterProtocol.
+     Returns false if the error was put to the error info */
+  template <class ProtocolType>
+  bool ServerSidePreparedStatement::sendExecute(ProtocolType& executor, ServerPrepareResult* pr,
+    std::vector<Shared::ParameterHolder>& parameterHolders, ErrorInfo* error)
+  {
+    if (boundValues != nullptr) {
+      executor.executePreparedQuery(mustExecuteOnMaster, pr, stmt->getInternalResults(), boundValues);
+    }
+    else if (error == nullptr) {
+      executor.executePreparedQuery(mustExecuteOnMaster, pr, stmt->getInternalResults(), parameterHolders);
+    }
+    else {
+      return executor.tryExecutePreparedQuery(
+        mustExecuteOnMaster, pr, stmt->getInternalResults(), parameterHolders, *error);
+    }
+    return true;
+  }
+
+
+  bool ServerSidePreparedStatement::executeInternal(int32_t fetchSize, bool isRetry, ErrorInfo* error)
   {
     validParameters();
+    // Long data sent for the statement cannot be sent once more
+    bool mayRetry= !isRetry && !hasLongData && stmt->mayRetryOnFailover(sql);
+    // Long data has to be sent for the prepared statement id before the execution. Values of executeWith are bound to
+    // the prepared statement right away
+    if (hasLongData || boundValues != nullptr) {
+      ensurePrepared();
+    }
+    // Statement of the query with list markers expanded. Values of executeWith go to the query as it is
+    std::vector<Shared::ParameterHolder> parameterHolders;
+    ServerPrepareResult* pr= serverPrepareResult.get();
+    if (!listParameters.empty() && boundValues == nullptr) {
+      pr= prepareListShape(parameterHolders);
+    }
 
-    std::unique_lock<std::mutex> localScopeLock(*protocol->getLock());
+    std::unique_lock<ConnectionMutex> localScopeLock(*protocol->getLock());
     try {
-      executeQueryPrologue(serverPrepareResult.get());
-      if (stmt->getQueryTimeout() !=0) {
+      executeQueryPrologue(pr);
+      if (stmt->getQueryTimeoutMs() !=0) {
         stmt->setTimerTask(false);
       }
 
-      std::vector<Shared::ParameterHolder> parameterHolders;
-      std::for_each(currentParameterHolder.cbegin(), currentParameterHolder.cend(), /*std::back_inserter(queryParameters),*/
-        [&parameterHolders](const std::map<int32_t, Shared::ParameterHolder>::value_type& mapEntry) {parameterHolders.push_back(mapEntry.second); });
+      if (boundValues == nullptr && pr != listShapeResult.get()) {
+        std::for_each(currentParameterHolder.cbegin(), currentParameterHolder.cend(), /*std::back_inserter(queryParameters),*/
+          [&parameterHolders](const std::map<int32_t, Shared::ParameterHolder>::value_type& mapEntry) {parameterHolders.push_back(mapEntry.second); });
+      }
 
       stmt->setInternalResults(
-        new Results(
+        std::make_shared<Results>(
           this,
           fetchSize,
           false,
@@ -399,12 +753,22 @@ namespace sql
           stmt->getResultSetConcurrency(),
           autoGeneratedKeys,
           protocol->getAutoIncrementIncrement(),
-          sql,
-          parameterHolders));
-
-      serverPrepareResult->resetParameterTypeHeader();
-      protocol->executePreparedQuery(
-        mustExecuteOnMaster, serverPrepareResult.get(), stmt->getInternalResults(), parameterHolders);
+          sql));
+
+      if (pr != nullptr) {
+        pr->resetParameterTypeHeader();
+        if (!(directProtocol != nullptr ? sendExecute(*directProtocol, pr, parameterHolders, error)
+                                        : sendExecute(*protocol, pr, parameterHolders, error))) {
+          stmt->executeEpilogue();
+          localScopeLock.unlock();
+          executeErrorEpilogue(*error);
+          return false;
+        }
+      }
+      else {
+        serverPrepareResult.reset(protocol->prepareAndExecute(sql, stmt->getInternalResults(), parameterHolders));
+        setMetaFromResult();
+      }
 
       stmt->getInternalResults()->commandEnd();
       stmt->executeEpilogue();
@@ -414,6 +778,16 @@ namespace sql
     catch (SQLException& exception) {
       stmt->executeEpilogue();
       localScopeLock.unlock();
+      if (stmt->failoverForRetry(exception, mayRetry)) {
+        // Statement handle belongs to the lost connection. It is prepared again on the new one with the execution
+        serverPrepareResult.reset();
+        listShapeResult.reset();
+        return executeInternal(fetchSize, true, error);
+      }
+      if (error != nullptr) {
+        executeExceptionEpilogue(exception, *error);
+        return false;
+      }
       executeExceptionEpilogue(exception).Throw();
     }
     //To please compilers etc
@@ -425,7 +799,7 @@ namespace sql
     if (stmt->isClosed()) {
       return;
     }
-    std::lock_guard<std::mutex> localScopeLock(*protocol->getLock());
+    std::lock_guard<ConnectionMutex> localScopeLock(*protocol->getLock());
 
     stmt->markClosed();
     if (stmt->getInternalResults()) {
@@ -435,9 +809,22 @@ namespace sql
       stmt->getInternalResults()->close();
     }
 
+    // The prepare, that the cache keeps for other statements, is not the statement's any more. Otherwise it is deleted
+    // with the statement
     if (serverPrepareResult != nullptr && protocol) {
       try {
-        serverPrepareResult->getUnProxiedProtocol()->releasePrepareStatement(serverPrepareResult.get());
+        if (!serverPrepareResult->getUnProxiedProtocol()->releasePrepareStatement(serverPrepareResult.get())) {
+          serverPrepareResult.release();
+        }
+      }
+      catch (SQLException&) {
+      }
+    }
+    if (listShapeResult && protocol) {
+      try {
+        if (!listShapeResult->getUnProxiedProtocol()->releasePrepareStatement(listShapeResult.get())) {
+          listShapeResult.release();
+        }
       }
       catch (SQLException&) {
       }
@@ -464,7 +851,7 @@ namespace sql
     */
   SQLString ServerSidePreparedStatement::toString()
   {
-    SQLString sb("sql : '"+serverPrepareResult->getSql()+"'");
+    SQLString sb("sql : '"+(serverPrepareResult ? serverPrepareResult->getSql() : sql)+"'");
     if (parameterCount > 0) {
       sb.append(", parameters : [");
       for (int32_t i= 0; i < parameterCount; i++)
@@ -492,6 +879,9 @@ namespace sql
     */
   int64_t ServerSidePreparedStatement::getServerThreadId()
   {
+    if (!serverPrepareResult) {
+      return protocol->getServerThreadId();
+    }
     return serverPrepareResult->getUnProxiedProtocol()->getServerThreadId();
   }
 }
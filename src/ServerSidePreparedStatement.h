@@ -36,7 +36,7 @@ class MariaDbResultSetMetaData;
 /* For the sake of speeed(of initial development), leaving it derived from BasePreparedStatement and it's partial PS implementation
  * In future I guess we should get rid of that
  */
-class ServerSidePreparedStatement : public BasePrepareStatement {
+class ServerSidePreparedStatement final : public BasePrepareStatement {
 
   static const Shared::Logger logger ; /*LoggerFactory.getLogger(typeid(ServerSidePreparedStatement))*/
 
@@ -53,6 +53,11 @@ private:
 
   std::map<int32_t,Shared::ParameterHolder> currentParameterHolder;
   std::vector<std::vector<Shared::ParameterHolder>> queryParameters;
+  std::map<int32_t, ParameterArray> parameterArrays;
+  std::size_t parameterArrayRows= 0;
+  /* Values of the list parameters by the index, and the statement of the query expanded for their current sizes */
+  std::map<int32_t, std::vector<Shared::ParameterHolder>> listParameters;
+  Unique::ServerPrepareResult listShapeResult;
 
   bool mustExecuteOnMaster;
 
@@ -65,6 +70,7 @@ public:
     int32_t autoGeneratedKeys,
     Shared::ExceptionFactory& factory);
   ServerSidePreparedStatement* clone(MariaDbConnection* connection);
+  PreparedStatement* clone(Connection* connection);
 
 private:
   ServerSidePreparedStatement(
@@ -76,10 +82,20 @@ private:
     Shared::ExceptionFactory& factory);
 
   void prepare(const SQLString& sql);
+  bool defersPrepare() const;
+  void ensurePrepared();
   void setMetaFromResult();
 
 public:
   void setParameter(int32_t parameterIndex,/*const*/ ParameterHolder* holder);
+  ParameterHolder* getReusableParameter(int32_t parameterIndex);
+  void setArray(int32_t parameterIndex, const int32_t* values, const char* nullIndicators, std::size_t rows);
+  void setArray(int32_t parameterIndex, const int64_t* values, const char* nullIndicators, std::size_t rows);
+  void setArray(int32_t parameterIndex, const double* values, const char* nullIndicators, std::size_t rows);
+  void setArray(int32_t parameterIndex, const char* const* values, const unsigned long* lengths,
+    const char* nullIndicators, std::size_t rows);
+  void setList(int32_t parameterIndex, const int64_t* values, std::size_t count);
+  void setList(int32_t parameterIndex, const SQLString* values, std::size_t count);
   void addBatch();
   void addBatch(const SQLString& sql);
   void clearBatch();
@@ -90,14 +106,22 @@ public:
 
 private:
   void executeBatchInternal(int32_t queryParameterSize);
+  void executeArrayBatchInternal();
+  void setParameterArray(int32_t parameterIndex, const ParameterArray& parameterArray, std::size_t rows);
+  void setListParameter(int32_t parameterIndex, std::vector<Shared::ParameterHolder>&& values);
+  ServerPrepareResult* prepareListShape(std::vector<Shared::ParameterHolder>& parameterHolders);
   void executeQueryPrologue(ServerPrepareResult* serverPrepareResult);
+  template <class ProtocolType>
+  bool sendExecute(ProtocolType& executor, ServerPrepareResult* pr, std::vector<Shared::ParameterHolder>& parameterHolders,
+    ErrorInfo* error);
 
 public:
   void clearParameters();
 
 //protected: //TODO: again, not the best idea to have these public
   void validParameters();
-  bool executeInternal(int32_t fetchSize);
+  bool executeInternal(int32_t fetchSize, bool isRetry= false, ErrorInfo* error= nullptr);
+  int64_t getResultCacheQuery(SQLString& query);
 
 public:
   void close();
@@ -74,5 +74,57 @@ namespace mariadb
     return sqlStateGroup;
   }
 
+  /**
+    * Class of the error by its sqlstate, i.e. the SQLException subclass for the error.
+    *
+    * @param sqlState sqlstate
+    * @param timeout was timeout on query
+    * @param cause cause of the error
+    * @return kind of the error
+    */
+  ErrorInfo::Kind SqlStates::classify(const SQLString& sqlState, bool timeout, const std::exception* cause)
+  {
+    const SqlStates state(fromString(sqlState));
+
+    if (state.getSqlState().compare(DATA_EXCEPTION.getSqlState()) == 0) {
+      return ErrorInfo::DATA;
+    }
+    else if (state.getSqlState().compare(FEATURE_NOT_SUPPORTED.getSqlState()) == 0) {
+      return ErrorInfo::FEATURE_NOT_SUPPORTED;
+    }
+    else if (state.getSqlState().compare(CONSTRAINT_VIOLATION.getSqlState()) == 0) {
+      return ErrorInfo::INTEGRITY_CONSTRAINT_VIOLATION;
+    }
+    else if (state.getSqlState().compare(INVALID_AUTHORIZATION.getSqlState()) == 0) {
+      return ErrorInfo::INVALID_AUTHORIZATION;
+    }
+    else if (state.getSqlState().compare(CONNECTION_EXCEPTION.getSqlState()) == 0) {
+      return ErrorInfo::NON_TRANSIENT_CONNECTION;
+    }
+    else if (state.getSqlState().compare(SYNTAX_ERROR_ACCESS_RULE.getSqlState()) == 0) {
+      return ErrorInfo::SYNTAX;
+    }
+    else if (state.getSqlState().compare(TRANSACTION_ROLLBACK.getSqlState()) == 0) {
+      return ErrorInfo::TRANSACTION_ROLLBACK;
+    }
+    else if (state.getSqlState().compare(INTERRUPTED_EXCEPTION.getSqlState()) == 0) {
+      if (timeout && sqlState.compare("70100") == 0) {
+        return ErrorInfo::TIMEOUT;
+      }
+      else if (INSTANCEOF(cause, const SQLNonTransientConnectionException*)) {
+        return ErrorInfo::NON_TRANSIENT_CONNECTION;
+      }
+      return ErrorInfo::TRANSIENT;
+    }
+    else if (state.getSqlState().compare(TIMEOUT_EXCEPTION.getSqlState()) == 0) {
+      return ErrorInfo::TIMEOUT;
+    }
+    else if (state.getSqlState().compare(UNDEFINED_SQLSTATE.getSqlState()) == 0
+      && INSTANCEOF(cause, const SQLNonTransientConnectionException*)) {
+      return ErrorInfo::NON_TRANSIENT_CONNECTION;
+    }
+    return ErrorInfo::GENERIC;
+  }
+
 }
 }
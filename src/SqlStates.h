@@ -38,6 +38,7 @@ class SqlStates
 
   SqlStates(const char* stateGroup );
   static SqlStates fromString(const SQLString& group);
+  static ErrorInfo::Kind classify(const SQLString& sqlState, bool timeout, const std::exception* cause);
   const SQLString& getSqlState() const;
 };
 
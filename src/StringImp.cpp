@@ -21,6 +21,16 @@
 
 namespace sql
 {
+#ifdef MARIADB_INLINE_SQLSTRING
+  std::string& StringImp::get(SQLString& str) {
+    return str.theString;
+  }
+
+
+  const std::string& StringImp::get(const SQLString& str) {
+    return str.theString;
+  }
+#else
   std::string& StringImp::get(SQLString& str) {
     return str.theString->realStr;
   }
@@ -29,6 +39,7 @@ namespace sql
   const std::string& StringImp::get(const SQLString& str) {
     return str.theString->realStr;
   }
+#endif
 
 
   StringImp::StringImp(const char* str) : realStr(str) {
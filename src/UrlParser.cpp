@@ -23,7 +23,9 @@
 #include "options/DefaultOptions.h"
 #include "pool/GlobalStateInfo.h"
 #include "Exception.hpp"
-#include "credential/CredentialPluginLoader.h"
+#ifndef MARIADB_NO_CREDENTIAL_PLUGINS
+# include "credential/CredentialPluginLoader.h"
+#endif
 #include "logger/LoggerFactory.h"
 
 namespace sql
@@ -49,6 +51,19 @@ namespace mariadb
     return false;
   }
 
+  /* Plugin of the credentialType option. Without the loader compiled in, there is none, as for unknown types */
+#ifdef MARIADB_NO_CREDENTIAL_PLUGINS
+  static std::shared_ptr<CredentialPlugin> loadCredentialPlugin(const SQLString& /*type*/)
+  {
+    return nullptr;
+  }
+#else
+  static std::shared_ptr<CredentialPlugin> loadCredentialPlugin(const SQLString& type)
+  {
+    return CredentialPluginLoader::get(StringImp::get(type));
+  }
+#endif
+
 
   UrlParser::UrlParser() : options(new Options())
   {}
@@ -73,7 +88,7 @@ namespace mariadb
         }
       }
     }
-    this->credentialPlugin= CredentialPluginLoader::get(StringImp::get(options->credentialType));
+    this->credentialPlugin= loadCredentialPlugin(options->credentialType);
     DefaultOptions::postOptionProcess(options, credentialPlugin.get());
     setInitialUrl();
     loadMultiMasterValue();
@@ -119,7 +134,7 @@ namespace mariadb
       }
       urlParser.haMode= parseHaMode(url, separator);
 
-      if (urlParser.haMode != HaMode::NONE)
+      if (urlParser.haMode != HaMode::NONE && urlParser.haMode != HaMode::REPLICATION)
       {
         throw SQLFeatureNotImplementedException(SQLString("Support of the HA mode") + HaModeStrMap[urlParser.haMode] + "is not yet implemented");
       }
@@ -182,7 +197,7 @@ namespace mariadb
       urlParser.database= "";
       urlParser.options= DefaultOptions::parse(urlParser.haMode, emptyStr, properties, urlParser.options);
     }
-    urlParser.credentialPlugin= CredentialPluginLoader::get(StringImp::get(urlParser.options->credentialType));
+    urlParser.credentialPlugin= loadCredentialPlugin(urlParser.options->credentialType);
     DefaultOptions::postOptionProcess(urlParser.options, urlParser.credentialPlugin.get());
 
     LoggerFactory::init(
@@ -432,10 +447,13 @@ namespace mariadb
   }
 
 
-  UrlParser* UrlParser::clone()
+  /* With shareOptions the clone refers the same Options object, that none of them may change then */
+  UrlParser* UrlParser::clone(bool shareOptions)
   {
     UrlParser *tmpUrlParser= new UrlParser(*this);
-    tmpUrlParser->options.reset(options->clone());
+    if (!shareOptions) {
+      tmpUrlParser->options.reset(options->clone());
+    }
     tmpUrlParser->addresses.assign(this->addresses.begin(), this->addresses.end());
 
     return tmpUrlParser;
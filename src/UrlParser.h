@@ -82,7 +82,7 @@ protected:
   public:  int64_t hashCode() const;
   private: void loadMultiMasterValue();
   public:  bool isMultiMaster();
-  public:  UrlParser* clone();
+  public:  UrlParser* clone(bool shareOptions= false);
 };
 }
 }
@@ -46,6 +46,9 @@ public:
   virtual std::vector<int32_t>& getUpdateCounts()=0;
   virtual std::vector<int32_t>& getServerUpdateCounts()=0;
   virtual std::vector<int64_t>& getLargeUpdateCounts()=0;
+  /* Update counts and insert ids of the commands as they came from the server. Returns the number of commands */
+  virtual std::size_t getServerResults(const int64_t*& updateCounts, const int64_t*& insertIds,
+    int32_t& autoIncrement)=0;
   virtual int32_t getUpdateCount()=0;
   virtual int64_t getLargeUpdateCount()=0;
   virtual void addSuccessStat(int64_t updateCount,int64_t insertId)=0;
@@ -54,10 +57,16 @@ public:
   virtual void addResultSetStat()=0;
   virtual ResultSet* getGeneratedKeys(Protocol* protocol, const SQLString& sql)=0;
   virtual ResultSet* getBatchGeneratedKeys(Protocol* protocol)=0;
+  /* Insert id of the current result, or of the last command of the batch, that has generated ids. 0 if none */
+  virtual int64_t getLastInsertId()=0;
   virtual int32_t getCurrentStatNumber()=0;
   virtual bool moreResults()=0;
   virtual bool isCurrentUpdateCount()=0;
   virtual void setRewrite(bool rewritten)=0;
+  /* Number of rows in each of the rewritten queries, and the range of the update count of one row. Lets the rewritten
+     batch report exact update counts of the rows, if the query's count tells them */
+  virtual void setRewriteRows(const std::vector<std::size_t>& queryRows, int32_t rowUpdateCountMin,
+    int32_t rowUpdateCountMax)=0;
 };
 
 }
@@ -49,6 +49,8 @@ namespace mariadb
   void CmdInformationBatch::addErrorStat()
   {
     hasException= true;
+    // Keeping insert ids aligned with update counts
+    insertIds.push_back(0);
     updateCounts.push_back(static_cast<int64_t>(Statement::EXECUTE_FAILED));
   }
 
@@ -60,11 +62,13 @@ namespace mariadb
     insertIdNumber= 0;
     hasException= false;
     rewritten= false;
+    rewriteRows.clear();
   }
 
 
   void CmdInformationBatch::addResultSetStat()
   {
+    insertIds.push_back(0);
     this->updateCounts.push_back(static_cast<int64_t>(RESULT_SET_VALUE));
   }
 
@@ -77,10 +81,46 @@ namespace mariadb
   }
 
 
+  /**
+    * Update counts of the rows of the rewritten batch, that each query's count tells exactly - if it is the number of its
+    * rows times the lowest or the highest count of one row, all rows have that count. E.g. N for N rows of INSERT is 1
+    * for each row, and 2N for N rows with ON DUPLICATE KEY UPDATE is 2 for each. Otherwise rows of the query get
+    * SUCCESS_NO_INFO.
+    *
+    * @param counts counts of the rows to fill
+    * @return false if the counts are not known for the queries
+    */
+  template <typename T>
+  bool CmdInformationBatch::rewrittenRowCounts(std::vector<T>& counts)
+  {
+    if (hasException || rewriteRows.empty() || rewriteRows.size() != updateCounts.size()) {
+      return false;
+    }
+    counts.reserve(expectedSize);
+    for (std::size_t i= 0; i < rewriteRows.size(); ++i) {
+      const int64_t rows= static_cast<int64_t>(rewriteRows[i]);
+      T rowCount= static_cast<T>(Statement::SUCCESS_NO_INFO);
+
+      if (updateCounts[i] == rows*rowUpdateCountMin) {
+        rowCount= static_cast<T>(rowUpdateCountMin);
+      }
+      else if (updateCounts[i] == rows*rowUpdateCountMax) {
+        rowCount= static_cast<T>(rowUpdateCountMax);
+      }
+      counts.insert(counts.end(), rewriteRows[i], rowCount);
+    }
+    counts.resize(expectedSize, static_cast<T>(Statement::EXECUTE_FAILED));
+    return true;
+  }
+
+
   std::vector<int32_t>& CmdInformationBatch::getUpdateCounts()
   {
     batchRes.clear();
     if (rewritten) {
+      if (rewrittenRowCounts(batchRes)) {
+        return batchRes;
+      }
       
       int32_t resultValue;
 
@@ -134,6 +174,9 @@ namespace mariadb
   {
     largeBatchRes.clear();
     if (rewritten) {
+      if (rewrittenRowCounts(largeBatchRes)) {
+        return largeBatchRes;
+      }
 
       int64_t resultValue;
       if (hasException) {
@@ -173,6 +216,16 @@ namespace mariadb
   }
 
 
+  std::size_t CmdInformationBatch::getServerResults(const int64_t*& _updateCounts, const int64_t*& _insertIds,
+    int32_t& _autoIncrement)
+  {
+    _updateCounts= updateCounts.data();
+    _insertIds= insertIds.data();
+    _autoIncrement= autoIncrement;
+    return updateCounts.size();
+  }
+
+
   int32_t CmdInformationBatch::getUpdateCount()
   {
     return (updateCounts.size() == 0 ? -1 : static_cast<int32_t>(updateCounts.front()));
@@ -187,25 +240,8 @@ namespace mariadb
 
   ResultSet* CmdInformationBatch::getBatchGeneratedKeys(Protocol* protocol)
   {
-    std::vector<int64_t> ret;
-    int32_t position= 0;
-    int64_t insertId;
-    auto idIterator= insertIds.begin();
-
-    ret.reserve(static_cast<std::size_t>(insertIdNumber));
-
-    for (int64_t updateCountLong : updateCounts) {
-      int32_t updateCount= static_cast<int32_t>(updateCountLong);
-      if (updateCount != Statement::EXECUTE_FAILED
-        && updateCount != RESULT_SET_VALUE
-        && (insertId= *idIterator) > 0) {
-        for (int64_t i= 0; i < updateCount; i++) {
-          ret[position++]= insertId + i*autoIncrement;
-        }
-      }
-      ++idIterator;
-    }
-    return SelectResultSet::createGeneratedData(ret, protocol, true);
+    return SelectResultSet::createGeneratedData(updateCounts.data(), insertIds.data(), updateCounts.size(),
+      autoIncrement, protocol);
   }
 
   /**
@@ -218,25 +254,18 @@ namespace mariadb
     */
   ResultSet* CmdInformationBatch::getGeneratedKeys(Protocol* protocol, const SQLString& /*sql*/)
   {
-    std::vector<int64_t> ret;
-    int32_t position= 0;
-    int64_t insertId;
-    auto idIterator= insertIds.begin();
-
-    ret.reserve(static_cast<size_t>(insertIdNumber));
-
-    for (int64_t updateCountLong : updateCounts) {
-      int32_t updateCount= static_cast<int32_t>(updateCountLong);
-      if (updateCount != Statement::EXECUTE_FAILED
-        && updateCount != RESULT_SET_VALUE
-        && (insertId= *idIterator) > 0) {
-        for (int32_t i= 0; i < updateCount; i++) {
-          ret[position++]= insertId + i*autoIncrement;
-        }
+    return getBatchGeneratedKeys(protocol);
+  }
+
+
+  int64_t CmdInformationBatch::getLastInsertId()
+  {
+    for (auto it= insertIds.rbegin(); it != insertIds.rend(); ++it) {
+      if (*it > 0) {
+        return *it;
       }
-      ++idIterator;
     }
-    return SelectResultSet::createGeneratedData(ret, protocol, true);
+    return 0;
   }
 
 
@@ -262,5 +291,14 @@ namespace mariadb
   {
     this->rewritten= rewritten;
   }
+
+
+  void CmdInformationBatch::setRewriteRows(const std::vector<std::size_t>& queryRows, int32_t _rowUpdateCountMin,
+    int32_t _rowUpdateCountMax)
+  {
+    rewriteRows= queryRows;
+    rowUpdateCountMin= _rowUpdateCountMin;
+    rowUpdateCountMax= _rowUpdateCountMax;
+  }
 }
 }
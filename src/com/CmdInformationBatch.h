@@ -39,6 +39,11 @@ class CmdInformationBatch : public CmdInformation {
   int64_t insertIdNumber ; /*0*/
   bool hasException= false;
   bool rewritten= false;
+  std::vector<std::size_t> rewriteRows;
+  int32_t rowUpdateCountMin= 1;
+  int32_t rowUpdateCountMax= 1;
+
+  template <typename T> bool rewrittenRowCounts(std::vector<T>& counts);
 
 public:
   CmdInformationBatch(std::size_t expectedSize,int32_t autoIncrement);
@@ -49,14 +54,17 @@ public:
   std::vector<int32_t>& getUpdateCounts();
   std::vector<int32_t>& getServerUpdateCounts();
   std::vector<int64_t>& getLargeUpdateCounts();
+  std::size_t getServerResults(const int64_t*& updateCounts, const int64_t*& insertIds, int32_t& autoIncrement);
   int32_t getUpdateCount();
   int64_t getLargeUpdateCount();
   ResultSet* getBatchGeneratedKeys(Protocol* protocol);
+  int64_t getLastInsertId();
   ResultSet* getGeneratedKeys(Protocol* protocol, const SQLString& sql);
   int32_t getCurrentStatNumber();
   bool moreResults();
   bool isCurrentUpdateCount();
   void setRewrite(bool rewritten);
+  void setRewriteRows(const std::vector<std::size_t>& queryRows, int32_t rowUpdateCountMin, int32_t rowUpdateCountMax);
   };
 }
 }
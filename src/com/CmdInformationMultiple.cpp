@@ -48,6 +48,8 @@ namespace mariadb
   void CmdInformationMultiple::addErrorStat()
   {
     hasException= true;
+    // Keeping insert ids aligned with update counts
+    insertIds.push_back(0);
     updateCounts.push_back(static_cast<int64_t>(Statement::EXECUTE_FAILED));
   }
 
@@ -63,6 +65,7 @@ namespace mariadb
 
   void CmdInformationMultiple::addResultSetStat()
   {
+    insertIds.push_back(0);
     updateCounts.push_back(static_cast<int64_t>(RESULT_SET_VALUE));
   }
 
@@ -141,6 +144,16 @@ namespace mariadb
   }
 
 
+  std::size_t CmdInformationMultiple::getServerResults(const int64_t*& _updateCounts, const int64_t*& _insertIds,
+    int32_t& _autoIncrement)
+  {
+    _updateCounts= updateCounts.data();
+    _insertIds= insertIds.data();
+    _autoIncrement= autoIncrement;
+    return updateCounts.size();
+  }
+
+
   int32_t CmdInformationMultiple::getUpdateCount()
   {
     if (static_cast<size_t>(moreResultsIdx) >= updateCounts.size()) {
@@ -159,24 +172,8 @@ namespace mariadb
 
   ResultSet* CmdInformationMultiple::getBatchGeneratedKeys(Protocol* protocol)
   {
-    std::vector<int64_t> ret;
-    int32_t position= 0;
-    int64_t insertId;
-    auto idIterator= insertIds.begin();
-
-    ret.reserve(static_cast<std::size_t>(insertIdNumber));
-
-    for (int64_t updateCount : updateCounts) {
-      if (updateCount != Statement::EXECUTE_FAILED
-        && updateCount != RESULT_SET_VALUE
-        && (insertId= *idIterator)>0) {
-        for (int32_t i= 0; i < updateCount; i++) {
-          ret[position++]= insertId + i*autoIncrement;
-        }
-      }
-      ++idIterator;
-    }
-    return SelectResultSet::createGeneratedData(ret, protocol, true);
+    return SelectResultSet::createGeneratedData(updateCounts.data(), insertIds.data(), updateCounts.size(),
+      autoIncrement, protocol);
   }
 
   /**
@@ -189,27 +186,19 @@ namespace mariadb
     */
   ResultSet* CmdInformationMultiple::getGeneratedKeys(Protocol* protocol, const SQLString& /*sql*/)
   {
-    std::vector<int64_t> ret;
-    int32_t position= 0;
-    int64_t insertId;
-    auto idIterator= insertIds.begin();
-    auto updateIterator= updateCounts.begin();
-
-    ret.reserve(static_cast<size_t>(insertIdNumber));
-
-    for (int32_t element= 0; element <= moreResultsIdx; element++) {
-      int64_t updateCount= *updateIterator;
-      if (updateCount != Statement::EXECUTE_FAILED
-        && updateCount != RESULT_SET_VALUE
-        && (insertId= *idIterator)>0
-        && element == moreResultsIdx) {
-        for (int32_t i= 0; i <updateCount; i++) {
-          ret[position++]= insertId + i*autoIncrement;
-        }
-      }
-      ++idIterator;
+    // Only the current result's ids
+    std::size_t current= static_cast<std::size_t>(moreResultsIdx);
+    if (current >= updateCounts.size()) {
+      return SelectResultSet::createGeneratedData(nullptr, nullptr, 0, autoIncrement, protocol);
     }
-    return SelectResultSet::createGeneratedData(ret, protocol, true);
+    return SelectResultSet::createGeneratedData(&updateCounts[current], &insertIds[current], 1, autoIncrement,
+      protocol);
+  }
+
+  int64_t CmdInformationMultiple::getLastInsertId()
+  {
+    std::size_t current= static_cast<std::size_t>(moreResultsIdx);
+    return current < insertIds.size() ? insertIds[current] : 0;
   }
 
   int32_t CmdInformationMultiple::getCurrentStatNumber()
@@ -232,5 +221,11 @@ namespace mariadb
   {
     this->rewritten= rewritten;
   }
+
+  /* Rewritten batches are executed with CmdInformationBatch */
+  void CmdInformationMultiple::setRewriteRows(const std::vector<std::size_t>& /*queryRows*/,
+    int32_t /*rowUpdateCountMin*/, int32_t /*rowUpdateCountMax*/)
+  {
+  }
 }
 }
@@ -50,14 +50,17 @@ public:
   std::vector<int32_t>& getServerUpdateCounts();
   std::vector<int32_t>& getUpdateCounts();
   std::vector<int64_t>& getLargeUpdateCounts();
+  std::size_t getServerResults(const int64_t*& updateCounts, const int64_t*& insertIds, int32_t& autoIncrement);
   int32_t getUpdateCount();
   int64_t getLargeUpdateCount();
   ResultSet* getBatchGeneratedKeys(Protocol* protocol);
+  int64_t getLastInsertId();
   ResultSet* getGeneratedKeys(Protocol* protocol, const SQLString& sql);
   int32_t getCurrentStatNumber();
   bool moreResults();
   bool isCurrentUpdateCount();
   void setRewrite(bool rewritten);
+  void setRewriteRows(const std::vector<std::size_t>& queryRows, int32_t rowUpdateCountMin, int32_t rowUpdateCountMax);
   };
 }
 }
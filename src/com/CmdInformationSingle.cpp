@@ -40,6 +40,13 @@ namespace mariadb
   {
   }
 
+  void CmdInformationSingle::set(int64_t _insertId, int64_t _updateCount, int32_t _autoIncrement)
+  {
+    insertId= _insertId;
+    updateCount= _updateCount;
+    autoIncrement= _autoIncrement;
+  }
+
   std::vector<int32_t>& CmdInformationSingle::getUpdateCounts()
   {
     batchRes[0]= static_cast<int32_t>(updateCount);
@@ -58,6 +65,15 @@ namespace mariadb
     return largeBatchRes;
   }
 
+  std::size_t CmdInformationSingle::getServerResults(const int64_t*& updateCounts, const int64_t*& insertIds,
+    int32_t& _autoIncrement)
+  {
+    updateCounts= &updateCount;
+    insertIds= &insertId;
+    _autoIncrement= autoIncrement;
+    return 1;
+  }
+
   int32_t CmdInformationSingle::getUpdateCount()
   {
     return static_cast<int32_t>(updateCount);
@@ -167,6 +183,11 @@ namespace mariadb
   }
 
 
+  int64_t CmdInformationSingle::getLastInsertId()
+  {
+    return insertId;
+  }
+
   int32_t CmdInformationSingle::getCurrentStatNumber()
   {
     return 1;
@@ -194,5 +215,12 @@ namespace mariadb
   {
 
   }
+
+  /* Have nothing to do, but must implement */
+  void CmdInformationSingle::setRewriteRows(const std::vector<std::size_t>& /*queryRows*/, int32_t /*rowUpdateCountMin*/,
+    int32_t /*rowUpdateCountMax*/)
+  {
+
+  }
 }
 }
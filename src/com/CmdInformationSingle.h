@@ -33,15 +33,18 @@ namespace mariadb
 
 class CmdInformationSingle  : public CmdInformation {
 
-  const int64_t insertId;
+  int64_t insertId;
   int32_t autoIncrement;
   int64_t updateCount;
 
 public:
   CmdInformationSingle(int64_t insertId,int64_t updateCount,int32_t autoIncrement);
+  /* For recycling of the object by the next execution */
+  void set(int64_t insertId, int64_t updateCount, int32_t autoIncrement);
   std::vector<int32_t>& getUpdateCounts();
   std::vector<int32_t>& getServerUpdateCounts();
   std::vector<int64_t>& getLargeUpdateCounts();
+  std::size_t getServerResults(const int64_t*& updateCounts, const int64_t*& insertIds, int32_t& autoIncrement);
   int32_t getUpdateCount();
   int64_t getLargeUpdateCount();
   void addErrorStat();
@@ -54,11 +57,13 @@ private:
 
 public:
   ResultSet* getBatchGeneratedKeys(Protocol* protocol);
+  int64_t getLastInsertId();
   int32_t getCurrentStatNumber();
   bool moreResults();
   bool isCurrentUpdateCount();
   void addSuccessStat(int64_t updateCount,int64_t insertId);
   void setRewrite(bool rewritten);
+  void setRewriteRows(const std::vector<std::size_t>& queryRows, int32_t rowUpdateCountMin, int32_t rowUpdateCountMax);
   };
 }
 }
@@ -18,6 +18,9 @@
 *************************************************************************************/
 
 
+#include <algorithm>
+#include <cctype>
+
 #include "ColumnNameMap.h"
 
 #include "ColumnDefinition.h"
@@ -35,7 +38,118 @@ namespace mariadb
   void ColumnNameMap::init(std::vector<Shared::ColumnDefinition>& columnInformations)
   {
     columnInfo= &columnInformations;
+    table.clear();
+    mask= 0;
+  }
+
+
+  static inline char foldCase(char c)
+  {
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+  }
+
+  /* FNV-1a of the case-folded name */
+  std::size_t ColumnNameMap::hashName(const char* name, std::size_t length)
+  {
+    std::size_t hash= 2166136261U;
+    for (std::size_t i= 0; i < length; ++i) {
+      hash^= static_cast<unsigned char>(foldCase(name[i]));
+      hash*= 16777619U;
+    }
+    return hash;
+  }
+
+
+  void ColumnNameMap::insertKey(std::string& key, int32_t index)
+  {
+    std::size_t hash= hashName(key.c_str(), key.length());
+
+    for (std::size_t slot= hash & mask;; slot= (slot + 1) & mask) {
+      Entry& entry= table[slot];
+      if (entry.index < 0) {
+        entry.key.swap(key);
+        entry.hash= hash;
+        entry.index= index;
+        return;
+      }
+      if (entry.hash == hash && entry.key == key) {
+        // The first one wins
+        return;
+      }
+    }
+  }
+
+
+  void ColumnNameMap::insert(const char* tableName, std::size_t tableLength, const char* name, std::size_t length,
+    int32_t index)
+  {
+    if (length == 0) {
+      return;
+    }
+    std::string key(name, length);
+    std::transform(key.begin(), key.end(), key.begin(), foldCase);
+
+    if (tableLength > 0) {
+      std::string fullKey(tableName, tableLength);
+      std::transform(fullKey.begin(), fullKey.end(), fullKey.begin(), foldCase);
+      fullKey.append(1, '.').append(key);
+      insertKey(key, index);
+      insertKey(fullKey, index);
+    }
+    else {
+      insertKey(key, index);
+    }
+  }
+
+
+  void ColumnNameMap::build()
+  {
+    // Each column may give up to 4 keys, and table is kept not more than half full
+    std::size_t capacity= 8;
+    while (capacity < columnInfo->size()*8) {
+      capacity<<= 1;
+    }
+    table.assign(capacity, Entry());
+    mask= capacity - 1;
+
+    int32_t counter= 0;
+    std::size_t tableLength, length;
+    // Aliases go first, so they shadow original names. Names are read from the column definitions without copies
+    for (auto& ci : *columnInfo) {
+      const char* tableName= ci->getTableView(tableLength);
+      const char* name= ci->getNameView(length);
+      insert(tableName, tableLength, name, length, counter++);
+    }
+    counter= 0;
+    for (auto& ci : *columnInfo) {
+      const char* tableName= ci->getOriginalTableView(tableLength);
+      const char* name= ci->getOriginalNameView(length);
+      insert(tableName, tableLength, name, length, counter++);
+    }
+  }
+
+
+  int32_t ColumnNameMap::find(const char* name, std::size_t length) const
+  {
+    std::size_t hash= hashName(name, length);
+
+    for (std::size_t slot= hash & mask;; slot= (slot + 1) & mask) {
+      const Entry& entry= table[slot];
+      if (entry.index < 0) {
+        return -1;
+      }
+      if (entry.hash == hash && entry.key.length() == length) {
+        std::size_t i= 0;
+        while (i < length && entry.key[i] == foldCase(name[i])) {
+          ++i;
+        }
+        if (i == length) {
+          return entry.index;
+        }
+      }
+    }
   }
+
   /**
     * Get column index by name.
     *
@@ -48,82 +162,18 @@ namespace mariadb
     if (name.empty() == true) {
       throw SQLException("Column name cannot be empty");
     }
-    SQLString lowerName(name);
-
-    lowerName.toLowerCase();
-
-    if (aliasMap.empty())
-    {
-      int32_t counter= 0;
-
-      for (auto& ci : *columnInfo)
-      {
-        SQLString columnAlias(ci->getName());
-        if (!columnAlias.empty())
-        {
-          columnAlias.toLowerCase();
-
-          if (aliasMap.find(columnAlias) == aliasMap.end())
-          {
-            aliasMap.emplace(columnAlias, counter);
-          }
-
-          SQLString keyName(ci->getTable());
-
-          if (!keyName.empty())
-          {
-            keyName.toLowerCase().append('.').append(columnAlias);
-            if (aliasMap.find(keyName) != aliasMap.end())
-            {
-              aliasMap.emplace(keyName, counter);
-            }
-          }
-        }
-        ++counter;
-      }
-    }
-
-    const auto& cit= aliasMap.find(lowerName);
-    if (cit != aliasMap.end()) {
-      return cit->second;
-    }
 
-    if (originalMap.empty())
-    {
-      int32_t counter= 0;
-      for (auto& ci : *columnInfo)
-      {
-        SQLString columnRealName(ci->getOriginalName());
-
-        if (columnRealName.empty()) {
-          columnRealName= columnRealName.toLowerCase();
-
-          if (originalMap.find(columnRealName) == originalMap.end())
-          {
-            originalMap.emplace(columnRealName, counter);
-          }
-
-          SQLString keyName(ci->getOriginalTable());
-          if (!keyName.empty())
-          {
-            keyName.toLowerCase().append('.').append(columnRealName);
-            if (originalMap.find(keyName) == originalMap.end())
-            {
-              originalMap.emplace(keyName, counter);
-            }
-          }
-        }
-        ++counter;
-      }
+    if (table.empty()) {
+      build();
     }
 
-    const auto& otherCit= originalMap.find(lowerName);
+    int32_t index= find(name.c_str(), name.length());
 
-    if (otherCit == originalMap.end()) {
+    if (index < 0) {
       //throw ExceptionMapper::get("No such column: "+name, "42S22", 1054, NULL, false);
       throw IllegalArgumentException("No such column: " + name, "42S22", 1054);
     }
-    return cit->second;
+    return index;
   }
 
 }
@@ -29,11 +29,26 @@ namespace mariadb
 {
 class ColumnDefinition;
 
+/* Case-insensitive column label to index lookup. Labels are case-folded and put into an open-addressing hash table
+   once per result set, on first lookup. Aliases take precedence over original names, and the first column wins if
+   a label is repeated */
 class ColumnNameMap
 {
+  struct Entry {
+    std::string key; // case-folded label
+    std::size_t hash= 0;
+    int32_t index= -1; // -1 means empty slot
+  };
+
   std::vector<Shared::ColumnDefinition>* columnInfo;
-  std::map<SQLString,int32_t>originalMap;
-  std::map<SQLString,int32_t>aliasMap;
+  std::vector<Entry> table;
+  std::size_t mask= 0;
+
+  static std::size_t hashName(const char* name, std::size_t length);
+  void build();
+  void insert(const char* tableName, std::size_t tableLength, const char* name, std::size_t length, int32_t index);
+  void insertKey(std::string& key, int32_t index);
+  int32_t find(const char* name, std::size_t length) const;
 
 public:
   ColumnNameMap() : columnInfo(nullptr) {}
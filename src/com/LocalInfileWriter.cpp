@@ -0,0 +1,226 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+
+#include <cstring>
+#include <sstream>
+#include <iomanip>
+#include <limits>
+
+#include "LocalInfileWriter.h"
+
+namespace sql
+{
+namespace mariadb
+{
+
+  LocalInfileWriter::LocalInfileWriter(sql::RowProducer& _producer, std::size_t _columnCount)
+    : producer(_producer)
+    , columnCount(_columnCount)
+    , fieldCount(0)
+    , bufferPos(0)
+    , eof(false)
+    , rowCount(0)
+    , errorCode(0)
+  {
+  }
+
+
+  void LocalInfileWriter::startField()
+  {
+    if (fieldCount++ > 0) {
+      buffer.push_back('\t');
+    }
+  }
+
+  /* Copies runs of characters, that do not need escaping, at once */
+  void LocalInfileWriter::appendEscaped(const char* value, std::size_t length)
+  {
+    const char *runStart= value, *end= value + length;
+
+    for (const char* it= value; it < end; ++it) {
+      const char* escaped;
+      switch (*it) {
+      case '\\':
+        escaped= "\\\\";
+        break;
+      case '\t':
+        escaped= "\\t";
+        break;
+      case '\n':
+        escaped= "\\n";
+        break;
+      case '\0':
+        escaped= "\\0";
+        break;
+      default:
+        continue;
+      }
+      buffer.append(runStart, it - runStart);
+      buffer.append(escaped, 2);
+      runStart= it + 1;
+    }
+    buffer.append(runStart, end - runStart);
+  }
+
+
+  void LocalInfileWriter::setNull()
+  {
+    startField();
+    buffer.append("\\N", 2);
+  }
+
+
+  void LocalInfileWriter::setInt64(int64_t value)
+  {
+    startField();
+    buffer.append(std::to_string(value));
+  }
+
+
+  void LocalInfileWriter::setUInt64(uint64_t value)
+  {
+    startField();
+    buffer.append(std::to_string(value));
+  }
+
+
+  void LocalInfileWriter::setDouble(double value)
+  {
+    std::ostringstream doubleAsString;
+    doubleAsString << std::setprecision(std::numeric_limits<double>::max_digits10) << value;
+    startField();
+    buffer.append(doubleAsString.str());
+  }
+
+
+  void LocalInfileWriter::setString(const char* value, std::size_t length)
+  {
+    startField();
+    appendEscaped(value, length);
+  }
+
+
+  void LocalInfileWriter::setString(const SQLString& value)
+  {
+    startField();
+    appendEscaped(value.c_str(), value.length());
+  }
+
+  /* Refills the row buffer with rows of the producer, till it has at least wanted bytes, or rows are over */
+  bool LocalInfileWriter::fillBuffer(std::size_t wanted)
+  {
+    buffer.clear();
+    bufferPos= 0;
+
+    while (buffer.length() < wanted) {
+      fieldCount= 0;
+      if (!producer.nextRow(*this)) {
+        eof= true;
+        break;
+      }
+      if (columnCount > 0 && fieldCount != columnCount) {
+        SQLString msg("Row ");
+        msg.append(std::to_string(rowCount + 1)).append(" has ").append(std::to_string(fieldCount))
+          .append(" values, while ").append(std::to_string(columnCount)).append(" columns are loaded");
+        throw SQLException(msg, "21S01");
+      }
+      buffer.push_back('\n');
+      ++rowCount;
+    }
+    return !buffer.empty();
+  }
+
+
+  int LocalInfileWriter::read(char* buf, uint32_t bufLen)
+  {
+    std::size_t written= 0;
+
+    try {
+      while (written < bufLen) {
+        if (bufferPos == buffer.length() && (eof || !fillBuffer(bufLen))) {
+          break;
+        }
+        std::size_t chunk= std::min<std::size_t>(bufLen - written, buffer.length() - bufferPos);
+        std::memcpy(buf + written, buffer.data() + bufferPos, chunk);
+        written+= chunk;
+        bufferPos+= chunk;
+      }
+    }
+    catch (SQLException& e) {
+      error= std::current_exception();
+      errorMessage= e.what();
+      errorCode= e.getErrorCode() != 0 ? e.getErrorCode() : 2000;
+      return -1;
+    }
+    catch (std::exception& e) {
+      error= std::current_exception();
+      errorMessage= e.what();
+      errorCode= 2000;
+      return -1;
+    }
+    return static_cast<int>(written);
+  }
+
+
+  int LocalInfileWriter::getError(char* buf, uint32_t bufLen)
+  {
+    if (bufLen > 0) {
+      std::size_t length= std::min<std::size_t>(errorMessage.length(), bufLen - 1);
+      std::memcpy(buf, errorMessage.c_str(), length);
+      buf[length]= '\0';
+    }
+    return static_cast<int>(errorCode);
+  }
+
+
+  void LocalInfileWriter::rethrowError()
+  {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+
+  int LocalInfileWriter::localInfileInit(void** ptr, const char* /*fileName*/, void* userData)
+  {
+    *ptr= userData;
+    return 0;
+  }
+
+
+  int LocalInfileWriter::localInfileRead(void* ptr, char* buf, unsigned int bufLen)
+  {
+    return static_cast<LocalInfileWriter*>(ptr)->read(buf, bufLen);
+  }
+
+
+  void LocalInfileWriter::localInfileEnd(void* /*ptr*/)
+  {
+  }
+
+
+  int LocalInfileWriter::localInfileError(void* ptr, char* buf, unsigned int bufLen)
+  {
+    return static_cast<LocalInfileWriter*>(ptr)->getError(buf, bufLen);
+  }
+
+}
+}
@@ -0,0 +1,81 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _LOCALINFILEWRITER_H_
+#define _LOCALINFILEWRITER_H_
+
+#include <exception>
+
+#include "Consts.h"
+#include "BulkLoad.hpp"
+
+namespace sql
+{
+namespace mariadb
+{
+
+/* Serializes rows of the RowProducer into LOAD DATA default format - tab separated fields, rows terminated by new
+   line, backslash as escape character and \N for NULL. Serves as data source of the C API local infile handler.
+   Rows are serialized into the row buffer only when it has been completely copied to the packet buffer of the
+   connector, i.e. the producer is called on demand and at most one packet worth of data is held in memory */
+class LocalInfileWriter : public sql::RowWriter
+{
+  sql::RowProducer& producer;
+  /* 0 means that number of values in the row is not checked */
+  std::size_t columnCount;
+  std::size_t fieldCount;
+  std::string buffer;
+  std::size_t bufferPos;
+  bool eof;
+  int64_t rowCount;
+  std::exception_ptr error;
+  std::string errorMessage;
+  uint32_t errorCode;
+
+  void startField();
+  void appendEscaped(const char* value, std::size_t length);
+  bool fillBuffer(std::size_t wanted);
+
+public:
+  LocalInfileWriter(sql::RowProducer& producer, std::size_t columnCount);
+
+  void setNull();
+  void setInt64(int64_t value);
+  void setUInt64(uint64_t value);
+  void setDouble(double value);
+  void setString(const char* value, std::size_t length);
+  void setString(const SQLString& value);
+
+  int read(char* buf, uint32_t bufLen);
+  int getError(char* buf, uint32_t bufLen);
+  /* Re-throws exception of the producer, if the load has been aborted by it */
+  void rethrowError();
+  int64_t getRowCount() const { return rowCount; }
+
+  /* Callbacks for mysql_set_local_infile_handler. User data is the writer object */
+  static int localInfileInit(void** ptr, const char* fileName, void* userData);
+  static int localInfileRead(void* ptr, char* buf, unsigned int bufLen);
+  static void localInfileEnd(void* ptr);
+  static int localInfileError(void* ptr, char* buf, unsigned int bufLen);
+};
+
+}
+}
+#endif
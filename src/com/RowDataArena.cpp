@@ -0,0 +1,372 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#include <cstdlib>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+# include <windows.h>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <unistd.h>
+#endif
+
+#include "RowDataArena.h"
+
+namespace sql
+{
+namespace mariadb
+{
+
+  void RowDataArena::ChunkDeleter::operator()(char* chunk) const
+  {
+    if (!mapped) {
+      DriverAllocator::deallocate(allocator, chunk, size);
+    }
+    else {
+#ifdef _WIN32
+      UnmapViewOfFile(chunk);
+#else
+      munmap(chunk, size);
+#endif
+    }
+  }
+
+
+  RowDataArena::RowDataArena(std::size_t _columnCount)
+    : columnCount(0)
+    , headerSize(0)
+    , largeRecordsSize(0)
+    , currentChunk(0)
+    , freePtr(nullptr)
+    , chunkFree(0)
+    , spillThreshold(0)
+    , spillFile(-1)
+    , spillFileSize(0)
+    , heapSize(0)
+  {
+    setColumnCount(_columnCount);
+  }
+
+
+  RowDataArena::~RowDataArena()
+  {
+    rows.clear();
+    largeRecords.clear();
+    chunks.clear();
+    closeSpillFile();
+  }
+
+
+  void RowDataArena::setColumnCount(std::size_t _columnCount)
+  {
+    clear();
+    columnCount= _columnCount;
+    // offsets of each cell and of the end of the last one, then null bitmap
+    headerSize= sizeof(uint32_t)*(columnCount + 1) + ((columnCount + 7) >> 3);
+  }
+
+
+  void RowDataArena::clear()
+  {
+    dropChunks(chunks, 1);
+    recycle();
+    closeSpillFile();
+  }
+
+
+  void RowDataArena::recycle()
+  {
+    rows.clear();
+    dropChunks(largeRecords, 0);
+    largeRecordsSize= 0;
+    currentChunk= 0;
+    if (chunks.empty()) {
+      freePtr= nullptr;
+      chunkFree= 0;
+    }
+    else {
+      freePtr= chunks.front().get();
+      chunkFree= DEFAULT_CHUNK_SIZE;
+    }
+  }
+
+
+  void RowDataArena::swap(RowDataArena& other)
+  {
+    std::swap(columnCount, other.columnCount);
+    std::swap(headerSize, other.headerSize);
+    chunks.swap(other.chunks);
+    largeRecords.swap(other.largeRecords);
+    std::swap(largeRecordsSize, other.largeRecordsSize);
+    std::swap(currentChunk, other.currentChunk);
+    std::swap(freePtr, other.freePtr);
+    std::swap(chunkFree, other.chunkFree);
+    rows.swap(other.rows);
+    std::swap(spillThreshold, other.spillThreshold);
+    std::swap(spillFile, other.spillFile);
+    std::swap(spillFileSize, other.spillFileSize);
+    std::swap(heapSize, other.heapSize);
+  }
+
+
+  void RowDataArena::resize(std::size_t rowCount)
+  {
+    if (rowCount == 0) {
+      clear();
+    }
+    else if (rowCount < rows.size()) {
+      rows.resize(rowCount);
+    }
+  }
+
+
+  void RowDataArena::closeSpillFile()
+  {
+    if (spillFile != -1) {
+#ifdef _WIN32
+      CloseHandle(reinterpret_cast<HANDLE>(spillFile));
+#else
+      close(static_cast<int>(spillFile));
+#endif
+      // Mapped chunks, that are still there, keep the file
+      spillFile= -1;
+      spillFileSize= 0;
+    }
+  }
+
+
+  char* RowDataArena::mapSpilled(std::size_t& size)
+  {
+    // Offsets in the file have to be aligned to the page, or to the allocation granularity on Windows
+    size= (size + DEFAULT_CHUNK_SIZE - 1) / DEFAULT_CHUNK_SIZE * DEFAULT_CHUNK_SIZE;
+#ifdef _WIN32
+    if (spillFile == -1) {
+      char dir[MAX_PATH + 1], path[MAX_PATH + 1];
+      DWORD length= GetTempPathA(sizeof(dir), dir);
+
+      if (length == 0 || length > MAX_PATH || GetTempFileNameA(dir, "mdb", 0, path) == 0) {
+        return nullptr;
+      }
+      HANDLE file= CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+        FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, NULL);
+      if (file == INVALID_HANDLE_VALUE) {
+        DeleteFileA(path);
+        return nullptr;
+      }
+      spillFile= reinterpret_cast<std::intptr_t>(file);
+    }
+    uint64_t end= spillFileSize + size;
+    // The mapping of bigger size than the file extends the file
+    HANDLE mapping= CreateFileMappingA(reinterpret_cast<HANDLE>(spillFile), NULL, PAGE_READWRITE,
+      static_cast<DWORD>(end >> 32), static_cast<DWORD>(end), NULL);
+    if (mapping == NULL) {
+      return nullptr;
+    }
+    void* mapped= MapViewOfFile(mapping, FILE_MAP_WRITE, static_cast<DWORD>(spillFileSize >> 32),
+      static_cast<DWORD>(spillFileSize), size);
+    // The view keeps the mapping
+    CloseHandle(mapping);
+    if (mapped == nullptr) {
+      return nullptr;
+    }
+#else
+    if (spillFile == -1) {
+      const char* dir= std::getenv("TMPDIR");
+      std::string path(dir != nullptr && *dir != '\0' ? dir : "/tmp");
+
+      path.append("/mariadb-rows-XXXXXX");
+      int fd= mkstemp(&path[0]);
+      if (fd < 0) {
+        return nullptr;
+      }
+      // Nobody needs the name, and the space is freed, when the file is closed and unmapped
+      unlink(path.c_str());
+      spillFile= fd;
+    }
+    int fd= static_cast<int>(spillFile);
+# ifdef __linux__
+    // Reserving the space - writing to the mapping of the sparse file on the full disk would kill the process with SIGBUS
+    if (posix_fallocate(fd, static_cast<off_t>(spillFileSize), static_cast<off_t>(size)) != 0) {
+      return nullptr;
+    }
+# else
+    if (ftruncate(fd, static_cast<off_t>(spillFileSize + size)) != 0) {
+      return nullptr;
+    }
+# endif
+    void* mapped= mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, static_cast<off_t>(spillFileSize));
+    if (mapped == MAP_FAILED) {
+      return nullptr;
+    }
+#endif
+    spillFileSize+= size;
+    return static_cast<char*>(mapped);
+  }
+
+
+  RowDataArena::Chunk RowDataArena::newChunk(std::size_t size)
+  {
+    if (spillThreshold > 0 && chunks.size()*DEFAULT_CHUNK_SIZE + largeRecordsSize >= spillThreshold) {
+      char* mapped= mapSpilled(size);
+      if (mapped != nullptr) {
+        return Chunk(mapped, ChunkDeleter(size, true));
+      }
+      // If the file cannot be used, rows stay in memory
+    }
+    Allocator* allocator= DriverAllocator::get();
+    Chunk chunk(static_cast<char*>(DriverAllocator::allocate(allocator, size)), ChunkDeleter(size, false, allocator));
+    heapSize+= size;
+    return chunk;
+  }
+
+
+  void RowDataArena::dropChunks(std::vector<Chunk>& list, std::size_t keep)
+  {
+    for (std::size_t i= keep; i < list.size(); ++i) {
+      if (!list[i].get_deleter().mapped) {
+        heapSize-= list[i].get_deleter().size;
+      }
+    }
+    if (list.size() > keep) {
+      list.resize(keep);
+    }
+  }
+
+
+  char* RowDataArena::allocate(std::size_t size)
+  {
+    // Keeping records aligned for the offsets array
+    size= (size + sizeof(uint32_t) - 1) & ~(sizeof(uint32_t) - 1);
+
+    if (size > DEFAULT_CHUNK_SIZE/4) {
+      largeRecords.push_back(newChunk(size));
+      largeRecordsSize+= size;
+      return largeRecords.back().get();
+    }
+    if (size > chunkFree) {
+      if (chunks.empty() || currentChunk + 1 >= chunks.size()) {
+        chunks.push_back(newChunk(DEFAULT_CHUNK_SIZE));
+        currentChunk= chunks.size() - 1;
+      }
+      else {
+        ++currentChunk;
+      }
+      freePtr= chunks[currentChunk].get();
+      chunkFree= DEFAULT_CHUNK_SIZE;
+    }
+    char* result= freePtr;
+    freePtr+= size;
+    chunkFree-= size;
+    return result;
+  }
+
+
+  char* RowDataArena::allocateRecord(std::size_t dataLength)
+  {
+    if (dataLength > UINT32_MAX) {
+      throw SQLException("Row data is too long to be cached in the result set", "HY001");
+    }
+    char* record= allocate(headerSize + dataLength);
+    std::memset(record, 0, headerSize);
+    return record;
+  }
+
+
+  void RowDataArena::setCell(char* record, std::size_t column, const char* value, std::size_t length) const
+  {
+    uint32_t* offset= reinterpret_cast<uint32_t*>(record);
+
+    if (value == nullptr) {
+      record[sizeof(uint32_t)*(columnCount + 1) + (column >> 3)]|= static_cast<char>(1 << (column & 7));
+      offset[column + 1]= offset[column];
+    }
+    else {
+      char* cell= record + headerSize + offset[column];
+      std::memcpy(cell, value, length);
+      // Terminating every cell - text protocol getters may use cell as a C string
+      cell[length]= '\0';
+      offset[column + 1]= offset[column] + static_cast<uint32_t>(length) + 1;
+    }
+  }
+
+
+  void RowDataArena::append(const std::vector<sql::bytes>& rowData)
+  {
+    append([&rowData](std::size_t column, std::size_t& length)->const char* {
+      if (column >= rowData.size() || rowData[column].arr == nullptr) {
+        return nullptr;
+      }
+      length= rowData[column].size();
+      return rowData[column].arr;
+    });
+  }
+
+
+  void RowDataArena::append(const char* const* cells, const unsigned long* lengths)
+  {
+    append([cells, lengths](std::size_t column, std::size_t& length)->const char* {
+      length= static_cast<std::size_t>(lengths[column]);
+      return cells[column];
+    });
+  }
+
+
+  void RowDataArena::replace(std::size_t rowIndex, const std::vector<sql::bytes>& rowData)
+  {
+    append(rowData);
+    rows[rowIndex]= rows.back();
+    rows.pop_back();
+  }
+
+
+  void RowDataArena::erase(std::size_t rowIndex)
+  {
+    rows.erase(rows.begin() + rowIndex);
+  }
+
+
+  void RowDataArena::view(std::size_t rowIndex, std::vector<sql::bytes>& rowView) const
+  {
+    std::size_t length;
+
+    rowView.resize(columnCount);
+    for (std::size_t i= 0; i < columnCount; ++i) {
+      const char* cell= getCell(rowIndex, i, length);
+      rowView[i].wrap(const_cast<char*>(cell), length);
+    }
+  }
+
+
+  const char* RowDataArena::getCell(std::size_t rowIndex, std::size_t column, std::size_t& length) const
+  {
+    if (isNull(rowIndex, column)) {
+      length= 0;
+      return nullptr;
+    }
+    const uint32_t* offset= offsets(rowIndex);
+    length= offset[column + 1] - offset[column] - 1;
+    return rows[rowIndex] + headerSize + offset[column];
+  }
+
+}
+}
@@ -0,0 +1,154 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _ROWDATAARENA_H_
+#define _ROWDATAARENA_H_
+
+#include <cstdint>
+
+#include "Consts.h"
+#include "util/DriverAllocator.h"
+
+namespace sql
+{
+namespace mariadb
+{
+
+/* Storage for locally cached result set rows. All cells of a row go into one record in the slab, that is carved
+   out of big chunks - the record starts with cells offsets and null bitmap, followed by cells data. Thus there is
+   no allocation per cell or per row, and growing the storage never moves already stored rows. Rows are handed out
+   as views - sql::bytes, that do not own the memory they point to.
+   With the spill threshold set, chunks beyond it are mapped from the unnamed temporary file, so that the OS can page
+   rows of very big results out to the disk, instead of keeping them all in RAM */
+class RowDataArena
+{
+  static const std::size_t DEFAULT_CHUNK_SIZE= 64*1024;
+
+  /* Chunk is either allocated on the heap by the driver's allocator, or is mapped from the spill file */
+  struct ChunkDeleter
+  {
+    std::size_t size;
+    bool mapped;
+    Allocator* allocator;
+
+    ChunkDeleter(std::size_t _size= 0, bool _mapped= false, Allocator* _allocator= nullptr) :
+      size(_size), mapped(_mapped), allocator(_allocator) {}
+    void operator()(char* chunk) const;
+  };
+  typedef std::unique_ptr<char[], ChunkDeleter> Chunk;
+
+  std::size_t columnCount;
+  std::size_t headerSize;
+  std::vector<Chunk> chunks;
+  std::vector<Chunk> largeRecords;
+  std::size_t largeRecordsSize;
+  std::size_t currentChunk;
+  char* freePtr;
+  std::size_t chunkFree;
+  std::vector<char*> rows;
+  std::size_t spillThreshold;
+  // File descriptor, or HANDLE on Windows. -1 if the file has not been created
+  std::intptr_t spillFile;
+  uint64_t spillFileSize;
+  // Bytes of the chunks on the heap, i.e. not spilled
+  std::size_t heapSize;
+
+  RowDataArena(const RowDataArena&)= delete;
+  RowDataArena& operator=(const RowDataArena&)= delete;
+
+  Chunk newChunk(std::size_t size);
+  /* Frees the chunks of the list beyond the first keep ones */
+  void dropChunks(std::vector<Chunk>& list, std::size_t keep);
+  /* Returns nullptr, if the file cannot be created or extended. Size is rounded up to the chunk size */
+  char* mapSpilled(std::size_t& size);
+  void closeSpillFile();
+  char* allocate(std::size_t size);
+  char* allocateRecord(std::size_t dataLength);
+  const uint32_t* offsets(std::size_t rowIndex) const { return reinterpret_cast<const uint32_t*>(rows[rowIndex]); }
+  const uint8_t* nullBitmap(std::size_t rowIndex) const {
+    return reinterpret_cast<const uint8_t*>(rows[rowIndex] + sizeof(uint32_t)*(columnCount + 1));
+  }
+  void setCell(char* record, std::size_t column, const char* value, std::size_t length) const;
+
+public:
+  RowDataArena(std::size_t columnCount= 0);
+  ~RowDataArena();
+
+  /* Has to be called before adding any row, if column count was not known at construction time */
+  void setColumnCount(std::size_t columnCount);
+  std::size_t getColumnCount() const { return columnCount; }
+  /* Bytes of rows kept in memory, after which the storage spills to the temporary file. 0 disables spilling */
+  void setSpillThreshold(std::size_t bytes) { spillThreshold= bytes; }
+
+  std::size_t size() const { return rows.size(); }
+  /* Bytes of the storage in the memory. Spilled rows are not counted */
+  std::size_t memoryUsed() const { return heapSize + rows.capacity()*sizeof(char*); }
+  bool empty() const { return rows.empty(); }
+  void reserve(std::size_t rowCount) { rows.reserve(rowCount); }
+  /* Drops all rows. The first chunk is kept for reuse, so the storage may be refilled without new allocations. The
+     spill file is closed */
+  void clear();
+  /* Drops all rows, but keeps all chunks for reuse. For the storage, that is refilled with about the same amount of
+     data over and over, like a streaming result's window of fetchSize rows */
+  void recycle();
+  /* Only shrinks the storage. Memory of dropped rows is reclaimed only if all rows are dropped */
+  void resize(std::size_t rowCount);
+  /* Exchanges the contents, including the spill file, with the storage of the same column count */
+  void swap(RowDataArena& other);
+
+  void append(const std::vector<sql::bytes>& rowData);
+  /* Takes row as arrays of cells and their lengths, like MYSQL_ROW. Null cell is indicated by nullptr */
+  void append(const char* const* cells, const unsigned long* lengths);
+  template <class CellGetter> void append(CellGetter getCell);
+  void replace(std::size_t rowIndex, const std::vector<sql::bytes>& rowData);
+  void erase(std::size_t rowIndex);
+
+  /* Fills rowView with non-owning sql::bytes pointing to the row's cells. They stay valid until the row is
+     replaced or erased, or the storage is cleared */
+  void view(std::size_t rowIndex, std::vector<sql::bytes>& rowView) const;
+  bool isNull(std::size_t rowIndex, std::size_t column) const {
+    return (nullBitmap(rowIndex)[column >> 3] & (1 << (column & 7))) != 0;
+  }
+  const char* getCell(std::size_t rowIndex, std::size_t column, std::size_t& length) const;
+};
+
+/* CellGetter is called as getCell(columnIndex, length) for each column, twice. It returns pointer to the cell data
+   and sets its length, or returns nullptr for null cell */
+template <class CellGetter> void RowDataArena::append(CellGetter getCell)
+{
+  std::size_t dataLength= 0, length= 0;
+
+  for (std::size_t i= 0; i < columnCount; ++i) {
+    if (getCell(i, length) != nullptr) {
+      dataLength+= length + 1;
+    }
+  }
+  char* record= allocateRecord(dataLength);
+
+  for (std::size_t i= 0; i < columnCount; ++i) {
+    const char* value= getCell(i, length);
+    setCell(record, i, value, length);
+  }
+  rows.push_back(record);
+}
+
+}
+}
+#endif
@@ -188,10 +188,14 @@ namespace mariadb
 
   long double RowProtocol::stringToDouble(const char* str, uint32_t len)
   {
+    long double result;
+
+    if (parseLongDouble(str, len, result)) {
+      return result;
+    }
     std::string doubleAsString(str, len);
     std::istringstream convStream(doubleAsString);
     std::locale C("C");
-    long double result;
     convStream.imbue(C);
     convStream >> result;
 
@@ -203,6 +207,8 @@ namespace mariadb
     , options(options)
     , lastValueNull(0)
     , buf(nullptr)
+    , arena(nullptr)
+    , arenaRow(0)
     , fieldBuf()
     , pos(0)
     , length(0)
@@ -214,6 +220,34 @@ namespace mariadb
   void RowProtocol::resetRow(std::vector<sql::bytes>& _buf)
   {
     buf= &_buf;
+    arena= nullptr;
+  }
+
+
+  void RowProtocol::resetRow(const RowDataArena& _arena, std::size_t row)
+  {
+    buf= nullptr;
+    arena= &_arena;
+    arenaRow= row;
+  }
+
+
+  void RowProtocol::resetRow()
+  {
+    buf= nullptr;
+    arena= nullptr;
+  }
+
+
+  /* Positions on the cell of the arena row */
+  void RowProtocol::setArenaPosition()
+  {
+    std::size_t cellLength;
+    const char* cell= arena->getCell(arenaRow, static_cast<std::size_t>(index), cellLength);
+
+    lastValueNull= cell != nullptr ? BIT_LAST_FIELD_NOT_NULL : BIT_LAST_FIELD_NULL;
+    length= static_cast<uint32_t>(cellLength);
+    fieldBuf.wrap(const_cast<char*>(cell), cellLength);
   }
 
   uint32_t RowProtocol::getLengthMaxFieldSize()
@@ -24,6 +24,7 @@
 #include <iostream>
 
 #include "Consts.h"
+#include "com/RowDataArena.h"
 
 namespace sql
 {
@@ -90,6 +91,9 @@ protected:
 public:
   int32_t lastValueNull;
   std::vector<sql::bytes>* buf;
+  // Row of the arena, that is read instead of buf, if arena is not nullptr
+  const RowDataArena* arena;
+  std::size_t arenaRow;
   sql::bytes fieldBuf; // I actually don't remember why is it a ref
   int32_t pos;
   uint32_t length;
@@ -102,7 +106,17 @@ public:
   virtual ~RowProtocol() {}
 
   void resetRow(std::vector<sql::bytes>& buf);
+  /* Makes the stored row current. Cells are looked up in the row's record when the column is positioned, thus
+     nothing is done for the columns, that are not read */
+  void resetRow(const RowDataArena& arena, std::size_t row);
+  /* Makes the row fetched last current. Its values are read right from Connector/C buffers */
+  void resetRow();
   virtual void setPosition(int32_t position)=0;
+  /* Positions on the column to read it with getInternalStreamBuf. Returns false, if the protocol does not read the
+     column in chunks, and the value is in the fieldBuf, as after setPosition */
+  virtual bool setStreamPosition(int32_t position) { setPosition(position); return false; }
+  /* Buffer reading the value of the current column in chunks, owned by the caller. Valid while the row is current */
+  virtual std::streambuf* getInternalStreamBuf() { return nullptr; }
   uint32_t getLengthMaxFieldSize();
   uint32_t getMaxFieldSize();
 
@@ -134,12 +148,22 @@ public:
   virtual int8_t getInternalByte(ColumnDefinition* columnInfo)=0;
   virtual int16_t getInternalShort(ColumnDefinition* columnInfo)=0;
   virtual SQLString getInternalTimeString(ColumnDefinition* columnInfo)=0;
+  /* Returns false for NULL and zero dates */
+  virtual bool getInternalDateTime(ColumnDefinition* columnInfo, DateTime& value)=0;
+  /* Returns false for NULL */
+  virtual bool getInternalDecimal(ColumnDefinition* columnInfo, Decimal& value)=0;
 
   virtual bool isBinaryEncoded()=0;
-  virtual void cacheCurrentRow(std::vector<sql::bytes>& rowData, std::size_t columnCount)=0;
+  /* If string representation of the value of this column is the field buffer itself, i.e. getInternalString would
+     only copy it */
+  virtual bool isRawStringValue(ColumnDefinition* columnInfo)=0;
+  virtual void cacheCurrentRow(RowDataArena& cache, std::size_t columnCount)=0;
+  /* Total length of the current row's values, for the metrics */
+  virtual std::size_t rowDataLength(std::size_t columnCount)=0;
   bool lastValueWasNull();
 
 protected:
+  void setArenaPosition();
   template<typename T>
   T parseBinaryAsInteger(ColumnDefinition* columnInfo);
   SQLString zeroFillingIfNeeded(const SQLString& value, ColumnDefinition* columnInformation);
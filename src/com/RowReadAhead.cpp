@@ -0,0 +1,142 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#include <vector>
+
+#include "RowReadAhead.h"
+
+namespace sql
+{
+namespace mariadb
+{
+
+  RowReadAhead::RowReadAhead(std::size_t columnCount, Reader _reader)
+    : reader(std::move(_reader))
+    , window(columnCount)
+  {
+  }
+
+
+  RowReadAhead::~RowReadAhead()
+  {
+    {
+      std::unique_lock<std::mutex> localScopeLock(lock);
+      stopping= true;
+      wakeup.notify_all();
+      while (requested && !ready) {
+        wakeup.wait(localScopeLock);
+      }
+    }
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+
+
+  void RowReadAhead::run()
+  {
+    std::unique_lock<std::mutex> localScopeLock(lock);
+
+    for (;;) {
+      while (!stopping && (!requested || ready)) {
+        wakeup.wait(localScopeLock);
+      }
+      if (stopping && (!requested || ready)) {
+        return;
+      }
+      // The storage is not touched by the other thread, until the window is ready
+      localScopeLock.unlock();
+      bool hasMore= false;
+      std::exception_ptr readError;
+      try {
+        window.recycle();
+        hasMore= reader(window);
+      }
+      catch (...) {
+        readError= std::current_exception();
+      }
+      localScopeLock.lock();
+      more= hasMore;
+      error= readError;
+      ready= true;
+      wakeup.notify_all();
+    }
+  }
+
+
+  void RowReadAhead::request()
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+
+    requested= true;
+    ready= false;
+    if (!thread.joinable()) {
+      thread= std::thread(&RowReadAhead::run, this);
+    }
+    else {
+      wakeup.notify_all();
+    }
+  }
+
+
+  void RowReadAhead::wait(std::unique_lock<std::mutex>& localScopeLock)
+  {
+    while (requested && !ready) {
+      wakeup.wait(localScopeLock);
+    }
+    requested= false;
+    if (error) {
+      std::exception_ptr readError(error);
+      error= nullptr;
+      more= false;
+      std::rethrow_exception(readError);
+    }
+  }
+
+
+  bool RowReadAhead::take(RowDataArena& storage)
+  {
+    std::unique_lock<std::mutex> localScopeLock(lock);
+
+    wait(localScopeLock);
+    storage.swap(window);
+    return more;
+  }
+
+
+  bool RowReadAhead::finish(RowDataArena* storage)
+  {
+    std::unique_lock<std::mutex> localScopeLock(lock);
+    bool wasRequested= requested;
+
+    wait(localScopeLock);
+    if (storage != nullptr && wasRequested) {
+      std::vector<sql::bytes> rowView;
+      for (std::size_t i= 0; i < window.size(); ++i) {
+        window.view(i, rowView);
+        storage->append(rowView);
+      }
+    }
+    window.recycle();
+    return more;
+  }
+
+}
+}
@@ -0,0 +1,83 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _ROWREADAHEAD_H_
+#define _ROWREADAHEAD_H_
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "com/RowDataArena.h"
+
+namespace sql
+{
+namespace mariadb
+{
+
+/* Reads the next window of the streaming result's rows in the background thread, while the application processes the
+   current one(streamingReadAhead option). There is one window in flight, and the windows are swapped with the result's
+   storage, so rows are never copied. The connection belongs to the reader thread from request() until the window is
+   taken, or finish() returns - the result has to get the window, before anything else is sent or read on the
+   connection. Windows are handed over once per fetchSize rows, thus the handover is a plain mutex and condition */
+class RowReadAhead final
+{
+public:
+  /* Reads the window of rows into the storage. Returns false if the result has ended */
+  typedef std::function<bool(RowDataArena& storage)> Reader;
+
+private:
+  Reader reader;
+  RowDataArena window;
+  std::mutex lock;
+  std::condition_variable wakeup;
+  std::thread thread;
+  bool requested= false;
+  bool ready= false;
+  bool more= true;
+  bool stopping= false;
+  std::exception_ptr error;
+
+  RowReadAhead(const RowReadAhead&)= delete;
+  RowReadAhead& operator=(const RowReadAhead&)= delete;
+
+  void run();
+  /* Waits for the requested window. Rethrows the reader's exception */
+  void wait(std::unique_lock<std::mutex>& localScopeLock);
+
+public:
+  RowReadAhead(std::size_t columnCount, Reader reader);
+  /* Waits for the window in progress, the connection cannot be left in the middle of the row */
+  ~RowReadAhead();
+
+  /* Starts reading of the next window */
+  void request();
+  /* Waits for the requested window, and swaps it with the storage. Returns false if the result has ended with it */
+  bool take(RowDataArena& storage);
+  /* Waits for the requested window, and appends its rows to the storage, if it is not null. The reader is not used
+     after this. Returns false if the result has ended with the window */
+  bool finish(RowDataArena* storage);
+};
+
+}
+}
+#endif
@@ -18,6 +18,8 @@
 *************************************************************************************/
 
 
+#include <cstring>
+
 #include "ColumnDefinitionCapi.h"
 
 namespace sql
@@ -71,7 +73,8 @@ namespace capi
     metadata(other.metadata),
     owned(other.owned),
     type(other.type),
-    length(other.length)
+    length(other.length),
+    json(other.json)
   {
   }
 
@@ -83,7 +86,8 @@ namespace capi
   ColumnDefinitionCapi::ColumnDefinitionCapi(capi::MYSQL_FIELD* _metadata, bool ownshipPassed) :
     metadata(_metadata),
     type(ColumnType::fromServer(metadata->type & 0xff, metadata->charsetnr)), // TODO: may be wrong
-    length(std::max(_metadata->length, _metadata->max_length))
+    length(std::max(_metadata->length, _metadata->max_length)),
+    json(isJsonField(_metadata))
   {
     if (ownshipPassed) {
       owned.reset(_metadata);
@@ -91,17 +95,50 @@ namespace capi
   }
 
 
+  /* MariaDB sends JSON as LONGTEXT, and tells about it only with the format in the extended metadata, if the
+     connection has negotiated it. MySQL has the type of its own */
+  bool ColumnDefinitionCapi::isJsonField(const MYSQL_FIELD* field)
+  {
+    if (field->type == MYSQL_TYPE_JSON) {
+      return true;
+    }
+    MARIADB_CONST_STRING format{nullptr, 0};
+    if (mariadb_field_attr(&format, field, MARIADB_FIELD_ATTR_FORMAT_NAME) != 0 || format.str == nullptr) {
+      return false;
+    }
+    return format.length == 4 && std::strncmp(format.str, "json", 4) == 0;
+  }
+
+
+  void ColumnDefinitionCapi::fromFields(std::vector<Shared::ColumnDefinition>& columns, capi::MYSQL_FIELD* fields,
+    uint32_t count)
+  {
+    if (count == 0) {
+      return;
+    }
+    auto block= std::make_shared<std::vector<ColumnDefinitionCapi>>();
+
+    block->reserve(count);
+    columns.reserve(columns.size() + count);
+    for (uint32_t i= 0; i < count; ++i) {
+      block->emplace_back(&fields[i]);
+      // Aliasing constructor - the column keeps the whole block alive
+      columns.emplace_back(block, &block->back());
+    }
+  }
+
+
   SQLString ColumnDefinitionCapi::getDatabase() const {
-    return std::string(metadata->db, metadata->db_length);
+    return SQLString(metadata->db, metadata->db_length);
   }
 
 
   SQLString ColumnDefinitionCapi::getTable() const {
-    return metadata->table;
+    return SQLString(metadata->table, metadata->table_length);
   }
 
   SQLString ColumnDefinitionCapi::getOriginalTable() const {
-    return metadata->org_table;
+    return SQLString(metadata->org_table, metadata->org_table_length);
   }
 
 
@@ -110,23 +147,31 @@ namespace capi
   }
 
  
+  /* Copies the name into the storage at the offset, and points the field's member to the copy */
+  static void copyName(std::string& storage, std::size_t& offset, char*& name, unsigned int length)
+  {
+    char* copy= &storage[offset];
+
+    if (length > 0) {
+      std::memcpy(copy, name, length);
+    }
+    copy[length]= '\0';
+    name= copy;
+    offset+= length + 1;
+  }
+
+
   FieldNames::FieldNames(MYSQL_FIELD *metadata)
+    : storage(metadata->name_length + metadata->org_name_length + metadata->db_length + metadata->table_length +
+      metadata->org_table_length + 5, '\0')
   {
-    name.reserve(metadata->name_length + 1);
-    name.assign(metadata->name, metadata->name_length);
-    metadata->name= const_cast<char*>(name.c_str());
-    orgname.reserve(metadata->org_name_length + 1);
-    orgname.assign(metadata->org_name, metadata->org_name_length);
-    metadata->org_name= const_cast<char*>(orgname.c_str());
-    db.reserve(metadata->db_length + 1);
-    db.assign(metadata->db, metadata->db_length);
-    metadata->db= const_cast<char*>(db.c_str());
-    table.reserve(metadata->table_length + 1);
-    table.assign(metadata->table, metadata->table_length);
-    metadata->table= const_cast<char*>(table.c_str());
-    orgtable.reserve(metadata->org_table_length + 1);
-    orgtable.assign(metadata->org_table, metadata->org_table_length);
-    metadata->org_table= const_cast<char*>(orgtable.c_str());
+    std::size_t offset= 0;
+
+    copyName(storage, offset, metadata->name, metadata->name_length);
+    copyName(storage, offset, metadata->org_name, metadata->org_name_length);
+    copyName(storage, offset, metadata->db, metadata->db_length);
+    copyName(storage, offset, metadata->table, metadata->table_length);
+    copyName(storage, offset, metadata->org_table, metadata->org_table_length);
   }
 
 
@@ -146,10 +191,34 @@ namespace capi
 
   SQLString ColumnDefinitionCapi::getName() const
   {
-    return metadata->name;
+    return SQLString(metadata->name, metadata->name_length);
   }
 
   SQLString ColumnDefinitionCapi::getOriginalName() const {
+    return SQLString(metadata->org_name, metadata->org_name_length);
+  }
+
+
+  const char* ColumnDefinitionCapi::getTableView(std::size_t& _length) const {
+    _length= metadata->table_length;
+    return metadata->table;
+  }
+
+
+  const char* ColumnDefinitionCapi::getOriginalTableView(std::size_t& _length) const {
+    _length= metadata->org_table_length;
+    return metadata->org_table;
+  }
+
+
+  const char* ColumnDefinitionCapi::getNameView(std::size_t& _length) const {
+    _length= metadata->name_length;
+    return metadata->name;
+  }
+
+
+  const char* ColumnDefinitionCapi::getOriginalNameView(std::size_t& _length) const {
+    _length= metadata->org_name_length;
     return metadata->org_name;
   }
 
@@ -256,6 +325,10 @@ namespace capi
   return (getCharsetNumber() == 63);
   }
 
+  bool ColumnDefinitionCapi::isJson() const {
+    return json;
+  }
+
 }
 }
 }
@@ -35,10 +35,11 @@ namespace capi
 
 #include "mysql.h"
 
-// Small helper not to keep all those objects in ColumnDefinition object by default and to create copy of names in MYSQL_FIELD for deep copy
+// Small helper not to keep all those objects in ColumnDefinition object by default and to create copy of names in MYSQL_FIELD for deep copy.
+// Names are stored one after another in the single buffer, each terminated by \0
 struct FieldNames
 {
-  std::string name, table, orgname, orgtable, db;
+  std::string storage;
 
   FieldNames(MYSQL_FIELD *metadata);
 };
@@ -57,18 +58,31 @@ class ColumnDefinitionCapi : public sql::mariadb::ColumnDefinition
   const ColumnType& type;
   uint32_t length;
   std::unique_ptr<FieldNames> names;
+  /* Evaluated once, since the extended metadata does not survive makeLocalCopy */
+  bool json;
   //SQLString db;
 
 public:
   ColumnDefinitionCapi(const ColumnDefinitionCapi& other);
   ColumnDefinitionCapi(capi::MYSQL_FIELD* metadata, bool ownshipPassed= false);
 
+  /* Appends definitions of all fields of the result to columns. Definitions refer the C API fields, and are allocated
+     in one block, that the columns share, instead of one allocation per column */
+  static void fromFields(std::vector<Shared::ColumnDefinition>& columns, capi::MYSQL_FIELD* fields, uint32_t count);
+
+private:
+  static bool isJsonField(const MYSQL_FIELD* field);
+
 public:
   SQLString getDatabase() const;
   SQLString getTable() const;
   SQLString getOriginalTable() const;
   SQLString getName() const;
   SQLString getOriginalName() const;
+  const char* getTableView(std::size_t& length) const;
+  const char* getOriginalTableView(std::size_t& length) const;
+  const char* getNameView(std::size_t& length) const;
+  const char* getOriginalNameView(std::size_t& length) const;
   int16_t getCharsetNumber() const;
   SQLString getCollation() const;
   uint32_t getLength() const;
@@ -87,6 +101,7 @@ public:
   bool isZeroFill() const;
   bool isBinary() const;
   bool isReadonly() const;
+  bool isJson() const override;
   void makeLocalCopy() override;
 };
 
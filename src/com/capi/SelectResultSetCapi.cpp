@@ -20,7 +20,12 @@
 
 #include <vector>
 #include <array>
+#include <cstring>
+#include <atomic>
+#include <functional>
+#include <mutex>
 #include <sstream>
+#include <thread>
 
 #include "SelectResultSetCapi.h"
 #include "Results.h"
@@ -36,6 +41,9 @@
 #include "protocol/capi/BinRowProtocolCapi.h"
 #include "protocol/capi/TextRowProtocolCapi.h"
 #include "util/ServerPrepareResult.h"
+#include "util/MetricsRecorder.h"
+#include "util/ExportWriter.h"
+#include "util/Probes.h"
 
 namespace sql
 {
@@ -69,32 +77,56 @@ namespace capi
       capiStmtHandle(spr->getStatementId()),
       dataSize(0),
       fetchSize(results->getFetchSize()),
+      fetchBytes(results->getFetchBytes()),
       resultSetScrollType(results->getResultSetScrollType()),
       columnNameMap(columnsInformation),
       eofDeprecated(eofDeprecated),
       forceAlias(false)
   {
+    transcoding= Charset::getTranscoding(options->useCharacterEncoding, options->clientCharacterEncoding,
+      options->trustServerEncoding);
+    data.setColumnCount(columnInformationLength);
+    dataReservation.setAccount(protocol->getMemoryAccount());
+    // Row has to be there before streaming reads first rows
+    row.reset(new capi::BinRowProtocolCapi(columnsInformation, columnInformationLength, results->getMaxFieldSize(), options, spr));
+
+    // Updatable result has to leave the connection free for its updates
+    if (fetchSize == 0 && !callableResult && options->incrementalFetchSize > 0 &&
+      results->getResultSetConcurrency() == ResultSet::CONCUR_READ_ONLY) {
+      fetchSize= options->incrementalFetchSize;
+      incremental= true;
+    }
     if (fetchSize == 0 || callableResult) {
-      data.reserve(10);
-      if (mysql_stmt_store_result(capiStmtHandle)) {
-        throwStmtError(capiStmtHandle);
+      if (storesRowsItself() && !callableResult) {
+        readAllRows();
+      }
+      else {
+        if (mysql_stmt_store_result(capiStmtHandle)) {
+          throwStmtError(capiStmtHandle);
+        }
+        dataSize= static_cast<std::size_t>(mysql_stmt_num_rows(capiStmtHandle));
+        MetricsRecorder::increment(protocol->getMetrics().rowsFetched, dataSize);
       }
-      dataSize= static_cast<std::size_t>(mysql_stmt_num_rows(capiStmtHandle));
       streaming= false;
       resetVariables();
     }
     else {
       lock= protocol->getLock();
+      serverCursor= (protocol->getServerStatus() & ServerStatus::CURSOR_EXISTS) != 0;
 
-      protocol->setActiveStreamingResult(results);
-
+      if (!serverCursor) {
+        protocol->setActiveStreamingResult(results);
+      }
       protocol->removeHasMoreResults();
-      data.reserve(std::max(10, fetchSize)); // Same
-      nextStreamingValue();
+      data.reserve(fetchBytes > 0 ? 10 : std::max(10, fetchSize)); // Same
+      // Scrollable result keeps all rows it has read
+      if (keepsRows()) {
+        data.setSpillThreshold(static_cast<std::size_t>(incremental ? options->resultSpillThreshold : options->scrollSpillThreshold) << 20);
+      }
+      directRows= !keepsRows() && !serverCursor && fetchBytes == 0 && !options->streamingReadAhead;
       streaming= true;
+      nextStreamingValue();
     }
-
-    row.reset(new capi::BinRowProtocolCapi(columnsInformation, columnInformationLength, results->getMaxFieldSize(), options, capiStmtHandle));
   }
 
 
@@ -112,39 +144,57 @@ namespace capi
       capiStmtHandle(nullptr),
       dataSize(0),
       fetchSize(results->getFetchSize()),
+      fetchBytes(results->getFetchBytes()),
       resultSetScrollType(results->getResultSetScrollType()),
       columnNameMap(columnsInformation),
       eofDeprecated(eofDeprecated),
       forceAlias(false)
   {
+    transcoding= Charset::getTranscoding(options->useCharacterEncoding, options->clientCharacterEncoding,
+      options->trustServerEncoding);
     MYSQL_RES* textNativeResults= nullptr;
+    const bool ownStorage= storesRowsItself();
+
+    dataReservation.setAccount(protocol->getMemoryAccount());
+    // Updatable result has to leave the connection free for its updates
+    if (fetchSize == 0 && !callableResult && options->incrementalFetchSize > 0 &&
+      results->getResultSetConcurrency() == ResultSet::CONCUR_READ_ONLY) {
+      fetchSize= options->incrementalFetchSize;
+      incremental= true;
+    }
     if (fetchSize == 0 || callableResult) {
-      data.reserve(10);
-      textNativeResults= mysql_store_result(capiConnHandle);
+      // With the spill threshold or memory limit rows are read into own storage by readAllRows
+      textNativeResults= ownStorage ? mysql_use_result(capiConnHandle) : mysql_store_result(capiConnHandle);
 
       if (textNativeResults == nullptr && mysql_errno(capiConnHandle) != 0) {
         throw SQLException(mysql_error(capiConnHandle), mysql_sqlstate(capiConnHandle), mysql_errno(capiConnHandle));
       }
-      dataSize= static_cast<size_t>(textNativeResults != nullptr ? mysql_num_rows(textNativeResults) : 0);
+      if (!ownStorage) {
+        dataSize= static_cast<size_t>(textNativeResults != nullptr ? mysql_num_rows(textNativeResults) : 0);
+        MetricsRecorder::increment(protocol->getMetrics().rowsFetched, dataSize);
+      }
       streaming= false;
-      resetVariables();
     }
     else {
       lock= protocol->getLock();
       protocol->setActiveStreamingResult(results);
 
       protocol->removeHasMoreResults();
-      data.reserve(std::max(10, fetchSize)); // Same
+      data.reserve(fetchBytes > 0 ? 10 : std::max(10, fetchSize)); // Same
+      // Scrollable result keeps all rows it has read
+      if (keepsRows()) {
+        data.setSpillThreshold(static_cast<std::size_t>(incremental ? options->resultSpillThreshold : options->scrollSpillThreshold) << 20);
+      }
       textNativeResults= mysql_use_result(capiConnHandle);
 
+      directRows= !keepsRows() && fetchBytes == 0 && !options->streamingReadAhead;
       streaming= true;
     }
     uint32_t fieldCnt= mysql_field_count(capiConnHandle);
 
-    columnsInformation.reserve(fieldCnt);
-
-    for (size_t i= 0; i < fieldCnt; ++i) {
-      columnsInformation.emplace_back(new ColumnDefinitionCapi(mysql_fetch_field(textNativeResults)));
+    data.setColumnCount(fieldCnt);
+    if (textNativeResults != nullptr) {
+      ColumnDefinitionCapi::fromFields(columnsInformation, mysql_fetch_fields(textNativeResults), fieldCnt);
     }
     row.reset(new capi::TextRowProtocolCapi(results->getMaxFieldSize(), options, textNativeResults));
 
@@ -154,6 +204,12 @@ namespace capi
     if (streaming) {
       nextStreamingValue();
     }
+    else {
+      if (ownStorage && textNativeResults != nullptr) {
+        readAllRows();
+      }
+      resetVariables();
+    }
   }
 
   /**
@@ -167,8 +223,8 @@ namespace capi
     *     <code>ResultSet.TYPE_SCROLL_SENSITIVE</code>
     */
   SelectResultSetCapi::SelectResultSetCapi(
-    std::vector<Shared::ColumnDefinition>& columnInformation,
-    std::vector<std::vector<sql::bytes>>& resultSet,
+    const std::vector<Shared::ColumnDefinition>& columnInformation,
+    const std::vector<std::vector<sql::bytes>>& resultSet,
     Protocol* _protocol,
     int32_t resultSetScrollType)
     :
@@ -183,8 +239,8 @@ namespace capi
       capiConnHandle(nullptr),
       capiStmtHandle(nullptr),
       streaming(false),
-      data(std::move(resultSet)),
-      dataSize(data.size()),
+      data(columnInformation.size()),
+      dataSize(resultSet.size()),
       fetchSize(0),
       resultSetScrollType(resultSetScrollType),
       rowPointer(-1),
@@ -194,7 +250,26 @@ namespace capi
   {
     if (protocol != nullptr) {
       this->options= protocol->getOptions();
+      dataReservation.setAccount(protocol->getMemoryAccount());
+    }
+    data.reserve(resultSet.size());
+    for (auto& rowData : resultSet) {
+      data.append(rowData);
     }
+    reserveRows();
+  }
+
+
+  bool SelectResultSetCapi::storesRowsItself() const
+  {
+    return options->resultSpillThreshold > 0 || options->maxResultSetMemory > 0 ||
+      MemoryAccounting::get(MemoryAccounting::RESULT_SETS).getLimit() > 0;
+  }
+
+
+  bool SelectResultSetCapi::keepsRows() const
+  {
+    return resultSetScrollType != TYPE_FORWARD_ONLY || incremental;
   }
 
 
@@ -219,12 +294,25 @@ namespace capi
 
   void SelectResultSetCapi::fetchAllResults()
   {
-    dataSize= 0;
-    while (readNextValue()) {
+    if (serverCursor) {
+      closeServerCursor();
+      return;
     }
+    // Rows are skipped, not stored
+    skipRemainingRows();
     ++dataFetchTime;
   }
 
+  /* Closes the cursor at the server, instead of fetching the rest of the rows. Can be called from the destructor, thus
+     does not throw - if the reset fails, the error will come with the next command */
+  void SelectResultSetCapi::closeServerCursor()
+  {
+    mysql_stmt_free_result(capiStmtHandle);
+    resetVariables();
+    ++dataFetchTime;
+  }
+
+
   const char * SelectResultSetCapi::getErrMessage()
   {
     if (capiStmtHandle != nullptr)
@@ -282,6 +370,7 @@ namespace capi
   void SelectResultSetCapi::fetchRemainingInternal() {
     try {
       lastRowPointer= -1;
+      keepCurrentRow();
       while (!isEof) {
         addStreamingValue();
       }
@@ -296,6 +385,20 @@ namespace capi
     ++dataFetchTime;
   }
 
+  /* The current row has to stay readable, when more rows are read off the connection. Thus reading of the rows
+   * right from Connector/C buffers ends, and the current row is copied into data */
+  void SelectResultSetCapi::keepCurrentRow()
+  {
+    if (directRows) {
+      directRows= false;
+      if (dataSize > 0) {
+        data.recycle();
+        row->cacheCurrentRow(data, columnInformationLength);
+        reserveRows();
+      }
+    }
+  }
+
   /**
     * When protocol has a current Streaming result (this) fetch all to permit another query is
     * executing.
@@ -304,7 +407,7 @@ namespace capi
     */
   void SelectResultSetCapi::fetchRemaining() {
     if (!isEof) {
-      std::lock_guard<std::mutex> localScopeLock(*lock);
+      std::lock_guard<ConnectionMutex> localScopeLock(*lock);
       fetchRemainingInternal();
     }
   }
@@ -330,11 +433,105 @@ namespace capi
   void SelectResultSetCapi::nextStreamingValue() {
     lastRowPointer= -1;
 
-    if (resultSetScrollType == TYPE_FORWARD_ONLY) {
+    if (!keepsRows()) {
       dataSize= 0;
     }
-
+    if (readAhead) {
+      takeReadAhead();
+      return;
+    }
     addStreamingValue();
+    // Only forward-only result replaces the window, and the cursor result does not block the connection anyway
+    if (!isEof && options->streamingReadAhead && !keepsRows() && !serverCursor) {
+      startReadAhead();
+    }
+  }
+
+
+  void SelectResultSetCapi::startReadAhead()
+  {
+    const int32_t windowSize= fetchSize;
+    const std::size_t windowBytes= fetchBytes;
+    MetricsRecorder* metrics= &protocol->getMetrics();
+
+    readAhead.reset(new RowReadAhead(columnInformationLength,
+      [this, windowSize, windowBytes, metrics](RowDataArena& storage)->bool {
+      std::size_t bytes= 0;
+      for (int32_t i= 0; i < windowSize && (windowBytes == 0 || bytes < windowBytes); ++i) {
+        int32_t rc= row->fetchNext();
+        if (rc == MYSQL_NO_DATA) {
+          return false;
+        }
+        if (rc == 1) {
+          throw SQLException(getErrMessage(), getSqlState(), getErrNo());
+        }
+        if (rc == MYSQL_DATA_TRUNCATED) {
+          readAheadTruncated= true;
+        }
+        std::size_t rowBytes= row->rowDataLength(columnInformationLength);
+        metrics->rowFetched(rowBytes);
+        bytes+= rowBytes;
+        row->cacheCurrentRow(storage, columnInformationLength);
+      }
+      return true;
+    }));
+    readAhead->request();
+  }
+
+
+  void SelectResultSetCapi::takeReadAhead()
+  {
+    bool more;
+
+    try {
+      more= readAhead->take(data);
+    }
+    catch (...) {
+      readAhead.reset();
+      throw;
+    }
+    dataSize= data.size();
+    if (readAheadTruncated) {
+      protocol->setHasWarnings(true);
+      readAheadTruncated= false;
+    }
+    ++dataFetchTime;
+    if (more) {
+      readAhead->request();
+    }
+    else {
+      readAhead.reset();
+      readEndOfResult();
+    }
+    reserveRows();
+  }
+
+
+  void SelectResultSetCapi::stopReadAhead(bool keepRows)
+  {
+    if (!readAhead) {
+      return;
+    }
+    std::unique_ptr<RowReadAhead> reader(std::move(readAhead));
+
+    if (keepRows) {
+      if (dataSize == 0) {
+        data.recycle();
+      }
+      else if (dataSize < data.size()) {
+        data.resize(dataSize);
+      }
+    }
+    // If the result has ended with the window, the next fetch gets its end once again
+    reader->finish(keepRows ? &data : nullptr);
+    if (keepRows) {
+      dataSize= data.size();
+      reserveRows();
+    }
+    if (readAheadTruncated && protocol != nullptr) {
+      protocol->setHasWarnings(true);
+    }
+    readAheadTruncated= false;
   }
 
   /**
@@ -345,14 +542,93 @@ namespace capi
     */
   void SelectResultSetCapi::addStreamingValue() {
 
-    int32_t fetchSizeTmp= fetchSize;
-    while (fetchSizeTmp > 0 && readNextValue()) {
-      fetchSizeTmp--;
+    stopReadAhead(true);
+    if (serverCursor) {
+      // Other statement's result may be streamed at the moment, and has to be read off before COM_STMT_FETCH is sent
+      Results* activeStream= protocol->getActiveStreamingResult();
+      if (activeStream != nullptr) {
+        activeStream->loadFully(false, protocol);
+        protocol->setActiveStreamingResult(nullptr);
+      }
     }
+    const int32_t batchSize= directRows ? 1 : fetchSize;
+    int32_t fetchSizeTmp= batchSize;
+    if (fetchBytes == 0) {
+      while (fetchSizeTmp > 0 && readNextValue()) {
+        fetchSizeTmp--;
+      }
+    }
+    else {
+      // COM_STMT_FETCH is sent, when the rows of the previous one have been read, and brings as many rows as fit in
+      // the budget by the row size seen so far
+      if (serverCursor) {
+        unsigned long prefetchRows= static_cast<unsigned long>(chunkRows());
+        mysql_stmt_attr_set(capiStmtHandle, STMT_ATTR_PREFETCH_ROWS, &prefetchRows);
+      }
+      uint64_t chunkStart= observedBytes;
+      while (fetchSizeTmp > 0 && observedBytes - chunkStart < fetchBytes && readNextValue()) {
+        fetchSizeTmp--;
+      }
+    }
+    MARIADB_PROBE2(fetch__batch, this, batchSize - fetchSizeTmp);
     ++dataFetchTime;
   }
 
 
+  /* Rows of the chunk, that fit in the byte budget by the average size of the rows read so far. Before the first row
+   * the size is guessed from the columns lengths, capping long ones, since they are rarely filled up */
+  int32_t SelectResultSetCapi::chunkRows() const
+  {
+    uint64_t rowBytes= 0;
+
+    if (observedRows > 0) {
+      rowBytes= observedBytes / observedRows;
+    }
+    else {
+      for (auto& column : columnsInformation) {
+        rowBytes+= std::min<uint64_t>(column->getLength(), 1024);
+      }
+    }
+    uint64_t rows= fetchBytes / std::max<uint64_t>(rowBytes, 1);
+    return static_cast<int32_t>(std::max<uint64_t>(1, std::min<uint64_t>(rows, static_cast<uint64_t>(fetchSize))));
+  }
+
+
+  /* Reads all rows of the unbuffered result into the own storage, instead of storing them with Connector/C. Beyond
+   * the spill threshold the storage goes to the temporary file, and one huge result cannot exhaust the memory.
+   * If the rows exceed the memory limit, the rest of the result is skipped, so the connection stays usable */
+  void SelectResultSetCapi::readAllRows()
+  {
+    int32_t rc;
+
+    data.setSpillThreshold(static_cast<std::size_t>(options->resultSpillThreshold) << 20);
+    while ((rc= row->fetchNext()) != MYSQL_NO_DATA) {
+      if (rc == 1) {
+        throwStmtError(capiStmtHandle);
+      }
+      if (rc == MYSQL_DATA_TRUNCATED) {
+        protocol->setHasWarnings(true);
+      }
+      protocol->getMetrics().rowFetched(row->rowDataLength(columnInformationLength));
+      row->cacheCurrentRow(data, columnInformationLength);
+      try {
+        reserveRows();
+      }
+      catch (SQLException&) {
+        while ((rc= row->fetchNext()) != MYSQL_NO_DATA && rc != 1) {}
+        data.clear();
+        dataReservation.release();
+        throw;
+      }
+    }
+    // Text protocol reports errors as the end of the result
+    if (capiConnHandle != nullptr && mysql_errno(capiConnHandle) != 0) {
+      throw SQLException(mysql_error(capiConnHandle), mysql_sqlstate(capiConnHandle), mysql_errno(capiConnHandle));
+    }
+    dataSize= data.size();
+  }
+
+
   /**
     * Read next value.
     *
@@ -379,60 +655,102 @@ namespace capi
         false);*/
     }
 
-    case MYSQL_NO_DATA: {
-      uint32_t serverStatus;
-      if (protocol) {
-        if (!eofDeprecated) {
-
-          protocol->readEofPacket();
-          serverStatus= protocol->getServerStatus();
-
-          // CallableResult has been read from intermediate EOF server_status
-          // and is mandatory because :
-          //
-          // - Call query will have an callable resultSet for OUT parameters
-          //   this resultSet must be identified and not listed in JDBC statement.getResultSet()
-          //
-          // - after a callable resultSet, a OK packet is send,
-          //   but mysql before 5.7.4 doesn't send MORE_RESULTS_EXISTS flag
-          if (callableResult) {
-            serverStatus|= MORE_RESULTS_EXISTS;
-          }
-        }
-        else {
-          // OK_Packet with a 0xFE header
-          // protocol->readOkPacket()?
-        
-          serverStatus= protocol->getServerStatus();
-          callableResult= (serverStatus & PS_OUT_PARAMETERS) != 0;
-        }
-        protocol->setServerStatus(serverStatus);
-        protocol->setHasWarnings(warningCount() > 0);
+    case MYSQL_NO_DATA:
+      readEndOfResult();
+      return false;
+    }
 
-        if ((serverStatus & MORE_RESULTS_EXISTS) == 0) {
-          protocol->removeActiveStreamingResult();
+    std::size_t rowBytes= row->rowDataLength(columnInformationLength);
+    if (protocol) {
+      protocol->getMetrics().rowFetched(rowBytes);
+    }
+    ++observedRows;
+    observedBytes+= rowBytes;
+    if (streaming && !directRows) {
+      // Forward-only result starts new window of fetchSize rows in the same memory. Otherwise rows, that have been
+      // read and discarded, are dropped
+      if (dataSize == 0) {
+        data.recycle();
+      }
+      else if (dataSize < data.size()) {
+        data.resize(dataSize);
+      }
+      row->cacheCurrentRow(data, columnInformationLength);
+      reserveRows();
+    }
+    ++dataSize;
+    return true;
+  }
+
+  /* Processes the end of the result, after the last row has been read */
+  void SelectResultSetCapi::readEndOfResult()
+  {
+    uint32_t serverStatus;
+    if (protocol) {
+      if (!eofDeprecated) {
+
+        protocol->readEofPacket();
+        serverStatus= protocol->getServerStatus();
+
+        // CallableResult has been read from intermediate EOF server_status
+        // and is mandatory because :
+        //
+        // - Call query will have an callable resultSet for OUT parameters
+        //   this resultSet must be identified and not listed in JDBC statement.getResultSet()
+        //
+        // - after a callable resultSet, a OK packet is send,
+        //   but mysql before 5.7.4 doesn't send MORE_RESULTS_EXISTS flag
+        if (callableResult) {
+          serverStatus|= MORE_RESULTS_EXISTS;
         }
       }
+      else {
+        // OK_Packet with a 0xFE header
+        // protocol->readOkPacket()?
+      
+        serverStatus= protocol->getServerStatus();
+        callableResult= (serverStatus & PS_OUT_PARAMETERS) != 0;
+      }
+      protocol->setServerStatus(serverStatus);
+      protocol->setHasWarnings(warningCount() > 0);
 
-      resetVariables();
-      return false;
-    }
+      // Cursor result has never been the active streaming result, and some other can be active now
+      if ((serverStatus & MORE_RESULTS_EXISTS) == 0 && !serverCursor) {
+        protocol->removeActiveStreamingResult();
+      }
     }
 
-    if (dataSize + 1 >= data.size()) {
-      growDataArray();
+    resetVariables();
+  }
+
+
+  /* Reads the rest of the rows off the connection without copying them into the result. The rows, that nobody is going
+   * to read, do not need the arena space or the copy. No locking */
+  void SelectResultSetCapi::skipRemainingRows()
+  {
+    int32_t rc;
+
+    stopReadAhead(false);
+    while ((rc= row->fetchNext()) != MYSQL_NO_DATA) {
+      if (rc == 1) {
+        throw SQLException(getErrMessage(), getSqlState(), getErrNo());
+      }
+      if (protocol) {
+        protocol->getMetrics().rowFetched(row->rowDataLength(columnInformationLength));
+      }
     }
-    ++dataSize;
-    return true;
+    readEndOfResult();
   }
 
+
   /**
     * Get current row's raw bytes.
     *
     * @return row's raw bytes
     */
   std::vector<sql::bytes>& SelectResultSetCapi::getCurrentRowData() {
-    return data[rowPointer];
+    data.view(rowPointer, currentRowView);
+    return currentRowView;
   }
 
   /**
@@ -443,8 +761,8 @@ namespace capi
     */
   void SelectResultSetCapi::updateRowData(std::vector<sql::bytes>& rawData)
   {
-    data[rowPointer]= rawData;
-    row->resetRow(data[rowPointer]);
+    data.replace(rowPointer, rawData);
+    row->resetRow(data, rowPointer);
   }
 
   /**
@@ -454,17 +772,15 @@ namespace capi
     */
   void SelectResultSetCapi::deleteCurrentRowData() {
 
-    data.erase(data.begin()+lastRowPointer);
+    data.erase(lastRowPointer);
     dataSize--;
     lastRowPointer= -1;
     previous();
   }
 
   void SelectResultSetCapi::addRowData(std::vector<sql::bytes>& rawData) {
-    if (dataSize +1 >= data.size()) {
-      growDataArray();
-    }
-    data[dataSize]= rawData;
+    data.append(rawData);
+    reserveRows();
     rowPointer= static_cast<int32_t>(dataSize);
     dataSize++;
   }
@@ -500,29 +816,6 @@ namespace capi
     }
   }*/
 
-  /** Grow data array. */
-  void SelectResultSetCapi::growDataArray(bool complete) {
-    std::size_t curSize= data.size(), newSize= curSize + 1;
-    if (complete) {
-      newSize= dataSize;
-    }
-
-    if (data.capacity() < newSize) {
-      std::size_t newCapacity= complete ? newSize : static_cast<std::size_t>(curSize + (curSize >> 1));
-
-      // I don't remember what is MAX_ARRAY_SIZE is about. it might be irrelevant for C/ODBC and C/C++
-      if (!complete && newCapacity > MAX_ARRAY_SIZE) {
-        newCapacity= static_cast<std::size_t>(MAX_ARRAY_SIZE);
-      }
-
-      data.reserve(newCapacity);
-    }
-    for (std::size_t i= curSize; i < newSize; ++i) {
-      data.push_back({});
-      data.back().reserve(columnsInformation.size());
-    }
-  }
-
   /**
     * Connection.abort() has been called, abort result-set.
     *
@@ -532,9 +825,8 @@ namespace capi
     isClosedFlag= true;
     resetVariables();
 
-    for (auto& row : data) {
-      row.clear();
-    }
+    data.clear();
+    dataReservation.release();
 
     if (statement != nullptr) {
       statement->checkCloseOnCompletion(this);
@@ -546,11 +838,13 @@ namespace capi
   void SelectResultSetCapi::close() {
     isClosedFlag= true;
     if (!isEof) {
-      std::unique_lock<std::mutex> localScopeLock(*lock);
+      std::unique_lock<ConnectionMutex> localScopeLock(*lock);
       try {
-        while (!isEof) {
-          dataSize= 0; // to avoid storing data
-          readNextValue();
+        if (serverCursor) {
+          closeServerCursor();
+        }
+        if (!isEof) {
+          skipRemainingRows();
         }
       }
       catch (SQLException& queryException) {
@@ -566,6 +860,7 @@ namespace capi
     resetVariables();
 
     data.clear();
+    dataReservation.release();
 
     if (statement != nullptr) {
       statement->checkCloseOnCompletion(this);
@@ -583,12 +878,13 @@ namespace capi
   {
     ++rowPointer;
     if (data.size() > 0) {
-      row->resetRow(data[rowPointer]);
+      row->resetRow(data, rowPointer);
     }
     else {
       if (row->fetchNext() == MYSQL_NO_DATA) {
         return false;
       }
+      countRowData();
     }
     lastRowPointer= rowPointer;
     return true;
@@ -605,7 +901,7 @@ namespace capi
     }
     else {
       if (streaming && !isEof) {
-        std::lock_guard<std::mutex> localScopeLock(*lock);
+        std::lock_guard<ConnectionMutex> localScopeLock(*lock);
         try {
           if (!isEof) {
             nextStreamingValue();
@@ -615,7 +911,7 @@ namespace capi
           handleIoException(ioe);
         }
 
-        if (resultSetScrollType == TYPE_FORWARD_ONLY) {
+        if (!keepsRows()) {
 
           rowPointer= 0;
           return dataSize > 0;
@@ -635,20 +931,40 @@ namespace capi
 
   void SelectResultSetCapi::resetRow()
   {
-    if (data.size() > 0) {
-      row->resetRow(data[rowPointer]);
+    if (directRows) {
+      row->resetRow();
+    }
+    else if (data.size() > 0) {
+      row->resetRow(data, rowPointer);
     }
     else {
       if (rowPointer != lastRowPointer + 1) {
         row->installCursorAtPosition(rowPointer);
       }
       row->fetchNext();
+      countRowData();
     }
     lastRowPointer= rowPointer;
   }
 
+  /* Rows of stored result are counted in the size of the result, here only their data is, when the row is read the
+     first time */
+  void SelectResultSetCapi::countRowData()
+  {
+    if (rowPointer >= countedRows && protocol) {
+      MetricsRecorder::increment(protocol->getMetrics().bytesReceived, row->rowDataLength(columnInformationLength));
+      countedRows= rowPointer + 1;
+    }
+  }
+
 
   void SelectResultSetCapi::checkObjectRange(int32_t position) {
+    checkRowRange(position);
+    row->setPosition(position - 1);
+  }
+
+  /* Checks the position like checkObjectRange and makes the row current, but does not position on the column */
+  void SelectResultSetCapi::checkRowRange(int32_t position) {
     if (rowPointer < 0) {
       throw SQLDataException("Current position is before the first row", "22023");
     }
@@ -664,7 +980,6 @@ namespace capi
     if (lastRowPointer != rowPointer) {
       resetRow();
     }
-    row->setPosition(position - 1);
   }
 
   SQLWarning* SelectResultSetCapi::getWarnings() {
@@ -697,11 +1012,12 @@ namespace capi
       {
       // has to read more result to know if it's finished or not
       // (next packet may be new data or an EOF packet indicating that there is no more data)
-        std::lock_guard<std::mutex> localScopeLock(*lock);
+        std::lock_guard<ConnectionMutex> localScopeLock(*lock);
         try {
           // this time, fetch is added even for streaming forward type only to keep current pointer
           // row.
           if (!isEof) {
+            keepCurrentRow();
             addStreamingValue();
           }
         }
@@ -734,9 +1050,10 @@ namespace capi
     else {
       // when streaming and not having read all results,
       // must read next packet to know if next packet is an EOF packet or some additional data
-      std::lock_guard<std::mutex> localScopeLock(*lock);
+      std::lock_guard<ConnectionMutex> localScopeLock(*lock);
       try {
         if (!isEof) {
+          keepCurrentRow();
           addStreamingValue();
         }
       }
@@ -755,7 +1072,7 @@ namespace capi
   void SelectResultSetCapi::beforeFirst() {
     checkClose();
 
-    if (streaming &&resultSetScrollType == TYPE_FORWARD_ONLY) {
+    if (streaming && !keepsRows()) {
       throw SQLException("Invalid operation for result set type TYPE_FORWARD_ONLY");
     }
     rowPointer= -1;
@@ -770,7 +1087,7 @@ namespace capi
   bool SelectResultSetCapi::first() {
     checkClose();
 
-    if (streaming && resultSetScrollType == TYPE_FORWARD_ONLY) {
+    if (streaming && !keepsRows()) {
       throw SQLException("Invalid operation for result set type TYPE_FORWARD_ONLY");
     }
 
@@ -787,7 +1104,7 @@ namespace capi
 
   int32_t SelectResultSetCapi::getRow() {
     checkClose();
-    if (streaming && resultSetScrollType == TYPE_FORWARD_ONLY) {
+    if (streaming && !keepsRows()) {
       return 0;
     }
     return rowPointer + 1;
@@ -796,7 +1113,7 @@ namespace capi
   bool SelectResultSetCapi::absolute(int32_t rowPos) {
     checkClose();
 
-    if (streaming && resultSetScrollType == TYPE_FORWARD_ONLY) {
+    if (streaming && !keepsRows()) {
       throw SQLException("Invalid operation for result set type TYPE_FORWARD_ONLY");
     }
 
@@ -835,7 +1152,7 @@ namespace capi
 
   bool SelectResultSetCapi::relative(int32_t rows) {
     checkClose();
-    if (streaming &&resultSetScrollType == TYPE_FORWARD_ONLY) {
+    if (streaming && !keepsRows()) {
       throw SQLException("Invalid operation for result set type TYPE_FORWARD_ONLY");
     }
     int32_t newPos= rowPointer + rows;
@@ -855,7 +1172,7 @@ namespace capi
 
   bool SelectResultSetCapi::previous() {
     checkClose();
-    if (streaming && resultSetScrollType == TYPE_FORWARD_ONLY) {
+    if (streaming && !keepsRows()) {
       throw SQLException("Invalid operation for result set type TYPE_FORWARD_ONLY");
     }
     if (rowPointer > -1) {
@@ -877,14 +1194,15 @@ namespace capi
   }
 
   int32_t SelectResultSetCapi::getFetchSize() {
-    return this->fetchSize;
+    // Result streamed by the byte budget alone has no fetch size
+    return incremental || fetchSize == INT32_MAX ? 0 : this->fetchSize;
   }
 
   void SelectResultSetCapi::setFetchSize(int32_t fetchSize) {
     if (streaming &&fetchSize == 0) {
-      std::lock_guard<std::mutex> localScopeLock(*lock);
+      std::lock_guard<ConnectionMutex> localScopeLock(*lock);
       try {
-
+        keepCurrentRow();
         while (!isEof) {
           addStreamingValue();
         }
@@ -965,9 +1283,13 @@ namespace capi
   SQLString SelectResultSetCapi::getString(int32_t columnIndex)
   {
     checkObjectRange(columnIndex);
-    std::unique_ptr<SQLString> res= row->getInternalString(columnsInformation[columnIndex -1].get());
+    ColumnDefinition* columnInfo= columnsInformation[columnIndex -1].get();
+    std::unique_ptr<SQLString> res= row->getInternalString(columnInfo);
 
     if (res) {
+      if (transcoding != Charset::NO_TRANSCODING && !columnInfo->isBinary()) {
+        Charset::decode(transcoding, *res);
+      }
       return std::move(*res);
     }
     else {
@@ -996,10 +1318,16 @@ namespace capi
 
   /** {inheritDoc}. */
   std::istream* SelectResultSetCapi::getBinaryStream(int32_t columnIndex) {
-    checkObjectRange(columnIndex);
+    checkRowRange(columnIndex);
+    // Value, that is read in chunks from the row, is not copied to the row's buffer
+    bool chunked= row->setStreamPosition(columnIndex - 1);
     if (row->lastValueWasNull()) {
       return nullptr;
     }
+    if (chunked) {
+      blobBuffer[columnIndex].reset(row->getInternalStreamBuf());
+      return new std::istream(blobBuffer[columnIndex].get());
+    }
     blobBuffer[columnIndex].reset(new memBuf(row->fieldBuf.arr + row->pos, row->fieldBuf.arr + row->pos + row->getLengthMaxFieldSize()));
     return new std::istream(blobBuffer[columnIndex].get());
   }
@@ -1200,7 +1528,16 @@ namespace capi
 
   /** {inheritDoc}. */
   sql::ResultSetMetaData* SelectResultSetCapi::getMetaData() {
-    return new MariaDbResultSetMetaData(columnsInformation, options, forceAlias);
+    // The copy shares the column definitions with the result set's metadata
+    return new MariaDbResultSetMetaData(static_cast<MariaDbResultSetMetaData&>(getMetaDataView()));
+  }
+
+
+  ResultSetMetaData& SelectResultSetCapi::getMetaDataView() {
+    if (!metadata) {
+      metadata.reset(new MariaDbResultSetMetaData(columnsInformation, options, forceAlias));
+    }
+    return *metadata;
   }
 
   /** {inheritDoc}. */
@@ -1595,6 +1932,536 @@ namespace capi
     return dataSize;
   }
 
+
+  const char* SelectResultSetCapi::getStringView(int32_t columnIndex, std::size_t& length)
+  {
+    checkObjectRange(columnIndex);
+    return currentStringView(columnIndex, length);
+  }
+
+  /* Does getStringView's job for the column, the row protocol is already positioned on */
+  const char* SelectResultSetCapi::currentStringView(int32_t columnIndex, std::size_t& length)
+  {
+    if (stringViewBuffer.size() < static_cast<std::size_t>(columnInformationLength)) {
+      stringViewBuffer.resize(columnInformationLength);
+    }
+    return stringView(row.get(), columnsInformation[columnIndex - 1].get(), length, stringViewBuffer[columnIndex - 1]);
+  }
+
+
+  const char* SelectResultSetCapi::stringView(RowProtocol* rowProtocol, ColumnDefinition* columnInfo,
+    std::size_t& length, std::unique_ptr<SQLString>& buffer) const
+  {
+    length= 0;
+    if (rowProtocol->lastValueWasNull()) {
+      return nullptr;
+    }
+    bool decode= transcoding != Charset::NO_TRANSCODING && !columnInfo->isBinary();
+    std::unique_ptr<SQLString> res;
+
+    if (rowProtocol->isRawStringValue(columnInfo)) {
+      const char* value= rowProtocol->fieldBuf.arr + rowProtocol->pos;
+      length= rowProtocol->getLengthMaxFieldSize();
+      if (!decode || Charset::isDecoded(transcoding, value, length)) {
+        return value;
+      }
+      res.reset(new SQLString(value, length));
+    }
+    else {
+      res= rowProtocol->getInternalString(columnInfo);
+      if (!res) {
+        return nullptr;
+      }
+    }
+    if (decode) {
+      Charset::decode(transcoding, *res);
+    }
+    buffer= std::move(res);
+    length= buffer->length();
+    return buffer->c_str();
+  }
+
+
+  const char* SelectResultSetCapi::getStringView(const SQLString& columnLabel, std::size_t& length)
+  {
+    return getStringView(findColumn(columnLabel), length);
+  }
+
+
+  const char* SelectResultSetCapi::getJsonView(int32_t columnIndex, std::size_t& length)
+  {
+    checkObjectRange(columnIndex);
+    ColumnDefinition* columnInfo= columnsInformation[columnIndex - 1].get();
+
+    if (!columnInfo->isJson()) {
+      throw SQLDataException("Column " + std::to_string(columnIndex) + " is not of JSON type", "22018");
+    }
+    length= 0;
+    if (row->lastValueWasNull()) {
+      return nullptr;
+    }
+    length= row->getLengthMaxFieldSize();
+    return row->fieldBuf.arr + row->pos;
+  }
+
+
+  const char* SelectResultSetCapi::getJsonView(const SQLString& columnLabel, std::size_t& length)
+  {
+    return getJsonView(findColumn(columnLabel), length);
+  }
+
+
+  const char* SelectResultSetCapi::rawStringView(int32_t columnIndex, std::size_t& length,
+    std::unique_ptr<SQLString>& buffer, Charset::Transcoding& valueTranscoding)
+  {
+    checkObjectRange(columnIndex);
+    length= 0;
+    valueTranscoding= Charset::NO_TRANSCODING;
+    if (row->lastValueWasNull()) {
+      return nullptr;
+    }
+    ColumnDefinition* columnInfo= columnsInformation[columnIndex - 1].get();
+
+    if (row->isRawStringValue(columnInfo)) {
+      if (!columnInfo->isBinary()) {
+        valueTranscoding= transcoding;
+      }
+      length= row->getLengthMaxFieldSize();
+      return row->fieldBuf.arr + row->pos;
+    }
+    // Values of other types are converted to ASCII strings
+    buffer= row->getInternalString(columnInfo);
+    if (!buffer) {
+      return nullptr;
+    }
+    length= buffer->length();
+    return buffer->c_str();
+  }
+
+
+  std::u16string SelectResultSetCapi::getU16String(int32_t columnIndex)
+  {
+    std::unique_ptr<SQLString> buffer;
+    Charset::Transcoding valueTranscoding;
+    std::size_t length;
+    const char* value= rawStringView(columnIndex, length, buffer, valueTranscoding);
+    std::u16string result;
+
+    Charset::decodeWide(valueTranscoding, value, length, result);
+    return result;
+  }
+
+
+  std::u16string SelectResultSetCapi::getU16String(const SQLString& columnLabel)
+  {
+    return getU16String(findColumn(columnLabel));
+  }
+
+
+  std::wstring SelectResultSetCapi::getWString(int32_t columnIndex)
+  {
+    std::unique_ptr<SQLString> buffer;
+    Charset::Transcoding valueTranscoding;
+    std::size_t length;
+    const char* value= rawStringView(columnIndex, length, buffer, valueTranscoding);
+    std::wstring result;
+
+    Charset::decodeWide(valueTranscoding, value, length, result);
+    return result;
+  }
+
+
+  std::wstring SelectResultSetCapi::getWString(const SQLString& columnLabel)
+  {
+    return getWString(findColumn(columnLabel));
+  }
+
+
+  std::size_t SelectResultSetCapi::getBytesInto(int32_t columnIndex, sql::bytes& buffer)
+  {
+    checkObjectRange(columnIndex);
+    if (row->lastValueWasNull()) {
+      return 0;
+    }
+    ColumnDefinition* columnInfo= columnsInformation[columnIndex - 1].get();
+    std::unique_ptr<SQLString> converted;
+    const char* value;
+    std::size_t length;
+
+    if (row->isRawStringValue(columnInfo)) {
+      value= row->fieldBuf.arr + row->pos;
+      length= row->getLengthMaxFieldSize();
+    }
+    else {
+      converted= row->getInternalString(columnInfo);
+      if (!converted) {
+        return 0;
+      }
+      value= converted->c_str();
+      length= converted->length();
+    }
+    buffer.reserve(length);
+    if (length > 0) {
+      std::memcpy(buffer.arr, value, length);
+    }
+    return length;
+  }
+
+
+  std::size_t SelectResultSetCapi::getBytesInto(const SQLString& columnLabel, sql::bytes& buffer)
+  {
+    return getBytesInto(findColumn(columnLabel), buffer);
+  }
+
+
+  bool SelectResultSetCapi::getDateTime(int32_t columnIndex, DateTime& value)
+  {
+    checkObjectRange(columnIndex);
+    return row->getInternalDateTime(columnsInformation[columnIndex - 1].get(), value);
+  }
+
+
+  bool SelectResultSetCapi::getDateTime(const SQLString& columnLabel, DateTime& value)
+  {
+    return getDateTime(findColumn(columnLabel), value);
+  }
+
+
+  bool SelectResultSetCapi::getDecimal(int32_t columnIndex, Decimal& value)
+  {
+    checkObjectRange(columnIndex);
+    return row->getInternalDecimal(columnsInformation[columnIndex - 1].get(), value);
+  }
+
+
+  bool SelectResultSetCapi::getDecimal(const SQLString& columnLabel, Decimal& value)
+  {
+    return getDecimal(findColumn(columnLabel), value);
+  }
+
+
+  void SelectResultSetCapi::checkBindings(ColumnBinding* columns, std::size_t columnCount)
+  {
+    if (isClosedFlag) {
+      throw SQLException("Operation not permit on a closed resultSet", "HY000");
+    }
+    // Checking bindings once, and not for each value
+    for (std::size_t i= 0; i < columnCount; ++i) {
+      if (columns[i].columnIndex <= 0 || columns[i].columnIndex > columnInformationLength) {
+        throw IllegalArgumentException("No such column: " + std::to_string(columns[i].columnIndex), "22023");
+      }
+      if (columns[i].buffer == nullptr || columns[i].type > ColumnBinding::BIND_SQLSTRING) {
+        throw IllegalArgumentException("Invalid buffer for the column " + std::to_string(columns[i].columnIndex), "HY009");
+      }
+    }
+  }
+
+
+  std::size_t SelectResultSetCapi::elementSize(const ColumnBinding& bind)
+  {
+    switch (bind.type) {
+    case ColumnBinding::BIND_INT32:
+      return sizeof(int32_t);
+    case ColumnBinding::BIND_INT64:
+      return sizeof(int64_t);
+    case ColumnBinding::BIND_UINT64:
+      return sizeof(uint64_t);
+    case ColumnBinding::BIND_DOUBLE:
+      return sizeof(double);
+    case ColumnBinding::BIND_SQLSTRING:
+      return sizeof(SQLString);
+    default:
+      return bind.bufferLength;
+    }
+  }
+
+
+  void SelectResultSetCapi::storeColumns(RowProtocol* rowProtocol, ColumnBinding* columns, std::size_t columnCount,
+    std::size_t index, std::unique_ptr<SQLString>& stringBuffer) const
+  {
+    for (std::size_t i= 0; i < columnCount; ++i) {
+      ColumnBinding& bind= columns[i];
+      ColumnDefinition* columnInfo= columnsInformation[bind.columnIndex - 1].get();
+
+      rowProtocol->setPosition(bind.columnIndex - 1);
+      bool isNull= rowProtocol->lastValueWasNull();
+
+      if (bind.isNull != nullptr) {
+        bind.isNull[index]= isNull;
+      }
+      // Rows of the array of structs are stride bytes apart
+      std::size_t offset= index*(bind.stride != 0 ? bind.stride : elementSize(bind));
+      void* element= static_cast<char*>(bind.buffer) + offset;
+
+      switch (bind.type) {
+      case ColumnBinding::BIND_INT32:
+        *static_cast<int32_t*>(element)= isNull ? 0 : rowProtocol->getInternalInt(columnInfo);
+        break;
+      case ColumnBinding::BIND_INT64:
+        *static_cast<int64_t*>(element)= isNull ? 0 : rowProtocol->getInternalLong(columnInfo);
+        break;
+      case ColumnBinding::BIND_UINT64:
+        *static_cast<uint64_t*>(element)= isNull ? 0 : rowProtocol->getInternalULong(columnInfo);
+        break;
+      case ColumnBinding::BIND_DOUBLE:
+        *static_cast<double*>(element)= isNull ? 0.0 :
+          static_cast<double>(rowProtocol->getInternalDouble(columnInfo));
+        break;
+      case ColumnBinding::BIND_STRING:
+      case ColumnBinding::BIND_SQLSTRING:
+      {
+        std::size_t length= 0;
+        const char* value= isNull ? nullptr : stringView(rowProtocol, columnInfo, length, stringBuffer);
+
+        if (bind.type == ColumnBinding::BIND_SQLSTRING) {
+          // The string keeps its memory, if it's big enough for the value
+          StringImp::get(*static_cast<SQLString*>(element)).assign(value != nullptr ? value : "", length);
+        }
+        else if (value != nullptr && bind.bufferLength > 0) {
+          std::memcpy(element, value, std::min(length, bind.bufferLength));
+        }
+        if (bind.length != nullptr) {
+          bind.length[index]= length;
+        }
+        break;
+      }
+      }
+    }
+  }
+
+
+  std::size_t SelectResultSetCapi::fetchColumns(std::size_t maxRows, ColumnBinding* columns, std::size_t columnCount)
+  {
+    checkBindings(columns, columnCount);
+
+    std::size_t rowsFetched= 0;
+    std::unique_ptr<SQLString> stringBuffer;
+
+    while (rowsFetched < maxRows && next()) {
+      if (lastRowPointer != rowPointer) {
+        resetRow();
+      }
+      storeColumns(row.get(), columns, columnCount, rowsFetched, stringBuffer);
+      ++rowsFetched;
+    }
+    return rowsFetched;
+  }
+
+
+  namespace
+  {
+    /* Runs the tasks in the calling thread and the threads it creates, each thread taking next task, while there are any */
+    class ThreadExecutor : public TaskExecutor
+    {
+    public:
+      void run(std::size_t count, void (*task)(void* context, std::size_t index), void* context) override
+      {
+        std::atomic<std::size_t> next(0);
+        auto worker= [&next, count, task, context]() {
+          for (std::size_t i= next++; i < count; i= next++) {
+            task(context, i);
+          }
+        };
+        std::size_t threadCount= std::min<std::size_t>(std::max(std::thread::hardware_concurrency(), 1U), count);
+        std::vector<std::thread> threads;
+
+        threads.reserve(threadCount - 1);
+        for (std::size_t i= 1; i < threadCount; ++i) {
+          threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads) {
+          thread.join();
+        }
+      }
+    };
+
+    struct MaterializeContext
+    {
+      std::function<void(std::size_t)> decode;
+      std::mutex lock;
+      std::exception_ptr error;
+    };
+
+    void materializeTask(void* context, std::size_t index)
+    {
+      MaterializeContext* ctx= static_cast<MaterializeContext*>(context);
+      try {
+        ctx->decode(index);
+      }
+      catch (...) {
+        std::lock_guard<std::mutex> localScopeLock(ctx->lock);
+        if (!ctx->error) {
+          ctx->error= std::current_exception();
+        }
+      }
+    }
+  }
+
+  /* Rows of the text protocol are decoded from the local storage, that is read-only meanwhile, by own row protocol
+   * object in each task. Binary protocol's values come decoded already, and its row is bound to the statement, thus
+   * they are copied in the calling thread */
+  std::size_t SelectResultSetCapi::materializeColumns(ColumnBinding* columns, std::size_t columnCount, TaskExecutor* executor)
+  {
+    static const std::size_t ROWS_PER_TASK= 8192;
+
+    checkBindings(columns, columnCount);
+    if (streaming) {
+      if (!keepsRows()) {
+        throw SQLException("Invalid operation for result set type TYPE_FORWARD_ONLY with fetch size set", "HY010");
+      }
+      fetchRemaining();
+    }
+    else if (data.size() < dataSize) {
+      // Rows stored by Connector/C are read with the cursor, and have to be copied for the random access
+      copyStoredRows();
+    }
+    // The current row is set again, when it is accessed next time
+    lastRowPointer= -1;
+
+    if (row->isBinaryEncoded()) {
+      std::unique_ptr<SQLString> stringBuffer;
+
+      for (std::size_t i= 0; i < dataSize; ++i) {
+        row->resetRow(data, i);
+        storeColumns(row.get(), columns, columnCount, i, stringBuffer);
+      }
+      return dataSize;
+    }
+
+    MaterializeContext context;
+    uint32_t maxFieldSize= row->getMaxFieldSize();
+    context.decode= [this, columns, columnCount, maxFieldSize](std::size_t task) {
+      TextRowProtocolCapi taskRow(maxFieldSize, options, nullptr);
+      std::unique_ptr<SQLString> stringBuffer;
+      std::size_t end= std::min(dataSize, (task + 1)*ROWS_PER_TASK);
+
+      for (std::size_t i= task*ROWS_PER_TASK; i < end; ++i) {
+        taskRow.resetRow(data, i);
+        storeColumns(&taskRow, columns, columnCount, i, stringBuffer);
+      }
+    };
+    std::size_t taskCount= (dataSize + ROWS_PER_TASK - 1)/ROWS_PER_TASK;
+    if (taskCount == 1) {
+      context.decode(0);
+    }
+    else if (taskCount > 1) {
+      ThreadExecutor ownExecutor;
+      (executor != nullptr ? executor : &ownExecutor)->run(taskCount, materializeTask, &context);
+      if (context.error) {
+        std::rethrow_exception(context.error);
+      }
+    }
+    return dataSize;
+  }
+
+
+  int64_t SelectResultSetCapi::exportTo(int fd, ExportOptions::Format format, const ExportOptions& options)
+  {
+    if (format != ExportOptions::EXPORT_CSV && format != ExportOptions::EXPORT_TSV &&
+      format != ExportOptions::EXPORT_NDJSON) {
+      throw SQLException("Invalid export format", "HY024");
+    }
+    ExportWriter writer(fd, options.bufferSize);
+    const char* nullValue= options.nullValue != nullptr ? options.nullValue : "";
+    std::size_t nullLength= std::strlen(nullValue);
+    // NDJSON writes numbers unquoted. BIT values are bytes, rather than numbers
+    std::vector<bool> numeric(columnInformationLength);
+
+    for (int32_t i= 0; i < columnInformationLength; ++i) {
+      const ColumnType& type= columnsInformation[i]->getColumnType();
+      numeric[i]= ColumnType::isNumeric(type) && type != ColumnType::BIT;
+    }
+    if (options.header && format != ExportOptions::EXPORT_NDJSON) {
+      for (int32_t i= 0; i < columnInformationLength; ++i) {
+        std::size_t length;
+        const char* label= columnsInformation[i]->getNameView(length);
+        if (format == ExportOptions::EXPORT_CSV) {
+          if (i > 0) {
+            writer.append(options.separator);
+          }
+          writer.appendCsv(label, length, options.separator);
+        }
+        else {
+          if (i > 0) {
+            writer.append('\t');
+          }
+          writer.appendTsv(label, length);
+        }
+      }
+      writer.append('\n');
+    }
+
+    std::unique_ptr<SQLString> stringBuffer;
+    int64_t rows= 0;
+
+    while (next()) {
+      if (lastRowPointer != rowPointer) {
+        resetRow();
+      }
+      if (format == ExportOptions::EXPORT_NDJSON) {
+        writer.append('{');
+      }
+      for (int32_t i= 0; i < columnInformationLength; ++i) {
+        ColumnDefinition* columnInfo= columnsInformation[i].get();
+        std::size_t length;
+
+        row->setPosition(i);
+        const char* value= stringView(row.get(), columnInfo, length, stringBuffer);
+
+        switch (format) {
+        case ExportOptions::EXPORT_CSV:
+          if (i > 0) {
+            writer.append(options.separator);
+          }
+          if (value == nullptr) {
+            writer.append(nullValue, nullLength);
+          }
+          else {
+            writer.appendCsv(value, length, options.separator);
+          }
+          break;
+        case ExportOptions::EXPORT_TSV:
+          if (i > 0) {
+            writer.append('\t');
+          }
+          if (value == nullptr) {
+            writer.append("\\N", 2);
+          }
+          else {
+            writer.appendTsv(value, length);
+          }
+          break;
+        default: {
+          std::size_t labelLength;
+          const char* label= columnInfo->getNameView(labelLength);
+          if (i > 0) {
+            writer.append(',');
+          }
+          writer.appendJsonString(label, labelLength);
+          writer.append(':');
+          if (value == nullptr) {
+            writer.append("null", 4);
+          }
+          else if (numeric[i]) {
+            writer.append(value, length);
+          }
+          else {
+            writer.appendJsonString(value, length);
+          }
+        }
+        }
+      }
+      if (format == ExportOptions::EXPORT_NDJSON) {
+        writer.append('}');
+      }
+      writer.append('\n');
+      ++rows;
+    }
+    writer.flush();
+    return rows;
+  }
+
 #ifdef RS_UPDATE_FUNCTIONALITY_IMPLEMENTED
   /** {inheritDoc}. */
   void SelectResultSetCapi::updateNull(int32_t columnIndex) {
@@ -1969,6 +2836,7 @@ namespace capi
   /** Force metadata getTableName to return table alias, not original table name. */
   void SelectResultSetCapi::setForceTableAlias() {
     this->forceAlias= true;
+    metadata.reset();
   }
 
   void SelectResultSetCapi::rangeCheck(const SQLString& className, int64_t minValue, int64_t maxValue, int64_t value, ColumnDefinition* columnInfo) {
@@ -2022,32 +2890,42 @@ namespace capi
         // we have already it cached
         return;
       }
-      auto preservedPosition= rowPointer;
       // fetchRemaining does remaining stream
       if (streaming) {
         fetchRemainingInternal();
       }
       else {
-        if (rowPointer > -1) {
-          beforeFirst();
-          row->installCursorAtPosition(rowPointer > -1 ? rowPointer : 0);
-          lastRowPointer= -1;
-        }
-        growDataArray(true);
-        for (std::size_t rowNum= 0; rowNum < dataSize; ++rowNum) {
-          row->fetchNext();
-          row->cacheCurrentRow(data[rowNum], columnInformationLength);
-        }
-        for (auto& colInfo : columnsInformation) {
-          colInfo->makeLocalCopy();
-        }
-        //columnNameMap.init(columnsInformation);
-        rowPointer= preservedPosition;
+        copyStoredRows();
         fetchSize= 0;
       }
     }
     // else it is already cached in case of Text protocol
   }
+
+
+  /* Copies rows, that Connector/C has stored, to the local storage. The cursor position is kept */
+  void SelectResultSetCapi::copyStoredRows()
+  {
+    auto preservedPosition= rowPointer;
+
+    row->installCursorAtPosition(0);
+    lastRowPointer= -1;
+    data.reserve(dataSize);
+    for (std::size_t rowNum= 0; rowNum < dataSize; ++rowNum) {
+      row->fetchNext();
+      row->cacheCurrentRow(data, columnInformationLength);
+    }
+    reserveRows();
+    if (row->isBinaryEncoded()) {
+      // Column objects are shared with the prepare result, that reuses them for next executions
+      for (auto& colInfo : columnsInformation) {
+        colInfo= std::make_shared<ColumnDefinitionCapi>(*static_cast<ColumnDefinitionCapi*>(colInfo.get()));
+        colInfo->makeLocalCopy();
+      }
+    }
+    //columnNameMap.init(columnsInformation);
+    rowPointer= preservedPosition;
+  }
 }
 }
 }
@@ -36,6 +36,9 @@
 #include "ResultSet.hpp"
 #include "ColumnType.h"
 #include "com/ColumnNameMap.h"
+#include "com/RowDataArena.h"
+#include "com/RowReadAhead.h"
+#include "util/MemoryAccounting.h"
 #include "io/StandardPacketInputStream.h"
 
 #include "jdbccompat.hpp"
@@ -53,14 +56,17 @@ namespace capi
 {
 #include "mysql.h"
 
-class SelectResultSetCapi : public SelectResultSet
+class SelectResultSetCapi final : public SelectResultSet
 {
   //TimeZone* timeZone= nullptr;
   Shared::Options options;
   std::vector<Shared::ColumnDefinition> columnsInformation;
   int32_t columnInformationLength;
   bool noBackslashEscapes;
-  std::map<int32_t, std::unique_ptr<memBuf>> blobBuffer;
+  Charset::Transcoding transcoding= Charset::NO_TRANSCODING;
+  std::map<int32_t, std::unique_ptr<std::streambuf>> blobBuffer;
+  /* Values converted for getStringView, that have to live until the cursor is moved */
+  std::vector<std::unique_ptr<SQLString>> stringViewBuffer;
 
   Protocol* protocol;
   bool isEof= false;
@@ -74,22 +80,48 @@ class SelectResultSetCapi : public SelectResultSet
 
   int32_t dataFetchTime= 0;
   bool streaming;
-
-  /*std::unique_ptr<*/
-  std::vector<std::vector<sql::bytes>> data;
+  /* Rows are read from the server cursor by COM_STMT_FETCH, and the connection is not blocked by the result */
+  bool serverCursor= false;
+  /* Result without fetch size, read in batches of incrementalFetchSize rows as next() reaches them. Unlike the
+     streaming result it keeps all rows and stays scrollable */
+  bool incremental= false;
+  /* Forward-only streaming result reads the rows one by one, and the current row is read right from Connector/C
+     buffers, without being copied into data. Unless the rows are read by the byte budget or ahead, or the row has to
+     outlive the fetch of the next one, as with fetchRemaining or isLast */
+  bool directRows= false;
+
+  RowDataArena data;
   std::size_t dataSize; //Should go after data
+  /* Memory of the stored rows in the connection's and process wide accounts */
+  MemoryReservation dataReservation;
+  /* Views of the cells of the current row in the data, returned by getCurrentRowData */
+  std::vector<sql::bytes> currentRowView;
 
   int32_t fetchSize;
+  /* Byte budget of the chunk of the streamed result. Rows and their data read so far give the row size, by which the
+     rows of the server cursor's chunk are estimated */
+  std::size_t fetchBytes= 0;
+  uint64_t observedRows= 0;
+  uint64_t observedBytes= 0;
   int32_t resultSetScrollType;
   int32_t rowPointer= -1;
 
   ColumnNameMap columnNameMap;
 
   int32_t lastRowPointer= -1;
+  /* Rows of stored result, which data has been counted in the metrics */
+  int32_t countedRows= 0;
   bool isClosedFlag= false;
   bool eofDeprecated;
   Shared::mutex lock;
   bool forceAlias;
+  /* Created on the first request, and shared with the objects returned by getMetaData */
+  Shared::MariaDbResultSetMetaData metadata;
+  /* Set by the read ahead thread, if a value of the window has been truncated */
+  bool readAheadTruncated= false;
+  /* Reader of the next window of the streaming result(streamingReadAhead). Uses the row, thus it has to be destroyed
+     first, and goes last */
+  std::unique_ptr<RowReadAhead> readAhead;
 
 public:
 
@@ -107,8 +139,8 @@ public:
     bool eofDeprecated);
 
   SelectResultSetCapi(
-    std::vector<Shared::ColumnDefinition>& columnInformation,
-    /*std::unique_ptr<*/std::vector<std::vector<sql::bytes>>& resultSet,
+    const std::vector<Shared::ColumnDefinition>& columnInformation,
+    /*std::unique_ptr<*/const std::vector<std::vector<sql::bytes>>& resultSet,
     Protocol* protocol,
     int32_t resultSetScrollType);
   ~SelectResultSetCapi();
@@ -116,13 +148,32 @@ public:
   bool isFullyLoaded() const;
 
 private:
+  /* If rows are to be read into own storage instead of Connector/C's, i.e. a spill threshold or a limit are set */
+  bool storesRowsItself() const;
+  /* If the rows, that have been read, are kept, i.e. the result is not a forward-only window of fetchSize rows */
+  bool keepsRows() const;
+  /* Updates the reservation after the rows storage has changed. Throws if a memory limit is exceeded */
+  void reserveRows()
+  {
+    if (data.memoryUsed() != dataReservation.size()) {
+      dataReservation.resize(data.memoryUsed());
+    }
+  }
   void fetchAllResults();
+  void startReadAhead();
+  /* Replaces the window of rows with the one, that has been read ahead */
+  void takeReadAhead();
+  /* Waits for the read ahead window, appends it to the rows if keepRows is true, and returns the connection to the
+     calling thread */
+  void stopReadAhead(bool keepRows);
+  void closeServerCursor();
 
   const char* getErrMessage();
   const char* getSqlState();
   uint32_t getErrNo();
   uint32_t warningCount();
   void fetchRemainingInternal(); // no Locking
+  void keepCurrentRow();
 public:
   void fetchRemaining();
 
@@ -131,6 +182,11 @@ private:
   void nextStreamingValue();
   void addStreamingValue();
   bool readNextValue();
+  int32_t chunkRows() const;
+  void readAllRows();
+  void copyStoredRows();
+  void readEndOfResult();
+  void skipRemainingRows();
 
 protected:
   std::vector<sql::bytes>& getCurrentRowData();
@@ -138,10 +194,6 @@ protected:
   void deleteCurrentRowData();
   void addRowData(std::vector<sql::bytes>& rawData);
 
-private:
-  void growDataArray(bool complete= false);
-
-public:
   void abort();
   void close();
 
@@ -152,7 +204,9 @@ public:
   bool next();
 private:
   void resetRow();
+  void countRowData();
   void checkObjectRange(int32_t position);
+  void checkRowRange(int32_t position);
 public:
   SQLWarning* getWarnings();
   void clearWarnings();
@@ -282,6 +336,40 @@ public:
   void cancelRowUpdates();
 
   std::size_t rowsCount();
+  const char* getStringView(int32_t columnIndex, std::size_t& length);
+  const char* getStringView(const SQLString& columnLabel, std::size_t& length);
+  const char* getJsonView(int32_t columnIndex, std::size_t& length);
+  const char* getJsonView(const SQLString& columnLabel, std::size_t& length);
+  std::u16string getU16String(int32_t columnIndex);
+  std::u16string getU16String(const SQLString& columnLabel);
+  std::wstring getWString(int32_t columnIndex);
+  std::wstring getWString(const SQLString& columnLabel);
+  std::size_t getBytesInto(int32_t columnIndex, sql::bytes& buffer);
+  std::size_t getBytesInto(const SQLString& columnLabel, sql::bytes& buffer);
+  std::size_t fetchColumns(std::size_t maxRows, ColumnBinding* columns, std::size_t columnCount);
+  std::size_t materializeColumns(ColumnBinding* columns, std::size_t columnCount, TaskExecutor* executor);
+  int64_t exportTo(int fd, ExportOptions::Format format, const ExportOptions& options);
+  bool getDateTime(int32_t columnIndex, DateTime& value);
+  bool getDateTime(const SQLString& columnLabel, DateTime& value);
+  bool getDecimal(int32_t columnIndex, Decimal& value);
+  bool getDecimal(const SQLString& columnLabel, Decimal& value);
+  ResultSetMetaData& getMetaDataView();
+private:
+  const char* currentStringView(int32_t columnIndex, std::size_t& length);
+  /* The value in the row buffer as the server has sent it, or converted to the string into the buffer, and the
+     transcoding it needs. NULL value is returned as nullptr */
+  const char* rawStringView(int32_t columnIndex, std::size_t& length, std::unique_ptr<SQLString>& buffer,
+    Charset::Transcoding& valueTranscoding);
+  /* currentStringView for the current row of the rowProtocol. Converted value is kept in the buffer */
+  const char* stringView(RowProtocol* rowProtocol, ColumnDefinition* columnInfo, std::size_t& length,
+    std::unique_ptr<SQLString>& buffer) const;
+  void checkBindings(ColumnBinding* columns, std::size_t columnCount);
+  /* Distance between the values of consecutive rows in the binding's buffer, if its stride is not set */
+  static std::size_t elementSize(const ColumnBinding& bind);
+  /* Stores the values of the current row of the rowProtocol to the element index of the bindings */
+  void storeColumns(RowProtocol* rowProtocol, ColumnBinding* columns, std::size_t columnCount, std::size_t index,
+    std::unique_ptr<SQLString>& stringBuffer) const;
+public:
 
 #ifdef RS_UPDATE_FUNCTIONALITY_IMPLEMENTED
   void updateNull(int32_t columnIndex);
@@ -21,6 +21,8 @@
 #ifndef _CREDENTIAL_H_
 #define _CREDENTIAL_H_
 
+#include <chrono>
+
 #include "SQLString.hpp"
 
 namespace sql
@@ -31,12 +33,16 @@ namespace mariadb
 class Credential  {
   SQLString user;
   SQLString password;
+  // Tokens of the external providers expire. Credentials, that do expire, are cached until then by CredentialCache
+  std::chrono::steady_clock::time_point expires= std::chrono::steady_clock::time_point::max();
 
 public:
   Credential(const SQLString& user, const SQLString& password);
   const SQLString& getUser() const;
   void setUser(const SQLString& user);
   const SQLString& getPassword() const;
+  std::chrono::steady_clock::time_point getExpires() const { return expires; }
+  void setExpires(std::chrono::steady_clock::time_point _expires) { expires= _expires; }
   };
 }
 }
@@ -0,0 +1,163 @@
+/************************************************************************************
+   Copyright (C) 2020 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#include <tuple>
+
+#include "CredentialCache.h"
+
+namespace sql
+{
+namespace mariadb
+{
+  // Failed refresh is not retried more often than that
+  static const std::chrono::seconds retryInterval(1);
+
+
+  CredentialCache::Entry::Entry(std::shared_ptr<CredentialPlugin>& _plugin, Shared::Options& _options,
+    const SQLString& _userName, const HostAddress& _hostAddress)
+    : plugin(_plugin)
+    , options(_options)
+    , userName(_userName)
+    , hostAddress(_hostAddress)
+  {
+  }
+
+
+  void CredentialCache::Entry::update(const Credential& credential, std::chrono::steady_clock::time_point now)
+  {
+    user= credential.getUser();
+    password= credential.getPassword();
+    expires= credential.getExpires();
+    refreshAt= expires > now ? now + (expires - now)*4/5 : now;
+  }
+
+
+  CredentialCache::~CredentialCache()
+  {
+    {
+      std::lock_guard<std::mutex> localScopeLock(lock);
+      stopping= true;
+    }
+    wakeup.notify_all();
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+
+
+  CredentialCache& CredentialCache::getInstance()
+  {
+    static CredentialCache theInstance;
+    return theInstance;
+  }
+
+
+  Credential* CredentialCache::get(std::shared_ptr<CredentialPlugin>& plugin, Shared::Options& options,
+    const SQLString& userName, const HostAddress& hostAddress)
+  {
+    std::string key(plugin->type());
+    key.push_back('\0');
+    key.append(StringImp::get(userName)).push_back('\0');
+    key.append(StringImp::get(hostAddress.host)).push_back(':');
+    key.append(std::to_string(hostAddress.port));
+
+    auto now= std::chrono::steady_clock::now();
+    {
+      std::lock_guard<std::mutex> localScopeLock(lock);
+      auto it= entries.find(key);
+
+      if (it != entries.end() && it->second.expires > now) {
+        Entry& entry= it->second;
+        if (!entry.refreshing && entry.refreshAt <= now) {
+          entry.refreshing= true;
+          toRefresh.push_back(key);
+          if (!worker.joinable()) {
+            worker= std::thread(&CredentialCache::run, this);
+          }
+          wakeup.notify_one();
+        }
+        Credential* credential= new Credential(entry.user, entry.password);
+        credential->setExpires(entry.expires);
+        return credential;
+      }
+    }
+
+    std::unique_ptr<Credential> credential(plugin->initialize(options, userName, hostAddress)->get());
+
+    if (credential->getExpires() != std::chrono::steady_clock::time_point::max()) {
+      now= std::chrono::steady_clock::now();
+      std::lock_guard<std::mutex> localScopeLock(lock);
+      auto it= entries.find(key);
+
+      if (it == entries.end()) {
+        it= entries.emplace(std::piecewise_construct, std::forward_as_tuple(key),
+          std::forward_as_tuple(plugin, options, userName, hostAddress)).first;
+      }
+      it->second.update(*credential, now);
+    }
+    return credential.release();
+  }
+
+
+  void CredentialCache::run()
+  {
+    std::unique_lock<std::mutex> localScopeLock(lock);
+
+    while (!stopping) {
+      if (toRefresh.empty()) {
+        wakeup.wait(localScopeLock);
+        continue;
+      }
+      std::string key(std::move(toRefresh.front()));
+      toRefresh.pop_front();
+
+      auto it= entries.find(key);
+      if (it == entries.end()) {
+        continue;
+      }
+      std::shared_ptr<CredentialPlugin> plugin(it->second.plugin);
+      Shared::Options options(it->second.options);
+      SQLString userName(it->second.userName);
+      HostAddress hostAddress(it->second.hostAddress);
+      std::unique_ptr<Credential> credential;
+
+      // The provider is called without the lock, so connects are served from the cache meanwhile
+      localScopeLock.unlock();
+      try {
+        credential.reset(plugin->initialize(options, userName, hostAddress)->get());
+      }
+      catch (std::exception&) {
+      }
+      localScopeLock.lock();
+
+      // Entries are never removed
+      Entry& entry= entries.find(key)->second;
+      auto now= std::chrono::steady_clock::now();
+      entry.refreshing= false;
+      if (credential) {
+        entry.update(*credential, now);
+      }
+      else {
+        entry.refreshAt= now + retryInterval;
+      }
+    }
+  }
+}
+}
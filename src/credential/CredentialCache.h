@@ -0,0 +1,85 @@
+/************************************************************************************
+   Copyright (C) 2020 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _CREDENTIALCACHE_H_
+#define _CREDENTIALCACHE_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "CredentialPlugin.h"
+
+namespace sql
+{
+namespace mariadb
+{
+
+/* Process wide cache of credentials, that plugins give with the expiry, e.g. tokens of cloud IAM. The key is the plugin
+   type, the user and the host. Once 4/5 of the credential's lifetime has passed, the connect, that gets it, queues its
+   refresh, and the cache's thread gets the new one from the plugin, while connects keep using the cached one. Thus only
+   the very first connect, or the one after the credential has expired, waits for the provider. The thread is started
+   with the first refresh */
+class CredentialCache final
+{
+  struct Entry
+  {
+    std::shared_ptr<CredentialPlugin> plugin;
+    Shared::Options options;
+    SQLString userName;
+    HostAddress hostAddress;
+    SQLString user;
+    SQLString password;
+    std::chrono::steady_clock::time_point refreshAt;
+    std::chrono::steady_clock::time_point expires;
+    bool refreshing= false;
+
+    Entry(std::shared_ptr<CredentialPlugin>& plugin, Shared::Options& options, const SQLString& userName,
+      const HostAddress& hostAddress);
+    void update(const Credential& credential, std::chrono::steady_clock::time_point now);
+  };
+
+  std::mutex lock;
+  std::condition_variable wakeup;
+  std::map<std::string, Entry> entries;
+  std::deque<std::string> toRefresh;
+  std::thread worker;
+  bool stopping= false;
+
+  CredentialCache() {}
+  ~CredentialCache();
+  void run();
+
+public:
+  static CredentialCache& getInstance();
+  /* The caller owns the credential. If there is no cached credential, or it has expired, it is fetched from the
+     plugin right away */
+  Credential* get(std::shared_ptr<CredentialPlugin>& plugin, Shared::Options& options, const SQLString& userName,
+    const HostAddress& hostAddress);
+};
+
+}
+}
+#endif
@@ -25,12 +25,15 @@ namespace sql
 {
 namespace mariadb
 {
-  static std::shared_ptr<CredentialPlugin> nullPlugin(nullptr);
-  std::map<std::string, std::shared_ptr<CredentialPlugin>> CredentialPluginLoader::plugin;
+  std::map<std::string, std::shared_ptr<CredentialPlugin>>& CredentialPluginLoader::plugins()
+  {
+    static std::map<std::string, std::shared_ptr<CredentialPlugin>> plugin;
+    return plugin;
+  }
 
   void CredentialPluginLoader::RegisterPlugin(CredentialPlugin* aPlugin)
   {
-    plugin.insert(std::pair<std::string, std::shared_ptr<CredentialPlugin>>(aPlugin->type(), std::shared_ptr<CredentialPlugin>(aPlugin)));
+    plugins().insert(std::pair<std::string, std::shared_ptr<CredentialPlugin>>(aPlugin->type(), std::shared_ptr<CredentialPlugin>(aPlugin)));
   }
   /**
    * Get current Identity plugin according to option `identityType`.
@@ -44,14 +47,14 @@ namespace mariadb
     if (type.empty()){
       return nullptr;
     }
-    std::map<std::string, std::shared_ptr<CredentialPlugin>>::iterator PluginTypeHandler= plugin.find(type);
-    if (PluginTypeHandler != plugin.end()){
+    std::map<std::string, std::shared_ptr<CredentialPlugin>>::iterator PluginTypeHandler= plugins().find(type);
+    if (PluginTypeHandler != plugins().end()){
       return PluginTypeHandler->second;
     }
     /* As auth plugins are currently cared by C/C we cannot check if named plugin is available. We will later let C/C to do that.
        So far just returning "null" plugin as we do not need to throw exception now.
     */
-    return nullPlugin;
+    return nullptr;
     //throw sql::SQLException(SQLString("No identity plugin registered with the type \"") + type + "\".", "08004", 1251);
   }
 }
@@ -33,7 +33,8 @@ namespace mariadb
 {
 class CredentialPluginLoader
 {
-  static std::map<std::string, std::shared_ptr<CredentialPlugin>> plugin;
+  // Function-local, so plugins can register from their static initializers, and the map costs nothing until then
+  static std::map<std::string, std::shared_ptr<CredentialPlugin>>& plugins();
   public:
     static void RegisterPlugin(CredentialPlugin *aplugin);
     static std::shared_ptr<CredentialPlugin> get(const std::string& type);
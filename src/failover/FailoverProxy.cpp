@@ -63,7 +63,7 @@ namespace mariadb
    * @param lock synchronisation lock
    * @throws SQLException if connection error occur
    */
-  FailoverProxy::FailoverProxy(Listener* _listener, std::mutex* _lock)
+  FailoverProxy::FailoverProxy(Listener* _listener, ConnectionMutex* _lock)
     : listener(_listener)
     , lock(_lock)
   {
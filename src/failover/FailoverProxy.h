@@ -77,7 +77,7 @@ class FailoverProxy {
 public:
   Shared::mutex lock; /* Weak? */
 
-  FailoverProxy(Listener* listener, std::mutex* lock);
+  FailoverProxy(Listener* listener, ConnectionMutex* lock);
 
 #ifdef JDBC_SPECIFIC_TYPES_IMPLEMENTED
   sql::Object* invoke(sql::Object* proxy,Method method,sql::sql::Object** args);
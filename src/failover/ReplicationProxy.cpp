@@ -0,0 +1,983 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+
+#include <algorithm>
+
+#include "ReplicationProxy.h"
+
+#include "logger/LoggerFactory.h"
+#include "protocol/MasterProtocol.h"
+#include "util/ServerPrepareResult.h"
+#include "util/LogQueryTool.h"
+
+namespace sql
+{
+namespace mariadb
+{
+  Shared::Logger ReplicationProxy::logger= LoggerFactory::getLogger(typeid(ReplicationProxy));
+
+  /**
+   * Connects to the master. Hosts of the url of the "slave" type are replicas
+   *
+   * @param urlParser connection URL infos
+   * @param globalInfo server global variables information
+   */
+  ReplicationProxy::ReplicationProxy(std::shared_ptr<UrlParser>& _urlParser, GlobalStateInfo* globalInfo)
+    : lock(new ConnectionMutex(_urlParser->getOptions()->threadSafeConnection))
+    , urlParser(_urlParser)
+    , current(nullptr)
+    , readOnly(false)
+    , replicaFailed(false)
+  {
+    std::shared_ptr<UrlParser> masterUrlParser(urlParser->clone());
+    std::vector<HostAddress>& masters= masterUrlParser->getHostAddresses();
+
+    replicaUrlParser.reset(urlParser->clone());
+    std::vector<HostAddress>& replicas= replicaUrlParser->getHostAddresses();
+
+    masters.erase(std::remove_if(masters.begin(), masters.end(),
+      [](const HostAddress& host) { return ParameterConstant::TYPE_MASTER.compare(host.type) != 0; }), masters.end());
+    replicas.erase(std::remove_if(replicas.begin(), replicas.end(),
+      [](const HostAddress& host) { return ParameterConstant::TYPE_MASTER.compare(host.type) == 0; }), replicas.end());
+
+    if (replicas.empty()) {
+      replicaUrlParser.reset();
+    }
+    if (masters.empty()) {
+      throw SQLException("No master host is defined in the replication url " + urlParser->getInitialUrl(), "08000");
+    }
+    // Each connection has own lock, since this lock is taken by callers, and then connections may take theirs
+    Shared::mutex masterLock(new ConnectionMutex(urlParser->getOptions()->threadSafeConnection));
+    master.reset(new MasterProtocol(masterUrlParser, globalInfo, masterLock));
+    master->connectWithoutProxy();
+    current= master.get();
+  }
+
+
+  Protocol* ReplicationProxy::connectedReplica()
+  {
+    if (!replicaUrlParser || replicaFailed) {
+      return nullptr;
+    }
+    try {
+      if (!replica) {
+        Shared::mutex replicaLock(new ConnectionMutex(urlParser->getOptions()->threadSafeConnection));
+        // Global state of the master does not apply to replicas
+        replica.reset(new MasterProtocol(replicaUrlParser, nullptr, replicaLock));
+        replica->connectWithoutProxy();
+      }
+      else if (replica->isClosed()) {
+        replica->connectWithoutProxy();
+      }
+    }
+    catch (SQLException& e) {
+      replicaFailed= true;
+      logger->warn(SQLString("Could not connect to any replica, using master connection: ") + e.getMessage());
+      return nullptr;
+    }
+    return replica.get();
+  }
+
+
+  void ReplicationProxy::switchTo(Protocol* target)
+  {
+    target->setMaxRows(current->getMaxRows());
+    if (target->getTransactionIsolationLevel() != current->getTransactionIsolationLevel()) {
+      target->setTransactionIsolation(current->getTransactionIsolationLevel());
+    }
+    if (target->getDatabase().compare(current->getDatabase()) != 0) {
+      target->setCatalog(current->getDatabase());
+    }
+    target->setAutocommit(current->getAutocommit());
+    current= target;
+  }
+
+
+  Protocol* ReplicationProxy::route()
+  {
+    if (readOnly == (current != master.get())
+      || current->inTransaction() || current->getActiveStreamingResult() != nullptr || current->hasMoreResults()) {
+      return current;
+    }
+    Protocol* target= readOnly ? connectedReplica() : master.get();
+
+    if (target != nullptr && (target == master.get() || replicaCaughtUp(target))) {
+      switchTo(target);
+    }
+    return current;
+  }
+
+
+  /* With readYourWrites the read goes to the replica only after it has applied the last transaction, that the master
+     connection has written. The replica is waited for up to readYourWritesTimeout once for each GTID, and then only
+     checked, while reads stay on the master */
+  bool ReplicationProxy::replicaCaughtUp(Protocol* target)
+  {
+    const SQLString& gtid= master->getLastGtid();
+
+    if (!urlParser->getOptions()->readYourWrites || gtid.empty() || gtid.compare(replicaGtid) == 0) {
+      return true;
+    }
+    int32_t timeout= gtid.compare(awaitedGtid) == 0 ? 0 : urlParser->getOptions()->readYourWritesTimeout;
+    awaitedGtid= gtid;
+    try {
+      if (target->waitForGtid(gtid, timeout)) {
+        replicaGtid= gtid;
+        return true;
+      }
+    }
+    catch (SQLException& e) {
+      logger->warn("Could not check the replica's GTID position, using master connection: " + e.getMessage());
+    }
+    return false;
+  }
+
+
+  Protocol* ReplicationProxy::prepareOwner(ServerPrepareResult* serverPrepareResult)
+  {
+    if (replica && serverPrepareResult->getUnProxiedProtocol() == replica.get()) {
+      return replica.get();
+    }
+    return master.get();
+  }
+
+
+  Protocol* ReplicationProxy::owner(ServerPrepareResult* serverPrepareResult)
+  {
+    if (serverPrepareResult == nullptr) {
+      return route();
+    }
+    current= prepareOwner(serverPrepareResult);
+    return current;
+  }
+
+
+  ServerPrepareResult* ReplicationProxy::prepare(const SQLString& sql, bool executeOnMaster)
+  {
+    return route()->prepare(sql, executeOnMaster);
+  }
+
+
+  bool ReplicationProxy::getAutocommit()
+  {
+    return current->getAutocommit();
+  }
+
+
+  void ReplicationProxy::setAutocommit(bool autocommit)
+  {
+    current->setAutocommit(autocommit);
+  }
+
+
+  bool ReplicationProxy::noBackslashEscapes()
+  {
+    return current->noBackslashEscapes();
+  }
+
+
+  void ReplicationProxy::connect()
+  {
+    master->connect();
+  }
+
+
+  const UrlParser& ReplicationProxy::getUrlParser() const
+  {
+    return *urlParser;
+  }
+
+
+  bool ReplicationProxy::inTransaction()
+  {
+    return current->inTransaction();
+  }
+
+
+  FailoverProxy* ReplicationProxy::getProxy()
+  {
+    return master->getProxy();
+  }
+
+
+  void ReplicationProxy::setProxy(FailoverProxy* proxy)
+  {
+    master->setProxy(proxy);
+  }
+
+
+  const Shared::Options& ReplicationProxy::getOptions() const
+  {
+    return urlParser->getOptions();
+  }
+
+
+  bool ReplicationProxy::hasMoreResults()
+  {
+    return current->hasMoreResults();
+  }
+
+
+  void ReplicationProxy::close()
+  {
+    if (replica && !replica->isClosed()) {
+      replica->close();
+    }
+    master->close();
+  }
+
+
+  void ReplicationProxy::reset()
+  {
+    if (replica && !replica->isClosed()) {
+      replica->reset();
+    }
+    master->reset();
+  }
+
+
+  void ReplicationProxy::changeUser(const SQLString& user, const SQLString& password, const SQLString& database)
+  {
+    if (replica && !replica->isClosed()) {
+      replica->changeUser(user, password, database);
+    }
+    master->changeUser(user, password, database);
+  }
+
+
+  void ReplicationProxy::closeExplicit()
+  {
+    if (replica && !replica->isClosed()) {
+      replica->closeExplicit();
+    }
+    master->closeExplicit();
+  }
+
+
+  void ReplicationProxy::deferTransactionEnd(bool commit)
+  {
+    current->deferTransactionEnd(commit);
+  }
+
+
+  void ReplicationProxy::flushTransactionEnd()
+  {
+    if (replica && !replica->isClosed()) {
+      replica->flushTransactionEnd();
+    }
+    master->flushTransactionEnd();
+  }
+
+
+  void ReplicationProxy::deferSavepoint(const SQLString& name, bool release)
+  {
+    current->deferSavepoint(name, release);
+  }
+
+
+  bool ReplicationProxy::rollbackDeferredSavepoint(const SQLString& name)
+  {
+    return current->rollbackDeferredSavepoint(name);
+  }
+
+
+  bool ReplicationProxy::isClosed()
+  {
+    return master->isClosed();
+  }
+
+
+  void ReplicationProxy::resetDatabase()
+  {
+    if (replica && !replica->isClosed()) {
+      replica->resetDatabase();
+    }
+    master->resetDatabase();
+  }
+
+
+  void ReplicationProxy::resetSessionState(bool autocommit, int32_t transactionIsolationLevel, bool resetDatabase)
+  {
+    if (replica && !replica->isClosed()) {
+      replica->resetSessionState(autocommit, transactionIsolationLevel, resetDatabase);
+    }
+    master->resetSessionState(autocommit, transactionIsolationLevel, resetDatabase);
+  }
+
+
+  SQLString ReplicationProxy::getCatalog()
+  {
+    return current->getCatalog();
+  }
+
+
+  void ReplicationProxy::setCatalog(const SQLString& database)
+  {
+    current->setCatalog(database);
+  }
+
+
+  const SQLString& ReplicationProxy::getServerVersion() const
+  {
+    return current->getServerVersion();
+  }
+
+
+  bool ReplicationProxy::isConnected()
+  {
+    return master->isConnected();
+  }
+
+
+  bool ReplicationProxy::getReadonly() const
+  {
+    return readOnly;
+  }
+
+
+  void ReplicationProxy::setReadonly(bool readOnly)
+  {
+    this->readOnly= readOnly;
+    if (readOnly) {
+      replicaFailed= false;
+    }
+  }
+
+
+  bool ReplicationProxy::isMasterConnection()
+  {
+    return current->isMasterConnection();
+  }
+
+
+  bool ReplicationProxy::mustBeMasterConnection()
+  {
+    return current->mustBeMasterConnection();
+  }
+
+
+  const HostAddress& ReplicationProxy::getHostAddress() const
+  {
+    return current->getHostAddress();
+  }
+
+
+  void ReplicationProxy::setHostAddress(const HostAddress& hostAddress)
+  {
+    master->setHostAddress(hostAddress);
+  }
+
+
+  const SQLString& ReplicationProxy::getHost() const
+  {
+    return current->getHost();
+  }
+
+
+  int32_t ReplicationProxy::getPort() const
+  {
+    return current->getPort();
+  }
+
+
+  void ReplicationProxy::rollback()
+  {
+    current->rollback();
+  }
+
+
+  const SQLString& ReplicationProxy::getDatabase() const
+  {
+    return current->getDatabase();
+  }
+
+
+  const SQLString& ReplicationProxy::getUsername() const
+  {
+    return current->getUsername();
+  }
+
+
+  bool ReplicationProxy::ping()
+  {
+    return current->ping();
+  }
+
+
+  bool ReplicationProxy::isValid(int32_t timeout)
+  {
+    return current->isValid(timeout);
+  }
+
+
+  void ReplicationProxy::executeQuery(const SQLString& sql)
+  {
+    route()->executeQuery(sql);
+  }
+
+
+  void ReplicationProxy::executeQuery(bool mustExecuteOnMaster, Shared::Results& results, const SQLString& sql)
+  {
+    route()->executeQuery(mustExecuteOnMaster, results, sql);
+  }
+
+
+  void ReplicationProxy::executePipeline(std::vector<Shared::Results>& results, const std::vector<SQLString>& queries)
+  {
+    route()->executePipeline(results, queries);
+  }
+
+
+  int32_t ReplicationProxy::executeQueryAsyncStart(const SQLString& sql)
+  {
+    return route()->executeQueryAsyncStart(sql);
+  }
+
+
+  int32_t ReplicationProxy::executeQueryAsyncContinue(int32_t readyEvents)
+  {
+    return current->executeQueryAsyncContinue(readyEvents);
+  }
+
+
+  int64_t ReplicationProxy::getNativeSocket()
+  {
+    return current->getNativeSocket();
+  }
+
+
+  uint32_t ReplicationProxy::getAsyncTimeout()
+  {
+    return current->getAsyncTimeout();
+  }
+
+
+  void ReplicationProxy::executeQuery(bool mustExecuteOnMaster, Shared::Results& results, const SQLString& sql, const Charset* charset)
+  {
+    route()->executeQuery(mustExecuteOnMaster, results, sql, charset);
+  }
+
+
+  void ReplicationProxy::executeQuery(bool mustExecuteOnMaster, Shared::Results& results, ClientPrepareResult* clientPrepareResult,
+    std::vector<Shared::ParameterHolder>& parameters)
+  {
+    route()->executeQuery(mustExecuteOnMaster, results, clientPrepareResult, parameters);
+  }
+
+
+  void ReplicationProxy::executeQuery(bool mustExecuteOnMaster, Shared::Results& results, ClientPrepareResult* clientPrepareResult,
+    std::vector<Shared::ParameterHolder>& parameters, int32_t timeout)
+  {
+    route()->executeQuery(mustExecuteOnMaster, results, clientPrepareResult, parameters, timeout);
+  }
+
+
+  bool ReplicationProxy::tryExecuteQuery(bool mustExecuteOnMaster, Shared::Results& results, const SQLString& sql, ErrorInfo& error)
+  {
+    return route()->tryExecuteQuery(mustExecuteOnMaster, results, sql, error);
+  }
+
+
+  bool ReplicationProxy::tryExecuteQuery(bool mustExecuteOnMaster, Shared::Results& results, ClientPrepareResult* clientPrepareResult,
+    std::vector<Shared::ParameterHolder>& parameters, int32_t timeout, ErrorInfo& error)
+  {
+    return route()->tryExecuteQuery(mustExecuteOnMaster, results, clientPrepareResult, parameters, timeout, error);
+  }
+
+
+  bool ReplicationProxy::executeBatchClient(bool mustExecuteOnMaster, Shared::Results& results, ClientPrepareResult* prepareResult,
+    std::vector<std::vector<Shared::ParameterHolder>>& parametersList, bool hasLongData)
+  {
+    return route()->executeBatchClient(mustExecuteOnMaster, results, prepareResult, parametersList, hasLongData);
+  }
+
+
+  void ReplicationProxy::executeBatchStmt(bool mustExecuteOnMaster, Shared::Results& results, const std::vector<SQLString>& queries)
+  {
+    route()->executeBatchStmt(mustExecuteOnMaster, results, queries);
+  }
+
+
+  void ReplicationProxy::executeBatchEncoded(Shared::Results& results, ClientPrepareResult* prepareResult,
+    const EncodedBatch& batch)
+  {
+    route()->executeBatchEncoded(results, prepareResult, batch);
+  }
+
+
+  void ReplicationProxy::executePreparedQuery(bool mustExecuteOnMaster, ServerPrepareResult* serverPrepareResult, Shared::Results& results,
+    std::vector<Shared::ParameterHolder>& parameters)
+  {
+    owner(serverPrepareResult)->executePreparedQuery(mustExecuteOnMaster, serverPrepareResult, results, parameters);
+  }
+
+
+  void ReplicationProxy::executePreparedQuery(bool mustExecuteOnMaster, ServerPrepareResult* serverPrepareResult,
+    Shared::Results& results, const ParameterValue* values)
+  {
+    owner(serverPrepareResult)->executePreparedQuery(mustExecuteOnMaster, serverPrepareResult, results, values);
+  }
+
+
+  bool ReplicationProxy::tryExecutePreparedQuery(bool mustExecuteOnMaster, ServerPrepareResult* serverPrepareResult,
+    Shared::Results& results, std::vector<Shared::ParameterHolder>& parameters, ErrorInfo& error)
+  {
+    return owner(serverPrepareResult)->tryExecutePreparedQuery(mustExecuteOnMaster, serverPrepareResult, results, parameters, error);
+  }
+
+
+  ServerPrepareResult* ReplicationProxy::prepareAndExecute(const SQLString& sql, Shared::Results& results,
+    std::vector<Shared::ParameterHolder>& parameters)
+  {
+    return route()->prepareAndExecute(sql, results, parameters);
+  }
+
+
+  bool ReplicationProxy::executeBatchServer(bool mustExecuteOnMaster, ServerPrepareResult* serverPrepareResult, Shared::Results& results,
+    const SQLString& sql, std::vector<std::vector<Shared::ParameterHolder>>& parameterList, bool hasLongData)
+  {
+    return owner(serverPrepareResult)->executeBatchServer(mustExecuteOnMaster, serverPrepareResult, results, sql, parameterList, hasLongData);
+  }
+
+
+  void ReplicationProxy::executeBatchArrays(ServerPrepareResult* serverPrepareResult, Shared::Results& results,
+    const std::vector<ParameterArray>& arrays, uint32_t rows)
+  {
+    owner(serverPrepareResult)->executeBatchArrays(serverPrepareResult, results, arrays, rows);
+  }
+
+
+  int64_t ReplicationProxy::executeBulkLoad(const SQLString& table, const SQLString* columns, std::size_t columnCount,
+    RowProducer& producer)
+  {
+    return route()->executeBulkLoad(table, columns, columnCount, producer);
+  }
+
+
+  void ReplicationProxy::moveToNextResult(Results* results, ServerPrepareResult* spr)
+  {
+    current->moveToNextResult(results, spr);
+  }
+
+
+  void ReplicationProxy::getResult(Results* results, ServerPrepareResult* spr, bool readAllResults)
+  {
+    current->getResult(results, spr, readAllResults);
+  }
+
+
+  void ReplicationProxy::cancelCurrentQuery()
+  {
+    current->cancelCurrentQuery();
+  }
+
+
+  void ReplicationProxy::interrupt()
+  {
+    current->interrupt();
+  }
+
+
+  void ReplicationProxy::skip()
+  {
+    current->skip();
+  }
+
+
+  bool ReplicationProxy::checkIfMaster()
+  {
+    return current->checkIfMaster();
+  }
+
+
+  bool ReplicationProxy::hasWarnings()
+  {
+    return current->hasWarnings();
+  }
+
+
+  int64_t ReplicationProxy::getMaxRows()
+  {
+    return current->getMaxRows();
+  }
+
+
+  void ReplicationProxy::setMaxRows(int64_t max)
+  {
+    current->setMaxRows(max);
+  }
+
+
+  uint32_t ReplicationProxy::getMajorServerVersion()
+  {
+    return current->getMajorServerVersion();
+  }
+
+
+  uint32_t ReplicationProxy::getMinorServerVersion()
+  {
+    return current->getMinorServerVersion();
+  }
+
+
+  uint32_t ReplicationProxy::getPatchServerVersion()
+  {
+    return current->getPatchServerVersion();
+  }
+
+
+  bool ReplicationProxy::versionGreaterOrEqual(uint32_t major, uint32_t minor, uint32_t patch) const
+  {
+    return current->versionGreaterOrEqual(major, minor, patch);
+  }
+
+
+  void ReplicationProxy::setLocalInfileInputStream(std::istream& inputStream)
+  {
+    if (replica && !replica->isClosed()) {
+      replica->setLocalInfileInputStream(inputStream);
+    }
+    master->setLocalInfileInputStream(inputStream);
+  }
+
+
+  int32_t ReplicationProxy::getTimeout()
+  {
+    return current->getTimeout();
+  }
+
+
+  void ReplicationProxy::setTimeout(int32_t timeout)
+  {
+    current->setTimeout(timeout);
+  }
+
+
+  bool ReplicationProxy::getPinGlobalTxToPhysicalConnection() const
+  {
+    return master->getPinGlobalTxToPhysicalConnection();
+  }
+
+
+  int64_t ReplicationProxy::getServerThreadId()
+  {
+    return current->getServerThreadId();
+  }
+
+
+  void ReplicationProxy::setTransactionIsolation(int32_t level)
+  {
+    current->setTransactionIsolation(level);
+  }
+
+
+  int32_t ReplicationProxy::getTransactionIsolationLevel()
+  {
+    return current->getTransactionIsolationLevel();
+  }
+
+
+  bool ReplicationProxy::isExplicitClosed()
+  {
+    return master->isExplicitClosed();
+  }
+
+
+  void ReplicationProxy::connectWithoutProxy()
+  {
+    master->connectWithoutProxy();
+  }
+
+
+  bool ReplicationProxy::shouldReconnectWithoutProxy()
+  {
+    return current->shouldReconnectWithoutProxy();
+  }
+
+
+  void ReplicationProxy::setHostFailedWithoutProxy()
+  {
+    current->setHostFailedWithoutProxy();
+  }
+
+
+  bool ReplicationProxy::releasePrepareStatement(ServerPrepareResult* serverPrepareResult)
+  {
+    return prepareOwner(serverPrepareResult)->releasePrepareStatement(serverPrepareResult);
+  }
+
+
+  bool ReplicationProxy::forceReleasePrepareStatement(capi::MYSQL_STMT* statementId)
+  {
+    return current->forceReleasePrepareStatement(statementId);
+  }
+
+
+  void ReplicationProxy::forceReleaseWaitingPrepareStatement()
+  {
+    current->forceReleaseWaitingPrepareStatement();
+  }
+
+
+  ServerPrepareStatementCache* ReplicationProxy::prepareStatementCache()
+  {
+    return current->prepareStatementCache();
+  }
+
+
+  void ReplicationProxy::prepareCachedQueries(const std::vector<SQLString>& keys, std::size_t maxCount)
+  {
+    current->prepareCachedQueries(keys, maxCount);
+  }
+
+
+  TimeZone* ReplicationProxy::getTimeZone()
+  {
+    return current->getTimeZone();
+  }
+
+
+  void ReplicationProxy::prolog(int64_t maxRows, bool hasProxy, MariaDbConnection* connection, MariaDbStatement* statement)
+  {
+    route()->prolog(maxRows, hasProxy, connection, statement);
+  }
+
+
+  void ReplicationProxy::prologProxy(ServerPrepareResult* serverPrepareResult, int64_t maxRows, bool hasProxy, MariaDbConnection* connection,
+    MariaDbStatement* statement)
+  {
+    owner(serverPrepareResult)->prologProxy(serverPrepareResult, maxRows, hasProxy, connection, statement);
+  }
+
+
+  Results* ReplicationProxy::getActiveStreamingResult()
+  {
+    return current->getActiveStreamingResult();
+  }
+
+
+  void ReplicationProxy::setActiveStreamingResult(Results* mariaSelectResultSet)
+  {
+    current->setActiveStreamingResult(mariaSelectResultSet);
+  }
+
+
+  Shared::mutex& ReplicationProxy::getLock()
+  {
+    return lock;
+  }
+
+
+  void ReplicationProxy::setServerStatus(uint32_t serverStatus)
+  {
+    current->setServerStatus(serverStatus);
+  }
+
+
+  uint32_t ReplicationProxy::getServerStatus()
+  {
+    return current->getServerStatus();
+  }
+
+
+  void ReplicationProxy::removeHasMoreResults()
+  {
+    current->removeHasMoreResults();
+  }
+
+
+  void ReplicationProxy::setHasWarnings(bool hasWarnings)
+  {
+    current->setHasWarnings(hasWarnings);
+  }
+
+
+  bool ReplicationProxy::addPrepareInCache(const SQLString& key, ServerPrepareResult* serverPrepareResult)
+  {
+    return prepareOwner(serverPrepareResult)->addPrepareInCache(key, serverPrepareResult);
+  }
+
+
+  void ReplicationProxy::readEofPacket()
+  {
+    current->readEofPacket();
+  }
+
+
+  void ReplicationProxy::skipEofPacket()
+  {
+    current->skipEofPacket();
+  }
+
+
+  void ReplicationProxy::changeSocketTcpNoDelay(bool setTcpNoDelay)
+  {
+    current->changeSocketTcpNoDelay(setTcpNoDelay);
+  }
+
+
+  void ReplicationProxy::changeSocketSoTimeout(int32_t setSoTimeout)
+  {
+    current->changeSocketSoTimeout(setSoTimeout);
+  }
+
+
+  void ReplicationProxy::removeActiveStreamingResult()
+  {
+    current->removeActiveStreamingResult();
+  }
+
+
+  void ReplicationProxy::resetStateAfterFailover(int64_t maxRows, int32_t transactionIsolationLevel, const SQLString& database, bool autocommit)
+  {
+    current->resetStateAfterFailover(maxRows, transactionIsolationLevel, database, autocommit);
+  }
+
+
+  bool ReplicationProxy::isServerMariaDb()
+  {
+    return current->isServerMariaDb();
+  }
+
+
+  void ReplicationProxy::setActiveFutureTask(FutureTask* activeFutureTask)
+  {
+    current->setActiveFutureTask(activeFutureTask);
+  }
+
+
+  MariaDBExceptionThrower ReplicationProxy::handleIoException(std::runtime_error& initialException, bool throwRightAway)
+  {
+    return current->handleIoException(initialException, throwRightAway);
+  }
+
+
+  bool ReplicationProxy::failover()
+  {
+    return current->failover();
+  }
+
+  /* Counters of the master and replica connections are kept separately, i.e. this is the current one's part */
+  MetricsRecorder& ReplicationProxy::getMetrics()
+  {
+    return current->getMetrics();
+  }
+
+
+  void ReplicationProxy::trimMemory()
+  {
+    master->trimMemory();
+    if (replica) {
+      replica->trimMemory();
+    }
+  }
+
+
+  std::size_t ReplicationProxy::getMemoryFootprint()
+  {
+    return sizeof(*this) + master->getMemoryFootprint() + (replica ? replica->getMemoryFootprint() : 0);
+  }
+
+
+  std::size_t ReplicationProxy::getBatchWindow()
+  {
+    return current->getBatchWindow();
+  }
+
+
+  const SQLString& ReplicationProxy::getLastGtid() const
+  {
+    return master->getLastGtid();
+  }
+
+
+  bool ReplicationProxy::waitForGtid(const SQLString& gtid, int32_t timeout)
+  {
+    return current->waitForGtid(gtid, timeout);
+  }
+
+  /* Master and replica connections have own accounts, each with the maxResultSetMemory limit */
+  const std::shared_ptr<MemoryAccount>& ReplicationProxy::getMemoryAccount()
+  {
+    return current->getMemoryAccount();
+  }
+
+
+  bool ReplicationProxy::isEofDeprecated()
+  {
+    return current->isEofDeprecated();
+  }
+
+
+  int32_t ReplicationProxy::getAutoIncrementIncrement()
+  {
+    return current->getAutoIncrementIncrement();
+  }
+
+
+  bool ReplicationProxy::sessionStateAware()
+  {
+    return current->sessionStateAware();
+  }
+
+
+  bool ReplicationProxy::transactionIsolationTracked()
+  {
+    return current->transactionIsolationTracked();
+  }
+
+
+  SQLString ReplicationProxy::getTraces()
+  {
+    return current->getTraces();
+  }
+
+
+  bool ReplicationProxy::isInterrupted()
+  {
+    return current->isInterrupted();
+  }
+
+
+  void ReplicationProxy::stopIfInterrupted()
+  {
+    current->stopIfInterrupted();
+  }
+
+
+  void ReplicationProxy::reconnect()
+  {
+    current->reconnect();
+  }
+
+
+  void ReplicationProxy::skipAllResults()
+  {
+    current->skipAllResults();
+  }
+
+
+  void ReplicationProxy::skipAllResults(ServerPrepareResult* spr)
+  {
+    current->skipAllResults(spr);
+  }
+}
+}
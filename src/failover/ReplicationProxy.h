@@ -0,0 +1,209 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _REPLICATIONPROXY_H_
+#define _REPLICATIONPROXY_H_
+
+#include "Protocol.h"
+#include "Consts.h"
+
+namespace sql
+{
+namespace mariadb
+{
+class GlobalStateInfo;
+
+/* Protocol for the replication HA mode. It holds the connection to the master, and the connection to a replica, that
+   is established on first need. While the connection is read-only, new commands go to the replica, otherwise to the
+   master. Switching happens only between transactions, and when there is no pending result. The session state -
+   database, autocommit and isolation level, is carried over on switch.
+   Commands of server side prepared statements go to the connection, the statement has been prepared on. Everything
+   else, like reading of results, goes to the connection, that has executed the last command */
+class ReplicationProxy : public Protocol
+{
+  static Shared::Logger logger;
+
+  Shared::mutex lock;
+  std::shared_ptr<UrlParser> urlParser;
+  std::shared_ptr<UrlParser> replicaUrlParser;
+  Shared::Protocol master;
+  Shared::Protocol replica;
+  Protocol* current;
+  bool readOnly;
+  // Set if connecting to replicas has failed, to not try that on each command. Reset on next setReadonly(true)
+  bool replicaFailed;
+  // With readYourWrites, the master's GTID the replica is known to have applied, and the one it has been waited for
+  SQLString replicaGtid;
+  SQLString awaitedGtid;
+
+  Protocol* connectedReplica();
+  void switchTo(Protocol* target);
+  bool replicaCaughtUp(Protocol* target);
+  /* Picks the connection for a new command */
+  Protocol* route();
+  /* Picks the connection, statement has been prepared on, as the connection for new command */
+  Protocol* owner(ServerPrepareResult* serverPrepareResult);
+  Protocol* prepareOwner(ServerPrepareResult* serverPrepareResult);
+
+public:
+  ReplicationProxy(std::shared_ptr<UrlParser>& urlParser, GlobalStateInfo* globalInfo);
+
+  ServerPrepareResult* prepare(const SQLString& sql, bool executeOnMaster);
+  bool getAutocommit();
+  void setAutocommit(bool autocommit);
+  bool noBackslashEscapes();
+  void connect();
+  const UrlParser& getUrlParser() const;
+  bool inTransaction();
+  FailoverProxy* getProxy();
+  void setProxy(FailoverProxy* proxy);
+  const Shared::Options& getOptions() const;
+  bool hasMoreResults();
+  void close();
+  void reset();
+  void changeUser(const SQLString& user, const SQLString& password, const SQLString& database);
+  void closeExplicit();
+  void deferTransactionEnd(bool commit);
+  void flushTransactionEnd();
+  void deferSavepoint(const SQLString& name, bool release);
+  bool rollbackDeferredSavepoint(const SQLString& name);
+  bool isClosed();
+  void resetDatabase();
+  void resetSessionState(bool autocommit, int32_t transactionIsolationLevel, bool resetDatabase);
+  SQLString getCatalog();
+  void setCatalog(const SQLString& database);
+  const SQLString& getServerVersion() const;
+  bool isConnected();
+  bool getReadonly() const;
+  void setReadonly(bool readOnly);
+  bool isMasterConnection();
+  bool mustBeMasterConnection();
+  const HostAddress& getHostAddress() const;
+  void setHostAddress(const HostAddress& hostAddress);
+  const SQLString& getHost() const;
+  int32_t getPort() const;
+  void rollback();
+  const SQLString& getDatabase() const;
+  const SQLString& getUsername() const;
+  bool ping();
+  bool isValid(int32_t timeout);
+  void executeQuery(const SQLString& sql);
+  void executeQuery(bool mustExecuteOnMaster, Shared::Results& results, const SQLString& sql);
+  void executeQuery(bool mustExecuteOnMaster, Shared::Results& results, const SQLString& sql, const Charset* charset);
+  void executeQuery(bool mustExecuteOnMaster, Shared::Results& results, ClientPrepareResult* clientPrepareResult, std::vector<Shared::ParameterHolder>& parameters);
+  void executeQuery(bool mustExecuteOnMaster, Shared::Results& results, ClientPrepareResult* clientPrepareResult, std::vector<Shared::ParameterHolder>& parameters,
+    int32_t timeout);
+  bool tryExecuteQuery(bool mustExecuteOnMaster, Shared::Results& results, const SQLString& sql, ErrorInfo& error);
+  bool tryExecuteQuery(bool mustExecuteOnMaster, Shared::Results& results, ClientPrepareResult* clientPrepareResult,
+    std::vector<Shared::ParameterHolder>& parameters, int32_t timeout, ErrorInfo& error);
+  void executePipeline(std::vector<Shared::Results>& results, const std::vector<SQLString>& queries);
+  int32_t executeQueryAsyncStart(const SQLString& sql);
+  int32_t executeQueryAsyncContinue(int32_t readyEvents);
+  int64_t getNativeSocket();
+  uint32_t getAsyncTimeout();
+  bool executeBatchClient(bool mustExecuteOnMaster, Shared::Results& results, ClientPrepareResult* prepareResult,
+    std::vector<std::vector<Shared::ParameterHolder>>& parametersList, bool hasLongData);
+  void executeBatchStmt(bool mustExecuteOnMaster,Shared::Results& results, const std::vector<SQLString>& queries);
+  void executeBatchEncoded(Shared::Results& results, ClientPrepareResult* prepareResult, const EncodedBatch& batch);
+  void executePreparedQuery(bool mustExecuteOnMaster, ServerPrepareResult* serverPrepareResult, Shared::Results& results, std::vector<Shared::ParameterHolder>& parameters);
+  void executePreparedQuery(bool mustExecuteOnMaster, ServerPrepareResult* serverPrepareResult, Shared::Results& results, const ParameterValue* values);
+  bool tryExecutePreparedQuery(bool mustExecuteOnMaster, ServerPrepareResult* serverPrepareResult, Shared::Results& results,
+    std::vector<Shared::ParameterHolder>& parameters, ErrorInfo& error);
+  ServerPrepareResult* prepareAndExecute(const SQLString& sql, Shared::Results& results, std::vector<Shared::ParameterHolder>& parameters);
+  bool executeBatchServer(bool mustExecuteOnMaster, ServerPrepareResult* serverPrepareResult, Shared::Results& results, const SQLString& sql,
+                          std::vector<std::vector<Shared::ParameterHolder>>& parameterList, bool hasLongData);
+  void executeBatchArrays(ServerPrepareResult* serverPrepareResult, Shared::Results& results,
+                          const std::vector<ParameterArray>& arrays, uint32_t rows);
+  int64_t executeBulkLoad(const SQLString& table, const SQLString* columns, std::size_t columnCount, RowProducer& producer);
+  void moveToNextResult(Results* results, ServerPrepareResult* spr=nullptr);
+  void getResult(Results* results, ServerPrepareResult *pr=nullptr, bool readAllResults=false);
+  void cancelCurrentQuery();
+  void interrupt();
+  void skip();
+  bool checkIfMaster();
+  bool hasWarnings();
+  int64_t getMaxRows();
+  void setMaxRows(int64_t max);
+  uint32_t getMajorServerVersion();
+  uint32_t getMinorServerVersion();
+  uint32_t getPatchServerVersion();
+  bool versionGreaterOrEqual(uint32_t major, uint32_t minor, uint32_t patch) const;
+  void setLocalInfileInputStream(std::istream& inputStream);
+  int32_t getTimeout();
+  void setTimeout(int32_t timeout);
+  bool getPinGlobalTxToPhysicalConnection() const;
+  int64_t getServerThreadId();
+  //Socket* getSocket();
+  void setTransactionIsolation(int32_t level);
+  int32_t getTransactionIsolationLevel();
+  bool isExplicitClosed();
+  void connectWithoutProxy();
+  bool shouldReconnectWithoutProxy();
+  void setHostFailedWithoutProxy();
+  bool releasePrepareStatement(ServerPrepareResult* serverPrepareResult);
+  bool forceReleasePrepareStatement(capi::MYSQL_STMT* statementId);
+  void forceReleaseWaitingPrepareStatement();
+  ServerPrepareStatementCache* prepareStatementCache();
+  void prepareCachedQueries(const std::vector<SQLString>& keys, std::size_t maxCount);
+  TimeZone* getTimeZone();
+  void prolog(int64_t maxRows, bool hasProxy, MariaDbConnection* connection, MariaDbStatement* statement);
+  void prologProxy( ServerPrepareResult* serverPrepareResult, int64_t maxRows, bool hasProxy, MariaDbConnection* connection, MariaDbStatement* statement);
+  Results* getActiveStreamingResult();
+  void setActiveStreamingResult(Results* mariaSelectResultSet);
+  Shared::mutex& getLock();
+  void setServerStatus(uint32_t serverStatus);
+  uint32_t getServerStatus();
+  void removeHasMoreResults();
+  void setHasWarnings(bool hasWarnings);
+  bool addPrepareInCache(const SQLString& key, ServerPrepareResult* serverPrepareResult);
+  void readEofPacket();
+  void skipEofPacket();
+  void changeSocketTcpNoDelay(bool setTcpNoDelay);
+  void changeSocketSoTimeout(int32_t setSoTimeout);
+  void removeActiveStreamingResult();
+  void resetStateAfterFailover(int64_t maxRows,int32_t transactionIsolationLevel, const SQLString& database, bool autocommit);
+  bool isServerMariaDb();
+  void setActiveFutureTask(FutureTask* activeFutureTask);
+  MariaDBExceptionThrower handleIoException(std::runtime_error& initialException, bool throwRightAway= true);
+  bool failover();
+  MetricsRecorder& getMetrics();
+  void trimMemory();
+  std::size_t getMemoryFootprint();
+  std::size_t getBatchWindow();
+  const SQLString& getLastGtid() const;
+  bool waitForGtid(const SQLString& gtid, int32_t timeout);
+  const std::shared_ptr<MemoryAccount>& getMemoryAccount();
+  //PacketInputistream* getReader();
+  //PacketOutputStream* getWriter();
+  bool isEofDeprecated();
+  int32_t getAutoIncrementIncrement();
+  bool sessionStateAware();
+  bool transactionIsolationTracked();
+  SQLString getTraces();
+  bool isInterrupted();
+  void stopIfInterrupted();
+  void reconnect();
+  void skipAllResults() override;
+  void skipAllResults(ServerPrepareResult* spr) override;
+};
+
+}
+}
+#endif
@@ -0,0 +1,182 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+
+#include "AsyncLogWriter.h"
+
+namespace sql
+{
+namespace mariadb
+{
+  static const char* operationName[]= {"query", "prepare", "execute", "batch"};
+
+  AsyncLogWriter::AsyncLogWriter() :
+    ring(new Record[CAPACITY]),
+    enqueuePos(0),
+    dropped(0),
+    sleeping(false)
+  {
+    for (std::size_t i= 0; i < CAPACITY; ++i) {
+      ring[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    worker= std::thread(&AsyncLogWriter::run, this);
+  }
+
+
+  AsyncLogWriter::~AsyncLogWriter()
+  {
+    {
+      std::lock_guard<std::mutex> localScopeLock(lock);
+      stopping= true;
+    }
+    wakeup.notify_all();
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+
+
+  AsyncLogWriter& AsyncLogWriter::getInstance()
+  {
+    static AsyncLogWriter theInstance;
+    return theInstance;
+  }
+
+
+  std::ostream* AsyncLogWriter::getStream(const std::string& fileName)
+  {
+    if (fileName.empty()) {
+      return &std::cerr;
+    }
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    auto it= files.find(fileName);
+
+    if (it == files.end()) {
+      std::unique_ptr<std::ostream> file(new std::ofstream(fileName, std::ios::out | std::ios::app));
+      if (!*file) {
+        return &std::cerr;
+      }
+      it= files.emplace(fileName, std::move(file)).first;
+    }
+    return it->second.get();
+  }
+
+
+  void AsyncLogWriter::write(const Record& record)
+  {
+    std::ostream& out= *record.out;
+    std::time_t seconds= static_cast<std::time_t>(record.timestamp / 1000000000);
+    char dateTime[32], batchSize[32]= "", header[160];
+
+    /* Only this thread formats time, so the static buffer of gmtime is safe to use. snprintf is used not to change
+       the format flags of the application's streams */
+    std::strftime(dateTime, sizeof(dateTime), "%Y-%m-%d %H:%M:%S", std::gmtime(&seconds));
+    if (record.operation == BATCH) {
+      std::snprintf(batchSize, sizeof(batchSize), "(%llu)", static_cast<unsigned long long>(record.batchSize));
+    }
+    int length= std::snprintf(header, sizeof(header), "%s.%03d conn:%lld %s%s %.3fms%s - ", dateTime,
+      static_cast<int>((record.timestamp / 1000000) % 1000), static_cast<long long>(record.threadId),
+      operationName[record.operation], batchSize, static_cast<double>(record.duration) / 1000000, record.failed ? " failed" : "");
+
+    out.write(header, std::min(static_cast<std::size_t>(std::max(length, 0)), sizeof(header) - 1));
+    out.write(record.sql.data(), record.sql.length());
+    if (!record.parameters.empty()) {
+      out << " - parameters:[" << record.parameters << ']';
+    }
+    out << '\n';
+  }
+
+
+  /* Returns true, if any record has been written */
+  bool AsyncLogWriter::drain()
+  {
+    bool wrote= false;
+
+    for (;;) {
+      Record& record= ring[dequeuePos & (CAPACITY - 1)];
+      if (record.sequence.load(std::memory_order_acquire) != dequeuePos + 1) {
+        break;
+      }
+      write(record);
+      record.sequence.store(dequeuePos + CAPACITY, std::memory_order_release);
+      ++dequeuePos;
+      wrote= true;
+    }
+
+    uint64_t droppedNow= dropped.load(std::memory_order_relaxed);
+    if (droppedNow != reportedDropped) {
+      std::cerr << "Query log: " << droppedNow - reportedDropped << " records dropped, the log is written slower than "
+        "queries are executed\n";
+      reportedDropped= droppedNow;
+      wrote= true;
+    }
+    return wrote;
+  }
+
+
+  void AsyncLogWriter::run()
+  {
+    std::unique_lock<std::mutex> localScopeLock(lock);
+
+    for (;;) {
+      localScopeLock.unlock();
+      bool wrote= drain();
+      localScopeLock.lock();
+      writtenPos= dequeuePos;
+
+      if (wrote) {
+        for (auto& it : files) {
+          it.second->flush();
+        }
+        std::cerr.flush();
+        written.notify_all();
+        continue;
+      }
+      written.notify_all();
+      if (stopping) {
+        break;
+      }
+      sleeping.store(true, std::memory_order_seq_cst);
+      /* Producer might have published the record before it could see the flag */
+      if (ring[dequeuePos & (CAPACITY - 1)].sequence.load(std::memory_order_seq_cst) != dequeuePos + 1) {
+        wakeup.wait_for(localScopeLock, std::chrono::milliseconds(100));
+      }
+      sleeping.store(false, std::memory_order_relaxed);
+    }
+  }
+
+
+  void AsyncLogWriter::flush()
+  {
+    std::size_t target= enqueuePos.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> localScopeLock(lock);
+
+    wakeup.notify_one();
+    written.wait(localScopeLock, [this, target]() { return writtenPos >= target || stopping; });
+  }
+
+}
+}
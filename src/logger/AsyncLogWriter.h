@@ -0,0 +1,147 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _ASYNCLOGWRITER_H_
+#define _ASYNCLOGWRITER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+namespace sql
+{
+namespace mariadb
+{
+
+/* Process wide writer of the query log(profileSql and slowQueryThresholdNanos). Connection threads put binary
+   records into the bounded lock-free ring, and the writer's thread formats and writes them. Query thread never waits
+   for the output - if the ring is full, the record is dropped and counted, and the number of dropped records is
+   written to the log later */
+class AsyncLogWriter final
+{
+public:
+  enum Operation {
+    QUERY= 0,
+    PREPARE,
+    EXECUTE,
+    BATCH
+  };
+
+  /* Slots of the ring are reused, and so are the strings' buffers */
+  struct Record
+  {
+    std::atomic<std::size_t> sequence;
+    std::ostream* out;
+    int64_t timestamp;
+    int64_t duration;
+    int64_t threadId;
+    Operation operation;
+    /* Number of queries or parameter sets in the batch */
+    std::size_t batchSize;
+    bool failed;
+    std::string sql;
+    std::string parameters;
+  };
+
+private:
+  static constexpr std::size_t CAPACITY= 4096;
+
+  std::unique_ptr<Record[]> ring;
+  std::atomic<std::size_t> enqueuePos;
+  /* Only the writer's thread uses it */
+  std::size_t dequeuePos= 0;
+  std::atomic<uint64_t> dropped;
+  uint64_t reportedDropped= 0;
+  std::atomic<bool> sleeping;
+
+  std::mutex lock;
+  std::condition_variable wakeup;
+  std::condition_variable written;
+  /* dequeuePos as of the last drain, guarded by the lock */
+  std::size_t writtenPos= 0;
+  std::thread worker;
+  bool stopping= false;
+  /* Streams are never closed before the writer is destroyed, so the records may safely point to them */
+  std::map<std::string, std::unique_ptr<std::ostream>> files;
+
+  AsyncLogWriter();
+  ~AsyncLogWriter();
+  bool drain();
+  void write(const Record& record);
+  void run();
+
+public:
+  static AsyncLogWriter& getInstance();
+
+  /* Returns the stream for the log file, or std::cerr if the fileName is empty or the file cannot be opened */
+  std::ostream* getStream(const std::string& fileName);
+  /* Fills and publishes a record. Returns false, if the ring was full, and the record was dropped.
+     Filler is called as fill(record) and has to set everything but the sequence */
+  template <class Filler> bool push(Filler fill);
+  uint64_t getDropped() const { return dropped.load(std::memory_order_relaxed); }
+  /* Blocks until all records published before the call are written. For tests mostly */
+  void flush();
+};
+
+
+template <class Filler> bool AsyncLogWriter::push(Filler fill)
+{
+  std::size_t pos= enqueuePos.load(std::memory_order_relaxed);
+  Record* record;
+
+  for (;;) {
+    record= &ring[pos & (CAPACITY - 1)];
+    std::size_t seq= record->sequence.load(std::memory_order_acquire);
+    intptr_t diff= static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+    if (diff == 0) {
+      if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    }
+    else if (diff < 0) {
+      dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    else {
+      pos= enqueuePos.load(std::memory_order_relaxed);
+    }
+  }
+  fill(*record);
+  record->sequence.store(pos + 1, std::memory_order_release);
+
+  /* Pairs with the writer setting the flag and re-checking the ring before going to sleep */
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (sleeping.load(std::memory_order_relaxed)) {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    wakeup.notify_one();
+  }
+  return true;
+}
+
+}
+}
+#endif
@@ -19,8 +19,17 @@
 
 
 
+#include <chrono>
+#include <exception>
+
 #include "ProtocolLoggingProxy.h"
 #include "logger/LoggerFactory.h"
+#include "logger/AsyncLogWriter.h"
+#include "parameters/ParameterHolder.h"
+#include "util/ClientPrepareResult.h"
+#include "util/EncodedBatch.h"
+#include "util/ServerPrepareResult.h"
+#include "options/Options.h"
 
 namespace sql
 {
@@ -28,8 +37,109 @@ namespace mariadb
 {
   Shared::Logger ProtocolLoggingProxy::logger= LoggerFactory::getLogger(typeid(ProtocolLoggingProxy));
 
+  static const SQLString emptyQuery;
+
+  class ProtocolLoggingProxy::LoggedOperation
+  {
+    ProtocolLoggingProxy* proxy;
+    AsyncLogWriter::Operation operation;
+    const SQLString& sql;
+    const std::vector<Shared::ParameterHolder>* parameters;
+    std::size_t batchSize;
+    std::chrono::steady_clock::time_point start;
+    /* The error, that has been returned instead of thrown */
+    bool returnedError= false;
+
+    void fill(AsyncLogWriter::Record& record, int64_t duration, bool failed);
+
+  public:
+    LoggedOperation(ProtocolLoggingProxy* _proxy, AsyncLogWriter::Operation _operation, const SQLString& _sql,
+      const std::vector<Shared::ParameterHolder>* _parameters= nullptr, std::size_t _batchSize= 1) :
+      proxy(_proxy), operation(_operation), sql(_sql), parameters(_parameters), batchSize(_batchSize),
+      start(std::chrono::steady_clock::now())
+    {}
+    ~LoggedOperation();
+    void fail() { returnedError= true; }
+  };
+
+
+  ProtocolLoggingProxy::LoggedOperation::~LoggedOperation()
+  {
+    int64_t duration= std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    /* With slowQueryThresholdNanos only, that is all fast query pays for */
+    if (!proxy->profileSql && duration < proxy->slowQueryThresholdNanos) {
+      return;
+    }
+    bool failed= returnedError || std::uncaught_exception();
+    try {
+      AsyncLogWriter::getInstance().push([this, duration, failed](AsyncLogWriter::Record& record) {
+        fill(record, duration, failed);
+      });
+    }
+    catch (...) {
+      /* Logging must not change the operation's outcome */
+    }
+  }
+
+
+  /* Copies the query and parameters right into the record's buffers, truncated to maxQuerySizeToLog like
+     LogQueryTool does */
+  void ProtocolLoggingProxy::LoggedOperation::fill(AsyncLogWriter::Record& record, int64_t duration, bool failed)
+  {
+    std::size_t maxSize= proxy->maxQuerySizeToLog > 3 ? static_cast<std::size_t>(proxy->maxQuerySizeToLog - 3) : 0;
+
+    record.out= proxy->logStream;
+    record.timestamp= std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+    record.duration= duration;
+    record.threadId= proxy->protocol->getServerThreadId();
+    record.operation= operation;
+    record.batchSize= batchSize;
+    record.failed= failed;
+
+    if (maxSize > 0 && sql.length() > maxSize) {
+      record.sql.assign(sql.c_str(), maxSize);
+      record.sql.append("...");
+    }
+    else {
+      record.sql.assign(sql.c_str(), sql.length());
+    }
+
+    record.parameters.clear();
+    if (parameters != nullptr) {
+      for (auto& parameter : *parameters) {
+        if (!record.parameters.empty()) {
+          record.parameters.append(",");
+        }
+        if (!parameter) {
+          record.parameters.append("<not set>");
+          continue;
+        }
+        record.parameters.append(StringImp::get(parameter->toString()));
+        if (maxSize > 0 && record.parameters.length() > maxSize) {
+          record.parameters.resize(maxSize);
+          record.parameters.append("...");
+          break;
+        }
+      }
+    }
+  }
+
+
+  ProtocolLoggingProxy::ProtocolLoggingProxy(Shared::Protocol &realProtocol, const Shared::Options& options) :
+    protocol(realProtocol),
+    profileSql(options->profileSql),
+    slowQueryThresholdNanos(options->slowQueryThresholdNanos),
+    maxQuerySizeToLog(options->maxQuerySizeToLog),
+    logQuery(nullptr),
+    logStream(AsyncLogWriter::getInstance().getStream(StringImp::get(options->queryLogFile)))
+  {}
+
+
   ServerPrepareResult* ProtocolLoggingProxy::prepare(const SQLString& sql, bool executeOnMaster)
   {
+    LoggedOperation logged(this, AsyncLogWriter::PREPARE, sql);
     return protocol->prepare(sql, executeOnMaster);
   }
 
@@ -41,6 +151,13 @@ namespace mariadb
 	}
 
 
+  void ProtocolLoggingProxy::setAutocommit(bool autocommit)
+	{
+		/* Add here logging if needed */
+	  protocol->setAutocommit(autocommit);
+	}
+
+
   bool ProtocolLoggingProxy::noBackslashEscapes()
 	{
 		/* Add here logging if needed */
@@ -111,6 +228,13 @@ namespace mariadb
 	}
 
 
+  void ProtocolLoggingProxy::changeUser(const SQLString& user, const SQLString& password, const SQLString& database)
+	{
+		/* Add here logging if needed */
+	  protocol->changeUser(user, password, database);
+	}
+
+
   void ProtocolLoggingProxy::closeExplicit()
 	{
 		/* Add here logging if needed */
@@ -118,6 +242,34 @@ namespace mariadb
 	}
 
 
+  void ProtocolLoggingProxy::deferTransactionEnd(bool commit)
+	{
+		/* Add here logging if needed */
+	  protocol->deferTransactionEnd(commit);
+	}
+
+
+  void ProtocolLoggingProxy::flushTransactionEnd()
+	{
+		/* Add here logging if needed */
+	  protocol->flushTransactionEnd();
+	}
+
+
+  void ProtocolLoggingProxy::deferSavepoint(const SQLString& name, bool release)
+	{
+		/* Add here logging if needed */
+	  protocol->deferSavepoint(name, release);
+	}
+
+
+  bool ProtocolLoggingProxy::rollbackDeferredSavepoint(const SQLString& name)
+	{
+		/* Add here logging if needed */
+	  return protocol->rollbackDeferredSavepoint(name);
+	}
+
+
   bool ProtocolLoggingProxy::isClosed()
 	{
 		/* Add here logging if needed */
@@ -132,6 +284,13 @@ namespace mariadb
 	}
 
 
+  void ProtocolLoggingProxy::resetSessionState(bool autocommit, int32_t transactionIsolationLevel, bool resetDatabase)
+	{
+		/* Add here logging if needed */
+	  protocol->resetSessionState(autocommit, transactionIsolationLevel, resetDatabase);
+	}
+
+
   SQLString ProtocolLoggingProxy::getCatalog()
 	{
 		/* Add here logging if needed */
@@ -251,21 +410,54 @@ namespace mariadb
 
   void ProtocolLoggingProxy::executeQuery(const SQLString& sql)
 	{
-		/* Add here logging if needed */
+	  LoggedOperation logged(this, AsyncLogWriter::QUERY, sql);
 	  protocol->executeQuery(sql);
 	}
 
 
   void ProtocolLoggingProxy::executeQuery(bool mustExecuteOnMaster, Shared::Results& results, const SQLString& sql)
   {
-    /* Add here logging if needed */
+    LoggedOperation logged(this, AsyncLogWriter::QUERY, sql);
     protocol->executeQuery(mustExecuteOnMaster, results, sql);
   }
 
 
-  void ProtocolLoggingProxy::executeQuery(bool mustExecuteOnMaster, Shared::Results& results, const SQLString& sql, const Charset* charset)
+  void ProtocolLoggingProxy::executePipeline(std::vector<Shared::Results>& results, const std::vector<SQLString>& queries)
+  {
+    LoggedOperation logged(this, AsyncLogWriter::BATCH, queries.empty() ? emptyQuery : queries.front(), nullptr, queries.size());
+    protocol->executePipeline(results, queries);
+  }
+
+
+  int32_t ProtocolLoggingProxy::executeQueryAsyncStart(const SQLString& sql)
   {
     /* Add here logging if needed */
+    return protocol->executeQueryAsyncStart(sql);
+  }
+
+
+  int32_t ProtocolLoggingProxy::executeQueryAsyncContinue(int32_t readyEvents)
+  {
+    /* Add here logging if needed */
+    return protocol->executeQueryAsyncContinue(readyEvents);
+  }
+
+
+  int64_t ProtocolLoggingProxy::getNativeSocket()
+  {
+    return protocol->getNativeSocket();
+  }
+
+
+  uint32_t ProtocolLoggingProxy::getAsyncTimeout()
+  {
+    return protocol->getAsyncTimeout();
+  }
+
+
+  void ProtocolLoggingProxy::executeQuery(bool mustExecuteOnMaster, Shared::Results& results, const SQLString& sql, const Charset* charset)
+  {
+    LoggedOperation logged(this, AsyncLogWriter::QUERY, sql);
     protocol->executeQuery(mustExecuteOnMaster, results, sql, charset);
   }
 
@@ -273,7 +465,7 @@ namespace mariadb
   void ProtocolLoggingProxy::executeQuery(bool mustExecuteOnMaster, Shared::Results& results, ClientPrepareResult* clientPrepareResult,
     std::vector<Shared::ParameterHolder>& parameters)
   {
-    /* Add here logging if needed */
+    LoggedOperation logged(this, AsyncLogWriter::QUERY, clientPrepareResult->getSql(), &parameters);
     protocol->executeQuery(mustExecuteOnMaster, results, clientPrepareResult, parameters);
   }
 
@@ -281,42 +473,118 @@ namespace mariadb
   void ProtocolLoggingProxy::executeQuery(bool mustExecuteOnMaster, Shared::Results& results, ClientPrepareResult* clientPrepareResult,
     std::vector<Shared::ParameterHolder>& parameters, int32_t timeout)
   {
-    /* Add here logging if needed */
+    LoggedOperation logged(this, AsyncLogWriter::QUERY, clientPrepareResult->getSql(), &parameters);
     protocol->executeQuery(mustExecuteOnMaster, results, clientPrepareResult, parameters, timeout);
   }
 
 
+  bool ProtocolLoggingProxy::tryExecuteQuery(bool mustExecuteOnMaster, Shared::Results& results, const SQLString& sql,
+    ErrorInfo& error)
+  {
+    LoggedOperation logged(this, AsyncLogWriter::QUERY, sql);
+    if (!protocol->tryExecuteQuery(mustExecuteOnMaster, results, sql, error)) {
+      logged.fail();
+      return false;
+    }
+    return true;
+  }
+
+
+  bool ProtocolLoggingProxy::tryExecuteQuery(bool mustExecuteOnMaster, Shared::Results& results,
+    ClientPrepareResult* clientPrepareResult, std::vector<Shared::ParameterHolder>& parameters, int32_t timeout, ErrorInfo& error)
+  {
+    LoggedOperation logged(this, AsyncLogWriter::QUERY, clientPrepareResult->getSql(), &parameters);
+    if (!protocol->tryExecuteQuery(mustExecuteOnMaster, results, clientPrepareResult, parameters, timeout, error)) {
+      logged.fail();
+      return false;
+    }
+    return true;
+  }
+
+
   bool ProtocolLoggingProxy::executeBatchClient(bool mustExecuteOnMaster, Shared::Results& results, ClientPrepareResult* prepareResult,
     std::vector<std::vector<Shared::ParameterHolder>>& parametersList, bool hasLongData)
 	{
-		/* Add here logging if needed */
+    LoggedOperation logged(this, AsyncLogWriter::BATCH, prepareResult->getSql(), nullptr, parametersList.size());
     return protocol->executeBatchClient(mustExecuteOnMaster, results, prepareResult, parametersList, hasLongData);
 	}
 
 
   void ProtocolLoggingProxy::executeBatchStmt(bool mustExecuteOnMaster, Shared::Results& results, const std::vector<SQLString>& queries)
   {
-    /* Add here logging if needed */
+    LoggedOperation logged(this, AsyncLogWriter::BATCH, queries.empty() ? emptyQuery : queries.front(), nullptr, queries.size());
     protocol->executeBatchStmt(mustExecuteOnMaster, results, queries);
   }
 
 
+  void ProtocolLoggingProxy::executeBatchEncoded(Shared::Results& results, ClientPrepareResult* prepareResult,
+    const EncodedBatch& batch)
+  {
+    LoggedOperation logged(this, AsyncLogWriter::BATCH, prepareResult->getSql(), nullptr, batch.size());
+    protocol->executeBatchEncoded(results, prepareResult, batch);
+  }
+
+
   void ProtocolLoggingProxy::executePreparedQuery(bool mustExecuteOnMaster, ServerPrepareResult* serverPrepareResult, Shared::Results& results,
     std::vector<Shared::ParameterHolder>& parameters)
   {
-    /* Add here logging if needed */
+    LoggedOperation logged(this, AsyncLogWriter::EXECUTE, serverPrepareResult->getSql(), &parameters);
     protocol->executePreparedQuery(mustExecuteOnMaster, serverPrepareResult, results, parameters);
   }
 
 
+  void ProtocolLoggingProxy::executePreparedQuery(bool mustExecuteOnMaster, ServerPrepareResult* serverPrepareResult,
+    Shared::Results& results, const ParameterValue* values)
+  {
+    LoggedOperation logged(this, AsyncLogWriter::EXECUTE, serverPrepareResult->getSql());
+    protocol->executePreparedQuery(mustExecuteOnMaster, serverPrepareResult, results, values);
+  }
+
+
+  bool ProtocolLoggingProxy::tryExecutePreparedQuery(bool mustExecuteOnMaster, ServerPrepareResult* serverPrepareResult,
+    Shared::Results& results, std::vector<Shared::ParameterHolder>& parameters, ErrorInfo& error)
+  {
+    LoggedOperation logged(this, AsyncLogWriter::EXECUTE, serverPrepareResult->getSql(), &parameters);
+    if (!protocol->tryExecutePreparedQuery(mustExecuteOnMaster, serverPrepareResult, results, parameters, error)) {
+      logged.fail();
+      return false;
+    }
+    return true;
+  }
+
+
+  ServerPrepareResult* ProtocolLoggingProxy::prepareAndExecute(const SQLString& sql, Shared::Results& results,
+    std::vector<Shared::ParameterHolder>& parameters)
+  {
+    LoggedOperation logged(this, AsyncLogWriter::EXECUTE, sql, &parameters);
+    return protocol->prepareAndExecute(sql, results, parameters);
+  }
+
+
   bool ProtocolLoggingProxy::executeBatchServer(bool mustExecuteOnMaster, ServerPrepareResult* serverPrepareResult, Shared::Results& results,
     const SQLString& sql, std::vector<std::vector<Shared::ParameterHolder>>& parameterList, bool hasLongData)
   {
-    /* Add here logging if needed */
+    LoggedOperation logged(this, AsyncLogWriter::BATCH, sql, nullptr, parameterList.size());
     return protocol->executeBatchServer(mustExecuteOnMaster, serverPrepareResult, results, sql, parameterList, hasLongData);
   }
 
 
+  void ProtocolLoggingProxy::executeBatchArrays(ServerPrepareResult* serverPrepareResult, Shared::Results& results,
+    const std::vector<ParameterArray>& arrays, uint32_t rows)
+  {
+    LoggedOperation logged(this, AsyncLogWriter::BATCH, serverPrepareResult->getSql(), nullptr, rows);
+    protocol->executeBatchArrays(serverPrepareResult, results, arrays, rows);
+  }
+
+
+  int64_t ProtocolLoggingProxy::executeBulkLoad(const SQLString& table, const SQLString* columns, std::size_t columnCount,
+    RowProducer& producer)
+  {
+    /* Add here logging if needed */
+    return protocol->executeBulkLoad(table, columns, columnCount, producer);
+  }
+
+
 	void ProtocolLoggingProxy::moveToNextResult(Results* results, ServerPrepareResult* spr)
 	{
 		/* Add here logging if needed */
@@ -482,10 +750,10 @@ namespace mariadb
     /* Add here logging if needed */
     protocol->setHostFailedWithoutProxy();
   }
-  void ProtocolLoggingProxy::releasePrepareStatement(ServerPrepareResult* serverPrepareResult)
+  bool ProtocolLoggingProxy::releasePrepareStatement(ServerPrepareResult* serverPrepareResult)
 	{
 		/* Add here logging if needed */
-	  protocol->releasePrepareStatement(serverPrepareResult);
+	  return protocol->releasePrepareStatement(serverPrepareResult);
 	}
 
 
@@ -510,6 +778,12 @@ namespace mariadb
 	}
 
 
+  void ProtocolLoggingProxy::prepareCachedQueries(const std::vector<SQLString>& keys, std::size_t maxCount)
+  {
+    protocol->prepareCachedQueries(keys, maxCount);
+  }
+
+
   TimeZone* ProtocolLoggingProxy::getTimeZone()
 	{
 		/* Add here logging if needed */
@@ -579,7 +853,7 @@ namespace mariadb
 	}
 
 
-  ServerPrepareResult* ProtocolLoggingProxy::addPrepareInCache(const SQLString& key, ServerPrepareResult* serverPrepareResult)
+  bool ProtocolLoggingProxy::addPrepareInCache(const SQLString& key, ServerPrepareResult* serverPrepareResult)
 	{
 		/* Add here logging if needed */
     return protocol->addPrepareInCache(key, serverPrepareResult);
@@ -649,6 +923,56 @@ namespace mariadb
 	}
 
 
+	bool ProtocolLoggingProxy::failover()
+	{
+		/* Add here logging if needed */
+	  return protocol->failover();
+	}
+
+
+	MetricsRecorder& ProtocolLoggingProxy::getMetrics()
+	{
+		/* Add here logging if needed */
+	  return protocol->getMetrics();
+	}
+
+
+  void ProtocolLoggingProxy::trimMemory()
+  {
+    protocol->trimMemory();
+  }
+
+
+  std::size_t ProtocolLoggingProxy::getMemoryFootprint()
+  {
+    return sizeof(*this) + protocol->getMemoryFootprint();
+  }
+
+
+  std::size_t ProtocolLoggingProxy::getBatchWindow()
+  {
+    return protocol->getBatchWindow();
+  }
+
+
+  const SQLString& ProtocolLoggingProxy::getLastGtid() const
+  {
+    return protocol->getLastGtid();
+  }
+
+
+  bool ProtocolLoggingProxy::waitForGtid(const SQLString& gtid, int32_t timeout)
+  {
+    return protocol->waitForGtid(gtid, timeout);
+  }
+
+
+  const std::shared_ptr<MemoryAccount>& ProtocolLoggingProxy::getMemoryAccount()
+  {
+    return protocol->getMemoryAccount();
+  }
+
+
   //PacketInputistream* ProtocolLoggingProxy::getReader()
 	//{
 	//	/* Add here logging if needed */
@@ -684,6 +1008,13 @@ namespace mariadb
 	}
 
 
+  bool ProtocolLoggingProxy::transactionIsolationTracked()
+  {
+    /* Add here logging if needed */
+    return protocol->transactionIsolationTracked();
+  }
+
+
   SQLString ProtocolLoggingProxy::getTraces()
 	{
 		/* Add here logging if needed */
@@ -22,6 +22,8 @@
 #define _PROTOCOLLOGGINGPROXY_H_
 
 
+#include <ostream>
+
 #include "Protocol.h"
 #include "Consts.h"
 
@@ -41,17 +43,19 @@ class ProtocolLoggingProxy : public Protocol
   int64_t slowQueryThresholdNanos;
   int32_t maxQuerySizeToLog;
   LogQueryTool* logQuery;
+  std::ostream* logStream;
+
+  /* Times the operation in its scope, and puts the query log record, if it has to be logged */
+  class LoggedOperation;
 
   ProtocolLoggingProxy() {}
 
 public:
-  ProtocolLoggingProxy(Shared::Protocol &realProtocol, const Shared::Options& options) : protocol(realProtocol),
-    profileSql(options->profileSql), slowQueryThresholdNanos(options->slowQueryThresholdNanos),
-    maxQuerySizeToLog(options->maxQuerySizeToLog), logQuery(nullptr)
-  {}
+  ProtocolLoggingProxy(Shared::Protocol &realProtocol, const Shared::Options& options);
 
   ServerPrepareResult* prepare(const SQLString& sql, bool executeOnMaster);
   bool getAutocommit();
+  void setAutocommit(bool autocommit);
   bool noBackslashEscapes();
   void connect();
   const UrlParser& getUrlParser() const;
@@ -62,9 +66,15 @@ public:
   bool hasMoreResults();
   void close();
   void reset();
+  void changeUser(const SQLString& user, const SQLString& password, const SQLString& database);
   void closeExplicit();
+  void deferTransactionEnd(bool commit);
+  void flushTransactionEnd();
+  void deferSavepoint(const SQLString& name, bool release);
+  bool rollbackDeferredSavepoint(const SQLString& name);
   bool isClosed();
   void resetDatabase();
+  void resetSessionState(bool autocommit, int32_t transactionIsolationLevel, bool resetDatabase);
   SQLString getCatalog();
   void setCatalog(const SQLString& database);
   const SQLString& getServerVersion() const;
@@ -88,12 +98,28 @@ public:
   void executeQuery(bool mustExecuteOnMaster, Shared::Results& results, ClientPrepareResult* clientPrepareResult, std::vector<Shared::ParameterHolder>& parameters);
   void executeQuery(bool mustExecuteOnMaster, Shared::Results& results, ClientPrepareResult* clientPrepareResult, std::vector<Shared::ParameterHolder>& parameters,
     int32_t timeout);
+  bool tryExecuteQuery(bool mustExecuteOnMaster, Shared::Results& results, const SQLString& sql, ErrorInfo& error);
+  bool tryExecuteQuery(bool mustExecuteOnMaster, Shared::Results& results, ClientPrepareResult* clientPrepareResult,
+    std::vector<Shared::ParameterHolder>& parameters, int32_t timeout, ErrorInfo& error);
+  void executePipeline(std::vector<Shared::Results>& results, const std::vector<SQLString>& queries);
+  int32_t executeQueryAsyncStart(const SQLString& sql);
+  int32_t executeQueryAsyncContinue(int32_t readyEvents);
+  int64_t getNativeSocket();
+  uint32_t getAsyncTimeout();
   bool executeBatchClient(bool mustExecuteOnMaster, Shared::Results& results, ClientPrepareResult* prepareResult,
     std::vector<std::vector<Shared::ParameterHolder>>& parametersList, bool hasLongData);
   void executeBatchStmt(bool mustExecuteOnMaster,Shared::Results& results, const std::vector<SQLString>& queries);
+  void executeBatchEncoded(Shared::Results& results, ClientPrepareResult* prepareResult, const EncodedBatch& batch);
   void executePreparedQuery(bool mustExecuteOnMaster, ServerPrepareResult* serverPrepareResult, Shared::Results& results, std::vector<Shared::ParameterHolder>& parameters);
+  void executePreparedQuery(bool mustExecuteOnMaster, ServerPrepareResult* serverPrepareResult, Shared::Results& results, const ParameterValue* values);
+  bool tryExecutePreparedQuery(bool mustExecuteOnMaster, ServerPrepareResult* serverPrepareResult, Shared::Results& results,
+    std::vector<Shared::ParameterHolder>& parameters, ErrorInfo& error);
+  ServerPrepareResult* prepareAndExecute(const SQLString& sql, Shared::Results& results, std::vector<Shared::ParameterHolder>& parameters);
   bool executeBatchServer(bool mustExecuteOnMaster, ServerPrepareResult* serverPrepareResult, Shared::Results& results, const SQLString& sql,
                           std::vector<std::vector<Shared::ParameterHolder>>& parameterList, bool hasLongData);
+  void executeBatchArrays(ServerPrepareResult* serverPrepareResult, Shared::Results& results,
+                          const std::vector<ParameterArray>& arrays, uint32_t rows);
+  int64_t executeBulkLoad(const SQLString& table, const SQLString* columns, std::size_t columnCount, RowProducer& producer);
   void moveToNextResult(Results* results, ServerPrepareResult* spr=nullptr);
   void getResult(Results* results, ServerPrepareResult *pr=nullptr, bool readAllResults=false);
   void cancelCurrentQuery();
@@ -119,10 +145,11 @@ public:
   void connectWithoutProxy();
   bool shouldReconnectWithoutProxy();
   void setHostFailedWithoutProxy();
-  void releasePrepareStatement(ServerPrepareResult* serverPrepareResult);
+  bool releasePrepareStatement(ServerPrepareResult* serverPrepareResult);
   bool forceReleasePrepareStatement(capi::MYSQL_STMT* statementId);
   void forceReleaseWaitingPrepareStatement();
   ServerPrepareStatementCache* prepareStatementCache();
+  void prepareCachedQueries(const std::vector<SQLString>& keys, std::size_t maxCount);
   TimeZone* getTimeZone();
   void prolog(int64_t maxRows, bool hasProxy, MariaDbConnection* connection, MariaDbStatement* statement);
   void prologProxy( ServerPrepareResult* serverPrepareResult, int64_t maxRows, bool hasProxy, MariaDbConnection* connection, MariaDbStatement* statement);
@@ -133,7 +160,7 @@ public:
   uint32_t getServerStatus();
   void removeHasMoreResults();
   void setHasWarnings(bool hasWarnings);
-  ServerPrepareResult* addPrepareInCache(const SQLString& key, ServerPrepareResult* serverPrepareResult);
+  bool addPrepareInCache(const SQLString& key, ServerPrepareResult* serverPrepareResult);
   void readEofPacket();
   void skipEofPacket();
   void changeSocketTcpNoDelay(bool setTcpNoDelay);
@@ -143,11 +170,20 @@ public:
   bool isServerMariaDb();
   void setActiveFutureTask(FutureTask* activeFutureTask);
   MariaDBExceptionThrower handleIoException(std::runtime_error& initialException, bool throwRightAway= true);
+  bool failover();
+  MetricsRecorder& getMetrics();
+  void trimMemory();
+  std::size_t getMemoryFootprint();
+  std::size_t getBatchWindow();
+  const SQLString& getLastGtid() const;
+  bool waitForGtid(const SQLString& gtid, int32_t timeout);
+  const std::shared_ptr<MemoryAccount>& getMemoryAccount();
   //PacketInputistream* getReader();
   //PacketOutputStream* getWriter();
   bool isEofDeprecated();
   int32_t getAutoIncrementIncrement();
   bool sessionStateAware();
+  bool transactionIsolationTracked();
   SQLString getTraces();
   bool isInterrupted();
   void stopIfInterrupted();
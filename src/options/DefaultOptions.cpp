@@ -30,7 +30,11 @@ namespace sql
   namespace mariadb
   {
     static const int32_t SocketTimeoutDefault[]= {30000, 0, 0, 0, 0, 0};
-    std::map<std::string, DefaultOptions> OptionsMap{
+    /* Options with their descriptions and defaults. The map is built on the first use rather than by the static
+       initialization, so that the process does not pay for it before it parses any connection options */
+    std::map<std::string, DefaultOptions>& defaultOptionsMap()
+    {
+      static std::map<std::string, DefaultOptions> OptionsMap{
       {"user",     {"user",      "0.9.1", "Database user name",            false} },
       {"password", {"password",  "0.9.1", "Password of the database user", false} },
 
@@ -45,6 +49,25 @@ namespace sql
          false,
          (int32_t)30000,
          int32_t(0)}} ,
+       {
+         "connectAttemptDelay", {"connectAttemptDelay",
+         "1.0.6",
+         "If the url contains several hosts, the delay in milliseconds, after which connection attempt to the next host "
+         "is started, while previous attempts are still in progress. The first established connection is used. "
+         "Zero means hosts are tried one after another.",
+         false,
+         (int32_t)0,
+         int32_t(0)}},
+       {
+         "dnsCacheTtl", {"dnsCacheTtl",
+         "1.0.6",
+         "Time in ms, the resolved addresses of the hosts are kept in the cache shared by all connections of the "
+         "process, so that reconnects do not query DNS each time. Addresses are refreshed in the background before "
+         "they expire. Connections with TLS connect by the host name, since it is required for the certificate "
+         "verification and SNI. Value of 0 disables the cache.",
+         false,
+         (int32_t)0,
+         int32_t(0)}},
        {"pipe", {"pipe",  "0.9.1", "On Windows, specify the named pipe name to connect", false}},
        {
          "localSocket", {"localSocket",
@@ -180,7 +203,8 @@ namespace sql
       {
         "tcpKeepAlive", {"tcpKeepAlive",
         "0.9.1",
-        "Sets corresponding option on the connection socket.",
+        "Sets corresponding option(SO_KEEPALIVE) on the connection socket. Probes are tuned with tcpKeepIdle and "
+        "tcpKeepInterval.",
         false,
         true}},
       {
@@ -236,6 +260,23 @@ namespace sql
         "Driver must recreateConnection after a failover.",
         false,
         false}},
+      {
+        "retryOnFailover", {"retryOnFailover",
+        "1.0.6",
+        "If connection is lost during execution in autocommit mode outside of transaction, the driver reconnects, "
+        "trying other hosts of the url if the failed one does not respond, and executes again reads and statements "
+        "marked retryable with Statement::setRetryable(). The session state is not replayed beyond maxRows, isolation "
+        "level, database and autocommit.",
+        false,
+        false}},
+      {
+        "clientQueryTimeout", {"clientQueryTimeout",
+        "1.0.6",
+        "Enforce query timeouts with client side deadlines, that cancel the query with KILL QUERY, and not with "
+        "max_statement_time. The query text is not changed then. Timeouts, that are not whole seconds, and timeouts on "
+        "servers not supporting max_statement_time are always enforced this way.",
+        false,
+        false}},
       {
         "failOnReadOnly", {"failOnReadOnly",
         "0.9.1",
@@ -271,6 +312,14 @@ namespace sql
         false,
         (int32_t)0,
         int32_t(0)}},
+      {
+        "validMinDelay", {"validMinDelay",
+        "1.0.6",
+        "Time in ms after the last response of the server, during which Connection::isValid() does not ping the "
+        "server, if the socket has no pending EOF or error. 0 means the server is pinged each time",
+        false,
+        (int32_t)0,
+        int32_t(0)}},
       {
         "loadBalanceBlacklistTimeout", {"loadBalanceBlacklistTimeout",
         "0.9.1",
@@ -300,6 +349,122 @@ namespace sql
         false,
         (int32_t)2048,
         int32_t(0)}},
+      {
+        "parsedQueryCacheSize", {"parsedQueryCacheSize",
+        "1.0.6",
+        "Size limit in bytes of the cache of parsed client side prepared statements queries. The cache is shared by all "
+        "connections of the process. Value of 0 disables the cache for the connection.",
+        false,
+        (int32_t)1048576,
+        int32_t(0)}},
+      {
+        "metadataCacheTtl", {"metadataCacheTtl",
+        "1.0.6",
+        "Time in ms, the results of DatabaseMetaData getColumns, getTables, getPrimaryKeys, getIndexInfo and "
+        "getImportedKeys are kept in the cache shared by connections to the same host. DDL executed by any "
+        "connection of the process invalidates the host's cached results. Value of 0 disables the cache.",
+        false,
+        (int32_t)0,
+        int32_t(0)}},
+      {
+        "metadataCacheValidation", {"metadataCacheValidation",
+        "1.0.6",
+        "Validate cached metadata before using it, comparing the number and the creation time of the tables it "
+        "covers in information_schema.TABLES with the values stored with the result. Catches DDL executed by other "
+        "clients at the cost of a cheap query.",
+        false,
+        false}},
+      {
+        "blobChunkSize", {"blobChunkSize",
+        "1.0.6",
+        "If set, BLOB and TEXT values of results of server side prepared statements are not copied to the connector's "
+        "buffers with the row. getBinaryStream and getBlob read them from the fetched row in chunks of this size, "
+        "other getters fetch the whole value, when it is requested. Values of streaming results are copied, when the "
+        "rows are read ahead. 0 disables it.",
+        false,
+        (int32_t)0,
+        int32_t(0)}},
+      {
+        "lazyColumnFetch", {"lazyColumnFetch",
+        "1.0.6",
+        "Values of variable length columns(strings, BLOBs, decimals, JSON, geometry) of results of server side "
+        "prepared statements are not copied to the connector's buffers with the row, but fetched from the row, when they "
+        "are requested. Makes reading of few columns of wide rows cheaper, at the cost of slower access to each value. "
+        "Values of streaming results are still copied, when the rows are read ahead.",
+        false,
+        false}},
+      {
+        "longDataChunkSize", {"longDataChunkSize",
+        "1.0.6",
+        "Size of chunks, in which stream parameters(setBlob, setBinaryStream, setCharacterStream) of server side "
+        "prepared statements are read and sent to the server. Values bigger than the maximum packet size are "
+        "reduced to it.",
+        false,
+        (int32_t)1048576,
+        int32_t(1)}},
+      {
+        "longDataReadAhead", {"longDataReadAhead",
+        "1.0.6",
+        "Read the next chunk of a stream parameter in the separate thread, while the current chunk is being sent, "
+        "so that reading of the stream overlaps with the network transfer. Requires the second chunk buffer.",
+        false,
+        false}},
+      {
+        "prepStmtCacheResetWarmup", {"prepStmtCacheResetWarmup",
+        "1.0.6",
+        "Number of the most recently used statements of the prepared statements cache, that are prepared again "
+        "after the connection reset with useResetConnection, e.g. when the pooled connection is given back. "
+        "COM_RESET_CONNECTION drops server side prepared statements, and without this the first execution of each "
+        "statement after the reset pays the prepare. 0 disables it.",
+        false,
+        (int32_t)0,
+        int32_t(0)}},
+      {
+        "clientCharacterEncoding", {"clientCharacterEncoding",
+        "1.0.6",
+        "Character set of the strings, that the application passes to and gets from the driver, if it is different "
+        "from useCharacterEncoding. The driver converts strings of setString and getString. Only utf8mb4 with latin1 "
+        "connection character set is supported.",
+        false,
+        ""}},
+      {
+        "trustServerEncoding", {"trustServerEncoding",
+        "1.0.6",
+        "Do not check, that strings, that getString returns for utf8mb4 connection, are valid UTF-8.",
+        false,
+        true}},
+      {
+        "tcpQuickAck", {"tcpQuickAck",
+        "1.0.6",
+        "Set TCP_QUICKACK on the connection socket, so that acknowledgements are not delayed. Linux only. The kernel "
+        "may leave the quick acknowledgement mode later on its own.",
+        false,
+        false}},
+      {
+        "socketBusyPoll", {"socketBusyPoll",
+        "1.0.6",
+        "Microseconds of busy polling of the device queue on blocking reads from the connection socket(SO_BUSY_POLL). "
+        "Lowers the latency at the cost of CPU. Linux only. 0 disables it.",
+        false,
+        (int32_t)0,
+        int32_t(0)}},
+      {
+        "ipTos", {"ipTos",
+        "1.0.6",
+        "Value of the IP_TOS(IPV6_TCLASS for IPv6) field of the connection's packets, e.g. to give the traffic "
+        "a DSCP class. 0 leaves the system default.",
+        false,
+        (int32_t)0,
+        int32_t(0)}},
+      {
+        "localSocketAutoDetect", {"localSocketAutoDetect",
+        "1.0.6",
+        "For TCP connections to the loopback address, read the server's Unix socket file(@@socket) once per host and "
+        "port, and connect over it afterwards. On Windows the shared memory is used, if the server has it enabled. If "
+        "the socket cannot be used, TCP is used for the host again. Not applicable with localSocket, pipe or "
+        "sharedMemory options.",
+        false,
+        false}},
       {
         "assureReadOnly", {"assureReadOnly",
         "0.9.1",
@@ -334,6 +499,15 @@ namespace sql
         "     * if rewriteBatchedStatements is set to true, this options will be set to false.",
         false,
         false}},
+      {
+        "serverPrepareThreshold", {"serverPrepareThreshold",
+        "1.0.6",
+        "If useServerPrepStmts is off, the client side prepared statement executed more than this number of times is "
+        "prepared on the server, and is executed with the binary protocol from then on. 0 disables this. Has no effect "
+        "with rewriteBatchedStatements",
+        false,
+        (int32_t)0,
+        int32_t(0)}},
 /******************************* Tls parameters *******************************/
       {
         "useTls", {"useTls",
@@ -478,7 +652,8 @@ namespace sql
         "useBatchMultiSendNumber", {"useBatchMultiSendNumber",
         "0.9.1",
         "When option useBatchMultiSend is active,"
-        " indicate the maximum query send in a row before reading results.",
+        " indicate the maximum number of queries sent ahead of reading their results. Results are read while"
+        " the next queries are sent, keeping up to that many queries in flight.",
         false,
         (int32_t)100,
         int32_t(1)}},
@@ -499,6 +674,31 @@ namespace sql
         0LL,
         false,
         0LL}},
+      {
+        "queryLogFile", {"queryLogFile",
+        "1.0.6",
+        "File, the queries logged with profileSql and slowQueryThresholdNanos are appended to. The log is written by "
+        "a background thread. If not set, or the file cannot be opened, the log goes to the standard error stream",
+        false}},
+      {
+        "protocolRecordFile", {"protocolRecordFile",
+        "1.0.6",
+        "Records the whole client/server exchange of each connection to the file with this name and the number of the "
+        "connection in the process appended, e.g. name.1. The recording can be played back with protocolReplayFile",
+        false}},
+      {
+        "protocolReplayFile", {"protocolReplayFile",
+        "1.0.6",
+        "Connects to the in-process mock server, that plays back this recording made with protocolRecordFile, "
+        "instead of the host of the url. Other options have to be the same as in the recorded connection, except TLS "
+        "and compression, that cannot be used",
+        false}},
+      {
+        "preloadPlugins", {"preloadPlugins",
+        "1.0.6",
+        "Comma separated list of Connector/C client plugins, e.g. authentication plugins, that are loaded by the first "
+        "connection that has this option. By default plugins are loaded only when the server asks for them",
+        false}},
       {
         "passwordCharacterEncoding", {"passwordCharacterEncoding",
         "0.9.1",
@@ -549,12 +749,234 @@ namespace sql
         "(works only with server MariaDB >= 10.2.7)",
         false,
         false}},
+      {
+        "bulkIsolateErrors", {"bulkIsolateErrors",
+        "1.0.6",
+        "With useBulkStmts and continueBatchOnError, the failed bulk batch is rolled back to the savepoint, and its "
+        "halves are executed as separate bulks, down to single failed rows. Thus the batch with few bad rows still takes "
+        "few bulk round trips, and each row gets its own status. Requires server, that returns per row results of the bulk",
+        false,
+        false}},
+      {
+        "useCursorFetch", {"useCursorFetch",
+        "1.0.6",
+        "For server side prepared statements with fetch size set, read the result with a read-only server cursor, "
+        "fetching fetchSize rows at a time. The connection can execute other statements while the cursor is open",
+        false,
+        true}},
+      {
+        "batchChunksInFlight", {"batchChunksInFlight",
+        "1.0.6",
+        "Maximum number of chunks of the rewritten batch, that are sent to the server before reading their results. "
+        "Each chunk is cut at max_allowed_packet size",
+        false,
+        (int32_t)1,
+        int32_t(1)}},
+      {
+        "scrollSpillThreshold", {"scrollSpillThreshold",
+        "1.0.6",
+        "Megabytes of rows of the scrollable result read with fetch size set, that are kept in memory. Rows beyond "
+        "that go to memory mapped temporary file, which the OS can page out to the disk. 0 keeps all rows in memory",
+        false,
+        (int32_t)0,
+        int32_t(0)}},
+      {
+        "resultSpillThreshold", {"resultSpillThreshold",
+        "1.0.6",
+        "Megabytes of rows of the result read with fetch size 0, that are kept in memory. If set, rows are read into "
+        "the driver's own storage instead of Connector/C's, and rows beyond that go to memory mapped temporary file. 0 "
+        "lets Connector/C keep the whole result in memory",
+        false,
+        (int32_t)0,
+        int32_t(0)}},
+      {
+        "maxResultSetMemory", {"maxResultSetMemory",
+        "1.0.6",
+        "Megabytes of rows, that result sets of the connection may keep in memory together. Reading the row, that "
+        "would exceed it, fails with HY001 SQLSTATE. If set, results are read into the driver's own storage, like with "
+        "resultSpillThreshold. Spilled rows are not counted. 0 means no limit",
+        false,
+        (int32_t)0,
+        int32_t(0)}},
+      {
+        "streamingReadAhead", {"streamingReadAhead",
+        "1.0.6",
+        "Forward-only result, streamed with the fetch size set, reads the next fetchSize rows in the background "
+        "thread, while the application processes the current ones. Server side cursor results are not read ahead.",
+        false,
+        false}},
+      {
+        "adaptiveBatchWindow", {"adaptiveBatchWindow",
+        "1.0.6",
+        "Number of queries of the multi-send batch, that are sent ahead of reading their results, starts at "
+        "useBatchMultiSendNumber and follows the network: it grows while the results are awaited, and is halved "
+        "when sending blocks. It is bounded by the socket send buffer at the average query size.",
+        false,
+        false}},
+      {
+        "encodeBatchAtAdd", {"encodeBatchAtAdd",
+        "1.0.6",
+        "With rewriteBatchedStatements, rows of the client side prepared statement's batch, that is rewritten as the "
+        "multi-values query, are written as the query text at addBatch time into one buffer, instead of keeping their "
+        "parameter objects till executeBatch. Stream parameters are read at addBatch time then.",
+        false,
+        false}},
+      {
+        "directWriteThreshold", {"directWriteThreshold",
+        "1.0.6",
+        "String and bytes parameters of server side prepared statements of this size or bigger are sent as the long "
+        "data right from the application memory with scatter-gather writes, bypassing the copies into the Connector/C "
+        "buffers. Chunks of stream parameters are sent the same way, and queries of rewritten batches are written in "
+        "packets as they are built. Applies only to the plain connection without TLS and compression. 0 disables it.",
+        false,
+        (int32_t)0,
+        int32_t(0)}},
+      {
+        "failoverStandby", {"failoverStandby",
+        "1.0.6",
+        "If the url contains several hosts, the connection keeps one more authenticated connection to the next healthy "
+        "host ready. When the connection is lost, the standby is taken over instead of connecting anew, and the new "
+        "standby is established in the background.",
+        false,
+        false}},
+      {
+        "failoverStandbyPingInterval", {"failoverStandbyPingInterval",
+        "1.0.6",
+        "Interval in milliseconds, in which the failoverStandby connection is pinged, so that it is not closed by the "
+        "server's wait_timeout, and the failed standby is replaced.",
+        false,
+        (int32_t)30000,
+        int32_t(100)}},
+      {
+        "poolKeepAlive", {"poolKeepAlive",
+        "1.0.6",
+        "Time in seconds, after which the pool pings its idle connection, so that it's not closed by the server's "
+        "wait_timeout or by a proxy. It is capped by the half of the server's wait_timeout, and each connection's time "
+        "is shortened by up to 20% at random, so the pings are spread. The connection, that fails the ping, is "
+        "replaced. 0 disables keepalive.",
+        false,
+        (int32_t)0,
+        int32_t(0)}},
+      {
+        "tcpKeepIdle", {"tcpKeepIdle",
+        "1.0.6",
+        "Time in seconds, the connection stays idle before TCP keepalive probes start(TCP_KEEPIDLE). Applies with "
+        "tcpKeepAlive. 0 leaves the system default.",
+        false,
+        (int32_t)0,
+        int32_t(0)}},
+      {
+        "tcpKeepInterval", {"tcpKeepInterval",
+        "1.0.6",
+        "Time in seconds between TCP keepalive probes(TCP_KEEPINTVL). Applies with tcpKeepAlive. 0 leaves the system "
+        "default.",
+        false,
+        (int32_t)0,
+        int32_t(0)}},
+      {
+        "tcpUserTimeout", {"tcpUserTimeout",
+        "1.0.6",
+        "Time in milliseconds, the sent data may stay unacknowledged, before the connection is dropped "
+        "(TCP_USER_TIMEOUT). Linux only. 0 leaves the system default.",
+        false,
+        (int32_t)0,
+        int32_t(0)}},
+      {
+        "readYourWrites", {"readYourWrites",
+        "1.0.6",
+        "With the replication HA mode, the read-only connection reads from the replica only after it has applied the "
+        "last transaction, that the connection has written on the master. The GTID of the transaction is tracked with "
+        "the session tracking of last_gtid. MariaDB only.",
+        false,
+        false}},
+      {
+        "readYourWritesTimeout", {"readYourWritesTimeout",
+        "1.0.6",
+        "Time in milliseconds, the readYourWrites read waits for the replica to apply the transaction(MASTER_GTID_WAIT), "
+        "before it goes to the master.",
+        false,
+        (int32_t)1000,
+        int32_t(0)}},
+      {
+        "ignoreNoteWarnings", {"ignoreNoteWarnings",
+        "1.0.6",
+        "If true, the session is set with sql_notes=0, so the server does not count note level warnings, e.g. of IF "
+        "EXISTS clauses, and they do not make getWarnings() query the server.",
+        false,
+        false}},
+      {
+        "maxWarnings", {"maxWarnings",
+        "1.0.6",
+        "Maximum number of warnings, that getWarnings() reads from the server after the execution. 0 means all of "
+        "them.",
+        false,
+        (int32_t)0,
+        int32_t(0)}},
+      {
+        "pipelineSavepoints", {"pipelineSavepoints",
+        "1.0.6",
+        "setSavepoint() and releaseSavepoint() don't wait for the server - SAVEPOINT and RELEASE SAVEPOINT are sent "
+        "together with the next command of the connection. A savepoint released or rolled back to before anything has "
+        "been executed after it is not sent at all",
+        false,
+        false}},
+      {
+        "incrementalFetchSize", {"incrementalFetchSize",
+        "1.0.6",
+        "Results of statements without fetch size are read from the server in batches of this many rows, when next() "
+        "reaches the end of the rows read so far, rather than all at once before the first row is returned. Such "
+        "result keeps all its rows and stays scrollable. Moving beyond the rows read, and any other command of the "
+        "connection, read the rest of it first. 0 disables it",
+        false,
+        (int32_t)0,
+        int32_t(0)}},
+      {
+        "defaultFetchBytes", {"defaultFetchBytes",
+        "1.0.6",
+        "Byte budget of every chunk of streamed results of newly-created Statements, as if setFetchBytes(n) was "
+        "called. Rows of the chunk are read until their data reach the budget, and the server cursor fetches as many "
+        "rows as fit in it by the row size observed so far. Alone it streams the result without the limit on rows "
+        "count. 0 disables it",
+        false,
+        (int32_t)0,
+        int32_t(0)}},
+      {
+        "executeDirectLongQueries", {"executeDirectLongQueries",
+        "1.0.6",
+        "Server side prepared statement, that is never cached - the connection has no prepared statements cache, or "
+        "the query is not shorter than prepStmtCacheSqlLimit - is prepared on its first execution together with it, "
+        "as with pipelinePrepare, costing one roundtrip instead of two",
+        false,
+        true}},
+      {
+        "threadSafeConnection", {"threadSafeConnection",
+        "1.0.6",
+        "If false, the connection's lock does nothing. The application has to guarantee then, that the connection, "
+        "its statements and results are never used by two threads at the same time, including the asynchronous "
+        "execution, pipelines and cancel",
+        false,
+        true}},
+      {
+        "pipelinePrepare", {"pipelinePrepare",
+        "1.0.6",
+        "Server side prepared statement is prepared on its first execution, and prepare and execute commands are sent "
+        "together, costing one roundtrip instead of two. Errors in the query are reported then by the first execution",
+        false,
+        false}},
       {
         "autocommit", {"autocommit",
         "0.9.1",
         "Set default autocommit value on connection initialization",
         false,
         true}},
+      {
+        "pipelineTransactionEnd", {"pipelineTransactionEnd",
+        "1.0.6",
+        "commit() and rollback() don't wait for the server - COMMIT or ROLLBACK is sent together with the next command "
+        "of the connection, and its error is thrown by that command before its own result. Closing or resetting the "
+        "connection sends it right away",
+        false,
+        false}},
       {
         "pool", {"pool",
         "1.1.1",
@@ -594,6 +1016,54 @@ namespace sql
         false,
         (int32_t)600,
         Options::MIN_VALUE__MAX_IDLE_TIME}},
+      {
+        "maxLifetime", {"maxLifetime",
+        "1.0.6",
+        "The maximum amount of time in seconds a pooled connection lives. Each connection is retired after "
+        "a random time between 90% and 100% of this, so that connections created together do not expire together. "
+        "The pool creates the replacement before closing the idle connection, connections in use are retired when they "
+        "are given back. 0 means connections are never retired for their age.",
+        false,
+        (int32_t)0,
+        int32_t(0)}},
+      {
+        "idleTrimTime", {"idleTrimTime",
+        "1.0.6",
+        "Time in seconds, after which the pool releases the memory, that its idle connection keeps for the next "
+        "commands - query buffers and cached server side prepared statements. The connection stays in the pool. "
+        "0 disables trimming.",
+        false,
+        (int32_t)0,
+        int32_t(0)}},
+      {
+        "poolPriority", {"poolPriority",
+        "1.0.6",
+        "Priority of the requests for a connection, when the pool is exhausted. Waiting requests are served in the "
+        "order of their priority, the higher first, and in the order of arrival within the same priority. The option "
+        "is not part of the pool configuration - connects with different priorities share the same pool.",
+        false,
+        (int32_t)0,
+        int32_t(0)}},
+      {
+        "sharedPool", {"sharedPool",
+        "1.0.6",
+        "The pool is shared by all users and databases on the same hosts, and maxPoolSize limits the connections to "
+        "the hosts, and not to the user. A connection of another user is switched with COM_CHANGE_USER, and "
+        "the connection of the same user, but of another database, gets the database with its next command. Idle "
+        "connections of the same user are handed out first. The pool's options are those of its first connect.",
+        false,
+        false}},
+      {
+        "poolRebalanceRate", {"poolRebalanceRate",
+        "1.0.6",
+        "Maximum number of idle connections, that the pool moves to other hosts in each run of its thread, so that "
+        "the connections are distributed over healthy hosts of the url the way new connections would be - on the "
+        "first healthy host, or by host weights with loadbalance. Moves connections back to the host, that has "
+        "recovered after a failover. The replacement is connected before the idle connection is closed, connections "
+        "in use are not touched. 0 disables rebalancing.",
+        false,
+        (int32_t)0,
+        int32_t(0)}},
       {
         "poolValidMinDelay", {"poolValidMinDelay",
         "1.1.1",
@@ -604,6 +1074,31 @@ namespace sql
         false,
         (int32_t)1000,
         int32_t(0)}},
+      {
+        "adaptiveConcurrency", {"adaptiveConcurrency",
+        "1.0.6",
+        "Limits the number of connections the pool hands out at once below maxPoolSize, adapting the limit to the "
+        "time connections are held. The limit grows additively while the hold time is stable, and is cut when it "
+        "rises or connections break. Requests over the limit wait for a connection, and are rejected right away, if "
+        "there are already as many waiters as the limit.",
+        false,
+        false}},
+      {
+        "circuitBreakerThreshold", {"circuitBreakerThreshold",
+        "1.0.6",
+        "Number of consecutive failures(connection errors) on a host, after which the pool stops connecting to it "
+        "for circuitBreakerTimeout ms, and fails requests right away, if all hosts of the url are in this state. "
+        "0 disables the circuit breaker.",
+        false,
+        (int32_t)0,
+        int32_t(0)}},
+      {
+        "circuitBreakerTimeout", {"circuitBreakerTimeout",
+        "1.0.6",
+        "Time in ms the pool's circuit breaker stays open, before one request is let through to try the host again.",
+        false,
+        (int32_t)5000,
+        int32_t(0)}},
       {
         "staticGlobal", {"staticGlobal",
         "0.9.1",
@@ -662,7 +1157,9 @@ namespace sql
       {
         "useReadAheadInput", {"useReadAheadInput",
         "0.9.1",
-        "use a buffered inputSteam that read socket available data",
+        "use a buffered inputSteam that read socket available data. Connector/C always reads ahead - packets shorter "
+        "than 2k are served from its 16k read cache, and longer ones are read directly into the packet buffer. Thus "
+        "the option has no effect. The socket receive buffer may be raised with tcpRcvBuf",
         false,
         true}
       },
@@ -704,13 +1201,18 @@ namespace sql
         false,
         ""}
       }
-    };
+      };
+      return OptionsMap;
+    }
 
 //---------------------------------------- Aliases ------------------------------------------------------------------------------------
-    bool addAliases(std::map<std::string, DefaultOptions*>& completeOptionsMap) {
+    static std::unordered_map<std::string, DefaultOptions*> addAliases() {
+      std::map<std::string, DefaultOptions>& OptionsMap= defaultOptionsMap();
+      std::unordered_map<std::string, DefaultOptions*> completeOptionsMap;
       // Here it has to be reference, otherwise it will create (short living) copy of the mapped DefaultOptions
       // object. Plus we don't want extra copy-constructing anyway
       for (auto& defaultOption : OptionsMap) {
+        defaultOption.second.field= Options::getField(defaultOption.first);
         completeOptionsMap.emplace(defaultOption.first, &defaultOption.second);
       }
 
@@ -745,11 +1247,15 @@ namespace sql
       completeOptionsMap.emplace("OPT_SET_CHARSET_NAME",       &OptionsMap["useCharacterEncoding"]);
       completeOptionsMap.emplace("useCharset",                 &OptionsMap["useCharacterEncoding"]);
       completeOptionsMap.emplace("defaultAuth",                &OptionsMap["credentialType"]);
-      return true;
+      return completeOptionsMap;
     }
 
-    std::map<std::string, DefaultOptions*> DefaultOptions::OPTIONS_MAP;
-    static bool aliasesAdded= addAliases(DefaultOptions::OPTIONS_MAP);
+
+    const std::unordered_map<std::string, DefaultOptions*>& DefaultOptions::getOptionsMap()
+    {
+      static const std::unordered_map<std::string, DefaultOptions*> completeOptionsMap(addAliases());
+      return completeOptionsMap;
+    }
 //-------------------------------------------------------------------------------------------------------------------------------------
     DefaultOptions::DefaultOptions(const char * optionName, const char * /*implementationVersion*/, const char* description, bool required)
       : optionName(optionName)
@@ -904,12 +1410,12 @@ namespace sql
           const std::string& key= StringImp::get(it.first);
           SQLString propertyValue(it.second);
 
-          const auto& cit= OPTIONS_MAP.find(key);
+          const auto& cit= getOptionsMap().find(key);
 
-          if (cit != OPTIONS_MAP.end()/* && !propertyValue.empty()*/)
+          if (cit != getOptionsMap().end()/* && !propertyValue.empty()*/)
           {
             DefaultOptions *o= cit->second;
-            const ClassField<Options> field= Options::getField(o->optionName);
+            const ClassField<Options>& field= o->field;
 
             if (o->objType() == Value::VSTRING ){
               field.set(options, propertyValue);
@@ -1042,6 +1548,7 @@ namespace sql
     {
       if (options->rewriteBatchedStatements){
         options->useServerPrepStmts= false;
+        options->serverPrepareThreshold= 0;
       }
       if (!options->pipe.empty()){
         options->useBatchMultiSend= false;
@@ -1053,8 +1560,6 @@ namespace sql
           options->minPoolSize == 0
           ? options->maxPoolSize
           : std::min(options->minPoolSize, options->maxPoolSize);
-
-        throw SQLFeatureNotImplementedException("This connector version does not have pool support");
       }
 
       if (options->cacheCallableStmts || options->cachePrepStmts) {
@@ -1077,6 +1582,9 @@ namespace sql
       if (options->useCharacterEncoding.compare("utf8") == 0) {
         options->useCharacterEncoding = "utf8mb4";
       }
+      // Throws, if the conversion is not supported
+      Charset::getTranscoding(options->useCharacterEncoding, options->clientCharacterEncoding,
+        options->trustServerEncoding);
     }
 
     /**
@@ -1091,13 +1599,15 @@ namespace sql
       try
       {
         bool first= true;
-        for (auto& it : OptionsMap)
+        Value value;
+        for (auto& it : defaultOptionsMap())
         {
           DefaultOptions& o= it.second;
-          const ClassField<Options> field= Options::getField(o.optionName);
-          const Value& value= field.get(*options);
+          const ClassField<Options>& field= o.field;
+          field.get(*options, value);
 
-          if (!value.empty() && !value.equals(o.defaultValue))
+          // The priority is the property of the request, and not of the pool, that the url identifies
+          if (!value.empty() && !value.equals(o.defaultValue) && o.optionName.compare("poolPriority") != 0)
           {
             if (first)
             {
@@ -22,6 +22,7 @@
 #define _DEFAULTOPTIONS_H_
 
 #include <memory>
+#include <unordered_map>
 
 #include "jdbccompat.hpp"
 #include "util/Value.h"
@@ -44,7 +45,10 @@ class DefaultOptions
 
 public:
   const Value defaultValue;
-  static std::map<std::string, DefaultOptions*> OPTIONS_MAP;
+  // Field of the Options, that the option sets. Resolved once, when the map of options and aliases is built
+  ClassField<Options> field;
+  /* Options and their aliases */
+  static const std::unordered_map<std::string, DefaultOptions*>& getOptionsMap();
 
   /* These constructor makes use of [] operator on the OptionsMap possible */
   DefaultOptions() : required(false) {}
@@ -86,7 +90,7 @@ public:
     enum Value::valueType objType() const;
 };
 
-extern std::map<std::string, DefaultOptions> OptionsMap;
+std::map<std::string, DefaultOptions>& defaultOptionsMap();
 
 }
 }
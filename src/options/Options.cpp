@@ -27,8 +27,6 @@ namespace sql
 {
 namespace mariadb
 {
-  extern std::map<std::string, DefaultOptions> OptionsMap;
-
   /* hashMap does not compile with SQLString out of the box, thus std::string */
   int64_t hashProps(const Properties& props)
   {
@@ -46,107 +44,173 @@ namespace mariadb
 
 #define OPTIONS_FIELD(_FIELD) {#_FIELD, &Options::_FIELD}
 
-  std::map<std::string, ClassField<Options>> Options::Field{
-    OPTIONS_FIELD(user),
-    OPTIONS_FIELD(password),
-    OPTIONS_FIELD(trustServerCertificate),
-    OPTIONS_FIELD(serverSslCert),
-    OPTIONS_FIELD(tlsKey),
-    OPTIONS_FIELD(tlsCRLPath),
-    OPTIONS_FIELD(tlsCRL),
-    OPTIONS_FIELD(tlsCert),
-    OPTIONS_FIELD(tlsCA),
-    OPTIONS_FIELD(tlsCAPath),
-    OPTIONS_FIELD(keyPassword),
-    OPTIONS_FIELD(enabledTlsProtocolSuites),
-    OPTIONS_FIELD(useFractionalSeconds),
-    OPTIONS_FIELD(pinGlobalTxToPhysicalConnection),
-    OPTIONS_FIELD(socketFactory),
-    OPTIONS_FIELD(connectTimeout),
-    OPTIONS_FIELD(pipe),
-    OPTIONS_FIELD(localSocket),
-    OPTIONS_FIELD(sharedMemory),
-    OPTIONS_FIELD(tcpNoDelay),
-    OPTIONS_FIELD(tcpKeepAlive),
-    OPTIONS_FIELD(tcpRcvBuf),
-    OPTIONS_FIELD(tcpSndBuf),
-    OPTIONS_FIELD(tcpAbortiveClose),
-    OPTIONS_FIELD(localSocketAddress),
-    OPTIONS_FIELD(socketTimeout),
-    OPTIONS_FIELD(allowMultiQueries),
-    OPTIONS_FIELD(rewriteBatchedStatements),
-    OPTIONS_FIELD(useCompression),
-    OPTIONS_FIELD(interactiveClient),
-    OPTIONS_FIELD(passwordCharacterEncoding),
-    OPTIONS_FIELD(useCharacterEncoding),
-    OPTIONS_FIELD(blankTableNameMeta),
-    OPTIONS_FIELD(credentialType),
-    OPTIONS_FIELD(useTls),
-    OPTIONS_FIELD(enabledTlsCipherSuites),
-    OPTIONS_FIELD(sessionVariables),
-    OPTIONS_FIELD(tinyInt1isBit),
-    OPTIONS_FIELD(yearIsDateType),
-    OPTIONS_FIELD(createDatabaseIfNotExist),
-    OPTIONS_FIELD(serverTimezone),
-    OPTIONS_FIELD(nullCatalogMeansCurrent),
-    OPTIONS_FIELD(dumpQueriesOnException),
-    OPTIONS_FIELD(useOldAliasMetadataBehavior),
-    OPTIONS_FIELD(useMysqlMetadata),
-    OPTIONS_FIELD(allowLocalInfile),
-    OPTIONS_FIELD(cachePrepStmts),
-    OPTIONS_FIELD(prepStmtCacheSize),
-    OPTIONS_FIELD(prepStmtCacheSqlLimit),
-    OPTIONS_FIELD(useAffectedRows),
-    OPTIONS_FIELD(maximizeMysqlCompatibility),
-    OPTIONS_FIELD(useServerPrepStmts),
-    OPTIONS_FIELD(continueBatchOnError),
-    OPTIONS_FIELD(jdbcCompliantTruncation),
-    OPTIONS_FIELD(cacheCallableStmts),
-    OPTIONS_FIELD(callableStmtCacheSize),
-    OPTIONS_FIELD(connectionAttributes),
-    OPTIONS_FIELD(useBatchMultiSend),
-    OPTIONS_FIELD(useBatchMultiSendNumber),
-    OPTIONS_FIELD(usePipelineAuth),
-    OPTIONS_FIELD(enablePacketDebug),
-    OPTIONS_FIELD(useBulkStmts),
-    OPTIONS_FIELD(disableSslHostnameVerification),
-    OPTIONS_FIELD(autocommit),
-    OPTIONS_FIELD(includeInnodbStatusInDeadlockExceptions),
-    OPTIONS_FIELD(includeThreadDumpInDeadlockExceptions),
-    OPTIONS_FIELD(servicePrincipalName),
-    OPTIONS_FIELD(defaultFetchSize),
-    OPTIONS_FIELD(tlsPeerFPList),
-    OPTIONS_FIELD(log),
-    OPTIONS_FIELD(profileSql),
-    OPTIONS_FIELD(maxQuerySizeToLog),
-    OPTIONS_FIELD(slowQueryThresholdNanos),
-    OPTIONS_FIELD(assureReadOnly),
-    OPTIONS_FIELD(autoReconnect),
-    OPTIONS_FIELD(failOnReadOnly),
-    OPTIONS_FIELD(retriesAllDown),
-    OPTIONS_FIELD(validConnectionTimeout),
-    OPTIONS_FIELD(loadBalanceBlacklistTimeout),
-    OPTIONS_FIELD(failoverLoopRetries),
-    OPTIONS_FIELD(allowMasterDownConnection),
-    OPTIONS_FIELD(galeraAllowedState),
-    OPTIONS_FIELD(pool),
-    OPTIONS_FIELD(poolName),
-    OPTIONS_FIELD(maxPoolSize),
-    OPTIONS_FIELD(minPoolSize),
-    OPTIONS_FIELD(maxIdleTime),
-    OPTIONS_FIELD(staticGlobal),
-    OPTIONS_FIELD(poolValidMinDelay),
-    OPTIONS_FIELD(useResetConnection),
-    OPTIONS_FIELD(useReadAheadInput),
-    OPTIONS_FIELD(serverRsaPublicKeyFile),
-    OPTIONS_FIELD(tlsPeerFP)
-  };
+  /* Map is function local, so it can be used during static initialization of other units */
+  std::map<std::string, ClassField<Options>>& Options::fields()
+  {
+    static std::map<std::string, ClassField<Options>> Field{
+      OPTIONS_FIELD(user),
+      OPTIONS_FIELD(password),
+      OPTIONS_FIELD(trustServerCertificate),
+      OPTIONS_FIELD(serverSslCert),
+      OPTIONS_FIELD(tlsKey),
+      OPTIONS_FIELD(tlsCRLPath),
+      OPTIONS_FIELD(tlsCRL),
+      OPTIONS_FIELD(tlsCert),
+      OPTIONS_FIELD(tlsCA),
+      OPTIONS_FIELD(tlsCAPath),
+      OPTIONS_FIELD(keyPassword),
+      OPTIONS_FIELD(enabledTlsProtocolSuites),
+      OPTIONS_FIELD(useFractionalSeconds),
+      OPTIONS_FIELD(pinGlobalTxToPhysicalConnection),
+      OPTIONS_FIELD(socketFactory),
+      OPTIONS_FIELD(connectTimeout),
+      OPTIONS_FIELD(connectAttemptDelay),
+      OPTIONS_FIELD(dnsCacheTtl),
+      OPTIONS_FIELD(pipe),
+      OPTIONS_FIELD(localSocket),
+      OPTIONS_FIELD(sharedMemory),
+      OPTIONS_FIELD(tcpNoDelay),
+      OPTIONS_FIELD(tcpKeepAlive),
+      OPTIONS_FIELD(tcpRcvBuf),
+      OPTIONS_FIELD(tcpSndBuf),
+      OPTIONS_FIELD(tcpAbortiveClose),
+      OPTIONS_FIELD(localSocketAddress),
+      OPTIONS_FIELD(socketTimeout),
+      OPTIONS_FIELD(allowMultiQueries),
+      OPTIONS_FIELD(rewriteBatchedStatements),
+      OPTIONS_FIELD(useCompression),
+      OPTIONS_FIELD(interactiveClient),
+      OPTIONS_FIELD(passwordCharacterEncoding),
+      OPTIONS_FIELD(useCharacterEncoding),
+      OPTIONS_FIELD(blankTableNameMeta),
+      OPTIONS_FIELD(credentialType),
+      OPTIONS_FIELD(useTls),
+      OPTIONS_FIELD(enabledTlsCipherSuites),
+      OPTIONS_FIELD(sessionVariables),
+      OPTIONS_FIELD(tinyInt1isBit),
+      OPTIONS_FIELD(yearIsDateType),
+      OPTIONS_FIELD(createDatabaseIfNotExist),
+      OPTIONS_FIELD(serverTimezone),
+      OPTIONS_FIELD(nullCatalogMeansCurrent),
+      OPTIONS_FIELD(dumpQueriesOnException),
+      OPTIONS_FIELD(useOldAliasMetadataBehavior),
+      OPTIONS_FIELD(useMysqlMetadata),
+      OPTIONS_FIELD(allowLocalInfile),
+      OPTIONS_FIELD(cachePrepStmts),
+      OPTIONS_FIELD(prepStmtCacheSize),
+      OPTIONS_FIELD(prepStmtCacheSqlLimit),
+      OPTIONS_FIELD(parsedQueryCacheSize),
+      OPTIONS_FIELD(metadataCacheTtl),
+      OPTIONS_FIELD(metadataCacheValidation),
+      OPTIONS_FIELD(blobChunkSize),
+      OPTIONS_FIELD(lazyColumnFetch),
+      OPTIONS_FIELD(longDataChunkSize),
+      OPTIONS_FIELD(longDataReadAhead),
+      OPTIONS_FIELD(prepStmtCacheResetWarmup),
+      OPTIONS_FIELD(clientCharacterEncoding),
+      OPTIONS_FIELD(trustServerEncoding),
+      OPTIONS_FIELD(tcpQuickAck),
+      OPTIONS_FIELD(socketBusyPoll),
+      OPTIONS_FIELD(ipTos),
+      OPTIONS_FIELD(localSocketAutoDetect),
+      OPTIONS_FIELD(batchChunksInFlight),
+      OPTIONS_FIELD(scrollSpillThreshold),
+      OPTIONS_FIELD(resultSpillThreshold),
+      OPTIONS_FIELD(maxResultSetMemory),
+      OPTIONS_FIELD(streamingReadAhead),
+      OPTIONS_FIELD(adaptiveBatchWindow),
+      OPTIONS_FIELD(encodeBatchAtAdd),
+      OPTIONS_FIELD(directWriteThreshold),
+      OPTIONS_FIELD(failoverStandby),
+      OPTIONS_FIELD(failoverStandbyPingInterval),
+      OPTIONS_FIELD(poolKeepAlive),
+      OPTIONS_FIELD(tcpKeepIdle),
+      OPTIONS_FIELD(tcpKeepInterval),
+      OPTIONS_FIELD(tcpUserTimeout),
+      OPTIONS_FIELD(readYourWrites),
+      OPTIONS_FIELD(readYourWritesTimeout),
+      OPTIONS_FIELD(ignoreNoteWarnings),
+      OPTIONS_FIELD(maxWarnings),
+      OPTIONS_FIELD(pipelineSavepoints),
+      OPTIONS_FIELD(incrementalFetchSize),
+      OPTIONS_FIELD(defaultFetchBytes),
+      OPTIONS_FIELD(executeDirectLongQueries),
+      OPTIONS_FIELD(threadSafeConnection),
+      OPTIONS_FIELD(useAffectedRows),
+      OPTIONS_FIELD(maximizeMysqlCompatibility),
+      OPTIONS_FIELD(useServerPrepStmts),
+      OPTIONS_FIELD(serverPrepareThreshold),
+      OPTIONS_FIELD(continueBatchOnError),
+      OPTIONS_FIELD(jdbcCompliantTruncation),
+      OPTIONS_FIELD(cacheCallableStmts),
+      OPTIONS_FIELD(callableStmtCacheSize),
+      OPTIONS_FIELD(connectionAttributes),
+      OPTIONS_FIELD(useBatchMultiSend),
+      OPTIONS_FIELD(useBatchMultiSendNumber),
+      OPTIONS_FIELD(usePipelineAuth),
+      OPTIONS_FIELD(enablePacketDebug),
+      OPTIONS_FIELD(useBulkStmts),
+      OPTIONS_FIELD(bulkIsolateErrors),
+      OPTIONS_FIELD(useCursorFetch),
+      OPTIONS_FIELD(pipelinePrepare),
+      OPTIONS_FIELD(disableSslHostnameVerification),
+      OPTIONS_FIELD(autocommit),
+      OPTIONS_FIELD(pipelineTransactionEnd),
+      OPTIONS_FIELD(includeInnodbStatusInDeadlockExceptions),
+      OPTIONS_FIELD(includeThreadDumpInDeadlockExceptions),
+      OPTIONS_FIELD(servicePrincipalName),
+      OPTIONS_FIELD(defaultFetchSize),
+      OPTIONS_FIELD(tlsPeerFPList),
+      OPTIONS_FIELD(log),
+      OPTIONS_FIELD(profileSql),
+      OPTIONS_FIELD(maxQuerySizeToLog),
+      OPTIONS_FIELD(slowQueryThresholdNanos),
+      OPTIONS_FIELD(queryLogFile),
+      OPTIONS_FIELD(protocolRecordFile),
+      OPTIONS_FIELD(protocolReplayFile),
+      OPTIONS_FIELD(preloadPlugins),
+      OPTIONS_FIELD(assureReadOnly),
+      OPTIONS_FIELD(autoReconnect),
+      OPTIONS_FIELD(retryOnFailover),
+      OPTIONS_FIELD(clientQueryTimeout),
+      OPTIONS_FIELD(failOnReadOnly),
+      OPTIONS_FIELD(retriesAllDown),
+      OPTIONS_FIELD(validConnectionTimeout),
+      OPTIONS_FIELD(validMinDelay),
+      OPTIONS_FIELD(loadBalanceBlacklistTimeout),
+      OPTIONS_FIELD(failoverLoopRetries),
+      OPTIONS_FIELD(allowMasterDownConnection),
+      OPTIONS_FIELD(galeraAllowedState),
+      OPTIONS_FIELD(pool),
+      OPTIONS_FIELD(poolName),
+      OPTIONS_FIELD(maxPoolSize),
+      OPTIONS_FIELD(minPoolSize),
+      OPTIONS_FIELD(maxIdleTime),
+      OPTIONS_FIELD(maxLifetime),
+      OPTIONS_FIELD(idleTrimTime),
+      OPTIONS_FIELD(poolPriority),
+      OPTIONS_FIELD(sharedPool),
+      OPTIONS_FIELD(poolRebalanceRate),
+      OPTIONS_FIELD(staticGlobal),
+      OPTIONS_FIELD(poolValidMinDelay),
+      OPTIONS_FIELD(adaptiveConcurrency),
+      OPTIONS_FIELD(circuitBreakerThreshold),
+      OPTIONS_FIELD(circuitBreakerTimeout),
+      OPTIONS_FIELD(useResetConnection),
+      OPTIONS_FIELD(useReadAheadInput),
+      OPTIONS_FIELD(serverRsaPublicKeyFile),
+      OPTIONS_FIELD(tlsPeerFP)
+    };
+
+    return Field;
+  }
 
 
   ClassField<Options>& Options::getField(const SQLString& fieldName)
   {
     static ClassField<Options> emptyField;
 
+    auto& Field= fields();
     auto it= Field.find(StringImp::get(fieldName));
 
     if (it != Field.end())
@@ -158,12 +222,24 @@ namespace mariadb
   }
 
 
-  Options::Options()
+  Options::Options() : Options(defaults())
+  {
+  }
+
+
+  const Options& Options::defaults()
+  {
+    static const Options prototype(fields());
+    return prototype;
+  }
+
+
+  Options::Options(std::map<std::string, ClassField<Options>>& Field)
   {
     for (auto& it : Field) {
-      const auto& cit= OptionsMap.find(it.first);
+      const auto& cit= defaultOptionsMap().find(it.first);
 
-      if (cit != OptionsMap.end())
+      if (cit != defaultOptionsMap().end())
       {
         try {
           switch (it.second.objType())
@@ -311,6 +387,9 @@ namespace mariadb
     if (useServerPrepStmts != opt->useServerPrepStmts) {
       return false;
     }
+    if (serverPrepareThreshold != opt->serverPrepareThreshold) {
+      return false;
+    }
     if (continueBatchOnError != opt->continueBatchOnError) {
       return false;
     }
@@ -338,6 +417,15 @@ namespace mariadb
     if (useBulkStmts != opt->useBulkStmts) {
       return false;
     }
+    if (bulkIsolateErrors != opt->bulkIsolateErrors) {
+      return false;
+    }
+    if (useCursorFetch != opt->useCursorFetch) {
+      return false;
+    }
+    if (pipelinePrepare != opt->pipelinePrepare) {
+      return false;
+    }
     if (disableSslHostnameVerification != opt->disableSslHostnameVerification) {
       return false;
     }
@@ -353,6 +441,12 @@ namespace mariadb
     if (autoReconnect != opt->autoReconnect) {
       return false;
     }
+    if (retryOnFailover != opt->retryOnFailover) {
+      return false;
+    }
+    if (clientQueryTimeout != opt->clientQueryTimeout) {
+      return false;
+    }
     if (failOnReadOnly != opt->failOnReadOnly) {
       return false;
     }
@@ -365,6 +459,9 @@ namespace mariadb
     if (validConnectionTimeout != opt->validConnectionTimeout) {
       return false;
     }
+    if (validMinDelay != opt->validMinDelay) {
+      return false;
+    }
     if (loadBalanceBlacklistTimeout != opt->loadBalanceBlacklistTimeout) {
       return false;
     }
@@ -389,9 +486,33 @@ namespace mariadb
     if (maxIdleTime != opt->maxIdleTime) {
       return false;
     }
+    if (maxLifetime != opt->maxLifetime) {
+      return false;
+    }
+    if (idleTrimTime != opt->idleTrimTime) {
+      return false;
+    }
+    if (poolPriority != opt->poolPriority) {
+      return false;
+    }
+    if (sharedPool != opt->sharedPool) {
+      return false;
+    }
+    if (poolRebalanceRate != opt->poolRebalanceRate) {
+      return false;
+    }
     if (poolValidMinDelay != opt->poolValidMinDelay) {
       return false;
     }
+    if (adaptiveConcurrency != opt->adaptiveConcurrency) {
+      return false;
+    }
+    if (circuitBreakerThreshold != opt->circuitBreakerThreshold) {
+      return false;
+    }
+    if (circuitBreakerTimeout != opt->circuitBreakerTimeout) {
+      return false;
+    }
     if (user.compare(opt->user) != 0) {
       return false;
     }
@@ -430,6 +551,12 @@ namespace mariadb
     if (connectTimeout != opt->connectTimeout) {
       return false;
     }
+    if (connectAttemptDelay != opt->connectAttemptDelay) {
+      return false;
+    }
+    if (dnsCacheTtl != opt->dnsCacheTtl) {
+      return false;
+    }
     if (!(pipe.compare(opt->pipe) == 0)) {
       return false;
     }
@@ -482,6 +609,117 @@ namespace mariadb
     if (prepStmtCacheSqlLimit != opt->prepStmtCacheSqlLimit) {
       return false;
     }
+    if (parsedQueryCacheSize != opt->parsedQueryCacheSize) {
+      return false;
+    }
+    if (metadataCacheTtl != opt->metadataCacheTtl) {
+      return false;
+    }
+    if (metadataCacheValidation != opt->metadataCacheValidation) {
+      return false;
+    }
+    if (blobChunkSize != opt->blobChunkSize) {
+      return false;
+    }
+    if (lazyColumnFetch != opt->lazyColumnFetch) {
+      return false;
+    }
+    if (longDataChunkSize != opt->longDataChunkSize) {
+      return false;
+    }
+    if (longDataReadAhead != opt->longDataReadAhead) {
+      return false;
+    }
+    if (prepStmtCacheResetWarmup != opt->prepStmtCacheResetWarmup) {
+      return false;
+    }
+    if (clientCharacterEncoding.compare(opt->clientCharacterEncoding) != 0) {
+      return false;
+    }
+    if (trustServerEncoding != opt->trustServerEncoding) {
+      return false;
+    }
+    if (tcpQuickAck != opt->tcpQuickAck) {
+      return false;
+    }
+    if (socketBusyPoll != opt->socketBusyPoll) {
+      return false;
+    }
+    if (ipTos != opt->ipTos) {
+      return false;
+    }
+    if (localSocketAutoDetect != opt->localSocketAutoDetect) {
+      return false;
+    }
+    if (batchChunksInFlight != opt->batchChunksInFlight) {
+      return false;
+    }
+    if (scrollSpillThreshold != opt->scrollSpillThreshold) {
+      return false;
+    }
+    if (resultSpillThreshold != opt->resultSpillThreshold) {
+      return false;
+    }
+    if (maxResultSetMemory != opt->maxResultSetMemory) {
+      return false;
+    }
+    if (streamingReadAhead != opt->streamingReadAhead) {
+      return false;
+    }
+    if (adaptiveBatchWindow != opt->adaptiveBatchWindow) {
+      return false;
+    }
+    if (encodeBatchAtAdd != opt->encodeBatchAtAdd) {
+      return false;
+    }
+    if (directWriteThreshold != opt->directWriteThreshold) {
+      return false;
+    }
+    if (failoverStandby != opt->failoverStandby) {
+      return false;
+    }
+    if (failoverStandbyPingInterval != opt->failoverStandbyPingInterval) {
+      return false;
+    }
+    if (poolKeepAlive != opt->poolKeepAlive) {
+      return false;
+    }
+    if (tcpKeepIdle != opt->tcpKeepIdle) {
+      return false;
+    }
+    if (tcpKeepInterval != opt->tcpKeepInterval) {
+      return false;
+    }
+    if (tcpUserTimeout != opt->tcpUserTimeout) {
+      return false;
+    }
+    if (readYourWrites != opt->readYourWrites) {
+      return false;
+    }
+    if (readYourWritesTimeout != opt->readYourWritesTimeout) {
+      return false;
+    }
+    if (ignoreNoteWarnings != opt->ignoreNoteWarnings) {
+      return false;
+    }
+    if (maxWarnings != opt->maxWarnings) {
+      return false;
+    }
+    if (pipelineSavepoints != opt->pipelineSavepoints) {
+      return false;
+    }
+    if (incrementalFetchSize != opt->incrementalFetchSize) {
+      return false;
+    }
+    if (defaultFetchBytes != opt->defaultFetchBytes) {
+      return false;
+    }
+    if (executeDirectLongQueries != opt->executeDirectLongQueries) {
+      return false;
+    }
+    if (threadSafeConnection != opt->threadSafeConnection) {
+      return false;
+    }
     if (callableStmtCacheSize != opt->callableStmtCacheSize) {
       return false;
     }
@@ -503,9 +741,24 @@ namespace mariadb
     if (autocommit != opt->autocommit) {
       return false;
     }
+    if (pipelineTransactionEnd != opt->pipelineTransactionEnd) {
+      return false;
+    }
     if (!(poolName.compare(opt->poolName) == 0)) {
       return false;
     }
+    if (!(queryLogFile.compare(opt->queryLogFile) == 0)) {
+      return false;
+    }
+    if (!(protocolRecordFile.compare(opt->protocolRecordFile) == 0)) {
+      return false;
+    }
+    if (!(protocolReplayFile.compare(opt->protocolReplayFile) == 0)) {
+      return false;
+    }
+    if (!(preloadPlugins.compare(opt->preloadPlugins) == 0)) {
+      return false;
+    }
     if (!(galeraAllowedState.compare(opt->galeraAllowedState) == 0)) {
       return false;
     }
@@ -540,6 +793,8 @@ namespace mariadb
     result= 31 *result + (pinGlobalTxToPhysicalConnection ? 1 : 0);
     result= 31 *result + (!socketFactory.empty() ? socketFactory.hashCode() : 0);
     result= 31 *result +connectTimeout;
+    result= 31 *result +connectAttemptDelay;
+    result= 31 *result +dnsCacheTtl;
     result= 31 *result + (!pipe.empty() ? pipe.hashCode() : 0);
     result= 31 *result + (!localSocket.empty() ? localSocket.hashCode() : 0);
     result= 31 *result + (!sharedMemory.empty() ? sharedMemory.hashCode() : 0);
@@ -570,9 +825,47 @@ namespace mariadb
     result= 31 *result + (cachePrepStmts ? 1 : 0);
     result= 31 *result +prepStmtCacheSize;
     result= 31 *result +prepStmtCacheSqlLimit;
+    result= 31 *result +parsedQueryCacheSize;
+    result= 31 *result +metadataCacheTtl;
+    result= 31 *result + (metadataCacheValidation ? 1 : 0);
+    result= 31 *result +blobChunkSize;
+    result= 31 *result + (lazyColumnFetch ? 1 : 0);
+    result= 31 *result +longDataChunkSize;
+    result= 31 *result + (longDataReadAhead ? 1 : 0);
+    result= 31 *result + prepStmtCacheResetWarmup;
+    result= 31 *result + (!clientCharacterEncoding.empty() ? clientCharacterEncoding.hashCode() : 0);
+    result= 31 *result + (trustServerEncoding ? 1 : 0);
+    result= 31 *result + (tcpQuickAck ? 1 : 0);
+    result= 31 *result + socketBusyPoll;
+    result= 31 *result + ipTos;
+    result= 31 *result + (localSocketAutoDetect ? 1 : 0);
+    result= 31 *result +batchChunksInFlight;
+    result= 31 *result +scrollSpillThreshold;
+    result= 31 *result +resultSpillThreshold;
+    result= 31 *result +maxResultSetMemory;
+    result= 31 *result + (streamingReadAhead ? 1 : 0);
+    result= 31 *result + (adaptiveBatchWindow ? 1 : 0);
+    result= 31 *result + (encodeBatchAtAdd ? 1 : 0);
+    result= 31 *result +directWriteThreshold;
+    result= 31 *result + (failoverStandby ? 1 : 0);
+    result= 31 *result +failoverStandbyPingInterval;
+    result= 31 *result +poolKeepAlive;
+    result= 31 *result +tcpKeepIdle;
+    result= 31 *result +tcpKeepInterval;
+    result= 31 *result +tcpUserTimeout;
+    result= 31 *result + (readYourWrites ? 1 : 0);
+    result= 31 *result +readYourWritesTimeout;
+    result= 31 *result + (ignoreNoteWarnings ? 1 : 0);
+    result= 31 *result +maxWarnings;
+    result= 31 *result + (pipelineSavepoints ? 1 : 0);
+    result= 31 *result +incrementalFetchSize;
+    result= 31 *result +defaultFetchBytes;
+    result= 31 *result + (executeDirectLongQueries ? 1 : 0);
+    result= 31 *result + (threadSafeConnection ? 1 : 0);
     result= 31 *result + (useAffectedRows ? 1 : 0);
     result= 31 *result + (maximizeMysqlCompatibility ? 1 : 0);
     result= 31 *result + (useServerPrepStmts ? 1 : 0);
+    result= 31 *result + serverPrepareThreshold;
     result= 31 *result + (continueBatchOnError ? 1 : 0);
     result= 31 *result + (jdbcCompliantTruncation ? 1 : 0);
     result= 31 *result + (cacheCallableStmts ? 1 : 0);
@@ -585,18 +878,28 @@ namespace mariadb
     result= 31 *result + (includeInnodbStatusInDeadlockExceptions ? 1 : 0);
     result= 31 *result + (includeThreadDumpInDeadlockExceptions ? 1 : 0);
     result= 31 *result + (useBulkStmts ? 1 : 0);
+    result= 31 *result + (bulkIsolateErrors ? 1 : 0);
+    result= 31 *result + (useCursorFetch ? 1 : 0);
+    result= 31 *result + (pipelinePrepare ? 1 : 0);
     result= 31 *result + defaultFetchSize;
     result= 31 *result + (disableSslHostnameVerification ? 1 : 0);
     result= 31 *result + (log ? 1 : 0);
     result= 31 *result + (profileSql ? 1 : 0);
     result= 31 *result + maxQuerySizeToLog;
     result= 31 *result + (slowQueryThresholdNanos > 0 ? hash(slowQueryThresholdNanos) : 0);
+    result= 31 *result + (!queryLogFile.empty() ? queryLogFile.hashCode() : 0);
+    result= 31 *result + (!protocolRecordFile.empty() ? protocolRecordFile.hashCode() : 0);
+    result= 31 *result + (!protocolReplayFile.empty() ? protocolReplayFile.hashCode() : 0);
+    result= 31 *result + (!preloadPlugins.empty() ? preloadPlugins.hashCode() : 0);
     result= 31 *result + (assureReadOnly ? 1 : 0);
     result= 31 *result + (autoReconnect ? 1 : 0);
+    result= 31 *result + (retryOnFailover ? 1 : 0);
+    result= 31 *result + (clientQueryTimeout ? 1 : 0);
     result= 31 *result + (failOnReadOnly ? 1 : 0);
     result= 31 *result + (allowMasterDownConnection ? 1 : 0);
     result= 31 *result +retriesAllDown;
     result= 31 *result +validConnectionTimeout;
+    result= 31 *result + validMinDelay;
     result= 31 *result +loadBalanceBlacklistTimeout;
     result= 31 *result +failoverLoopRetries;
     result= 31 *result + (pool ? 1 : 0);
@@ -608,8 +911,17 @@ namespace mariadb
     result= 31 *result + maxPoolSize;
     result= 31 *result + (minPoolSize > 0 ? hash(minPoolSize) : 0);
     result= 31 *result + maxIdleTime;
+    result= 31 *result + maxLifetime;
+    result= 31 *result + idleTrimTime;
+    result= 31 *result + poolPriority;
+    result= 31 *result + (sharedPool ? 1 : 0);
+    result= 31 *result + poolRebalanceRate;
     result= 31 *result + poolValidMinDelay;
+    result= 31 *result + (adaptiveConcurrency ? 1 : 0);
+    result= 31 *result + circuitBreakerThreshold;
+    result= 31 *result + circuitBreakerTimeout;
     result= 31 *result + (autocommit ? 1 : 0);
+    result= 31 *result + (pipelineTransactionEnd ? 1 : 0);
     result= 31 *result + (!credentialType.empty() ? credentialType.hashCode() : 0);
 
     result= 31 *result + (!nonMappedOptions.empty() ? hashProps(nonMappedOptions) : 0);
@@ -33,11 +33,17 @@ namespace mariadb
 
 struct Options
 {
-  static std::map<std::string, ClassField<Options>> Field;
   static ClassField<Options>& getField(const SQLString& field);
   static int32_t MIN_VALUE__MAX_IDLE_TIME;
 
+  /* Copies prototype object, that is initialized with default values only once */
   Options();
+private:
+  /* Sets the default value to each field, looking them up by name */
+  explicit Options(std::map<std::string, ClassField<Options>>& fields);
+  static const Options& defaults();
+  static std::map<std::string, ClassField<Options>>& fields();
+public:
 
   SQLString user;
   SQLString password;
@@ -58,6 +64,8 @@ struct Options
   bool      pinGlobalTxToPhysicalConnection;
   SQLString socketFactory;
   int32_t   connectTimeout= 30000;
+  int32_t   connectAttemptDelay= 0;
+  int32_t   dnsCacheTtl= 0;
   SQLString pipe;
   SQLString localSocket;
   SQLString sharedMemory;
@@ -91,9 +99,46 @@ struct Options
   bool      cachePrepStmts= true;
   int32_t   prepStmtCacheSize= 250;
   int32_t   prepStmtCacheSqlLimit= 2048;
+  int32_t   parsedQueryCacheSize= 1048576;
+  int32_t   metadataCacheTtl= 0;
+  bool      metadataCacheValidation= false;
+  int32_t   blobChunkSize= 0;
+  bool      lazyColumnFetch= false;
+  int32_t   longDataChunkSize= 1048576;
+  bool      longDataReadAhead= false;
+  int32_t   prepStmtCacheResetWarmup= 0;
+  SQLString clientCharacterEncoding;
+  bool      trustServerEncoding= true;
+  bool      tcpQuickAck= false;
+  int32_t   socketBusyPoll= 0;
+  int32_t   ipTos= 0;
+  bool      localSocketAutoDetect= false;
+  int32_t   batchChunksInFlight= 1;
+  int32_t   scrollSpillThreshold= 0;
+  int32_t   resultSpillThreshold= 0;
+  int32_t   maxResultSetMemory= 0;
+  bool      streamingReadAhead= false;
+  bool      adaptiveBatchWindow= false;
+  bool      encodeBatchAtAdd= false;
+  int32_t   directWriteThreshold= 0;
+  bool      failoverStandby= false;
+  int32_t   failoverStandbyPingInterval= 30000;
+  int32_t   poolKeepAlive= 0;
+  int32_t   tcpKeepIdle= 0;
+  int32_t   tcpKeepInterval= 0;
+  int32_t   tcpUserTimeout= 0;
+  bool      readYourWrites= false;
+  int32_t   readYourWritesTimeout= 1000;
+  bool      ignoreNoteWarnings= false;
+  int32_t   maxWarnings= 0;
+  bool      pipelineSavepoints= false;
+  int32_t   incrementalFetchSize= 0;
+  bool      executeDirectLongQueries= true;
+  bool      threadSafeConnection= true;
   bool      useAffectedRows;
   bool      maximizeMysqlCompatibility;
   bool      useServerPrepStmts;
+  int32_t   serverPrepareThreshold= 0;
   bool      continueBatchOnError= true;
   bool      jdbcCompliantTruncation= true;
   bool      cacheCallableStmts= false;
@@ -104,12 +149,17 @@ struct Options
   bool      usePipelineAuth;
   bool      enablePacketDebug;
   bool      useBulkStmts;
+  bool      bulkIsolateErrors= false;
+  bool      useCursorFetch= true;
+  bool      pipelinePrepare;
   bool      disableSslHostnameVerification;
   bool      autocommit= true;
+  bool      pipelineTransactionEnd= false;
   bool      includeInnodbStatusInDeadlockExceptions;
   bool      includeThreadDumpInDeadlockExceptions;
   SQLString servicePrincipalName;
   int32_t   defaultFetchSize;
+  int32_t   defaultFetchBytes= 0;
 
   Properties nonMappedOptions;
 
@@ -117,11 +167,18 @@ struct Options
   bool      profileSql;
   int32_t   maxQuerySizeToLog= 1024;
   int64_t   slowQueryThresholdNanos;
+  SQLString queryLogFile;
+  SQLString protocolRecordFile;
+  SQLString protocolReplayFile;
+  SQLString preloadPlugins;
   bool      assureReadOnly;
   bool      autoReconnect;
+  bool      retryOnFailover= false;
+  bool      clientQueryTimeout= false;
   bool      failOnReadOnly;
   int32_t   retriesAllDown= 120;
   int32_t   validConnectionTimeout;
+  int32_t   validMinDelay= 0;
   int32_t   loadBalanceBlacklistTimeout= 50;
   int32_t   failoverLoopRetries= 120;
   bool      allowMasterDownConnection;
@@ -131,8 +188,16 @@ struct Options
   int32_t   maxPoolSize= 8;
   int32_t   minPoolSize;
   int32_t   maxIdleTime= 600;
+  int32_t   maxLifetime= 0;
+  int32_t   idleTrimTime= 0;
+  int32_t   poolPriority= 0;
+  bool      sharedPool= false;
+  int32_t   poolRebalanceRate= 0;
   bool      staticGlobal;
   int32_t   poolValidMinDelay= 1000;
+  bool      adaptiveConcurrency= false;
+  int32_t   circuitBreakerThreshold= 0;
+  int32_t   circuitBreakerTimeout= 5000;
   bool      useResetConnection;
   bool      useReadAheadInput= true;
   SQLString serverRsaPublicKeyFile;
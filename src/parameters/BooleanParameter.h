@@ -47,6 +47,7 @@ public:
   bool isLongData();
   void* getValuePtr();
   unsigned long getValueBinLen() const { return 1; }
+  void setValue(bool _value) { value= _value; }
   };
 }
 }
@@ -56,7 +56,8 @@ namespace sql
 
   int64_t ByteArrayParameter::getApproximateTextProtocolLength()
   {
-    return bytes.length *2;
+    // _binary and quotes, each byte may be escaped
+    return 10 + bytes.length*2;
   }
 
   /**
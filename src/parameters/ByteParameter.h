@@ -48,6 +48,7 @@ public:
   bool isLongData();
   void* getValuePtr() { return static_cast<void*>(&value); }
   unsigned long getValueBinLen() const { return 1; }
+  void setValue(int8_t _value) { value= _value; }
   };
 }
 }
@@ -73,7 +73,7 @@ namespace mariadb
 
   int64_t DateParameter::getApproximateTextProtocolLength()
   {
-    return 16;
+    return date.length() + 2;
   }
 
   /**
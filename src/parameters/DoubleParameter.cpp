@@ -48,7 +48,8 @@ namespace mariadb
 
   int64_t DoubleParameter::getApproximateTextProtocolLength()
   {
-    return std::to_string(value).length();
+    // Sign, digit, point, 30 digits of the precision and the exponent up to e-324
+    return 38;
   }
 
   /**
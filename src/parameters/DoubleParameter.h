@@ -46,6 +46,7 @@ public:
   bool isLongData();
   void* getValuePtr() { return static_cast<void*>(&value); }
   unsigned long getValueBinLen() const { return sizeof(value); }
+  void setValue(double _value) { value= _value; }
   };
 }
 }
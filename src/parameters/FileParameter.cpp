@@ -0,0 +1,207 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+
+#include <algorithm>
+#include <cerrno>
+
+#ifdef _WIN32
+# include <windows.h>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+#include "FileParameter.h"
+
+#include "util/Utils.h"
+
+namespace sql
+{
+namespace mariadb
+{
+
+  FileParameter::FileParameter(const SQLString& _path, bool _noBackslashEscapes)
+    : path(_path)
+    , noBackslashEscapes(_noBackslashEscapes)
+  {
+#ifdef _WIN32
+    HANDLE file= CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    LARGE_INTEGER size;
+
+    if (file == INVALID_HANDLE_VALUE) {
+      throw SQLException(("Could not open the file " + path).c_str(), "HY000", GetLastError());
+    }
+    if (!GetFileSizeEx(file, &size)) {
+      CloseHandle(file);
+      throw SQLException(("Could not get the size of the file " + path).c_str(), "HY000", GetLastError());
+    }
+    length= size.QuadPart;
+    // Empty file cannot be mapped
+    if (length > 0) {
+      mapping= CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+      if (mapping != NULL) {
+        data= static_cast<char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+      }
+      if (data == nullptr) {
+        DWORD error= GetLastError();
+        if (mapping != NULL) {
+          CloseHandle(mapping);
+        }
+        CloseHandle(file);
+        throw SQLException(("Could not map the file " + path).c_str(), "HY000", error);
+      }
+    }
+    // The mapping keeps the file open
+    CloseHandle(file);
+#else
+    int fd= open(path.c_str(), O_RDONLY);
+    struct stat fileStat;
+
+    if (fd < 0) {
+      throw SQLException(("Could not open the file " + path).c_str(), "HY000", errno);
+    }
+    if (fstat(fd, &fileStat) != 0) {
+      int error= errno;
+      close(fd);
+      throw SQLException(("Could not get the size of the file " + path).c_str(), "HY000", error);
+    }
+    length= static_cast<int64_t>(fileStat.st_size);
+    // Empty file cannot be mapped
+    if (length > 0) {
+      void* mapped= mmap(nullptr, static_cast<std::size_t>(length), PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapped == MAP_FAILED) {
+        int error= errno;
+        close(fd);
+        throw SQLException(("Could not map the file " + path).c_str(), "HY000", error);
+      }
+      data= static_cast<char*>(mapped);
+      // The value is read sequentially, and only once per execution
+      madvise(mapped, static_cast<std::size_t>(length), MADV_SEQUENTIAL);
+    }
+    // The mapping keeps the file open
+    close(fd);
+#endif
+  }
+
+
+  FileParameter::~FileParameter()
+  {
+    if (data != nullptr) {
+#ifdef _WIN32
+      UnmapViewOfFile(data);
+      CloseHandle(mapping);
+#else
+      munmap(data, static_cast<std::size_t>(length));
+#endif
+    }
+  }
+
+
+  void FileParameter::writeTo(SQLString& str)
+  {
+    str.append(BINARY_INTRODUCER);
+    Utils::escapeData(data, static_cast<size_t>(length), noBackslashEscapes, str);
+    str.append(QUOTE);
+  }
+
+  /**
+    * Write file content to database in text format.
+    *
+    * @param pos database outputStream
+    */
+  void FileParameter::writeTo(PacketOutputStream& pos)
+  {
+    int64_t offset= 0;
+
+    pos.write(BINARY_INTRODUCER);
+    while (offset < length) {
+      int32_t chunk= static_cast<int32_t>(std::min<int64_t>(length - offset, INT32_MAX));
+      pos.writeBytesEscaped(data + offset, chunk, noBackslashEscapes);
+      offset+= chunk;
+    }
+    pos.write(QUOTE);
+  }
+
+
+  int64_t FileParameter::getApproximateTextProtocolLength()
+  {
+    // _binary and quotes, each byte may be escaped
+    return 10 + length*2;
+  }
+
+  /**
+    * Write file content to database in binary format.
+    *
+    * @param pos database outputStream
+    */
+  void FileParameter::writeBinary(PacketOutputStream& pos)
+  {
+    int64_t offset= 0;
+
+    pos.writeFieldLength(length);
+    while (offset < length) {
+      int32_t chunk= static_cast<int32_t>(std::min<int64_t>(length - offset, INT32_MAX));
+      pos.write(data + offset, 0, chunk);
+      offset+= chunk;
+    }
+  }
+
+  /* The buffer is not filled, but wraps the next chunk of the mapping */
+  uint32_t FileParameter::writeBinary(sql::bytes& buffer)
+  {
+    uint32_t chunk= static_cast<uint32_t>(std::min<int64_t>(buffer.size(), length - sent));
+
+    if (chunk == 0) {
+      sent= 0;
+      return 0;
+    }
+    buffer.wrap(data + sent, chunk);
+    sent+= chunk;
+    return chunk;
+  }
+
+
+  const ColumnType& FileParameter::getColumnType() const
+  {
+    return ColumnType::BLOB;
+  }
+
+
+  SQLString FileParameter::toString()
+  {
+    return "<File:" + path + ">";
+  }
+
+
+  bool FileParameter::isNullData() const
+  {
+    return false;
+  }
+
+
+  bool FileParameter::isLongData()
+  {
+    return true;
+  }
+}
+}
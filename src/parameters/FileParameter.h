@@ -0,0 +1,68 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+
+#ifndef _FILEPARAMETER_H_
+#define _FILEPARAMETER_H_
+
+#include "Consts.h"
+
+#include "ParameterHolder.h"
+
+namespace sql
+{
+namespace mariadb
+{
+/* BLOB parameter with the content of the file. The file is mapped to the memory, and the long data chunks and the text
+   protocol escaping read it from the mapping, without copying it to the intermediate buffers */
+class FileParameter  : public ParameterHolder {
+
+  const SQLString path;
+  char* data= nullptr;
+  int64_t length= 0;
+#ifdef _WIN32
+  void* mapping= nullptr;
+#endif
+  /* Bytes of the value sent with the chunks of the current execution */
+  int64_t sent= 0;
+  bool noBackslashEscapes;
+
+  FileParameter(const FileParameter&)= delete;
+  FileParameter& operator=(const FileParameter&)= delete;
+
+public:
+  /* Throws SQLException, if the file cannot be opened or mapped */
+  FileParameter(const SQLString& path, bool noBackslashEscapes);
+  ~FileParameter();
+  void writeTo(SQLString& str);
+  void writeTo(PacketOutputStream& str);
+  int64_t getApproximateTextProtocolLength();
+  void writeBinary(PacketOutputStream& pos);
+  uint32_t writeBinary(sql::bytes& buffer);
+  SQLString toString();
+  const ColumnType& getColumnType() const;
+  bool isNullData() const;
+  bool isLongData();
+  void* getValuePtr() { return nullptr; }
+  unsigned long getValueBinLen() const { return 0; }
+  };
+}
+}
+#endif
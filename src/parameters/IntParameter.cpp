@@ -44,7 +44,7 @@ namespace mariadb
 
   int64_t IntParameter::getApproximateTextProtocolLength()
   {
-    return std::to_string(value).length();
+    return decimalLength(static_cast<int64_t>(value));
   }
 
   /**
@@ -47,6 +47,7 @@ public:
   bool isLongData();
   void* getValuePtr() { return static_cast<void*>(&value); }
   unsigned long getValueBinLen() const { return sizeof(value); }
+  void setValue(int32_t _value) { value= _value; }
   };
 }
 }
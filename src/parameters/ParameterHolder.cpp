@@ -30,5 +30,26 @@ namespace mariadb
   ParameterHolder::~ParameterHolder()
   {
   }
+
+
+  int64_t ParameterHolder::decimalLength(uint64_t value)
+  {
+    int64_t length= 1;
+    while (value >= 10) {
+      value/= 10;
+      ++length;
+    }
+    return length;
+  }
+
+
+  int64_t ParameterHolder::decimalLength(int64_t value)
+  {
+    if (value < 0) {
+      // Negating as unsigned, since INT64_MIN cannot be negated
+      return 1 + decimalLength(0 - static_cast<uint64_t>(value));
+    }
+    return decimalLength(static_cast<uint64_t>(value));
+  }
 }
 }
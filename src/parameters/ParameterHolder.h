@@ -23,18 +23,22 @@
 
 #include "io/PacketOutputStream.h"
 #include "ColumnType.h"
+#include "util/DriverAllocator.h"
 
 namespace sql
 {
 namespace mariadb
 {
 
-class ParameterHolder
+class ParameterHolder : public DriverAllocated
 {
 protected:
   static char BINARY_INTRODUCER[];
   static char QUOTE;
   ParameterHolder()= default;
+  /* Number of characters in the decimal representation of the value, including the sign */
+  static int64_t decimalLength(int64_t value);
+  static int64_t decimalLength(uint64_t value);
 public:
   virtual ~ParameterHolder();
 
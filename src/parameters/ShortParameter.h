@@ -46,6 +46,7 @@ public:
   bool isLongData();
   void* getValuePtr() { return static_cast<void*>(&value); }
   virtual unsigned long getValueBinLen() const { return 2; }
+  void setValue(int16_t _value) { value= _value; }
   };
 }
 }
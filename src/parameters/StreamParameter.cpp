@@ -18,6 +18,7 @@
 *************************************************************************************/
 
 
+#include <algorithm>
 #include <istream>
 
 #include "StreamParameter.h"
@@ -82,14 +83,17 @@ namespace mariadb
 
   uint32_t StreamParameter::writeBinary(sql::bytes &buffer)
   {
-    std::size_t readMax= buffer.size(), readTotal= static_cast<uint32_t>(length);
+    std::streamsize readMax= static_cast<std::streamsize>(std::min<int64_t>(buffer.size(), length - sent));
+    uint32_t readCount= readMax > 0 ? static_cast<uint32_t>(is.read(buffer, readMax).gcount()) : 0;
 
-    if (readMax > readTotal)
-    {
-      readMax= readTotal;
+    // The length limits the whole value, and not each chunk. After the last chunk the next execution starts anew
+    if (readCount == 0) {
+      sent= 0;
     }
-
-    return static_cast<uint32_t>(is.read(buffer, readMax).gcount());
+    else {
+      sent+= readCount;
+    }
+    return readCount;
   }
 
   /**
@@ -33,6 +33,8 @@ class StreamParameter  : public ParameterHolder {
 
   std::istream& is;
   const int64_t length;
+  /* Bytes of the value sent with the chunks of the current execution */
+  int64_t sent= 0;
   bool noBackslashEscapes;
 
 public:
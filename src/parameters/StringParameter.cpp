@@ -54,7 +54,8 @@ namespace mariadb
 
   int64_t StringParameter::getApproximateTextProtocolLength()
   {
-    return stringValue.size()*3;
+    // Each character may be escaped, plus quotes
+    return stringValue.size()*2 + 2;
   }
 
   /**
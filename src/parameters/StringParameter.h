@@ -31,7 +31,7 @@ namespace mariadb
 {
 class StringParameter  : public ParameterHolder {
 
-  const SQLString stringValue;
+  SQLString stringValue;
   bool noBackslashEscapes;
 
 public:
@@ -47,6 +47,7 @@ public:
   bool isLongData();
   void* getValuePtr() { return const_cast<void*>(static_cast<const void*>(stringValue.c_str())); }
   unsigned long getValueBinLen() const { return static_cast<unsigned long>(stringValue.length()); }
+  void setValue(const SQLString& str) { stringValue= str; }
   };
 }
 }
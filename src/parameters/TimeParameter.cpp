@@ -78,7 +78,7 @@ namespace mariadb
 
   int64_t TimeParameter::getApproximateTextProtocolLength()
   {
-    return 15;
+    return time.length() + 2;
   }
 
   /**
@@ -77,7 +77,7 @@ namespace mariadb
 
   int64_t TimestampParameter::getApproximateTextProtocolLength()
   {
-    return 27;
+    return ts.length() + 2;
   }
 
   /**
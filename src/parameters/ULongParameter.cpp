@@ -44,7 +44,7 @@ namespace mariadb
 
   int64_t ULongParameter::getApproximateTextProtocolLength()
   {
-    return std::to_string(value).length();
+    return decimalLength(static_cast<uint64_t>(value));
   }
 
   /**
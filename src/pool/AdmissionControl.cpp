@@ -0,0 +1,232 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+
+#include <algorithm>
+
+#include "AdmissionControl.h"
+#include "options/Options.h"
+
+namespace sql
+{
+namespace mariadb
+{
+  constexpr double AdmissionControl::SHORT_ALPHA;
+  constexpr double AdmissionControl::LONG_ALPHA;
+  constexpr double AdmissionControl::LATENCY_TOLERANCE;
+  constexpr double AdmissionControl::BACKOFF;
+
+
+  AdmissionControl::AdmissionControl(const Shared::Options& options, const std::vector<HostAddress>& hostAddresses)
+    : limitConcurrency(options->adaptiveConcurrency)
+    , maxLimit(static_cast<double>(options->maxPoolSize))
+    , limit(maxLimit)
+    , breakerThreshold(options->circuitBreakerThreshold)
+    , breakerTimeout(options->circuitBreakerTimeout)
+  {
+    for (auto& host : hostAddresses) {
+      hosts.push_back(key(host));
+    }
+  }
+
+
+  bool AdmissionControl::isEnabled(const Shared::Options& options)
+  {
+    return options->adaptiveConcurrency || options->circuitBreakerThreshold > 0;
+  }
+
+
+  std::string AdmissionControl::key(const HostAddress& host)
+  {
+    std::string result(StringImp::get(host.host));
+    result.append(":").append(std::to_string(host.port));
+    return result;
+  }
+
+
+  bool AdmissionControl::admit()
+  {
+    if (breakerThreshold <= 0) {
+      return true;
+    }
+    auto now= std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> localScopeLock(lock);
+
+    for (auto& host : hosts) {
+      auto it= breakers.find(host);
+      if (it == breakers.end() || !it->second.open) {
+        return true;
+      }
+    }
+    for (auto& host : hosts) {
+      Breaker& breaker= breakers[host];
+      if (breaker.retryAt <= now) {
+        // Half-open - the next trial is not before another timeout, whatever the outcome of this one is
+        breaker.retryAt= now + breakerTimeout;
+        return true;
+      }
+    }
+    return false;
+  }
+
+
+  bool AdmissionControl::acquire(const std::chrono::steady_clock::time_point& deadline, int32_t priority)
+  {
+    if (!limitConcurrency) {
+      return true;
+    }
+    std::unique_lock<std::mutex> localScopeLock(lock);
+
+    // Waiters of the same priority came first
+    if (inFlight < static_cast<int32_t>(limit)
+      && (waitingByPriority.empty() || waitingByPriority.begin()->first < priority)) {
+      ++inFlight;
+      return true;
+    }
+    if (closed || waiting >= static_cast<int32_t>(limit)) {
+      return false;
+    }
+    ++waiting;
+    ++waitingByPriority[priority];
+    bool permitted= permitAvailable.wait_until(localScopeLock, deadline, [this, priority]() {
+        return closed || (inFlight < static_cast<int32_t>(limit) && waitingByPriority.begin()->first <= priority);
+      }) && !closed;
+    --waiting;
+    if (--waitingByPriority[priority] == 0) {
+      waitingByPriority.erase(priority);
+      // Requests of lower priorities may go now
+      permitAvailable.notify_all();
+    }
+
+    if (permitted) {
+      ++inFlight;
+    }
+    return permitted;
+  }
+
+
+  void AdmissionControl::release(std::chrono::microseconds holdTime, bool failed)
+  {
+    if (!limitConcurrency) {
+      return;
+    }
+    auto now= std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    const bool saturated= inFlight >= static_cast<int32_t>(limit);
+    double sample= static_cast<double>(holdTime.count());
+
+    --inFlight;
+    if (longLatency == 0) {
+      shortLatency= longLatency= sample;
+    }
+    else {
+      shortLatency+= SHORT_ALPHA*(sample - shortLatency);
+      longLatency+= LONG_ALPHA*(sample - longLatency);
+    }
+
+    if (failed || shortLatency > longLatency*LATENCY_TOLERANCE) {
+      if (now - lastBackoff > std::chrono::microseconds(static_cast<int64_t>(shortLatency))) {
+        limit= std::max(1.0, limit*BACKOFF);
+        lastBackoff= now;
+      }
+    }
+    else if (saturated) {
+      limit= std::min(maxLimit, limit + 1.0/limit);
+    }
+    // Only the waiters of the highest priority can take the permit, and notify_one could pick another one
+    permitAvailable.notify_all();
+  }
+
+
+  void AdmissionControl::abandon()
+  {
+    if (!limitConcurrency) {
+      return;
+    }
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    --inFlight;
+    permitAvailable.notify_all();
+  }
+
+
+  void AdmissionControl::recordFailure(const std::string& host, const std::chrono::steady_clock::time_point& now)
+  {
+    Breaker& breaker= breakers[host];
+    if (++breaker.failures >= breakerThreshold && !breaker.open) {
+      breaker.open= true;
+      breaker.retryAt= now + breakerTimeout;
+    }
+  }
+
+
+  void AdmissionControl::onSuccess(const HostAddress& host)
+  {
+    if (breakerThreshold <= 0) {
+      return;
+    }
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    auto it= breakers.find(key(host));
+    if (it != breakers.end()) {
+      it->second.failures= 0;
+      it->second.open= false;
+    }
+  }
+
+
+  void AdmissionControl::onFailure(const HostAddress& host)
+  {
+    if (breakerThreshold <= 0) {
+      return;
+    }
+    auto now= std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    recordFailure(key(host), now);
+  }
+
+
+  void AdmissionControl::onFailure()
+  {
+    if (breakerThreshold <= 0) {
+      return;
+    }
+    auto now= std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    for (auto& host : hosts) {
+      recordFailure(host, now);
+    }
+  }
+
+
+  void AdmissionControl::close()
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    closed= true;
+    permitAvailable.notify_all();
+  }
+
+
+  int32_t AdmissionControl::getLimit()
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    return static_cast<int32_t>(limit);
+  }
+
+}
+}
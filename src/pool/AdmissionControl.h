@@ -0,0 +1,112 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _ADMISSIONCONTROL_H_
+#define _ADMISSIONCONTROL_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Consts.h"
+#include "HostAddress.h"
+
+namespace sql
+{
+namespace mariadb
+{
+
+/* Pool's admission control. Adaptive concurrency limit(adaptiveConcurrency option) is AIMD driven by the time
+   connections are held by the application - the limit grows by 1/limit per released connection while the pool is
+   saturated, and is cut by BACKOFF, if the short term average of the hold time exceeds the long term one
+   LATENCY_TOLERANCE times, or a connection breaks. The limit is cut at most once per short term average hold time, so
+   one episode of slowness is not punished for every connection released in it. The waiting queue is as long as
+   the limit, requests beyond that are shed right away. A waiting request gets the permit only when no request of
+   a higher priority is waiting.
+   Circuit breaker(circuitBreakerThreshold option) counts consecutive failures per host. When the threshold is
+   reached, the circuit opens, and while all hosts of the url have open circuits, requests fail without touching the
+   network. Once circuitBreakerTimeout has passed, one request is let through to try again(half-open state) */
+class AdmissionControl final
+{
+  static constexpr double SHORT_ALPHA= 0.2;
+  static constexpr double LONG_ALPHA= 0.01;
+  static constexpr double LATENCY_TOLERANCE= 2.0;
+  static constexpr double BACKOFF= 0.9;
+
+  struct Breaker
+  {
+    int32_t failures= 0;
+    bool open= false;
+    std::chrono::steady_clock::time_point retryAt;
+  };
+
+  std::mutex lock;
+  std::condition_variable permitAvailable;
+  bool closed= false;
+
+  const bool limitConcurrency;
+  const double maxLimit;
+  double limit;
+  int32_t inFlight= 0;
+  int32_t waiting= 0;
+  /* Number of waiting requests by priority, the highest first */
+  std::map<int32_t, int32_t, std::greater<int32_t>> waitingByPriority;
+  /* Hold time averages, in microseconds */
+  double shortLatency= 0;
+  double longLatency= 0;
+  std::chrono::steady_clock::time_point lastBackoff;
+
+  const int32_t breakerThreshold;
+  const std::chrono::milliseconds breakerTimeout;
+  std::vector<std::string> hosts;
+  std::unordered_map<std::string, Breaker> breakers;
+
+  static std::string key(const HostAddress& host);
+  void recordFailure(const std::string& host, const std::chrono::steady_clock::time_point& now);
+
+public:
+  AdmissionControl(const Shared::Options& options, const std::vector<HostAddress>& hostAddresses);
+
+  static bool isEnabled(const Shared::Options& options);
+  /* False, if circuits of all hosts are open. If the circuit's open time is over, lets one request through */
+  bool admit();
+  /* Takes a permit, waiting for it until the deadline. Returns false, if the request was shed, or timed out */
+  bool acquire(const std::chrono::steady_clock::time_point& deadline, int32_t priority= 0);
+  /* Returns the permit. holdTime and failed are the feedback for the limit adaptation */
+  void release(std::chrono::microseconds holdTime, bool failed);
+  /* Returns the permit of the request, that did not get a connection */
+  void abandon();
+  void onSuccess(const HostAddress& host);
+  void onFailure(const HostAddress& host);
+  /* Failure to connect to any host of the url */
+  void onFailure();
+  /* Wakes up and fails all waiters */
+  void close();
+
+  int32_t getLimit();
+};
+
+}
+}
+#endif
@@ -0,0 +1,400 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#include "MariaDbProxyConnection.h"
+#include "Pool.h"
+
+namespace sql
+{
+namespace mariadb
+{
+
+  MariaDbProxyConnection::MariaDbProxyConnection(Shared::Pool _pool, std::unique_ptr<MariaDbPooledConnection>& _pooledConnection)
+    : pool(_pool)
+    , pooledConnection(std::move(_pooledConnection))
+    , broken(false)
+  {
+    pooledConnection->addConnectionEventListener(*this);
+  }
+
+
+  MariaDbProxyConnection::~MariaDbProxyConnection()
+  {
+    try {
+      close();
+    }
+    catch (SQLException&) {
+    }
+  }
+
+
+  MariaDbConnection* MariaDbProxyConnection::getPhysical()
+  {
+    if (!pooledConnection) {
+      throw SQLException("Connection is closed", "08000");
+    }
+    return pooledConnection->getConnection();
+  }
+
+  /* Physical connection has been closed directly - it's the same as if the application closed this object */
+  void MariaDbProxyConnection::connectionClosed(MariaDbPooledConnection& /*pooledConnection*/)
+  {
+    close();
+  }
+
+  /* The physical connection is not reusable, it's discarded when returned to the pool */
+  void MariaDbProxyConnection::connectionErrorOccurred(MariaDbPooledConnection& /*pooledConnection*/, SQLException& /*ex*/)
+  {
+    broken= true;
+  }
+
+  /* Gives the physical connection back to the pool. Subsequent calls on the object, other than close(), throw */
+  void MariaDbProxyConnection::close()
+  {
+    if (pooledConnection) {
+      pooledConnection->removeConnectionEventListener(*this);
+      pool->releaseConnection(pooledConnection, broken);
+      pooledConnection.reset();
+    }
+  }
+
+
+  bool MariaDbProxyConnection::isClosed()
+  {
+    return !pooledConnection || pooledConnection->getConnection()->isClosed();
+  }
+
+
+  Statement* MariaDbProxyConnection::createStatement()
+  {
+    return getPhysical()->createStatement();
+  }
+
+
+  Pipeline* MariaDbProxyConnection::createPipeline()
+  {
+    return getPhysical()->createPipeline();
+  }
+
+
+  int64_t MariaDbProxyConnection::bulkLoad(const SQLString& table, const SQLString* columns, std::size_t columnCount,
+    RowProducer& producer)
+  {
+    return getPhysical()->bulkLoad(table, columns, columnCount, producer);
+  }
+
+
+  SequenceAllocator* MariaDbProxyConnection::getSequenceAllocator(const SQLString& sequence, int64_t blockSize)
+  {
+    return getPhysical()->getSequenceAllocator(sequence, blockSize);
+  }
+
+
+  ConnectionMetrics MariaDbProxyConnection::getMetrics()
+  {
+    return getPhysical()->getMetrics();
+  }
+
+  Statement* MariaDbProxyConnection::createStatement(int32_t resultSetType, int32_t resultSetConcurrency)
+  {
+    return getPhysical()->createStatement(resultSetType, resultSetConcurrency);
+  }
+
+  Statement* MariaDbProxyConnection::createStatement(int32_t resultSetType, int32_t resultSetConcurrency, int32_t resultSetHoldability)
+  {
+    return getPhysical()->createStatement(resultSetType, resultSetConcurrency, resultSetHoldability);
+  }
+
+  PreparedStatement* MariaDbProxyConnection::prepareStatement(const SQLString& sql)
+  {
+    return getPhysical()->prepareStatement(sql);
+  }
+
+  PreparedStatement* MariaDbProxyConnection::prepareStatement(const SQLString& sql, int32_t resultSetType, int32_t resultSetConcurrency)
+  {
+    return getPhysical()->prepareStatement(sql, resultSetType, resultSetConcurrency);
+  }
+
+  PreparedStatement* MariaDbProxyConnection::prepareStatement(const SQLString& sql, int32_t resultSetType, int32_t resultSetConcurrency, int32_t resultSetHoldability)
+  {
+    return getPhysical()->prepareStatement(sql, resultSetType, resultSetConcurrency, resultSetHoldability);
+  }
+
+  PreparedStatement* MariaDbProxyConnection::prepareStatement(const SQLString& sql, int32_t autoGeneratedKeys)
+  {
+    return getPhysical()->prepareStatement(sql, autoGeneratedKeys);
+  }
+
+  PreparedStatement* MariaDbProxyConnection::prepareStatement(const SQLString& sql, int32_t* columnIndexes)
+  {
+    return getPhysical()->prepareStatement(sql, columnIndexes);
+  }
+
+  PreparedStatement* MariaDbProxyConnection::prepareStatement(const SQLString& sql, const SQLString* columnNames)
+  {
+    return getPhysical()->prepareStatement(sql, columnNames);
+  }
+
+  CallableStatement* MariaDbProxyConnection::prepareCall(const SQLString& sql)
+  {
+    return getPhysical()->prepareCall(sql);
+  }
+
+  CallableStatement* MariaDbProxyConnection::prepareCall(const SQLString& sql, int32_t resultSetType, int32_t resultSetConcurrency)
+  {
+    return getPhysical()->prepareCall(sql, resultSetType, resultSetConcurrency);
+  }
+
+  CallableStatement* MariaDbProxyConnection::prepareCall(const SQLString& sql, int32_t resultSetType, int32_t resultSetConcurrency, int32_t resultSetHoldability)
+  {
+    return getPhysical()->prepareCall(sql, resultSetType, resultSetConcurrency, resultSetHoldability);
+  }
+
+  SQLString MariaDbProxyConnection::nativeSQL(const SQLString& sql)
+  {
+    return getPhysical()->nativeSQL(sql);
+  }
+
+  bool MariaDbProxyConnection::getAutoCommit()
+  {
+    return getPhysical()->getAutoCommit();
+  }
+
+  void MariaDbProxyConnection::setAutoCommit(bool autoCommit)
+  {
+    getPhysical()->setAutoCommit(autoCommit);
+  }
+
+  void MariaDbProxyConnection::commit()
+  {
+    getPhysical()->commit();
+  }
+
+  void MariaDbProxyConnection::rollback()
+  {
+    getPhysical()->rollback();
+  }
+
+  void MariaDbProxyConnection::rollback(const Savepoint* savepoint)
+  {
+    getPhysical()->rollback(savepoint);
+  }
+
+  DatabaseMetaData* MariaDbProxyConnection::getMetaData()
+  {
+    return getPhysical()->getMetaData();
+  }
+
+  bool MariaDbProxyConnection::isReadOnly()
+  {
+    return getPhysical()->isReadOnly();
+  }
+
+  void MariaDbProxyConnection::setReadOnly(bool readOnly)
+  {
+    getPhysical()->setReadOnly(readOnly);
+  }
+
+  SQLString MariaDbProxyConnection::getCatalog()
+  {
+    return getPhysical()->getCatalog();
+  }
+
+  void MariaDbProxyConnection::setCatalog(const SQLString& catalog)
+  {
+    getPhysical()->setCatalog(catalog);
+  }
+
+  int32_t MariaDbProxyConnection::getTransactionIsolation()
+  {
+    return getPhysical()->getTransactionIsolation();
+  }
+
+  void MariaDbProxyConnection::setTransactionIsolation(int32_t level)
+  {
+    getPhysical()->setTransactionIsolation(level);
+  }
+
+  SQLWarning* MariaDbProxyConnection::getWarnings()
+  {
+    return getPhysical()->getWarnings();
+  }
+
+  void MariaDbProxyConnection::clearWarnings()
+  {
+    getPhysical()->clearWarnings();
+  }
+
+  int32_t MariaDbProxyConnection::getHoldability()
+  {
+    return getPhysical()->getHoldability();
+  }
+
+  void MariaDbProxyConnection::setHoldability(int32_t holdability)
+  {
+    getPhysical()->setHoldability(holdability);
+  }
+
+  Savepoint* MariaDbProxyConnection::setSavepoint()
+  {
+    return getPhysical()->setSavepoint();
+  }
+
+  Savepoint* MariaDbProxyConnection::setSavepoint(const SQLString& name)
+  {
+    return getPhysical()->setSavepoint(name);
+  }
+
+  void MariaDbProxyConnection::releaseSavepoint(const Savepoint* savepoint)
+  {
+    getPhysical()->releaseSavepoint(savepoint);
+  }
+
+  bool MariaDbProxyConnection::isValid(int32_t timeout)
+  {
+    return getPhysical()->isValid(timeout);
+  }
+
+  bool MariaDbProxyConnection::isValid()
+  {
+    return getPhysical()->isValid();
+  }
+
+  void MariaDbProxyConnection::setClientInfo(const SQLString& name, const SQLString& value)
+  {
+    getPhysical()->setClientInfo(name, value);
+  }
+
+  void MariaDbProxyConnection::setClientInfo(const Properties& properties)
+  {
+    getPhysical()->setClientInfo(properties);
+  }
+
+  Properties MariaDbProxyConnection::getClientInfo()
+  {
+    return getPhysical()->getClientInfo();
+  }
+
+  SQLString MariaDbProxyConnection::getClientInfo(const SQLString& name)
+  {
+    return getPhysical()->getClientInfo(name);
+  }
+
+  SQLString MariaDbProxyConnection::getUsername()
+  {
+    return getPhysical()->getUsername();
+  }
+
+  SQLString MariaDbProxyConnection::getHostname()
+  {
+    return getPhysical()->getHostname();
+  }
+
+  int32_t MariaDbProxyConnection::getNetworkTimeout()
+  {
+    return getPhysical()->getNetworkTimeout();
+  }
+
+  SQLString MariaDbProxyConnection::getSchema()
+  {
+    return getPhysical()->getSchema();
+  }
+
+  void MariaDbProxyConnection::setSchema(const SQLString& arg0)
+  {
+    getPhysical()->setSchema(arg0);
+  }
+
+  void MariaDbProxyConnection::reset()
+  {
+    getPhysical()->reset();
+  }
+
+  bool MariaDbProxyConnection::reconnect()
+  {
+    return getPhysical()->reconnect();
+  }
+
+  Connection* MariaDbProxyConnection::setClientOption(const SQLString& name, void* value)
+  {
+    getPhysical()->setClientOption(name, value);
+    return this;
+  }
+
+  Connection* MariaDbProxyConnection::setClientOption(const SQLString& name, const SQLString& value)
+  {
+    getPhysical()->setClientOption(name, value);
+    return this;
+  }
+
+  void MariaDbProxyConnection::getClientOption(const SQLString& n, void* v)
+  {
+    getPhysical()->getClientOption(n, v);
+  }
+
+  SQLString MariaDbProxyConnection::getClientOption(const SQLString& n)
+  {
+    return getPhysical()->getClientOption(n);
+  }
+
+  Clob* MariaDbProxyConnection::createClob()
+  {
+    return getPhysical()->createClob();
+  }
+
+  Blob* MariaDbProxyConnection::createBlob()
+  {
+    return getPhysical()->createBlob();
+  }
+
+  NClob* MariaDbProxyConnection::createNClob()
+  {
+    return getPhysical()->createNClob();
+  }
+
+  SQLXML* MariaDbProxyConnection::createSQLXML()
+  {
+    return getPhysical()->createSQLXML();
+  }
+
+#ifdef JDBC_SPECIFIC_TYPES_IMPLEMENTED
+  sql::Array* MariaDbProxyConnection::createArrayOf(const SQLString& typeName, const sql::Object* elements)
+  {
+    return getPhysical()->createArrayOf(typeName, elements);
+  }
+
+  sql::Struct* MariaDbProxyConnection::createStruct(const SQLString& typeName, const sql::Object* attributes)
+  {
+    return getPhysical()->createStruct(typeName, attributes);
+  }
+
+  void MariaDbProxyConnection::abort(sql::Executor* executor)
+  {
+    getPhysical()->abort(executor);
+  }
+
+  void MariaDbProxyConnection::setNetworkTimeout(Executor* executor, int32_t milliseconds)
+  {
+    getPhysical()->setNetworkTimeout(executor, milliseconds);
+  }
+#endif
+}
+}
+
@@ -0,0 +1,129 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _MARIADBPROXYCONNECTION_H_
+#define _MARIADBPROXYCONNECTION_H_
+
+#include "Consts.h"
+
+#include "MariaDbPooledConnection.h"
+
+namespace sql
+{
+namespace mariadb
+{
+
+/* Connection object the application gets from the pool. It forwards all calls to the physical connection, and
+   instead of closing it, gives it back to the pool on close() or destruction */
+class MariaDbProxyConnection final : public Connection, public ConnectionEventListener
+{
+  Shared::Pool pool;
+  std::unique_ptr<MariaDbPooledConnection> pooledConnection;
+  bool broken;
+
+  MariaDbProxyConnection(const MariaDbProxyConnection&)= delete;
+  MariaDbConnection* getPhysical();
+
+public:
+  MariaDbProxyConnection(Shared::Pool _pool, std::unique_ptr<MariaDbPooledConnection>& _pooledConnection);
+  ~MariaDbProxyConnection();
+
+  void connectionClosed(MariaDbPooledConnection& pooledConnection);
+  void connectionErrorOccurred(MariaDbPooledConnection& pooledConnection, SQLException& ex);
+
+  Statement* createStatement();
+  Pipeline* createPipeline();
+  int64_t bulkLoad(const SQLString& table, const SQLString* columns, std::size_t columnCount, RowProducer& producer);
+  ConnectionMetrics getMetrics();
+  SequenceAllocator* getSequenceAllocator(const SQLString& sequence, int64_t blockSize);
+  Statement* createStatement(int32_t resultSetType, int32_t resultSetConcurrency);
+  Statement* createStatement(int32_t resultSetType, int32_t resultSetConcurrency, int32_t resultSetHoldability);
+  PreparedStatement* prepareStatement(const SQLString& sql);
+  PreparedStatement* prepareStatement(const SQLString& sql, int32_t resultSetType, int32_t resultSetConcurrency);
+  PreparedStatement* prepareStatement(const SQLString& sql, int32_t resultSetType, int32_t resultSetConcurrency,
+                                      int32_t resultSetHoldability);
+  PreparedStatement* prepareStatement(const SQLString& sql, int32_t autoGeneratedKeys);
+  PreparedStatement* prepareStatement(const SQLString& sql, int32_t* columnIndexes);
+  PreparedStatement* prepareStatement(const SQLString& sql, const SQLString* columnNames);
+  CallableStatement* prepareCall(const SQLString& sql);
+  CallableStatement* prepareCall(const SQLString& sql, int32_t resultSetType, int32_t resultSetConcurrency);
+  CallableStatement* prepareCall(const SQLString& sql, int32_t resultSetType, int32_t resultSetConcurrency,
+                                 int32_t resultSetHoldability);
+  SQLString nativeSQL(const SQLString& sql);
+  bool getAutoCommit();
+  void setAutoCommit(bool autoCommit);
+  void commit();
+  void rollback();
+  void rollback(const Savepoint* savepoint);
+  void close();
+  bool isClosed();
+  DatabaseMetaData* getMetaData();
+  bool isReadOnly();
+  void setReadOnly(bool readOnly);
+  SQLString getCatalog();
+  void setCatalog(const SQLString& catalog);
+  int32_t getTransactionIsolation();
+  void setTransactionIsolation(int32_t level);
+  SQLWarning* getWarnings();
+  void clearWarnings();
+  int32_t getHoldability();
+  void setHoldability(int32_t holdability);
+  Savepoint* setSavepoint();
+  Savepoint* setSavepoint(const SQLString& name);
+  void releaseSavepoint(const Savepoint* savepoint);
+
+  bool isValid(int32_t timeout);
+  bool isValid();
+
+  void setClientInfo(const SQLString& name, const SQLString& value);
+  void setClientInfo(const Properties& properties);
+  Properties getClientInfo();
+  SQLString getClientInfo(const SQLString& name);
+
+  SQLString getUsername();
+  SQLString getHostname();
+
+  int32_t getNetworkTimeout();
+  SQLString getSchema();
+  void setSchema(const SQLString& arg0);
+  void reset();
+
+  bool reconnect();
+
+  Connection* setClientOption(const SQLString& name, void* value);
+  Connection* setClientOption(const SQLString& name, const SQLString& value);
+  void getClientOption(const SQLString& n, void* v);
+  SQLString getClientOption(const SQLString& n);
+
+  Clob* createClob();
+  Blob* createBlob();
+  NClob* createNClob();
+  SQLXML* createSQLXML();
+#ifdef JDBC_SPECIFIC_TYPES_IMPLEMENTED
+  sql::Array* createArrayOf(const SQLString& typeName, const sql::Object* elements);
+  sql::Struct* createStruct(const SQLString& typeName, const sql::Object* attributes);
+  void abort(sql::Executor* executor);
+  void setNetworkTimeout(Executor* executor, int32_t milliseconds);
+#endif
+};
+
+}
+}
+#endif
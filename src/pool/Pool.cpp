@@ -1,5 +1,5 @@
 /************************************************************************************
-   Copyright (C) 2020 MariaDB Corporation AB
+   Copyright (C) 2020,2023 MariaDB Corporation AB
 
    This library is free software; you can redistribute it and/or
    modify it under the terms of the GNU Library General Public
@@ -18,600 +18,1070 @@
 *************************************************************************************/
 
 
+#include <chrono>
+#include <algorithm>
+
 #include "Pool.h"
+#include "Pools.h"
+#include "HostHealthRegistry.h"
+#include "MariaDbProxyConnection.h"
+#include "SqlStates.h"
+#include "logger/LoggerFactory.h"
+#include "util/DnsCache.h"
+#include "util/Probes.h"
+#include "util/Utils.h"
 
 namespace sql
 {
 namespace mariadb
 {
-  const Shared::Logger logger= LoggerFactory::getLogger(typeid(Pool));
-  int32_t Pool::POOL_STATE_OK= 0;
-  int32_t Pool::POOL_STATE_CLOSING= 1;
+  const Shared::Logger Pool::logger= LoggerFactory::getLogger(typeid(Pool));
+
+  static int64_t nanoTime()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+  }
+
+
+  static std::string hostKeyOf(const HostAddress& host)
+  {
+    std::string key(StringImp::get(host.host));
+    return key.append(1, ':').append(std::to_string(host.port));
+  }
+
+
+  static SQLString tenantKey(const SQLString& user, const SQLString& password)
+  {
+    SQLString key(user);
+    StringImp::get(key).append(1, '\0').append(StringImp::get(password));
+    return key;
+  }
+
+
+  PoolRequest::PoolRequest(UrlParser& urlParser)
+    : priority(urlParser.getOptions()->poolPriority)
+  {
+    if (urlParser.getOptions()->sharedPool) {
+      user= urlParser.getUsername();
+      password= urlParser.getPassword();
+      database= urlParser.getDatabase();
+    }
+  }
+
+
+  SQLString PoolRequest::tenant() const
+  {
+    return tenantKey(user, password);
+  }
 
   /**
     * Create pool from configuration.
     *
     * @param urlParser configuration parser
     * @param poolIndex pool index to permit distinction of thread name
-    * @param poolExecutor pools common executor
     */
-  Pool::Pool(UrlParser &urlParser, int32_t poolIndex, ScheduledThreadPoolExecutor& poolExecutor) :
-    urlParser(urlParser),
-    options(urlParser.getOptions()),
-    maxIdleTime(options->maxIdleTime)
-  {
-    poolTag= generatePoolTag(poolIndex);
-
-    connectionAppenderQueue= new ArrayBlockingQueue<>(options->maxPoolSize);
-    connectionAppender =
-      new ThreadPoolExecutor(
-        1,
-        1,
-        10,
-        TimeUnit::SECONDS,
-        connectionAppenderQueue,
-        new MariaDbThreadFactory(poolTag +"-appender"));
-    connectionAppender.allowCoreThreadTimeOut(true);
-
-    connectionAppender.prestartCoreThread();
-
-    idleConnections= new LinkedBlockingDeque<>();
-
-    int32_t scheduleDelay= Math.min(30, maxIdleTime 2);
-    this->poolExecutor= poolExecutor;
-    scheduledFuture =
-      poolExecutor.scheduleAtFixedRate(
-        this::removeIdleTimeoutConnection, scheduleDelay, scheduleDelay, TimeUnit.SECONDS);
-
-    try
-    {
-      for (int32_t i= 0; i <options->minPoolSize; i++) {
-        addConnection();
-      }
-    }
-    catch (Exception& ex) {
-      logger.error("error initializing pool connection", sqle);
+  Pool::Pool(std::shared_ptr<UrlParser>& _urlParser, int32_t poolIndex)
+    : poolState(POOL_STATE_OK)
+    , urlParser(_urlParser)
+    , options(_urlParser->getOptions())
+    , pendingRequestNumber(0)
+    , totalConnection(0)
+    , waiters(0)
+    , shardCount(std::max(1U, std::min(std::thread::hardware_concurrency(), static_cast<uint32_t>(options->maxPoolSize))))
+    , shards(new IdleShard[shardCount])
+    , poolTag(generatePoolTag(poolIndex))
+    , maxIdleTime(options->maxIdleTime)
+    , waitTimeout(0)
+    , rnd(std::random_device{}())
+    , retireRequested(false)
+  {
+    if (AdmissionControl::isEnabled(options)) {
+      admission.reset(new AdmissionControl(options, urlParser->getHostAddresses()));
     }
+    MetricsRegistry::getInstance().attach(&metrics, StringImp::get(poolTag));
+    houseKeeper= std::thread(&Pool::houseKeeping, this);
+  }
+
+
+  Pool::~Pool()
+  {
+    close();
+    MetricsRegistry::getInstance().detach(&metrics);
   }
 
   /**
-    * Add new connection if needed. Only one thread create new connection, so new connection request
-    * will wait to newly created connection or for a released connection.
+    * Pool's thread. Fills the pool up to minPoolSize, and then periodically removes connections, that have been idle
+    * for too long, pings idle connections with poolKeepAlive, replaces connections older than maxLifetime, moves
+    * connections between hosts, and recreates connections to keep minPoolSize.
     */
-  void Pool::addConnectionRequest()
+  void Pool::houseKeeping()
   {
-    if (totalConnection.get() < options->maxPoolSize && poolState.get() == POOL_STATE_OK)
-    {
-      connectionAppender.prestartCoreThread();
-      connectionAppenderQueue.offer(
-        ()->{
-        if ((totalConnection.get()<options->minPoolSize ||pendingRequestNumber.get()>0)
-          &&totalConnection.get()<options->maxPoolSize) {
-          try {
-            addConnection();
-          }
-          catch (SQLException&)
-          {
-          }
+    int32_t delay= std::max(1, std::min(30, maxIdleTime / 2));
+    if (options->maxLifetime > 0) {
+      delay= std::max(1, std::min(delay, options->maxLifetime / 10));
+    }
+    if (options->idleTrimTime > 0) {
+      delay= std::max(1, std::min(delay, options->idleTrimTime / 2));
+    }
+    if (options->poolKeepAlive > 0) {
+      delay= std::max(1, std::min(delay, options->poolKeepAlive / 10));
+    }
+    const std::chrono::seconds scheduleDelay(delay);
+
+    // The pool's connections will need the addresses of all its hosts, e.g. after a failover
+    if (options->dnsCacheTtl > 0 && !options->useTls) {
+      std::vector<SQLString> hosts;
+      for (auto& host : urlParser->getHostAddresses()) {
+        hosts.push_back(host.host);
+      }
+      DnsCache::getInstance().prefetch(hosts, std::chrono::milliseconds(options->dnsCacheTtl));
+    }
+
+    while (poolState.load() == POOL_STATE_OK) {
+      while (totalConnection.load() < options->minPoolSize && addConnection()) {
+      }
+      std::chrono::seconds wait(scheduleDelay);
+      // The keepalive interval may turn out to be shorter with the server's wait_timeout
+      if (options->poolKeepAlive > 0) {
+        wait= std::min(wait, std::chrono::seconds(std::max(1, keepAliveInterval() / 10)));
+      }
+      {
+        std::unique_lock<std::mutex> guard(lock);
+        houseKeeperWakeup.wait_for(guard, wait,
+          [this]() { return poolState.load() != POOL_STATE_OK || retireRequested.load(); });
+      }
+      if (poolState.load() == POOL_STATE_OK) {
+        removeIdleTimeoutConnection();
+        keepAliveIdleConnections();
+        retireExpiredConnections();
+        if (options->poolRebalanceRate > 0) {
+          rebalance();
         }
-      });
+      }
     }
   }
 
   /**
-    * Removing idle connection. Close them and recreate connection to reach minimal number of
-    * connection.
+    * Removing idle connections. Oldest connections are at the bottom of each shard's stack. Connections are closed
+    * with no lock held. Connections idle for idleTrimTime, that stay, release their buffers and cached statements -
+    * that costs no round trip, since statements close commands have no response.
     */
   void Pool::removeIdleTimeoutConnection()
   {
-    Iterator<MariaDbPooledConnection>iterator= idleConnections.descendingIterator();
-    MariaDbPooledConnection item;
-
-    while (iterator.hasNext())
-    {
-      item= iterator.next();
-
-      int64_t idleTime= System.nanoTime()-item.getLastUsed().get();
-      bool timedOut= idleTime >TimeUnit.SECONDS.toNanos(maxIdleTime);
+    std::vector<std::unique_ptr<MariaDbPooledConnection>> toClose;
+    const int64_t now= nanoTime();
+    const int64_t maxIdleNanos= static_cast<int64_t>(maxIdleTime) * 1000000000LL;
+    const int64_t waitTimeoutNanos= globalInfo ? static_cast<int64_t>(globalInfo->getWaitTimeout() - 45) * 1000000000LL : 0;
+    // Pinged connections are not closed by the server
+    const bool serverCloses= globalInfo && options->poolKeepAlive == 0;
+    const int64_t trimNanos= static_cast<int64_t>(options->idleTrimTime) * 1000000000LL;
+
+    for (std::size_t i= 0; i < shardCount; ++i) {
+      IdleShard& shard= shards[i];
+      std::lock_guard<std::mutex> shardLock(shard.lock);
+
+      for (auto it= shard.connections.begin(); it != shard.connections.end();) {
+        int64_t idleTime= now - (*it)->getLastUsed();
+        bool shouldBeReleased= (idleTime > maxIdleNanos && totalConnection.load() > options->minPoolSize)
+          || (serverCloses && idleTime > waitTimeoutNanos);
+
+        if (shouldBeReleased) {
+          toClose.push_back(std::move(*it));
+          it= shard.connections.erase(it);
+          --shard.idleCount;
+          --totalConnection;
+        }
+        else {
+          if (trimNanos > 0 && idleTime > trimNanos) {
+            (*it)->getConnection()->getProtocol()->trimMemory();
+          }
+          ++it;
+        }
+      }
+    }
 
-      bool shouldBeReleased= false;
+    if (!toClose.empty()) {
+      for (auto& item : toClose) {
+        silentCloseConnection(*item);
+      }
+      toClose.clear();
+      notifyWaiter();
+      if (logger->isDebugEnabled()) {
+        logger->debug("pool " + poolTag + " connections removed due to inactivity " + stateToString());
+      }
+    }
+  }
 
-      if (globalInfo) {
+  /**
+    * Replacing idle connections past their lifetime. Replacements are connected first, so the requests coming
+    * meanwhile still find the old connections idle. If the pool is full, the connection is closed before its
+    * replacement is created. Connections in use are retired when they are given back.
+    */
+  void Pool::retireExpiredConnections()
+  {
+    retireRequested.store(false);
+    if (options->maxLifetime <= 0) {
+      return;
+    }
+    const int64_t now= nanoTime();
+    int32_t expired= 0, replaced= 0;
 
+    for (std::size_t i= 0; i < shardCount; ++i) {
+      IdleShard& shard= shards[i];
+      std::lock_guard<std::mutex> shardLock(shard.lock);
 
-        if (idleTime >TimeUnit.SECONDS.toNanos(globalInfo.getWaitTimeout()-45)) {
-          shouldBeReleased= true;
+      for (auto& item : shard.connections) {
+        if (item->getRetireTime() <= now) {
+          ++expired;
         }
+      }
+    }
+    while (replaced < expired && addConnection()) {
+      ++replaced;
+    }
 
-
-        if (timedOut &&totalConnection.get()>options->minPoolSize) {
-          shouldBeReleased= true;
+    std::vector<std::unique_ptr<MariaDbPooledConnection>> toClose;
+    for (std::size_t i= 0; i < shardCount; ++i) {
+      IdleShard& shard= shards[i];
+      std::lock_guard<std::mutex> shardLock(shard.lock);
+
+      for (auto it= shard.connections.begin(); it != shard.connections.end();) {
+        if ((*it)->getRetireTime() <= now) {
+          toClose.push_back(std::move(*it));
+          it= shard.connections.erase(it);
+          --shard.idleCount;
+          --totalConnection;
+        }
+        else {
+          ++it;
         }
+      }
+    }
 
+    if (!toClose.empty()) {
+      int32_t retired= static_cast<int32_t>(toClose.size());
+      for (auto& item : toClose) {
+        silentCloseConnection(*item);
       }
-      else if (timedOut) {
-        shouldBeReleased= true;
+      toClose.clear();
+      notifyWaiter();
+      // Connections, that could not be replaced in advance, since the pool was full
+      for (; replaced < retired && addConnection(); ++replaced) {
       }
+      if (logger->isDebugEnabled()) {
+        logger->debug("pool " + poolTag + " connections retired due to maxLifetime " + stateToString());
+      }
+    }
+  }
 
-      if (shouldBeReleased &&idleConnections.remove(item)) {
-
-        totalConnection.decrementAndGet();
-        silentCloseConnection(item);
-        addConnectionRequest();
-        if (logger.isDebugEnabled()) {
-          logger.debug(
-            "pool {} connection removed due to inactivity (total:{}, active:{}, pending:{})",
-            poolTag,
-            totalConnection.get(),
-            getActiveConnections(),
-            pendingRequestNumber.get());
-        }
 
+  void Pool::requestRetirement()
+  {
+    retireRequested.store(true);
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    houseKeeperWakeup.notify_all();
+  }
 
-      }
+  /* Jitter of up to 10% of maxLifetime spreads the retirement of connections created at the same time */
+  int64_t Pool::retireTime()
+  {
+    const int64_t lifetime= static_cast<int64_t>(options->maxLifetime) * 1000000000LL;
+    int64_t jitter;
+    {
+      std::lock_guard<std::mutex> localScopeLock(lock);
+      jitter= std::uniform_int_distribution<int64_t>(0, lifetime / 10)(rnd);
     }
+    return nanoTime() + lifetime - jitter;
   }
 
   /**
-    * Create new connection.
-    *
-    * @throws SQLException if connection creation failed
+    * Pings idle connections, whose keepalive time has come. They are taken from the idle stacks for the ping, so that
+    * the shards are not locked during the round trips, and are put back on top. Connections, that fail the ping, are
+    * discarded, and minPoolSize is restored by the next round.
     */
-  void Pool::addConnection() {
-
-    Protocol& protocol= Utils::retrieveProxy(urlParser, globalInfo);
-    MariaDbConnection connection= new MariaDbConnection(protocol);
-    MariaDbPooledConnection pooledConnection= createPoolConnection(connection);
-
-    if (options->staticGlobal) {
-
-      if (globalInfo) {
-        initializePoolGlobalState(connection);
-      }
-
-      connection.setDefaultTransactionIsolation(globalInfo.getDefaultTransactionIsolation());
+  void Pool::keepAliveIdleConnections()
+  {
+    if (options->poolKeepAlive <= 0) {
+      return;
     }
-    else {
-
-      connection.setDefaultTransactionIsolation(connection.getTransactionIsolation());
+    std::vector<std::unique_ptr<MariaDbPooledConnection>> toPing;
+    const int64_t now= nanoTime();
+
+    for (std::size_t i= 0; i < shardCount; ++i) {
+      IdleShard& shard= shards[i];
+      std::lock_guard<std::mutex> shardLock(shard.lock);
+
+      for (auto it= shard.connections.begin(); it != shard.connections.end();) {
+        if ((*it)->getKeepAliveTime() <= now) {
+          toPing.push_back(std::move(*it));
+          it= shard.connections.erase(it);
+          --shard.idleCount;
+        }
+        else {
+          ++it;
+        }
+      }
     }
 
-    if (poolState.get()==POOL_STATE_OK
-      &&totalConnection.incrementAndGet()<=options->maxPoolSize) {
-      idleConnections.addFirst(pooledConnection);
-
-      if (logger.isDebugEnabled()) {
-        logger.debug(
-          "pool {} new physical connection created (total:{}, active:{}, pending:{})",
-          poolTag,
-          totalConnection.get(),
-          getActiveConnections(),
-          pendingRequestNumber.get());
+    for (auto& item : toPing) {
+      bool alive= false;
+      try {
+        alive= item->getConnection()->getProtocol()->ping();
       }
-      return;
+      catch (SQLException&) {
+      }
+      if (alive) {
+        item->setKeepAliveTime(keepAliveTime());
+        if (pushIdle(item)) {
+          continue;
+        }
+      }
+      else {
+        logger->debug("connection removed from pool " + poolTag + " due to failed keepalive ping");
+      }
+      discard(item);
     }
+  }
 
-    silentCloseConnection(pooledConnection);
+  /* poolKeepAlive, but not longer than the half of the server's wait_timeout */
+  int32_t Pool::keepAliveInterval() const
+  {
+    int32_t timeout= waitTimeout.load();
+    return timeout > 0 ? std::max(1, std::min(options->poolKeepAlive, timeout / 2)) : options->poolKeepAlive;
   }
 
-  MariaDbPooledConnection Pool::getIdleConnection() {
-    return getIdleConnection(0, TimeUnit.NANOSECONDS);
+  /* Jitter of up to 20% of the interval spreads the pings of connections, that have become idle at the same time */
+  int64_t Pool::keepAliveTime()
+  {
+    const int64_t interval= static_cast<int64_t>(keepAliveInterval()) * 1000000000LL;
+    int64_t jitter;
+    {
+      std::lock_guard<std::mutex> localScopeLock(lock);
+      jitter= std::uniform_int_distribution<int64_t>(0, interval / 5)(rnd);
+    }
+    return nanoTime() + interval - jitter;
   }
 
   /**
-    * Get an existing idle connection in pool.
-    *
-    * @return an IDLE connection.
+    * Moves up to poolRebalanceRate idle connections from the hosts, that have more connections than their share, to
+    * those, that have less. With loadbalance the share of a healthy host is by its weight, otherwise all connections
+    * belong on the first healthy host, where new connections go. Thus connections return to the host, that is not
+    * blacklisted any more. Replacement is connected before the taken idle connection is closed, unless the pool is
+    * full. Connections in use are not moved.
     */
-  MariaDbPooledConnection Pool::getIdleConnection(int64_t timeout, TimeUnit timeUnit) {
-
-
-    while (true) {
-      MariaDbPooledConnection item =
-        (timeout ==0)
-        ? idleConnections.pollFirst()
-        : idleConnections.pollFirst(timeout, timeUnit);
-
-      if (item) {
-        MariaDbConnection connection= item.getConnection();
-        try {
-          if (TimeUnit.NANOSECONDS.toMillis(System.nanoTime()-item.getLastUsed().get())
->options->poolValidMinDelay) {
+  void Pool::rebalance()
+  {
+    std::vector<HostAddress>& hosts= urlParser->getHostAddresses();
 
+    if (hosts.size() < 2 || urlParser->getHaMode() == HaMode::REPLICATION || waiters.load() > 0) {
+      return;
+    }
+    HostHealthRegistry& registry= HostHealthRegistry::getInstance();
+    std::vector<double> shares(hosts.size(), 0.0);
+    double totalShare= 0;
 
-            if (connection.isValid(10)) {
-              item.lastUsedToNow();
-              return item;
-            }
+    for (std::size_t i= 0; i < hosts.size(); ++i) {
+      if (registry.isBlacklisted(hosts[i])) {
+        continue;
+      }
+      if (urlParser->getHaMode() != HaMode::LOADBALANCE) {
+        shares[i]= totalShare= 1;
+        break;
+      }
+      shares[i]= hosts[i].weight > 0 ? hosts[i].weight : 1;
+      totalShare+= shares[i];
+    }
+    if (totalShare == 0) {
+      return;
+    }
 
+    for (int32_t moved= 0; moved < options->poolRebalanceRate && poolState.load() == POOL_STATE_OK; ++moved) {
+      std::size_t over= hosts.size(), under= hosts.size();
+      double maxExcess= 0, maxDeficit= 0;
+      int32_t underCount= 0;
+      {
+        std::lock_guard<std::mutex> localScopeLock(lock);
+        double total= 0;
+        for (auto& it : hostConnections) {
+          total+= it.second;
+        }
+        for (std::size_t i= 0; i < hosts.size(); ++i) {
+          auto it= hostConnections.find(hostKeyOf(hosts[i]));
+          int32_t count= it == hostConnections.end() ? 0 : it->second;
+          double excess= count - total*shares[i]/totalShare;
+
+          if (excess >= 1.0 && excess > maxExcess) {
+            over= i;
+            maxExcess= excess;
           }
-          else {
-
-
-            item.lastUsedToNow();
-            return item;
+          else if (shares[i] > 0 && excess <= -1.0 && -excess > maxDeficit) {
+            under= i;
+            maxDeficit= -excess;
+            underCount= count;
           }
-
         }
-        catch (SQLException& sqle) {
+      }
+      if (over == hosts.size() || under == hosts.size()) {
+        return;
+      }
 
+      // The oldest idle connection of the host, so it's not handed out while the replacement is connected
+      const std::string overKey(hostKeyOf(hosts[over]));
+      std::unique_ptr<MariaDbPooledConnection> item;
+      for (std::size_t i= 0; i < shardCount && !item; ++i) {
+        IdleShard& shard= shards[i];
+        std::lock_guard<std::mutex> shardLock(shard.lock);
+        auto it= std::find_if(shard.connections.begin(), shard.connections.end(),
+          [&overKey](const std::unique_ptr<MariaDbPooledConnection>& idle) { return idle->getHostKey() == overKey; });
+        if (it != shard.connections.end()) {
+          item= std::move(*it);
+          shard.connections.erase(it);
+          --shard.idleCount;
         }
-
-        totalConnection.decrementAndGet();
-
-
-        silentAbortConnection(item);
-        addConnectionRequest();
-        if (logger.isDebugEnabled()) {
-          logger.debug(
-            "pool {} connection removed from pool due to failed validation (total:{}, active:{}, pending:{})",
-            poolTag,
-            totalConnection.get(),
-            getActiveConnections(),
-            pendingRequestNumber.get());
+      }
+      if (!item) {
+        return;
+      }
+      bool added= addConnection(&hosts[under]);
+      discard(item);
+      if (!added && !addConnection(&hosts[under])) {
+        return;
+      }
+      {
+        std::lock_guard<std::mutex> localScopeLock(lock);
+        // The replacement has not got to the host, e.g. it is not reachable actually
+        if (hostConnections[hostKeyOf(hosts[under])] <= underCount) {
+          return;
         }
-        continue;
       }
-
-      return NULL;
+      if (logger->isDebugEnabled()) {
+        logger->debug("pool " + poolTag + " connection moved from " + hosts[over].toString() + " to "
+          + hosts[under].toString() + " " + stateToString());
+      }
     }
   }
 
-  void Pool::silentCloseConnection(MariaDbPooledConnection item) {
-    try {
-      item.close();
-    }
-    catch (SQLException& ex) {
+  /**
+    * Create new connection and put it to the idle stack.
+    *
+    * @param host host to try first, if given
+    * @return true if connection has been added
+    */
+  bool Pool::addConnection(const HostAddress* host)
+  {
+    int32_t total= totalConnection.load();
 
-    }
-  }
+    do {
+      if (poolState.load() != POOL_STATE_OK || total >= options->maxPoolSize) {
+        return false;
+      }
+    } while (!totalConnection.compare_exchange_weak(total, total + 1));
 
-  void Pool::silentAbortConnection(MariaDbPooledConnection item) {
+    std::unique_ptr<MariaDbPooledConnection> item;
     try {
-      item.abort(poolExecutor);
+      item.reset(createPoolConnection(nullptr, host));
+    }
+    catch (SQLException& sqle) {
+      logger->error("error initializing pool connection", sqle);
+      --totalConnection;
+      notifyWaiter();
+      return false;
     }
-    catch (SQLException& ex) {
 
+    if (!pushIdle(item)) {
+      discard(item);
+      return false;
     }
+    if (logger->isDebugEnabled()) {
+      logger->debug("pool " + poolTag + " new physical connection created " + stateToString());
+    }
+    return true;
   }
 
-  MariaDbPooledConnection Pool::createPoolConnection(MariaDbConnection connection) {
-    MariaDbPooledConnection pooledConnection= new MariaDbPooledConnection(connection);
-    pooledConnection.addConnectionEventListener(
-      new ConnectionEventListener(){
+  /* Shard of the current thread. Threads are assigned shards in round robin manner on first use of any pool */
+  std::size_t Pool::localShard() const
+  {
+    static std::atomic<std::size_t> threadCounter(0);
+    static thread_local std::size_t threadIndex= threadCounter++;
 
-      @Override
-      void Pool::connectionClosed(ConnectionEvent event) {
-      MariaDbPooledConnection item =(MariaDbPooledConnection)event.getSource();
-      if (poolState.get()==POOL_STATE_OK) {
-      try {
-      if (!(idleConnections.find_first_of(item) >= 0)) {
-      item.getConnection().reset();
-      idleConnections.addFirst(item);
-      }
-      }
-      catch (SQLException& sqle) {
+    return threadIndex % shardCount;
+  }
+
+  /* Pops connection from the current thread's shard, or steals it from the next shard, that has any. With the tenant,
+     the most recently used connection of the tenant in the shard is taken, if there is one */
+  std::unique_ptr<MariaDbPooledConnection> Pool::takeIdle(const SQLString* tenant)
+  {
+    std::unique_ptr<MariaDbPooledConnection> item;
+    const std::size_t local= localShard();
 
+    for (std::size_t i= 0; i < shardCount && !item; ++i) {
+      IdleShard& shard= shards[(local + i) % shardCount];
 
-      totalConnection.decrementAndGet();
-      silentCloseConnection(item);
-      logger.debug("connection removed from pool {} due to error during reset",poolTag);
+      if (shard.idleCount.load(std::memory_order_relaxed) == 0) {
+        continue;
       }
+      std::lock_guard<std::mutex> shardLock(shard.lock);
+      if (!shard.connections.empty()) {
+        auto it= std::prev(shard.connections.end());
+        if (tenant != nullptr) {
+          auto own= std::find_if(shard.connections.rbegin(), shard.connections.rend(),
+            [tenant](const std::unique_ptr<MariaDbPooledConnection>& idle) { return idle->getTenant() == *tenant; });
+          if (own != shard.connections.rend()) {
+            it= std::prev(own.base());
+          }
+        }
+        item= std::move(*it);
+        shard.connections.erase(it);
+        --shard.idleCount;
       }
-      else {
+    }
+    return item;
+  }
 
-    try {
-    item.close();
+  /* Pushes connection to the current thread's shard. Returns false if the pool is being closed */
+  bool Pool::pushIdle(std::unique_ptr<MariaDbPooledConnection>& item)
+  {
+    IdleShard& shard= shards[localShard()];
+    {
+      std::lock_guard<std::mutex> shardLock(shard.lock);
+      // close() changes state before collecting connections from shards, so with the shard lock the check is reliable
+      if (poolState.load() != POOL_STATE_OK) {
+        return false;
+      }
+      shard.connections.push_back(std::move(item));
+      ++shard.idleCount;
     }
-    catch (SQLException& sqle) {
+    notifyWaiter();
+    return true;
+  }
+
+  /**
+    * Waits in the queue until a connection is handed over, or there is room for a new one.
+    *
+    * @param ticket order of arrival of the request. Assigned on the first wait
+    * @param item the connection handed over to the request, if any
+    * @return false if the wait has timed out
+    */
+  bool Pool::waitForIdle(const std::chrono::steady_clock::time_point& deadline, int32_t priority, uint64_t& ticket,
+    std::unique_ptr<MariaDbPooledConnection>& item)
+  {
+    std::unique_lock<std::mutex> guard(lock);
+    bool result= true;
 
+    if (poolState.load() != POOL_STATE_OK) {
+      return true;
     }
-    totalConnection.decrementAndGet();
+    if (ticket == 0) {
+      ticket= ++lastTicket;
     }
+    Waiter waiter(priority, ticket, deadline);
+    auto position= std::find_if(waitQueue.begin(), waitQueue.end(), [&waiter](const Waiter* queued) {
+      return queued->priority < waiter.priority || (queued->priority == waiter.priority && queued->ticket > waiter.ticket);
+    });
+    waitQueue.insert(position, &waiter);
+
+    ++waiters;
+    // Connections could be released or discarded while the thread was scanning shards. The counter is incremented
+    // before the check, and releasers change shards before reading it, so the notification can't be lost
+    handOver();
+    auto ready= [this, &waiter]() { return waiter.woken || poolState.load() != POOL_STATE_OK; };
+    if (options->connectTimeout == 0) {
+      waiter.wakeup.wait(guard, ready);
     }
-
-    @Override
-    void Pool::connectionClosed(ConnectionEvent event) {
-
-    MariaDbPooledConnection item =((MariaDbPooledConnection)event.getSource());
-    if (idleConnections.remove(item)) {
-    totalConnection.decrementAndGet();
+    else {
+      result= waiter.wakeup.wait_until(guard, deadline, ready);
     }
-    silentCloseConnection(item);
-    addConnectionRequest();
-    logger.debug(
-    "connection {} removed from pool {} due to having throw a Connection* exception (total:{}, active:{}, pending:{})",
-    item.getConnection().getServerThreadId(),
-    poolTag,
-    totalConnection.get(),
-    getActiveConnections(),
-    pendingRequestNumber.get());
+    --waiters;
+    // Timed out waiter leaves the queue under the lock, thus nothing can be handed over to it after the deadline
+    if (!waiter.woken) {
+      waitQueue.remove(&waiter);
     }
-      });
-    return pooledConnection;
+    item= std::move(waiter.item);
+
+    return result;
   }
 
   /**
-    * Retrieve new connection. If possible return idle connection, if not, stack connection query,
-    * ask for a connection creation, and loop until a connection become idle / a new connection is
-    * created.
-    *
-    * @return a connection object
-    * @throws SQLException if no connection is created when reaching timeout (connectTimeout option)
+    * Hands idle connections over to the waiters in the queue order. If there are no idle connections, but the pool
+    * is not full, the first waiter is woken to create one. Waiters, whose deadline has passed, are dropped from the
+    * queue. Has to be called with the lock held.
     */
-  MariaDbConnection* Pool::getConnection()
+  void Pool::handOver()
   {
-    pendingRequestNumber.incrementAndGet();
+    const auto now= std::chrono::steady_clock::now();
 
-    MariaDbPooledConnection pooledConnection;
+    while (!waitQueue.empty()) {
+      Waiter* waiter= waitQueue.front();
 
-    try {
+      if (options->connectTimeout != 0 && waiter->deadline <= now) {
+        // It fails on its own wake up
+        waitQueue.pop_front();
+        continue;
+      }
+      waiter->item= takeIdle();
+      if (!waiter->item && totalConnection.load() >= options->maxPoolSize) {
+        return;
+      }
+      waitQueue.pop_front();
+      waiter->woken= true;
+      waiter->wakeup.notify_one();
+      if (!waiter->item) {
+        return;
+      }
+    }
+  }
 
 
-      if ((pooledConnection =
-        getIdleConnection(totalConnection.get()>4 ? 0 : 50, TimeUnit.MICROSECONDS))) {
-        return pooledConnection.getConnection();
+  void Pool::notifyWaiter()
+  {
+    if (waiters.load() > 0) {
+      std::lock_guard<std::mutex> localScopeLock(lock);
+      handOver();
+    }
+  }
+
+  /**
+    * Create new physical connection.
+    *
+    * @param request the connect, that the connection is created for. The shared pool connects as its tenant
+    * @param host host to try first, if given
+    * @return pooled connection object
+    * @throws SQLException if connection creation failed
+    */
+  MariaDbPooledConnection* Pool::createPoolConnection(const PoolRequest* request, const HostAddress* host)
+  {
+    // Options are immutable once parsed, and are shared by the pool's connections, unless the tenant's credentials go there
+    UrlParser* connectParser= urlParser->clone(!(request != nullptr && options->sharedPool));
+    if (request != nullptr && options->sharedPool) {
+      connectParser->setUsername(request->user);
+      connectParser->setPassword(request->password);
+      connectParser->setDatabase(request->database);
+    }
+    if (host != nullptr) {
+      std::vector<HostAddress>& addresses= connectParser->getHostAddresses();
+      auto it= std::find_if(addresses.begin(), addresses.end(),
+        [host](const HostAddress& address) { return address.host == host->host && address.port == host->port; });
+      if (it != addresses.end()) {
+        std::rotate(addresses.begin(), it, it + 1);
       }
+    }
+    Shared::Protocol protocol(Utils::retrieveProxy(*connectParser, globalInfo.get()));
+    MariaDbConnection* connection= new MariaDbConnection(protocol);
+    std::unique_ptr<MariaDbPooledConnection> pooledConnection(new MariaDbPooledConnection(connection));
 
+    if (options->sharedPool) {
+      pooledConnection->setTenant(tenantKey(connectParser->getUsername(), connectParser->getPassword()));
+    }
 
-      addConnectionRequest();
+    if (options->maxLifetime > 0) {
+      pooledConnection->setRetireTime(retireTime());
+    }
 
+    MetricsRegistry::getInstance().setGroup(&protocol->getMetrics(), StringImp::get(poolTag));
 
-      if ((pooledConnection =
-        getIdleConnection(
-          TimeUnit.MILLISECONDS.toNanos(options->connectTimeout), TimeUnit.NANOSECONDS))) {
-        return pooledConnection.getConnection();
+    if (options->staticGlobal) {
+      {
+        std::lock_guard<std::mutex> localScopeLock(lock);
+        if (!globalInfo) {
+          initializePoolGlobalState(connection);
+        }
       }
-
-      throw ExceptionMapper.connException(
-        "No connection available within the specified time "
-        +"(option 'connectTimeout': "
-        +NumberFormat.getInstance().format(options->connectTimeout)
-        +" ms)");
-
+      connection->setDefaultTransactionIsolation(globalInfo->getDefaultTransactionIsolation());
     }
-    catch (InterruptedException& interrupted)
-    {
-      throw ExceptionMapper.connException("Thread was interrupted", interrupted);
+    else {
+      connection->setDefaultTransactionIsolation(connection->getTransactionIsolation());
+    }
+
+    if (options->poolKeepAlive > 0) {
+      if (waitTimeout.load() == 0) {
+        if (globalInfo) {
+          waitTimeout.store(globalInfo->getWaitTimeout());
+        }
+        else {
+          Unique::Statement stmt(connection->createStatement());
+          Unique::ResultSet rs(stmt->executeQuery("SELECT @@wait_timeout"));
+          if (rs->next()) {
+            waitTimeout.store(rs->getInt(1));
+          }
+        }
+      }
+      pooledConnection->setKeepAliveTime(keepAliveTime());
     }
-    finally
+    pooledConnection->setHostKey(hostKeyOf(protocol->getHostAddress()));
     {
-      pendingRequestNumber.decrementAndGet();
+      std::lock_guard<std::mutex> localScopeLock(lock);
+      ++hostConnections[pooledConnection->getHostKey()];
     }
+    return pooledConnection.release();
   }
 
   /**
-    * Get new connection from pool if user and password correspond to pool. If username and password
-    * are different from pool, will return a dedicated connection.
-    *
-    * @param username username
-    * @param password password
-    * @return connection
-    * @throws SQLException if any error occur during connection
+    * Switches the connection of the shared pool to the tenant of the request. Another user costs COM_CHANGE_USER,
+    * another database is sent with the next command. The connection is authenticated again, if the password
+    * differs, so a request never gets the session of the credentials it has not presented.
     */
-  MariaDbConnection Pool::getConnection(SQLString& username, SQLString& password) {
-
-
-    try {
-
-      if ((urlParser.getUsername()
-        ? (urlParser.getUsername().compare(username) == 0)
-        : username)
-        &&(urlParser.getPassword()
-          ? (urlParser.getUsername().compare(username) == 0)
-          : password)) {
-        return getConnection();
-      }
-
-      UrlParser tmpUrlParser =(UrlParser)urlParser.clone();
-      tmpUrlParser.setUsername(username);
-      tmpUrlParser.setPassword(password);
-      Protocol& protocol= Utils.retrieveProxy(tmpUrlParser, globalInfo);
-      return new MariaDbConnection(protocol);
+  void Pool::lend(MariaDbPooledConnection& item, const PoolRequest& request)
+  {
+    Shared::Protocol& protocol= item.getConnection()->getProtocol();
+    SQLString tenant(request.tenant());
 
+    if (item.getTenant() != tenant) {
+      // If the change fails, the connection is discarded
+      protocol->changeUser(request.user, request.password, request.database);
+      item.setTenant(tenant);
     }
-    catch (CloneNotSupportedException& cloneException) {
-
-      throw SQLException(
-        "Error getting connection, parameters cannot be cloned", cloneException);
+    else if (protocol->getDatabase().compare(request.database) != 0) {
+      protocol->setCatalog(request.database);
     }
   }
 
-  SQLString Pool::generatePoolTag(int32_t poolIndex)
+  /**
+    * Checks if the connection taken from the idle stack is still alive. Connections used not longer than
+    * poolValidMinDelay ago are considered valid without asking the server.
+    */
+  bool Pool::validate(MariaDbPooledConnection& item)
   {
-    if (options->poolName.empty())
-    {
-      options->poolName= "MariaDB-pool";
+    if (nanoTime() - item.getLastUsed() <= static_cast<int64_t>(options->poolValidMinDelay) * 1000000LL) {
+      return true;
+    }
+    try {
+      return item.getConnection()->isValid(10);
     }
-    return options->poolName + "-" + poolIndex;
+    catch (SQLException&) {
+    }
+    return false;
   }
 
-  UrlParser& Pool::getUrlParser()
+  void Pool::recordWait(const std::chrono::steady_clock::time_point& start, bool failed)
   {
-    return urlParser;
+    int64_t waited= std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    metrics.poolWait.record(static_cast<uint64_t>(waited));
+    MARIADB_PROBE3(pool__checkout, poolTag.c_str(), waited, static_cast<int>(failed));
   }
 
-  /**
-    * Close pool and underlying connections.
-    *
-    * @throws InterruptedException if interrupted
-    */
-  void Pool::close()
+  /* Has to be called without the lock */
+  void Pool::discard(std::unique_ptr<MariaDbPooledConnection>& item)
   {
-    //synchronized(this)
-    {
-      Pools.remove(this);
-      poolState.set(POOL_STATE_CLOSING);
-      pendingRequestNumber.set(0);
+    --totalConnection;
+    silentCloseConnection(*item);
+    item.reset();
+    // Waiter may create new connection now
+    notifyWaiter();
+  }
 
-      scheduledFuture.cancel(false);
-      connectionAppender.shutdown();
 
-      try
-      {
-        connectionAppender.awaitTermination(10, TimeUnit.SECONDS);
-      }
-      catch (std::exception &))
-      {
-      closeAll(connectionRemover, idleConnections);
-}
+  const HostAddress& Pool::hostOf(MariaDbPooledConnection& item)
+  {
+    return item.getConnection()->getProtocol()->getHostAddress();
+  }
 
-      connectionRemover.shutdown();
-      try {
-        unRegisterJmx();
-      }
-      catch (Exception& exception) {
 
+  void Pool::silentCloseConnection(MariaDbPooledConnection& item)
+  {
+    {
+      std::lock_guard<std::mutex> localScopeLock(lock);
+      auto it= hostConnections.find(item.getHostKey());
+      if (it != hostConnections.end() && --it->second <= 0) {
+        hostConnections.erase(it);
       }
-      connectionRemover.awaitTermination(10, TimeUnit.SECONDS);
+    }
+    try {
+      item.close();
+    }
+    catch (SQLException&) {
     }
   }
 
-  void Pool::closeAll(ExecutorService connectionRemover, Collection<MariaDbPooledConnection>collection) {
-    synchronized(collection) {
-      for (MariaDbPooledConnection item : collection) {
-        collection.remove(item);
-        totalConnection.decrementAndGet();
+  /**
+    * Retrieve new connection. If possible return idle connection, if not, and the pool is not full yet, new
+    * connection is created. Otherwise waits in the queue for a connection to be released. The queue is ordered by
+    * the priority, and then by the arrival. connectTimeout is the deadline of the whole request, including the wait
+    * for the admission control's permit.
+    * The connection of the shared pool is switched to the user and the database of the request.
+    *
+    * @param request priority of the request in the waiting queue, and the tenant for the shared pool
+    * @return a connection object
+    * @throws SQLException if no connection is created when reaching timeout (connectTimeout option)
+    */
+  Connection* Pool::getConnection(const PoolRequest& request)
+  {
+    const int32_t priority= request.priority;
+    const SQLString tenant(options->sharedPool ? request.tenant() : SQLString());
+    std::unique_ptr<MariaDbPooledConnection> item;
+    uint64_t ticket= 0;
+    auto start= std::chrono::steady_clock::now();
+    auto deadline= start + std::chrono::milliseconds(options->connectTimeout);
+
+    if (admission) {
+      if (!admission->admit()) {
+        throw SQLException("Pool " + poolTag + " does not connect, circuit breaker is open after "
+          + std::to_string(options->circuitBreakerThreshold) + " consecutive failures", CONNECTION_EXCEPTION.getSqlState().c_str());
+      }
+      if (!admission->acquire(deadline, priority)) {
+        throw SQLException("Pool " + poolTag + " request rejected, concurrency limit " + std::to_string(admission->getLimit())
+          + " is reached", CONNECTION_EXCEPTION.getSqlState().c_str());
+      }
+    }
+    ++pendingRequestNumber;
+    try {
+      for (;;) {
+        if (poolState.load() != POOL_STATE_OK) {
+          if (item) {
+            discard(item);
+          }
+          throw SQLException("Pool " + poolTag + " is closed", CONNECTION_EXCEPTION.getSqlState().c_str());
+        }
+        // Idle connections go to the queued requests first, unless one has just been handed over to this one
+        if (item || (waiters.load() == 0 && (item= takeIdle(options->sharedPool ? &tenant : nullptr)))) {
+          if (validate(*item)) {
+            break;
+          }
+          if (admission) {
+            admission->onFailure(hostOf(*item));
+          }
+          discard(item);
+          if (logger->isDebugEnabled()) {
+            logger->debug("pool " + poolTag + " connection removed from pool due to failed validation " + stateToString());
+          }
+          continue;
+        }
+        int32_t total= totalConnection.load();
+        if (total < options->maxPoolSize) {
+          if (totalConnection.compare_exchange_weak(total, total + 1)) {
+            try {
+              item.reset(createPoolConnection(&request));
+            }
+            catch (SQLException& e) {
+              --totalConnection;
+              notifyWaiter();
+              if (admission && e.getSQLState().startsWith("08")) {
+                admission->onFailure();
+              }
+              throw;
+            }
+            if (admission) {
+              admission->onSuccess(hostOf(*item));
+            }
+            break;
+          }
+          continue;
+        }
+        if (!waitForIdle(deadline, priority, ticket, item)) {
+          throw SQLException(SQLString("No connection available within the specified time (option 'connectTimeout': ")
+            + std::to_string(options->connectTimeout) + " ms)", CONNECTION_EXCEPTION.getSqlState().c_str());
+        }
+      }
+      if (options->sharedPool) {
         try {
-          item.abort(connectionRemover);
+          lend(*item, request);
         }
-        catch (SQLException& ex) {
-
+        catch (SQLException&) {
+          discard(item);
+          throw;
         }
+      }
+    }
+    catch (SQLException&) {
+      --pendingRequestNumber;
+      if (admission) {
+        admission->abandon();
+      }
+      recordWait(start, true);
+      throw;
+    }
+    --pendingRequestNumber;
+    recordWait(start, false);
+    item->lastUsedToNow();
 
+    return new MariaDbProxyConnection(shared_from_this(), item);
+  }
 
+  /**
+    * Connection is given back by the application. Transaction, that is left open, is rolled back, and the connection
+    * state is reset.
+    */
+  void Pool::releaseConnection(std::unique_ptr<MariaDbPooledConnection>& item, bool broken)
+  {
+    if (admission) {
+      // lastUsed is set at the checkout, thus this is the time the application held the connection
+      admission->release(std::chrono::microseconds((nanoTime() - item->getLastUsed())/1000), broken);
+      if (broken) {
+        admission->onFailure(hostOf(*item));
+      }
+      else {
+        admission->onSuccess(hostOf(*item));
       }
     }
+    if (!broken && poolState.load() == POOL_STATE_OK) {
+      MariaDbConnection* connection= item->getConnection();
+      try {
+        if (!connection->isClosed()) {
+          connection->rollback();
+          connection->reset();
+          item->lastUsedToNow();
+          if (options->poolKeepAlive > 0) {
+            item->setKeepAliveTime(keepAliveTime());
+          }
+          // The connection stays idle until the pool's thread has connected its replacement
+          bool expired= options->maxLifetime > 0 && item->getRetireTime() <= item->getLastUsed();
 
-    void Pool::initializePoolGlobalState(MariaDbConnection connection) {
-      try (Statement* stmt= connection.createStatement()) {
-        SQLString sql =
-          "SELECT @@max_allowed_packet,"
-          +"@@wait_timeout,"
-          +"@@autocommit,"
-          +"@@auto_increment_increment,"
-          +"@@time_zone,"
-          +"@@system_time_zone,"
-          +"@@tx_isolation";
-        if (!connection.isServerMariaDb()) {
-          int32_t major= connection.getMetaData().getDatabaseMajorVersion();
-          if ((major >=8 &&connection.versionGreaterOrEqual(8, 0, 3))
-            ||(major <8 &&connection.versionGreaterOrEqual(5, 7, 20))) {
-            sql =
-              "SELECT @@max_allowed_packet,"
-              +"@@wait_timeout,"
-              +"@@autocommit,"
-              +"@@auto_increment_increment,"
-              +"@@time_zone,"
-              +"@@system_time_zone,"
-              +"@@transaction_isolation";
+          if (pushIdle(item)) {
+            if (expired) {
+              requestRetirement();
+            }
+            return;
           }
         }
+      }
+      catch (SQLException&) {
+        logger->debug("connection removed from pool " + poolTag + " due to error during reset");
+      }
+    }
+    discard(item);
+  }
 
-        try (ResultSet* rs= stmt.executeQuery(sql)) {
-
-          rs.next();
-
-          int32_t transactionIsolation= Utils.transactionFromString(rs.getString(7));
+  /**
+    * Close pool and idle connections. Connections in use are closed, when they are given back by the application.
+    */
+  void Pool::close()
+  {
+    std::vector<std::unique_ptr<MariaDbPooledConnection>> toClose;
+    {
+      std::lock_guard<std::mutex> localScopeLock(lock);
+      if (poolState.exchange(POOL_STATE_CLOSING) != POOL_STATE_OK) {
+        return;
+      }
+      houseKeeperWakeup.notify_all();
+      for (auto waiter : waitQueue) {
+        waiter->wakeup.notify_one();
+      }
+      waitQueue.clear();
+    }
+    if (admission) {
+      admission->close();
+    }
+    if (houseKeeper.joinable()) {
+      if (houseKeeper.get_id() == std::this_thread::get_id()) {
+        houseKeeper.detach();
+      }
+      else {
+        houseKeeper.join();
+      }
+    }
+    for (std::size_t i= 0; i < shardCount; ++i) {
+      std::lock_guard<std::mutex> shardLock(shards[i].lock);
+      for (auto& item : shards[i].connections) {
+        toClose.push_back(std::move(item));
+      }
+      shards[i].connections.clear();
+      shards[i].idleCount= 0;
+    }
+    totalConnection-= static_cast<int32_t>(toClose.size());
 
-          globalInfo =
-            new GlobalStateInfo(
-              rs.getLong(1),
-              rs.getInt(2),
-              rs.getBoolean(3),
-              rs.getInt(4),
-              rs.getString(5),
-              rs.getString(6),
-              transactionIsolation);
+    for (auto& item : toClose) {
+      silentCloseConnection(*item);
+    }
+  }
 
 
+  void Pool::initializePoolGlobalState(MariaDbConnection* connection)
+  {
+    SQLString sql("SELECT @@max_allowed_packet,@@wait_timeout,@@autocommit,@@auto_increment_increment,"
+      "@@time_zone,@@system_time_zone,@@tx_isolation");
+
+    if (!connection->isServerMariaDb()) {
+      Shared::Protocol& protocol= connection->getProtocol();
+      int32_t major= protocol->getMajorServerVersion();
+      if ((major >= 8 && protocol->versionGreaterOrEqual(8, 0, 3))
+        || (major < 8 && protocol->versionGreaterOrEqual(5, 7, 20))) {
+        sql= "SELECT @@max_allowed_packet,@@wait_timeout,@@autocommit,@@auto_increment_increment,"
+          "@@time_zone,@@system_time_zone,@@transaction_isolation";
+      }
+    }
+    Unique::Statement stmt(connection->createStatement());
+    Unique::ResultSet rs(stmt->executeQuery(sql));
 
-          maxIdleTime= Math.min(options->maxIdleTime, globalInfo.getWaitTimeout()-45);
+    if (rs->next()) {
+      SQLString timeZone(rs->getString(5)), systemTimeZone(rs->getString(6));
+      int32_t transactionIsolation= Utils::transactionFromString(rs->getString(7));
 
+      globalInfo.reset(new GlobalStateInfo(rs->getLong(1), rs->getInt(2), rs->getBoolean(3), rs->getInt(4), timeZone,
+        systemTimeZone, transactionIsolation));
 
-        }
+      // Kept alive connections are not closed by the server
+      if (options->poolKeepAlive == 0) {
+        maxIdleTime= std::min(options->maxIdleTime, globalInfo->getWaitTimeout() - 45);
       }
+    }
+  }
 
-      SQLString Pool::getPoolTag() {
-        return poolTag;
-      }
 
-      bool Pool::equals(sql::Object* obj) {
-        if (this ==obj) {
-          return true;
-        }
-        if (obj ||getClass()!=obj.getClass()) {
-          return false;
-        }
+  SQLString Pool::generatePoolTag(int32_t poolIndex)
+  {
+    if (options->poolName.empty()) {
+      options->poolName= "MariaDB-pool";
+    }
+    return options->poolName + "-" + std::to_string(poolIndex);
+  }
 
-        Pool pool =(Pool)obj;
 
-        return (poolTag.compare(pool.poolTag) == 0);
-      }
+  SQLString Pool::stateToString()
+  {
+    return "(total:" + std::to_string(getTotalConnections()) + ", active:" + std::to_string(getActiveConnections())
+      + ", pending:" + std::to_string(getConnectionRequests()) + ")";
+  }
 
-      int64_t Pool::hashCode() {
-        return poolTag.hashCode();
-      }
 
-      GlobalStateInfo Pool::getGlobalInfo() {
-        return globalInfo;
-      }
+  const SQLString& Pool::getPoolTag() const
+  {
+    return poolTag;
+  }
 
-      int64_t Pool::getActiveConnections() {
-        return totalConnection.get()-idleConnections.size();
-      }
 
-      int64_t Pool::getTotalConnections() {
-        return totalConnection.get();
-      }
+  int64_t Pool::getActiveConnections()
+  {
+    return getTotalConnections() - getIdleConnections();
+  }
 
-      int64_t Pool::getIdleConnections() {
-        return idleConnections.size();
-      }
 
-      int64_t Pool::getConnectionRequests() {
-        return pendingRequestNumber.get();
-      }
+  int64_t Pool::getTotalConnections()
+  {
+    return totalConnection.load();
+  }
 
-      void Pool::registerJmx() {
-        MBeanServer mbs= ManagementFactory.getPlatformMBeanServer();
-        SQLString jmxName= replace(poolTag, ":", "_");
-        ObjectName name= new ObjectName("org.mariadb.jdbc.pool:type="+jmxName);
 
-        if (!mbs.isRegistered(name)) {
-          mbs.registerMBean(this, name);
-        }
-      }
+  int64_t Pool::getIdleConnections()
+  {
+    int64_t idle= 0;
+    for (std::size_t i= 0; i < shardCount; ++i) {
+      idle+= shards[i].idleCount.load();
+    }
+    return idle;
+  }
 
-      void Pool::unRegisterJmx() {
-        MBeanServer mbs= ManagementFactory.getPlatformMBeanServer();
-        SQLString jmxName= replace(poolTag, ":", "_");
-        ObjectName name= new ObjectName("org.mariadb.jdbc.pool:type="+jmxName);
 
-        if (mbs.isRegistered(name)) {
-          mbs.unregisterMBean(name);
-        }
-      }
+  int64_t Pool::getConnectionRequests()
+  {
+    return pendingRequestNumber.load();
+  }
 
-      /**
-        * For testing purpose only.
-        *
-        * @return current thread id's
-        */
-      std::list<Long>testGetConnectionIdleThreadIds() {
-        std::list<Long>threadIds= new ArrayList<>();
-        for (MariaDbPooledConnection pooledConnection : idleConnections) {
-          threadIds.add(pooledConnection.getConnection().getServerThreadId());
-        }
-        return threadIds;
-      }
+  /**
+    * For testing purpose only.
+    *
+    * @return current thread id's
+    */
+  std::vector<int64_t> Pool::testGetConnectionIdleThreadIds()
+  {
+    std::vector<int64_t> threadIds;
 
-      /** JMX method to remove state (will be reinitialized on next connection creation). */  void Pool::resetStaticGlobal() {
-        globalInfo= NULL;
+    for (std::size_t i= 0; i < shardCount; ++i) {
+      std::lock_guard<std::mutex> shardLock(shards[i].lock);
+      for (auto& item : shards[i].connections) {
+        threadIds.push_back(item->getConnection()->getServerThreadId());
       }
-
-
     }
+    return threadIds;
   }
 }
-}
\ No newline at end of file
+}
@@ -22,97 +22,163 @@
 #define _POOL_H_
 
 #include <vector>
-#include <atomic>
-#include <deque>
 #include <list>
+#include <unordered_map>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <random>
 
 #include "Consts.h"
 #include "UrlParser.h"
 #include "GlobalStateInfo.h"
 #include "MariaDbConnection.h"
+#include "AdmissionControl.h"
+#include "util/MetricsRecorder.h"
 
 namespace sql
 {
 namespace mariadb
 {
-class ThreadPoolExecutor;
-class Runnable
-{
-  int32_t dummy;
-};
-class ScheduledFuture;
-class ExecutorService;
-
-class ScheduledThreadPoolExecutor;
-enum TimeUnit {
-  SECONDS
-};
-
 class MariaDbConnection;
 
-class Pool
+/* Parameters of the connect, that are not the pool configuration */
+struct PoolRequest
 {
-  static const Shared::Logger logger; /*LoggerFactory.getLogger(Pool.class)*/
-  static int32_t POOL_STATE_OK; /*0*/
-  static int32_t POOL_STATE_CLOSING; /*1*/
-  std::atomic<int32_t> poolState; /*new std::atomic<int32_t>()*/
+  int32_t priority= 0;
+  /* The tenant, the connection of the shared pool is lent to */
+  SQLString user;
+  SQLString password;
+  SQLString database;
+
+  PoolRequest() {}
+  explicit PoolRequest(UrlParser& urlParser);
+  /* The key of the credentials, that idle connections of the tenant have */
+  SQLString tenant() const;
+};
 
+/* Pool of physical connections with the same url and credentials. Idle connections are kept in LIFO stacks, so the
+   most recently used(and thus the one, that the most probably is still alive and does not need validation) is handed
+   out first, and connections from the bottom of the stack expire if they are not needed. To avoid contention on a
+   single lock, idle connections are sharded - every application thread is assigned a shard, it puts connections to
+   and takes them from, and it steals from other shards only if its own is empty. The pool's own thread keeps at least
+   minPoolSize connections in the pool, evicts connections idle for longer than maxIdleTime, and replaces connections
+   older than maxLifetime(less the random jitter) - the replacement is connected before the old connection is closed.
+   The shared pool(sharedPool option) is the pool of the hosts - its connections are lent to any user and database,
+   switching them on the connection. With poolRebalanceRate, idle connections are moved gradually from the hosts,
+   that have more connections than they would get now, e.g. after the failover, to those, that have less */
+class Pool : public std::enable_shared_from_this<Pool>
+{
+  struct IdleShard
+  {
+    std::mutex lock;
+    std::vector<std::unique_ptr<MariaDbPooledConnection>> connections;
+    std::atomic<int32_t> idleCount;
+
+    IdleShard() : idleCount(0) {}
+  };
+
+  /* Request waiting for a connection. Lives on the stack of the waiting thread, and is in the queue while it waits */
+  struct Waiter
+  {
+    const int32_t priority;
+    /* Order of arrival. The request keeps it, if it has to wait again */
+    const uint64_t ticket;
+    const std::chrono::steady_clock::time_point deadline;
+    std::condition_variable wakeup;
+    bool woken= false;
+    /* Connection handed over to the waiter. Empty, if it is woken to create a new one */
+    std::unique_ptr<MariaDbPooledConnection> item;
+
+    Waiter(int32_t _priority, uint64_t _ticket, const std::chrono::steady_clock::time_point& _deadline)
+      : priority(_priority), ticket(_ticket), deadline(_deadline) {}
+  };
+
+  static const Shared::Logger logger;
+  static const int32_t POOL_STATE_OK= 0;
+  static const int32_t POOL_STATE_CLOSING= 1;
+
+  std::atomic<int32_t> poolState;
   std::shared_ptr<UrlParser> urlParser;
   const Shared::Options options;
-  std::atomic<int32_t> pendingRequestNumber ; /*new std::atomic<int32_t>()*/
-  std::atomic<int32_t> totalConnection ; /*new std::atomic<int32_t>()*/
-  const std::deque<std::unique_ptr<MariaDbPooledConnection>>idleConnections;
-  const ThreadPoolExecutor* connectionAppender;
-  const std::vector<Runnable> connectionAppenderQueue;
+  std::atomic<int32_t> pendingRequestNumber;
+  std::atomic<int32_t> totalConnection;
+  /* Guards waiting for a connection, pool's thread sleep, and global state initialization */
+  std::mutex lock;
+  std::condition_variable houseKeeperWakeup;
+  std::atomic<int32_t> waiters;
+  /* Waiting requests by priority, and in the order of arrival within the same priority. Guarded by the lock */
+  std::list<Waiter*> waitQueue;
+  uint64_t lastTicket= 0;
+  std::size_t shardCount;
+  std::unique_ptr<IdleShard[]> shards;
   const SQLString poolTag;
-  const ScheduledThreadPoolExecutor* poolExecutor;
-  const ScheduledFuture* scheduledFuture;
-  GlobalStateInfo globalInfo;
+  std::unique_ptr<GlobalStateInfo> globalInfo;
   int32_t maxIdleTime;
-  int64_t timeToConnectNanos;
-  int64_t connectionTime ; /*0*/
-
-public:
-  Pool(std::shared_ptr<UrlParser>& _urlParser, int32_t /*poolIndex*/, std::shared_ptr<ScheduledThreadPoolExecutor>& /*poolExecutor*/) : urlParser(_urlParser) {}
-
-private:
-  void addConnectionRequest();
+  /* Server's wait_timeout in seconds, read once if poolKeepAlive is set. 0 until it's known */
+  std::atomic<int32_t> waitTimeout;
+  /* Guarded by the lock */
+  std::default_random_engine rnd;
+  /* Set, if a connection past its lifetime has been given back, so the pool's thread should replace it right away */
+  std::atomic<bool> retireRequested;
+  /* Number of connections by "host:port". Guarded by the lock */
+  std::unordered_map<std::string, int32_t> hostConnections;
+  /* Only if adaptiveConcurrency or circuitBreakerThreshold options are set */
+  std::unique_ptr<AdmissionControl> admission;
+  /* Pool's own part of the pool's metrics group - the wait time. Connections' recorders are moved to the group */
+  MetricsRecorder metrics;
+  std::thread houseKeeper;
+
+  void houseKeeping();
   void removeIdleTimeoutConnection();
-  void addConnection();
-  MariaDbPooledConnection& getIdleConnection();
-  MariaDbPooledConnection& getIdleConnection(int64_t timeout, TimeUnit timeUnit);
+  void retireExpiredConnections();
+  void requestRetirement();
+  int64_t retireTime();
+  void keepAliveIdleConnections();
+  int32_t keepAliveInterval() const;
+  int64_t keepAliveTime();
+  void rebalance();
+  /* If host is given, it is tried first */
+  bool addConnection(const HostAddress* host= nullptr);
+  std::size_t localShard() const;
+  /* With the tenant, its connection is preferred */
+  std::unique_ptr<MariaDbPooledConnection> takeIdle(const SQLString* tenant= nullptr);
+  bool pushIdle(std::unique_ptr<MariaDbPooledConnection>& item);
+  bool waitForIdle(const std::chrono::steady_clock::time_point& deadline, int32_t priority, uint64_t& ticket,
+    std::unique_ptr<MariaDbPooledConnection>& item);
+  void handOver();
+  void notifyWaiter();
+  void recordWait(const std::chrono::steady_clock::time_point& start, bool failed);
+  MariaDbPooledConnection* createPoolConnection(const PoolRequest* request= nullptr, const HostAddress* host= nullptr);
+  void lend(MariaDbPooledConnection& item, const PoolRequest& request);
+  bool validate(MariaDbPooledConnection& item);
+  void discard(std::unique_ptr<MariaDbPooledConnection>& item);
   void silentCloseConnection(MariaDbPooledConnection& item);
-  void silentAbortConnection(MariaDbPooledConnection& item);
-  MariaDbPooledConnection& createPoolConnection(MariaDbConnection* connection);
+  const HostAddress& hostOf(MariaDbPooledConnection& item);
+  void initializePoolGlobalState(MariaDbConnection* connection);
+  SQLString generatePoolTag(int32_t poolIndex);
+  SQLString stateToString();
 
 public:
-  MariaDbConnection* getConnection();
-  MariaDbConnection* getConnection(SQLString& username, SQLString& password);
+  Pool(std::shared_ptr<UrlParser>& _urlParser, int32_t poolIndex);
+  ~Pool();
 
-private:
-  SQLString generatePoolTag(int32_t poolIndex);
-public:
+  /* Requests with higher priority are served first, when the pool is exhausted */
+  Connection* getConnection(const PoolRequest& request);
+  /* Returns connection to the pool. The connection is discarded if it is broken, or the pool is being closed */
+  void releaseConnection(std::unique_ptr<MariaDbPooledConnection>& item, bool broken);
   std::shared_ptr<UrlParser>& getUrlParser() { return urlParser; }
-  void close() {}
-private:
-  void closeAll(ExecutorService connectionRemover, std::list<MariaDbPooledConnection>collection);
-  void initializePoolGlobalState(MariaDbConnection& connection);
-public:
-  SQLString getPoolTag();
-  bool equals(sql::Object* obj);
-  int64_t hashCode();
-  GlobalStateInfo getGlobalInfo();
+  void close();
+
+  const SQLString& getPoolTag() const;
   int64_t getActiveConnections();
   int64_t getTotalConnections();
   int64_t getIdleConnections();
   int64_t getConnectionRequests();
-
-private:
-  void registerJmx();
-  void unRegisterJmx();
-public:
-  std::vector<int64_t>testGetConnectionIdleThreadIds();
-  void resetStaticGlobal();
+  /* For testing purposes */
+  std::vector<int64_t> testGetConnectionIdleThreadIds();
 };
 
 }
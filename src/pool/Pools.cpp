@@ -19,49 +19,126 @@
 
 
 #include "Pools.h"
+#include "StringImp.h"
 
 namespace sql
 {
 namespace mariadb
 {
   std::atomic<int32_t> Pools::poolIndex;
-  std::shared_ptr<ScheduledThreadPoolExecutor> Pools::poolExecutor;
-  /* TODO: change to std::unordered_map */
-  HashMap<UrlParser, Shared::Pool> Pools::poolMap;
+  std::mutex Pools::poolMapLock;
+  std::shared_ptr<const Pools::Registry> Pools::registry(new Pools::Registry());
 
-  //const std::map<UrlParser&, Pool>poolMap;// =new ConcurrentHashMap<>();
-  /* ScheduledThreadPoolExecutor* Pools::poolExecutor= NULL; */
+
+  std::string Pools::poolKey(UrlParser& urlParser)
+  {
+    // Users and databases of the shared pool are switched on its connections, so hosts are its only identity
+    if (urlParser.getOptions()->sharedPool) {
+      std::string key("shared:");
+
+      key.append(std::to_string(static_cast<int32_t>(urlParser.getHaMode())));
+      for (auto& host : urlParser.getHostAddresses()) {
+        key.append(1, '\0').append(StringImp::get(host.host)).append(1, ':').append(std::to_string(host.port));
+      }
+      return key;
+    }
+    std::string key(StringImp::get(urlParser.getInitialUrl()));
+
+    key.append(1, '\0').append(StringImp::get(urlParser.getUsername()));
+    key.append(1, '\0').append(StringImp::get(urlParser.getPassword()));
+    return key;
+  }
+
+  /**
+    * Key of the connect parameters exactly as they were passed by the application. Same parameters are always parsed to
+    * the same configuration, thus they can be used to find the pool without parsing.
+    *
+    * @param url connection url
+    * @param props connection properties
+    * @return key for findPool
+    */
+  std::string Pools::connectKey(const SQLString& url, const Properties& props)
+  {
+    std::string key(StringImp::get(url));
+
+    for (const auto& prop : props) {
+      key.append(1, '\0').append(StringImp::get(prop.first)).append(1, '=').append(StringImp::get(prop.second));
+    }
+    return key;
+  }
+
+  /**
+    * Get existing pool for the connect parameters, that have been used for a pool before. Doesn't lock.
+    *
+    * @param connectKey key of connect parameters
+    * @param request parameters of the request for a connection, if the pool is found
+    * @return pool or empty pointer if parameters have to be parsed
+    */
+  Shared::Pool Pools::findPool(const std::string& connectKey, PoolRequest& request)
+  {
+    std::shared_ptr<const Registry> current(std::atomic_load(&registry));
+    auto cit= current->connectStrings.find(connectKey);
+
+    if (cit == current->connectStrings.end()) {
+      return Shared::Pool();
+    }
+    request= cit->second.second;
+    return cit->second.first;
+  }
 
   /**
     * Get existing pool for a configuration. Create it if doesn't exists.
     *
     * @param urlParser configuration parser
+    * @param connectKey key of connect parameters, that were parsed by urlParser. If not empty, pool will be found by it
+    *        next time
     * @return pool
     */
-  Shared::Pool Pools::retrievePool(std::shared_ptr<UrlParser>& urlParser)
+  Shared::Pool Pools::retrievePool(std::shared_ptr<UrlParser>& urlParser, const std::string& connectKey)
   {
-    auto cit= poolMap.find(*urlParser);
-    if (cit == poolMap.end())
-    {
-      //synchronized(poolMap)
-      {
-        cit= poolMap.find(*urlParser);
+    const std::string key(poolKey(*urlParser));
+    std::shared_ptr<const Registry> current(std::atomic_load(&registry));
+    auto cit= current->pools.find(key);
 
-        if (cit == poolMap.end())
-        {
-          if (!poolExecutor)
-          {
-            poolExecutor.reset(new ScheduledThreadPoolExecutor()); //1, new MariaDbThreadFactory("MariaDbPool-maxTimeoutIdle-checker"));
-          }
-          Shared::Pool pool(new Pool(urlParser, ++poolIndex, poolExecutor));
-          poolMap.insert(*urlParser, pool);
-
-          return pool;
-        }
-      }
+    if (cit != current->pools.end() && (connectKey.empty() || current->connectStrings.count(connectKey) != 0)) {
+      return cit->second;
+    }
+
+    std::lock_guard<std::mutex> localScopeLock(poolMapLock);
+    std::shared_ptr<Registry> copy(new Registry(*registry));
+    Shared::Pool& pool= copy->pools[key];
+
+    if (!pool) {
+      pool.reset(new Pool(urlParser, ++poolIndex));
     }
+    if (!connectKey.empty()) {
+      copy->connectStrings.emplace(connectKey, std::make_pair(pool, PoolRequest(*urlParser)));
+    }
+    Shared::Pool result(pool);
+    std::atomic_store(&registry, std::shared_ptr<const Registry>(std::move(copy)));
 
-    return cit->second;
+    return result;
+  }
+
+
+  void Pools::erase(Registry& copy, Pool* pool)
+  {
+    for (auto it= copy.connectStrings.begin(); it != copy.connectStrings.end();) {
+      if (it->second.first.get() == pool) {
+        it= copy.connectStrings.erase(it);
+      }
+      else {
+        ++it;
+      }
+    }
+    for (auto it= copy.pools.begin(); it != copy.pools.end();) {
+      if (it->second.get() == pool) {
+        it= copy.pools.erase(it);
+      }
+      else {
+        ++it;
+      }
+    }
   }
 
   /**
@@ -71,36 +148,29 @@ namespace mariadb
     */
   void Pools::remove(Pool &pool)
   {
-    if (poolMap.find(*pool.getUrlParser()) != poolMap.end())
-    {
-      //synchronized(poolMap)
-      {
-        if (poolMap.find(*pool.getUrlParser()) != poolMap.end())
-        {
-          poolMap.remove(*pool.getUrlParser());
-          shutdownExecutor();
-        }
-      }
-    }
+    std::lock_guard<std::mutex> localScopeLock(poolMapLock);
+    std::shared_ptr<Registry> copy(new Registry(*registry));
+
+    erase(*copy, &pool);
+    std::atomic_store(&registry, std::shared_ptr<const Registry>(std::move(copy)));
   }
 
   /** Close all pools. */
   void Pools::close()
   {
-    //synchronized(poolMap)
+    std::lock_guard<std::mutex> localScopeLock(poolMapLock);
+    std::shared_ptr<const Registry> current(registry);
+
+    for (auto& it : current->pools)
     {
-      for (auto& it : poolMap)
-      {
-        try {
-          it.second->close();
-        }
-        catch (std::exception&) {
+      try {
+        it.second->close();
+      }
+      catch (std::exception&) {
 
-        }
       }
-      shutdownExecutor();
-      poolMap.clear();
     }
+    std::atomic_store(&registry, std::shared_ptr<const Registry>(new Registry()));
   }
 
   /**
@@ -114,43 +184,28 @@ namespace mariadb
     {
       return;
     }
-    //synchronized(poolMap)
+    std::lock_guard<std::mutex> localScopeLock(poolMapLock);
+    std::shared_ptr<const Registry> current(registry);
+
+    for (auto& it : current->pools)
     {
-      for (auto& it : poolMap)
+      if (poolName.compare(it.second->getUrlParser()->getOptions()->poolName) == 0)
       {
-        if (poolName.compare(it.second->getUrlParser()->getOptions()->poolName) == 0)
+        try
         {
-          try
-          {
-            it.second->close();
-          }
-          catch (std::exception&)
-          {
-          }
-          poolMap.remove(*it.second->getUrlParser());
-          return;
+          it.second->close();
         }
-      }
+        catch (std::exception&)
+        {
+        }
+        std::shared_ptr<Registry> copy(new Registry(*current));
 
-      if (poolMap.empty())
-      {
-        shutdownExecutor();
+        erase(*copy, it.second.get());
+        std::atomic_store(&registry, std::shared_ptr<const Registry>(std::move(copy)));
+        return;
       }
     }
   }
 
-  void Pools::shutdownExecutor()
-  {
-    poolExecutor->shutdown();
-    try
-    {
-      poolExecutor->awaitTermination(10, TimeUnit::SECONDS);
-    }
-    catch (std::exception&)
-    {
-    }
-    poolExecutor= NULL;
-  }
-
 }
-}
\ No newline at end of file
+}
@@ -23,8 +23,10 @@
 #define _POOLS_H_
 
 #include <atomic>
-#include <map>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 
 #include "UrlParser.h"
 #include "Pool.h"
@@ -33,96 +35,34 @@ namespace sql
 {
 namespace mariadb
 {
-//class Pool;
-
-/*Stub to enable build */
-class ScheduledThreadPoolExecutor
-{
-public:
-  //ScheduledThreadPoolExecutor(int32_t, MariaDbThreadFactory*) {}
-  void shutdown() {}
-  void awaitTermination(int32_t /*time*/, enum TimeUnit /*unit*/) {}
-};
-
-
-template <class HASHABLEKEY, class VT> class HashMap
-{
-  std::map<int64_t, VT> realMap;
-
-public:
-  typedef typename std::map<int64_t, VT>::iterator iterator;
-  typedef typename std::map<int64_t, VT>::const_iterator const_iterator;
-
-  void put(HASHABLEKEY& hashableObj, VT& valueObj)
-  {
-    realMap[hashableObj.hashCode()]= valueObj;
-  }
-
-  void insert(const HASHABLEKEY& hashableObj, VT& valueObj)
-  {
-    realMap.insert({ hashableObj.hashCode(), valueObj });
-  }
-
-  void remove(HASHABLEKEY& hashableObj)
-  {
-    realMap.erase(hashableObj.hashCode());
-  }
-
-  void clear()
-  {
-    realMap.clear();
-  }
-
-  bool empty() const
-  {
-    return realMap.empty();
-  }
-  typename std::map<int64_t, VT>::iterator find(const HASHABLEKEY& hashableObj)
-  {
-    return realMap.find(hashableObj.hashCode());
-  }
-
-  typename std::map<int64_t, VT>::iterator begin()
-  {
-    return realMap.begin();
-  }
-
-  typename std::map<int64_t, VT>::iterator end()
-  {
-    return realMap.end();
-  }
-
-  typename std::map<int64_t, VT>::const_iterator find(const HASHABLEKEY& hashableObj) const
-  {
-    return realMap.find(hashableObj.hashCode());
-  }
-
-  typename std::map<int64_t, VT>::const_iterator cbegin() const
-  {
-    return realMap.cbegin();
-  }
-
-  typename std::map<int64_t, VT>::const_iterator cend() const
-  {
-    return realMap.cend();
-  }
-};
-
 
 class Pools
 {
+    /* Registry is never changed once published. Lookups take current registry without locking, and changes are made
+       on its copy under poolMapLock, that then replaces it. Pools are created rarely, and looked up on each connect */
+    struct Registry
+    {
+      // Pools by url, user and password - the same, that UrlParser::equals compares
+      std::unordered_map<std::string, Shared::Pool> pools;
+      // Pools by url and properties exactly as application passed them, with the parameters of the requests they
+      // make. Allows to skip url parsing on next connects
+      std::unordered_map<std::string, std::pair<Shared::Pool, PoolRequest>> connectStrings;
+    };
+
     static std::atomic<int32_t> poolIndex ; /*new std::atomic<int32_t>()*/
-    static HashMap<UrlParser,Shared::Pool> poolMap; /*new ConcurrentHashMap<>()*/
-    static std::shared_ptr<ScheduledThreadPoolExecutor> poolExecutor; /*NULL*/
+    static std::shared_ptr<const Registry> registry;
+    static std::mutex poolMapLock;
+
+    static std::string poolKey(UrlParser& urlParser);
+    static void erase(Registry& copy, Pool* pool);
 
   public:
-    static Shared::Pool retrievePool(std::shared_ptr<UrlParser>& urlParser);
+    static std::string connectKey(const SQLString& url, const Properties& props);
+    static Shared::Pool findPool(const std::string& connectKey, PoolRequest& request);
+    static Shared::Pool retrievePool(std::shared_ptr<UrlParser>& urlParser, const std::string& connectKey= "");
     static void remove(Pool& pool);
     static void close();
     static void close(const SQLString& poolName);
-
-  private:
-    static void shutdownExecutor();
 };
 
 }
@@ -19,15 +19,18 @@
 
 
 #include <mutex>
+#include <condition_variable>
 #include <random>
 #include <thread>
 
 #include "MasterProtocol.h"
 
 #include "UrlParser.h"
+#include "HostHealthRegistry.h"
 #include "pool/GlobalStateInfo.h"
 #include "failover/FailoverProxy.h"
 #include "util/LogQueryTool.h"
+#include "util/Utils.h"
 
 namespace sql
 {
@@ -148,6 +151,95 @@ namespace mariadb
     throw SQLException("No active connection found for master");
   }
 
+  /* State shared by the connectRace and its connection attempts. Attempts may outlive the connectRace call */
+  struct ConnectRace
+  {
+    std::mutex mutex;
+    std::condition_variable attemptFinished;
+    Shared::Protocol winner;
+    std::size_t failed= 0;
+    SQLException lastError;
+  };
+
+  static void attemptConnect(std::shared_ptr<ConnectRace> race, std::shared_ptr<UrlParser> urlParser,
+    GlobalStateInfo* globalInfo, HostAddress host)
+  {
+    Shared::mutex lock(new ConnectionMutex(urlParser->getOptions()->threadSafeConnection));
+    Shared::Protocol protocol(Utils::getProxyLoggingIfNeeded(*urlParser, new MasterProtocol(urlParser, globalInfo, lock)));
+
+    try {
+      protocol->setHostAddress(host);
+      protocol->connect();
+    }
+    catch (SQLException& e) {
+      if (HostHealthRegistry::isHostFailure(e.getErrorCode())) {
+        HostHealthRegistry::getInstance().addToBlacklist(host, urlParser->getUsername(), urlParser->getPassword(),
+          urlParser->getOptions()->loadBalanceBlacklistTimeout);
+      }
+      std::lock_guard<std::mutex> raceLock(race->mutex);
+      ++race->failed;
+      race->lastError= e;
+      race->attemptFinished.notify_all();
+      return;
+    }
+
+    std::unique_lock<std::mutex> raceLock(race->mutex);
+    if (!race->winner) {
+      race->winner= protocol;
+      race->attemptFinished.notify_all();
+      return;
+    }
+    raceLock.unlock();
+    // Somebody was faster
+    protocol->close();
+  }
+
+  /**
+   * Connects to one of the url hosts, starting connection attempts with connectAttemptDelay interval, or right after
+   * all previously started attempts have failed. Thus a black-holed host does not cost connectTimeout. The first
+   * established connection is returned. Attempts, that have not been started yet, are cancelled, and connections of
+   * those in progress are closed once established.
+   *
+   * @param urlParser connection URL infos
+   * @param globalInfo server global variables information
+   * @return connected protocol
+   * @throws SQLException if connection to none of hosts could be established
+   */
+  Shared::Protocol MasterProtocol::connectRace(std::shared_ptr<UrlParser>& urlParser, GlobalStateInfo* globalInfo)
+  {
+    std::vector<HostAddress> hosts(urlParser->getHostAddresses());
+    std::chrono::milliseconds delay(urlParser->getOptions()->connectAttemptDelay);
+    auto race= std::make_shared<ConnectRace>();
+
+    if (urlParser->getHaMode() == HaMode::LOADBALANCE) {
+      HostHealthRegistry::getInstance().order(hosts);
+    }
+    else {
+      HostHealthRegistry::getInstance().moveUnhealthyLast(hosts);
+    }
+
+    std::unique_lock<std::mutex> raceLock(race->mutex);
+
+    for (std::size_t started= 0; started < hosts.size();) {
+      std::thread(attemptConnect, race, urlParser, globalInfo, hosts[started]).detach();
+      ++started;
+      race->attemptFinished.wait_for(raceLock, delay, [&race, started]{ return race->winner || race->failed == started; });
+      if (race->winner) {
+        return race->winner;
+      }
+    }
+    race->attemptFinished.wait(raceLock, [&race, &hosts]{ return race->winner || race->failed == hosts.size(); });
+
+    if (race->winner) {
+      return race->winner;
+    }
+    throw SQLException(
+      ("Could not connect to " + HostAddress::toString(hosts) + " : " + race->lastError.getMessage()).c_str(),
+      race->lastError.getSQLStateCStr(),
+      race->lastError.getErrorCode(),
+      &race->lastError);
+  }
+
   /**
    * Reinitialize loopAddresses with all hosts : all servers in randomize order without connected
    * host.
@@ -157,11 +249,9 @@ namespace mariadb
    */
   void MasterProtocol::resetHostList(Listener* listener, std::list<HostAddress>& loopAddresses)
   {
-    static auto rnd = std::default_random_engine{};
-
     std::vector<HostAddress> servers(listener->getUrlParser()->getHostAddresses());
 
-    std::shuffle(servers.begin(), servers.end(), rnd);
+    HostHealthRegistry::getInstance().order(servers);
 
     loopAddresses.clear();
     std::copy(servers.begin(), servers.end(), loopAddresses.begin());
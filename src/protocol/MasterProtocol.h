@@ -36,7 +36,9 @@ namespace mariadb
 class Listener;
 class SearchFilter;
 
-class MasterProtocol  : public capi::QueryProtocol
+/* The protocol of the connections without proxy. It is final, so the statements' calls through the MasterProtocol
+   pointer are resolved at compile time */
+class MasterProtocol final : public capi::QueryProtocol
 {
   typedef capi::QueryProtocol super;
 
@@ -46,6 +48,7 @@ class MasterProtocol  : public capi::QueryProtocol
 public:
   MasterProtocol(std::shared_ptr<UrlParser>& urlParser, GlobalStateInfo* globalInfo, Shared::mutex& lock);
   static void loop(Listener* listener, GlobalStateInfo& globalInfo, const std::vector<HostAddress>& addresses, SearchFilter* searchFilter);
+  static Shared::Protocol connectRace(std::shared_ptr<UrlParser>& urlParser, GlobalStateInfo* globalInfo);
   ~MasterProtocol() {}
 };
 }
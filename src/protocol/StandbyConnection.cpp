@@ -0,0 +1,145 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+#include "StandbyConnection.h"
+#include "MasterProtocol.h"
+
+#include "UrlParser.h"
+#include "HostHealthRegistry.h"
+
+namespace sql
+{
+namespace mariadb
+{
+  /* State shared by the StandbyConnection and its keeping thread */
+  struct StandbyState
+  {
+    std::mutex mutex;
+    std::condition_variable stopRequested;
+    bool stopped= false;
+    // Connected standby, that is not being pinged at the moment
+    std::unique_ptr<MasterProtocol> protocol;
+  };
+
+  /* Connects to the first healthy host other than the primary, or returns nullptr if none is reachable */
+  static MasterProtocol* connectStandby(const std::shared_ptr<UrlParser>& urlParser, const HostAddress& primary)
+  {
+    std::shared_ptr<UrlParser> parser(urlParser);
+    std::vector<HostAddress> hosts(urlParser->getHostAddresses());
+    HostHealthRegistry::getInstance().moveUnhealthyLast(hosts);
+
+    for (const auto& host : hosts) {
+      if (host.port == primary.port && host.host.compare(primary.host) == 0) {
+        continue;
+      }
+      Shared::mutex lock(new ConnectionMutex(false));
+      std::unique_ptr<MasterProtocol> protocol(new MasterProtocol(parser, nullptr, lock));
+      try {
+        protocol->setHostAddress(host);
+        protocol->connect();
+        return protocol.release();
+      }
+      catch (SQLException& e) {
+        if (HostHealthRegistry::isHostFailure(e.getErrorCode())) {
+          HostHealthRegistry::getInstance().addToBlacklist(host, urlParser->getUsername(), urlParser->getPassword(),
+            urlParser->getOptions()->loadBalanceBlacklistTimeout);
+        }
+      }
+    }
+    return nullptr;
+  }
+
+  /* Connects the standby, and pings it every failoverStandbyPingInterval. The failed standby is replaced on the next
+     round. The connection and the ping are done without holding the lock, so take() never waits for them */
+  static void keepStandby(std::shared_ptr<StandbyState> state, std::shared_ptr<UrlParser> urlParser, HostAddress primary)
+  {
+    std::chrono::milliseconds interval(urlParser->getOptions()->failoverStandbyPingInterval);
+    std::unique_lock<std::mutex> stateLock(state->mutex);
+    std::unique_ptr<MasterProtocol> standby;
+
+    while (!state->stopped) {
+      standby= std::move(state->protocol);
+      stateLock.unlock();
+
+      if (standby && !standby->ping()) {
+        standby->close();
+        standby.reset();
+      }
+      if (!standby) {
+        standby.reset(connectStandby(urlParser, primary));
+      }
+
+      stateLock.lock();
+      if (state->stopped) {
+        break;
+      }
+      state->protocol= std::move(standby);
+      state->stopRequested.wait_for(stateLock, interval, [&state]{ return state->stopped; });
+    }
+    stateLock.unlock();
+    // Nobody took the standby
+    if (standby) {
+      standby->close();
+    }
+  }
+
+
+  StandbyConnection::StandbyConnection(const std::shared_ptr<UrlParser>& urlParser, const HostAddress& primary)
+    : state(std::make_shared<StandbyState>())
+  {
+    std::thread(keepStandby, state, urlParser, primary).detach();
+  }
+
+
+  StandbyConnection::~StandbyConnection()
+  {
+    std::unique_ptr<MasterProtocol> standby;
+    {
+      std::lock_guard<std::mutex> stateLock(state->mutex);
+      state->stopped= true;
+      standby= std::move(state->protocol);
+    }
+    state->stopRequested.notify_all();
+    if (standby) {
+      standby->close();
+    }
+  }
+
+
+  std::unique_ptr<MasterProtocol> StandbyConnection::take()
+  {
+    std::unique_ptr<MasterProtocol> standby;
+    {
+      std::lock_guard<std::mutex> stateLock(state->mutex);
+      if (!state->protocol || !state->protocol->isConnected()) {
+        return standby;
+      }
+      state->stopped= true;
+      standby= std::move(state->protocol);
+    }
+    state->stopRequested.notify_all();
+    return standby;
+  }
+}
+}
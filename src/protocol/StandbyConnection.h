@@ -0,0 +1,52 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _STANDBYCONNECTION_H_
+#define _STANDBYCONNECTION_H_
+
+#include <memory>
+
+#include "HostAddress.h"
+
+namespace sql
+{
+namespace mariadb
+{
+class UrlParser;
+class MasterProtocol;
+struct StandbyState;
+
+/* Connection to one of the url's hosts other than the primary's one, that is established and kept alive by the
+   background thread, so that the failover can take it over instead of connecting. The thread may outlive the object -
+   it's told to stop, and closes the standby itself */
+class StandbyConnection
+{
+  std::shared_ptr<StandbyState> state;
+
+public:
+  StandbyConnection(const std::shared_ptr<UrlParser>& urlParser, const HostAddress& primary);
+  ~StandbyConnection();
+  /* The standby, if it's connected and is not being pinged at the moment. The keeping thread stops then */
+  std::unique_ptr<MasterProtocol> take();
+};
+
+}
+}
+#endif
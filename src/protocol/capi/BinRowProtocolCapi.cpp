@@ -18,11 +18,17 @@
 *************************************************************************************/
 
 
+#include <algorithm>
 #include <sstream>
+#include <cstring>
 
 #include "BinRowProtocolCapi.h"
 
 #include "ColumnDefinition.h"
+#include "util/ServerPrepareResult.h"
+#include "util/DateTimeCodec.h"
+#include "util/DecimalCodec.h"
+#include "util/MemoryAccounting.h"
 #include "ExceptionFactory.h"
 
 namespace sql
@@ -38,38 +44,50 @@ namespace capi
     * @param columnInformationLength number of columns
     * @param maxFieldSize max field size
     * @param options connection options
+    * @param spr prepare result, that owns C API statement handle and result bind buffers
     */
    BinRowProtocolCapi::BinRowProtocolCapi(
     std::vector<Shared::ColumnDefinition>& _columnInformation,
     int32_t _columnInformationLength,
     uint32_t _maxFieldSize,
     Shared::Options options,
-    MYSQL_STMT* capiStmtHandle)
+    ServerPrepareResult* spr)
      : RowProtocol(_maxFieldSize, options)
      , columnInformation(_columnInformation)
      , columnInformationLength(_columnInformationLength)
-     , stmt(capiStmtHandle)
+     , stmt(spr->getStatementId())
+     , bind(spr->getResultBind())
+     , deferred(_columnInformation.size(), false)
+     , chunkSize(static_cast<uint32_t>(options->blobChunkSize))
   {
-     bind.reserve(mysql_stmt_field_count(stmt));
+     bind.resize(columnInformation.size());
 
-     for (auto& columnInfo : columnInformation)
+     for (std::size_t i= 0; i < columnInformation.size(); ++i)
      {
+       auto& columnInfo= columnInformation[i];
+       MYSQL_BIND& columnBind= bind[i];
        length= columnInfo->getLength();
        maxFieldSize= columnInfo->getMaxLength();
        //TODO maybe change property type in the ColumnInfo?
-       bind.emplace_back();
+       std::memset(&columnBind, 0, sizeof(columnBind));
 
-       bind.back().buffer_type=   static_cast<enum_field_types>(columnInfo->getColumnType().getType());
-       if (bind.back().buffer_type == MYSQL_TYPE_VARCHAR) {
-         bind.back().buffer_type= MYSQL_TYPE_STRING;
+       columnBind.buffer_type=   static_cast<enum_field_types>(columnInfo->getColumnType().getType());
+       if (columnBind.buffer_type == MYSQL_TYPE_VARCHAR) {
+         columnBind.buffer_type= MYSQL_TYPE_STRING;
        }
-       bind.back().buffer_length= static_cast<unsigned long>(columnInfo->getColumnType().binarySize() != 0 ?
+       columnBind.buffer_length= static_cast<unsigned long>(columnInfo->getColumnType().binarySize() != 0 ?
                                                          columnInfo->getColumnType().binarySize() :
                                                          getLengthMaxFieldSize());
-       bind.back().buffer=        new uint8_t[bind.back().buffer_length];
-       bind.back().length=        &bind.back().length_value;
-       bind.back().is_null=       &bind.back().is_null_value;
-       bind.back().error=         &bind.back().error_value;
+       if (isDeferred(columnBind.buffer_type)) {
+         // Only the length is fetched with the row
+         columnBind.buffer_length= 0;
+         deferred[i]= true;
+         hasDeferred= true;
+       }
+       columnBind.buffer=        spr->getResultBuffer(i, columnBind.buffer_length);
+       columnBind.length=        &columnBind.length_value;
+       columnBind.is_null=       &columnBind.is_null_value;
+       columnBind.error=         &columnBind.error_value;
      }
      maxFieldSize= 0;
      if (mysql_stmt_bind_result(stmt, bind.data())) {
@@ -80,12 +98,32 @@ namespace capi
 
    BinRowProtocolCapi::~BinRowProtocolCapi()
    {
-     for (auto& columnBind : bind)
-     {
-       delete[] (uint8_t*)columnBind.buffer;
-     }
    }
 
+
+  /* BLOBs are deferred with blobChunkSize, and all variable length values with lazyColumnFetch */
+  bool BinRowProtocolCapi::isDeferred(enum_field_types type) const
+  {
+    switch (type) {
+    case MYSQL_TYPE_TINY_BLOB:
+    case MYSQL_TYPE_MEDIUM_BLOB:
+    case MYSQL_TYPE_LONG_BLOB:
+    case MYSQL_TYPE_BLOB:
+      return chunkSize > 0 || options->lazyColumnFetch;
+    case MYSQL_TYPE_STRING:
+    case MYSQL_TYPE_VAR_STRING:
+    case MYSQL_TYPE_JSON:
+    case MYSQL_TYPE_ENUM:
+    case MYSQL_TYPE_SET:
+    case MYSQL_TYPE_DECIMAL:
+    case MYSQL_TYPE_NEWDECIMAL:
+    case MYSQL_TYPE_GEOMETRY:
+      return options->lazyColumnFetch;
+    default:
+      return false;
+    }
+  }
+
   /**
     * Set length and pos indicator to requested index.
     *
@@ -98,28 +136,191 @@ namespace capi
     index= newIndex;
     pos= 0;
 
-    if (buf != nullptr) {
+    if (arena != nullptr) {
+      setArenaPosition();
+    }
+    else if (buf != nullptr) {
       fieldBuf.wrap((*buf)[index], (*buf)[index].size());
       this->lastValueNull = fieldBuf ? BIT_LAST_FIELD_NOT_NULL : BIT_LAST_FIELD_NULL;
       length = static_cast<uint32_t>(fieldBuf.size());
     }
     else {
       length = bind[index].length_value;
-      fieldBuf.wrap(static_cast<char*>(bind[index].buffer), length);
       this->lastValueNull = bind[index].is_null_value ? BIT_LAST_FIELD_NULL : BIT_LAST_FIELD_NOT_NULL;
+      if (deferred[index] && !bind[index].is_null_value) {
+        fetchDeferred(index);
+        fieldBuf.wrap(deferredValue.data(), length);
+      }
+      else {
+        fieldBuf.wrap(static_cast<char*>(bind[index].buffer), length);
+      }
     }
   }
 
 
+  /* Reads the whole value of the deferred column of the current row into deferredValue, unless it is there already */
+  void BinRowProtocolCapi::fetchDeferred(int32_t column)
+  {
+    MYSQL_BIND columnBind;
+    unsigned long fetched= 0;
+    my_bool error= 0;
+
+    if (column == deferredColumn) {
+      return;
+    }
+    std::memset(&columnBind, 0, sizeof(columnBind));
+    deferredValue.resize(std::max<std::size_t>(bind[column].length_value, 1));
+    columnBind.buffer_type= bind[column].buffer_type;
+    columnBind.buffer= deferredValue.data();
+    columnBind.buffer_length= static_cast<unsigned long>(deferredValue.size());
+    columnBind.length= &fetched;
+    columnBind.error= &error;
+
+    if (mysql_stmt_fetch_column(stmt, &columnBind, static_cast<unsigned int>(column), 0)) {
+      deferredColumn= -1;
+      throwStmtError(stmt);
+    }
+    deferredColumn= column;
+  }
+
+
+  /* Reads BLOB or TEXT value from the row, that the C API holds, in chunks of the given size */
+  class ColumnChunkBuf : public std::streambuf
+  {
+    MYSQL_STMT* stmt;
+    unsigned int column;
+    enum_field_types type;
+    std::size_t total;
+    // Offset of the chunk's end in the value
+    std::size_t offset= 0;
+    std::vector<char> chunk;
+
+    std::size_t position() const { return offset - (egptr() - gptr()); }
+
+  public:
+    ColumnChunkBuf(MYSQL_STMT* _stmt, unsigned int _column, enum_field_types _type, std::size_t _total,
+      std::size_t chunkSize)
+      : stmt(_stmt)
+      , column(_column)
+      , type(_type)
+      , total(_total)
+      , chunk(chunkSize)
+    {
+      setg(chunk.data(), chunk.data(), chunk.data());
+      MemoryAccounting::get(MemoryAccounting::LARGE_VALUES).add(chunk.size());
+    }
+
+    ~ColumnChunkBuf()
+    {
+      MemoryAccounting::get(MemoryAccounting::LARGE_VALUES).release(chunk.size());
+    }
+
+  protected:
+    int_type underflow() override
+    {
+      if (gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+      }
+      if (offset >= total) {
+        return traits_type::eof();
+      }
+      MYSQL_BIND columnBind;
+      unsigned long fetched= 0;
+      my_bool error= 0;
+
+      std::memset(&columnBind, 0, sizeof(columnBind));
+      columnBind.buffer_type= type;
+      columnBind.buffer= chunk.data();
+      columnBind.buffer_length= static_cast<unsigned long>(chunk.size());
+      columnBind.length= &fetched;
+      columnBind.error= &error;
+      // Failure of the stream's underflow is the end of the data
+      if (mysql_stmt_fetch_column(stmt, &columnBind, column, static_cast<unsigned long>(offset))) {
+        return traits_type::eof();
+      }
+      std::size_t chunkLength= std::min(chunk.size(), total - offset);
+      setg(chunk.data(), chunk.data(), chunk.data() + chunkLength);
+      offset+= chunkLength;
+
+      return traits_type::to_int_type(*gptr());
+    }
+
+    std::streamsize showmanyc() override
+    {
+      return static_cast<std::streamsize>(total - position());
+    }
+
+    pos_type seekoff(off_type off, std::ios_base::seekdir direction, std::ios_base::openmode /*which*/) override
+    {
+      off_type target= off;
+
+      if (direction == std::ios_base::cur) {
+        target+= static_cast<off_type>(position());
+      }
+      else if (direction == std::ios_base::end) {
+        target+= static_cast<off_type>(total);
+      }
+      if (target < 0 || target > static_cast<off_type>(total)) {
+        return pos_type(off_type(-1));
+      }
+      // Next read starts the new chunk at the target
+      offset= static_cast<std::size_t>(target);
+      setg(chunk.data(), chunk.data(), chunk.data());
+
+      return pos_type(target);
+    }
+
+    pos_type seekpos(pos_type position, std::ios_base::openmode which) override
+    {
+      return seekoff(position - pos_type(off_type(0)), std::ios_base::beg, which);
+    }
+  };
+
+
+  bool BinRowProtocolCapi::setStreamPosition(int32_t newIndex)
+  {
+    if (arena != nullptr || buf != nullptr || !deferred[newIndex]) {
+      setPosition(newIndex);
+      return false;
+    }
+    index= newIndex;
+    pos= 0;
+    length= bind[index].length_value;
+    fieldBuf.wrap(nullptr, 0);
+    this->lastValueNull= bind[index].is_null_value ? BIT_LAST_FIELD_NULL : BIT_LAST_FIELD_NOT_NULL;
+
+    return true;
+  }
+
+
+  std::streambuf* BinRowProtocolCapi::getInternalStreamBuf()
+  {
+    return new ColumnChunkBuf(stmt, static_cast<unsigned int>(index), bind[index].buffer_type, length, chunkSize);
+  }
+
+
   int32_t BinRowProtocolCapi::fetchNext()
   {
-    return mysql_stmt_fetch(stmt);
+    int32_t rc= mysql_stmt_fetch(stmt);
+
+    deferredColumn= -1;
+    // Deferred columns are truncated always. Only truncation of other columns is reported
+    if (rc == MYSQL_DATA_TRUNCATED && hasDeferred) {
+      for (std::size_t i= 0; i < bind.size(); ++i) {
+        if (!deferred[i] && bind[i].error_value) {
+          return rc;
+        }
+      }
+      return 0;
+    }
+    return rc;
   }
 
 
   void BinRowProtocolCapi::installCursorAtPosition(int32_t rowPtr)
   {
     mysql_stmt_data_seek(stmt, static_cast<unsigned long long>(rowPtr));
+    deferredColumn= -1;
   }
 
 
@@ -223,6 +424,29 @@ namespace capi
     return result;
   }
 
+  bool BinRowProtocolCapi::isRawStringValue(ColumnDefinition* columnInfo)
+  {
+    switch (columnInfo->getColumnType().getType()) {
+    case MYSQL_TYPE_BIT:
+    case MYSQL_TYPE_TINY:
+    case MYSQL_TYPE_SHORT:
+    case MYSQL_TYPE_LONG:
+    case MYSQL_TYPE_INT24:
+    case MYSQL_TYPE_LONGLONG:
+    case MYSQL_TYPE_DOUBLE:
+    case MYSQL_TYPE_FLOAT:
+    case MYSQL_TYPE_TIME:
+    case MYSQL_TYPE_DATE:
+    case MYSQL_TYPE_YEAR:
+    case MYSQL_TYPE_TIMESTAMP:
+    case MYSQL_TYPE_DATETIME:
+    case MYSQL_TYPE_NULL:
+      return false;
+    default:
+      return true;
+    }
+  }
+
   /**
     * Get int from raw binary format.
     *
@@ -738,56 +962,39 @@ namespace capi
   }
 
 
+  static void toDateTime(const MYSQL_TIME* mt, DateTime& value)
+  {
+    value.year= mt->year;
+    value.month= mt->month;
+    value.day= mt->day;
+    value.hour= mt->hour;
+    value.minute= mt->minute;
+    value.second= mt->second;
+    value.nanos= static_cast<uint32_t>(mt->second_part*1000);
+    value.negative= mt->neg != 0;
+  }
+
+
   SQLString makeStringFromTimeStruct(MYSQL_TIME* mt, enum_field_types type, size_t decimals)
   {
-    std::ostringstream out;
-    if (mt->neg != 0)
-    {
-      out << "-";
-    }
+    DateTime value;
+    char buffer[DateTimeCodec::MAX_LENGTH];
+    // Binary protocol gives microseconds, and they are written with all 6 digits
+    uint32_t fractionDigits= decimals > 0 ? 6 : 0;
 
+    toDateTime(mt, value);
     switch (type) {
     case MYSQL_TYPE_TIMESTAMP:
     case MYSQL_TYPE_DATETIME:
+      return SQLString(buffer, DateTimeCodec::formatDateTime(value, fractionDigits, buffer));
     case MYSQL_TYPE_DATE:
-      out << mt->year << "-" << (mt->month < 10 ? "0" : "") << mt->month << "-" << (mt->day < 10 ? "0" : "") << mt->day;
-      if (type == MYSQL_TYPE_DATE) {
-        break;
-      }
-      out << " ";
-      // fall through
+      return SQLString(buffer, DateTimeCodec::formatDate(value, buffer));
     case MYSQL_TYPE_TIME:
-      out << (mt->hour < 10 ? "0" : "") << mt->hour << ":" << (mt->minute < 10 ? "0" : "") << mt->minute << ":" << (mt->second < 10 ? "0" : "") << mt->second;
-
-      if (mt->second_part != 0 && decimals > 0)
-      {
-        SQLString digits(std::to_string(mt->second_part));
-
-        if (digits.length() > std::min(decimals, (size_t)6U))
-        {
-          digits= digits.substr(0, 6);
-        }
-        size_t padZeros= std::min(decimals, 6 - digits.length());
-
-        out << ".";
-
-        if (digits.length() + padZeros > 6)
-        {
-          digits= digits.substr(0, 6 - padZeros);
-        }
-
-        while (padZeros--) {
-          out << "0";
-        }
-
-        out << digits.c_str();
-      }
-      break;
+      return SQLString(buffer, DateTimeCodec::formatTime(value, fractionDigits, buffer));
     default:
       // clang likes options for all enum members. Other types should not normally happen here. Probably would be better to throw here an exception
       return emptyStr;
     }
-    return out.str();
   }
 
 
@@ -856,6 +1063,22 @@ namespace capi
       }
     }
   }
+
+  /* Values returned for NULL and zero values */
+  static std::unique_ptr<Time> zeroTime(uint32_t decimals)
+  {
+    std::unique_ptr<Time> result(new Time("00:00:00"));
+    padZeroMicros(*result, decimals);
+    return result;
+  }
+
+  static std::unique_ptr<Timestamp> zeroTimestamp(uint32_t decimals)
+  {
+    std::unique_ptr<Timestamp> result(new Timestamp("0000-00-00 00:00:00"));
+    padZeroMicros(*result, decimals);
+    return result;
+  }
+
   /**
     * Get time from raw binary format.
     *
@@ -867,12 +1090,8 @@ namespace capi
     */
   std::unique_ptr<Time> BinRowProtocolCapi::getInternalTime(ColumnDefinition* columnInfo, Calendar* /*cal*/, TimeZone* /*timeZone*/)
   {
-    std::unique_ptr<Time> nullTime(new Date("00:00:00"));
-
-    padZeroMicros(*nullTime, columnInfo->getDecimals());
-
     if (lastValueWasNull()) {
-      return nullTime;
+      return zeroTime(columnInfo->getDecimals());
     }
     switch (columnInfo->getColumnType().getType()) {
     case MYSQL_TYPE_TIMESTAMP:
@@ -889,7 +1108,7 @@ namespace capi
 
       /*if (rawValue.compare(*nullTime) == 0 || rawValue.compare("00:00:00") == 0) {
         lastValueNull |= BIT_LAST_ZERO_DATE;
-        return nullTime;
+        return zeroTime(columnInfo->getDecimals());
       }*/
 
       return std::unique_ptr<Time>(new Time(rawValue));
@@ -900,7 +1119,7 @@ namespace capi
         + columnInfo->getColumnType().getCppTypeName());
     }
 
-    return nullTime;
+    return zeroTime(columnInfo->getDecimals());
   }
 
   /**
@@ -914,16 +1133,12 @@ namespace capi
     */
   std::unique_ptr<Timestamp> BinRowProtocolCapi::getInternalTimestamp(ColumnDefinition* columnInfo, Calendar* /*userCalendar*/, TimeZone* /*timeZone*/)
   {
-    std::unique_ptr<Timestamp> nullTs(new Timestamp("0000-00-00 00:00:00"));
-
-    padZeroMicros(*nullTs, columnInfo->getDecimals());
-
     if (lastValueWasNull()) {
-      return nullTs;
+      return zeroTimestamp(columnInfo->getDecimals());
     }
     if (length == 0) {
       lastValueNull |=BIT_LAST_FIELD_NULL;
-      return nullTs;
+      return zeroTimestamp(columnInfo->getDecimals());
     }
 
     switch (columnInfo->getColumnType().getType()) {
@@ -936,7 +1151,7 @@ namespace capi
 
       if (isNullTimeStruct(mt, MYSQL_TYPE_TIMESTAMP)) {
         lastValueNull |= BIT_LAST_ZERO_DATE;
-        return nullTs;
+        return zeroTimestamp(columnInfo->getDecimals());
       }
       if (columnInfo->getColumnType().getType() == MYSQL_TYPE_TIME)
       {
@@ -953,9 +1168,9 @@ namespace capi
     {
       SQLString rawValue(fieldBuf.arr, length);
 
-      if (rawValue.compare(*nullTs) == 0 || rawValue.compare("00:00:00") == 0) {
+      if (rawValue.compare(*zeroTimestamp(columnInfo->getDecimals())) == 0 || rawValue.compare("00:00:00") == 0) {
         lastValueNull |= BIT_LAST_ZERO_DATE;
-        return nullTs;
+        return zeroTimestamp(columnInfo->getDecimals());
       }
 
       return std::unique_ptr<Timestamp>(new Timestamp(rawValue));
@@ -966,7 +1181,111 @@ namespace capi
         + columnInfo->getColumnType().getCppTypeName());
     }
 
-    return nullTs;
+    return zeroTimestamp(columnInfo->getDecimals());
+  }
+
+
+  bool BinRowProtocolCapi::getInternalDateTime(ColumnDefinition* columnInfo, DateTime& value)
+  {
+    uint32_t fractionDigits;
+
+    value= DateTime();
+    if (lastValueWasNull()) {
+      return false;
+    }
+
+    switch (columnInfo->getColumnType().getType()) {
+    case MYSQL_TYPE_TIME:
+      toDateTime(reinterpret_cast<MYSQL_TIME*>(fieldBuf.arr), value);
+      return true;
+    case MYSQL_TYPE_TIMESTAMP:
+    case MYSQL_TYPE_DATETIME:
+    case MYSQL_TYPE_DATE:
+      toDateTime(reinterpret_cast<MYSQL_TIME*>(fieldBuf.arr), value);
+      break;
+    case MYSQL_TYPE_YEAR:
+    {
+      int32_t year= *reinterpret_cast<int16_t*>(fieldBuf.arr);
+      if (length == 2 && columnInfo->getLength() == 2) {
+        year+= year < 70 ? 2000 : 1900;
+      }
+      value.year= static_cast<uint32_t>(year);
+      value.month= 1;
+      value.day= 1;
+      return true;
+    }
+    case MYSQL_TYPE_VARCHAR:
+    case MYSQL_TYPE_VAR_STRING:
+    case MYSQL_TYPE_STRING:
+      if (DateTimeCodec::parseTime(fieldBuf.arr, length, value, fractionDigits)) {
+        return true;
+      }
+      if (!DateTimeCodec::parseDateTime(fieldBuf.arr, length, value, fractionDigits)) {
+        throw SQLException("cannot parse data in timestamp string '" + SQLString(fieldBuf.arr, length) + "'");
+      }
+      break;
+    default:
+      throw SQLException(
+        "getDateTime not available for data field type "
+        + columnInfo->getColumnType().getCppTypeName());
+    }
+
+    if (DateTimeCodec::isZero(value)) {
+      lastValueNull|= BIT_LAST_ZERO_DATE;
+      return false;
+    }
+    return true;
+  }
+
+
+  bool BinRowProtocolCapi::getInternalDecimal(ColumnDefinition* columnInfo, Decimal& value)
+  {
+    value= Decimal();
+    if (lastValueWasNull()) {
+      return false;
+    }
+
+    switch (columnInfo->getColumnType().getType()) {
+    case MYSQL_TYPE_BIT:
+    case MYSQL_TYPE_TINY:
+    case MYSQL_TYPE_SHORT:
+    case MYSQL_TYPE_YEAR:
+    case MYSQL_TYPE_LONG:
+    case MYSQL_TYPE_INT24:
+    case MYSQL_TYPE_LONGLONG:
+      if (columnInfo->isSigned()) {
+        DecimalCodec::fromInteger(getInternalLong(columnInfo), value);
+      }
+      else {
+        DecimalCodec::fromInteger(getInternalULong(columnInfo), value);
+      }
+      return true;
+    case MYSQL_TYPE_DECIMAL:
+    case MYSQL_TYPE_NEWDECIMAL:
+    case MYSQL_TYPE_VAR_STRING:
+    case MYSQL_TYPE_VARCHAR:
+    case MYSQL_TYPE_STRING:
+      // Decimals come in the text form in the binary protocol as well
+      if (DecimalCodec::parse(fieldBuf.arr, length, value)) {
+        return true;
+      }
+      break;
+    case MYSQL_TYPE_FLOAT:
+    case MYSQL_TYPE_DOUBLE:
+    {
+      std::unique_ptr<SQLString> str(getInternalString(columnInfo));
+      if (DecimalCodec::parse(str->c_str(), str->length(), value)) {
+        return true;
+      }
+      break;
+    }
+    default:
+      throw SQLException(
+        "getDecimal not available for data field type "
+        + columnInfo->getColumnType().getCppTypeName());
+    }
+    throw SQLException(
+      "Value of the column '" + columnInfo->getName() + "' cannot be converted to Decimal", "22003");
   }
 
   /**
@@ -1695,17 +2014,39 @@ namespace capi
   }
 
 
-  void BinRowProtocolCapi::cacheCurrentRow(std::vector<sql::bytes>& rowDataCache, std::size_t columnCount)
+  void BinRowProtocolCapi::cacheCurrentRow(RowDataArena& cache, std::size_t columnCount)
   {
-    rowDataCache.clear();
-    for (std::size_t i = 0; i < columnCount; ++i) {
+    std::size_t calls= 0;
+
+    // The getter is called twice for each column, deferred columns are fetched only on the second pass, when the
+    // value is copied
+    cache.append([this, &calls, columnCount](std::size_t i, std::size_t& length)->const char* {
+      bool copying= calls++ >= columnCount;
       if (bind[i].is_null_value != '\0') {
-        rowDataCache.emplace_back(0);
+        return nullptr;
       }
-      else {
-        rowDataCache.emplace_back(static_cast<const char*>(bind[i].buffer), bind[i].length_value);
+      length= static_cast<std::size_t>(bind[i].length_value);
+      if (deferred[i]) {
+        if (!copying) {
+          return "";
+        }
+        fetchDeferred(static_cast<int32_t>(i));
+        return deferredValue.data();
+      }
+      return static_cast<const char*>(bind[i].buffer);
+    });
+  }
+
+
+  std::size_t BinRowProtocolCapi::rowDataLength(std::size_t columnCount)
+  {
+    std::size_t length= 0;
+    for (std::size_t i= 0; i < columnCount; ++i) {
+      if (bind[i].is_null_value == '\0') {
+        length+= static_cast<std::size_t>(bind[i].length_value);
       }
     }
+    return length;
   }
 }
 }
@@ -30,19 +30,30 @@ namespace sql
 namespace mariadb
 {
 class ColumnDefinition;
+class ServerPrepareResult;
 
 namespace capi
 {
 #include "mysql.h"
 
-class BinRowProtocolCapi : public RowProtocol {
+class BinRowProtocolCapi final : public RowProtocol {
 
   const std::vector<Shared::ColumnDefinition>& columnInformation;
   int32_t columnInformationLength;
   MYSQL_STMT* stmt;
-  std::vector<MYSQL_BIND> bind;
-
+  // Owned by the prepare result, and reused for each its execution
+  std::vector<MYSQL_BIND>& bind;
+  // Columns, that are not copied to the bind buffer with the row, but read with mysql_stmt_fetch_column when needed
+  std::vector<bool> deferred;
+  bool hasDeferred= false;
+  std::vector<char> deferredValue;
+  // Column of the current row, that deferredValue has, or -1
+  int32_t deferredColumn= -1;
+  uint32_t chunkSize;
+
+  bool isDeferred(enum_field_types type) const;
   SQLString * convertToString(const char * asChar, ColumnDefinition * columnInfo);
+  void fetchDeferred(int32_t index);
 public:
 
   BinRowProtocolCapi(
@@ -50,11 +61,13 @@ public:
     int32_t columnInformationLength,
     uint32_t maxFieldSize,
     Shared::Options options,
-    MYSQL_STMT* stmt);
+    ServerPrepareResult* spr);
 
   virtual ~BinRowProtocolCapi();
 
   void setPosition(int32_t newIndex);
+  bool setStreamPosition(int32_t newIndex) override;
+  std::streambuf* getInternalStreamBuf() override;
 
 #ifdef JDBC_SPECIFIC_TYPES_IMPLEMENTED
   sql::Object* getInternalObject(ColumnDefinition* columnInfo,TimeZone* timeZone);
@@ -83,9 +96,13 @@ public:
   int8_t getInternalByte(ColumnDefinition* columnInfo);
   int16_t getInternalShort(ColumnDefinition* columnInfo);
   SQLString getInternalTimeString(ColumnDefinition* columnInfo);
+  bool getInternalDateTime(ColumnDefinition* columnInfo, DateTime& value);
+  bool getInternalDecimal(ColumnDefinition* columnInfo, Decimal& value);
 
   bool isBinaryEncoded();
-  void cacheCurrentRow(std::vector<sql::bytes>& rowData, std::size_t columnCount) override;
+  bool isRawStringValue(ColumnDefinition* columnInfo);
+  void cacheCurrentRow(RowDataArena& cache, std::size_t columnCount) override;
+  std::size_t rowDataLength(std::size_t columnCount) override;
   };
 
 }
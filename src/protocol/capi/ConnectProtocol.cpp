@@ -19,7 +19,24 @@
 
 
 #include <random>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
 #include <chrono>
+#include <mutex>
+#include <set>
+
+#ifdef _WIN32
+# include <winsock2.h>
+# include <ws2tcpip.h>
+#else
+# include <netinet/in.h>
+# include <netinet/tcp.h>
+# include <poll.h>
+# include <sys/socket.h>
+# include <sys/stat.h>
+# include <sys/uio.h>
+#endif
 
 #include "ConnectProtocol.h"
 
@@ -27,8 +44,17 @@
 #include "protocol/MasterProtocol.h"
 #include "Results.h"
 #include "ExceptionFactory.h"
+#include "HostHealthRegistry.h"
+#include "ControlConnectionRegistry.h"
+#include "credential/CredentialCache.h"
+#include "util/DnsCache.h"
 #include "util/Utils.h"
 #include "util/LogQueryTool.h"
+#include "util/MetadataCache.h"
+#include "util/ProtocolRecorder.h"
+#include "util/ProtocolReplayServer.h"
+#include "util/ServerPrepareStatementCache.h"
+#include "util/TraceSpan.h"
 
 
 namespace sql
@@ -37,6 +63,8 @@ namespace mariadb
 {
 namespace capi
 {
+#include "mysql/client_plugin.h"
+
   static const char OptionSelected= 1, OptionNotSelected= 0;
   static const unsigned int uintOptionSelected= 1, uintOptionNotSelected= 0;
   const char * attrPairSeparators= ",";
@@ -67,23 +95,62 @@ namespace capi
     , autoIncrementIncrement(_globalInfo ? _globalInfo->getAutoIncrementIncrement() : 1)
     , database(_urlParser->getDatabase())
     , serverPrepareStatementCache(nullptr)
+    , memoryAccount(std::make_shared<MemoryAccount>(static_cast<uint64_t>(options->maxResultSetMemory) << 20))
     , currentHost(localhost, 3306)
   {
     urlParser->auroraPipelineQuirks();
-    if (options->cachePrepStmts && options->useServerPrepStmts){
-      //ServerPrepareStatementCache::newInstance(options->prepStmtCacheSize, this);
+    if (options->cachePrepStmts && options->useServerPrepStmts && options->prepStmtCacheSize > 0){
+      serverPrepareStatementCache.reset(ServerPrepareStatementCache::newInstance(options->prepStmtCacheSize, this));
     }
+    MetricsRegistry::getInstance().attach(&metrics);
+  }
+
+
+  ConnectProtocol::~ConnectProtocol()
+  {
+    MetricsRegistry::getInstance().detach(&metrics);
+    stopRecording();
+    // The handle has to be closed before the mock server it's connected to
+    connection.reset();
   }
 
 
   void ConnectProtocol::closeSocket()
   {
+    stopRecording();
     try {
       connection.reset();
     }catch (std::exception& ){
     }
   }
 
+
+  void ConnectProtocol::stopRecording()
+  {
+    if (recording) {
+      ProtocolRecorder::getInstance().stop(connection.get());
+      recording= false;
+    }
+  }
+
+  /* Connector/C keeps loaded plugins process wide, thus each plugin of the list is loaded once per process. A name,
+     that failed to load, is not tried again - the server's request for the plugin will report the error */
+  static void preloadPlugins(MYSQL* socket, const SQLString& names)
+  {
+    static std::mutex lock;
+    static std::set<std::string> tried;
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    Tokens plugins(split(names, "[,;\\s]+"));
+
+    for (auto& it : *plugins) {
+      const std::string& name= StringImp::get(it);
+      if (!name.empty() && tried.insert(name).second) {
+        mysql_load_plugin(socket, name.c_str(), -1, 0);
+      }
+    }
+  }
+
+
   MYSQL* ConnectProtocol::createSocket(const SQLString& host, int32_t port, const Shared::Options& options)
   {
     //TODO: Shouldn't be Socket be an interface, and wrap MYSQL handle in case of C API use?
@@ -105,6 +172,7 @@ namespace capi
     if (options->autoReconnect){
       mysql_optionsv(socket, MYSQL_OPT_RECONNECT, &OptionSelected);
     }
+    // Connector/C's network buffer gets the bigger of the two. The socket buffers are set after the connect
     if (options->tcpRcvBuf > 0){
       mysql_optionsv(socket, MYSQL_OPT_NET_BUFFER_LENGTH, &options->tcpRcvBuf);
     }
@@ -127,6 +195,11 @@ namespace capi
       int protocol= MYSQL_PROTOCOL_PIPE;
       mysql_optionsv(socket, MYSQL_OPT_PROTOCOL, (void*)&protocol);
     }
+    else if (!options->sharedMemory.empty()) {
+      mysql_optionsv(socket, MYSQL_SHARED_MEMORY_BASE_NAME, (void *)options->sharedMemory.c_str());
+      int protocol= MYSQL_PROTOCOL_MEMORY;
+      mysql_optionsv(socket, MYSQL_OPT_PROTOCOL, (void*)&protocol);
+    }
     else {
       mysql_optionsv(socket, MARIADB_OPT_HOST, (void *)host.c_str());
       mysql_optionsv(socket, MARIADB_OPT_PORT, (void *)&port);
@@ -137,12 +210,15 @@ namespace capi
     if (!options->useCharacterEncoding.empty()) {
       mysql_optionsv(socket, MYSQL_SET_CHARSET_NAME, options->useCharacterEncoding.c_str());
     }
+    if (!options->preloadPlugins.empty()) {
+      preloadPlugins(socket, options->preloadPlugins);
+    }
 
     return socket;
   }
 
   int64_t ConnectProtocol::initializeClientCapabilities(
-      const Shared::Options& options, int64_t serverCapabilities, const SQLString& database)
+      const Shared::Options& options, int64_t serverCapabilities, const SQLString& database, bool compress)
   {
     int64_t capabilities =
       MariaDbServerCapabilities::IGNORE_SPACE
@@ -172,13 +248,10 @@ namespace capi
       capabilities|= MariaDbServerCapabilities::CLIENT_DEPRECATE_EOF;
     }
 
-    if (options->useCompression){
-      if ((serverCapabilities &MariaDbServerCapabilities::COMPRESS)==0){
-
-        options->useCompression= false;
-      }else {
-        capabilities|= MariaDbServerCapabilities::COMPRESS;
-      }
+    // Options may be shared by many connections, and must not be changed here. If server cannot do compression,
+    // Connector/C won't use it
+    if (compress && (serverCapabilities & MariaDbServerCapabilities::COMPRESS) != 0){
+      capabilities|= MariaDbServerCapabilities::COMPRESS;
     }
 
     if (options->interactiveClient){
@@ -249,7 +322,7 @@ namespace capi
   /** Closes socket and stream readers/writers Attempts graceful shutdown. */
   void ConnectProtocol::close()
   {
-    std::unique_lock<std::mutex> localScopeLock(*lock);
+    std::unique_lock<ConnectionMutex> localScopeLock(*lock);
     this->connected= false;
     try {
       // skip acquires lock
@@ -298,12 +371,9 @@ namespace capi
   void ConnectProtocol::forceAbort()
   {
     try {
-      Shared::mutex forCopied(new std::mutex());
-      std::unique_ptr<MasterProtocol> copiedProtocol(new MasterProtocol(urlParser, new GlobalStateInfo(), forCopied));
-      copiedProtocol->setHostAddress(getHostAddress());
-      copiedProtocol->connect();
-
-      copiedProtocol->executeQuery("KILL " + std::to_string(serverThreadId));
+      // Connection is being aborted, thus it's killed, and not only its query
+      ControlConnectionRegistry::getInstance().execute(urlParser, getHostAddress(),
+        "KILL " + std::to_string(serverThreadId));
     }catch (SQLException& ){
 
     }
@@ -338,7 +408,7 @@ namespace capi
   void ConnectProtocol::cleanMemory()
   {
     if (options->cachePrepStmts && options->useServerPrepStmts && serverPrepareStatementCache){
-      //serverPrepareStatementCache.clear();
+      serverPrepareStatementCache->clear();
     }
     if (options->enablePacketDebug){
       //traceCache->clearMemory();
@@ -365,6 +435,7 @@ namespace capi
    */
   void ConnectProtocol::connect()
   {
+    TraceSpan span("connect", this);
     if (!isClosed()){
       close();
     }
@@ -373,33 +444,92 @@ namespace capi
       createConnection(&currentHost, username);
     }catch (SQLException& exception){
       ExceptionFactory::INSTANCE.create(
-          "Could not connect to "+currentHost.toString() +". "+exception.getMessage() + getTraces(), "08000", &exception).Throw();
+          "Could not connect to "+currentHost.toString() +". "+exception.getMessage() + getTraces(), "08000",
+          exception.getErrorCode(), &exception).Throw();
     }
   }
 
 
+  static bool isLoopback(const SQLString& host)
+  {
+    const std::string& name= StringImp::get(host);
+    return name == "localhost" || name.compare(0, 4, "127.") == 0 || name == "::1" || name == "[::1]";
+  }
+
+
   void ConnectProtocol::createConnection(HostAddress* hostAddress, const SQLString& username)
   {
 
     SQLString host(hostAddress != nullptr ? hostAddress->host : "");
     int32_t port= hostAddress != nullptr ? hostAddress->port :3306;
+    // The host's own compress parameter overrides useCompression, e.g. to compress only the traffic to remote replicas
+    bool compress= hostAddress != nullptr && hostAddress->compress != HostAddress::COMPRESS_DEFAULT ?
+      hostAddress->compress == HostAddress::COMPRESS_ON : options->useCompression;
+
+    // On Windows that is the shared memory base name
+    SQLString unixSocket;
+    bool socketUnknown= false;
+    if (options->localSocketAutoDetect && hostAddress != nullptr && options->localSocket.empty() && options->pipe.empty()
+        && options->sharedMemory.empty() && options->protocolReplayFile.empty() && isLoopback(host)) {
+      socketUnknown= !HostHealthRegistry::getInstance().getLocalSocket(*hostAddress, unixSocket);
+    }
+
+    // The key lets the caching_sha2_password full authentication skip the round trip, requesting it from the server
+    bool rsaKeyUnknown= false;
+    if (hostAddress != nullptr && options->serverRsaPublicKeyFile.empty() && !options->useTls
+        && options->protocolReplayFile.empty()) {
+      SQLString rsaKeyFile;
+      rsaKeyUnknown= !HostHealthRegistry::getInstance().getRsaPublicKeyFile(*hostAddress, rsaKeyFile);
+      if (!rsaKeyFile.empty()) {
+        mysql_optionsv(connection.get(), MYSQL_SERVER_PUBLIC_KEY, (void*)rsaKeyFile.c_str());
+      }
+    }
 
     Unique::Credential credential;
     std::shared_ptr<CredentialPlugin> credentialPlugin(urlParser->getCredentialPlugin());
     if (credentialPlugin){
-      credential.reset(credentialPlugin->initialize(options, username, *hostAddress)->get());
+      credential.reset(CredentialCache::getInstance().get(credentialPlugin, options, username, *hostAddress));
     }else {
       credential.reset(new Credential(username, urlParser->getPassword()));
     }
 
-    connection.reset(createSocket(host, port, options));
+    auto connectStart= std::chrono::steady_clock::now();
+    stopRecording();
+    if (!options->protocolReplayFile.empty()) {
+      connection.reset();
+      replayServer.reset(new ProtocolReplayServer(StringImp::get(options->protocolReplayFile)));
+      host= "127.0.0.1";
+      port= replayServer->getPort();
+    }
+    // With TLS the C library needs the name for the certificate verification and SNI, thus the address is pinned only without it
+    SQLString address;
+    if (options->dnsCacheTtl > 0 && hostAddress != nullptr && unixSocket.empty() && !options->useTls
+        && options->protocolReplayFile.empty() && options->localSocket.empty() && options->pipe.empty()
+        && options->sharedMemory.empty()) {
+      address= DnsCache::getInstance().resolve(host, std::chrono::milliseconds(options->dnsCacheTtl));
+    }
+    connection.reset(createSocket(address.empty() ? host : address, port, options));
+    if (!unixSocket.empty()) {
+#ifdef _WIN32
+      mysql_optionsv(connection.get(), MYSQL_SHARED_MEMORY_BASE_NAME, (void *)unixSocket.c_str());
+      int protocol= MYSQL_PROTOCOL_MEMORY;
+#else
+      mysql_optionsv(connection.get(), MARIADB_OPT_UNIXSOCKET, (void *)unixSocket.c_str());
+      int protocol= MYSQL_PROTOCOL_SOCKET;
+#endif
+      mysql_optionsv(connection.get(), MYSQL_OPT_PROTOCOL, (void*)&protocol);
+    }
+    if (!options->protocolRecordFile.empty()) {
+      ProtocolRecorder::getInstance().start(connection.get(), StringImp::get(options->protocolRecordFile));
+      recording= true;
+    }
 
     assignStream(options);
 
     try {
 
       int8_t  exchangeCharset= decideLanguage(/*greetingPacket.getServerLanguage()*/224 & 0xFF);
-      int64_t clientCapabilities= initializeClientCapabilities(options, serverCapabilities, database);
+      int64_t clientCapabilities= initializeClientCapabilities(options, serverCapabilities, database, compress);
       exceptionFactory.reset(ExceptionFactory::of(serverThreadId, options));
 
       sslWrapper(
@@ -425,7 +555,7 @@ namespace capi
           credential.get(),
           host);
 
-      compressionHandler(options);
+      compressionHandler(compress);
       setConnectionAttributes(options->connectionAttributes);
     }
     catch (SQLException& sqlException) {
@@ -450,13 +580,53 @@ namespace capi
     }
     mysql_optionsv(connection.get(), MYSQL_REPORT_DATA_TRUNCATION, &uintOptionSelected);
     mysql_optionsv(connection.get(), MYSQL_OPT_LOCAL_INFILE, (options->allowLocalInfile ? &uintOptionSelected : &uintOptionNotSelected));
+#ifdef MARIADB_CLIENT_BULK_UNIT_RESULTS
+    if (options->useBulkStmts) {
+      static const my_bool unitResults= 1;
+      mysql_optionsv(connection.get(), MARIADB_OPT_BULK_UNIT_RESULTS, &unitResults);
+    }
+#endif
 
     if (mysql_real_connect(connection.get(), NULL, NULL, NULL, NULL, 0, NULL, CLIENT_MULTI_STATEMENTS) == nullptr)
     {
+      // The detected socket is gone, or it's not accessible - the host is used over TCP from now on
+      if (!unixSocket.empty() && HostHealthRegistry::isHostFailure(static_cast<int32_t>(mysql_errno(connection.get())))) {
+        logger->warn("Could not connect over the local transport " + unixSocket + ": " + mysql_error(connection.get())
+          + ". Falling back to TCP");
+        HostHealthRegistry::getInstance().setLocalSocket(*hostAddress, "");
+        destroySocket();
+        createConnection(hostAddress, username);
+        return;
+      }
+      // The host may have moved - the next attempt resolves its name again
+      if (!address.empty() && HostHealthRegistry::isHostFailure(static_cast<int32_t>(mysql_errno(connection.get())))) {
+        DnsCache::getInstance().invalidate(host);
+      }
       throw SQLException(mysql_error(connection.get()), mysql_sqlstate(connection.get()), mysql_errno(connection.get()));
     }
 
     connected= true;
+    lastResponse= std::chrono::steady_clock::now();
+    auto connectTime= std::chrono::duration_cast<std::chrono::microseconds>(lastResponse - connectStart);
+    metrics.connectTime.record(static_cast<uint64_t>(connectTime.count()));
+    if (options->localSocket.empty() && options->pipe.empty() && options->sharedMemory.empty() && unixSocket.empty()) {
+      setSocketOptions();
+    }
+    if (socketUnknown) {
+      detectLocalSocket(*hostAddress);
+    }
+    if (hostAddress != nullptr) {
+      HostHealthRegistry& registry= HostHealthRegistry::getInstance();
+      registry.updateLatency(*hostAddress, connectTime);
+
+      // Watching of the cluster state makes sense only if there are other nodes to choose from
+      if (!options->galeraAllowedState.empty() && urlParser->getHostAddresses().size() > 1) {
+        Tokens allowedStates(split(options->galeraAllowedState, ","));
+        for (const auto& host : urlParser->getHostAddresses()) {
+          registry.watchGalera(host, username, urlParser->getPassword(), *allowedStates);
+        }
+      }
+    }
 
     this->serverThreadId= mysql_thread_id(connection.get());
 
@@ -470,6 +640,9 @@ namespace capi
     else {
       serverMariaDb= StringImp::get(serverVersion).find("MariaDB") != std::string::npos;
     }
+    if (rsaKeyUnknown) {
+      detectRsaPublicKey(*hostAddress);
+    }
     unsigned long baseCaps, extCaps;
     mariadb_get_infov(connection.get(), MARIADB_CONNECTION_EXTENDED_SERVER_CAPABILITIES, (void*)&extCaps);
     mariadb_get_infov(connection.get(), MARIADB_CONNECTION_SERVER_CAPABILITIES, (void*)&baseCaps);
@@ -477,6 +650,10 @@ namespace capi
     serverCaps= serverCaps << 32;
     serverCaps|= baseCaps;
     this->serverCapabilities= serverCaps;
+    this->bulkUnitResults= false;
+#ifdef MARIADB_CLIENT_BULK_UNIT_RESULTS
+    this->bulkUnitResults= options->useBulkStmts && (serverCaps & MariaDbServerCapabilities::_MARIADB_CLIENT_BULK_UNIT_RESULTS) != 0;
+#endif
 
 
     if (this->options->socketTimeout > 0){
@@ -496,6 +673,7 @@ namespace capi
   /** Closing socket in case of Connection error after socket creation. */
   void ConnectProtocol::destroySocket()
   {
+    stopRecording();
     if (connection){
       try {
         connection.reset();
@@ -514,6 +692,9 @@ namespace capi
   {
     const unsigned int safeCApiTrue= 0x01010101;
 
+    // TLS context is created and owned by the Connector/C for each connection, and it does not expose it nor the TLS
+    // session to be shared. Thus all we can do here is to pass TLS options. The way to avoid handshakes is to
+    // re-use connections - the pool, or at least the ConnectionDescriptor
     if (options->useTls)
     {
       clientCapabilities|=  MariaDbServerCapabilities::SSL;
@@ -543,7 +724,7 @@ namespace capi
       mysql_optionsv(connection.get(), MYSQL_OPT_SSL_CRL, options->tlsCRL.c_str());
     }
     if (!options->tlsCRLPath.empty()) {
-      mysql_optionsv(connection.get(), MYSQL_OPT_SSL_CRL, options->tlsCRLPath.c_str());
+      mysql_optionsv(connection.get(), MYSQL_OPT_SSL_CRLPATH, options->tlsCRLPath.c_str());
     }
     if (!options->tlsPeerFP.empty()) {
       mysql_optionsv(connection.get(), MARIADB_OPT_TLS_PEER_FP, options->tlsPeerFP.c_str());
@@ -580,13 +761,342 @@ namespace capi
     }
   }
 
-  void ConnectProtocol::compressionHandler(const Shared::Options& options)
+  void ConnectProtocol::compressionHandler(bool compress)
   {
-    if (options->useCompression){
+    if (compress){
       mysql_optionsv(connection.get(), MYSQL_OPT_COMPRESS, NULL);
     }
   }
 
+  /* Applies the socket options, that Connector/C does not have, to the connected TCP socket. Failures are not fatal -
+     the connection works with the system defaults */
+  void ConnectProtocol::setSocketOptions()
+  {
+    my_socket fd= mysql_get_socket(connection.get());
+
+    auto setOption= [&](int level, int name, int value, const char* optionName) {
+      if (setsockopt(fd, level, name, reinterpret_cast<const char*>(&value), sizeof(value)) != 0) {
+        logger->warn(SQLString("Could not set socket option ") + optionName);
+      }
+    };
+
+    if (options->tcpRcvBuf > 0) {
+      setOption(SOL_SOCKET, SO_RCVBUF, options->tcpRcvBuf, "SO_RCVBUF");
+    }
+    if (options->tcpSndBuf > 0) {
+      setOption(SOL_SOCKET, SO_SNDBUF, options->tcpSndBuf, "SO_SNDBUF");
+    }
+    if (options->tcpQuickAck) {
+#ifdef TCP_QUICKACK
+      setOption(IPPROTO_TCP, TCP_QUICKACK, 1, "TCP_QUICKACK");
+#else
+      logger->warn("TCP_QUICKACK is not supported on this platform");
+#endif
+    }
+    if (options->tcpKeepAlive) {
+      setOption(SOL_SOCKET, SO_KEEPALIVE, 1, "SO_KEEPALIVE");
+      if (options->tcpKeepIdle > 0) {
+#if defined(TCP_KEEPIDLE)
+        setOption(IPPROTO_TCP, TCP_KEEPIDLE, options->tcpKeepIdle, "TCP_KEEPIDLE");
+#elif defined(TCP_KEEPALIVE)
+        setOption(IPPROTO_TCP, TCP_KEEPALIVE, options->tcpKeepIdle, "TCP_KEEPALIVE");
+#else
+        logger->warn("TCP_KEEPIDLE is not supported on this platform");
+#endif
+      }
+      if (options->tcpKeepInterval > 0) {
+#ifdef TCP_KEEPINTVL
+        setOption(IPPROTO_TCP, TCP_KEEPINTVL, options->tcpKeepInterval, "TCP_KEEPINTVL");
+#else
+        logger->warn("TCP_KEEPINTVL is not supported on this platform");
+#endif
+      }
+    }
+    if (options->tcpUserTimeout > 0) {
+#ifdef TCP_USER_TIMEOUT
+      setOption(IPPROTO_TCP, TCP_USER_TIMEOUT, options->tcpUserTimeout, "TCP_USER_TIMEOUT");
+#else
+      logger->warn("TCP_USER_TIMEOUT is not supported on this platform");
+#endif
+    }
+    if (options->socketBusyPoll > 0) {
+#ifdef SO_BUSY_POLL
+      setOption(SOL_SOCKET, SO_BUSY_POLL, options->socketBusyPoll, "SO_BUSY_POLL");
+#else
+      logger->warn("SO_BUSY_POLL is not supported on this platform");
+#endif
+    }
+    if (options->ipTos > 0) {
+      sockaddr_storage address;
+      socklen_t length= sizeof(address);
+
+      if (getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length) == 0 && address.ss_family == AF_INET6) {
+        setOption(IPPROTO_IPV6, IPV6_TCLASS, options->ipTos, "IPV6_TCLASS");
+      }
+      else {
+        setOption(IPPROTO_IP, IP_TOS, options->ipTos, "IP_TOS");
+      }
+    }
+  }
+
+  std::size_t ConnectProtocol::getSocketSendBuffer()
+  {
+    my_socket fd= mysql_get_socket(connection.get());
+    int value= 0;
+    socklen_t length= sizeof(value);
+
+    if (fd == MARIADB_INVALID_SOCKET
+      || getsockopt(fd, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<char*>(&value), &length) != 0 || value < 0) {
+      return 0;
+    }
+    return static_cast<std::size_t>(value);
+  }
+
+
+  // Maximum payload of the packet. The longer command is split into packets of this length and the shorter last one
+  static const std::size_t MAX_PAYLOAD= 0xffffff;
+
+#ifndef _WIN32
+  /* Writes the buffers to the socket, waiting for it to become writable up to timeout milliseconds, if it's
+     non-blocking */
+  static void writeDirect(my_socket fd, std::vector<struct iovec>& iov, int32_t socketTimeout)
+  {
+    std::size_t first= 0;
+    const int timeout= socketTimeout > 0 ? socketTimeout : -1;
+    while (first < iov.size()) {
+      struct msghdr message{};
+      message.msg_iov= &iov[first];
+      message.msg_iovlen= std::min<std::size_t>(iov.size() - first, IOV_MAX);
+#ifdef MSG_NOSIGNAL
+      ssize_t sent= sendmsg(fd, &message, MSG_NOSIGNAL);
+#else
+      ssize_t sent= sendmsg(fd, &message, 0);
+#endif
+      if (sent < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        struct pollfd writable{fd, POLLOUT, 0};
+        if ((errno == EAGAIN || errno == EWOULDBLOCK) && poll(&writable, 1, timeout) > 0) {
+          continue;
+        }
+        throw std::runtime_error("Could not send the command to the server, errno " + std::to_string(errno));
+      }
+      // Skipping what has been sent, the partially sent buffer is advanced
+      std::size_t rest= static_cast<std::size_t>(sent);
+      while (rest > 0 && rest >= iov[first].iov_len) {
+        rest-= iov[first].iov_len;
+        ++first;
+      }
+      if (rest > 0) {
+        iov[first].iov_base= static_cast<char*>(iov[first].iov_base) + rest;
+        iov[first].iov_len-= rest;
+      }
+    }
+  }
+#endif
+
+  bool ConnectProtocol::canSendDirect()
+  {
+#ifdef _WIN32
+    return false;
+#else
+    MYSQL* mysql= connection.get();
+    return !recording && mysql->net.compress == 0 && mysql->net.write_pos == mysql->net.buff
+      && mysql_get_ssl_cipher(mysql) == nullptr && mysql_get_socket(mysql) != MARIADB_INVALID_SOCKET;
+#endif
+  }
+
+
+  void ConnectProtocol::sendCommandDirect(uint8_t command, const char* header, std::size_t headerLength,
+    const char* data, std::size_t length)
+  {
+#ifdef _WIN32
+    throw std::runtime_error("Direct send is not supported on Windows");
+#else
+    const std::size_t payload= 1 + headerLength + length;
+    // The payload of MAX_PAYLOAD length is followed by the empty packet
+    const std::size_t packets= payload/MAX_PAYLOAD + 1;
+    const struct { const char* base; std::size_t length; } segments[]{
+      {reinterpret_cast<const char*>(&command), 1}, {header, headerLength}, {data, length}};
+    std::vector<unsigned char> packetHeaders(packets*4);
+    std::vector<struct iovec> iov;
+    std::size_t segment= 0, segmentOffset= 0;
+
+    iov.reserve(packets*2 + 2);
+    for (std::size_t packet= 0; packet < packets; ++packet) {
+      std::size_t packetLength= std::min(payload - packet*MAX_PAYLOAD, MAX_PAYLOAD);
+      unsigned char* packetHeader= &packetHeaders[packet*4];
+
+      packetHeader[0]= static_cast<unsigned char>(packetLength);
+      packetHeader[1]= static_cast<unsigned char>(packetLength >> 8);
+      packetHeader[2]= static_cast<unsigned char>(packetLength >> 16);
+      packetHeader[3]= static_cast<unsigned char>(packet);
+      iov.push_back({packetHeader, 4});
+      while (packetLength > 0) {
+        std::size_t chunk= std::min(segments[segment].length - segmentOffset, packetLength);
+        if (chunk > 0) {
+          iov.push_back({const_cast<char*>(segments[segment].base) + segmentOffset, chunk});
+        }
+        segmentOffset+= chunk;
+        packetLength-= chunk;
+        if (segmentOffset == segments[segment].length) {
+          ++segment;
+          segmentOffset= 0;
+        }
+      }
+    }
+
+    writeDirect(mysql_get_socket(connection.get()), iov, socketTimeout);
+#endif
+  }
+
+
+  ConnectProtocol::DirectCommand::DirectCommand(ConnectProtocol& _protocol, uint8_t command)
+    : protocol(_protocol)
+  {
+    buffer.append(static_cast<char>(command));
+  }
+
+
+  void ConnectProtocol::DirectCommand::writePacket(const char* data, std::size_t length)
+  {
+#ifdef _WIN32
+    throw std::runtime_error("Direct send is not supported on Windows");
+#else
+    unsigned char header[4]{static_cast<unsigned char>(length), static_cast<unsigned char>(length >> 8),
+      static_cast<unsigned char>(length >> 16), sequence++};
+    std::vector<struct iovec> iov{{header, sizeof(header)}, {const_cast<char*>(data), length}};
+
+    writeDirect(mysql_get_socket(protocol.connection.get()), iov, protocol.socketTimeout);
+#endif
+  }
+
+
+  void ConnectProtocol::DirectCommand::flush(std::size_t keepFrom)
+  {
+    std::size_t offset= 0;
+
+    while (keepFrom - offset >= MAX_PAYLOAD) {
+      writePacket(buffer.c_str() + offset, MAX_PAYLOAD);
+      offset+= MAX_PAYLOAD;
+    }
+    if (offset > 0) {
+      StringImp::get(buffer).erase(0, offset);
+      sent+= offset;
+    }
+  }
+
+
+  void ConnectProtocol::DirectCommand::end()
+  {
+    flush(buffer.length());
+    // The rest is shorter than the packet, possibly empty, and tells the server the command ends
+    writePacket(buffer.c_str(), buffer.length());
+    sent+= buffer.length();
+    buffer.clear();
+    // The response continues the command's packets numbering
+    protocol.connection->net.pkt_nr= sequence;
+    protocol.connection->net.compress_pkt_nr= sequence;
+    protocol.metrics.query(sent);
+  }
+
+  /* Checks the state of the connection socket without blocking and without reading anything from it */
+  ConnectProtocol::SocketState ConnectProtocol::peekSocket()
+  {
+    my_socket fd= mysql_get_socket(connection.get());
+    char byte;
+
+    if (fd == MARIADB_INVALID_SOCKET) {
+      return SOCKET_UNKNOWN;
+    }
+#ifdef _WIN32
+    fd_set readable;
+    timeval noWait= { 0, 0 };
+    FD_ZERO(&readable);
+    FD_SET(fd, &readable);
+
+    int ready= select(0, &readable, nullptr, nullptr, &noWait);
+    if (ready == 0) {
+      return SOCKET_IDLE;
+    }
+    if (ready < 0) {
+      return SOCKET_UNKNOWN;
+    }
+    int received= recv(fd, &byte, 1, MSG_PEEK);
+#else
+    ssize_t received= recv(fd, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return SOCKET_IDLE;
+    }
+    if (received < 0 && errno == EINTR) {
+      return SOCKET_UNKNOWN;
+    }
+#endif
+    // EOF, or the reset
+    if (received <= 0) {
+      return SOCKET_CLOSED;
+    }
+    return SOCKET_READABLE;
+  }
+
+  /* Remembers the Unix socket of the local server for the next connections to the host. The server may run in other
+     mount namespace, e.g. in a container, so its path is useful only, if the same socket exists here. On Windows
+     that is the shared memory base name, if the server has the shared memory enabled */
+  void ConnectProtocol::detectLocalSocket(const HostAddress& hostAddress)
+  {
+    SQLString path;
+#ifdef _WIN32
+    static const char query[]= "SELECT IF(@@shared_memory, @@shared_memory_base_name, NULL)";
+#else
+    static const char query[]= "SELECT @@socket";
+#endif
+
+    if (mysql_real_query(connection.get(), query, sizeof(query) - 1) == 0) {
+      MYSQL_RES* res= mysql_store_result(connection.get());
+      if (res != nullptr) {
+        MYSQL_ROW row= mysql_fetch_row(res);
+#ifdef _WIN32
+        if (row != nullptr && row[0] != nullptr) {
+#else
+        struct stat st;
+        if (row != nullptr && row[0] != nullptr && stat(row[0], &st) == 0 && S_ISSOCK(st.st_mode)) {
+#endif
+          path= row[0];
+        }
+        mysql_free_result(res);
+      }
+    }
+    HostHealthRegistry::getInstance().setLocalSocket(hostAddress, path);
+  }
+
+  /* Remembers the RSA public key of the MySQL server for caching_sha2_password and sha256_password authentications of
+     the next connections to the host. MariaDB server does not have these plugins, and it's marked as not having the key */
+  void ConnectProtocol::detectRsaPublicKey(const HostAddress& hostAddress)
+  {
+    static const char query[]= "SHOW STATUS WHERE Variable_name IN ('Caching_sha2_password_rsa_public_key',"
+      "'Rsa_public_key')";
+    std::string pem;
+
+    if (!serverMariaDb && mysql_real_query(connection.get(), query, sizeof(query) - 1) == 0) {
+      MYSQL_RES* res= mysql_store_result(connection.get());
+      if (res != nullptr) {
+        MYSQL_ROW row;
+        while ((row= mysql_fetch_row(res)) != nullptr) {
+          if (row[0] == nullptr || row[1] == nullptr || *row[1] == '\0') {
+            continue;
+          }
+          // Both are normally the same key, but the caching_sha2_password one is preferred
+          if (pem.empty() || std::strcmp(row[0], "Caching_sha2_password_rsa_public_key") == 0) {
+            pem= row[1];
+          }
+        }
+        mysql_free_result(res);
+      }
+    }
+    HostHealthRegistry::getInstance().setRsaPublicKey(hostAddress, pem);
+  }
+
   /* Parses connectAttributes option and sets connection atttributes uxing it
    */
   void ConnectProtocol::setConnectionAttributes(const SQLString & attributes)
@@ -666,13 +1176,19 @@ namespace capi
           additionalData(serverData);
         }
 
-        std::size_t maxAllowedPacket= static_cast<std::size_t>(std::stoi(StringImp::get(serverData["max_allowed_packet"])));
+        maxAllowedPacket= static_cast<std::size_t>(std::stoi(StringImp::get(serverData["max_allowed_packet"])));
         mysql_optionsv(connection.get(), MYSQL_OPT_MAX_ALLOWED_PACKET, &maxAllowedPacket);
         autoIncrementIncrement= std::stoi(StringImp::get(serverData["auto_increment_increment"]));
         loadCalendar(serverData["time_zone"],serverData["system_time_zone"]);
 
+        // Session tracking has been turned on for the isolation variable, so it's enough to read it once
+        auto cit= serverData.find(isolationVariableName());
+        if (sessionStateAware() && cit != serverData.end()) {
+          transactionIsolationLevel= Utils::transactionFromString(cit->second);
+          isolationTracked= true;
+        }
       }else {
-        size_t maxAllowedPacket= static_cast<size_t>(globalInfo->getMaxAllowedPacket());
+        maxAllowedPacket= static_cast<size_t>(globalInfo->getMaxAllowedPacket());
         mysql_optionsv(connection.get(), MYSQL_OPT_MAX_ALLOWED_PACKET, &maxAllowedPacket);
         autoIncrementIncrement= globalInfo->getAutoIncrementIncrement();
         loadCalendar(globalInfo->getTimeZone(), globalInfo->getSystemTimeZone());
@@ -704,34 +1220,54 @@ namespace capi
     sendPipelineCheckMaster();
   }
 
-  void ConnectProtocol::sendSessionInfos()
+  SQLString ConnectProtocol::sessionInfosQuery()
   {
-
     SQLString sessionOption("autocommit=");
     sessionOption.append(options->autocommit ? "1" : "0");
 
     if ((serverCapabilities & MariaDbServerCapabilities::CLIENT_SESSION_TRACK)!=0){
       sessionOption.append(", session_track_schema=1");
-      if (options->rewriteBatchedStatements){
-        sessionOption.append(", session_track_system_variables= 'auto_increment_increment' ");
+      sessionOption.append(", session_track_system_variables='auto_increment_increment,").append(isolationVariableName());
+      if (options->readYourWrites && serverMariaDb) {
+        sessionOption.append(",last_gtid");
       }
+      sessionOption.append("'");
     }
 
     if (options->jdbcCompliantTruncation){
       sessionOption.append(", sql_mode = concat(@@sql_mode,',STRICT_TRANS_TABLES')");
     }
 
+    if (options->ignoreNoteWarnings) {
+      sessionOption.append(", sql_notes=0");
+    }
+
     if (!options->sessionVariables.empty()){
       sessionOption.append(",").append(Utils::parseSessionVariables(options->sessionVariables));
     }
 
-    SQLString query("set "+sessionOption);
-    realQuery(query);
+    return "set " + sessionOption;
+  }
+
+
+  void ConnectProtocol::sendSessionInfos()
+  {
+    realQuery(sessionInfosQuery());
   }
 
   void ConnectProtocol::sendRequestSessionVariables()
   {
-    realQuery(SESSION_QUERY);
+    realQuery(SESSION_QUERY + ",@@" + isolationVariableName());
+  }
+
+  /* Name of the session variable with transaction isolation level. MySQL has renamed it */
+  const char* ConnectProtocol::isolationVariableName()
+  {
+    if (!serverMariaDb && ((majorVersion >= 8 && versionGreaterOrEqual(8, 0, 3))
+      || (majorVersion < 8 && versionGreaterOrEqual(5, 7, 20)))) {
+      return "transaction_isolation";
+    }
+    return "tx_isolation";
   }
 
   void ConnectProtocol::readRequestSessionVariables(std::map<SQLString, SQLString>& serverData)
@@ -748,6 +1284,9 @@ namespace capi
       serverData.emplace("system_time_zone",resultSet->getString(2));
       serverData.emplace("time_zone",resultSet->getString(3));
       serverData.emplace("auto_increment_increment", resultSet->getString(4));
+      if (resultSet->getMetaData()->getColumnCount() > 4) {
+        serverData.emplace(isolationVariableName(), resultSet->getString(5));
+      }
 
     }else {
       throw SQLException(mysql_get_socket(connection.get()) == MARIADB_INVALID_SOCKET ?
@@ -823,11 +1362,11 @@ namespace capi
       executeQuery(
           true,
           results,
-          "SHOW VARIABLES WHERE Variable_name in ("
+          SQLString("SHOW VARIABLES WHERE Variable_name in ("
           "'max_allowed_packet',"
           "'system_time_zone',"
           "'time_zone',"
-          "'auto_increment_increment')");
+          "'auto_increment_increment','") + isolationVariableName() + "')");
       results->commandEnd();
       ResultSet* resultSet= results->getResultSet();
       if (resultSet){
@@ -849,14 +1388,35 @@ namespace capi
   }
 
 
+  /**
+   * Sets session options, creates the database if needed, and reads server variables. All that is sent as one
+   * multi-statement, and thus costs one round trip.
+   */
   void ConnectProtocol::additionalData(std::map<SQLString, SQLString>& serverData)
   {
+    const bool createDatabase= options->createDatabaseIfNotExist && !database.empty();
+    SQLString query(sessionInfosQuery());
+
+    if (createDatabase) {
+      SQLString quotedDb(MariaDbConnection::quoteIdentifier(this->database));
+      query.append(";CREATE DATABASE IF NOT EXISTS ").append(quotedDb).append(";USE ").append(quotedDb);
+    }
+    query.append(';').append(SESSION_QUERY).append(",@@").append(isolationVariableName());
+
+    realQuery(query);
     Unique::Results res(new Results());
-    sendSessionInfos();
     getResult(res.get());
 
+    if (createDatabase) {
+      for (int32_t i= 0; i < 2; ++i) {
+        res.reset(new Results());
+        moveToNextResult(res.get(), nullptr);
+        getResult(res.get());
+      }
+    }
+
     try {
-      sendRequestSessionVariables();
+      moveToNextResult(res.get(), nullptr);
       readRequestSessionVariables(serverData);
     }catch (SQLException& ){
       requestSessionDataWithShow(serverData);
@@ -864,19 +1424,6 @@ namespace capi
 
     sendPipelineCheckMaster();
     readPipelineCheckMaster();
-
-    if (options->createDatabaseIfNotExist && !database.empty()){
-
-      SQLString quotedDb(MariaDbConnection::quoteIdentifier(this->database));
-      sendCreateDatabaseIfNotExist(quotedDb);
-
-      Unique::Results res(new Results());
-      getResult(res.get());
-
-      sendUseDatabaseIfNotExist(quotedDb);
-      res.reset(new Results());
-      getResult(res.get());
-    }
   }
 
   /**
@@ -1069,9 +1616,11 @@ namespace capi
     std::vector<HostAddress>& addrs= urlParser->getHostAddresses();
     std::vector<HostAddress> hosts(addrs);
 
-    if (urlParser->getHaMode() == HaMode::LOADBALANCE) {
-      static auto rnd= std::default_random_engine{};
-      std::shuffle(hosts.begin(), hosts.end(), rnd);
+    if (urlParser->getHaMode() == HaMode::LOADBALANCE || urlParser->getHaMode() == HaMode::REPLICATION) {
+      HostHealthRegistry::getInstance().order(hosts);
+    }
+    else if (hosts.size() > 1) {
+      HostHealthRegistry::getInstance().moveUnhealthyLast(hosts);
     }
 
     if (hosts.empty() && !options->pipe.empty()){
@@ -1090,14 +1639,17 @@ namespace capi
       }
     }
 
-    while (!hosts.empty()){
-      currentHost= hosts.back();
-      hosts.pop_back();
+    for (auto it= hosts.begin(); it != hosts.end(); ++it) {
+      currentHost= *it;
       try {
         createConnection(&currentHost, username);
         return;
       }catch (SQLException& e){
-        if (hosts.empty()){
+        if (hosts.size() > 1 && HostHealthRegistry::isHostFailure(e.getErrorCode())) {
+          HostHealthRegistry::getInstance().addToBlacklist(currentHost, username, urlParser->getPassword(),
+            options->loadBalanceBlacklistTimeout);
+        }
+        if (it + 1 == hosts.end()) {
           if (!e.getSQLState().empty()){
             ExceptionFactory::INSTANCE.create(
                 "Could not connect to "
@@ -1116,6 +1668,56 @@ namespace capi
     }
   }
 
+  /**
+   * Takes over the connection of the other protocol, that has been connected to one of the url hosts, along with what
+   * has been learned about its server and session. The other protocol is left closed. The state of this connection's
+   * session is not restored here.
+   *
+   * @param standby connected protocol
+   * @return false, if the standby's socket turns out to be closed, or to have unexpected data in it
+   */
+  bool ConnectProtocol::adoptConnection(ConnectProtocol& standby)
+  {
+    SocketState socketState= standby.peekSocket();
+    if (socketState != SOCKET_IDLE && socketState != SOCKET_UNKNOWN) {
+      return false;
+    }
+    if (!isClosed()) {
+      close();
+    }
+    stopRecording();
+    connection.swap(standby.connection);
+    standby.connected= false;
+
+    exceptionFactory= standby.exceptionFactory;
+    currentHost= standby.currentHost;
+    readOnly= standby.readOnly;
+    database= standby.database;
+    serverThreadId= standby.serverThreadId;
+    serverVersion= standby.serverVersion;
+    serverMariaDb= standby.serverMariaDb;
+    majorVersion= standby.majorVersion;
+    minorVersion= standby.minorVersion;
+    patchVersion= standby.patchVersion;
+    serverCapabilities= standby.serverCapabilities;
+    eofDeprecated= standby.eofDeprecated;
+    bulkUnitResults= standby.bulkUnitResults;
+    serverStatus= standby.serverStatus;
+    maxAllowedPacket= standby.maxAllowedPacket;
+    autoIncrementIncrement= standby.autoIncrementIncrement;
+    transactionIsolationLevel= standby.transactionIsolationLevel;
+    isolationTracked= standby.isolationTracked;
+    sessionMaxRows= standby.sessionMaxRows;
+    socketTimeout= standby.socketTimeout;
+    timeZone= standby.timeZone;
+    lastResponse= standby.lastResponse;
+
+    activeStreamingResult= nullptr;
+    hostFailed= false;
+    connected= true;
+    return true;
+  }
+
   /**
    * Indicate for Old reconnection if can reconnect without throwing exception.
    *
@@ -1133,6 +1735,11 @@ namespace capi
     return serverVersion;
   }
 
+  const SQLString& ConnectProtocol::getLastGtid() const
+  {
+    return lastGtid;
+  }
+
   bool ConnectProtocol::getReadonly() const
   {
     return readOnly;
@@ -1148,6 +1755,18 @@ namespace capi
     return currentHost;
   }
 
+
+  MetricsRecorder& ConnectProtocol::getMetrics()
+  {
+    return metrics;
+  }
+
+
+  const std::shared_ptr<MemoryAccount>& ConnectProtocol::getMemoryAccount()
+  {
+    return memoryAccount;
+  }
+
   void ConnectProtocol::setHostAddress(const HostAddress& host)
   {
     this->currentHost= host;
@@ -1176,7 +1795,7 @@ namespace capi
 
   const SQLString& ConnectProtocol::getDatabase() const
   {
-    return database;
+    return pendingDatabase.empty() ? database : pendingDatabase;
   }
 
   const SQLString& ConnectProtocol::getUsername() const
@@ -1280,7 +1899,7 @@ namespace capi
    */
   bool ConnectProtocol::hasWarnings()
   {
-    std::lock_guard<std::mutex> localScopeLock(*lock);
+    std::lock_guard<ConnectionMutex> localScopeLock(*lock);
     return hasWarningsFlag;
   }
 
@@ -1291,7 +1910,7 @@ namespace capi
    */
   bool ConnectProtocol::isConnected()
   {
-    std::lock_guard<std::mutex> localScopeLock(*lock);
+    std::lock_guard<ConnectionMutex> localScopeLock(*lock);
     return connected;
   }
 
@@ -1357,7 +1976,7 @@ namespace capi
 
   ServerPrepareStatementCache* ConnectProtocol::prepareStatementCache()
   {
-    return serverPrepareStatementCache;
+    return serverPrepareStatementCache.get();
   }
 
   /**
@@ -1404,6 +2023,12 @@ namespace capi
     return eofDeprecated;
   }
 
+
+  bool ConnectProtocol::transactionIsolationTracked()
+  {
+    return isolationTracked;
+  }
+
   bool ConnectProtocol::sessionStateAware()
   {
     return (serverCapabilities & MariaDbServerCapabilities::CLIENT_SESSION_TRACK)!=0;
@@ -1426,12 +2051,212 @@ namespace capi
      Process error and throws execution with error info */
   void ConnectProtocol::realQuery(const SQLString& sql)
   {
-    if (capi::mysql_real_query(connection.get(), sql.c_str(), static_cast<unsigned long>(sql.length()))) {
+    metrics.query(sql.length());
+    metrics.roundTrip();
+    MetadataCache::queryExecuted(currentHost, sql.c_str(), sql.length());
+    if (realQueryWithSessionChanges(sql)) {
       throw SQLException(capi::mysql_error(connection.get()), capi::mysql_sqlstate(connection.get()),
                         capi::mysql_errno(connection.get()));
     }
   }
 
+  /* realQuery, that returns the error of the server for the query instead of throwing it. Errors of the connection
+     are still thrown */
+  bool ConnectProtocol::tryRealQuery(const SQLString& sql, ErrorInfo& error)
+  {
+    auto con= connection.get();
+    metrics.query(sql.length());
+    metrics.roundTrip();
+    MetadataCache::queryExecuted(currentHost, sql.c_str(), sql.length());
+    if (realQueryWithSessionChanges(sql) == 0) {
+      return true;
+    }
+    uint32_t errorCode= capi::mysql_errno(con);
+    if (!isStatementError(errorCode)) {
+      throw SQLException(capi::mysql_error(con), capi::mysql_sqlstate(con), errorCode);
+    }
+    ExceptionFactory::toErrorInfo(capi::mysql_error(con), capi::mysql_sqlstate(con), errorCode, error);
+    return false;
+  }
+
+  SQLString ConnectProtocol::selectLimitQuery(int64_t limit)
+  {
+    if (limit == 0) {
+      return "set @@SQL_SELECT_LIMIT=DEFAULT";
+    }
+    return "set @@SQL_SELECT_LIMIT=" + std::to_string(limit);
+  }
+
+
+  SQLString ConnectProtocol::isolationQuery(int32_t level)
+  {
+    SQLString query("SET SESSION TRANSACTION ISOLATION LEVEL");
+
+    switch (level) {
+      case sql::TRANSACTION_READ_UNCOMMITTED:
+        return query.append(" READ UNCOMMITTED");
+      case sql::TRANSACTION_READ_COMMITTED:
+        return query.append(" READ COMMITTED");
+      case sql::TRANSACTION_REPEATABLE_READ:
+        return query.append(" REPEATABLE READ");
+      case sql::TRANSACTION_SERIALIZABLE:
+        return query.append(" SERIALIZABLE");
+      default:
+        throw SQLException("Unsupported transaction isolation level");
+    }
+  }
+
+
+  void ConnectProtocol::getSessionChanges(std::vector<SQLString>& queries) const
+  {
+    if (!pendingTransactionEnd.empty()) {
+      queries.push_back(pendingTransactionEnd);
+    }
+    if (maxRows != sessionMaxRows) {
+      queries.push_back(selectLimitQuery(maxRows));
+    }
+    if (pendingAutocommit != -1) {
+      queries.emplace_back(pendingAutocommit != 0 ? "SET autocommit=1" : "SET autocommit=0");
+    }
+    if (pendingIsolationLevel != 0) {
+      queries.push_back(isolationQuery(pendingIsolationLevel));
+    }
+    if (!pendingDatabase.empty()) {
+      queries.emplace_back("USE " + MariaDbConnection::quoteIdentifier(pendingDatabase));
+    }
+    queries.insert(queries.end(), pendingSavepoints.begin(), pendingSavepoints.end());
+  }
+
+
+  void ConnectProtocol::readSessionChanges(std::unique_ptr<SQLException>& error)
+  {
+    auto con= connection.get();
+    auto readChange= [con, &error]() {
+      if (capi::mysql_read_query_result(con) == 0) {
+        return true;
+      }
+      if (!error) {
+        error.reset(new SQLException(capi::mysql_error(con), capi::mysql_sqlstate(con), capi::mysql_errno(con)));
+      }
+      return false;
+    };
+
+    // If the connection is lost, COMMIT's outcome is not known, and failover has to see it
+    if (!pendingTransactionEnd.empty() && (readChange() || isStatementError(capi::mysql_errno(con)))) {
+      pendingTransactionEnd.clear();
+    }
+    if (maxRows != sessionMaxRows && readChange()) {
+      sessionMaxRows= maxRows;
+    }
+    if (pendingAutocommit != -1) {
+      readChange();
+      pendingAutocommit= -1;
+    }
+    if (pendingIsolationLevel != 0) {
+      if (readChange()) {
+        transactionIsolationLevel= pendingIsolationLevel;
+      }
+      pendingIsolationLevel= 0;
+    }
+    if (!pendingDatabase.empty()) {
+      if (readChange()) {
+        database= pendingDatabase;
+      }
+      pendingDatabase.clear();
+    }
+    for (std::size_t i= 0; i < pendingSavepoints.size(); ++i) {
+      readChange();
+    }
+    pendingSavepoints.clear();
+    // Autocommit is known from the status only
+    capi::mariadb_get_infov(con, MARIADB_CONNECTION_SERVER_STATUS, (void*)&this->serverStatus);
+  }
+
+
+  void ConnectProtocol::clearSessionChanges()
+  {
+    pendingAutocommit= -1;
+    pendingIsolationLevel= 0;
+    pendingDatabase.clear();
+    pendingTransactionEnd.clear();
+    pendingSavepoints.clear();
+  }
+
+
+  void ConnectProtocol::applyTransactionEnd()
+  {
+    if (!pendingTransactionEnd.empty()) {
+      SQLString query(pendingTransactionEnd);
+      pendingTransactionEnd.clear();
+      realQuery(query.c_str(), query.length());
+      capi::mariadb_get_infov(connection.get(), MARIADB_CONNECTION_SERVER_STATUS, (void*)&this->serverStatus);
+    }
+  }
+
+
+  int32_t ConnectProtocol::realQueryWithSessionChanges(const SQLString& sql)
+  {
+    MetricsTimer wait(metrics.networkTime);
+    auto con= connection.get();
+    std::vector<SQLString> changes;
+
+    getSessionChanges(changes);
+    if (changes.empty()) {
+      return capi::mysql_real_query(con, sql.c_str(), static_cast<unsigned long>(sql.length()));
+    }
+    for (const auto& change : changes) {
+      metrics.query(change.length());
+      if (capi::mysql_send_query(con, change.c_str(), static_cast<unsigned long>(change.length()))) {
+        return 1;
+      }
+    }
+    if (capi::mysql_send_query(con, sql.c_str(), static_cast<unsigned long>(sql.length()))) {
+      return 1;
+    }
+    std::unique_ptr<SQLException> changeError;
+    readSessionChanges(changeError);
+    if (changeError) {
+      // The query has been executed anyway, and its results have to be read off the connection
+      if (capi::mysql_read_query_result(con) == 0) {
+        do {
+          capi::MYSQL_RES* res= capi::mysql_store_result(con);
+          if (res != nullptr) {
+            capi::mysql_free_result(res);
+          }
+        } while (capi::mysql_next_result(con) == 0);
+      }
+      throw *changeError;
+    }
+    return capi::mysql_read_query_result(con);
+  }
+
+
+  void ConnectProtocol::applySessionChanges()
+  {
+    std::vector<SQLString> changes;
+
+    getSessionChanges(changes);
+    if (changes.empty()) {
+      return;
+    }
+    for (const auto& change : changes) {
+      sendQuery(change);
+    }
+    metrics.roundTrip();
+    std::unique_ptr<SQLException> changeError;
+    readSessionChanges(changeError);
+    if (changeError) {
+      throw *changeError;
+    }
+  }
+
+  /* If the error is the server's one for the statement, and the connection is fine. Client library's errors
+     start from 2000, and 1927 is the connection, killed on the server */
+  bool ConnectProtocol::isStatementError(uint32_t errorCode)
+  {
+    return errorCode < 2000 && errorCode != 1927;
+  }
+
   void ConnectProtocol::commitReturnAutocommit(bool justReadMultiSendResults)
   {
     if (justReadMultiSendResults) {
@@ -1446,8 +2271,11 @@ namespace capi
     capi::mariadb_get_infov(connection.get(), MARIADB_CONNECTION_SERVER_STATUS, (void*)&this->serverStatus);
   }
 
+  /* Round trips of queries, that are sent without reading their results, are counted by the caller */
   void ConnectProtocol::sendQuery(const SQLString & sql)
   {
+    metrics.query(sql.length());
+    MetadataCache::queryExecuted(currentHost, sql.c_str(), sql.length());
     if (capi::mysql_send_query(connection.get(), sql.c_str(), static_cast<unsigned long>(sql.length()))) {
       throw SQLException(capi::mysql_error(connection.get()), capi::mysql_sqlstate(connection.get()),
         capi::mysql_errno(connection.get()));
@@ -1457,6 +2285,8 @@ namespace capi
 
   void ConnectProtocol::sendQuery(const char * sql, std::size_t length)
   {
+    metrics.query(length);
+    MetadataCache::queryExecuted(currentHost, sql, length);
     if (capi::mysql_send_query(connection.get(), sql, static_cast<unsigned long>(length))) {
       throw SQLException(capi::mysql_error(connection.get()), capi::mysql_sqlstate(connection.get()),
         capi::mysql_errno(connection.get()));
@@ -1478,24 +2308,39 @@ namespace capi
   void ConnectProtocol::realQuery(const char* sql, std::size_t len)
   {
     auto con= connection.get();
-    if (capi::mysql_real_query(con, sql, static_cast<unsigned long>(len))) {
+    metrics.query(len);
+    metrics.roundTrip();
+    int32_t rc;
+    {
+      MetricsTimer wait(metrics.networkTime);
+      rc= capi::mysql_real_query(con, sql, static_cast<unsigned long>(len));
+    }
+    if (rc != 0) {
       throw SQLException(capi::mysql_error(con), capi::mysql_sqlstate(con),
                         capi::mysql_errno(con));
     }
   }
   void ConnectProtocol::reconnect()
   {
-    std::lock_guard<std::mutex> localScopeLock(*lock);
+    std::lock_guard<ConnectionMutex> localScopeLock(*lock);
 
     if (!options->autoReconnect)
     {
       mysql_optionsv(connection.get(), MYSQL_OPT_RECONNECT, &OptionSelected);
     }
+    MARIADB_PROBE1(reconnect__start, this);
     if (capi::mariadb_reconnect(connection.get()) != 0) {
+      MARIADB_PROBE2(reconnect__done, this, 1);
       throw SQLException(capi::mysql_error(connection.get()), capi::mysql_sqlstate(connection.get()),
         capi::mysql_errno(connection.get()));
     }
     connected= true;
+    MARIADB_PROBE2(reconnect__done, this, 0);
+    MetricsRecorder::increment(metrics.reconnects);
+    // New session has default isolation and session tracking settings
+    transactionIsolationLevel= 0;
+    isolationTracked= false;
+    sessionMaxRows= 0;
     if (!options->autoReconnect)
     {
       mysql_optionsv(connection.get(), MYSQL_OPT_RECONNECT, &OptionNotSelected);
@@ -22,11 +22,14 @@
 #define _ABSTRACTCONNECTPROTOCOL_H_
 
 #include <atomic>
+#include <chrono>
 #include <map>
 
 #include "Consts.h"
 #include "Protocol.h"
 #include "pool/GlobalStateInfo.h"
+#include "util/MetricsRecorder.h"
+#include "util/MemoryAccounting.h"
 
 #define CONST_QUERY(QUERY_STRING_LITERAL) realQuery(QUERY_STRING_LITERAL,sizeof(QUERY_STRING_LITERAL))
 #define SEND_CONST_QUERY(QUERY_STRING_LITERAL) sendQuery(QUERY_STRING_LITERAL,sizeof(QUERY_STRING_LITERAL))
@@ -40,6 +43,7 @@ namespace mariadb
   class Socket;
   class SSLSocket;
   class Credential;
+  class ProtocolReplayServer;
 
 namespace capi
 {
@@ -62,10 +66,11 @@ namespace capi
     std::shared_ptr<UrlParser> urlParser;
     Shared::Options options;
     Shared::ExceptionFactory exceptionFactory;
-    virtual ~ConnectProtocol() {}
+    /* Current user. changeUser() changes it */
+    SQLString username;
+    virtual ~ConnectProtocol();
 
   private:
-    const SQLString username;
     //const LruTraceCache traceCache; /*new LruTraceCache()*/
     std::unique_ptr<GlobalStateInfo> globalInfo;
 
@@ -84,10 +89,37 @@ namespace capi
     bool explicitClosed= false;
     SQLString database;
     int64_t serverThreadId= 0;
-    ServerPrepareStatementCache* serverPrepareStatementCache= nullptr;
+    std::unique_ptr<ServerPrepareStatementCache> serverPrepareStatementCache;
     bool eofDeprecated= false;
     int64_t serverCapabilities= 0;
+    // Bulk command returns affected rows and insert id of each parameter set
+    bool bulkUnitResults= false;
+    // Session's max_allowed_packet, 0 if not known
+    std::size_t maxAllowedPacket= 0;
+    // 0 if not known. If isolationTracked, server reports its every change, and the value is always actual
+    int32_t transactionIsolationLevel= 0;
+    bool isolationTracked= false;
+    // last_gtid reported by the session tracking, with readYourWrites
+    SQLString lastGtid;
+    /* Rows limit, that the current statement needs, and the SQL_SELECT_LIMIT of the session. The session is changed
+       only when a query the limit applies to is sent, and text queries carry the change along, i.e. it costs no
+       round trip of its own */
+    int64_t maxRows= 0;
+    int64_t sessionMaxRows= 0;
+    /* Session state, that has been requested, but not sent yet. It's sent the same way as the select limit. -1 for
+       autocommit, 0 for the isolation and empty database mean there is no pending change */
+    int32_t pendingAutocommit= -1;
+    int32_t pendingIsolationLevel= 0;
+    SQLString pendingDatabase;
+    // COMMIT or ROLLBACK deferred with pipelineTransactionEnd. It goes before other changes
+    SQLString pendingTransactionEnd;
+    // SAVEPOINT and RELEASE SAVEPOINT queries deferred with pipelineSavepoints. They go after other changes
+    std::vector<SQLString> pendingSavepoints;
     int32_t socketTimeout= 0;
+    // Time of the last response of the server. Tracked only if validMinDelay is set
+    std::chrono::steady_clock::time_point lastResponse;
+    MetricsRecorder metrics;
+    std::shared_ptr<MemoryAccount> memoryAccount;
 
   private:
     HostAddress currentHost;
@@ -98,25 +130,46 @@ namespace capi
     uint32_t minorVersion= 0;
     uint32_t patchVersion= 0;
     TimeZone* timeZone= nullptr;
+    // Mock server the connection is connected to, when protocolReplayFile is set
+    std::unique_ptr<ProtocolReplayServer> replayServer;
+    bool recording= false;
 
   public:
     ConnectProtocol(std::shared_ptr<UrlParser>& urlParser, GlobalStateInfo* globalInfo, Shared::mutex& lock);
 
   private:
     void closeSocket();
+    void stopRecording();
     static MYSQL* createSocket(const SQLString& host, int32_t port, const Shared::Options& options);
-    static int64_t initializeClientCapabilities(const Shared::Options& options, int64_t serverCapabilities, const SQLString& database);
+    static int64_t initializeClientCapabilities(const Shared::Options& options, int64_t serverCapabilities, const SQLString& database,
+      bool compress);
     static void enabledTlsProtocolSuites(MYSQL* socket, const Shared::Options& options);
     static void enabledTlsCipherSuites(MYSQL* sslSocket, const Shared::Options& options);
 
   protected:
     void realQuery(const SQLString& sql);
+    bool tryRealQuery(const SQLString& sql, ErrorInfo& error);
+    static bool isStatementError(uint32_t errorCode);
     void commitReturnAutocommit(bool justReadMultiSendResults=false);
     void sendQuery(const SQLString& sql);
     void sendQuery(const char* query, std::size_t length);
     //mysql_read_result
     void readQueryResult();
     void realQuery(const char* query, std::size_t length);
+    /* mysql_real_query, that sends pending changes of the session, if any, right before the query */
+    int32_t realQueryWithSessionChanges(const SQLString& sql);
+    /* Sends pending changes of the session with their own round trip, for commands, that cannot be pipelined after them */
+    void applySessionChanges();
+    /* Queries, bringing the session to the requested state, in the order readSessionChanges expects them */
+    void getSessionChanges(std::vector<SQLString>& queries) const;
+    /* Reads the results of the sent getSessionChanges queries, and updates the state. The first error is returned in
+       the error, and the rest of the results are read anyway */
+    void readSessionChanges(std::unique_ptr<SQLException>& error);
+    void clearSessionChanges();
+    /* Sends the deferred COMMIT or ROLLBACK alone, if there is one */
+    void applyTransactionEnd();
+    static SQLString selectLimitQuery(int64_t limit);
+    static SQLString isolationQuery(int32_t level);
 
   public:
     void close();
@@ -161,11 +214,61 @@ namespace capi
       Credential* credential, const SQLString& host);
 
 
-    void compressionHandler(const Shared::Options& options);
+    void compressionHandler(bool compress);
+    void setSocketOptions();
+  protected:
+    enum SocketState {
+      SOCKET_IDLE,
+      // There is data to be read, that nobody waits for, e.g. the error packet of the killed connection
+      SOCKET_READABLE,
+      SOCKET_CLOSED,
+      // Not a socket, e.g. the named pipe
+      SOCKET_UNKNOWN
+    };
+    SocketState peekSocket();
+    /* SO_SNDBUF of the connection socket, 0 if it cannot be got */
+    std::size_t getSocketSendBuffer();
+    /* If commands can be written to the socket bypassing the C API - it is the plain socket without TLS and
+       compression, the connection is not recorded, and nothing is left in the C API's write buffer */
+    bool canSendDirect();
+    /* Sends the command, that has no response, with the header and the data framed into packets, straight from their
+       memory with scatter-gather writes. The caller checks canSendDirect first */
+    void sendCommandDirect(uint8_t command, const char* header, std::size_t headerLength, const char* data,
+      std::size_t length);
+
+  public:
+    /* Command, that is written to the socket bypassing the C API in packets of the maximum size as its text is
+       produced, so that only the last unfinished packet is kept in memory, and the statement bigger than 16M is
+       never assembled as a whole. The text is appended to text(), and flush() writes the full packets. The text after
+       the given position is kept, as the producer may cut it back. end() writes the rest and prepares the C API to read
+       the response. The caller checks canSendDirect first */
+    class DirectCommand
+    {
+      ConnectProtocol& protocol;
+      SQLString buffer;
+      std::size_t sent= 0;
+      uint8_t sequence= 0;
+
+      void writePacket(const char* data, std::size_t length);
+
+    public:
+      DirectCommand(ConnectProtocol& protocol, uint8_t command);
+      SQLString& text() { return buffer; }
+      /* Length of the text written and buffered */
+      std::size_t length() const { return sent + buffer.length(); }
+      void flush(std::size_t keepFrom);
+      void end();
+    };
+
+  private:
+    void detectLocalSocket(const HostAddress& hostAddress);
+    void detectRsaPublicKey(const HostAddress& hostAddress);
     void setConnectionAttributes(const SQLString& attributes);
     void assignStream(const Shared::Options& options);
     void postConnectionQueries();
     void sendPipelineAdditionalData();
+    const char* isolationVariableName();
+    SQLString sessionInfosQuery();
     void sendSessionInfos();
     void sendRequestSessionVariables();
     void readRequestSessionVariables(std::map<SQLString, SQLString>& serverData);
@@ -179,6 +282,8 @@ namespace capi
     bool isClosed();
 
   private:
+    /* Temporal values are passed as the server sends and expects them, without time zone conversion, thus there is no time
+       zone to resolve here, and no per value cost. serverTimezone is accepted, but not applied */
     void loadCalendar(const SQLString& srvTimeZone, const SQLString& srvSystemTimeZone);
 
   public:
@@ -203,10 +308,18 @@ namespace capi
     bool noBackslashEscapes();
     void connectWithoutProxy();
     bool shouldReconnectWithoutProxy();
+
+  protected:
+    bool adoptConnection(ConnectProtocol& standby);
+
+  public:
     const SQLString& getServerVersion() const;
+    const SQLString& getLastGtid() const;
     bool getReadonly() const;
     void setReadonly(bool readOnly);
     const HostAddress& getHostAddress() const;
+    MetricsRecorder& getMetrics();
+    const std::shared_ptr<MemoryAccount>& getMemoryAccount();
     void setHostAddress(const HostAddress& host);
     const SQLString& getHost() const;
     FailoverProxy* getProxy();
@@ -246,6 +359,7 @@ namespace capi
     PacketOutputStream* getWriter();*/
     bool isEofDeprecated();
     bool sessionStateAware();
+    bool transactionIsolationTracked();
     SQLString getTraces();
     void reconnect();
   };
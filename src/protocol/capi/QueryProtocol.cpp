@@ -18,23 +18,39 @@
 *************************************************************************************/
 
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <iomanip>
+#include <sstream>
+
 #include "QueryProtocol.h"
 
 #include "logger/LoggerFactory.h"
 #include "Results.h"
 #include "util/LogQueryTool.h"
+#include "util/MemoryAccounting.h"
+#include "util/MetadataCache.h"
 #include "util/ClientPrepareResult.h"
+#include "util/EncodedBatch.h"
 #include "util/ServerPrepareResult.h"
 #include "util/ServerPrepareStatementCache.h"
+#include "util/TraceSpan.h"
 #include "util/StateChange.h"
 #include "util/Utils.h"
 #include "protocol/MasterProtocol.h"
+#include "protocol/StandbyConnection.h"
 #include "SqlStates.h"
 #include "com/capi/ColumnDefinitionCapi.h"
 #include "ExceptionFactory.h"
+#include "HostHealthRegistry.h"
+#include "ControlConnectionRegistry.h"
 #include "util/ServerStatus.h"
 //I guess eventually it should go from here
 #include "com/Packet.h"
+#include "com/LocalInfileWriter.h"
 
 namespace sql
 {
@@ -46,6 +62,12 @@ namespace capi
 
   static const int64_t MAX_PACKET_LENGTH= 0x00ffffff + 4;
 
+  /* Memory of the string's buffer beyond what the empty string has in itself */
+  static std::size_t bufferBytes(SQLString& str)
+  {
+    return StringImp::get(str).capacity() - std::string().capacity();
+  }
+
   const Shared::Logger QueryProtocol::logger= LoggerFactory::getLogger(typeid(QueryProtocol));
   const SQLString QueryProtocol::CHECK_GALERA_STATE_QUERY("show status like 'wsrep_local_state'");
 
@@ -65,6 +87,7 @@ namespace capi
   QueryProtocol::QueryProtocol(std::shared_ptr<UrlParser>& urlParser, GlobalStateInfo* globalInfo, Shared::mutex& lock)
     : super(urlParser, globalInfo, lock)
     , logQuery(new LogQueryTool(options))
+    , batchWindow(static_cast<std::size_t>(std::max(urlParser->getOptions()->useBatchMultiSendNumber, 1)))
   {
     if (!urlParser->getOptions()->galeraAllowedState.empty())
     {
@@ -72,18 +95,37 @@ namespace capi
     }
   }
 
+
+  QueryProtocol::~QueryProtocol()
+  {
+    // Releases the cached statements, while the protocol is still complete
+    if (serverPrepareStatementCache) {
+      serverPrepareStatementCache->clear();
+    }
+    // Statements released after the last command. If the connection is closed, the C API only frees them
+    for (auto statementId : statementsToRelease) {
+      mysql_stmt_close(statementId);
+    }
+    MemoryAccounting::get(MemoryAccounting::CONNECTION_BUFFERS).release(bufferBytes(queryBuffer));
+  }
+
   void QueryProtocol::reset()
   {
     cmdPrologue();
     try {
-
+      metrics.roundTrip();
       if (mysql_reset_connection(connection.get()))
       {
         throw SQLException("Connection reset failed");
       }
+      // Server has restored its defaults, and autocommit may have changed with them. Changes, requested before the
+      // reset, are dropped with the rest of the session state
+      sessionMaxRows= 0;
+      clearSessionChanges();
+      capi::mariadb_get_infov(connection.get(), MARIADB_CONNECTION_SERVER_STATUS, (void*)&this->serverStatus);
 
-      if (options->cachePrepStmts && options->useServerPrepStmts){
-        //serverPrepareStatementCache->clear();
+      if (options->cachePrepStmts && options->useServerPrepStmts && serverPrepareStatementCache){
+        serverPrepareStatementCache->clear();
       }
 
     }catch (SQLException& sqlException){
@@ -93,6 +135,40 @@ namespace capi
     }
   }
 
+  /**
+   * Switches the connection to another user and database with COM_CHANGE_USER. The server drops the session state,
+   * like with COM_RESET_CONNECTION. The new credentials are used for reconnects as well.
+   */
+  void QueryProtocol::changeUser(const SQLString& user, const SQLString& password, const SQLString& _database)
+  {
+    cmdPrologue();
+    try {
+      metrics.roundTrip();
+      if (mysql_change_user(connection.get(), user.c_str(), password.c_str(), _database.empty() ? nullptr : _database.c_str()))
+      {
+        throw SQLException(mysql_error(connection.get()), mysql_sqlstate(connection.get()), mysql_errno(connection.get()));
+      }
+      username= user;
+      urlParser->setUsername(user);
+      urlParser->setPassword(password);
+      urlParser->setDatabase(_database);
+      database= _database;
+      sessionMaxRows= 0;
+      clearSessionChanges();
+      capi::mariadb_get_infov(connection.get(), MARIADB_CONNECTION_SERVER_STATUS, (void*)&this->serverStatus);
+
+      if (options->cachePrepStmts && options->useServerPrepStmts && serverPrepareStatementCache) {
+        serverPrepareStatementCache->clear();
+      }
+    }
+    catch (SQLException& sqlException) {
+      throw logQuery->exceptionWithQuery("COM_CHANGE_USER failed.", sqlException, explicitClosed);
+    }
+    catch (std::runtime_error& e) {
+      handleIoException(e).Throw();
+    }
+  }
+
   /**
    * Execute internal query.
    *
@@ -110,6 +186,7 @@ namespace capi
 
   void QueryProtocol::executeQuery(bool /*mustExecuteOnMaster*/, Shared::Results& results, const SQLString& sql)
   {
+    TraceSpan span("query", this, &sql);
     cmdPrologue();
     try {
 
@@ -126,9 +203,179 @@ namespace capi
     }
   }
 
+  /**
+   * Non-throwing executeQuery. The error of the server for the query is put into the error info, the errors of the
+   * connection, and of the following results of the multi-statement are thrown as usual.
+   *
+   * @return false if the server has returned the error for the query
+   */
+  bool QueryProtocol::tryExecuteQuery(bool /*mustExecuteOnMaster*/, Shared::Results& results, const SQLString& sql,
+    ErrorInfo& error)
+  {
+    TraceSpan span("query", this, &sql);
+    cmdPrologue();
+    try {
+
+      if (!tryRealQuery(sql, error)) {
+        span.fail();
+        return false;
+      }
+      getResult(results.get());
+
+    }catch (SQLException& sqlException){
+      if (sqlException.getSQLState().compare("70100") == 0 && 1927 == sqlException.getErrorCode()){
+        throw sqlException;
+      }
+      throw logQuery->exceptionWithQuery(sql, sqlException, explicitClosed);
+    }catch (std::runtime_error& e){
+      handleIoException(e).Throw();
+    }
+    return true;
+  }
+
+
+  /**
+   * Sends all queries without reading results, and then reads results of each query into corresponding results
+   * object. Results of all queries are read even if some of them fail - the connection has to be left in sync.
+   *
+   * @param results results objects, one per query
+   * @param queries queries to send
+   * @throws SQLException the error of the first failed query, once all results have been read
+   */
+  void QueryProtocol::executePipeline(std::vector<Shared::Results>& results, const std::vector<SQLString>& queries)
+  {
+    TraceSpan span("batch", this, queries.empty() ? nullptr : &queries.front(), queries.size());
+    cmdPrologue();
+    std::unique_ptr<SQLException> firstError;
+    std::size_t sent= 0;
+    // Pending changes of the session go first in the pipeline
+    std::vector<SQLString> changes;
+    bool changesSent= false;
+
+    try {
+      if (!queries.empty()) {
+        getSessionChanges(changes);
+        for (const auto& change : changes) {
+          sendQuery(change);
+        }
+        changesSent= !changes.empty();
+      }
+      for (; sent < queries.size(); ++sent) {
+        sendQuery(queries[sent]);
+      }
+      metrics.roundTrip();
+    }
+    catch (SQLException& sqlException) {
+      firstError.reset(new SQLException(logQuery->exceptionWithQuery(queries[sent], sqlException, explicitClosed)));
+    }
+    if (changesSent) {
+      readSessionChanges(firstError);
+    }
+
+    for (std::size_t i= 0; i < sent; ++i) {
+      try {
+        // We don't need exception on error here. getResult reads error and throws
+        capi::mysql_read_query_result(connection.get());
+        getResult(results[i].get(), nullptr, true);
+      }
+      catch (SQLException& sqlException) {
+        if (mysql_get_socket(connection.get()) == MARIADB_INVALID_SOCKET) {
+          std::runtime_error e(sqlException.what());
+          handleIoException(e).Throw();
+        }
+        if (!firstError) {
+          firstError.reset(new SQLException(logQuery->exceptionWithQuery(queries[i], sqlException, explicitClosed)));
+        }
+      }
+    }
+    if (firstError) {
+      throw *firstError;
+    }
+  }
+
+  /**
+   * Starts non-blocking execution of the query. Like other internal execution methods, it is not synchronized -
+   * caller has to take care of that.
+   *
+   * @param sql query to execute
+   * @return bitmask of events(MYSQL_WAIT_*) the execution waits for, or 0 if the query is done
+   * @throws SQLException if the query failed
+   */
+  int32_t QueryProtocol::executeQueryAsyncStart(const SQLString& sql)
+  {
+    cmdPrologue();
+    applySessionChanges();
+    // The context with its own stack is allocated for the non-blocking mode, thus it's not set unless needed
+    if (!nonBlocking) {
+      if (capi::mysql_optionsv(connection.get(), MYSQL_OPT_NONBLOCK, 0) != 0) {
+        throw SQLException("Could not switch connection to non-blocking mode");
+      }
+      nonBlocking= true;
+    }
+    int32_t error= 0;
+    asyncQuery= sql;
+    asyncPending= true;
+    metrics.query(sql.length());
+    metrics.roundTrip();
+    MetadataCache::queryExecuted(getHostAddress(), sql.c_str(), sql.length());
+
+    return asyncQueryStatus(
+      capi::mysql_real_query_start(&error, connection.get(), sql.c_str(), static_cast<unsigned long>(sql.length())),
+      error);
+  }
+
+  /**
+   * Continues non-blocking execution of the query.
+   *
+   * @param readyEvents bitmask of events(MYSQL_WAIT_*) that have occurred
+   * @return bitmask of events the execution waits for, or 0 if the query is done
+   * @throws SQLException if the query failed
+   */
+  int32_t QueryProtocol::executeQueryAsyncContinue(int32_t readyEvents)
+  {
+    if (!asyncPending) {
+      throw SQLException("There is no asynchronous query in progress");
+    }
+    int32_t error= 0;
+    return asyncQueryStatus(capi::mysql_real_query_cont(&error, connection.get(), readyEvents), error);
+  }
+
+
+  int32_t QueryProtocol::asyncQueryStatus(int32_t status, int32_t error)
+  {
+    if (status != 0) {
+      return status;
+    }
+    asyncPending= false;
+    if (error != 0) {
+      SQLException sqlException(capi::mysql_error(connection.get()), capi::mysql_sqlstate(connection.get()),
+        capi::mysql_errno(connection.get()));
+
+      if (mysql_get_socket(connection.get()) == MARIADB_INVALID_SOCKET) {
+        std::runtime_error e(sqlException.what());
+        throw logQuery->exceptionWithQuery(asyncQuery, *handleIoException(e, false).getException(), explicitClosed);
+      }
+      throw logQuery->exceptionWithQuery(asyncQuery, sqlException, explicitClosed);
+    }
+    return 0;
+  }
+
+
+  int64_t QueryProtocol::getNativeSocket()
+  {
+    return static_cast<int64_t>(capi::mysql_get_socket(connection.get()));
+  }
+
+
+  uint32_t QueryProtocol::getAsyncTimeout()
+  {
+    return capi::mysql_get_timeout_value_ms(connection.get());
+  }
+
 
   void QueryProtocol::executeQuery( bool /*mustExecuteOnMaster*/, Shared::Results& results, const SQLString& sql, const Charset* /*charset*/)
   {
+    TraceSpan span("query", this, &sql);
     cmdPrologue();
     try {
 
@@ -177,6 +424,19 @@ namespace capi
     addQueryTimeout(out, queryTimeout);
 
     const std::vector<SQLString> &queryPart= clientPrepareResult->getQueryParts();
+    std::size_t length= out.length();
+
+    // Sizing the buffer once, so parameters are written without reallocations. Streams have unknown length
+    for (const auto& part : queryPart) {
+      length+= part.length();
+    }
+    for (uint32_t i = 0; i < clientPrepareResult->getParamCount(); i++) {
+      int64_t paramLength= parameters[i]->getApproximateTextProtocolLength();
+      if (paramLength > 0) {
+        length+= static_cast<std::size_t>(paramLength);
+      }
+    }
+    out.reserve(length);
 
     if (clientPrepareResult->isRewriteType()) {
 
@@ -199,6 +459,117 @@ namespace capi
       }
     }
   }
+
+  /* Text protocol representation of the value of executeWith */
+  static void writeValue(SQLString& out, const ParameterValue& value, bool noBackslashEscapes)
+  {
+    switch (value.kind) {
+    case ParameterValue::INTEGER:
+    {
+      int64_t number;
+      switch (value.length) {
+      case 1: number= *static_cast<const int8_t*>(value.value); break;
+      case 2: number= *static_cast<const int16_t*>(value.value); break;
+      case 4: number= *static_cast<const int32_t*>(value.value); break;
+      default: number= *static_cast<const int64_t*>(value.value);
+      }
+      out.append(std::to_string(number));
+      break;
+    }
+    case ParameterValue::UNSIGNED:
+    {
+      uint64_t number;
+      switch (value.length) {
+      case 1: number= *static_cast<const uint8_t*>(value.value); break;
+      case 2: number= *static_cast<const uint16_t*>(value.value); break;
+      case 4: number= *static_cast<const uint32_t*>(value.value); break;
+      default: number= *static_cast<const uint64_t*>(value.value);
+      }
+      out.append(std::to_string(number));
+      break;
+    }
+    case ParameterValue::REAL:
+    {
+      // std::to_string is not precise enough
+      std::ostringstream realAsString;
+      if (value.length == sizeof(float)) {
+        realAsString << std::scientific << std::setprecision(9) << *static_cast<const float*>(value.value);
+      }
+      else {
+        realAsString << std::scientific << std::setprecision(30) << *static_cast<const double*>(value.value);
+      }
+      out.append(realAsString.str());
+      break;
+    }
+    case ParameterValue::STRING:
+      out.append('\'');
+      Utils::escapeData(static_cast<const char*>(value.value), value.length, noBackslashEscapes, out);
+      out.append('\'');
+      break;
+    default:
+      out.append("NULL");
+    }
+  }
+
+
+  void assemblePreparedQueryForExec(
+    SQLString& out,
+    ClientPrepareResult* clientPrepareResult,
+    const ParameterValue* values,
+    bool noBackslashEscapes,
+    int32_t queryTimeout)
+  {
+    addQueryTimeout(out, queryTimeout);
+
+    const std::vector<SQLString> &queryPart= clientPrepareResult->getQueryParts();
+    std::size_t length= out.length();
+
+    for (const auto& part : queryPart) {
+      length+= part.length();
+    }
+    for (uint32_t i = 0; i < clientPrepareResult->getParamCount(); i++) {
+      // Numbers fit in the same space as the quoted string
+      length+= values[i].kind == ParameterValue::STRING ? values[i].length*2 + 2 : 38;
+    }
+    out.reserve(length);
+
+    std::size_t next= 1;
+    if (clientPrepareResult->isRewriteType()) {
+      out.append(queryPart[0]);
+      next= 2;
+    }
+    out.append(queryPart[next - 1]);
+    for (uint32_t i = 0; i < clientPrepareResult->getParamCount(); i++) {
+      writeValue(out, values[i], noBackslashEscapes);
+      out.append(queryPart[i + next]);
+    }
+    if (clientPrepareResult->isRewriteType()) {
+      out.append(queryPart[clientPrepareResult->getParamCount() + 2]);
+    }
+  }
+
+  // Bigger buffers are not kept between queries
+  static const std::size_t MAX_KEPT_QUERY_BUFFER= 1024*1024;
+
+  /* Hands out the connection's query buffer empty, and frees its memory after the query, if it has grown too big.
+     The change of the kept memory goes to the process wide accounting */
+  class QueryBuffer
+  {
+    SQLString& buffer;
+    std::size_t capacity;
+
+  public:
+    QueryBuffer(SQLString& _buffer) : buffer(_buffer), capacity(bufferBytes(_buffer)) { buffer.clear(); }
+    ~QueryBuffer()
+    {
+      if (StringImp::get(buffer).capacity() > MAX_KEPT_QUERY_BUFFER) {
+        std::string().swap(StringImp::get(buffer));
+      }
+      MemoryAccounting::resized(MemoryAccounting::CONNECTION_BUFFERS, capacity, bufferBytes(buffer));
+    }
+    SQLString& get() { return buffer; }
+  };
+
   /**
    * Execute a unique clientPrepareQuery.
    *
@@ -216,31 +587,55 @@ namespace capi
       std::vector<Shared::ParameterHolder>& parameters,
       int32_t queryTimeout)
   {
+    TraceSpan span("query", this, &clientPrepareResult->getSql());
     cmdPrologue();
 
-    SQLString sql;
+    QueryBuffer buffer(queryBuffer);
+    SQLString& sql= buffer.get();
     addQueryTimeout(sql, queryTimeout);
 
     try {
 
-      if (clientPrepareResult->getParamCount() == 0
-        && !clientPrepareResult->isQueryMultiValuesRewritable()) {
-        if (clientPrepareResult->getQueryParts().size() == 1) {
-          sql.append(clientPrepareResult->getQueryParts().front());
-          realQuery(sql);
-        }
-        else {
-          for (const auto& query : clientPrepareResult->getQueryParts())
-          {
-            sql.append(query);
-          }
-          realQuery(sql);
-        }
-      }
-      else {
-        /* Timeout has been added already, thus passing -1 for its value */
-        assemblePreparedQueryForExec(sql, clientPrepareResult, parameters, -1);
-        realQuery(sql);
+      assembleQuery(sql, clientPrepareResult, parameters);
+      realQuery(sql);
+      getResult(results.get());
+
+    }
+    catch (SQLException& queryException) {
+      throw logQuery->exceptionWithQuery(parameters, queryException, clientPrepareResult);
+    }
+    catch (std::runtime_error& e) {
+      handleIoException(e).Throw();
+    }
+  }
+
+  /**
+   * Non-throwing execution of the clientPrepareQuery. Like with the text query, only the error of the server for the
+   * query is returned.
+   *
+   * @return false if the server has returned the error for the query
+   */
+  bool QueryProtocol::tryExecuteQuery(
+      bool /*mustExecuteOnMaster*/,
+      Shared::Results& results,
+      ClientPrepareResult* clientPrepareResult,
+      std::vector<Shared::ParameterHolder>& parameters,
+      int32_t queryTimeout,
+      ErrorInfo& error)
+  {
+    TraceSpan span("query", this, &clientPrepareResult->getSql());
+    cmdPrologue();
+
+    QueryBuffer buffer(queryBuffer);
+    SQLString& sql= buffer.get();
+    addQueryTimeout(sql, queryTimeout);
+
+    try {
+
+      assembleQuery(sql, clientPrepareResult, parameters);
+      if (!tryRealQuery(sql, error)) {
+        span.fail();
+        return false;
       }
       getResult(results.get());
 
@@ -251,6 +646,29 @@ namespace capi
     catch (std::runtime_error& e) {
       handleIoException(e).Throw();
     }
+    return true;
+  }
+
+  /* Appends the query with parameters to the sql, that may already have the timeout */
+  void QueryProtocol::assembleQuery(SQLString& sql, ClientPrepareResult* clientPrepareResult,
+    std::vector<Shared::ParameterHolder>& parameters)
+  {
+    if (clientPrepareResult->getParamCount() == 0
+      && !clientPrepareResult->isQueryMultiValuesRewritable()) {
+      if (clientPrepareResult->getQueryParts().size() == 1) {
+        sql.append(clientPrepareResult->getQueryParts().front());
+      }
+      else {
+        for (const auto& query : clientPrepareResult->getQueryParts())
+        {
+          sql.append(query);
+        }
+      }
+    }
+    else {
+      /* Timeout has been added already, thus passing -1 for its value */
+      assemblePreparedQueryForExec(sql, clientPrepareResult, parameters, -1);
+    }
   }
 
   /**
@@ -271,6 +689,7 @@ namespace capi
       bool hasLongData)
 
   {
+    TraceSpan span("batch", this, &prepareResult->getSql(), parametersList.size());
     // ***********************************************************************************************************
     // Multiple solution for batching :
     // - rewrite as multi-values (only if generated keys are not needed and query can be rewritten)
@@ -293,7 +712,7 @@ namespace capi
         if (options->useBulkStmts
             && !hasLongData
             && prepareResult->isQueryMultipleRewritable()
-            && results->getAutoGeneratedKeys()==Statement::NO_GENERATED_KEYS
+            && (results->getAutoGeneratedKeys() == Statement::NO_GENERATED_KEYS || bulkUnitResults)
             && executeBulkBatch(results, prepareResult->getSql(), nullptr, parametersList)){
           return true;
         }
@@ -307,7 +726,7 @@ namespace capi
 
     if (options->useBulkStmts
         && !hasLongData
-        && results->getAutoGeneratedKeys()==Statement::NO_GENERATED_KEYS
+        && (results->getAutoGeneratedKeys() == Statement::NO_GENERATED_KEYS || bulkUnitResults)
         && executeBulkBatch(results,prepareResult->getSql(),nullptr,parametersList)){
       return true;
     }
@@ -385,6 +804,7 @@ namespace capi
     }
 
     cmdPrologue();
+    applySessionChanges();
 
     ServerPrepareResult* tmpServerPrepareResult= serverPrepareResult;
 
@@ -408,22 +828,67 @@ namespace capi
       {
         return false;
       }
+      if (options->bulkIsolateErrors && options->continueBatchOnError && bulkUnitResults && parametersList.size() > 1) {
+        bool autoCommit= getAutocommit();
+        SQLException firstError;
+
+        if (autoCommit) {
+          CONST_QUERY("SET AUTOCOMMIT=0");
+        }
+        try {
+          executeBulkIsolated(results.get(), tmpServerPrepareResult, parametersList, types.data(), firstError);
+        }
+        catch (SQLException& sqle) {
+          if (autoCommit && !sqle.getSQLState().startsWith("08")) {
+            commitReturnAutocommit();
+          }
+          if (!serverPrepareResult && releasePrepareStatement(tmpServerPrepareResult)) {
+            delete tmpServerPrepareResult;
+          }
+          if (sqle.getErrorCode() == 1295) {
+            results->getCmdInformation()->reset();
+            return false;
+          }
+          throw logQuery->exceptionWithQuery(sql, sqle, explicitClosed);
+        }
+        if (autoCommit) {
+          commitReturnAutocommit();
+        }
+        if (!serverPrepareResult && releasePrepareStatement(tmpServerPrepareResult)) {
+          delete tmpServerPrepareResult;
+        }
+        if (!firstError.getMessage().empty()) {
+          throw logQuery->exceptionWithQuery(sql, firstError, explicitClosed);
+        }
+        results->setRewritten(false);
+        return true;
+      }
+
       unsigned int bulkArrSize= static_cast<unsigned int>(parametersList.size());
 
       capi::mysql_stmt_attr_set(statementId, STMT_ATTR_ARRAY_SIZE, (const void*)&bulkArrSize);
       auto firstParameters= parametersList.front();
 
       tmpServerPrepareResult->bindParameters(parametersList, types.data());
-      capi::mysql_stmt_execute(statementId);
+      MetricsRecorder::increment(metrics.executes);
+      MetricsRecorder::increment(metrics.bulkExecutes);
+      metrics.roundTrip();
+      stmtExecute(statementId);
 
+      bool unitResults= false;
       try {
-        getResult(results.get(), tmpServerPrepareResult);
+        unitResults= readBulkUnitResults(results.get(), tmpServerPrepareResult);
+        if (!unitResults) {
+          getResult(results.get(), tmpServerPrepareResult);
+        }
       }
       catch (SQLException& sqle) {
         if (!serverPrepareResult && tmpServerPrepareResult) {
-          releasePrepareStatement(tmpServerPrepareResult);
-          // releasePrepareStatement basically cares only about releasing stmt on server(and C API handle)
-          delete tmpServerPrepareResult;
+          // releasePrepareStatement basically cares only about releasing stmt on server(and C API handle). The cached
+          // prepare stays in the cache
+          if (releasePrepareStatement(tmpServerPrepareResult)) {
+            delete tmpServerPrepareResult;
+          }
           tmpServerPrepareResult= nullptr;
         }
         if (sqle.getSQLState().compare("HY000") == 0 && sqle.getErrorCode()==1295) {
@@ -444,21 +909,26 @@ namespace capi
       if (!exception.getMessage().empty()) {
         throw exception;
       }
-      results->setRewritten(true);
+      // With unit results there is a separate update count for each parameter set
+      results->setRewritten(!unitResults);
       
       if (!serverPrepareResult && tmpServerPrepareResult) {
-        releasePrepareStatement(tmpServerPrepareResult);
-        // releasePrepareStatement basically cares only about releasing stmt on server(and C API handle)
-        delete tmpServerPrepareResult;
+        // releasePrepareStatement basically cares only about releasing stmt on server(and C API handle). The cached
+        // prepare stays in the cache
+        if (releasePrepareStatement(tmpServerPrepareResult)) {
+          delete tmpServerPrepareResult;
+        }
       }
       return true;
 
     }
     catch (std::runtime_error& e) {
       if (!serverPrepareResult && tmpServerPrepareResult) {
-        releasePrepareStatement(tmpServerPrepareResult);
-        // releasePrepareStatement basically cares only about releasing stmt on server(and C API handle)
-        delete tmpServerPrepareResult;
+        // releasePrepareStatement basically cares only about releasing stmt on server(and C API handle). The cached
+        // prepare stays in the cache
+        if (releasePrepareStatement(tmpServerPrepareResult)) {
+          delete tmpServerPrepareResult;
+        }
       }
       handleIoException(e).Throw();
     }
@@ -466,32 +936,180 @@ namespace capi
     return false;
   }
 
-  void QueryProtocol::initializeBatchReader()
+  /* Sends the rows as one bulk, and reads its per row results. The error is thrown without adding anything to the
+     results */
+  void QueryProtocol::executeBulkRows(Results* results, ServerPrepareResult* serverPrepareResult,
+    std::vector<std::vector<Shared::ParameterHolder>>& rows, const int16_t* types)
+  {
+    capi::MYSQL_STMT* statementId= serverPrepareResult->getStatementId();
+    unsigned int bulkArrSize= static_cast<unsigned int>(rows.size());
+
+    capi::mysql_stmt_attr_set(statementId, STMT_ATTR_ARRAY_SIZE, (const void*)&bulkArrSize);
+    serverPrepareResult->bindParameters(rows, types);
+    MetricsRecorder::increment(metrics.executes);
+    MetricsRecorder::increment(metrics.bulkExecutes);
+    metrics.roundTrip();
+    if (stmtExecute(statementId) != 0) {
+      throwStmtError(statementId);
+    }
+    if (!readBulkUnitResults(results, serverPrepareResult)) {
+      getResult(results, serverPrepareResult);
+    }
+  }
+
+  /* Executes the rows in one bulk. If that fails, the rows are rolled back to the savepoint, and each half is
+     executed the same way, down to the single rows, that get the error as their status. Thus f failed rows of n cost
+     about f*log2(n) bulks. The connection has to be in the transaction */
+  void QueryProtocol::executeBulkIsolated(Results* results, ServerPrepareResult* serverPrepareResult,
+    std::vector<std::vector<Shared::ParameterHolder>>& rows, const int16_t* types, SQLException& firstError)
   {
-    if (options->useBatchMultiSend){
-      //readScheduler= SchedulerServiceProviderHolder::getBulkScheduler();
+    // The failed statement of the single row is rolled back by the server
+    if (rows.size() > 1) {
+      CONST_QUERY("SAVEPOINT mariadb_connector_bulk");
+    }
+    try {
+      executeBulkRows(results, serverPrepareResult, rows, types);
+      return;
+    }
+    catch (SQLException& sqle) {
+      if (sqle.getSQLState().startsWith("08") || sqle.getErrorCode() == 1295) {
+        throw;
+      }
+      if (rows.size() == 1) {
+        results->addStatsError(false);
+        if (firstError.getMessage().empty()) {
+          firstError= sqle;
+        }
+        return;
+      }
     }
+    CONST_QUERY("ROLLBACK TO SAVEPOINT mariadb_connector_bulk");
+
+    std::size_t half= rows.size() / 2;
+    std::vector<std::vector<Shared::ParameterHolder>> head(rows.begin(), rows.begin() + half);
+    std::vector<std::vector<Shared::ParameterHolder>> tail(rows.begin() + half, rows.end());
+    executeBulkIsolated(results, serverPrepareResult, head, types, firstError);
+    executeBulkIsolated(results, serverPrepareResult, tail, types, firstError);
   }
 
   /**
-   * Execute clientPrepareQuery batch.
+   * Number of statements of the multi-send batch, that may be sent ahead of reading their results. Statements are
+   * written, while the results of the earlier ones are read, and the window keeps the unread results small enough to
+   * fit the socket buffers - otherwise the server could block on writing them, while the client is blocked on writing
+   * the next statement. Results are read in the same thread - the C API connection has one buffer for both directions.
    *
-   * @param results results
-   * @param clientPrepareResult ClientPrepareResult
-   * @param parametersList List of parameters
-   * @throws SQLException exception
+   * @return the window size
    */
-  void QueryProtocol::executeBatchMulti(
-      Shared::Results& results,
-      ClientPrepareResult* clientPrepareResult,
-      std::vector<std::vector<Shared::ParameterHolder>>& parametersList)
-
+  std::size_t QueryProtocol::initializeBatchReader()
   {
-    cmdPrologue();
-    initializeBatchReader();
+    if (options->adaptiveBatchWindow) {
+      batchWindow.setBufferSize(getSocketSendBuffer());
+      return batchWindow.size();
+    }
+    return static_cast<std::size_t>(std::max(options->useBatchMultiSendNumber, 1));
+  }
+
+
+  std::size_t QueryProtocol::getBatchWindow()
+  {
+    std::lock_guard<ConnectionMutex> localScopeLock(*lock);
+    return options->adaptiveBatchWindow ? batchWindow.size()
+                                        : static_cast<std::size_t>(std::max(options->useBatchMultiSendNumber, 1));
+  }
+
+  /**
+   * Waits with MASTER_GTID_WAIT until the server, as the replica, has applied the GTID. Zero timeout only checks the
+   * position.
+   *
+   * @return false if the timeout has passed first
+   */
+  bool QueryProtocol::waitForGtid(const SQLString& gtid, int32_t timeout)
+  {
+    std::lock_guard<ConnectionMutex> localScopeLock(*lock);
+    cmdPrologue();
+    bool applied= false;
+    SQLString query("SELECT MASTER_GTID_WAIT('");
+    query.append(gtid).append("',").append(std::to_string(timeout / 1000)).append(".")
+      .append(std::to_string(1000 + timeout % 1000).substr(1)).append(")");
+
+    realQuery(query);
+    MYSQL_RES* res= mysql_store_result(connection.get());
+    if (res != nullptr) {
+      MYSQL_ROW row= mysql_fetch_row(res);
+      applied= row != nullptr && row[0] != nullptr && std::strcmp(row[0], "0") == 0;
+      mysql_free_result(res);
+    }
+    return applied;
+  }
+
+  /**
+   * Sends the statement of the multi-send batch. With adaptiveBatchWindow the time of the write goes to the window - a
+   * write, that blocks, means the socket buffers are full.
+   *
+   * @param sql statement to send
+   */
+  void QueryProtocol::sendBatchQuery(const SQLString& sql)
+  {
+    if (!options->adaptiveBatchWindow) {
+      sendQuery(sql);
+      return;
+    }
+    auto start= std::chrono::steady_clock::now();
+    sendQuery(sql);
+    batchWindow.sent(sql.length(), static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start).count()));
+  }
+
+  /**
+   * Reads the result of the next statement of the multi-send batch. Errors are not thrown, but go to the results.
+   *
+   * @param results results of the batch
+   * @param autoCommitPending true, if the result of SET AUTOCOMMIT=0, sent before the batch, has not been read yet
+   */
+  void QueryProtocol::readBatchResult(Results* results, bool& autoCommitPending)
+  {
+    if (autoCommitPending) {
+      // Getting result for setting autocommit off - we don't need it
+      readQueryResult();
+      autoCommitPending= false;
+    }
+    if (!options->adaptiveBatchWindow) {
+      //we don't need exception in case of error, thus calling capi directly
+      capi::mysql_read_query_result(connection.get());
+      getResult(results);
+      return;
+    }
+    // If nothing has arrived yet, the pipe has run empty, and the window could be bigger
+    bool awaited= peekSocket() == SOCKET_IDLE;
+    auto start= std::chrono::steady_clock::now();
+    capi::mysql_read_query_result(connection.get());
+    batchWindow.received(awaited, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start).count()));
+    getResult(results);
+  }
+
+  /**
+   * Execute clientPrepareQuery batch.
+   *
+   * @param results results
+   * @param clientPrepareResult ClientPrepareResult
+   * @param parametersList List of parameters
+   * @throws SQLException exception
+   */
+  void QueryProtocol::executeBatchMulti(
+      Shared::Results& results,
+      ClientPrepareResult* clientPrepareResult,
+      std::vector<std::vector<Shared::ParameterHolder>>& parametersList)
+
+  {
+    cmdPrologue();
+    applySessionChanges();
+    const std::size_t window= initializeBatchReader();
 
     SQLString sql;
     bool autoCommit= getAutocommit();
+    bool autoCommitPending= autoCommit;
+    std::size_t pending= 0;
 
     if (autoCommit) {
       SEND_CONST_QUERY("SET AUTOCOMMIT=0");
@@ -502,20 +1120,26 @@ namespace capi
       sql.clear();
 
       assemblePreparedQueryForExec(sql, clientPrepareResult, parameters, -1);
-      sendQuery(sql);
+      sendBatchQuery(sql);
+      // Results are read as the statements are written, keeping up to window of them in flight. The adaptive window
+      // may change with every statement
+      for (++pending; pending >= (options->adaptiveBatchWindow ? batchWindow.size() : window); --pending) {
+        readBatchResult(results.get(), autoCommitPending);
+      }
     }
+    metrics.roundTrip();
     if (autoCommit) {
 
       // Sending commit, restoring autocommit
       SEND_CONST_QUERY("COMMIT");
       SEND_CONST_QUERY("SET AUTOCOMMIT=1");
-      // Getting result for setting autocommit off - we don't need it
-      readQueryResult();
+      if (autoCommitPending) {
+        readQueryResult();
+        autoCommitPending= false;
+      }
     }
-    for (std::size_t i= 0; i < parametersList.size(); ++i) {
-      // We don't need exception on error here
-      capi::mysql_read_query_result(connection.get());
-      getResult(results.get());
+    for (; pending > 0; --pending) {
+      readBatchResult(results.get(), autoCommitPending);
     }
     if (autoCommit) {
       // Getting result for commit and setting autocommit back on to clear the connection,
@@ -585,13 +1209,15 @@ namespace capi
    */
   void QueryProtocol::executeBatchStmt(bool /*mustExecuteOnMaster*/, Shared::Results& results, const std::vector<SQLString>& queries)
   {
+    TraceSpan span("batch", this, queries.empty() ? nullptr : &queries.front(), queries.size());
     cmdPrologue();
+    applySessionChanges();
     if (this->options->rewriteBatchedStatements) {
 
       // check that queries are rewritable
       bool canAggregateSemiColumn= true;
       std::size_t totalLen= 0;
-      for (SQLString query : queries){
+      for (const SQLString& query : queries){
         if (!ClientPrepareResult::canAggregateSemiColon(query,noBackslashEscapes())){
           canAggregateSemiColumn= false;
           break;
@@ -631,6 +1257,25 @@ namespace capi
       if (autoCommit) {
         CONST_QUERY("SET AUTOCOMMIT=0");
       }
+      // Server stops executing the multi-statement query at the first error, i.e. exactly where the batch has to stop,
+      // so the queries can go in few packets instead of waiting for each result
+      if (queries.size() > 1 && std::all_of(queries.begin(), queries.end(), [this](const SQLString& query) {
+            return ClientPrepareResult::canAggregateSemiColon(query, noBackslashEscapes());
+          })) {
+        try {
+          executeBatchAggregateSemiColon(results, queries, 0);
+        }
+        catch (SQLException&) {
+          if (autoCommit) {
+            commitReturnAutocommit();
+          }
+          throw;
+        }
+        if (autoCommit) {
+          commitReturnAutocommit();
+        }
+        return;
+      }
       for (auto& sql : queries) {
         try {
           stopIfInterrupted();
@@ -657,25 +1302,32 @@ namespace capi
       return;
     }
 
-    MariaDBExceptionThrower exception;
-    initializeBatchReader();
+    const std::size_t window= initializeBatchReader();
+    bool autoCommitPending= autoCommit;
+    std::size_t pending= 0;
+
     if (autoCommit) {
       SEND_CONST_QUERY("SET AUTOCOMMIT=0");
     }
     for (auto& query : queries) {
-      sendQuery(query);
+      sendBatchQuery(query);
+      for (++pending; pending >= (options->adaptiveBatchWindow ? batchWindow.size() : window); --pending) {
+        readBatchResult(results.get(), autoCommitPending);
+      }
     }
+    metrics.roundTrip();
     if (autoCommit) {
       // Sending commit, restoring autocommit
       SEND_CONST_QUERY("COMMIT");
       SEND_CONST_QUERY("SET AUTOCOMMIT=1");
       //Reading result of setting autocommit off
-      readQueryResult();
+      if (autoCommitPending) {
+        readQueryResult();
+        autoCommitPending= false;
+      }
     }
-    for (auto& query : queries) {
-      //we don't need exception in case of error, thus calling capi directly
-      capi::mysql_read_query_result(connection.get());
-      getResult(results.get());
+    for (; pending > 0; --pending) {
+      readBatchResult(results.get(), autoCommitPending);
     }
     if (autoCommit) {
       commitReturnAutocommit(true);
@@ -685,13 +1337,20 @@ namespace capi
 
   ServerPrepareResult* QueryProtocol::prepareInternal(const SQLString& sql, bool /*executeOnMaster*/)
   {
-    if (options->cachePrepStmts && options->useServerPrepStmts) {
+    TraceSpan span("prepare", this, &sql);
+    // The statement is prepared in the current database, that is also the part of the cache key
+    applySessionChanges();
+    SQLString key;
+    if (options->cachePrepStmts && options->useServerPrepStmts && serverPrepareStatementCache) {
 
-      ServerPrepareResult* pr = serverPrepareStatementCache->get(database + "-" + sql);
+      key.append(database).append("-").append(sql);
+      ServerPrepareResult* pr = serverPrepareStatementCache->get(key);
 
-      if (pr && pr->incrementShareCounter()) {
+      if (pr) {
+        MetricsRecorder::increment(metrics.prepareCacheHits);
         return pr;
       }
+      MetricsRecorder::increment(metrics.prepareCacheMisses);
     }
 
     capi::MYSQL_STMT* stmtId = capi::mysql_stmt_init(connection.get());
@@ -704,8 +1363,17 @@ namespace capi
     static const my_bool updateMaxLength= 1;
 
     capi::mysql_stmt_attr_set(stmtId, STMT_ATTR_UPDATE_MAX_LENGTH, &updateMaxLength);
+    MetricsRecorder::increment(metrics.prepares);
+    MetricsRecorder::increment(metrics.bytesSent, sql.length());
+    metrics.roundTrip();
+    MetadataCache::queryExecuted(getHostAddress(), sql.c_str(), sql.length());
 
-    if (capi::mysql_stmt_prepare(stmtId, sql.c_str(), static_cast<unsigned long>(sql.length())))
+    int32_t rc;
+    {
+      MetricsTimer wait(metrics.networkTime);
+      rc= capi::mysql_stmt_prepare(stmtId, sql.c_str(), static_cast<unsigned long>(sql.length()));
+    }
+    if (rc != 0)
     {
       SQLString err(mysql_stmt_error(stmtId)), sqlState(mysql_stmt_sqlstate(stmtId));
       uint32_t errNo = mysql_stmt_errno(stmtId);
@@ -718,16 +1386,10 @@ namespace capi
 
     if (options->cachePrepStmts
       && options->useServerPrepStmts
+      && serverPrepareStatementCache
       && sql.length() < static_cast<size_t>(options->prepStmtCacheSqlLimit)) {
-      SQLString key(getDatabase() + "-" + sql);
-
-      ServerPrepareResult* cachedServerPrepareResult= addPrepareInCache(key, res);
-
-      if (cachedServerPrepareResult != nullptr)
-      {
-        delete res;
-        res= cachedServerPrepareResult;
-      }
+      // If other statement uses the cached prepare of the query, this one simply stays out of the cache
+      addPrepareInCache(key, res);
     }
     return res;
   }
@@ -742,20 +1404,21 @@ namespace capi
   }
 
 
-  bool checkRemainingSize(int64_t newQueryLen)
+  bool checkRemainingSize(int64_t newQueryLen, std::size_t maxLength)
   {
-    return newQueryLen < MAX_PACKET_LENGTH;
+    return newQueryLen <= static_cast<int64_t>(maxLength);
   }
 
 
-  size_t assembleBatchAggregateSemiColonQuery(SQLString& sql, const SQLString &firstSql, const std::vector<SQLString>& queries, size_t currentIndex)
+  size_t assembleBatchAggregateSemiColonQuery(SQLString& sql, const SQLString &firstSql, const std::vector<SQLString>& queries,
+    size_t currentIndex, std::size_t maxLength)
   {
     sql.append(firstSql);
 
     // add query with ";"
     while (currentIndex < queries.size()) {
 
-      if (!checkRemainingSize(sql.length() + queries[currentIndex].length() + 1)) {
+      if (!checkRemainingSize(sql.length() + queries[currentIndex].length() + 1, maxLength)) {
         break;
       }
       sql.append(';').append(queries[currentIndex]);
@@ -765,10 +1428,21 @@ namespace capi
     return currentIndex;
   }
 
+  /**
+   * Maximum length of the query, that can be sent to the server.
+   *
+   * @return session's max_allowed_packet less command byte, or packet size limit if max_allowed_packet is not known
+   */
+  std::size_t QueryProtocol::getMaxQueryLength() const
+  {
+    return maxAllowedPacket > 1 ? maxAllowedPacket - 1 : static_cast<std::size_t>(MAX_PACKET_LENGTH);
+  }
+
   /**
    * Execute list of queries. This method is used when using text batch statement and using
    * rewriting (allowMultiQueries || rewriteBatchedStatements). queries will be send to server
-   * according to max_allowed_packet size.
+   * according to max_allowed_packet size. Up to batchChunksInFlight chunks are sent before reading
+   * their results.
    *
    * @param results result object
    * @param queries list of queries
@@ -780,6 +1454,12 @@ namespace capi
     SQLString firstSql;
     size_t currentIndex= 0;
     size_t totalQueries= queries.size();
+    const std::size_t maxLength= getMaxQueryLength();
+    // Chunks sent after the failed one would be executed, and that is not what the batch stopping on error may do
+    const std::size_t maxInFlight= options->continueBatchOnError ?
+      static_cast<std::size_t>(std::max(options->batchChunksInFlight, 1)) : 1;
+    // Indexes of first queries of chunks, that have been sent, and which results have not been read yet
+    std::deque<std::size_t> inFlight;
     SQLException exception;
     SQLString sql;
 
@@ -787,28 +1467,50 @@ namespace capi
 
       try {
 
-        firstSql= queries[currentIndex++];
+        firstSql= queries[currentIndex];
         if (totalLenEstimation == 0) {
           totalLenEstimation= firstSql.length()*queries.size() + queries.size() - 1;
         }
-        sql.reserve(((std::min<int64_t>(MAX_PACKET_LENGTH, totalLenEstimation) + 7) / 8) * 8);
-        currentIndex= assembleBatchAggregateSemiColonQuery(sql, firstSql, queries, currentIndex);
-        realQuery(sql);
+        sql.reserve(((std::min<int64_t>(maxLength, totalLenEstimation) + 7) / 8) * 8);
+        std::size_t chunkStart= currentIndex;
+        currentIndex= assembleBatchAggregateSemiColonQuery(sql, firstSql, queries, currentIndex + 1, maxLength);
+        sendQuery(sql);
+        metrics.roundTrip();
+        inFlight.push_back(chunkStart);
         sql.clear(); // clear is not supposed to release memory
 
-        getResult(results.get(), nullptr, true);
-
       }catch (SQLException& sqlException){
+        // Nothing can be sent anymore, only results of already sent chunks are to be read
         if (exception.getMessage().empty()){
           exception= logQuery->exceptionWithQuery(firstSql, sqlException, explicitClosed);
-          if (!options->continueBatchOnError){
-            throw exception;
-          }
         }
+        currentIndex= totalQueries;
       }catch (std::runtime_error& e){
         handleIoException(e).Throw();
       }
-      stopIfInterrupted();
+
+      while (!inFlight.empty() && (inFlight.size() >= maxInFlight || currentIndex >= totalQueries)) {
+        std::size_t chunkStart= inFlight.front();
+        inFlight.pop_front();
+        try {
+          // We don't need exception on error here - getResult reads error and throws
+          capi::mysql_read_query_result(connection.get());
+          getResult(results.get(), nullptr, true);
+        }catch (SQLException& sqlException){
+          if (exception.getMessage().empty()){
+            exception= logQuery->exceptionWithQuery(queries[chunkStart], sqlException, explicitClosed);
+            if (!options->continueBatchOnError){
+              // Not sending anything more, but results of chunks in flight still have to be read
+              currentIndex= totalQueries;
+            }
+          }
+        }catch (std::runtime_error& e){
+          handleIoException(e).Throw();
+        }
+      }
+      if (inFlight.empty()) {
+        stopIfInterrupted();
+      }
 
     }while (currentIndex < totalQueries);
 
@@ -818,9 +1520,27 @@ namespace capi
   }
 
 
+  bool isKnownParameterSize(const std::vector<Shared::ParameterHolder>& parameters)
+  {
+    for (auto& parameter : parameters) {
+      if (parameter->getApproximateTextProtocolLength() == -1) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /* Length of the query built in pos. With the direct command its beginning may have been sent already */
+  static std::size_t builtLength(const SQLString& pos, const ConnectProtocol::DirectCommand* command)
+  {
+    return command != nullptr ? command->length() : pos.length();
+  }
+
   /**
   * Client side PreparedStatement.executeBatch values rewritten (concatenate value params according
-  * to max_allowed_packet)
+  * to max_allowed_packet). Parameters sets of known size are added while the query fits maxLength -
+  * if the set does not fit, it is removed from the query. After the parameter set of unknown size
+  * (i.e. stream) the query is not continued.
   *
   * @param pos query string
   * @param queryParts query parts
@@ -828,6 +1548,8 @@ namespace capi
   * @param paramCount parameter pos
   * @param parameterList parameter list
   * @param rewriteValues is query rewritable by adding values
+  * @param maxLength maximum query length
+  * @param command if not null, pos is its text, and the query is sent by full packets before each row
   * @return current index
   * @throws IOException if connection fail
   */
@@ -836,7 +1558,9 @@ namespace capi
     std::size_t currentIndex,
     std::size_t paramCount,
     std::vector<std::vector<Shared::ParameterHolder>> &parameterList,
-    bool rewriteValues)
+    bool rewriteValues,
+    std::size_t maxLength,
+    ConnectProtocol::DirectCommand* command= nullptr)
 
   {
     std::size_t index= currentIndex;
@@ -850,11 +1574,6 @@ namespace capi
       pos.append(firstPart);
       pos.append(secondPart);
 
-      std::size_t staticLength= 1;
-      for (auto& queryPart : queryParts) {
-        staticLength+= queryPart.length();
-      }
-
       for (size_t i= 0; i < paramCount; i++) {
         parameters[i]->writeTo(pos);
         pos.append(queryParts[i +2]);
@@ -863,48 +1582,30 @@ namespace capi
 
 
       while (index <parameterList.size()) {
-        parameters= parameterList[index];
-
-
-        int64_t parameterLength= 0;
-        bool knownParameterSize= true;
-        for (auto& parameter : parameters) {
-          int64_t paramSize= parameter->getApproximateTextProtocolLength();
-          if (paramSize == -1) {
-            knownParameterSize= false;
-            break;
-          }
-          parameterLength+= paramSize;
+        std::vector<Shared::ParameterHolder> &rowParameters= parameterList[index];
+        bool knownParameterSize= isKnownParameterSize(rowParameters);
+        if (command != nullptr) {
+          command->flush(pos.length());
+        }
+        std::size_t rowStart= pos.length();
+
+        pos.append(';');
+        pos.append(firstPart);
+        pos.append(secondPart);
+        for (size_t i= 0; i < paramCount; i++) {
+          rowParameters[i]->writeTo(pos);
+          pos.append(queryParts[i +2]);
         }
+        pos.append(queryParts[paramCount +2]);
 
         if (knownParameterSize) {
-
-
-          if (checkRemainingSize(pos.length() + staticLength + parameterLength)) {
-            pos.append(';');
-            pos.append(firstPart);
-            pos.append(secondPart);
-            for (size_t i= 0; i <paramCount; i++) {
-              parameters[i]->writeTo(pos);
-              pos.append(queryParts[i + 2]);
-            }
-            pos.append(queryParts[paramCount +2]);
-            ++index;
-          }
-          else {
+          if (builtLength(pos, command) > maxLength) {
+            StringImp::get(pos).resize(rowStart);
             break;
           }
+          ++index;
         }
         else {
-
-          pos.append(';');
-          pos.append(firstPart);
-          pos.append(secondPart);
-          for (size_t i= 0; i < paramCount; i++) {
-            parameters[i]->writeTo(pos);
-            pos.append(queryParts[i +2]);
-          }
-          pos.append(queryParts[paramCount +2]);
           ++index;
           break;
         }
@@ -915,54 +1616,36 @@ namespace capi
       pos.append(firstPart);
       pos.append(secondPart);
       size_t lastPartLength= queryParts[paramCount +2].length();
-      size_t intermediatePartLength= queryParts[1].length();
 
       for (size_t i= 0; i <paramCount; i++) {
         parameters[i]->writeTo(pos);
         pos.append(queryParts[i +2]);
-        intermediatePartLength +=queryParts[i +2].length();
       }
 
       while (index <parameterList.size()) {
-        parameters= parameterList[index];
+        std::vector<Shared::ParameterHolder> &rowParameters= parameterList[index];
+        bool knownParameterSize= isKnownParameterSize(rowParameters);
+        if (command != nullptr) {
+          command->flush(pos.length());
+        }
+        std::size_t rowStart= pos.length();
 
+        pos.append(',');
+        pos.append(secondPart);
 
-        int64_t parameterLength= 0;
-        bool knownParameterSize= true;
-        for (auto& parameter : parameters) {
-          int64_t paramSize= parameter->getApproximateTextProtocolLength();
-          if (paramSize == -1) {
-            knownParameterSize= false;
-            break;
-          }
-          parameterLength +=paramSize;
+        for (size_t i= 0; i <paramCount; i++) {
+          rowParameters[i]->writeTo(pos);
+          pos.append(queryParts[i + 2]);
         }
 
         if (knownParameterSize) {
-
-
-          if (checkRemainingSize(pos.length() + 1 + parameterLength + intermediatePartLength + lastPartLength)) {
-            pos.append(',');
-            pos.append(secondPart);
-
-            for (size_t i= 0; i <paramCount; i++) {
-              parameters[i]->writeTo(pos);
-              pos.append(queryParts[i + 2]);
-            }
-            ++index;
-          }
-          else {
+          if (builtLength(pos, command) + lastPartLength > maxLength) {
+            StringImp::get(pos).resize(rowStart);
             break;
           }
+          ++index;
         }
         else {
-          pos.append(',');
-          pos.append(secondPart);
-
-          for (size_t i= 0; i <paramCount; i++) {
-            parameters[i]->writeTo(pos);
-            pos.append(queryParts[i +2]);
-          }
           ++index;
           break;
         }
@@ -973,8 +1656,36 @@ namespace capi
     return index;
   }
 
+  /* Upper bound of the length of the query text, that rewriteQuery builds starting from currentIndex. Rows are counted
+     while the text fits maxLength, plus the row, that does not fit - it is written before it is cut off. A row with the
+     parameter of unknown size ends the chunk */
+  std::size_t rewriteQueryLength(const std::vector<SQLString> &queryParts,
+    std::size_t currentIndex,
+    std::size_t paramCount,
+    std::vector<std::vector<Shared::ParameterHolder>> &parameterList,
+    std::size_t maxLength)
+  {
+    std::size_t rowPartsLength= 1/* , or ; */, length= 0;
+
+    for (const auto& part : queryParts) {
+      rowPartsLength+= part.length();
+    }
+    for (std::size_t index= currentIndex; index < parameterList.size() && length <= maxLength; ++index) {
+      length+= rowPartsLength;
+      for (std::size_t i= 0; i < paramCount; ++i) {
+        int64_t paramLength= parameterList[index][i]->getApproximateTextProtocolLength();
+        if (paramLength < 0) {
+          return length;
+        }
+        length+= static_cast<std::size_t>(paramLength);
+      }
+    }
+    return length;
+  }
+
   /**
-   * Specific execution for batch rewrite that has specific query for memory.
+   * Specific execution for batch rewrite that has specific query for memory. Up to batchChunksInFlight
+   * chunks are sent before reading their results.
    *
    * @param results result
    * @param prepareResult prepareResult
@@ -987,20 +1698,134 @@ namespace capi
       ClientPrepareResult* prepareResult,
       std::vector<std::vector<Shared::ParameterHolder>>& parameterList,
       bool rewriteValues)
+  {
+    const std::size_t maxLength= getMaxQueryLength();
+
+    sendRewrittenChunks(results, prepareResult, parameterList.size(), rewriteValues,
+      [&](SQLString& sql, std::size_t currentIndex, DirectCommand* command)
+      {
+        if (command == nullptr) {
+          sql.reserve(rewriteQueryLength(prepareResult->getQueryParts(), currentIndex, prepareResult->getParamCount(),
+            parameterList, maxLength));
+        }
+        return rewriteQuery(sql, prepareResult->getQueryParts(), currentIndex, prepareResult->getParamCount(),
+          parameterList, rewriteValues, maxLength, command);
+      });
+  }
+
+  /**
+   * Execute the batch of rows encoded at addBatch time, as multi-values queries. The query is the first part of the
+   * rewritable query, the rows separated by commas, and the last part, and is cut at max_allowed_packet. The row longer
+   * than that is sent alone, and the server reports the error.
+   *
+   * @param results result
+   * @param prepareResult prepareResult of the multi-values rewritable query
+   * @param batch rows of the batch
+   * @throws SQLException exception
+   */
+  void QueryProtocol::executeBatchEncoded(
+      Shared::Results& results,
+      ClientPrepareResult* prepareResult,
+      const EncodedBatch& batch)
+  {
+    TraceSpan span("batch", this, &prepareResult->getSql(), batch.size());
+    const std::vector<SQLString>& queryParts= prepareResult->getQueryParts();
+    // The 2nd part is the query up to the values, and the 1st one starts the values tuple, that the rows begin with
+    const SQLString& firstPart= queryParts[1];
+    const SQLString& lastPart= queryParts.back();
+    const std::size_t maxLength= getMaxQueryLength();
+
+    sendRewrittenChunks(results, prepareResult, batch.size(), true,
+      [&](SQLString& sql, std::size_t currentIndex, DirectCommand* command)
+      {
+        std::size_t index= currentIndex;
+        std::size_t length= firstPart.length() + batch.rowLength(index) + lastPart.length();
+
+        for (++index; index < batch.size() && length + 1 + batch.rowLength(index) <= maxLength; ++index) {
+          length+= 1 + batch.rowLength(index);
+        }
+        if (command == nullptr) {
+          sql.reserve(length);
+        }
+        sql.append(firstPart);
+        // Rows are back to back in the buffer, and only commas have to be put between them
+        for (std::size_t i= currentIndex; i < index; ++i) {
+          if (i > currentIndex) {
+            sql.append(',');
+          }
+          if (command != nullptr) {
+            command->flush(sql.length());
+          }
+          sql.append(batch.data() + batch.rowOffset(i), batch.rowLength(i));
+        }
+        sql.append(lastPart);
+        return index;
+      });
+  }
+
+  /**
+   * Sends the rewritten batch in chunks, that buildChunk makes, and reads their results. Up to batchChunksInFlight
+   * chunks are sent before reading their results.
+   *
+   * @param results result
+   * @param prepareResult prepareResult
+   * @param totalRows number of rows in the batch
+   * @param rewriteValues is rewritable flag
+   * @param buildChunk writes the query of the rows starting from the given one, and returns the index of the row
+   *        after the last written. With directWriteThreshold the query is written into the direct command's text,
+   *        and the builder sends full packets of it as it goes
+   * @throws SQLException exception
+   */
+  void QueryProtocol::sendRewrittenChunks(
+      Shared::Results& results,
+      ClientPrepareResult* prepareResult,
+      std::size_t totalRows,
+      bool rewriteValues,
+      const std::function<std::size_t(SQLString&, std::size_t, DirectCommand*)>& buildChunk)
   {
     cmdPrologue();
-    //std::vector<ParameterHolder>::const_iterator parameters;
+    applySessionChanges();
     std::size_t currentIndex= 0;
-    std::size_t totalParameterList= parameterList.size();
+    const std::size_t maxInFlight= static_cast<std::size_t>(std::max(options->batchChunksInFlight, 1));
+    std::size_t inFlight= 0;
+    std::unique_ptr<SQLException> firstError;
+    std::vector<std::size_t> queryRows;
 
     try {
       SQLString sql;
-      sql.reserve(1024); //No estimations. Just something for beginning. stringstream ?
       do {
-        sql.clear();
-        currentIndex= rewriteQuery(sql, prepareResult->getQueryParts(), currentIndex, prepareResult->getParamCount(), parameterList, rewriteValues);
-        realQuery(sql);
-        getResult(results.get(), nullptr, !rewriteValues);
+        std::size_t chunkStart= currentIndex;
+        // The buffer is allocated once for the chunk, and its memory is reused by next chunks
+        if (options->directWriteThreshold > 0 && canSendDirect()) {
+          DirectCommand command(*this, static_cast<uint8_t>(Packet::COM_QUERY));
+          currentIndex= buildChunk(command.text(), currentIndex, &command);
+          command.end();
+        }
+        else {
+          sql.clear();
+          currentIndex= buildChunk(sql, currentIndex, nullptr);
+          sendQuery(sql);
+        }
+        metrics.roundTrip();
+        ++inFlight;
+        queryRows.push_back(currentIndex - chunkStart);
+
+        // On error nothing more is sent, but results of chunks in flight still have to be read
+        while (inFlight > 0 && (inFlight >= maxInFlight || currentIndex >= totalRows || firstError)) {
+          --inFlight;
+          try {
+            capi::mysql_read_query_result(connection.get());
+            getResult(results.get(), nullptr, !rewriteValues);
+          }
+          catch (SQLException& sqlEx) {
+            if (!firstError) {
+              firstError.reset(new SQLException(sqlEx));
+            }
+          }
+        }
+        if (firstError) {
+          throw *firstError;
+        }
 
 #ifdef THE_TIME_HAS_COME
         if (Thread.currentThread().isInterrupted()){
@@ -1008,7 +1833,7 @@ namespace capi
               "Interrupted during batch",INTERRUPTED_EXCEPTION.getSqlState(),-1);
         }
 #endif
-      } while (currentIndex < totalParameterList);
+      } while (currentIndex < totalRows);
 
     }catch (SQLException& sqlEx){
       throw logQuery->exceptionWithQuery(sqlEx,prepareResult);
@@ -1016,6 +1841,10 @@ namespace capi
       handleIoException(e).Throw();
     }/* TODO: something with the finally was once here */ {
       results->setRewritten(rewriteValues);
+      if (rewriteValues) {
+        results->setRewriteRows(std::move(queryRows), prepareResult->getRowUpdateCountMin(),
+          prepareResult->getRowUpdateCountMax());
+      }
     }
   }
 
@@ -1038,12 +1867,13 @@ namespace capi
       std::vector<std::vector<Shared::ParameterHolder>>& parametersList,
       bool hasLongData)
   {
+    TraceSpan span("batch", this, &sql, parametersList.size());
     bool needToRelease= false;
     cmdPrologue();
 
     if (options->useBulkStmts
         && !hasLongData
-        && results->getAutoGeneratedKeys()==Statement::NO_GENERATED_KEYS
+        && (results->getAutoGeneratedKeys() == Statement::NO_GENERATED_KEYS || bulkUnitResults)
         && executeBulkBatch(results, sql, serverPrepareResult, parametersList)) {
       return true;
     }
@@ -1051,7 +1881,6 @@ namespace capi
     if (!options->useBatchMultiSend) {
       return false;
     }
-    initializeBatchReader();
 
     if (serverPrepareResult == nullptr) {
       serverPrepareResult= prepare(sql, true);
@@ -1069,46 +1898,453 @@ namespace capi
   }
 
 
+  /* Read-only cursor lets the result be fetched by fetchSize rows, while the connection is free for other commands.
+     Statement may keep the cursor type from the previous execution, thus it's set every time */
+  void QueryProtocol::setCursorType(ServerPrepareResult* serverPrepareResult, Results* results)
+  {
+    unsigned long cursorType= CURSOR_TYPE_NO_CURSOR;
+    MYSQL_STMT* stmt= serverPrepareResult->getStatementId();
+
+    if (options->useCursorFetch && results->getFetchSize() > 0 && !serverPrepareResult->getColumns().empty() &&
+      results->getResultSetConcurrency() == ResultSet::CONCUR_READ_ONLY) {
+      unsigned long prefetchRows= static_cast<unsigned long>(results->getFetchSize());
+      cursorType= CURSOR_TYPE_READ_ONLY;
+      capi::mysql_stmt_attr_set(stmt, STMT_ATTR_PREFETCH_ROWS, &prefetchRows);
+    }
+    capi::mysql_stmt_attr_set(stmt, STMT_ATTR_CURSOR_TYPE, &cursorType);
+  }
+
+
   void QueryProtocol::executePreparedQuery(
       bool /*mustExecuteOnMaster*/,
       ServerPrepareResult* serverPrepareResult,
       Shared::Results& results,
       std::vector<Shared::ParameterHolder>& parameters)
   {
+    TraceSpan span("execute", this, &serverPrepareResult->getSql());
+    cmdPrologue();
+
+    try {
+
+      if (sendPreparedQuery(serverPrepareResult, results.get(), parameters) != 0) {
+        throwStmtError(serverPrepareResult->getStatementId());
+      }
+      getResult(results.get(), serverPrepareResult);
+
+    }catch (SQLException& qex){
+      throw logQuery->exceptionWithQuery(parameters, qex, serverPrepareResult);
+    }catch (std::runtime_error& e){
+      handleIoException(e).Throw();
+    }
+  }
 
+  /**
+   * Execute a prepared statement with the values of PreparedStatement::executeWith. They are bound right from the
+   * application memory, without parameter holders.
+   *
+   * @param mustExecuteOnMaster was intended to be launched on master connection
+   * @param serverPrepareResult prepare result
+   * @param results execution result
+   * @param values values, one per parameter
+   * @throws SQLException if parameters/statement are wrong, or the execution has failed
+   */
+  void QueryProtocol::executePreparedQuery(
+      bool /*mustExecuteOnMaster*/,
+      ServerPrepareResult* serverPrepareResult,
+      Shared::Results& results,
+      const ParameterValue* values)
+  {
+    TraceSpan span("execute", this, &serverPrepareResult->getSql());
     cmdPrologue();
 
     try {
-      std::unique_ptr<sql::bytes> ldBuffer;
-      uint32_t bytesInBuffer;
+      serverPrepareResult->bindParameterValues(values);
+      setCursorType(serverPrepareResult, results.get());
+      applySessionChanges();
+      MetricsRecorder::increment(metrics.executes);
+      metrics.roundTrip();
 
-      serverPrepareResult->bindParameters(parameters);
+      if (stmtExecute(serverPrepareResult->getStatementId()) != 0) {
+        throwStmtError(serverPrepareResult->getStatementId());
+      }
+      getResult(results.get(), serverPrepareResult);
 
-      for (uint32_t i= 0; i < serverPrepareResult->getParameters().size(); i++){
-        if (parameters[i]->isLongData()){
-          if (!ldBuffer)
-          {
-            ldBuffer.reset(new sql::bytes(MAX_PACKET_LENGTH - 4));
+    }catch (SQLException& qex){
+      throw logQuery->exceptionWithQuery(serverPrepareResult->getSql(), qex, explicitClosed);
+    }catch (std::runtime_error& e){
+      handleIoException(e).Throw();
+    }
+  }
+
+  /**
+   * Non-throwing executePreparedQuery. Only the error of the server for the execution is returned, the rest is thrown.
+   *
+   * @return false if the server has returned the error for the execution
+   */
+  bool QueryProtocol::tryExecutePreparedQuery(
+      bool /*mustExecuteOnMaster*/,
+      ServerPrepareResult* serverPrepareResult,
+      Shared::Results& results,
+      std::vector<Shared::ParameterHolder>& parameters,
+      ErrorInfo& error)
+  {
+    TraceSpan span("execute", this, &serverPrepareResult->getSql());
+    cmdPrologue();
+
+    try {
+
+      if (sendPreparedQuery(serverPrepareResult, results.get(), parameters) != 0) {
+        MYSQL_STMT* stmt= serverPrepareResult->getStatementId();
+        if (!isStatementError(capi::mysql_stmt_errno(stmt))) {
+          throwStmtError(stmt);
+        }
+        ExceptionFactory::toErrorInfo(capi::mysql_stmt_error(stmt), capi::mysql_stmt_sqlstate(stmt),
+          capi::mysql_stmt_errno(stmt), error);
+        span.fail();
+        return false;
+      }
+      getResult(results.get(), serverPrepareResult);
+
+    }catch (SQLException& qex){
+      throw logQuery->exceptionWithQuery(parameters, qex, serverPrepareResult);
+    }catch (std::runtime_error& e){
+      handleIoException(e).Throw();
+    }
+    return true;
+  }
+
+  /* Sends the value of the stream parameter in chunks of the buffers size. With two buffers the next chunk is read from
+     the stream in the separate thread, while the current one is being sent */
+  void QueryProtocol::sendLongData(MYSQL_STMT* stmt, uint32_t index, ParameterHolder& parameter,
+    std::vector<sql::bytes>& buffers, bool direct)
+  {
+    // Parameters, that have the value in memory, make the chunk point to it instead of filling it. The buffers have
+    // to stay intact for the next parameter, thus the chunks only wrap them
+    std::vector<sql::bytes> chunks;
+    std::size_t current= 0;
+
+    chunks.reserve(buffers.size());
+    for (auto& buffer : buffers) {
+      chunks.emplace_back(buffer.arr, buffer.size());
+    }
+    uint32_t bytesInBuffer= parameter.writeBinary(chunks[current]);
+
+    while (bytesInBuffer > 0) {
+      sql::bytes& chunk= chunks[current];
+      std::future<uint32_t> next;
+
+      if (chunks.size() > 1) {
+        current= 1 - current;
+        sql::bytes& nextChunk= chunks[current];
+        next= std::async(std::launch::async, [&parameter, &nextChunk]() { return parameter.writeBinary(nextChunk); });
+      }
+      try {
+        if (direct) {
+          sendLongDataDirect(stmt, index, chunk.arr, bytesInBuffer);
+        }
+        else if (capi::mysql_stmt_send_long_data(stmt, index, chunk.arr, bytesInBuffer)) {
+          throwStmtError(stmt);
+        }
+      }
+      catch (...) {
+        if (next.valid()) {
+          next.wait();
+        }
+        throw;
+      }
+      MetricsRecorder::increment(metrics.bytesSent, bytesInBuffer);
+      bytesInBuffer= next.valid() ? next.get() : parameter.writeBinary(chunk);
+    }
+  }
+
+
+  /* Sends the chunk of the long data with COM_STMT_SEND_LONG_DATA right from its memory, bypassing the C API's copies
+     into its command and network buffers */
+  void QueryProtocol::sendLongDataDirect(MYSQL_STMT* stmt, uint32_t index, const char* data, std::size_t length)
+  {
+    char header[6];
+
+    // The empty chunk marks the parameter as the long data, that mysql_stmt_execute does not send. It's sent only once
+    if (capi::mysql_stmt_send_long_data(stmt, index, header, 0)) {
+      throwStmtError(stmt);
+    }
+    header[0]= static_cast<char>(stmt->stmt_id);
+    header[1]= static_cast<char>(stmt->stmt_id >> 8);
+    header[2]= static_cast<char>(stmt->stmt_id >> 16);
+    header[3]= static_cast<char>(stmt->stmt_id >> 24);
+    header[4]= static_cast<char>(index);
+    header[5]= static_cast<char>(index >> 8);
+    sendCommandDirect(static_cast<uint8_t>(Packet::COM_STMT_SEND_LONG_DATA), header, sizeof(header), data, length);
+  }
+
+
+  /* mysql_stmt_execute, which time goes to the network time in the metrics */
+  int32_t QueryProtocol::stmtExecute(MYSQL_STMT* stmt)
+  {
+    MetricsTimer wait(metrics.networkTime);
+    return capi::mysql_stmt_execute(stmt);
+  }
+
+
+  /* Binds parameters, sends the long data and executes the statement. Returns the result of mysql_stmt_execute */
+  int32_t QueryProtocol::sendPreparedQuery(ServerPrepareResult* serverPrepareResult, Results* results,
+    std::vector<Shared::ParameterHolder>& parameters)
+  {
+    std::vector<sql::bytes> ldBuffers;
+    const std::size_t directThreshold= static_cast<std::size_t>(std::max(options->directWriteThreshold, 0));
+    const bool direct= directThreshold > 0 && canSendDirect();
+
+    serverPrepareResult->bindParameters(parameters);
+
+    for (uint32_t i= 0; i < serverPrepareResult->getParameters().size(); i++){
+      // Big values in the application memory are sent as the long data from that memory instead of being copied into
+      // the execute packet
+      if (direct && !parameters[i]->isLongData() && !parameters[i]->isNullData()
+          && parameters[i]->getValueBinLen() >= directThreshold) {
+        sendLongDataDirect(serverPrepareResult->getStatementId(), i,
+          static_cast<const char*>(parameters[i]->getValuePtr()), parameters[i]->getValueBinLen());
+        MetricsRecorder::increment(metrics.bytesSent, parameters[i]->getValueBinLen());
+      }
+      else if (parameters[i]->isLongData()){
+        if (ldBuffers.empty())
+        {
+          int64_t chunkSize= std::min<int64_t>(options->longDataChunkSize, MAX_PACKET_LENGTH - 4);
+          std::size_t bufferCount= options->longDataReadAhead ? 2 : 1;
+
+          ldBuffers.reserve(bufferCount);
+          while (ldBuffers.size() < bufferCount) {
+            ldBuffers.emplace_back(chunkSize);
           }
+        }
+        sendLongData(serverPrepareResult->getStatementId(), i, *parameters[i], ldBuffers, direct);
+      }
+    }
 
-          while ((bytesInBuffer= parameters[i]->writeBinary(*ldBuffer)) > 0)
-          {
-            capi::mysql_stmt_send_long_data(serverPrepareResult->getStatementId(), i, ldBuffer->arr, bytesInBuffer);
+    setCursorType(serverPrepareResult, results);
+    applySessionChanges();
+    MetricsRecorder::increment(metrics.executes);
+    metrics.roundTrip();
+
+    return stmtExecute(serverPrepareResult->getStatementId());
+  }
+
+  /**
+   * Executes batch, that has parameters bound column-wise to the arrays in the application memory. With bulk
+   * support the arrays are sent with one COM_STMT_BULK_EXECUTE, without copying, otherwise rows are executed one
+   * after the other.
+   *
+   * @param serverPrepareResult prepare result
+   * @param results results
+   * @param arrays parameter arrays, one per parameter
+   * @param rows number of values in each array
+   * @throws SQLException if execution failed
+   */
+  void QueryProtocol::executeBatchArrays(
+      ServerPrepareResult* serverPrepareResult,
+      Shared::Results& results,
+      const std::vector<ParameterArray>& arrays,
+      uint32_t rows)
+  {
+    static const unsigned int noArray= 0;
+    TraceSpan span("batch", this, &serverPrepareResult->getSql(), rows);
+
+    cmdPrologue();
+    applySessionChanges();
+
+    capi::MYSQL_STMT* statementId= serverPrepareResult->getStatementId();
+
+    try {
+      if ((serverCapabilities & MariaDbServerCapabilities::_MARIADB_CLIENT_STMT_BULK_OPERATIONS) != 0) {
+        serverPrepareResult->bindParameterArrays(arrays, rows);
+        MetricsRecorder::increment(metrics.executes);
+        MetricsRecorder::increment(metrics.bulkExecutes);
+        metrics.roundTrip();
+
+        if (stmtExecute(statementId) != 0) {
+          throwStmtError(statementId);
+        }
+        if (!readBulkUnitResults(results.get(), serverPrepareResult)) {
+          getResult(results.get(), serverPrepareResult);
+          results->setRewritten(true);
+        }
+        // Otherwise next regular execution would be sent as bulk
+        capi::mysql_stmt_attr_set(statementId, STMT_ATTR_ARRAY_SIZE, &noArray);
+      }
+      else {
+        capi::mysql_stmt_attr_set(statementId, STMT_ATTR_ARRAY_SIZE, &noArray);
+
+        for (uint32_t row= 0; row < rows; ++row) {
+          serverPrepareResult->bindParameterArraysRow(arrays, row);
+          MetricsRecorder::increment(metrics.executes);
+          metrics.roundTrip();
+
+          if (stmtExecute(statementId) != 0) {
+            throwStmtError(statementId);
           }
+          getResult(results.get(), serverPrepareResult);
         }
       }
+    }catch (SQLException& qex){
+      capi::mysql_stmt_attr_set(statementId, STMT_ATTR_ARRAY_SIZE, &noArray);
+      throw logQuery->exceptionWithQuery(serverPrepareResult->getSql(), qex, explicitClosed);
+    }catch (std::runtime_error& e){
+      handleIoException(e).Throw();
+    }
+  }
 
-      if (capi::mysql_stmt_execute(serverPrepareResult->getStatementId()) != 0) {
-        throwStmtError(serverPrepareResult->getStatementId());
+  /**
+   * Loads rows of the producer into the table with LOAD DATA LOCAL INFILE. The local infile handler of the connection
+   * is replaced for the time of the query, so that rows are read from the producer instead of a file. The name of the
+   * file in the query is not used.
+   *
+   * @param table table name, as it should appear in the query
+   * @param columns names of the columns to load, or nullptr for all columns of the table
+   * @param columnCount number of column names
+   * @param producer source of rows
+   * @return number of loaded rows
+   * @throws SQLException if load failed, or the exception thrown by the producer
+   */
+  int64_t QueryProtocol::executeBulkLoad(const SQLString& table, const SQLString* columns, std::size_t columnCount,
+    RowProducer& producer)
+  {
+    if (!options->allowLocalInfile) {
+      throw SQLFeatureNotSupportedException(
+        "Usage of LOCAL INFILE is disabled. To use it enable it via the connection property allowLocalInfile=true",
+        "0A000");
+    }
+    cmdPrologue();
+
+    SQLString sql("LOAD DATA LOCAL INFILE 'rows' INTO TABLE ");
+    sql.append(table).append(" CHARACTER SET ").append(capi::mysql_character_set_name(connection.get()));
+
+    if (columns != nullptr && columnCount > 0) {
+      sql.append(" (");
+      for (std::size_t i= 0; i < columnCount; ++i) {
+        if (i > 0) {
+          sql.append(',');
+        }
+        sql.append('`').append(replace(columns[i], "`", "``")).append('`');
       }
-      /*CURSOR_TYPE_NO_CURSOR);*/
-      getResult(results.get(), serverPrepareResult);
+      sql.append(')');
+    }
+    else {
+      columnCount= 0;
+    }
+
+    LocalInfileWriter writer(producer, columnCount);
+    Shared::Results results(new Results());
+
+    capi::mysql_set_local_infile_handler(connection.get(), &LocalInfileWriter::localInfileInit,
+      &LocalInfileWriter::localInfileRead, &LocalInfileWriter::localInfileEnd, &LocalInfileWriter::localInfileError,
+      &writer);
+    try {
+      realQuery(sql);
+      capi::mysql_set_local_infile_default(connection.get());
+      getResult(results.get());
+    }catch (SQLException& sqlException){
+      capi::mysql_set_local_infile_default(connection.get());
+      writer.rethrowError();
+      throw logQuery->exceptionWithQuery(sql, sqlException, explicitClosed);
+    }catch (std::runtime_error& e){
+      capi::mysql_set_local_infile_default(connection.get());
+      handleIoException(e).Throw();
+    }
+    return results->getCmdInformation()->getLargeUpdateCount();
+  }
+
+  /**
+   * Prepares and executes the query in one roundtrip - COM_STMT_EXECUTE with statement id -1 is sent right after
+   * COM_STMT_PREPARE, without waiting for its response. Parameters can't have long data, since there is no
+   * statement id to send it for before the execution. If the statement is found in the prepare cache, it is only
+   * executed.
+   *
+   * @param sql query
+   * @param results results
+   * @param parameters parameters, their number is what query is expected to have
+   * @return prepare result of the statement, the caller owns it
+   * @throws SQLException if prepare or execution failed
+   */
+  ServerPrepareResult* QueryProtocol::prepareAndExecute(
+      const SQLString& sql,
+      Shared::Results& results,
+      std::vector<Shared::ParameterHolder>& parameters)
+  {
+    cmdPrologue();
+    // The statement is prepared in the current database, that is also the part of the cache key
+    applySessionChanges();
+
+    SQLString key;
+    if (options->cachePrepStmts && options->useServerPrepStmts && serverPrepareStatementCache) {
+
+      key.append(database).append("-").append(sql);
+      ServerPrepareResult* pr= serverPrepareStatementCache->get(key);
+
+      if (pr) {
+        try {
+          pr->resetParameterTypeHeader();
+          executePreparedQuery(true, pr, results, parameters);
+        }
+        catch (...) {
+          // The prepare goes back to the cache
+          releasePrepareStatement(pr);
+          throw;
+        }
+        return pr;
+      }
+    }
+
+    capi::MYSQL_STMT* stmtId= capi::mysql_stmt_init(connection.get());
+
+    if (stmtId == nullptr) {
+      throw SQLException(capi::mysql_error(connection.get()), capi::mysql_sqlstate(connection.get()), capi::mysql_errno(connection.get()));
+    }
+
+    static const my_bool updateMaxLength= 1;
+    unsigned int paramCount= static_cast<unsigned int>(parameters.size());
+
+    capi::mysql_stmt_attr_set(stmtId, STMT_ATTR_UPDATE_MAX_LENGTH, &updateMaxLength);
+    // Statement is not prepared, thus the number of parameters to bind has to be told
+    capi::mysql_stmt_attr_set(stmtId, STMT_ATTR_PREBIND_PARAMS, &paramCount);
+
+    std::vector<Shared::ColumnDefinition> columns, paramInfo(parameters.size());
+    std::unique_ptr<ServerPrepareResult> serverPrepareResult(new ServerPrepareResult(sql, stmtId, columns, paramInfo, this));
+
+    try {
+      serverPrepareResult->resetParameterTypeHeader();
+      serverPrepareResult->bindParameters(parameters);
+      setCursorType(serverPrepareResult.get(), results.get());
+
+      // Prepare and execute go in one roundtrip
+      MetricsRecorder::increment(metrics.prepares);
+      MetricsRecorder::increment(metrics.executes);
+      MetricsRecorder::increment(metrics.bytesSent, sql.length());
+      metrics.roundTrip();
+      MetadataCache::queryExecuted(getHostAddress(), sql.c_str(), sql.length());
+      int32_t rc;
+      {
+        MetricsTimer wait(metrics.networkTime);
+        rc= capi::mariadb_stmt_execute_direct(stmtId, sql.c_str(), sql.length());
+      }
+      if (rc != 0) {
+        throwStmtError(stmtId);
+      }
+      serverPrepareResult->reReadColumnInfo();
+      getResult(results.get(), serverPrepareResult.get());
 
     }catch (SQLException& qex){
-      throw logQuery->exceptionWithQuery(parameters, qex, serverPrepareResult);
+      throw logQuery->exceptionWithQuery(parameters, qex, serverPrepareResult.get());
     }catch (std::runtime_error& e){
       handleIoException(e).Throw();
     }
+
+    if (options->cachePrepStmts
+      && options->useServerPrepStmts
+      && serverPrepareStatementCache
+      && sql.length() < static_cast<size_t>(options->prepStmtCacheSqlLimit)) {
+      // If other statement uses the cached prepare of the query, this one simply stays out of the cache
+      addPrepareInCache(key, serverPrepareResult.get());
+    }
+    return serverPrepareResult.release();
   }
 
   /** Rollback transaction. */
@@ -1116,7 +2352,7 @@ namespace capi
   {
     cmdPrologue();
 
-    std::lock_guard<std::mutex> localScopeLock(*lock);
+    std::lock_guard<ConnectionMutex> localScopeLock(*lock);
     try {
 
       if (inTransaction()){
@@ -1128,59 +2364,88 @@ namespace capi
   }
 
   /**
-   * Force release of prepare statement that are not used. This method will be call when adding a
-   * new prepare statement in cache, so the packet can be send to server without problem.
+   * Release of prepare statement that are not used. The C API handle is only queued, and the statement is closed
+   * right before the next command, so that neither the cache eviction, nor the statement close cost a network write.
    *
    * @param statementId prepared statement Id to remove.
-   * @return true if successfully released
-   * @throws SQLException if connection exception.
+   * @return true, since the statement is always queued
    */
   bool QueryProtocol::forceReleasePrepareStatement(MYSQL_STMT* statementId)
   {
-
-    if (lock->try_lock()) {
-      checkClose();
-
-      if (mysql_stmt_close(statementId))
-      {
-        connected= false;
-        lock->unlock();
-        throw SQLException(
-            "Could not deallocate query",
-            CONNECTION_EXCEPTION.getSqlState().c_str());
-      }
-      lock->unlock();
-      return true;
-
-    }else {
-      statementIdToRelease= statementId;
+    if (statementId != nullptr) {
+      statementsToRelease.push_back(statementId);
     }
-
-    return false;
+    return true;
   }
 
   /**
-   * Force release of prepare statement that are not used. This permit to deallocate a statement
-   * that cannot be release due to multi-thread use.
+   * Closes the queued statements. Has to be called under the lock - it is done by cmdPrologue.
    *
    * @throws SQLException if connection occur
    */
   void QueryProtocol::forceReleaseWaitingPrepareStatement()
   {
-    if (statementIdToRelease != nullptr && forceReleasePrepareStatement(statementIdToRelease)){
-      statementIdToRelease= nullptr;
+    if (statementsToRelease.empty()) {
+      return;
+    }
+    std::vector<MYSQL_STMT*> toRelease;
+    bool failed= false;
+
+    toRelease.swap(statementsToRelease);
+    // Each close is one packet without response. All handles are closed even if the connection breaks - the C API
+    // frees them anyway
+    for (auto statementId : toRelease) {
+      if (mysql_stmt_close(statementId)) {
+        failed= true;
+      }
+    }
+    if (failed) {
+      connected= false;
+      throw SQLException(
+          "Could not deallocate query",
+          CONNECTION_EXCEPTION.getSqlState().c_str());
     }
   }
 
 
+  /* The round trip is skipped, if the socket is closed, or it is idle and the server has responded within
+     validMinDelay */
   bool QueryProtocol::ping()
   {
-
+    {
+      std::lock_guard<ConnectionMutex> localScopeLock(*lock);
+      if (connected && !asyncPending && activeStreamingResult == nullptr) {
+        switch (peekSocket()) {
+        case SOCKET_CLOSED:
+          // With autoReconnect Connector/C reconnects on the ping
+          if (!options->autoReconnect) {
+            return false;
+          }
+          break;
+        case SOCKET_IDLE:
+          if (options->validMinDelay > 0 &&
+              std::chrono::steady_clock::now() - lastResponse <= std::chrono::milliseconds(options->validMinDelay)) {
+            return true;
+          }
+          break;
+        default:
+          break;
+        }
+      }
+    }
     cmdPrologue();
-    std::lock_guard<std::mutex> localScopeLock(*lock);
+    std::lock_guard<ConnectionMutex> localScopeLock(*lock);
     try {
+      auto start= std::chrono::steady_clock::now();
+      metrics.roundTrip();
 
-      return mysql_ping(connection.get()) == 0;
+      if (mysql_ping(connection.get()) != 0) {
+        return false;
+      }
+      lastResponse= std::chrono::steady_clock::now();
+      HostHealthRegistry::getInstance().updateLatency(getHostAddress(),
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start));
+      return true;
 
     }catch (std::runtime_error& e){
       connected= false;
@@ -1199,7 +2464,11 @@ namespace capi
         this->changeSocketSoTimeout(timeout);
       }
       if (isMasterConnection() && galeraAllowedStates && galeraAllowedStates->size() != 0){
-
+        bool degraded;
+        // Node state and flow control are polled in background for all connections to the node
+        if (HostHealthRegistry::getInstance().galeraDegraded(getHostAddress(), degraded)) {
+          return !degraded && ping();
+        }
 
         Shared::Results results(new Results());
         executeQuery(true, results, CHECK_GALERA_STATE_QUERY);
@@ -1250,11 +2519,11 @@ namespace capi
 
     if ((serverCapabilities & MariaDbServerCapabilities::CLIENT_SESSION_TRACK)!=0){
 
-      return database;
+      return getDatabase();
     }
 
     cmdPrologue();
-    std::lock_guard<std::mutex> localScopeLock(*lock);
+    std::lock_guard<ConnectionMutex> localScopeLock(*lock);
 
     Shared::Results results(new Results());
     executeQuery(isMasterConnection(), results, "select database()");
@@ -1268,81 +2537,208 @@ namespace capi
 
   }
 
+  /* The database is changed with the next command. Without session tracking the current database may have been
+     changed by the application's queries, thus only the tracked one can tell, that the change is not needed */
   void QueryProtocol::setCatalog(const SQLString& _database)
   {
-
     cmdPrologue();
+    std::lock_guard<ConnectionMutex> localScopeLock(*lock);
 
-    std::unique_lock<std::mutex> localScopeLock(*lock);
-
-    if (capi::mysql_select_db(connection.get(), _database.c_str()) != 0) {
-      // TODO: realQuery should throw. Here we could catch and change message
-      if (mysql_get_socket(connection.get()) == MARIADB_INVALID_SOCKET) {
-        std::string msg("Connection lost: ");
-        msg.append(mysql_error(connection.get()));
-        std::runtime_error e(msg.c_str());
-        localScopeLock.unlock();
-        throw logQuery->exceptionWithQuery("COM_INIT_DB", *handleIoException(e, false).getException(), false);
-      }
-      else {
-        throw SQLException(
-          "Could not select database '" + _database + "' : " + mysql_error(connection.get()),
-          mysql_sqlstate(connection.get()),
-          mysql_errno(connection.get()));
-      }
+    if ((serverCapabilities & MariaDbServerCapabilities::CLIENT_SESSION_TRACK) != 0 && database.compare(_database) == 0) {
+      pendingDatabase.clear();
+    }
+    else {
+      pendingDatabase= _database;
     }
-    this->database= _database;
   }
 
   void QueryProtocol::resetDatabase()
   {
-    if (!(database.compare(urlParser->getDatabase()) == 0)){
+    if (!(getDatabase().compare(urlParser->getDatabase()) == 0)){
       setCatalog(urlParser->getDatabase());
     }
   }
 
-  void QueryProtocol::cancelCurrentQuery()
+  /**
+   * Restores session state, that differs from the initial one, sending all needed commands in one multi-statement
+   * query, i.e. in single roundtrip. Nothing is sent if the state hasn't changed.
+   *
+   * @param autocommit autocommit value to restore
+   * @param transactionIsolationLevel isolation level to restore, or 0 if it shouldn't be changed
+   * @param resetDatabase if true, the default database from connection url is restored
+   * @throws SQLException if the query failed
+   */
+  void QueryProtocol::resetSessionState(bool autocommit, int32_t _transactionIsolationLevel, bool resetDatabase)
   {
-    Shared::mutex newMutex(new std::mutex());
-    std::unique_ptr<MasterProtocol> copiedProtocol(
-      new MasterProtocol(urlParser, new GlobalStateInfo(), newMutex));
+    const SQLString& defaultDatabase= urlParser->getDatabase();
 
-    copiedProtocol->setHostAddress(getHostAddress());
-    copiedProtocol->connect();
+    // Like the application's changes, those are sent with the next command
+    setAutocommit(autocommit);
+    if (_transactionIsolationLevel != 0) {
+      setTransactionIsolation(_transactionIsolationLevel);
+    }
+    if (resetDatabase && !defaultDatabase.empty()) {
+      setCatalog(defaultDatabase);
+    }
+  }
 
-    copiedProtocol->executeQuery("KILL QUERY " + std::to_string(serverThreadId));
+  /* Only the query is killed, so the connection stays usable after that */
+  void QueryProtocol::cancelCurrentQuery()
+  {
+    ControlConnectionRegistry::getInstance().execute(urlParser, getHostAddress(),
+      "KILL QUERY " + std::to_string(serverThreadId));
 
     interrupted= true;
   }
 
   bool QueryProtocol::getAutocommit()
   {
+    if (pendingAutocommit != -1) {
+      return pendingAutocommit != 0;
+    }
     return ((serverStatus & ServerStatus::AUTOCOMMIT)!=0);
   }
 
+  /* The change is sent with the next command, and costs nothing, if the server's status says it's not needed.
+     Switching autocommit on commits the open transaction, and that cannot be postponed */
+  void QueryProtocol::setAutocommit(bool autocommit)
+  {
+    cmdPrologue();
+    std::lock_guard<ConnectionMutex> localScopeLock(*lock);
+
+    if (autocommit == ((serverStatus & ServerStatus::AUTOCOMMIT) != 0)) {
+      pendingAutocommit= -1;
+      return;
+    }
+    pendingAutocommit= autocommit ? 1 : 0;
+    if (autocommit && inTransaction()) {
+      applySessionChanges();
+    }
+  }
+
   bool QueryProtocol::inTransaction()
   {
+    // The transaction has ended for the application, even though the server hasn't got COMMIT/ROLLBACK yet
+    if (!pendingTransactionEnd.empty()) {
+      return false;
+    }
     return ((serverStatus &  ServerStatus::IN_TRANSACTION)!=0);
   }
 
 
+  /* COMMIT or ROLLBACK is sent with the next command. It's not checked here, whether the transaction is open */
+  void QueryProtocol::deferTransactionEnd(bool commit)
+  {
+    cmdPrologue();
+    std::lock_guard<ConnectionMutex> localScopeLock(*lock);
+    pendingTransactionEnd= commit ? "COMMIT" : "ROLLBACK";
+    // The transaction end drops all savepoints, and nothing has been executed after the deferred ones
+    pendingSavepoints.clear();
+  }
+
+
+  void QueryProtocol::flushTransactionEnd()
+  {
+    if (!pendingTransactionEnd.empty()) {
+      cmdPrologue();
+      std::lock_guard<ConnectionMutex> localScopeLock(*lock);
+      applyTransactionEnd();
+    }
+  }
+
+
+  void QueryProtocol::deferSavepoint(const SQLString& name, bool release)
+  {
+    cmdPrologue();
+    std::lock_guard<ConnectionMutex> localScopeLock(*lock);
+
+    if (!release) {
+      pendingSavepoints.emplace_back("SAVEPOINT " + name);
+      return;
+    }
+    std::size_t pos= findDeferredSavepoint(name);
+    // Nothing has been executed after the savepoint, and releasing it releases savepoints set after it as well
+    if (pos < pendingSavepoints.size()) {
+      pendingSavepoints.erase(pendingSavepoints.begin() + pos, pendingSavepoints.end());
+    }
+    else {
+      pendingSavepoints.emplace_back("RELEASE SAVEPOINT " + name);
+    }
+  }
+
+
+  bool QueryProtocol::rollbackDeferredSavepoint(const SQLString& name)
+  {
+    cmdPrologue();
+    std::lock_guard<ConnectionMutex> localScopeLock(*lock);
+
+    std::size_t pos= findDeferredSavepoint(name);
+    if (pos < pendingSavepoints.size()) {
+      // The savepoint stays, and savepoints set after it are gone
+      pendingSavepoints.erase(pendingSavepoints.begin() + pos + 1, pendingSavepoints.end());
+      return true;
+    }
+    return false;
+  }
+
+  /* Position of the deferred SAVEPOINT with the name, or the size of pendingSavepoints if it's not there. The search
+     stops at a deferred RELEASE, since it may have released the savepoint searched for */
+  std::size_t QueryProtocol::findDeferredSavepoint(const SQLString& name) const
+  {
+    SQLString query("SAVEPOINT " + name);
+
+    for (std::size_t i= pendingSavepoints.size(); i > 0; --i) {
+      const SQLString& pending= pendingSavepoints[i - 1];
+      if (pending.compare(query) == 0) {
+        return i - 1;
+      }
+      if (pending.startsWith("RELEASE")) {
+        break;
+      }
+    }
+    return pendingSavepoints.size();
+  }
+
+
   void QueryProtocol::closeExplicit()
   {
+    std::unique_ptr<SQLException> transactionEndError;
+
+    // The deferred COMMIT must not be lost with the connection, but the connection is closed anyway
+    if (connected && !pendingTransactionEnd.empty()) {
+      try {
+        flushTransactionEnd();
+      }
+      catch (SQLException& e) {
+        transactionEndError.reset(new SQLException(e));
+      }
+    }
     this->explicitClosed= true;
+    standby.reset();
     close();
+    if (transactionEndError) {
+      throw *transactionEndError;
+    }
   }
 
 
-  void QueryProtocol::releasePrepareStatement(ServerPrepareResult* serverPrepareResult)
+  /**
+   * Gives back the prepare, that the statement has used.
+   *
+   * @param serverPrepareResult the prepare
+   * @return true if the prepare has been deallocated, and the caller has to delete it. Otherwise it stays in the
+   *     prepared statements cache, that owns it then
+   */
+  bool QueryProtocol::releasePrepareStatement(ServerPrepareResult* serverPrepareResult)
   {
-    // If prepared cache is enabled, the ServerPrepareResult can be shared in many PrepStatement,
-    // so synchronised use count indicator will be decrement.
     serverPrepareResult->decrementShareCounter();
 
     // deallocate from server if not cached
     if (serverPrepareResult->canBeDeallocate()){
-      forceReleasePrepareStatement(serverPrepareResult->getStatementId());
+      forceReleasePrepareStatement(serverPrepareResult->detachStatementId());
+      return true;
     }
+    return false;
   }
 
 
@@ -1352,16 +2748,10 @@ namespace capi
   }
 
 
+  /* The session is changed only when the next query is sent, see realQueryWithSessionChanges and applySessionChanges */
   void QueryProtocol::setMaxRows(int64_t max)
   {
-    if (maxRows != max){
-      if (max == 0){
-        executeQuery("set @@SQL_SELECT_LIMIT=DEFAULT");
-      }else {
-        executeQuery("set @@SQL_SELECT_LIMIT=" + std::to_string(max));
-      }
-      maxRows= max;
-    }
+    maxRows= max;
   }
 
 
@@ -1379,7 +2769,7 @@ namespace capi
 
   void QueryProtocol::setTimeout(int32_t timeout)
   {
-    std::lock_guard<std::mutex> localScopeLock(*lock);
+    std::lock_guard<ConnectionMutex> localScopeLock(*lock);
 
     this->changeSocketSoTimeout(timeout);
   }
@@ -1392,36 +2782,24 @@ namespace capi
    */
   void QueryProtocol::setTransactionIsolation(int32_t level)
   {
+    // Unsupported level is reported right away
+    isolationQuery(level);
     cmdPrologue();
-    std::lock_guard<std::mutex> localScopeLock(*lock);
-
-    SQLString query= "SET SESSION TRANSACTION ISOLATION LEVEL";
+    std::lock_guard<ConnectionMutex> localScopeLock(*lock);
 
-    switch (level){
-      case sql::TRANSACTION_READ_UNCOMMITTED:
-        query.append(" READ UNCOMMITTED");
-        break;
-      case sql::TRANSACTION_READ_COMMITTED:
-        query.append(" READ COMMITTED");
-        break;
-      case sql::TRANSACTION_REPEATABLE_READ:
-        query.append(" REPEATABLE READ");
-        break;
-      case sql::TRANSACTION_SERIALIZABLE:
-        query.append(" SERIALIZABLE");
-        break;
-      default:
-        throw SQLException("Unsupported transaction isolation level");
+    // Without tracking, the level may have been changed by the application's queries
+    if (isolationTracked && level == transactionIsolationLevel) {
+      pendingIsolationLevel= 0;
+    }
+    else {
+      pendingIsolationLevel= level;
     }
-
-    executeQuery(query);
-    transactionIsolationLevel= level;
   }
 
 
   int32_t QueryProtocol::getTransactionIsolationLevel()
   {
-    return transactionIsolationLevel;
+    return pendingIsolationLevel != 0 ? pendingIsolationLevel : transactionIsolationLevel;
   }
 
 
@@ -1450,6 +2828,7 @@ namespace capi
 
   void QueryProtocol::getResult(Results* results, ServerPrepareResult *pr, bool readAllResults)
   {
+    MetricsTimer decode(metrics.decodeTime);
     readPacket(results, pr);
 
     if (readAllResults) {
@@ -1473,6 +2852,9 @@ namespace capi
     switch (errorOccurred(pr))
     {
       case 0:
+        if (options->validMinDelay > 0) {
+          lastResponse= std::chrono::steady_clock::now();
+        }
         if (fieldCount(pr) == 0)
         {
           readOkPacket(results, pr);
@@ -1511,6 +2893,58 @@ namespace capi
   }
 
 
+  /**
+   * Reads result of the bulk command, if that is the result set with affected rows and insert id of each parameter
+   * set, that the server sends when bulk unit results capability is negotiated. Each row is added to results as
+   * a separate update count, so the batch gets update count and generated key of each parameter set.
+   *
+   * @param results result object
+   * @param pr prepare result of the executed statement
+   * @return true, if unit results have been read, false if the bulk command returned something else
+   */
+  bool QueryProtocol::readBulkUnitResults(Results* results, ServerPrepareResult *pr)
+  {
+    capi::MYSQL_STMT* stmt= pr->getStatementId();
+
+    if (!bulkUnitResults || capi::mysql_stmt_errno(stmt) != 0 || capi::mysql_stmt_field_count(stmt) != 2) {
+      return false;
+    }
+    // It can also be the result of RETURNING clause, that happens to have 2 columns
+    std::unique_ptr<capi::MYSQL_RES, decltype(&capi::mysql_free_result)> metadata(capi::mysql_stmt_result_metadata(stmt),
+      &capi::mysql_free_result);
+    if (!metadata
+      || std::strcmp(capi::mysql_fetch_field_direct(metadata.get(), 0)->name, "Id") != 0
+      || std::strcmp(capi::mysql_fetch_field_direct(metadata.get(), 1)->name, "Affected_rows") != 0) {
+      return false;
+    }
+
+    int64_t insertId= 0, updateCount= 0;
+    capi::MYSQL_BIND bind[2];
+
+    std::memset(bind, 0, sizeof(bind));
+    bind[0].buffer_type= capi::MYSQL_TYPE_LONGLONG;
+    bind[0].buffer= &insertId;
+    bind[1].buffer_type= capi::MYSQL_TYPE_LONGLONG;
+    bind[1].buffer= &updateCount;
+
+    capi::mysql_stmt_bind_result(stmt, bind);
+
+    int rc;
+    while ((rc= capi::mysql_stmt_fetch(stmt)) == 0 || rc == MYSQL_DATA_TRUNCATED) {
+      results->addStats(updateCount, insertId, false);
+    }
+    if (rc != MYSQL_NO_DATA) {
+      throwStmtError(stmt);
+    }
+    capi::mysql_stmt_free_result(stmt);
+
+    capi::mariadb_get_infov(connection.get(), MARIADB_CONNECTION_SERVER_STATUS, (void*)&this->serverStatus);
+    hasWarningsFlag= capi::mysql_warning_count(connection.get()) > 0;
+
+    return true;
+  }
+
+
   void QueryProtocol::handleStateChange(Results* results)
   {
     const char *value;
@@ -1524,10 +2958,31 @@ namespace capi
 
         switch (type) {
         case StateChange::SESSION_TRACK_SYSTEM_VARIABLES:
-          if (str.compare("auto_increment_increment") == 0)
+          // Variables are reported as pairs of name and value
+          while (mysql_session_track_get_next(connection.get(), static_cast<enum capi::enum_session_state_type>(type),
+            &value, &len) == 0)
           {
-            autoIncrementIncrement= std::stoi(str);
-            results->setAutoIncrement(autoIncrementIncrement);
+            std::string varValue(value, len);
+
+            if (str.compare("auto_increment_increment") == 0)
+            {
+              autoIncrementIncrement= std::stoi(varValue);
+              results->setAutoIncrement(autoIncrementIncrement);
+            }
+            else if (str.compare("tx_isolation") == 0 || str.compare("transaction_isolation") == 0)
+            {
+              transactionIsolationLevel= Utils::transactionFromString(varValue);
+            }
+            else if (str.compare("last_gtid") == 0 && !varValue.empty())
+            {
+              lastGtid= varValue;
+            }
+            if (mysql_session_track_get_next(connection.get(), static_cast<enum capi::enum_session_state_type>(type),
+              &value, &len) != 0)
+            {
+              break;
+            }
+            str.assign(value, len);
           }
           break;
 
@@ -1575,7 +3030,7 @@ namespace capi
   int32_t QueryProtocol::getAutoIncrementIncrement()
   {
     if (autoIncrementIncrement == 0) {
-      std::lock_guard<std::mutex> localScopeLock(*lock);
+      std::lock_guard<ConnectionMutex> localScopeLock(*lock);
       try {
         Shared::Results results(new Results());
         executeQuery(true, results,"select @@auto_increment_increment");
@@ -1743,12 +3198,18 @@ namespace capi
    */
   void QueryProtocol::readResultSet(Results* results, ServerPrepareResult *pr)
   {
+    if (pr == nullptr && results->isScalarOnly()) {
+      readScalar(results);
+      return;
+    }
     try {
 
       SelectResultSet* selectResultSet;
 
       capi::mariadb_get_infov(connection.get(), MARIADB_CONNECTION_SERVER_STATUS, (void*)&this->serverStatus);
       bool callableResult= (serverStatus & ServerStatus::PS_OUT_PARAMETERS)!=0;
+      // Rows of the server cursor are not in the wire, and do not block the connection
+      bool cursorExists= pr != nullptr && (serverStatus & ServerStatus::CURSOR_EXISTS) != 0;
 
       if (pr == nullptr)
       {
@@ -1766,9 +3227,10 @@ namespace capi
         }
       }
       // Not sure where we get status and more results there is and if it's available if we are streaming result
-      bool pendingResults= hasMoreResults() || results->getFetchSize() > 0;
+      // Result without fetch size may be read incrementally as well(incrementalFetchSize)
+      bool pendingResults= hasMoreResults() || results->getFetchSize() > 0 || !selectResultSet->isFullyLoaded();
       results->addResultSet(selectResultSet, pendingResults);
-      if (pendingResults) {
+      if (pendingResults && !cursorExists) {
         setActiveStreamingResult(results);
       }
 
@@ -1782,6 +3244,45 @@ namespace capi
   }
 
 
+  /**
+   * Reads only the first value of the text result set, without creating the result set. The rest of the rows, and
+   * the rest of the results are skipped.
+   *
+   * @param results result object
+   */
+  void QueryProtocol::readScalar(Results* results)
+  {
+    capi::MYSQL_RES* res= capi::mysql_use_result(connection.get());
+
+    if (res == nullptr) {
+      throw SQLException(capi::mysql_error(connection.get()), capi::mysql_sqlstate(connection.get()),
+        capi::mysql_errno(connection.get()));
+    }
+    capi::MYSQL_ROW row= capi::mysql_fetch_row(res);
+    const char* value= nullptr;
+    std::size_t length= 0;
+
+    if (row != nullptr) {
+      value= row[0];
+      length= value != nullptr ? capi::mysql_fetch_lengths(res)[0] : 0;
+    }
+    // The value has to be taken before the result is freed
+    results->addScalar(value, length);
+    // Reads off the remaining rows
+    capi::mysql_free_result(res);
+    if (capi::mysql_errno(connection.get()) != 0) {
+      throw SQLException(capi::mysql_error(connection.get()), capi::mysql_sqlstate(connection.get()),
+        capi::mysql_errno(connection.get()));
+    }
+    capi::mariadb_get_infov(connection.get(), MARIADB_CONNECTION_SERVER_STATUS, (void*)&this->serverStatus);
+    hasWarningsFlag= capi::mysql_warning_count(connection.get()) > 0;
+    if ((serverStatus & ServerStatus::SERVER_SESSION_STATE_CHANGED_) != 0) {
+      handleStateChange(results);
+    }
+    skipAllResults();
+  }
+
+
   void QueryProtocol::prologProxy(
       ServerPrepareResult* /*serverPrepareResult*/,
       int64_t maxRows,
@@ -1810,28 +3311,27 @@ namespace capi
     if (!hasProxy && shouldReconnectWithoutProxy()) {
       try {
         connectWithoutProxy();
+        MetricsRecorder::increment(metrics.reconnects);
       } catch (SQLException& qe) {
         exceptionFactory.reset(ExceptionFactory::of(serverThreadId, options));
         exceptionFactory->create(qe).Throw();
       }
     }
 
-    try {
-      setMaxRows(maxRows);
-    }catch (SQLException& qe){
-      exceptionFactory->create(qe).Throw();
-    }
-
+    setMaxRows(maxRows);
     connection->reenableWarnings();
   }
 
-  ServerPrepareResult* QueryProtocol::addPrepareInCache(const SQLString& key, ServerPrepareResult* serverPrepareResult)
+  bool QueryProtocol::addPrepareInCache(const SQLString& key, ServerPrepareResult* serverPrepareResult)
   {
     return serverPrepareStatementCache->put(key, serverPrepareResult);
   }
 
   void QueryProtocol::cmdPrologue()
   {
+    if (asyncPending) {
+      throw SQLException("Connection is busy with the asynchronous query execution", "HY000");
+    }
     auto activeStream= getActiveStreamingResult();
     if (activeStream) {
       activeStream->loadFully(false, this);
@@ -1862,6 +3362,7 @@ namespace capi
     if (!this->connected){
       throw SQLException("Connection* is closed", "08000", 1220);
     }
+    forceReleaseWaitingPrepareStatement();
     interrupted= false;
   }
 
@@ -1879,9 +3380,7 @@ namespace capi
       setCatalog(database);
     }
 
-    if (getAutocommit()!=autocommit){
-      executeQuery(SQLString("set autocommit=").append(autocommit ?"1":"0"));
-    }
+    setAutocommit(autocommit);
   }
 
   /**
@@ -2018,6 +3517,148 @@ namespace capi
   }
 
 
+  /**
+   * Reconnects after the connection has been lost, so that the statement being executed may be retried. If the url
+   * has other hosts, the failed one is blacklisted, and they are tried first. The session state is restored the same
+   * way as after reconnect on IO error, and statements from the prepared statements cache are prepared again on the new
+   * connection.
+   *
+   * @return true if the new connection is established and its state is restored
+   */
+  bool QueryProtocol::failover()
+  {
+    // The outcome of the deferred COMMIT or ROLLBACK is not known, and the application has to be told the connection
+    // is lost rather than to continue on the new one
+    if (explicitClosed || !pendingTransactionEnd.empty()) {
+      return false;
+    }
+    int64_t lastMaxRows= maxRows;
+    int32_t lastIsolationLevel= getTransactionIsolationLevel();
+    SQLString lastDatabase(getDatabase());
+    bool lastAutocommit= getAutocommit();
+    std::vector<SQLString> cachedQueries;
+
+    // Cached statements belong to the lost connection
+    if (options->cachePrepStmts && options->useServerPrepStmts && serverPrepareStatementCache) {
+      cachedQueries= serverPrepareStatementCache->keys();
+      serverPrepareStatementCache->clear();
+    }
+    if (urlParser->getHostAddresses().size() > 1) {
+      HostHealthRegistry::getInstance().addToBlacklist(getHostAddress(), getUsername(), urlParser->getPassword(),
+        options->loadBalanceBlacklistTimeout);
+    }
+
+    try {
+      std::unique_ptr<MasterProtocol> spare(standby ? standby->take() : nullptr);
+      if (spare && adoptConnection(*spare)) {
+        standby.reset(new StandbyConnection(urlParser, getHostAddress()));
+      }
+      else {
+        connectWithoutProxy();
+      }
+      MetricsRecorder::increment(metrics.reconnects);
+      // New session has default select limit, and the state is restored with the requested changes
+      sessionMaxRows= 0;
+      clearSessionChanges();
+      resetStateAfterFailover(lastMaxRows, lastIsolationLevel, lastDatabase, lastAutocommit);
+    }
+    catch (SQLException&) {
+      connected= false;
+      return false;
+    }
+
+    prepareCachedQueries(cachedQueries, cachedQueries.size());
+    return true;
+  }
+
+
+  /**
+   * Connects to the first of the url hosts, that is reachable. With failoverStandby the standby connection to another
+   * host is started in the background then.
+   */
+  void QueryProtocol::connectWithoutProxy()
+  {
+    standby.reset();
+    super::connectWithoutProxy();
+
+    if (options->failoverStandby && urlParser->getHaMode() == HaMode::NONE
+        && urlParser->getHostAddresses().size() > 1) {
+      standby.reset(new StandbyConnection(urlParser, getHostAddress()));
+    }
+  }
+
+
+  /**
+   * Frees the memory the connection keeps for the next commands. The cached prepared statements are closed, since
+   * each of them holds the C API handle, and the server's memory.
+   */
+  void QueryProtocol::trimMemory()
+  {
+    std::lock_guard<ConnectionMutex> localScopeLock(*lock);
+
+    if (serverPrepareStatementCache != nullptr) {
+      serverPrepareStatementCache->clear();
+    }
+    if (connected && !asyncPending) {
+      try {
+        forceReleaseWaitingPrepareStatement();
+      }
+      catch (SQLException&) {
+        // Connection is gone, the pool will find it out on validation
+      }
+    }
+    MemoryAccounting::get(MemoryAccounting::CONNECTION_BUFFERS).release(bufferBytes(queryBuffer));
+    std::string().swap(StringImp::get(queryBuffer));
+    if (!asyncPending) {
+      std::string().swap(StringImp::get(asyncQuery));
+    }
+    if (statementsToRelease.empty()) {
+      std::vector<MYSQL_STMT*>().swap(statementsToRelease);
+    }
+  }
+
+
+  /* The options may be shared by the connections of the pool - each of them is accounted for its share */
+  std::size_t QueryProtocol::getMemoryFootprint()
+  {
+    std::lock_guard<ConnectionMutex> localScopeLock(*lock);
+    std::size_t footprint= sizeof(*this) + StringImp::get(queryBuffer).capacity() + StringImp::get(asyncQuery).capacity()
+      + statementsToRelease.capacity()*sizeof(MYSQL_STMT*) + sizeof(Options)/std::max<long>(options.use_count(), 1);
+
+    if (serverPrepareStatementCache != nullptr) {
+      footprint+= serverPrepareStatementCache->size()*sizeof(ServerPrepareResult);
+    }
+    return footprint;
+  }
+
+
+  void QueryProtocol::prepareCachedQueries(const std::vector<SQLString>& keys, std::size_t maxCount)
+  {
+    SQLString prefix(database + "-");
+    std::size_t prepared= 0;
+
+    for (auto& key : keys) {
+      if (prepared >= maxCount) {
+        break;
+      }
+      if (!key.startsWith(prefix)) {
+        continue;
+      }
+      try {
+        ServerPrepareResult* serverPrepareResult= prepareInternal(key.substr(prefix.length()), true);
+        // Only the cache holds it
+        if (releasePrepareStatement(serverPrepareResult)) {
+          delete serverPrepareResult;
+        }
+        ++prepared;
+      }
+      catch (SQLException&) {
+        // It will be prepared if the application uses it again
+      }
+    }
+  }
+
+
   void QueryProtocol::setActiveFutureTask(FutureTask* activeFutureTask)
   {
     this->activeFutureTask= activeFutureTask;
@@ -21,12 +21,14 @@
 #ifndef _ABSTRACTQUERYPROTOCOL_H_
 #define _ABSTRACTQUERYPROTOCOL_H_
 
+#include <functional>
 #include <istream>
 #include <vector>
 
 #include "Consts.h"
 
 #include "protocol/capi/ConnectProtocol.h"
+#include "util/BatchWindow.h"
 #include "Exception.hpp"
 
 namespace sql
@@ -37,8 +39,23 @@ namespace mariadb
   class ServerPrepareResult;
   class FutureTask;
   class LogQueryTool;
+  class StandbyConnection;
 namespace capi
 {
+  /* Builds query text from client side prepared statement parts and parameters values */
+  void assemblePreparedQueryForExec(
+    SQLString& out,
+    ClientPrepareResult* clientPrepareResult,
+    std::vector<Shared::ParameterHolder>& parameters,
+    int32_t queryTimeout);
+  /* The same with the values of PreparedStatement::executeWith, one per parameter */
+  void assemblePreparedQueryForExec(
+    SQLString& out,
+    ClientPrepareResult* clientPrepareResult,
+    const ParameterValue* values,
+    bool noBackslashEscapes,
+    int32_t queryTimeout);
+
   class QueryProtocol : public ConnectProtocol
   {
     typedef capi::ConnectProtocol super;
@@ -47,24 +64,39 @@ namespace capi
     static const SQLString CHECK_GALERA_STATE_QUERY; /*"show status like 'wsrep_local_state'"*/
     std::unique_ptr<LogQueryTool> logQuery;
     Tokens galeraAllowedStates;
-    //ThreadPoolExecutor readScheduler; /*NULL*/
-    int32_t transactionIsolationLevel= 0;
     std::unique_ptr<std::istream> localInfileInputStream;
-    int64_t maxRows= 0;
-    /*volatile*/
-    MYSQL_STMT* statementIdToRelease= nullptr;
+    // Released statements handles. They are closed right before the next command, since COM_STMT_CLOSE has no reply
+    std::vector<MYSQL_STMT*> statementsToRelease;
     FutureTask* activeFutureTask= nullptr;
     bool interrupted= false;
+    // Non-blocking mode of the connection is turned on by the first async query
+    bool nonBlocking= false;
+    bool asyncPending= false;
+    SQLString asyncQuery;
+    // Client side prepared queries are assembled here, to reuse the memory between executions
+    SQLString queryBuffer;
+    // In-flight window of multi-send batches, if adaptiveBatchWindow is set
+    BatchWindow batchWindow;
+    // Connection to another host, that failover takes over, if failoverStandby is set
+    std::unique_ptr<StandbyConnection> standby;
+
+    int32_t asyncQueryStatus(int32_t status, int32_t error);
 
   protected:
     QueryProtocol(std::shared_ptr<UrlParser>& urlParser, GlobalStateInfo* globalInfo, Shared::mutex& lock);
-    virtual ~QueryProtocol() {}
+    virtual ~QueryProtocol();
 
   public:
     void reset();
+    void changeUser(const SQLString& user, const SQLString& password, const SQLString& database);
     void executeQuery(const SQLString& sql);
     void executeQuery(bool mustExecuteOnMaster, Shared::Results& results, const SQLString& sql);
     void executeQuery(bool mustExecuteOnMaster, Shared::Results& results, const SQLString& sql, const Charset* charset);
+    void executePipeline(std::vector<Shared::Results>& results, const std::vector<SQLString>& queries);
+    int32_t executeQueryAsyncStart(const SQLString& sql);
+    int32_t executeQueryAsyncContinue(int32_t readyEvents);
+    int64_t getNativeSocket();
+    uint32_t getAsyncTimeout();
 
     void executeQuery(
       bool mustExecuteOnMaster,
@@ -72,18 +104,32 @@ namespace capi
       ClientPrepareResult* clientPrepareResult,
       std::vector<Shared::ParameterHolder>& parameters);
 
-    /*void assemblePreparedQueryForExec(
-      SQLString& out,
+    void executeQuery(
+      bool mustExecuteOnMaster,
+      Shared::Results& results,
       ClientPrepareResult* clientPrepareResult,
       std::vector<Shared::ParameterHolder>& parameters,
-      int32_t queryTimeout);*/
+      int32_t queryTimeout);
 
-    void executeQuery(
+    bool tryExecuteQuery(bool mustExecuteOnMaster, Shared::Results& results, const SQLString& sql, ErrorInfo& error);
+    bool tryExecuteQuery(
       bool mustExecuteOnMaster,
       Shared::Results& results,
       ClientPrepareResult* clientPrepareResult,
       std::vector<Shared::ParameterHolder>& parameters,
-      int32_t queryTimeout);
+      int32_t queryTimeout,
+      ErrorInfo& error);
+
+  private:
+    void assembleQuery(SQLString& sql, ClientPrepareResult* clientPrepareResult, std::vector<Shared::ParameterHolder>& parameters);
+    int32_t stmtExecute(MYSQL_STMT* stmt);
+    int32_t sendPreparedQuery(ServerPrepareResult* serverPrepareResult, Results* results,
+      std::vector<Shared::ParameterHolder>& parameters);
+    void sendLongData(MYSQL_STMT* stmt, uint32_t index, ParameterHolder& parameter, std::vector<sql::bytes>& buffers,
+      bool direct);
+    void sendLongDataDirect(MYSQL_STMT* stmt, uint32_t index, const char* data, std::size_t length);
+
+  public:
 
     bool executeBatchClient(
       bool mustExecuteOnMaster,
@@ -98,7 +144,13 @@ namespace capi
       Shared::Results& results, const SQLString& sql,
       ServerPrepareResult* serverPrepareResult,
       std::vector<std::vector<Shared::ParameterHolder>>& parametersList);
-    void initializeBatchReader();
+    void executeBulkRows(Results* results, ServerPrepareResult* serverPrepareResult,
+      std::vector<std::vector<Shared::ParameterHolder>>& rows, const int16_t* types);
+    void executeBulkIsolated(Results* results, ServerPrepareResult* serverPrepareResult,
+      std::vector<std::vector<Shared::ParameterHolder>>& rows, const int16_t* types, SQLException& firstError);
+    std::size_t initializeBatchReader();
+    void sendBatchQuery(const SQLString& sql);
+    void readBatchResult(Results* results, bool& autoCommitPending);
 
     void executeBatchMulti(
       Shared::Results& results,
@@ -113,6 +165,7 @@ namespace capi
 
   public:
     void executeBatchStmt(bool mustExecuteOnMaster, Shared::Results& results, const std::vector<SQLString>& queries);
+    void executeBatchEncoded(Shared::Results& results, ClientPrepareResult* prepareResult, const EncodedBatch& batch);
 
   private:
     void executeBatch(Shared::Results& results, const std::vector<SQLString>& queries);
@@ -129,6 +182,13 @@ namespace capi
       ClientPrepareResult* prepareResult,
       std::vector<std::vector<Shared::ParameterHolder>>& parameterList,
       bool rewriteValues);
+    void sendRewrittenChunks(
+      Shared::Results& results,
+      ClientPrepareResult* prepareResult,
+      std::size_t totalRows,
+      bool rewriteValues,
+      const std::function<std::size_t(SQLString&, std::size_t, DirectCommand*)>& buildChunk);
+    void setCursorType(ServerPrepareResult* serverPrepareResult, Results* results);
 
   public:
 
@@ -139,11 +199,37 @@ namespace capi
       std::vector<std::vector<Shared::ParameterHolder>>& parametersList,
       bool hasLongData);
 
+    void executeBatchArrays(
+      ServerPrepareResult* serverPrepareResult,
+      Shared::Results& results,
+      const std::vector<ParameterArray>& arrays,
+      uint32_t rows);
+    int64_t executeBulkLoad(
+      const SQLString& table,
+      const SQLString* columns,
+      std::size_t columnCount,
+      RowProducer& producer);
+
     void executePreparedQuery(
       bool mustExecuteOnMaster,
       ServerPrepareResult* serverPrepareResult,
       Shared::Results& results,
       std::vector<Shared::ParameterHolder>& parameters);
+    void executePreparedQuery(
+      bool mustExecuteOnMaster,
+      ServerPrepareResult* serverPrepareResult,
+      Shared::Results& results,
+      const ParameterValue* values);
+    bool tryExecutePreparedQuery(
+      bool mustExecuteOnMaster,
+      ServerPrepareResult* serverPrepareResult,
+      Shared::Results& results,
+      std::vector<Shared::ParameterHolder>& parameters,
+      ErrorInfo& error);
+    ServerPrepareResult* prepareAndExecute(
+      const SQLString& sql,
+      Shared::Results& results,
+      std::vector<Shared::ParameterHolder>& parameters);
     void rollback();
     bool forceReleasePrepareStatement(capi::MYSQL_STMT* statementId);
     void forceReleaseWaitingPrepareStatement();
@@ -152,12 +238,18 @@ namespace capi
     SQLString getCatalog();
     void setCatalog(const SQLString& database);
     void resetDatabase();
+    void resetSessionState(bool autocommit, int32_t transactionIsolationLevel, bool resetDatabase);
     void cancelCurrentQuery();
     bool getAutocommit();
+    void setAutocommit(bool autocommit);
     bool inTransaction();
     void closeExplicit();
+    void deferTransactionEnd(bool commit);
+    void flushTransactionEnd();
+    void deferSavepoint(const SQLString& name, bool release);
+    bool rollbackDeferredSavepoint(const SQLString& name);
 
-    void releasePrepareStatement(ServerPrepareResult* serverPrepareResult);
+    bool releasePrepareStatement(ServerPrepareResult* serverPrepareResult);
     int64_t getMaxRows();
     void setMaxRows(int64_t max);
     void setLocalInfileInputStream(std::istream& inputStream);
@@ -168,6 +260,7 @@ namespace capi
 
   private:
     void checkClose();
+    std::size_t findDeferredSavepoint(const SQLString& name) const;
 
   public:
     void moveToNextResult(Results* results, ServerPrepareResult* spr);
@@ -176,6 +269,8 @@ namespace capi
   private:
     void readPacket(Results* results, ServerPrepareResult *pr);
     void readOkPacket(Results* results, ServerPrepareResult *pr);
+    bool readBulkUnitResults(Results* results, ServerPrepareResult *pr);
+    std::size_t getMaxQueryLength() const;
     void handleStateChange(Results* results);
     uint32_t errorOccurred(ServerPrepareResult *pr);
     uint32_t fieldCount(ServerPrepareResult *pr);
@@ -187,6 +282,7 @@ namespace capi
     SQLException readErrorPacket(Results* results, ServerPrepareResult *pr= nullptr);
     void readLocalInfilePacket(Shared::Results& results);
     void readResultSet(Results* results, ServerPrepareResult *pr);
+    void readScalar(Results* results);
 
   public:
 
@@ -197,7 +293,7 @@ namespace capi
       MariaDbConnection* connection,
       MariaDbStatement* statement);
     void prolog(int64_t maxRows, bool hasProxy, MariaDbConnection* connection, MariaDbStatement* statement);
-    ServerPrepareResult* addPrepareInCache(const SQLString& key, ServerPrepareResult* serverPrepareResult);
+    bool addPrepareInCache(const SQLString& key, ServerPrepareResult* serverPrepareResult);
 
   private:
     void cmdPrologue();
@@ -205,6 +301,13 @@ namespace capi
   public:
     void resetStateAfterFailover(int64_t maxRows, int32_t transactionIsolationLevel, const SQLString& database, bool autocommit);
     MariaDBExceptionThrower handleIoException(std::runtime_error& initialException, bool throwRightAway=true);
+    bool failover();
+    void connectWithoutProxy();
+    void prepareCachedQueries(const std::vector<SQLString>& keys, std::size_t maxCount);
+    void trimMemory();
+    std::size_t getMemoryFootprint();
+    std::size_t getBatchWindow();
+    bool waitForGtid(const SQLString& gtid, int32_t timeout);
     void setActiveFutureTask(FutureTask* activeFutureTask);
     void interrupt();
     bool isInterrupted();
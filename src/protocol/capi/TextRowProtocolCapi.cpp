@@ -25,6 +25,8 @@
 #include "ExceptionFactory.h"
 #include "ColumnType.h"
 #include "ColumnDefinition.h"
+#include "util/DateTimeCodec.h"
+#include "util/DecimalCodec.h"
 
 namespace sql
 {
@@ -58,7 +60,10 @@ namespace capi
 
    pos= 0;
 
-   if (buf != nullptr) {
+   if (arena != nullptr) {
+     setArenaPosition();
+   }
+   else if (buf != nullptr) {
      fieldBuf.wrap((*buf)[index], (*buf)[index].size());
      this->lastValueNull= fieldBuf ? BIT_LAST_FIELD_NOT_NULL : BIT_LAST_FIELD_NULL;
      length= static_cast<uint32_t>(fieldBuf.size());
@@ -157,6 +162,29 @@ namespace capi
  }
 
 
+ bool TextRowProtocolCapi::isRawStringValue(ColumnDefinition* columnInfo)
+ {
+   switch (columnInfo->getColumnType().getType()) {
+   case MYSQL_TYPE_DOUBLE:
+   case MYSQL_TYPE_FLOAT:
+     return !columnInfo->isZeroFill();
+   case MYSQL_TYPE_YEAR:
+     return !options->yearIsDateType;
+   case MYSQL_TYPE_BIT:
+   case MYSQL_TYPE_TIME:
+   case MYSQL_TYPE_DATE:
+   case MYSQL_TYPE_TIMESTAMP:
+   case MYSQL_TYPE_DATETIME:
+   case MYSQL_TYPE_NEWDECIMAL:
+   case MYSQL_TYPE_DECIMAL:
+   case MYSQL_TYPE_NULL:
+     return false;
+   default:
+     return true;
+   }
+ }
+
+
  Date TextRowProtocolCapi::getInternalDate(ColumnDefinition* columnInfo, Calendar* cal, TimeZone* timeZone)
  {
    if (lastValueWasNull()) {
@@ -166,11 +194,22 @@ namespace capi
    switch (columnInfo->getColumnType().getType()) {
    case MYSQL_TYPE_DATE:
    {
-     std::vector<int32_t> datePart{ 0, 0, 0 };
+     DateTime value;
+     uint32_t fractionDigits;
+
+     if (DateTimeCodec::parseDateTime(fieldBuf.arr + pos, length, value, fractionDigits)) {
+       if (DateTimeCodec::isZero(value)) {
+         lastValueNull|= BIT_LAST_ZERO_DATE;
+         return nullDate;
+       }
+       return Date(fieldBuf.arr + pos, length);
+     }
+
+     int32_t datePart[]{ 0, 0, 0 };
      int32_t partIdx= 0;
      for (uint32_t begin= pos; begin < pos + length; begin++) {
        int8_t b= fieldBuf[begin];
-       if (b == '-') {
+       if (b == '-' && partIdx < 2) {
          partIdx++;
          continue;
        }
@@ -242,9 +281,8 @@ namespace capi
  */
  std::unique_ptr<Time> TextRowProtocolCapi::getInternalTime(ColumnDefinition* columnInfo, Calendar* cal, TimeZone* timeZone)
  {
-   std::unique_ptr<Time> nullTime(new Time("00:00:00"));
    if (lastValueWasNull()) {
-     return nullTime;
+     return std::unique_ptr<Time>(new Time("00:00:00"));
    }
 
    if (columnInfo->getColumnType()==ColumnType::TIMESTAMP
@@ -252,7 +290,7 @@ namespace capi
 
      std::unique_ptr<Timestamp> timestamp= getInternalTimestamp(columnInfo, cal, timeZone);
      if (!timestamp) {
-       return nullTime;
+       return std::unique_ptr<Time>(new Time("00:00:00"));
      }
      else {
        return std::unique_ptr<Time>(new Time(timestamp->substr(11)));
@@ -264,6 +302,13 @@ namespace capi
 
    }
    else {
+     DateTime value;
+     uint32_t fractionDigits;
+
+     if (DateTimeCodec::parseTime(fieldBuf.arr + pos, length, value, fractionDigits)) {
+       return std::unique_ptr<Time>(new Time(fieldBuf.arr + pos, length));
+     }
+
      SQLString raw(fieldBuf.arr + pos, length);
      std::vector<std::string> matcher;
 
@@ -306,9 +351,8 @@ namespace capi
  */
  std::unique_ptr<Timestamp> TextRowProtocolCapi::getInternalTimestamp(ColumnDefinition* columnInfo, Calendar* userCalendar, TimeZone* timeZone)
  {
-   std::unique_ptr<Timestamp> nullTs(new Timestamp("0000-00-00 00:00:00"));
    if (lastValueWasNull()) {
-     return nullTs;
+     return std::unique_ptr<Timestamp>(new Timestamp("0000-00-00 00:00:00"));
    }
 
    switch (columnInfo->getColumnType().getType()) {
@@ -319,6 +363,19 @@ namespace capi
    case MYSQL_TYPE_VAR_STRING:
    case MYSQL_TYPE_STRING:
    {
+     DateTime value;
+     uint32_t fractionDigits;
+
+     // Values in the server's format are parsed and formatted without intermediate strings
+     if (DateTimeCodec::parseDateTime(fieldBuf.arr + pos, length, value, fractionDigits)) {
+       if (DateTimeCodec::isZero(value)) {
+         lastValueNull|= BIT_LAST_ZERO_DATE;
+         return std::unique_ptr<Timestamp>(new Timestamp("0000-00-00 00:00:00"));
+       }
+       char buffer[DateTimeCodec::MAX_LENGTH];
+       return std::unique_ptr<Timestamp>(new Timestamp(buffer, DateTimeCodec::formatDateTime(value, fractionDigits, buffer)));
+     }
+
      const std::size_t nanosIdx= 6;
      int32_t nanoBegin= -1;
      std::string nanosStr("");
@@ -358,7 +415,7 @@ namespace capi
        && timestampsPart[6] == 0)
      {
        lastValueNull|= BIT_LAST_ZERO_DATE;
-       return nullTs;
+       return std::unique_ptr<Timestamp>(new Timestamp("0000-00-00 00:00:00"));
      }
 
      // fix non leading tray for nanoseconds
@@ -407,6 +464,85 @@ namespace capi
    }
  }
 
+
+ bool TextRowProtocolCapi::getInternalDateTime(ColumnDefinition* columnInfo, DateTime& value)
+ {
+   uint32_t fractionDigits;
+   bool isTime= false;
+
+   value= DateTime();
+   if (lastValueWasNull()) {
+     return false;
+   }
+
+   switch (columnInfo->getColumnType().getType()) {
+   case MYSQL_TYPE_TIME:
+     if (!DateTimeCodec::parseTime(fieldBuf.arr + pos, length, value, fractionDigits)) {
+       throw SQLException("Time format \"" + SQLString(fieldBuf.arr + pos, length) + "\" incorrect, must be [-]HH+:[0-59]:[0-59]");
+     }
+     return true;
+   case MYSQL_TYPE_YEAR:
+   {
+     int32_t year= getInternalInt(columnInfo);
+     if (length == 2 && columnInfo->getLength() == 2) {
+       year+= year < 70 ? 2000 : 1900;
+     }
+     value.year= static_cast<uint32_t>(year);
+     value.month= 1;
+     value.day= 1;
+     return true;
+   }
+   case MYSQL_TYPE_TIMESTAMP:
+   case MYSQL_TYPE_DATETIME:
+   case MYSQL_TYPE_DATE:
+   case MYSQL_TYPE_VARCHAR:
+   case MYSQL_TYPE_VAR_STRING:
+   case MYSQL_TYPE_STRING:
+     if (DateTimeCodec::parseDateTime(fieldBuf.arr + pos, length, value, fractionDigits)) {
+       break;
+     }
+     if (DateTimeCodec::parseTime(fieldBuf.arr + pos, length, value, fractionDigits)) {
+       isTime= true;
+       break;
+     }
+     {
+       // Not in the server's format - the general parsing gives the canonical string
+       std::unique_ptr<Timestamp> timestamp= getInternalTimestamp(columnInfo);
+       if ((lastValueNull & BIT_LAST_ZERO_DATE) != 0) {
+         return false;
+       }
+       if (!DateTimeCodec::parseDateTime(timestamp->c_str(), timestamp->length(), value, fractionDigits)) {
+         throw SQLException("cannot parse data in timestamp string '" + SQLString(fieldBuf.arr + pos, length) + "'");
+       }
+     }
+     break;
+   default:
+     throw SQLException("getDateTime not available for data field type " + columnInfo->getColumnType().getCppTypeName());
+   }
+
+   if (!isTime && DateTimeCodec::isZero(value)) {
+     lastValueNull|= BIT_LAST_ZERO_DATE;
+     return false;
+   }
+   return true;
+ }
+
+
+ bool TextRowProtocolCapi::getInternalDecimal(ColumnDefinition* columnInfo, Decimal& value)
+ {
+   value= Decimal();
+   if (lastValueWasNull()) {
+     return false;
+   }
+   // Integer, decimal and string values are parsed right from the row buffer
+   if (!DecimalCodec::parse(fieldBuf.arr + pos, length, value)) {
+     throw SQLException(
+       "Value '" + SQLString(fieldBuf.arr + pos, length) + "' of the column '" + columnInfo->getName() + "' cannot be converted to Decimal",
+       "22003");
+   }
+   return true;
+ }
+
 #ifdef JDBC_SPECIFIC_TYPES_IMPLEMENTED
  /**
  * Get Object from raw text format.
@@ -745,7 +881,7 @@ namespace capi
      case MYSQL_TYPE_FLOAT:
      case MYSQL_TYPE_DOUBLE:
      {
-       long double doubleValue= std::stold(fieldBuf.arr);
+       long double doubleValue= stringToDouble(fieldBuf.arr + pos, length);
        if (doubleValue > static_cast<long double>(INT64_MAX)) {
          throw SQLException(
            "Out of range value for column '"
@@ -766,7 +902,13 @@ namespace capi
      case MYSQL_TYPE_LONG:
      case MYSQL_TYPE_INT24:
      case MYSQL_TYPE_LONGLONG:
+     {
+       int64_t value;
+       if (parseInt64(fieldBuf.arr + pos, length, value)) {
+         return value;
+       }
        return std::stoll(std::string(fieldBuf.arr, length));
+     }
      case MYSQL_TYPE_TIMESTAMP:
      case MYSQL_TYPE_DATETIME:
      case MYSQL_TYPE_TIME:
@@ -779,6 +921,10 @@ namespace capi
          return parseBinaryAsInteger<int64_t>(columnInfo);
        }
        else {
+         int64_t value;
+         if (parseInt64(fieldBuf.arr + pos, length, value)) {
+           return value;
+         }
          return std::stoll(std::string(fieldBuf.arr + pos, length));
        }
      }
@@ -808,7 +954,7 @@ namespace capi
      case MYSQL_TYPE_FLOAT:
      case MYSQL_TYPE_DOUBLE:
      {
-       long double doubleValue = std::stold(fieldBuf.arr);
+       long double doubleValue= stringToDouble(fieldBuf.arr + pos, length);
        if (doubleValue < 0 || doubleValue > static_cast<long double>(UINT64_MAX)) {
          throw SQLException(
            "Out of range value for column '"
@@ -829,7 +975,9 @@ namespace capi
      case MYSQL_TYPE_LONG:
      case MYSQL_TYPE_INT24:
      case MYSQL_TYPE_LONGLONG:
-       value= sql::mariadb::stoull(fieldBuf.arr);
+       if (!parseUInt64(fieldBuf.arr + pos, length, value)) {
+         value= sql::mariadb::stoull(fieldBuf.arr + pos, length);
+       }
        break;
      case MYSQL_TYPE_TIMESTAMP:
      case MYSQL_TYPE_DATETIME:
@@ -842,7 +990,7 @@ namespace capi
        if (needsBinaryConversion(columnInfo)) {
          return parseBinaryAsInteger<uint64_t>(columnInfo);
        }
-       else {
+       else if (!parseUInt64(fieldBuf.arr + pos, length, value)) {
          value= sql::mariadb::stoull(fieldBuf.arr + pos, length);
        }
      }
@@ -1166,12 +1314,21 @@ namespace capi
  }
 
 
- void TextRowProtocolCapi::cacheCurrentRow(std::vector<sql::bytes>& rowDataCache, std::size_t columnCount)
+ void TextRowProtocolCapi::cacheCurrentRow(RowDataArena& cache, std::size_t columnCount)
  {
-   rowDataCache.clear();
-   for (std::size_t i = 0; i < columnCount; ++i) {
-     rowDataCache.emplace_back(const_cast<const char*>(rowData[i]), lengthArr[i]);
+   cache.append(const_cast<const char* const*>(rowData), lengthArr);
+ }
+
+
+ std::size_t TextRowProtocolCapi::rowDataLength(std::size_t columnCount)
+ {
+   std::size_t length= 0;
+   if (lengthArr != nullptr) {
+     for (std::size_t i= 0; i < columnCount; ++i) {
+       length+= lengthArr[i];
+     }
    }
+   return length;
  }
 }
 }
@@ -33,7 +33,7 @@ namespace capi
 {
 #include "mysql.h"
 
-class TextRowProtocolCapi  : public RowProtocol {
+class TextRowProtocolCapi final : public RowProtocol {
 
   std::unique_ptr<MYSQL_RES, decltype(&mysql_free_result)> capiResults;
   MYSQL_ROW  rowData;
@@ -71,9 +71,13 @@ public:
   int8_t getInternalByte(ColumnDefinition* columnInfo);
   int16_t getInternalShort(ColumnDefinition* columnInfo);
   SQLString getInternalTimeString(ColumnDefinition* columnInfo);
+  bool getInternalDateTime(ColumnDefinition* columnInfo, DateTime& value);
+  bool getInternalDecimal(ColumnDefinition* columnInfo, Decimal& value);
 
   bool isBinaryEncoded();
-  void cacheCurrentRow(std::vector<sql::bytes>& rowData, std::size_t columnCount) override;
+  bool isRawStringValue(ColumnDefinition* columnInfo);
+  void cacheCurrentRow(RowDataArena& cache, std::size_t columnCount) override;
+  std::size_t rowDataLength(std::size_t columnCount) override;
   };
 
 }
@@ -0,0 +1,83 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+#include <algorithm>
+
+#include "BatchWindow.h"
+
+namespace sql
+{
+namespace mariadb
+{
+  constexpr uint64_t BatchWindow::DEFAULT_BLOCKED_WRITE_US;
+  constexpr std::size_t BatchWindow::MAX_WINDOW;
+
+
+  BatchWindow::BatchWindow(std::size_t initial)
+    : window(std::min(std::max(initial, static_cast<std::size_t>(1)), MAX_WINDOW))
+  {
+  }
+
+
+  void BatchWindow::setBufferSize(std::size_t bytes)
+  {
+    bufferSize= bytes;
+    updateLimit();
+  }
+
+
+  void BatchWindow::updateLimit()
+  {
+    limit= MAX_WINDOW;
+    if (bufferSize > 0 && statementBytes > 0) {
+      limit= std::max(std::min(static_cast<std::size_t>(bufferSize / statementBytes), MAX_WINDOW),
+        static_cast<std::size_t>(1));
+    }
+    window= std::min(window, limit);
+  }
+
+
+  void BatchWindow::sent(std::size_t bytes, uint64_t writeMicros)
+  {
+    // Moving average with 1/8 weight of the new value, as the TCP's smoothed RTT
+    statementBytes= statementBytes == 0 ? bytes : (statementBytes*7 + bytes)/8;
+    updateLimit();
+
+    if (writeMicros > (rtt > 0 ? rtt/2 : DEFAULT_BLOCKED_WRITE_US)) {
+      window= std::max(window/2, static_cast<std::size_t>(1));
+      slowStart= false;
+      grown= 0;
+    }
+  }
+
+
+  void BatchWindow::received(bool awaited, uint64_t readMicros)
+  {
+    if (!awaited) {
+      return;
+    }
+    rtt= rtt == 0 ? readMicros : (rtt*7 + readMicros)/8;
+
+    if (slowStart || ++grown >= window) {
+      grown= 0;
+      window= std::min(window + 1, limit);
+    }
+  }
+}
+}
@@ -0,0 +1,67 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+#ifndef _BATCHWINDOW_H_
+#define _BATCHWINDOW_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sql
+{
+namespace mariadb
+{
+
+/* Number of statements of the multi-send batch, that are sent ahead of reading their results(adaptiveBatchWindow
+   option). Sized like the TCP congestion window: it grows, while the results are awaited, i.e. the pipe runs empty
+   before the next result arrives, by one per awaited result in the slow start, and by one per window after that. It is
+   halved, when writing a statement blocks for longer than the half of the round trip, i.e. the socket buffers are full.
+   The window in bytes, at the average statement size, is bounded by the socket send buffer. The round trip is the
+   smoothed time of the awaited reads. Owned by the connection, and used under its lock */
+class BatchWindow final
+{
+  static constexpr uint64_t DEFAULT_BLOCKED_WRITE_US= 1000;
+  static constexpr std::size_t MAX_WINDOW= 65536;
+
+  std::size_t window;
+  std::size_t bufferSize= 0;
+  std::size_t limit= MAX_WINDOW;
+  uint64_t statementBytes= 0;
+  uint64_t rtt= 0;
+  std::size_t grown= 0;
+  bool slowStart= true;
+
+  void updateLimit();
+
+public:
+  explicit BatchWindow(std::size_t initial);
+
+  std::size_t size() const { return window; }
+  /* Smoothed round trip in microseconds, 0 if it has not been measured yet */
+  uint64_t getRtt() const { return rtt; }
+  void setBufferSize(std::size_t bytes);
+  /* The statement of the given size has been written, that took writeMicros */
+  void sent(std::size_t bytes, uint64_t writeMicros);
+  /* The result of the statement has been read. awaited is true, if nothing had arrived by the time of reading */
+  void received(bool awaited, uint64_t readMicros);
+};
+
+}
+}
+#endif
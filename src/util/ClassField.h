@@ -240,7 +240,7 @@ public:
     obj.*(value.bv)= val2set;
   }
 
-  const Value get(const T& obj) const
+  Value get(const T& obj) const
   {
     /* We actually could make the Value out of pointer and give full access to the field,
        but do we need it? we return const */
@@ -261,6 +261,30 @@ public:
     return Value();
   }
 
+  /* Puts the field's value into the given Value, reusing its string, so reading fields of many objects needs
+     no allocations */
+  void get(const T& obj, Value& into) const
+  {
+    switch (type)
+    {
+    case valueType::VSTRING:
+      into= obj.*(value.sv);
+      break;
+    case valueType::VINT32:
+      into= obj.*(value.iv);
+      break;
+    case valueType::VINT64:
+      into= obj.*(value.lv);
+      break;
+    case valueType::VBOOL:
+      into= obj.*(value.bv);
+      break;
+    default:
+      into.reset();
+      break;
+    }
+  }
+
   ~ClassField()
   {
   }
@@ -18,7 +18,11 @@
 *************************************************************************************/
 
 
+#include <cctype>
+#include <cstring>
+
 #include "ClientPrepareResult.h"
+#include "Utils.h"
 
 namespace sql
 {
@@ -26,14 +30,54 @@ namespace mariadb
 {
   const SQLString SpecChars("();><=-+,");
 
+  /* True, if the keyword is at the position as the whole word. Case insensitive */
+  static bool isKeywordAt(const char* text, std::size_t length, std::size_t pos, const char* keyword)
+  {
+    std::size_t keywordLength= std::strlen(keyword);
+
+    if (pos + keywordLength > length || (pos > 0 && (std::isalnum(static_cast<unsigned char>(text[pos - 1]))
+      || text[pos - 1] == '_'))) {
+      return false;
+    }
+    for (std::size_t i= 0; i < keywordLength; ++i) {
+      if (std::toupper(static_cast<unsigned char>(text[pos + i])) != keyword[i]) {
+        return false;
+      }
+    }
+    return pos + keywordLength == length || !(std::isalnum(static_cast<unsigned char>(text[pos + keywordLength]))
+      || text[pos + keywordLength] == '_');
+  }
+
+  /* True, if the part of the query has the keyword outside of quotes and backticks */
+  static bool hasKeyword(const SQLString& part, const char* keyword)
+  {
+    char quote= '\0';
+
+    for (std::size_t i= 0; i < part.length(); ++i) {
+      char car= part.c_str()[i];
+      if (quote != '\0') {
+        if (car == quote) {
+          quote= '\0';
+        }
+      }
+      else if (car == '\'' || car == '"' || car == '`') {
+        quote= car;
+      }
+      else if (isKeywordAt(part.c_str(), part.length(), i, keyword)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
   ClientPrepareResult::ClientPrepareResult(
     const SQLString& _sql,
-    std::vector<SQLString>& _queryParts,
+    std::vector<SQLString>&& _queryParts,
     bool isQueryMultiValuesRewritable,
     bool isQueryMultipleRewritable,
     bool _rewriteType)
     : sql(_sql)
-    , queryParts(_queryParts)
+    , queryParts(std::move(_queryParts))
     , rewriteType(_rewriteType)
     , paramCount(static_cast<uint32_t>(queryParts.size()) - (_rewriteType ? 3 : 1))
     , isQueryMultiValuesRewritableFlag(isQueryMultiValuesRewritable)
@@ -63,10 +107,21 @@ namespace mariadb
     bool singleQuotes= false;
     std::size_t lastParameterPosition= 0;
 
+    const char* query= queryString.c_str();
     std::size_t queryLength= queryString.length();
     for (std::size_t i= 0; i < queryLength; i++) {
 
-      char car= queryString[i];
+      if (state != LexState::Normal && state != LexState::Escape) {
+        std::size_t next= Utils::skipLexState(state, query + i, query + queryLength) - query;
+        if (next >= queryLength) {
+          break;
+        }
+        if (next != i) {
+          i= next;
+          lastChar= query[i - 1];
+        }
+      }
+      char car= query[i];
       if (state == LexState::Escape
         && !((car == '\'' && singleQuotes) || (car == '"' && !singleQuotes))) {
         state= LexState::SqlString;
@@ -185,7 +240,141 @@ namespace mariadb
     }
 
     return new ClientPrepareResult(
-      queryString, partList, reWritablePrepare, multipleQueriesPrepare, false);
+      queryString, std::move(partList), reWritablePrepare, multipleQueriesPrepare, false);
+  }
+
+  static bool isIdentifierChar(char c)
+  {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$' || (c & 0x80) != 0;
+  }
+
+  /**
+    * Normalize query to its digest, that is the same for all executions of the same statement with different
+    * literals. Comments are recognized the same way parameterParts does it. Numbers and string literals are
+    * replaced by ?, whitespace is collapsed to single space. Example: "SELECT * FROM t  WHERE id=1 AND s='a'" gives
+    * "SELECT * FROM t WHERE id=? AND s=?"
+    *
+    * @param queryString query
+    * @param noBackslashEscapes escape mode
+    * @return digest
+    */
+  std::string ClientPrepareResult::digest(const SQLString& queryString, bool noBackslashEscapes)
+  {
+    std::string result;
+    LexState state= LexState::Normal;
+    char lastChar= '\0';
+    bool singleQuotes= false;
+    bool space= false;
+
+    std::size_t queryLength= queryString.length();
+    result.reserve(queryLength);
+    for (std::size_t i= 0; i < queryLength; i++) {
+
+      char car= queryString[i];
+      switch (state) {
+      case LexState::Escape:
+        state= LexState::SqlString;
+        lastChar= '\0';
+        continue;
+
+      case LexState::SqlString:
+        if (car == '\\' && !noBackslashEscapes) {
+          state= LexState::Escape;
+        }
+        else if (car == (singleQuotes ? '\'' : '"')) {
+          state= LexState::Normal;
+        }
+        lastChar= car;
+        continue;
+
+      case LexState::SlashStarComment:
+        if (car == '/' && lastChar == '*') {
+          state= LexState::Normal;
+          car= '\0';
+        }
+        lastChar= car;
+        continue;
+
+      case LexState::EOLComment:
+        if (car == '\n') {
+          state= LexState::Normal;
+        }
+        lastChar= car;
+        continue;
+
+      case LexState::Backtick:
+        result.push_back(car);
+        if (car == '`') {
+          state= LexState::Normal;
+        }
+        lastChar= car;
+        continue;
+
+      default:
+        break;
+      }
+
+      if (std::isspace(static_cast<unsigned char>(car))) {
+        space= true;
+        lastChar= car;
+        continue;
+      }
+      if ((car == '*' && lastChar == '/') || (car == '/' && lastChar == '/') || (car == '-' && lastChar == '-')) {
+        // The first character of the comment start has already gone to the digest
+        result.pop_back();
+        if (!result.empty() && result.back() == ' ') {
+          result.pop_back();
+        }
+        state= car == '*' ? LexState::SlashStarComment : LexState::EOLComment;
+        space= true;
+        lastChar= '\0';
+        continue;
+      }
+      if (car == '#') {
+        state= LexState::EOLComment;
+        space= true;
+        lastChar= car;
+        continue;
+      }
+      if (space && !result.empty()) {
+        result.push_back(' ');
+      }
+      space= false;
+
+      switch (car) {
+      case '"':
+      case '\'':
+        // Doubled quote inside the literal is not a new literal
+        if (!(lastChar == car && !result.empty() && result.back() == '?')) {
+          result.push_back('?');
+        }
+        state= LexState::SqlString;
+        singleQuotes= car == '\'';
+        break;
+
+      case '`':
+        result.push_back(car);
+        state= LexState::Backtick;
+        break;
+
+      default:
+        if (std::isdigit(static_cast<unsigned char>(car)) && (result.empty() || !isIdentifierChar(result.back()))) {
+          // Number, including decimal point, exponent and hex digits
+          while (i + 1 < queryLength && (isIdentifierChar(queryString[i + 1]) || queryString[i + 1] == '.'
+                 || ((queryString[i + 1] == '+' || queryString[i + 1] == '-') && (queryString[i] == 'e' || queryString[i] == 'E')))) {
+            ++i;
+          }
+          car= queryString[i];
+          result.push_back('?');
+        }
+        else {
+          result.push_back(car);
+        }
+        break;
+      }
+      lastChar= car;
+    }
+    return result;
   }
 
   /**
@@ -203,9 +392,22 @@ namespace mariadb
 
     bool singleQuotes= false;
     bool endingSemicolon= false;
+    const char* query= queryString.c_str();
+    std::size_t queryLength= queryString.length();
 
-    for (char car : queryString) {
+    for (std::size_t i= 0; i < queryLength; i++) {
 
+      if (state != LexState::Normal && state != LexState::Escape) {
+        std::size_t next= Utils::skipLexState(state, query + i, query + queryLength) - query;
+        if (next >= queryLength) {
+          break;
+        }
+        if (next != i) {
+          i= next;
+          lastChar= query[i - 1];
+        }
+      }
+      char car= query[i];
       if (state == LexState::Escape
         &&!((car == '\''&&singleQuotes)||(car == '"'&&!singleQuotes))) {
         state= LexState::SqlString;
@@ -363,6 +565,7 @@ namespace mariadb
     bool skipChar= false;
     bool isFirstChar= true;
     bool isInsert= false;
+    bool isReplace= false;
     bool semicolon= false;
     bool hasParam= false;
 
@@ -577,6 +780,11 @@ namespace mariadb
           if (car == 'I'||car == 'i') {
             isInsert= true;
           }
+          else if ((car == 'R'||car == 'r') && isKeywordAt(query, queryLength, i, "REPLACE")) {
+            // REPLACE has the same VALUES syntax, and is rewritten the same way
+            isInsert= true;
+            isReplace= true;
+          }
           isFirstChar= false;
         }
 
@@ -624,9 +832,24 @@ namespace mariadb
     }
     partList.push_back(sb/*.getBytes(StandardCharsets.UTF_8)*/);
 
+    ClientPrepareResult* result= new ClientPrepareResult(
+      queryString, std::move(partList), reWritablePrepare, multipleQueriesPrepare, true);
 
-    return new ClientPrepareResult(
-      queryString, partList, reWritablePrepare, multipleQueriesPrepare, true);
+    if (reWritablePrepare) {
+      if (isReplace) {
+        // Replaced row is deleted and inserted
+        result->rowUpdateCountMax= 2;
+      }
+      if (hasKeyword(preValuePart1, "IGNORE")) {
+        result->rowUpdateCountMin= 0;
+      }
+      // ON DUPLICATE KEY UPDATE is in the last part. Updated row counts 2, and unchanged one 0, or 1 with found rows
+      if (hasKeyword(sb, "DUPLICATE")) {
+        result->rowUpdateCountMin= 0;
+        result->rowUpdateCountMax= 2;
+      }
+    }
+    return result;
   }
 
   const SQLString& ClientPrepareResult::getSql() const
@@ -659,6 +882,16 @@ namespace mariadb
     return paramCount;
   }
 
+  Shared::ParameterMetaData ClientPrepareResult::getParameterMetaData() const
+  {
+    return std::atomic_load(&parameterMetaData);
+  }
+
+  void ClientPrepareResult::setParameterMetaData(const Shared::ParameterMetaData& metaData) const
+  {
+    std::atomic_store(&parameterMetaData, metaData);
+  }
+
   /*void ClientPrepareResult::assembleQueryText(SQLString& resultSql, const ClientPrepareResult* clientPrepareResult, const std::vector<ParameterHolder>& parameters)
   {
       //if (queryTimeout > 0) {
@@ -21,6 +21,8 @@
 #ifndef _CLIENTPREPARERESULT_H_
 #define _CLIENTPREPARERESULT_H_
 
+#include <memory>
+#include <string>
 #include <vector>
 
 #include "Consts.h"
@@ -34,16 +36,23 @@ namespace mariadb
 
 class ClientPrepareResult : public PrepareResult
 {
-  const SQLString& sql;
+  const SQLString sql;
   const std::vector<SQLString> queryParts;
   bool rewriteType;
   uint32_t paramCount;
   bool isQueryMultiValuesRewritableFlag; /*true*/
   bool isQueryMultipleRewritableFlag; /*true*/
+  /* Range of the update count of one row of the multi-values rewritable query: 1 for INSERT, 0..1 with IGNORE, 1..2 for
+     REPLACE, and 0..2 with ON DUPLICATE KEY UPDATE */
+  int32_t rowUpdateCountMin= 1;
+  int32_t rowUpdateCountMax= 1;
+  /* Set once by the first statement, that has asked the server. Shared by all statements of the query, as is the
+     rest of the object */
+  mutable Shared::ParameterMetaData parameterMetaData;
 
  ClientPrepareResult(
   const SQLString& sql,
-  std::vector<SQLString>& queryParts,
+  std::vector<SQLString>&& queryParts,
   bool isQueryMultiValuesRewritable,
   bool isQueryMultipleRewritable,
   bool rewriteType);
@@ -52,13 +61,19 @@ public:
   static ClientPrepareResult* parameterParts(const SQLString& queryString, bool noBackslashEscapes);
   static bool canAggregateSemiColon(const SQLString& queryString,bool noBackslashEscapes);
   static ClientPrepareResult* rewritableParts(const SQLString& queryString, bool noBackslashEscapes);
+  /* Query text with literals replaced by ?, comments removed, and whitespace collapsed */
+  static std::string digest(const SQLString& queryString, bool noBackslashEscapes);
 
   const SQLString& getSql() const;
   const std::vector<SQLString>& getQueryParts() const;
   bool isQueryMultiValuesRewritable() const;
   bool isQueryMultipleRewritable() const;
   bool isRewriteType() const;
+  int32_t getRowUpdateCountMin() const { return rowUpdateCountMin; }
+  int32_t getRowUpdateCountMax() const { return rowUpdateCountMax; }
   std::size_t getParamCount() const;
+  Shared::ParameterMetaData getParameterMetaData() const;
+  void setParameterMetaData(const Shared::ParameterMetaData& metaData) const;
   };
 
 //void assembleQueryText(SQLString& resultSql, const ClientPrepareResult* clientPrepareResult, const std::vector<ParameterHolder>& parameters);
@@ -0,0 +1,140 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#include "ClientPrepareResultCache.h"
+#include "ClientPrepareResult.h"
+#include "Probes.h"
+
+namespace sql
+{
+namespace mariadb
+{
+  /* Rough accounting of memory taken by the entry - key, that contains the query, and query parts */
+  std::size_t ClientPrepareResultCache::entrySize(const LruList::value_type& entry)
+  {
+    std::size_t size= sizeof(LruList::value_type) + sizeof(ClientPrepareResult) + entry.first.length();
+
+    for (auto& part : entry.second->getQueryParts()) {
+      size+= sizeof(SQLString) + part.length();
+    }
+    return size;
+  }
+
+
+  ClientPrepareResultCache::ClientPrepareResultCache()
+    : bytes(0)
+  {
+  }
+
+
+  ClientPrepareResultCache& ClientPrepareResultCache::getInstance()
+  {
+    static ClientPrepareResultCache theInstance;
+    return theInstance;
+  }
+
+  /* Has to be called under the lock */
+  void ClientPrepareResultCache::shrink(std::size_t maxBytes)
+  {
+    while (bytes > maxBytes && !lru.empty()) {
+      auto& eldest= lru.back();
+      bytes-= entrySize(eldest);
+      index.erase(eldest.first);
+      lru.pop_back();
+    }
+  }
+
+
+  Shared::ClientPrepareResult ClientPrepareResultCache::get(const SQLString& sql, bool noBackslashEscapes, bool rewritable,
+    std::size_t maxBytes, bool* cached)
+  {
+    if (cached != nullptr) {
+      *cached= false;
+    }
+    if (maxBytes == 0) {
+      return Shared::ClientPrepareResult(rewritable ? ClientPrepareResult::rewritableParts(sql, noBackslashEscapes) :
+        ClientPrepareResult::parameterParts(sql, noBackslashEscapes));
+    }
+    std::string key(StringImp::get(sql));
+    key.push_back(noBackslashEscapes ? '1' : '0');
+    key.push_back(rewritable ? '1' : '0');
+    {
+      std::lock_guard<std::mutex> localScopeLock(lock);
+      auto it= index.find(key);
+
+      if (it != index.end()) {
+        lru.splice(lru.begin(), lru, it->second);
+        if (cached != nullptr) {
+          *cached= true;
+        }
+        MARIADB_PROBE1(cache__hit, "clientPrepare");
+        return it->second->second;
+      }
+    }
+    MARIADB_PROBE1(cache__miss, "clientPrepare");
+    // Parsing without the lock. If other thread parses the same query meanwhile, its result is used
+    Shared::ClientPrepareResult result(rewritable ? ClientPrepareResult::rewritableParts(sql, noBackslashEscapes) :
+      ClientPrepareResult::parameterParts(sql, noBackslashEscapes));
+
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    auto it= index.find(key);
+
+    if (it != index.end()) {
+      lru.splice(lru.begin(), lru, it->second);
+      return it->second->second;
+    }
+    lru.emplace_front(std::move(key), result);
+    std::size_t size= entrySize(lru.front());
+
+    if (size > maxBytes) {
+      lru.pop_front();
+      return result;
+    }
+    index.emplace(lru.front().first, lru.begin());
+    bytes+= size;
+    shrink(maxBytes);
+
+    return result;
+  }
+
+
+  void ClientPrepareResultCache::clear()
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    index.clear();
+    lru.clear();
+    bytes= 0;
+  }
+
+
+  std::size_t ClientPrepareResultCache::size()
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    return lru.size();
+  }
+
+
+  std::size_t ClientPrepareResultCache::getBytes()
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    return bytes;
+  }
+}
+}
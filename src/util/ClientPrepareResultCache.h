@@ -0,0 +1,69 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _CLIENTPREPARERESULTCACHE_H_
+#define _CLIENTPREPARERESULTCACHE_H_
+
+#include <unordered_map>
+#include <list>
+#include <mutex>
+
+#include "Consts.h"
+
+namespace sql
+{
+namespace mariadb
+{
+
+/* Process wide cache of parsed client side prepared statements queries, shared by all connections. Parse results
+   are immutable, thus the same object can be used by any number of statements in any thread. Cached are results of
+   both parameterParts and rewritableParts, the key is the query plus the parse mode flags.
+   The size of the cache is limited by the total number of bytes of the cached queries and their parts. The limit
+   comes with every request, i.e. the connection option of the caller, and the least recently used entries are
+   evicted until the cache fits it. */
+class ClientPrepareResultCache final
+{
+  typedef std::list<std::pair<std::string, Shared::ClientPrepareResult>> LruList;
+
+  std::mutex lock;
+  LruList lru;
+  std::unordered_map<std::string, LruList::iterator> index;
+  std::size_t bytes;
+
+  ClientPrepareResultCache();
+  static std::size_t entrySize(const LruList::value_type& entry);
+  void shrink(std::size_t maxBytes);
+
+public:
+  static ClientPrepareResultCache& getInstance();
+
+  /* Returns cached or newly parsed result of ClientPrepareResult::rewritableParts, if rewritable is true, or of
+     ClientPrepareResult::parameterParts otherwise. maxBytes 0 bypasses the cache. If cached is not nullptr, it's set
+     to tell if the result has been found in the cache */
+  Shared::ClientPrepareResult get(const SQLString& sql, bool noBackslashEscapes, bool rewritable, std::size_t maxBytes,
+    bool* cached= nullptr);
+  void clear();
+  std::size_t size();
+  std::size_t getBytes();
+};
+
+}
+}
+#endif
@@ -0,0 +1,65 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _CONNECTIONMUTEX_H_
+#define _CONNECTIONMUTEX_H_
+
+#include <mutex>
+
+namespace sql
+{
+namespace mariadb
+{
+
+/* Lock of the connection's protocol, that callers take around each command and each read of the result. With the
+   threadSafeConnection option off, the application guarantees, that the connection is used by one thread at a time,
+   and the lock does nothing. The choice is made once, when the connection is created, so the check is one well
+   predicted branch instead of the atomic operations of the mutex */
+class ConnectionMutex
+{
+  std::mutex mutex;
+  const bool enabled;
+
+  ConnectionMutex(const ConnectionMutex&)= delete;
+  ConnectionMutex& operator=(const ConnectionMutex&)= delete;
+
+public:
+  explicit ConnectionMutex(bool _enabled= true) : enabled(_enabled) {}
+
+  void lock()
+  {
+    if (enabled) {
+      mutex.lock();
+    }
+  }
+
+  void unlock()
+  {
+    if (enabled) {
+      mutex.unlock();
+    }
+  }
+
+  bool try_lock() { return !enabled || mutex.try_lock(); }
+};
+
+}
+}
+#endif
@@ -0,0 +1,56 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _CONSTANTRESULT_H_
+#define _CONSTANTRESULT_H_
+
+#include <vector>
+
+#include "Consts.h"
+#include "ColumnType.h"
+
+namespace sql
+{
+namespace mariadb
+{
+
+/* Result, that does not depend on the server or the connection, e.g. of DatabaseMetaData::getTypeInfo. Meant to be
+   a function local static, i.e. built once per process. Result sets made of it share its column definitions, and copy
+   its rows into their storage in one go, without allocations per cell */
+class ConstantResult final
+{
+  std::vector<Shared::ColumnDefinition> columns;
+  /* Values in the text protocol representation */
+  const std::vector<std::vector<sql::bytes>> rows;
+
+  ConstantResult(const ConstantResult&)=delete;
+  void operator=(const ConstantResult&)=delete;
+
+public:
+  ConstantResult(const std::vector<SQLString>& columnNames, const std::vector<ColumnType>& columnTypes,
+    std::vector<std::vector<sql::bytes>>&& rows);
+
+  /* The caller owns the result */
+  ResultSet* createResultSet(Protocol* protocol) const;
+};
+
+}
+}
+#endif
@@ -0,0 +1,236 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+
+#include <cstring>
+
+#include "DateTimeCodec.h"
+
+namespace sql
+{
+namespace mariadb
+{
+  static const uint32_t powersOf10[]= {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+  // Layouts of 8 bytes words of the values, and masks of their separators
+  static const char dateHead[]= "0000-00-", dateHeadMask[]= "\0\0\0\0\xff\0\0\xff";
+  static const char dateTail[]= "00-00-00", timeMask[]= "\0\0\xff\0\0\xff\0\0";
+  static const char dayHour[]= "00 00:00";
+  static const char hourSecond[]= "00:00:00";
+
+
+  static inline uint64_t load8(const char* str)
+  {
+    uint64_t word;
+    std::memcpy(&word, str, sizeof(word));
+    return word;
+  }
+
+  /* Checks, that the 8 bytes at str have digits, where the layout has '0', and are equal to the layout otherwise.
+     Digit values are stored to digits. The bytes order does not matter, as both words are loaded the same way */
+  static inline bool matchLayout(const char* str, const char* layout, const char* separatorMask, uint8_t* digits)
+  {
+    uint64_t value= load8(str) ^ load8(layout);
+
+    // Digits give bytes 0-9, and separators give 0. Only bytes up to 9 stay below 0x80, when 0x76 is added to them
+    if (((value | (value + 0x7676767676767676ULL)) & 0x8080808080808080ULL) != 0 || (value & load8(separatorMask)) != 0) {
+      return false;
+    }
+    std::memcpy(digits, &value, sizeof(value));
+    return true;
+  }
+
+
+  static inline bool isDigit(char c)
+  {
+    return static_cast<unsigned char>(c - '0') < 10;
+  }
+
+
+  static bool parseFraction(const char* str, std::size_t length, DateTime& value, uint32_t& fractionDigits)
+  {
+    fractionDigits= 0;
+    if (length == 0) {
+      return true;
+    }
+    if (*str != '.' || length == 1 || length > 10) {
+      return false;
+    }
+    for (std::size_t i= 1; i < length; ++i) {
+      if (!isDigit(str[i])) {
+        return false;
+      }
+      value.nanos= value.nanos*10 + (str[i] - '0');
+    }
+    fractionDigits= static_cast<uint32_t>(length - 1);
+    value.nanos*= powersOf10[9 - fractionDigits];
+    return true;
+  }
+
+
+  bool DateTimeCodec::parseDateTime(const char* str, std::size_t length, DateTime& value, uint32_t& fractionDigits)
+  {
+    uint8_t head[8], tail[8];
+
+    if ((length != 10 && length < 19) || !matchLayout(str, dateHead, dateHeadMask, head)) {
+      return false;
+    }
+    value= DateTime();
+    fractionDigits= 0;
+    value.year= head[0]*1000U + head[1]*100U + head[2]*10U + head[3];
+    value.month= head[5]*10U + head[6];
+
+    if (length == 10) {
+      if (!matchLayout(str + 2, dateTail, timeMask, tail)) {
+        return false;
+      }
+      value.day= tail[6]*10U + tail[7];
+      return true;
+    }
+    if (!matchLayout(str + 8, dayHour, timeMask, head) || !matchLayout(str + 11, hourSecond, timeMask, tail)) {
+      return false;
+    }
+    value.day= head[0]*10U + head[1];
+    value.hour= tail[0]*10U + tail[1];
+    value.minute= tail[3]*10U + tail[4];
+    value.second= tail[6]*10U + tail[7];
+
+    return parseFraction(str + 19, length - 19, value, fractionDigits);
+  }
+
+
+  bool DateTimeCodec::parseTime(const char* str, std::size_t length, DateTime& value, uint32_t& fractionDigits)
+  {
+    const char* it= str, *end= str + length, *hourBegin;
+
+    value= DateTime();
+    fractionDigits= 0;
+    if (it < end && *it == '-') {
+      value.negative= true;
+      ++it;
+    }
+    hourBegin= it;
+    while (it < end && isDigit(*it)) {
+      value.hour= value.hour*10 + (*it - '0');
+      ++it;
+    }
+    if (it == hourBegin || it - hourBegin > 3 || end - it < 6) {
+      return false;
+    }
+    if (it[0] != ':' || !isDigit(it[1]) || !isDigit(it[2]) || it[3] != ':' || !isDigit(it[4]) || !isDigit(it[5])) {
+      return false;
+    }
+    value.minute= (it[1] - '0')*10U + (it[2] - '0');
+    value.second= (it[4] - '0')*10U + (it[5] - '0');
+    it+= 6;
+
+    return parseFraction(it, static_cast<std::size_t>(end - it), value, fractionDigits);
+  }
+
+
+  bool DateTimeCodec::isZero(const DateTime& value)
+  {
+    return value.year == 0 && value.month == 0 && value.day == 0 && value.hour == 0 && value.minute == 0 &&
+      value.second == 0 && value.nanos == 0;
+  }
+
+
+  static inline char* write2(char* out, uint32_t value)
+  {
+    out[0]= static_cast<char>('0' + value / 10 % 10);
+    out[1]= static_cast<char>('0' + value % 10);
+    return out + 2;
+  }
+
+
+  static char* writeDate(char* out, const DateTime& value)
+  {
+    out= write2(out, value.year / 100);
+    out= write2(out, value.year);
+    *out++= '-';
+    out= write2(out, value.month);
+    *out++= '-';
+    return write2(out, value.day);
+  }
+
+
+  static char* writeTime(char* out, const DateTime& value, uint32_t fractionDigits)
+  {
+    // Hours of TIME values go up to 838
+    if (value.hour > 99) {
+      *out++= static_cast<char>('0' + value.hour / 100 % 10);
+    }
+    out= write2(out, value.hour);
+    *out++= ':';
+    out= write2(out, value.minute);
+    *out++= ':';
+    out= write2(out, value.second);
+
+    if (value.nanos != 0 && fractionDigits > 0) {
+      uint32_t digits= fractionDigits > 9 ? 9 : fractionDigits;
+      uint32_t fraction= value.nanos / powersOf10[9 - digits];
+
+      *out++= '.';
+      for (uint32_t i= digits; i > 0; --i) {
+        out[i - 1]= static_cast<char>('0' + fraction % 10);
+        fraction/= 10;
+      }
+      out+= digits;
+    }
+    return out;
+  }
+
+
+  std::size_t DateTimeCodec::formatDate(const DateTime& value, char* buffer)
+  {
+    char* out= buffer;
+
+    if (value.negative) {
+      *out++= '-';
+    }
+    return writeDate(out, value) - buffer;
+  }
+
+
+  std::size_t DateTimeCodec::formatDateTime(const DateTime& value, uint32_t fractionDigits, char* buffer)
+  {
+    char* out= buffer;
+
+    if (value.negative) {
+      *out++= '-';
+    }
+    out= writeDate(out, value);
+    *out++= ' ';
+    return writeTime(out, value, fractionDigits) - buffer;
+  }
+
+
+  std::size_t DateTimeCodec::formatTime(const DateTime& value, uint32_t fractionDigits, char* buffer)
+  {
+    char* out= buffer;
+
+    if (value.negative) {
+      *out++= '-';
+    }
+    return writeTime(out, value, fractionDigits) - buffer;
+  }
+
+}
+}
@@ -0,0 +1,58 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+
+#ifndef _DATETIMECODEC_H_
+#define _DATETIMECODEC_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "ResultSet.hpp"
+
+namespace sql
+{
+namespace mariadb
+{
+
+/* Parsing and formatting of date and time values in the fixed layouts the server uses, i.e. "YYYY-MM-DD",
+   "YYYY-MM-DD HH:MM:SS[.F]" and "[-]H+:MM:SS[.F]", on raw bytes and without allocations. Digits and separators of the
+   fixed part are validated 8 bytes at a time. Parsers return false for anything else, and the caller falls back to
+   the general parsing */
+class DateTimeCodec final
+{
+public:
+  /* Enough for "-YYYY-MM-DD HHH:MM:SS.FFFFFFFFF" */
+  static constexpr std::size_t MAX_LENGTH= 32;
+
+  /* Date or datetime. fractionDigits is set to the number of digits of the fractional part, as it was given */
+  static bool parseDateTime(const char* str, std::size_t length, DateTime& value, uint32_t& fractionDigits);
+  static bool parseTime(const char* str, std::size_t length, DateTime& value, uint32_t& fractionDigits);
+  static bool isZero(const DateTime& value);
+  /* Formatters write to the buffer of at least MAX_LENGTH bytes, and return the length of the value. The terminating
+     null is not written. Non-zero fractional part is written with fractionDigits digits */
+  static std::size_t formatDate(const DateTime& value, char* buffer);
+  static std::size_t formatDateTime(const DateTime& value, uint32_t fractionDigits, char* buffer);
+  static std::size_t formatTime(const DateTime& value, uint32_t fractionDigits, char* buffer);
+};
+
+}
+}
+#endif
@@ -0,0 +1,174 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+
+#include "DecimalCodec.h"
+#include "Exception.hpp"
+
+namespace sql
+{
+namespace mariadb
+{
+  static const uint64_t lowMask= 0xffffffffULL;
+  // 10^38 is the first value, that does not fit MAX_DIGITS, 0x4b3b4ca85a86c47a098a224000000000
+  static const uint64_t limitHigh= 0x4b3b4ca85a86c47aULL, limitLow= 0x098a224000000000ULL;
+
+
+  /* value= value*10 + digit. The value must stay below 10^38, callers ensure it counting the digits */
+  static inline void mul10Add(Decimal& value, uint32_t digit)
+  {
+    uint64_t lowHigh= (value.low >> 32)*10, lowLow= (value.low & lowMask)*10;
+    uint64_t carry= (lowHigh >> 32) + (((lowHigh & lowMask) + (lowLow >> 32)) >> 32);
+
+    value.low= (lowHigh << 32) + lowLow;
+    value.low+= digit;
+    if (value.low < digit) {
+      ++carry;
+    }
+    value.high= value.high*10 + carry;
+  }
+
+  /* value= value/10, returns the remainder. Long division by 32 bits limbs */
+  static inline uint32_t divMod10(uint64_t& high, uint64_t& low)
+  {
+    uint64_t remainder= 0;
+    uint32_t limbs[]= {static_cast<uint32_t>(high >> 32), static_cast<uint32_t>(high & lowMask),
+                       static_cast<uint32_t>(low >> 32), static_cast<uint32_t>(low & lowMask)};
+
+    for (auto& limb : limbs) {
+      uint64_t current= (remainder << 32) | limb;
+      limb= static_cast<uint32_t>(current / 10);
+      remainder= current % 10;
+    }
+    high= (static_cast<uint64_t>(limbs[0]) << 32) | limbs[1];
+    low= (static_cast<uint64_t>(limbs[2]) << 32) | limbs[3];
+    return static_cast<uint32_t>(remainder);
+  }
+
+
+  bool DecimalCodec::parse(const char* str, std::size_t length, Decimal& value)
+  {
+    const char* it= str, *end= str + length;
+    uint32_t digits= 0;
+    bool point= false, anyDigit= false;
+
+    value= Decimal();
+    if (it < end && (*it == '-' || *it == '+')) {
+      value.negative= *it == '-';
+      ++it;
+    }
+    if (it == end) {
+      return false;
+    }
+    for (; it < end; ++it) {
+      uint32_t digit= static_cast<unsigned char>(*it - '0');
+
+      if (digit < 10) {
+        anyDigit= true;
+        // Leading zeros don't count
+        if (digits > 0 || digit != 0) {
+          if (++digits > MAX_DIGITS) {
+            return false;
+          }
+          mul10Add(value, digit);
+        }
+        else if (point && value.scale >= MAX_DIGITS) {
+          return false;
+        }
+        if (point) {
+          ++value.scale;
+        }
+      }
+      else if (*it == '.' && !point) {
+        point= true;
+      }
+      else {
+        return false;
+      }
+    }
+    if (!anyDigit) {
+      return false;
+    }
+    // Negative zero is the zero
+    if (value.high == 0 && value.low == 0) {
+      value.negative= false;
+    }
+    return true;
+  }
+
+
+  void DecimalCodec::fromInteger(int64_t integer, Decimal& value)
+  {
+    value= Decimal();
+    if (integer < 0) {
+      value.negative= true;
+      // Negating in unsigned arithmetic is defined for INT64_MIN as well
+      value.low= 0 - static_cast<uint64_t>(integer);
+    }
+    else {
+      value.low= static_cast<uint64_t>(integer);
+    }
+  }
+
+
+  void DecimalCodec::fromInteger(uint64_t integer, Decimal& value)
+  {
+    value= Decimal();
+    value.low= integer;
+  }
+
+
+  std::size_t DecimalCodec::format(const Decimal& value, char* buffer)
+  {
+    char digits[MAX_DIGITS];
+    uint64_t high= value.high, low= value.low;
+    uint32_t count= 0;
+    char* out= buffer;
+
+    if (value.scale > MAX_DIGITS || high > limitHigh || (high == limitHigh && low >= limitLow)) {
+      throw SQLException("Decimal value is out of range", "22003");
+    }
+    // Digits are produced from the lowest one
+    while (high != 0 || low != 0) {
+      digits[count++]= static_cast<char>('0' + divMod10(high, low));
+    }
+    if (value.negative && count > 0) {
+      *out++= '-';
+    }
+    if (count <= value.scale) {
+      *out++= '0';
+      if (value.scale > 0) {
+        *out++= '.';
+        for (uint32_t i= count; i < value.scale; ++i) {
+          *out++= '0';
+        }
+      }
+    }
+    while (count > 0) {
+      if (count == value.scale && out > buffer && *(out - 1) != '.') {
+        *out++= '.';
+      }
+      *out++= digits[--count];
+    }
+    return out - buffer;
+  }
+
+}
+}
@@ -0,0 +1,55 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+
+#ifndef _DECIMALCODEC_H_
+#define _DECIMALCODEC_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "ResultSet.hpp"
+
+namespace sql
+{
+namespace mariadb
+{
+
+/* Conversions of the Decimal, i.e. 128 bits scaled integer, from and to the text representation of DECIMAL values
+   "[-]D*[.D*]", done on raw bytes with 64 bits arithmetic. Values with more than MAX_DIGITS digits don't fit */
+class DecimalCodec final
+{
+public:
+  static constexpr uint32_t MAX_DIGITS= 38;
+  /* Enough for the sign, MAX_DIGITS digits, the point and the leading zero */
+  static constexpr std::size_t MAX_LENGTH= MAX_DIGITS + 3;
+
+  /* Returns false, if the string is not a decimal number, or has too many digits */
+  static bool parse(const char* str, std::size_t length, Decimal& value);
+  static void fromInteger(int64_t integer, Decimal& value);
+  static void fromInteger(uint64_t integer, Decimal& value);
+  /* Writes the value to the buffer of at least MAX_LENGTH bytes, and returns the length of the value. The terminating
+     null is not written. Throws SQLException, if the value is out of range */
+  static std::size_t format(const Decimal& value, char* buffer);
+};
+
+}
+}
+#endif
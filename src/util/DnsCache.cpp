@@ -0,0 +1,194 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#include <cstring>
+
+#ifdef _WIN32
+# include <winsock2.h>
+# include <ws2tcpip.h>
+#else
+# include <netdb.h>
+# include <sys/socket.h>
+#endif
+
+#include "DnsCache.h"
+
+namespace sql
+{
+namespace mariadb
+{
+  constexpr int32_t DnsCache::REFRESH_SHARE;
+
+
+  DnsCache& DnsCache::getInstance()
+  {
+    static DnsCache theInstance;
+    return theInstance;
+  }
+
+
+  DnsCache::~DnsCache()
+  {
+    {
+      std::lock_guard<std::mutex> localScopeLock(lock);
+      stopping= true;
+    }
+    refresherWakeup.notify_all();
+    if (refresher.joinable()) {
+      refresher.join();
+    }
+  }
+
+
+  std::string DnsCache::lookup(const std::string& host)
+  {
+#ifdef _WIN32
+    static const bool wsaStarted= []() {
+      WSADATA wsaData;
+      return WSAStartup(MAKEWORD(2, 2), &wsaData) == 0;
+    }();
+    if (!wsaStarted) {
+      return "";
+    }
+#endif
+    struct addrinfo hints, *result= nullptr;
+    char address[64];
+
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family= AF_UNSPEC;
+    hints.ai_socktype= SOCK_STREAM;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0 || result == nullptr) {
+      return "";
+    }
+    // The first address is the one, that the C library would connect first
+    bool found= getnameinfo(result->ai_addr, static_cast<socklen_t>(result->ai_addrlen), address, sizeof(address),
+      nullptr, 0, NI_NUMERICHOST) == 0;
+    freeaddrinfo(result);
+
+    return found ? std::string(address) : std::string();
+  }
+
+
+  SQLString DnsCache::resolve(const SQLString& host, std::chrono::milliseconds ttl)
+  {
+    const std::string& name= StringImp::get(host);
+    auto now= std::chrono::steady_clock::now();
+    {
+      std::lock_guard<std::mutex> localScopeLock(lock);
+      auto it= entries.find(name);
+
+      if (it != entries.end() && it->second.expires > now) {
+        Entry& entry= it->second;
+        if (!entry.refreshing && entry.expires - now < entry.ttl / REFRESH_SHARE) {
+          entry.refreshing= true;
+          refreshQueue.push_back(name);
+          if (!refresher.joinable()) {
+            refresher= std::thread(&DnsCache::refreshing, this);
+          }
+          else {
+            refresherWakeup.notify_all();
+          }
+        }
+        return entry.address;
+      }
+    }
+
+    std::string address(lookup(name));
+    if (address.empty()) {
+      return SQLString();
+    }
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    Entry& entry= entries[name];
+    entry.address= address;
+    entry.ttl= ttl;
+    entry.expires= now + ttl;
+
+    return address;
+  }
+
+
+  void DnsCache::prefetch(const std::vector<SQLString>& hosts, std::chrono::milliseconds ttl)
+  {
+    for (auto& host : hosts) {
+      resolve(host, ttl);
+    }
+  }
+
+
+  void DnsCache::invalidate(const SQLString& host)
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    auto it= entries.find(StringImp::get(host));
+    // The refresh in progress needs its entry
+    if (it != entries.end() && !it->second.refreshing) {
+      entries.erase(it);
+    }
+  }
+
+
+  void DnsCache::clear()
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    for (auto it= entries.begin(); it != entries.end();) {
+      if (it->second.refreshing) {
+        ++it;
+      }
+      else {
+        it= entries.erase(it);
+      }
+    }
+  }
+
+  /* Refresher's thread. Names are resolved with no lock held */
+  void DnsCache::refreshing()
+  {
+    std::unique_lock<std::mutex> localScopeLock(lock);
+
+    while (!stopping) {
+      if (refreshQueue.empty()) {
+        refresherWakeup.wait(localScopeLock);
+        continue;
+      }
+      std::string name(std::move(refreshQueue.back()));
+      refreshQueue.pop_back();
+
+      localScopeLock.unlock();
+      std::string address(lookup(name));
+      auto now= std::chrono::steady_clock::now();
+      localScopeLock.lock();
+
+      auto it= entries.find(name);
+      if (it == entries.end()) {
+        continue;
+      }
+      Entry& entry= it->second;
+      if (address.empty()) {
+        entries.erase(it);
+      }
+      else {
+        entry.address= address;
+        entry.expires= now + entry.ttl;
+        entry.refreshing= false;
+      }
+    }
+  }
+
+}
+}
@@ -0,0 +1,83 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _DNSCACHE_H_
+#define _DNSCACHE_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "StringImp.h"
+
+namespace sql
+{
+namespace mariadb
+{
+
+/* Process wide cache of host names resolution(dnsCacheTtl option), shared by all connection attempts to the host,
+   so a reconnect storm costs one lookup per host and TTL. Entries are refreshed by the background thread, when they
+   are used in the last 1/REFRESH_SHARE of their TTL, so the hot hosts never wait for the resolver. Entries, that fail to
+   refresh, or are found stale by a failed connect, are dropped, and the next attempt resolves the name again.
+   Failed resolution is not cached */
+class DnsCache final
+{
+  static constexpr int32_t REFRESH_SHARE= 5;
+
+  struct Entry
+  {
+    std::string address;
+    std::chrono::milliseconds ttl;
+    std::chrono::steady_clock::time_point expires;
+    bool refreshing= false;
+  };
+
+  std::mutex lock;
+  std::unordered_map<std::string, Entry> entries;
+  std::vector<std::string> refreshQueue;
+  std::condition_variable refresherWakeup;
+  std::thread refresher;
+  bool stopping= false;
+
+  DnsCache() {}
+  ~DnsCache();
+  /* Returns empty string, if the name cannot be resolved */
+  static std::string lookup(const std::string& host);
+  void refreshing();
+
+public:
+  static DnsCache& getInstance();
+
+  /* The numeric address of the host. Empty, if it cannot be resolved, and the name has to be used */
+  SQLString resolve(const SQLString& host, std::chrono::milliseconds ttl);
+  /* Resolves the hosts, that are not in the cache, e.g. at the pool start */
+  void prefetch(const std::vector<SQLString>& hosts, std::chrono::milliseconds ttl);
+  /* The address of the host has failed */
+  void invalidate(const SQLString& host);
+  void clear();
+};
+
+}
+}
+#endif
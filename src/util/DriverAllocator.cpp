@@ -0,0 +1,48 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#include "DriverAllocator.h"
+
+namespace sql
+{
+namespace mariadb
+{
+  std::atomic<Allocator*> DriverAllocator::current(nullptr);
+
+
+  void* DriverAllocator::allocateTagged(std::size_t size)
+  {
+    Allocator* allocator= get();
+    TagHeader* header= static_cast<TagHeader*>(allocate(allocator, sizeof(TagHeader) + size));
+    header->tag.allocator= allocator;
+    header->tag.size= sizeof(TagHeader) + size;
+    return header + 1;
+  }
+
+
+  void DriverAllocator::deallocateTagged(void* ptr)
+  {
+    if (ptr != nullptr) {
+      TagHeader* header= static_cast<TagHeader*>(ptr) - 1;
+      deallocate(header->tag.allocator, header, header->tag.size);
+    }
+  }
+}
+}
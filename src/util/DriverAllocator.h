@@ -0,0 +1,102 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _DRIVERALLOCATOR_H_
+#define _DRIVERALLOCATOR_H_
+
+#include <atomic>
+#include <cstddef>
+
+#include "Allocator.hpp"
+
+namespace sql
+{
+namespace mariadb
+{
+
+/* The allocator installed by Driver::setAllocator. Holders of the memory remember the allocator, that has given it,
+   since the installed one may change meanwhile. nullptr allocator means operator new */
+class DriverAllocator final
+{
+  static std::atomic<Allocator*> current;
+
+  /* Precedes the block of allocateTagged, keeping the alignment of operator new */
+  struct Tag
+  {
+    Allocator* allocator;
+    std::size_t size;
+  };
+  union TagHeader
+  {
+    Tag tag;
+    std::max_align_t align;
+  };
+
+public:
+  static void set(Allocator* allocator) { current.store(allocator, std::memory_order_release); }
+  static Allocator* get() { return current.load(std::memory_order_acquire); }
+
+  static void* allocate(Allocator* allocator, std::size_t size)
+  {
+    return allocator != nullptr ? allocator->allocate(size) : ::operator new(size);
+  }
+  static void deallocate(Allocator* allocator, void* ptr, std::size_t size)
+  {
+    if (allocator != nullptr) {
+      allocator->deallocate(ptr, size);
+    }
+    else {
+      ::operator delete(ptr);
+    }
+  }
+  /* For class specific operator new and delete - the block remembers its allocator and size */
+  static void* allocateTagged(std::size_t size);
+  static void deallocateTagged(void* ptr);
+
+  /* Standard library allocator over the allocator, that was installed, when it was created. E.g. for allocate_shared */
+  template <class T> class Std
+  {
+    template <class U> friend class Std;
+    Allocator* allocator;
+
+  public:
+    typedef T value_type;
+
+    Std() : allocator(get()) {}
+    template <class U> Std(const Std<U>& other) : allocator(other.allocator) {}
+
+    T* allocate(std::size_t n) { return static_cast<T*>(DriverAllocator::allocate(allocator, n*sizeof(T))); }
+    void deallocate(T* ptr, std::size_t n) { DriverAllocator::deallocate(allocator, ptr, n*sizeof(T)); }
+
+    template <class U> bool operator==(const Std<U>& other) const { return allocator == other.allocator; }
+    template <class U> bool operator!=(const Std<U>& other) const { return allocator != other.allocator; }
+  };
+};
+
+/* Base of the classes, whose objects are allocated by the installed allocator */
+struct DriverAllocated
+{
+  static void* operator new(std::size_t size) { return DriverAllocator::allocateTagged(size); }
+  static void operator delete(void* ptr) { DriverAllocator::deallocateTagged(ptr); }
+};
+
+}
+}
+#endif
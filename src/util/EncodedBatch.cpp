@@ -0,0 +1,64 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#include "EncodedBatch.h"
+
+#include "StringImp.h"
+#include "parameters/ParameterHolder.h"
+
+namespace sql
+{
+namespace mariadb
+{
+
+  void EncodedBatch::addRow(const std::vector<SQLString>& queryParts, std::vector<Shared::ParameterHolder>& parameters,
+    std::size_t paramCount)
+  {
+    std::size_t rowStart= buffer.length();
+
+    try {
+      buffer.append(queryParts[0]);
+      for (std::size_t i= 0; i < paramCount; ++i) {
+        parameters[i]->writeTo(buffer);
+        buffer.append(queryParts[i + 2]);
+      }
+    }
+    catch (...) {
+      StringImp::get(buffer).resize(rowStart);
+      throw;
+    }
+    rowEnds.push_back(buffer.length());
+  }
+
+
+  void EncodedBatch::clear()
+  {
+    std::string().swap(StringImp::get(buffer));
+    std::vector<std::size_t>().swap(rowEnds);
+  }
+
+
+  std::size_t EncodedBatch::getMemoryFootprint() const
+  {
+    return sizeof(*this) + StringImp::get(buffer).capacity() + rowEnds.capacity()*sizeof(std::size_t);
+  }
+
+}
+}
@@ -0,0 +1,60 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _ENCODEDBATCH_H_
+#define _ENCODEDBATCH_H_
+
+#include <vector>
+
+#include "Consts.h"
+
+namespace sql
+{
+namespace mariadb
+{
+
+/* Rows of the batch of the multi-values rewritable query, encoded at addBatch time(encodeBatchAtAdd option). Each row
+   is the values tuple of the query text with its parameters written as literals, e.g. "(1,'a')", and all rows are
+   kept back to back in one buffer. Thus the row costs its text length and an offset, instead of the vector of
+   parameter holders, and the rewritten query is assembled of the ready rows */
+class EncodedBatch final
+{
+  SQLString buffer;
+  // End of each row in the buffer
+  std::vector<std::size_t> rowEnds;
+
+public:
+  /* Appends the row. queryParts are the parts of the rewritable query, the row is the 1st part(the values tuple
+     start) followed by each parameter and the part after it. On error the buffer stays as it was */
+  void addRow(const std::vector<SQLString>& queryParts, std::vector<Shared::ParameterHolder>& parameters,
+    std::size_t paramCount);
+  std::size_t size() const { return rowEnds.size(); }
+  bool empty() const { return rowEnds.empty(); }
+  std::size_t rowOffset(std::size_t index) const { return index == 0 ? 0 : rowEnds[index - 1]; }
+  std::size_t rowLength(std::size_t index) const { return rowEnds[index] - rowOffset(index); }
+  const char* data() const { return buffer.c_str(); }
+  /* Clears the batch and releases its memory */
+  void clear();
+  std::size_t getMemoryFootprint() const;
+};
+
+}
+}
+#endif
@@ -0,0 +1,175 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#include <cerrno>
+#include <cstring>
+
+#include "ExportWriter.h"
+#include "SQLString.hpp"
+#include "Exception.hpp"
+
+#ifdef _WIN32
+# include <io.h>
+#else
+# include <unistd.h>
+#endif
+
+namespace sql
+{
+namespace mariadb
+{
+  static const char hexDigits[]= "0123456789abcdef";
+
+  ExportWriter::ExportWriter(int _fd, std::size_t bufferSize) :
+    fd(_fd),
+    buffer(bufferSize > 0 ? bufferSize : 64*1024),
+    used(0)
+  {
+  }
+
+
+  void ExportWriter::writeOut(const char* data, std::size_t length)
+  {
+    while (length > 0) {
+#ifdef _WIN32
+      int chunk= static_cast<int>(length > 0x40000000 ? 0x40000000 : length);
+      int res= _write(fd, data, chunk);
+#else
+      ssize_t res= ::write(fd, data, length);
+#endif
+      if (res < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        int error= errno;
+        throw SQLException(SQLString("Could not write the exported rows: ") + std::strerror(error), "HY000", error);
+      }
+      data+= res;
+      length-= static_cast<std::size_t>(res);
+    }
+  }
+
+
+  void ExportWriter::append(const char* data, std::size_t length)
+  {
+    if (length > buffer.size() - used) {
+      flush();
+      // Nothing to gain from copying the value, that does not fit the empty buffer
+      if (length >= buffer.size()) {
+        writeOut(data, length);
+        return;
+      }
+    }
+    std::memcpy(buffer.data() + used, data, length);
+    used+= length;
+  }
+
+
+  void ExportWriter::appendCsv(const char* value, std::size_t length, char separator)
+  {
+    const char* end= value + length;
+    const char* pos= value;
+
+    while (pos < end && *pos != separator && *pos != '"' && *pos != '\n' && *pos != '\r') {
+      ++pos;
+    }
+    if (pos == end) {
+      append(value, length);
+      return;
+    }
+    append('"');
+    const char* run= value;
+    for (pos= value; pos < end; ++pos) {
+      if (*pos == '"') {
+        append(run, pos - run + 1);
+        run= pos;
+      }
+    }
+    append(run, end - run);
+    append('"');
+  }
+
+
+  void ExportWriter::appendTsv(const char* value, std::size_t length)
+  {
+    const char* end= value + length;
+    const char* run= value;
+
+    for (const char* pos= value; pos < end; ++pos) {
+      char escaped;
+      switch (*pos) {
+      case '\t': escaped= 't'; break;
+      case '\n': escaped= 'n'; break;
+      case '\r': escaped= 'r'; break;
+      case '\0': escaped= '0'; break;
+      case '\\': escaped= '\\'; break;
+      default:
+        continue;
+      }
+      append(run, pos - run);
+      append('\\');
+      append(escaped);
+      run= pos + 1;
+    }
+    append(run, end - run);
+  }
+
+
+  void ExportWriter::appendJsonString(const char* value, std::size_t length)
+  {
+    const char* end= value + length;
+    const char* run= value;
+
+    append('"');
+    for (const char* pos= value; pos < end; ++pos) {
+      unsigned char c= static_cast<unsigned char>(*pos);
+      if (c >= 0x20 && c != '"' && c != '\\') {
+        continue;
+      }
+      append(run, pos - run);
+      append('\\');
+      switch (c) {
+      case '"': append('"'); break;
+      case '\\': append('\\'); break;
+      case '\n': append('n'); break;
+      case '\r': append('r'); break;
+      case '\t': append('t'); break;
+      default:
+        append("u00", 3);
+        append(hexDigits[c >> 4]);
+        append(hexDigits[c & 0x0f]);
+      }
+      run= pos + 1;
+    }
+    append(run, end - run);
+    append('"');
+  }
+
+
+  void ExportWriter::flush()
+  {
+    if (used > 0) {
+      std::size_t length= used;
+      used= 0;
+      writeOut(buffer.data(), length);
+    }
+  }
+}
+}
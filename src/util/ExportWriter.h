@@ -0,0 +1,64 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _EXPORTWRITER_H_
+#define _EXPORTWRITER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sql
+{
+namespace mariadb
+{
+
+/* Buffered writer of ResultSet::exportTo. Values are escaped into the buffer in runs of bytes, that need no escaping,
+   and the buffer is written to the file descriptor, when it's full. Throws SQLException, if the write fails */
+class ExportWriter final
+{
+  int fd;
+  std::vector<char> buffer;
+  std::size_t used;
+
+  void writeOut(const char* data, std::size_t length);
+
+public:
+  ExportWriter(int fd, std::size_t bufferSize);
+
+  void append(const char* data, std::size_t length);
+  void append(char c)
+  {
+    if (used == buffer.size()) {
+      flush();
+    }
+    buffer[used++]= c;
+  }
+  /* Quoted only if it contains the separator, quote, CR or LF */
+  void appendCsv(const char* value, std::size_t length, char separator);
+  void appendTsv(const char* value, std::size_t length);
+  /* With the quotes */
+  void appendJsonString(const char* value, std::size_t length);
+  void flush();
+};
+
+}
+}
+#endif
@@ -18,14 +18,12 @@
 *************************************************************************************/
 
 
-#include <sstream>
-#include <thread>
-
 #include "LogQueryTool.h"
 
 #include "parameters/ParameterHolder.h"
 #include "SqlStates.h"
 #include "PrepareResult.h"
+#include "MariaDBException.h"
 
 namespace sql
 {
@@ -86,26 +84,20 @@ namespace mariadb
   SQLException LogQueryTool::exceptionWithQuery(const SQLString& sql, SQLException& sqlException, bool explicitClosed)
   {
     if (explicitClosed) {
-      return SQLException("Connection has explicitly been closed/aborted.\nQuery is: " + subQuery(sql),
-        sqlException.getSQLState(),
+      SQLException closed("Connection has explicitly been closed/aborted.",
+        sqlException.getSQLStateCStr(),
         sqlException.getErrorCode(),
         sqlException.getCause());
+      ExceptionMessage::setQuery(closed, sql, options->maxQuerySizeToLog, nullptr);
+      return closed;
     }
 
     if (options->dumpQueriesOnException || sqlException.getErrorCode()==1064)
     {
-      std::stringstream str;
-      str << std::this_thread::get_id();
-
-      return SQLException(
-        sqlException.getMessage()
-        +"\nQuery is: "
-        + subQuery(sql)
-        +"\nThread: "
-        + str.str(),
-        sqlException.getSQLState(),
-        sqlException.getErrorCode(),
-        sqlException.getCause());
+      // The message with the query is built only if the application asks for it
+      SQLException withQuery(sqlException);
+      ExceptionMessage::setQuery(withQuery, sql, options->maxQuerySizeToLog, "\nThread: ");
+      return withQuery;
     }
     return sqlException;
   }
@@ -140,11 +132,11 @@ namespace mariadb
       return SQLException("Connection* timed out", CONNECTION_EXCEPTION.getSqlState(), 0, &sqlEx);
     }
     if (options->dumpQueriesOnException) {
-      return SQLException(
-        exWithQuery(sqlEx.getMessage(), serverPrepareResult, parameters),
-        sqlEx.getSQLState(),
-        sqlEx.getErrorCode(),
-        sqlEx.getCause());
+      SQLException withQuery(sqlEx);
+      // Parameters may change after the exception is thrown, thus they are formatted right away
+      ExceptionMessage::setQuery(withQuery, queryWithParameters(serverPrepareResult, parameters), options->maxQuerySizeToLog,
+        "\nThread: ");
+      return withQuery;
     }
     return sqlEx;
   }
@@ -159,70 +151,36 @@ namespace mariadb
   SQLException LogQueryTool::exceptionWithQuery(SQLException& sqlEx, PrepareResult* prepareResult)
   {
     if (options->dumpQueriesOnException ||sqlEx.getErrorCode()==1064) {
-      SQLString querySql(prepareResult->getSql());
-      SQLString message(sqlEx.getMessage());
-      if (options->maxQuerySizeToLog > 3 && querySql.size() > static_cast<std::size_t>(options->maxQuerySizeToLog - 3)) {
-        message.append("\nQuery is: "+querySql.substr(0, options->maxQuerySizeToLog -3)+"...");
-      }
-      else {
-        message.append("\nQuery is: "+querySql);
-      }
-
-      std::stringstream str;
-
-      str << std::this_thread::get_id();
-      message.append("\nthread id: ").append(str.str());
-
-      return SQLException(message, sqlEx.getSQLState(), sqlEx.getErrorCode(), sqlEx.getCause());
+      SQLException withQuery(sqlEx);
+      ExceptionMessage::setQuery(withQuery, prepareResult->getSql(), options->maxQuerySizeToLog, "\nthread id: ");
+      return withQuery;
     }
     return sqlEx;
   }
 
   /**
-    * Return exception message with query.
+    * Return query with parameters values.
     *
-    * @param message current exception message
     * @param serverPrepareResult prepare result
     * @param parameters query parameters
-    * @return exception message with query
+    * @return query with parameters
     */
-  SQLString LogQueryTool::exWithQuery(const SQLString& message, PrepareResult* serverPrepareResult, std::vector<Shared::ParameterHolder>& parameters)
+  SQLString LogQueryTool::queryWithParameters(PrepareResult* serverPrepareResult, std::vector<Shared::ParameterHolder>& parameters)
   {
-    if (options->dumpQueriesOnException) {
-      SQLString sql(serverPrepareResult->getSql());
-      if (serverPrepareResult->getParamCount() > 0) {
-        sql.append(", parameters [");
-        if (parameters.size() > 0) {
-          for (size_t i= 0;
-            i < std::min(parameters.size(), serverPrepareResult->getParamCount());
-            i++) {
-            sql.append(parameters[i]->toString()).append(",");
-          }
-          sql= sql.substr(0, sql.length() - 1);
+    SQLString sql(serverPrepareResult->getSql());
+    if (serverPrepareResult->getParamCount() > 0) {
+      sql.append(", parameters [");
+      if (parameters.size() > 0) {
+        for (size_t i= 0;
+          i < std::min(parameters.size(), serverPrepareResult->getParamCount());
+          i++) {
+          sql.append(parameters[i]->toString()).append(",");
         }
-        sql.append("]");
-      }
-
-      std::stringstream str;
-      str << std::this_thread::get_id();
-
-      if (options->maxQuerySizeToLog > 3 && sql.size() > static_cast<std::size_t>(options->maxQuerySizeToLog - 3)) {
-        return message
-          +"\nQuery is: "
-          +sql.substr(0, options->maxQuerySizeToLog -3)
-          +"..."
-          "\nThread: "
-          +str.str();
-      }
-      else {
-        return message
-          +"\nQuery is: "
-          +sql
-          +"\nThread: "
-          +str.str();
+        sql= sql.substr(0, sql.length() - 1);
       }
+      sql.append("]");
     }
-    return message;
+    return sql;
   }
 }
 }
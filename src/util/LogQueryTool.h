@@ -48,7 +48,7 @@ public:
   SQLException exceptionWithQuery(SQLException& sqlEx, PrepareResult* prepareResult);
 
 private:
-  SQLString exWithQuery(const SQLString& message, PrepareResult* serverPrepareResult, std::vector<Shared::ParameterHolder>& parameters);
+  SQLString queryWithParameters(PrepareResult* serverPrepareResult, std::vector<Shared::ParameterHolder>& parameters);
   };
 }
 }
@@ -0,0 +1,112 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#include <string>
+
+#include "MemoryAccounting.h"
+#include "ClientPrepareResultCache.h"
+#include "MetadataCache.h"
+#include "Exception.hpp"
+
+namespace sql
+{
+namespace mariadb
+{
+
+  bool MemoryAccount::tryReserve(std::size_t bytes)
+  {
+    uint64_t current= used.load(std::memory_order_relaxed), max= limit.load(std::memory_order_relaxed);
+
+    do {
+      if (max > 0 && current + bytes > max) {
+        return false;
+      }
+    } while (!used.compare_exchange_weak(current, current + bytes, std::memory_order_relaxed));
+    return true;
+  }
+
+
+  MemoryAccounting& MemoryAccounting::getInstance()
+  {
+    static MemoryAccounting theInstance;
+    return theInstance;
+  }
+
+
+  void MemoryAccounting::resized(Kind kind, std::size_t before, std::size_t after)
+  {
+    if (after > before) {
+      get(kind).add(after - before);
+    }
+    else if (after < before) {
+      get(kind).release(before - after);
+    }
+  }
+
+
+  void MemoryAccounting::snapshot(MemoryUsage& usage) const
+  {
+    usage.resultSets= accounts[RESULT_SETS].getUsed();
+    usage.largeValues= accounts[LARGE_VALUES].getUsed();
+    usage.prepareCaches= ClientPrepareResultCache::getInstance().getBytes();
+    usage.metadataCache= MetadataCache::getInstance().getBytes();
+    usage.connectionBuffers= accounts[CONNECTION_BUFFERS].getUsed();
+    usage.resultSetsLimit= accounts[RESULT_SETS].getLimit();
+  }
+
+
+  void MemoryReservation::resize(std::size_t newSize)
+  {
+    if (newSize <= bytes) {
+      std::size_t freed= bytes - newSize;
+      if (connectionAccount) {
+        connectionAccount->release(freed);
+      }
+      MemoryAccounting::get(MemoryAccounting::RESULT_SETS).release(freed);
+      bytes= newSize;
+      return;
+    }
+    std::size_t delta= newSize - bytes;
+    MemoryAccount& global= MemoryAccounting::get(MemoryAccounting::RESULT_SETS);
+
+    if (connectionAccount && !connectionAccount->tryReserve(delta)) {
+      std::string msg("Result set memory limit of the connection(maxResultSetMemory) of "
+        + std::to_string(connectionAccount->getLimit() >> 20) + "MB is exceeded");
+      throw SQLException(msg.c_str(), "HY001");
+    }
+    if (!global.tryReserve(delta)) {
+      if (connectionAccount) {
+        connectionAccount->release(delta);
+      }
+      std::string msg("Result sets memory limit of the process of " + std::to_string(global.getLimit())
+        + " bytes is exceeded");
+      throw SQLException(msg.c_str(), "HY001");
+    }
+    bytes= newSize;
+  }
+
+
+  void MemoryReservation::release()
+  {
+    resize(0);
+  }
+
+}
+}
@@ -0,0 +1,103 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _MEMORYACCOUNTING_H_
+#define _MEMORYACCOUNTING_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "Metrics.hpp"
+
+namespace sql
+{
+namespace mariadb
+{
+
+/* Bytes the driver holds for a connection, or for the whole process. Reservation, that would take the account over
+   its limit, fails. 0 limit is no limit */
+class MemoryAccount final
+{
+  std::atomic<uint64_t> used{0};
+  std::atomic<uint64_t> limit;
+
+public:
+  explicit MemoryAccount(uint64_t _limit= 0) : limit(_limit) {}
+
+  /* Nothing is taken, if false is returned */
+  bool tryReserve(std::size_t bytes);
+  void add(std::size_t bytes) { used.fetch_add(bytes, std::memory_order_relaxed); }
+  void release(std::size_t bytes) { used.fetch_sub(bytes, std::memory_order_relaxed); }
+  uint64_t getUsed() const { return used.load(std::memory_order_relaxed); }
+  uint64_t getLimit() const { return limit.load(std::memory_order_relaxed); }
+  void setLimit(uint64_t bytes) { limit.store(bytes, std::memory_order_relaxed); }
+};
+
+/* Process wide accounts of the memory by its kind. Only result sets' account has the limit(Driver::setMemoryLimit).
+   The process wide caches count their bytes themselves, and the snapshot takes them from there */
+class MemoryAccounting final
+{
+public:
+  enum Kind {
+    RESULT_SETS= 0,
+    LARGE_VALUES,
+    CONNECTION_BUFFERS,
+    KIND_COUNT
+  };
+
+private:
+  std::array<MemoryAccount, KIND_COUNT> accounts;
+
+  MemoryAccounting() {}
+
+public:
+  static MemoryAccounting& getInstance();
+  static MemoryAccount& get(Kind kind) { return getInstance().accounts[kind]; }
+  /* Adds the size change of the buffer of the kind */
+  static void resized(Kind kind, std::size_t before, std::size_t after);
+  void snapshot(MemoryUsage& usage) const;
+};
+
+/* Stored rows of a result set, reserved in the connection's account(maxResultSetMemory), and in the process wide one.
+   The reservation is returned, when the object is destroyed */
+class MemoryReservation final
+{
+  std::shared_ptr<MemoryAccount> connectionAccount;
+  std::size_t bytes= 0;
+
+  MemoryReservation(const MemoryReservation&)= delete;
+  MemoryReservation& operator=(const MemoryReservation&)= delete;
+
+public:
+  MemoryReservation() {}
+  ~MemoryReservation() { release(); }
+
+  void setAccount(const std::shared_ptr<MemoryAccount>& account) { connectionAccount= account; }
+  std::size_t size() const { return bytes; }
+  /* Throws SQLException with HY001 state and keeps the reserved size, if any of the limits would be exceeded */
+  void resize(std::size_t newSize);
+  void release();
+};
+
+}
+}
+#endif
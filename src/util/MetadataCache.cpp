@@ -0,0 +1,234 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#include <cctype>
+
+#include "MetadataCache.h"
+#include "ResultSet.hpp"
+#include "ResultSetMetaData.hpp"
+#include "SelectResultSet.h"
+#include "Probes.h"
+
+namespace sql
+{
+namespace mariadb
+{
+  std::atomic<bool> MetadataCache::used(false);
+
+  static char emptyValue[]= "";
+  static const char* ddlKeywords[]= {"CREATE", "ALTER", "DROP", "RENAME", "TRUNCATE"};
+
+
+  void MetadataCache::Entry::fill(ResultSet* rs)
+  {
+    sql::ResultSetMetaData& md= rs->getMetaDataView();
+    uint32_t columnCount= md.getColumnCount();
+
+    for (uint32_t i= 1; i <= columnCount; ++i) {
+      columnNames.push_back(md.getColumnLabel(i));
+      columnTypes.push_back(ColumnType::toServer(md.getColumnType(i)));
+      bytes+= sizeof(SQLString) + columnNames.back().length() + sizeof(ColumnType);
+    }
+    while (rs->next()) {
+      rows.emplace_back();
+      std::vector<sql::bytes>& row= rows.back();
+      row.reserve(columnCount);
+
+      for (uint32_t i= 1; i <= columnCount; ++i) {
+        SQLString value(rs->getString(i));
+        if (rs->wasNull()) {
+          row.emplace_back(0);
+        }
+        else if (value.empty()) {
+          row.emplace_back(emptyValue, 0);
+        }
+        else {
+          row.emplace_back(value.c_str(), value.length());
+        }
+        bytes+= sizeof(sql::bytes) + row.back().size();
+      }
+      bytes+= sizeof(row);
+    }
+  }
+
+
+  ResultSet* MetadataCache::Entry::createResultSet(Protocol* protocol) const
+  {
+    return SelectResultSet::createResultSet(columnNames, columnTypes, rows, protocol);
+  }
+
+
+  /* If the text at pos starts with the keyword, that is not the part of a longer word */
+  static bool isKeyword(const char* pos, const char* end, const char* keyword)
+  {
+    for (; *keyword != '\0'; ++keyword, ++pos) {
+      if (pos == end || std::toupper(static_cast<unsigned char>(*pos)) != *keyword) {
+        return false;
+      }
+    }
+    return pos == end || !(std::isalnum(static_cast<unsigned char>(*pos)) || *pos == '_');
+  }
+
+
+  MetadataCache& MetadataCache::getInstance()
+  {
+    static MetadataCache theInstance;
+    return theInstance;
+  }
+
+
+  std::string MetadataCache::hostKey(const HostAddress& host)
+  {
+    std::string key(StringImp::get(host.host));
+    key.push_back(':');
+    return key.append(std::to_string(host.port));
+  }
+
+
+  bool MetadataCache::isDdl(const char* sql, std::size_t length)
+  {
+    const char* it= sql, *end= sql + length;
+
+    while (it < end) {
+      if (std::isspace(static_cast<unsigned char>(*it))) {
+        ++it;
+      }
+      else if (*it == '#' || (*it == '-' && end - it > 2 && *(it + 1) == '-' && std::isspace(static_cast<unsigned char>(*(it + 2))))) {
+        while (it < end && *it != '\n') {
+          ++it;
+        }
+      }
+      else if (*it == '/' && end - it > 1 && *(it + 1) == '*') {
+        // Executable comment's content is the part of the query, only its start is skipped
+        if (end - it > 2 && (*(it + 2) == '!' || (*(it + 2) == 'M' && end - it > 3 && *(it + 3) == '!'))) {
+          it+= *(it + 2) == '!' ? 3 : 4;
+          while (it < end && std::isdigit(static_cast<unsigned char>(*it))) {
+            ++it;
+          }
+          continue;
+        }
+        it+= 2;
+        while (it < end - 1 && !(*it == '*' && *(it + 1) == '/')) {
+          ++it;
+        }
+        if (it >= end - 1) {
+          return false;
+        }
+        it+= 2;
+      }
+      else {
+        break;
+      }
+    }
+
+    for (auto keyword : ddlKeywords) {
+      if (isKeyword(it, end, keyword)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+
+  std::shared_ptr<const MetadataCache::Entry> MetadataCache::get(const std::string& host, const std::string& key)
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    auto hostIt= hosts.find(host);
+
+    if (hostIt == hosts.end()) {
+      MARIADB_PROBE1(cache__miss, "metadata");
+      return nullptr;
+    }
+    auto it= hostIt->second.find(key);
+    if (it == hostIt->second.end()) {
+      MARIADB_PROBE1(cache__miss, "metadata");
+      return nullptr;
+    }
+    if (it->second->expires <= std::chrono::steady_clock::now()) {
+      hostIt->second.erase(it);
+      MARIADB_PROBE1(cache__miss, "metadata");
+      return nullptr;
+    }
+    MARIADB_PROBE1(cache__hit, "metadata");
+    return it->second;
+  }
+
+
+  void MetadataCache::put(const std::string& host, const std::string& key, std::shared_ptr<const Entry> entry)
+  {
+    auto now= std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    HostEntries& entries= hosts[host];
+
+    // Dropping expired entries of the host keeps the memory bounded by the requests, that are still in use
+    for (auto it= entries.begin(); it != entries.end();) {
+      if (it->second->expires <= now) {
+        it= entries.erase(it);
+      }
+      else {
+        ++it;
+      }
+    }
+    entries[key]= std::move(entry);
+    used.store(true, std::memory_order_relaxed);
+  }
+
+
+  void MetadataCache::invalidate(const std::string& host)
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    hosts.erase(host);
+  }
+
+
+  void MetadataCache::clear()
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    hosts.clear();
+  }
+
+
+  std::size_t MetadataCache::size()
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    std::size_t result= 0;
+
+    for (auto& it : hosts) {
+      result+= it.second.size();
+    }
+    return result;
+  }
+
+
+  std::size_t MetadataCache::getBytes()
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    std::size_t result= 0;
+
+    for (auto& it : hosts) {
+      for (auto& entry : it.second) {
+        result+= entry.first.length() + entry.second->bytes;
+      }
+    }
+    return result;
+  }
+
+}
+}
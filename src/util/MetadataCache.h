@@ -0,0 +1,104 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _METADATACACHE_H_
+#define _METADATACACHE_H_
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Consts.h"
+#include "ColumnType.h"
+#include "HostAddress.h"
+
+namespace sql
+{
+namespace mariadb
+{
+
+/* Process wide cache of DatabaseMetaData results and stored routines parameters, shared by the connections to the same
+   host. The key is the request, i.e. the method, its arguments and the current database. Each entry lives for the TTL
+   given with it, i.e. the metadataCacheTtl option of the connection, that has stored it. DDL executed on the host by any connection
+   of the process drops all entries of the host. Before that the cache cannot see schema changes, thus entries may
+   carry the validation token - the caller may compare it with the current one before using the entry */
+class MetadataCache final
+{
+public:
+  struct Entry
+  {
+    std::chrono::steady_clock::time_point expires;
+    std::vector<SQLString> columnNames;
+    std::vector<ColumnType> columnTypes;
+    /* Values in the text protocol representation. NULL has no array, and empty values wrap the static empty string,
+       since the owning array cannot have zero length */
+    std::vector<std::vector<sql::bytes>> rows;
+    SQLString token;
+    /* Estimated memory of the entry, counted by fill */
+    std::size_t bytes= sizeof(Entry);
+
+    /* Copies the remaining rows of the result */
+    void fill(ResultSet* rs);
+    /* The caller owns the result */
+    ResultSet* createResultSet(Protocol* protocol) const;
+  };
+
+private:
+  typedef std::unordered_map<std::string, std::shared_ptr<const Entry>> HostEntries;
+
+  /* Nothing has to be checked, while nothing has been cached */
+  static std::atomic<bool> used;
+
+  std::mutex lock;
+  std::map<std::string, HostEntries> hosts;
+
+  MetadataCache() {}
+
+public:
+  static MetadataCache& getInstance();
+  static std::string hostKey(const HostAddress& host);
+  /* If the query is CREATE, ALTER, DROP, RENAME or TRUNCATE, ignoring leading spaces and comments */
+  static bool isDdl(const char* sql, std::size_t length);
+  /* To be called for every query sent to the host */
+  static void queryExecuted(const HostAddress& host, const char* sql, std::size_t length)
+  {
+    if (used.load(std::memory_order_relaxed) && isDdl(sql, length)) {
+      getInstance().invalidate(hostKey(host));
+    }
+  }
+
+  /* Returns nullptr, if there is no entry, or it has expired */
+  std::shared_ptr<const Entry> get(const std::string& host, const std::string& key);
+  void put(const std::string& host, const std::string& key, std::shared_ptr<const Entry> entry);
+  void invalidate(const std::string& host);
+  void clear();
+  std::size_t size();
+  /* Estimated memory of all entries */
+  std::size_t getBytes();
+};
+
+}
+}
+#endif
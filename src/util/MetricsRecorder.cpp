@@ -0,0 +1,256 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#include <algorithm>
+#include <vector>
+
+#include "MetricsRecorder.h"
+
+namespace sql
+{
+namespace mariadb
+{
+  constexpr uint32_t LatencyHistogram::SUB_BITS;
+  constexpr uint32_t LatencyHistogram::SUB_COUNT;
+  constexpr uint32_t LatencyHistogram::MAX_BITS;
+  constexpr std::size_t LatencyHistogram::BUCKET_COUNT;
+
+  LatencyHistogram::LatencyHistogram()
+    : count(0)
+    , sum(0)
+    , max(0)
+  {
+    for (auto& bucket : buckets) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+  }
+
+
+  std::size_t LatencyHistogram::bucketOf(uint64_t value)
+  {
+    if (value < SUB_COUNT) {
+      return static_cast<std::size_t>(value);
+    }
+    if (value >= (1ULL << MAX_BITS)) {
+      return BUCKET_COUNT - 1;
+    }
+    // Position of the highest bit
+    uint32_t exponent= SUB_BITS;
+    for (uint32_t step= 16; step > 0; step>>= 1) {
+      if ((value >> (exponent + step)) != 0) {
+        exponent+= step;
+      }
+    }
+    uint64_t sub= (value >> (exponent - SUB_BITS)) & (SUB_COUNT - 1);
+    return static_cast<std::size_t>((exponent - SUB_BITS + 1)*SUB_COUNT + sub);
+  }
+
+
+  uint64_t LatencyHistogram::valueOf(std::size_t bucket)
+  {
+    if (bucket < SUB_COUNT) {
+      return bucket;
+    }
+    uint32_t shift= static_cast<uint32_t>(bucket/SUB_COUNT) - 1;
+    uint64_t lowest= (SUB_COUNT + bucket % SUB_COUNT) << shift;
+    return lowest + ((1ULL << shift) >> 1);
+  }
+
+
+  void LatencyHistogram::record(uint64_t micros)
+  {
+    buckets[bucketOf(micros)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(micros, std::memory_order_relaxed);
+
+    uint64_t current= max.load(std::memory_order_relaxed);
+    while (micros > current && !max.compare_exchange_weak(current, micros, std::memory_order_relaxed)) {
+    }
+  }
+
+
+  void LatencyHistogram::addTo(LatencyHistogram& total) const
+  {
+    for (std::size_t i= 0; i < BUCKET_COUNT; ++i) {
+      uint64_t value= buckets[i].load(std::memory_order_relaxed);
+      if (value != 0) {
+        total.buckets[i].fetch_add(value, std::memory_order_relaxed);
+      }
+    }
+    total.count.fetch_add(count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    total.sum.fetch_add(sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+    uint64_t micros= max.load(std::memory_order_relaxed), current= total.max.load(std::memory_order_relaxed);
+    while (micros > current && !total.max.compare_exchange_weak(current, micros, std::memory_order_relaxed)) {
+    }
+  }
+
+
+  void LatencyHistogram::summarize(LatencySummary& summary) const
+  {
+    static const double quantiles[]= {0.5, 0.9, 0.99, 0.999};
+    uint64_t* results[]= {&summary.p50, &summary.p90, &summary.p99, &summary.p999};
+
+    summary.sum= sum.load(std::memory_order_relaxed);
+    summary.max= max.load(std::memory_order_relaxed);
+    // Buckets may be updated meanwhile, thus count is taken from them, and not from the counter
+    uint64_t total= 0;
+    for (auto& bucket : buckets) {
+      total+= bucket.load(std::memory_order_relaxed);
+    }
+    summary.count= total;
+    if (total == 0) {
+      return;
+    }
+
+    uint64_t seen= 0;
+    std::size_t q= 0;
+    for (std::size_t i= 0; i < BUCKET_COUNT && q < 4; ++i) {
+      seen+= buckets[i].load(std::memory_order_relaxed);
+      while (q < 4 && seen >= static_cast<uint64_t>(quantiles[q]*total + 0.5)) {
+        *results[q]= std::min(valueOf(i), summary.max);
+        ++q;
+      }
+    }
+    for (; q < 4; ++q) {
+      *results[q]= summary.max;
+    }
+  }
+
+
+  void MetricsRecorder::addTo(MetricsRecorder& total) const
+  {
+    total.queries.fetch_add(queries.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    total.prepares.fetch_add(prepares.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    total.executes.fetch_add(executes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    total.roundTrips.fetch_add(roundTrips.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    total.bytesSent.fetch_add(bytesSent.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    total.bytesReceived.fetch_add(bytesReceived.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    total.rowsFetched.fetch_add(rowsFetched.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    total.prepareCacheHits.fetch_add(prepareCacheHits.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    total.prepareCacheMisses.fetch_add(prepareCacheMisses.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    total.reconnects.fetch_add(reconnects.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    total.bulkExecutes.fetch_add(bulkExecutes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    total.networkTime.fetch_add(networkTime.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    total.decodeTime.fetch_add(decodeTime.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    executionTime.addTo(total.executionTime);
+    poolWait.addTo(total.poolWait);
+    connectTime.addTo(total.connectTime);
+  }
+
+
+  void MetricsRecorder::snapshot(ConnectionMetrics& metrics) const
+  {
+    metrics.queries= queries.load(std::memory_order_relaxed);
+    metrics.prepares= prepares.load(std::memory_order_relaxed);
+    metrics.executes= executes.load(std::memory_order_relaxed);
+    metrics.roundTrips= roundTrips.load(std::memory_order_relaxed);
+    metrics.bytesSent= bytesSent.load(std::memory_order_relaxed);
+    metrics.bytesReceived= bytesReceived.load(std::memory_order_relaxed);
+    metrics.rowsFetched= rowsFetched.load(std::memory_order_relaxed);
+    metrics.prepareCacheHits= prepareCacheHits.load(std::memory_order_relaxed);
+    metrics.prepareCacheMisses= prepareCacheMisses.load(std::memory_order_relaxed);
+    metrics.reconnects= reconnects.load(std::memory_order_relaxed);
+    metrics.bulkExecutes= bulkExecutes.load(std::memory_order_relaxed);
+    metrics.networkTime= networkTime.load(std::memory_order_relaxed) / 1000;
+    metrics.decodeTime= decodeTime.load(std::memory_order_relaxed) / 1000;
+    executionTime.summarize(metrics.executionTime);
+    poolWait.summarize(metrics.poolWait);
+    connectTime.summarize(metrics.connectTime);
+  }
+
+
+  class MariaDbMetricsSnapshot final : public MetricsSnapshot
+  {
+    ConnectionMetrics total;
+    std::vector<SQLString> names;
+    std::vector<ConnectionMetrics> groups;
+
+  public:
+    MariaDbMetricsSnapshot(const std::map<std::string, MetricsRecorder>& group)
+    {
+      MetricsRecorder totalRecorder;
+      names.reserve(group.size());
+      groups.resize(group.size());
+
+      std::size_t i= 0;
+      for (auto& it : group) {
+        names.emplace_back(it.first);
+        it.second.snapshot(groups[i++]);
+        it.second.addTo(totalRecorder);
+      }
+      totalRecorder.snapshot(total);
+    }
+
+    const ConnectionMetrics& getTotal() { return total; }
+    std::size_t getGroupCount() { return groups.size(); }
+    const SQLString& getGroupName(std::size_t index) { return names.at(index); }
+    const ConnectionMetrics& getGroup(std::size_t index) { return groups.at(index); }
+  };
+
+
+  MetricsRegistry& MetricsRegistry::getInstance()
+  {
+    static MetricsRegistry theInstance;
+    return theInstance;
+  }
+
+
+  void MetricsRegistry::attach(MetricsRecorder* recorder, const std::string& group)
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    recorder->group= group;
+    live.insert(recorder);
+  }
+
+
+  void MetricsRegistry::detach(MetricsRecorder* recorder)
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    if (live.erase(recorder) > 0) {
+      recorder->addTo(retired[recorder->group]);
+    }
+  }
+
+
+  void MetricsRegistry::setGroup(MetricsRecorder* recorder, const std::string& group)
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    recorder->group= group;
+  }
+
+
+  MetricsSnapshot* MetricsRegistry::snapshot()
+  {
+    std::map<std::string, MetricsRecorder> group;
+    {
+      std::lock_guard<std::mutex> localScopeLock(lock);
+      for (auto& it : retired) {
+        it.second.addTo(group[it.first]);
+      }
+      for (auto recorder : live) {
+        recorder->addTo(group[recorder->group]);
+      }
+    }
+    return new MariaDbMetricsSnapshot(group);
+  }
+
+}
+}
@@ -0,0 +1,148 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _METRICSRECORDER_H_
+#define _METRICSRECORDER_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include "Metrics.hpp"
+
+namespace sql
+{
+namespace mariadb
+{
+
+/* HDR style histogram of microsecond latencies. Values below SUB_COUNT have bucket each, and every next power of two
+   range is split into SUB_COUNT buckets, so the relative error is within 1/SUB_COUNT at any scale. Values are
+   clamped at 2^MAX_BITS us(~71 min). Recording is few relaxed atomic increments */
+class LatencyHistogram final
+{
+  static constexpr uint32_t SUB_BITS= 4;
+  static constexpr uint32_t SUB_COUNT= 1 << SUB_BITS;
+  static constexpr uint32_t MAX_BITS= 32;
+  static constexpr std::size_t BUCKET_COUNT= (MAX_BITS - SUB_BITS + 1)*SUB_COUNT;
+
+  std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets;
+  std::atomic<uint64_t> count;
+  std::atomic<uint64_t> sum;
+  std::atomic<uint64_t> max;
+
+  static std::size_t bucketOf(uint64_t value);
+  /* The middle of the bucket's range */
+  static uint64_t valueOf(std::size_t bucket);
+
+public:
+  LatencyHistogram();
+
+  void record(uint64_t micros);
+  void addTo(LatencyHistogram& total) const;
+  void summarize(LatencySummary& summary) const;
+};
+
+/* Counters of one connection(i.e. protocol), or of the group of connections. The owner updates them lock-free,
+   readers take a snapshot of them relaxed, i.e. counters are not consistent with each other at the moment */
+struct MetricsRecorder final
+{
+  std::atomic<uint64_t> queries{0};
+  std::atomic<uint64_t> prepares{0};
+  std::atomic<uint64_t> executes{0};
+  std::atomic<uint64_t> roundTrips{0};
+  std::atomic<uint64_t> bytesSent{0};
+  std::atomic<uint64_t> bytesReceived{0};
+  std::atomic<uint64_t> rowsFetched{0};
+  std::atomic<uint64_t> prepareCacheHits{0};
+  std::atomic<uint64_t> prepareCacheMisses{0};
+  std::atomic<uint64_t> reconnects{0};
+  std::atomic<uint64_t> bulkExecutes{0};
+  /* In nanoseconds */
+  std::atomic<uint64_t> networkTime{0};
+  std::atomic<uint64_t> decodeTime{0};
+  LatencyHistogram executionTime;
+  LatencyHistogram poolWait;
+  LatencyHistogram connectTime;
+  /* Name of the group in MetricsRegistry, changed only under the registry lock */
+  std::string group;
+
+  static void increment(std::atomic<uint64_t>& counter, uint64_t value= 1) {
+    counter.fetch_add(value, std::memory_order_relaxed);
+  }
+  void query(std::size_t length) {
+    increment(queries);
+    increment(bytesSent, length);
+  }
+  void roundTrip() { increment(roundTrips); }
+  void rowFetched(std::size_t length) {
+    increment(rowsFetched);
+    increment(bytesReceived, length);
+  }
+  void addTo(MetricsRecorder& total) const;
+  void snapshot(ConnectionMetrics& metrics) const;
+};
+
+/* Adds the time of its scope to the nanoseconds counter */
+class MetricsTimer final
+{
+  std::atomic<uint64_t>& counter;
+  const std::chrono::steady_clock::time_point start;
+
+public:
+  explicit MetricsTimer(std::atomic<uint64_t>& _counter)
+    : counter(_counter)
+    , start(std::chrono::steady_clock::now())
+  {}
+  ~MetricsTimer()
+  {
+    MetricsRecorder::increment(counter, static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()));
+  }
+};
+
+/* Process wide registry of recorders of live connections and pools. Counters of a destroyed recorder are added to
+   its group's totals, so they do not disappear from the snapshot. Only attaching, detaching and snapshot take the
+   lock, the hot path does not */
+class MetricsRegistry final
+{
+  std::mutex lock;
+  std::set<MetricsRecorder*> live;
+  std::map<std::string, MetricsRecorder> retired;
+
+  MetricsRegistry() {}
+
+public:
+  static MetricsRegistry& getInstance();
+
+  void attach(MetricsRecorder* recorder, const std::string& group= "");
+  void detach(MetricsRecorder* recorder);
+  void setGroup(MetricsRecorder* recorder, const std::string& group);
+  /* The caller owns the snapshot */
+  MetricsSnapshot* snapshot();
+};
+
+}
+}
+#endif
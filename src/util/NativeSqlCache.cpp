@@ -0,0 +1,112 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#include "NativeSqlCache.h"
+#include "Utils.h"
+#include "Protocol.h"
+
+namespace sql
+{
+namespace mariadb
+{
+  std::size_t NativeSqlCache::entrySize(const LruList::value_type& entry)
+  {
+    return sizeof(LruList::value_type) + entry.first.length() + entry.second.length();
+  }
+
+
+  NativeSqlCache::NativeSqlCache()
+    : bytes(0)
+  {
+  }
+
+
+  NativeSqlCache& NativeSqlCache::getInstance()
+  {
+    static NativeSqlCache theInstance;
+    return theInstance;
+  }
+
+  /* Has to be called under the lock */
+  void NativeSqlCache::shrink(std::size_t maxBytes)
+  {
+    while (bytes > maxBytes && !lru.empty()) {
+      auto& eldest= lru.back();
+      bytes-= entrySize(eldest);
+      index.erase(eldest.first);
+      lru.pop_back();
+    }
+  }
+
+
+  SQLString NativeSqlCache::get(const SQLString& sql, Protocol* protocol, std::size_t maxBytes)
+  {
+    if (maxBytes == 0) {
+      return Utils::nativeSql(sql, protocol);
+    }
+    std::string key(StringImp::get(sql));
+    key.push_back(protocol->noBackslashEscapes() ? '1' : '0');
+    {
+      std::lock_guard<std::mutex> localScopeLock(lock);
+      auto it= index.find(key);
+
+      if (it != index.end()) {
+        lru.splice(lru.begin(), lru, it->second);
+        return it->second->second;
+      }
+    }
+    // Invalid escape throws here, and such query is not cached
+    SQLString result(Utils::nativeSql(sql, protocol));
+
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    if (index.find(key) != index.end()) {
+      return result;
+    }
+    lru.emplace_front(std::move(key), result);
+    std::size_t size= entrySize(lru.front());
+
+    if (size > maxBytes) {
+      lru.pop_front();
+      return result;
+    }
+    index.emplace(lru.front().first, lru.begin());
+    bytes+= size;
+    shrink(maxBytes);
+
+    return result;
+  }
+
+
+  void NativeSqlCache::clear()
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    index.clear();
+    lru.clear();
+    bytes= 0;
+  }
+
+
+  std::size_t NativeSqlCache::size()
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    return lru.size();
+  }
+}
+}
@@ -0,0 +1,63 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _NATIVESQLCACHE_H_
+#define _NATIVESQLCACHE_H_
+
+#include <unordered_map>
+#include <list>
+#include <mutex>
+
+#include "Consts.h"
+
+namespace sql
+{
+namespace mariadb
+{
+
+/* Process wide cache of queries with JDBC escapes rewritten by Utils::nativeSql, shared by all connections. The key is
+   the query plus the noBackslashEscapes flag, that is the only connection property the rewrite depends on. Queries
+   without escapes never get here. The size is limited the same way as of ClientPrepareResultCache, i.e. by the total
+   number of bytes of the cached queries and their rewrites, passed with every request */
+class NativeSqlCache final
+{
+  typedef std::list<std::pair<std::string, SQLString>> LruList;
+
+  std::mutex lock;
+  LruList lru;
+  std::unordered_map<std::string, LruList::iterator> index;
+  std::size_t bytes;
+
+  NativeSqlCache();
+  static std::size_t entrySize(const LruList::value_type& entry);
+  void shrink(std::size_t maxBytes);
+
+public:
+  static NativeSqlCache& getInstance();
+
+  /* Returns cached or newly made result of Utils::nativeSql. maxBytes 0 bypasses the cache */
+  SQLString get(const SQLString& sql, Protocol* protocol, std::size_t maxBytes);
+  void clear();
+  std::size_t size();
+};
+
+}
+}
+#endif
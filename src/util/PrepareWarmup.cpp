@@ -0,0 +1,85 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#include "PrepareWarmup.h"
+#include "Protocol.h"
+#include "options/Options.h"
+
+namespace sql
+{
+namespace mariadb
+{
+  std::atomic<bool> PrepareWarmup::used(false);
+
+
+  PrepareWarmup& PrepareWarmup::getInstance()
+  {
+    static PrepareWarmup theInstance;
+    return theInstance;
+  }
+
+
+  void PrepareWarmup::set(const std::list<SQLString>& _statements)
+  {
+    std::shared_ptr<const std::vector<SQLString>> fresh;
+
+    if (!_statements.empty()) {
+      fresh.reset(new std::vector<SQLString>(_statements.begin(), _statements.end()));
+    }
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    statements= std::move(fresh);
+    used.store(static_cast<bool>(statements), std::memory_order_relaxed);
+  }
+
+
+  std::shared_ptr<const std::vector<SQLString>> PrepareWarmup::get()
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    return statements;
+  }
+
+
+  void PrepareWarmup::warmUp(Protocol* protocol)
+  {
+    const Shared::Options& options= protocol->getOptions();
+
+    if (!isUsed() || protocol->prepareStatementCache() == nullptr) {
+      return;
+    }
+    std::shared_ptr<const std::vector<SQLString>> list(getInstance().get());
+    if (!list) {
+      return;
+    }
+    // Keys of the statements cache
+    SQLString prefix(protocol->getDatabase() + "-");
+    std::vector<SQLString> keys;
+
+    keys.reserve(list->size());
+    for (auto& sql : *list) {
+      // Longer query would not stay in the cache
+      if (sql.length() < static_cast<std::size_t>(options->prepStmtCacheSqlLimit)) {
+        keys.push_back(prefix + sql);
+      }
+    }
+    protocol->prepareCachedQueries(keys, keys.size());
+  }
+
+}
+}
@@ -0,0 +1,63 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _PREPAREWARMUP_H_
+#define _PREPAREWARMUP_H_
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "SQLString.hpp"
+
+namespace sql
+{
+namespace mariadb
+{
+class Protocol;
+
+/* Process wide list of statements, that are prepared on every new connection, that caches server side prepared
+   statements, so their first executions don't wait for PREPARE. Connections of the pool are created by the pool's
+   thread, i.e. mostly off the application's path */
+class PrepareWarmup final
+{
+  static std::atomic<bool> used;
+
+  std::mutex lock;
+  std::shared_ptr<const std::vector<SQLString>> statements;
+
+  PrepareWarmup() {}
+
+public:
+  static PrepareWarmup& getInstance();
+  static bool isUsed() { return used.load(std::memory_order_relaxed); }
+
+  /* Replaces the list. Empty list turns the warm-up off */
+  void set(const std::list<SQLString>& statements);
+  std::shared_ptr<const std::vector<SQLString>> get();
+  /* Prepares the statements of the list on the new connection, if it has the cache of prepared statements */
+  static void warmUp(Protocol* protocol);
+};
+
+}
+}
+#endif
@@ -0,0 +1,51 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _PROBES_H_
+#define _PROBES_H_
+
+/* USDT(DTrace/SystemTap) static probes of the provider "mariadbcpp", compiled in with WITH_USDT cmake option. A probe is
+   a single nop in the code, until a tracer(bpftrace, perf, stap) attaches to it, and nothing at all without the option.
+   Probes and their arguments:
+     operation__start(const char* operation, const char* sql, size_t sqlLength, void* protocol)
+     operation__done(const char* operation, int failed, void* protocol)
+       operation is one of "connect", "query", "prepare", "execute", "batch"; sql is null, if there is no query text
+     reconnect__start(void* protocol), reconnect__done(void* protocol, int failed)
+     fetch__batch(void* resultSet, int32_t rows) - rows of the batch the streaming result has read
+     pool__checkout(const char* poolTag, int64_t waitMicroseconds, int failed)
+     cache__hit(const char* cache), cache__miss(const char* cache)
+       cache is one of "clientPrepare", "serverPrepare", "metadata"
+   Arguments are evaluated even if no tracer is attached, thus they must be the values at hand */
+#ifdef HAVE_USDT
+# include <sys/sdt.h>
+# define MARIADB_PROBE0(name) DTRACE_PROBE(mariadbcpp, name)
+# define MARIADB_PROBE1(name, a1) DTRACE_PROBE1(mariadbcpp, name, a1)
+# define MARIADB_PROBE2(name, a1, a2) DTRACE_PROBE2(mariadbcpp, name, a1, a2)
+# define MARIADB_PROBE3(name, a1, a2, a3) DTRACE_PROBE3(mariadbcpp, name, a1, a2, a3)
+# define MARIADB_PROBE4(name, a1, a2, a3, a4) DTRACE_PROBE4(mariadbcpp, name, a1, a2, a3, a4)
+#else
+# define MARIADB_PROBE0(name) do {} while (0)
+# define MARIADB_PROBE1(name, a1) do {} while (0)
+# define MARIADB_PROBE2(name, a1, a2) do {} while (0)
+# define MARIADB_PROBE3(name, a1, a2, a3) do {} while (0)
+# define MARIADB_PROBE4(name, a1, a2, a3, a4) do {} while (0)
+#endif
+
+#endif
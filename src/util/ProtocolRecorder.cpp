@@ -0,0 +1,148 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#include "ProtocolRecorder.h"
+#include "Exception.hpp"
+
+namespace sql
+{
+namespace mariadb
+{
+namespace capi
+{
+  /* Connector/C transport hook. mode is 0 for the read, and 1 for the write */
+  extern "C" int ma_pvio_register_callback(my_bool registerCallback,
+    void (*callbackFunction)(int mode, MYSQL* mysql, const unsigned char* buffer, size_t length));
+}
+
+  const char ProtocolRecorder::MAGIC[]= "MACPPREC1\n";
+
+
+  ProtocolRecorder& ProtocolRecorder::getInstance()
+  {
+    static ProtocolRecorder theInstance;
+    return theInstance;
+  }
+
+
+  std::string ProtocolRecorder::start(capi::MYSQL* connection, const std::string& fileBase)
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    std::string fileName(fileBase + "." + std::to_string(++fileCounters[fileBase]));
+    std::unique_ptr<Recording> recording(new Recording());
+
+    recording->file.open(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!recording->file) {
+      throw SQLException(("Could not open protocol record file " + fileName).c_str(), "HY000");
+    }
+    recording->file.write(MAGIC, sizeof(MAGIC) - 1);
+
+    if (!callbackRegistered) {
+      capi::ma_pvio_register_callback(1, &ProtocolRecorder::transportCallback);
+      callbackRegistered= true;
+    }
+    recordings[connection]= std::move(recording);
+    active.store(recordings.size(), std::memory_order_relaxed);
+    return fileName;
+  }
+
+
+  void ProtocolRecorder::stop(capi::MYSQL* connection)
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    auto it= recordings.find(connection);
+
+    if (it != recordings.end()) {
+      writeExchange(*it->second);
+      it->second->file.close();
+      recordings.erase(it);
+      active.store(recordings.size(), std::memory_order_relaxed);
+    }
+  }
+
+
+  void ProtocolRecorder::transportCallback(int mode, capi::MYSQL* connection, const unsigned char* buffer, std::size_t length)
+  {
+    ProtocolRecorder& recorder= getInstance();
+    // Read of 0 bytes or error(-1 passed as length). Other connections pay only for this check
+    if (recorder.active.load(std::memory_order_relaxed) == 0 || buffer == nullptr || length == 0 ||
+      length > static_cast<std::size_t>(INT32_MAX)) {
+      return;
+    }
+    recorder.append(connection, mode != 0, buffer, length);
+  }
+
+
+  void ProtocolRecorder::append(capi::MYSQL* connection, bool fromClient, const unsigned char* buffer, std::size_t length)
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    auto it= recordings.find(connection);
+
+    if (it == recordings.end()) {
+      return;
+    }
+    Recording& recording= *it->second;
+    if (recording.fromClient != fromClient) {
+      writeExchange(recording);
+      recording.fromClient= fromClient;
+    }
+    recording.pending.append(reinterpret_cast<const char*>(buffer), length);
+  }
+
+
+  void ProtocolRecorder::writeExchange(Recording& recording)
+  {
+    if (recording.pending.empty()) {
+      return;
+    }
+    uint32_t length= static_cast<uint32_t>(recording.pending.length());
+    char header[5]= {recording.fromClient ? 'C' : 'S', static_cast<char>(length), static_cast<char>(length >> 8),
+      static_cast<char>(length >> 16), static_cast<char>(length >> 24)};
+
+    recording.file.write(header, sizeof(header));
+    recording.file.write(recording.pending.data(), recording.pending.length());
+    recording.pending.clear();
+  }
+
+
+  void ProtocolRecorder::load(const std::string& fileName, std::vector<Exchange>& exchanges)
+  {
+    std::ifstream file(fileName, std::ios::in | std::ios::binary);
+    char magic[sizeof(MAGIC) - 1];
+
+    if (!file.read(magic, sizeof(magic)) || std::string(magic, sizeof(magic)).compare(MAGIC) != 0) {
+      throw SQLException(("Could not read protocol recording from " + fileName).c_str(), "HY000");
+    }
+
+    unsigned char header[5];
+    while (file.read(reinterpret_cast<char*>(header), sizeof(header))) {
+      uint32_t length= header[1] | (header[2] << 8) | (header[3] << 16) | (static_cast<uint32_t>(header[4]) << 24);
+      exchanges.emplace_back();
+      Exchange& exchange= exchanges.back();
+      exchange.fromClient= (header[0] == 'C');
+      exchange.data.resize(length);
+      if (!file.read(&exchange.data[0], length)) {
+        throw SQLException(("Protocol recording " + fileName + " is truncated").c_str(), "HY000");
+      }
+    }
+  }
+
+}
+}
@@ -0,0 +1,92 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _PROTOCOLRECORDER_H_
+#define _PROTOCOLRECORDER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sql
+{
+namespace mariadb
+{
+namespace capi
+{
+#include "mysql.h"
+}
+
+/* Process wide recorder of the client/server exchange of connections with protocolRecordFile option. It is hooked
+   into the Connector/C transport layer, and gets the bytes as they are written to and read from the connection(after
+   TLS decryption, but before decompression). Consecutive chunks of one direction are stored as one exchange, so the
+   file is a sequence of client packets groups and server responses, that ProtocolReplayServer can play back.
+   Record format: direction byte('C' or 'S'), 4 bytes little-endian length, data */
+class ProtocolRecorder final
+{
+public:
+  struct Exchange
+  {
+    bool fromClient;
+    std::string data;
+  };
+
+private:
+  struct Recording
+  {
+    std::ofstream file;
+    bool fromClient= true;
+    std::string pending;
+  };
+
+  static const char MAGIC[];
+
+  std::mutex lock;
+  std::atomic<std::size_t> active;
+  std::unordered_map<std::string, uint32_t> fileCounters;
+  bool callbackRegistered= false;
+  std::unordered_map<capi::MYSQL*, std::unique_ptr<Recording>> recordings;
+
+  ProtocolRecorder() : active(0) {}
+  static void transportCallback(int mode, capi::MYSQL* connection, const unsigned char* buffer, std::size_t length);
+  static void writeExchange(Recording& recording);
+  void append(capi::MYSQL* connection, bool fromClient, const unsigned char* buffer, std::size_t length);
+
+public:
+  static ProtocolRecorder& getInstance();
+
+  /* Starts recording of the connection to the file fileBase.<N>, where N is the number of the connection recorded
+     with this fileBase in the process, starting from 1. Has to be called before the connection is established to get
+     the handshake. Returns the name of the file */
+  std::string start(capi::MYSQL* connection, const std::string& fileBase);
+  /* Has to be called before the handle is closed */
+  void stop(capi::MYSQL* connection);
+  /* Throws SQLException, if the file cannot be read, or is not a recording */
+  static void load(const std::string& fileName, std::vector<Exchange>& exchanges);
+};
+
+}
+}
+#endif
@@ -0,0 +1,190 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#include <algorithm>
+#include <cstring>
+
+#include "ProtocolReplayServer.h"
+#include "Exception.hpp"
+
+#ifdef _WIN32
+# include <ws2tcpip.h>
+# define INVALID_REPLAY_SOCKET INVALID_SOCKET
+#else
+# include <arpa/inet.h>
+# include <netinet/in.h>
+# include <sys/socket.h>
+# include <unistd.h>
+# define INVALID_REPLAY_SOCKET -1
+#endif
+
+// Client closing the connection must not kill the process with SIGPIPE
+#ifdef MSG_NOSIGNAL
+# define REPLAY_SEND_FLAGS MSG_NOSIGNAL
+#else
+# define REPLAY_SEND_FLAGS 0
+#endif
+
+namespace sql
+{
+namespace mariadb
+{
+
+  ProtocolReplayServer::ProtocolReplayServer(const std::string& fileName) :
+    listening(INVALID_REPLAY_SOCKET),
+    client(INVALID_REPLAY_SOCKET),
+    stopping(false)
+  {
+    ProtocolRecorder::load(fileName, exchanges);
+#ifdef _WIN32
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+    sockaddr_in address;
+    socklen_t addressLength= sizeof(address);
+
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family= AF_INET;
+    address.sin_addr.s_addr= htonl(INADDR_LOOPBACK);
+    address.sin_port= 0;
+
+    listening= socket(AF_INET, SOCK_STREAM, 0);
+    if (listening == INVALID_REPLAY_SOCKET ||
+      bind(listening, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+      listen(listening, 1) != 0 ||
+      getsockname(listening, reinterpret_cast<sockaddr*>(&address), &addressLength) != 0) {
+      closeSocket(listening);
+      throw SQLException("Could not start protocol replay server", "HY000");
+    }
+    port= ntohs(address.sin_port);
+    worker= std::thread(&ProtocolReplayServer::run, this);
+  }
+
+
+  ProtocolReplayServer::~ProtocolReplayServer()
+  {
+    stopping.store(true);
+    // Unblocks accept and recv of the worker
+#ifdef _WIN32
+    shutdown(listening, SD_BOTH);
+    shutdown(client, SD_BOTH);
+#else
+    shutdown(listening, SHUT_RDWR);
+    shutdown(client, SHUT_RDWR);
+#endif
+    if (worker.joinable()) {
+      worker.join();
+    }
+    Socket accepted= client.load();
+    closeSocket(accepted);
+    closeSocket(listening);
+  }
+
+
+  void ProtocolReplayServer::closeSocket(Socket& socket)
+  {
+    if (socket != INVALID_REPLAY_SOCKET) {
+#ifdef _WIN32
+      closesocket(socket);
+#else
+      ::close(socket);
+#endif
+      socket= INVALID_REPLAY_SOCKET;
+    }
+  }
+
+
+  std::size_t ProtocolReplayServer::countPackets(const std::string& data)
+  {
+    std::size_t count= 0, pos= 0;
+
+    while (pos + 4 <= data.length()) {
+      const unsigned char* header= reinterpret_cast<const unsigned char*>(data.data() + pos);
+      pos+= 4 + (header[0] | (header[1] << 8) | (header[2] << 16));
+      ++count;
+    }
+    return count;
+  }
+
+
+  bool ProtocolReplayServer::readPackets(std::size_t count)
+  {
+    char buffer[16384];
+
+    for (std::size_t i= 0; i < count; ++i) {
+      unsigned char header[4];
+      std::size_t got= 0;
+
+      while (got < sizeof(header)) {
+        int rc= recv(client, reinterpret_cast<char*>(header) + got, static_cast<int>(sizeof(header) - got), 0);
+        if (rc <= 0) {
+          return false;
+        }
+        got+= rc;
+      }
+      std::size_t length= header[0] | (header[1] << 8) | (header[2] << 16);
+      while (length > 0) {
+        int rc= recv(client, buffer, static_cast<int>(std::min(length, sizeof(buffer))), 0);
+        if (rc <= 0) {
+          return false;
+        }
+        length-= rc;
+      }
+    }
+    return true;
+  }
+
+
+  bool ProtocolReplayServer::sendAll(const std::string& data)
+  {
+    std::size_t sent= 0;
+
+    while (sent < data.length()) {
+      int rc= send(client, data.data() + sent, static_cast<int>(data.length() - sent), REPLAY_SEND_FLAGS);
+      if (rc <= 0) {
+        return false;
+      }
+      sent+= rc;
+    }
+    return true;
+  }
+
+
+  void ProtocolReplayServer::run()
+  {
+    client= accept(listening, nullptr, nullptr);
+    if (client == INVALID_REPLAY_SOCKET || stopping.load()) {
+      return;
+    }
+    for (auto& exchange : exchanges) {
+      if (stopping.load()) {
+        return;
+      }
+      if (exchange.fromClient ? !readPackets(countPackets(exchange.data)) : !sendAll(exchange.data)) {
+        return;
+      }
+    }
+    // Waiting for the client to close the connection. Anything it sends is not answered
+    char buffer[1024];
+    while (!stopping.load() && recv(client, buffer, sizeof(buffer), 0) > 0);
+  }
+
+}
+}
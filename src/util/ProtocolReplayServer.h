@@ -0,0 +1,77 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _PROTOCOLREPLAYSERVER_H_
+#define _PROTOCOLREPLAYSERVER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ProtocolRecorder.h"
+
+#ifdef _WIN32
+# include <winsock2.h>
+#endif
+
+namespace sql
+{
+namespace mariadb
+{
+
+/* Mock server, that plays back the recording made by ProtocolRecorder to one connection on the loopback interface.
+   Client packets are not compared with the recorded ones - for each recorded group of client packets the same number
+   of packets is read, and then the recorded server response is sent. Thus the replaying connection has to use the
+   same options as the recorded one, and neither TLS nor compression can be used */
+class ProtocolReplayServer final
+{
+#ifdef _WIN32
+  typedef SOCKET Socket;
+#else
+  typedef int Socket;
+#endif
+
+  std::vector<ProtocolRecorder::Exchange> exchanges;
+  Socket listening;
+  std::atomic<Socket> client;
+  std::atomic<bool> stopping;
+  int32_t port= 0;
+  std::thread worker;
+
+  static void closeSocket(Socket& socket);
+  bool readPackets(std::size_t count);
+  bool sendAll(const std::string& data);
+  void run();
+
+public:
+  /* Throws SQLException, if the recording cannot be loaded, or the server cannot listen */
+  ProtocolReplayServer(const std::string& fileName);
+  ~ProtocolReplayServer();
+
+  int32_t getPort() const { return port; }
+  /* Number of packets in the recorded chunk of packets */
+  static std::size_t countPackets(const std::string& data);
+};
+
+}
+}
+#endif
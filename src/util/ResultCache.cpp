@@ -0,0 +1,199 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#include <cctype>
+
+#include "ResultCache.h"
+#include "DriverAllocator.h"
+#include "Protocol.h"
+#include "ResultSet.hpp"
+
+namespace sql
+{
+namespace mariadb
+{
+  std::atomic<bool> ResultCache::enabled(false);
+
+  static const char hintName[]= "RESULT_CACHE(";
+
+
+  ResultCache& ResultCache::getInstance()
+  {
+    static ResultCache theInstance;
+    return theInstance;
+  }
+
+
+  int64_t ResultCache::hintTtl(const SQLString& sql)
+  {
+    const char* it= sql.c_str(), *end= it + sql.length();
+    int64_t ttl= 0;
+
+    while (it < end && std::isspace(static_cast<unsigned char>(*it))) {
+      ++it;
+    }
+    if (end - it < 2 || *it != '/' || *(it + 1) != '*') {
+      return 0;
+    }
+    it+= 2;
+    while (it < end && std::isspace(static_cast<unsigned char>(*it))) {
+      ++it;
+    }
+    for (const char* name= hintName; *name != '\0'; ++name, ++it) {
+      if (it == end || *it != *name) {
+        return 0;
+      }
+    }
+    for (; it < end && std::isdigit(static_cast<unsigned char>(*it)); ++it) {
+      ttl= ttl*10 + (*it - '0');
+    }
+    if (it == end || *it != ')') {
+      return 0;
+    }
+    return ttl;
+  }
+
+
+  std::string ResultCache::key(Protocol* protocol, const SQLString& sql)
+  {
+    std::string result(MetadataCache::hostKey(protocol->getHostAddress()));
+
+    result.push_back('\0');
+    result.append(StringImp::get(protocol->getUsername()));
+    result.push_back('\0');
+    result.append(StringImp::get(protocol->getDatabase()));
+    result.push_back('\0');
+    return result.append(StringImp::get(sql));
+  }
+
+
+  std::size_t ResultCache::entrySize(const Entry& entry)
+  {
+    std::size_t result= sizeof(Entry);
+
+    for (auto& name : entry.columnNames) {
+      result+= sizeof(SQLString) + name.length() + sizeof(ColumnType);
+    }
+    for (auto& row : entry.rows) {
+      result+= sizeof(row);
+      for (auto& value : row) {
+        result+= sizeof(value) + value.size();
+      }
+    }
+    return result;
+  }
+
+
+  void ResultCache::setCapacity(std::size_t _capacity)
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    capacity= _capacity;
+    items.clear();
+    lru.clear();
+    used= 0;
+    enabled.store(capacity > 0, std::memory_order_relaxed);
+  }
+
+
+  ResultSet* ResultCache::query(Protocol* protocol, const std::string& key, int64_t ttl,
+    const std::function<ResultSet*()>& query)
+  {
+    std::shared_ptr<const Entry> entry(get(key));
+
+    if (entry) {
+      return entry->createResultSet(protocol);
+    }
+    std::unique_ptr<ResultSet> rs(query());
+    std::shared_ptr<Entry> fresh(std::allocate_shared<Entry>(DriverAllocator::Std<Entry>()));
+    fresh->fill(rs.get());
+    fresh->expires= std::chrono::steady_clock::now() + std::chrono::milliseconds(ttl);
+    put(key, fresh);
+
+    return fresh->createResultSet(protocol);
+  }
+
+
+  void ResultCache::erase(std::unordered_map<std::string, Item>::iterator it)
+  {
+    used-= it->second.size;
+    lru.erase(it->second.lruPos);
+    items.erase(it);
+  }
+
+
+  std::shared_ptr<const ResultCache::Entry> ResultCache::get(const std::string& key)
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    auto it= items.find(key);
+
+    if (it == items.end()) {
+      return nullptr;
+    }
+    if (it->second.entry->expires <= std::chrono::steady_clock::now()) {
+      erase(it);
+      return nullptr;
+    }
+    lru.splice(lru.begin(), lru, it->second.lruPos);
+    return it->second.entry;
+  }
+
+
+  void ResultCache::put(const std::string& key, std::shared_ptr<const Entry> entry)
+  {
+    std::size_t entrySize= ResultCache::entrySize(*entry) + key.length();
+    std::lock_guard<std::mutex> localScopeLock(lock);
+
+    // Result, that would take more than a quarter of the cache, would evict too much
+    if (entrySize > capacity/4) {
+      return;
+    }
+    auto it= items.find(key);
+    if (it != items.end()) {
+      erase(it);
+    }
+    while (used + entrySize > capacity && !lru.empty()) {
+      erase(items.find(lru.back()));
+    }
+    lru.push_front(key);
+    Item& item= items[key];
+    item.entry= std::move(entry);
+    item.size= entrySize;
+    item.lruPos= lru.begin();
+    used+= entrySize;
+  }
+
+
+  void ResultCache::clear()
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    items.clear();
+    lru.clear();
+    used= 0;
+  }
+
+
+  std::size_t ResultCache::size()
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    return items.size();
+  }
+
+}
+}
@@ -0,0 +1,86 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _RESULTCACHE_H_
+#define _RESULTCACHE_H_
+
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "MetadataCache.h"
+
+namespace sql
+{
+namespace mariadb
+{
+
+/* Process wide cache of results of the queries, marked cacheable by the application - with the statement's
+   setResultCacheTtl, or with the RESULT_CACHE(ttl) comment at the query's start. The key is the query with its
+   parameters, the host, the user and the current database. Entry lives for its ttl, and there is no other
+   invalidation. The total size of entries is kept within the capacity, evicting the least recently used ones */
+class ResultCache final
+{
+  typedef MetadataCache::Entry Entry;
+
+  struct Item
+  {
+    std::shared_ptr<const Entry> entry;
+    std::size_t size;
+    std::list<std::string>::iterator lruPos;
+  };
+
+  static std::atomic<bool> enabled;
+
+  std::mutex lock;
+  std::size_t capacity= 0;
+  std::size_t used= 0;
+  // Most recently used keys go first
+  std::list<std::string> lru;
+  std::unordered_map<std::string, Item> items;
+
+  ResultCache() {}
+  void erase(std::unordered_map<std::string, Item>::iterator it);
+
+public:
+  static ResultCache& getInstance();
+  static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+  /* TTL in milliseconds of the RESULT_CACHE(ttl) comment the query starts with, or 0 */
+  static int64_t hintTtl(const SQLString& sql);
+  static std::string key(Protocol* protocol, const SQLString& sql);
+  static std::size_t entrySize(const Entry& entry);
+
+  /* Size of entries in bytes. 0 disables the cache. The cache is cleared */
+  void setCapacity(std::size_t capacity);
+  /* Returns the cached result, or the query's one, caching it for ttl. The caller owns the result */
+  ResultSet* query(Protocol* protocol, const std::string& key, int64_t ttl, const std::function<ResultSet*()>& query);
+  std::shared_ptr<const Entry> get(const std::string& key);
+  void put(const std::string& key, std::shared_ptr<const Entry> entry);
+  void clear();
+  std::size_t size();
+};
+
+}
+}
+#endif
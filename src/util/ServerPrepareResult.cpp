@@ -32,8 +32,9 @@ namespace mariadb
 {
   ServerPrepareResult::~ServerPrepareResult()
   {
-    std::lock_guard<std::mutex> localScopeLock(lock);
-    capi::mysql_stmt_close(statementId);
+    if (statementId != nullptr) {
+      capi::mysql_stmt_close(statementId);
+    }
   }
   /**
     * PrepareStatement Result object.
@@ -80,11 +81,11 @@ namespace mariadb
     , metadata(mysql_stmt_result_metadata(statementId), &capi::mysql_free_result)
     , unProxiedProtocol(_unProxiedProtocol)
   {
-    columns.reserve(mysql_stmt_field_count(statementId));
-
-    for (uint32_t i= 0; i < mysql_stmt_field_count(statementId); ++i) {
-      columns.emplace_back(new capi::ColumnDefinitionCapi(mysql_fetch_field_direct(metadata.get(), i)));
+    if (metadata) {
+      capi::ColumnDefinitionCapi::fromFields(columns, capi::mysql_fetch_fields(metadata.get()),
+        mysql_stmt_field_count(statementId));
     }
+    cachedFields= capi::mariadb_stmt_fetch_fields(statementId);
     parameters.reserve(mysql_stmt_param_count(statementId));
 
     for (uint32_t i= 0; i < mysql_stmt_param_count(statementId); ++i) {
@@ -93,12 +94,39 @@ namespace mariadb
   }
 
 
+  /* Result metadata of the statement normally stays the same between executions. Column definitions are rebuilt only
+     if C API statement fields have been re-allocated, or differ from the cached ones, e.g. after the table has been
+     altered. If MARIADB_CLIENT_CACHE_METADATA is negotiated, the server does not even re-send them */
+  bool ServerPrepareResult::isColumnInfoValid()
+  {
+    uint32_t fieldCount= mysql_stmt_field_count(statementId);
+    capi::MYSQL_FIELD* fields= capi::mariadb_stmt_fetch_fields(statementId);
+
+    if (fields == nullptr || fields != cachedFields || fieldCount != columns.size()) {
+      return false;
+    }
+    for (uint32_t i= 0; i < fieldCount; ++i) {
+      const ColumnDefinition& column= *columns[i];
+      if (&column.getColumnType() != &ColumnType::fromServer(fields[i].type & 0xff, fields[i].charsetnr) ||
+        column.getLength() != static_cast<uint32_t>(std::max(fields[i].length, fields[i].max_length))) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+
   void ServerPrepareResult::reReadColumnInfo()
   {
+    if (isColumnInfoValid()) {
+      return;
+    }
     metadata.reset(mysql_stmt_result_metadata(statementId));
+    cachedFields= capi::mariadb_stmt_fetch_fields(statementId);
     columns.clear();
-    for (uint32_t i= 0; i < mysql_stmt_field_count(statementId); ++i) {
-      columns.emplace_back(new capi::ColumnDefinitionCapi(mysql_fetch_field_direct(metadata.get(), i)));
+    if (metadata) {
+      capi::ColumnDefinitionCapi::fromFields(columns, capi::mysql_fetch_fields(metadata.get()),
+        mysql_stmt_field_count(statementId));
     }
   }
 
@@ -122,9 +150,9 @@ namespace mariadb
   {
     this->statementId= statementId;
     this->unProxiedProtocol= unProxiedProtocol.get();
+    this->cachedFields= nullptr;
     resetParameterTypeHeader();
-    this->shareCounter= 1;
-    this->isBeingDeallocate= false;
+    this->shareCounter.store(1, std::memory_order_release);
   }
 
   void ServerPrepareResult::setAddToCache()
@@ -144,19 +172,32 @@ namespace mariadb
     */
   bool ServerPrepareResult::incrementShareCounter()
   {
-    std::lock_guard<std::mutex> localScopeLock(lock);
-    if (isBeingDeallocate) {
-      return false;
-    }
+    int32_t current= shareCounter.load(std::memory_order_relaxed);
+
+    do {
+      if (current == DEALLOCATED) {
+        return false;
+      }
+    } while (!shareCounter.compare_exchange_weak(current, current + 1, std::memory_order_acquire, std::memory_order_relaxed));
 
-    shareCounter++;
     return true;
   }
 
+  /**
+    * Takes the cached prepare for the statement. Rows of the binary result are read from the C API handle, thus the
+    * prepare can't be shared, and only the one, that no statement uses, can be taken.
+    *
+    * @return true if the prepare has been taken
+    */
+  bool ServerPrepareResult::takeUnused()
+  {
+    int32_t expected= 0;
+    return shareCounter.compare_exchange_strong(expected, 1, std::memory_order_acquire, std::memory_order_relaxed);
+  }
+
   void ServerPrepareResult::decrementShareCounter()
   {
-    std::lock_guard<std::mutex> localScopeLock(lock);
-    shareCounter--;
+    shareCounter.fetch_sub(1, std::memory_order_release);
   }
 
   /**
@@ -167,16 +208,13 @@ namespace mariadb
     */
   bool ServerPrepareResult::canBeDeallocate()
   {
-    std::lock_guard<std::mutex> localScopeLock(lock);
+    int32_t expected= 0;
 
-    if (shareCounter >0 || isBeingDeallocate) {
+    if (shareCounter.load(std::memory_order_relaxed) != 0 || inCache.load()) {
       return false;
     }
-    if (!inCache.load()) {
-      isBeingDeallocate= true;
-      return true;
-    }
-    return false;
+    // Only one caller can move the counter from 0 to DEALLOCATED, and no statement can take the prepare after that
+    return shareCounter.compare_exchange_strong(expected, DEALLOCATED, std::memory_order_acq_rel, std::memory_order_relaxed);
   }
 
   size_t ServerPrepareResult::getParamCount() const
@@ -187,8 +225,8 @@ namespace mariadb
   // for unit test
   int32_t ServerPrepareResult::getShareCounter()
   {
-    std::lock_guard<std::mutex> localScopeLock(lock);
-    return shareCounter;
+    int32_t current= shareCounter.load(std::memory_order_acquire);
+    return current == DEALLOCATED ? 0 : current;
   }
 
   capi::MYSQL_STMT* ServerPrepareResult::getStatementId()
@@ -196,6 +234,14 @@ namespace mariadb
     return statementId;
   }
 
+
+  capi::MYSQL_STMT* ServerPrepareResult::detachStatementId()
+  {
+    capi::MYSQL_STMT* detached= statementId;
+    statementId= nullptr;
+    return detached;
+  }
+
   const std::vector<Shared::ColumnDefinition>& ServerPrepareResult::getColumns() const
   {
     return columns;
@@ -225,6 +271,33 @@ namespace mariadb
   }
 
 
+  std::vector<capi::MYSQL_BIND>& ServerPrepareResult::getResultBind()
+  {
+    return resultBind;
+  }
+
+  /**
+    * Returns buffer for the result column of at least length bytes. The buffer is kept for next executions, and
+    * next results of the same execution, thus it is allocated only once, unless bigger one is required.
+    *
+    * @param column index of the column (0 is first)
+    * @param length required buffer length
+    * @return buffer pointer
+    */
+  uint8_t* ServerPrepareResult::getResultBuffer(std::size_t column, unsigned long length)
+  {
+    if (column >= resultBuffer.size()) {
+      resultBuffer.resize(column + 1);
+      resultBufferSize.resize(column + 1, 0);
+    }
+    if (resultBufferSize[column] < length || !resultBuffer[column]) {
+      resultBuffer[column].reset(new uint8_t[length > 0 ? length : 1]);
+      resultBufferSize[column]= length;
+    }
+    return resultBuffer[column].get();
+  }
+
+
   void initBindStruct(capi::MYSQL_BIND& bind, const ParameterHolder& paramInfo)
   {
     const ColumnType& typeInfo= paramInfo.getColumnType();
@@ -326,5 +399,90 @@ extern "C"
     capi::mysql_stmt_attr_set(statementId, capi::STMT_ATTR_CB_PARAM, (const void*)&paramRowUpdateCallback);
     capi::mysql_stmt_bind_param(statementId, paramBind.data());
   }
+
+  /* Column-wise binding of the arrays for the bulk execution - the C API reads values right from the application
+     memory. The callback of the row-wise binding is reset, since it would take precedence */
+  void ServerPrepareResult::bindParameterArrays(const std::vector<ParameterArray>& arrays, uint32_t rows)
+  {
+    resetParameterTypeHeader();
+    for (std::size_t i= 0; i < paramBind.size(); ++i)
+    {
+      auto& bind= paramBind[i];
+      const ParameterArray& arr= arrays[i];
+
+      std::memset(&bind, 0, sizeof(bind));
+      bind.buffer_type= arr.type;
+      bind.buffer= const_cast<void*>(arr.values);
+      bind.length= const_cast<unsigned long*>(arr.lengths);
+      bind.u.indicator= const_cast<char*>(arr.indicators);
+    }
+    capi::mysql_stmt_attr_set(statementId, capi::STMT_ATTR_CB_PARAM, nullptr);
+    capi::mysql_stmt_attr_set(statementId, capi::STMT_ATTR_ARRAY_SIZE, &rows);
+    capi::mysql_stmt_bind_param(statementId, paramBind.data());
+  }
+
+  /* Binds values of one row of the arrays, for the servers not supporting bulk execution */
+  void ServerPrepareResult::bindParameterArraysRow(const std::vector<ParameterArray>& arrays, std::size_t row)
+  {
+    for (std::size_t i= 0; i < paramBind.size(); ++i)
+    {
+      auto& bind= paramBind[i];
+      const ParameterArray& arr= arrays[i];
+
+      std::memset(&bind, 0, sizeof(bind));
+      bind.buffer_type= arr.type;
+      bind.is_null= &bind.is_null_value;
+
+      if (arr.indicators != nullptr && arr.indicators[row] == capi::STMT_INDICATOR_NULL) {
+        bind.is_null_value= '\1';
+      }
+      else if (arr.lengths != nullptr) {
+        bind.buffer= const_cast<char*>(static_cast<const char* const*>(arr.values)[row]);
+        bind.buffer_length= arr.lengths[row];
+      }
+      else {
+        bind.buffer= const_cast<char*>(static_cast<const char*>(arr.values) + row*arr.elementSize);
+        bind.buffer_length= static_cast<unsigned long>(arr.elementSize);
+      }
+    }
+    capi::mysql_stmt_bind_param(statementId, paramBind.data());
+  }
+
+  /* Binds the values of executeWith right from the application memory. Their types are known from the arguments types,
+     thus values don't need holders */
+  void ServerPrepareResult::bindParameterValues(const ParameterValue* values)
+  {
+    resetParameterTypeHeader();
+    for (std::size_t i= 0; i < paramBind.size(); ++i)
+    {
+      auto& bind= paramBind[i];
+      const ParameterValue& value= values[i];
+
+      bind.buffer= const_cast<void*>(value.value);
+      bind.buffer_length= static_cast<unsigned long>(value.length);
+
+      switch (value.kind) {
+      case ParameterValue::INTEGER:
+      case ParameterValue::UNSIGNED:
+        bind.is_unsigned= value.kind == ParameterValue::UNSIGNED ? '\1' : '\0';
+        switch (value.length) {
+        case 1: bind.buffer_type= capi::MYSQL_TYPE_TINY; break;
+        case 2: bind.buffer_type= capi::MYSQL_TYPE_SHORT; break;
+        case 4: bind.buffer_type= capi::MYSQL_TYPE_LONG; break;
+        default: bind.buffer_type= capi::MYSQL_TYPE_LONGLONG;
+        }
+        break;
+      case ParameterValue::REAL:
+        bind.buffer_type= value.length == sizeof(float) ? capi::MYSQL_TYPE_FLOAT : capi::MYSQL_TYPE_DOUBLE;
+        break;
+      case ParameterValue::STRING:
+        bind.buffer_type= capi::MYSQL_TYPE_STRING;
+        break;
+      default:
+        bind.buffer_type= capi::MYSQL_TYPE_NULL;
+      }
+    }
+    capi::mysql_stmt_bind_param(statementId, paramBind.data());
+  }
 }
 }
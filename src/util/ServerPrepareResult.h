@@ -22,11 +22,11 @@
 #define _SERVERPREPARERESULT_H_
 
 #include <atomic>
-#include <mutex>
 
 #include "Consts.h"
 
 #include "PrepareResult.h"
+#include "ParameterValue.hpp"
 
 namespace sql
 {
@@ -41,6 +41,18 @@ class ColumnDefinition;
 class ColumnType;
 class ParameterHolder;
 
+/* Column of parameter values in the application memory, that is bound to the statement as is. Indicators follow
+   C API STMT_INDICATOR_* values, and can be nullptr if there are no NULLs */
+struct ParameterArray
+{
+  capi::enum_field_types type;
+  const void* values;
+  // For strings values is array of pointers, and lengths are their lengths. Otherwise lengths is nullptr
+  const unsigned long* lengths;
+  const char* indicators;
+  std::size_t elementSize;
+};
+
 class ServerPrepareResult  : public PrepareResult {
 
   std::vector<Shared::ColumnDefinition> columns;
@@ -49,11 +61,21 @@ class ServerPrepareResult  : public PrepareResult {
   std::atomic_bool inCache;
   capi::MYSQL_STMT* statementId;
   std::unique_ptr<capi::MYSQL_RES, decltype(&capi::mysql_free_result)> metadata;
+  // Fields of the C API statement, that columns have been built for
+  capi::MYSQL_FIELD* cachedFields= nullptr;
   std::vector<capi::MYSQL_BIND> paramBind;
+  // Result bind and its buffers are kept between executions. A buffer is only reallocated if it has to grow
+  std::vector<capi::MYSQL_BIND> resultBind;
+  std::vector<std::unique_ptr<uint8_t[]>> resultBuffer;
+  std::vector<unsigned long> resultBufferSize;
   Protocol* unProxiedProtocol;
+  // Number of statements using the prepare, or DEALLOCATED once it is marked for deallocation. Lock-free, since
+  // statements taking a cached prepare change it on each create and close
   std::atomic<int32_t> shareCounter{1};
-  std::atomic<bool> isBeingDeallocate{false};
-  std::mutex lock;
+
+  static constexpr int32_t DEALLOCATED= -1;
+
+  bool isColumnInfoValid();
 
 public:
   ~ServerPrepareResult();
@@ -77,18 +99,26 @@ public:
   void setAddToCache();
   void setRemoveFromCache();
   bool incrementShareCounter();
+  bool takeUnused();
   void decrementShareCounter();
   bool canBeDeallocate();
   size_t getParamCount() const;
   int32_t getShareCounter();
   capi::MYSQL_STMT* getStatementId();
+  /* The caller takes over closing the C API handle. Used once the prepare has been marked for deallocation */
+  capi::MYSQL_STMT* detachStatementId();
   const std::vector<Shared::ColumnDefinition>& getColumns() const;
   const std::vector<Shared::ColumnDefinition>& getParameters() const;
   Protocol* getUnProxiedProtocol();
   const SQLString& getSql() const;
   const std::vector<capi::MYSQL_BIND>& getParameterTypeHeader() const;
+  std::vector<capi::MYSQL_BIND>& getResultBind();
+  uint8_t* getResultBuffer(std::size_t column, unsigned long length);
   void bindParameters(std::vector<Shared::ParameterHolder>& parameters);
   void bindParameters(std::vector<std::vector<Shared::ParameterHolder>>& parameters, const int16_t *type= nullptr);
+  void bindParameterArrays(const std::vector<ParameterArray>& arrays, uint32_t rows);
+  void bindParameterArraysRow(const std::vector<ParameterArray>& arrays, std::size_t row);
+  void bindParameterValues(const ParameterValue* values);
   };
 }
 }
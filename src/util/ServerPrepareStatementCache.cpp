@@ -21,91 +21,210 @@
 #include "ServerPrepareStatementCache.h"
 #include "util/ServerPrepareResult.h"
 #include "Protocol.h"
+#include "util/Probes.h"
 
 namespace sql
 {
 namespace mariadb
 {
 
-  ServerPrepareStatementCache::ServerPrepareStatementCache(uint32_t size, Shared::Protocol& protocol)
+  ServerPrepareStatementCache::ServerPrepareStatementCache(uint32_t size, Protocol* protocol)
     : maxSize(size)
     , protocol(protocol)
+    , hits(0)
+    , misses(0)
+    , evictions(0)
   {
+    index.reserve(size + 1);
   }
 
-  ServerPrepareStatementCache* ServerPrepareStatementCache::newInstance(uint32_t size, Shared::Protocol& protocol)
+  ServerPrepareStatementCache* ServerPrepareStatementCache::newInstance(uint32_t size, Protocol* protocol)
   {
     return new ServerPrepareStatementCache(size, protocol);
   }
 
-  bool ServerPrepareStatementCache::removeEldestEntry(value_type eldest)
+  /* FNV-1a 64bit */
+  uint64_t ServerPrepareStatementCache::hashKey(const SQLString& key)
   {
-    bool mustBeRemoved= cache.size() > maxSize;
+    uint64_t hash= 14695981039346656037ULL;
+    const char* ptr= key.c_str(), *end= ptr + key.length();
 
-    if (mustBeRemoved){
-      ServerPrepareResult* serverPrepareResult= eldest.second;
-      serverPrepareResult->setRemoveFromCache();
+    while (ptr < end) {
+      hash^= static_cast<unsigned char>(*ptr++);
+      hash*= 1099511628211ULL;
+    }
+    return hash;
+  }
+
+  /* Has to be called under the lock. Moves found entry to the head of the list */
+  ServerPrepareResult* ServerPrepareStatementCache::lookup(uint64_t hash, const SQLString& key)
+  {
+    auto it= index.find(hash);
+
+    if (it == index.end() || it->second->key.compare(0, std::string::npos, key.c_str(), key.length()) != 0) {
+      return nullptr;
+    }
+    if (it->second != lru.begin()) {
+      lru.splice(lru.begin(), lru, it->second);
+    }
+    return it->second->result;
+  }
+
+  /* Has to be called under the lock. The statement is only marked as not cached, and put aside until the lock is
+     released */
+  void ServerPrepareStatementCache::evict(LruList::iterator it)
+  {
+    it->result->setRemoveFromCache();
+    evicted.push_back(it->result);
+    index.erase(it->hash);
+    lru.erase(it);
+    ++evictions;
+  }
+
+  /* Has to be called without the lock. Deallocates evicted statements, that are not used any more. Those, that are
+     used, are deallocated by their statement */
+  void ServerPrepareStatementCache::releaseEvicted(std::vector<ServerPrepareResult*>& toRelease)
+  {
+    for (auto serverPrepareResult : toRelease) {
       if (serverPrepareResult->canBeDeallocate()) {
         try {
-          protocol->forceReleasePrepareStatement(serverPrepareResult->getStatementId());
+          protocol->forceReleasePrepareStatement(serverPrepareResult->detachStatementId());
         }catch (SQLException&){
 
         }
+        delete serverPrepareResult;
       }
     }
-    return mustBeRemoved;
   }
 
   /**
-   * Associates the specified value with the specified key in this map. If the map previously
-   * contained a mapping for the key, the existing cached prepared result shared counter will be
-   * incremented.
+   * Adds the prepare, that the statement has just made, to the cache. If the cache is full, the least recently used
+   * statement is removed from it.
    *
    * @param key key
    * @param result new prepare result.
-   * @return the previous value associated with key if not been deallocate, or null if there was no
-   *     mapping for key.
+   * @return false if the query is cached already - its prepare is used by other statement, and the new one stays out
+   *     of the cache
    */
-  ServerPrepareResult* ServerPrepareStatementCache::put(const SQLString& key, ServerPrepareResult* result)
+  bool ServerPrepareStatementCache::put(const SQLString& key, ServerPrepareResult* result)
   {
-    std::lock_guard<std::mutex> localScopeLock(lock);
+    uint64_t hash= hashKey(key);
+    std::vector<ServerPrepareResult*> toRelease;
+    {
+      std::lock_guard<std::mutex> localScopeLock(lock);
 
-    iterator cachedServerPrepareResult= cache.find(StringImp::get(key));
+      if (lookup(hash, key) != nullptr) {
+        return false;
+      }
+      // Other key with the same hash
+      auto it= index.find(hash);
+      if (it != index.end()) {
+        evict(it->second);
+      }
+      while (!lru.empty() && lru.size() >= maxSize) {
+        evict(std::prev(lru.end()));
+      }
+      result->setAddToCache();
+      lru.emplace_front(hash, StringImp::get(key), result);
+      index.emplace(hash, lru.begin());
 
-    if (cachedServerPrepareResult != cache.end() && cachedServerPrepareResult->second->incrementShareCounter()){
-      return cachedServerPrepareResult->second;
+      toRelease.swap(evicted);
     }
+    releaseEvicted(toRelease);
 
-    result->setAddToCache();
-    cache.emplace(StringImp::get(key), result);
-
-    return nullptr;
+    return true;
   }
 
 
-  /* Calls have to be guarded*/
+  /* Takes the cached prepare of the query for the statement, if no other statement uses it */
   ServerPrepareResult* ServerPrepareStatementCache::get(const SQLString& key)
   {
+    uint64_t hash= hashKey(key);
+    std::lock_guard<std::mutex> localScopeLock(lock);
 
-    iterator cachedServerPrepareResult= cache.find(StringImp::get(key));
+    ServerPrepareResult* cachedServerPrepareResult= lookup(hash, key);
 
-    if (cachedServerPrepareResult != cache.end() && cachedServerPrepareResult->second->incrementShareCounter()){
-      return cachedServerPrepareResult->second;
+    if (cachedServerPrepareResult != nullptr && cachedServerPrepareResult->takeUnused()) {
+      ++hits;
+      MARIADB_PROBE1(cache__hit, "serverPrepare");
+      return cachedServerPrepareResult;
     }
-
+    ++misses;
+    MARIADB_PROBE1(cache__miss, "serverPrepare");
     return nullptr;
   }
+
+  /* Removes all statements from the cache, deallocating those, that are not used by any statement object */
+  void ServerPrepareStatementCache::clear()
+  {
+    std::vector<ServerPrepareResult*> toRelease;
+    {
+      std::lock_guard<std::mutex> localScopeLock(lock);
+      while (!lru.empty()) {
+        evict(lru.begin());
+      }
+      toRelease.swap(evicted);
+    }
+    releaseEvicted(toRelease);
+  }
+
+
+  /* Returns keys of all cached statements, the most recently used first */
+  std::vector<SQLString> ServerPrepareStatementCache::keys()
+  {
+    std::vector<SQLString> result;
+    std::lock_guard<std::mutex> localScopeLock(lock);
+
+    result.reserve(lru.size());
+    for (auto& entry : lru) {
+      result.emplace_back(entry.key);
+    }
+    return result;
+  }
+
+
+  std::size_t ServerPrepareStatementCache::size()
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    return lru.size();
+  }
+
+
+  uint64_t ServerPrepareStatementCache::getHits()
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    return hits;
+  }
+
+
+  uint64_t ServerPrepareStatementCache::getMisses()
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    return misses;
+  }
+
+
+  uint64_t ServerPrepareStatementCache::getEvictions()
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    return evictions;
+  }
+
+
   SQLString ServerPrepareStatementCache::toString()
   {
+    std::lock_guard<std::mutex> localScopeLock(lock);
     SQLString stringBuilder("ServerPrepareStatementCache.map[");
-    for (auto& entry: this->cache){
+    for (auto& entry: lru){
       stringBuilder
         .append("\n")
-        .append(entry.first)
+        .append(entry.key)
         .append("-")
-        .append(std::to_string(entry.second->getShareCounter()));
+        .append(std::to_string(entry.result->getShareCounter()));
     }
-    stringBuilder.append("]");
+    stringBuilder.append("]hits:").append(std::to_string(hits))
+      .append(",misses:").append(std::to_string(misses))
+      .append(",evictions:").append(std::to_string(evictions));
     return stringBuilder;
   }
 }
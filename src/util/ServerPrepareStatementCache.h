@@ -22,6 +22,7 @@
 #define _SERVERPREPARESTATEMENTCACHE_H_
 
 #include <unordered_map>
+#include <list>
 #include <mutex>
 
 #include "Consts.h"
@@ -31,20 +32,49 @@ namespace sql
 namespace mariadb
 {
 
-
+/* LRU cache of server side prepared statements. Entries are kept in the list in the order of use, most recently used
+   first, and indexed by 64bit hash of the key("<schema>-<query>"), so lookup, promotion and eviction are all O(1).
+   Statements pushed out of the cache are collected under the lock and released afterwards in one go.
+   A cached prepare is used by one statement at a time, since binary result rows are read from its C API handle. The
+   cache owns the prepares, that no statement uses, and deletes them on eviction */
 class ServerPrepareStatementCache final {
+  struct Entry
+  {
+    uint64_t hash;
+    std::string key;
+    ServerPrepareResult* result;
+
+    Entry(uint64_t _hash, const std::string& _key, ServerPrepareResult* _result)
+      : hash(_hash), key(_key), result(_result) {}
+  };
+  typedef std::list<Entry> LruList;
+
   std::mutex lock;
   uint32_t maxSize;
-  const Shared::Protocol protocol;
-  ServerPrepareStatementCache(uint32_t size, Shared::Protocol& protocol);
-  std::unordered_map<std::string, ServerPrepareResult*> cache;
-  typedef std::unordered_map<std::string, ServerPrepareResult*>::iterator iterator;
+  Protocol* const protocol;
+  LruList lru;
+  std::unordered_map<uint64_t, LruList::iterator> index;
+  std::vector<ServerPrepareResult*> evicted;
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+
+  ServerPrepareStatementCache(uint32_t size, Protocol* protocol);
+  ServerPrepareResult* lookup(uint64_t hash, const SQLString& key);
+  void evict(LruList::iterator it);
+  void releaseEvicted(std::vector<ServerPrepareResult*>& toRelease);
+
 public:
-  typedef std::unordered_map<std::string, ServerPrepareResult*>::value_type value_type;
-  static ServerPrepareStatementCache* newInstance(uint32_t size, Shared::Protocol& protocol);
-  bool removeEldestEntry(value_type eldest);
-  /*synchronized*/ ServerPrepareResult* put(const SQLString& key, ServerPrepareResult* result);
+  static ServerPrepareStatementCache* newInstance(uint32_t size, Protocol* protocol);
+  static uint64_t hashKey(const SQLString& key);
+  /*synchronized*/ bool put(const SQLString& key, ServerPrepareResult* result);
   /*synchronized*/ ServerPrepareResult* get(const SQLString& key);
+  /*synchronized*/ void clear();
+  /*synchronized*/ std::vector<SQLString> keys();
+  std::size_t size();
+  uint64_t getHits();
+  uint64_t getMisses();
+  uint64_t getEvictions();
   SQLString toString();
   };
 }
@@ -0,0 +1,120 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#include <algorithm>
+#include <vector>
+
+#include "StatementDigestTable.h"
+
+namespace sql
+{
+namespace mariadb
+{
+  std::atomic<bool> StatementDigestTable::enabled(false);
+
+  class MariaDbStatementDigests final : public StatementDigests
+  {
+    std::vector<StatementDigest> digests;
+
+  public:
+    MariaDbStatementDigests(std::vector<StatementDigest>&& _digests) : digests(std::move(_digests))
+    {}
+
+    std::size_t getCount() { return digests.size(); }
+    const StatementDigest& get(std::size_t index) { return digests.at(index); }
+  };
+
+
+  StatementDigestTable& StatementDigestTable::getInstance()
+  {
+    static StatementDigestTable theInstance;
+    return theInstance;
+  }
+
+
+  void StatementDigestTable::setCapacity(std::size_t _capacity)
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+    capacity= _capacity;
+    entries.clear();
+    entries.reserve(capacity);
+    enabled.store(capacity > 0, std::memory_order_relaxed);
+  }
+
+
+  void StatementDigestTable::record(const std::string& digest, uint64_t micros, uint64_t rows, bool failed)
+  {
+    std::lock_guard<std::mutex> localScopeLock(lock);
+
+    if (capacity == 0) {
+      return;
+    }
+    auto it= entries.find(digest);
+    if (it == entries.end()) {
+      std::unique_ptr<Entry> entry(new Entry());
+
+      if (entries.size() >= capacity) {
+        auto least= std::min_element(entries.begin(), entries.end(),
+          [](const decltype(entries)::value_type& a, const decltype(entries)::value_type& b) {
+            return a.second->totalTime < b.second->totalTime;
+          });
+        entry->totalTime= least->second->totalTime;
+        entry->totalTimeError= least->second->totalTime;
+        entries.erase(least);
+      }
+      it= entries.emplace(digest, std::move(entry)).first;
+    }
+    Entry& entry= *it->second;
+    ++entry.count;
+    if (failed) {
+      ++entry.errors;
+    }
+    entry.totalTime+= micros;
+    entry.rows+= rows;
+    entry.latency.record(micros);
+  }
+
+
+  StatementDigests* StatementDigestTable::snapshot()
+  {
+    std::vector<StatementDigest> digests;
+    {
+      std::lock_guard<std::mutex> localScopeLock(lock);
+      digests.reserve(entries.size());
+      for (auto& it : entries) {
+        digests.emplace_back();
+        StatementDigest& digest= digests.back();
+        digest.digest= it.first;
+        digest.count= it.second->count;
+        digest.errors= it.second->errors;
+        digest.totalTime= it.second->totalTime;
+        digest.totalTimeError= it.second->totalTimeError;
+        digest.rows= it.second->rows;
+        it.second->latency.summarize(digest.latency);
+      }
+    }
+    std::sort(digests.begin(), digests.end(), [](const StatementDigest& a, const StatementDigest& b) {
+      return a.totalTime > b.totalTime;
+    });
+    return new MariaDbStatementDigests(std::move(digests));
+  }
+
+}
+}
@@ -0,0 +1,76 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _STATEMENTDIGESTTABLE_H_
+#define _STATEMENTDIGESTTABLE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "Metrics.hpp"
+#include "util/MetricsRecorder.h"
+
+namespace sql
+{
+namespace mariadb
+{
+
+/* Process wide table of the most expensive statements, aggregated by digest. The table keeps at most capacity
+   digests - when it is full, the digest with the least total time is replaced by the new one, which inherits its
+   total time as the error(Space-Saving algorithm). Thus statements, that take a big share of the total time, are
+   never displaced, and the memory stays bounded. Recording takes the lock only for the lookup and few increments */
+class StatementDigestTable final
+{
+  struct Entry
+  {
+    uint64_t count= 0;
+    uint64_t errors= 0;
+    uint64_t totalTime= 0;
+    uint64_t totalTimeError= 0;
+    uint64_t rows= 0;
+    LatencyHistogram latency;
+  };
+
+  static std::atomic<bool> enabled;
+
+  std::mutex lock;
+  std::size_t capacity= 0;
+  std::unordered_map<std::string, std::unique_ptr<Entry>> entries;
+
+  StatementDigestTable() {}
+
+public:
+  static StatementDigestTable& getInstance();
+  static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+  /* 0 disables the table. The table is cleared */
+  void setCapacity(std::size_t capacity);
+  void record(const std::string& digest, uint64_t micros, uint64_t rows, bool failed);
+  /* The caller owns the snapshot */
+  StatementDigests* snapshot();
+};
+
+}
+}
+#endif
@@ -22,6 +22,7 @@
 #include <string>
 #include <cstring>
 #include <stdexcept>
+#include <limits>
 
 #include "util/String.h"
 #include "StringImp.h"
@@ -149,5 +150,144 @@ namespace mariadb
     len= len == static_cast<std::size_t>(-1) ? std::strlen(str) : len;
     return stoull(sql::SQLString(str, len), pos);
   }
+
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__)
+# if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#  define MADB_SWAR_DIGITS 1
+# endif
+#elif defined(_M_IX86) || defined(_M_X64) || defined(_M_ARM64)
+# define MADB_SWAR_DIGITS 1
+#endif
+
+#ifdef MADB_SWAR_DIGITS
+  /* Checks 8 bytes loaded from the string at once, if they all are digits */
+  static inline bool isEightDigits(uint64_t chunk)
+  {
+    return ((chunk & 0xF0F0F0F0F0F0F0F0ULL) | (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ==
+      0x3333333333333333ULL;
+  }
+
+  /* Converts 8 digits in one go - pairs of digits, then pairs of 2-digits numbers, and then pairs of 4-digits ones */
+  static inline uint32_t parseEightDigits(uint64_t chunk)
+  {
+    chunk-= 0x3030303030303030ULL;
+    chunk= (chunk * 10) + (chunk >> 8);
+    chunk= (((chunk & 0x000000FF000000FFULL) * 0x000F424000000064ULL) +
+      (((chunk >> 16) & 0x000000FF000000FFULL) * 0x0000271000000001ULL)) >> 32;
+    return static_cast<uint32_t>(chunk);
+  }
+#endif
+
+  /* Reads all digits starting from str. Value may wrap around if there were more than 19 digits - caller has
+     to check that */
+  static inline const char* parseDigits(const char* str, const char* end, uint64_t& value)
+  {
+#ifdef MADB_SWAR_DIGITS
+    uint64_t chunk;
+    while (end - str >= 8) {
+      std::memcpy(&chunk, str, sizeof(chunk));
+      if (!isEightDigits(chunk)) {
+        break;
+      }
+      value= value*100000000ULL + parseEightDigits(chunk);
+      str+= 8;
+    }
+#endif
+    while (str < end && static_cast<unsigned char>(*str - '0') < 10) {
+      value= value*10 + static_cast<uint64_t>(*str - '0');
+      ++str;
+    }
+    return str;
+  }
+
+  // Max number of digits, that is guaranteed to fit uint64_t
+  static const std::ptrdiff_t MAX_SAFE_DIGITS= 19;
+
+  bool parseUInt64(const char* str, std::size_t len, uint64_t& value)
+  {
+    const char* end= str + len, *digitsEnd;
+    value= 0;
+
+    if (len == 0) {
+      return false;
+    }
+    digitsEnd= parseDigits(str, end, value);
+    return digitsEnd == end && (end - str) <= MAX_SAFE_DIGITS;
+  }
+
+
+  bool parseInt64(const char* str, std::size_t len, int64_t& value)
+  {
+    bool negative= false;
+    uint64_t absValue;
+
+    if (len > 0 && (*str == '-' || *str == '+')) {
+      negative= (*str == '-');
+      ++str;
+      --len;
+    }
+    if (!parseUInt64(str, len, absValue)) {
+      return false;
+    }
+    if (negative) {
+      if (absValue > static_cast<uint64_t>(INT64_MAX) + 1) {
+        return false;
+      }
+      value= static_cast<int64_t>(0ULL - absValue);
+    }
+    else {
+      if (absValue > static_cast<uint64_t>(INT64_MAX)) {
+        return false;
+      }
+      value= static_cast<int64_t>(absValue);
+    }
+    return true;
+  }
+
+  /* Powers of 10, that are exactly representable as in long double with 64 bits mantissa */
+  static const long double exactPow10[]= {
+    1e0L, 1e1L, 1e2L, 1e3L, 1e4L, 1e5L, 1e6L, 1e7L, 1e8L, 1e9L, 1e10L, 1e11L, 1e12L, 1e13L, 1e14L,
+    1e15L, 1e16L, 1e17L, 1e18L, 1e19L, 1e20L, 1e21L, 1e22L, 1e23L, 1e24L, 1e25L, 1e26L, 1e27L
+  };
+
+  /* Only as many powers, as fit the long double mantissa on this platform, i.e. 5^n < 2^digits */
+  static const std::ptrdiff_t maxExactPow10= std::numeric_limits<long double>::digits >= 64 ? 27 :
+    (std::numeric_limits<long double>::digits >= 53 ? 22 : 10);
+
+  static const uint64_t maxExactMantissa= std::numeric_limits<long double>::digits >= 64 ? UINT64_MAX :
+    (1ULL << (std::numeric_limits<long double>::digits < 64 ? std::numeric_limits<long double>::digits : 0));
+
+  bool parseLongDouble(const char* str, std::size_t len, long double& value)
+  {
+    const char* end= str + len, *intEnd, *fracEnd;
+    bool negative= false;
+    uint64_t mantissa= 0;
+    std::ptrdiff_t scale= 0, digits;
+
+    if (len > 0 && (*str == '-' || *str == '+')) {
+      negative= (*str == '-');
+      ++str;
+    }
+    intEnd= parseDigits(str, end, mantissa);
+    fracEnd= intEnd;
+
+    if (intEnd < end && *intEnd == '.') {
+      fracEnd= parseDigits(intEnd + 1, end, mantissa);
+      scale= fracEnd - intEnd - 1;
+    }
+    digits= (intEnd - str) + scale;
+    // Exponent, too many digits or no digits at all are left for the generic conversion
+    if (fracEnd != end || digits == 0 || digits > MAX_SAFE_DIGITS || scale > maxExactPow10 || mantissa > maxExactMantissa) {
+      return false;
+    }
+    /* Mantissa and power of 10 are exact, and division is correctly rounded. Thus the result is the same as of the
+       generic conversion */
+    value= static_cast<long double>(mantissa) / exactPow10[scale];
+    if (negative) {
+      value= -value;
+    }
+    return true;
+  }
 }
 }
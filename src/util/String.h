@@ -47,5 +47,12 @@ namespace mariadb
 
   uint64_t stoull(const SQLString& str, std::size_t* pos= nullptr);
   uint64_t stoull(const char* str, std::size_t len= -1, std::size_t* pos = nullptr);
+
+  /* Fast paths for plain decimal numbers, that the text protocol returns for numeric columns. They return false, if the
+     string is anything else, e.g. has spaces, exponent or is out of range. The caller then should fall back to the
+     generic conversion */
+  bool parseInt64(const char* str, std::size_t len, int64_t& value);
+  bool parseUInt64(const char* str, std::size_t len, uint64_t& value);
+  bool parseLongDouble(const char* str, std::size_t len, long double& value);
 }
 }
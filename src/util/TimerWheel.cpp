@@ -0,0 +1,241 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#include <algorithm>
+
+#include "TimerWheel.h"
+
+namespace sql
+{
+namespace mariadb
+{
+  constexpr uint32_t TimerWheel::LEVELS;
+  constexpr uint32_t TimerWheel::FIRST_LEVEL_BITS;
+  constexpr uint32_t TimerWheel::LEVEL_BITS;
+  constexpr uint32_t TimerWheel::FIRST_LEVEL_SIZE;
+  constexpr uint32_t TimerWheel::LEVEL_SIZE;
+  constexpr uint64_t TimerWheel::MAX_DELAY;
+
+  TimerWheel::TimerWheel()
+    : start(std::chrono::steady_clock::now())
+  {
+  }
+
+
+  TimerWheel::~TimerWheel()
+  {
+    {
+      std::lock_guard<std::mutex> localScopeLock(lock);
+      stopping= true;
+    }
+    wakeup.notify_all();
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+
+
+  TimerWheel& TimerWheel::getInstance()
+  {
+    static TimerWheel theInstance;
+    return theInstance;
+  }
+
+
+  uint64_t TimerWheel::now() const
+  {
+    return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+  }
+
+
+  void TimerWheel::place(TimerId id, uint64_t deadline)
+  {
+    // Overdue timer fires on the next tick
+    uint64_t delta= std::min(std::max(deadline, current + 1) - current, MAX_DELAY);
+    uint64_t tick= current + delta;
+
+    if (delta < FIRST_LEVEL_SIZE) {
+      firstLevel[tick & (FIRST_LEVEL_SIZE - 1)].push_back(id);
+      return;
+    }
+    uint32_t shift= FIRST_LEVEL_BITS;
+    for (uint32_t level= 0; level < LEVELS - 1; ++level, shift+= LEVEL_BITS) {
+      if (delta < (1ULL << (shift + LEVEL_BITS)) || level == LEVELS - 2) {
+        levels[level][(tick >> shift) & (LEVEL_SIZE - 1)].push_back(id);
+        return;
+      }
+    }
+  }
+
+
+  /* Moves timers of the slot, the current tick has come to, one or more levels down */
+  void TimerWheel::cascade(uint32_t level)
+  {
+    uint32_t shift= FIRST_LEVEL_BITS + level*LEVEL_BITS;
+    std::vector<TimerId> slot;
+
+    slot.swap(levels[level][(current >> shift) & (LEVEL_SIZE - 1)]);
+    for (auto id : slot) {
+      auto it= timers.find(id);
+      if (it != timers.end()) {
+        place(id, it->second.deadline);
+      }
+    }
+  }
+
+
+  void TimerWheel::advance(std::vector<TimerId>& expired)
+  {
+    ++current;
+
+    uint32_t shift= FIRST_LEVEL_BITS;
+    for (uint32_t level= 0; level < LEVELS - 1 && (current & ((1ULL << shift) - 1)) == 0; ++level, shift+= LEVEL_BITS) {
+      cascade(level);
+    }
+
+    std::vector<TimerId> slot;
+    slot.swap(firstLevel[current & (FIRST_LEVEL_SIZE - 1)]);
+    for (auto id : slot) {
+      auto it= timers.find(id);
+      if (it == timers.end()) {
+        continue;
+      }
+      if (it->second.deadline <= current) {
+        expired.push_back(id);
+      }
+      else {
+        place(id, it->second.deadline);
+      }
+    }
+  }
+
+
+  /* The nearest tick with timers on the first level, or the tick, the first level wraps at */
+  uint64_t TimerWheel::nextWakeup() const
+  {
+    uint64_t wrap= (current | (FIRST_LEVEL_SIZE - 1)) + 1;
+
+    for (uint64_t tick= current + 1; tick < wrap; ++tick) {
+      if (!firstLevel[tick & (FIRST_LEVEL_SIZE - 1)].empty()) {
+        return tick;
+      }
+    }
+    return wrap;
+  }
+
+
+  void TimerWheel::run()
+  {
+    std::unique_lock<std::mutex> localScopeLock(lock);
+    std::vector<TimerId> expired;
+
+    while (!stopping) {
+      uint64_t target= now();
+      while (current < target) {
+        advance(expired);
+      }
+
+      for (auto id : expired) {
+        // The timer could be cancelled, while the previous task was running
+        auto it= timers.find(id);
+        if (it == timers.end()) {
+          continue;
+        }
+        std::function<void()> task(std::move(it->second.task));
+        timers.erase(it);
+        running= id;
+        localScopeLock.unlock();
+        try {
+          task();
+        }
+        catch (...) {
+        }
+        localScopeLock.lock();
+        running= 0;
+        taskDone.notify_all();
+      }
+      if (!expired.empty()) {
+        expired.clear();
+        // Tasks took some time
+        continue;
+      }
+
+      if (timers.empty()) {
+        plannedWakeup= UINT64_MAX;
+        wakeup.wait(localScopeLock);
+      }
+      else {
+        plannedWakeup= nextWakeup();
+        wakeup.wait_until(localScopeLock, start + std::chrono::milliseconds(plannedWakeup));
+      }
+    }
+  }
+
+
+  TimerWheel::TimerId TimerWheel::schedule(std::chrono::milliseconds delay, std::function<void()> task)
+  {
+    std::unique_lock<std::mutex> localScopeLock(lock);
+
+    if (timers.empty()) {
+      // Nothing to advance through. Dropping ids of cancelled timers, that are still in slots
+      for (auto& slot : firstLevel) {
+        slot.clear();
+      }
+      for (auto& level : levels) {
+        for (auto& slot : level) {
+          slot.clear();
+        }
+      }
+      current= std::max(current, now());
+    }
+
+    TimerId id= nextId++;
+    // Plus one tick, since the current one has partly passed - the timer never fires early
+    uint64_t deadline= now() + static_cast<uint64_t>(std::max<int64_t>(delay.count(), 0)) + 1;
+    timers.emplace(id, Timer{deadline, std::move(task)});
+    place(id, deadline);
+
+    if (!worker.joinable()) {
+      worker= std::thread(&TimerWheel::run, this);
+    }
+    else if (deadline < plannedWakeup) {
+      localScopeLock.unlock();
+      wakeup.notify_one();
+    }
+    return id;
+  }
+
+
+  bool TimerWheel::cancel(TimerId id)
+  {
+    std::unique_lock<std::mutex> localScopeLock(lock);
+
+    if (timers.erase(id) > 0) {
+      return true;
+    }
+    while (running == id) {
+      taskDone.wait(localScopeLock);
+    }
+    return false;
+  }
+
+}
+}
@@ -0,0 +1,102 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _TIMERWHEEL_H_
+#define _TIMERWHEEL_H_
+
+#include <array>
+#include <cstdint>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace sql
+{
+namespace mariadb
+{
+
+/* Process wide hierarchical timer wheel with 1ms tick, used for client side query deadlines. The first level has a
+   slot per tick for the nearest 256ms, each next level has 64 slots, where every slot covers the whole turn of the
+   previous level. Timers are moved one level down, when the lower level wraps around, so scheduling and cancelling
+   are O(1), and the thread wakes up only for ticks, that have timers, or to move timers down.
+   Tasks are run by the wheel's thread one after another, and thus have to be short */
+class TimerWheel final
+{
+  static constexpr uint32_t LEVELS= 4;
+  static constexpr uint32_t FIRST_LEVEL_BITS= 8;
+  static constexpr uint32_t LEVEL_BITS= 6;
+  static constexpr uint32_t FIRST_LEVEL_SIZE= 1 << FIRST_LEVEL_BITS;
+  static constexpr uint32_t LEVEL_SIZE= 1 << LEVEL_BITS;
+  /* Longer delays are scheduled for the farthest slot, and re-scheduled from there */
+  static constexpr uint64_t MAX_DELAY= (1ULL << (FIRST_LEVEL_BITS + (LEVELS - 1)*LEVEL_BITS)) - 1;
+
+public:
+  typedef uint64_t TimerId;
+
+private:
+  struct Timer
+  {
+    uint64_t deadline;
+    std::function<void()> task;
+  };
+
+  std::mutex lock;
+  std::condition_variable wakeup;
+  std::condition_variable taskDone;
+  std::thread worker;
+  bool stopping= false;
+  const std::chrono::steady_clock::time_point start;
+  /* The last processed tick */
+  uint64_t current= 0;
+  /* The tick, the thread is going to wake up at */
+  uint64_t plannedWakeup= UINT64_MAX;
+  TimerId nextId= 1;
+  TimerId running= 0;
+  std::unordered_map<TimerId, Timer> timers;
+  /* Slots contain ids of timers. Ids of cancelled timers are skipped when the slot is processed */
+  std::array<std::vector<TimerId>, FIRST_LEVEL_SIZE> firstLevel;
+  std::array<std::array<std::vector<TimerId>, LEVEL_SIZE>, LEVELS - 1> levels;
+
+  TimerWheel();
+  ~TimerWheel();
+  uint64_t now() const;
+  /* Methods below have to be called under the lock */
+  void place(TimerId id, uint64_t deadline);
+  void cascade(uint32_t level);
+  void advance(std::vector<TimerId>& expired);
+  uint64_t nextWakeup() const;
+  void run();
+
+public:
+  static TimerWheel& getInstance();
+
+  TimerId schedule(std::chrono::milliseconds delay, std::function<void()> task);
+  /* Returns true, if the timer has been cancelled before it fired. If its task is running, waits until it's finished.
+     Must not be called from a task */
+  bool cancel(TimerId id);
+};
+
+}
+}
+#endif
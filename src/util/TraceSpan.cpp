@@ -0,0 +1,115 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+
+#include <cstring>
+#include <exception>
+
+#include "TraceSpan.h"
+#include "Protocol.h"
+#include "util/MetricsRecorder.h"
+#include "util/ClientPrepareResult.h"
+
+namespace sql
+{
+namespace mariadb
+{
+  std::atomic<Tracer*> TraceSpan::installed(nullptr);
+
+  void TraceSpan::setTracer(Tracer* tracer)
+  {
+    installed.store(tracer, std::memory_order_release);
+  }
+
+
+  void TraceSpan::start(const char* operation, Protocol* _protocol, const SQLString* sql, std::size_t batchSize)
+  {
+    // Preparing is not an execution of the statement
+    if (recordDigest && std::strcmp(operation, "prepare") == 0) {
+      recordDigest= false;
+      if (tracer == nullptr) {
+        return;
+      }
+    }
+    protocol= _protocol;
+    attributes.operation= operation;
+    attributes.batchSize= batchSize;
+    if (sql != nullptr) {
+      attributes.sql= sql->c_str();
+      attributes.sqlLength= sql->length();
+      digest= ClientPrepareResult::digest(*sql, protocol->noBackslashEscapes());
+      attributes.digest= digest.c_str();
+    }
+    const HostAddress& host= protocol->getHostAddress();
+    attributes.host= host.host.c_str();
+    attributes.port= host.port;
+    attributes.serverThreadId= protocol->getServerThreadId();
+
+    MetricsRecorder& metrics= protocol->getMetrics();
+    rowsAtStart= metrics.rowsFetched.load(std::memory_order_relaxed);
+    bytesSentAtStart= metrics.bytesSent.load(std::memory_order_relaxed);
+    bytesReceivedAtStart= metrics.bytesReceived.load(std::memory_order_relaxed);
+
+    if (recordDigest) {
+      startTime= std::chrono::steady_clock::now();
+    }
+    if (tracer == nullptr) {
+      return;
+    }
+    try {
+      span= tracer->startSpan(attributes);
+    }
+    catch (std::exception&) {
+      // Tracer's failure is not the operation's one
+      tracer= nullptr;
+    }
+  }
+
+
+  void TraceSpan::end()
+  {
+    MetricsRecorder& metrics= protocol->getMetrics();
+    attributes.rowCount= metrics.rowsFetched.load(std::memory_order_relaxed) - rowsAtStart;
+    attributes.bytesSent= metrics.bytesSent.load(std::memory_order_relaxed) - bytesSentAtStart;
+    attributes.bytesReceived= metrics.bytesReceived.load(std::memory_order_relaxed) - bytesReceivedAtStart;
+    attributes.serverThreadId= protocol->getServerThreadId();
+    attributes.failed= returnedError || std::uncaught_exception();
+
+    if (recordDigest) {
+      try {
+        StatementDigestTable::getInstance().record(digest, static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count()),
+          attributes.rowCount, attributes.failed);
+      }
+      catch (std::exception&) {
+      }
+    }
+    if (tracer == nullptr) {
+      return;
+    }
+    try {
+      tracer->endSpan(span, attributes);
+    }
+    catch (std::exception&) {
+    }
+  }
+
+}
+}
@@ -0,0 +1,94 @@
+/************************************************************************************
+   Copyright (C) 2023 MariaDB Corporation AB
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not see <http://www.gnu.org/licenses>
+   or write to the Free Software Foundation, Inc.,
+   51 Franklin St., Fifth Floor, Boston, MA 02110, USA
+*************************************************************************************/
+
+
+#ifndef _TRACESPAN_H_
+#define _TRACESPAN_H_
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <string>
+
+#include "Tracing.hpp"
+#include "Consts.h"
+#include "util/StatementDigestTable.h"
+#include "util/Probes.h"
+
+namespace sql
+{
+namespace mariadb
+{
+class Protocol;
+
+/* Scope of a traced protocol operation. The span also feeds the statement digests table, if it is enabled. Without
+   installed tracer and digests it costs two loads and a branch - the query text is passed by pointer, and nothing is
+   computed. The span is failed, if it ends with an exception, or the error is returned with fail().
+   The span also fires operation__start/operation__done static probes(util/Probes.h) */
+class TraceSpan final
+{
+  static std::atomic<Tracer*> installed;
+
+  Tracer* tracer;
+  bool recordDigest;
+  const char* operation;
+  void* span= nullptr;
+  Protocol* protocol= nullptr;
+  SpanAttributes attributes;
+  std::string digest;
+  uint64_t rowsAtStart= 0;
+  uint64_t bytesSentAtStart= 0;
+  uint64_t bytesReceivedAtStart= 0;
+  std::chrono::steady_clock::time_point startTime;
+  bool returnedError= false;
+
+  void start(const char* operation, Protocol* protocol, const SQLString* sql, std::size_t batchSize);
+  void end();
+
+public:
+  TraceSpan(const char* _operation, Protocol* _protocol, const SQLString* sql= nullptr, std::size_t batchSize= 1)
+    : tracer(installed.load(std::memory_order_acquire))
+    , recordDigest(sql != nullptr && StatementDigestTable::isEnabled())
+    , operation(_operation)
+    , protocol(_protocol)
+  {
+    MARIADB_PROBE4(operation__start, operation, sql != nullptr ? sql->c_str() : nullptr,
+      sql != nullptr ? sql->length() : 0, protocol);
+    if (tracer != nullptr || recordDigest) {
+      start(operation, _protocol, sql, batchSize);
+    }
+  }
+  ~TraceSpan()
+  {
+    if (tracer != nullptr || recordDigest) {
+      end();
+    }
+    MARIADB_PROBE3(operation__done, operation, static_cast<int>(returnedError || std::uncaught_exception()), protocol);
+  }
+  void fail() { returnedError= true; }
+  TraceSpan(const TraceSpan&)= delete;
+  TraceSpan& operator=(const TraceSpan&)= delete;
+
+  /* nullptr uninstalls the tracer. Spans, that have already started, are ended with the tracer they started with */
+  static void setTracer(Tracer* tracer);
+};
+
+}
+}
+#endif
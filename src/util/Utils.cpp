@@ -19,13 +19,27 @@
 
 
 #include <cctype>
+#include <cstring>
 #include <array>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# define MADB_SSE2_ESCAPE 1
+# include <emmintrin.h>
+# ifdef _MSC_VER
+#  include <intrin.h>
+# endif
+#endif
+
 #include "Utils.h"
 
 #include "LogQueryTool.h"
-#include "logger/ProtocolLoggingProxy.h"
+#ifndef MARIADB_NO_PROTOCOL_LOGGING
+# include "logger/ProtocolLoggingProxy.h"
+#endif
 #include "protocol/MasterProtocol.h"
+#ifndef MARIADB_NO_FAILOVER
+# include "failover/ReplicationProxy.h"
+#endif
 
 
 namespace sql
@@ -80,29 +94,157 @@ namespace mariadb
     return replace(escaped, "\\", "\\\\");
   }
 
+#ifdef MADB_SSE2_ESCAPE
+  static inline uint32_t lowestBit(uint32_t mask)
+  {
+# ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<uint32_t>(index);
+# else
+    return static_cast<uint32_t>(__builtin_ctz(mask));
+# endif
+  }
+
+  /* Returns the position of the first byte, that has to be escaped with backslash, or end. 16 bytes per step */
+  static const char* findBackslashEscaped(const char* it, const char* end)
+  {
+    const __m128i quote= _mm_set1_epi8('\''), dblQuote= _mm_set1_epi8('"'), backslash= _mm_set1_epi8('\\'),
+      zero= _mm_setzero_si128();
+
+    while (end - it >= 16) {
+      __m128i chunk= _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+      __m128i hits= _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, dblQuote)),
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, backslash), _mm_cmpeq_epi8(chunk, zero)));
+      uint32_t mask= static_cast<uint32_t>(_mm_movemask_epi8(hits));
+      if (mask != 0) {
+        return it + lowestBit(mask);
+      }
+      it+= 16;
+    }
+    while (it < end && *it != '\'' && *it != '"' && *it != '\\' && *it != '\0') {
+      ++it;
+    }
+    return it;
+  }
+
+  /* Returns the position of the first quote, or end */
+  static const char* findQuote(const char* it, const char* end)
+  {
+    const __m128i quote= _mm_set1_epi8('\'');
+
+    while (end - it >= 16) {
+      __m128i chunk= _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+      uint32_t mask= static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote)));
+      if (mask != 0) {
+        return it + lowestBit(mask);
+      }
+      it+= 16;
+    }
+    while (it < end && *it != '\'') {
+      ++it;
+    }
+    return it;
+  }
+#else
+  static const uint64_t LOW_BITS= 0x0101010101010101ULL;
+  static const uint64_t HIGH_BITS= 0x8080808080808080ULL;
+
+  /* If any byte of the word equals to c. The exact position is not needed - the word with a hit is rescanned bytewise */
+  static inline bool hasByte(uint64_t word, unsigned char c)
+  {
+    uint64_t v= word ^ (LOW_BITS * c);
+    return ((v - LOW_BITS) & ~v & HIGH_BITS) != 0;
+  }
+
+  /* Returns the position of the first byte, that has to be escaped with backslash, or end. 8 bytes per step */
+  static const char* findBackslashEscaped(const char* it, const char* end)
+  {
+    uint64_t word;
+    while (end - it >= 8) {
+      std::memcpy(&word, it, sizeof(word));
+      if (hasByte(word, '\'') || hasByte(word, '"') || hasByte(word, '\\') || hasByte(word, '\0')) {
+        break;
+      }
+      it+= 8;
+    }
+    while (it < end && *it != '\'' && *it != '"' && *it != '\\' && *it != '\0') {
+      ++it;
+    }
+    return it;
+  }
+
+  /* Returns the position of the first quote, or end */
+  static const char* findQuote(const char* it, const char* end)
+  {
+    uint64_t word;
+    while (end - it >= 8) {
+      std::memcpy(&word, it, sizeof(word));
+      if (hasByte(word, '\'')) {
+        break;
+      }
+      it+= 8;
+    }
+    while (it < end && *it != '\'') {
+      ++it;
+    }
+    return it;
+  }
+#endif
+
+  /* The byte, that ends quoted string, or starts its escape sequence, also needs escaping, so it's found by the same
+     kernel. Stops at the zero byte, too, what costs only one more iteration of the caller */
+  const char* Utils::skipLexState(LexState state, const char* it, const char* end)
+  {
+    const void* found= nullptr;
+
+    switch (state) {
+    case LexState::SqlString:
+      return findBackslashEscaped(it, end);
+    case LexState::Backtick:
+      found= std::memchr(it, '`', end - it);
+      break;
+    case LexState::SlashStarComment:
+      found= std::memchr(it, '/', end - it);
+      break;
+    case LexState::EOLComment:
+      found= std::memchr(it, '\n', end - it);
+      break;
+    default:
+      return it;
+    }
+    return found != nullptr ? static_cast<const char*>(found) : end;
+  }
+
+  /* Clean spans between the bytes, that need escaping, are found by the kernels above and appended at once */
   void Utils::escapeData(const char* in, size_t len, bool noBackslashEscapes, SQLString& out)
   {
     std::string &realOut= StringImp::get(out);
+    const char* end= in + len;
     out.reserve(out.length() + len + 64);
 
-    //TODO: can be easily optimized
     if (noBackslashEscapes) {
-      for (size_t i = 0; i < len; i++) {
-        if (QUOTE == in[i]) {
-          realOut.push_back(QUOTE);
+      while (in < end) {
+        const char* special= findQuote(in, end);
+        realOut.append(in, special - in);
+        if (special == end) {
+          break;
         }
-        realOut.push_back(in[i]);
+        realOut.push_back(QUOTE);
+        realOut.push_back(QUOTE);
+        in= special + 1;
       }
     }
     else {
-      for (size_t i = 0; i < len; i++) {
-        if (in[i] == QUOTE
-          || in[i] == BACKSLASH
-          || in[i] == DBL_QUOTE
-          || in[i] == ZERO_BYTE) {
-          realOut.push_back('\\');
+      while (in < end) {
+        const char* special= findBackslashEscaped(in, end);
+        realOut.append(in, special - in);
+        if (special == end) {
+          break;
         }
-        realOut.push_back(in[i]);
+        realOut.push_back('\\');
+        realOut.push_back(*special);
+        in= special + 1;
       }
     }
   }
@@ -377,10 +519,10 @@ namespace mariadb
 
   SQLString Utils::nativeSql(const SQLString& sqlStr, Protocol* protocol)
   {
-    const std::string &sql= StringImp::get(sqlStr);
-    if (sql.find_first_of('{') == std::string::npos) {
-      return sql;
+    if (!hasEscapes(sqlStr)) {
+      return sqlStr;
     }
+    const std::string &sql= StringImp::get(sqlStr);
 
     SQLString escapeSequenceBuf;
     SQLString sqlBuffer;
@@ -398,6 +540,19 @@ namespace mariadb
 
     for (auto it= sql.begin(); it < sql.end(); ++it)
     {
+      // Backtick quoted identifiers are rare, and the scan would have to stop at backslashes inside them anyway
+      if (inQuote && quoteChar != '`' && lastChar != '\\') {
+        const char* run= &*it;
+        const char* next= skipLexState(LexState::SqlString, run, sql.data() + sql.length());
+        if (next != run) {
+          (inEscapeSeq > 0 ? escapeSequenceBuf : sqlBuffer).append(run, next - run);
+          it+= next - run;
+          if (it == sql.end()) {
+            break;
+          }
+          lastChar= *(next - 1);
+        }
+      }
       char car= *it;
       if (lastChar == '\\' && !protocol->noBackslashEscapes()){
         sqlBuffer.append(car);
@@ -500,11 +655,17 @@ namespace mariadb
     */
   Shared::Protocol Utils::retrieveProxy(UrlParser& urlParser, GlobalStateInfo* globalInfo)
   {
-    Shared::mutex lock(new std::mutex());
+    Shared::mutex lock(new ConnectionMutex(urlParser.getOptions()->threadSafeConnection));
     std::shared_ptr<UrlParser> shUrlParser(&urlParser);
 
     switch (urlParser.getHaMode())
     {
+      case REPLICATION:
+#ifdef MARIADB_NO_FAILOVER
+        throw SQLFeatureNotImplementedException("Replication is not compiled in this build of the connector");
+#else
+        return Shared::Protocol(getProxyLoggingIfNeeded(urlParser, new ReplicationProxy(shUrlParser, globalInfo)));
+#endif
       case AURORA:
 #ifdef AURORA_SUPPORT_IMPLEMENTED
         return getProxyLoggingIfNeeded(
@@ -514,16 +675,6 @@ namespace mariadb
               AuroraProtocol.class.getClassLoader(),
               new Class[] {Protocol&.class},
               new FailoverProxy(new AuroraListener(urlParser,globalInfo), lock)));
-#endif
-      case REPLICATION:
-#ifdef REPLICATION_SUPPORT_IMPLEMENTED
-        return getProxyLoggingIfNeeded(
-            urlParser,
-            (Protocol&)
-            Proxy.newProxyInstance(
-              MastersSlavesProtocol.class.getClassLoader(),
-              new Class[] {Protocol&.class},
-              new FailoverProxy(new MastersSlavesListener(urlParser,globalInfo), lock)));
 #endif
       case LOADBALANCE:
       case SEQUENTIAL:
@@ -540,6 +691,9 @@ namespace mariadb
         throw SQLFeatureNotImplementedException(SQLString("Support of the HA mode") + HaModeStrMap[urlParser.getHaMode()] + "is not yet implemented");
 #endif
       default:
+        if (urlParser.getOptions()->connectAttemptDelay > 0 && urlParser.getHostAddresses().size() > 1) {
+          return MasterProtocol::connectRace(shUrlParser, globalInfo);
+        }
         Shared::Protocol protocol(getProxyLoggingIfNeeded(urlParser, new MasterProtocol(shUrlParser, globalInfo, lock)));
         protocol->connectWithoutProxy();
 
@@ -549,6 +703,7 @@ namespace mariadb
 
   Protocol* Utils::getProxyLoggingIfNeeded(const UrlParser &urlParser, Protocol* protocol)
   {
+#ifndef MARIADB_NO_PROTOCOL_LOGGING
     /* TODO: profileSql and slowQueryThresholdNanos should be probably hidded/disabled*/
     if (urlParser.getOptions()->profileSql
         || urlParser.getOptions()->slowQueryThresholdNanos > 0)
@@ -558,6 +713,7 @@ namespace mariadb
 
       return protocol;
     }
+#endif
     /* Probably reference won't work at some point */
     return protocol;
   }
@@ -1211,5 +1367,37 @@ IP_V6_COMPRESSED( "^(([0-9A-Fa-f]{1,4}(:[0-9A-Fa-f]{1,4}){0,5})?)::(([0-9A-Fa-f]
     skipCommentsAndBlanks(sql, it);
     return it - sql.cbegin();
   }
+
+  /**
+    * Tells if the query only reads data, and thus may be safely executed once more. That is a single SELECT, that does
+    * not write anything with INTO, or SHOW, DESCRIBE or EXPLAIN. Queries are judged conservatively, e.g. anything
+    * containing ';' is treated as multistatement.
+    *
+    * @param query query to check
+    * @return true if the query is a read
+    */
+  bool Utils::isReadQuery(const SQLString& query)
+  {
+    static const char* readCommands[]= {"select", "show", "describe", "desc", "explain"};
+    const std::string& sql= StringImp::get(query);
+    std::size_t start= skipCommentsAndBlanks(sql);
+
+    if (sql.find(';', start) != std::string::npos) {
+      return false;
+    }
+    for (auto command : readCommands) {
+      std::size_t len= std::strlen(command);
+      if (sql.length() - start < len) {
+        continue;
+      }
+      auto it= sql.cbegin() + start;
+      if (strnicmp(it, command, len) || (it != sql.cend() && (std::isalnum(*it) || *it == '_'))) {
+        continue;
+      }
+      // SELECT ... INTO writes into variables or files
+      return command != readCommands[0] || findstrni(sql, "into", 4) == std::string::npos;
+    }
+    return false;
+  }
 }
 }
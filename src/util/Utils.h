@@ -21,6 +21,7 @@
 #ifndef _MADBCPPUTILS_H_
 #define _MADBCPPUTILS_H_
 
+#include <cstring>
 #include <mutex>
 #include <vector>
 
@@ -55,12 +56,17 @@ private:
   static SQLString replaceFunctionParameter(const SQLString& functionString, Protocol* protocol);
   static SQLString resolveEscapes(SQLString& escaped, Protocol* protocol);
 public:
+  /* If the query may contain JDBC escapes, i.e. has '{' anywhere */
+  static bool hasEscapes(const SQLString& sql)
+  {
+    return std::memchr(sql.c_str(), '{', sql.length()) != nullptr;
+  }
   static SQLString nativeSql(const SQLString& sql, Protocol* protocol);
+  /* Returns the position of the first character, that may change the lexer's state, or end. I.e. the end of the
+     skipped run of characters, that mean nothing in the state. Normal and Escape states skip nothing */
+  static const char* skipLexState(LexState state, const char* it, const char* end);
   static Shared::Protocol retrieveProxy(UrlParser& urlParser, GlobalStateInfo* globalInfo);
-
-private:
   static Protocol* getProxyLoggingIfNeeded(const UrlParser& urlParser, Protocol* protocol);
-public:
 #ifdef WE_DEAL_WITH_TIMEZONES
   static TimeZone& getTimeZone(const SQLString& id);
 #endif
@@ -83,6 +89,7 @@ public:
   static std::size_t tokenize(std::vector<sql::bytes>& tokens, const char* cstring, const char *separator);
   static std::string::const_iterator& skipCommentsAndBlanks(const std::string &sql, std::string::const_iterator& start);
   static std::size_t skipCommentsAndBlanks(const std::string &sql, std::size_t start= 0);
+  static bool isReadQuery(const SQLString& sql);
 
   enum Parse {
     Normal,
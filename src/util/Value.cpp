@@ -28,7 +28,37 @@ namespace mariadb
 {
   extern const SQLString emptyStr;
 
-  Value::Value(const Value& other) 
+  Value::Value(const Value& other)
+  {
+    copyValue(other);
+  }
+
+
+  Value::Value(Value&& other) noexcept
+  {
+    moveValue(other);
+  }
+
+
+  /* Has to be called on the object, that does not hold the string. Only the string changes hands, the rest is copied */
+  void Value::moveValue(Value& other) noexcept
+  {
+    if (other.type == VSTRING && !other.isPtr)
+    {
+      type=  VSTRING;
+      isPtr= false;
+      new (&value.sv) SQLString(std::move(other.value.sv));
+      other.reset();
+    }
+    else
+    {
+      copyValue(other);
+    }
+  }
+
+
+  /* Has to be called on the object, that does not hold the string */
+  void Value::copyValue(const Value& other)
   {
     type= other.type;
     isPtr= other.isPtr;
@@ -83,6 +113,12 @@ namespace mariadb
   }
 
 
+  Value::Value(SQLString&& v) : type(VSTRING), isPtr(false)
+  {
+    new (&value.sv) SQLString(std::move(v));
+  }
+
+
   Value::Value(const char* v) : type(VSTRING), isPtr(false)
   {
     new (&value.sv) SQLString(v);
@@ -112,6 +148,47 @@ namespace mariadb
     value.pv= static_cast<void*>(v);
   }
 
+  Value& Value::operator=(const Value& other)
+  {
+    if (this == &other)
+    {
+      return *this;
+    }
+    if (other.type == VSTRING && !other.isPtr)
+    {
+      *this= other.value.sv;
+    }
+    else
+    {
+      reset();
+      copyValue(other);
+    }
+    return *this;
+  }
+
+
+  Value& Value::operator=(Value&& other) noexcept
+  {
+    if (this != &other)
+    {
+      reset();
+      moveValue(other);
+    }
+    return *this;
+  }
+
+
+  SQLString & Value::operator=(SQLString&& str)
+  {
+    reset();
+    type=  VSTRING;
+    isPtr= false;
+    new (&value.sv) SQLString(std::move(str));
+
+    return value.sv;
+  }
+
+
   SQLString & Value::operator=(const SQLString &str)
   {
 
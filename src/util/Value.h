@@ -59,21 +59,32 @@ private:
   enum valueType  type;
   bool            isPtr;
 
+  void copyValue(const Value& other);
+  void moveValue(Value& other) noexcept;
+
 public:
   Value() : value(), type(VNONE), isPtr(false) {}
   Value(const Value& other);
+  /* Takes over the string of the other, which becomes empty */
+  Value(Value&& other) noexcept;
 
   Value(int32_t v);
   Value(int64_t v);
   Value(bool v);
   Value(const SQLString &v);
+  Value(SQLString&& v);
   Value(const char* v);
   Value(int32_t* v);
   Value(int64_t* v);
   Value(bool* v);
   Value(SQLString *v);
 
+  /* Assigning the value of the same type reuses the string, that the object already holds, thus the object can be
+     filled again and again without allocations, once its string is big enough */
+  Value&     operator=(const Value& other);
+  Value&     operator=(Value&& other) noexcept;
   SQLString& operator=(const SQLString&);
+  SQLString& operator=(SQLString&&);
   int32_t&   operator=(int32_t);
   int64_t&   operator=(int64_t);
   bool&      operator=(bool);
@@ -43,7 +43,10 @@
 #include <memory>
 #include <list>
 #include <thread>
+#include <atomic>
+#include <mutex>
 #include <functional>
+#include <algorithm>
 
 namespace testsuite
 {
@@ -3466,5 +3469,1369 @@ void connection::setUp()
   stmt.reset(con->createStatement());
 }
 
+
+static int64_t connectionId(sql::Connection* conn)
+{
+  std::unique_ptr<sql::Statement> st(conn->createStatement());
+  std::unique_ptr<sql::ResultSet> rs(st->executeQuery("SELECT CONNECTION_ID()"));
+  rs->next();
+  return rs->getLong(1);
+}
+
+void connection::pool()
+{
+  sql::ConnectOptionsMap p{{"user", user}, {"password", passwd}, {"useTls", useTls ? "true" : "false"}, {"pool", "true"},
+    {"maxPoolSize", "2"}, {"connectTimeout", "1000"}};
+
+  Connection c1(driver->connect(url, p)), c2(driver->connect(url, p));
+  int64_t id1= connectionId(c1.get()), id2= connectionId(c2.get());
+  ASSERT(id1 != id2);
+
+  // Pool is exhausted
+  try {
+    Connection c3(driver->connect(url, p));
+    FAIL("Pool did not throw on exhaustion");
+  }
+  catch (sql::SQLException& e) {
+    ASSERT_EQUALS("08", e.getSQLState());
+  }
+
+  int32_t isolation= c1->getTransactionIsolation();
+  c1->setAutoCommit(false);
+  c1->setTransactionIsolation(isolation == sql::TRANSACTION_SERIALIZABLE ? sql::TRANSACTION_READ_COMMITTED :
+    sql::TRANSACTION_SERIALIZABLE);
+  c1->close();
+  ASSERT(c1->isClosed());
+  try {
+    stmt.reset(c1->createStatement());
+    FAIL("Closed connection object can be used");
+  }
+  catch (sql::SQLException&) {
+  }
+  // The only idle connection is the one released above, and its state has been reset
+  Connection c3(driver->connect(url, p));
+  ASSERT_EQUALS(id1, connectionId(c3.get()));
+  ASSERT(c3->getAutoCommit());
+  ASSERT_EQUALS(isolation, c3->getTransactionIsolation());
+
+  // Destroying connection object gives the connection back to the pool as well
+  c2.reset();
+  Connection c4(driver->connect(url, p));
+  ASSERT_EQUALS(id2, connectionId(c4.get()));
+}
+
+
+void connection::pipeline()
+{
+  createSchemaObject("TABLE", "pipeline", "(id INT NOT NULL PRIMARY KEY, val VARCHAR(10))");
+  std::unique_ptr<sql::Pipeline> pipe(con->createPipeline());
+  pstmt.reset(con->prepareStatement("INSERT INTO pipeline VALUES(?, ?)"));
+
+  pipe->add("INSERT INTO pipeline VALUES(1, 'a')");
+  pstmt->setInt(1, 2);
+  pstmt->setString(2, "b");
+  pipe->add(pstmt.get());
+  // Duplicate key
+  pipe->add("INSERT INTO pipeline VALUES(1, 'c')")->add("SELECT val FROM pipeline ORDER BY id");
+  ASSERT_EQUALS(static_cast<uint64_t>(4), static_cast<uint64_t>(pipe->size()));
+
+  try {
+    pipe->execute();
+    FAIL("Error of the failed query has not been thrown");
+  }
+  catch (sql::SQLException& e) {
+    ASSERT_EQUALS(1062, e.getErrorCode());
+  }
+  ASSERT_EQUALS(static_cast<uint64_t>(0), static_cast<uint64_t>(pipe->size()));
+  ASSERT_EQUALS(static_cast<int64_t>(1), pipe->getUpdateCount(0));
+  ASSERT_EQUALS(static_cast<int64_t>(1), pipe->getUpdateCount(1));
+  ASSERT_EQUALS(static_cast<int64_t>(sql::Statement::EXECUTE_FAILED), pipe->getUpdateCount(2));
+  ASSERT(pipe->getResultSet(0) == nullptr);
+
+  res.reset(pipe->getResultSet(3));
+  ASSERT(res.get() != nullptr);
+  ASSERT(res->next());
+  ASSERT_EQUALS("a", res->getString(1));
+  ASSERT(res->next());
+  ASSERT_EQUALS("b", res->getString(1));
+  ASSERT(!res->next());
+
+  // Connection is in sync after the pipeline
+  stmt.reset(con->createStatement());
+  res.reset(stmt->executeQuery("SELECT COUNT(*) FROM pipeline"));
+  ASSERT(res->next());
+  ASSERT_EQUALS(2, res->getInt(1));
+}
+
+namespace
+{
+class TestRowProducer : public sql::RowProducer
+{
+  int32_t rows;
+  int32_t current= 0;
+  std::size_t valuesInLastRow;
+
+public:
+  TestRowProducer(int32_t _rows, std::size_t _valuesInLastRow= 3) : rows(_rows), valuesInLastRow(_valuesInLastRow) {}
+
+  bool nextRow(sql::RowWriter& writer)
+  {
+    if (current == rows) {
+      return false;
+    }
+    ++current;
+    writer.setInt64(current);
+    if (current % 10 == 0) {
+      writer.setNull();
+    }
+    else {
+      writer.setString("tab\tnew\nline\\" + std::to_string(current));
+    }
+    if (current < rows || valuesInLastRow > 2) {
+      writer.setDouble(current / 4.0);
+    }
+    return true;
+  }
+};
+
+class FailingRowProducer : public sql::RowProducer
+{
+public:
+  bool nextRow(sql::RowWriter&)
+  {
+    throw std::runtime_error("Producer has failed");
+  }
+};
+}
+
+void connection::bulkLoad()
+{
+  sql::Properties p{{"user", user}, {"password", passwd}, {"allowLocalInfile", "true"}, {"useTls", useTls ? "true" : "false"}};
+  sql::SQLString onServer(getVariableValue("local_infile", true));
+
+  if (onServer.compare("0") == 0) {
+    try {
+      setVariableValue("local_infile", "ON", true);
+    }
+    catch (sql::SQLException&) {
+      SKIP("local_infile is OFF at the server, and test could not change that");
+    }
+  }
+  con.reset(driver->connect(url, p));
+  stmt.reset(con->createStatement());
+  createSchemaObject("TABLE", "bulk_load", "(id INT NOT NULL PRIMARY KEY, val VARCHAR(64), num DOUBLE, extra INT DEFAULT 7)");
+
+  const sql::SQLString columns[]= {"id", "val", "num"};
+  TestRowProducer producer(1000);
+
+  ASSERT_EQUALS(static_cast<int64_t>(1000), con->bulkLoad("bulk_load", columns, 3, producer));
+
+  res.reset(stmt->executeQuery("SELECT id, val, num, extra FROM bulk_load ORDER BY id"));
+  for (int32_t i= 1; i <= 1000; ++i) {
+    ASSERT(res->next());
+    ASSERT_EQUALS(i, res->getInt(1));
+    if (i % 10 == 0) {
+      ASSERT(res->getString(2).empty());
+      ASSERT(res->wasNull());
+    }
+    else {
+      ASSERT_EQUALS("tab\tnew\nline\\" + std::to_string(i), res->getString(2));
+    }
+    ASSERT_EQUALS(i / 4.0, res->getDouble(3));
+    ASSERT_EQUALS(7, res->getInt(4));
+  }
+  ASSERT(!res->next());
+
+  stmt->executeUpdate("DELETE FROM bulk_load");
+  TestRowProducer shortRow(5, 2);
+  try {
+    con->bulkLoad("bulk_load", columns, 3, shortRow);
+    FAIL("Row with wrong number of values has been loaded");
+  }
+  catch (sql::SQLException& e) {
+    ASSERT_EQUALS("21S01", e.getSQLState());
+  }
+
+  FailingRowProducer failing;
+  try {
+    con->bulkLoad("bulk_load", nullptr, 0, failing);
+    FAIL("Exception of the producer has not been thrown");
+  }
+  catch (std::runtime_error& e) {
+    ASSERT_EQUALS("Producer has failed", e.what());
+  }
+  // Connection is in sync after failed loads
+  res.reset(stmt->executeQuery("SELECT COUNT(*) FROM bulk_load"));
+  ASSERT(res->next());
+  ASSERT_EQUALS(0, res->getInt(1));
+}
+
+
+void connection::connectionDescriptor()
+{
+  sql::ConnectOptionsMap p{{"user", user}, {"password", passwd}, {"useTls", useTls ? "true" : "false"}};
+  std::unique_ptr<sql::ConnectionDescriptor> descriptor(driver->prepareConnection(url, p));
+  ASSERT(descriptor.get() != nullptr);
+
+  Connection c1(descriptor->connect()), c2(descriptor->connect());
+  ASSERT(connectionId(c1.get()) != connectionId(c2.get()));
+  c1->setSchema("mysql");
+  ASSERT_EQUALS("mysql", c1->getSchema());
+  ASSERT_EQUALS(con->getSchema(), c2->getSchema());
+
+  sql::ConnectOptionsMap wrong{{"user", user}};
+  ASSERT(driver->prepareConnection("jdbc:postgresql://localhost/test", wrong) == nullptr);
+}
+
+
+void connection::isolationTracking()
+{
+  int32_t isolation= con->getTransactionIsolation();
+
+  stmt->execute("SET SESSION TRANSACTION ISOLATION LEVEL SERIALIZABLE");
+  ASSERT_EQUALS(sql::TRANSACTION_SERIALIZABLE, con->getTransactionIsolation());
+  stmt->execute("SET SESSION TRANSACTION ISOLATION LEVEL READ COMMITTED");
+  ASSERT_EQUALS(sql::TRANSACTION_READ_COMMITTED, con->getTransactionIsolation());
+
+  con->setTransactionIsolation(isolation);
+  ASSERT_EQUALS(isolation, con->getTransactionIsolation());
+}
+
+
+void connection::connectRace()
+{
+  std::size_t hostStart= url.find("//");
+  if (hostStart == std::string::npos) {
+    SKIP("The test requires url with hosts");
+  }
+  hostStart+= 2;
+  // Non-routable address - connection attempt to it hangs until the timeout
+  sql::SQLString raceUrl(url.substr(0, hostStart) + "10.255.255.1," + url.substr(hostStart));
+  sql::Properties p{{"user", user}, {"password", passwd}, {"useTls", useTls ? "true" : "false"},
+    {"connectTimeout", "20000"}, {"connectAttemptDelay", "100"}};
+
+  auto start= std::chrono::steady_clock::now();
+  Connection c(driver->connect(raceUrl, p));
+  ASSERT(c->isValid(0));
+  ASSERT(std::chrono::steady_clock::now() - start < std::chrono::seconds(10));
+}
+
+
+void connection::replicationReadOnly()
+{
+  const std::string prefix("jdbc:mariadb://");
+  if (url.compare(0, prefix.length(), prefix) != 0) {
+    SKIP("The test requires url in jdbc:mariadb:// format");
+  }
+  std::string rest(url.substr(prefix.length()));
+  std::size_t hostsEnd= rest.find_first_of("/?");
+  std::string hosts(rest.substr(0, hostsEnd));
+  sql::SQLString replicationUrl("jdbc:mariadb:replication://" + hosts + "," + hosts +
+    (hostsEnd == std::string::npos ? "" : rest.substr(hostsEnd)));
+  sql::Properties p{{"user", user}, {"password", passwd}, {"useTls", useTls ? "true" : "false"}};
+
+  Connection c(driver->connect(replicationUrl, p));
+  int64_t masterId= connectionId(c.get());
+
+  c->setReadOnly(true);
+  ASSERT(c->isReadOnly());
+  int64_t replicaId= connectionId(c.get());
+  ASSERT(masterId != replicaId);
+
+  c->setReadOnly(false);
+  c->setAutoCommit(false);
+  ASSERT_EQUALS(masterId, connectionId(c.get()));
+  // Master is pinned inside the transaction
+  c->setReadOnly(true);
+  ASSERT_EQUALS(masterId, connectionId(c.get()));
+  c->commit();
+  ASSERT_EQUALS(replicaId, connectionId(c.get()));
+  ASSERT(!c->getAutoCommit());
+  c->setAutoCommit(true);
+}
+
+
+void connection::retryOnFailover()
+{
+  sql::Properties p{{"retryOnFailover", "true"}};
+  Connection c(getConnection(&p));
+  std::unique_ptr<sql::Statement> st(c->createStatement());
+  int64_t id= connectionId(c.get());
+
+  stmt->executeUpdate("KILL CONNECTION " + std::to_string(id));
+  res.reset(st->executeQuery("SELECT 1"));
+  ASSERT(res->next());
+  ASSERT_EQUALS(1, res->getInt(1));
+  int64_t newId= connectionId(c.get());
+  ASSERT(id != newId);
+
+  ASSERT(!st->isRetryable());
+  st->setRetryable(true);
+  ASSERT(st->isRetryable());
+  stmt->executeUpdate("KILL CONNECTION " + std::to_string(newId));
+  st->executeUpdate("DO 1");
+  ASSERT(newId != connectionId(c.get()));
+}
+
+
+
+void connection::poolPriorityQueue()
+{
+  sql::ConnectOptionsMap p{{"user", user}, {"password", passwd}, {"useTls", useTls ? "true" : "false"}, {"pool", "true"},
+    {"maxPoolSize", "1"}, {"connectTimeout", "5000"}};
+  sql::ConnectOptionsMap urgent(p), late(p);
+  urgent["poolPriority"]= "1";
+  late["connectTimeout"]= "200";
+  std::mutex orderLock;
+  std::vector<int32_t> order;
+  Connection c1(driver->connect(url, p));
+
+  auto request= [&](sql::ConnectOptionsMap& props, int32_t id) {
+    try {
+      Connection c(driver->connect(url, props));
+      std::lock_guard<std::mutex> guard(orderLock);
+      order.push_back(id);
+    }
+    catch (sql::SQLException&) {
+      std::lock_guard<std::mutex> guard(orderLock);
+      order.push_back(-id);
+    }
+  };
+  std::thread lateRequest(request, std::ref(late), 3);
+  std::thread batch(request, std::ref(p), 1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  std::thread userFacing(request, std::ref(urgent), 2);
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  c1.reset();
+  lateRequest.join();
+  batch.join();
+  userFacing.join();
+
+  // The request past its deadline fails and is never given the connection, the higher priority goes first
+  ASSERT_EQUALS(3, static_cast<int32_t>(order.size()));
+  ASSERT_EQUALS(-3, order[0]);
+  ASSERT_EQUALS(2, order[1]);
+  ASSERT_EQUALS(1, order[2]);
+}
+
+
+void connection::sharedPool()
+{
+  sql::ConnectOptionsMap p{{"user", user}, {"password", passwd}, {"useTls", useTls ? "true" : "false"}, {"pool", "true"},
+    {"sharedPool", "true"}, {"maxPoolSize", "1"}, {"connectTimeout", "1000"}};
+  sql::ConnectOptionsMap tenant(p), intruder(p);
+  tenant["user"]= "shareduser";
+  tenant["password"]= "sharedpass";
+  intruder["user"]= "shareduser";
+  intruder["password"]= "wrongpass";
+
+  try {
+    stmt->execute("DROP USER 'shareduser'@'%'");
+  }
+  catch (sql::SQLException&) {
+  }
+  stmt->execute("CREATE USER 'shareduser'@'%' IDENTIFIED BY 'sharedpass'");
+  stmt->execute("GRANT SELECT ON `" + con->getSchema() + "`.* TO 'shareduser'@'%'");
+
+  int64_t id;
+  {
+    Connection c1(driver->connect(url, p));
+    id= connectionId(c1.get());
+  }
+  // The only connection of the pool is lent to another user
+  {
+    Connection c2(driver->connect(url, tenant));
+    ASSERT_EQUALS(id, connectionId(c2.get()));
+    std::unique_ptr<sql::Statement> st(c2->createStatement());
+    res.reset(st->executeQuery("SELECT USER()"));
+    ASSERT(res->next());
+    ASSERT_EQUALS("shareduser@", res->getString(1).substr(0, 11));
+  }
+  // The session of the user is not given to the wrong password
+  try {
+    Connection c3(driver->connect(url, intruder));
+    FAIL("Connection has been lent with the wrong password");
+  }
+  catch (sql::SQLException&) {
+  }
+  {
+    Connection c4(driver->connect(url, p));
+    std::unique_ptr<sql::Statement> st(c4->createStatement());
+    res.reset(st->executeQuery("SELECT USER()"));
+    ASSERT(res->next());
+    ASSERT_EQUALS(user + "@", res->getString(1).substr(0, user.length() + 1));
+  }
+  stmt->execute("DROP USER 'shareduser'@'%'");
+}
+
+
+void connection::poolMaxLifetime()
+{
+  sql::ConnectOptionsMap p{{"user", user}, {"password", passwd}, {"useTls", useTls ? "true" : "false"}, {"pool", "true"},
+    {"maxPoolSize", "2"}, {"maxLifetime", "1"}};
+  int64_t id1;
+  {
+    Connection c1(driver->connect(url, p));
+    id1= connectionId(c1.get());
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+  }
+  // The connection has been given back past its lifetime, the pool's thread replaces and closes it
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  Connection c2(driver->connect(url, p));
+  ASSERT(id1 != connectionId(c2.get()));
+
+  res.reset(stmt->executeQuery("SELECT COUNT(*) FROM information_schema.PROCESSLIST WHERE ID=" + std::to_string(id1)));
+  ASSERT(res->next());
+  ASSERT_EQUALS(0, res->getInt(1));
+}
+
+
+void connection::poolIdleTrim()
+{
+  sql::ConnectOptionsMap p{{"user", user}, {"password", passwd}, {"useTls", useTls ? "true" : "false"}, {"pool", "true"},
+    {"maxPoolSize", "1"}, {"idleTrimTime", "1"}};
+  int64_t id1;
+  uint64_t footprint;
+  {
+    Connection c1(driver->connect(url, p));
+    id1= connectionId(c1.get());
+    std::unique_ptr<sql::PreparedStatement> ps(c1->prepareStatement("SELECT LENGTH(?)"));
+    ps->setString(1, std::string(256*1024, 'a'));
+    res.reset(ps->executeQuery());
+    ASSERT(res->next());
+    ASSERT_EQUALS(256*1024, res->getInt(1));
+    res.reset();
+    footprint= c1->getMetrics().memoryFootprint;
+    ASSERT(footprint > 256*1024);
+  }
+  // The pool's thread runs every second with the idleTrimTime of 1s
+  std::this_thread::sleep_for(std::chrono::milliseconds(3000));
+  Connection c2(driver->connect(url, p));
+  ASSERT_EQUALS(id1, connectionId(c2.get()));
+  ASSERT(c2->getMetrics().memoryFootprint < footprint - 256*1024);
+}
+
+
+void connection::poolCircuitBreaker()
+{
+  sql::Properties p{{"user", user}, {"password", passwd}, {"pool", "true"}, {"connectTimeout", "1000"},
+    {"circuitBreakerThreshold", "2"}, {"circuitBreakerTimeout", "60000"}};
+  // Nothing listens on port 1, thus connection attempts are refused
+  sql::SQLString deadUrl("jdbc:mariadb://127.0.0.1:1/");
+
+  for (int32_t i= 0; i < 2; ++i) {
+    try {
+      Connection c(driver->connect(deadUrl, p));
+      FAIL("Connection to the closed port has been established");
+    }
+    catch (sql::SQLException& e) {
+      ASSERT(std::string(e.what()).find("circuit breaker") == std::string::npos);
+    }
+  }
+  try {
+    Connection c(driver->connect(deadUrl, p));
+    FAIL("Connection to the closed port has been established");
+  }
+  catch (sql::SQLException& e) {
+    ASSERT_EQUALS("08", e.getSQLState().substr(0, 2));
+    ASSERT(std::string(e.what()).find("circuit breaker") != std::string::npos);
+  }
+}
+
+
+void connection::metrics()
+{
+  sql::ConnectionMetrics before= con->getMetrics();
+
+  res.reset(stmt->executeQuery("SELECT 1 UNION SELECT 2"));
+  while (res->next()) {
+    res->getInt(1);
+  }
+  res.reset();
+
+  sql::ConnectionMetrics after= con->getMetrics();
+  ASSERT(after.queries > before.queries);
+  ASSERT(after.roundTrips > before.roundTrips);
+  ASSERT(after.bytesSent > before.bytesSent);
+  ASSERT_EQUALS(static_cast<int64_t>(before.rowsFetched + 2), static_cast<int64_t>(after.rowsFetched));
+  ASSERT(after.bytesReceived >= before.bytesReceived + 2);
+  ASSERT_EQUALS(static_cast<int64_t>(before.executionTime.count + 1), static_cast<int64_t>(after.executionTime.count));
+  ASSERT(after.executionTime.p50 <= after.executionTime.max);
+  ASSERT(after.connectTime.count > 0);
+  ASSERT(after.connectTime.max > 0);
+
+  std::unique_ptr<sql::MetricsSnapshot> snapshot(driver->getMetricsSnapshot());
+  ASSERT(snapshot->getTotal().queries >= after.queries);
+  ASSERT(snapshot->getTotal().rowsFetched >= after.rowsFetched);
+  ASSERT(snapshot->getTotal().connectTime.count >= after.connectTime.count);
+}
+
+
+namespace
+{
+  class TestTracer : public sql::Tracer
+  {
+  public:
+    int32_t started= 0, ended= 0;
+    std::string operation, digest;
+    uint64_t rowCount= 0;
+    int64_t threadId= 0;
+    bool failed= false;
+
+    void* startSpan(const sql::SpanAttributes& attributes)
+    {
+      ++started;
+      return this;
+    }
+    void endSpan(void* span, const sql::SpanAttributes& attributes)
+    {
+      if (span == this && attributes.sql != nullptr) {
+        ++ended;
+        operation= attributes.operation;
+        digest= attributes.digest;
+        rowCount= attributes.rowCount;
+        threadId= attributes.serverThreadId;
+        failed= attributes.failed;
+      }
+    }
+  };
+}
+
+void connection::memoryLimit()
+{
+  sql::ConnectOptionsMap p{{"user", user}, {"password", passwd}, {"useTls", useTls ? "true" : "false"},
+    {"maxResultSetMemory", "1"}};
+  Connection c1(driver->connect(url, p));
+  Statement st(c1->createStatement());
+
+  try {
+    res.reset(st->executeQuery("SELECT REPEAT('a', 1000) FROM information_schema.columns a, information_schema.columns b"
+      " LIMIT 2000"));
+    FAIL("Result over the memory limit has been stored");
+  }
+  catch (sql::SQLException& e) {
+    ASSERT_EQUALS("HY001", e.getSQLState());
+  }
+  // The rest of the result has been skipped
+  res.reset(st->executeQuery("SELECT 1 UNION SELECT 2"));
+  ASSERT(res->next());
+  ASSERT(c1->getMetrics().resultSetMemory > 0);
+  ASSERT(driver->getMemoryUsage().resultSets >= c1->getMetrics().resultSetMemory);
+  res.reset();
+  ASSERT(c1->getMetrics().resultSetMemory == 0);
+}
+
+
+void connection::tracing()
+{
+  TestTracer tracer;
+
+  driver->setTracer(&tracer);
+  try {
+    res.reset(stmt->executeQuery("SELECT 'a',  12, 0x1F  /* comment */ UNION SELECT 'b', 13, 0x20"));
+    driver->setTracer(nullptr);
+  }
+  catch (sql::SQLException&) {
+    driver->setTracer(nullptr);
+    throw;
+  }
+  ASSERT_EQUALS(1, tracer.started);
+  ASSERT_EQUALS(1, tracer.ended);
+  ASSERT_EQUALS("query", tracer.operation);
+  ASSERT_EQUALS("SELECT ?, ?, ? UNION SELECT ?, ?, ?", tracer.digest);
+  ASSERT_EQUALS(static_cast<int64_t>(2), static_cast<int64_t>(tracer.rowCount));
+  ASSERT_EQUALS(connectionId(con.get()), tracer.threadId);
+  ASSERT(!tracer.failed);
+
+  // Not installed tracer gets nothing
+  res.reset(stmt->executeQuery("SELECT 1"));
+  ASSERT_EQUALS(1, tracer.started);
+}
+
+
+void connection::slowQueryLog()
+{
+  const char* logFile= "cppconn_slow_query.log";
+  std::remove(logFile);
+  sql::Properties p{{"user", user}, {"password", passwd}, {"slowQueryThresholdNanos", "100000000"},
+    {"queryLogFile", logFile}};
+  Connection c(driver->connect(url, p));
+  Statement st(c->createStatement());
+
+  ResultSet rs(st->executeQuery("SELECT 'fast query'"));
+  rs.reset(st->executeQuery("SELECT SLEEP(0.2), 'slow query'"));
+
+  // The log is written asynchronously
+  std::string log;
+  for (int32_t i= 0; i < 50 && log.find("slow query") == std::string::npos; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    std::ifstream in(logFile);
+    log.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+  ASSERT(log.find("slow query") != std::string::npos);
+  ASSERT(log.find("conn:" + std::to_string(connectionId(c.get()))) != std::string::npos);
+  ASSERT(log.find("fast query") == std::string::npos);
+}
+
+
+void connection::statementDigests()
+{
+  driver->setStatementDigests(16);
+  try {
+    res.reset(stmt->executeQuery("SELECT 1, 'a'"));
+    res.reset(stmt->executeQuery("SELECT  2, 'bb' /* comment */"));
+    res.reset(stmt->executeQuery("select 3"));
+    res.reset();
+
+    std::unique_ptr<sql::StatementDigests> digests(driver->getStatementDigests());
+    const sql::StatementDigest* found= nullptr;
+    for (std::size_t i= 0; i < digests->getCount(); ++i) {
+      if (digests->get(i).digest.compare("SELECT ?, ?") == 0) {
+        found= &digests->get(i);
+      }
+    }
+    ASSERT(found != nullptr);
+    ASSERT_EQUALS(static_cast<int64_t>(2), static_cast<int64_t>(found->count));
+    ASSERT_EQUALS(static_cast<int64_t>(2), static_cast<int64_t>(found->rows));
+    ASSERT_EQUALS(static_cast<int64_t>(0), static_cast<int64_t>(found->errors));
+    ASSERT(found->latency.p99 <= found->latency.max);
+
+    driver->setStatementDigests(2);
+    for (int32_t i= 0; i < 5; ++i) {
+      res.reset(stmt->executeQuery("SELECT " + std::string(i + 1, 'a') + " FROM (SELECT 1 a, 2 aa, 3 aaa, 4 aaaa, 5 aaaaa) t"));
+    }
+    digests.reset(driver->getStatementDigests());
+    ASSERT_EQUALS(static_cast<int64_t>(2), static_cast<int64_t>(digests->getCount()));
+    ASSERT(digests->get(0).totalTime >= digests->get(1).totalTime);
+    driver->setStatementDigests(0);
+  }
+  catch (...) {
+    driver->setStatementDigests(0);
+    throw;
+  }
+}
+
+
+
+void connection::exceptionMessage()
+{
+  sql::Properties p{{"user", user}, {"password", passwd}, {"dumpQueriesOnException", "true"}};
+  Connection c(driver->connect(url, p));
+  Statement st(c->createStatement());
+
+  st->execute("CREATE TEMPORARY TABLE exc_msg(id INT NOT NULL PRIMARY KEY)");
+  st->execute("INSERT INTO exc_msg VALUES(1)");
+  try {
+    st->execute("INSERT INTO exc_msg VALUES(1)");
+    FAIL("Duplicate key has been inserted");
+  }
+  catch (sql::SQLException& e) {
+    ASSERT_EQUALS(1062, e.getErrorCode());
+    ASSERT_EQUALS("23000", e.getSQLState());
+
+    sql::SQLException copy(e);
+    std::string message(e.what());
+    ASSERT_EQUALS(0, static_cast<int32_t>(message.find("(conn=" + std::to_string(connectionId(c.get())) + ") Duplicate")));
+    ASSERT(message.find("\nQuery is: INSERT INTO exc_msg VALUES(1)") != std::string::npos);
+    ASSERT_EQUALS(message, std::string(copy.what()));
+    ASSERT_EQUALS(message, std::string(e.getMessage().c_str()));
+  }
+}
+
+
+void connection::protocolReplay()
+{
+  const char* recordFile= "cppconn_protocol.rec";
+  const std::string replayFile(std::string(recordFile) + ".1");
+  const char* query= "SELECT 1, 'first' UNION ALL SELECT 2, 'second' UNION ALL SELECT 3, 'third'";
+  std::remove(replayFile.c_str());
+  {
+    sql::Properties p{{"user", user}, {"password", passwd}, {"protocolRecordFile", recordFile}};
+    Connection c(driver->connect(url, p));
+    Statement st(c->createStatement());
+    ResultSet rs(st->executeQuery(query));
+    ASSERT(rs->next());
+    c->close();
+  }
+  sql::Properties p{{"user", user}, {"password", passwd}, {"protocolReplayFile", replayFile}};
+  Connection c(driver->connect(url, p));
+  Statement st(c->createStatement());
+  ResultSet rs(st->executeQuery(query));
+
+  ASSERT(rs->next());
+  ASSERT_EQUALS(1, rs->getInt(1));
+  ASSERT_EQUALS("first", rs->getString(2));
+  ASSERT(rs->next());
+  ASSERT(rs->next());
+  ASSERT_EQUALS(3, rs->getInt(1));
+  ASSERT_EQUALS("third", rs->getString(2));
+  ASSERT(!rs->next());
+  c->close();
+  std::remove(replayFile.c_str());
+}
+
+void connection::threadSafeConnection()
+{
+  sql::Properties p{{"user", user}, {"password", passwd}, {"threadSafeConnection", "false"}, {"useServerPrepStmts", "true"}};
+  Connection c(driver->connect(url, p));
+  Statement st(c->createStatement());
+  PreparedStatement ps(c->prepareStatement("SELECT ?"));
+
+  // Locking the connection does nothing, and nothing else changes for the single thread
+  st->setFetchSize(1);
+  ResultSet rs(st->executeQuery("SELECT 1 UNION ALL SELECT 2"));
+  ASSERT(rs->next());
+  ps->setInt(1, 3);
+  ResultSet rs2(ps->executeQuery());
+  ASSERT(rs2->next());
+  ASSERT_EQUALS(3, rs2->getInt(1));
+  ASSERT(rs->next());
+  ASSERT_EQUALS(2, rs->getInt(1));
+  ASSERT(!rs->next());
+  c->close();
+}
+
+
+void connection::multiplexer()
+{
+  sql::ConnectOptionsMap p{{"user", user}, {"password", passwd}, {"useTls", useTls ? "true" : "false"}};
+  std::unique_ptr<sql::ConnectionDescriptor> descriptor(driver->prepareConnection(url, p));
+  std::unique_ptr<sql::Multiplexer> mux(descriptor->createMultiplexer(2));
+  std::vector<std::thread> threads;
+  std::atomic<int32_t> mismatches(0), errors(0);
+
+  ASSERT_EQUALS(static_cast<uint64_t>(2), static_cast<uint64_t>(mux->getConnectionCount()));
+  for (int32_t t= 0; t < 8; ++t) {
+    threads.emplace_back([&mux, &mismatches, &errors, t]() {
+      for (int32_t i= 0; i < 50; ++i) {
+        int32_t expected= t*1000 + i;
+        std::unique_ptr<sql::ResultSet> rs(mux->executeQuery("SELECT " + std::to_string(expected)));
+        if (!rs || !rs->next() || rs->getInt(1) != expected) {
+          ++mismatches;
+        }
+        try {
+          mux->executeQuery("SELECT * FROM nonexistent_multiplexed_table");
+        }
+        catch (sql::SQLException& e) {
+          if (e.getErrorCode() == 1146) {
+            ++errors;
+          }
+        }
+      }
+    });
+  }
+  for (auto& it : threads) {
+    it.join();
+  }
+  ASSERT_EQUALS(0, mismatches.load());
+  ASSERT_EQUALS(400, errors.load());
+  ASSERT_EQUALS(static_cast<int64_t>(0), mux->executeUpdate("DO 1"));
+
+  mux->close();
+  try {
+    mux->executeQuery("SELECT 1");
+    FAIL("Closed multiplexer has executed the query");
+  }
+  catch (sql::SQLException&) {
+  }
+}
+
+
+void connection::validMinDelay()
+{
+  sql::Properties p{{"user", user}, {"password", passwd}, {"validMinDelay", "60000"}};
+  Connection c(driver->connect(url, p));
+  Statement st(c->createStatement());
+  ResultSet rs(st->executeQuery("SELECT CONNECTION_ID()"));
+
+  ASSERT(rs->next());
+  int64_t id= rs->getInt64(1);
+  rs.reset();
+  ASSERT(c->isValid());
+
+  stmt->execute("KILL " + std::to_string(id));
+  // Giving the server time to close the socket
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  ASSERT(!c->isValid());
+  c->close();
+}
+
+
+class DuplicateRowBinder : public sql::BatchRowBinder
+{
+public:
+  // Row 500 duplicates the id of the row 10
+  void bindRow(sql::PreparedStatement& ps, std::size_t row) override
+  {
+    ps.setInt(1, static_cast<int32_t>(row == 500 ? 11 : row + 1));
+    ps.setString(2, "row" + std::to_string(row));
+  }
+};
+
+
+void connection::parallelBatchExecutor()
+{
+  createSchemaObject("TABLE", "parallel_batch", "(id INT NOT NULL PRIMARY KEY, val VARCHAR(16))");
+
+  sql::ConnectOptionsMap p{{"user", user}, {"password", passwd}, {"useTls", useTls ? "true" : "false"}};
+  std::unique_ptr<sql::ConnectionDescriptor> descriptor(driver->prepareConnection(url, p));
+  std::unique_ptr<sql::ParallelBatchExecutor> executor(descriptor->createParallelBatchExecutor(4));
+  DuplicateRowBinder binder;
+
+  ASSERT_EQUALS(static_cast<uint64_t>(4), static_cast<uint64_t>(executor->getConnectionCount()));
+  executor->setPartitionTransactions(true);
+  executor->setChunkSize(100);
+  try {
+    executor->executeBatch("INSERT INTO parallel_batch VALUES(?,?)", 1000, binder);
+    FAIL("Duplicate key error has not been thrown");
+  }
+  catch (sql::SQLException& e) {
+    ASSERT_EQUALS(1062, e.getErrorCode());
+  }
+  const sql::Longs& counts= executor->getUpdateCounts();
+  ASSERT_EQUALS(static_cast<int64_t>(1000), static_cast<int64_t>(counts.size()));
+  for (std::size_t i= 0; i < counts.size(); ++i) {
+    // The third partition has been rolled back as a whole
+    if (i >= 500 && i < 750) {
+      ASSERT_EQUALS(static_cast<int64_t>(sql::Statement::EXECUTE_FAILED), counts.arr[i]);
+    }
+    else {
+      ASSERT(counts.arr[i] != sql::Statement::EXECUTE_FAILED);
+    }
+  }
+  res.reset(stmt->executeQuery("SELECT COUNT(*), MIN(id), MAX(id) FROM parallel_batch"));
+  ASSERT(res->next());
+  ASSERT_EQUALS(750, res->getInt(1));
+  ASSERT_EQUALS(1, res->getInt(2));
+  ASSERT_EQUALS(1000, res->getInt(3));
+
+  executor->close();
+}
+
+
+void connection::deferredSessionState()
+{
+  const sql::SQLString query("SELECT @@autocommit, @@tx_isolation, DATABASE()");
+  std::unique_ptr<sql::Connection> c(getConnection());
+  std::unique_ptr<sql::Statement> st(c->createStatement());
+
+  res.reset(st->executeQuery(query));
+  res.reset();
+  uint64_t roundTrips= c->getMetrics().roundTrips;
+  res.reset(st->executeQuery(query));
+  res.reset();
+  // Round trips of the query alone
+  uint64_t queryRoundTrips= c->getMetrics().roundTrips - roundTrips;
+
+  roundTrips= c->getMetrics().roundTrips;
+  c->setAutoCommit(false);
+  c->setTransactionIsolation(sql::TRANSACTION_READ_COMMITTED);
+  c->setSchema("information_schema");
+  ASSERT(!c->getAutoCommit());
+  ASSERT_EQUALS(roundTrips, c->getMetrics().roundTrips);
+
+  res.reset(st->executeQuery(query));
+  ASSERT_EQUALS(roundTrips + queryRoundTrips, c->getMetrics().roundTrips);
+  ASSERT(res->next());
+  ASSERT_EQUALS(0, res->getInt(1));
+  ASSERT_EQUALS("READ-COMMITTED", res->getString(2));
+  ASSERT_EQUALS("information_schema", res->getString(3));
+  res.reset();
+
+  // The value, the server already has, costs nothing
+  roundTrips= c->getMetrics().roundTrips;
+  c->setAutoCommit(false);
+  res.reset(st->executeQuery(query));
+  res.reset();
+  ASSERT_EQUALS(roundTrips + queryRoundTrips, c->getMetrics().roundTrips);
+
+  // Error of the change is reported by the statement, that has carried it
+  c->setSchema("there_is_no_such_database_for_sure");
+  try {
+    res.reset(st->executeQuery(query));
+    FAIL("Unknown database error has not been thrown");
+  }
+  catch (sql::SQLException& e) {
+    ASSERT_EQUALS(1049, e.getErrorCode());
+  }
+  res.reset(st->executeQuery(query));
+  ASSERT(res->next());
+  ASSERT_EQUALS("information_schema", res->getString(3));
+  c->close();
+}
+
+
+void connection::pipelineTransactionEnd()
+{
+  createSchemaObject("TABLE", "pipeline_trx", "(id INT NOT NULL PRIMARY KEY)");
+
+  sql::Properties p{{"pipelineTransactionEnd", "true"}};
+  Connection c(getConnection(&p));
+  Statement st(c->createStatement());
+
+  c->setAutoCommit(false);
+  st->executeUpdate("INSERT INTO pipeline_trx VALUES(1)");
+  uint64_t roundTrips= c->getMetrics().roundTrips;
+  c->commit();
+  ASSERT_EQUALS(roundTrips, c->getMetrics().roundTrips);
+  // Nothing to roll back - the transaction has ended for the application
+  c->rollback();
+
+  // COMMIT goes with this insert
+  st->executeUpdate("INSERT INTO pipeline_trx VALUES(2)");
+  res.reset(stmt->executeQuery("SELECT COUNT(*) FROM pipeline_trx"));
+  ASSERT(res->next());
+  ASSERT_EQUALS(1, res->getInt(1));
+
+  c->rollback();
+  ResultSet rs(st->executeQuery("SELECT COUNT(*) FROM pipeline_trx"));
+  ASSERT(rs->next());
+  ASSERT_EQUALS(1, rs->getInt(1));
+  rs.reset();
+
+  // Closing sends the deferred COMMIT
+  st->executeUpdate("INSERT INTO pipeline_trx VALUES(3)");
+  c->commit();
+  c->close();
+  res.reset(stmt->executeQuery("SELECT COUNT(*) FROM pipeline_trx"));
+  ASSERT(res->next());
+  ASSERT_EQUALS(2, res->getInt(1));
+}
+
+
+void connection::pipelineSavepoints()
+{
+  createSchemaObject("TABLE", "pipeline_savepoint", "(id INT NOT NULL PRIMARY KEY)");
+
+  sql::Properties p{{"pipelineSavepoints", "true"}};
+  Connection c(getConnection(&p));
+  Statement st(c->createStatement());
+
+  c->setAutoCommit(false);
+  st->executeUpdate("INSERT INTO pipeline_savepoint VALUES(1)");
+  uint64_t roundTrips= c->getMetrics().roundTrips;
+
+  // Nothing executed between setting and releasing - neither is sent
+  std::unique_ptr<sql::Savepoint> empty(c->setSavepoint("empty"));
+  c->releaseSavepoint(empty.get());
+  ASSERT_EQUALS(roundTrips, c->getMetrics().roundTrips);
+
+  // The savepoint goes with the insert, and its release with the next statement
+  std::unique_ptr<sql::Savepoint> sp(c->setSavepoint("sp"));
+  ASSERT_EQUALS(roundTrips, c->getMetrics().roundTrips);
+  st->executeUpdate("INSERT INTO pipeline_savepoint VALUES(2)");
+  c->rollback(sp.get());
+  ResultSet rs(st->executeQuery("SELECT COUNT(*) FROM pipeline_savepoint"));
+  ASSERT(rs->next());
+  ASSERT_EQUALS(1, rs->getInt(1));
+  rs.reset();
+
+  // Rolling back to the savepoint, that has not been sent yet, costs nothing either
+  std::unique_ptr<sql::Savepoint> nested(c->setSavepoint("nested"));
+  roundTrips= c->getMetrics().roundTrips;
+  c->rollback(nested.get());
+  c->releaseSavepoint(nested.get());
+  c->releaseSavepoint(sp.get());
+  ASSERT_EQUALS(roundTrips, c->getMetrics().roundTrips);
+
+  st->executeUpdate("INSERT INTO pipeline_savepoint VALUES(3)");
+  c->commit();
+  res.reset(stmt->executeQuery("SELECT COUNT(*) FROM pipeline_savepoint"));
+  ASSERT(res->next());
+  ASSERT_EQUALS(2, res->getInt(1));
+
+  // The released savepoint is gone on the server, what the next statement reports
+  std::unique_ptr<sql::Savepoint> released(c->setSavepoint("released"));
+  st->executeUpdate("INSERT INTO pipeline_savepoint VALUES(4)");
+  c->releaseSavepoint(released.get());
+  c->releaseSavepoint(released.get());
+  try {
+    st->executeQuery("SELECT 1");
+    FAIL("Error of the deferred RELEASE SAVEPOINT has not been thrown");
+  }
+  catch (sql::SQLException&) {
+  }
+  c->rollback();
+}
+
+
+void connection::prepareWarmup()
+{
+  // The query too long for the cache is skipped
+  driver->setPrepareWarmup({"SELECT 1", "SELECT ?", "SELECT 2 /*" + std::string(2100, 'x') + "*/"});
+
+  sql::Properties p{{"useServerPrepStmts", "true"}, {"cachePrepStmts", "true"}};
+  Connection c(getConnection(&p));
+  driver->setPrepareWarmup({});
+
+  sql::ConnectionMetrics before= c->getMetrics();
+  ASSERT_EQUALS(static_cast<uint64_t>(2), before.prepares);
+
+  PreparedStatement ps(c->prepareStatement("SELECT ?"));
+  ps->setInt(1, 7);
+  res.reset(ps->executeQuery());
+  ASSERT(res->next());
+  ASSERT_EQUALS(7, res->getInt(1));
+
+  sql::ConnectionMetrics after= c->getMetrics();
+  ASSERT_EQUALS(before.prepares, after.prepares);
+  ASSERT_EQUALS(before.prepareCacheHits + 1, after.prepareCacheHits);
+}
+
+
+void connection::prepareResetWarmup()
+{
+  sql::Properties p{{"useServerPrepStmts", "true"}, {"cachePrepStmts", "true"}, {"useResetConnection", "true"},
+    {"prepStmtCacheResetWarmup", "1"}};
+  Connection c(getConnection(&p));
+
+  PreparedStatement ps(c->prepareStatement("SELECT ? + 1"));
+  ps.reset();
+  ps.reset(c->prepareStatement("SELECT ? + 2"));
+  ps.reset();
+
+  uint64_t prepares= c->getMetrics().prepares;
+  c->reset();
+  // Only the most recently used statement is prepared again
+  ASSERT_EQUALS(prepares + 1, c->getMetrics().prepares);
+
+  ps.reset(c->prepareStatement("SELECT ? + 2"));
+  ASSERT_EQUALS(prepares + 1, c->getMetrics().prepares);
+  ps->setInt(1, 1);
+  res.reset(ps->executeQuery());
+  ASSERT(res->next());
+  ASSERT_EQUALS(3, res->getInt(1));
+  res.reset();
+  ps.reset();
+
+  ps.reset(c->prepareStatement("SELECT ? + 1"));
+  ASSERT_EQUALS(prepares + 2, c->getMetrics().prepares);
+}
+
+
+void connection::dnsCache()
+{
+  sql::Properties p{{"dnsCacheTtl", "60000"}};
+
+  for (int32_t i= 0; i < 3; ++i) {
+    Connection c(getConnection(&p));
+    std::unique_ptr<sql::Statement> st(c->createStatement());
+    res.reset(st->executeQuery("SELECT 1"));
+    ASSERT(res->next());
+    ASSERT_EQUALS(1, res->getInt(1));
+  }
+
+  // The failed connect drops the cached address, and the next connection resolves the name again
+  sql::Properties wrongPort(p);
+  wrongPort["connectTimeout"]= "1000";
+  try {
+    Connection c(driver->connect("jdbc:mariadb://" + con->getHostname() + ":1/", wrongPort));
+    FAIL("Connection to the closed port has been established");
+  }
+  catch (sql::SQLException&) {
+  }
+  Connection c(getConnection(&p));
+  ASSERT(c->isValid(1));
+}
+
+
+void connection::failoverStandby()
+{
+  const std::string prefix("jdbc:mariadb://");
+  if (url.compare(0, prefix.length(), prefix) != 0) {
+    SKIP("The test requires url in jdbc:mariadb:// format");
+  }
+  std::string rest(url.substr(prefix.length()));
+  std::size_t hostsEnd= rest.find_first_of("/?");
+  std::string hosts(rest.substr(0, hostsEnd));
+  std::size_t portStart= hosts.find(':');
+  std::string host(hosts.substr(0, portStart)), port(portStart == std::string::npos ? "" : hosts.substr(portStart));
+  if (host != "localhost" && host != "127.0.0.1") {
+    SKIP("The test requires the server on the local host");
+  }
+  sql::SQLString standbyUrl(prefix + hosts + "," + (host == "localhost" ? "127.0.0.1" : "localhost") + port +
+    (hostsEnd == std::string::npos ? "" : rest.substr(hostsEnd)));
+  sql::Properties p{{"user", user}, {"password", passwd}, {"useTls", useTls ? "true" : "false"},
+    {"retryOnFailover", "true"}, {"failoverStandby", "true"}, {"failoverStandbyPingInterval", "100"}};
+
+  Connection c(driver->connect(standbyUrl, p));
+  std::unique_ptr<sql::Statement> st(c->createStatement());
+  c->setSchema(db);
+
+  for (int32_t i= 0; i < 2; ++i) {
+    // Lets the standby connect
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    int64_t id= connectionId(c.get());
+    stmt->executeUpdate("KILL CONNECTION " + std::to_string(id));
+    res.reset(st->executeQuery("SELECT DATABASE()"));
+    ASSERT(res->next());
+    ASSERT_EQUALS(db, res->getString(1));
+    ASSERT(id != connectionId(c.get()));
+  }
+}
+
+
+void connection::poolKeepAlive()
+{
+  sql::ConnectOptionsMap p{{"user", user}, {"password", passwd}, {"useTls", useTls ? "true" : "false"}, {"pool", "true"},
+    {"maxPoolSize", "1"}, {"poolKeepAlive", "1"}, {"tcpKeepIdle", "10"}, {"tcpKeepInterval", "5"}};
+  int64_t id1;
+  {
+    Connection c1(driver->connect(url, p));
+    id1= connectionId(c1.get());
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(4000));
+  // TIME of the process list is the time since the last command of the connection
+  res.reset(stmt->executeQuery("SELECT TIME FROM information_schema.PROCESSLIST WHERE ID=" + std::to_string(id1)));
+  ASSERT(res->next());
+  ASSERT(res->getInt(1) < 3);
+
+  Connection c2(driver->connect(url, p));
+  ASSERT_EQUALS(id1, connectionId(c2.get()));
+}
+
+
+void connection::readYourWrites()
+{
+  const std::string prefix("jdbc:mariadb://");
+  if (url.compare(0, prefix.length(), prefix) != 0) {
+    SKIP("The test requires url in jdbc:mariadb:// format");
+  }
+  std::string rest(url.substr(prefix.length()));
+  std::size_t hostsEnd= rest.find_first_of("/?");
+  std::string hosts(rest.substr(0, hostsEnd));
+  sql::SQLString replicationUrl("jdbc:mariadb:replication://" + hosts + "," + hosts +
+    (hostsEnd == std::string::npos ? "" : rest.substr(hostsEnd)));
+  sql::Properties p{{"user", user}, {"password", passwd}, {"useTls", useTls ? "true" : "false"},
+    {"readYourWrites", "true"}, {"readYourWritesTimeout", "100"}};
+
+  createSchemaObject("TABLE", "readYourWrites", "(id INT NOT NULL PRIMARY KEY)");
+  Connection c(driver->connect(replicationUrl, p));
+  c->setSchema(db);
+  std::unique_ptr<sql::Statement> st(c->createStatement());
+
+  for (int32_t i= 1; i <= 2; ++i) {
+    c->setReadOnly(false);
+    st->executeUpdate("INSERT INTO readYourWrites VALUES(" + std::to_string(i) + ")");
+    c->setReadOnly(true);
+    res.reset(st->executeQuery("SELECT COUNT(*) FROM readYourWrites"));
+    ASSERT(res->next());
+    ASSERT_EQUALS(i, res->getInt(1));
+  }
+}
+
+
+void connection::shardRouter()
+{
+  sql::ConnectOptionsMap p{{"user", user}, {"password", passwd}, {"useTls", useTls ? "true" : "false"},
+    {"maxPoolSize", "2"}};
+  std::vector<sql::SQLString> urls{url, url, url};
+  std::unique_ptr<sql::ShardRouter> router(driver->createShardRouter(urls, p));
+
+  ASSERT_EQUALS(static_cast<uint64_t>(3), static_cast<uint64_t>(router->getShardCount()));
+  uint32_t shard= router->shardOf("customer42");
+  ASSERT(shard < 3);
+  ASSERT_EQUALS(static_cast<uint64_t>(shard), static_cast<uint64_t>(router->shardOf("customer42")));
+  {
+    Connection c(router->getConnection("customer42"));
+    std::unique_ptr<sql::Statement> st(c->createStatement());
+    res.reset(st->executeQuery("SELECT 1"));
+    ASSERT(res->next());
+  }
+
+  for (int32_t fetchSize : {0, 1}) {
+    std::unique_ptr<sql::ShardedResult> rows(router->executeQueryOnAll("SELECT 1 UNION ALL SELECT 2", fetchSize));
+    uint32_t count= 0;
+    while (rows->next()) {
+      ASSERT_EQUALS(static_cast<uint64_t>(count / 2), static_cast<uint64_t>(rows->currentShard()));
+      ASSERT_EQUALS(static_cast<int32_t>(count % 2 + 1), rows->current()->getInt(1));
+      ++count;
+    }
+    ASSERT_EQUALS(static_cast<uint64_t>(6), static_cast<uint64_t>(count));
+  }
+
+  sql::RangeShardFunction range({0, 1000, 2000});
+  std::unique_ptr<sql::ShardRouter> rangeRouter(driver->createShardRouter(urls, p, &range));
+  ASSERT_EQUALS(static_cast<uint64_t>(0), static_cast<uint64_t>(rangeRouter->shardOf("999")));
+  ASSERT_EQUALS(static_cast<uint64_t>(1), static_cast<uint64_t>(rangeRouter->shardOf("1000")));
+  ASSERT_EQUALS(static_cast<uint64_t>(2), static_cast<uint64_t>(rangeRouter->shardOf("123456")));
+  ASSERT_EQUALS(static_cast<uint64_t>(0), static_cast<uint64_t>(rangeRouter->shardOf("-5")));
+}
+
+
+namespace
+{
+  class CountingAllocator : public sql::Allocator
+  {
+  public:
+    std::atomic<int64_t> blocks{0}, allocated{0};
+
+    void* allocate(std::size_t size)
+    {
+      ++blocks;
+      ++allocated;
+      return ::operator new(size);
+    }
+    void deallocate(void* ptr, std::size_t)
+    {
+      --blocks;
+      ::operator delete(ptr);
+    }
+  };
+}
+
+void connection::allocator()
+{
+  CountingAllocator counting;
+
+  driver->setAllocator(&counting);
+  try {
+    pstmt.reset(con->prepareStatement("SELECT ? FROM information_schema.columns LIMIT 100"));
+    pstmt->setInt(1, 7);
+    pstmt->setFetchSize(10);
+    res.reset(pstmt->executeQuery());
+    driver->setAllocator(nullptr);
+  }
+  catch (sql::SQLException&) {
+    driver->setAllocator(nullptr);
+    throw;
+  }
+  ASSERT(counting.allocated > 0);
+  ASSERT(res->next());
+  ASSERT_EQUALS(7, res->getInt(1));
+  // Memory allocated after the uninstalling does not come from it, but the old one goes back to it
+  pstmt->setString(1, "x");
+  res.reset();
+  pstmt.reset();
+  ASSERT_EQUALS(static_cast<int64_t>(0), static_cast<int64_t>(counting.blocks));
+}
+
+
+void connection::asyncInsertQueue()
+{
+  createSchemaObject("TABLE", "async_insert", "(id INT NOT NULL PRIMARY KEY, val VARCHAR(16))");
+
+  sql::ConnectOptionsMap p{{"user", user}, {"password", passwd}, {"useTls", useTls ? "true" : "false"}};
+  std::unique_ptr<sql::ConnectionDescriptor> descriptor(driver->prepareConnection(url, p));
+  std::unique_ptr<sql::AsyncInsertQueue> queue(descriptor->createAsyncInsertQueue(
+    "INSERT INTO async_insert VALUES(?,?)", 50, 64));
+  std::vector<std::future<int64_t>> results(400);
+  std::vector<std::thread> threads;
+
+  for (int32_t t= 0; t < 4; ++t) {
+    threads.emplace_back([&queue, &results, t]() {
+      for (int32_t i= t*100; i < (t + 1)*100; ++i) {
+        results[i]= queue->insert(i + 1, "row");
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  queue->flush();
+  ASSERT_EQUALS(static_cast<int64_t>(0), static_cast<int64_t>(queue->getPendingRows()));
+  for (auto& result : results) {
+    int64_t count= result.get();
+    ASSERT(count == 1 || count == sql::Statement::SUCCESS_NO_INFO);
+  }
+  res.reset(stmt->executeQuery("SELECT COUNT(*), MIN(id), MAX(id) FROM async_insert"));
+  ASSERT(res->next());
+  ASSERT_EQUALS(400, res->getInt(1));
+  ASSERT_EQUALS(1, res->getInt(2));
+  ASSERT_EQUALS(400, res->getInt(3));
+
+  // Rows of the batch with the duplicate key get its error
+  std::future<int64_t> fresh= queue->insert(401, "new");
+  std::future<int64_t> duplicate= queue->insert(7, "dup");
+  queue->flush();
+  try {
+    duplicate.get();
+    FAIL("Duplicate key error has not been thrown");
+  }
+  catch (sql::SQLException& e) {
+    ASSERT_EQUALS(1062, e.getErrorCode());
+  }
+  try {
+    fresh.get();
+    FAIL("Row of the failed batch has succeeded");
+  }
+  catch (sql::SQLException& e) {
+    ASSERT_EQUALS(1062, e.getErrorCode());
+  }
+
+  try {
+    queue->insert(402);
+    FAIL("Row with the wrong number of values has been queued");
+  }
+  catch (sql::SQLException& e) {
+    ASSERT_EQUALS("07001", e.getSQLState());
+  }
+  queue->close();
+  try {
+    queue->insert(403, "closed");
+    FAIL("Row has been queued after close");
+  }
+  catch (sql::SQLException& e) {
+    ASSERT_EQUALS("08003", e.getSQLState());
+  }
+}
+
+
+void connection::sequenceAllocator()
+{
+  if (getServerVersion(con) < 1003000)
+  {
+    SKIP("Server does not support sequences");
+  }
+  createSchemaObject("SEQUENCE", "id_seq", "START WITH 1 INCREMENT BY 10");
+
+  try {
+    std::unique_ptr<sql::SequenceAllocator> wrong(con->getSequenceAllocator("id_seq", 5));
+    FAIL("Block size different from the INCREMENT has been accepted");
+  }
+  catch (sql::SQLException& e) {
+    ASSERT_EQUALS("HY024", e.getSQLState());
+  }
+
+  std::unique_ptr<sql::SequenceAllocator> allocator(con->getSequenceAllocator("id_seq", 0));
+  ASSERT_EQUALS(static_cast<int64_t>(10), allocator->getBlockSize());
+
+  std::vector<int64_t> values(100);
+  std::vector<std::thread> threads;
+  uint64_t roundTrips= con->getMetrics().roundTrips;
+
+  for (int32_t t= 0; t < 4; ++t) {
+    threads.emplace_back([&allocator, &values, t]() {
+      for (int32_t i= t*25; i < (t + 1)*25; ++i) {
+        values[i]= allocator->next();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  allocator->close();
+  // One round trip per block, and possibly the block claimed in advance
+  ASSERT(con->getMetrics().roundTrips - roundTrips <= 11);
+
+  std::sort(values.begin(), values.end());
+  ASSERT(std::adjacent_find(values.begin(), values.end()) == values.end());
+
+  // Values are taken from the blocks, the sequence has given out
+  res.reset(stmt->executeQuery("SELECT NEXT VALUE FOR id_seq"));
+  ASSERT(res->next());
+  int64_t nextValue= res->getInt64(1);
+  ASSERT_EQUALS(static_cast<int64_t>(1), nextValue % 10);
+  ASSERT(values.back() < nextValue);
+  ASSERT(values.front() >= 1);
+
+  try {
+    allocator->next();
+    FAIL("Closed allocator has returned the value");
+  }
+  catch (sql::SQLException&) {
+  }
+}
+
 } /* namespace connection */
 } /* namespace testsuite */
@@ -2571,5 +2571,117 @@ void connectionmetadata::bugCpp25()
 
 }
 
+
+void connectionmetadata::metadataCache()
+{
+  logMsg("connectionmetadata::metadataCache");
+  sql::Properties p{{"user", user}, {"password", passwd}, {"metadataCacheTtl", "60000"}};
+  Connection c(driver->connect(url, p));
+  Statement st(c->createStatement());
+  DatabaseMetaData dbmeta(c->getMetaData());
+  sql::SQLString schema(c->getSchema());
+
+  st->execute("DROP TABLE IF EXISTS test_metadata_cache");
+  st->execute("CREATE TABLE test_metadata_cache(id INT NOT NULL PRIMARY KEY, val VARCHAR(10) DEFAULT '')");
+
+  res.reset(dbmeta->getColumns("", schema, "test_metadata_cache", "%"));
+  ASSERT(res->next());
+  ASSERT_EQUALS("id", res->getString(4));
+  ASSERT(res->next());
+  ASSERT_EQUALS("val", res->getString(4));
+  ASSERT_EQUALS("", res->getString(12));
+  ASSERT(!res->next());
+
+  uint64_t queries= c->getMetrics().queries;
+  res.reset(dbmeta->getColumns("", schema, "test_metadata_cache", "%"));
+  ASSERT_EQUALS(queries, c->getMetrics().queries);
+  ASSERT(res->next());
+  ASSERT_EQUALS("id", res->getString(4));
+  ASSERT_EQUALS(1, res->getInt(17));
+  ASSERT(res->getString(13).empty() && res->wasNull());
+  ASSERT(res->next());
+  ASSERT_EQUALS("val", res->getString(4));
+  ASSERT_EQUALS("", res->getString(12));
+  ASSERT(!res->wasNull());
+  ASSERT(!res->next());
+
+  st->execute("ALTER TABLE test_metadata_cache ADD COLUMN added INT");
+  res.reset(dbmeta->getColumns("", schema, "test_metadata_cache", "%"));
+  ASSERT(res->next());
+  ASSERT(res->next());
+  ASSERT(res->next());
+  ASSERT_EQUALS("added", res->getString(4));
+  ASSERT(!res->next());
+
+  // Parameters of stored procedures are shared with other connections as well
+  st->execute("DROP PROCEDURE IF EXISTS test_metadata_cache_proc");
+  st->execute("CREATE PROCEDURE test_metadata_cache_proc(IN a INT, OUT b VARCHAR(10)) SET b=a");
+  CallableStatement cs(c->prepareCall("CALL test_metadata_cache_proc(?, ?)"));
+  ASSERT_EQUALS(2U, cs->getParameterMetaData()->getParameterCount());
+
+  Connection c2(driver->connect(url, p));
+  CallableStatement cs2(c2->prepareCall("CALL test_metadata_cache_proc(?, ?)"));
+  queries= c2->getMetrics().queries;
+  ParameterMetaData* pmd= cs2->getParameterMetaData();
+  ASSERT_EQUALS(queries, c2->getMetrics().queries);
+  ASSERT_EQUALS(2U, pmd->getParameterCount());
+  ASSERT_EQUALS(static_cast<int32_t>(sql::ParameterMetaData::parameterModeOut), pmd->getParameterMode(2));
+
+  st->execute("DROP PROCEDURE test_metadata_cache_proc");
+  st->execute("CREATE PROCEDURE test_metadata_cache_proc(IN a INT, OUT b VARCHAR(10), IN c INT) SET b=a+c");
+  cs2.reset(c2->prepareCall("CALL test_metadata_cache_proc(?, ?, ?)"));
+  ASSERT_EQUALS(3U, cs2->getParameterMetaData()->getParameterCount());
+
+  st->execute("DROP PROCEDURE IF EXISTS test_metadata_cache_proc");
+  st->execute("DROP TABLE IF EXISTS test_metadata_cache");
+}
+
+
+void connectionmetadata::constantResults()
+{
+  logMsg("connectionmetadata::constantResults");
+  DatabaseMetaData dbmeta(con->getMetaData());
+  uint64_t queries= con->getMetrics().queries;
+  int32_t typeCount= 0;
+
+  for (int i= 0; i < 2; ++i) {
+    int32_t rows= 0;
+    res.reset(dbmeta->getTypeInfo());
+    ASSERT(res->next());
+    ASSERT_EQUALS(18U, res->getMetaData()->getColumnCount());
+    ASSERT_EQUALS("BIT", res->getString(1));
+    do {
+      ++rows;
+    } while (res->next());
+    if (i == 0) {
+      typeCount= rows;
+    }
+    ASSERT_EQUALS(typeCount, rows);
+
+    res.reset(dbmeta->getTableTypes());
+    ASSERT_EQUALS("TABLE_TYPE", res->getMetaData()->getColumnLabel(1));
+    ASSERT(res->next());
+    ASSERT_EQUALS("TABLE", res->getString(1));
+    ASSERT(res->next());
+    ASSERT_EQUALS("SYSTEM VIEW", res->getString(1));
+    ASSERT(res->next());
+    ASSERT_EQUALS("VIEW", res->getString(1));
+    ASSERT(!res->next());
+
+    res.reset(dbmeta->getCatalogs());
+    ASSERT_EQUALS("TABLE_CAT", res->getMetaData()->getColumnLabel(1));
+    ASSERT(!res->next());
+
+    res.reset(dbmeta->getClientInfoProperties());
+    rows= 0;
+    while (res->next()) {
+      ++rows;
+    }
+    ASSERT_EQUALS(3, rows);
+  }
+  /* None of them has been sent to the server */
+  ASSERT_EQUALS(queries, con->getMetrics().queries);
+}
+
 } /* namespace connectionmetadata */
 } /* namespace testsuite */
@@ -106,6 +106,8 @@ public:
   TEST_CASE(getTableCharset);
   TEST_CASE(getTables);
   TEST_CASE(bugCpp25);
+  TEST_CASE(metadataCache);
+  TEST_CASE(constantResults);
   }
 
   /**
@@ -391,6 +393,16 @@ public:
    * Test of server version
    */
   void bugCpp25();
+
+  /**
+   * Test of the metadata cache(metadataCacheTtl), including stored procedures parameters, and of its invalidation by DDL
+   */
+  void metadataCache();
+
+  /**
+   * Test of the results, that the DatabaseMetaData builds without the server, e.g. getTypeInfo, getTableTypes
+   */
+  void constantResults();
 };
 
 REGISTER_FIXTURE(connectionmetadata);
@@ -94,6 +94,43 @@ public:
     TEST_CASE(concpp94_loadLocalInfile);
     TEST_CASE(concpp105_conn_concurrency);
     TEST_CASE(concpp112_connection_attributes);
+    TEST_CASE(pool);
+    TEST_CASE(pipeline);
+    TEST_CASE(bulkLoad);
+    TEST_CASE(connectionDescriptor);
+    TEST_CASE(isolationTracking);
+    TEST_CASE(connectRace);
+    TEST_CASE(replicationReadOnly);
+    TEST_CASE(retryOnFailover);
+    TEST_CASE(poolCircuitBreaker);
+    TEST_CASE(poolMaxLifetime);
+    TEST_CASE(poolIdleTrim);
+    TEST_CASE(poolPriorityQueue);
+    TEST_CASE(sharedPool);
+    TEST_CASE(metrics);
+    TEST_CASE(memoryLimit);
+    TEST_CASE(tracing);
+    TEST_CASE(slowQueryLog);
+    TEST_CASE(statementDigests);
+    TEST_CASE(exceptionMessage);
+    TEST_CASE(protocolReplay);
+    TEST_CASE(threadSafeConnection);
+    TEST_CASE(multiplexer);
+    TEST_CASE(validMinDelay);
+    TEST_CASE(parallelBatchExecutor);
+    TEST_CASE(deferredSessionState);
+    TEST_CASE(pipelineTransactionEnd);
+    TEST_CASE(pipelineSavepoints);
+    TEST_CASE(prepareWarmup);
+    TEST_CASE(prepareResetWarmup);
+    TEST_CASE(dnsCache);
+    TEST_CASE(failoverStandby);
+    TEST_CASE(poolKeepAlive);
+    TEST_CASE(readYourWrites);
+    TEST_CASE(shardRouter);
+    TEST_CASE(allocator);
+    TEST_CASE(asyncInsertQueue);
+    TEST_CASE(sequenceAllocator);
   }
 
   /**
@@ -288,6 +325,90 @@ public:
 
   /* Setting of connection attributes for perfschema */
   void concpp112_connection_attributes();
+  /* Connections from the pool - reuse, state reset, and waiting for a free connection */
+  void pool();
+  /* Queries sent with the pipeline, and their results read in order */
+  void pipeline();
+  /* Loading of rows generated in memory with LOAD DATA LOCAL INFILE - escaping of values, NULLs and errors */
+  void bulkLoad();
+  /* Connections opened with once parsed connection parameters */
+  void connectionDescriptor();
+  /* Transaction isolation changed with SQL is seen by getTransactionIsolation */
+  void isolationTracking();
+  /* Connection to unreachable host does not delay the connection to next url host with connectAttemptDelay */
+  void connectRace();
+  /* Read-only connection of replication HA mode goes to replica outside of transactions. The test uses the same server
+     as both master and replica */
+  void replicationReadOnly();
+  /* With retryOnFailover reads and statements marked retryable are executed again on new connection, if the
+     connection is killed */
+  void retryOnFailover();
+  /* Pool stops connecting to the host after circuitBreakerThreshold consecutive failures, and fails fast */
+  void poolCircuitBreaker();
+  /* Pooled connections older than maxLifetime are replaced */
+  void poolMaxLifetime();
+  /* Connections idle in the pool for idleTrimTime release their buffers, and stay in the pool */
+  void poolIdleTrim();
+  /* Waiters for a pooled connection are served by priority, and do not get it past their deadline */
+  void poolPriorityQueue();
+  /* Connections of the shared pool are lent to other users */
+  void sharedPool();
+  /* Connection's metrics count executed queries and fetched rows, and are part of the driver's snapshot */
+  void metrics();
+  /* Result set, that would take over maxResultSetMemory, fails with HY001, and the connection stays usable */
+  void memoryLimit();
+  /* Installed tracer gets the span of a query with its digest and row count */
+  void tracing();
+  /* Only queries slower than slowQueryThresholdNanos get into the queryLogFile */
+  void slowQueryLog();
+  /* Executions with different literals are aggregated under one digest, and the table does not grow over its capacity */
+  void statementDigests();
+  /* Server error message gets the connection id, and with dumpQueriesOnException the query, also in copies */
+  void exceptionMessage();
+  /* Connection recorded with protocolRecordFile is played back with protocolReplayFile without the server */
+  void protocolReplay();
+  /* With threadSafeConnection=false the connection works for one thread as usual, also with the streamed result */
+  void threadSafeConnection();
+  /* Threads sharing two connections of the multiplexer each get the result or the error of their own query */
+  void multiplexer();
+  /* isValid within validMinDelay does not ping the server, but still sees the connection closed by the server */
+  void validMinDelay();
+  /* Batch split across four connections gets its update counts in order, and only the partition with the failed row
+     is rolled back */
+  void parallelBatchExecutor();
+  /* Autocommit, isolation and database changes are sent with the next query without round trips of their own, and
+     the change to the current value is not sent at all */
+  void deferredSessionState();
+  /* With pipelineTransactionEnd COMMIT and ROLLBACK take effect with the next statement or closing, and cost no round
+     trips of their own */
+  void pipelineTransactionEnd();
+  /* With pipelineSavepoints savepoints are set and released with the next statement, and the pair with nothing
+     executed in between is not sent at all */
+  void pipelineSavepoints();
+  /* Statements of the driver's warm-up list are in the prepared statements cache of the new connection */
+  void prepareWarmup();
+  /* With prepStmtCacheResetWarmup the most recently used cached statements are prepared again by the connection reset */
+  void prepareResetWarmup();
+  /* Connections with dnsCacheTtl reuse the resolved address of the host, also after a failed connect to it */
+  void dnsCache();
+  /* With failoverStandby the killed connection is replaced by the standby connection to the other url host. The test
+     uses the same server by two names */
+  void failoverStandby();
+  /* Idle pooled connections are pinged every poolKeepAlive seconds */
+  void poolKeepAlive();
+  /* With readYourWrites the read-only connection sees the row, it has just written on the master. The test uses the
+     same server as both master and replica */
+  void readYourWrites();
+  /* Keys are routed to shards by the hash or range function, and the query on all shards returns their rows shard by
+     shard. The test uses the same server as all shards */
+  void shardRouter();
+  /* Parameters and stored rows are allocated by the installed allocator, and return to it after its uninstalling */
+  void allocator();
+  /* Rows queued by several threads are inserted in batches, each row's future gets its update count, and rows of the
+     failed batch get its exception */
+  void asyncInsertQueue();
+  /* Values handed out by several threads come from the blocks of the sequence's INCREMENT, and do not repeat */
+  void sequenceAllocator();
 
   void setUp();
 };
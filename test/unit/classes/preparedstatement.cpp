@@ -34,10 +34,15 @@
 #include "PreparedStatement.hpp"
 #include "Connection.hpp"
 #include "Warning.hpp"
+#include "ArrowExport.hpp"
 #include "preparedstatementtest.h"
+// For the Connector/C capabilities, that the driver is built with
+#include "mysql.h"
 #include <stdlib.h>
 
 #include <memory>
+#include <fstream>
+#include <thread>
 
 namespace testsuite
 {
@@ -1973,7 +1978,7 @@ void preparedstatement::concpp99_batchRewrite()
 
   const sql::SQLString insertQuery[]{"INSERT INTO concpp99_batchRewrite VALUES(?,?)",
                                      "INSERT INTO concpp99_batchRewrite(id) VALUES(?) ON DUPLICATE KEY UPDATE val=?"};
-  const int32_t id[]{1, 2, 3}, batchResult[]{sql::Statement::SUCCESS_NO_INFO, 1};
+  const int32_t id[]{1, 2, 3}, batchResult[]{1, 1};
   const sql::SQLString val[][3]{{"X'1", "y\"2", "xxx"}, {"","",""}},
     selectQuery("SELECT id, val FROM concpp99_batchRewrite ORDER BY id"),
     deleteQuery("DELETE FROM concpp99_batchRewrite");
@@ -1996,7 +2001,7 @@ void preparedstatement::concpp99_batchRewrite()
       ASSERT(res->next());
       ASSERT_EQUALS(id[row], res->getInt(1));
       ASSERT_EQUALS(val[i][row], res->getString(2));
-      // With rewriteBatchedStatements we don't have separate results for each parameters set - only SUCCESS_NO_INFO
+      // The rewritten query's count is the number of rows, and each row gets 1
       ASSERT_EQUALS(batchResult[i], batchRes[row]);
     }
     ASSERT(!res->next());
@@ -2019,7 +2024,6 @@ void preparedstatement::concpp99_batchRewrite()
       ASSERT(res->next());
       ASSERT_EQUALS(id[row] + 3, res->getInt(1));
       ASSERT_EQUALS(val[i][row], res->getString(2));
-      // With rewriteBatchedStatements we don't have separate results for each parameters set - only SUCCESS_NO_INFO
       ASSERT_EQUALS(static_cast<int64_t>(batchResult[i]), batchLRes[row]);
     }
     ASSERT(!res->next());
@@ -2048,6 +2052,12 @@ void preparedstatement::concpp106_batchBulk()
     *val_expected[][4]{{nullptr, "X'1", "xxx", "y\"2"}, {nullptr, nullptr, nullptr, nullptr}};
   const sql::SQLString selectQuery("SELECT id, val FROM concpp106_batchBulk ORDER BY id"),
     deleteQuery("DELETE FROM concpp106_batchBulk");
+  // MariaDB 11.5+ sends bulk unit results, if Connector/C supports them, and then each row has its update count
+#ifdef MARIADB_CLIENT_BULK_UNIT_RESULTS
+  const bool unitResults= !isMySQL() && getServerVersion(con) >= 1105000;
+#else
+  const bool unitResults= false;
+#endif
 
   for (std::size_t i = 0; i < sizeof(insertQuery) / sizeof(insertQuery[0]); ++i) {
     pstmt.reset(con->prepareStatement(insertQuery[i]));
@@ -2083,8 +2093,8 @@ void preparedstatement::concpp106_batchBulk()
         ASSERT_EQUALS(val_expected[i][row], res->getString(2));
       }
       // With bulk we don't have separate results for each parameters set - only SUCCESS_NO_INFO.
-      // Unless with mysql where it is not supported
-      ASSERT_EQUALS(isMySQL() ? 1 : batchResult[i], batchRes[row]);
+      // Unless with mysql where it is not supported, or with bulk unit results
+      ASSERT_EQUALS(isMySQL() || unitResults ? 1 : batchResult[i], batchRes[row]);
     }
     ASSERT(!res->next());
     ////// The same, but for executeLargeBatch
@@ -2122,7 +2132,7 @@ void preparedstatement::concpp106_batchBulk()
         ASSERT_EQUALS(val_expected[i][row], res->getString(2));
       }
       // With rewriteBatchedStatements we don't have separate results for each parameters set - only SUCCESS_NO_INFO
-      ASSERT_EQUALS(isMySQL() ? 1LL : static_cast<int64_t>(batchResult[i]), batchLRes[row]);
+      ASSERT_EQUALS(isMySQL() || unitResults ? 1LL : static_cast<int64_t>(batchResult[i]), batchLRes[row]);
     }
     ASSERT(!res->next());
     stmt->executeUpdate(deleteQuery);
@@ -2218,5 +2228,1160 @@ void preparedstatement::multirs_caching()
   ASSERT_EQUALS(-1, pstmt1->getUpdateCount());
 }
 
+void preparedstatement::serverCursorFetch()
+{
+  std::ostringstream query("INSERT INTO ccpptest_cursor(id) VALUES(1)", std::ios_base::ate);
+
+  for (int32_t i= 2; i <= 100; ++i) {
+    query << ",(" << i << ")";
+  }
+  createSchemaObject("TABLE", "ccpptest_cursor", "(id INT NOT NULL PRIMARY KEY)");
+  stmt.reset(sspsCon->createStatement());
+  stmt->executeUpdate(query.str());
+
+  PreparedStatement pstmt1(sspsCon->prepareStatement("SELECT id FROM ccpptest_cursor WHERE id > ? ORDER BY id"));
+  pstmt1->setFetchSize(3);
+  pstmt1->setInt(1, 0);
+  ResultSet res1(pstmt1->executeQuery());
+
+  for (int32_t i= 1; i <= 100; ++i) {
+    ASSERT(res1->next());
+    ASSERT_EQUALS(i, res1->getInt(1));
+    if (i % 10 == 0) {
+      // Connection is free while cursor is open
+      res.reset(stmt->executeQuery("SELECT " + std::to_string(i)));
+      ASSERT(res->next());
+      ASSERT_EQUALS(i, res->getInt(1));
+    }
+  }
+  ASSERT(!res1->next());
+
+  // Closing the result set with the cursor open, and then re-executing
+  res1.reset(pstmt1->executeQuery());
+  ASSERT(res1->next());
+  ASSERT_EQUALS(1, res1->getInt(1));
+  res1.reset();
+  pstmt1->setInt(1, 95);
+  res1.reset(pstmt1->executeQuery());
+  for (int32_t i= 96; i <= 100; ++i) {
+    ASSERT(res1->next());
+    ASSERT_EQUALS(i, res1->getInt(1));
+  }
+  ASSERT(!res1->next());
+
+  // Without fetch size the result is read as before
+  pstmt1->setFetchSize(0);
+  res1.reset(pstmt1->executeQuery());
+  ASSERT_EQUALS(5ULL, static_cast<uint64_t>(res1->rowsCount()));
+}
+
+
+void preparedstatement::prepareCache()
+{
+  sql::Properties p{{"useServerPrepStmts", "true"}, {"cachePrepStmts", "true"}};
+  Connection con2(getConnection(&p));
+  sql::ConnectionMetrics before= con2->getMetrics();
+
+  PreparedStatement pstmt1(con2->prepareStatement("SELECT ? + 1"));
+  pstmt1->setInt(1, 1);
+  res.reset(pstmt1->executeQuery());
+  ASSERT(res->next());
+  ASSERT_EQUALS(2, res->getInt(1));
+
+  // The cached statement is used by pstmt1, and the second one prepares its own
+  PreparedStatement pstmt2(con2->prepareStatement("SELECT ? + 1"));
+  ASSERT_EQUALS(before.prepares + 2, con2->getMetrics().prepares);
+  pstmt2->setInt(1, 2);
+  std::unique_ptr<sql::ResultSet> res2(pstmt2->executeQuery());
+  ASSERT(res2->next());
+  ASSERT_EQUALS(3, res2->getInt(1));
+  ASSERT_EQUALS(2, res->getInt(1));
+
+  // Closed statement leaves its prepare in the cache
+  res.reset();
+  pstmt1->close();
+  pstmt1.reset(con2->prepareStatement("SELECT ? + 1"));
+  sql::ConnectionMetrics after= con2->getMetrics();
+  ASSERT_EQUALS(before.prepares + 2, after.prepares);
+  ASSERT_EQUALS(before.prepareCacheHits + 1, after.prepareCacheHits);
+  pstmt1->setInt(1, 41);
+  res.reset(pstmt1->executeQuery());
+  ASSERT(res->next());
+  ASSERT_EQUALS(42, res->getInt(1));
+
+  // The same with the statement deleted without close
+  res.reset();
+  pstmt1.reset();
+  pstmt1.reset(con2->prepareStatement("SELECT ? + 1"));
+  ASSERT_EQUALS(before.prepares + 2, con2->getMetrics().prepares);
+
+  // The query is prepared in the current database, that is the part of the cache key
+  Statement st(con2->createStatement());
+  st->executeUpdate("DROP DATABASE IF EXISTS ccpptest_prepare_cache");
+  st->executeUpdate("CREATE DATABASE ccpptest_prepare_cache");
+  con2->setSchema("ccpptest_prepare_cache");
+  pstmt1.reset(con2->prepareStatement("SELECT ? + 1"));
+  ASSERT_EQUALS(before.prepares + 3, con2->getMetrics().prepares);
+  st->executeUpdate("DROP DATABASE ccpptest_prepare_cache");
+}
+
+
+void preparedstatement::sharedParsedQuery()
+{
+  const sql::SQLString query("SELECT ?, '\\' ?', ? /* ? */");
+  sql::ConnectOptionsMap connection_properties{{"userName", user}, {"password", passwd}, {"useTls", useTls ? "true" : "false"}};
+  Connection con2(driver->connect(url, connection_properties));
+  connection_properties["parsedQueryCacheSize"]= "0";
+  Connection con3(driver->connect(url, connection_properties));
+
+  PreparedStatement pstmt1(con->prepareStatement(query));
+  PreparedStatement pstmt2(con2->prepareStatement(query));
+  PreparedStatement pstmt3(con3->prepareStatement(query));
+  // The statement, that parsed the query, is gone
+  pstmt1.reset();
+
+  pstmt2->setInt(1, 1);
+  pstmt2->setString(2, "two");
+  res.reset(pstmt2->executeQuery());
+  ASSERT(res->next());
+  ASSERT_EQUALS(1, res->getInt(1));
+  ASSERT_EQUALS("' ?", res->getString(2));
+  ASSERT_EQUALS("two", res->getString(3));
+
+  pstmt3->setInt(1, 3);
+  pstmt3->setString(2, "four");
+  res.reset(pstmt3->executeQuery());
+  ASSERT(res->next());
+  ASSERT_EQUALS(3, res->getInt(1));
+  ASSERT_EQUALS("four", res->getString(3));
+
+  // The same query text has different number of parameters with NO_BACKSLASH_ESCAPES, and without it
+  stmt.reset(con2->createStatement());
+  stmt->execute("SET SESSION sql_mode=CONCAT(@@sql_mode, ',NO_BACKSLASH_ESCAPES')");
+  const sql::SQLString noEscQuery("SELECT ?, '\\', ?");
+  pstmt2.reset(con2->prepareStatement(noEscQuery));
+  pstmt1.reset(con->prepareStatement(noEscQuery));
+  ASSERT_EQUALS(2U, pstmt2->getParameterMetaData()->getParameterCount());
+  ASSERT_EQUALS(1U, pstmt1->getParameterMetaData()->getParameterCount());
+  pstmt2->setInt(1, 5);
+  pstmt2->setInt(2, 6);
+  res.reset(pstmt2->executeQuery());
+  ASSERT(res->next());
+  ASSERT_EQUALS("\\", res->getString(2));
+  ASSERT_EQUALS(6, res->getInt(3));
+}
+
+
+void preparedstatement::pipelinePrepare()
+{
+  sql::Properties p{{"useServerPrepStmts", "true"}, {"pipelinePrepare", "true"}};
+  Connection con2(getConnection(&p));
+
+  PreparedStatement pstmt1(con2->prepareStatement("SELECT ? + 1, ?"));
+  pstmt1->setInt(1, 1);
+  pstmt1->setString(2, "one");
+  res.reset(pstmt1->executeQuery());
+  ASSERT(res->next());
+  ASSERT_EQUALS(2, res->getInt(1));
+  ASSERT_EQUALS("one", res->getString(2));
+  ASSERT_EQUALS(2U, res->getMetaData()->getColumnCount());
+  ASSERT(!res->next());
+
+  // Re-execution uses the statement prepared with the first execution
+  pstmt1->setInt(1, 10);
+  pstmt1->setString(2, "ten");
+  res.reset(pstmt1->executeQuery());
+  ASSERT(res->next());
+  ASSERT_EQUALS(11, res->getInt(1));
+  ASSERT_EQUALS("ten", res->getString(2));
+
+  // Metadata requested before the execution prepares the statement
+  pstmt1.reset(con2->prepareStatement("SELECT ?"));
+  ASSERT_EQUALS(1U, pstmt1->getParameterMetaData()->getParameterCount());
+  pstmt1->setInt(1, 3);
+  res.reset(pstmt1->executeQuery());
+  ASSERT(res->next());
+  ASSERT_EQUALS(3, res->getInt(1));
+
+  // Wrong query fails only when executed, and the connection stays usable
+  pstmt1.reset(con2->prepareStatement("SELECT * FROM nonexistent_pipeline_table WHERE id=?"));
+  pstmt1->setInt(1, 1);
+  try {
+    pstmt1->executeQuery();
+    FAIL("Query has to fail");
+  }
+  catch (sql::SQLException& e) {
+    ASSERT_EQUALS(1146, e.getErrorCode());
+  }
+  stmt.reset(con2->createStatement());
+  res.reset(stmt->executeQuery("SELECT 1"));
+  ASSERT(res->next());
+}
+
+
+void preparedstatement::bulkGeneratedKeys()
+{
+  sql::ConnectOptionsMap connection_properties{ {"userName", user}, {"password", passwd}, {"useBulkStmts", "true"}, {"useTls", useTls ? "true" : "false"} };
+
+  con.reset(driver->connect(url, connection_properties));
+  con->setSchema(db);
+  stmt.reset(sspsCon->createStatement());
+  createSchemaObject("TABLE", "bulkGeneratedKeys", "(id int not NULL PRIMARY KEY AUTO_INCREMENT, val VARCHAR(31))");
+
+  // Without generated keys the batch is executed with the bulk command anyway. Its update counts tell if the server
+  // sends bulk unit results(MariaDB 11.5+)
+  pstmt.reset(con->prepareStatement("INSERT INTO bulkGeneratedKeys(val) VALUES(?)"));
+  pstmt->setString(1, "probe1");
+  pstmt->addBatch();
+  pstmt->setString(1, "probe2");
+  pstmt->addBatch();
+  const bool unitResults= !isMySQL() && pstmt->executeBatch()[0] == 1;
+  stmt->executeUpdate("DELETE FROM bulkGeneratedKeys");
+
+  uint64_t bulkExecutes= con->getMetrics().bulkExecutes;
+  pstmt.reset(con->prepareStatement("INSERT INTO bulkGeneratedKeys(val) VALUES(?)", sql::Statement::RETURN_GENERATED_KEYS));
+  for (int32_t row= 0; row < 3; ++row) {
+    pstmt->setString(1, "val" + std::to_string(row));
+    pstmt->addBatch();
+  }
+  const sql::Ints& batchRes= pstmt->executeBatch();
+  ASSERT_EQUALS(3U, static_cast<uint32_t>(batchRes.size()));
+  // Unit results carry the generated keys, and the batch goes in one bulk command. Otherwise the keys need the
+  // execution of each parameter set
+  ASSERT_EQUALS(bulkExecutes + (unitResults ? 1 : 0), con->getMetrics().bulkExecutes);
+
+  res.reset(pstmt->getGeneratedKeys());
+  ResultSet ids(stmt->executeQuery("SELECT id FROM bulkGeneratedKeys ORDER BY id"));
+  for (int32_t row= 0; row < 3; ++row) {
+    ASSERT(res->next());
+    ASSERT(ids->next());
+    ASSERT_EQUALS(ids->getInt64(1), res->getInt64(1));
+  }
+  ASSERT(!res->next());
+}
+
+
+void preparedstatement::parameterArrays()
+{
+  const int64_t id[]{1, 2, 3, 4};
+  const double num[]{0.5, 1.5, 0, 2.5};
+  const char* str[]{"one", "two", nullptr, "four"};
+  const unsigned long strLen[]{3, 3, 0, 4};
+  const char numNull[]{0, 0, 1, 0}, strNull[]{0, 0, 1, 0};
+
+  stmt.reset(sspsCon->createStatement());
+  createSchemaObject("TABLE", "parameterArrays", "(id BIGINT NOT NULL PRIMARY KEY, num DOUBLE, str VARCHAR(31))");
+
+  pstmt.reset(sspsCon->prepareStatement("INSERT INTO parameterArrays VALUES(?,?,?)"));
+  pstmt->setArray(1, id, nullptr, 4);
+  pstmt->setArray(2, num, numNull, 4);
+  pstmt->setArray(3, str, strLen, strNull, 4);
+  // All arrays must have the same size
+  try {
+    pstmt->setArray(2, num, nullptr, 3);
+    FAIL("Array of different size has been accepted");
+  }
+  catch (sql::SQLException& e) {
+    ASSERT_EQUALS("HY090", e.getSQLState());
+  }
+  const sql::Ints& batchRes= pstmt->executeBatch();
+  ASSERT_EQUALS(4U, static_cast<uint32_t>(batchRes.size()));
+
+  res.reset(stmt->executeQuery("SELECT id, num, str FROM parameterArrays ORDER BY id"));
+  for (std::size_t row= 0; row < 4; ++row) {
+    ASSERT(res->next());
+    ASSERT_EQUALS(id[row], res->getInt64(1));
+    if (numNull[row]) {
+      ASSERT(res->isNull(2));
+      ASSERT(res->isNull(3));
+    }
+    else {
+      ASSERT_EQUALS(num[row], res->getDouble(2));
+      ASSERT_EQUALS(str[row], res->getString(3));
+    }
+  }
+  ASSERT(!res->next());
+
+  // Statement is executed normally after the array batch
+  pstmt->clearBatch();
+  pstmt->setInt(1, 5);
+  pstmt->setDouble(2, 3.5);
+  pstmt->setString(3, "five");
+  ASSERT_EQUALS(1, pstmt->executeUpdate());
+
+  // Client side prepared statements do not support arrays
+  pstmt.reset(con->prepareStatement("INSERT INTO parameterArrays VALUES(?,?,?)"));
+  try {
+    pstmt->setArray(1, id, nullptr, 4);
+    FAIL("Client side prepared statement has accepted parameter array");
+  }
+  catch (sql::SQLFeatureNotSupportedException&) {
+  }
+}
+
+
+void preparedstatement::batchChunksInFlight()
+{
+  stmt.reset(sspsCon->createStatement());
+  res.reset(stmt->executeQuery("SELECT @@max_allowed_packet"));
+  ASSERT(res->next());
+  const std::size_t rowLength= static_cast<std::size_t>(res->getUInt64(1)/4);
+  if (rowLength > 16*1024*1024) {
+    SKIP("max_allowed_packet is too big for the test");
+  }
+  createSchemaObject("TABLE", "batchChunksInFlight", "(id INT NOT NULL PRIMARY KEY, val LONGTEXT)");
+
+  sql::ConnectOptionsMap connection_properties{{"userName", user}, {"password", passwd}, {"useTls", useTls ? "true" : "false"},
+    {"rewriteBatchedStatements", "true"}, {"batchChunksInFlight", "3"}};
+  con.reset(driver->connect(url, connection_properties));
+  con->setSchema(db);
+
+  const sql::SQLString value(std::string(rowLength, 'x'));
+  const sql::SQLString insertQuery[]{"INSERT INTO batchChunksInFlight VALUES(?,?)",
+                                     "INSERT INTO batchChunksInFlight VALUES(?,?) ON DUPLICATE KEY UPDATE val=VALUES(val)"};
+
+  for (auto& query : insertQuery) {
+    stmt->executeUpdate("DELETE FROM batchChunksInFlight");
+    pstmt.reset(con->prepareStatement(query));
+    // About 3 rows fit one chunk, i.e. 4 chunks
+    for (int32_t id= 1; id <= 10; ++id) {
+      pstmt->setInt(1, id);
+      pstmt->setString(2, value);
+      pstmt->addBatch();
+    }
+    ASSERT_EQUALS(10U, static_cast<uint32_t>(pstmt->executeBatch().size()));
+
+    res.reset(stmt->executeQuery("SELECT COUNT(*), SUM(LENGTH(val)) FROM batchChunksInFlight"));
+    ASSERT(res->next());
+    ASSERT_EQUALS(10, res->getInt(1));
+    ASSERT_EQUALS(static_cast<uint64_t>(rowLength*10), res->getUInt64(2));
+  }
+
+  // Error in one of the chunks, the connection stays usable
+  pstmt.reset(con->prepareStatement(insertQuery[0]));
+  for (int32_t id= 11; id <= 20; ++id) {
+    pstmt->setInt(1, id == 15 ? 1 : id);
+    pstmt->setString(2, value);
+    pstmt->addBatch();
+  }
+  try {
+    pstmt->executeBatch();
+    FAIL("Batch with duplicate key has to fail");
+  }
+  catch (sql::SQLException& e) {
+    ASSERT_EQUALS(1062, e.getErrorCode());
+  }
+  stmt.reset(con->createStatement());
+  res.reset(stmt->executeQuery("SELECT 1"));
+  ASSERT(res->next());
+}
+
+
+void preparedstatement::rebindParameters()
+{
+  sql::Connection* conns[]= {con.get(), sspsCon.get()};
+
+  for (auto connection : conns) {
+    stmt.reset(connection->createStatement());
+    createSchemaObject("TABLE", "rebindParameters", "(id INT NOT NULL PRIMARY KEY, num DOUBLE, str VARCHAR(31))");
+    pstmt.reset(connection->prepareStatement("INSERT INTO rebindParameters VALUES(?,?,?)"));
+
+    for (int32_t id= 1; id <= 3; ++id) {
+      pstmt->setInt(1, id);
+      pstmt->setDouble(2, id / 2.0);
+      pstmt->setString(3, std::string(static_cast<std::size_t>(id)*10, 'a'));
+      ASSERT_EQUALS(1, pstmt->executeUpdate());
+    }
+    // Values, that have been added to the batch, must not be changed by following set calls
+    for (int32_t id= 4; id <= 6; ++id) {
+      pstmt->setInt(1, id);
+      pstmt->setDouble(2, id / 2.0);
+      pstmt->setString(3, std::string(static_cast<std::size_t>(id)*10, 'a'));
+      pstmt->addBatch();
+    }
+    pstmt->executeBatch();
+
+    res.reset(stmt->executeQuery("SELECT id, num, str FROM rebindParameters ORDER BY id"));
+    for (int32_t id= 1; id <= 6; ++id) {
+      ASSERT(res->next());
+      ASSERT_EQUALS(id, res->getInt(1));
+      ASSERT_EQUALS(id / 2.0, res->getDouble(2));
+      ASSERT_EQUALS(static_cast<uint64_t>(id*10), static_cast<uint64_t>(res->getString(3).length()));
+    }
+    ASSERT(!res->next());
+  }
+}
+
+
+void preparedstatement::reuseColumnMetadata()
+{
+  createSchemaObject("TABLE", "reuseColumnMetadata", "(id INT NOT NULL PRIMARY KEY, val VARCHAR(10))");
+  stmt->executeUpdate("INSERT INTO reuseColumnMetadata VALUES(1,'a'),(2,'bb')");
+  pstmt.reset(sspsCon->prepareStatement("SELECT * FROM reuseColumnMetadata WHERE id=?"));
+
+  for (int32_t id= 1; id <= 2; ++id) {
+    pstmt->setInt(1, id);
+    res.reset(pstmt->executeQuery());
+    ASSERT(res->next());
+    ASSERT_EQUALS(2, res->getMetaData()->getColumnCount());
+    ASSERT_EQUALS("val", res->getMetaData()->getColumnLabel(2));
+    ASSERT_EQUALS(id, res->getInt("id"));
+    ASSERT_EQUALS(std::string(static_cast<std::size_t>(id), id == 1 ? 'a' : 'b'), std::string(res->getString("val").c_str()));
+  }
+  stmt->executeUpdate("ALTER TABLE reuseColumnMetadata ADD COLUMN extra BIGINT NOT NULL DEFAULT 7");
+
+  pstmt->setInt(1, 2);
+  res.reset(pstmt->executeQuery());
+  ASSERT(res->next());
+  ASSERT_EQUALS(3, res->getMetaData()->getColumnCount());
+  ASSERT_EQUALS("extra", res->getMetaData()->getColumnLabel(3));
+  ASSERT_EQUALS(static_cast<int64_t>(7), res->getLong("extra"));
+  ASSERT_EQUALS("bb", res->getString("val"));
+}
+
+
+void preparedstatement::tryExecute()
+{
+  createSchemaObject("TABLE", "tryExecute", "(id INT NOT NULL PRIMARY KEY)");
+  sql::ErrorInfo error;
+
+  ASSERT(!stmt->tryExecute("SELECT * FROM tryExecuteNoSuchTable", error));
+  ASSERT(error.failed());
+  ASSERT_EQUALS(sql::ErrorInfo::SYNTAX, error.kind);
+  ASSERT_EQUALS(1146, error.errorCode);
+  ASSERT_EQUALS("42S02", error.sqlState);
+  ASSERT(stmt->tryExecute("SELECT 1", error));
+  ASSERT(!error.failed());
+  res.reset(stmt->getResultSet());
+  ASSERT(res->next());
+  ASSERT_EQUALS(1, res->getInt(1));
+
+  sql::Connection* conns[]= {con.get(), sspsCon.get()};
+  for (auto conn : conns) {
+    stmt.reset(conn->createStatement());
+    stmt->executeUpdate("DELETE FROM tryExecute");
+    pstmt.reset(conn->prepareStatement("INSERT INTO tryExecute VALUES(?)"));
+    pstmt->setInt(1, 1);
+    ASSERT_EQUALS(1, pstmt->tryExecuteUpdate(error));
+    ASSERT(!error.failed());
+    ASSERT_EQUALS(static_cast<int32_t>(sql::Statement::EXECUTE_FAILED), pstmt->tryExecuteUpdate(error));
+    ASSERT_EQUALS(sql::ErrorInfo::INTEGRITY_CONSTRAINT_VIOLATION, error.kind);
+    ASSERT_EQUALS(1062, error.errorCode);
+    ASSERT_EQUALS("23000", error.sqlState);
+
+    pstmt->setInt(1, 2);
+    ASSERT(pstmt->tryExecute(error));
+    ASSERT_EQUALS(1, pstmt->getUpdateCount());
+  }
+}
+
+
+void preparedstatement::longDataChunks()
+{
+  createSchemaObject("TABLE", "longDataChunks", "(id INT NOT NULL PRIMARY KEY, b LONGBLOB)");
+  sql::ConnectOptionsMap connection_properties{{"userName", user}, {"password", passwd}, {"useTls", useTls ? "true" : "false"},
+    {"useServerPrepStmts", "true"}, {"longDataChunkSize", "1000"}};
+  std::string value(100000, 'a');
+
+  for (std::size_t i= 0; i < value.length(); ++i) {
+    value[i]= static_cast<char>('a' + i % 26);
+  }
+  for (auto readAhead : {"false", "true"}) {
+    connection_properties["longDataReadAhead"]= readAhead;
+    Connection con2(driver->connect(url, connection_properties));
+    con2->setSchema(db);
+    Statement st(con2->createStatement());
+    st->executeUpdate("DELETE FROM longDataChunks");
+
+    PreparedStatement ins(con2->prepareStatement("INSERT INTO longDataChunks VALUES(?, ?)"));
+    std::istringstream whole(value);
+    ins->setInt(1, 1);
+    ins->setBlob(2, &whole);
+    ins->executeUpdate();
+
+    std::istringstream part(value);
+    ins->setInt(1, 2);
+    ins->setBlob(2, &part, 50500);
+    ins->executeUpdate();
+    // The same parameter sends the value from the current position of the stream again
+    ins->setInt(1, 3);
+    ins->executeUpdate();
+
+    res.reset(st->executeQuery("SELECT id, b FROM longDataChunks ORDER BY id"));
+    ASSERT(res->next());
+    ASSERT(value == res->getString(2).c_str());
+    ASSERT(res->next());
+    ASSERT(value.substr(0, 50500) == res->getString(2).c_str());
+    ASSERT(res->next());
+    ASSERT(value.substr(50500, 49500) == res->getString(2).c_str());
+    ASSERT(!res->next());
+  }
+}
+
+
+void preparedstatement::blobFromFile()
+{
+  createSchemaObject("TABLE", "blobFromFile", "(id INT NOT NULL PRIMARY KEY, b LONGBLOB)");
+  const char* fileName= "test_blob_from_file.bin", *emptyFileName= "test_blob_from_file_empty.bin";
+  std::string value(100000, 'a');
+
+  for (std::size_t i= 0; i < value.length(); ++i) {
+    value[i]= static_cast<char>(i % 256);
+  }
+  std::ofstream file(fileName, std::ios::binary);
+  file.write(value.c_str(), value.length());
+  file.close();
+  std::ofstream emptyFile(emptyFileName, std::ios::binary);
+  emptyFile.close();
+
+  sql::Connection* conns[]= {con.get(), sspsCon.get()};
+  for (auto conn : conns) {
+    stmt.reset(conn->createStatement());
+    stmt->executeUpdate("DELETE FROM blobFromFile");
+    pstmt.reset(conn->prepareStatement("INSERT INTO blobFromFile VALUES(?, ?)"));
+    pstmt->setInt(1, 1);
+    pstmt->setBlobFromFile(2, fileName);
+    ASSERT_EQUALS(1, pstmt->executeUpdate());
+    // Re-execution sends the whole file again
+    pstmt->setInt(1, 2);
+    ASSERT_EQUALS(1, pstmt->executeUpdate());
+    pstmt->setInt(1, 3);
+    pstmt->setBlobFromFile(2, emptyFileName);
+    ASSERT_EQUALS(1, pstmt->executeUpdate());
+
+    try {
+      pstmt->setBlobFromFile(2, "test_blob_from_file_no_such_file.bin");
+      FAIL("Not existing file not detected");
+    }
+    catch (sql::SQLException&) {
+    }
+
+    res.reset(stmt->executeQuery("SELECT id, b FROM blobFromFile ORDER BY id"));
+    for (int32_t id= 1; id < 3; ++id) {
+      ASSERT(res->next());
+      sql::SQLString read(res->getString(2));
+      ASSERT_EQUALS(value.length(), static_cast<std::size_t>(read.length()));
+      ASSERT(value == std::string(read.c_str(), read.length()));
+    }
+    ASSERT(res->next());
+    ASSERT_EQUALS(0, static_cast<int32_t>(res->getString(2).length()));
+    ASSERT(!res->next());
+  }
+  pstmt.reset();
+  std::remove(fileName);
+  std::remove(emptyFileName);
+}
+
+
+void preparedstatement::callOutParameters()
+{
+  logMsg("preparedstatement::callOutParameters() - MySQL_CallableStatement::registerOutParameter");
+
+  stmt->execute("DROP PROCEDURE IF EXISTS test_out_params_proc");
+  stmt->execute("DROP FUNCTION IF EXISTS test_out_params_func");
+  stmt->execute("CREATE PROCEDURE test_out_params_proc(IN a INT, OUT b VARCHAR(20), INOUT c INT) SET b=CONCAT('v', a), c=c*a");
+  stmt->execute("CREATE FUNCTION test_out_params_func(a INT, b VARCHAR(10)) RETURNS VARCHAR(20) DETERMINISTIC "
+    "RETURN CONCAT(b, a)");
+
+  cstmt.reset(con->prepareCall("CALL test_out_params_proc(?, ?, ?)"));
+  cstmt->setInt(1, 7);
+  cstmt->registerOutParameter(2, sql::Types::VARCHAR);
+  cstmt->setInt(3, 3);
+  cstmt->registerOutParameter(3, sql::Types::INTEGER);
+  cstmt->execute();
+  ASSERT_EQUALS("v7", cstmt->getString(2));
+  ASSERT_EQUALS(21, cstmt->getInt(3));
+
+  cstmt.reset(con->prepareCall("{?= call test_out_params_func(?, ?)}"));
+  cstmt->registerOutParameter(1, sql::Types::VARCHAR);
+  cstmt->setInt(2, 5);
+  cstmt->setString(3, "x");
+  cstmt->execute();
+  ASSERT_EQUALS("x5", cstmt->getString(1));
+  cstmt->setInt(2, 6);
+  cstmt->execute();
+  ASSERT_EQUALS("x6", cstmt->getString(1));
+
+  cstmt.reset();
+  stmt->execute("DROP FUNCTION IF EXISTS test_out_params_func");
+  stmt->execute("DROP PROCEDURE IF EXISTS test_out_params_proc");
+}
+
+
+void preparedstatement::arrowBatch()
+{
+  ArrowSchema schema;
+  ArrowArray array;
+
+  stmt.reset(sspsCon->createStatement());
+  createSchemaObject("TABLE", "arrowBatch", "(id BIGINT NOT NULL PRIMARY KEY, name VARCHAR(31), d DATE)");
+
+  // The batch exported from one result is inserted as it is
+  res.reset(stmt->executeQuery("SELECT 1, 'one', CAST('1970-01-02' AS DATE) UNION ALL SELECT 2, NULL, NULL UNION ALL "
+    "SELECT 3, 'three', CAST('2000-02-29' AS DATE)"));
+  ASSERT_EQUALS(static_cast<std::size_t>(3), sql::exportArrowBatch(res.get(), 10, &schema, &array));
+
+  pstmt.reset(sspsCon->prepareStatement("INSERT INTO arrowBatch VALUES(?,?,?)"));
+  const sql::Longs& batchRes= sql::executeArrowBatch(pstmt.get(), &schema, &array);
+  ASSERT_EQUALS(3U, static_cast<uint32_t>(batchRes.size()));
+  schema.release(&schema);
+  array.release(&array);
+
+  res.reset(stmt->executeQuery("SELECT id, name, d FROM arrowBatch ORDER BY id"));
+  ASSERT(res->next());
+  ASSERT_EQUALS(std::string("one"), std::string(res->getString(2).c_str()));
+  ASSERT_EQUALS(std::string("1970-01-02"), std::string(res->getString(3).c_str()));
+  ASSERT(res->next());
+  ASSERT(res->isNull(2));
+  ASSERT(res->isNull(3));
+  ASSERT(res->next());
+  ASSERT_EQUALS(3, res->getInt(1));
+  ASSERT_EQUALS(std::string("2000-02-29"), std::string(res->getString(3).c_str()));
+  ASSERT(!res->next());
+
+  // Arrays are not left bound to the statement
+  pstmt->setInt(1, 4);
+  pstmt->setNull(2, sql::Types::VARCHAR);
+  pstmt->setNull(3, sql::Types::DATE);
+  ASSERT_EQUALS(1, pstmt->executeUpdate());
+}
+
+
+void preparedstatement::sharedParameterMetaData()
+{
+  sql::Properties p{{"user", user}, {"password", passwd}, {"useServerPrepStmts", "false"}};
+  Connection c(driver->connect(url, p));
+  PreparedStatement ps1(c->prepareStatement("SELECT ?, ? /* sharedParameterMetaData */"));
+  PreparedStatement ps2(c->prepareStatement("SELECT ?, ? /* sharedParameterMetaData */"));
+
+  sql::ParameterMetaData* md= ps1->getParameterMetaData();
+  ASSERT_EQUALS(2U, md->getParameterCount());
+  ASSERT(md == ps2->getParameterMetaData());
+
+  PreparedStatement noParams(c->prepareStatement("SELECT 1"));
+  ASSERT_EQUALS(0U, noParams->getParameterMetaData()->getParameterCount());
+  c->close();
+}
+
+
+void preparedstatement::serverPrepareThreshold()
+{
+  sql::Properties p{{"user", user}, {"password", passwd}, {"serverPrepareThreshold", "2"}};
+  Connection c(driver->connect(url, p));
+  Statement st(c->createStatement());
+  const sql::SQLString query("SELECT ? /* serverPrepareThreshold */");
+
+  auto prepares= [&st]() {
+    ResultSet rs(st->executeQuery("SHOW SESSION STATUS LIKE 'Com_stmt_prepare'"));
+    ASSERT(rs->next());
+    return rs->getInt64(2);
+  };
+  int64_t before= prepares();
+
+  // Executions of other statements of the query do not count
+  for (int32_t i= 0; i < 3; ++i) {
+    PreparedStatement ps(c->prepareStatement(query));
+    ps->setInt(1, i);
+    ResultSet rs(ps->executeQuery());
+    ASSERT(rs->next());
+    ASSERT_EQUALS(i, rs->getInt(1));
+  }
+  ASSERT_EQUALS(before, prepares());
+
+  PreparedStatement ps(c->prepareStatement(query));
+  for (int32_t i= 0; i < 2; ++i) {
+    ps->setInt(1, i);
+    ResultSet rs(ps->executeQuery());
+    ASSERT(rs->next());
+    ASSERT_EQUALS(i, rs->getInt(1));
+  }
+  ASSERT_EQUALS(before, prepares());
+
+  // The third execution prepares the statement, and next ones only execute it
+  for (int32_t i= 7; i < 10; ++i) {
+    ps->setInt(1, i);
+    ResultSet rs(ps->executeQuery());
+    ASSERT(rs->next());
+    ASSERT_EQUALS(i, rs->getInt(1));
+    ASSERT(!rs->next());
+  }
+  ASSERT_EQUALS(before + 1, prepares());
+  ps->close();
+
+  // With 0 the statement is never prepared
+  sql::Properties p0{{"user", user}, {"password", passwd}};
+  Connection c0(driver->connect(url, p0));
+  Statement st0(c0->createStatement());
+  ResultSet rs0(st0->executeQuery("SHOW SESSION STATUS LIKE 'Com_stmt_prepare'"));
+  ASSERT(rs0->next());
+  int64_t before0= rs0->getInt64(2);
+  PreparedStatement ps0(c0->prepareStatement(query));
+  for (int32_t i= 0; i < 5; ++i) {
+    ps0->setInt(1, i);
+    ResultSet rs(ps0->executeQuery());
+    ASSERT(rs->next());
+  }
+  rs0.reset(st0->executeQuery("SHOW SESSION STATUS LIKE 'Com_stmt_prepare'"));
+  ASSERT(rs0->next());
+  ASSERT_EQUALS(before0, rs0->getInt64(2));
+  c0->close();
+  c->close();
+}
+
+
+void preparedstatement::executeWith()
+{
+  stmt->executeUpdate("DROP TABLE IF EXISTS test_execute_with");
+  stmt->executeUpdate("CREATE TABLE test_execute_with(id BIGINT, name VARCHAR(32), score DOUBLE, flag TINYINT UNSIGNED)");
+
+  for (const char* serverPrepare : {"true", "false"}) {
+    sql::Properties p{{"user", user}, {"password", passwd}, {"useServerPrepStmts", serverPrepare}};
+    Connection c(driver->connect(url, p));
+    Statement st(c->createStatement());
+    st->executeUpdate("DELETE FROM test_execute_with");
+
+    PreparedStatement ins(c->prepareStatement("INSERT INTO test_execute_with VALUES(?, ?, ?, ?)"));
+    const int64_t id= 1;
+    const std::string name("it's");
+    const uint8_t flag= 200;
+    ASSERT(!ins->executeWith(id, name, 2.5, flag));
+    ASSERT_EQUALS(1, ins->getUpdateCount());
+    ASSERT(!ins->executeWith(2, "second", 0.125f, nullptr));
+
+    try {
+      ins->executeWith(3, "too few");
+      FAIL("Wrong number of values has been accepted");
+    }
+    catch (sql::SQLException& e) {
+      ASSERT_EQUALS("07001", e.getSQLState());
+    }
+
+    PreparedStatement sel(c->prepareStatement("SELECT name, score, flag FROM test_execute_with WHERE id=? OR name=? ORDER BY id"));
+    ResultSet rs(sel->executeQueryWith(1, sql::SQLString("second")));
+    ASSERT(rs->next());
+    ASSERT_EQUALS("it's", rs->getString(1));
+    ASSERT_EQUALS(2.5, rs->getDouble(2));
+    ASSERT_EQUALS(200, rs->getInt(3));
+    ASSERT(rs->next());
+    ASSERT_EQUALS(0.125, rs->getDouble(2));
+    rs->getInt(3);
+    ASSERT(rs->wasNull());
+    ASSERT(!rs->next());
+
+    // Values set with setters are not affected
+    sel->setInt(1, 2);
+    sel->setString(2, "");
+    rs.reset(sel->executeQuery());
+    ASSERT(rs->next());
+    ASSERT_EQUALS("second", rs->getString(1));
+    ASSERT(!rs->next());
+    c->close();
+  }
+  stmt->executeUpdate("DROP TABLE IF EXISTS test_execute_with");
+}
+
+
+void preparedstatement::listParameters()
+{
+  const int64_t ids[]{1, 3, 5, 7, 9};
+  const sql::SQLString names[]{"three", "nine"};
+
+  stmt.reset(sspsCon->createStatement());
+  createSchemaObject("TABLE", "listParameters", "(id BIGINT NOT NULL PRIMARY KEY, name VARCHAR(31))");
+  stmt->executeUpdate("INSERT INTO listParameters VALUES(1,'one'),(3,'three'),(5,'five'),(7,'seven'),(9,'nine'),(11,'eleven')");
+
+  pstmt.reset(sspsCon->prepareStatement("SELECT id FROM listParameters WHERE id IN (?) AND id < ? ORDER BY id"));
+  pstmt->setInt(2, 100);
+  for (std::size_t count= 1; count <= 5; ++count) {
+    pstmt->setList(1, ids, count);
+    res.reset(pstmt->executeQuery());
+    // Padding repeats the last value, and does not add rows
+    for (std::size_t i= 0; i < count; ++i) {
+      ASSERT(res->next());
+      ASSERT_EQUALS(ids[i], res->getInt64(1));
+    }
+    ASSERT(!res->next());
+  }
+  // The list is replaced with the regular value
+  pstmt->setInt(1, 11);
+  res.reset(pstmt->executeQuery());
+  ASSERT(res->next());
+  ASSERT_EQUALS(11, res->getInt(1));
+  ASSERT(!res->next());
+
+  pstmt.reset(sspsCon->prepareStatement("SELECT id FROM listParameters WHERE name IN (?) ORDER BY id"));
+  pstmt->setList(1, names, 2);
+  res.reset(pstmt->executeQuery());
+  ASSERT(res->next());
+  ASSERT_EQUALS(3, res->getInt(1));
+  ASSERT(res->next());
+  ASSERT_EQUALS(9, res->getInt(1));
+  ASSERT(!res->next());
+
+  try {
+    pstmt->setList(1, names, 0);
+    FAIL("Empty list has been accepted");
+  }
+  catch (sql::SQLException& e) {
+    ASSERT_EQUALS("HY090", e.getSQLState());
+  }
+  try {
+    pstmt->addBatch();
+    FAIL("List parameter has been added to the batch");
+  }
+  catch (sql::SQLException&) {
+  }
+}
+
+
+void preparedstatement::rewriteUpsert()
+{
+  sql::ConnectOptionsMap connection_properties{{"userName", user}, {"password", passwd}, {"useTls", useTls ? "true" : "false"},
+    {"rewriteBatchedStatements", "true"}};
+  con.reset(driver->connect(url, connection_properties));
+  con->setSchema(db);
+  stmt.reset(con->createStatement());
+  createSchemaObject("TABLE", "rewriteUpsert", "(id INT NOT NULL PRIMARY KEY, val INT NOT NULL)");
+
+  const sql::SQLString upsertQuery[]{"INSERT INTO rewriteUpsert VALUES(?,?) ON DUPLICATE KEY UPDATE val=VALUES(val)",
+                                     "REPLACE INTO rewriteUpsert VALUES(?,?)",
+                                     "INSERT IGNORE INTO rewriteUpsert VALUES(?,?)"};
+  // Counts of the rows, when all rows are new, and when all rows exist
+  const int32_t insertedCount[]{1, 1, 1}, existingCount[]{2, 2, 0};
+
+  for (std::size_t i= 0; i < sizeof(upsertQuery)/sizeof(upsertQuery[0]); ++i) {
+    stmt->executeUpdate("DELETE FROM rewriteUpsert");
+    pstmt.reset(con->prepareStatement(upsertQuery[i]));
+
+    for (int32_t pass= 0; pass < 2; ++pass) {
+      for (int32_t id= 1; id <= 3; ++id) {
+        pstmt->setInt(1, id);
+        pstmt->setInt(2, id*10 + pass + 1);
+        pstmt->addBatch();
+      }
+      const sql::Ints& batchRes= pstmt->executeBatch();
+      ASSERT_EQUALS(3ULL, static_cast<uint64_t>(batchRes.size()));
+      for (auto count : batchRes) {
+        ASSERT_EQUALS(pass == 0 ? insertedCount[i] : existingCount[i], count);
+      }
+    }
+    // The mix of new and existing rows cannot be told apart
+    pstmt->setInt(1, 3);
+    pstmt->setInt(2, 33);
+    pstmt->addBatch();
+    pstmt->setInt(1, 4);
+    pstmt->setInt(2, 43);
+    pstmt->addBatch();
+    const sql::Longs& batchLRes= pstmt->executeLargeBatch();
+    ASSERT_EQUALS(2ULL, static_cast<uint64_t>(batchLRes.size()));
+    // E.g. 3 for 2 rows of the upsert is neither 2*1, nor 2*2
+    ASSERT_EQUALS(static_cast<int64_t>(sql::Statement::SUCCESS_NO_INFO), batchLRes[0]);
+    ASSERT_EQUALS(static_cast<int64_t>(sql::Statement::SUCCESS_NO_INFO), batchLRes[1]);
+  }
+}
+
+void preparedstatement::encodeBatchAtAdd()
+{
+  sql::ConnectOptionsMap connection_properties{{"userName", user}, {"password", passwd}, {"useTls", useTls ? "true" : "false"},
+    {"rewriteBatchedStatements", "true"}, {"encodeBatchAtAdd", "true"}};
+  con.reset(driver->connect(url, connection_properties));
+  con->setSchema(db);
+  stmt.reset(con->createStatement());
+  createSchemaObject("TABLE", "encodeBatchAtAdd", "(id INT NOT NULL PRIMARY KEY, val VARCHAR(31))");
+
+  pstmt.reset(con->prepareStatement("INSERT INTO encodeBatchAtAdd VALUES(?,?)"));
+  // Values are encoded right away - changing them after addBatch does not change the row
+  for (int32_t id= 1; id <= 1000; ++id) {
+    pstmt->setInt(1, id);
+    if (id % 10 == 0) {
+      pstmt->setNull(2, sql::Types::VARCHAR);
+    }
+    else {
+      pstmt->setString(2, "x'\\\"" + std::to_string(id));
+    }
+    pstmt->addBatch();
+  }
+  pstmt->setInt(1, 2000);
+  const sql::Ints& batchRes= pstmt->executeBatch();
+  ASSERT_EQUALS(1000ULL, static_cast<uint64_t>(batchRes.size()));
+  ASSERT_EQUALS(1, batchRes[999]);
+
+  res.reset(stmt->executeQuery("SELECT COUNT(*), SUM(id), COUNT(val), MAX(id) FROM encodeBatchAtAdd"));
+  ASSERT(res->next());
+  ASSERT_EQUALS(1000, res->getInt(1));
+  ASSERT_EQUALS(500500, res->getInt(2));
+  ASSERT_EQUALS(900, res->getInt(3));
+  ASSERT_EQUALS(1000, res->getInt(4));
+  res.reset(stmt->executeQuery("SELECT val FROM encodeBatchAtAdd WHERE id=7"));
+  ASSERT(res->next());
+  ASSERT_EQUALS("x'\\\"7", res->getString(1));
+
+  pstmt->clearBatch();
+  pstmt->setInt(1, 1001);
+  pstmt->setString(2, "y");
+  pstmt->addBatch();
+  pstmt->setInt(1, 1);
+  pstmt->addBatch();
+  try {
+    pstmt->executeBatch();
+    FAIL("Batch with duplicate key has to fail");
+  }
+  catch (sql::SQLException& e) {
+    ASSERT_EQUALS(1062, e.getErrorCode());
+  }
+  res.reset(stmt->executeQuery("SELECT 1"));
+  ASSERT(res->next());
+}
+
+void preparedstatement::directWrite()
+{
+  sql::ConnectOptionsMap connection_properties{{"userName", user}, {"password", passwd}, {"useTls", useTls ? "true" : "false"},
+    {"useServerPrepStmts", "true"}, {"directWriteThreshold", "1024"}, {"longDataChunkSize", "65536"}};
+  con.reset(driver->connect(url, connection_properties));
+  con->setSchema(db);
+  stmt.reset(con->createStatement());
+  res.reset(stmt->executeQuery("SELECT @@max_allowed_packet"));
+  ASSERT(res->next());
+  if (res->getUInt64(1) < 8*1024*1024) {
+    SKIP("max_allowed_packet is too small for the test");
+  }
+  createSchemaObject("TABLE", "directWrite", "(id INT NOT NULL PRIMARY KEY, txt LONGTEXT, bin LONGBLOB, small VARCHAR(31))");
+
+  std::string text(2*1024*1024 + 7, 'a'), binary(1024*1024 + 3, '\0');
+  for (std::size_t i= 0; i < binary.length(); ++i) {
+    binary[i]= static_cast<char>(i % 251);
+    text[i]= static_cast<char>('a' + i % 26);
+  }
+  pstmt.reset(con->prepareStatement("INSERT INTO directWrite VALUES(?,?,?,?)"));
+  for (int32_t id= 1; id <= 2; ++id) {
+    std::istringstream stream(binary);
+    pstmt->setInt(1, id);
+    pstmt->setString(2, text);
+    if (id == 1) {
+      pstmt->setBytes(3, binary.c_str(), binary.length());
+    }
+    else {
+      pstmt->setBlob(3, &stream);
+    }
+    pstmt->setString(4, "below threshold");
+    ASSERT_EQUALS(1, pstmt->executeUpdate());
+  }
+
+  res.reset(stmt->executeQuery("SELECT txt, bin, small FROM directWrite ORDER BY id"));
+  for (int32_t id= 1; id <= 2; ++id) {
+    ASSERT(res->next());
+    ASSERT(res->getString(1) == text);
+    ASSERT(res->getString(2) == binary);
+    ASSERT_EQUALS("below threshold", res->getString(3));
+  }
+  ASSERT(!res->next());
+}
+
+void preparedstatement::directWriteBatch()
+{
+  stmt.reset(sspsCon->createStatement());
+  res.reset(stmt->executeQuery("SELECT @@max_allowed_packet"));
+  ASSERT(res->next());
+  if (res->getUInt64(1) < 40*1024*1024) {
+    SKIP("max_allowed_packet is too small for the test");
+  }
+  createSchemaObject("TABLE", "directWriteBatch", "(id INT NOT NULL PRIMARY KEY, val MEDIUMTEXT)");
+
+  const sql::SQLString value(std::string(512*1024, 'v'));
+  const char* encode[]{"false", "true"};
+
+  for (auto encodeBatch : encode) {
+    sql::ConnectOptionsMap connection_properties{{"userName", user}, {"password", passwd}, {"useTls", useTls ? "true" : "false"},
+      {"rewriteBatchedStatements", "true"}, {"directWriteThreshold", "1024"}, {"encodeBatchAtAdd", encodeBatch}};
+    con.reset(driver->connect(url, connection_properties));
+    con->setSchema(db);
+    stmt->executeUpdate("DELETE FROM directWriteBatch");
+
+    // About 20M of the query, that is sent in 2 packets
+    pstmt.reset(con->prepareStatement("INSERT INTO directWriteBatch VALUES(?,?)"));
+    for (int32_t id= 1; id <= 40; ++id) {
+      pstmt->setInt(1, id);
+      pstmt->setString(2, value);
+      pstmt->addBatch();
+    }
+    ASSERT_EQUALS(40ULL, static_cast<uint64_t>(pstmt->executeBatch().size()));
+
+    res.reset(stmt->executeQuery("SELECT COUNT(*), SUM(LENGTH(val)) FROM directWriteBatch"));
+    ASSERT(res->next());
+    ASSERT_EQUALS(40, res->getInt(1));
+    ASSERT_EQUALS(static_cast<uint64_t>(value.length()*40), res->getUInt64(2));
+    // The connection is in sync with the server after the batch
+    Statement st2(con->createStatement());
+    res.reset(st2->executeQuery("SELECT 1"));
+    ASSERT(res->next());
+  }
+}
+
+
+void preparedstatement::cloneStatement()
+{
+  const char* serverPrepare[]= {"false", "true"};
+
+  for (auto useServerPrepStmts : serverPrepare) {
+    sql::ConnectOptionsMap connection_properties{{"userName", user}, {"password", passwd}, {"useTls", useTls ? "true" : "false"},
+      {"useServerPrepStmts", useServerPrepStmts}, {"cachePrepStmts", "true"}};
+    con.reset(driver->connect(url, connection_properties));
+    pstmt.reset(con->prepareStatement("SELECT ? + 1"));
+    pstmt->setInt(1, 1);
+
+    // Parameter values are not cloned
+    PreparedStatement sameConnection(pstmt->clone());
+    ASSERT_EQUALS(1U, sameConnection->getParameterMetaData()->getParameterCount());
+    sameConnection->setInt(1, 10);
+    res.reset(sameConnection->executeQuery());
+    ASSERT(res->next());
+    ASSERT_EQUALS(11, res->getInt(1));
+    res.reset(pstmt->executeQuery());
+    ASSERT(res->next());
+    ASSERT_EQUALS(2, res->getInt(1));
+
+    const int32_t threadCount= 4;
+    std::vector<std::unique_ptr<sql::Connection>> connections;
+    std::vector<std::unique_ptr<sql::PreparedStatement>> clones;
+    std::vector<int32_t> sums(threadCount, 0);
+    std::vector<std::thread> threads;
+
+    for (int32_t i= 0; i < threadCount; ++i) {
+      connections.emplace_back(driver->connect(url, connection_properties));
+      clones.emplace_back(pstmt->clone(connections.back().get()));
+    }
+    for (int32_t i= 0; i < threadCount; ++i) {
+      threads.emplace_back([&clones, &sums, i]() {
+        for (int32_t j= 0; j < 100; ++j) {
+          clones[i]->setInt(1, j);
+          std::unique_ptr<sql::ResultSet> rs(clones[i]->executeQuery());
+          if (rs->next()) {
+            sums[i]+= rs->getInt(1);
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    for (int32_t i= 0; i < threadCount; ++i) {
+      ASSERT_EQUALS(5050, sums[i]);
+      ASSERT(clones[i]->getConnection() == connections[i].get());
+    }
+    clones.clear();
+
+    if (std::string(useServerPrepStmts) == "true") {
+      // The clone takes the prepare, that the deleted statement has left in the connection's cache. The prepare used
+      // by the statement is not taken by its clone
+      Connection other(driver->connect(url, connection_properties));
+      delete other->prepareStatement("SELECT ? + 1");
+      uint64_t prepares= other->getMetrics().prepares;
+      PreparedStatement cached(pstmt->clone(other.get()));
+      ASSERT_EQUALS(prepares, other->getMetrics().prepares);
+      PreparedStatement own(cached->clone());
+      ASSERT_EQUALS(prepares + 1, other->getMetrics().prepares);
+      own->setInt(1, 2);
+      res.reset(own->executeQuery());
+      ASSERT(res->next());
+      ASSERT_EQUALS(3, res->getInt(1));
+      res.reset();
+    }
+
+    pstmt->close();
+    try {
+      sameConnection.reset(pstmt->clone());
+      FAIL("Closed statement has been cloned");
+    }
+    catch (sql::SQLException&) {
+    }
+  }
+}
+
+
+void preparedstatement::executeDirectLongQuery()
+{
+  sql::Properties p{{"useServerPrepStmts", "true"}, {"cachePrepStmts", "true"}};
+  Connection con2(getConnection(&p));
+  const sql::SQLString longQuery("SELECT ? + 1 /*" + std::string(2100, 'x') + "*/");
+
+  uint64_t prepares= con2->getMetrics().prepares;
+  PreparedStatement pstmt1(con2->prepareStatement(longQuery));
+  ASSERT_EQUALS(prepares, con2->getMetrics().prepares);
+
+  uint64_t roundTrips= con2->getMetrics().roundTrips;
+  pstmt1->setInt(1, 1);
+  res.reset(pstmt1->executeQuery());
+  ASSERT_EQUALS(roundTrips + 1, con2->getMetrics().roundTrips);
+  ASSERT_EQUALS(prepares + 1, con2->getMetrics().prepares);
+  ASSERT(res->next());
+  ASSERT_EQUALS(2, res->getInt(1));
+
+  // Re-execution uses the statement prepared with the first one
+  pstmt1->setInt(1, 41);
+  res.reset(pstmt1->executeQuery());
+  ASSERT_EQUALS(prepares + 1, con2->getMetrics().prepares);
+  ASSERT(res->next());
+  ASSERT_EQUALS(42, res->getInt(1));
+
+  // Short query goes to the cache, and is prepared right away
+  pstmt1.reset(con2->prepareStatement("SELECT ? + 1"));
+  ASSERT_EQUALS(prepares + 2, con2->getMetrics().prepares);
+
+  // Without the cache no query is cached, and the short one is prepared with its first execution as well
+  p["cachePrepStmts"]= "false";
+  Connection con3(getConnection(&p));
+  prepares= con3->getMetrics().prepares;
+  pstmt1.reset(con3->prepareStatement("SELECT ? + 1"));
+  ASSERT_EQUALS(prepares, con3->getMetrics().prepares);
+  pstmt1->setInt(1, 1);
+  res.reset(pstmt1->executeQuery());
+  ASSERT_EQUALS(prepares + 1, con3->getMetrics().prepares);
+  ASSERT(res->next());
+  ASSERT_EQUALS(2, res->getInt(1));
+
+  p["executeDirectLongQueries"]= "false";
+  Connection con4(getConnection(&p));
+  prepares= con4->getMetrics().prepares;
+  pstmt1.reset(con4->prepareStatement("SELECT ? + 1"));
+  ASSERT_EQUALS(prepares + 1, con4->getMetrics().prepares);
+  pstmt1.reset(con4->prepareStatement(longQuery));
+  ASSERT_EQUALS(prepares + 2, con4->getMetrics().prepares);
+}
+
+
+void preparedstatement::executeAsync()
+{
+  pstmt.reset(con->prepareStatement("SELECT SLEEP(0.2), ?"));
+  pstmt->setInt(1, 7);
+
+  std::unique_ptr<sql::AsyncExecution> execution(pstmt->executeAsync());
+  // Not really waiting for events here - resume() returns the same status, if they have not occurred yet
+  while (!execution->isDone()) {
+    execution->resume(execution->getWaitStatus());
+  }
+  ASSERT(execution->getResult());
+  res.reset(pstmt->getResultSet());
+  ASSERT(res->next());
+  ASSERT_EQUALS(7, res->getInt(2));
+
+  pstmt->setInt(1, 8);
+  execution.reset(pstmt->executeAsync());
+  while (!execution->isDone()) {
+    execution->resume(execution->getWaitStatus());
+  }
+  res.reset(pstmt->getResultSet());
+  ASSERT(res->next());
+  ASSERT_EQUALS(8, res->getInt(2));
+
+  pstmt.reset(sspsCon->prepareStatement("SELECT ?"));
+  pstmt->setInt(1, 1);
+  try {
+    execution.reset(pstmt->executeAsync());
+    FAIL("Server side prepared statement has executed asynchronously");
+  }
+  catch (sql::SQLFeatureNotSupportedException&) {
+  }
+}
+
 } /* namespace preparedstatement */
 } /* namespace testsuite */
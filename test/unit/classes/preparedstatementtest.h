@@ -79,6 +79,31 @@ public:
     TEST_CASE(concpp106_batchBulk);
     TEST_CASE(concpp116_getByte);
     TEST_CASE(multirs_caching);
+    TEST_CASE(serverCursorFetch);
+    TEST_CASE(prepareCache);
+    TEST_CASE(sharedParsedQuery);
+    TEST_CASE(pipelinePrepare);
+    TEST_CASE(bulkGeneratedKeys);
+    TEST_CASE(parameterArrays);
+    TEST_CASE(batchChunksInFlight);
+    TEST_CASE(rebindParameters);
+    TEST_CASE(reuseColumnMetadata);
+    TEST_CASE(tryExecute);
+    TEST_CASE(longDataChunks);
+    TEST_CASE(blobFromFile);
+    TEST_CASE(callOutParameters);
+    TEST_CASE(arrowBatch);
+    TEST_CASE(sharedParameterMetaData);
+    TEST_CASE(serverPrepareThreshold);
+    TEST_CASE(executeWith);
+    TEST_CASE(listParameters);
+    TEST_CASE(rewriteUpsert);
+    TEST_CASE(encodeBatchAtAdd);
+    TEST_CASE(directWrite);
+    TEST_CASE(directWriteBatch);
+    TEST_CASE(cloneStatement);
+    TEST_CASE(executeDirectLongQuery);
+    TEST_CASE(executeAsync);
   }
 
   /**
@@ -170,6 +195,125 @@ public:
   void concpp116_getByte();
 
   void multirs_caching();
+  /**
+   * Reading result of server side prepared statement with fetch size through the server cursor, while executing
+   * other statements on the connection
+   */
+  void serverCursorFetch();
+
+  /**
+   * With cachePrepStmts the statement of the closed PreparedStatement is taken by the next one with the same query
+   */
+  void prepareCache();
+  /**
+   * Client side prepared statements with the same query on different connections, with and without
+   * NO_BACKSLASH_ESCAPES and parsed query cache
+   */
+  void sharedParsedQuery();
+  /**
+   * Server side prepared statements with pipelinePrepare - prepare sent with the first execution
+   */
+  void pipelinePrepare();
+  /**
+   * Generated keys of the batch executed with bulk command
+   */
+  void bulkGeneratedKeys();
+  /**
+   * Batch of parameters bound column-wise to the application arrays
+   */
+  void parameterArrays();
+  /**
+   * Rewritten batch bigger than max_allowed_packet, sent in several chunks without waiting for results
+   */
+  void batchChunksInFlight();
+  /**
+   * Statement executed in the loop with new values, and added to the batch - values are reused, but batch is intact
+   */
+  void rebindParameters();
+  /**
+   * Query executed repeatedly, with the table altered between executions, result set has to follow the change
+   */
+  void reuseColumnMetadata();
+  /**
+   * Non-throwing execution - errors of the server are returned with their class, successful execution clears the error
+   */
+  void tryExecute();
+
+  /**
+   * Stream parameters are sent in chunks of longDataChunkSize, the length limits the whole value
+   */
+  void longDataChunks();
+
+  /**
+   * BLOB parameter with the content of the memory mapped file
+   */
+  void blobFromFile();
+
+  /**
+   * OUT parameters of the procedure and the value of the function, read without session variables
+   */
+  void callOutParameters();
+
+  /**
+   * Arrow record batch exported from the result, executed as the batch of parameters
+   */
+  void arrowBatch();
+
+  /**
+   * Client side statements of the same query share the parameters metadata, got from the server once
+   */
+  void sharedParameterMetaData();
+
+  /**
+   * Client side statement executed more than serverPrepareThreshold times is prepared on the server
+   */
+  void serverPrepareThreshold();
+
+  /**
+   * executeWith and executeQueryWith bind the arguments as parameters, with server and client side prepared statements
+   */
+  void executeWith();
+
+  /**
+   * List parameters in IN(?) - lists of different sizes, padded to the bucket size, return the same rows as literal lists
+   */
+  void listParameters();
+
+  /**
+   * Rewritten batches of INSERT ... ON DUPLICATE KEY UPDATE, REPLACE and INSERT IGNORE report exact counts of rows
+   */
+  void rewriteUpsert();
+
+  /**
+   * Batch encoded at addBatch time - rows keep the values they had at addBatch, and are inserted by rewritten queries
+   */
+  void encodeBatchAtAdd();
+
+  /**
+   * Big string, bytes and stream parameters sent as the long data right from the application memory
+   */
+  void directWrite();
+
+  /**
+   * Rewritten batch query bigger than 16M written in packets as it is built
+   */
+  void directWriteBatch();
+
+  /**
+   * clone() copies the statement for the same or other connection, and clones work in their own threads
+   */
+  void cloneStatement();
+
+  /**
+   * Query, that is not cached - too long for the prepared statements cache, or on the connection without it - is
+   * prepared with its first execution in one roundtrip
+   */
+  void executeDirectLongQuery();
+
+  /**
+   * Non-blocking execution of the client side prepared statement. Server side statements do not support it
+   */
+  void executeAsync();
 
   /* unit_fixture methods overriding */
   void setUp();
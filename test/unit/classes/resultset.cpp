@@ -35,10 +35,12 @@
 
 #include <sstream>
 #include <cstdlib>
+#include <cstdio>
 #include <stdlib.h>
 #include "ResultSet.hpp"
 #include "conncpp/Types.hpp"
 #include "conncpp/Connection.hpp"
+#include "conncpp/ArrowExport.hpp"
 #include "resultsettest.h"
 
 
@@ -1342,5 +1344,1176 @@ void resultset::JSON_support()
 }
 
 
+void resultset::cachedRowData()
+{
+  logMsg("resultset::cachedRowData - MySQL_ResultSet::*");
+
+  try
+  {
+    stmt.reset(con->createStatement());
+    stmt->execute("DROP TABLE IF EXISTS test");
+    stmt->execute("CREATE TABLE test(id INT NOT NULL, val VARCHAR(64000))");
+    stmt->execute("INSERT INTO test(id, val) VALUES(1, NULL),(2, ''),(3, 'abc'),(4, REPEAT('z', 60000)),(5, 'xyz')");
+
+    for (int32_t fetchSize= 0; fetchSize < 3; ++fetchSize) {
+      stmt.reset(con->createStatement(sql::ResultSet::TYPE_SCROLL_INSENSITIVE, sql::ResultSet::CONCUR_READ_ONLY));
+      stmt->setFetchSize(fetchSize);
+      res.reset(stmt->executeQuery("SELECT id, val FROM test ORDER BY id"));
+
+      for (int32_t i= 1; i < 6; ++i) {
+        ASSERT(res->next());
+        ASSERT_EQUALS(i, res->getInt(1));
+      }
+      ASSERT(!res->next());
+
+      ASSERT(res->absolute(1));
+      ASSERT(res->getString(2).empty());
+      ASSERT(res->wasNull());
+      ASSERT(res->absolute(2));
+      ASSERT_EQUALS("", res->getString(2));
+      ASSERT(!res->wasNull());
+      ASSERT(res->absolute(4));
+      ASSERT_EQUALS(60000ULL, static_cast<uint64_t>(res->getString(2).length()));
+      ASSERT(res->absolute(3));
+      ASSERT_EQUALS("abc", res->getString(2));
+      ASSERT(res->last());
+      ASSERT_EQUALS(5, res->getInt(1));
+      ASSERT_EQUALS("xyz", res->getString(2));
+
+      pstmt.reset(con->prepareStatement("SELECT id, val FROM test ORDER BY id"));
+      pstmt->setFetchSize(fetchSize);
+      res.reset(pstmt->executeQuery());
+
+      for (int32_t i= 1; i < 6; ++i) {
+        ASSERT(res->next());
+        ASSERT_EQUALS(i, res->getInt(1));
+        if (i == 1) {
+          ASSERT(res->getString(2).empty());
+          ASSERT(res->wasNull());
+        }
+        else if (i == 3) {
+          ASSERT_EQUALS("abc", res->getString(2));
+        }
+      }
+      ASSERT(!res->next());
+    }
+    res.reset();
+    stmt->execute("DROP TABLE IF EXISTS test");
+  }
+  catch (sql::SQLException &e)
+  {
+    logErr(e.what());
+    logErr("SQLState: " + std::string(e.getSQLState()));
+    fail(e.what(), __FILE__, __LINE__);
+  }
+}
+
+
+void resultset::getBytesInto()
+{
+  logMsg("resultset::getBytesInto - MySQL_ResultSet::getBytesInto");
+
+  try
+  {
+    const char binary[]= {'\0', '\1', '\xff', 'a', '\0', 'b'};
+    std::string big(1000, 'x');
+    sql::bytes buffer;
+
+    stmt.reset(con->createStatement());
+    stmt->execute("DROP TABLE IF EXISTS test");
+    stmt->execute("CREATE TABLE test(id INT NOT NULL, val BLOB)");
+
+    pstmt.reset(con->prepareStatement("INSERT INTO test(id, val) VALUES(?,?)"));
+    pstmt->setInt(1, 1);
+    pstmt->setBytes(2, big.c_str(), big.length());
+    pstmt->executeUpdate();
+    pstmt->setInt(1, 2);
+    pstmt->setBytes(2, binary, sizeof(binary));
+    pstmt->executeUpdate();
+    pstmt->setInt(1, 3);
+    pstmt->setBytes(2, nullptr, 0);
+    pstmt->executeUpdate();
+
+    pstmt.reset(con->prepareStatement("SELECT val, id FROM test ORDER BY id"));
+    for (int32_t i= 0; i < 2; ++i) {
+      if (i == 0) {
+        res.reset(stmt->executeQuery("SELECT val, id FROM test ORDER BY id"));
+      }
+      else {
+        res.reset(pstmt->executeQuery());
+      }
+      ASSERT(res->next());
+      ASSERT_EQUALS(1000ULL, static_cast<uint64_t>(res->getBytesInto(1, buffer)));
+      ASSERT_EQUALS(big, std::string(buffer.arr, 1000));
+      const char* allocated= buffer.arr;
+
+      ASSERT(res->next());
+      ASSERT_EQUALS(static_cast<uint64_t>(sizeof(binary)), static_cast<uint64_t>(res->getBytesInto("val", buffer)));
+      ASSERT_EQUALS(std::string(binary, sizeof(binary)), std::string(buffer.arr, sizeof(binary)));
+      // Smaller value goes to the same memory
+      ASSERT(allocated == buffer.arr);
+      ASSERT_EQUALS(1ULL, static_cast<uint64_t>(res->getBytesInto(2, buffer)));
+      ASSERT_EQUALS('2', buffer.arr[0]);
+
+      ASSERT(res->next());
+      ASSERT_EQUALS(0ULL, static_cast<uint64_t>(res->getBytesInto(1, buffer)));
+      ASSERT(res->wasNull());
+      ASSERT(!res->next());
+    }
+    res.reset();
+    stmt->execute("DROP TABLE IF EXISTS test");
+  }
+  catch (sql::SQLException &e)
+  {
+    logErr(e.what());
+    logErr("SQLState: " + std::string(e.getSQLState()));
+    fail(e.what(), __FILE__, __LINE__);
+  }
+}
+
+
+void resultset::getStringView()
+{
+  logMsg("resultset::getStringView - MySQL_ResultSet::getStringView");
+
+  try
+  {
+    std::size_t length;
+    const char* value;
+
+    stmt.reset(con->createStatement());
+    stmt->execute("DROP TABLE IF EXISTS test");
+    stmt->execute("CREATE TABLE test(id INT NOT NULL, val VARCHAR(32), dt DATE, nul VARCHAR(10))");
+    stmt->execute("INSERT INTO test(id, val, dt, nul) VALUES(7, 'abc', '2023-01-02', NULL),(8, '', '2023-01-03', NULL)");
+
+    pstmt.reset(con->prepareStatement("SELECT id, val, dt, nul FROM test ORDER BY id"));
+
+    for (int32_t i= 0; i < 2; ++i) {
+      if (i == 0) {
+        res.reset(stmt->executeQuery("SELECT id, val, dt, nul FROM test ORDER BY id"));
+      }
+      else {
+        res.reset(pstmt->executeQuery());
+      }
+      ASSERT(res->next());
+
+      value= res->getStringView(2, length);
+      ASSERT(value != nullptr);
+      ASSERT_EQUALS(3ULL, static_cast<uint64_t>(length));
+      ASSERT_EQUALS("abc", std::string(value, length));
+
+      value= res->getStringView(1, length);
+      ASSERT_EQUALS("7", std::string(value, length));
+      ASSERT_EQUALS(res->getString(3), std::string(res->getStringView("dt", length), length));
+      // Converted value has to stay valid while other columns are read
+      value= res->getStringView(3, length);
+      res->getStringView(1, length);
+      ASSERT_EQUALS(res->getString(3), value);
+
+      ASSERT(res->getStringView(4, length) == nullptr);
+      ASSERT_EQUALS(0ULL, static_cast<uint64_t>(length));
+      ASSERT(res->wasNull());
+
+      ASSERT(res->next());
+      value= res->getStringView(2, length);
+      ASSERT(value != nullptr);
+      ASSERT_EQUALS(0ULL, static_cast<uint64_t>(length));
+      ASSERT(!res->wasNull());
+      ASSERT(!res->next());
+    }
+    res.reset();
+    stmt->execute("DROP TABLE IF EXISTS test");
+  }
+  catch (sql::SQLException &e)
+  {
+    logErr(e.what());
+    logErr("SQLState: " + std::string(e.getSQLState()));
+    fail(e.what(), __FILE__, __LINE__);
+  }
+}
+
+
+void resultset::findColumn()
+{
+  logMsg("resultset::findColumn - MySQL_ResultSet::findColumn");
+
+  try
+  {
+    stmt.reset(con->createStatement());
+    stmt->execute("DROP TABLE IF EXISTS test");
+    stmt->execute("CREATE TABLE test(id INT NOT NULL, val VARCHAR(32), other INT)");
+    stmt->execute("INSERT INTO test(id, val, other) VALUES(1, 'abc', 3)");
+
+    res.reset(stmt->executeQuery("SELECT id, val, other AS Id2, val AS other, 5 AS ID FROM test t"));
+    ASSERT(res->next());
+
+    ASSERT_EQUALS(1, res->findColumn("id"));
+    ASSERT_EQUALS(1, res->findColumn("ID"));
+    ASSERT_EQUALS(2, res->findColumn("Val"));
+    ASSERT_EQUALS(3, res->findColumn("id2"));
+    // Alias shadows original name of the 3rd column
+    ASSERT_EQUALS(4, res->findColumn("OTHER"));
+    ASSERT_EQUALS(2, res->findColumn("t.val"));
+    ASSERT_EQUALS(1, res->findColumn("test.id"));
+    ASSERT_EQUALS(3, res->getInt("Id2"));
+    ASSERT_EQUALS("abc", res->getString("other"));
+
+    try {
+      res->findColumn("nosuchcolumn");
+      FAIL("Exception has not been thrown for unknown column");
+    }
+    catch (sql::SQLException& e) {
+      ASSERT_EQUALS("42S22", e.getSQLState());
+    }
+    res.reset();
+    stmt->execute("DROP TABLE IF EXISTS test");
+  }
+  catch (sql::SQLException &e)
+  {
+    logErr(e.what());
+    logErr("SQLState: " + std::string(e.getSQLState()));
+    fail(e.what(), __FILE__, __LINE__);
+  }
+}
+
+
+void resultset::fetchColumns()
+{
+  logMsg("resultset::fetchColumns - MySQL_ResultSet::fetchColumns");
+
+  try
+  {
+    const std::size_t rowsInChunk= 4;
+    int64_t ids[rowsInChunk];
+    double dvals[rowsInChunk];
+    char names[rowsInChunk][4];
+    std::size_t nameLengths[rowsInChunk];
+    bool nameIsNull[rowsInChunk];
+    sql::ColumnBinding bind[]= {
+      {1, sql::ColumnBinding::BIND_INT64, ids, 0, nullptr, nullptr},
+      {2, sql::ColumnBinding::BIND_DOUBLE, dvals, 0, nullptr, nullptr},
+      {3, sql::ColumnBinding::BIND_STRING, names, sizeof(names[0]), nameLengths, nameIsNull}
+    };
+
+    stmt.reset(con->createStatement());
+    stmt->execute("DROP TABLE IF EXISTS test");
+    stmt->execute("CREATE TABLE test(id BIGINT NOT NULL, dval DOUBLE, name VARCHAR(32))");
+    stmt->execute("INSERT INTO test(id, dval, name) VALUES(1, 0.5, 'a'),(2, 1.5, NULL),(3, 2.5, 'abcdef'),(4, 3.5, ''),"
+      "(5, 4.5, 'e'),(6, 5.5, 'f')");
+
+    pstmt.reset(con->prepareStatement("SELECT id, dval, name FROM test ORDER BY id"));
+
+    for (int32_t i= 0; i < 2; ++i) {
+      if (i == 0) {
+        res.reset(stmt->executeQuery("SELECT id, dval, name FROM test ORDER BY id"));
+      }
+      else {
+        res.reset(pstmt->executeQuery());
+      }
+
+      ASSERT_EQUALS(4ULL, static_cast<uint64_t>(res->fetchColumns(rowsInChunk, bind, 3)));
+      for (std::size_t r= 0; r < rowsInChunk; ++r) {
+        ASSERT_EQUALS(static_cast<int64_t>(r + 1), ids[r]);
+        ASSERT_EQUALS(0.5 + r, dvals[r]);
+      }
+      ASSERT(!nameIsNull[0]);
+      ASSERT_EQUALS("a", std::string(names[0], nameLengths[0]));
+      ASSERT(nameIsNull[1]);
+      ASSERT_EQUALS(6ULL, static_cast<uint64_t>(nameLengths[2]));
+      ASSERT_EQUALS("abcd", std::string(names[2], sizeof(names[2])));
+      ASSERT(!nameIsNull[3]);
+      ASSERT_EQUALS(0ULL, static_cast<uint64_t>(nameLengths[3]));
+      // Cursor is on the last fetched row
+      ASSERT_EQUALS(4, res->getInt(1));
+
+      ASSERT_EQUALS(2ULL, static_cast<uint64_t>(res->fetchColumns(rowsInChunk, bind, 3)));
+      ASSERT_EQUALS(static_cast<int64_t>(6), ids[1]);
+      ASSERT_EQUALS(0ULL, static_cast<uint64_t>(res->fetchColumns(rowsInChunk, bind, 3)));
+    }
+
+    bind[0].columnIndex= 4;
+    try {
+      res->fetchColumns(rowsInChunk, bind, 3);
+      FAIL("Exception has not been thrown for invalid column index");
+    }
+    catch (sql::SQLException&) {
+    }
+    res.reset();
+    stmt->execute("DROP TABLE IF EXISTS test");
+  }
+  catch (sql::SQLException &e)
+  {
+    logErr(e.what());
+    logErr("SQLState: " + std::string(e.getSQLState()));
+    fail(e.what(), __FILE__, __LINE__);
+  }
+}
+
+
+void resultset::streamingWindow()
+{
+  logMsg("resultset::streamingWindow - MySQL_ResultSet::next");
+
+  try
+  {
+    std::unique_ptr<sql::Statement> stmt2(con->createStatement());
+    int32_t rowNum= 0;
+    std::ostringstream query("INSERT INTO test(id) VALUES(1)", std::ios_base::ate);
+
+    for (int32_t i= 2; i <= 1000; ++i) {
+      query << ",(" << i << ")";
+    }
+    stmt.reset(con->createStatement());
+    stmt->execute("DROP TABLE IF EXISTS test");
+    stmt->execute("CREATE TABLE test(id INT NOT NULL PRIMARY KEY)");
+    stmt->execute(query.str());
+
+    stmt->setFetchSize(7);
+    res.reset(stmt->executeQuery("SELECT id, REPEAT('x', id % 100) FROM test ORDER BY id"));
+
+    while (res->next()) {
+      ++rowNum;
+      ASSERT_EQUALS(rowNum, res->getInt(1));
+      ASSERT_EQUALS(static_cast<uint64_t>(rowNum % 100), static_cast<uint64_t>(res->getString(2).length()));
+    }
+    ASSERT_EQUALS(1000, rowNum);
+
+    // Connection is free after the last row has been read, while result set is still open
+    std::unique_ptr<sql::ResultSet> res2(stmt2->executeQuery("SELECT 1"));
+    ASSERT(res2->next());
+    ASSERT_EQUALS(1, res2->getInt(1));
+    ASSERT(!res->next());
+
+    // Result set not read till the end
+    res.reset(stmt->executeQuery("SELECT id FROM test ORDER BY id"));
+    ASSERT(res->next());
+    ASSERT_EQUALS(1, res->getInt(1));
+    res.reset();
+    res2.reset(stmt2->executeQuery("SELECT 2"));
+    ASSERT(res2->next());
+    ASSERT_EQUALS(2, res2->getInt(1));
+    res2.reset();
+    stmt2->execute("DROP TABLE IF EXISTS test");
+  }
+  catch (sql::SQLException &e)
+  {
+    logErr(e.what());
+    logErr("SQLState: " + std::string(e.getSQLState()));
+    fail(e.what(), __FILE__, __LINE__);
+  }
+}
+
+
+
+void resultset::streamingReadAhead()
+{
+  logMsg("resultset::streamingReadAhead - next window of rows read in the background thread");
+
+  sql::Properties p{{"user", user}, {"password", passwd}, {"useTls", useTls ? "true" : "false"},
+    {"streamingReadAhead", "true"}};
+  Connection c(driver->connect(url, p));
+  const char* query= "SELECT @n:=@n+1, REPEAT('x', @n % 100) FROM information_schema.columns a, "
+    "information_schema.columns b, (SELECT @n:=0) init LIMIT 1000";
+
+  for (auto serverPrepared : {false, true}) {
+    Statement st(c->createStatement());
+    PreparedStatement ps(c->prepareStatement(query));
+    int32_t rowNum= 0;
+
+    if (serverPrepared) {
+      ps->setFetchSize(7);
+      res.reset(ps->executeQuery());
+    }
+    else {
+      st->setFetchSize(7);
+      res.reset(st->executeQuery(query));
+    }
+    while (rowNum < 500 && res->next()) {
+      ++rowNum;
+      ASSERT_EQUALS(static_cast<uint64_t>(rowNum % 100), static_cast<uint64_t>(res->getString(2).length()));
+    }
+    // Other query gets the connection back from the reader, and the rest of the result is kept
+    Statement st2(c->createStatement());
+    ResultSet res2(st2->executeQuery("SELECT 1"));
+    ASSERT(res2->next());
+    while (res->next()) {
+      ++rowNum;
+      ASSERT_EQUALS(rowNum, res->getInt(1));
+    }
+    ASSERT_EQUALS(1000, rowNum);
+    res.reset();
+  }
+
+  // Result closed in the middle of reading ahead
+  Statement st(c->createStatement());
+  st->setFetchSize(10);
+  res.reset(st->executeQuery(query));
+  ASSERT(res->next());
+  res.reset();
+  res.reset(st->executeQuery("SELECT 2"));
+  ASSERT(res->next());
+  ASSERT_EQUALS(2, res->getInt(1));
+}
+
+
+void resultset::blobChunks()
+{
+  logMsg("resultset::blobChunks - MySQL_ResultSet::getBinaryStream");
+
+  sql::Properties p{{"user", user}, {"password", passwd}, {"useServerPrepStmts", "true"}, {"blobChunkSize", "1000"}};
+  Connection c(driver->connect(url, p));
+  Statement st(c->createStatement());
+  std::string value(100000, 'a');
+
+  for (std::size_t i= 0; i < value.length(); ++i) {
+    value[i]= static_cast<char>('a' + i % 26);
+  }
+  st->execute("DROP TABLE IF EXISTS test_blob_chunks");
+  st->execute("CREATE TABLE test_blob_chunks(id INT NOT NULL PRIMARY KEY, b LONGBLOB, t TEXT)");
+  PreparedStatement ins(c->prepareStatement("INSERT INTO test_blob_chunks VALUES(?, ?, ?)"));
+  ins->setInt(1, 1);
+  ins->setString(2, value);
+  ins->setString(3, "text value");
+  ins->executeUpdate();
+  ins->setInt(1, 2);
+  ins->setNull(2, sql::DataType::LONGVARBINARY);
+  ins->setString(3, "");
+  ins->executeUpdate();
+
+  PreparedStatement sel(c->prepareStatement("SELECT id, b, t FROM test_blob_chunks ORDER BY id"));
+  ResultSet rs(sel->executeQuery());
+
+  ASSERT(rs->next());
+  std::unique_ptr<std::istream> blob(rs->getBinaryStream(2));
+  ASSERT(blob.get() != nullptr);
+  std::string read;
+  char chunk[4096];
+  while (blob->read(chunk, sizeof(chunk)) || blob->gcount() > 0) {
+    read.append(chunk, static_cast<std::size_t>(blob->gcount()));
+  }
+  ASSERT_EQUALS(value.length(), read.length());
+  ASSERT(value == read);
+
+  blob->clear();
+  blob->seekg(99990);
+  ASSERT(!blob->read(chunk, 10).fail());
+  ASSERT_EQUALS(value.substr(99990), std::string(chunk, 10));
+
+  ASSERT_EQUALS("text value", rs->getString(3));
+  ASSERT_EQUALS(value.length(), static_cast<std::size_t>(rs->getString(2).length()));
+
+  ASSERT(rs->next());
+  ASSERT(rs->getBinaryStream(2) == nullptr);
+  ASSERT(rs->wasNull());
+  ASSERT_EQUALS("", rs->getString(3));
+  ASSERT(!rs->wasNull());
+  ASSERT(!rs->next());
+
+  st->execute("DROP TABLE IF EXISTS test_blob_chunks");
+}
+
+
+void resultset::lazyColumnFetch()
+{
+  logMsg("resultset::lazyColumnFetch - variable length values fetched from the row on access");
+
+  sql::Properties p{{"user", user}, {"password", passwd}, {"useServerPrepStmts", "true"}, {"lazyColumnFetch", "true"}};
+  Connection c(driver->connect(url, p));
+  PreparedStatement sel(c->prepareStatement("SELECT ?, REPEAT('x', 70000), CAST(? AS DECIMAL(10,2)), NULL, 'end' "
+    "UNION ALL SELECT 2, '', 0, 'not null', NULL"));
+  sel->setInt(1, 1);
+  sel->setString(2, "12.5");
+  ResultSet rs(sel->executeQuery());
+
+  ASSERT(rs->next());
+  ASSERT_EQUALS(1, rs->getInt(1));
+  ASSERT_EQUALS("end", rs->getString(5));
+  ASSERT_EQUALS(70000U, static_cast<uint32_t>(rs->getString(2).length()));
+  // The same column again, and after the other one has been fetched
+  ASSERT_EQUALS(70000U, static_cast<uint32_t>(rs->getString(2).length()));
+  ASSERT_EQUALS(12.5, rs->getDouble(3));
+  ASSERT_EQUALS("12.50", rs->getString(3));
+  ASSERT(rs->getString(4).empty());
+  ASSERT(rs->wasNull());
+
+  ASSERT(rs->next());
+  ASSERT_EQUALS("", rs->getString(2));
+  ASSERT(!rs->wasNull());
+  ASSERT_EQUALS("not null", rs->getString(4));
+  ASSERT(rs->getString(5).empty());
+  ASSERT(rs->wasNull());
+  ASSERT(!rs->next());
+}
+
+
+void resultset::getDateTime()
+{
+  logMsg("resultset::getDateTime - MySQL_ResultSet::getDateTime");
+
+  for (auto ssps : {"false", "true"}) {
+    sql::Properties p{{"user", user}, {"password", passwd}, {"useServerPrepStmts", ssps}};
+    Connection c(driver->connect(url, p));
+    c->setSchema(db);
+    Statement st(c->createStatement());
+    st->execute("SET SESSION sql_mode=''");
+    st->execute("DROP TABLE IF EXISTS test_get_datetime");
+    st->execute("CREATE TABLE test_get_datetime(id INT NOT NULL PRIMARY KEY, d DATE, dt DATETIME(6), t TIME(3), y YEAR,"
+      "s VARCHAR(32))");
+    st->execute("INSERT INTO test_get_datetime VALUES(1, '2023-01-15', '2023-01-15 12:34:56.123456', '-838:59:58.5', 2023,"
+      "'2023-01-05 01:02:03'), (2, NULL, '0000-00-00 00:00:00', '00:00:00', NULL, '12:30:00')");
+
+    sql::DateTime value;
+    sql::DateTime param{2024, 2, 29, 23, 59, 58, 500000000, false};
+    PreparedStatement ins(c->prepareStatement("INSERT INTO test_get_datetime(id, dt, t) VALUES(3, ?, ?)"));
+    ins->setDateTime(1, param);
+    sql::DateTime timeParam{0, 0, 0, 100, 1, 2, 0, true};
+    ins->setDateTime(2, timeParam);
+    ins->executeUpdate();
+
+    PreparedStatement sel(c->prepareStatement("SELECT d, dt, t, y, s FROM test_get_datetime ORDER BY id"));
+    ResultSet rs(sel->executeQuery());
+
+    ASSERT(rs->next());
+    ASSERT(rs->getDateTime(1, value));
+    ASSERT_EQUALS(2023U, value.year);
+    ASSERT_EQUALS(1U, value.month);
+    ASSERT_EQUALS(15U, value.day);
+    ASSERT_EQUALS(0U, value.hour);
+    ASSERT(rs->getDateTime("dt", value));
+    ASSERT_EQUALS(12U, value.hour);
+    ASSERT_EQUALS(34U, value.minute);
+    ASSERT_EQUALS(56U, value.second);
+    ASSERT_EQUALS(123456000U, value.nanos);
+    ASSERT_EQUALS("2023-01-15 12:34:56.123456", rs->getString(2));
+    ASSERT(rs->getDateTime(3, value));
+    ASSERT(value.negative);
+    ASSERT_EQUALS(838U, value.hour);
+    ASSERT_EQUALS(58U, value.second);
+    ASSERT_EQUALS(500000000U, value.nanos);
+    ASSERT(rs->getDateTime(4, value));
+    ASSERT_EQUALS(2023U, value.year);
+    ASSERT(rs->getDateTime(5, value));
+    ASSERT_EQUALS(5U, value.day);
+    ASSERT_EQUALS(3U, value.second);
+
+    ASSERT(rs->next());
+    ASSERT(!rs->getDateTime(1, value));
+    ASSERT(rs->wasNull());
+    ASSERT(!rs->getDateTime(2, value));
+    ASSERT(rs->wasNull());
+    ASSERT(rs->getDateTime(3, value));
+    ASSERT(!rs->wasNull());
+    ASSERT(rs->getDateTime(5, value));
+    ASSERT_EQUALS(12U, value.hour);
+    ASSERT_EQUALS(30U, value.minute);
+
+    ASSERT(rs->next());
+    ASSERT(rs->getDateTime(2, value));
+    ASSERT_EQUALS(2024U, value.year);
+    ASSERT_EQUALS(29U, value.day);
+    ASSERT_EQUALS(500000000U, value.nanos);
+    ASSERT(rs->getDateTime(3, value));
+    ASSERT(value.negative);
+    ASSERT_EQUALS(100U, value.hour);
+    ASSERT_EQUALS(2U, value.second);
+    ASSERT(!rs->next());
+
+    st->execute("DROP TABLE IF EXISTS test_get_datetime");
+  }
+}
+
+
+void resultset::getDecimal()
+{
+  logMsg("resultset::getDecimal - MySQL_ResultSet::getDecimal");
+
+  for (auto ssps : {"false", "true"}) {
+    sql::Properties p{{"user", user}, {"password", passwd}, {"useServerPrepStmts", ssps}};
+    Connection c(driver->connect(url, p));
+    c->setSchema(db);
+    Statement st(c->createStatement());
+    st->execute("DROP TABLE IF EXISTS test_get_decimal");
+    st->execute("CREATE TABLE test_get_decimal(id INT NOT NULL PRIMARY KEY, d DECIMAL(38,10), u BIGINT UNSIGNED,"
+      "s VARCHAR(32))");
+    st->execute("INSERT INTO test_get_decimal VALUES(1, 1234567890123456789012345678.0123456789, 18446744073709551615,"
+      "'-12.50'), (2, NULL, 0, NULL), (3, -0.0000000001, NULL, '0')");
+
+    sql::Decimal value;
+    PreparedStatement sel(c->prepareStatement("SELECT d, u, s FROM test_get_decimal ORDER BY id"));
+    ResultSet rs(sel->executeQuery());
+
+    ASSERT(rs->next());
+    ASSERT(rs->getDecimal(1, value));
+    ASSERT_EQUALS(10U, value.scale);
+    ASSERT(!value.negative);
+    // 12345678901234567890123456780123456789 == 0x0949B0F6F0023313C449904ECC674515
+    ASSERT_EQUALS(static_cast<uint64_t>(0x0949B0F6F0023313ULL), value.high);
+    ASSERT_EQUALS(static_cast<uint64_t>(0xC449904ECC674515ULL), value.low);
+
+    PreparedStatement ins(c->prepareStatement("INSERT INTO test_get_decimal(id, d) VALUES(4, ?)"));
+    ins->setDecimal(1, value);
+    ins->executeUpdate();
+
+    ASSERT(rs->getDecimal("u", value));
+    ASSERT_EQUALS(0U, value.scale);
+    ASSERT_EQUALS(0ULL, value.high);
+    ASSERT_EQUALS(18446744073709551615ULL, value.low);
+    ASSERT(rs->getDecimal(3, value));
+    ASSERT(value.negative);
+    ASSERT_EQUALS(2U, value.scale);
+    ASSERT_EQUALS(1250ULL, value.low);
+
+    ASSERT(rs->next());
+    ASSERT(!rs->getDecimal(1, value));
+    ASSERT(rs->wasNull());
+    ASSERT(rs->getDecimal(2, value));
+    ASSERT_EQUALS(0ULL, value.low);
+
+    ASSERT(rs->next());
+    ASSERT(rs->getDecimal(1, value));
+    ASSERT(value.negative);
+    ASSERT_EQUALS(10U, value.scale);
+    ASSERT_EQUALS(1ULL, value.low);
+    ASSERT(!rs->getDecimal(2, value));
+    ASSERT(rs->getDecimal(3, value));
+    ASSERT(!value.negative);
+    ASSERT_EQUALS(0ULL, value.low);
+    ASSERT(!rs->next());
+
+    rs.reset(st->executeQuery("SELECT d FROM test_get_decimal WHERE id=4"));
+    ASSERT(rs->next());
+    ASSERT_EQUALS("1234567890123456789012345678.0123456789", rs->getString(1));
+
+    st->execute("DROP TABLE IF EXISTS test_get_decimal");
+  }
+}
+
+
+void resultset::clientCharacterEncoding()
+{
+  logMsg("resultset::clientCharacterEncoding - MySQL_ResultSet::getString");
+
+  const sql::SQLString value("caf\xC3\xA9 \xE2\x82\xAC" "5");
+  for (auto ssps : {"false", "true"}) {
+    sql::Properties p{{"user", user}, {"password", passwd}, {"useServerPrepStmts", ssps},
+      {"useCharacterEncoding", "latin1"}, {"clientCharacterEncoding", "utf8mb4"}};
+    Connection c(driver->connect(url, p));
+    c->setSchema(db);
+    Statement st(c->createStatement());
+    st->execute("DROP TABLE IF EXISTS test_client_encoding");
+    st->execute("CREATE TABLE test_client_encoding(id INT NOT NULL PRIMARY KEY, s VARCHAR(32)) CHARACTER SET utf8mb4");
+
+    PreparedStatement ins(c->prepareStatement("INSERT INTO test_client_encoding VALUES(?, ?)"));
+    ins->setInt(1, 1);
+    ins->setString(2, value);
+    ins->executeUpdate();
+    try {
+      // Not in latin1
+      ins->setString(2, "\xE4\xB8\xAD");
+      FAIL("Character, that latin1 does not have, has been accepted");
+    }
+    catch (sql::SQLException& e) {
+      ASSERT_EQUALS("22018", e.getSQLState());
+    }
+
+    PreparedStatement sel(c->prepareStatement("SELECT s, HEX(CONVERT(s USING utf8mb4)) FROM test_client_encoding"));
+    ResultSet rs(sel->executeQuery());
+    ASSERT(rs->next());
+    ASSERT_EQUALS(value, rs->getString(1));
+    // The server has stored what application has passed
+    ASSERT_EQUALS("436166C3A920E282AC35", rs->getString(2));
+    std::size_t length;
+    const char* view= rs->getStringView(1, length);
+    ASSERT_EQUALS(value, sql::SQLString(view, length));
+    ASSERT(!rs->next());
+
+    st->execute("DROP TABLE IF EXISTS test_client_encoding");
+  }
+}
+
+
+void resultset::scrollSpill()
+{
+  logMsg("resultset::scrollSpill - MySQL_ResultSet::absolute");
+
+  sql::Properties p{{"user", user}, {"password", passwd}, {"scrollSpillThreshold", "1"}};
+  Connection c(driver->connect(url, p));
+  Statement st(c->createStatement(sql::ResultSet::TYPE_SCROLL_INSENSITIVE, sql::ResultSet::CONCUR_READ_ONLY));
+  // About 4M of rows, most of them go to the spill file
+  const int32_t rowCount= 20000;
+
+  st->setFetchSize(100);
+  ResultSet rs(st->executeQuery("SELECT @n:=@n+1 AS n, REPEAT('x', 200) FROM information_schema.columns a,"
+    "information_schema.columns b, (SELECT @n:=0) init LIMIT " + std::to_string(rowCount)));
+  ASSERT(rs->absolute(rowCount));
+  ASSERT_EQUALS(rowCount, rs->getInt(1));
+  for (int32_t i : {1, 7777, rowCount/2, rowCount - 1}) {
+    ASSERT(rs->absolute(i));
+    ASSERT_EQUALS(i, rs->getInt(1));
+    ASSERT_EQUALS(200U, static_cast<uint32_t>(rs->getString(2).length()));
+  }
+  ASSERT(!rs->absolute(rowCount + 1));
+}
+
+
+void resultset::materializeColumns()
+{
+  logMsg("resultset::materializeColumns - MySQL_ResultSet::materializeColumns");
+
+  // Several tasks of decoding
+  const int32_t rowCount= 50000;
+  std::vector<int64_t> ids(rowCount);
+  std::vector<char> names(rowCount*8);
+  std::vector<std::size_t> nameLengths(rowCount);
+  sql::ColumnBinding bind[]= {
+    {1, sql::ColumnBinding::BIND_INT64, ids.data(), 0, nullptr, nullptr},
+    {2, sql::ColumnBinding::BIND_STRING, names.data(), 8, nameLengths.data(), nullptr}
+  };
+  const sql::SQLString query("SELECT @n:=@n+1 AS n, CONCAT('n', @n) FROM information_schema.columns a,"
+    "information_schema.columns b, (SELECT @n:=0) init LIMIT " + std::to_string(rowCount));
+
+  stmt.reset(con->createStatement());
+  pstmt.reset(con->prepareStatement(query));
+  for (int32_t i= 0; i < 2; ++i) {
+    res.reset(i == 0 ? stmt->executeQuery(query) : pstmt->executeQuery());
+    ASSERT(res->next());
+
+    ASSERT_EQUALS(static_cast<std::size_t>(rowCount), res->materializeColumns(bind, 2));
+    for (int32_t r= 0; r < rowCount; r+= 997) {
+      ASSERT_EQUALS(static_cast<int64_t>(r + 1), ids[r]);
+      ASSERT_EQUALS("n" + std::to_string(r + 1), std::string(&names[r*8], nameLengths[r]));
+    }
+    // The cursor is where it was
+    ASSERT_EQUALS(1, res->getInt(1));
+    ASSERT(res->next());
+    ASSERT_EQUALS(2, res->getInt(1));
+  }
+
+  stmt->setFetchSize(10);
+  res.reset(stmt->executeQuery("SELECT 1"));
+  try {
+    res->materializeColumns(bind, 1);
+    FAIL("Forward-only streaming result has been materialized");
+  }
+  catch (sql::SQLException&) {
+  }
+}
+
+
+void resultset::resultSpill()
+{
+  logMsg("resultset::resultSpill - MySQL_ResultSet::next");
+
+  const int32_t rowCount= 20000;
+  for (auto ssps : {"false", "true"}) {
+    sql::Properties p{{"user", user}, {"password", passwd}, {"useServerPrepStmts", ssps}, {"resultSpillThreshold", "1"}};
+    Connection c(driver->connect(url, p));
+    PreparedStatement ps(c->prepareStatement("SELECT @n:=@n+1 AS n, REPEAT('x', 200) FROM information_schema.columns a,"
+      "information_schema.columns b, (SELECT @n:=0) init LIMIT " + std::to_string(rowCount)));
+    ResultSet rs(ps->executeQuery());
+    // The result is read completely, and the connection can be used
+    Statement st(c->createStatement());
+    ResultSet rs2(st->executeQuery("SELECT 1"));
+    ASSERT(rs2->next());
+
+    for (int32_t i= 1; i <= rowCount; ++i) {
+      ASSERT(rs->next());
+      ASSERT_EQUALS(i, rs->getInt(1));
+    }
+    ASSERT_EQUALS(200U, static_cast<uint32_t>(rs->getString(2).length()));
+    ASSERT(!rs->next());
+  }
+}
+
+
+void resultset::arrowExport()
+{
+  logMsg("resultset::arrowExport - sql::exportArrowBatch");
+
+  ArrowSchema schema;
+  ArrowArray array;
+
+  stmt.reset(con->createStatement());
+  res.reset(stmt->executeQuery("SELECT 1 AS id, 'one' AS name, CAST('1970-01-02' AS DATE) AS d UNION ALL "
+    "SELECT 2, NULL, NULL UNION ALL SELECT 3, 'three', CAST('1969-12-31' AS DATE)"));
+
+  ASSERT_EQUALS(static_cast<std::size_t>(2), sql::exportArrowBatch(res.get(), 2, &schema, &array));
+  ASSERT_EQUALS(std::string("+s"), std::string(schema.format));
+  ASSERT_EQUALS(static_cast<int64_t>(3), schema.n_children);
+  ASSERT_EQUALS(std::string("l"), std::string(schema.children[0]->format));
+  ASSERT_EQUALS(std::string("name"), std::string(schema.children[1]->name));
+  ASSERT_EQUALS(std::string("tdD"), std::string(schema.children[2]->format));
+  ASSERT_EQUALS(static_cast<int64_t>(2), array.length);
+
+  const int64_t* ids= static_cast<const int64_t*>(array.children[0]->buffers[1]);
+  ASSERT_EQUALS(static_cast<int64_t>(2), ids[1]);
+  ASSERT(array.children[0]->buffers[0] == nullptr);
+
+  ArrowArray* names= array.children[1];
+  const int32_t* offsets= static_cast<const int32_t*>(names->buffers[1]);
+  ASSERT_EQUALS(static_cast<int64_t>(1), names->null_count);
+  ASSERT_EQUALS(std::string("one"), std::string(static_cast<const char*>(names->buffers[2]) + offsets[0], offsets[1] - offsets[0]));
+  ASSERT_EQUALS(offsets[1], offsets[2]);
+  ASSERT_EQUALS(0x01, static_cast<const uint8_t*>(names->buffers[0])[0] & 0x03);
+  ASSERT_EQUALS(1, static_cast<const int32_t*>(array.children[2]->buffers[1])[0]);
+
+  schema.release(&schema);
+  array.release(&array);
+  ASSERT(schema.release == nullptr && array.release == nullptr);
+
+  ASSERT_EQUALS(static_cast<std::size_t>(1), sql::exportArrowBatch(res.get(), 2, &schema, &array));
+  ASSERT_EQUALS(-1, static_cast<const int32_t*>(array.children[2]->buffers[1])[0]);
+  schema.release(&schema);
+  array.release(&array);
+
+  ASSERT_EQUALS(static_cast<std::size_t>(0), sql::exportArrowBatch(res.get(), 2, &schema, &array));
+  ASSERT(schema.release == nullptr && array.release == nullptr);
+}
+
+
+void resultset::typedCursor()
+{
+  logMsg("resultset::typedCursor - MySQL_ResultSet::get<T> and typed<T...>");
+
+  stmt.reset(con->createStatement());
+  res.reset(stmt->executeQuery("SELECT 1, 'one', 1.5 UNION ALL SELECT 2, 'two', NULL"));
+
+  ASSERT(res->next());
+  ASSERT_EQUALS(static_cast<int64_t>(1), res->get<int64_t>(1));
+  ASSERT_EQUALS(sql::SQLString("one"), res->get<sql::SQLString>(2));
+  ASSERT_EQUALS(1.5, res->get<double>(3));
+
+  res.reset(stmt->executeQuery("SELECT 1, 'one', 1.5 UNION ALL SELECT 2, 'two', NULL"));
+  auto cursor= res->typed<int32_t, sql::SQLString, double>();
+  std::tuple<int32_t, sql::SQLString, double> row;
+
+  ASSERT(cursor.next(row));
+  ASSERT_EQUALS(1, std::get<0>(row));
+  ASSERT_EQUALS(1.5, std::get<2>(row));
+  ASSERT(cursor.next(row));
+  ASSERT_EQUALS(2, std::get<0>(row));
+  ASSERT_EQUALS(sql::SQLString("two"), std::get<1>(row));
+  ASSERT_EQUALS(0.0, std::get<2>(row));
+  ASSERT(!cursor.next(row));
+}
+
+
+namespace
+{
+  struct Order
+  {
+    int64_t id;
+    sql::SQLString name;
+    double price;
+  };
+}
+
+void resultset::fetchInto()
+{
+  logMsg("resultset::fetchInto - MySQL_ResultSet::fetchInto");
+
+  static const sql::RowMapping<Order> orderFields(&Order::id, &Order::name, &Order::price);
+  const sql::SQLString query("SELECT @n:=@n+1 AS n, CONCAT('order', @n), IF(@n = 3, NULL, @n/2) FROM "
+    "information_schema.columns a, information_schema.columns b, (SELECT @n:=0) init LIMIT 2500");
+
+  stmt.reset(con->createStatement());
+  pstmt.reset(con->prepareStatement(query));
+  for (int32_t i= 0; i < 2; ++i) {
+    res.reset(i == 0 ? stmt->executeQuery(query) : pstmt->executeQuery());
+
+    std::vector<Order> orders(1);
+    ASSERT_EQUALS(static_cast<std::size_t>(2), res->fetchInto(orders, orderFields, 2));
+    ASSERT_EQUALS(static_cast<std::size_t>(3), orders.size());
+    ASSERT_EQUALS(static_cast<int64_t>(1), orders[1].id);
+    ASSERT_EQUALS(sql::SQLString("order2"), orders[2].name);
+    ASSERT_EQUALS(1.0, orders[2].price);
+
+    // The rest of the rows takes several chunks
+    ASSERT_EQUALS(static_cast<std::size_t>(2498), res->fetchInto(orders, orderFields));
+    ASSERT_EQUALS(static_cast<std::size_t>(2501), orders.size());
+    ASSERT_EQUALS(0.0, orders[3].price);
+    ASSERT_EQUALS(static_cast<int64_t>(2500), orders.back().id);
+    ASSERT_EQUALS(sql::SQLString("order2500"), orders.back().name);
+    ASSERT_EQUALS(static_cast<std::size_t>(0), res->fetchInto(orders, orderFields));
+  }
+}
+
+
+namespace
+{
+  /* Exports the rest of the result to the temporary file, and returns what has been written */
+  std::string exportToString(sql::ResultSet* rs, sql::ExportOptions::Format format, const sql::ExportOptions& options,
+    int64_t& rows)
+  {
+    FILE* file= tmpfile();
+    ASSERT(file != nullptr);
+    rows= rs->exportTo(fileno(file), format, options);
+
+    std::string result;
+    char buffer[256];
+    std::size_t read;
+    rewind(file);
+    while ((read= fread(buffer, 1, sizeof(buffer), file)) > 0) {
+      result.append(buffer, read);
+    }
+    fclose(file);
+    return result;
+  }
+}
+
+void resultset::exportTo()
+{
+  logMsg("resultset::exportTo - MySQL_ResultSet::exportTo");
+
+  const sql::SQLString query("SELECT 1 AS id, 'a,b' AS name, NULL AS note UNION ALL "
+    "SELECT 2, 'say \"hi\"', CONCAT('tab', CHAR(9), 'here', CHAR(10))");
+  sql::ExportOptions options;
+  int64_t rows;
+
+  stmt.reset(con->createStatement());
+  pstmt.reset(con->prepareStatement(query));
+  for (int32_t i= 0; i < 2; ++i) {
+    options.header= true;
+    res.reset(i == 0 ? stmt->executeQuery(query) : pstmt->executeQuery());
+    ASSERT_EQUALS("id,name,note\n1,\"a,b\",\n2,\"say \"\"hi\"\"\",\"tab\there\n\"\n",
+      exportToString(res.get(), sql::ExportOptions::EXPORT_CSV, options, rows).c_str());
+    ASSERT_EQUALS(static_cast<int64_t>(2), rows);
+
+    options.header= false;
+    res.reset(i == 0 ? stmt->executeQuery(query) : pstmt->executeQuery());
+    ASSERT_EQUALS("1\ta,b\t\\N\n2\tsay \"hi\"\ttab\\there\\n\n",
+      exportToString(res.get(), sql::ExportOptions::EXPORT_TSV, options, rows).c_str());
+
+    res.reset(i == 0 ? stmt->executeQuery(query) : pstmt->executeQuery());
+    // Only the rows after the cursor are exported
+    ASSERT(res->next());
+    ASSERT_EQUALS("{\"id\":2,\"name\":\"say \\\"hi\\\"\",\"note\":\"tab\\there\\n\"}\n",
+      exportToString(res.get(), sql::ExportOptions::EXPORT_NDJSON, options, rows).c_str());
+    ASSERT_EQUALS(static_cast<int64_t>(1), rows);
+    ASSERT(!res->next());
+  }
+}
+
+void resultset::incrementalFetch()
+{
+  logMsg("resultset::incrementalFetch - MySQL_ResultSet::next");
+
+  const sql::SQLString query("SELECT 1 UNION ALL SELECT 2 UNION ALL SELECT 3 UNION ALL SELECT 4 UNION ALL SELECT 5");
+  sql::Properties p{{"incrementalFetchSize", "2"}};
+  Connection c(getConnection(&p));
+  Statement st(c->createStatement());
+  PreparedStatement ps(c->prepareStatement(query));
+
+  for (int32_t i= 0; i < 2; ++i) {
+    uint64_t fetched= c->getMetrics().rowsFetched;
+    res.reset(i == 0 ? st->executeQuery(query) : ps->executeQuery());
+    ASSERT_EQUALS(static_cast<uint64_t>(2), c->getMetrics().rowsFetched - fetched);
+    ASSERT_EQUALS(0, res->getFetchSize());
+    ASSERT_EQUALS(sql::ResultSet::TYPE_FORWARD_ONLY, res->getType());
+
+    for (int32_t expected= 1; expected <= 3; ++expected) {
+      ASSERT(res->next());
+      ASSERT_EQUALS(expected, res->getInt(1));
+    }
+    ASSERT_EQUALS(static_cast<uint64_t>(4), c->getMetrics().rowsFetched - fetched);
+    // Rows that have been read are kept
+    ASSERT(res->first());
+    ASSERT_EQUALS(1, res->getInt(1));
+    ASSERT(res->absolute(3));
+    ASSERT_EQUALS(3, res->getInt(1));
+
+    // Other query reads the rest of the result first
+    Statement otherStmt(c->createStatement());
+    ResultSet other(otherStmt->executeQuery("SELECT 42"));
+    ASSERT(other->next());
+    ASSERT_EQUALS(42, other->getInt(1));
+    ASSERT_EQUALS(static_cast<uint64_t>(6), c->getMetrics().rowsFetched - fetched);
+
+    ASSERT(res->last());
+    ASSERT_EQUALS(5, res->getInt(1));
+    ASSERT_EQUALS(5, res->getRow());
+    ASSERT(res->previous());
+    ASSERT_EQUALS(4, res->getInt(1));
+    ASSERT(res->next());
+    ASSERT(!res->next());
+  }
+}
+
+
+void resultset::wideStrings()
+{
+  logMsg("resultset::wideStrings - MySQL_ResultSet::getU16String");
+
+  const std::u16string value(u"Zürich 日本 \U0001F600 and plain ASCII long enough for the vector path");
+  const std::wstring wvalue(L"Zürich 日本 \U0001F600 and plain ASCII long enough for the vector path");
+  const sql::SQLString utf8(u8"Zürich 日本 \U0001F600 and plain ASCII long enough for the vector path");
+
+  createSchemaObject("TABLE", "wide_strings", "(id INT NOT NULL, val VARCHAR(100) CHARACTER SET utf8mb4, nul VARCHAR(10))");
+  pstmt.reset(con->prepareStatement("INSERT INTO wide_strings(id, val, nul) VALUES(?, ?, NULL)"));
+  pstmt->setInt(1, 1);
+  pstmt->setU16String(2, value);
+  pstmt->executeUpdate();
+  pstmt->setInt(1, 2);
+  pstmt->setWString(2, wvalue);
+  pstmt->executeUpdate();
+
+  stmt.reset(con->createStatement());
+  pstmt.reset(con->prepareStatement("SELECT id, val, nul FROM wide_strings ORDER BY id"));
+  for (int32_t i= 0; i < 2; ++i) {
+    res.reset(i == 0 ? stmt->executeQuery("SELECT id, val, nul FROM wide_strings ORDER BY id") : pstmt->executeQuery());
+    while (res->next()) {
+      ASSERT_EQUALS(utf8, res->getString(2));
+      ASSERT(value == res->getU16String(2));
+      ASSERT(wvalue == res->getWString("val"));
+      ASSERT(std::u16string(u"1") == res->getU16String(1) || std::u16string(u"2") == res->getU16String(1));
+      ASSERT(res->getU16String(3).empty());
+      ASSERT(res->wasNull());
+      ASSERT(res->getWString(3).empty());
+    }
+  }
+}
+
+
+void resultset::fetchBytes()
+{
+  logMsg("resultset::fetchBytes - MySQL_ResultSet::next");
+
+  const sql::SQLString query("SELECT id, val FROM fetch_bytes ORDER BY id");
+  createSchemaObject("TABLE", "fetch_bytes", "(id INT NOT NULL, val VARCHAR(5000))");
+  pstmt.reset(con->prepareStatement("INSERT INTO fetch_bytes VALUES(?, REPEAT(?, ?))"));
+  for (int32_t id= 1; id <= 23; ++id) {
+    pstmt->setInt(1, id);
+    pstmt->setString(2, id <= 20 ? "n" : "w");
+    pstmt->setInt(3, id <= 20 ? 100 : 5000);
+    pstmt->executeUpdate();
+  }
+
+  sql::Properties p{{"useServerPrepStmts", "true"}};
+  Connection c(getConnection(&p));
+  Statement st(c->createStatement());
+  PreparedStatement ps(c->prepareStatement(query));
+
+  st->setFetchBytes(1000);
+  ps->setFetchBytes(1000);
+  ASSERT_EQUALS(static_cast<uint64_t>(1000), static_cast<uint64_t>(ps->getFetchBytes()));
+
+  for (int32_t i= 0; i < 2; ++i) {
+    uint64_t fetched= c->getMetrics().rowsFetched;
+    res.reset(i == 0 ? st->executeQuery(query) : ps->executeQuery());
+    ASSERT_EQUALS(0, res->getFetchSize());
+    // About 100 bytes per row
+    ASSERT_EQUALS(static_cast<uint64_t>(10), c->getMetrics().rowsFetched - fetched);
+
+    for (int32_t expected= 1; expected <= 20; ++expected) {
+      ASSERT(res->next());
+      ASSERT_EQUALS(expected, res->getInt(1));
+    }
+    ASSERT_EQUALS(static_cast<uint64_t>(20), c->getMetrics().rowsFetched - fetched);
+    // Every wide row is the chunk of its own
+    for (int32_t expected= 21; expected <= 23; ++expected) {
+      ASSERT(res->next());
+      ASSERT_EQUALS(expected, res->getInt(1));
+      ASSERT_EQUALS(static_cast<uint64_t>(expected), c->getMetrics().rowsFetched - fetched);
+      ASSERT_EQUALS(static_cast<uint64_t>(5000), static_cast<uint64_t>(res->getString(2).length()));
+    }
+    ASSERT(!res->next());
+  }
+}
+
+
+void resultset::getJsonView()
+{
+  logMsg("resultset::getJsonView - MySQL_ResultSet::getJsonView");
+
+  // JSON columns are marked only in the extended metadata
+  if (getServerVersion(con) < 1005002)
+  {
+    SKIP("Server does not send extended metadata");
+  }
+  const sql::SQLString query("SELECT id, doc FROM json_view ORDER BY id");
+  const std::string doc("{\"a\": [1, 2, {\"b\": \"c\"}]}");
+  std::size_t length;
+  const char* value;
+
+  createSchemaObject("TABLE", "json_view", "(id INT NOT NULL, doc JSON)");
+  pstmt.reset(con->prepareStatement("INSERT INTO json_view VALUES(?, ?)"));
+  pstmt->setInt(1, 1);
+  pstmt->setString(2, doc);
+  pstmt->executeUpdate();
+  pstmt->setInt(1, 2);
+  pstmt->setNull(2, sql::Types::VARCHAR);
+  pstmt->executeUpdate();
+
+  stmt.reset(con->createStatement());
+  pstmt.reset(con->prepareStatement(query));
+
+  for (int32_t i= 0; i < 2; ++i) {
+    res.reset(i == 0 ? stmt->executeQuery(query) : pstmt->executeQuery());
+    ASSERT(res->next());
+
+    value= res->getJsonView(2, length);
+    ASSERT(value != nullptr);
+    ASSERT_EQUALS(doc, std::string(value, length));
+    ASSERT_EQUALS(doc, std::string(res->getJsonView("doc", length), length));
+    try
+    {
+      res->getJsonView(1, length);
+      FAIL("Non-JSON column has been accepted by getJsonView");
+    }
+    catch (sql::SQLDataException&)
+    {
+    }
+
+    ASSERT(res->next());
+    ASSERT(res->getJsonView(2, length) == nullptr);
+    ASSERT_EQUALS(static_cast<uint64_t>(0), static_cast<uint64_t>(length));
+    ASSERT(res->wasNull());
+    ASSERT(!res->next());
+  }
+}
+
+
+void resultset::directStreaming()
+{
+  logMsg("resultset::directStreaming - MySQL_ResultSet::next");
+
+  const sql::SQLString query("SELECT id, CONCAT('row', id) FROM direct_streaming ORDER BY id");
+  createSchemaObject("TABLE", "direct_streaming", "(id INT NOT NULL)");
+  stmt->executeUpdate("INSERT INTO direct_streaming VALUES(1),(2),(3),(4),(5),(6),(7),(8)");
+
+  for (const char* serverPrepare : {"false", "true"}) {
+    sql::Properties p{{"useServerPrepStmts", serverPrepare}};
+    Connection c(getConnection(&p));
+    PreparedStatement ps(c->prepareStatement(query));
+    ps->setFetchSize(3);
+
+    uint64_t fetched= c->getMetrics().rowsFetched;
+    res.reset(ps->executeQuery());
+    for (int32_t expected= 1; expected <= 4; ++expected) {
+      ASSERT(res->next());
+      ASSERT_EQUALS(expected, res->getInt(1));
+      ASSERT_EQUALS("row" + std::to_string(expected), res->getString(2).c_str());
+      ASSERT_EQUALS(static_cast<uint64_t>(expected), c->getMetrics().rowsFetched - fetched);
+    }
+    ASSERT(!res->isLast());
+    ASSERT_EQUALS(4, res->getInt(1));
+
+    // Other query reads the rest of the result first
+    Statement otherStmt(c->createStatement());
+    ResultSet other(otherStmt->executeQuery("SELECT 42"));
+    ASSERT(other->next());
+    ASSERT_EQUALS(42, other->getInt(1));
+    ASSERT_EQUALS(4, res->getInt(1));
+    ASSERT_EQUALS("row4", res->getString(2).c_str());
+
+    for (int32_t expected= 5; expected <= 8; ++expected) {
+      ASSERT(res->next());
+      ASSERT_EQUALS(expected, res->getInt(1));
+    }
+    ASSERT(res->isLast());
+    ASSERT(!res->next());
+  }
+}
+
 } /* namespace resultset */
 } /* namespace testsuite */
@@ -1416,6 +1416,35 @@ void resultsetmetadata::doGetColumnCollation(bool is_ps)
 }
 
 
+void resultsetmetadata::metaDataView()
+{
+  logMsg("resultsetmetadata::metaDataView() - MySQL_ResultSet::getMetaDataView");
+
+  for (int ps= 0; ps < 2; ++ps) {
+    if (ps == 0) {
+      runStandardQuery();
+    }
+    else {
+      runStandardPSQuery();
+    }
+    sql::ResultSetMetaData& view= res->getMetaDataView();
+    ASSERT(&view == &res->getMetaDataView());
+    ASSERT_EQUALS(5U, view.getColumnCount());
+    ASSERT_EQUALS("a", view.getColumnLabel(1));
+    ASSERT_EQUALS("z", view.getColumnLabel(5));
+
+    ResultSetMetaData meta(res->getMetaData());
+    ASSERT(meta.get() != &view);
+    ASSERT_EQUALS(view.getColumnCount(), meta->getColumnCount());
+    for (uint32_t i= 1; i <= view.getColumnCount(); ++i) {
+      ASSERT_EQUALS(view.getColumnLabel(i), meta->getColumnLabel(i));
+      ASSERT_EQUALS(view.getColumnType(i), meta->getColumnType(i));
+    }
+    ASSERT_EQUALS(5, res->findColumn("z"));
+  }
+}
+
+
 void resultsetmetadata::runStandardQuery()
 {
   stmt.reset(con->createStatement());
@@ -105,6 +105,7 @@ public:
     TEST_CASE(isWritable);
     TEST_CASE(getColumnCharset);
     TEST_CASE(getColumnCollation);
+    TEST_CASE(metaDataView);
   }
 
   /**
@@ -275,6 +276,11 @@ public:
    */
   void getColumnCollation();
 
+  /**
+   * Test for ResultSet::getMetaDataView() - the same object is returned each time, and it's consistent with getMetaData
+   */
+  void metaDataView();
+
 };
 
 REGISTER_FIXTURE(resultsetmetadata);
@@ -63,6 +63,30 @@ public:
     TEST_CASE(getResultSetType);
     TEST_CASE(getTypesMinorIssues);
     TEST_CASE(JSON_support);
+    TEST_CASE(cachedRowData);
+    TEST_CASE(getStringView);
+    TEST_CASE(getBytesInto);
+    TEST_CASE(findColumn);
+    TEST_CASE(fetchColumns);
+    TEST_CASE(streamingWindow);
+    TEST_CASE(streamingReadAhead);
+    TEST_CASE(blobChunks);
+    TEST_CASE(lazyColumnFetch);
+    TEST_CASE(getDateTime);
+    TEST_CASE(getDecimal);
+    TEST_CASE(clientCharacterEncoding);
+    TEST_CASE(scrollSpill);
+    TEST_CASE(resultSpill);
+    TEST_CASE(materializeColumns);
+    TEST_CASE(arrowExport);
+    TEST_CASE(typedCursor);
+    TEST_CASE(fetchInto);
+    TEST_CASE(exportTo);
+    TEST_CASE(incrementalFetch);
+    TEST_CASE(wideStrings);
+    TEST_CASE(fetchBytes);
+    TEST_CASE(getJsonView);
+    TEST_CASE(directStreaming);
 
 #ifdef INCLUDE_NOT_IMPLEMENTED_METHODS
     TEST_CASE(notImplemented);
@@ -123,6 +147,127 @@ public:
    */
   void JSON_support();
 
+  /**
+   * Reading rows cached by the result set - streamed and scrollable results, NULL and empty values
+   */
+  void cachedRowData();
+
+  /**
+   * Test for resultset::getStringView() - values pointing to the row buffer and converted ones
+   */
+  void getStringView();
+
+  /**
+   * Test for resultset::getBytesInto() - binary values read into one reused buffer, written with not copied setBytes
+   */
+  void getBytesInto();
+
+  /**
+   * Test for resultset::findColumn() and getters by label - aliases, original names, table prefix, letter case
+   */
+  void findColumn();
+
+  /**
+   * Test for resultset::fetchColumns() - bulk fetch into arrays
+   */
+  void fetchColumns();
+
+  /**
+   * Forward-only streaming result with fetch size - rows are read in windows of fetchSize rows
+   */
+  void streamingWindow();
+
+  /**
+   * Streaming result reads the next window of rows in the background(streamingReadAhead)
+   */
+  void streamingReadAhead();
+
+  /**
+   * BLOB and TEXT values of binary protocol results read in chunks(blobChunkSize)
+   */
+  void blobChunks();
+
+  /**
+   * Variable length values of binary protocol results are fetched from the row, when they are read(lazyColumnFetch)
+   */
+  void lazyColumnFetch();
+
+  /**
+   * Temporal values read into DateTime, and DateTime parameters
+   */
+  void getDateTime();
+
+  /**
+   * Decimal values read into Decimal, and Decimal parameters
+   */
+  void getDecimal();
+
+  /**
+   * UTF-8 strings of the application with latin1 connection character set
+   */
+  void clientCharacterEncoding();
+
+  /**
+   * absolute() over scrollable result, which rows partly are in the spill file
+   */
+  void scrollSpill();
+
+  /**
+   * Result read with fetch size 0 and resultSpillThreshold
+   */
+  void resultSpill();
+
+  /**
+   * materializeColumns() of text and binary protocol results
+   */
+  void materializeColumns();
+
+  /**
+   * exportArrowBatch() in several batches, with NULLs and dates
+   */
+  void arrowExport();
+
+  /**
+   * get<T>() and the cursor of typed rows
+   */
+  void typedCursor();
+
+  /**
+   * fetchInto decodes rows into the vector of structs, with text and binary protocol results
+   */
+  void fetchInto();
+
+  /**
+   * exportTo writes rows as CSV, TSV and NDJSON to the file descriptor
+   */
+  void exportTo();
+
+  /**
+   * Result without fetch size is read in batches of incrementalFetchSize rows, and stays scrollable
+   */
+  void incrementalFetch();
+
+  /**
+   * getU16String, getWString and the matching setters convert between UTF-8 of the connection and UTF-16 or wchar_t
+   */
+  void wideStrings();
+
+  /**
+   * Streamed result with setFetchBytes reads chunks of as many rows as fit in the byte budget, many narrow rows or
+   * one wide row
+   */
+  void fetchBytes();
+
+  /**
+   * getJsonView points to the JSON document in the row buffer, and refuses columns of other types
+   */
+  void getJsonView();
+
+  /**
+   * Forward-only streamed result reads rows one by one, and the current row stays readable after the rest of the
+   * result has been read off the connection
+   */
+  void directStreaming();
 
 };
 
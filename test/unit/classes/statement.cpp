@@ -37,6 +37,8 @@
 #include "statementtest.h"
 #include <stdlib.h>
 #include <time.h>
+#include <chrono>
+#include <thread>
 
 namespace testsuite
 {
@@ -676,6 +678,101 @@ void statement::addBatch()
 }
 
 
+void statement::batchInsertIds()
+{
+  createSchemaObject("TABLE", "batchInsertIds", "(id int not NULL AUTO_INCREMENT PRIMARY KEY, val int)");
+  res.reset(stmt->executeQuery("SELECT @@auto_increment_increment"));
+  ASSERT(res->next());
+  int32_t serverIncrement= res->getInt(1);
+
+  stmt->addBatch("INSERT INTO batchInsertIds(val) VALUES(1),(2)");
+  stmt->addBatch("INSERT INTO batchInsertIds(id, val) VALUES(1, 3)");
+  stmt->addBatch("INSERT INTO batchInsertIds(val) VALUES(4)");
+
+  try {
+    stmt->executeBatch();
+    FAIL("Duplicate key error expected");
+  }
+  catch (sql::SQLException&) {
+  }
+
+  const int64_t *counts, *ids;
+  std::size_t countsSize, idsSize;
+  int32_t increment;
+
+  stmt->getBatchUpdateCounts(counts, countsSize);
+  stmt->getBatchInsertIds(ids, idsSize, increment);
+
+  ASSERT(countsSize >= 2);
+  ASSERT_EQUALS(countsSize, idsSize);
+  ASSERT_EQUALS(serverIncrement, increment);
+  ASSERT_EQUALS(2LL, counts[0]);
+  ASSERT_EQUALS(static_cast<int64_t>(sql::Statement::EXECUTE_FAILED), counts[1]);
+  ASSERT_EQUALS(0LL, ids[1]);
+
+  // The range of the first command's ids matches the generated keys
+  res.reset(stmt->getGeneratedKeys());
+  for (int64_t i= 0; i < counts[0]; ++i) {
+    ASSERT(res->next());
+    ASSERT_EQUALS(ids[0] + i*increment, res->getInt64(1));
+  }
+  if (countsSize > 2) {
+    ASSERT(res->next());
+    ASSERT_EQUALS(ids[2], res->getInt64(1));
+  }
+  ASSERT(!res->next());
+}
+
+void statement::lastInsertId()
+{
+  createSchemaObject("TABLE", "lastInsertId", "(id int not NULL AUTO_INCREMENT PRIMARY KEY, val int)");
+
+  ASSERT_EQUALS(0LL, stmt->getLastInsertId());
+  stmt->executeUpdate("INSERT INTO lastInsertId(id, val) VALUES(10, 1)");
+  ASSERT_EQUALS(10LL, stmt->getLastInsertId());
+
+  PreparedStatement pstmt(con->prepareStatement("INSERT INTO lastInsertId(val) VALUES(?)"));
+  pstmt->setInt(1, 2);
+  pstmt->executeUpdate();
+  res.reset(stmt->executeQuery("SELECT MAX(id) FROM lastInsertId"));
+  ASSERT(res->next());
+  ASSERT_EQUALS(res->getInt64(1), pstmt->getLastInsertId());
+
+  // The explicit value counts as the insert id, like in the OK packet
+  stmt->executeUpdate("INSERT INTO lastInsertId(id, val) VALUES(100, 3)");
+  ASSERT_EQUALS(100LL, stmt->getLastInsertId());
+
+  stmt->addBatch("INSERT INTO lastInsertId(val) VALUES(4)");
+  stmt->addBatch("INSERT INTO lastInsertId(val) VALUES(5)");
+  stmt->addBatch("UPDATE lastInsertId SET val=val+1 WHERE id=100");
+  stmt->executeBatch();
+  int64_t batchId= stmt->getLastInsertId();
+  res.reset(stmt->executeQuery("SELECT id FROM lastInsertId WHERE val=5"));
+  ASSERT(res->next());
+  ASSERT_EQUALS(res->getInt64(1), batchId);
+}
+
+void statement::skipResults()
+{
+  Statement stmt1(con->createStatement());
+
+  ASSERT(stmt1->execute("SELECT * FROM information_schema.columns;DO 1;SELECT 2;SELECT 3"));
+  // Lands on the update count of DO
+  ASSERT(!stmt1->skipResults(1));
+  ASSERT_EQUALS(0, stmt1->getUpdateCount());
+  ASSERT(stmt1->skipResults(2));
+  res.reset(stmt1->getResultSet());
+  ASSERT(res->next());
+  ASSERT_EQUALS(3, res->getInt(1));
+  ASSERT(!stmt1->skipResults(1));
+  ASSERT_EQUALS(-1, stmt1->getUpdateCount());
+
+  // The connection has to be usable after the skip
+  res.reset(stmt->executeQuery("SELECT 100"));
+  ASSERT(res->next());
+  ASSERT_EQUALS(100, res->getInt(1));
+}
+
 /** Test of rewriteBatchedStatements option. The test does cannot test if the batch is really rewritten, though.
  */
 void statement::concpp99_batchRewrite()
@@ -835,5 +932,412 @@ void statement::multirs_caching()
   ASSERT(!stmt1->getMoreResults());
   ASSERT(stmt1->getUpdateCount() == -1);
 }
+
+
+void statement::executeAsync()
+{
+  std::unique_ptr<sql::AsyncExecution> execution(stmt->executeAsync("SELECT SLEEP(0.2), 7"));
+
+  ASSERT(execution->getSocket() >= 0);
+  // Connection may not be used while the execution is in progress
+  if (!execution->isDone()) {
+    Statement stmt1(con->createStatement());
+    try {
+      res.reset(stmt1->executeQuery("SELECT 1"));
+      FAIL("Connection could be used during asynchronous execution");
+    }
+    catch (sql::SQLException&) {
+    }
+  }
+  // Not really waiting for events here - resume() returns the same status, if they have not occurred yet
+  while (!execution->isDone()) {
+    execution->resume(execution->getWaitStatus());
+  }
+  ASSERT(execution->getResult());
+  res.reset(stmt->getResultSet());
+  ASSERT(res->next());
+  ASSERT_EQUALS(7, res->getInt(2));
+
+  execution.reset(stmt->executeAsync("DO 1"));
+  while (!execution->isDone()) {
+    execution->resume(execution->getWaitStatus());
+  }
+  ASSERT(!execution->getResult());
+  ASSERT_EQUALS(0, stmt->getUpdateCount());
+
+  try {
+    execution.reset(stmt->executeAsync("SELECT * FROM nonexistent_table_async"));
+    while (!execution->isDone()) {
+      execution->resume(execution->getWaitStatus());
+    }
+    FAIL("Error has not been reported");
+  }
+  catch (sql::SQLException& e) {
+    ASSERT_EQUALS("42S02", e.getSQLState());
+  }
+  // Connection is usable after the error
+  res.reset(stmt->executeQuery("SELECT 1"));
+  ASSERT(res->next());
+}
+
+
+void statement::cancelQuery()
+{
+  res.reset(stmt->executeQuery("SELECT CONNECTION_ID()"));
+  ASSERT(res->next());
+  int64_t id= res->getLong(1);
+
+  // Second time the control connection is reused
+  for (int32_t i= 0; i < 2; ++i) {
+    bool cancelled= true;
+    std::thread canceller([this, &cancelled]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+      try {
+        stmt->cancel();
+      }
+      catch (sql::SQLException&) {
+        cancelled= false;
+      }
+    });
+    auto start= std::chrono::steady_clock::now();
+    res.reset(stmt->executeQuery("SELECT SLEEP(10)"));
+    canceller.join();
+    ASSERT(cancelled);
+    ASSERT(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+    ASSERT(res->next());
+    // Interrupted SLEEP returns 1
+    ASSERT_EQUALS(1, res->getInt(1));
+  }
+  res.reset(stmt->executeQuery("SELECT CONNECTION_ID()"));
+  ASSERT(res->next());
+  ASSERT_EQUALS(id, res->getLong(1));
+}
+
+
+void statement::queryTimeoutMs()
+{
+  stmt->setQueryTimeoutMs(300);
+  ASSERT_EQUALS(static_cast<int64_t>(300), stmt->getQueryTimeoutMs());
+  // Rounded up
+  ASSERT_EQUALS(1, stmt->getQueryTimeout());
+
+  auto start= std::chrono::steady_clock::now();
+  try {
+    res.reset(stmt->executeQuery("SELECT SLEEP(5)"));
+    // Interrupted SLEEP returns 1
+    ASSERT(res->next());
+    ASSERT_EQUALS(1, res->getInt(1));
+  }
+  catch (sql::SQLException& e) {
+    ASSERT_EQUALS("70100", e.getSQLState());
+  }
+  ASSERT(std::chrono::steady_clock::now() - start < std::chrono::seconds(3));
+
+  // The deadline is cancelled once the query is done
+  res.reset(stmt->executeQuery("SELECT 1"));
+  std::this_thread::sleep_for(std::chrono::milliseconds(400));
+  res.reset(stmt->executeQuery("SELECT SLEEP(0.1)"));
+  ASSERT(res->next());
+  ASSERT_EQUALS(0, res->getInt(1));
+
+  stmt->setQueryTimeout(0);
+  ASSERT_EQUALS(static_cast<int64_t>(0), stmt->getQueryTimeoutMs());
+}
+
+
+void statement::stopBatchOnError()
+{
+  sql::Properties p{{"user", user}, {"password", passwd}, {"continueBatchOnError", "false"}};
+  std::unique_ptr<sql::Connection> c(driver->connect(url, p));
+  std::unique_ptr<sql::Statement> st(c->createStatement());
+
+  createSchemaObject("TABLE", "stopBatchOnError", "(id INT NOT NULL PRIMARY KEY)");
+  st->addBatch("INSERT INTO stopBatchOnError VALUES(1)");
+  st->addBatch("UPDATE stopBatchOnError SET id=id");
+  st->addBatch("INSERT INTO stopBatchOnError VALUES(1)");
+  st->addBatch("INSERT INTO stopBatchOnError VALUES(2)");
+  try {
+    st->executeBatch();
+    FAIL("Batch with duplicate key has not failed");
+  }
+  catch (sql::SQLException& e) {
+    ASSERT_EQUALS(1062, e.getErrorCode());
+  }
+  res.reset(stmt->executeQuery("SELECT COUNT(*), MAX(id) FROM stopBatchOnError"));
+  ASSERT(res->next());
+  ASSERT_EQUALS(1, res->getInt(1));
+  ASSERT_EQUALS(1, res->getInt(2));
+  c->close();
+}
+
+
+void statement::alternatingMaxRows()
+{
+  const char* query= "SELECT id FROM alternatingMaxRows";
+  std::string values("INSERT INTO alternatingMaxRows VALUES(1)");
+
+  createSchemaObject("TABLE", "alternatingMaxRows", "(id INT NOT NULL PRIMARY KEY)");
+  for (int32_t i= 2; i <= 100; ++i) {
+    values.append(",(").append(std::to_string(i)).append(")");
+  }
+  stmt->executeUpdate(values);
+
+  Statement limited(con->createStatement()), unlimited(con->createStatement());
+  PreparedStatement ps(con->prepareStatement(query));
+
+  limited->setMaxRows(3);
+  ps->setMaxRows(5);
+  for (int32_t i= 0; i < 3; ++i) {
+    int32_t rows= 0;
+
+    res.reset(limited->executeQuery(query));
+    while (res->next()) ++rows;
+    ASSERT_EQUALS(3, rows);
+
+    rows= 0;
+    res.reset(unlimited->executeQuery(query));
+    while (res->next()) ++rows;
+    ASSERT_EQUALS(100, rows);
+
+    rows= 0;
+    res.reset(ps->executeQuery());
+    while (res->next()) ++rows;
+    ASSERT_EQUALS(5, rows);
+  }
+  // The session's limit is changed along with the next query, even if that one fails
+  try {
+    limited->executeQuery("SELECT * FROM nonexistent_alternating_table");
+    FAIL("Query on non-existent table has not failed");
+  }
+  catch (sql::SQLException& e) {
+    ASSERT_EQUALS(1146, e.getErrorCode());
+  }
+  res.reset(unlimited->executeQuery(query));
+  int32_t rows= 0;
+  while (res->next()) ++rows;
+  ASSERT_EQUALS(100, rows);
+}
+
+void statement::resultCache()
+{
+  const char* query= "SELECT COUNT(*) FROM resultCache";
+
+  createSchemaObject("TABLE", "resultCache", "(id INT NOT NULL PRIMARY KEY)");
+  stmt->executeUpdate("INSERT INTO resultCache VALUES(1)");
+  driver->setResultCache(1024*1024);
+
+  Statement cached(con->createStatement());
+  PreparedStatement ps(con->prepareStatement("/* RESULT_CACHE(60000) */ SELECT COUNT(*) FROM resultCache WHERE id > ?"));
+  cached->setResultCacheTtl(60000);
+  ps->setInt(1, 0);
+
+  res.reset(cached->executeQuery(query));
+  ASSERT(res->next());
+  ASSERT_EQUALS(1, res->getInt(1));
+  res.reset(ps->executeQuery());
+  ASSERT(res->next());
+  ASSERT_EQUALS(1, res->getInt(1));
+
+  stmt->executeUpdate("INSERT INTO resultCache VALUES(2)");
+  // Cached results stay until their ttl expires, others see the change
+  res.reset(cached->executeQuery(query));
+  ASSERT(res->next());
+  ASSERT_EQUALS(1, res->getInt(1));
+  res.reset(ps->executeQuery());
+  ASSERT(res->next());
+  ASSERT_EQUALS(1, res->getInt(1));
+  res.reset(stmt->executeQuery(query));
+  ASSERT(res->next());
+  ASSERT_EQUALS(2, res->getInt(1));
+
+  // Other parameters value is the other result
+  ps->setInt(1, 1);
+  res.reset(ps->executeQuery());
+  ASSERT(res->next());
+  ASSERT_EQUALS(1, res->getInt(1));
+
+  driver->setResultCache(0);
+  res.reset(cached->executeQuery(query));
+  ASSERT(res->next());
+  ASSERT_EQUALS(2, res->getInt(1));
+}
+
+
+void statement::adaptiveBatchWindow()
+{
+  sql::Properties p{{"user", user}, {"password", passwd}, {"continueBatchOnError", "true"},
+    {"useBatchMultiSendNumber", "4"}, {"adaptiveBatchWindow", "true"}};
+  std::unique_ptr<sql::Connection> c(driver->connect(url, p));
+  std::unique_ptr<sql::Statement> st(c->createStatement());
+
+  ASSERT_EQUALS(static_cast<uint64_t>(4), c->getMetrics().batchWindow);
+  createSchemaObject("TABLE", "adaptiveBatchWindow", "(id INT NOT NULL PRIMARY KEY)");
+  for (int32_t i= 1; i <= 200; ++i) {
+    st->addBatch("INSERT INTO adaptiveBatchWindow VALUES(" + std::to_string(i) + ")");
+  }
+  // The duplicate fails, and the rest of the batch is executed
+  st->addBatch("INSERT INTO adaptiveBatchWindow VALUES(1)");
+  st->addBatch("INSERT INTO adaptiveBatchWindow VALUES(201)");
+  try {
+    st->executeBatch();
+    FAIL("Batch with duplicate key has not failed");
+  }
+  catch (sql::SQLException&) {
+  }
+  res.reset(st->executeQuery("SELECT COUNT(*) FROM adaptiveBatchWindow"));
+  ASSERT(res->next());
+  ASSERT_EQUALS(201, res->getInt(1));
+  ASSERT(c->getMetrics().batchWindow >= 1);
+  c->close();
+}
+
+
+void statement::executeScalar()
+{
+  createSchemaObject("TABLE", "executeScalar", "(id INT NOT NULL PRIMARY KEY, val VARCHAR(32), price DOUBLE)");
+  ASSERT_EQUALS(3, stmt->executeUpdate("INSERT INTO executeScalar VALUES(1,'one',1.5),(2,'two',NULL),(3,NULL,2.25)"));
+
+  ASSERT_EQUALS(3, stmt->executeScalar<int32_t>("SELECT COUNT(*) FROM executeScalar"));
+  ASSERT_EQUALS(static_cast<int64_t>(6), stmt->executeScalar<int64_t>("SELECT SUM(id) FROM executeScalar"));
+  ASSERT_EQUALS(3.75, stmt->executeScalar<double>("SELECT SUM(price) FROM executeScalar"));
+  ASSERT_EQUALS("one", stmt->executeScalar<sql::SQLString>("SELECT val FROM executeScalar ORDER BY id"));
+  // NULL and no row
+  ASSERT_EQUALS(0, stmt->executeScalar<int32_t>("SELECT price FROM executeScalar WHERE id=2"));
+  ASSERT_EQUALS(0, stmt->executeScalar<int32_t>("SELECT id FROM executeScalar WHERE id=100"));
+  int64_t value= -1;
+  ASSERT(!stmt->executeScalar("SELECT val FROM executeScalar WHERE id=3", value));
+  // The rest of the result, and following results are skipped, and the connection is usable
+  ASSERT_EQUALS(1, stmt->executeScalar<int32_t>("SELECT id FROM executeScalar ORDER BY id"));
+  res.reset(stmt->executeQuery("SELECT COUNT(*) FROM executeScalar"));
+  ASSERT(res->next());
+  ASSERT_EQUALS(3, res->getInt(1));
+
+  try {
+    stmt->executeScalar<int32_t>("SELECT 'abc'");
+    FAIL("Non-numeric value has been converted to integer");
+  }
+  catch (sql::SQLException&) {
+  }
+  try {
+    stmt->executeUpdate("SELECT id FROM executeScalar");
+    FAIL("executeUpdate has not thrown for the query with result set");
+  }
+  catch (sql::SQLException&) {
+  }
+  ASSERT_EQUALS(1, stmt->executeUpdate("UPDATE executeScalar SET val='three' WHERE id=3"));
+  ASSERT_EQUALS(static_cast<int64_t>(2), stmt->executeLargeUpdate("DELETE FROM executeScalar WHERE id > 1"));
+
+  for (const char* useServerPrepStmts : {"false", "true"}) {
+    sql::Properties p{{"user", user}, {"password", passwd}, {"useServerPrepStmts", useServerPrepStmts}};
+    std::unique_ptr<sql::Connection> c(driver->connect(url, p));
+    std::unique_ptr<sql::PreparedStatement> ps(c->prepareStatement("SELECT val FROM executeScalar WHERE id=?"));
+
+    ps->setInt(1, 1);
+    ASSERT_EQUALS("one", ps->executeScalar<sql::SQLString>());
+    ps->setInt(1, 2);
+    ASSERT_EQUALS("", ps->executeScalar<sql::SQLString>());
+    ps.reset(c->prepareStatement("UPDATE executeScalar SET price=? WHERE id=1"));
+    ps->setDouble(1, 3.5);
+    ASSERT_EQUALS(1, ps->executeUpdate());
+    ps.reset(c->prepareStatement("SELECT price FROM executeScalar WHERE id=?"));
+    ps->setInt(1, 1);
+    ASSERT_EQUALS(3.5, ps->executeScalar<double>());
+    c->close();
+  }
+}
+
+
+/* Counts the warnings of the chain, and deletes them */
+static uint32_t consumeWarnings(const sql::SQLWarning* warning)
+{
+  uint32_t count= 0;
+  while (warning != nullptr) {
+    const sql::SQLWarning* next= warning->getNextWarning();
+    delete warning;
+    warning= next;
+    ++count;
+  }
+  return count;
+}
+
+
+static int32_t showWarningsCount(sql::Statement* st)
+{
+  std::unique_ptr<sql::ResultSet> rs(st->executeQuery("SHOW SESSION STATUS LIKE 'Com_show_warnings'"));
+  return rs->next() ? rs->getInt(2) : -1;
+}
+
+
+void statement::warningsCache()
+{
+  sql::Properties p{{"user", user}, {"password", passwd}};
+  std::unique_ptr<sql::Connection> c(driver->connect(url, p));
+  std::unique_ptr<sql::Statement> st(c->createStatement());
+  std::unique_ptr<sql::Statement> status(c->createStatement());
+
+  int32_t before= showWarningsCount(status.get());
+  res.reset(st->executeQuery("SELECT CAST('1a' AS SIGNED), CAST('2b' AS SIGNED)"));
+  ASSERT_EQUALS(2U, consumeWarnings(st->getWarnings()));
+  ASSERT_EQUALS(2U, consumeWarnings(st->getWarnings()));
+  ASSERT_EQUALS(2U, consumeWarnings(c->getWarnings()));
+  ASSERT_EQUALS(before + 1, showWarningsCount(status.get()));
+  // The next execution has its own warnings
+  res.reset(st->executeQuery("SELECT 1"));
+  ASSERT(st->getWarnings() == nullptr);
+  c->close();
+
+  p["maxWarnings"]= "1";
+  p["ignoreNoteWarnings"]= "true";
+  c.reset(driver->connect(url, p));
+  st.reset(c->createStatement());
+  res.reset(st->executeQuery("SELECT CAST('1a' AS SIGNED), CAST('2b' AS SIGNED)"));
+  ASSERT_EQUALS(1U, consumeWarnings(st->getWarnings()));
+  st->execute("DROP TABLE IF EXISTS warningsCacheNoSuchTable");
+  ASSERT(st->getWarnings() == nullptr);
+  c->close();
+}
+
+
+void statement::executionStats()
+{
+  const sql::SQLString query("SELECT 1 UNION ALL SELECT 2 UNION ALL SELECT 3");
+  sql::Properties p{{"useServerPrepStmts", "true"}};
+  Connection c(getConnection(&p));
+  Statement st(c->createStatement());
+
+  res.reset(st->executeQuery(query));
+  const sql::ExecutionStats& stats= st->getLastExecutionStats();
+  ASSERT_EQUALS(static_cast<uint64_t>(1), stats.roundTrips);
+  ASSERT_EQUALS(static_cast<uint64_t>(3), stats.rows);
+  ASSERT_EQUALS(static_cast<uint64_t>(query.length()), stats.bytesSent);
+  ASSERT_EQUALS(static_cast<uint64_t>(3), stats.bytesReceived);
+  ASSERT(stats.totalTime >= stats.networkTime + stats.decodeTime);
+  ASSERT(stats.networkTime > 0);
+  ASSERT(!stats.prepared);
+  ASSERT(!stats.bulk);
+  ASSERT(!stats.rewritten);
+
+  PreparedStatement ps(c->prepareStatement("SELECT ?"));
+  ps->setInt(1, 7);
+  res.reset(ps->executeQuery());
+  ASSERT(ps->getLastExecutionStats().prepared);
+  // Prepared by prepareStatement
+  ASSERT(ps->getLastExecutionStats().cached);
+  ASSERT_EQUALS(static_cast<uint64_t>(1), ps->getLastExecutionStats().rows);
+
+  createSchemaObject("TABLE", "execution_stats", "(id INT NOT NULL)");
+  sql::Properties rewrite{{"rewriteBatchedStatements", "true"}};
+  Connection c2(getConnection(&rewrite));
+  PreparedStatement ps2(c2->prepareStatement("INSERT INTO execution_stats VALUES(?)"));
+  for (int32_t i= 0; i < 10; ++i) {
+    ps2->setInt(1, i);
+    ps2->addBatch();
+  }
+  ps2->executeBatch();
+  ASSERT(ps2->getLastExecutionStats().rewritten);
+  ASSERT(!ps2->getLastExecutionStats().prepared);
+  ASSERT_EQUALS(static_cast<uint64_t>(1), ps2->getLastExecutionStats().roundTrips);
+}
+
 } /* namespace statement */
 } /* namespace testsuite */
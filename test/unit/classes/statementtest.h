@@ -66,10 +66,23 @@ public:
     TEST_CASE(unbufferedOutOfSync);
     TEST_CASE(queryTimeout);
     TEST_CASE(addBatch);
+    TEST_CASE(batchInsertIds);
+    TEST_CASE(lastInsertId);
+    TEST_CASE(skipResults);
     TEST_CASE(concpp99_batchRewrite);
     TEST_CASE(concpp107_setFetchSizeExeption);
     TEST_CASE(otherstmts_result);
     TEST_CASE(multirs_caching);
+    TEST_CASE(executeAsync);
+    TEST_CASE(cancelQuery);
+    TEST_CASE(queryTimeoutMs);
+    TEST_CASE(stopBatchOnError);
+    TEST_CASE(alternatingMaxRows);
+    TEST_CASE(resultCache);
+    TEST_CASE(adaptiveBatchWindow);
+    TEST_CASE(executeScalar);
+    TEST_CASE(warningsCache);
+    TEST_CASE(executionStats);
   }
 
   /**
@@ -117,6 +130,15 @@ public:
    */
   void addBatch();
 
+  /* getBatchUpdateCounts and getBatchInsertIds giving the batch results without conversion */
+  void batchInsertIds();
+
+  /* getLastInsertId after queries, prepared statements executions and batches */
+  void lastInsertId();
+
+  /* skipResults() in the multi-statement query */
+  void skipResults();
+
   /* addBatch with rewrite option */
   void concpp99_batchRewrite();
 
@@ -125,6 +147,37 @@ public:
 
   void otherstmts_result();
   void multirs_caching();
+
+  /* Non-blocking execution with Statement::executeAsync */
+  void executeAsync();
+
+  /* Statement::cancel kills only the query, and the connection stays usable */
+  void cancelQuery();
+
+  /* Query timeout, that is not whole seconds, enforced by the client side deadline */
+  void queryTimeoutMs();
+
+  /* With continueBatchOnError off the batch, sent in multi-statement packets, stops at the failed query */
+  void stopBatchOnError();
+
+  /* Statements with different maxRows, executed in turns on the same connection, each get their own number of rows */
+  void alternatingMaxRows();
+
+  /* Results of the queries, marked with setResultCacheTtl or RESULT_CACHE comment, come from the cache within ttl */
+  void resultCache();
+
+  /* Multi-send batch with adaptiveBatchWindow - all results are read, and the window is reported in the metrics */
+  void adaptiveBatchWindow();
+
+  /* executeScalar of Statement and PreparedStatement, and executeUpdate, that reads the OK packet only */
+  void executeScalar();
+
+  /* Warnings of the execution are read from the server once, however many times getWarnings() is called, and
+     ignoreNoteWarnings and maxWarnings options */
+  void warningsCache();
+
+  /* getLastExecutionStats of the query, the server side prepared statement and the rewritten batch */
+  void executionStats();
 };
 
 REGISTER_FIXTURE(statement);
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2023 MariaDB Corporation AB
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+
+
+#include <deque>
+#include <exception>
+#include <functional>
+
+#include "PreparedStatement.hpp"
+#include "Connection.hpp"
+#include "Coroutines.hpp"
+#include "coroutines.h"
+
+namespace
+{
+  /* Coroutine, that runs till its first suspension right away, and is destroyed on its completion */
+  struct Task
+  {
+    struct promise_type
+    {
+      Task get_return_object() { return {}; }
+      std::suspend_never initial_suspend() noexcept { return {}; }
+      std::suspend_never final_suspend() noexcept { return {}; }
+      void return_void() {}
+      void unhandled_exception() { std::terminate(); }
+    };
+  };
+
+  /* Does not really wait for the events - resume() returns the same status, if they have not occurred yet */
+  class QueueReactor : public sql::coro::Reactor
+  {
+    std::deque<std::function<void()>> pending;
+
+  public:
+    void waitFor(int64_t, int32_t events, uint32_t, std::function<void(int32_t)> onReady) override
+    {
+      pending.emplace_back([events, onReady]() { onReady(events); });
+    }
+
+    void run()
+    {
+      while (!pending.empty()) {
+        std::function<void()> next(std::move(pending.front()));
+        pending.pop_front();
+        next();
+      }
+    }
+  };
+
+  Task selectSecondColumn(sql::Statement* stmt, const sql::SQLString& query, QueueReactor& reactor, int32_t& value,
+    std::exception_ptr& error)
+  {
+    try {
+      std::unique_ptr<sql::ResultSet> rs(co_await sql::coro::executeQueryAsync(stmt, query, reactor));
+      while (co_await sql::coro::nextAsync(rs.get())) {
+        value= rs->getInt(2);
+      }
+    }
+    catch (...) {
+      error= std::current_exception();
+    }
+  }
+
+  Task execute(sql::Statement* stmt, const sql::SQLString& query, QueueReactor& reactor, bool& hasResultSet,
+    std::exception_ptr& error)
+  {
+    try {
+      hasResultSet= co_await sql::coro::executeAsync(stmt, query, reactor);
+    }
+    catch (...) {
+      error= std::current_exception();
+    }
+  }
+
+  Task selectSecondColumn(sql::PreparedStatement* stmt, QueueReactor& reactor, int32_t& value,
+    std::exception_ptr& error)
+  {
+    try {
+      std::unique_ptr<sql::ResultSet> rs(co_await sql::coro::executeQueryAsync(stmt, reactor));
+      while (co_await sql::coro::nextAsync(rs.get())) {
+        value= rs->getInt(2);
+      }
+    }
+    catch (...) {
+      error= std::current_exception();
+    }
+  }
+}
+
+namespace testsuite
+{
+namespace classes
+{
+
+void coroutines::statementQuery()
+{
+  QueueReactor reactor;
+  int32_t value= 0;
+  std::exception_ptr error;
+
+  selectSecondColumn(stmt.get(), "SELECT SLEEP(0.2), 7", reactor, value, error);
+  reactor.run();
+  ASSERT(error == nullptr);
+  ASSERT_EQUALS(7, value);
+
+  bool hasResultSet= true;
+  execute(stmt.get(), "DO 1", reactor, hasResultSet, error);
+  reactor.run();
+  ASSERT(error == nullptr);
+  ASSERT(!hasResultSet);
+  ASSERT_EQUALS(0, stmt->getUpdateCount());
+}
+
+
+void coroutines::preparedQuery()
+{
+  QueueReactor reactor;
+  int32_t value= 0;
+  std::exception_ptr error;
+
+  pstmt.reset(con->prepareStatement("SELECT SLEEP(0.2), ?"));
+  pstmt->setInt(1, 7);
+  selectSecondColumn(pstmt.get(), reactor, value, error);
+  reactor.run();
+  ASSERT(error == nullptr);
+  ASSERT_EQUALS(7, value);
+
+  sql::Properties p{{"useServerPrepStmts", "true"}};
+  Connection con2(getConnection(&p));
+  PreparedStatement pstmt2(con2->prepareStatement("SELECT 1, ?"));
+  pstmt2->setInt(1, 1);
+  selectSecondColumn(pstmt2.get(), reactor, value, error);
+  reactor.run();
+  ASSERT(error != nullptr);
+  try {
+    std::rethrow_exception(error);
+  }
+  catch (sql::SQLFeatureNotSupportedException&) {
+  }
+}
+
+
+void coroutines::queryError()
+{
+  QueueReactor reactor;
+  int32_t value= 0;
+  std::exception_ptr error;
+
+  selectSecondColumn(stmt.get(), "SELECT 1, 2 FROM nonexistent_table_coro", reactor, value, error);
+  reactor.run();
+  ASSERT(error != nullptr);
+  try {
+    std::rethrow_exception(error);
+  }
+  catch (sql::SQLException& e) {
+    ASSERT_EQUALS("42S02", e.getSQLState());
+  }
+  // Connection is usable after the error
+  res.reset(stmt->executeQuery("SELECT 1"));
+  ASSERT(res->next());
+}
+
+} /* namespace classes */
+} /* namespace testsuite */
@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2023 MariaDB Corporation AB
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "Statement.hpp"
+#include "Connection.hpp"
+#include "perf_budget.h"
+
+/* Allocations are counted only in the thread running a measured block, not to count ones of the driver's background
+   threads. On Windows the connector's DLL does not use these operators, so its allocations are not counted there */
+namespace
+{
+  thread_local bool countAllocations= false;
+  thread_local uint64_t allocations= 0;
+
+  class AllocationCounter
+  {
+  public:
+    AllocationCounter() { allocations= 0; countAllocations= true; }
+    ~AllocationCounter() { countAllocations= false; }
+    uint64_t get() const { return allocations; }
+  };
+}
+
+void* operator new(std::size_t size)
+{
+  if (countAllocations) {
+    ++allocations;
+  }
+  void* ptr= std::malloc(size != 0 ? size : 1);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void* operator new[](std::size_t size)
+{
+  return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+  try {
+    return operator new(size);
+  }
+  catch (std::bad_alloc&) {
+    return nullptr;
+  }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept
+{
+  return operator new(size, tag);
+}
+
+void operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+  std::free(ptr);
+}
+
+namespace testsuite
+{
+namespace performance
+{
+/* Budgets are per operation, and have some headroom over the current numbers - they are to catch regressions, that
+   add allocations or round trips to every execution, and not to fail on small changes */
+static const uint64_t SELECT_1_ALLOCATIONS= 32;
+static const uint64_t DO_1_ALLOCATIONS= 8;
+static const uint64_t BATCH_10K_ROUND_TRIPS= 8;
+
+void perf_budget::selectAllocations()
+{
+  const int32_t iterations= 100;
+  Statement st(con->createStatement());
+
+  // Warming up caches and lazily created objects
+  for (int32_t i= 0; i < 10; ++i) {
+    ResultSet rs(st->executeQuery("SELECT 1"));
+    ASSERT(rs->next());
+    ASSERT_EQUALS(1, rs->getInt(1));
+  }
+  uint64_t counted;
+  {
+    AllocationCounter counter;
+    for (int32_t i= 0; i < iterations; ++i) {
+      ResultSet rs(st->executeQuery("SELECT 1"));
+      rs->next();
+      rs->getInt(1);
+    }
+    counted= counter.get();
+  }
+  logMsg("SELECT 1 + getInt allocations per execution: " + std::to_string(counted / iterations));
+  ASSERT(counted <= SELECT_1_ALLOCATIONS*iterations);
+}
+
+
+void perf_budget::updateAllocations()
+{
+  const int32_t iterations= 100;
+  Statement st(con->createStatement());
+
+  for (int32_t i= 0; i < 10; ++i) {
+    st->executeUpdate("DO 1");
+  }
+  uint64_t counted;
+  {
+    AllocationCounter counter;
+    for (int32_t i= 0; i < iterations; ++i) {
+      st->executeUpdate("DO 1");
+    }
+    counted= counter.get();
+  }
+  logMsg("DO 1 allocations per execution: " + std::to_string(counted / iterations));
+  ASSERT(counted <= DO_1_ALLOCATIONS*iterations);
+}
+
+
+void perf_budget::batchRoundTrips()
+{
+  sql::Properties p{{"user", user}, {"password", passwd}, {"rewriteBatchedStatements", "true"}};
+  Connection c(driver->connect(url, p));
+  Statement st(c->createStatement());
+
+  st->execute("CREATE TEMPORARY TABLE perf_budget_batch(id INT NOT NULL, val VARCHAR(32))");
+  PreparedStatement ps(c->prepareStatement("INSERT INTO perf_budget_batch VALUES(?, ?)"));
+  for (int32_t i= 0; i < 10000; ++i) {
+    ps->setInt(1, i);
+    ps->setString(2, "value " + std::to_string(i));
+    ps->addBatch();
+  }
+  uint64_t roundTrips= c->getMetrics().roundTrips;
+  ps->executeBatch();
+  roundTrips= c->getMetrics().roundTrips - roundTrips;
+
+  logMsg("executeBatch of 10k rows round trips: " + std::to_string(roundTrips));
+  ASSERT(roundTrips <= BATCH_10K_ROUND_TRIPS);
+  ResultSet rs(st->executeQuery("SELECT COUNT(*) FROM perf_budget_batch"));
+  ASSERT(rs->next());
+  ASSERT_EQUALS(10000, rs->getInt(1));
+}
+
+
+void perf_budget::preparedReexecute()
+{
+  const int32_t iterations= 100;
+  sql::Properties p{{"user", user}, {"password", passwd}, {"useServerPrepStmts", "true"}};
+  Connection c(driver->connect(url, p));
+  PreparedStatement ps(c->prepareStatement("SELECT ?"));
+
+  ps->setInt(1, 0);
+  ResultSet rs(ps->executeQuery());
+  sql::ConnectionMetrics before= c->getMetrics();
+  for (int32_t i= 1; i <= iterations; ++i) {
+    ps->setInt(1, i);
+    rs.reset(ps->executeQuery());
+    ASSERT(rs->next());
+    ASSERT_EQUALS(i, rs->getInt(1));
+  }
+  sql::ConnectionMetrics after= c->getMetrics();
+
+  ASSERT_EQUALS(static_cast<int64_t>(0), static_cast<int64_t>(after.prepares - before.prepares));
+  ASSERT_EQUALS(static_cast<int64_t>(iterations), static_cast<int64_t>(after.executes - before.executes));
+  ASSERT(after.roundTrips - before.roundTrips <= static_cast<uint64_t>(iterations));
+}
+
+} /* namespace performance */
+} /* namespace testsuite */
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2023 MariaDB Corporation AB
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+
+
+#include "../unit_fixture.h"
+
+/**
+ * Performance regression gates: fixed budgets of allocations, round trips and prepares of the hot paths
+ *
+ */
+
+namespace testsuite
+{
+namespace performance
+{
+
+class perf_budget : public unit_fixture
+{
+private:
+  typedef unit_fixture super;
+
+public:
+
+  EXAMPLE_TEST_FIXTURE(perf_budget)
+  {
+    TEST_CASE(selectAllocations);
+    TEST_CASE(updateAllocations);
+    TEST_CASE(batchRoundTrips);
+    TEST_CASE(preparedReexecute);
+  }
+
+  /* SELECT 1 and getInt do not allocate more than the budget */
+  void selectAllocations();
+  /* Re-execution of an update by the same statement recycles its results, and allocates next to nothing */
+  void updateAllocations();
+  /* Rewritten executeBatch of 10k rows is sent in a few queries */
+  void batchRoundTrips();
+  /* Re-execution of the server side prepared statement does not prepare again, and takes one round trip */
+  void preparedReexecute();
+};
+
+REGISTER_FIXTURE(perf_budget);
+} /* namespace performance */
+} /* namespace testsuite */